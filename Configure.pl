@@ -49,7 +49,7 @@ GetOptions(\%args, qw(
     build=s host=s big-endian jit! enable-jit
     prefix=s bindir=s libdir=s mastdir=s
     relocatable make-install asan ubsan tsan
-    valgrind telemeh dtrace show-autovect git-cache-dir=s
+    valgrind telemeh dtrace fast-hash hash-single-alloc compact-headers show-autovect git-cache-dir=s
     show-autovect-failed:s),
 
     'no-optimize|nooptimize' => sub { $args{optimize} = 0 },
@@ -101,6 +101,12 @@ for (qw(coverage instrument static big-endian has-libtommath has-sha has-libuv
 # jit is default
 $args{jit} = 1 unless defined $args{jit};
 
+# the JIT reads STable pointers straight out of objects
+if ($args{'compact-headers'} && $args{jit}) {
+    print "The JIT does not support compact object headers, so it is disabled.\n\n";
+    $args{jit} = 0;
+}
+
 # fill in C<%defaults>
 if (exists $args{build} || exists $args{host}) {
     setup_cross($args{build}, $args{host});
@@ -428,6 +434,9 @@ push @cflags, '-DDEBUG_HELPERS' if $args{debug};
 push @cflags, '-DMVM_VALGRIND_SUPPORT' if $args{valgrind};
 push @cflags, '-DMVM_DTRACE_SUPPORT' if $args{dtrace};
 push @cflags, '-DHAVE_TELEMEH' if $args{telemeh};
+push @cflags, '-DMVM_HASH_SIPHASH_1_3' if $args{'fast-hash'};
+push @cflags, '-DMVM_HASH_SINGLE_ALLOCATION=1' if $args{'hash-single-alloc'};
+push @cflags, '-DMVM_COMPACT_HEADERS' if $args{'compact-headers'};
 push @cflags, '-DWORDS_BIGENDIAN' if $config{be}; # 3rdparty/sha1 needs it and it isnt set on mips;
 push @cflags, '-DMVM_HEAPSNAPSHOT_FORMAT=' . $config{heapsnapformat};
 push @cflags, $ENV{CFLAGS} if $ENV{CFLAGS};
@@ -509,6 +518,11 @@ if ($args{'jit'}) {
         $config{dasm_flags}   = '-D POSIX=1';
         $config{jit_arch}     = 'MVM_JIT_ARCH_X64';
         $config{jit_platform} = 'MVM_JIT_PLATFORM_POSIX';
+    } elsif ($Config{archname} =~ m/^aarch64/) {
+        $config{jit_obj}      = '$(JIT_OBJECTS) $(JIT_ARCH_ARM64)';
+        $config{dasm_flags}   = '-D POSIX=1';
+        $config{jit_arch}     = 'MVM_JIT_ARCH_ARM64';
+        $config{jit_platform} = 'MVM_JIT_PLATFORM_POSIX';
     } elsif ($Config{archname} =~ /^MSWin32-x64/) {
         $config{jit_obj}      = '$(JIT_OBJECTS) $(JIT_ARCH_X64)';
         $config{dasm_flags}   = '-D WIN32=1';
@@ -961,7 +975,9 @@ __END__
                    [--has-libtommath] [--has-sha] [--has-libuv]
                    [--has-libatomic_ops]
                    [--asan] [--ubsan] [--tsan] [--no-jit]
-                   [--telemeh] [--git-cache-dir <path>]
+                   [--telemeh] [--fast-hash] [--hash-single-alloc]
+                   [--compact-headers]
+                   [--git-cache-dir <path>]
 
     ./Configure.pl --build <build-triple> --host <host-triple>
                    [--ar <ar>] [--cc <cc>] [--ld <ld>] [--make <make>]
@@ -1163,6 +1179,29 @@ Disable JIT compiler, which is enabled by default to JIT-compile hot frames.
 
 Build support for the fine-grained internal event logger.
 
+=item --fast-hash
+
+Hash strings with SipHash-1-3 rather than SipHash-2-4. This is faster, and
+still keyed with a per-process secret, but has a smaller security margin
+against hash flooding.
+
+=item --hash-single-alloc
+
+Allocate the entries and metadata of each of the VM's internal hash tables as
+one block of memory, rather than two. This saves an allocation per table and
+keeps them together in memory, but means that ASAN and valgrind can no longer
+spot overruns from one into the other, so it is best left off for debugging.
+
+=item --compact-headers
+
+Pack the owning thread and flags of each object's header, and have objects
+refer to their STable by a 32-bit index rather than a pointer, making the
+header of an object 16 bytes rather than 24 on 64-bit platforms. This saves a
+lot of memory for heaps of many small objects, at the cost of an extra load
+to get at an object's STable and size, and of the JIT, which is disabled. It
+also limits a process to 65535 threads and about 16 million types. Extensions
+must be built with the same setting.
+
 =item --git-cache-dir <path>
 
 Use the given path as a git repository cache.
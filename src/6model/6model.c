@@ -202,6 +202,23 @@ MVMint32 MVM_6model_find_method_spesh(MVMThreadContext *tc, MVMObject *obj, MVMS
 }
 
 
+/* Finds a method using a polymorphic cache of num_types pairs of STable and
+ * method in spesh slots, starting from ss_idx, that was filled in when the
+ * frame was specialized. Falls back to a full lookup if none match. */
+void MVM_6model_find_method_spesh_poly(MVMThreadContext *tc, MVMObject *obj, MVMString *name,
+                                       MVMint32 ss_idx, MVMint32 num_types, MVMRegister *res) {
+    MVMCollectable **slots = tc->cur_frame->effective_spesh_slots + ss_idx;
+    MVMSTable *st = STABLE(obj);
+    MVMint32 i;
+    for (i = 0; i < num_types; i++) {
+        if ((MVMSTable *)slots[2 * i] == st) {
+            res->o = (MVMObject *)slots[2 * i + 1];
+            return;
+        }
+    }
+    MVM_6model_find_method(tc, obj, name, res, 1);
+}
+
 /* Locates a method by name. Returns 1 if it exists; otherwise 0. */
 static void late_bound_can_return(MVMThreadContext *tc, void *sr_data) {
     /* Transform to an integer result. */
@@ -451,8 +468,8 @@ void MVM_6model_invoke_default(MVMThreadContext *tc, MVMObject *invokee, MVMCall
     MVM_exception_throw_adhoc(tc, "Cannot invoke this object (REPR: %s; %s)", REPR(invokee)->name, MVM_6model_get_debug_name(tc, invokee));
 }
 
-/* Clean up STable memory. */
-void MVM_6model_stable_gc_free(MVMThreadContext *tc, MVMSTable *st) {
+/* Clean up STable memory, apart from its index. */
+static void free_stable_storage(MVMThreadContext *tc, MVMSTable *st) {
     /* First have it free its repr_data if it wants. */
     if (st->REPR->gc_free_repr_data)
         st->REPR->gc_free_repr_data(tc, st);
@@ -466,6 +483,88 @@ void MVM_6model_stable_gc_free(MVMThreadContext *tc, MVMSTable *st) {
     MVM_free(st->debug_name);
 }
 
+/* Clean up STable memory. */
+void MVM_6model_stable_gc_free(MVMThreadContext *tc, MVMSTable *st) {
+    free_stable_storage(tc, st);
+
+#ifdef MVM_COMPACT_HEADERS
+    /* Nothing refers to the index any more, so it can be handed out again. */
+    {
+        MVMInstance *instance = tc->instance;
+        uv_mutex_lock(&instance->mutex_stable_index);
+        *MVM_STABLE_INDEX_SLOT(st->header.st_idx) = NULL;
+        MVM_VECTOR_PUSH(instance->free_stable_indexes, st->header.st_idx);
+        uv_mutex_unlock(&instance->mutex_stable_index);
+    }
+#endif
+}
+
+/* Cleans up the memory of a list of STables, linked through their headers
+ * as the GC queues them for freeing. Code generating types at runtime can
+ * leave many of these at once, so the indexes are all handed back under one
+ * hold of the lock. */
+void MVM_6model_stable_gc_free_list(MVMThreadContext *tc, MVMSTable *st) {
+#ifdef MVM_COMPACT_HEADERS
+    MVMInstance *instance = tc->instance;
+    uv_mutex_lock(&instance->mutex_stable_index);
+#endif
+    while (st) {
+        MVMSTable *next = st->header.sc_forward_u.st;
+        st->header.sc_forward_u.st = NULL;
+        free_stable_storage(tc, st);
+#ifdef MVM_COMPACT_HEADERS
+        *MVM_STABLE_INDEX_SLOT(st->header.st_idx) = NULL;
+        MVM_VECTOR_PUSH(instance->free_stable_indexes, st->header.st_idx);
+#endif
+        st = next;
+    }
+#ifdef MVM_COMPACT_HEADERS
+    uv_mutex_unlock(&instance->mutex_stable_index);
+#endif
+}
+
+#ifdef MVM_COMPACT_HEADERS
+MVMSTable **MVM_stable_index_chunks[MVM_STABLE_INDEX_CHUNKS];
+
+/* Gives a new STable the index that objects of its type will refer to it
+ * by. Index 0 is never handed out, so that an object whose STable was not
+ * yet set is easy to spot. */
+void MVM_6model_stable_index_add(MVMThreadContext *tc, MVMSTable *st) {
+    MVMInstance *instance = tc->instance;
+    MVMuint32 idx;
+    uv_mutex_lock(&instance->mutex_stable_index);
+    if (MVM_VECTOR_ELEMS(instance->free_stable_indexes)) {
+        idx = MVM_VECTOR_POP(instance->free_stable_indexes);
+    }
+    else {
+        idx = instance->next_stable_index;
+        if (idx >= MVM_STABLE_INDEX_CHUNKS * MVM_STABLE_INDEX_CHUNK_SIZE) {
+            uv_mutex_unlock(&instance->mutex_stable_index);
+            MVM_oops(tc, "Too many types for compact object headers (limit is %d)",
+                MVM_STABLE_INDEX_CHUNKS * MVM_STABLE_INDEX_CHUNK_SIZE - 1);
+        }
+        if (!MVM_stable_index_chunks[idx >> MVM_STABLE_INDEX_CHUNK_BITS]) {
+            /* Make sure the chunk is zeroed before other threads can see it. */
+            MVMSTable **chunk = MVM_calloc(MVM_STABLE_INDEX_CHUNK_SIZE, sizeof(MVMSTable *));
+            MVM_barrier();
+            MVM_stable_index_chunks[idx >> MVM_STABLE_INDEX_CHUNK_BITS] = chunk;
+        }
+        instance->next_stable_index++;
+    }
+    *MVM_STABLE_INDEX_SLOT(idx) = st;
+    st->header.st_idx = idx;
+    uv_mutex_unlock(&instance->mutex_stable_index);
+}
+
+/* Frees the STable index table, at instance destruction. */
+void MVM_6model_stable_index_destroy(MVMInstance *instance) {
+    MVMuint32 i;
+    for (i = 0; i < MVM_STABLE_INDEX_CHUNKS; i++)
+        MVM_free_null(MVM_stable_index_chunks[i]);
+    MVM_VECTOR_DESTROY(instance->free_stable_indexes);
+}
+#endif
+
 /* Get the next type cache ID for a newly created STable. */
 MVMuint64 MVM_6model_next_type_cache_id(MVMThreadContext *tc) {
     return (MVMuint64)MVM_add(&tc->instance->cur_type_cache_id, MVM_TYPE_CACHE_ID_INCR) + MVM_TYPE_CACHE_ID_INCR;
@@ -477,7 +576,7 @@ void MVM_6model_never_repossess(MVMThreadContext *tc, MVMObject *obj) {
     if (IS_CONCRETE(obj))
         obj->header.flags1 |= MVM_CF_NEVER_REPOSSESS;
     else
-        obj->st->mode_flags |= MVM_NEVER_REPOSSESS_TYPE;
+        STABLE(obj)->mode_flags |= MVM_NEVER_REPOSSESS_TYPE;
 }
 
 /* Set the debug name on a type. */
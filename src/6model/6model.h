@@ -134,7 +134,15 @@ typedef enum {
     /* Note: if you're hunting for a flag, some day in the future when we
      * have used them all, this one is easy enough to eliminate by having the
      * tiny number of objects marked this way in a remembered set. */
-    MVM_CF_NEVER_REPOSSESS = 32
+    MVM_CF_NEVER_REPOSSESS = 32,
+
+    /* Has this object been pinned, so that it must stay alive and not move?
+     * Pinned objects go straight to gen2 when first seen in the nursery. */
+    MVM_CF_PINNED = 64,
+
+    /* Was this object sampled to see if objects of its type tend to live
+     * long enough to be worth allocating straight into gen2? */
+    MVM_CF_PRETENURE_SAMPLE = 128
 } MVMCollectableFlags1;
 
 typedef enum {
@@ -206,6 +214,18 @@ struct MVMCollectable {
         MVMSTable *st;
     } sc_forward_u;
 
+#ifdef MVM_COMPACT_HEADERS
+    /* With compact headers, the owner is packed down to 16 bits, and objects
+     * refer to their STable by a 32-bit index in the header rather than by
+     * a pointer after it, making the header of an object 16 bytes rather
+     * than 24. An STable holds its own index in st_idx. The size is not
+     * stored; it comes from the STable or the kind of collectable (see
+     * MVM_gc_collectable_size). */
+    MVMuint16 owner;
+    MVMuint8 flags1;
+    MVMuint8 flags2;
+    MVMuint32 st_idx;
+#else
     /* Identifier of the thread that created the object. 0 if this is a
      * non-heap frame. */
     MVMuint32 owner;
@@ -216,6 +236,7 @@ struct MVMCollectable {
 
     /* Object size, in bytes. */
     MVMuint16 size;
+#endif
 };
 #ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
 #  define MVM_DIRECT_SC_IDX_SENTINEL 0xFFFF
@@ -233,8 +254,10 @@ struct MVMObject {
     /* Commonalities that all collectable entities have. */
     MVMCollectable header;
 
+#ifndef MVM_COMPACT_HEADERS
     /* The s-table for the object. */
     MVMSTable *st;
+#endif
 };
 
 /* An dummy object, mostly used to compute the offset of the data part of
@@ -352,7 +375,9 @@ struct MVMSTable {
             /* Lookup table of existing parameterizations. For now, just a VM
              * array with alternating pairs of [arg array], object. Could in
              * the future we something lower level or hashy; we've yet to see
-             * how hot-path lookups end up being in reality. */
+             * how hot-path lookups end up being in reality. With weak
+             * parameterizations, full collections drop pairs whose object
+             * nothing else refers to. */
             MVMObject *lookup;
         } ric;
         struct {
@@ -383,6 +408,16 @@ struct MVMSTable {
     /* If this STable represents a type that can be the target of a
      * change_type - that is to say, it's been mixed in to. */
     MVMuint8 is_mixin_type;
+
+    /* Pretenuring: whether objects of this type are being sampled, are
+     * allocated in gen2, and so on (see MVM_PRETENURE_*), along with how
+     * many were sampled and how many of those got promoted, and the GC run
+     * that sampling ended in. These are updated without synchronization, so
+     * are only approximate. */
+    MVMuint8  pretenure_state;
+    MVMuint32 pretenure_sampled;
+    MVMuint32 pretenure_promoted;
+    MVMuint32 pretenure_sample_end;
 };
 
 /* The representation operations table. Note that representations are not
@@ -657,7 +692,10 @@ struct MVMREPROps {
      * adding all pointers it contains to the worklist. */
     void (*gc_mark) (MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist);
 
-    /* MoarVM-specific REPR API addition used to free an object. */
+    /* MoarVM-specific REPR API addition used to free an object. For gen2
+     * objects under MVM_GC_LAZY_SWEEP this may be called outside of a GC
+     * run, by the owning thread as it allocates, so it must not assume the
+     * world is stopped. */
     void (*gc_free) (MVMThreadContext *tc, MVMObject *object);
 
     /* This is called to do any cleanup of resources when an object gets
@@ -695,8 +733,32 @@ struct MVMREPROps {
     void (*describe_refs) (MVMThreadContext *tc, MVMHeapSnapshotState *ss, MVMSTable *st, void *data);
 };
 
-/* Various handy macros for getting at important stuff. */
+/* With compact headers, STables are found by index in a table of chunks,
+ * which never move once allocated, so STABLE needs no locking. */
+#ifdef MVM_COMPACT_HEADERS
+#define MVM_STABLE_INDEX_CHUNK_BITS 12
+#define MVM_STABLE_INDEX_CHUNK_SIZE (1 << MVM_STABLE_INDEX_CHUNK_BITS)
+#define MVM_STABLE_INDEX_CHUNKS     4096
+MVM_PUBLIC extern MVMSTable **MVM_stable_index_chunks[MVM_STABLE_INDEX_CHUNKS];
+#define MVM_STABLE_INDEX_SLOT(idx) (&MVM_stable_index_chunks[(idx) >> MVM_STABLE_INDEX_CHUNK_BITS] \
+                                        [(idx) & (MVM_STABLE_INDEX_CHUNK_SIZE - 1)])
+#endif
+
+/* Various handy macros for getting at important stuff. STABLE_REF gives
+ * where the STable pointer is kept, for marking; SET_STABLE changes the
+ * STable of an object, and INIT_STABLE sets it on a new one. */
+#ifdef MVM_COMPACT_HEADERS
+#define STABLE(o)        (*MVM_STABLE_INDEX_SLOT(((MVMObject *)(o))->header.st_idx))
+#define MVM_STABLE_REF(o) MVM_STABLE_INDEX_SLOT(((MVMObject *)(o))->header.st_idx)
+#define MVM_SET_STABLE(tc, o, s) (((MVMObject *)(o))->header.st_idx = (s)->header.st_idx)
+#define MVM_INIT_STABLE(o, s) (((MVMObject *)(o))->header.st_idx = (s)->header.st_idx)
+#else
 #define STABLE(o)        (((MVMObject *)(o))->st)
+#define MVM_STABLE_REF(o) (&((MVMObject *)(o))->st)
+#define MVM_SET_STABLE(tc, o, s) MVM_ASSIGN_REF(tc, &(((MVMObject *)(o))->header), \
+                                    ((MVMObject *)(o))->st, (s))
+#define MVM_INIT_STABLE(o, s) (((MVMObject *)(o))->st = (s))
+#endif
 #define REPR(o)          (STABLE((o))->REPR)
 #define OBJECT_BODY(o)   (&(((MVMObjectStooge *)(o))->data))
 
@@ -711,6 +773,8 @@ void MVM_6model_find_method(MVMThreadContext *tc, MVMObject *obj, MVMString *nam
 MVM_PUBLIC MVMObject * MVM_6model_find_method_cache_only(MVMThreadContext *tc, MVMObject *obj, MVMString *name);
 MVMint32 MVM_6model_find_method_spesh(MVMThreadContext *tc, MVMObject *obj, MVMString *name,
                                       MVMint32 ss_idx, MVMRegister *res);
+void MVM_6model_find_method_spesh_poly(MVMThreadContext *tc, MVMObject *obj, MVMString *name,
+                                       MVMint32 ss_idx, MVMint32 num_types, MVMRegister *res);
 MVMint64 MVM_6model_can_method_cache_only(MVMThreadContext *tc, MVMObject *obj, MVMString *name);
 void MVM_6model_can_method(MVMThreadContext *tc, MVMObject *obj, MVMString *name, MVMRegister *res);
 void MVM_6model_istype(MVMThreadContext *tc, MVMObject *obj, MVMObject *type, MVMRegister *res);
@@ -718,6 +782,11 @@ MVM_PUBLIC MVMint64 MVM_6model_istype_cache_only(MVMThreadContext *tc, MVMObject
 MVMint64 MVM_6model_try_cache_type_check(MVMThreadContext *tc, MVMObject *obj, MVMObject *type, MVMint32 *result);
 void MVM_6model_invoke_default(MVMThreadContext *tc, MVMObject *invokee, MVMCallsite *callsite, MVMRegister *args);
 void MVM_6model_stable_gc_free(MVMThreadContext *tc, MVMSTable *st);
+void MVM_6model_stable_gc_free_list(MVMThreadContext *tc, MVMSTable *st);
+#ifdef MVM_COMPACT_HEADERS
+void MVM_6model_stable_index_add(MVMThreadContext *tc, MVMSTable *st);
+void MVM_6model_stable_index_destroy(MVMInstance *instance);
+#endif
 MVMuint64 MVM_6model_next_type_cache_id(MVMThreadContext *tc);
 void MVM_6model_never_repossess(MVMThreadContext *tc, MVMObject *obj);
 
@@ -59,7 +59,7 @@ static void new_type(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *a
     /* See if we were given a name; put it into the meta-object if so. */
     name = name_arg.exists ? name_arg.arg.s : instance->str_consts.anon;
     MVM_ASSIGN_REF(tc, &(HOW->header), ((MVMKnowHOWREPR *)HOW)->body.name, name);
-    type_object->st->debug_name = MVM_string_utf8_encode_C_string(tc, name);
+    STABLE(type_object)->debug_name = MVM_string_utf8_encode_C_string(tc, name);
 
     /* Set .WHO to an empty hash. */
     BOOTHash = tc->instance->boot_types.BOOTHash;
@@ -280,7 +280,7 @@ static void bootstrap_KnowHOW(MVMThreadContext *tc) {
     st->size      = sizeof(MVMKnowHOWREPR);
     knowhow_how   = (MVMKnowHOWREPR *)REPR->allocate(tc, st);
     st->HOW       = (MVMObject *)knowhow_how;
-    knowhow_how->common.st = st;
+    MVM_INIT_STABLE(knowhow_how, st);
 
     /* Add various methods to the KnowHOW's HOW. */
     REPR->initialize(tc, NULL, (MVMObject *)knowhow_how, &knowhow_how->body);
@@ -325,7 +325,7 @@ static void add_meta_object(MVMThreadContext *tc, MVMObject *type_obj, char *nam
         /* Set name. */
         name_str = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, name);
         MVM_ASSIGN_REF(tc, &(meta_obj->header), ((MVMKnowHOWREPR *)meta_obj)->body.name, name_str);
-        type_obj->st->debug_name = strdup(name);
+        STABLE(type_obj)->debug_name = strdup(name);
     });
 }
 
@@ -473,7 +473,7 @@ static MVMObject * boot_typed_array(MVMThreadContext *tc, char *name, MVMObject
         bs = MVM_malloc(sizeof(MVMBoolificationSpec));
         bs->mode = MVM_BOOL_MODE_HAS_ELEMS;
         bs->method = NULL;
-        array->st->boolification_spec = bs;
+        STABLE(array)->boolification_spec = bs;
     });
     return array;
 }
@@ -554,6 +554,9 @@ static void string_consts(MVMThreadContext *tc) {
     string_creator(P6opaque, "P6opaque");
     string_creator(box_target, "box_target");
     string_creator(array, "array");
+    string_creator(hash, "hash");
+    string_creator(queue, "queue");
+    string_creator(capacity, "capacity");
     string_creator(positional_delegate, "positional_delegate");
     string_creator(associative_delegate, "associative_delegate");
     string_creator(auto_viv_container, "auto_viv_container");
@@ -581,11 +584,13 @@ static void string_consts(MVMThreadContext *tc) {
     string_creator(kind, "kind");
     string_creator(instrumented, "instrumented");
     string_creator(heap, "heap");
+    string_creator(census, "census");
     string_creator(translate_newlines, "translate_newlines");
     string_creator(platform_newline, MVM_TRANSLATE_NEWLINE_OUTPUT ? "\r\n" : "\n");
     string_creator(path, "path");
     string_creator(config, "config");
     string_creator(replacement, "replacement");
+    string_creator(env_delta, "env_delta");
 }
 
 /* Drives the overall bootstrap process. */
@@ -613,7 +618,7 @@ void MVM_6model_bootstrap(MVMThreadContext *tc) {
         bs = MVM_malloc(sizeof(MVMBoolificationSpec)); \
         bs->mode = boolspec; \
         bs->method = NULL; \
-        type->st->boolification_spec = bs; \
+        STABLE(type)->boolification_spec = bs; \
     } \
 } while (0)
     create_stub_boot_type(tc, MVM_REPR_ID_MVMNull, VMNull, 0, MVM_BOOL_MODE_NOT_TYPE_OBJECT);
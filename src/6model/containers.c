@@ -322,6 +322,50 @@ static void value_desc_cont_spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshG
         ins->operands[2].lit_i16 = (MVMuint16)data->value_offset;
         break;
         }
+    case MVM_OP_decont_i:
+    case MVM_OP_decont_n:
+    case MVM_OP_decont_s:
+    case MVM_OP_decont_u: {
+        /* Load the value out of the container into a temporary and unbox it,
+         * which may in turn be lowered if the type of the value is known.
+         * Only called for containers known to be concrete. */
+        MVMSpeshFacts   *cont_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+        MVMSpeshOperand  temp       = MVM_spesh_manipulate_get_temp_reg(tc, g, MVM_reg_obj);
+        MVMSpeshFacts   *temp_facts = MVM_spesh_get_facts(tc, g, temp);
+        MVMSpeshIns     *get_ins    = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
+        MVMuint16        unbox_op;
+        switch (ins->info->opcode) {
+            case MVM_OP_decont_i: unbox_op = MVM_OP_unbox_i; break;
+            case MVM_OP_decont_n: unbox_op = MVM_OP_unbox_n; break;
+            case MVM_OP_decont_s: unbox_op = MVM_OP_unbox_s; break;
+            default:              unbox_op = MVM_OP_unbox_u; break;
+        }
+
+        get_ins->info = MVM_op_get_op(MVM_OP_sp_get_o);
+        get_ins->operands = MVM_spesh_alloc(tc, g, 3 * sizeof(MVMSpeshOperand));
+        get_ins->operands[0] = temp;
+        get_ins->operands[1] = ins->operands[1];
+        get_ins->operands[2].lit_i16 = (MVMuint16)data->value_offset;
+        MVM_spesh_manipulate_insert_ins(tc, bb, ins->prev, get_ins);
+        MVM_spesh_usages_add_by_reg(tc, g, ins->operands[1], get_ins);
+        temp_facts->writer = get_ins;
+        if (cont_facts->flags & MVM_SPESH_FACT_KNOWN_DECONT_TYPE) {
+            temp_facts->type   = cont_facts->decont_type;
+            temp_facts->flags |= MVM_SPESH_FACT_KNOWN_TYPE;
+        }
+        if (cont_facts->flags & MVM_SPESH_FACT_DECONT_CONCRETE)
+            temp_facts->flags |= MVM_SPESH_FACT_CONCRETE;
+        else if (cont_facts->flags & MVM_SPESH_FACT_DECONT_TYPEOBJ)
+            temp_facts->flags |= MVM_SPESH_FACT_TYPEOBJ;
+
+        MVM_spesh_graph_add_comment(tc, g, ins, "lowered from %s", ins->info->name);
+        MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[1], ins);
+        ins->info = MVM_op_get_op(unbox_op);
+        ins->operands[1] = temp;
+        MVM_spesh_usages_add_by_reg(tc, g, temp, ins);
+        MVM_spesh_manipulate_release_temp_reg(tc, g, temp);
+        break;
+        }
     default: break;
     }
 }
@@ -881,73 +925,73 @@ void MVM_6model_container_cas(MVMThreadContext *tc, MVMObject *cont,
                               MVMObject *expected, MVMObject *value,
                               MVMRegister *result) {
     if (IS_CONCRETE(cont)) {
-        MVMContainerSpec const *cs = cont->st->container_spec;
+        MVMContainerSpec const *cs = STABLE(cont)->container_spec;
         if (cs) {
             if (cs->cas)
                 cs->cas(tc, cont, expected, value, result);
             else
                 MVM_exception_throw_adhoc(tc,
                     "A %s container does not know how to do atomic compare and swap",
-                     MVM_6model_get_stable_debug_name(tc, cont->st));
+                     MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
         else {
             MVM_exception_throw_adhoc(tc,
                 "Cannot perform atomic compare and swap on non-container value of type %s",
-                 MVM_6model_get_stable_debug_name(tc, cont->st));
+                 MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
     }
     else {
         MVM_exception_throw_adhoc(tc,
             "Cannot perform atomic compare and swap on %s type object",
-             MVM_6model_get_stable_debug_name(tc, cont->st));
+             MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
     }
 }
 
 MVMObject * MVM_6model_container_atomic_load(MVMThreadContext *tc, MVMObject *cont) {
     if (IS_CONCRETE(cont)) {
-        MVMContainerSpec const *cs = cont->st->container_spec;
+        MVMContainerSpec const *cs = STABLE(cont)->container_spec;
         if (cs) {
             if (cs->atomic_load)
                 return cs->atomic_load(tc, cont);
             else
                 MVM_exception_throw_adhoc(tc,
                     "A %s container does not know how to do an atomic load",
-                     MVM_6model_get_stable_debug_name(tc, cont->st));
+                     MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
         else {
             MVM_exception_throw_adhoc(tc,
                 "Cannot perform atomic load from a non-container value of type %s",
-                 MVM_6model_get_stable_debug_name(tc, cont->st));
+                 MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
     }
     else {
         MVM_exception_throw_adhoc(tc,
             "Cannot perform atomic load from %s type object",
-             MVM_6model_get_stable_debug_name(tc, cont->st));
+             MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
     }
 }
 
 void MVM_6model_container_atomic_store(MVMThreadContext *tc, MVMObject *cont, MVMObject *value) {
     if (IS_CONCRETE(cont)) {
-        MVMContainerSpec const *cs = cont->st->container_spec;
+        MVMContainerSpec const *cs = STABLE(cont)->container_spec;
         if (cs) {
             if (cs->atomic_store)
                 cs->atomic_store(tc, cont, value);
             else
                 MVM_exception_throw_adhoc(tc,
                     "A %s container does not know how to do an atomic store",
-                     MVM_6model_get_stable_debug_name(tc, cont->st));
+                     MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
         else {
             MVM_exception_throw_adhoc(tc,
                 "Cannot perform atomic store to a non-container value of type %s",
-                 MVM_6model_get_stable_debug_name(tc, cont->st));
+                 MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
         }
     }
     else {
         MVM_exception_throw_adhoc(tc,
             "Cannot perform atomic store to %s type object",
-             MVM_6model_get_stable_debug_name(tc, cont->st));
+             MVM_6model_get_stable_debug_name(tc, STABLE(cont)));
     }
 }
 
@@ -60,18 +60,18 @@ static void finish_parameterizing(MVMThreadContext *tc, void *sr_data) {
         MVM_gc_mark_thread_unblocked(tc);
 
         found = MVM_6model_parametric_try_find_parameterization(tc,
-            parametric_type->st, parameters);
+            STABLE(parametric_type), parameters);
         if (found) {
             prd->result->o = found;
         }
         else {
-            MVMObject *copy = MVM_repr_clone(tc, parametric_type->st->paramet.ric.lookup);
+            MVMObject *copy = MVM_repr_clone(tc, STABLE(parametric_type)->paramet.ric.lookup);
             MVMROOT(tc, copy, {
                 MVM_repr_push_o(tc, copy, parameters);
                 MVM_repr_push_o(tc, copy, prd->result->o);
             });
-            MVM_ASSIGN_REF(tc, &(parametric_type->st->header),
-                parametric_type->st->paramet.ric.lookup, copy);
+            MVM_ASSIGN_REF(tc, &(STABLE(parametric_type)->header),
+                STABLE(parametric_type)->paramet.ric.lookup, copy);
         }
         uv_mutex_unlock(&tc->instance->mutex_parameterization_add);
     });
@@ -141,6 +141,46 @@ MVMObject * MVM_6model_parametric_try_find_parameterization(MVMThreadContext *tc
     return NULL;
 }
 
+/* Whether a collectable was found to be alive by the full collection that is
+ * being done. */
+static MVMuint32 gc_live(MVMCollectable *col) {
+    return col && (col->flags2 & (MVM_CF_GEN2_LIVE | MVM_CF_FORWARDER_VALID));
+}
+
+/* With weak parameterizations, a full collection leaves the lookups of the
+ * parametric types it reaches until everything else is marked, then calls
+ * this on each to drop the parameterizations that weren't marked, before
+ * marking what is left. Readers of the lookup don't allocate, so it can be
+ * changed in place, with the world stopped. If the lookup was reached some
+ * other way, everything in it was marked anyway. */
+void MVM_6model_parametric_prune_lookup(MVMThreadContext *tc, MVMSTable *st) {
+    MVMObject    *lookup = st->paramet.ric.lookup;
+    MVMArrayBody *body;
+    MVMObject   **slots;
+    MVMuint64     i, kept = 0;
+
+    if (!lookup || gc_live((MVMCollectable *)lookup) || REPR(lookup)->ID != MVM_REPR_ID_VMArray
+            || ((MVMArrayREPRData *)STABLE(lookup)->REPR_data)->slot_type != MVM_ARRAY_OBJ)
+        return;
+
+    body  = &((MVMArray *)lookup)->body;
+    slots = body->slots.o + body->start;
+    for (i = 0; i + 1 < body->elems; i += 2) {
+        if (gc_live((MVMCollectable *)slots[i + 1])) {
+            slots[kept]     = slots[i];
+            slots[kept + 1] = slots[i + 1];
+            kept += 2;
+        }
+    }
+    if (kept != body->elems) {
+        /* Cards cover fixed ranges of the storage, so are no good once
+         * elements are moved; the array is then scanned in full. */
+        MVM_free(body->cards);
+        body->cards = NULL;
+        body->elems = kept;
+    }
+}
+
 /* If the passed type is a parameterized type, then returns the parametric
  * type it is based on. Otherwise, returns null. */
 MVMObject * MVM_6model_parametric_type_parameterized(MVMThreadContext *tc, MVMObject *type) {
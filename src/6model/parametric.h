@@ -2,6 +2,7 @@ void MVM_6model_parametric_setup(MVMThreadContext *tc, MVMObject *type, MVMObjec
 void MVM_6model_parametric_parameterize(MVMThreadContext *tc, MVMObject *type, MVMObject *params,
     MVMRegister *result);
 MVMObject * MVM_6model_parametric_try_find_parameterization(MVMThreadContext *tc, MVMSTable *st, MVMObject *params);
+void MVM_6model_parametric_prune_lookup(MVMThreadContext *tc, MVMSTable *st);
 MVMObject * MVM_6model_parametric_type_parameterized(MVMThreadContext *tc, MVMObject *type);
 MVMObject * MVM_6model_parametric_type_parameters(MVMThreadContext *tc, MVMObject *type);
 MVMObject * MVM_6model_parametric_type_parameter_at(MVMThreadContext *tc, MVMObject *type, MVMint64 idx);
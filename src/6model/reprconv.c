@@ -51,9 +51,11 @@ MVM_PUBLIC void MVM_repr_pos_set_elems(MVMThreadContext *tc, MVMObject *obj, MVM
 void MVM_repr_populate_indices_array(MVMThreadContext *tc, MVMObject *arr, MVMint64 *elems) {
     MVMint64 i;
     *elems = MVM_repr_elems(tc, arr);
-    if (*elems > tc->num_multi_dim_indices)
+    if (*elems > tc->num_multi_dim_indices) {
         tc->multi_dim_indices = MVM_realloc(tc->multi_dim_indices,
             *elems * sizeof(MVMint64));
+        tc->num_multi_dim_indices = *elems;
+    }
     for (i = 0; i < *elems; i++)
         tc->multi_dim_indices[i] = MVM_repr_at_pos_i(tc, arr, i);
 }
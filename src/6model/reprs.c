@@ -288,6 +288,14 @@ void MVM_repr_initialize_registry(MVMThreadContext *tc) {
     register_core_repr(Decoder);
     register_core_repr(StaticFrameSpesh);
     register_core_repr(SpeshPluginState);
+    register_core_repr(StringBuilder);
+    register_core_repr(StringSearcher);
+    register_core_repr(ConcHash);
+    register_core_repr(NativeHash);
+    register_core_repr(ChunkedArray);
+    register_core_repr(ArrayView);
+    register_core_repr(ConcRingQueue);
+    register_core_repr(ReadWriteLock);
 
     assert(tc->instance->num_reprs == MVM_REPR_CORE_COUNT);
 }
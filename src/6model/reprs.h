@@ -45,6 +45,14 @@
 #include "6model/reprs/MVMSpeshLog.h"
 #include "6model/reprs/MVMStaticFrameSpesh.h"
 #include "6model/reprs/MVMSpeshPluginState.h"
+#include "6model/reprs/StringBuilder.h"
+#include "6model/reprs/StringSearcher.h"
+#include "6model/reprs/ConcHash.h"
+#include "6model/reprs/NativeHash.h"
+#include "6model/reprs/ChunkedArray.h"
+#include "6model/reprs/ArrayView.h"
+#include "6model/reprs/ConcRingQueue.h"
+#include "6model/reprs/ReadWriteLock.h"
 
 /* REPR related functions. */
 void MVM_repr_initialize_registry(MVMThreadContext *tc);
@@ -100,8 +108,16 @@ const MVMREPROps * MVM_repr_get_by_name(MVMThreadContext *tc, MVMString *name);
 #define MVM_REPR_ID_Decoder                 43
 #define MVM_REPR_ID_MVMStaticFrameSpesh     44
 #define MVM_REPR_ID_MVMSpeshPluginState     45
+#define MVM_REPR_ID_StringBuilder           46
+#define MVM_REPR_ID_StringSearcher          47
+#define MVM_REPR_ID_ConcHash                48
+#define MVM_REPR_ID_NativeHash              49
+#define MVM_REPR_ID_ChunkedArray            50
+#define MVM_REPR_ID_ArrayView               51
+#define MVM_REPR_ID_ConcRingQueue           52
+#define MVM_REPR_ID_ReadWriteLock           53
 
-#define MVM_REPR_CORE_COUNT                 46
+#define MVM_REPR_CORE_COUNT                 54
 #define MVM_REPR_MAX_COUNT                  64
 
 /* Default attribute functions for a REPR that lacks them. */
@@ -0,0 +1,261 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps ArrayView_this_repr;
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st = MVM_gc_allocate_stable(tc, &ArrayView_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMArrayView);
+    });
+
+    return st->WHAT;
+}
+
+/* Copies the body of one object to another. The copy views the same
+ * elements of the same parent. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVMArrayViewBody *src_body  = (MVMArrayViewBody *)src;
+    MVMArrayViewBody *dest_body = (MVMArrayViewBody *)dest;
+    MVM_ASSIGN_REF(tc, &(dest_root->header), dest_body->parent, src_body->parent);
+    dest_body->offset = src_body->offset;
+    dest_body->length = src_body->length;
+    dest_body->stride = src_body->stride;
+}
+
+/* Adds held objects to the GC worklist. */
+static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
+    MVMArrayViewBody *body = (MVMArrayViewBody *)data;
+    MVM_gc_worklist_add(tc, worklist, &body->parent);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Checks the view is bound, and maps an index in the view, which may be
+ * negative to count from the end, to the index in the parent. */
+static MVMint64 parent_index(MVMThreadContext *tc, MVMArrayViewBody *body, MVMint64 index) {
+    if (MVM_UNLIKELY(!body->parent))
+        MVM_exception_throw_adhoc(tc, "ArrayView: view is not bound to an array");
+    if (index < 0)
+        index += body->length;
+    if (index < 0 || index >= body->length)
+        MVM_exception_throw_adhoc(tc,
+            "ArrayView: Index %"PRIi64" out of bounds for a view of %"PRIi64" elements",
+            index, body->length);
+    return body->offset + index * body->stride;
+}
+
+static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind) {
+    MVMArrayViewBody *body   = (MVMArrayViewBody *)data;
+    MVMint64          pindex = parent_index(tc, body, index);
+    MVMObject        *parent = body->parent;
+    REPR(parent)->pos_funcs.at_pos(tc, STABLE(parent), parent, OBJECT_BODY(parent),
+        pindex, value, kind);
+}
+
+static void bind_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister value, MVMuint16 kind) {
+    MVMArrayViewBody *body   = (MVMArrayViewBody *)data;
+    MVMint64          pindex = parent_index(tc, body, index);
+    MVMObject        *parent = body->parent;
+    REPR(parent)->pos_funcs.bind_pos(tc, STABLE(parent), parent, OBJECT_BODY(parent),
+        pindex, value, kind);
+}
+
+static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMArrayViewBody *body = (MVMArrayViewBody *)data;
+    return (MVMuint64)body->length;
+}
+
+/* Views of contiguous elements can have native values read and written
+ * through them, which is what binary parsing wants. The offset and count are
+ * checked against the view, not just the parent. */
+static MVMint64 buf_offset(MVMThreadContext *tc, MVMArrayViewBody *body, MVMint64 offset, MVMuint64 count) {
+    MVMArrayREPRData *parent_data;
+    if (MVM_UNLIKELY(!body->parent))
+        MVM_exception_throw_adhoc(tc, "ArrayView: view is not bound to an array");
+    if (body->stride != 1)
+        MVM_exception_throw_adhoc(tc, "ArrayView: can only read or write native values in a view with stride 1");
+    parent_data = (MVMArrayREPRData *)STABLE(body->parent)->REPR_data;
+    if (offset < 0 || (MVMuint64)offset * parent_data->elem_size + count
+            > (MVMuint64)body->length * parent_data->elem_size)
+        MVM_exception_throw_adhoc(tc,
+            "ArrayView: offset %"PRIi64" and size %"PRIu64" out of bounds for a view of %"PRIi64" elements",
+            offset, count, body->length);
+    return body->offset + offset;
+}
+
+static void write_buf(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, char *from, MVMint64 offset, MVMuint64 count) {
+    MVMArrayViewBody *body    = (MVMArrayViewBody *)data;
+    MVMint64          poffset = buf_offset(tc, body, offset, count);
+    MVMObject        *parent  = body->parent;
+    REPR(parent)->pos_funcs.write_buf(tc, STABLE(parent), parent, OBJECT_BODY(parent),
+        from, poffset, count);
+}
+
+static MVMint64 read_buf(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 offset, MVMuint64 count) {
+    MVMArrayViewBody *body    = (MVMArrayViewBody *)data;
+    MVMint64          poffset = buf_offset(tc, body, offset, count);
+    MVMObject        *parent  = body->parent;
+    return REPR(parent)->pos_funcs.read_buf(tc, STABLE(parent), parent, OBJECT_BODY(parent),
+        poffset, count);
+}
+
+/* Views of all kinds of arrays share an STable, so the element type can't be
+ * known here. */
+static MVMStorageSpec get_elem_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    MVMStorageSpec spec;
+    spec.inlineable      = MVM_STORAGE_SPEC_REFERENCE;
+    spec.boxed_primitive = MVM_STORAGE_SPEC_BP_NONE;
+    spec.can_box         = 0;
+    spec.bits            = 0;
+    spec.align           = 0;
+    spec.is_unsigned     = 0;
+    return spec;
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
+    /* Nothing to do for this REPR. */
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMArrayView);
+}
+
+static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
+    MVMArrayViewBody *body = (MVMArrayViewBody *)data;
+    MVM_serialization_write_ref(tc, writer, body->parent);
+    MVM_serialization_write_int(tc, writer, body->offset);
+    MVM_serialization_write_int(tc, writer, body->length);
+    MVM_serialization_write_int(tc, writer, body->stride);
+}
+
+static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMSerializationReader *reader) {
+    MVMArrayViewBody *body = (MVMArrayViewBody *)data;
+    MVM_ASSIGN_REF(tc, &(root->header), body->parent, MVM_serialization_read_ref(tc, reader));
+    body->offset = MVM_serialization_read_int(tc, reader);
+    body->length = MVM_serialization_read_int(tc, reader);
+    body->stride = MVM_serialization_read_int(tc, reader);
+}
+
+static void describe_refs(MVMThreadContext *tc, MVMHeapSnapshotState *ss, MVMSTable *st, void *data) {
+    MVMArrayViewBody *body = (MVMArrayViewBody *)data;
+    MVM_profile_heap_add_collectable_rel_const_cstr(tc, ss,
+        (MVMCollectable *)body->parent, "Parent array");
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMArrayView_initialize(MVMThreadContext *tc) {
+    return &ArrayView_this_repr;
+}
+
+static const MVMREPROps ArrayView_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    NULL, /* initialize */
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    {
+        at_pos,
+        bind_pos,
+        MVM_REPR_DEFAULT_SET_ELEMS,
+        MVM_REPR_DEFAULT_PUSH,
+        MVM_REPR_DEFAULT_POP,
+        MVM_REPR_DEFAULT_UNSHIFT,
+        MVM_REPR_DEFAULT_SHIFT,
+        MVM_REPR_DEFAULT_SLICE,
+        MVM_REPR_DEFAULT_SPLICE,
+        MVM_REPR_DEFAULT_AT_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_BIND_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_DIMENSIONS,
+        MVM_REPR_DEFAULT_SET_DIMENSIONS,
+        get_elem_storage_spec,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC_MULTIDIM,
+        write_buf,
+        read_buf
+    },    /* pos_funcs */
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    elems,
+    get_storage_spec,
+    NULL, /* change_type */
+    serialize,
+    deserialize,
+    NULL, /* serialize_repr_data */
+    NULL, /* deserialize_repr_data */
+    deserialize_stable_size,
+    gc_mark,
+    NULL, /* gc_free */
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    NULL, /* gc_free_repr_data */
+    compose,
+    NULL, /* spesh */
+    "ArrayView", /* name */
+    MVM_REPR_ID_ArrayView,
+    NULL, /* unmanaged_size */
+    describe_refs,
+};
+
+/* Binds a view to a range of a VMArray. A view of a view is bound straight
+ * to the underlying array, so element access never goes through a chain of
+ * views. The whole range has to be within the array as it is now. */
+void MVM_array_view_bind(MVMThreadContext *tc, MVMObject *view, MVMObject *parent,
+                         MVMint64 offset, MVMint64 length, MVMint64 stride) {
+    MVMArrayViewBody *body;
+    MVMint64          parent_elems, last;
+
+    if (MVM_UNLIKELY(REPR(view)->ID != MVM_REPR_ID_ArrayView || !IS_CONCRETE(view)))
+        MVM_exception_throw_adhoc(tc,
+            "arrviewbind can only work on an object with the ArrayView representation");
+    if (REPR(parent)->ID == MVM_REPR_ID_ArrayView && IS_CONCRETE(parent)) {
+        MVMArrayViewBody *inner = &((MVMArrayView *)parent)->body;
+        if (!inner->parent)
+            MVM_exception_throw_adhoc(tc, "ArrayView: view is not bound to an array");
+        /* Both the first and the last element reached must lie within the
+         * inner view's window, whichever way the stride goes. */
+        last = offset + (length - 1) * stride;
+        if (offset < 0 || length < 0 || (length && (offset >= inner->length
+                || last < 0 || last >= inner->length)))
+            MVM_exception_throw_adhoc(tc, "ArrayView: view range out of bounds");
+        offset = inner->offset + offset * inner->stride;
+        stride = stride * inner->stride;
+        parent = inner->parent;
+    }
+    if (MVM_UNLIKELY(REPR(parent)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(parent)))
+        MVM_exception_throw_adhoc(tc, "ArrayView: can only view a concrete VMArray");
+    if (stride == 0)
+        MVM_exception_throw_adhoc(tc, "ArrayView: stride may not be zero");
+
+    parent_elems = (MVMint64)MVM_repr_elems(tc, parent);
+    last = offset + (length - 1) * stride;
+    if (offset < 0 || length < 0 || (length && (offset >= parent_elems || last < 0 || last >= parent_elems)))
+        MVM_exception_throw_adhoc(tc,
+            "ArrayView: view of %"PRIi64" elements from %"PRIi64" with stride %"PRIi64" is out of bounds for an array of %"PRIi64" elements",
+            length, offset, stride, parent_elems);
+
+    body = &((MVMArrayView *)view)->body;
+    MVM_ASSIGN_REF(tc, &(view->header), body->parent, parent);
+    body->offset = offset;
+    body->length = length;
+    body->stride = stride;
+}
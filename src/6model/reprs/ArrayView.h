@@ -0,0 +1,25 @@
+/* Representation used for a view onto part of a VMArray, such as one field of
+ * a buf8 being parsed, without copying it out. Element i of the view is
+ * element offset + i * stride of the parent; all reads and writes go through
+ * the parent, which the view keeps alive. */
+struct MVMArrayViewBody {
+    /* The array being viewed; NULL until the view is bound. */
+    MVMObject *parent;
+
+    /* Where in the parent the view starts, the number of elements in the
+     * view, and the distance between them in the parent. */
+    MVMint64   offset;
+    MVMint64   length;
+    MVMint64   stride;
+};
+struct MVMArrayView {
+    MVMObject common;
+    MVMArrayViewBody body;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMArrayView_initialize(MVMThreadContext *tc);
+
+/* Operations on an ArrayView object. */
+void MVM_array_view_bind(MVMThreadContext *tc, MVMObject *view, MVMObject *parent,
+                         MVMint64 offset, MVMint64 length, MVMint64 stride);
@@ -111,6 +111,7 @@ static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, voi
 
     body->allocated = 4;
     body->elems = 0;
+    body->source = NULL;
 }
 
 /* Copies to the body of one object to another. */
@@ -130,6 +131,8 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
     dest_body->managed = src_body->managed;
     dest_body->allocated = src_body->allocated;
     dest_body->elems = src_body->elems;
+    if (src_body->source)
+        MVM_ASSIGN_REF(tc, &(dest_root->header), dest_body->source, src_body->source);
 }
 
 /* This is called to do any cleanup of resources when an object gets
@@ -160,6 +163,8 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
     const MVMint32 elems = body->elems;
     MVMint32 i;
 
+    MVM_gc_worklist_add(tc, worklist, &body->source);
+
     /* Don't traverse child_objs list if there isn't one. */
     if (!body->child_objs) return;
 
@@ -254,19 +259,26 @@ static MVMObject * make_wrapper(MVMThreadContext *tc, MVMSTable *st, void *data)
             MVM_exception_throw_adhoc(tc, "Unknown element type in CArray");
     }
 }
+/* Checks if an index is beyond the elements we know we have; for an array
+ * from C, we don't know, so it never is. */
+static MVMint32 beyond_elems(MVMThreadContext *tc, MVMCArrayBody *body, MVMint64 index) {
+    if (body->source)
+        return index >= (MVMint64)MVM_repr_elems(tc, body->source);
+    return body->managed && index >= body->elems;
+}
 static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind) {
     MVMCArrayREPRData *repr_data = (MVMCArrayREPRData *)st->REPR_data;
     MVMCArrayBody     *body      = (MVMCArrayBody *)data;
-    void              *ptr       = ((char *)body->storage) + index * repr_data->elem_size;
+    void              *ptr       = ((char *)MVM_carray_storage(body)) + index * repr_data->elem_size;
     switch (repr_data->elem_kind) {
         case MVM_CARRAY_ELEM_KIND_NUMERIC:
             if (kind == MVM_reg_int64)
-                value->i64 = body->managed && index >= body->elems
+                value->i64 = beyond_elems(tc, body, index)
                     ? 0
                     : REPR(repr_data->elem_type)->box_funcs.get_int(tc,
                         STABLE(repr_data->elem_type), root, ptr);
             else if (kind == MVM_reg_num64)
-                value->n64 = body->managed && index >= body->elems
+                value->n64 = beyond_elems(tc, body, index)
                     ? 0.0
                     : REPR(repr_data->elem_type)->box_funcs.get_num(tc,
                         STABLE(repr_data->elem_type), root, ptr);
@@ -359,7 +371,11 @@ static void bind_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void
     if (index >= body->elems)
         body->elems = index + 1;
 
-    ptr = ((char *)body->storage) + index * repr_data->elem_size;
+    /* Binding past the end of a view of a VMArray grows the array. */
+    if (body->source && index >= (MVMint64)MVM_repr_elems(tc, body->source))
+        MVM_repr_pos_set_elems(tc, body->source, index + 1);
+
+    ptr = ((char *)MVM_carray_storage(body)) + index * repr_data->elem_size;
 
     switch (repr_data->elem_kind) {
         case MVM_CARRAY_ELEM_KIND_NUMERIC:
@@ -437,6 +453,8 @@ static void aslice(MVMThreadContext *tc, MVMSTable *st, MVMObject *src, void *da
 static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
     MVMCArrayBody *body = (MVMCArrayBody *)data;
 
+    if (body->source)
+        return MVM_repr_elems(tc, body->source);
     if (body->managed)
         return body->elems;
 
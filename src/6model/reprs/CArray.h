@@ -18,6 +18,11 @@ struct MVMCArrayBody {
     /* The number of elements we have, if known. Invalid if we
      * are not managing the array. */
     MVMint32 elems;
+
+    /* If this array is a view of a VMArray (see MVM_nativecall_carray_view),
+     * that array, which owns the storage; we are then not managing it, but
+     * know how many elements there are from the array. */
+    MVMObject *source;
 };
 
 struct MVMCArray {
@@ -48,5 +53,16 @@ struct MVMCArrayREPRData {
     MVMint32 elem_kind;
 };
 
+/* Gets the storage of a CArray. For a view of a VMArray, the array may have
+ * moved its storage since we last looked, so we look again. */
+MVM_STATIC_INLINE void * MVM_carray_storage(MVMCArrayBody *body) {
+    if (body->source) {
+        MVMArrayBody *arr_body = &((MVMArray *)body->source)->body;
+        size_t elem_size = ((MVMArrayREPRData *)STABLE(body->source)->REPR_data)->elem_size;
+        body->storage = (char *)arr_body->slots.any + arr_body->start * elem_size;
+    }
+    return body->storage;
+}
+
 /* Initializes the CArray REPR. */
 const MVMREPROps * MVMCArray_initialize(MVMThreadContext *tc);
@@ -103,6 +103,16 @@ static MVMObject * index_mapping_and_flat_list(MVMThreadContext *tc, MVMObject *
     return flat_list;
 }
 
+/* Works out which attributes have child objects. */
+static void compute_child_attrs(MVMCStructREPRData *repr_data) {
+    MVMint32 i, num = 0;
+    repr_data->child_attrs = (MVMint32 *)MVM_malloc((repr_data->num_attributes + 1) * sizeof(MVMint32));
+    for (i = 0; i < repr_data->num_attributes; i++)
+        if ((repr_data->attribute_locations[i] & MVM_CSTRUCT_ATTR_MASK) != MVM_CSTRUCT_ATTR_IN_STRUCT)
+            repr_data->child_attrs[num++] = i;
+    repr_data->child_attrs[num] = -1;
+}
+
 static MVMint32 round_up_to_multi(MVMint32 i, MVMint32 m) {
     return (MVMint32)((i + m - 1) / m) * m;
 }
@@ -346,6 +356,7 @@ static void compute_allocation_strategy(MVMThreadContext *tc, MVMObject *repr_in
         if (repr_data->initialize_slots)
             repr_data->initialize_slots[cur_init_slot] = -1;
     }
+    compute_child_attrs(repr_data);
 
     MVM_gc_root_temp_pop_n(tc, 2); /* repr_info, st */
 }
@@ -753,6 +764,7 @@ static void gc_free_repr_data(MVMThreadContext *tc, MVMSTable *st) {
         MVM_free(repr_data->member_types);
         MVM_free(repr_data->initialize_slots);
     }
+    MVM_free(repr_data->child_attrs);
 
     MVM_free(st->REPR_data);
 }
@@ -891,6 +903,7 @@ static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerial
         repr_data->initialize_slots[i] = MVM_serialization_read_int(tc, reader);
     }
     repr_data->initialize_slots[i] = -1;
+    compute_child_attrs(repr_data);
 
     st->REPR_data = repr_data;
 }
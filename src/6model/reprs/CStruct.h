@@ -81,6 +81,11 @@ struct MVMCStructREPRData {
     /* Slots holding flattened objects that need another REPR to initialize
      * them; terminated with -1. */
     MVMint32 *initialize_slots;
+
+    /* The attributes that have a child object, which are all a native call
+     * refreshing the struct has to look at; terminated with -1. Not
+     * serialized, but worked out again from the attribute locations. */
+    MVMint32 *child_attrs;
 };
 
 /* Initializes the CStruct REPR. */
@@ -0,0 +1,574 @@
+#include "moar.h"
+#include "limits.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps ChunkedArray_this_repr;
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st = MVM_gc_allocate_stable(tc, &ChunkedArray_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)MVM_malloc(sizeof(MVMChunkedArrayREPRData));
+
+        repr_data->slot_type = MVM_reg_obj;
+        repr_data->elem_type = NULL;
+
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMChunkedArray);
+        st->REPR_data = repr_data;
+    });
+
+    return st->WHAT;
+}
+
+/* Gets the slot for an element, which must be in range. */
+MVM_STATIC_INLINE MVMRegister * slot_at(MVMChunkedArrayBody *body, MVMuint64 index) {
+    MVMuint64 real_index = body->start + index;
+    return &(body->chunks[real_index >> MVM_CHUNKED_ARRAY_CHUNK_SHIFT][real_index & MVM_CHUNKED_ARRAY_CHUNK_MASK]);
+}
+
+/* The number of chunks needed to hold the given number of slots. */
+MVM_STATIC_INLINE MVMuint64 chunks_for(MVMuint64 slots) {
+    return (slots + MVM_CHUNKED_ARRAY_CHUNK_MASK) >> MVM_CHUNKED_ARRAY_CHUNK_SHIFT;
+}
+
+/* Makes sure the chunk table has room for the wanted number of chunks. Only
+ * the table is ever reallocated, never the chunks themselves. */
+static void ensure_table(MVMThreadContext *tc, MVMChunkedArrayBody *body, MVMuint64 wanted) {
+    if (wanted > body->alloc_chunks) {
+        MVMuint64 alloc = body->alloc_chunks ? body->alloc_chunks * 2 : 4;
+        if (alloc < wanted)
+            alloc = wanted;
+        body->chunks = MVM_realloc(body->chunks, alloc * sizeof(MVMRegister *));
+        body->alloc_chunks = alloc;
+    }
+}
+
+/* Allocates zeroed chunks until there are the wanted number of them. */
+static void add_chunks(MVMThreadContext *tc, MVMChunkedArrayBody *body, MVMuint64 wanted) {
+    ensure_table(tc, body, wanted);
+    while (body->num_chunks < wanted)
+        body->chunks[body->num_chunks++] = MVM_calloc(MVM_CHUNKED_ARRAY_CHUNK_SLOTS, sizeof(MVMRegister));
+}
+
+/* Frees the chunks past the ones the elements need. One spare chunk is kept,
+ * so pushing and popping around a chunk boundary doesn't allocate and free a
+ * chunk every time. */
+static void release_chunks(MVMThreadContext *tc, MVMChunkedArrayBody *body) {
+    MVMuint64 keep;
+    if (body->elems == 0)
+        body->start = 0;
+    keep = chunks_for(body->start + body->elems) + 1;
+    while (body->num_chunks > keep)
+        MVM_free(body->chunks[--body->num_chunks]);
+}
+
+/* Zeroes the slots from one real index up to another, within the chunks that
+ * are allocated. */
+static void zero_slots(MVMChunkedArrayBody *body, MVMuint64 from, MVMuint64 to) {
+    MVMuint64 allocated = body->num_chunks << MVM_CHUNKED_ARRAY_CHUNK_SHIFT;
+    if (to > allocated)
+        to = allocated;
+    while (from < to) {
+        MVMuint64 offset = from & MVM_CHUNKED_ARRAY_CHUNK_MASK;
+        MVMuint64 count  = MVM_CHUNKED_ARRAY_CHUNK_SLOTS - offset;
+        if (count > to - from)
+            count = to - from;
+        memset(&(body->chunks[from >> MVM_CHUNKED_ARRAY_CHUNK_SHIFT][offset]), 0,
+            count * sizeof(MVMRegister));
+        from += count;
+    }
+}
+
+static void set_size_internal(MVMThreadContext *tc, MVMChunkedArrayBody *body, MVMuint64 n) {
+    MVMuint64 elems = body->elems;
+
+    if (n == elems)
+        return;
+
+    if (n < elems) {
+        /* Free the chunks we no longer need, then clear off the remaining
+         * slots that were in use. */
+        MVMuint64 start = body->start;
+        body->elems = n;
+        release_chunks(tc, body);
+        zero_slots(body, start + n, start + elems);
+        return;
+    }
+
+    if (n > (1ULL << (CHAR_BIT * sizeof(size_t) - 4)))
+        MVM_exception_throw_adhoc(tc,
+            "Unable to allocate an array of %"PRIu64" elements", n);
+    add_chunks(tc, body, chunks_for(body->start + n));
+    body->elems = n;
+}
+
+/* Copies the body of one object to another. The chunks are copied whole,
+ * so the copy has the same layout. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVMChunkedArrayBody *src_body  = (MVMChunkedArrayBody *)src;
+    MVMChunkedArrayBody *dest_body = (MVMChunkedArrayBody *)dest;
+    MVMuint64 i;
+    dest_body->elems        = src_body->elems;
+    dest_body->start        = src_body->start;
+    dest_body->num_chunks   = 0;
+    dest_body->alloc_chunks = 0;
+    dest_body->chunks       = NULL;
+    ensure_table(tc, dest_body, src_body->num_chunks);
+    for (i = 0; i < src_body->num_chunks; i++) {
+        MVMRegister *chunk = MVM_malloc(MVM_CHUNKED_ARRAY_CHUNK_SLOTS * sizeof(MVMRegister));
+        memcpy(chunk, src_body->chunks[i], MVM_CHUNKED_ARRAY_CHUNK_SLOTS * sizeof(MVMRegister));
+        dest_body->chunks[i] = chunk;
+    }
+    dest_body->num_chunks = src_body->num_chunks;
+}
+
+/* Adds held objects to the GC worklist. Strings and objects are both
+ * pointers in the same register union, so one loop handles both. */
+static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVMChunkedArrayBody     *body      = (MVMChunkedArrayBody *)data;
+    MVMuint64 i, end;
+
+    if (repr_data->slot_type != MVM_reg_obj && repr_data->slot_type != MVM_reg_str)
+        return;
+
+    MVM_gc_worklist_presize_for(tc, worklist, body->elems);
+    end = body->start + body->elems;
+    for (i = body->start; i < end; i++)
+        MVM_gc_worklist_add(tc, worklist,
+            &(body->chunks[i >> MVM_CHUNKED_ARRAY_CHUNK_SHIFT][i & MVM_CHUNKED_ARRAY_CHUNK_MASK].o));
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMChunkedArrayBody *body = &(((MVMChunkedArray *)obj)->body);
+    MVMuint64 i;
+    for (i = 0; i < body->num_chunks; i++)
+        MVM_free(body->chunks[i]);
+    MVM_free(body->chunks);
+}
+
+/* Marks the representation data in an STable.*/
+static void gc_mark_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMGCWorklist *worklist) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    if (repr_data == NULL)
+        return;
+    MVM_gc_worklist_add(tc, worklist, &repr_data->elem_type);
+}
+
+/* Frees the representation data in an STable.*/
+static void gc_free_repr_data(MVMThreadContext *tc, MVMSTable *st) {
+    MVM_free(st->REPR_data);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+MVM_STATIC_INLINE void check_kind(MVMThreadContext *tc, MVMSTable *st, MVMuint16 kind, const char *op) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    if (MVM_UNLIKELY(kind != repr_data->slot_type))
+        MVM_exception_throw_adhoc(tc, "ChunkedArray: %s expected %s register",
+            op, MVM_reg_get_debug_name(tc, repr_data->slot_type));
+}
+
+/* Stores a value in a slot, with a write barrier if it's a reference. */
+MVM_STATIC_INLINE void store(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, MVMRegister *slot, MVMRegister value) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    switch (repr_data->slot_type) {
+        case MVM_reg_obj:
+            MVM_ASSIGN_REF(tc, &(root->header), slot->o, value.o);
+            break;
+        case MVM_reg_str:
+            MVM_ASSIGN_REF(tc, &(root->header), slot->s, value.s);
+            break;
+        default:
+            *slot = value;
+            break;
+    }
+}
+
+/* Loads a value from a slot; an empty object slot reads as VMNull. */
+MVM_STATIC_INLINE void load(MVMThreadContext *tc, MVMSTable *st, MVMRegister *slot, MVMRegister *value) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    *value = *slot;
+    if (repr_data->slot_type == MVM_reg_obj && !value->o)
+        value->o = tc->instance->VMNull;
+}
+
+static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+
+    check_kind(tc, st, kind, "atpos");
+
+    /* Handle negative indexes. */
+    if (index < 0) {
+        index += body->elems;
+        if (index < 0)
+            MVM_exception_throw_adhoc(tc, "ChunkedArray: Index out of bounds");
+    }
+
+    if ((MVMuint64)index >= body->elems) {
+        value->i64 = 0;
+        load(tc, st, value, value);
+    }
+    else {
+        load(tc, st, slot_at(body, (MVMuint64)index), value);
+    }
+}
+
+static void bind_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+
+    check_kind(tc, st, kind, "bindpos");
+
+    /* Handle negative indexes and resizing if needed. */
+    if (index < 0) {
+        index += body->elems;
+        if (index < 0)
+            MVM_exception_throw_adhoc(tc, "ChunkedArray: Index out of bounds");
+    }
+    else if ((MVMuint64)index >= body->elems)
+        set_size_internal(tc, body, (MVMuint64)index + 1);
+
+    store(tc, st, root, slot_at(body, (MVMuint64)index), value);
+}
+
+static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+    return body->elems;
+}
+
+static void set_elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMuint64 count) {
+    set_size_internal(tc, (MVMChunkedArrayBody *)data, count);
+}
+
+static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+    check_kind(tc, st, kind, "push");
+    set_size_internal(tc, body, body->elems + 1);
+    store(tc, st, root, slot_at(body, body->elems - 1), value);
+}
+
+static void pop(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister *value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+    MVMRegister         *slot;
+
+    if (body->elems < 1)
+        MVM_exception_throw_adhoc(tc,
+            "ChunkedArray: Can't pop from an empty array");
+    check_kind(tc, st, kind, "pop");
+
+    slot = slot_at(body, body->elems - 1);
+    load(tc, st, slot, value);
+    slot->i64 = 0;
+    body->elems--;
+    release_chunks(tc, body);
+}
+
+static void unshift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+
+    check_kind(tc, st, kind, "unshift");
+
+    /* If there's no room before the first element, add a chunk at the
+     * front; only the chunk pointers move. */
+    if (body->start == 0) {
+        ensure_table(tc, body, body->num_chunks + 1);
+        memmove(body->chunks + 1, body->chunks, body->num_chunks * sizeof(MVMRegister *));
+        body->chunks[0] = MVM_calloc(MVM_CHUNKED_ARRAY_CHUNK_SLOTS, sizeof(MVMRegister));
+        body->num_chunks++;
+        body->start = MVM_CHUNKED_ARRAY_CHUNK_SLOTS;
+    }
+
+    body->start--;
+    body->elems++;
+    store(tc, st, root, slot_at(body, 0), value);
+}
+
+static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister *value, MVMuint16 kind) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+    MVMRegister         *slot;
+
+    if (body->elems < 1)
+        MVM_exception_throw_adhoc(tc,
+            "ChunkedArray: Can't shift from an empty array");
+    check_kind(tc, st, kind, "shift");
+
+    slot = slot_at(body, 0);
+    load(tc, st, slot, value);
+    slot->i64 = 0;
+    body->start++;
+    body->elems--;
+
+    /* Once the first chunk is empty, free it. */
+    if (body->elems && body->start == MVM_CHUNKED_ARRAY_CHUNK_SLOTS) {
+        MVM_free(body->chunks[0]);
+        body->num_chunks--;
+        memmove(body->chunks, body->chunks + 1, body->num_chunks * sizeof(MVMRegister *));
+        body->start = 0;
+    }
+    release_chunks(tc, body);
+}
+
+static MVMStorageSpec get_elem_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVMStorageSpec spec;
+
+    /* initialise storage spec to default values */
+    spec.bits            = 0;
+    spec.align           = 0;
+    spec.is_unsigned     = 0;
+
+    switch (repr_data->slot_type) {
+        case MVM_reg_str:
+            spec.inlineable      = MVM_STORAGE_SPEC_INLINED;
+            spec.boxed_primitive = MVM_STORAGE_SPEC_BP_STR;
+            spec.can_box         = MVM_STORAGE_SPEC_CAN_BOX_STR;
+            break;
+        case MVM_reg_int64:
+            spec.inlineable      = MVM_STORAGE_SPEC_INLINED;
+            spec.boxed_primitive = MVM_STORAGE_SPEC_BP_INT;
+            spec.can_box         = MVM_STORAGE_SPEC_CAN_BOX_INT;
+            break;
+        case MVM_reg_num64:
+            spec.inlineable      = MVM_STORAGE_SPEC_INLINED;
+            spec.boxed_primitive = MVM_STORAGE_SPEC_BP_NUM;
+            spec.can_box         = MVM_STORAGE_SPEC_CAN_BOX_NUM;
+            break;
+        default:
+            spec.inlineable      = MVM_STORAGE_SPEC_REFERENCE;
+            spec.boxed_primitive = MVM_STORAGE_SPEC_BP_NONE;
+            spec.can_box         = 0;
+            break;
+    }
+    return spec;
+}
+
+/* Works out the slot type from the storage spec of the element type. */
+static void spec_to_repr_data(MVMThreadContext *tc, MVMChunkedArrayREPRData *repr_data, const MVMStorageSpec *spec) {
+    switch (spec->boxed_primitive) {
+        case MVM_STORAGE_SPEC_BP_INT:
+            if (spec->bits != 64 || spec->is_unsigned)
+                MVM_exception_throw_adhoc(tc,
+                    "ChunkedArray: native integer elements must be signed 64-bit");
+            repr_data->slot_type = MVM_reg_int64;
+            break;
+        case MVM_STORAGE_SPEC_BP_NUM:
+            if (spec->bits != 64)
+                MVM_exception_throw_adhoc(tc,
+                    "ChunkedArray: native float elements must be 64-bit");
+            repr_data->slot_type = MVM_reg_num64;
+            break;
+        case MVM_STORAGE_SPEC_BP_STR:
+            repr_data->slot_type = MVM_reg_str;
+            break;
+        default:
+            repr_data->slot_type = MVM_reg_obj;
+            break;
+    }
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
+    MVMStringConsts                str_consts = tc->instance->str_consts;
+    MVMChunkedArrayREPRData * const repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+
+    MVMObject *info = MVM_repr_at_key_o(tc, info_hash, str_consts.array);
+    if (!MVM_is_null(tc, info)) {
+        MVMObject *type = MVM_repr_at_key_o(tc, info, str_consts.type);
+        if (!MVM_is_null(tc, type)) {
+            const MVMStorageSpec *spec = REPR(type)->get_storage_spec(tc, STABLE(type));
+            spec_to_repr_data(tc, repr_data, spec);
+            MVM_ASSIGN_REF(tc, &(st->header), repr_data->elem_type, type);
+        }
+    }
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMChunkedArray);
+}
+
+/* Serializes the REPR data. */
+static void serialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationWriter *writer) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVM_serialization_write_ref(tc, writer, repr_data->elem_type);
+}
+
+/* Deserializes representation data. */
+static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)MVM_malloc(sizeof(MVMChunkedArrayREPRData));
+
+    MVMObject *type = MVM_serialization_read_ref(tc, reader);
+    MVM_ASSIGN_REF(tc, &(st->header), repr_data->elem_type, type);
+    repr_data->slot_type = MVM_reg_obj;
+    st->REPR_data = repr_data;
+
+    if (type) {
+        MVM_serialization_force_stable(tc, reader, STABLE(type));
+        spec_to_repr_data(tc, repr_data, REPR(type)->get_storage_spec(tc, STABLE(type)));
+    }
+}
+
+static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMSerializationReader *reader) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVMChunkedArrayBody     *body      = (MVMChunkedArrayBody *)data;
+    MVMuint64 i;
+
+    set_size_internal(tc, body, MVM_serialization_read_int(tc, reader));
+    for (i = 0; i < body->elems; i++) {
+        MVMRegister *slot = slot_at(body, i);
+        switch (repr_data->slot_type) {
+            case MVM_reg_obj:
+                MVM_ASSIGN_REF(tc, &(root->header), slot->o, MVM_serialization_read_ref(tc, reader));
+                break;
+            case MVM_reg_str:
+                MVM_ASSIGN_REF(tc, &(root->header), slot->s, MVM_serialization_read_str(tc, reader));
+                break;
+            case MVM_reg_int64:
+                slot->i64 = MVM_serialization_read_int(tc, reader);
+                break;
+            case MVM_reg_num64:
+                slot->n64 = MVM_serialization_read_num(tc, reader);
+                break;
+        }
+    }
+}
+
+static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVMChunkedArrayBody     *body      = (MVMChunkedArrayBody *)data;
+    MVMuint64 i;
+
+    MVM_serialization_write_int(tc, writer, body->elems);
+    for (i = 0; i < body->elems; i++) {
+        MVMRegister *slot = slot_at(body, i);
+        switch (repr_data->slot_type) {
+            case MVM_reg_obj:
+                MVM_serialization_write_ref(tc, writer, slot->o);
+                break;
+            case MVM_reg_str:
+                MVM_serialization_write_str(tc, writer, slot->s);
+                break;
+            case MVM_reg_int64:
+                MVM_serialization_write_int(tc, writer, slot->i64);
+                break;
+            case MVM_reg_num64:
+                MVM_serialization_write_num(tc, writer, slot->n64);
+                break;
+        }
+    }
+}
+
+/* Bytecode specialization for this REPR. */
+static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    switch (ins->info->opcode) {
+    case MVM_OP_create: {
+        /* A zeroed body is an empty array, so these can be fast-created. */
+        if (!(st->mode_flags & MVM_FINALIZE_TYPE) && st->pretenure_state != MVM_PRETENURE_YES) {
+            MVMSpeshOperand target   = ins->operands[0];
+            MVMSpeshOperand type     = ins->operands[1];
+            MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, target);
+
+            ins->info                = MVM_op_get_op(MVM_OP_sp_fastcreate);
+            ins->operands            = MVM_spesh_alloc(tc, g, 3 * sizeof(MVMSpeshOperand));
+            ins->operands[0]         = target;
+            ins->operands[1].lit_i16 = sizeof(MVMChunkedArray);
+            ins->operands[2].lit_i16 = MVM_spesh_add_spesh_slot(tc, g, (MVMCollectable *)st);
+            MVM_spesh_usages_delete_by_reg(tc, g, type, ins);
+
+            tgt_facts->flags |= MVM_SPESH_FACT_KNOWN_TYPE | MVM_SPESH_FACT_CONCRETE;
+            tgt_facts->type = st->WHAT;
+        }
+        break;
+    }
+    }
+}
+
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMChunkedArrayBody *body = (MVMChunkedArrayBody *)data;
+    return body->num_chunks * MVM_CHUNKED_ARRAY_CHUNK_SLOTS * sizeof(MVMRegister)
+        + body->alloc_chunks * sizeof(MVMRegister *);
+}
+
+static void describe_refs(MVMThreadContext *tc, MVMHeapSnapshotState *ss, MVMSTable *st, void *data) {
+    MVMChunkedArrayREPRData *repr_data = (MVMChunkedArrayREPRData *)st->REPR_data;
+    MVMChunkedArrayBody     *body      = (MVMChunkedArrayBody *)data;
+    MVMuint64 i;
+
+    if (repr_data->slot_type != MVM_reg_obj && repr_data->slot_type != MVM_reg_str)
+        return;
+
+    for (i = 0; i < body->elems; i++)
+        MVM_profile_heap_add_collectable_rel_idx(tc, ss,
+            (MVMCollectable *)slot_at(body, i)->o, i);
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMChunkedArray_initialize(MVMThreadContext *tc) {
+    return &ChunkedArray_this_repr;
+}
+
+static const MVMREPROps ChunkedArray_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    NULL, /* initialize */
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    {
+        at_pos,
+        bind_pos,
+        set_elems,
+        push,
+        pop,
+        unshift,
+        shift,
+        MVM_REPR_DEFAULT_SLICE,
+        MVM_REPR_DEFAULT_SPLICE,
+        MVM_REPR_DEFAULT_AT_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_BIND_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_DIMENSIONS,
+        MVM_REPR_DEFAULT_SET_DIMENSIONS,
+        get_elem_storage_spec,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC_MULTIDIM,
+        MVM_REPR_DEFAULT_POS_WRITE_BUF,
+        MVM_REPR_DEFAULT_POS_READ_BUF
+    },    /* pos_funcs */
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    elems,
+    get_storage_spec,
+    NULL, /* change_type */
+    serialize,
+    deserialize,
+    serialize_repr_data,
+    deserialize_repr_data,
+    deserialize_stable_size,
+    gc_mark,
+    gc_free,
+    NULL, /* gc_cleanup */
+    gc_mark_repr_data,
+    gc_free_repr_data,
+    compose,
+    spesh,
+    "ChunkedArray", /* name */
+    MVM_REPR_ID_ChunkedArray,
+    unmanaged_size,
+    describe_refs,
+};
@@ -0,0 +1,40 @@
+/* Representation used for very large VM-level arrays. Rather than a single
+ * slot block, as VMArray has, the elements live in fixed-size chunks that
+ * are reached through a table of chunk pointers. Growing the array only
+ * allocates new chunks and, now and then, a bigger chunk table, so existing
+ * elements are never copied; shrinking it frees the chunks it no longer
+ * needs one at a time. Elements are full registers, so the element type is
+ * an object, a string, or a 64-bit integer or float. */
+struct MVMChunkedArrayBody {
+    /* number of elements (from user's point of view) */
+    MVMuint64     elems;
+
+    /* slot index of first element in the first chunk */
+    MVMuint64     start;
+
+    /* the chunk table, the number of chunks allocated, and the number of
+     * chunk pointers the table has room for. Slots outside of the elements
+     * are always zeroed. */
+    MVMRegister **chunks;
+    MVMuint64     num_chunks;
+    MVMuint64     alloc_chunks;
+};
+struct MVMChunkedArray {
+    MVMObject common;
+    MVMChunkedArrayBody body;
+};
+
+/* The number of slots in each chunk. */
+#define MVM_CHUNKED_ARRAY_CHUNK_SHIFT   12
+#define MVM_CHUNKED_ARRAY_CHUNK_SLOTS   (1 << MVM_CHUNKED_ARRAY_CHUNK_SHIFT)
+#define MVM_CHUNKED_ARRAY_CHUNK_MASK    (MVM_CHUNKED_ARRAY_CHUNK_SLOTS - 1)
+
+/* The element type, as a register kind, and the type object it was composed
+ * with, if any. */
+struct MVMChunkedArrayREPRData {
+    MVMuint16  slot_type;
+    MVMObject *elem_type;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMChunkedArray_initialize(MVMThreadContext *tc);
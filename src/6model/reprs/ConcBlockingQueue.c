@@ -3,6 +3,27 @@
 /* This representation's function pointer table. */
 static const MVMREPROps ConcBlockingQueue_this_repr;
 
+/* Takes one of the queue's locks, marking the thread blocked while waiting
+ * for it. The acquisition is counted when profiling lock contention. */
+static void lock_queue(MVMThreadContext *tc, uv_mutex_t *lock) {
+    MVMuint64 wait_start = 0;
+    MVMuint32 contended  = 0;
+    MVM_gc_mark_thread_blocked(tc);
+    if (tc->instance->lock_profiling && uv_mutex_trylock(lock) != 0) {
+        wait_start = uv_hrtime();
+        contended  = 1;
+        uv_mutex_lock(lock);
+    }
+    else if (!tc->instance->lock_profiling) {
+        uv_mutex_lock(lock);
+    }
+    MVM_gc_mark_thread_unblocked(tc);
+    if (tc->instance->lock_profiling)
+        MVM_lock_contention_log(tc, lock, "ConcBlockingQueue",
+            tc->cur_frame ? tc->cur_frame->static_info : NULL,
+            contended ? uv_hrtime() - wait_start : 0, contended);
+}
+
 /* Creates a new type object of this representation, and associates it with
  * the given HOW. */
 static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
@@ -50,10 +71,13 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
      * traversal of the data structure without needing locks. */
     MVMConcBlockingQueueBody *cbq = *(MVMConcBlockingQueueBody **)data;
     MVMConcBlockingQueueNode *cur = cbq->head;
+    size_t i;
     while (cur) {
         MVM_gc_worklist_add(tc, worklist, &cur->value);
         cur = cur->next;
     }
+    for (i = cbq->fiber_waiters_head; i < MVM_VECTOR_ELEMS(cbq->fiber_waiters); i++)
+        MVM_gc_worklist_add(tc, worklist, &cbq->fiber_waiters[i]);
 }
 
 static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
@@ -80,6 +104,7 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     uv_mutex_destroy(&body->head_lock);
     uv_mutex_destroy(&body->tail_lock);
     uv_cond_destroy(&body->head_cond);
+    MVM_VECTOR_DESTROY(body->fiber_waiters);
 
     /* Clean up body */
     MVM_fixed_size_free(tc, tc->instance->fsa, sizeof(MVMConcBlockingQueueBody), body);
@@ -119,9 +144,7 @@ static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *d
         unsigned int interval_id;
         interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.at_pos");
         MVMROOT(tc, root, {
-            MVM_gc_mark_thread_blocked(tc);
-            uv_mutex_lock(&body->head_lock);
-            MVM_gc_mark_thread_unblocked(tc);
+            lock_queue(tc, &body->head_lock);
         });
         peeked = body->head->next;
         value->o = peeked ? peeked->value : tc->instance->VMNull;
@@ -138,6 +161,43 @@ static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, voi
     return MVM_load(&(cbq->elems));
 }
 
+/* Takes the value at the head of the queue, which must not be empty. Called
+ * with the head lock held. */
+static MVMObject * take_head(MVMThreadContext *tc, MVMConcBlockingQueueBody *body) {
+    MVMConcBlockingQueueNode *taken = body->head->next;
+    MVMObject *value;
+    MVM_fixed_size_free(tc, tc->instance->fsa, sizeof(MVMConcBlockingQueueNode), body->head);
+    body->head = taken;
+    MVM_barrier();
+    value = taken->value;
+    taken->value = NULL;
+    MVM_barrier();
+    MVM_decr(&body->elems);
+    return value;
+}
+
+/* Hands values to any suspended fibers waiting for them, oldest first.
+ * Called after adding to the queue. */
+static void wake_fibers(MVMThreadContext *tc, MVMObject *root, MVMConcBlockingQueueBody *body) {
+    if (!MVM_load(&body->num_fiber_waiters))
+        return;
+    MVMROOT(tc, root, {
+        lock_queue(tc, &body->head_lock);
+        while (MVM_load(&body->elems) > 0
+                && body->fiber_waiters_head < MVM_VECTOR_ELEMS(body->fiber_waiters)) {
+            MVMObject *cont  = body->fiber_waiters[body->fiber_waiters_head++];
+            MVMObject *value = take_head(tc, body);
+            MVM_decr(&body->num_fiber_waiters);
+            MVM_fiber_wake(tc, cont, value);
+        }
+        if (body->fiber_waiters_head == MVM_VECTOR_ELEMS(body->fiber_waiters)) {
+            body->fiber_waiters_head = 0;
+            MVM_VECTOR_CLEAR(body->fiber_waiters);
+        }
+        uv_mutex_unlock(&body->head_lock);
+    });
+}
+
 static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind) {
     MVMConcBlockingQueueBody *body = *(MVMConcBlockingQueueBody**)data;
     MVMConcBlockingQueueNode *add;
@@ -156,9 +216,7 @@ static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *dat
 
     interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.push");
     MVMROOT2(tc, root, to_add, {
-        MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&body->tail_lock);
-        MVM_gc_mark_thread_unblocked(tc);
+        lock_queue(tc, &body->tail_lock);
     });
     MVM_ASSIGN_REF(tc, &(root->header), add->value, to_add);
     body->tail->next = add;
@@ -168,13 +226,12 @@ static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *dat
 
     if (orig_elems == 0) {
         MVMROOT(tc, root, {
-            MVM_gc_mark_thread_blocked(tc);
-            uv_mutex_lock(&body->head_lock);
-            MVM_gc_mark_thread_unblocked(tc);
+            lock_queue(tc, &body->head_lock);
         });
         uv_cond_signal(&body->head_cond);
         uv_mutex_unlock(&body->head_lock);
     }
+    wake_fibers(tc, root, body);
     MVM_telemetry_interval_annotate(orig_elems, interval_id, "this many items in it");
     MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.push");
 }
@@ -202,10 +259,8 @@ static void unshift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
      * and push would update tail->next - without the tail lock, this could
      * race. Ensure that we lock in the same order */
     MVMROOT2(tc, root, to_add, {
-        MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&cbq->tail_lock);
-        uv_mutex_lock(&cbq->head_lock);
-        MVM_gc_mark_thread_unblocked(tc);
+        lock_queue(tc, &cbq->tail_lock);
+        lock_queue(tc, &cbq->head_lock);
     });
 
     MVM_ASSIGN_REF(tc, &(root->header), add->value, to_add);
@@ -222,6 +277,7 @@ static void unshift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
     uv_mutex_unlock(&cbq->head_lock);
     uv_mutex_unlock(&cbq->tail_lock);
 
+    wake_fibers(tc, root, cbq);
     MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.unshift");
 }
 
@@ -236,9 +292,7 @@ static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *da
 
     interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.shift");
     MVMROOT(tc, root, {
-        MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&body->head_lock);
-        MVM_gc_mark_thread_unblocked(tc);
+        lock_queue(tc, &body->head_lock);
 
         while (MVM_load(&body->elems) == 0) {
                 MVM_gc_mark_thread_blocked(tc);
@@ -324,9 +378,11 @@ static const MVMREPROps ConcBlockingQueue_this_repr = {
 MVMObject * MVM_concblockingqueue_jit_poll(MVMThreadContext *tc, MVMObject *queue) {
     if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue))
         return MVM_concblockingqueue_poll(tc, (MVMConcBlockingQueue *)queue);
+    else if (REPR(queue)->ID == MVM_REPR_ID_ConcRingQueue && IS_CONCRETE(queue))
+        return MVM_concringqueue_poll(tc, (MVMConcRingQueue *)queue);
     else
         MVM_exception_throw_adhoc(tc,
-                "queuepoll requires a concrete object with REPR ConcBlockingQueue");
+                "queuepoll requires a concrete object with REPR ConcBlockingQueue or ConcRingQueue");
 }
 
 /* Polls a queue for a value, returning NULL if none is available. */
@@ -339,9 +395,7 @@ MVMObject * MVM_concblockingqueue_poll(MVMThreadContext *tc, MVMConcBlockingQueu
 
     interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.poll");
     MVMROOT(tc, cbq, { /* No need to root result as VMNull is always in gen2 */
-        MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&body->head_lock);
-        MVM_gc_mark_thread_unblocked(tc);
+        lock_queue(tc, &body->head_lock);
     });
 
     if (MVM_load(&body->elems) > 0) {
@@ -361,3 +415,87 @@ MVMObject * MVM_concblockingqueue_poll(MVMThreadContext *tc, MVMConcBlockingQueu
     MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.poll");
     return result;
 }
+
+/* Pushes all the values in an array onto the queue, taking the tail lock and
+ * waking a waiting thread at most once for the whole batch. */
+void MVM_concblockingqueue_push_batch(MVMThreadContext *tc, MVMObject *queue, MVMObject *values) {
+    MVMConcBlockingQueueBody *body = ((MVMConcBlockingQueue *)queue)->body;
+    MVMConcBlockingQueueNode *first = NULL;
+    MVMConcBlockingQueueNode *last  = NULL;
+    MVMint64 count = MVM_repr_elems(tc, values);
+    MVMint64 i;
+    AO_t orig_elems;
+    unsigned int interval_id;
+
+    if (count == 0)
+        return;
+    for (i = 0; i < count; i++)
+        if (MVM_is_null(tc, MVM_repr_at_pos_o(tc, values, i)))
+            MVM_exception_throw_adhoc(tc,
+                "Cannot store a null value in a concurrent blocking queue");
+
+    /* Make the chain of nodes up front, so the lock is held only to link
+     * it in. */
+    for (i = 0; i < count; i++) {
+        MVMConcBlockingQueueNode *add = MVM_fixed_size_alloc_zeroed(tc,
+            tc->instance->fsa, sizeof(MVMConcBlockingQueueNode));
+        if (last)
+            last->next = add;
+        else
+            first = add;
+        last = add;
+    }
+
+    interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.push_batch");
+    MVMROOT2(tc, queue, values, {
+        lock_queue(tc, &body->tail_lock);
+    });
+    {
+        MVMConcBlockingQueueNode *node = first;
+        for (i = 0; i < count; i++, node = node->next)
+            MVM_ASSIGN_REF(tc, &(queue->header), node->value,
+                MVM_repr_at_pos_o(tc, values, i));
+    }
+    body->tail->next = first;
+    body->tail = last;
+    orig_elems = AO_fetch_and_add_full(&body->elems, (AO_t)count);
+    uv_mutex_unlock(&body->tail_lock);
+
+    if (orig_elems == 0) {
+        MVMROOT(tc, queue, {
+            lock_queue(tc, &body->head_lock);
+        });
+        uv_cond_signal(&body->head_cond);
+        uv_mutex_unlock(&body->head_lock);
+    }
+    wake_fibers(tc, queue, body);
+    MVM_telemetry_interval_annotate(count, interval_id, "this many items pushed");
+    MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.push_batch");
+}
+
+/* Queues up a suspended fiber to be woken with the next value pushed, unless
+ * a value arrived in the meantime, in which case it is taken into the result
+ * register and zero is returned. The fiber is counted as waiting before the
+ * queue is checked, and pushers check the count after adding to the queue,
+ * so one of the two always sees the other. */
+MVMint32 MVM_concblockingqueue_fiber_wait(MVMThreadContext *tc, MVMObject *queue, MVMObject *cont, MVMRegister *res_reg) {
+    MVMConcBlockingQueueBody *body = ((MVMConcBlockingQueue *)queue)->body;
+    MVMint32 suspended;
+
+    MVM_incr(&body->num_fiber_waiters);
+    MVMROOT2(tc, queue, cont, {
+        lock_queue(tc, &body->head_lock);
+    });
+    if (MVM_load(&body->elems) > 0) {
+        res_reg->o = take_head(tc, body);
+        MVM_decr(&body->num_fiber_waiters);
+        suspended = 0;
+    }
+    else {
+        MVM_VECTOR_PUSH(body->fiber_waiters, cont);
+        MVM_gc_write_barrier(tc, (MVMCollectable *)queue, (MVMCollectable *)cont);
+        suspended = 1;
+    }
+    uv_mutex_unlock(&body->head_lock);
+    return suspended;
+}
@@ -22,6 +22,13 @@ struct MVMConcBlockingQueueBody {
     uv_mutex_t  head_lock;
     uv_mutex_t  tail_lock;
     uv_cond_t   head_cond;
+
+    /* Suspended fibers waiting for a value, oldest first from the head index
+     * on, protected by the head lock; and how many fibers are waiting or
+     * about to, which pushers check without the lock. */
+    MVM_VECTOR_DECL(MVMObject *, fiber_waiters);
+    size_t fiber_waiters_head;
+    AO_t   num_fiber_waiters;
 };
 
 struct MVMConcBlockingQueue {
@@ -35,6 +42,8 @@ const MVMREPROps * MVMConcBlockingQueue_initialize(MVMThreadContext *tc);
 
 /* Operations on concurrent blocking queues. */
 MVMObject * MVM_concblockingqueue_poll(MVMThreadContext *tc, MVMConcBlockingQueue *queue);
+void MVM_concblockingqueue_push_batch(MVMThreadContext *tc, MVMObject *queue, MVMObject *values);
+MVMint32 MVM_concblockingqueue_fiber_wait(MVMThreadContext *tc, MVMObject *queue, MVMObject *cont, MVMRegister *res_reg);
 
 /* Purely for the convenience of the jit */
 MVMObject * MVM_concblockingqueue_jit_poll(MVMThreadContext *tc, MVMObject *queue);
@@ -0,0 +1,325 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps ConcHash_this_repr;
+
+MVM_STATIC_INLINE MVMString * get_string_key(MVMThreadContext *tc, MVMObject *key) {
+    if (MVM_UNLIKELY(!key || REPR(key)->ID != MVM_REPR_ID_MVMString || !IS_CONCRETE(key)))
+        MVM_exception_throw_adhoc(tc, "ConcHash representation requires MVMString keys");
+    return (MVMString *)key;
+}
+
+/* Allocates an empty table with the given number of slots. */
+static MVMConcHashTable * allocate_table(MVMuint32 num_slots) {
+    MVMConcHashTable *table = MVM_calloc(1,
+        sizeof(MVMConcHashTable) + num_slots * sizeof(MVMConcHashSlot));
+    table->num_slots = num_slots;
+    table->slots     = (MVMConcHashSlot *)(table + 1);
+    return table;
+}
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st  = MVM_gc_allocate_stable(tc, &ConcHash_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMConcHash);
+    });
+
+    return st->WHAT;
+}
+
+/* Initializes a new instance. */
+static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMConcHashBody *body = MVM_calloc(1, sizeof(MVMConcHashBody));
+    MVMuint32 i;
+    for (i = 0; i < MVM_CONC_HASH_STRIPES; i++) {
+        int init_stat;
+        if ((init_stat = uv_mutex_init(&body->stripes[i])) < 0)
+            MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
+                uv_strerror(init_stat));
+    }
+    body->table = allocate_table(MVM_CONC_HASH_MIN_SLOTS);
+    ((MVMConcHash *)root)->body = body;
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVM_exception_throw_adhoc(tc, "Cannot copy object with representation ConcHash");
+}
+
+/* Called by the VM to mark any GCable items. */
+static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
+    /* At this point we know the world is stopped, and thus we can safely do a
+     * traversal of the table without needing locks. Keys of deleted entries
+     * are marked too, as they still hold their slots. */
+    MVMConcHashBody *body = *(MVMConcHashBody **)data;
+    if (body) {
+        MVMConcHashTable *table = body->table;
+        MVMuint32 i;
+        for (i = 0; i < table->num_slots; i++) {
+            MVM_gc_worklist_add(tc, worklist, &(table->slots[i].key));
+            MVM_gc_worklist_add(tc, worklist, &(table->slots[i].value));
+        }
+    }
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMConcHashBody *body = ((MVMConcHash *)obj)->body;
+    if (body) {
+        MVMuint32 i;
+        for (i = 0; i < MVM_CONC_HASH_STRIPES; i++)
+            uv_mutex_destroy(&body->stripes[i]);
+        MVM_free(body->table);
+        MVM_free(body);
+    }
+}
+
+/* Finds the slot holding the key in the table or, failing that, the free
+ * slot where it would go. Returns NULL if the probe runs the length of the
+ * table without finding either. */
+static MVMConcHashSlot * find_slot(MVMThreadContext *tc, MVMConcHashTable *table,
+        MVMString *key, MVMuint64 hash) {
+    MVMuint32 mask = table->num_slots - 1;
+    MVMuint32 i    = (MVMuint32)hash & mask;
+    MVMuint32 probes;
+    for (probes = 0; probes < table->num_slots; probes++) {
+        MVMConcHashSlot *slot = &(table->slots[i]);
+        MVMString       *k    = (MVMString *)MVM_load(&(slot->key));
+        if (!k || k == key || MVM_string_equal(tc, k, key))
+            return slot;
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+/* Looks up the value for a key without taking any locks; NULL if there is
+ * none. */
+static MVMObject * lookup(MVMThreadContext *tc, MVMConcHashBody *body, MVMString *key) {
+    MVMConcHashTable *table = (MVMConcHashTable *)MVM_load(&(body->table));
+    MVMConcHashSlot  *slot  = find_slot(tc, table, key, MVM_string_hash_code(tc, key));
+    return slot && MVM_load(&(slot->key)) ? (MVMObject *)MVM_load(&(slot->value)) : NULL;
+}
+
+/* Takes a stripe lock, noting the thread as blocked while waiting for it, so
+ * that GC can go ahead meanwhile. */
+static void lock_stripe(MVMThreadContext *tc, uv_mutex_t *stripe) {
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(stripe);
+    MVM_gc_mark_thread_unblocked(tc);
+}
+
+/* Rebuilds the table with room to grow, unless somebody else already did it
+ * since we saw it was full. The caller must root anything it holds, as GC may
+ * run while we wait for the locks. */
+static void grow(MVMThreadContext *tc, MVMConcHashBody *body, MVMConcHashTable *full) {
+    MVMConcHashTable *old;
+    MVMuint32 i;
+    for (i = 0; i < MVM_CONC_HASH_STRIPES; i++)
+        lock_stripe(tc, &(body->stripes[i]));
+    old = body->table;
+    if (old == full) {
+        /* Size the new table so that the live entries fill at most three
+         * eighths of it; nobody else can be writing, so we needn't take care
+         * filling it in. */
+        MVMuint32         live      = (MVMuint32)MVM_load(&(body->elems));
+        MVMuint32         num_slots = MVM_CONC_HASH_MIN_SLOTS;
+        MVMConcHashTable *table;
+        while (num_slots * 3 < (live + 1) * 8)
+            num_slots *= 2;
+        table = allocate_table(num_slots);
+        for (i = 0; i < old->num_slots; i++) {
+            MVMConcHashSlot *slot = &(old->slots[i]);
+            if (slot->key && slot->value) {
+                MVMuint32 mask = num_slots - 1;
+                MVMuint32 j    = (MVMuint32)MVM_string_hash_code(tc, slot->key) & mask;
+                while (table->slots[j].key)
+                    j = (j + 1) & mask;
+                table->slots[j] = *slot;
+                table->used++;
+            }
+        }
+        MVM_barrier();
+        MVM_store(&(body->table), table);
+
+        /* Readers may still be looking at the old table, but none can be by
+         * the next safepoint. */
+        uv_mutex_lock(&(tc->instance->mutex_free_at_safepoint));
+        MVM_free_at_safepoint(tc, old);
+        uv_mutex_unlock(&(tc->instance->mutex_free_at_safepoint));
+    }
+    for (i = 0; i < MVM_CONC_HASH_STRIPES; i++)
+        uv_mutex_unlock(&(body->stripes[i]));
+}
+
+static void at_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister *result, MVMuint16 kind) {
+    MVMConcHashBody *body  = *(MVMConcHashBody **)data;
+    MVMObject       *value;
+    if (MVM_UNLIKELY(kind != MVM_reg_obj))
+        MVM_exception_throw_adhoc(tc,
+            "ConcHash representation does not support native type storage");
+    value     = lookup(tc, body, get_string_key(tc, key_obj));
+    result->o = value ? value : tc->instance->VMNull;
+}
+
+static void bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister value, MVMuint16 kind) {
+    MVMConcHashBody *body    = *(MVMConcHashBody **)data;
+    MVMString       *key     = get_string_key(tc, key_obj);
+    MVMObject       *to_bind = value.o;
+    MVMuint64        hash;
+    uv_mutex_t      *stripe;
+
+    if (MVM_UNLIKELY(kind != MVM_reg_obj))
+        MVM_exception_throw_adhoc(tc,
+            "ConcHash representation does not support native type storage");
+    if (!to_bind)
+        MVM_exception_throw_adhoc(tc, "Cannot store a null value in a ConcHash");
+
+    hash   = MVM_string_hash_code(tc, key);
+    stripe = &(body->stripes[(hash >> 32) % MVM_CONC_HASH_STRIPES]);
+    while (1) {
+        MVMConcHashTable *table;
+        MVMConcHashSlot  *slot = NULL;
+        MVMROOT3(tc, root, key, to_bind, {
+            lock_stripe(tc, stripe);
+        });
+        table = body->table;
+        if (4 * (MVM_load(&(table->used)) + 1) <= 3 * table->num_slots)
+            slot = find_slot(tc, table, key, hash);
+        if (slot) {
+            if (!slot->key) {
+                /* Writers of other stripes may be after the same free slot;
+                 * if one got there first, look again. */
+                if (!MVM_trycas(&(slot->key), NULL, key)) {
+                    uv_mutex_unlock(stripe);
+                    continue;
+                }
+                MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+                MVM_incr(&(table->used));
+            }
+            MVM_gc_write_barrier(tc, &(root->header), &(to_bind->header));
+            if (!slot->value)
+                MVM_incr(&(body->elems));
+            MVM_store(&(slot->value), to_bind);
+            uv_mutex_unlock(stripe);
+            return;
+        }
+        uv_mutex_unlock(stripe);
+        MVMROOT3(tc, root, key, to_bind, {
+            grow(tc, body, table);
+        });
+    }
+}
+
+static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMConcHashBody *body = *(MVMConcHashBody **)data;
+    return MVM_load(&(body->elems));
+}
+
+static MVMint64 exists_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
+    MVMConcHashBody *body = *(MVMConcHashBody **)data;
+    return lookup(tc, body, get_string_key(tc, key_obj)) != NULL;
+}
+
+static void delete_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
+    MVMConcHashBody *body = *(MVMConcHashBody **)data;
+    MVMString       *key  = get_string_key(tc, key_obj);
+    MVMuint64        hash = MVM_string_hash_code(tc, key);
+    uv_mutex_t      *stripe = &(body->stripes[(hash >> 32) % MVM_CONC_HASH_STRIPES]);
+    MVMConcHashSlot *slot;
+    MVMROOT(tc, key, {
+        lock_stripe(tc, stripe);
+    });
+    slot = find_slot(tc, body->table, key, hash);
+    if (slot && slot->key && slot->value) {
+        MVM_store(&(slot->value), NULL);
+        MVM_decr(&(body->elems));
+    }
+    uv_mutex_unlock(stripe);
+}
+
+static MVMStorageSpec get_value_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    MVMStorageSpec spec;
+    spec.inlineable      = MVM_STORAGE_SPEC_REFERENCE;
+    spec.boxed_primitive = MVM_STORAGE_SPEC_BP_NONE;
+    spec.can_box         = 0;
+    spec.bits            = 0;
+    spec.align           = 0;
+    spec.is_unsigned     = 0;
+    return spec;
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
+    /* Nothing to do for this REPR. */
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMConcHash);
+}
+
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMConcHashBody *body = *(MVMConcHashBody **)data;
+    return sizeof(MVMConcHashBody) + sizeof(MVMConcHashTable)
+        + body->table->num_slots * sizeof(MVMConcHashSlot);
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMConcHash_initialize(MVMThreadContext *tc) {
+    return &ConcHash_this_repr;
+}
+
+static const MVMREPROps ConcHash_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    initialize,
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    MVM_REPR_DEFAULT_POS_FUNCS,
+    {
+        at_key,
+        bind_key,
+        exists_key,
+        delete_key,
+        get_value_storage_spec
+    },    /* ass_funcs */
+    elems,
+    get_storage_spec,
+    NULL, /* change_type */
+    NULL, /* serialize */
+    NULL, /* deserialize */
+    NULL, /* serialize_repr_data */
+    NULL, /* deserialize_repr_data */
+    deserialize_stable_size,
+    gc_mark,
+    gc_free,
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    NULL, /* gc_free_repr_data */
+    compose,
+    NULL, /* spesh */
+    "ConcHash", /* name */
+    MVM_REPR_ID_ConcHash,
+    unmanaged_size,
+    NULL, /* describe_refs */
+};
@@ -0,0 +1,51 @@
+/* Representation used for a concurrent hash, for caches shared between
+ * threads. Reads take no locks at all; writes take one of a number of stripe
+ * locks, picked by the key's hash, so that writes of different keys mostly
+ * go ahead in parallel. Slots are claimed with a compare and swap on the key,
+ * and a key keeps its slot until the table is rebuilt, deletion just clearing
+ * the value. Growing takes all of the stripe locks, rebuilds the table with
+ * only the live entries, and frees the old one at the next GC safepoint, by
+ * which time no reader can still be looking at it.
+ *
+ * As with the concurrent blocking queue, the object holds a pointer to the
+ * body, which is allocated by malloc() so that its locks never move. */
+
+#define MVM_CONC_HASH_STRIPES   16
+#define MVM_CONC_HASH_MIN_SLOTS 16
+
+struct MVMConcHashSlot {
+    /* NULL if the slot was never claimed. */
+    MVMString *key;
+
+    /* NULL if the key isn't (or isn't yet, or is no longer) in the hash. */
+    MVMObject *value;
+};
+
+struct MVMConcHashTable {
+    /* The number of slots, a power of two, and the number claimed. */
+    MVMuint32 num_slots;
+    AO_t      used;
+
+    /* The slots, allocated right after the table. */
+    MVMConcHashSlot *slots;
+};
+
+struct MVMConcHashBody {
+    /* The current table. */
+    MVMConcHashTable *table;
+
+    /* Number of keys in the hash. */
+    AO_t elems;
+
+    /* Locks taken for writing. */
+    uv_mutex_t stripes[MVM_CONC_HASH_STRIPES];
+};
+
+struct MVMConcHash {
+    MVMObject common;
+    /* As noted, a pointer, not an inline struct */
+    MVMConcHashBody *body;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMConcHash_initialize(MVMThreadContext *tc);
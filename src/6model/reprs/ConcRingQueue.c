@@ -0,0 +1,464 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps ConcRingQueue_this_repr;
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st  = MVM_gc_allocate_stable(tc, &ConcRingQueue_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVMConcRingQueueREPRData *repr_data = MVM_malloc(sizeof(MVMConcRingQueueREPRData));
+        repr_data->capacity = MVM_CONC_RING_QUEUE_DEFAULT_CAPACITY;
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMConcRingQueue);
+        st->REPR_data = repr_data;
+    });
+
+    return st->WHAT;
+}
+
+/* Initializes a new instance. */
+static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMConcRingQueueREPRData *repr_data = (MVMConcRingQueueREPRData *)st->REPR_data;
+    MVMConcRingQueueBody     *body      = MVM_calloc(1, sizeof(MVMConcRingQueueBody));
+    MVMuint64 capacity = repr_data->capacity;
+    MVMuint64 i;
+    int init_stat;
+
+    if ((init_stat = uv_mutex_init(&body->park_lock)) < 0)
+        MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
+            uv_strerror(init_stat));
+    if ((init_stat = uv_cond_init(&body->not_empty)) < 0)
+        MVM_exception_throw_adhoc(tc, "Failed to initialize condition variable: %s",
+            uv_strerror(init_stat));
+    if ((init_stat = uv_cond_init(&body->not_full)) < 0)
+        MVM_exception_throw_adhoc(tc, "Failed to initialize condition variable: %s",
+            uv_strerror(init_stat));
+
+    body->cells = MVM_calloc(capacity, sizeof(MVMConcRingQueueCell));
+    body->mask  = capacity - 1;
+    for (i = 0; i < capacity; i++)
+        body->cells[i].sequence = (AO_t)i;
+    ((MVMConcRingQueue *)root)->body = body;
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVM_exception_throw_adhoc(tc, "Cannot copy object with representation ConcRingQueue");
+}
+
+/* Called by the VM to mark any GCable items. The world is stopped, and no
+ * thread is ever part way through filling a slot at a GC safepoint, so it is
+ * enough to mark every slot; empty ones are NULL. */
+static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+    MVMuint64 i;
+    if (!body)
+        return;
+    for (i = 0; i <= body->mask; i++)
+        MVM_gc_worklist_add(tc, worklist, &body->cells[i].value);
+}
+
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+    return sizeof(MVMConcRingQueueBody) + (body->mask + 1) * sizeof(MVMConcRingQueueCell);
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMConcRingQueueBody *body = ((MVMConcRingQueue *)obj)->body;
+    if (!body)
+        return;
+    uv_mutex_destroy(&body->park_lock);
+    uv_cond_destroy(&body->not_empty);
+    uv_cond_destroy(&body->not_full);
+    MVM_free(body->cells);
+    MVM_free(body);
+}
+
+/* Frees the REPR data. */
+static void gc_free_repr_data(MVMThreadContext *tc, MVMSTable *st) {
+    MVM_free(st->REPR_data);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Compose the representation, taking the capacity from the "queue" entry of
+ * the info hash. It is rounded up to a power of 2. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
+    MVMStringConsts           str_consts = tc->instance->str_consts;
+    MVMConcRingQueueREPRData *repr_data  = (MVMConcRingQueueREPRData *)st->REPR_data;
+
+    MVMObject *info = MVM_repr_at_key_o(tc, info_hash, str_consts.queue);
+    if (!MVM_is_null(tc, info)) {
+        MVMObject *capacity_obj = MVM_repr_at_key_o(tc, info, str_consts.capacity);
+        if (!MVM_is_null(tc, capacity_obj)) {
+            MVMint64  wanted   = MVM_repr_get_int(tc, capacity_obj);
+            MVMuint64 capacity = 2;
+            if (wanted < 1 || wanted > (1LL << 32))
+                MVM_exception_throw_adhoc(tc,
+                    "ConcRingQueue capacity must be between 1 and 2**32, got %"PRIi64, wanted);
+            while (capacity < (MVMuint64)wanted)
+                capacity *= 2;
+            repr_data->capacity = capacity;
+        }
+    }
+}
+
+/* Tries to push a value, returning zero if the queue is full. */
+static int try_push(MVMThreadContext *tc, MVMObject *root, MVMConcRingQueueBody *body, MVMObject *value) {
+    MVMConcRingQueueCell *cell;
+    AO_t pos = MVM_load(&body->enqueue_pos);
+    for (;;) {
+        AO_t seq;
+        cell = &body->cells[pos & body->mask];
+        seq  = MVM_load(&cell->sequence);
+        if (seq == pos) {
+            if (MVM_trycas(&body->enqueue_pos, pos, pos + 1))
+                break;
+            pos = MVM_load(&body->enqueue_pos);
+        }
+        else if ((intptr_t)(seq - pos) < 0) {
+            return 0;
+        }
+        else {
+            pos = MVM_load(&body->enqueue_pos);
+        }
+    }
+    MVM_ASSIGN_REF(tc, &(root->header), cell->value, value);
+    MVM_store(&cell->sequence, pos + 1);
+    return 1;
+}
+
+/* Tries to shift a value, returning NULL if the queue is empty. */
+static MVMObject * try_shift(MVMThreadContext *tc, MVMConcRingQueueBody *body) {
+    MVMConcRingQueueCell *cell;
+    MVMObject *value;
+    AO_t pos = MVM_load(&body->dequeue_pos);
+    for (;;) {
+        AO_t seq;
+        cell = &body->cells[pos & body->mask];
+        seq  = MVM_load(&cell->sequence);
+        if (seq == pos + 1) {
+            if (MVM_trycas(&body->dequeue_pos, pos, pos + 1))
+                break;
+            pos = MVM_load(&body->dequeue_pos);
+        }
+        else if ((intptr_t)(seq - (pos + 1)) < 0) {
+            return NULL;
+        }
+        else {
+            pos = MVM_load(&body->dequeue_pos);
+        }
+    }
+    value = cell->value;
+    cell->value = NULL;
+    MVM_store(&cell->sequence, pos + body->mask + 1);
+    return value;
+}
+
+/* Whether a shift or a push would currently find nothing to do. These are
+ * only used to decide whether to park, under the park lock. */
+static int is_empty(MVMConcRingQueueBody *body) {
+    AO_t pos = MVM_load(&body->dequeue_pos);
+    return (intptr_t)(MVM_load(&body->cells[pos & body->mask].sequence) - (pos + 1)) < 0;
+}
+static int is_full(MVMConcRingQueueBody *body) {
+    AO_t pos = MVM_load(&body->enqueue_pos);
+    return (intptr_t)(MVM_load(&body->cells[pos & body->mask].sequence) - pos) < 0;
+}
+
+/* Wakes parked threads, if there are any. The waiter counts are bumped under
+ * the park lock before a waiter checks the queue for the last time, and we
+ * check the count after our push or shift is visible, so a waiter either sees
+ * our change or we see it waiting. */
+static void wake(MVMThreadContext *tc, MVMObject *root, MVMConcRingQueueBody *body,
+                 AO_t *waiting, uv_cond_t *cond, int all) {
+    MVM_barrier();
+    if (MVM_load(waiting)) {
+        MVMROOT(tc, root, {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_mutex_lock(&body->park_lock);
+            MVM_gc_mark_thread_unblocked(tc);
+        });
+        if (all)
+            uv_cond_broadcast(cond);
+        else
+            uv_cond_signal(cond);
+        uv_mutex_unlock(&body->park_lock);
+    }
+}
+
+/* Parks until the queue looks non-empty (to shift) or non-full (to push). */
+static void park(MVMThreadContext *tc, MVMObject *root, MVMConcRingQueueBody *body,
+                 AO_t *waiting, uv_cond_t *cond, int (*blocked)(MVMConcRingQueueBody *)) {
+    MVMROOT(tc, root, {
+        MVM_gc_mark_thread_blocked(tc);
+        uv_mutex_lock(&body->park_lock);
+        MVM_gc_mark_thread_unblocked(tc);
+        MVM_incr(waiting);
+        while (blocked(body)) {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_cond_wait(cond, &body->park_lock);
+            MVM_gc_mark_thread_unblocked(tc);
+        }
+        MVM_decr(waiting);
+        uv_mutex_unlock(&body->park_lock);
+    });
+}
+
+/* Pushes a value, parking while the queue is full. */
+static void push_value(MVMThreadContext *tc, MVMObject *root, MVMConcRingQueueBody *body, MVMObject *value) {
+    while (!try_push(tc, root, body, value)) {
+        MVMROOT2(tc, root, value, {
+            park(tc, root, body, &body->waiting_producers, &body->not_full, is_full);
+        });
+    }
+}
+
+static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+    AO_t pos;
+    MVMConcRingQueueCell *cell;
+
+    if (index != 0)
+        MVM_exception_throw_adhoc(tc,
+            "Can only request (peek) head of a concurrent ring queue");
+    if (kind != MVM_reg_obj)
+        MVM_exception_throw_adhoc(tc,
+            "Can only get objects from a concurrent ring queue");
+
+    /* As with ConcBlockingQueue, a peek may be out of date by the time it is
+     * looked at. */
+    pos  = MVM_load(&body->dequeue_pos);
+    cell = &body->cells[pos & body->mask];
+    value->o = tc->instance->VMNull;
+    if (MVM_load(&cell->sequence) == pos + 1) {
+        MVMObject *peeked = cell->value;
+        if (peeked)
+            value->o = peeked;
+    }
+}
+
+static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+    AO_t deq = MVM_load(&body->dequeue_pos);
+    AO_t enq = MVM_load(&body->enqueue_pos);
+    intptr_t count = (intptr_t)(enq - deq);
+    if (count < 0)
+        return 0;
+    return (MVMuint64)count > body->mask + 1 ? body->mask + 1 : (MVMuint64)count;
+}
+
+static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+
+    if (kind != MVM_reg_obj)
+        MVM_exception_throw_adhoc(tc,
+            "Can only push objects to a concurrent ring queue");
+    if (value.o == NULL)
+        MVM_exception_throw_adhoc(tc,
+            "Cannot store a null value in a concurrent ring queue");
+
+    MVMROOT(tc, root, {
+        push_value(tc, root, body, value.o);
+    });
+    wake(tc, root, body, &body->waiting_consumers, &body->not_empty, 0);
+}
+
+static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister *value, MVMuint16 kind) {
+    MVMConcRingQueueBody *body = *(MVMConcRingQueueBody **)data;
+    MVMObject *taken;
+
+    if (kind != MVM_reg_obj)
+        MVM_exception_throw_adhoc(tc, "Can only shift objects from a ConcRingQueue");
+
+    MVMROOT(tc, root, {
+        while (!(taken = try_shift(tc, body)))
+            park(tc, root, body, &body->waiting_consumers, &body->not_empty, is_empty);
+    });
+    value->o = taken;
+
+    MVMROOT(tc, taken, {
+        wake(tc, root, body, &body->waiting_producers, &body->not_full, 0);
+    });
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMConcRingQueue);
+}
+
+/* Serializes the REPR data. */
+static void serialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationWriter *writer) {
+    MVMConcRingQueueREPRData *repr_data = (MVMConcRingQueueREPRData *)st->REPR_data;
+    MVM_serialization_write_int(tc, writer, repr_data->capacity);
+}
+
+/* Deserializes the REPR data. */
+static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    MVMConcRingQueueREPRData *repr_data = MVM_malloc(sizeof(MVMConcRingQueueREPRData));
+    repr_data->capacity = MVM_serialization_read_int(tc, reader);
+    st->REPR_data = repr_data;
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMConcRingQueue_initialize(MVMThreadContext *tc) {
+    return &ConcRingQueue_this_repr;
+}
+
+static const MVMREPROps ConcRingQueue_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    initialize,
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    {
+        at_pos,
+        MVM_REPR_DEFAULT_BIND_POS,
+        MVM_REPR_DEFAULT_SET_ELEMS,
+        push,
+        MVM_REPR_DEFAULT_POP,
+        MVM_REPR_DEFAULT_UNSHIFT,
+        shift,
+        MVM_REPR_DEFAULT_SLICE,
+        MVM_REPR_DEFAULT_SPLICE,
+        MVM_REPR_DEFAULT_AT_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_BIND_POS_MULTIDIM,
+        MVM_REPR_DEFAULT_DIMENSIONS,
+        MVM_REPR_DEFAULT_SET_DIMENSIONS,
+        MVM_REPR_DEFAULT_GET_ELEM_STORAGE_SPEC,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC,
+        MVM_REPR_DEFAULT_POS_AS_ATOMIC_MULTIDIM,
+        MVM_REPR_DEFAULT_POS_WRITE_BUF,
+        MVM_REPR_DEFAULT_POS_READ_BUF
+    },    /* pos_funcs */
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    elems,
+    get_storage_spec,
+    NULL, /* change_type */
+    NULL, /* serialize */
+    NULL, /* deserialize */
+    serialize_repr_data,
+    deserialize_repr_data,
+    deserialize_stable_size,
+    gc_mark,
+    gc_free,
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    gc_free_repr_data,
+    compose,
+    NULL, /* spesh */
+    "ConcRingQueue", /* name */
+    MVM_REPR_ID_ConcRingQueue,
+    unmanaged_size,
+    NULL /* describe_refs */
+};
+
+/* Polls a queue for a value, returning VMNull if none is available, just as
+ * MVM_concblockingqueue_poll does. */
+MVMObject * MVM_concringqueue_poll(MVMThreadContext *tc, MVMConcRingQueue *queue) {
+    MVMConcRingQueueBody *body = queue->body;
+    MVMObject *result = try_shift(tc, body);
+    if (!result)
+        return tc->instance->VMNull;
+    MVMROOT(tc, result, {
+        wake(tc, (MVMObject *)queue, body, &body->waiting_producers, &body->not_full, 0);
+    });
+    return result;
+}
+
+/* Pushes all the values in an array onto a queue, in order, parking while it
+ * is full. Parked consumers are woken once for the whole batch. Also works on
+ * a ConcBlockingQueue. */
+void MVM_concringqueue_push_all(MVMThreadContext *tc, MVMObject *queue, MVMObject *values) {
+    MVMint64 count, i;
+    if (!IS_CONCRETE(values) || REPR(values)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "queuepushall requires a concrete array of values");
+    count = MVM_repr_elems(tc, values);
+    if (REPR(queue)->ID == MVM_REPR_ID_ConcRingQueue && IS_CONCRETE(queue)) {
+        MVMConcRingQueueBody *body = ((MVMConcRingQueue *)queue)->body;
+        MVMROOT2(tc, queue, values, {
+            for (i = 0; i < count; i++) {
+                MVMObject *value = MVM_repr_at_pos_o(tc, values, i);
+                if (MVM_is_null(tc, value))
+                    MVM_exception_throw_adhoc(tc,
+                        "Cannot store a null value in a concurrent ring queue");
+                /* Let consumers parked on an empty queue go before we park
+                 * on a full one. */
+                if (!try_push(tc, queue, body, value)) {
+                    MVMROOT(tc, value, {
+                        wake(tc, queue, body, &body->waiting_consumers, &body->not_empty, 1);
+                    });
+                    push_value(tc, queue, body, value);
+                }
+            }
+            wake(tc, queue, body, &body->waiting_consumers, &body->not_empty, 1);
+        });
+    }
+    else if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue)) {
+        MVM_concblockingqueue_push_batch(tc, queue, values);
+    }
+    else {
+        MVM_exception_throw_adhoc(tc,
+            "queuepushall requires a concrete object with REPR ConcRingQueue or ConcBlockingQueue, got %s (%s)",
+            REPR(queue)->name, MVM_6model_get_debug_name(tc, queue));
+    }
+}
+
+/* Moves up to max values that are available right now from a queue onto the
+ * end of an array, without blocking, and returns how many were moved. Also
+ * works on a ConcBlockingQueue. */
+MVMint64 MVM_concringqueue_poll_many(MVMThreadContext *tc, MVMObject *queue,
+                                     MVMObject *result, MVMint64 max) {
+    MVMint64 taken = 0;
+    if (!IS_CONCRETE(result) || REPR(result)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "queuepollmany requires a concrete array for the result");
+    if (REPR(queue)->ID == MVM_REPR_ID_ConcRingQueue && IS_CONCRETE(queue)) {
+        MVMConcRingQueueBody *body = ((MVMConcRingQueue *)queue)->body;
+        MVMROOT2(tc, queue, result, {
+            while (taken < max) {
+                MVMObject *value = try_shift(tc, body);
+                if (!value)
+                    break;
+                MVM_repr_push_o(tc, result, value);
+                taken++;
+            }
+            if (taken)
+                wake(tc, queue, body, &body->waiting_producers, &body->not_full, 1);
+        });
+    }
+    else if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue)) {
+        MVMROOT2(tc, queue, result, {
+            while (taken < max) {
+                MVMObject *value = MVM_concblockingqueue_poll(tc, (MVMConcBlockingQueue *)queue);
+                if (MVM_is_null(tc, value))
+                    break;
+                MVM_repr_push_o(tc, result, value);
+                taken++;
+            }
+        });
+    }
+    else {
+        MVM_exception_throw_adhoc(tc,
+            "queuepollmany requires a concrete object with REPR ConcRingQueue or ConcBlockingQueue, got %s (%s)",
+            REPR(queue)->name, MVM_6model_get_debug_name(tc, queue));
+    }
+    return taken;
+}
@@ -0,0 +1,63 @@
+/* A slot in the ring. The sequence number says whose turn the slot is: it is
+ * free for the producer at position p when it is p, and holds the value for
+ * the consumer at position p when it is p + 1. */
+struct MVMConcRingQueueCell {
+    AO_t       sequence;
+    MVMObject *value;
+};
+
+/* The padding used to keep the two positions on separate cache lines. */
+#define MVM_CONC_RING_QUEUE_PAD 64
+
+/* Representation used for a bounded, lock-free queue with many producers and
+ * many consumers, as a faster alternative to ConcBlockingQueue. Pushes and
+ * shifts claim a slot in a ring with a compare and swap, following Dmitry
+ * Vyukov's bounded MPMC queue. Threads only park, on a condition variable,
+ * when the queue is empty (to shift) or full (to push), and a push or shift
+ * only takes the park lock to wake a thread if one is known to be waiting.
+ * As with ConcBlockingQueue, the body is malloced so it never moves. */
+struct MVMConcRingQueueBody {
+    /* The ring, and its capacity minus one; the capacity is a power of 2. */
+    MVMConcRingQueueCell *cells;
+    MVMuint64             mask;
+
+    /* The next positions to push to and to shift from, each on its own cache
+     * line so producers and consumers don't contend on the same one. */
+    char pad0[MVM_CONC_RING_QUEUE_PAD];
+    AO_t enqueue_pos;
+    char pad1[MVM_CONC_RING_QUEUE_PAD - sizeof(AO_t)];
+    AO_t dequeue_pos;
+    char pad2[MVM_CONC_RING_QUEUE_PAD - sizeof(AO_t)];
+
+    /* Numbers of threads parked waiting for a value or for room. */
+    AO_t waiting_consumers;
+    AO_t waiting_producers;
+
+    /* Parking lock and condition variables. */
+    uv_mutex_t park_lock;
+    uv_cond_t  not_empty;
+    uv_cond_t  not_full;
+};
+
+struct MVMConcRingQueue {
+    MVMObject common;
+    /* As for ConcBlockingQueue, a pointer, not an inline struct */
+    MVMConcRingQueueBody *body;
+};
+
+/* The capacity is set per type at compose time. */
+struct MVMConcRingQueueREPRData {
+    MVMuint64 capacity;
+};
+
+/* The capacity used if none is given at compose time. */
+#define MVM_CONC_RING_QUEUE_DEFAULT_CAPACITY 1024
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMConcRingQueue_initialize(MVMThreadContext *tc);
+
+/* Operations on concurrent ring queues. */
+MVMObject * MVM_concringqueue_poll(MVMThreadContext *tc, MVMConcRingQueue *queue);
+void MVM_concringqueue_push_all(MVMThreadContext *tc, MVMObject *queue, MVMObject *values);
+MVMint64 MVM_concringqueue_poll_many(MVMThreadContext *tc, MVMObject *queue,
+                                     MVMObject *result, MVMint64 max);
@@ -121,41 +121,68 @@ MVMObject * MVM_conditionvariable_from_lock(MVMThreadContext *tc, MVMReentrantMu
 }
 
 /* Adds the current thread to the queue of waiters on the condition variable,
- * releasing, waiting, and then re-acquiring the lock. */
-void MVM_conditionvariable_wait(MVMThreadContext *tc, MVMConditionVariable *cv) {
+ * releasing, waiting, and then re-acquiring the lock. The wait lasts at most
+ * timeout nanoseconds, or for as long as it takes if it's negative. Returns
+ * 0 if the wait timed out, and 1 otherwise. */
+static MVMint64 wait_on(MVMThreadContext *tc, MVMConditionVariable *cv, MVMint64 timeout,
+        const char *what) {
     MVMReentrantMutex *rm = (MVMReentrantMutex *)cv->body.mutex;
     AO_t orig_rec_level;
     unsigned int interval_id;
+    int r = 0;
 
     if (MVM_load(&rm->body.holder_id) != tc->thread_id)
         MVM_exception_throw_adhoc(tc,
             "Can only wait on a condition variable when holding mutex");
 
-    interval_id = MVM_telemetry_interval_start(tc, "ConditionVariable.wait");
+    interval_id = MVM_telemetry_interval_start(tc, what);
     MVM_telemetry_interval_annotate((uintptr_t)cv->body.condvar, interval_id, "this condition variable");
     orig_rec_level = MVM_load(&rm->body.lock_count);
     MVM_store(&rm->body.holder_id, 0);
     MVM_store(&rm->body.lock_count, 0);
 
+    MVM_incr(&cv->body.waiters);
     MVMROOT2(tc, cv, rm, {
         MVM_gc_mark_thread_blocked(tc);
-        uv_cond_wait(cv->body.condvar, rm->body.mutex);
+        if (timeout < 0)
+            uv_cond_wait(cv->body.condvar, rm->body.mutex);
+        else
+            r = uv_cond_timedwait(cv->body.condvar, rm->body.mutex, timeout);
         MVM_gc_mark_thread_unblocked(tc);
     });
+    MVM_decr(&cv->body.waiters);
 
     MVM_store(&rm->body.holder_id, tc->thread_id);
     MVM_store(&rm->body.lock_count, orig_rec_level);
-    MVM_telemetry_interval_stop(tc, interval_id, "ConditionVariable.wait");
+    MVM_telemetry_interval_stop(tc, interval_id, what);
+    return r != UV_ETIMEDOUT;
+}
+
+void MVM_conditionvariable_wait(MVMThreadContext *tc, MVMConditionVariable *cv) {
+    wait_on(tc, cv, -1, "ConditionVariable.wait");
+}
+
+/* Waits on the condition variable for at most timeout seconds. Returns 0 if
+ * it timed out, and 1 if it was woken, which may be spuriously, so callers
+ * should check their condition either way, and work out how long there is
+ * left to wait from a deadline of their own. */
+MVMint64 MVM_conditionvariable_wait_timeout(MVMThreadContext *tc, MVMConditionVariable *cv,
+        MVMnum64 timeout) {
+    return wait_on(tc, cv,
+        timeout <= 0 ? 0 : timeout < 1e9 ? (MVMint64)(timeout * 1e9) : INT64_MAX / 2,
+        "ConditionVariable.wait_timeout");
 }
 
 /* Signals one thread waiting on the condition. */
 void MVM_conditionvariable_signal_one(MVMThreadContext *tc, MVMConditionVariable *cv) {
     MVM_telemetry_timestamp(tc, "ConditionVariable.signal_one");
-    uv_cond_signal(cv->body.condvar);
+    if (MVM_load(&cv->body.waiters))
+        uv_cond_signal(cv->body.condvar);
 }
 
 /* Signals all threads waiting on the condition. */
 void MVM_conditionvariable_signal_all(MVMThreadContext *tc, MVMConditionVariable *cv) {
     MVM_telemetry_timestamp(tc, "ConditionVariable.signal_all");
-    uv_cond_broadcast(cv->body.condvar);
+    if (MVM_load(&cv->body.waiters))
+        uv_cond_broadcast(cv->body.condvar);
 }
@@ -6,6 +6,11 @@ struct MVMConditionVariableBody {
     /* The condition variable itself, held at a level of indirection to keep
      * OSes that wouldn't like it moving around happy. */
     uv_cond_t *condvar;
+
+    /* How many threads are waiting on the condition variable. It is only
+     * changed while holding the mutex, so a signal sent while holding it
+     * can skip waking anyone when it is 0. */
+    AO_t waiters;
 };
 struct MVMConditionVariable {
     MVMObject common;
@@ -18,5 +23,7 @@ const MVMREPROps * MVMConditionVariable_initialize(MVMThreadContext *tc);
 /* Operations on a condition variable. */
 MVMObject * MVM_conditionvariable_from_lock(MVMThreadContext *tc, MVMReentrantMutex *lock, MVMObject *type);
 void MVM_conditionvariable_wait(MVMThreadContext *tc, MVMConditionVariable *cv);
+MVMint64 MVM_conditionvariable_wait_timeout(MVMThreadContext *tc, MVMConditionVariable *cv,
+    MVMnum64 timeout);
 void MVM_conditionvariable_signal_one(MVMThreadContext *tc, MVMConditionVariable *cv);
 void MVM_conditionvariable_signal_all(MVMThreadContext *tc, MVMConditionVariable *cv);
@@ -25,6 +25,14 @@ struct MVMAsyncTaskBody {
 
     /* The current state of the task. */
     MVMint32 state;
+
+    /* The index of the event loop the task was queued on. */
+    MVMuint32 loop;
+
+    /* When the task was queued, and when it was set up on the loop (both
+     * from uv_hrtime), for the event loop latency statistics. */
+    MVMuint64 queued_at;
+    MVMuint64 setup_at;
 };
 struct MVMAsyncTask {
     MVMObject common;
@@ -76,9 +76,12 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
             MVM_callsite_destroy(cs);
     }
 
+    if (body->spesh_code_cache)
+        MVM_spesh_code_cache_unit_destroy(tc, body->spesh_code_cache);
     uv_mutex_destroy(body->inline_tweak_mutex);
     MVM_free(body->inline_tweak_mutex);
     MVM_free(body->coderefs);
+    MVM_free(body->frame_index);
     if (body->callsites)
         MVM_fixed_size_free(tc, tc->instance->fsa,
             body->num_callsites * sizeof(MVMCallsite *),
@@ -29,6 +29,9 @@ struct MVMExtOpRecord {
 
     /* Discover facts for spesh. */
     MVMExtOpFactDiscover *discover;
+
+    /* Template for the expression JIT, if the extension supplied one. */
+    const MVMJitExprTemplate *jit_template;
 };
 
 /* How to release memory. */
@@ -55,6 +58,14 @@ struct MVMCompUnitBody {
     MVMuint32        num_frames;    /* Total, inc. added by inliner. */
     MVMuint32        orig_frames;   /* Original from loading comp unit. */
 
+    /* The code objects and their static frames are only made on first use
+     * (see MVM_cu_coderef). Until then, what's needed to make them: the
+     * offset of each frame's header from data_start, and the bytecode and
+     * annotation segments the headers point into. */
+    MVMuint32       *frame_index;
+    MVMuint8        *bytecode_seg;
+    MVMuint8        *annotation_seg;
+
     /* Special frames. */
     MVMStaticFrame  *mainline_frame;
     MVMStaticFrame  *main_frame;
@@ -126,6 +137,12 @@ struct MVMCompUnitBody {
     /* Filename, if any, that we loaded it from. */
     MVMString *filename;
 
+    /* Specialized code remembered for this compilation unit, if there's a
+     * spesh code cache, and whether it was loaded yet (0 if not, 1 while
+     * it's being loaded, and 2 once it has been). */
+    MVMSpeshCodeCacheUnit *spesh_code_cache;
+    AO_t                   spesh_code_cache_state;
+
     /* Handle, if any, associated with a mapped file. */
     void *handle;
 
@@ -145,6 +162,9 @@ struct MVMCompUnitBody {
 
     /* Was a frame in this compilation unit invoked yet? */
     MVMuint8 invoked;
+
+    /* Is the bytecode trusted, so frames need not be validated? */
+    MVMuint8 trusted;
 };
 struct MVMCompUnit {
     MVMObject common;
@@ -25,9 +25,17 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 /* Adds held objects to the GC worklist. */
 static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     MVMExceptionBody *body = (MVMExceptionBody *)data;
+    MVMuint32 i;
     MVM_gc_worklist_add(tc, worklist, &body->message);
     MVM_gc_worklist_add(tc, worklist, &body->payload);
     MVM_gc_worklist_add(tc, worklist, &body->origin);
+    for (i = 0; i < body->bt_num_frames; i++)
+        MVM_gc_worklist_add(tc, worklist, &body->bt_frames[i]);
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVM_free(((MVMException *)obj)->body.bt_frames);
 }
 
 static const MVMStorageSpec storage_spec = {
@@ -73,7 +81,7 @@ static const MVMREPROps MVMException_this_repr = {
     NULL, /* deserialize_repr_data */
     NULL, /* deserialize_stable_size */
     gc_mark,
-    NULL, /* gc_free */
+    gc_free,
     NULL, /* gc_cleanup */
     NULL, /* gc_mark_repr_data */
     NULL, /* gc_free_repr_data */
@@ -16,6 +16,14 @@ struct MVMExceptionBody {
     MVMFrame *origin;
     MVMuint8 *throw_address;
 
+    /* The frames from the origin on down, and the bytecode offset each was
+     * at, captured when a handler is invoked; NULL before. The caller chain
+     * isn't kept once frames return, and the frames below go on running.
+     * Annotations are only looked up should a backtrace be asked for. */
+    MVMFrame **bt_frames;
+    MVMuint32 *bt_offsets;
+    MVMuint32  bt_num_frames;
+
     /* Where should we resume to, if it's possible? */
     MVMuint8 *resume_addr;
     void     *jit_resume_label;
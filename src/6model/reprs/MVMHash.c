@@ -9,6 +9,183 @@ MVM_STATIC_INLINE MVMString * get_string_key(MVMThreadContext *tc, MVMObject *ke
     return (MVMString *)key;
 }
 
+/* The ordered mode starts out with 8 index slots, and keeps up to two
+ * thirds of them in use. */
+#define MVM_HASH_ORDERED_MIN_BITS 3
+#define MVM_HASH_ORDERED_START    0xFFFFFFFF
+
+MVM_STATIC_INLINE MVMuint32 ordered_capacity(MVMuint8 index_bits) {
+    return ((MVMuint32)1 << index_bits) * 2 / 3;
+}
+
+MVM_STATIC_INLINE char * ordered_index(MVMHashOrdered *ordered) {
+    return (char *)(MVM_hash_ordered_entries(ordered) + ordered->alloc);
+}
+
+MVM_STATIC_INLINE MVMuint32 ordered_index_get(MVMHashOrdered *ordered, MVMuint32 slot) {
+    char *index = ordered_index(ordered);
+    switch (ordered->slot_size) {
+        case 1:  return ((MVMuint8 *)index)[slot];
+        case 2:  return ((MVMuint16 *)index)[slot];
+        default: return ((MVMuint32 *)index)[slot];
+    }
+}
+
+MVM_STATIC_INLINE void ordered_index_set(MVMHashOrdered *ordered, MVMuint32 slot, MVMuint32 value) {
+    char *index = ordered_index(ordered);
+    switch (ordered->slot_size) {
+        case 1:  ((MVMuint8 *)index)[slot]  = (MVMuint8)value;  break;
+        case 2:  ((MVMuint16 *)index)[slot] = (MVMuint16)value; break;
+        default: ((MVMuint32 *)index)[slot] = value;            break;
+    }
+}
+
+/* Allocates empty ordered storage with the given number of index slots. */
+static MVMHashOrdered * ordered_allocate(MVMThreadContext *tc, MVMuint8 index_bits, MVMuint64 salt) {
+    MVMuint32 alloc = ordered_capacity(index_bits);
+    MVMuint8 slot_size = alloc < 0xFF ? 1 : alloc < 0xFFFF ? 2 : 4;
+    size_t index_size = ((size_t)1 << index_bits) * slot_size;
+    MVMHashOrdered *ordered = MVM_malloc(sizeof(MVMHashOrdered)
+        + alloc * sizeof(MVMHashEntry) + index_size);
+    ordered->salt       = salt;
+    ordered->used       = 0;
+    ordered->alloc      = alloc;
+    ordered->live       = 0;
+    ordered->index_bits = index_bits;
+    ordered->slot_size  = slot_size;
+    memset(ordered_index(ordered), 0, index_size);
+    return ordered;
+}
+
+/* Finds the entry for a key in ordered storage, or NULL if there is none.
+ * Holes are left in the index, so we just probe past them. */
+static MVMHashEntry * ordered_fetch(MVMThreadContext *tc, MVMHashOrdered *ordered, MVMString *key) {
+    MVMHashEntry *entries = MVM_hash_ordered_entries(ordered);
+    MVMuint32 mask = ((MVMuint32)1 << ordered->index_bits) - 1;
+    MVMuint32 slot = MVM_str_hash_code(tc, ordered->salt, key) >> (64 - ordered->index_bits);
+    MVMuint64 hash_code = MVM_string_hash_code(tc, key);
+    MVMuint32 number;
+    while ((number = ordered_index_get(ordered, slot))) {
+        MVMString *entry_key = entries[number - 1].hash_handle.key;
+        if (entry_key && (entry_key == key
+                || (MVM_string_hash_code(tc, entry_key) == hash_code
+                    && MVM_str_hash_key_matches(tc, key, entry_key))))
+            return &(entries[number - 1]);
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/* Appends an entry for a key that isn't in the ordered storage yet, which
+ * must have room for it, returning the entry with a NULL value. */
+static MVMHashEntry * ordered_append(MVMThreadContext *tc, MVMHashOrdered *ordered, MVMString *key) {
+    MVMHashEntry *entry = &(MVM_hash_ordered_entries(ordered)[ordered->used]);
+    MVMuint32 mask = ((MVMuint32)1 << ordered->index_bits) - 1;
+    MVMuint32 slot = MVM_str_hash_code(tc, ordered->salt, key) >> (64 - ordered->index_bits);
+    while (ordered_index_get(ordered, slot))
+        slot = (slot + 1) & mask;
+    ordered_index_set(ordered, slot, ++ordered->used);
+    ordered->live++;
+    entry->hash_handle.key = key;
+    entry->value = NULL;
+    return entry;
+}
+
+/* Rebuilds ordered storage with room for at least the wanted number of live
+ * entries, dropping the holes but keeping the order. */
+static void ordered_rebuild(MVMThreadContext *tc, MVMHashBody *body, MVMuint32 wanted) {
+    MVMHashOrdered *old = body->ordered;
+    MVMHashEntry *old_entries = MVM_hash_ordered_entries(old);
+    MVMuint8 index_bits = MVM_HASH_ORDERED_MIN_BITS;
+    MVMHashOrdered *ordered;
+    MVMuint32 i;
+    while (ordered_capacity(index_bits) < wanted)
+        index_bits++;
+    ordered = ordered_allocate(tc, index_bits, old->salt);
+    for (i = 0; i < old->used; i++) {
+        if (old_entries[i].hash_handle.key) {
+            MVMHashEntry *entry = ordered_append(tc, ordered, old_entries[i].hash_handle.key);
+            entry->value = old_entries[i].value;
+        }
+    }
+    body->ordered = ordered;
+    MVM_free(old);
+}
+
+/* Looks up the entry for a key in ordered storage, appending one with a NULL
+ * value if there is none. Growth is by half as much again as what is live,
+ * so a hash with lots of deletions gets compacted rather than grown. */
+static MVMHashEntry * ordered_lvalue_fetch(MVMThreadContext *tc, MVMHashBody *body, MVMString *key) {
+    MVMHashEntry *entry = ordered_fetch(tc, body->ordered, key);
+    if (entry)
+        return entry;
+    if (body->ordered->used == body->ordered->alloc) {
+        MVMuint32 live = body->ordered->live;
+        ordered_rebuild(tc, body, live + 1 + live / 2);
+    }
+    return ordered_append(tc, body->ordered, key);
+}
+
+MVM_STATIC_INLINE MVMuint32 ordered_next_live(MVMHashOrdered *ordered, MVMuint32 from) {
+    MVMHashEntry *entries = MVM_hash_ordered_entries(ordered);
+    MVMuint32 i;
+    for (i = from; i < ordered->used; i++)
+        if (entries[i].hash_handle.key)
+            return i + 1;
+    return 0;
+}
+
+/* Finds the entry for a key in a small hash, or NULL if there is none. Keys
+ * are very often the very same string object, so we look for that first, and
+ * otherwise only compare against those with a matching hash code. */
+static MVMHashEntry * small_fetch(MVMThreadContext *tc, MVMHashBody *body, MVMString *key) {
+    MVMuint32 count = body->small_count;
+    MVMuint32 i;
+    MVMuint64 hash_code;
+    for (i = 0; i < count; i++)
+        if (body->small[i].hash_handle.key == key)
+            return &(body->small[i]);
+    if (count == 0)
+        return NULL;
+    hash_code = MVM_string_hash_code(tc, key);
+    for (i = 0; i < count; i++) {
+        MVMString *entry_key = body->small[i].hash_handle.key;
+        if (MVM_string_hash_code(tc, entry_key) == hash_code
+                && MVM_str_hash_key_matches(tc, key, entry_key))
+            return &(body->small[i]);
+    }
+    return NULL;
+}
+
+MVM_STATIC_INLINE MVMHashEntry * fetch_nocheck(MVMThreadContext *tc, MVMHashBody *body, MVMString *key) {
+    if (body->ordered)
+        return ordered_fetch(tc, body->ordered, key);
+    return MVM_hash_is_small(tc, body)
+        ? small_fetch(tc, body, key)
+        : MVM_str_hash_fetch_nocheck(tc, &(body->hashtable), key);
+}
+
+MVM_STATIC_INLINE MVMHashEntry * fetch(MVMThreadContext *tc, MVMHashBody *body, MVMString *key) {
+    if (!MVM_str_hash_key_is_valid(tc, key)) {
+        MVM_str_hash_key_throw_invalid(tc, key);
+    }
+    return fetch_nocheck(tc, body, key);
+}
+
+/* Moves the entries of a small hash into a freshly built hash table, with
+ * room for the wanted number of entries. The entries stay owned by the same
+ * object, so no write barriers are needed. */
+static void promote(MVMThreadContext *tc, MVMHashBody *body, MVMuint32 wanted) {
+    MVMStrHashTable *hashtable = &(body->hashtable);
+    MVMuint32 i;
+    MVM_str_hash_build(tc, hashtable, sizeof(MVMHashEntry), wanted);
+    for (i = 0; i < body->small_count; i++) {
+        MVMHashEntry *entry = MVM_str_hash_insert_nocheck(tc, hashtable, body->small[i].hash_handle.key);
+        entry->value = body->small[i].value;
+    }
+    body->small_count = 0;
+}
+
 /* Creates a new type object of this representation, and associates it with
  * the given HOW. */
 static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
@@ -30,12 +207,43 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 
     MVMStrHashTable *src_hashtable = &(src_body->hashtable);
     MVMStrHashTable *dest_hashtable = &(dest_body->hashtable);
-    if (MVM_str_hash_entry_size(tc, dest_hashtable)) {
+    if (MVM_str_hash_entry_size(tc, dest_hashtable) || dest_body->small_count || dest_body->ordered) {
         /* copy_to is, on reference types, only ever used as part of clone, and
          * that will always target a freshly created object.
          * So this should be unreachable. */
         MVM_oops(tc, "copy_to on MVMHash that is already initialized");
     }
+    if (src_body->ordered) {
+        /* Rebuilding rather than copying drops any holes. */
+        MVMHashOrdered *src_ordered = src_body->ordered;
+        MVMHashEntry *src_entries = MVM_hash_ordered_entries(src_ordered);
+        MVMuint8 index_bits = MVM_HASH_ORDERED_MIN_BITS;
+        MVMuint32 i;
+        while (ordered_capacity(index_bits) < src_ordered->live)
+            index_bits++;
+        dest_body->ordered = ordered_allocate(tc, index_bits, src_ordered->salt);
+        for (i = 0; i < src_ordered->used; i++) {
+            MVMHashEntry *entry = &(src_entries[i]);
+            if (entry->hash_handle.key) {
+                MVMHashEntry *new_entry = ordered_append(tc, dest_body->ordered, entry->hash_handle.key);
+                MVM_gc_write_barrier(tc, &(dest_root->header), &(new_entry->hash_handle.key->common.header));
+                MVM_ASSIGN_REF(tc, &(dest_root->header), new_entry->value, entry->value);
+            }
+        }
+        return;
+    }
+    if (MVM_hash_is_small(tc, src_body)) {
+        MVMuint32 i;
+        for (i = 0; i < src_body->small_count; i++) {
+            MVMHashEntry *entry = &(src_body->small[i]);
+            MVMHashEntry *new_entry = &(dest_body->small[i]);
+            new_entry->hash_handle.key = entry->hash_handle.key;
+            MVM_gc_write_barrier(tc, &(dest_root->header), &(new_entry->hash_handle.key->common.header));
+            MVM_ASSIGN_REF(tc, &(dest_root->header), new_entry->value, entry->value);
+        }
+        dest_body->small_count = src_body->small_count;
+        return;
+    }
     MVM_str_hash_build(tc, dest_hashtable, sizeof(MVMHashEntry),
                        MVM_str_hash_count(tc, src_hashtable));
     MVMStrHashIterator iterator = MVM_str_hash_first(tc, src_hashtable);
@@ -52,6 +260,47 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 static void MVMHash_gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     MVMHashBody     *body = (MVMHashBody *)data;
     MVMStrHashTable *hashtable = &(body->hashtable);
+    if (body->ordered) {
+        MVMHashEntry *entries = MVM_hash_ordered_entries(body->ordered);
+        MVMuint32 used = body->ordered->used;
+        MVMuint32 i;
+        MVM_gc_worklist_presize_for(tc, worklist, 2 * body->ordered->live);
+        for (i = 0; i < used; i++) {
+            MVMHashEntry *current = &(entries[i]);
+            if (!current->hash_handle.key)
+                continue;
+            if (worklist->include_gen2) {
+                MVM_gc_worklist_add_include_gen2_nocheck(tc, worklist, &current->hash_handle.key);
+                MVM_gc_worklist_add_include_gen2_nocheck(tc, worklist, &current->value);
+            }
+            else {
+                MVMCollectable **key = (MVMCollectable **) &current->hash_handle.key;
+                MVM_gc_worklist_add_no_include_gen2_nocheck(tc, worklist, key);
+                MVM_gc_worklist_add_object_no_include_gen2_nocheck(tc, worklist, &current->value);
+            }
+        }
+        return;
+    }
+    if (MVM_hash_is_small(tc, body)) {
+        MVMuint32 i;
+        MVM_gc_worklist_presize_for(tc, worklist, 2 * body->small_count);
+        if (worklist->include_gen2) {
+            for (i = 0; i < body->small_count; i++) {
+                MVMHashEntry *current = &(body->small[i]);
+                MVM_gc_worklist_add_include_gen2_nocheck(tc, worklist, &current->hash_handle.key);
+                MVM_gc_worklist_add_include_gen2_nocheck(tc, worklist, &current->value);
+            }
+        }
+        else {
+            for (i = 0; i < body->small_count; i++) {
+                MVMHashEntry *current = &(body->small[i]);
+                MVMCollectable **key = (MVMCollectable **) &current->hash_handle.key;
+                MVM_gc_worklist_add_no_include_gen2_nocheck(tc, worklist, key);
+                MVM_gc_worklist_add_object_no_include_gen2_nocheck(tc, worklist, &current->value);
+            }
+        }
+        return;
+    }
     MVM_gc_worklist_presize_for(tc, worklist, 2 * MVM_str_hash_count(tc, hashtable));
     if (worklist->include_gen2) {
         MVMStrHashIterator iterator = MVM_str_hash_first(tc, hashtable);
@@ -80,17 +329,17 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMStrHashTable *hashtable = &(h->body.hashtable);
 
     MVM_str_hash_demolish(tc, hashtable);
+    MVM_free(h->body.ordered);
 }
 
 void MVMHash_at_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister *result, MVMuint16 kind) {
     MVMHashBody   *body = (MVMHashBody *)data;
-    MVMStrHashTable *hashtable = &(body->hashtable);
 
     if (MVM_UNLIKELY(kind != MVM_reg_obj))
         MVM_exception_throw_adhoc(tc,
             "MVMHash representation does not support native type storage");
 
-    MVMHashEntry *entry = MVM_str_hash_fetch(tc, hashtable, (MVMString *)key_obj);
+    MVMHashEntry *entry = fetch(tc, body, (MVMString *)key_obj);
     result->o = entry != NULL ? entry->value : tc->instance->VMNull;
 }
 
@@ -106,8 +355,27 @@ void MVMHash_bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void
         MVM_exception_throw_adhoc(tc,
             "MVMHash representation does not support native type storage");
 
-    if (!MVM_str_hash_entry_size(tc, hashtable)) {
-        MVM_str_hash_build(tc, hashtable, sizeof(MVMHashEntry), 0);
+    if (body->ordered) {
+        MVMHashEntry *entry = ordered_lvalue_fetch(tc, body, key);
+        if (!entry->value)
+            MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+        MVM_ASSIGN_REF(tc, &(root->header), entry->value, value.o);
+        return;
+    }
+    if (MVM_hash_is_small(tc, body)) {
+        MVMHashEntry *entry = small_fetch(tc, body, key);
+        if (entry || body->small_count < MVM_HASH_SMALL_MAX) {
+            if (!entry) {
+                entry = &(body->small[body->small_count]);
+                entry->hash_handle.key = key;
+                entry->value = NULL;
+                body->small_count++;
+                MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+            }
+            MVM_ASSIGN_REF(tc, &(root->header), entry->value, value.o);
+            return;
+        }
+        promote(tc, body, body->small_count + 1);
     }
 
     MVMHashEntry *entry = MVM_str_hash_lvalue_fetch_nocheck(tc, hashtable, key);
@@ -119,13 +387,13 @@ void MVMHash_bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void
 }
 static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
     MVMHashBody *body = (MVMHashBody *)data;
-    return MVM_str_hash_count(tc, &(body->hashtable));}
+    return MVM_hash_count(tc, body);
+}
 
 static MVMint64 exists_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
     MVMHashBody   *body = (MVMHashBody *)data;
-    /* key_obj checked in MVM_str_hash_fetch */
-    MVMStrHashTable *hashtable = &(body->hashtable);
-    MVMHashEntry *entry = MVM_str_hash_fetch(tc, hashtable, (MVMString *)key_obj);
+    /* key_obj checked in fetch */
+    MVMHashEntry *entry = fetch(tc, body, (MVMString *)key_obj);
     return entry != NULL;
 }
 
@@ -134,6 +402,27 @@ static void delete_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, voi
     MVMString *key = get_string_key(tc, key_obj);
     MVMStrHashTable *hashtable = &(body->hashtable);
 
+    if (body->ordered) {
+        /* Leave a hole, which keeps the index and iterators valid. */
+        MVMHashEntry *entry = ordered_fetch(tc, body->ordered, key);
+        if (entry) {
+            entry->hash_handle.key = NULL;
+            entry->value = NULL;
+            body->ordered->live--;
+        }
+        return;
+    }
+    if (MVM_hash_is_small(tc, body)) {
+        /* Close up the gap, keeping the order, so that iterators (which go
+         * downwards) are still valid after deleting at the current one. */
+        MVMHashEntry *entry = small_fetch(tc, body, key);
+        if (entry) {
+            MVMHashEntry *end = body->small + body->small_count;
+            memmove(entry, entry + 1, (end - entry - 1) * sizeof(MVMHashEntry));
+            body->small_count--;
+        }
+        return;
+    }
     MVM_str_hash_delete(tc, hashtable, key);
 }
 
@@ -171,7 +460,7 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
 static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMSerializationReader *reader) {
     MVMHashBody *body = (MVMHashBody *)data;
     MVMStrHashTable *hashtable = &(body->hashtable);
-    if (MVM_str_hash_entry_size(tc, hashtable)) {
+    if (MVM_str_hash_entry_size(tc, hashtable) || body->small_count || body->ordered) {
         /* This should be unreachable. As clarified by @jnthn:
          *   The key question here is "what happens if the hash is repossessed".
          *   When that happens, the original one has this happen to it:
@@ -181,9 +470,48 @@ static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, vo
          * code must be unreachable.] */
         MVM_oops(tc, "deserialize on MVMHash that is already initialized");
     }
+    MVMint64 ordered = reader->root.version >= 24
+        ? MVM_serialization_read_int(tc, reader)
+        : 0;
     MVMint64 elems = MVM_serialization_read_int(tc, reader);
-    MVM_str_hash_build(tc, hashtable, sizeof(MVMHashEntry), elems);
     MVMint64 i;
+    if (ordered) {
+        MVMuint8 index_bits = MVM_HASH_ORDERED_MIN_BITS;
+        while (ordered_capacity(index_bits) < elems)
+            index_bits++;
+#if MVM_HASH_RANDOMIZE
+        body->ordered = ordered_allocate(tc, index_bits, MVM_proc_rand_i(tc));
+#else
+        body->ordered = ordered_allocate(tc, index_bits, 0);
+#endif
+        for (i = 0; i < elems; i++) {
+            MVMString *key = MVM_serialization_read_str(tc, reader);
+            if (!MVM_str_hash_key_is_valid(tc, key)) {
+                MVM_str_hash_key_throw_invalid(tc, key);
+            }
+            MVMObject *value = MVM_serialization_read_ref(tc, reader);
+            MVMHashEntry *entry = ordered_append(tc, body->ordered, key);
+            MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+            MVM_ASSIGN_REF(tc, &(root->header), entry->value, value);
+        }
+        return;
+    }
+    if (elems <= MVM_HASH_SMALL_MAX) {
+        for (i = 0; i < elems; i++) {
+            MVMString *key = MVM_serialization_read_str(tc, reader);
+            if (!MVM_str_hash_key_is_valid(tc, key)) {
+                MVM_str_hash_key_throw_invalid(tc, key);
+            }
+            MVMObject *value = MVM_serialization_read_ref(tc, reader);
+            MVMHashEntry *entry = &(body->small[i]);
+            entry->hash_handle.key = key;
+            MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+            MVM_ASSIGN_REF(tc, &(root->header), entry->value, value);
+            body->small_count++;
+        }
+        return;
+    }
+    MVM_str_hash_build(tc, hashtable, sizeof(MVMHashEntry), elems);
     for (i = 0; i < elems; i++) {
         MVMString *key = MVM_serialization_read_str(tc, reader);
         if (!MVM_str_hash_key_is_valid(tc, key)) {
@@ -202,21 +530,34 @@ static int cmp_strings(const void *s1, const void *s2) {
 }
 static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
     MVMHashBody *body = (MVMHashBody *)data;
-    MVMStrHashTable *hashtable = &(body->hashtable);
-    MVMuint64 elems = MVM_str_hash_count(tc, hashtable);
+    MVMuint64 elems = MVM_hash_count(tc, body);
+    MVM_serialization_write_int(tc, writer, body->ordered ? 1 : 0);
+    if (body->ordered) {
+        /* The order is part of the value, so we keep it rather than sorting
+         * the keys. */
+        MVM_serialization_write_int(tc, writer, elems);
+        MVMStrHashIterator iterator = MVM_hash_first(tc, body);
+        while (!MVM_hash_at_end(tc, body, iterator)) {
+            MVMHashEntry *current = MVM_hash_current_nocheck(tc, body, iterator);
+            MVM_serialization_write_str(tc, writer, current->hash_handle.key);
+            MVM_serialization_write_ref(tc, writer, current->value);
+            iterator = MVM_hash_next_nocheck(tc, body, iterator);
+        }
+        return;
+    }
     MVMString **keys = MVM_malloc(sizeof(MVMString *) * elems);
     MVMuint64 i = 0;
     MVM_serialization_write_int(tc, writer, elems);
-    MVMStrHashIterator iterator = MVM_str_hash_first(tc, hashtable);
-    while (!MVM_str_hash_at_end(tc, hashtable, iterator)) {
-        MVMHashEntry *current = MVM_str_hash_current_nocheck(tc, hashtable, iterator);
+    MVMStrHashIterator iterator = MVM_hash_first(tc, body);
+    while (!MVM_hash_at_end(tc, body, iterator)) {
+        MVMHashEntry *current = MVM_hash_current_nocheck(tc, body, iterator);
         keys[i++] = current->hash_handle.key;
-        iterator = MVM_str_hash_next_nocheck(tc, hashtable, iterator);
+        iterator = MVM_hash_next_nocheck(tc, body, iterator);
     }
     cmp_tc = tc;
     qsort(keys, elems, sizeof(MVMString*), cmp_strings);
     for (i = 0; i < elems; i++) {
-        MVMHashEntry *entry = MVM_str_hash_fetch_nocheck(tc, hashtable, keys[i]);
+        MVMHashEntry *entry = fetch_nocheck(tc, body, keys[i]);
         MVM_serialization_write_str(tc, writer, keys[i]);
         MVM_serialization_write_ref(tc, writer, entry->value);
     }
@@ -232,7 +573,9 @@ static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSeri
 static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
     switch (ins->info->opcode) {
     case MVM_OP_create: {
-        if (!(st->mode_flags & MVM_FINALIZE_TYPE)) {
+        /* Objects of pretenured types must go through the allocator to end up
+         * in gen2, so aren't fast-created. */
+        if (!(st->mode_flags & MVM_FINALIZE_TYPE) && st->pretenure_state != MVM_PRETENURE_YES) {
             MVMSpeshOperand target   = ins->operands[0];
             MVMSpeshOperand type     = ins->operands[1];
             MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, target);
@@ -255,6 +598,11 @@ static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpes
 static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
     MVMHashBody *body = (MVMHashBody *)data;
 
+    if (body->ordered)
+        return sizeof(MVMHashOrdered) + body->ordered->alloc * sizeof(MVMHashEntry)
+            + ((size_t)1 << body->ordered->index_bits) * body->ordered->slot_size;
+    if (MVM_hash_is_small(tc, body))
+        return 0;
     return sizeof(MVMHashEntry) * MVM_str_hash_count(tc, &(body->hashtable));
 }
 
@@ -298,3 +646,168 @@ static const MVMREPROps MVMHash_this_repr = {
     unmanaged_size, /* unmanaged_size */
     NULL, /* describe_refs */
 };
+
+/* Makes an iterator for the small mode; pos is the index plus one. */
+MVM_STATIC_INLINE MVMStrHashIterator small_iterator(MVMuint32 pos) {
+    MVMStrHashIterator iterator;
+#if HASH_DEBUG_ITER
+    iterator.owner  = 0;
+    iterator.serial = 0;
+#endif
+    iterator.pos = pos;
+    return iterator;
+}
+
+MVMuint64 MVM_hash_count(MVMThreadContext *tc, MVMHashBody *body) {
+    if (body->ordered)
+        return body->ordered->live;
+    return MVM_hash_is_small(tc, body)
+        ? body->small_count
+        : MVM_str_hash_count(tc, &(body->hashtable));
+}
+
+MVMStrHashIterator MVM_hash_first(MVMThreadContext *tc, MVMHashBody *body) {
+    if (body->ordered)
+        return small_iterator(ordered_next_live(body->ordered, 0));
+    return MVM_hash_is_small(tc, body)
+        ? small_iterator(body->small_count)
+        : MVM_str_hash_first(tc, &(body->hashtable));
+}
+
+/* The start position of a small or ordered hash doesn't depend on the
+ * number of items, so that it is stable over deletions. */
+MVMStrHashIterator MVM_hash_start(MVMThreadContext *tc, MVMHashBody *body) {
+    if (body->ordered)
+        return small_iterator(MVM_HASH_ORDERED_START);
+    return MVM_hash_is_small(tc, body)
+        ? small_iterator(MVM_HASH_SMALL_MAX + 1)
+        : MVM_str_hash_start(tc, &(body->hashtable));
+}
+
+int MVM_hash_at_end(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator) {
+    return !MVM_hash_uses_table(tc, body)
+        ? iterator.pos == 0
+        : MVM_str_hash_at_end(tc, &(body->hashtable), iterator);
+}
+
+int MVM_hash_at_start(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator) {
+    if (body->ordered)
+        return iterator.pos == MVM_HASH_ORDERED_START;
+    return MVM_hash_is_small(tc, body)
+        ? iterator.pos == MVM_HASH_SMALL_MAX + 1
+        : MVM_str_hash_at_start(tc, &(body->hashtable), iterator);
+}
+
+/* Only call this if MVM_hash_at_end returns false. */
+MVMStrHashIterator MVM_hash_next_nocheck(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator) {
+    if (body->ordered)
+        return small_iterator(ordered_next_live(body->ordered,
+            iterator.pos == MVM_HASH_ORDERED_START ? 0 : iterator.pos));
+    if (MVM_hash_is_small(tc, body)) {
+        MVMuint32 pos = iterator.pos - 1;
+        return small_iterator(pos > body->small_count ? body->small_count : pos);
+    }
+    return MVM_str_hash_next_nocheck(tc, &(body->hashtable), iterator);
+}
+
+/* Only call this if MVM_hash_at_end returns false. */
+MVMHashEntry * MVM_hash_current_nocheck(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator) {
+    if (body->ordered)
+        return &(MVM_hash_ordered_entries(body->ordered)[iterator.pos - 1]);
+    return MVM_hash_is_small(tc, body)
+        ? &(body->small[iterator.pos - 1])
+        : MVM_str_hash_current_nocheck(tc, &(body->hashtable), iterator);
+}
+
+/* Switches an empty hash to the ordered mode, so it iterates in insertion
+ * order. */
+void MVM_hash_set_ordered(MVMThreadContext *tc, MVMObject *hash) {
+    MVMHashBody *body;
+    if (REPR(hash)->ID != MVM_REPR_ID_MVMHash || !IS_CONCRETE(hash))
+        MVM_exception_throw_adhoc(tc, "sethashordered requires a concrete VMHash");
+    body = &(((MVMHash *)hash)->body);
+    if (body->ordered)
+        return;
+    if (MVM_hash_count(tc, body))
+        MVM_exception_throw_adhoc(tc, "sethashordered requires an empty hash");
+#if MVM_HASH_RANDOMIZE
+    body->ordered = ordered_allocate(tc, MVM_HASH_ORDERED_MIN_BITS, MVM_proc_rand_i(tc));
+#else
+    body->ordered = ordered_allocate(tc, MVM_HASH_ORDERED_MIN_BITS, 0);
+#endif
+}
+
+/* Makes room in a hash for the expected number of entries, so that filling
+ * it up to there doesn't grow it along the way. */
+void MVM_hash_presize(MVMThreadContext *tc, MVMObject *hash, MVMint64 entries) {
+    MVMHashBody *body;
+    if (REPR(hash)->ID != MVM_REPR_ID_MVMHash || !IS_CONCRETE(hash))
+        MVM_exception_throw_adhoc(tc, "hashpresize requires a concrete VMHash");
+    if (entries < 0 || entries > 0xFFFFFFF)
+        MVM_exception_throw_adhoc(tc, "hashpresize size %"PRId64" out of range", entries);
+    body = &(((MVMHash *)hash)->body);
+    if (body->ordered) {
+        if (body->ordered->alloc < entries)
+            ordered_rebuild(tc, body, (MVMuint32)entries);
+    }
+    else if (MVM_hash_is_small(tc, body)) {
+        if (entries > MVM_HASH_SMALL_MAX)
+            promote(tc, body, (MVMuint32)entries);
+    }
+    else {
+        MVM_str_hash_reserve(tc, &(body->hashtable), (MVMuint32)entries);
+    }
+}
+
+/* Binds each of an array of keys to the value at the same position in an
+ * array of values, sizing the hash for them first. */
+void MVM_hash_bind_all(MVMThreadContext *tc, MVMObject *hash, MVMObject *keys, MVMObject *values) {
+    MVMuint64 count, num_values, i;
+    if (REPR(hash)->ID != MVM_REPR_ID_MVMHash || !IS_CONCRETE(hash))
+        MVM_exception_throw_adhoc(tc, "hashbindall requires a concrete VMHash");
+    if (REPR(keys)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(keys)
+            || REPR(values)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(values))
+        MVM_exception_throw_adhoc(tc, "hashbindall requires concrete arrays of keys and values");
+    count      = MVM_repr_elems(tc, keys);
+    num_values = MVM_repr_elems(tc, values);
+    if (num_values != count)
+        MVM_exception_throw_adhoc(tc,
+            "hashbindall got %"PRIu64" keys but %"PRIu64" values",
+            count, num_values);
+    MVM_hash_presize(tc, hash, (MVMint64)(MVM_hash_count(tc, &(((MVMHash *)hash)->body)) + count));
+    MVMROOT3(tc, hash, keys, values, {
+        for (i = 0; i < count; i++) {
+            MVMString *key   = MVM_repr_at_pos_s(tc, keys, i);
+            MVMObject *value = MVM_repr_at_pos_o(tc, values, i);
+            MVMRegister reg;
+            reg.o = value;
+            MVMHash_bind_key(tc, STABLE(hash), hash, OBJECT_BODY(hash), (MVMObject *)key, reg, MVM_reg_obj);
+        }
+    });
+}
+
+/* Binds all the entries of one hash into another, sizing the target for
+ * them first. */
+void MVM_hash_merge(MVMThreadContext *tc, MVMObject *target, MVMObject *source) {
+    MVMHashBody *source_body;
+    if (REPR(target)->ID != MVM_REPR_ID_MVMHash || !IS_CONCRETE(target)
+            || REPR(source)->ID != MVM_REPR_ID_MVMHash || !IS_CONCRETE(source))
+        MVM_exception_throw_adhoc(tc, "hashmerge requires two concrete VMHashes");
+    if (target == source)
+        return;
+    source_body = &(((MVMHash *)source)->body);
+    MVM_hash_presize(tc, target, MVM_hash_count(tc, &(((MVMHash *)target)->body))
+        + MVM_hash_count(tc, source_body));
+
+    /* Binding doesn't allocate any collectable objects, so nothing can move
+     * while we walk the source. */
+    MVMStrHashIterator iterator = MVM_hash_first(tc, source_body);
+    while (!MVM_hash_at_end(tc, source_body, iterator)) {
+        MVMHashEntry *current = MVM_hash_current_nocheck(tc, source_body, iterator);
+        MVMRegister reg;
+        reg.o = current->value;
+        MVMHash_bind_key(tc, STABLE(target), target, OBJECT_BODY(target),
+            (MVMObject *)current->hash_handle.key, reg, MVM_reg_obj);
+        iterator = MVM_hash_next_nocheck(tc, source_body, iterator);
+    }
+}
@@ -7,16 +7,77 @@ struct MVMHashEntry {
     MVMObject *value;
 };
 
+/* Hashes with only a few keys keep them inline in the body, as a linear
+ * array that is scanned, and only get a hash table when they grow beyond
+ * that. The hash table being unbuilt is what marks the small mode, so a
+ * zeroed body is a valid empty hash. */
+#define MVM_HASH_SMALL_MAX 8
+
 struct MVMHashBody {
     MVMStrHashTable hashtable;
+    MVMHashEntry small[MVM_HASH_SMALL_MAX];
+    MVMuint32 small_count;
+
+    /* Set if the hash was switched to the ordered mode, in which case the
+     * other storage is unused. */
+    MVMHashOrdered *ordered;
 };
 struct MVMHash {
     MVMObject common;
     MVMHashBody body;
 };
 
+/* Storage for a hash in the ordered mode, which iterates in insertion
+ * order. The entries are kept in a dense array, in the order they were
+ * added; deleted ones are left behind as holes with a NULL key until the
+ * next rebuild. They are found through an open addressed index, whose slots
+ * hold an entry number plus one (0 being empty) in 8, 16 or 32 bits, as the
+ * capacity needs. The entries and then the index follow this header in the
+ * same allocation. */
+struct MVMHashOrdered {
+    MVMuint64 salt;
+    /* Entries handed out so far, including holes. */
+    MVMuint32 used;
+    /* Entries there is room for. */
+    MVMuint32 alloc;
+    /* Entries that are not holes. */
+    MVMuint32 live;
+    /* Log base 2 of the number of index slots, and the size of a slot. */
+    MVMuint8 index_bits;
+    MVMuint8 slot_size;
+};
+
+MVM_STATIC_INLINE MVMHashEntry * MVM_hash_ordered_entries(MVMHashOrdered *ordered) {
+    return (MVMHashEntry *)(ordered + 1);
+}
+
 /* Function for REPR setup. */
 const MVMREPROps * MVMHash_initialize(MVMThreadContext *tc);
 
 void MVMHash_at_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister *result, MVMuint16 kind);
 void MVMHash_bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister value, MVMuint16 kind);
+
+MVM_STATIC_INLINE int MVM_hash_uses_table(MVMThreadContext *tc, MVMHashBody *body) {
+    return body->hashtable.entry_size != 0;
+}
+MVM_STATIC_INLINE int MVM_hash_is_small(MVMThreadContext *tc, MVMHashBody *body) {
+    return body->hashtable.entry_size == 0 && !body->ordered;
+}
+
+/* Iteration over a hash in any mode. The iterators work just as those of
+ * MVMStrHashTable do, including that deleting the entry at the current
+ * position is allowed. In the small and ordered modes the position is the
+ * index of the entry plus one, or 0 at the end; small hashes are walked
+ * downwards, and ordered ones upwards. */
+MVMuint64 MVM_hash_count(MVMThreadContext *tc, MVMHashBody *body);
+MVMStrHashIterator MVM_hash_first(MVMThreadContext *tc, MVMHashBody *body);
+MVMStrHashIterator MVM_hash_start(MVMThreadContext *tc, MVMHashBody *body);
+int MVM_hash_at_end(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator);
+int MVM_hash_at_start(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator);
+MVMStrHashIterator MVM_hash_next_nocheck(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator);
+MVMHashEntry * MVM_hash_current_nocheck(MVMThreadContext *tc, MVMHashBody *body, MVMStrHashIterator iterator);
+
+void MVM_hash_set_ordered(MVMThreadContext *tc, MVMObject *hash);
+void MVM_hash_presize(MVMThreadContext *tc, MVMObject *hash, MVMint64 entries);
+void MVM_hash_bind_all(MVMThreadContext *tc, MVMObject *hash, MVMObject *keys, MVMObject *values);
+void MVM_hash_merge(MVMThreadContext *tc, MVMObject *target, MVMObject *source);
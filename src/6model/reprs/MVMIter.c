@@ -105,29 +105,7 @@ static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *da
             }
             return;
         case MVM_ITER_MODE_HASH:
-            ; /* Sigh, C99 won't let me put a declaration here. */
-            MVMStrHashTable *hashtable = &(((MVMHash *)target)->body.hashtable);
-#if HASH_DEBUG_ITER
-            if (body->hash_state.curr.owner != hashtable->ht_id) {
-                MVM_oops(tc, "MVMIter shift called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
-                         body->hash_state.curr.owner, hashtable->ht_id);
-            }
-            /* OK, to implement "delete at current iterator position" we need
-             * to cheat somewhat. */
-            if (MVM_str_hash_iterator_target_deleted(tc, hashtable, body->hash_state.curr)) {
-                /* The only action taken on the hash was to delete at the
-                 * current iterator. In which case, the "next" iterator is
-                 * valid (but has already been advanced beyond pos, so we
-                 * can't perform this test on it). So "fix up" its state to pass
-                 * muster with the HASH_DEBUG_ITER sanity tests. */
-                body->hash_state.next.serial = hashtable->serial;
-            }
-#endif
-            body->hash_state.curr = body->hash_state.next;
-            if (MVM_str_hash_at_end(tc, hashtable, body->hash_state.curr))
-                MVM_exception_throw_adhoc(tc, "Iteration past end of iterator");
-            body->hash_state.next = MVM_str_hash_next_nocheck(tc, hashtable, body->hash_state.curr);
-            value->o = root;
+            value->o = MVM_iter_shift_hash(tc, (MVMIter *)root);
             return;
         default:
             MVM_exception_throw_adhoc(tc, "Unknown iteration mode");
@@ -155,6 +133,63 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
     /* XXX element type supplied through this... */
 }
 
+/* Finds the slot type of the VMArray an array iterator is over, if spesh
+ * knows it from the iter op that made the iterator. */
+static MVMint32 array_slot_type(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshFacts *facts) {
+    MVMSpeshFacts *target_facts;
+    MVMArrayREPRData *repr_data;
+    if (!facts->writer || facts->writer->info->opcode != MVM_OP_iter)
+        return -1;
+    target_facts = MVM_spesh_get_facts(tc, g, facts->writer->operands[1]);
+    if (!(target_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) || !target_facts->type
+            || REPR(target_facts->type)->ID != MVM_REPR_ID_VMArray)
+        return -1;
+    repr_data = (MVMArrayREPRData *)STABLE(target_facts->type)->REPR_data;
+    if (!repr_data)
+        return -1;
+    MVM_spesh_use_facts(tc, g, target_facts);
+    return repr_data->slot_type;
+}
+
+/* Bytecode specialization for this REPR. Where spesh knows what an iterator
+ * is over, shifting from it and getting the key and value it's at can skip
+ * the REPR and the iteration mode, and for VMArrays read the slots
+ * directly. */
+static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+    MVMuint16 opcode = ins->info->opcode;
+    if (!(facts->flags & MVM_SPESH_FACT_CONCRETE))
+        return;
+    if (facts->flags & MVM_SPESH_FACT_HASH_ITER) {
+        switch (opcode) {
+        case MVM_OP_shift_o:
+            ins->info = MVM_op_get_op(MVM_OP_sp_iter_shift_hash);
+            break;
+        case MVM_OP_iterkey_s:
+            ins->info = MVM_op_get_op(MVM_OP_sp_iterkey_hash);
+            break;
+        case MVM_OP_iterval:
+            ins->info = MVM_op_get_op(MVM_OP_sp_iterval_hash);
+            break;
+        }
+    }
+    else if (facts->flags & MVM_SPESH_FACT_ARRAY_ITER) {
+        MVMint32 slot_type;
+        if (opcode != MVM_OP_shift_o && opcode != MVM_OP_shift_i
+                && opcode != MVM_OP_shift_n && opcode != MVM_OP_shift_s)
+            return;
+        slot_type = array_slot_type(tc, g, facts);
+        if (opcode == MVM_OP_shift_o && slot_type == MVM_ARRAY_OBJ)
+            ins->info = MVM_op_get_op(MVM_OP_sp_iter_shift_arr_o);
+        else if (opcode == MVM_OP_shift_i && slot_type == MVM_ARRAY_I64)
+            ins->info = MVM_op_get_op(MVM_OP_sp_iter_shift_arr_i);
+        else if (opcode == MVM_OP_shift_n && slot_type == MVM_ARRAY_N64)
+            ins->info = MVM_op_get_op(MVM_OP_sp_iter_shift_arr_n);
+        else if (opcode == MVM_OP_shift_s && slot_type == MVM_ARRAY_STR)
+            ins->info = MVM_op_get_op(MVM_OP_sp_iter_shift_arr_s);
+    }
+}
+
 /* Set the size of the STable. */
 static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
     st->size = sizeof(MVMIter);
@@ -207,7 +242,7 @@ static const MVMREPROps MVMIter_this_repr = {
     NULL, /* gc_mark_repr_data */
     NULL, /* gc_free_repr_data */
     compose,
-    NULL, /* spesh */
+    spesh,
     "VMIter", /* name */
     MVM_REPR_ID_MVMIter,
     NULL, /* unmanaged_size */
@@ -237,9 +272,9 @@ MVMObject * MVM_iter(MVMThreadContext *tc, MVMObject *target) {
             iterator = (MVMIter *)MVM_repr_alloc_init(tc,
                 MVM_hll_current(tc)->hash_iterator_type);
             iterator->body.mode = MVM_ITER_MODE_HASH;
-            MVMStrHashTable *hashtable = &(((MVMHash *)target)->body.hashtable);
-            iterator->body.hash_state.curr = MVM_str_hash_start(tc, hashtable);
-            iterator->body.hash_state.next = MVM_str_hash_first(tc, hashtable);
+            MVMHashBody *hash = &(((MVMHash *)target)->body);
+            iterator->body.hash_state.curr = MVM_hash_start(tc, hash);
+            iterator->body.hash_state.next = MVM_hash_first(tc, hash);
             MVM_ASSIGN_REF(tc, &(iterator->common.header), iterator->body.target, target);
         }
         else if (REPR(target)->ID == MVM_REPR_ID_MVMContext) {
@@ -276,21 +311,7 @@ MVMString * MVM_iterkey_s(MVMThreadContext *tc, MVMIter *iterator) {
             || iterator->body.mode != MVM_ITER_MODE_HASH)
         MVM_exception_throw_adhoc(tc, "This is not a hash iterator, it's a %s (%s)", REPR(iterator)->name, MVM_6model_get_debug_name(tc, (MVMObject *)iterator));
 
-    MVMStrHashTable *hashtable = &(((MVMHash *)iterator->body.target)->body.hashtable);
-
-#if HASH_DEBUG_ITER
-        if (iterator->body.hash_state.next.owner != hashtable->ht_id) {
-            MVM_oops(tc, "MVM_itereky_s called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
-                     iterator->body.hash_state.next.owner, hashtable->ht_id);
-        }
-#endif
-
-    if (MVM_str_hash_at_end(tc, hashtable, iterator->body.hash_state.curr)
-        || MVM_str_hash_at_start(tc, hashtable, iterator->body.hash_state.curr))
-        MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
-
-    struct MVMHashEntry *entry = MVM_str_hash_current_nocheck(tc, hashtable, iterator->body.hash_state.curr);
-    return entry->hash_handle.key;
+    return MVM_iterkey_s_hash(tc, iterator);
 }
 
 MVMObject * MVM_iterval(MVMThreadContext *tc, MVMIter *iterator) {
@@ -307,25 +328,110 @@ MVMObject * MVM_iterval(MVMThreadContext *tc, MVMIter *iterator) {
         REPR(target)->pos_funcs.at_pos(tc, STABLE(target), target, OBJECT_BODY(target), body->array_state.index, &result, MVM_reg_obj);
     }
     else if (iterator->body.mode == MVM_ITER_MODE_HASH) {
-        MVMStrHashTable *hashtable = &(((MVMHash *)iterator->body.target)->body.hashtable);
+        result.o = MVM_iterval_hash(tc, iterator);
+    }
+    else {
+        MVM_exception_throw_adhoc(tc, "Unknown iterator mode in iterval");
+    }
+    return result.o;
+}
 
+/* Advances a hash iterator, returning it. */
+MVMObject * MVM_iter_shift_hash(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMIterBody *body = &iterator->body;
+    MVMHashBody *hash = &(((MVMHash *)body->target)->body);
 #if HASH_DEBUG_ITER
-        if (iterator->body.hash_state.next.owner != hashtable->ht_id) {
-        MVM_oops(tc, "MVM_iterval called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
-                 iterator->body.hash_state.next.owner, hashtable->ht_id);
-        }
+    MVMStrHashTable *hashtable = &(hash->hashtable);
+    if (MVM_hash_uses_table(tc, hash) && body->hash_state.curr.owner != hashtable->ht_id) {
+        MVM_oops(tc, "MVMIter shift called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
+                 body->hash_state.curr.owner, hashtable->ht_id);
+    }
+    /* OK, to implement "delete at current iterator position" we need
+     * to cheat somewhat. */
+    if (MVM_hash_uses_table(tc, hash)
+            && MVM_str_hash_iterator_target_deleted(tc, hashtable, body->hash_state.curr)) {
+        /* The only action taken on the hash was to delete at the
+         * current iterator. In which case, the "next" iterator is
+         * valid (but has already been advanced beyond pos, so we
+         * can't perform this test on it). So "fix up" its state to pass
+         * muster with the HASH_DEBUG_ITER sanity tests. */
+        body->hash_state.next.serial = hashtable->serial;
+    }
 #endif
+    body->hash_state.curr = body->hash_state.next;
+    if (MVM_hash_at_end(tc, hash, body->hash_state.curr))
+        MVM_exception_throw_adhoc(tc, "Iteration past end of iterator");
+    body->hash_state.next = MVM_hash_next_nocheck(tc, hash, body->hash_state.curr);
+    return (MVMObject *)iterator;
+}
+
+/* Gets the key and the value a hash iterator is at. */
+MVMString * MVM_iterkey_s_hash(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMHashBody *hash = &(((MVMHash *)iterator->body.target)->body);
+    struct MVMHashEntry *entry;
 
-        if (MVM_str_hash_at_end(tc, hashtable, iterator->body.hash_state.curr)
-            || MVM_str_hash_at_start(tc, hashtable, iterator->body.hash_state.curr))
-            MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
-        struct MVMHashEntry *entry = MVM_str_hash_current_nocheck(tc, hashtable, iterator->body.hash_state.curr);
-        result.o = entry->value;
-        if (!result.o)
-            result.o = tc->instance->VMNull;
+#if HASH_DEBUG_ITER
+    MVMStrHashTable *hashtable = &(hash->hashtable);
+    if (MVM_hash_uses_table(tc, hash) && iterator->body.hash_state.next.owner != hashtable->ht_id) {
+        MVM_oops(tc, "MVM_itereky_s called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
+                 iterator->body.hash_state.next.owner, hashtable->ht_id);
     }
-    else {
-        MVM_exception_throw_adhoc(tc, "Unknown iterator mode in iterval");
+#endif
+
+    if (MVM_hash_at_end(tc, hash, iterator->body.hash_state.curr)
+        || MVM_hash_at_start(tc, hash, iterator->body.hash_state.curr))
+        MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
+    entry = MVM_hash_current_nocheck(tc, hash, iterator->body.hash_state.curr);
+    return entry->hash_handle.key;
+}
+
+MVMObject * MVM_iterval_hash(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMHashBody *hash = &(((MVMHash *)iterator->body.target)->body);
+    struct MVMHashEntry *entry;
+
+#if HASH_DEBUG_ITER
+    MVMStrHashTable *hashtable = &(hash->hashtable);
+    if (MVM_hash_uses_table(tc, hash) && iterator->body.hash_state.next.owner != hashtable->ht_id) {
+        MVM_oops(tc, "MVM_iterval called with an iterator from a different hash table: %016" PRIx64 " != %016" PRIx64,
+                 iterator->body.hash_state.next.owner, hashtable->ht_id);
     }
-    return result.o;
+#endif
+
+    if (MVM_hash_at_end(tc, hash, iterator->body.hash_state.curr)
+        || MVM_hash_at_start(tc, hash, iterator->body.hash_state.curr))
+        MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
+    entry = MVM_hash_current_nocheck(tc, hash, iterator->body.hash_state.curr);
+    return entry->value ? entry->value : tc->instance->VMNull;
+}
+
+/* Advances an iterator over a VMArray, giving the index into the slots of
+ * the element it is now at, or -1 if the array has since shrunk past it. */
+static MVMint64 shift_array_slot(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMArrayBody *array = &(((MVMArray *)iterator->body.target)->body);
+    MVMint64 index = ++iterator->body.array_state.index;
+    if (index >= iterator->body.array_state.limit)
+        MVM_exception_throw_adhoc(tc, "Iteration past end of iterator");
+    return (MVMuint64)index < array->elems ? (MVMint64)(array->start + index) : -1;
+}
+
+/* Shifts from iterators over a VMArray with object, 64-bit int, 64-bit num
+ * or str slots, which spesh has already checked the array to have; these
+ * read the slots directly, rather than going through the REPR. */
+MVMObject * MVM_iter_shift_array_o(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMint64 slot = shift_array_slot(tc, iterator);
+    MVMObject *found = slot < 0 ? NULL
+        : ((MVMArray *)iterator->body.target)->body.slots.o[slot];
+    return found ? found : tc->instance->VMNull;
+}
+MVMint64 MVM_iter_shift_array_i(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMint64 slot = shift_array_slot(tc, iterator);
+    return slot < 0 ? 0 : ((MVMArray *)iterator->body.target)->body.slots.i64[slot];
+}
+MVMnum64 MVM_iter_shift_array_n(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMint64 slot = shift_array_slot(tc, iterator);
+    return slot < 0 ? 0.0 : ((MVMArray *)iterator->body.target)->body.slots.n64[slot];
+}
+MVMString * MVM_iter_shift_array_s(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMint64 slot = shift_array_slot(tc, iterator);
+    return slot < 0 ? NULL : ((MVMArray *)iterator->body.target)->body.slots.s[slot];
 }
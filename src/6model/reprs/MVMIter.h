@@ -37,6 +37,13 @@ MVMObject * MVM_iter(MVMThreadContext *tc, MVMObject *target);
 MVMint64 MVM_iter_istrue(MVMThreadContext *tc, MVMIter *iter);
 MVMString * MVM_iterkey_s(MVMThreadContext *tc, MVMIter *iterator);
 MVMObject * MVM_iterval(MVMThreadContext *tc, MVMIter *iterator);
+MVMObject * MVM_iter_shift_hash(MVMThreadContext *tc, MVMIter *iterator);
+MVMString * MVM_iterkey_s_hash(MVMThreadContext *tc, MVMIter *iterator);
+MVMObject * MVM_iterval_hash(MVMThreadContext *tc, MVMIter *iterator);
+MVMObject * MVM_iter_shift_array_o(MVMThreadContext *tc, MVMIter *iterator);
+MVMint64 MVM_iter_shift_array_i(MVMThreadContext *tc, MVMIter *iterator);
+MVMnum64 MVM_iter_shift_array_n(MVMThreadContext *tc, MVMIter *iterator);
+MVMString * MVM_iter_shift_array_s(MVMThreadContext *tc, MVMIter *iterator);
 
 MVM_STATIC_INLINE MVMint64 MVM_iter_istrue_array(MVMThreadContext *tc, MVMIter *iterator) {
     return iterator->body.array_state.index + 1 < iterator->body.array_state.limit ? 1 : 0;
@@ -44,7 +51,12 @@ MVM_STATIC_INLINE MVMint64 MVM_iter_istrue_array(MVMThreadContext *tc, MVMIter *
 
 MVM_STATIC_INLINE MVMint64 MVM_iter_istrue_hash(MVMThreadContext *tc, MVMIter *iterator) {
     MVMIterBody *body = &iterator->body;
-    MVMStrHashTable *hashtable = &(((MVMHash *)body->target)->body.hashtable);
+    MVMHashBody *hash = &(((MVMHash *)body->target)->body);
+    MVMStrHashTable *hashtable = &(hash->hashtable);
+
+    /* In the small and ordered modes the end is also position 0. */
+    if (!MVM_hash_uses_table(tc, hash))
+        return body->hash_state.next.pos == 0 ? 0 : 1;
 
 #if HASH_DEBUG_ITER
     if (body->hash_state.curr.owner != hashtable->ht_id) {
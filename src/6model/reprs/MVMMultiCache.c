@@ -30,6 +30,11 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
         MVM_gc_worklist_add(tc, worklist, &(mc->results[i]));
 }
 
+/* The amount of memory a hashed cache uses. */
+static size_t hashed_memory_size(MVMMultiCacheHash *hashed) {
+    return sizeof(MVMMultiCacheHash) + (hashed->size - 1) * sizeof(MVMMultiCacheHashEntry);
+}
+
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMMultiCache *mc = (MVMMultiCache *)obj;
@@ -40,6 +45,9 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
         MVM_fixed_size_free(tc, tc->instance->fsa,
             mc->body.num_results * sizeof(MVMObject *),
             mc->body.results);
+    if (mc->body.hashed)
+        MVM_fixed_size_free(tc, tc->instance->fsa,
+            hashed_memory_size(mc->body.hashed), mc->body.hashed);
 }
 
 static const MVMStorageSpec storage_spec = {
@@ -64,7 +72,8 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
 /* Calculates the non-GC-managed memory we hold on to. */
 static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
     MVMMultiCacheBody *body = (MVMMultiCacheBody *)data;
-    return body->num_results * sizeof(MVMObject *) + body->cache_memory_size;
+    return body->num_results * sizeof(MVMObject *) + body->cache_memory_size
+        + (body->hashed ? hashed_memory_size(body->hashed) : 0);
 }
 
 /* Initializes the representation. */
@@ -142,6 +151,140 @@ MVM_STATIC_INLINE size_t hash_callsite(MVMThreadContext *tc, MVMCallsite *cs) {
     return ((size_t)cs >> 3) & MVM_MULTICACHE_HASH_FILTER;
 }
 
+/* Calculates the matcher flags for each of the object arguments, putting them
+ * into match_flags by argument index, and the argument index of each object
+ * argument in turn into match_arg_idx. Returns the number of object arguments,
+ * or -1 if one of them is in a container that may run code to fetch from, in
+ * which case the dispatch can't be cached. */
+static MVMint32 calculate_match_flags(MVMThreadContext *tc, MVMCallsite *cs, MVMRegister *args,
+                                      MVMuint64 *match_flags, size_t *match_arg_idx) {
+    MVMuint32 flag, i, num_obj_args = 0;
+    for (i = 0, flag = 0; flag < cs->flag_count; i++, flag++) {
+        if (cs->arg_flags[flag] & MVM_CALLSITE_ARG_NAMED)
+            i++;
+        if ((cs->arg_flags[flag] & MVM_CALLSITE_ARG_MASK) == MVM_CALLSITE_ARG_OBJ) {
+            MVMRegister  arg   = args[i];
+            MVMSTable   *st    = STABLE(arg.o);
+            MVMuint32    is_rw = 0;
+            if (st->container_spec && IS_CONCRETE(arg.o)) {
+                MVMContainerSpec const *contspec = st->container_spec;
+                if (!contspec->fetch_never_invokes)
+                    return -1;
+                if (REPR(arg.o)->ID != MVM_REPR_ID_NativeRef) {
+                    is_rw = contspec->can_store(tc, arg.o);
+                    contspec->fetch(tc, arg.o, &arg);
+                }
+                else {
+                    is_rw = 1;
+                }
+            }
+            match_flags[i] = STABLE(arg.o)->type_cache_id |
+                (is_rw ? MVM_MULTICACHE_ARG_RW_FILTER : 0) |
+                (IS_CONCRETE(arg.o) ? MVM_MULTICACHE_ARG_CONC_FILTER : 0);
+            match_arg_idx[num_obj_args] = i;
+            num_obj_args++;
+        }
+    }
+    return num_obj_args;
+}
+
+/* Hashes a callsite and a tuple of arg matchers for the hashed cache. */
+static MVMuint64 hash_entry_key(MVMCallsite *cs, MVMuint64 *arg_match, MVMuint32 num_args) {
+    MVMuint64 hash = (MVMuint64)(size_t)cs >> 3;
+    MVMuint32 i;
+    for (i = 0; i < num_args; i++)
+        hash = (hash ^ arg_match[i]) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 32);
+}
+
+/* Puts an entry into a hashed cache, which must have a free slot. */
+static void insert_hashed(MVMMultiCacheHash *hashed, MVMCallsite *cs, MVMuint64 *arg_match,
+                          MVMuint32 num_args, MVMuint32 result) {
+    MVMuint32 mask = hashed->size - 1;
+    MVMuint32 slot = (MVMuint32)hash_entry_key(cs, arg_match, num_args) & mask;
+    MVMMultiCacheHashEntry *entry;
+    while (hashed->entries[slot].cs)
+        slot = (slot + 1) & mask;
+    entry = &(hashed->entries[slot]);
+    entry->cs = cs;
+    memcpy(entry->arg_match, arg_match, num_args * sizeof(MVMuint64));
+    entry->num_args = num_args;
+    entry->result = result;
+    hashed->used++;
+}
+
+/* Walks the arg matchers of a tree from the given node, hashing every entry
+ * found, with the matchers leading to the node in arg_match. */
+static void hash_tree_args(MVMMultiCacheHash *hashed, MVMMultiCacheNode *tree, MVMint32 cur_node,
+                           MVMCallsite *cs, MVMuint64 *arg_match, MVMuint32 depth) {
+    while (cur_node > 0) {
+        MVMint32 match = tree[cur_node].match;
+        arg_match[depth] = tree[cur_node].action.arg_match;
+        if (match < 0)
+            insert_hashed(hashed, cs, arg_match, depth + 1, -match);
+        else
+            hash_tree_args(hashed, tree, match, cs, arg_match, depth + 1);
+        cur_node = tree[cur_node].no_match;
+    }
+}
+
+/* Builds a hashed cache holding all of the entries of a tree, sized so that
+ * it is at most a quarter full. */
+static MVMMultiCacheHash * build_hashed(MVMThreadContext *tc, MVMMultiCacheNode *tree,
+                                        size_t num_entries) {
+    MVMMultiCacheHash *hashed;
+    MVMuint64 arg_match[MVM_INTERN_ARITY_LIMIT];
+    MVMuint32 size = 4;
+    size_t i;
+    while (size < 4 * num_entries)
+        size *= 2;
+    hashed = MVM_fixed_size_alloc_zeroed(tc, tc->instance->fsa,
+        sizeof(MVMMultiCacheHash) + (size - 1) * sizeof(MVMMultiCacheHashEntry));
+    hashed->size = size;
+    for (i = 0; i < MVM_MULTICACHE_HASH_SIZE; i++) {
+        MVMint32 cur_node = i;
+        if (!tree[cur_node].action.cs)
+            continue;
+        do {
+            MVMCallsite *cs = tree[cur_node].action.cs;
+            MVMint32 match = tree[cur_node].match;
+            if (match < 0)
+                insert_hashed(hashed, cs, arg_match, 0, -match);
+            else
+                hash_tree_args(hashed, tree, match, cs, arg_match, 0);
+            cur_node = tree[cur_node].no_match;
+        } while (cur_node > 0);
+    }
+    return hashed;
+}
+
+/* Looks up a callsite and args in a hashed cache. */
+static MVMObject * find_hashed(MVMThreadContext *tc, MVMMultiCacheBody *cache,
+                               MVMMultiCacheHash *hashed, MVMCallsite *cs, MVMRegister *args) {
+    MVMuint64 match_flags[2 * MVM_INTERN_ARITY_LIMIT];
+    size_t    match_arg_idx[MVM_INTERN_ARITY_LIMIT];
+    MVMuint64 arg_match[MVM_INTERN_ARITY_LIMIT];
+    MVMint32  num_args = calculate_match_flags(tc, cs, args, match_flags, match_arg_idx);
+    MVMuint32 mask, slot;
+    MVMint32  i;
+    if (num_args < 0)
+        return NULL;
+    for (i = 0; i < num_args; i++)
+        arg_match[i] = match_flags[match_arg_idx[i]] | match_arg_idx[i];
+    mask = hashed->size - 1;
+    slot = (MVMuint32)hash_entry_key(cs, arg_match, num_args) & mask;
+    while (hashed->entries[slot].cs) {
+        MVMMultiCacheHashEntry *entry = &(hashed->entries[slot]);
+        if (entry->cs == cs && memcmp(entry->arg_match, arg_match, num_args * sizeof(MVMuint64)) == 0)
+            return cache->results[entry->result];
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+static MVMObject * find_callsite_args(MVMThreadContext *tc, MVMObject *cache_obj,
+    MVMCallsite *cs, MVMRegister *args);
+
 /* Adds an entry to the multi-dispatch cache. */
 MVMObject * MVM_multi_cache_add(MVMThreadContext *tc, MVMObject *cache_obj, MVMObject *capture, MVMObject *result) {
     MVMMultiCacheBody *cache = NULL;
@@ -149,12 +292,14 @@ MVMObject * MVM_multi_cache_add(MVMThreadContext *tc, MVMObject *cache_obj, MVMO
     MVMArgProcContext *apc   = NULL;
     MVMuint64          match_flags[2 * MVM_INTERN_ARITY_LIMIT];
     size_t             match_arg_idx[MVM_INTERN_ARITY_LIMIT];
-    MVMuint32          flag, i, num_obj_args, have_head, have_tree,
+    MVMint32           num_obj_args_calc;
+    MVMuint32          i, num_obj_args, have_head, have_tree,
                        have_callsite, matched_args, unmatched_arg,
                        tweak_node, insert_node;
     size_t             new_size;
     MVMMultiCacheNode *new_head    = NULL;
     MVMObject        **new_results = NULL;
+    MVMMultiCacheHash *new_hashed  = NULL;
 
     /* Allocate a cache if needed. */
     if (MVM_is_null(tc, cache_obj) || !IS_CONCRETE(cache_obj) || REPR(cache_obj)->ID != MVM_REPR_ID_MVMMultiCache) {
@@ -176,38 +321,15 @@ MVMObject * MVM_multi_cache_add(MVMThreadContext *tc, MVMObject *cache_obj, MVMO
     }
 
     /* Calculate matcher flags for all the object arguments. */
-    num_obj_args = 0;
-    for (i = 0, flag = 0; flag < cs->flag_count; i++, flag++) {
-        if (cs->arg_flags[flag] & MVM_CALLSITE_ARG_NAMED)
-            i++;
-        if ((cs->arg_flags[flag] & MVM_CALLSITE_ARG_MASK) == MVM_CALLSITE_ARG_OBJ) {
-            MVMRegister  arg   = apc->args[i];
-            MVMSTable   *st    = STABLE(arg.o);
-            MVMuint32    is_rw = 0;
-            if (st->container_spec && IS_CONCRETE(arg.o)) {
-                MVMContainerSpec const *contspec = st->container_spec;
-                if (!contspec->fetch_never_invokes)
-                    return cache_obj; /* Impossible to cache. */
-                if (REPR(arg.o)->ID != MVM_REPR_ID_NativeRef) {
-                    is_rw = contspec->can_store(tc, arg.o);
-                    contspec->fetch(tc, arg.o, &arg);
-                }
-                else {
-                    is_rw = 1;
-                }
-            }
-            match_flags[i] = STABLE(arg.o)->type_cache_id |
-                (is_rw ? MVM_MULTICACHE_ARG_RW_FILTER : 0) |
-                (IS_CONCRETE(arg.o) ? MVM_MULTICACHE_ARG_CONC_FILTER : 0);
-            match_arg_idx[num_obj_args] = i;
-            num_obj_args++;
-        }
-    }
+    num_obj_args_calc = calculate_match_flags(tc, cs, apc->args, match_flags, match_arg_idx);
+    if (num_obj_args_calc < 0)
+        return cache_obj; /* Impossible to cache. */
+    num_obj_args = (MVMuint32)num_obj_args_calc;
 
     /* Oobtain the cache addition lock, and then do another lookup to ensure
      * nobody beat us to making this entry. */
     uv_mutex_lock(&(tc->instance->mutex_multi_cache_add));
-    if (MVM_multi_cache_find(tc, cache_obj, capture))
+    if (find_callsite_args(tc, cache_obj, cs, apc->args))
         goto DONE;
 
     /* We're now udner the insertion lock and know nobody else can tweak the
@@ -256,7 +378,7 @@ MVMObject * MVM_multi_cache_add(MVMThreadContext *tc, MVMObject *cache_obj, MVMO
          * checked for non-entry above. */
         if (cur_node != 0)
             MVM_panic(1, "Corrupt multi dispatch cache: cur_node != 0, re-check == %p",
-                MVM_multi_cache_find(tc, cache_obj, capture));
+                find_callsite_args(tc, cache_obj, cs, apc->args));
     }
 
     /* Now calculate the new size we'll need to allocate. */
@@ -337,12 +459,20 @@ MVMObject * MVM_multi_cache_add(MVMThreadContext *tc, MVMObject *cache_obj, MVMO
     /* Associate final node with result index. */
     new_head[tweak_node].match = -(cache->num_results - 1);
 
+    /* Hash the entries too, if there are enough of them. */
+    if (cache->num_results - 1 >= MVM_MULTICACHE_HASHED_FROM)
+        new_hashed = build_hashed(tc, new_head, cache->num_results - 1);
+
     /* Update the rest. */
     if (cache->node_hash_head)
         MVM_fixed_size_free_at_safepoint(tc, tc->instance->fsa,
             cache->cache_memory_size, cache->node_hash_head);
+    if (cache->hashed)
+        MVM_fixed_size_free_at_safepoint(tc, tc->instance->fsa,
+            hashed_memory_size(cache->hashed), cache->hashed);
     cache->node_hash_head = new_head;
     cache->cache_memory_size = new_size;
+    cache->hashed = new_hashed;
 
 #if MVM_MULTICACHE_DEBUG
     printf("Made new entry for callsite with %d object arguments\n", num_obj_args);
@@ -377,11 +507,21 @@ MVMObject * MVM_multi_cache_find(MVMThreadContext *tc, MVMObject *cache_obj, MVM
     }
 }
 
-/* Does a lookup in the multi-dispatch cache using a callsite and args. */
+/* Does a lookup in the multi-dispatch cache using a callsite and args,
+ * counting it as a hit or a miss when profiling. */
 MVMObject * MVM_multi_cache_find_callsite_args(MVMThreadContext *tc, MVMObject *cache_obj,
     MVMCallsite *cs, MVMRegister *args) {
-    MVMMultiCacheBody *cache = NULL;
-    MVMMultiCacheNode *tree  = NULL;
+    MVMObject *result = find_callsite_args(tc, cache_obj, cs, args);
+    if (tc->instance->profiling)
+        MVM_profiler_log_multi_cache(tc, result != NULL);
+    return result;
+}
+
+static MVMObject * find_callsite_args(MVMThreadContext *tc, MVMObject *cache_obj,
+    MVMCallsite *cs, MVMRegister *args) {
+    MVMMultiCacheBody *cache  = NULL;
+    MVMMultiCacheNode *tree   = NULL;
+    MVMMultiCacheHash *hashed = NULL;
     MVMint32 cur_node;
 
     /* Bail if callsite not interned. */
@@ -395,6 +535,11 @@ MVMObject * MVM_multi_cache_find_callsite_args(MVMThreadContext *tc, MVMObject *
     if (!cache->node_hash_head)
         return NULL;
 
+    /* If there's a hashed cache, it has all the entries; use it. */
+    hashed = cache->hashed;
+    if (hashed)
+        return find_hashed(tc, cache, hashed, cs, args);
+
     /* Use hashed callsite to find the node to start with. */
     cur_node = hash_callsite(tc, cs);
 
@@ -495,11 +640,11 @@ MVMObject * MVM_multi_cache_find_spesh(MVMThreadContext *tc, MVMObject *cache_ob
             MVMSTable *known_type_st = NULL;
             MVMuint32 is_conc;
             if (type_tuple[tt_offset].decont_type) {
-                known_type_st = type_tuple[tt_offset].decont_type->st;
+                known_type_st = STABLE(type_tuple[tt_offset].decont_type);
                 is_conc = type_tuple[tt_offset].decont_type_concrete;
             }
             else if (type_tuple[tt_offset].type) { /* FIXME: tuples with neither decont_type nor type shouldn't appear */
-                known_type_st = type_tuple[tt_offset].type->st;
+                known_type_st = STABLE(type_tuple[tt_offset].type);
                 is_conc = type_tuple[tt_offset].type_concrete;
             }
 
@@ -29,6 +29,13 @@
  * kept in thier CPU caches. Upon a new entry, the cache will be copied, and the
  * tweaks made. The cache head pointer will then be set to the new cache, and the
  * old cache memory scheduled for freeeing at the next safepoint.
+ *
+ * Walking the tree means trying each of the types seen for an argument in turn
+ * though, which gets slow for megamorphic multis, such as operators that are
+ * called with dozens of type combinations. So once a cache has enough entries,
+ * they also go into a hash keyed on the callsite and the full tuple of
+ * argument matchers, which lookups with args use instead. It is immutable and
+ * replaced on change just like the tree.
  */
 
 /* A node in the cache. */
@@ -41,6 +48,26 @@ struct MVMMultiCacheNode {
     MVMint32 no_match;
 };
 
+/* An entry in the hashed cache; an empty slot has a NULL callsite. The arg
+ * matchers are those of the object arguments, in order, as in the tree. */
+struct MVMMultiCacheHashEntry {
+    MVMCallsite *cs;
+    MVMuint64 arg_match[MVM_INTERN_ARITY_LIMIT];
+    MVMuint32 num_args;
+    MVMuint32 result;
+};
+
+/* The hashed cache, using open addressing with linear probing. */
+struct MVMMultiCacheHash {
+    /* Number of slots; a power of 2. */
+    MVMuint32 size;
+
+    /* Number of slots in use. */
+    MVMuint32 used;
+
+    MVMMultiCacheHashEntry entries[1];
+};
+
 /* Body of a multi-dispatch cache. */
 struct MVMMultiCacheBody {
     /* Pointer to the an array of nodes, which we can initially index
@@ -63,12 +90,19 @@ struct MVMMultiCacheBody {
     /* The amount of memory the cache uses. Used for freeing with the fixed
      * size allocator. */
     size_t cache_memory_size;
+
+    /* The hashed cache, if there are enough entries for it. Replaced along
+     * with node_hash_head. */
+    MVMMultiCacheHash *hashed;
 };
 
 /* Hash table size. Must be a power of 2. */
 #define MVM_MULTICACHE_HASH_SIZE    8
 #define MVM_MULTICACHE_HASH_FILTER  (MVM_MULTICACHE_HASH_SIZE - 1)
 
+/* Number of entries a cache needs to have for them to be hashed too. */
+#define MVM_MULTICACHE_HASHED_FROM  16
+
 struct MVMMultiCache {
     MVMObject common;
     MVMMultiCacheBody body;
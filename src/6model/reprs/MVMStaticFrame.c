@@ -195,6 +195,7 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     if (!body->fully_deserialized)
         return;
     MVM_free(body->handlers);
+    MVM_free(body->handler_ranges);
     MVM_free(body->work_initial);
     MVM_free(body->static_env);
     MVM_free(body->static_env_flags);
@@ -26,6 +26,9 @@ struct MVMStaticFrameBody {
     /* If the frame has state variables. */
     MVMuint8 has_state_vars;
 
+    /* If the frame declares any dynamic variables (with the * twigil). */
+    MVMuint8 has_dynamic_lexicals;
+
     /* Should we allocate the frame directly on the heap? Doing so may avoid
      * needing to promote it there later. Set by measuring the number of times
      * the frame is promoted to the heap relative to the number of times it is
@@ -78,6 +81,9 @@ struct MVMStaticFrameBody {
     /* The number of exception handlers this frame has. */
     MVMuint32 num_handlers;
 
+    /* The handlers grouped by the ranges of bytecode they cover. */
+    MVMFrameHandlerRanges *handler_ranges;
+
     /* Is the frame full deserialized? */
     MVMuint8 fully_deserialized;
 
@@ -42,6 +42,7 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
                 MVM_gc_worklist_add(tc, worklist, &body->spesh_candidates[i]->spesh_slots[j]);
             for (j = 0; j < body->spesh_candidates[i]->num_inlines; j++)
                 MVM_gc_worklist_add(tc, worklist, &body->spesh_candidates[i]->inlines[j].sf);
+            MVM_gc_worklist_add(tc, worklist, &body->spesh_candidates[i]->sf);
         }
     }
     MVM_gc_worklist_add(tc, worklist, &body->plugin_state);
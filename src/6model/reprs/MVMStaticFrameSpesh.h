@@ -31,6 +31,10 @@ struct MVMStaticFrameSpeshBody {
      * specialized. Used to decide whether we'll directly allocate this frame
      * on the heap. */
     MVMuint32 num_heap_promotions;
+
+    /* Set when the JIT could not compile a baseline candidate of the frame,
+     * so we don't keep on trying. */
+    MVMuint8 baseline_failed;
 };
 struct MVMStaticFrameSpesh {
     MVMObject common;
@@ -22,6 +22,7 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
     MVMStringBody *src_body     = (MVMStringBody *)src;
     MVMStringBody *dest_body    = (MVMStringBody *)dest;
     dest_body->storage_type     = src_body->storage_type;
+    dest_body->flags            = src_body->flags & ~MVM_STRING_FLAG_INTERNED;
     dest_body->num_strands      = src_body->num_strands;
     dest_body->num_graphs       = src_body->num_graphs;
     dest_body->cached_hash_code = src_body->cached_hash_code;
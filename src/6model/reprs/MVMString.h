@@ -1,12 +1,14 @@
 /* Representation used by VM-level strings.
  *
- * Strings come in one of 3 forms today, with 1 expected future form:
+ * Strings come in one of 4 forms:
  *   - 32-bit buffer of graphemes (Unicode codepoints or synthetic codepoints)
  *   - 8-bit buffer of codepoints that all fall in the ASCII range
+ *   - 8-bit buffer of codepoints with negatives as synthetics (we draw out a
+ *     distinction with the ASCII range buffer because we can do some I/O
+ *     simplifications when we know all is in the ASCII range). Since the
+ *     negative half is taken by synthetics, codepoints 128..255 do not fit,
+ *     and Latin-1 text outside of ASCII needs the 32-bit form.
  *   - Buffer of strands
- *   - (LATER) 8-bit buffer of codepoints with negatives as synthetics (we
- *     draw out a distinction with the ASCII range buffer because we can do
- *     some I/O simplifications when we know all is in the ASCII range).
  *
  * A buffer of strands represents a string made up of other non-strand
  * strings. That is, there's no recursive strands. This simplifies the
@@ -18,7 +20,7 @@
 /* Kinds of grapheme we may hold in a string. */
 typedef MVMint32 MVMGrapheme32;
 typedef MVMint8  MVMGraphemeASCII;
-typedef MVMint8  MVMGrapheme8;       /* Future use */
+typedef MVMint8  MVMGrapheme8;
 
 /* What kind of data is a string storing? */
 #define MVM_STRING_GRAPHEME_32      0
@@ -26,6 +28,19 @@ typedef MVMint8  MVMGrapheme8;       /* Future use */
 #define MVM_STRING_GRAPHEME_8       2
 #define MVM_STRING_STRAND           3
 
+/* Facts about a string's graphemes, worked out lazily and cached in its
+ * flags (see MVM_string_flags). The case stability flags are only ever set
+ * once a case change has been seen to leave the string as it is. */
+#define MVM_STRING_FLAGS_COMPUTED         1
+#define MVM_STRING_FLAG_ALL_ASCII         2
+#define MVM_STRING_FLAG_NO_SYNTHETICS     4
+#define MVM_STRING_FLAG_CASE_STABLE(type) (8 << (type))
+
+/* Set on a string that is the one shared instance of its value, so that two
+ * different strings both with it set are known to be unequal. It is only
+ * ever set before the string is shared, and never copied. */
+#define MVM_STRING_FLAG_INTERNED          128
+
 /* String index data type, for when we talk about indexes. */
 typedef MVMuint32 MVMStringIndex;
 
@@ -44,7 +59,8 @@ struct MVMStringBody {
         MVMStringStrand  *strands;
         void             *any;
     } storage;
-    MVMuint16 storage_type;
+    MVMuint8  storage_type;
+    MVMuint8  flags;
     MVMuint16 num_strands;
     MVMuint32 num_graphs;
     MVMHashv  cached_hash_code;
@@ -40,6 +40,7 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     /* The ThreadContext has already been destroyed by the GC. */
     MVMThread *thread = (MVMThread *)obj;
     thread->body.invokee = NULL;
+    MVM_free(thread->body.affinity);
 }
 
 static const MVMStorageSpec storage_spec = {
@@ -36,6 +36,13 @@ struct MVMThreadBody {
     /* Non-zero if the thread should not block shutdown of the VM (those with
      * zero in here will be joined when the main thread ends). */
     MVMint32 app_lifetime;
+
+    /* The CPUs to pin the thread to when it starts, as a mask of
+     * MVM_CPU_SET_WORDS words (NULL if it was not set), and the priority to
+     * give it, if one was set. */
+    MVMuint64 *affinity;
+    MVMint32   priority;
+    MVMuint8   has_priority;
 };
 struct MVMThread {
     MVMObject common;
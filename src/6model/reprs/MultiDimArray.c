@@ -786,6 +786,278 @@ static AO_t * pos_as_atomic(MVMThreadContext *tc, MVMSTable *st, MVMObject *root
 }
 
 
+/* Checks an object is a concrete multi-dim array of native elements, as the
+ * bulk operations, which work straight on the flat storage, need. */
+static MVMMultiDimArrayREPRData * native_repr_data(MVMThreadContext *tc, MVMObject *obj, const char *what) {
+    MVMMultiDimArrayREPRData *repr_data;
+    if (!IS_CONCRETE(obj) || REPR(obj)->ID != MVM_REPR_ID_MultiDimArray)
+        MVM_exception_throw_adhoc(tc, "%s needs a concrete MultiDimArray", what);
+    repr_data = (MVMMultiDimArrayREPRData *)STABLE(obj)->REPR_data;
+    if (repr_data->slot_type == MVM_ARRAY_OBJ || repr_data->slot_type == MVM_ARRAY_STR)
+        MVM_exception_throw_adhoc(tc, "%s needs a MultiDimArray of native numbers", what);
+    return repr_data;
+}
+
+/* Checks two native multi-dim arrays have the same element type and shape,
+ * returning the number of elements they have. */
+static MVMint64 check_same_shape(MVMThreadContext *tc, MVMObject *a, MVMObject *b, const char *what) {
+    MVMMultiDimArrayREPRData *a_repr_data = native_repr_data(tc, a, what);
+    MVMMultiDimArrayREPRData *b_repr_data = native_repr_data(tc, b, what);
+    MVMint64 *a_dims = ((MVMMultiDimArray *)a)->body.dimensions;
+    MVMint64 *b_dims = ((MVMMultiDimArray *)b)->body.dimensions;
+    if (a_repr_data->slot_type != b_repr_data->slot_type
+            || a_repr_data->num_dimensions != b_repr_data->num_dimensions
+            || memcmp(a_dims, b_dims, a_repr_data->num_dimensions * sizeof(MVMint64)) != 0)
+        MVM_exception_throw_adhoc(tc, "%s needs arrays of the same element type and shape", what);
+    return flat_elements(a_repr_data->num_dimensions, a_dims);
+}
+
+#define FILL(field, type) \
+    for (i = 0; i < n; i++) \
+        body->slots.field[i] = (type)value; \
+    break;
+
+/* Sets every element of a native integer multi-dim array. */
+void MVM_MultiDimArray_fill_i(MVMThreadContext *tc, MVMObject *obj, MVMint64 value) {
+    MVMMultiDimArrayREPRData *repr_data = native_repr_data(tc, obj, "mdfill_i");
+    MVMMultiDimArrayBody     *body      = &((MVMMultiDimArray *)obj)->body;
+    MVMint64 n = flat_elements(repr_data->num_dimensions, body->dimensions);
+    MVMint64 i;
+    switch (repr_data->slot_type) {
+        case MVM_ARRAY_I64: FILL(i64, MVMint64)
+        case MVM_ARRAY_I32: FILL(i32, MVMint32)
+        case MVM_ARRAY_I16: FILL(i16, MVMint16)
+        case MVM_ARRAY_I8:  FILL(i8,  MVMint8)
+        case MVM_ARRAY_U64: FILL(u64, MVMuint64)
+        case MVM_ARRAY_U32: FILL(u32, MVMuint32)
+        case MVM_ARRAY_U16: FILL(u16, MVMuint16)
+        case MVM_ARRAY_U8:  FILL(u8,  MVMuint8)
+        default:
+            MVM_exception_throw_adhoc(tc, "mdfill_i needs a MultiDimArray of native integers");
+    }
+}
+
+/* Sets every element of a native num multi-dim array. */
+void MVM_MultiDimArray_fill_n(MVMThreadContext *tc, MVMObject *obj, MVMnum64 value) {
+    MVMMultiDimArrayREPRData *repr_data = native_repr_data(tc, obj, "mdfill_n");
+    MVMMultiDimArrayBody     *body      = &((MVMMultiDimArray *)obj)->body;
+    MVMint64 n = flat_elements(repr_data->num_dimensions, body->dimensions);
+    MVMint64 i;
+    switch (repr_data->slot_type) {
+        case MVM_ARRAY_N64: FILL(n64, MVMnum64)
+        case MVM_ARRAY_N32: FILL(n32, MVMnum32)
+        default:
+            MVM_exception_throw_adhoc(tc, "mdfill_n needs a MultiDimArray of native nums");
+    }
+}
+
+#undef FILL
+
+/* Copies all elements of a native multi-dim array into another of the same
+ * element type and shape. */
+void MVM_MultiDimArray_copy(MVMThreadContext *tc, MVMObject *dest, MVMObject *src) {
+    MVMint64 n = check_same_shape(tc, dest, src, "mdcopy");
+    memmove(((MVMMultiDimArray *)dest)->body.slots.any, ((MVMMultiDimArray *)src)->body.slots.any,
+        n * ((MVMMultiDimArrayREPRData *)STABLE(src)->REPR_data)->elem_size);
+}
+
+/* Transposes a 2D native array into another, which must have the same
+ * element type and the swapped dimensions. It's done a square block at a
+ * time, so that both the rows being read and those written stay in cache. */
+#define TRANSPOSE_BLOCK 32
+#define TRANSPOSE(type) { \
+    type       *d = (type *)dest_body->slots.any; \
+    const type *s = (const type *)src_body->slots.any; \
+    for (r0 = 0; r0 < rows; r0 += TRANSPOSE_BLOCK) { \
+        MVMint64 r_end = r0 + TRANSPOSE_BLOCK < rows ? r0 + TRANSPOSE_BLOCK : rows; \
+        for (c0 = 0; c0 < cols; c0 += TRANSPOSE_BLOCK) { \
+            MVMint64 c_end = c0 + TRANSPOSE_BLOCK < cols ? c0 + TRANSPOSE_BLOCK : cols; \
+            for (r = r0; r < r_end; r++) \
+                for (c = c0; c < c_end; c++) \
+                    d[c * rows + r] = s[r * cols + c]; \
+        } \
+    } \
+    break; \
+}
+void MVM_MultiDimArray_transpose(MVMThreadContext *tc, MVMObject *dest, MVMObject *src) {
+    MVMMultiDimArrayREPRData *dest_repr_data = native_repr_data(tc, dest, "mdtranspose");
+    MVMMultiDimArrayREPRData *src_repr_data  = native_repr_data(tc, src, "mdtranspose");
+    MVMMultiDimArrayBody     *dest_body      = &((MVMMultiDimArray *)dest)->body;
+    MVMMultiDimArrayBody     *src_body       = &((MVMMultiDimArray *)src)->body;
+    MVMint64 rows, cols, r0, c0, r, c;
+    if (dest_repr_data->num_dimensions != 2 || src_repr_data->num_dimensions != 2)
+        MVM_exception_throw_adhoc(tc, "mdtranspose needs 2 dimension arrays");
+    if (dest == src)
+        MVM_exception_throw_adhoc(tc, "mdtranspose cannot transpose an array into itself");
+    rows = src_body->dimensions[0];
+    cols = src_body->dimensions[1];
+    if (dest_repr_data->slot_type != src_repr_data->slot_type
+            || dest_body->dimensions[0] != cols || dest_body->dimensions[1] != rows)
+        MVM_exception_throw_adhoc(tc,
+            "mdtranspose needs a %"PRId64"x%"PRId64" array of the same element type to transpose into",
+            cols, rows);
+    switch (src_repr_data->elem_size) {
+        case 8: TRANSPOSE(MVMuint64)
+        case 4: TRANSPOSE(MVMuint32)
+        case 2: TRANSPOSE(MVMuint16)
+        case 1: TRANSPOSE(MVMuint8)
+        default:
+            MVM_exception_throw_adhoc(tc, "mdtranspose: unhandled element size");
+    }
+}
+#undef TRANSPOSE
+#undef TRANSPOSE_BLOCK
+
+/* Sets each element of dest to the result of an operation on the elements
+ * at the same position in a and b, all of which have the same element type
+ * and shape (dest may be either of them). The loops are kept simple, so the
+ * C compiler can vectorize them. Integer division checks for a zero divisor
+ * before anything has been written. */
+#define ELEMWISE_LOOP(expr) \
+    for (i = 0; i < n; i++) \
+        d[i] = (expr); \
+    break;
+#define ELEMWISE(field, type, is_int) { \
+    type       *d = dest_body->slots.field; \
+    const type *x = a_body->slots.field; \
+    const type *y = b_body->slots.field; \
+    switch (op) { \
+        case MVM_MULTIDIM_OP_ADD: ELEMWISE_LOOP(x[i] + y[i]) \
+        case MVM_MULTIDIM_OP_SUB: ELEMWISE_LOOP(x[i] - y[i]) \
+        case MVM_MULTIDIM_OP_MUL: ELEMWISE_LOOP(x[i] * y[i]) \
+        case MVM_MULTIDIM_OP_DIV: \
+            if (is_int) \
+                for (i = 0; i < n; i++) \
+                    if (y[i] == 0) \
+                        MVM_exception_throw_adhoc(tc, "Division by zero"); \
+            ELEMWISE_LOOP(x[i] / y[i]) \
+        case MVM_MULTIDIM_OP_MIN: ELEMWISE_LOOP(x[i] < y[i] ? x[i] : y[i]) \
+        case MVM_MULTIDIM_OP_MAX: ELEMWISE_LOOP(x[i] > y[i] ? x[i] : y[i]) \
+    } \
+    break; \
+}
+void MVM_MultiDimArray_elemwise(MVMThreadContext *tc, MVMObject *dest, MVMObject *a,
+        MVMObject *b, MVMint64 op) {
+    MVMMultiDimArrayBody *dest_body, *a_body, *b_body;
+    MVMint64 n = check_same_shape(tc, dest, a, "mdelemwise");
+    MVMint64 i;
+    check_same_shape(tc, dest, b, "mdelemwise");
+    if (op < MVM_MULTIDIM_OP_ADD || op > MVM_MULTIDIM_OP_MAX)
+        MVM_exception_throw_adhoc(tc, "mdelemwise: unknown operation %"PRId64, op);
+    dest_body = &((MVMMultiDimArray *)dest)->body;
+    a_body    = &((MVMMultiDimArray *)a)->body;
+    b_body    = &((MVMMultiDimArray *)b)->body;
+    switch (((MVMMultiDimArrayREPRData *)STABLE(dest)->REPR_data)->slot_type) {
+        case MVM_ARRAY_I64: ELEMWISE(i64, MVMint64,  1)
+        case MVM_ARRAY_I32: ELEMWISE(i32, MVMint32,  1)
+        case MVM_ARRAY_I16: ELEMWISE(i16, MVMint16,  1)
+        case MVM_ARRAY_I8:  ELEMWISE(i8,  MVMint8,   1)
+        case MVM_ARRAY_U64: ELEMWISE(u64, MVMuint64, 1)
+        case MVM_ARRAY_U32: ELEMWISE(u32, MVMuint32, 1)
+        case MVM_ARRAY_U16: ELEMWISE(u16, MVMuint16, 1)
+        case MVM_ARRAY_U8:  ELEMWISE(u8,  MVMuint8,  1)
+        case MVM_ARRAY_N64: ELEMWISE(n64, MVMnum64,  0)
+        case MVM_ARRAY_N32: ELEMWISE(n32, MVMnum32,  0)
+        default:
+            MVM_exception_throw_adhoc(tc, "mdelemwise: unhandled slot type");
+    }
+}
+#undef ELEMWISE
+#undef ELEMWISE_LOOP
+
+/* Copies n elements of the given size, each stride elements apart in the
+ * source and target. */
+#define COPY_STRIDED(type) { \
+    type       *t = (type *)to; \
+    const type *f = (const type *)from; \
+    for (i = 0; i < n; i++) \
+        t[i * to_stride] = f[i * from_stride]; \
+    break; \
+}
+static void copy_strided(MVMThreadContext *tc, void *to, size_t to_stride,
+        const void *from, size_t from_stride, MVMint64 n, size_t elem_size) {
+    MVMint64 i;
+    switch (elem_size) {
+        case 8: COPY_STRIDED(MVMuint64)
+        case 4: COPY_STRIDED(MVMuint32)
+        case 2: COPY_STRIDED(MVMuint16)
+        case 1: COPY_STRIDED(MVMuint8)
+        default:
+            MVM_exception_throw_adhoc(tc, "MultiDimArray: unhandled element size");
+    }
+}
+#undef COPY_STRIDED
+
+/* Finds the line through a native multi-dim array along dimension dim that
+ * passes through the given indices (of which the one for dim is ignored).
+ * Gives a pointer to its first element, or NULL if it's empty, and how many
+ * elements apart its elements are in the flat storage. */
+static char * find_line(MVMThreadContext *tc, MVMObject *obj, MVMObject *indices,
+        MVMint64 dim, size_t *stride, const char *what) {
+    MVMMultiDimArrayREPRData *repr_data = native_repr_data(tc, obj, what);
+    MVMMultiDimArrayBody     *body      = &((MVMMultiDimArray *)obj)->body;
+    MVMint64 num_indices, i;
+    MVM_repr_populate_indices_array(tc, indices, &num_indices);
+    if (num_indices != repr_data->num_dimensions)
+        MVM_exception_throw_adhoc(tc,
+            "Cannot access %"PRId64" dimension array with %"PRId64" indices",
+            repr_data->num_dimensions, num_indices);
+    if (dim < 0 || dim >= repr_data->num_dimensions)
+        MVM_exception_throw_adhoc(tc, "%s: dimension %"PRId64" out of range (must be 0..%"PRId64")",
+            what, dim, repr_data->num_dimensions - 1);
+    *stride = 1;
+    for (i = dim + 1; i < repr_data->num_dimensions; i++)
+        *stride *= body->dimensions[i];
+    if (body->dimensions[dim] == 0)
+        return NULL;
+    tc->multi_dim_indices[dim] = 0;
+    return (char *)body->slots.any + repr_data->elem_size * indices_to_flat_index(tc,
+        repr_data->num_dimensions, body->dimensions, tc->multi_dim_indices);
+}
+
+/* Checks an object is a concrete native array with the same element type as
+ * a native multi-dim array. */
+static MVMArrayBody * line_array(MVMThreadContext *tc, MVMObject *arr, MVMObject *obj, const char *what) {
+    if (!IS_CONCRETE(arr) || REPR(arr)->ID != MVM_REPR_ID_VMArray
+            || ((MVMArrayREPRData *)STABLE(arr)->REPR_data)->slot_type
+                != ((MVMMultiDimArrayREPRData *)STABLE(obj)->REPR_data)->slot_type)
+        MVM_exception_throw_adhoc(tc, "%s needs a native array of the same element type as the MultiDimArray", what);
+    return &((MVMArray *)arr)->body;
+}
+
+/* Reads a line (such as a row or a column of a matrix) out of a native
+ * multi-dim array into a native array, which is resized to fit it. */
+void MVM_MultiDimArray_read_line(MVMThreadContext *tc, MVMObject *target, MVMObject *obj,
+        MVMObject *indices, MVMint64 dim) {
+    size_t        stride;
+    char         *line      = find_line(tc, obj, indices, dim, &stride, "mdreadline");
+    MVMArrayBody *arr_body  = line_array(tc, target, obj, "mdreadline");
+    MVMint64      n         = ((MVMMultiDimArray *)obj)->body.dimensions[dim];
+    size_t        elem_size = ((MVMMultiDimArrayREPRData *)STABLE(obj)->REPR_data)->elem_size;
+    MVM_repr_pos_set_elems(tc, target, n);
+    if (line)
+        copy_strided(tc, (char *)arr_body->slots.any + arr_body->start * elem_size, 1,
+            line, stride, n, elem_size);
+}
+
+/* Writes the elements of a native array over a line of a native multi-dim
+ * array; it must have exactly as many elements as the line. */
+void MVM_MultiDimArray_write_line(MVMThreadContext *tc, MVMObject *obj, MVMObject *indices,
+        MVMint64 dim, MVMObject *source) {
+    size_t        stride;
+    char         *line      = find_line(tc, obj, indices, dim, &stride, "mdwriteline");
+    MVMArrayBody *arr_body  = line_array(tc, source, obj, "mdwriteline");
+    MVMint64      n         = ((MVMMultiDimArray *)obj)->body.dimensions[dim];
+    size_t        elem_size = ((MVMMultiDimArrayREPRData *)STABLE(obj)->REPR_data)->elem_size;
+    if ((MVMint64)arr_body->elems != n)
+        MVM_exception_throw_adhoc(tc, "mdwriteline needs %"PRId64" elements, but got %"PRIu64,
+            n, arr_body->elems);
+    if (line)
+        copy_strided(tc, line, stride, (char *)arr_body->slots.any + arr_body->start * elem_size,
+            1, n, elem_size);
+}
+
+
 /* Initializes the representation. */
 const MVMREPROps * MVMMultiDimArray_initialize(MVMThreadContext *tc) {
     return &MultiDimArray_this_repr;
@@ -46,5 +46,25 @@ struct MVMMultiDimArrayREPRData {
     MVMObject *elem_type;
 };
 
+/* Elementwise operations on native multi-dim arrays. */
+#define MVM_MULTIDIM_OP_ADD 0
+#define MVM_MULTIDIM_OP_SUB 1
+#define MVM_MULTIDIM_OP_MUL 2
+#define MVM_MULTIDIM_OP_DIV 3
+#define MVM_MULTIDIM_OP_MIN 4
+#define MVM_MULTIDIM_OP_MAX 5
+
 /* Initializes the MultiDimArray REPR. */
 const MVMREPROps * MVMMultiDimArray_initialize(MVMThreadContext *tc);
+
+/* Bulk operations on the flat storage of native multi-dim arrays. */
+void MVM_MultiDimArray_fill_i(MVMThreadContext *tc, MVMObject *obj, MVMint64 value);
+void MVM_MultiDimArray_fill_n(MVMThreadContext *tc, MVMObject *obj, MVMnum64 value);
+void MVM_MultiDimArray_copy(MVMThreadContext *tc, MVMObject *dest, MVMObject *src);
+void MVM_MultiDimArray_transpose(MVMThreadContext *tc, MVMObject *dest, MVMObject *src);
+void MVM_MultiDimArray_elemwise(MVMThreadContext *tc, MVMObject *dest, MVMObject *a,
+    MVMObject *b, MVMint64 op);
+void MVM_MultiDimArray_read_line(MVMThreadContext *tc, MVMObject *target, MVMObject *obj,
+    MVMObject *indices, MVMint64 dim);
+void MVM_MultiDimArray_write_line(MVMThreadContext *tc, MVMObject *obj, MVMObject *indices,
+    MVMint64 dim, MVMObject *source);
@@ -50,6 +50,11 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
             MVM_fixed_size_free(tc, tc->instance->fsa, nfa->body.num_state_edges[i] * sizeof(MVMNFAStateInfo), nfa->body.states[i]);
     MVM_fixed_size_free(tc, tc->instance->fsa, nfa->body.num_states * sizeof(MVMNFAStateInfo *), nfa->body.states);
     MVM_fixed_size_free(tc, tc->instance->fsa, nfa->body.num_states * sizeof(MVMint64), nfa->body.num_state_edges);
+    if (nfa->body.dfa)
+        MVM_nfa_dfa_destroy(nfa->body.dfa);
+    if (nfa->body.num_start_literals)
+        MVM_fixed_size_free(tc, tc->instance->fsa, nfa->body.num_start_literals * sizeof(MVMGrapheme32),
+            nfa->body.start_literals);
 }
 
 
@@ -180,6 +185,103 @@ static int opt_edge_comp(const void *av, const void *bv) {
         return 0;
     }
 }
+/* Works out the literal graphemes the start state can begin with, if it can
+ * only begin with literals; see the NFA body. */
+static int grapheme_comp(const void *av, const void *bv) {
+    MVMGrapheme32 a = *(const MVMGrapheme32 *)av;
+    MVMGrapheme32 b = *(const MVMGrapheme32 *)bv;
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+static void add_start_literal(MVMNFABody *body, MVMGrapheme32 **lits, MVMuint32 *num,
+        MVMuint32 *alloc, MVMGrapheme32 g) {
+    if (g >= 0 && g < 128) {
+        body->start_ascii[g >> 6] |= (MVMuint64)1 << (g & 63);
+        return;
+    }
+    if (*num == *alloc) {
+        *alloc = *alloc ? *alloc * 2 : 16;
+        *lits  = MVM_realloc(*lits, *alloc * sizeof(MVMGrapheme32));
+    }
+    (*lits)[(*num)++] = g;
+}
+static void compute_start_literals(MVMThreadContext *tc, MVMNFABody *body) {
+    MVMuint8      *seen;
+    MVMint64      *todo;
+    MVMint64       num_todo = 0;
+    MVMGrapheme32 *lits     = NULL;
+    MVMuint32      num_lits = 0, alloc_lits = 0, i, j;
+    int            usable   = 1;
+
+    body->start_ascii[0] = body->start_ascii[1] = 0;
+    body->has_start_literals = 0;
+    if (body->num_states < 1)
+        return;
+
+    /* Walk the states reachable from the start state by epsilon edges. */
+    seen = MVM_calloc(body->num_states + 1, 1);
+    todo = MVM_malloc((body->num_states + 1) * sizeof(MVMint64));
+    todo[num_todo++] = 1;
+    seen[1] = 1;
+    while (usable && num_todo) {
+        MVMint64 st = todo[--num_todo];
+        MVMNFAStateInfo *edge_info = body->states[st - 1];
+        MVMint64 e;
+        for (e = 0; usable && e < body->num_state_edges[st - 1]; e++) {
+            MVMint64 act = edge_info[e].act;
+            MVMint64 to  = edge_info[e].to;
+            if (act < 0)
+                act &= 0xff;
+            switch (act) {
+                case MVM_NFA_EDGE_EPSILON:
+                    if (to > 0 && to <= body->num_states && !seen[to]) {
+                        seen[to] = 1;
+                        todo[num_todo++] = to;
+                    }
+                    break;
+                case MVM_NFA_EDGE_CODEPOINT:
+                case MVM_NFA_EDGE_CODEPOINT_LL:
+                    add_start_literal(body, &lits, &num_lits, &alloc_lits, edge_info[e].arg.g);
+                    break;
+                case MVM_NFA_EDGE_CODEPOINT_I:
+                case MVM_NFA_EDGE_CODEPOINT_I_LL:
+                    add_start_literal(body, &lits, &num_lits, &alloc_lits, edge_info[e].arg.uclc.uc);
+                    add_start_literal(body, &lits, &num_lits, &alloc_lits, edge_info[e].arg.uclc.lc);
+                    break;
+                case MVM_NFA_EDGE_SYNTH_CP_COUNT:
+                case MVM_NFA_EDGE_SUBRULE:
+                    /* The former just counts the codepoint edges after it,
+                     * the latter is never taken. */
+                    break;
+                default:
+                    /* A fate reachable right away, or an edge that isn't a
+                     * literal. */
+                    usable = 0;
+            }
+        }
+    }
+    MVM_free(todo);
+    MVM_free(seen);
+
+    if (usable) {
+        if (num_lits) {
+            qsort(lits, num_lits, sizeof(MVMGrapheme32), grapheme_comp);
+            for (i = 1, j = 0; i < num_lits; i++)
+                if (lits[i] != lits[j])
+                    lits[++j] = lits[i];
+            num_lits = j + 1;
+            body->start_literals = MVM_fixed_size_alloc(tc, tc->instance->fsa,
+                num_lits * sizeof(MVMGrapheme32));
+            memcpy(body->start_literals, lits, num_lits * sizeof(MVMGrapheme32));
+        }
+        body->num_start_literals = num_lits;
+        body->has_start_literals = 1;
+    }
+    else {
+        body->start_ascii[0] = body->start_ascii[1] = 0;
+    }
+    MVM_free(lits);
+}
+
 static void sort_states_and_add_synth_cp_node(MVMThreadContext *tc, MVMNFABody *body) {
     MVMint64 s;
     for (s = 0; s < body->num_states; s++) {
@@ -210,6 +312,8 @@ static void sort_states_and_add_synth_cp_node(MVMThreadContext *tc, MVMNFABody *
             body->num_state_edges[s] = num_new_edges;
         }
     }
+
+    compute_start_literals(tc, body);
 }
 
 /* Deserializes the data. */
@@ -310,8 +414,11 @@ static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data)
 
     total = body->num_states * sizeof(MVMint64); /* for num_state_edges */
     total += body->num_states * sizeof(MVMNFAStateInfo *); /* for states level 1 */
+    total += body->num_start_literals * sizeof(MVMGrapheme32);
     for (i = 0; i < body->num_states; i++)
         total += body->num_state_edges[i] * sizeof(MVMNFAStateInfo);
+    if (body->dfa)
+        total += sizeof(MVMNFADFA) + body->dfa->num_states * sizeof(MVMNFADFAState);
 
     return total;
 }
@@ -481,22 +588,562 @@ static MVMint32 in_done(MVMuint32 *done, MVMuint32 numdone, MVMuint32 st) {
     return 0;
 }
 
+/* The state of a run that the steps of the simulation update, and that the
+ * transitions of the DFA replay their recorded events into. */
+typedef struct {
+    MVMint64 *fates;
+    MVMint64  fate_arr_len;
+    MVMint64  total_fates;
+    MVMint64  prev_fates;
+    MVMint64 *longlit;
+    MVMint64  usedlonglit;
+
+    /* The token length if the current position is matched. */
+    MVMint64  length;
+
+    /* Events of the step being recorded for a new DFA transition. */
+    MVMNFADFAEvent *events;
+    MVMuint32       num_events;
+    MVMuint32       alloc_events;
+    MVMuint32       recording;
+
+    int nfadeb;
+} NFARun;
+
+static void record_event(NFARun *run, MVMint32 kind, MVMint64 arg) {
+    if (run->num_events == run->alloc_events) {
+        run->alloc_events = run->alloc_events ? run->alloc_events * 2 : 16;
+        run->events = MVM_realloc(run->events, run->alloc_events * sizeof(MVMNFADFAEvent));
+    }
+    run->events[run->num_events].kind = kind;
+    run->events[run->num_events].arg  = arg;
+    run->num_events++;
+}
+
+/* Crossed a fate edge. Check if we already saw this fate, and if so remove
+ * the entry so we can re-add at the new token length. */
+static void cross_fate(MVMThreadContext *tc, NFARun *run, MVMint64 arg) {
+    MVMint64 *fates = run->fates;
+    MVMint64 j;
+    MVMint64 found_fate = 0;
+    if (run->recording)
+        record_event(run, MVM_NFA_DFA_EVENT_FATE, arg);
+    if (MVM_UNLIKELY(run->nfadeb))
+        fprintf(stderr, "fate(%016llx) ", (long long unsigned int)arg);
+    for (j = 0; j < run->total_fates; j++) {
+        if (found_fate)
+            fates[j - found_fate] = fates[j];
+        if ((fates[j] & 0xffffff) == arg) {
+            found_fate++;
+            if (j < run->prev_fates)
+                run->prev_fates--;
+        }
+    }
+    run->total_fates -= found_fate;
+    if (arg < run->usedlonglit)
+        arg -= run->longlit[arg] << 24;
+    if (MVM_UNLIKELY(++run->total_fates > run->fate_arr_len)) {
+        /* should never happen if nfa->fates is correct and dedup above works right */
+        fprintf(stderr, "oops adding %016llx to\n", (long long unsigned int)arg);
+        for (j = 0; j < run->total_fates - 1; j++) {
+            fprintf(stderr, "  %016llx\n", (long long unsigned int)fates[j]);
+        }
+        run->fate_arr_len = run->total_fates + 10;
+        tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates,
+            sizeof(MVMint64) * run->fate_arr_len);
+        tc->nfa_fates_len = run->fate_arr_len;
+        fates             = run->fates = tc->nfa_fates;
+    }
+    /* a small insertion sort */
+    j = run->total_fates - 1;
+    while (--j >= run->prev_fates && fates[j] < arg) {
+        fates[j + 1] = fates[j];
+    }
+    fates[++j] = arg;
+}
+
+/* Passed through the final char of a literal, which influences the fate
+ * with the given index. */
+static void saw_literal(MVMThreadContext *tc, NFARun *run, MVMint64 fate) {
+    if (run->recording)
+        record_event(run, MVM_NFA_DFA_EVENT_LONGLIT, fate);
+    while (run->usedlonglit <= fate)
+        run->longlit[run->usedlonglit++] = 0;
+    run->longlit[fate] = run->length;
+}
+
+/* Takes one step of the NFA simulation, from the states in curst over the
+ * grapheme at offset (if not at the end of the string), putting the states
+ * reached into nextst and returning how many there are. What the step does
+ * depends only on the states and the grapheme, which the DFA relies on. */
+static MVMint64 nfa_step(MVMThreadContext *tc, MVMNFABody *nfa, NFARun *run,
+        MVMuint32 *curst, MVMint64 numcur, MVMuint32 *nextst, MVMString *target,
+        MVMint64 offset, MVMint64 eos, MVMGraphemeIter_cached *gic) {
+    MVMuint32 *done       = tc->nfa_done;
+    MVMint64   num_states = nfa->num_states;
+    MVMint64   numnext    = 0;
+    MVMint64   numdone    = 0;
+    MVMint64   i;
+
+    while (numcur) {
+        MVMNFAStateInfo *edge_info;
+        MVMint64         edge_info_elems;
+
+        MVMint64 st = curst[--numcur];
+        if (st <= num_states) {
+            if (in_done(done, numdone, st))
+                continue;
+            done[numdone++] = st;
+        }
+
+        edge_info = nfa->states[st - 1];
+        edge_info_elems = nfa->num_state_edges[st - 1];
+        if (MVM_UNLIKELY(run->nfadeb))
+            fprintf(stderr,"\t%"PRIi64"\t%"PRIi64"\t", st, edge_info_elems);
+        for (i = 0; i < edge_info_elems; i++) {
+            MVMint64 act = edge_info[i].act;
+            MVMint64 to  = edge_info[i].to;
+
+            /* All the special cases are under one test. */
+            if (act <= MVM_NFA_EDGE_EPSILON) {
+                if (act < 0) {
+                    /* Negative indicates a fate is encoded in the act of the codepoint edge. */
+                    /* These will redispatch to one of the _LL cases below */
+                    act &= 0xff;
+                }
+                else if (act == MVM_NFA_EDGE_FATE) {
+                    /* Crossed a fate edge. Check if we already saw this fate, and
+                     * if so remove the entry so we can re-add at the new token length. */
+                    cross_fate(tc, run, edge_info[i].arg.i);
+                    continue;
+                }
+                else if (act == MVM_NFA_EDGE_EPSILON && to <= num_states &&
+                        !in_done(done, numdone, to)) {
+                    if (to)
+                        curst[numcur++] = to;
+                    else if (MVM_UNLIKELY(run->nfadeb))  /* XXX should turn into a "can't happen" after rebootstrap */
+                        fprintf(stderr, "  oops, ignoring epsilon to 0\n");
+                    continue;
+                }
+            }
+
+            if (eos <= offset) {
+                /* Can't match, so drop state. */
+                continue;
+            }
+            else {
+                switch (act) {
+                    case MVM_NFA_EDGE_CODEPOINT_LL: {
+                        const MVMGrapheme32 arg = edge_info[i].arg.g;
+                        if (MVM_string_gi_cached_get_grapheme(tc, gic, offset) == arg) {
+                            nextst[numnext++] = to;
+                            saw_literal(tc, run, (edge_info[i].act >> 8) & 0xfffff);
+                            if (MVM_UNLIKELY(run->nfadeb))
+                                fprintf(stderr, "%d->%d ", (int)i, (int)to);
+                        }
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT: {
+                        const MVMGrapheme32 arg = edge_info[i].arg.g;
+                        if (MVM_string_gi_cached_get_grapheme(tc, gic, offset) == arg) {
+                            nextst[numnext++] = to;
+                            if (MVM_UNLIKELY(run->nfadeb))
+                                fprintf(stderr, "%d->%d ", (int)i, (int)to);
+                        }
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT_NEG: {
+                        const MVMGrapheme32 arg = edge_info[i].arg.g;
+                        if (MVM_string_gi_cached_get_grapheme(tc, gic, offset) != arg)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARCLASS: {
+                        const MVMint64 arg = edge_info[i].arg.i;
+                        if (MVM_string_grapheme_is_cclass(tc, arg, MVM_string_gi_cached_get_grapheme(tc, gic, offset)))
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARCLASS_NEG: {
+                        const MVMint64 arg = edge_info[i].arg.i;
+                        if (!MVM_string_grapheme_is_cclass(tc, arg, MVM_string_gi_cached_get_grapheme(tc, gic, offset)))
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARLIST: {
+                        MVMString *arg   = edge_info[i].arg.s;
+                        MVMGrapheme32 cp = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (MVM_string_index_of_grapheme(tc, arg, cp) >= 0)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARLIST_NEG: {
+                        MVMString *arg    = edge_info[i].arg.s;
+                        const MVMGrapheme32 cp = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (MVM_string_index_of_grapheme(tc, arg, cp) < 0)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT_I_LL: {
+                        const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (ord == lc_arg || ord == uc_arg) {
+                            nextst[numnext++] = to;
+                            saw_literal(tc, run, (edge_info[i].act >> 8) & 0xfffff);
+                        }
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT_I: {
+                        MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (ord == lc_arg || ord == uc_arg)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT_I_NEG: {
+                        const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (ord != lc_arg && ord != uc_arg)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARRANGE: {
+                        MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (ord >= lc_arg && ord <= uc_arg)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARRANGE_NEG: {
+                        const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        if (ord < lc_arg || uc_arg < ord)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_SUBRULE:
+                        if (MVM_UNLIKELY(run->nfadeb))
+                            fprintf(stderr, "IGNORING SUBRULE\n");
+                        continue;
+                    case MVM_NFA_EDGE_CODEPOINT_M:
+                    case MVM_NFA_EDGE_CODEPOINT_M_NEG: {
+                        MVMNormalizer norm;
+                        MVMint32 ready;
+                        MVMGrapheme32 ga = edge_info[i].arg.g;
+                        MVMGrapheme32 gb = MVM_string_ord_basechar_at(tc, target, offset);
+
+                        MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+                        ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, ga, &ga);
+                        MVM_unicode_normalizer_eof(tc, &norm);
+                        if (!ready)
+                            ga = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+
+                        if (((act == MVM_NFA_EDGE_CODEPOINT_M)     && (ga == gb))
+                         || ((act == MVM_NFA_EDGE_CODEPOINT_M_NEG) && (ga != gb)))
+                            nextst[numnext++] = to;
+                        MVM_unicode_normalizer_cleanup(tc, &norm);
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CODEPOINT_IM:
+                    case MVM_NFA_EDGE_CODEPOINT_IM_NEG: {
+                        MVMNormalizer norm;
+                        MVMint32 ready;
+                        MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord = MVM_string_ord_basechar_at(tc, target, offset);
+
+                        MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+                        ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, uc_arg, &uc_arg);
+                        MVM_unicode_normalizer_eof(tc, &norm);
+                        if (!ready)
+                            uc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+                        MVM_unicode_normalizer_cleanup(tc, &norm);
+
+                        MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+                        ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, lc_arg, &lc_arg);
+                        MVM_unicode_normalizer_eof(tc, &norm);
+                        if (!ready)
+                            lc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+
+                        if (((act == MVM_NFA_EDGE_CODEPOINT_IM)     && (ord == lc_arg || ord == uc_arg))
+                         || ((act == MVM_NFA_EDGE_CODEPOINT_IM_NEG) && (ord != lc_arg && ord != uc_arg)))
+                            nextst[numnext++] = to;
+                        MVM_unicode_normalizer_cleanup(tc, &norm);
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARRANGE_M: {
+                        const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
+                        if (ord >= lc_arg && ord <= uc_arg)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_CHARRANGE_M_NEG: {
+                        const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
+                        const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
+                        const MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
+                        if (ord < lc_arg || uc_arg < ord)
+                            nextst[numnext++] = to;
+                        continue;
+                    }
+                    case MVM_NFA_EDGE_SYNTH_CP_COUNT: {
+                        /* Binary search the edges ahead for the grapheme. */
+                        const MVMGrapheme32 search = MVM_string_gi_cached_get_grapheme(tc, gic, offset);
+                        const MVMint64 num_possibilities = edge_info[i].arg.i;
+                        const MVMint64 end = i + num_possibilities;
+                        MVMint64 l = i + 1;
+                        MVMint64 r = end;
+                        MVMint64 found = -1;
+                        while (l <= r) {
+                            const MVMint64 m = l + (r - l) / 2;
+                            const MVMGrapheme32 test = edge_info[m].arg.g;
+                            if (test == search) {
+                                /* We found it, but important we get the first edge
+                                 * that matches. */
+                                found = m;
+                                while (found > i + 1 && edge_info[found - 1].arg.g == search)
+                                    found--;
+                                break;
+                            }
+                            if (test < search)
+                                l = m + 1;
+                            else
+                                r = m - 1;
+                        }
+                        if (found == -1) {
+                            /* Binary search failed to find a match, so just skip all
+                             * the nodes. */
+                            i += num_possibilities;
+                        }
+                        else {
+                            /* Add all states that match. */
+                            while (found <= end && edge_info[found].arg.g == search) {
+                                to = edge_info[found].to;
+                                if (edge_info[found].act == MVM_NFA_EDGE_CODEPOINT) {
+                                    nextst[numnext++] = to;
+                                    if (MVM_UNLIKELY(run->nfadeb))
+                                        fprintf(stderr, "%d->%d ", (int)found, (int)to);
+                                }
+                                else {
+                                    nextst[numnext++] = to;
+                                    saw_literal(tc, run, (edge_info[found].act >> 8) & 0xfffff);
+                                    if (MVM_UNLIKELY(run->nfadeb))
+                                        fprintf(stderr, "%d->%d ", (int)found, (int)to);
+                                }
+                                found++;
+                            }
+                            i += num_possibilities;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        if (MVM_UNLIKELY(run->nfadeb)) fprintf(stderr,"\n");
+    }
+    return numnext;
+}
+
+/* Gets the DFA of an NFA, making it with just its start state if there is
+ * none yet. */
+static MVMNFADFA * get_dfa(MVMThreadContext *tc, MVMNFABody *nfa) {
+    MVMNFADFA *dfa = (MVMNFADFA *)MVM_load(&nfa->dfa);
+    if (!dfa) {
+        MVMNFADFA      *fresh = MVM_calloc(1, sizeof(MVMNFADFA));
+        MVMNFADFAState *start = MVM_calloc(1, sizeof(MVMNFADFAState));
+        int init_stat;
+        if ((init_stat = uv_mutex_init(&fresh->mutex)) < 0)
+            MVM_panic(1, "Failed to initialize NFA DFA mutex: %s", uv_strerror(init_stat));
+        start->nfa_states     = MVM_malloc(sizeof(MVMuint32));
+        start->nfa_states[0]  = 1;
+        start->num_nfa_states = 1;
+        fresh->states[0]      = start;
+        fresh->num_states     = 1;
+        if (!MVM_trycas(&nfa->dfa, NULL, fresh)) {
+            /* Another thread got there first. */
+            MVM_nfa_dfa_destroy(fresh);
+            dfa = (MVMNFADFA *)MVM_load(&nfa->dfa);
+        }
+        else {
+            dfa = fresh;
+        }
+    }
+    return dfa;
+}
+
+/* Finds where the transition of a DFA state over a grapheme, or the end of
+ * the string, is kept. Graphemes outside of ASCII are hashed, and NULL is
+ * returned if there is no room for another one. */
+static MVMNFADFATransition ** transition_slot(MVMNFADFAState *ds, MVMint32 at_eos,
+        MVMGrapheme32 g) {
+    MVMuint32 idx;
+    if (at_eos)
+        return &ds->eos;
+    if (g >= 0 && g < MVM_NFA_DFA_ASCII)
+        return &ds->ascii[g];
+    idx = ((MVMuint32)g * 2654435761U) >> (32 - MVM_NFA_DFA_OTHER_BITS);
+    while (1) {
+        MVMNFADFATransition *t = (MVMNFADFATransition *)MVM_load(&ds->other[idx]);
+        if (!t)
+            return ds->num_other < (1 << MVM_NFA_DFA_OTHER_BITS) / 4 * 3
+                ? &ds->other[idx]
+                : NULL;
+        if (t->g == g)
+            return &ds->other[idx];
+        idx = (idx + 1) & ((1 << MVM_NFA_DFA_OTHER_BITS) - 1);
+    }
+}
+
+static MVMNFADFATransition * find_transition(MVMNFADFAState *ds, MVMint32 at_eos,
+        MVMGrapheme32 g) {
+    MVMNFADFATransition **slot = transition_slot(ds, at_eos, g);
+    MVMNFADFATransition  *t    = slot ? (MVMNFADFATransition *)MVM_load(slot) : NULL;
+    return t && (at_eos || t->g == g) ? t : NULL;
+}
+
+/* Adds the transition a step of the simulation just recorded to the DFA,
+ * returning the DFA state reached, or NULL if the DFA is full. */
+static MVMNFADFAState * add_transition(MVMThreadContext *tc, MVMNFADFA *dfa,
+        MVMNFADFAState *from, MVMint32 at_eos, MVMGrapheme32 g, NFARun *run,
+        MVMuint32 *reached, MVMint64 num_reached) {
+    MVMNFADFAState       *to = NULL;
+    MVMNFADFATransition **slot;
+    MVMNFADFATransition  *t;
+    MVMuint32 i;
+
+    uv_mutex_lock(&dfa->mutex);
+
+    /* Another thread may have added it meanwhile. */
+    if ((t = find_transition(from, at_eos, g))) {
+        uv_mutex_unlock(&dfa->mutex);
+        return t->to;
+    }
+
+    /* Find the DFA state for the NFA states reached, making it if needed. */
+    for (i = 0; i < dfa->num_states; i++) {
+        MVMNFADFAState *ds = dfa->states[i];
+        if (ds->num_nfa_states == num_reached && (num_reached == 0 ||
+                memcmp(ds->nfa_states, reached, num_reached * sizeof(MVMuint32)) == 0)) {
+            to = ds;
+            break;
+        }
+    }
+    if (!to) {
+        if (dfa->num_states == MVM_NFA_DFA_MAX_STATES) {
+            uv_mutex_unlock(&dfa->mutex);
+            return NULL;
+        }
+        to = MVM_calloc(1, sizeof(MVMNFADFAState));
+        if (num_reached) {
+            to->nfa_states = MVM_malloc(num_reached * sizeof(MVMuint32));
+            memcpy(to->nfa_states, reached, num_reached * sizeof(MVMuint32));
+        }
+        to->num_nfa_states = (MVMuint32)num_reached;
+        dfa->states[dfa->num_states++] = to;
+    }
+
+    /* Publish the transition, if there's room for it. */
+    if ((slot = transition_slot(from, at_eos, g))) {
+        t = MVM_malloc(sizeof(MVMNFADFATransition));
+        t->to         = to;
+        t->g          = g;
+        t->num_events = run->num_events;
+        t->events     = NULL;
+        if (run->num_events) {
+            t->events = MVM_malloc(run->num_events * sizeof(MVMNFADFAEvent));
+            memcpy(t->events, run->events, run->num_events * sizeof(MVMNFADFAEvent));
+        }
+        if (slot >= from->other && slot < from->other + (1 << MVM_NFA_DFA_OTHER_BITS))
+            from->num_other++;
+        MVM_store(slot, t);
+    }
+
+    uv_mutex_unlock(&dfa->mutex);
+    return to;
+}
+
+/* Frees a DFA and everything in it. */
+void MVM_nfa_dfa_destroy(MVMNFADFA *dfa) {
+    MVMuint32 i, j;
+    for (i = 0; i < dfa->num_states; i++) {
+        MVMNFADFAState *ds = dfa->states[i];
+        MVMNFADFATransition *t;
+        if ((t = ds->eos)) {
+            MVM_free(t->events);
+            MVM_free(t);
+        }
+        for (j = 0; j < MVM_NFA_DFA_ASCII; j++) {
+            if ((t = ds->ascii[j])) {
+                MVM_free(t->events);
+                MVM_free(t);
+            }
+        }
+        for (j = 0; j < (1 << MVM_NFA_DFA_OTHER_BITS); j++) {
+            if ((t = ds->other[j])) {
+                MVM_free(t->events);
+                MVM_free(t);
+            }
+        }
+        MVM_free(ds->nfa_states);
+        MVM_free(ds);
+    }
+    uv_mutex_destroy(&dfa->mutex);
+    MVM_free(dfa);
+}
+
+/* Checks if a run could get anywhere from a position starting with the given
+ * grapheme; only valid when the NFA has start literals. */
+static MVMint32 is_start_literal(MVMNFABody *nfa, MVMGrapheme32 g) {
+    MVMint64 l, r;
+    if (g >= 0 && g < 128)
+        return (nfa->start_ascii[g >> 6] >> (g & 63)) & 1;
+    l = 0;
+    r = (MVMint64)nfa->num_start_literals - 1;
+    while (l <= r) {
+        const MVMint64 m = l + (r - l) / 2;
+        const MVMGrapheme32 test = nfa->start_literals[m];
+        if (test == g)
+            return 1;
+        if (test < g)
+            l = m + 1;
+        else
+            r = m - 1;
+    }
+    return 0;
+}
+
 static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *target, MVMint64 offset, MVMint64 *total_fates_out) {
     MVMint64  eos     = MVM_string_graphs(tc, target);
-    MVMuint32 gen     = 1;
     MVMint64  numcur  = 0;
     MVMint64  numnext = 0;
-    MVMint64  numdone = 0;
-    MVMuint32 *done, *curst, *nextst;
-    MVMint64  *fates, *longlit;
-    MVMint64  i, fate_arr_len, num_states, total_fates, prev_fates, usedlonglit;
+    MVMuint32 *curst, *nextst;
+    MVMint64  i, num_states;
     MVMint64  orig_offset = offset;
+    NFARun    run;
+    /* The DFA, and the state of it we're in; we stop following it for the
+     * rest of the run if it fills up. */
+    MVMNFADFA      *dfa;
+    MVMNFADFAState *dstate;
     /* We used a cached grapheme iterator since we often request the same
      * grapheme multiple times, most common after that is requesting the next
      * grapheme. */
     MVMGraphemeIter_cached gic;
     int nfadeb = tc->instance->nfa_debug_enabled;
 
+    /* If the NFA can only start with a literal and the grapheme here isn't
+     * one it can start with, or we're at the end, nothing can match. */
+    if (nfa->has_start_literals && !nfadeb && (offset >= eos ||
+            !is_start_literal(nfa, MVM_string_get_grapheme_at_nocheck(tc, target, offset)))) {
+        *total_fates_out = 0;
+        return tc->nfa_fates;
+    }
+
     /* Obtain or (re)allocate "done states", "current states" and "next
      * states" arrays. */
     num_states = nfa->num_states;
@@ -507,28 +1154,36 @@ static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *
         tc->nfa_nextst = (MVMuint32 *)MVM_realloc(tc->nfa_nextst, alloc);
         tc->nfa_alloc_states = num_states;
     }
-    done   = tc->nfa_done;
     curst  = tc->nfa_curst;
     nextst = tc->nfa_nextst;
 
     /* Allocate fates array. */
-    fate_arr_len = 1 + MVM_repr_elems(tc, nfa->fates);
-    if (tc->nfa_fates_len < fate_arr_len) {
-        tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates, sizeof(MVMint64) * fate_arr_len);
-        tc->nfa_fates_len = fate_arr_len;
+    run.fate_arr_len = 1 + MVM_repr_elems(tc, nfa->fates);
+    if (tc->nfa_fates_len < run.fate_arr_len) {
+        tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates, sizeof(MVMint64) * run.fate_arr_len);
+        tc->nfa_fates_len = run.fate_arr_len;
     }
-    fates = tc->nfa_fates;
-    total_fates = 0;
-    if (MVM_UNLIKELY(nfadeb)) fprintf(stderr,"======================================\nStarting with %d fates in %d states\n", (int)fate_arr_len, (int)num_states) ;
+    run.fates = tc->nfa_fates;
+    run.total_fates = 0;
+    if (MVM_UNLIKELY(nfadeb)) fprintf(stderr,"======================================\nStarting with %d fates in %d states\n", (int)run.fate_arr_len, (int)num_states) ;
 
     /* longlit will be updated on a fate whenever NFA passes through final char of a literal. */
     /* These edges are specially marked to indicate which fate they influence the fate of. */
-    if (tc->nfa_longlit_len < fate_arr_len) {
-        tc->nfa_longlit = (MVMint64 *)MVM_realloc(tc->nfa_longlit, sizeof(MVMint64) * fate_arr_len);
-        tc->nfa_longlit_len  = fate_arr_len;
+    if (tc->nfa_longlit_len < run.fate_arr_len) {
+        tc->nfa_longlit = (MVMint64 *)MVM_realloc(tc->nfa_longlit, sizeof(MVMint64) * run.fate_arr_len);
+        tc->nfa_longlit_len  = run.fate_arr_len;
     }
-    longlit = tc->nfa_longlit;
-    usedlonglit = 0;
+    run.longlit      = tc->nfa_longlit;
+    run.usedlonglit  = 0;
+    run.events       = NULL;
+    run.num_events   = 0;
+    run.alloc_events = 0;
+    run.recording    = 0;
+    run.nfadeb       = nfadeb;
+
+    /* The debug output wants to see every step, so doesn't use the DFA. */
+    dfa    = nfadeb ? NULL : get_dfa(tc, nfa);
+    dstate = dfa ? dfa->states[0] : NULL;
 
     nextst[numnext++] = 1;
     /* In NFA could be called with a string that has 0 graphemes in it. Guard
@@ -536,16 +1191,44 @@ static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *
     if (target->body.num_graphs) MVM_string_gi_cached_init(tc, &gic, target, 0);
 
     while (numnext && offset <= eos) {
+        MVMint32      at_eos = offset >= eos;
+        MVMGrapheme32 g      = at_eos ? 0 : MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
+        MVMuint32    *temp;
+
+        /* Save how many fates we have before this position is considered. */
+        run.prev_fates = run.total_fates;
+        run.length     = offset - orig_offset + 1;
+
+        /* If the DFA has been this way before, replay what the step did. */
+        if (dstate) {
+            MVMNFADFATransition *t = find_transition(dstate, at_eos, g);
+            if (t) {
+                MVMuint32 e;
+                for (e = 0; e < t->num_events; e++) {
+                    if (t->events[e].kind == MVM_NFA_DFA_EVENT_FATE)
+                        cross_fate(tc, &run, t->events[e].arg);
+                    else
+                        saw_literal(tc, &run, t->events[e].arg);
+                }
+                dstate  = t->to;
+                numnext = dstate->num_nfa_states;
+                offset++;
+                continue;
+            }
+
+            /* Otherwise, simulate the step from the DFA state's NFA states,
+             * recording it. */
+            numnext = dstate->num_nfa_states;
+            memcpy(nextst, dstate->nfa_states, numnext * sizeof(MVMuint32));
+            run.recording  = 1;
+            run.num_events = 0;
+        }
+
         /* Swap next and current */
-        MVMuint32 *temp = curst;
+        temp    = curst;
         curst   = nextst;
         nextst  = temp;
         numcur  = numnext;
-        numnext = 0;
-        numdone = 0;
-
-        /* Save how many fates we have before this position is considered. */
-        prev_fates = total_fates;
 
         if (MVM_UNLIKELY(nfadeb)) {
             if (offset < eos) {
@@ -556,327 +1239,29 @@ static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *
                 fprintf(stderr,"EOS with %"PRId64"s\n", numcur);
             }
         }
-        while (numcur) {
-            MVMNFAStateInfo *edge_info;
-            MVMint64         edge_info_elems;
+        numnext = nfa_step(tc, nfa, &run, curst, numcur, nextst, target, offset, eos, &gic);
 
-            MVMint64 st = curst[--numcur];
-            if (st <= num_states) {
-                if (in_done(done, numdone, st))
-                    continue;
-                done[numdone++] = st;
-            }
-
-            edge_info = nfa->states[st - 1];
-            edge_info_elems = nfa->num_state_edges[st - 1];
-            if (MVM_UNLIKELY(nfadeb))
-                fprintf(stderr,"\t%"PRIi64"\t%"PRIi64"\t", st, edge_info_elems);
-            for (i = 0; i < edge_info_elems; i++) {
-                MVMint64 act = edge_info[i].act;
-                MVMint64 to  = edge_info[i].to;
-
-                /* All the special cases are under one test. */
-                if (act <= MVM_NFA_EDGE_EPSILON) {
-                    if (act < 0) {
-                        /* Negative indicates a fate is encoded in the act of the codepoint edge. */
-                        /* These will redispatch to one of the _LL cases below */
-                        act &= 0xff;
-                    }
-                    else if (act == MVM_NFA_EDGE_FATE) {
-                        /* Crossed a fate edge. Check if we already saw this fate, and
-                         * if so remove the entry so we can re-add at the new token length. */
-                        MVMint64 arg = edge_info[i].arg.i;
-                        MVMint64 j;
-                        MVMint64 found_fate = 0;
-                        if (MVM_UNLIKELY(nfadeb))
-                            fprintf(stderr, "fate(%016llx) ", (long long unsigned int)arg);
-                        for (j = 0; j < total_fates; j++) {
-                            if (found_fate)
-                                fates[j - found_fate] = fates[j];
-                            if ((fates[j] & 0xffffff) == arg) {
-                                found_fate++;
-                                if (j < prev_fates)
-                                    prev_fates--;
-                            }
-                        }
-                        total_fates -= found_fate;
-                        if (arg < usedlonglit)
-                            arg -= longlit[arg] << 24;
-                        if (MVM_UNLIKELY(++total_fates > fate_arr_len)) {
-                            /* should never happen if nfa->fates is correct and dedup above works right */
-                            fprintf(stderr, "oops adding %016llx to\n", (long long unsigned int)arg);
-                            for (j = 0; j < total_fates - 1; j++) {
-                                fprintf(stderr, "  %016llx\n", (long long unsigned int)fates[j]);
-                            }
-                            fate_arr_len      = total_fates + 10;
-                            tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates,
-                                sizeof(MVMint64) * fate_arr_len);
-                            tc->nfa_fates_len = fate_arr_len;
-                            fates             = tc->nfa_fates;
-                        }
-                        /* a small insertion sort */
-                        j = total_fates - 1;
-                        while (--j >= prev_fates && fates[j] < arg) {
-                            fates[j + 1] = fates[j];
-                        }
-                        fates[++j] = arg;
-                        continue;
-                    }
-                    else if (act == MVM_NFA_EDGE_EPSILON && to <= num_states &&
-                            !in_done(done, numdone, to)) {
-                        if (to)
-                            curst[numcur++] = to;
-                        else if (MVM_UNLIKELY(nfadeb))  /* XXX should turn into a "can't happen" after rebootstrap */
-                            fprintf(stderr, "  oops, ignoring epsilon to 0\n");
-                        continue;
-                    }
-                }
-
-                if (eos <= offset) {
-                    /* Can't match, so drop state. */
-                    continue;
-                }
-                else {
-                    switch (act) {
-                        case MVM_NFA_EDGE_CODEPOINT_LL: {
-                            const MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_gi_cached_get_grapheme(tc, &gic, offset) == arg) {
-                                MVMint64 fate = (edge_info[i].act >> 8) & 0xfffff;
-                                nextst[numnext++] = to;
-                                while (usedlonglit <= fate)
-                                    longlit[usedlonglit++] = 0;
-                                longlit[fate] = offset - orig_offset + 1;
-                                if (MVM_UNLIKELY(nfadeb))
-                                    fprintf(stderr, "%d->%d ", (int)i, (int)to);
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT: {
-                            const MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_gi_cached_get_grapheme(tc, &gic, offset) == arg) {
-                                nextst[numnext++] = to;
-                                if (MVM_UNLIKELY(nfadeb))
-                                    fprintf(stderr, "%d->%d ", (int)i, (int)to);
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_NEG: {
-                            const MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_gi_cached_get_grapheme(tc, &gic, offset) != arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARCLASS: {
-                            const MVMint64 arg = edge_info[i].arg.i;
-                            if (MVM_string_grapheme_is_cclass(tc, arg, MVM_string_gi_cached_get_grapheme(tc, &gic, offset)))
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARCLASS_NEG: {
-                            const MVMint64 arg = edge_info[i].arg.i;
-                            if (!MVM_string_grapheme_is_cclass(tc, arg, MVM_string_gi_cached_get_grapheme(tc, &gic, offset)))
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARLIST: {
-                            MVMString *arg   = edge_info[i].arg.s;
-                            MVMGrapheme32 cp = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (MVM_string_index_of_grapheme(tc, arg, cp) >= 0)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARLIST_NEG: {
-                            MVMString *arg    = edge_info[i].arg.s;
-                            const MVMGrapheme32 cp = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (MVM_string_index_of_grapheme(tc, arg, cp) < 0)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I_LL: {
-                            const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (ord == lc_arg || ord == uc_arg) {
-                                MVMint64 fate = (edge_info[i].act >> 8) & 0xfffff;
-                                nextst[numnext++] = to;
-                                while (usedlonglit <= fate)
-                                    longlit[usedlonglit++] = 0;
-                                longlit[fate] = offset - orig_offset + 1;
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (ord == lc_arg || ord == uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I_NEG: {
-                            const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (ord != lc_arg && ord != uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (ord >= lc_arg && ord <= uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_NEG: {
-                            const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord    = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            if (ord < lc_arg || uc_arg < ord)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_SUBRULE:
-                            if (MVM_UNLIKELY(nfadeb))
-                                fprintf(stderr, "IGNORING SUBRULE\n");
-                            continue;
-                        case MVM_NFA_EDGE_CODEPOINT_M:
-                        case MVM_NFA_EDGE_CODEPOINT_M_NEG: {
-                            MVMNormalizer norm;
-                            MVMint32 ready;
-                            MVMGrapheme32 ga = edge_info[i].arg.g;
-                            MVMGrapheme32 gb = MVM_string_ord_basechar_at(tc, target, offset);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, ga, &ga);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                ga = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-
-                            if (((act == MVM_NFA_EDGE_CODEPOINT_M)     && (ga == gb))
-                             || ((act == MVM_NFA_EDGE_CODEPOINT_M_NEG) && (ga != gb)))
-                                nextst[numnext++] = to;
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_IM:
-                        case MVM_NFA_EDGE_CODEPOINT_IM_NEG: {
-                            MVMNormalizer norm;
-                            MVMint32 ready;
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord = MVM_string_ord_basechar_at(tc, target, offset);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, uc_arg, &uc_arg);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                uc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, lc_arg, &lc_arg);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                lc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-
-                            if (((act == MVM_NFA_EDGE_CODEPOINT_IM)     && (ord == lc_arg || ord == uc_arg))
-                             || ((act == MVM_NFA_EDGE_CODEPOINT_IM_NEG) && (ord != lc_arg && ord != uc_arg)))
-                                nextst[numnext++] = to;
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_M: {
-                            const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
-                            if (ord >= lc_arg && ord <= uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_M_NEG: {
-                            const MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            const MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            const MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
-                            if (ord < lc_arg || uc_arg < ord)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_SYNTH_CP_COUNT: {
-                            /* Binary search the edges ahead for the grapheme. */
-                            const MVMGrapheme32 search = MVM_string_gi_cached_get_grapheme(tc, &gic, offset);
-                            const MVMint64 num_possibilities = edge_info[i].arg.i;
-                            const MVMint64 end = i + num_possibilities;
-                            MVMint64 l = i + 1;
-                            MVMint64 r = end;
-                            MVMint64 found = -1;
-                            while (l <= r) {
-                                const MVMint64 m = l + (r - l) / 2;
-                                const MVMGrapheme32 test = edge_info[m].arg.g;
-                                if (test == search) {
-                                    /* We found it, but important we get the first edge
-                                     * that matches. */
-                                    found = m;
-                                    while (found > i + 1 && edge_info[found - 1].arg.g == search)
-                                        found--;
-                                    break;
-                                }
-                                if (test < search)
-                                    l = m + 1;
-                                else
-                                    r = m - 1;
-                            }
-                            if (found == -1) {
-                                /* Binary search failed to find a match, so just skip all
-                                 * the nodes. */
-                                i += num_possibilities;
-                            }
-                            else {
-                                /* Add all states that match. */
-                                while (found <= end && edge_info[found].arg.g == search) {
-                                    to = edge_info[found].to;
-                                    if (edge_info[found].act == MVM_NFA_EDGE_CODEPOINT) {
-                                        nextst[numnext++] = to;
-                                        if (MVM_UNLIKELY(nfadeb))
-                                            fprintf(stderr, "%d->%d ", (int)found, (int)to);
-                                    }
-                                    else {
-                                        const MVMint64 fate = (edge_info[found].act >> 8) & 0xfffff;
-                                        nextst[numnext++] = to;
-                                        while (usedlonglit <= fate)
-                                            longlit[usedlonglit++] = 0;
-                                        longlit[fate] = offset - orig_offset + 1;
-                                        if (MVM_UNLIKELY(nfadeb))
-                                            fprintf(stderr, "%d->%d ", (int)found, (int)to);
-                                    }
-                                    found++;
-                                }
-                                i += num_possibilities;
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
-            if (MVM_UNLIKELY(nfadeb)) fprintf(stderr,"\n");
+        if (dstate) {
+            dstate = add_transition(tc, dfa, dstate, at_eos, g, &run, nextst, numnext);
+            run.recording = 0;
         }
 
-        /* Move to next character and generation. */
+        /* Move to next character. */
         offset++;
-        gen++;
     }
+    MVM_free(run.events);
+
     /* strip any literal lengths, leaving only fates */
-    if (usedlonglit || nfadeb) {
+    if (run.usedlonglit || nfadeb) {
         if (MVM_UNLIKELY(nfadeb)) fprintf(stderr,"Final\n");
-        for (i = 0; i < total_fates; i++) {
-            if (MVM_UNLIKELY(nfadeb)) fprintf(stderr, "  %08llx\n", (long long unsigned int)fates[i]);
-            fates[i] &= 0xffffff;
+        for (i = 0; i < run.total_fates; i++) {
+            if (MVM_UNLIKELY(nfadeb)) fprintf(stderr, "  %08llx\n", (long long unsigned int)run.fates[i]);
+            run.fates[i] &= 0xffffff;
         }
     }
 
-    *total_fates_out = total_fates;
-    return fates;
+    *total_fates_out = run.total_fates;
+    return run.fates;
 }
 
 /* Takes an NFA, a target string in and an offset. Runs the NFA and returns
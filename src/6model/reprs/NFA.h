@@ -47,12 +47,69 @@ struct MVMNFAStateInfo {
     } arg;
 };
 
+/* The DFA built lazily over an NFA as it is run. Each DFA state stands for
+ * the list of NFA states the simulation has at some position. The first time
+ * a grapheme is seen in a DFA state, a step of the simulation is made and the
+ * fate edges it crossed and literals it passed the end of are recorded as a
+ * transition, so later runs can replay them in place of the step. States and
+ * transitions are only added, under the mutex, and transitions are published
+ * with an atomic store, so runs read the DFA without locking. Once it has as
+ * many states as it can hold, runs simulate the NFA from there on. */
+#define MVM_NFA_DFA_MAX_STATES  128
+#define MVM_NFA_DFA_ASCII       128
+#define MVM_NFA_DFA_OTHER_BITS  5
+
+#define MVM_NFA_DFA_EVENT_FATE     0
+#define MVM_NFA_DFA_EVENT_LONGLIT  1
+struct MVMNFADFAEvent {
+    MVMint64 arg;
+    MVMint32 kind;
+};
+
+struct MVMNFADFATransition {
+    MVMNFADFAState *to;
+    MVMNFADFAEvent *events;
+    MVMuint32       num_events;
+    MVMGrapheme32   g;
+};
+
+struct MVMNFADFAState {
+    /* The NFA states, in the order the simulation has them. */
+    MVMuint32 *nfa_states;
+    MVMuint32  num_nfa_states;
+
+    /* Transitions at the end of the string, over ASCII graphemes (indexed
+     * directly, so the common case costs a single load), and over all other
+     * graphemes (in a small open addressing table). */
+    MVMuint32            num_other;
+    MVMNFADFATransition *eos;
+    MVMNFADFATransition *ascii[MVM_NFA_DFA_ASCII];
+    MVMNFADFATransition *other[1 << MVM_NFA_DFA_OTHER_BITS];
+};
+
+struct MVMNFADFA {
+    uv_mutex_t      mutex;
+    MVMuint32       num_states;
+    MVMNFADFAState *states[MVM_NFA_DFA_MAX_STATES];
+};
+
 /* Body of an NFA. */
 struct MVMNFABody {
     MVMObject        *fates;
     MVMint64          num_states;
     MVMint64         *num_state_edges;
     MVMNFAStateInfo **states;
+    MVMNFADFA        *dfa;
+
+    /* If every edge that the start state can take over a grapheme is a
+     * literal one, and no fate can be reached without taking one, these are
+     * the graphemes such edges match, so a run at a position not starting
+     * with one of them can fail right away. ASCII ones are in a bitmap, the
+     * rest sorted for a binary search. */
+    MVMuint64         start_ascii[2];
+    MVMGrapheme32    *start_literals;
+    MVMuint32         num_start_literals;
+    MVMuint32         has_start_literals;
 };
 
 struct MVMNFA {
@@ -66,5 +123,6 @@ const MVMREPROps * MVMNFA_initialize(MVMThreadContext *tc);
 /* Other NFA related functions. */
 MVMObject * MVM_nfa_from_statelist(MVMThreadContext *tc, MVMObject *states, MVMObject *nfa_type);
 MVMObject * MVM_nfa_run_proto(MVMThreadContext *tc, MVMObject *nfa, MVMString *target, MVMint64 offset);
+void MVM_nfa_dfa_destroy(MVMNFADFA *dfa);
 void MVM_nfa_run_alt(MVMThreadContext *tc, MVMObject *nfa, MVMString *target,
     MVMint64 offset, MVMObject *bstack, MVMObject *cstack, MVMObject *labels);
@@ -0,0 +1,385 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps NativeHash_this_repr;
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st = MVM_gc_allocate_stable(tc, &NativeHash_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)MVM_malloc(sizeof(MVMNativeHashREPRData));
+
+        repr_data->slot_type  = MVM_reg_int64;
+        repr_data->value_type = NULL;
+
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMNativeHash);
+        st->REPR_data = repr_data;
+    });
+
+    return st->WHAT;
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVMNativeHashBody *src_body  = (MVMNativeHashBody *)src;
+    MVMNativeHashBody *dest_body = (MVMNativeHashBody *)dest;
+
+    MVMStrHashTable *src_hashtable = &(src_body->hashtable);
+    MVMStrHashTable *dest_hashtable = &(dest_body->hashtable);
+    if (MVM_str_hash_entry_size(tc, dest_hashtable)) {
+        /* As for MVMHash, clone always targets a fresh object. */
+        MVM_oops(tc, "copy_to on NativeHash that is already initialized");
+    }
+    MVM_str_hash_build(tc, dest_hashtable, sizeof(MVMNativeHashEntry),
+                       MVM_str_hash_count(tc, src_hashtable));
+    MVMStrHashIterator iterator = MVM_str_hash_first(tc, src_hashtable);
+    while (!MVM_str_hash_at_end(tc, src_hashtable, iterator)) {
+        MVMNativeHashEntry *entry = MVM_str_hash_current_nocheck(tc, src_hashtable, iterator);
+        MVMNativeHashEntry *new_entry = MVM_str_hash_insert_nocheck(tc, dest_hashtable, entry->hash_handle.key);
+        new_entry->value = entry->value;
+        MVM_gc_write_barrier(tc, &(dest_root->header), &(new_entry->hash_handle.key->common.header));
+        iterator = MVM_str_hash_next_nocheck(tc, src_hashtable, iterator);
+    }
+}
+
+/* Adds held objects to the GC worklist; only the keys are objects. */
+static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMStrHashTable *hashtable = &(body->hashtable);
+    MVM_gc_worklist_presize_for(tc, worklist, MVM_str_hash_count(tc, hashtable));
+
+    MVMStrHashIterator iterator = MVM_str_hash_first(tc, hashtable);
+    while (!MVM_str_hash_at_end(tc, hashtable, iterator)) {
+        MVMNativeHashEntry *current = MVM_str_hash_current_nocheck(tc, hashtable, iterator);
+        MVM_gc_worklist_add(tc, worklist, &current->hash_handle.key);
+        iterator = MVM_str_hash_next_nocheck(tc, hashtable, iterator);
+    }
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMNativeHash *h = (MVMNativeHash *)obj;
+    MVM_str_hash_demolish(tc, &(h->body.hashtable));
+}
+
+/* Marks the REPR data. */
+static void gc_mark_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMGCWorklist *worklist) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    if (repr_data == NULL)
+        return;
+    MVM_gc_worklist_add(tc, worklist, &repr_data->value_type);
+}
+
+/* Frees the REPR data. */
+static void gc_free_repr_data(MVMThreadContext *tc, MVMSTable *st) {
+    MVM_free(st->REPR_data);
+}
+
+MVM_STATIC_INLINE void check_kind(MVMThreadContext *tc, MVMSTable *st, MVMuint16 kind) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    if (MVM_UNLIKELY(kind != repr_data->slot_type))
+        MVM_exception_throw_adhoc(tc,
+            "NativeHash: values are %s, but a %s was used",
+            MVM_reg_get_debug_name(tc, repr_data->slot_type),
+            MVM_reg_get_debug_name(tc, kind));
+}
+
+/* Looking up a missing key gives zero, as reading past the end of a native
+ * array does. */
+static void at_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister *result, MVMuint16 kind) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    check_kind(tc, st, kind);
+    MVMNativeHashEntry *entry = MVM_str_hash_fetch(tc, &(body->hashtable), (MVMString *)key_obj);
+    if (kind == MVM_reg_int64)
+        result->i64 = entry ? entry->value.i64 : 0;
+    else
+        result->n64 = entry ? entry->value.n64 : 0.0;
+}
+
+static void bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister value, MVMuint16 kind) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMStrHashTable *hashtable = &(body->hashtable);
+
+    MVMString *key = (MVMString *)key_obj;
+    if (!MVM_str_hash_key_is_valid(tc, key)) {
+        MVM_str_hash_key_throw_invalid(tc, key);
+    }
+    check_kind(tc, st, kind);
+
+    if (!MVM_str_hash_entry_size(tc, hashtable)) {
+        MVM_str_hash_build(tc, hashtable, sizeof(MVMNativeHashEntry), 0);
+    }
+
+    MVMNativeHashEntry *entry = MVM_str_hash_lvalue_fetch_nocheck(tc, hashtable, key);
+    if (kind == MVM_reg_int64)
+        entry->value.i64 = value.i64;
+    else
+        entry->value.n64 = value.n64;
+    if (!entry->hash_handle.key) {
+        entry->hash_handle.key = key;
+        MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+    }
+}
+
+static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    return MVM_str_hash_count(tc, &(body->hashtable));
+}
+
+static MVMint64 exists_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    return MVM_str_hash_fetch(tc, &(body->hashtable), (MVMString *)key_obj) != NULL;
+}
+
+static void delete_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVM_str_hash_delete(tc, &(body->hashtable), (MVMString *)key_obj);
+}
+
+static MVMStorageSpec get_value_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    MVMStorageSpec spec;
+    spec.inlineable      = MVM_STORAGE_SPEC_INLINED;
+    spec.boxed_primitive = repr_data->slot_type == MVM_reg_int64
+        ? MVM_STORAGE_SPEC_BP_INT
+        : MVM_STORAGE_SPEC_BP_NUM;
+    spec.can_box         = 0;
+    spec.bits            = 64;
+    spec.align           = ALIGNOF(MVMint64);
+    spec.is_unsigned     = 0;
+    return spec;
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Works out the slot type from the storage spec of the value type. */
+static void spec_to_repr_data(MVMThreadContext *tc, MVMNativeHashREPRData *repr_data, const MVMStorageSpec *spec) {
+    if (spec->boxed_primitive == MVM_STORAGE_SPEC_BP_INT && spec->bits == 64 && !spec->is_unsigned)
+        repr_data->slot_type = MVM_reg_int64;
+    else if (spec->boxed_primitive == MVM_STORAGE_SPEC_BP_NUM && spec->bits == 64)
+        repr_data->slot_type = MVM_reg_num64;
+    else
+        MVM_exception_throw_adhoc(tc,
+            "NativeHash: values must be 64-bit integers or floats");
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
+    MVMStringConsts          str_consts = tc->instance->str_consts;
+    MVMNativeHashREPRData * const repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+
+    MVMObject *info = MVM_repr_at_key_o(tc, info_hash, str_consts.hash);
+    if (!MVM_is_null(tc, info)) {
+        MVMObject *type = MVM_repr_at_key_o(tc, info, str_consts.type);
+        if (!MVM_is_null(tc, type)) {
+            const MVMStorageSpec *spec = REPR(type)->get_storage_spec(tc, STABLE(type));
+            spec_to_repr_data(tc, repr_data, spec);
+            MVM_ASSIGN_REF(tc, &(st->header), repr_data->value_type, type);
+        }
+    }
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMNativeHash);
+}
+
+/* Serializes the REPR data. */
+static void serialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationWriter *writer) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    MVM_serialization_write_ref(tc, writer, repr_data->value_type);
+}
+
+/* Deserializes representation data. */
+static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)MVM_malloc(sizeof(MVMNativeHashREPRData));
+
+    MVMObject *type = MVM_serialization_read_ref(tc, reader);
+    MVM_ASSIGN_REF(tc, &(st->header), repr_data->value_type, type);
+    repr_data->slot_type = MVM_reg_int64;
+    st->REPR_data = repr_data;
+
+    if (type) {
+        MVM_serialization_force_stable(tc, reader, STABLE(type));
+        spec_to_repr_data(tc, repr_data, REPR(type)->get_storage_spec(tc, STABLE(type)));
+    }
+}
+
+/* Deserialize the representation. */
+static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMSerializationReader *reader) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMStrHashTable *hashtable = &(body->hashtable);
+    MVMint64 elems = MVM_serialization_read_int(tc, reader);
+    MVMint64 i;
+    MVM_str_hash_build(tc, hashtable, sizeof(MVMNativeHashEntry), elems);
+    for (i = 0; i < elems; i++) {
+        MVMString *key = MVM_serialization_read_str(tc, reader);
+        if (!MVM_str_hash_key_is_valid(tc, key)) {
+            MVM_str_hash_key_throw_invalid(tc, key);
+        }
+        MVMNativeHashEntry *entry = MVM_str_hash_insert_nocheck(tc, hashtable, key);
+        if (repr_data->slot_type == MVM_reg_int64)
+            entry->value.i64 = MVM_serialization_read_int(tc, reader);
+        else
+            entry->value.n64 = MVM_serialization_read_num(tc, reader);
+        MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
+    }
+}
+
+/* Serialize the representation. As for MVMHash, the keys are sorted so the
+ * output doesn't depend on the hash salt. */
+static MVMThreadContext *cmp_tc;
+static int cmp_strings(const void *s1, const void *s2) {
+    return MVM_string_compare(cmp_tc, *(MVMString **)s1, *(MVMString **)s2);
+}
+static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMStrHashTable *hashtable = &(body->hashtable);
+    MVMuint64 elems = MVM_str_hash_count(tc, hashtable);
+    MVMString **keys = MVM_malloc(sizeof(MVMString *) * elems);
+    MVMuint64 i = 0;
+    MVM_serialization_write_int(tc, writer, elems);
+    MVMStrHashIterator iterator = MVM_str_hash_first(tc, hashtable);
+    while (!MVM_str_hash_at_end(tc, hashtable, iterator)) {
+        MVMNativeHashEntry *current = MVM_str_hash_current_nocheck(tc, hashtable, iterator);
+        keys[i++] = current->hash_handle.key;
+        iterator = MVM_str_hash_next_nocheck(tc, hashtable, iterator);
+    }
+    cmp_tc = tc;
+    qsort(keys, elems, sizeof(MVMString*), cmp_strings);
+    for (i = 0; i < elems; i++) {
+        MVMNativeHashEntry *entry = MVM_str_hash_fetch_nocheck(tc, hashtable, keys[i]);
+        MVM_serialization_write_str(tc, writer, keys[i]);
+        if (repr_data->slot_type == MVM_reg_int64)
+            MVM_serialization_write_int(tc, writer, entry->value.i64);
+        else
+            MVM_serialization_write_num(tc, writer, entry->value.n64);
+    }
+    MVM_free(keys);
+}
+
+/* Bytecode specialization for this REPR. */
+static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    switch (ins->info->opcode) {
+    case MVM_OP_create: {
+        /* A zeroed body is an empty hash, so these can be fast-created, as
+         * for MVMHash. */
+        if (!(st->mode_flags & MVM_FINALIZE_TYPE) && st->pretenure_state != MVM_PRETENURE_YES) {
+            MVMSpeshOperand target   = ins->operands[0];
+            MVMSpeshOperand type     = ins->operands[1];
+            MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, target);
+
+            ins->info                = MVM_op_get_op(MVM_OP_sp_fastcreate);
+            ins->operands            = MVM_spesh_alloc(tc, g, 3 * sizeof(MVMSpeshOperand));
+            ins->operands[0]         = target;
+            ins->operands[1].lit_i16 = sizeof(MVMNativeHash);
+            ins->operands[2].lit_i16 = MVM_spesh_add_spesh_slot(tc, g, (MVMCollectable *)st);
+            MVM_spesh_usages_delete_by_reg(tc, g, type, ins);
+
+            tgt_facts->flags |= MVM_SPESH_FACT_KNOWN_TYPE | MVM_SPESH_FACT_CONCRETE;
+            tgt_facts->type = st->WHAT;
+        }
+        break;
+    }
+    }
+}
+
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    return sizeof(MVMNativeHashEntry) * MVM_str_hash_count(tc, &(body->hashtable));
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMNativeHash_initialize(MVMThreadContext *tc) {
+    return &NativeHash_this_repr;
+}
+
+/* devirtualized versions of at_key */
+
+static void native_hash_at_key_int64(MVMThreadContext *tc, MVMSTable *st, void *data, MVMString *key, MVMRegister *value) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMNativeHashEntry *entry = MVM_str_hash_fetch(tc, &(body->hashtable), key);
+    value->i64 = entry ? entry->value.i64 : 0;
+}
+
+static void native_hash_at_key_num64(MVMThreadContext *tc, MVMSTable *st, void *data, MVMString *key, MVMRegister *value) {
+    MVMNativeHashBody *body = (MVMNativeHashBody *)data;
+    MVMNativeHashEntry *entry = MVM_str_hash_fetch(tc, &(body->hashtable), key);
+    value->n64 = entry ? entry->value.n64 : 0.0;
+}
+
+/* devirtualization dispatch function for the JIT to use. Binding isn't
+ * devirtualized, since a new key needs a write barrier on the hash, and the
+ * devirtualized calls don't get passed the object. */
+
+void *MVM_NativeHash_find_fast_impl_for_jit(MVMThreadContext *tc, MVMSTable *st, MVMint16 op, MVMuint16 kind) {
+    MVMNativeHashREPRData *repr_data = (MVMNativeHashREPRData *)st->REPR_data;
+
+    switch (op) {
+        case MVM_OP_atkey_i:
+            if (kind == MVM_reg_int64 && repr_data->slot_type == MVM_reg_int64)
+                return native_hash_at_key_int64;
+            break;
+        case MVM_OP_atkey_n:
+            if (kind == MVM_reg_num64 && repr_data->slot_type == MVM_reg_num64)
+                return native_hash_at_key_num64;
+            break;
+        default:
+            return NULL;
+    }
+    return NULL;
+}
+
+static const MVMREPROps NativeHash_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    NULL, /* initialize */
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    MVM_REPR_DEFAULT_POS_FUNCS,
+    {
+        at_key,
+        bind_key,
+        exists_key,
+        delete_key,
+        get_value_storage_spec
+    },    /* ass_funcs */
+    elems,
+    get_storage_spec,
+    NULL, /* change_type */
+    serialize,
+    deserialize,
+    serialize_repr_data,
+    deserialize_repr_data,
+    deserialize_stable_size,
+    gc_mark,
+    gc_free,
+    NULL, /* gc_cleanup */
+    gc_mark_repr_data,
+    gc_free_repr_data,
+    compose,
+    spesh,
+    "NativeHash", /* name */
+    MVM_REPR_ID_NativeHash,
+    unmanaged_size,
+    NULL, /* describe_refs */
+};
@@ -0,0 +1,33 @@
+/* Representation used for hashes with string keys and native values, such as
+ * counters, which would otherwise have to box every value. The value type is
+ * set at compose time and is either a 64-bit integer (the default) or a
+ * 64-bit float. Only the keys need marking by the GC. */
+struct MVMNativeHashEntry {
+    /* hash handle inline struct, including the key. */
+    struct MVMStrHashHandle hash_handle;
+    /* the native value */
+    union {
+        MVMint64 i64;
+        MVMnum64 n64;
+    } value;
+};
+
+struct MVMNativeHashBody {
+    MVMStrHashTable hashtable;
+};
+struct MVMNativeHash {
+    MVMObject common;
+    MVMNativeHashBody body;
+};
+
+/* The value type, as a register kind (MVM_reg_int64 or MVM_reg_num64), and
+ * the type object it was composed with, if any. */
+struct MVMNativeHashREPRData {
+    MVMuint16  slot_type;
+    MVMObject *value_type;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMNativeHash_initialize(MVMThreadContext *tc);
+
+void *MVM_NativeHash_find_fast_impl_for_jit(MVMThreadContext *tc, MVMSTable *st, MVMint16 op, MVMuint16 kind);
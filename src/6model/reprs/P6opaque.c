@@ -28,6 +28,70 @@ MVM_STATIC_INLINE void align_to(MVMuint64 *size, MVMuint32 align) {
     }
 }
 
+/* Gets the size and alignment of a type flattened into the body. A P6opaque
+ * (inlined as a value type) takes up a whole body, so the P6opaque functions
+ * work on it just as they do on a standalone object. */
+static MVMuint32 flattened_size(MVMThreadContext *tc, MVMSTable *st, MVMuint32 *align) {
+    if (st->REPR->ID == MVM_REPR_ID_P6opaque) {
+        *align = ALIGNOF(MVMint64) > ALIGNOF(void *) ? ALIGNOF(MVMint64) : ALIGNOF(void *);
+        return st->size - sizeof(MVMObject);
+    }
+    else {
+        const MVMStorageSpec *spec = st->REPR->get_storage_spec(tc, st);
+        *align = spec->align;
+        return spec->bits / 8;
+    }
+}
+
+/* Works out the offset in the body of the attribute in each slot, and gives
+ * the size of the body. Normally attributes go in declaration order; with
+ * MVM_P6OPAQUE_PACK, they are placed from the most strictly aligned down, so
+ * that no padding is needed between them. Slots stay in declaration order
+ * either way, so the name map, hints and serialized objects are unaffected,
+ * and as the layout only depends on the attributes' types, it works out the
+ * same when a type is deserialized. */
+static MVMuint64 lay_out_attributes(MVMThreadContext *tc, MVMuint16 num_attributes,
+        MVMSTable **flattened_stables, MVMuint16 *offsets) {
+    MVMuint64 cur_offset = sizeof(MVMP6opaqueBody);
+    MVMuint32 placed = 0;
+    MVMuint32 max_align = 0;
+    MVMuint16 i;
+    while (placed < num_attributes) {
+        /* Find the alignment to place this round; when not packing, that's
+         * any, so all are placed in the first. */
+        MVMuint32 next_align = 0;
+        if (tc->instance->p6opaque_pack) {
+            for (i = 0; i < num_attributes; i++) {
+                MVMuint32 align = ALIGNOF(MVMObject *);
+                if (flattened_stables[i])
+                    flattened_size(tc, flattened_stables[i], &align);
+                if ((max_align == 0 || align < max_align) && align > next_align)
+                    next_align = align;
+            }
+        }
+        for (i = 0; i < num_attributes; i++) {
+            MVMuint32 align, size;
+            if (flattened_stables[i]) {
+                size = flattened_size(tc, flattened_stables[i], &align);
+            }
+            else {
+                align = ALIGNOF(MVMObject *);
+                size  = sizeof(MVMObject *);
+            }
+            if (next_align && align != next_align)
+                continue;
+            align_to(&cur_offset, align);
+            if (offsets)
+                offsets[i] = cur_offset;
+            cur_offset += size;
+            placed++;
+        }
+        max_align = next_align;
+    }
+    align_to(&cur_offset, ALIGNOF(void *));
+    return cur_offset;
+}
+
 /* Helper for finding a slot number. */
 static MVMint64 try_get_slot(MVMThreadContext *tc, MVMP6opaqueREPRData *repr_data, MVMObject *class_key, MVMString *name) {
     if (repr_data->name_to_index_mapping) {
@@ -103,6 +167,9 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
             MVMObject *ref = get_obj_at_offset(src, offset);
             if (ref)
                 set_obj_at_offset(tc, dest_root, dest, offset, ref);
+            else
+                /* Matters when copying into an inlined attribute. */
+                *((MVMObject **)((char *)dest + offset)) = NULL;
         }
     }
 }
@@ -127,18 +194,22 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
     }
 }
 
-/* Called by the VM in order to free memory associated with this object. */
-static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
-    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(obj)->REPR_data;
+/* Cleans up any nested reprs that need it; called for an object being
+ * freed, or when this type is inlined into another. */
+static void gc_cleanup(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)st->REPR_data;
     MVMint64 i;
-    void *data = MVM_p6opaque_real_data(tc, OBJECT_BODY(obj));
-
-    /* Cleanup any nested reprs that need it. */
+    data = MVM_p6opaque_real_data(tc, data);
     for (i = 0; repr_data->gc_cleanup_slots[i] >= 0; i++) {
         MVMuint16  offset = repr_data->attribute_offsets[repr_data->gc_cleanup_slots[i]];
         MVMSTable *st     = repr_data->flattened_stables[repr_data->gc_cleanup_slots[i]];
         st->REPR->gc_cleanup(tc, st, (char *)data + offset);
     }
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    gc_cleanup(tc, STABLE(obj), OBJECT_BODY(obj));
 
     /* If we replaced the object body, free the replacement. */
     MVM_free(((MVMP6opaque *)obj)->body.replaced);
@@ -377,6 +448,10 @@ static void bind_attribute(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
             MVMObject *value = value_reg.o;
             if (attr_st) {
                 MVMSTable *value_st = STABLE(value);
+                if (attr_st->REPR->ID == MVM_REPR_ID_P6opaque && !IS_CONCRETE(value))
+                    MVM_exception_throw_adhoc(tc,
+                        "P6opaque: cannot store a type object (%s) in an inlined attribute",
+                        MVM_6model_get_stable_debug_name(tc, value_st));
                 if (attr_st == value_st)
                     value_st->REPR->copy_to(tc, attr_st, OBJECT_BODY(value), root,
                         (char *)data + repr_data->attribute_offsets[slot]);
@@ -650,6 +725,8 @@ static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *
 static void mk_storage_spec(MVMThreadContext *tc, MVMP6opaqueREPRData * repr_data, MVMStorageSpec *spec) {
 
     spec->inlineable      = MVM_STORAGE_SPEC_REFERENCE;
+    spec->bits            = 0;
+    spec->align           = ALIGNOF(void *);
     spec->boxed_primitive = MVM_STORAGE_SPEC_BP_NONE;
     spec->can_box         = 0;
 
@@ -685,6 +762,7 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
     MVMString    * const str_ass_del = str_consts.associative_delegate;
     MVMString    * const str_pos_del = str_consts.positional_delegate;
     MVMString  * const str_attribute = str_consts.attribute;
+    MVMString    * const str_inlined = str_consts.inlined;
     MVMString * const str_box_target = str_consts.box_target;
 
     /* Check not already composed. */
@@ -749,7 +827,6 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
     mro_pos          = mro_count;
     cur_slot         = 0;
     cur_type         = 0;
-    cur_alloc_addr   = sizeof(MVMP6opaqueBody);
     cur_obj_attr     = 0;
     cur_init_slot    = 0;
     cur_mark_slot    = 0;
@@ -780,9 +857,8 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
             MVMObject *type = MVM_repr_at_key_o(tc, attr_info, str_type);
             MVMint64 is_box_target = REPR(attr_info)->ass_funcs.exists_key(tc,
                 STABLE(attr_info), attr_info, OBJECT_BODY(attr_info), (MVMObject *)str_box_target);
+            MVMObject *inlined_val = MVM_repr_at_key_o(tc, attr_info, str_inlined);
             MVMint8 inlined = 0;
-            MVMuint32 bits;
-            MVMuint32 align;
 
             /* Ensure we have a name. */
             if (MVM_is_null(tc, name_obj)) {
@@ -804,16 +880,12 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
 
             /* Consider the type. */
             unboxed_type = MVM_STORAGE_SPEC_BP_NONE;
-            bits         = sizeof(MVMObject *) * 8;
-            align        = ALIGNOF(void *);
             if (!MVM_is_null(tc, type)) {
                 /* Get the storage spec of the type and see what it wants. */
                 const MVMStorageSpec *spec = REPR(type)->get_storage_spec(tc, STABLE(type));
                 if (spec->inlineable == MVM_STORAGE_SPEC_INLINED) {
                     /* Yes, it's something we'll flatten. */
                     unboxed_type = spec->boxed_primitive;
-                    bits = spec->bits;
-                    align = spec->align;
                     MVM_ASSIGN_REF(tc, &(st->header), repr_data->flattened_stables[cur_slot], STABLE(type));
                     inlined = 1;
 
@@ -884,19 +956,32 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
                         repr_data->unbox_slots[REPR(type)->ID] = cur_slot;
                     }
                 }
-            }
-
-            /* C structure needs careful alignment. If cur_alloc_addr is not
-             * aligned to align bytes (cur_alloc_addr % align), make sure it is
-             * before we add the next element. */
-            align_to(&cur_alloc_addr, align);
 
-            /* Attribute will live at the current position in the object. */
-            repr_data->attribute_offsets[cur_slot] = cur_alloc_addr;
+                /* Another P6opaque type asked to be inlined is flattened in
+                 * as a value type: it is copied in when stored and out when
+                 * read, so its attributes live in this object's body. */
+                else if (REPR(type)->ID == MVM_REPR_ID_P6opaque
+                        && !MVM_is_null(tc, inlined_val) && MVM_repr_get_int(tc, inlined_val)) {
+                    if (!STABLE(type)->REPR_data || STABLE(type) == st) {
+                        if (num_attrs) {
+                            MVM_free_null(name_map->names);
+                            MVM_free_null(name_map->slots);
+                        }
+                        free_repr_data(repr_data);
+                        MVM_exception_throw_adhoc(tc,
+                            "While composing %s: can't inline attribute %"PRId64" of type %s before that type is composed",
+                            MVM_6model_get_stable_debug_name(tc, st), i, MVM_6model_get_debug_name(tc, type));
+                    }
+                    MVM_ASSIGN_REF(tc, &(st->header), repr_data->flattened_stables[cur_slot], STABLE(type));
+                    inlined = 1;
+                    repr_data->initialize_slots[cur_init_slot++] = cur_slot;
+                    repr_data->gc_mark_slots[cur_mark_slot++] = cur_slot;
+                    repr_data->gc_cleanup_slots[cur_cleanup_slot++] = cur_slot;
+                }
+            }
 
-            /* Handle object attributes, which need marking and may have auto-viv needs. */
+            /* Handle object attributes, which may have auto-viv needs. */
             if (!inlined) {
-                repr_data->gc_obj_mark_offsets[cur_obj_attr] = cur_alloc_addr;
                 if (MVM_repr_exists_key(tc, attr_info, str_avc))
                     MVM_ASSIGN_REF(tc, &(st->header), repr_data->auto_viv_values[cur_slot],
                         MVM_repr_at_key_o(tc, attr_info, str_avc));
@@ -914,7 +999,7 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
                     MVM_exception_throw_adhoc(tc,
                         "While composing %s: Duplicate positional delegate attributes: %d and %"PRId64"", MVM_6model_get_stable_debug_name(tc, st), repr_data->pos_del_slot, cur_slot);
                 }
-                if (unboxed_type == MVM_STORAGE_SPEC_BP_NONE)
+                if (unboxed_type == MVM_STORAGE_SPEC_BP_NONE && !inlined)
                     repr_data->pos_del_slot = cur_slot;
                 else {
                     if (num_attrs) {
@@ -936,7 +1021,7 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
                     MVM_exception_throw_adhoc(tc,
                         "While composing %s: Duplicate associative delegate attributes: %d and %"PRId64, MVM_6model_get_stable_debug_name(tc, st), repr_data->pos_del_slot, cur_slot);
                 }
-                if (unboxed_type == MVM_STORAGE_SPEC_BP_NONE)
+                if (unboxed_type == MVM_STORAGE_SPEC_BP_NONE && !inlined)
                     repr_data->ass_del_slot = cur_slot;
                 else {
                     if (num_attrs) {
@@ -949,13 +1034,6 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
                 }
             }
 
-            /* Add the required space for this type.
-             *
-             * Note: This is the only place in this function where cur_alloc_addr can
-             * become unaligned.
-             */
-            cur_alloc_addr += bits / 8;
-
             /* Increment slot count. */
             cur_slot++;
         }
@@ -964,9 +1042,15 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
         cur_type++;
     }
 
-    align_to(&cur_alloc_addr, ALIGNOF(void *));
-
-    /* Add allocated amount for body to have total object size. */
+    /* Now we know what all the attributes are, place them, and note where
+     * the object ones are for marking. Add allocated amount for body to have
+     * total object size. */
+    cur_alloc_addr = lay_out_attributes(tc, total_attrs, repr_data->flattened_stables,
+        repr_data->attribute_offsets);
+    cur_obj_attr = 0;
+    for (i = 0; i < total_attrs; i++)
+        if (!repr_data->flattened_stables[i])
+            repr_data->gc_obj_mark_offsets[cur_obj_attr++] = repr_data->attribute_offsets[i];
     st->size = sizeof(MVMP6opaque) + (cur_alloc_addr - sizeof(MVMP6opaqueBody));
     MVM_ASSERT_ALIGNED(st->size, ALIGNOF(void *));
 
@@ -987,31 +1071,24 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info_hash) {
 static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
     /* To calculate size, we need number of attributes and to know about
      * anything flattend in. */
-    MVMint64  num_attributes = MVM_serialization_read_int(tc, reader);
-    MVMuint64 cur_offset = sizeof(MVMP6opaque);
-    MVMint64  i;
+    MVMint64    num_attributes = MVM_serialization_read_int(tc, reader);
+    MVMSTable **flattened_stables = MVM_malloc(P6OMAX(num_attributes, 1) * sizeof(MVMSTable *));
+    MVMuint64   body_size;
+    MVMint64    i;
     for (i = 0; i < num_attributes; i++) {
+        flattened_stables[i] = NULL;
         if (MVM_serialization_read_int(tc, reader)) {
             MVMSTable *st = MVM_serialization_read_stable_ref(tc, reader);
             const MVMStorageSpec *ss = st->REPR->get_storage_spec(tc, st);
-            if (ss->inlineable) {
-                /* TODO: Review if/when we get sub-byte things. */
-                align_to(&cur_offset, (MVMuint32)ss->align);
-                cur_offset += ss->bits / 8;
-            }
-            else {
-                align_to(&cur_offset, ALIGNOF(MVMObject *));
-                cur_offset += sizeof(MVMObject *);
-            }
-        }
-        else {
-            align_to(&cur_offset, ALIGNOF(MVMObject *));
-            cur_offset += sizeof(MVMObject *);
+            /* TODO: Review if/when we get sub-byte things. */
+            if (ss->inlineable || st->REPR->ID == MVM_REPR_ID_P6opaque)
+                flattened_stables[i] = st;
         }
     }
 
-    align_to(&cur_offset, ALIGNOF(void *));
-    st->size = cur_offset;
+    body_size = lay_out_attributes(tc, num_attributes, flattened_stables, NULL);
+    MVM_free(flattened_stables);
+    st->size = sizeof(MVMP6opaque) + (body_size - sizeof(MVMP6opaqueBody));
     MVM_ASSERT_ALIGNED(st->size, ALIGNOF(void *));
 }
 
@@ -1174,26 +1251,12 @@ static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerial
     repr_data->gc_mark_slots       = (MVMint16 *)MVM_malloc((repr_data->num_attributes + 1) * sizeof(MVMint16));
     repr_data->gc_cleanup_slots    = (MVMint16 *)MVM_malloc((repr_data->num_attributes + 1) * sizeof(MVMint16));
     repr_data->gc_obj_mark_offsets_count = 0;
-    cur_offset          = sizeof(MVMP6opaqueBody);
     cur_initialize_slot = 0;
     cur_gc_mark_slot    = 0;
     cur_gc_cleanup_slot = 0;
     for (i = 0; i < repr_data->num_attributes; i++) {
-        if (repr_data->flattened_stables[i] == NULL) {
-            align_to(&cur_offset, ALIGNOF(MVMObject *));
-            /* Store position. */
-            repr_data->attribute_offsets[i] = cur_offset;
-
-            /* Reference type. Needs marking. */
-            repr_data->gc_obj_mark_offsets[repr_data->gc_obj_mark_offsets_count] = cur_offset;
-            repr_data->gc_obj_mark_offsets_count++;
-
-            /* Increment by pointer size. */
-            cur_offset += sizeof(MVMObject *);
-        }
-        else {
-            /* Store position. */
-            MVMSTable *cur_st = repr_data->flattened_stables[i];
+        MVMSTable *cur_st = repr_data->flattened_stables[i];
+        if (cur_st) {
             const MVMStorageSpec *spec = cur_st->REPR->get_storage_spec(tc, cur_st);
             /* Set up flags for initialization and GC. */
             if (cur_st->REPR->initialize)
@@ -1207,15 +1270,17 @@ static void deserialize_repr_data(MVMThreadContext *tc, MVMSTable *st, MVMSerial
                 free_repr_data(repr_data);
                 MVM_exception_throw_adhoc(tc, "Serialization error: Storage Spec of P6opaque must not have align set to 0.");
             }
-
-            align_to(&cur_offset, spec->align);
-
-            repr_data->attribute_offsets[i] = cur_offset;
-
-            /* Increment by size reported by representation. */
-            cur_offset += spec->bits / 8;
         }
     }
+
+    /* Place the attributes just as compose did, and note the reference
+     * types, which need marking. */
+    cur_offset = lay_out_attributes(tc, repr_data->num_attributes,
+        repr_data->flattened_stables, repr_data->attribute_offsets);
+    for (i = 0; i < repr_data->num_attributes; i++)
+        if (!repr_data->flattened_stables[i])
+            repr_data->gc_obj_mark_offsets[repr_data->gc_obj_mark_offsets_count++] =
+                repr_data->attribute_offsets[i];
     assert(cur_offset <= st->size + sizeof(MVMP6opaqueBody) - sizeof(MVMP6opaque));
     repr_data->initialize_slots[cur_initialize_slot] = -1;
     repr_data->gc_mark_slots[cur_gc_mark_slot] = -1;
@@ -1275,6 +1340,7 @@ static void change_type(MVMThreadContext *tc, MVMObject *obj, MVMObject *new_typ
     MVMP6opaqueREPRData *cur_repr_data = (MVMP6opaqueREPRData *)STABLE(obj)->REPR_data;
     MVMP6opaqueREPRData *new_repr_data = (MVMP6opaqueREPRData *)STABLE(new_type)->REPR_data;
     MVMP6opaqueNameMap *cur_map_entry, *new_map_entry;
+    MVMuint32 moved;
 
     /* Ensure we don't have a type object. */
     if (!IS_CONCRETE(obj))
@@ -1312,8 +1378,13 @@ static void change_type(MVMThreadContext *tc, MVMObject *obj, MVMObject *new_typ
         new_map_entry++;
     }
 
+    /* When attributes are packed, those of the current type may not be in
+     * the same place in the new one. */
+    moved = memcmp(cur_repr_data->attribute_offsets, new_repr_data->attribute_offsets,
+        cur_repr_data->num_attributes * sizeof(MVMuint16)) != 0;
+
     /* Resize if needed. */
-    if (STABLE(obj)->size != STABLE(new_type)->size) {
+    if (STABLE(obj)->size != STABLE(new_type)->size || moved) {
         /* Get current object body. */
         MVMP6opaqueBody *body = (MVMP6opaqueBody *)OBJECT_BODY(obj);
         void            *old  = body->replaced ? body->replaced : body;
@@ -1321,12 +1392,27 @@ static void change_type(MVMThreadContext *tc, MVMObject *obj, MVMObject *new_typ
         /* Allocate new memory. */
         size_t  new_size = STABLE(new_type)->size - sizeof(MVMObject);
         void   *new = MVM_malloc(new_size);
-        memset((char *)new + (STABLE(obj)->size - sizeof(MVMObject)),
-            0, new_size - (STABLE(obj)->size - sizeof(MVMObject)));
 
         /* Copy existing to new.
          * XXX Need more care here, as may have to re-barrier pointers. */
-        memcpy(new, old, STABLE(obj)->size - sizeof(MVMObject));
+        if (moved) {
+            MVMuint16 i;
+            memset(new, 0, new_size);
+            for (i = 0; i < cur_repr_data->num_attributes; i++) {
+                MVMSTable *attr_st = cur_repr_data->flattened_stables[i];
+                MVMuint32 attr_align;
+                size_t attr_size = attr_st
+                    ? flattened_size(tc, attr_st, &attr_align)
+                    : sizeof(MVMObject *);
+                memcpy((char *)new + new_repr_data->attribute_offsets[i],
+                    (char *)old + cur_repr_data->attribute_offsets[i], attr_size);
+            }
+        }
+        else {
+            memset((char *)new + (STABLE(obj)->size - sizeof(MVMObject)),
+                0, new_size - (STABLE(obj)->size - sizeof(MVMObject)));
+            memcpy(new, old, STABLE(obj)->size - sizeof(MVMObject));
+        }
 
         /* Pointer switch, taking care of existing body issues. */
         if (body->replaced) {
@@ -1339,7 +1425,7 @@ static void change_type(MVMThreadContext *tc, MVMObject *obj, MVMObject *new_typ
     }
 
     /* Finally, ready to switch over the STable. */
-    MVM_ASSIGN_REF(tc, &(obj->header), obj->st, STABLE(new_type));
+    MVM_SET_STABLE(tc, obj, STABLE(new_type));
 }
 
 static void die_no_pos_del(MVMThreadContext *tc, MVMSTable *st) {
@@ -1539,8 +1625,10 @@ static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpes
         return;
     switch (opcode) {
     case MVM_OP_create: {
-        /* Create can be optimized if there are no initialization slots. */
-        if (repr_data->initialize_slots[0] < 0 && !(st->mode_flags & MVM_FINALIZE_TYPE)) {
+        /* Create can be optimized if there are no initialization slots,
+         * unless objects of the type are allocated straight into gen2. */
+        if (repr_data->initialize_slots[0] < 0 && !(st->mode_flags & MVM_FINALIZE_TYPE)
+                && st->pretenure_state != MVM_PRETENURE_YES) {
             MVMSpeshOperand target   = ins->operands[0];
             MVMSpeshOperand type     = ins->operands[1];
             MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, target);
@@ -1790,9 +1878,11 @@ static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpes
                 !(st->mode_flags & MVM_FINALIZE_TYPE)) {
             MVMSTable *embedded_st = repr_data->flattened_stables[repr_data->unbox_int_slot];
             if (embedded_st->REPR->ID == MVM_REPR_ID_P6bigint) {
-                MVMSpeshFacts *value_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
-
-                /* Turn into a sp_fastbox_bi[_ic] instruction. */
+                /* A constant in range of the integer cache is just a load of
+                 * the cached object; otherwise, turn into a sp_fastbox_bi[_ic]
+                 * instruction. */
+                if (MVM_intcache_spesh_box(tc, g, ins, st))
+                    break;
                 MVMint32 int_cache_type_idx = MVM_intcache_type_index(tc, st->WHAT);
                 MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, ins->operands[0]);
                 MVMSpeshOperand *orig_operands = ins->operands;
@@ -1813,10 +1903,6 @@ static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpes
 
                 MVM_spesh_graph_add_comment(tc, g, ins, "box_i into a %s",
                         MVM_6model_get_stable_debug_name(tc, st));
-
-                if (value_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE) {
-                    MVM_spesh_graph_add_comment(tc, g, ins, "could have made literal");
-                }
             }
         }
         break;
@@ -2049,7 +2135,7 @@ static const MVMREPROps P6opaque_this_repr = {
     deserialize_stable_size,
     gc_mark,
     gc_free,
-    NULL, /* gc_cleanup */
+    gc_cleanup,
     gc_mark_repr_data,
     gc_free_repr_data,
     compose,
@@ -2064,7 +2150,7 @@ static const MVMREPROps P6opaque_this_repr = {
  * precisely known types. */
 size_t MVM_p6opaque_attr_offset(MVMThreadContext *tc, MVMObject *type,
                                 MVMObject *class_handle, MVMString *name) {
-    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)type->st->REPR_data;
+    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(type)->REPR_data;
     size_t slot = try_get_slot(tc, repr_data, class_handle, name);
     return repr_data->attribute_offsets[slot];
 }
@@ -2082,7 +2168,7 @@ MVMuint16 MVM_p6opaque_get_bigint_offset(MVMThreadContext *tc, MVMSTable *st) {
 
 /* Gets the attribute index given we know the slot offset. */
 MVMuint32 MVM_p6opaque_offset_to_attr_idx(MVMThreadContext *tc, MVMObject *type, size_t offset) {
-    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)type->st->REPR_data;
+    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(type)->REPR_data;
     MVMuint32 i;
     for (i = 0; i < repr_data->num_attributes; i++)
         if (repr_data->attribute_offsets[i] == offset)
@@ -2090,6 +2176,46 @@ MVMuint32 MVM_p6opaque_offset_to_attr_idx(MVMThreadContext *tc, MVMObject *type,
     MVM_oops(tc, "P6opaque: slot offset not found");
 }
 
+/* Finds the index of the (non-flattened) attribute of an object that holds
+ * the given value, or -1 if there's none. */
+MVMint64 MVM_p6opaque_attr_idx_holding(MVMThreadContext *tc, MVMObject *obj, MVMObject *value) {
+    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(obj)->REPR_data;
+    void *data;
+    MVMuint32 i;
+    if (!repr_data || !IS_CONCRETE(obj))
+        return -1;
+    data = MVM_p6opaque_real_data(tc, OBJECT_BODY(obj));
+    for (i = 0; i < repr_data->num_attributes; i++)
+        if (!repr_data->flattened_stables[i]
+                && get_obj_at_offset(data, repr_data->attribute_offsets[i]) == value)
+            return i;
+    return -1;
+}
+
+/* Checks that an object has a (non-flattened) attribute with the given index. */
+static MVMP6opaqueREPRData * check_attr_idx(MVMThreadContext *tc, MVMObject *obj, MVMint64 idx) {
+    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(obj)->REPR_data;
+    if (!repr_data || !IS_CONCRETE(obj) || idx < 0 || idx >= repr_data->num_attributes
+            || repr_data->flattened_stables[idx])
+        MVM_exception_throw_adhoc(tc, "P6opaque: no object attribute with index %"PRId64" in %s",
+            idx, MVM_6model_get_debug_name(tc, obj));
+    return repr_data;
+}
+
+/* Gets a (non-flattened) attribute of an object by index. */
+MVMObject * MVM_p6opaque_get_attr_idx(MVMThreadContext *tc, MVMObject *obj, MVMint64 idx) {
+    MVMP6opaqueREPRData *repr_data = check_attr_idx(tc, obj, idx);
+    return get_obj_at_offset(MVM_p6opaque_real_data(tc, OBJECT_BODY(obj)),
+        repr_data->attribute_offsets[idx]);
+}
+
+/* Binds a (non-flattened) attribute of an object by index. */
+void MVM_p6opaque_bind_attr_idx(MVMThreadContext *tc, MVMObject *obj, MVMint64 idx, MVMObject *value) {
+    MVMP6opaqueREPRData *repr_data = check_attr_idx(tc, obj, idx);
+    set_obj_at_offset(tc, obj, MVM_p6opaque_real_data(tc, OBJECT_BODY(obj)),
+        repr_data->attribute_offsets[idx], value);
+}
+
 #ifdef DEBUG_HELPERS
 /* This is meant to be called in a debugging session and not used anywhere else.
  * Please don't delete. */
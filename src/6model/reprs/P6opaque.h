@@ -125,4 +125,7 @@ size_t MVM_p6opaque_attr_offset(MVMThreadContext *tc, MVMObject *type,
     MVMObject *class_handle, MVMString *name);
 MVMuint16 MVM_p6opaque_get_bigint_offset(MVMThreadContext *tc, MVMSTable *st);
 MVMuint32 MVM_p6opaque_offset_to_attr_idx(MVMThreadContext *tc, MVMObject *type, size_t offset);
+MVMint64 MVM_p6opaque_attr_idx_holding(MVMThreadContext *tc, MVMObject *obj, MVMObject *value);
+MVMObject * MVM_p6opaque_get_attr_idx(MVMThreadContext *tc, MVMObject *obj, MVMint64 idx);
+void MVM_p6opaque_bind_attr_idx(MVMThreadContext *tc, MVMObject *obj, MVMint64 idx, MVMObject *value);
 void MVM_P6opaque_at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind);
@@ -0,0 +1,249 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps ReadWriteLock_this_repr;
+
+/* Populates the object body with the lock state and parking primitives. */
+static void initialize_lock(MVMThreadContext *tc, MVMReadWriteLock *rw) {
+    MVMReadWriteLockBody *body = MVM_calloc(1, sizeof(MVMReadWriteLockBody));
+    int init_stat;
+    if ((init_stat = uv_mutex_init(&body->park_lock)) < 0) {
+        MVM_free(body);
+        MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
+            uv_strerror(init_stat));
+    }
+    if ((init_stat = uv_cond_init(&body->readers_cond)) < 0) {
+        uv_mutex_destroy(&body->park_lock);
+        MVM_free(body);
+        MVM_exception_throw_adhoc(tc, "Failed to initialize condition variable: %s",
+            uv_strerror(init_stat));
+    }
+    if ((init_stat = uv_cond_init(&body->writers_cond)) < 0) {
+        uv_cond_destroy(&body->readers_cond);
+        uv_mutex_destroy(&body->park_lock);
+        MVM_free(body);
+        MVM_exception_throw_adhoc(tc, "Failed to initialize condition variable: %s",
+            uv_strerror(init_stat));
+    }
+    rw->body = body;
+}
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st  = MVM_gc_allocate_stable(tc, &ReadWriteLock_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMReadWriteLock);
+    });
+
+    return st->WHAT;
+}
+
+/* Initializes a new instance. */
+static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
+    initialize_lock(tc, (MVMReadWriteLock *)root);
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVM_exception_throw_adhoc(tc, "Cannot copy object with representation ReadWriteLock");
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMReadWriteLockBody *body = ((MVMReadWriteLock *)obj)->body;
+    if (!body)
+        return;
+    if (body->state)
+        MVM_panic(1, "Tried to garbage-collect a locked reader-writer lock");
+    uv_mutex_destroy(&body->park_lock);
+    uv_cond_destroy(&body->readers_cond);
+    uv_cond_destroy(&body->writers_cond);
+    MVM_free(body);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
+    /* Nothing to do for this REPR. */
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMReadWriteLock);
+}
+
+/* As with ReentrantMutex, serializing a lock saves nothing; a fresh one is
+ * made upon deserialization. */
+static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
+}
+static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMSerializationReader *reader) {
+    initialize_lock(tc, (MVMReadWriteLock *)root);
+}
+
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    return sizeof(MVMReadWriteLockBody);
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMReadWriteLock_initialize(MVMThreadContext *tc) {
+    return &ReadWriteLock_this_repr;
+}
+
+static const MVMREPROps ReadWriteLock_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    initialize,
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    MVM_REPR_DEFAULT_POS_FUNCS,
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    MVM_REPR_DEFAULT_ELEMS,
+    get_storage_spec,
+    NULL, /* change_type */
+    serialize,
+    deserialize,
+    NULL, /* serialize_repr_data */
+    NULL, /* deserialize_repr_data */
+    deserialize_stable_size,
+    NULL, /* gc_mark */
+    gc_free,
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    NULL, /* gc_free_repr_data */
+    compose,
+    NULL, /* spesh */
+    "ReadWriteLock", /* name */
+    MVM_REPR_ID_ReadWriteLock,
+    unmanaged_size,
+    NULL, /* describe_refs */
+};
+
+static MVMReadWriteLockBody * get_body(MVMThreadContext *tc, MVMObject *lock, const char *op) {
+    if (REPR(lock)->ID != MVM_REPR_ID_ReadWriteLock || !IS_CONCRETE(lock))
+        MVM_exception_throw_adhoc(tc,
+            "%s requires a concrete object with REPR ReadWriteLock", op);
+    return ((MVMReadWriteLock *)lock)->body;
+}
+
+/* Tries to take the lock to read, which can't be done while a writer holds
+ * it or is waiting for it. */
+static MVMint32 try_read(MVMReadWriteLockBody *body) {
+    AO_t state = MVM_load(&body->state);
+    if ((state & MVM_RWLOCK_WRITER) || MVM_load(&body->waiting_writers))
+        return 0;
+    return MVM_trycas(&body->state, state, state + 1);
+}
+
+/* Wakes the threads waiting on a condition, if there are any. The park lock
+ * is taken so a thread that just found it must wait can't miss the wakeup. */
+static void wake(MVMThreadContext *tc, MVMObject *lock, MVMReadWriteLockBody *body,
+        uv_cond_t *cond, MVMint32 all) {
+    MVMROOT(tc, lock, {
+        MVM_gc_mark_thread_blocked(tc);
+        uv_mutex_lock(&body->park_lock);
+        MVM_gc_mark_thread_unblocked(tc);
+    });
+    if (all)
+        uv_cond_broadcast(cond);
+    else
+        uv_cond_signal(cond);
+    uv_mutex_unlock(&body->park_lock);
+}
+
+/* Takes the lock to read, waiting while a writer holds it or wants it. */
+void MVM_rwlock_read_lock(MVMThreadContext *tc, MVMObject *lock) {
+    MVMReadWriteLockBody *body = get_body(tc, lock, "readlock");
+    if (MVM_load(&body->writer_id) == tc->thread_id)
+        MVM_exception_throw_adhoc(tc,
+            "Cannot take a reader-writer lock to read while holding it to write");
+    while (!try_read(body)) {
+        AO_t state = MVM_load(&body->state);
+        if (!(state & MVM_RWLOCK_WRITER) && !MVM_load(&body->waiting_writers))
+            continue; /* Lost a race with another reader; just try again. */
+        MVMROOT(tc, lock, {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_mutex_lock(&body->park_lock);
+            MVM_incr(&body->waiting_readers);
+            while (!try_read(body))
+                uv_cond_wait(&body->readers_cond, &body->park_lock);
+            MVM_decr(&body->waiting_readers);
+            uv_mutex_unlock(&body->park_lock);
+            MVM_gc_mark_thread_unblocked(tc);
+        });
+        break;
+    }
+    tc->num_locks++;
+}
+
+/* Releases a read lock. The last reader out lets a waiting writer in. */
+void MVM_rwlock_read_unlock(MVMThreadContext *tc, MVMObject *lock) {
+    MVMReadWriteLockBody *body = get_body(tc, lock, "readunlock");
+    AO_t state;
+    do {
+        state = MVM_load(&body->state);
+        if (state == 0 || (state & MVM_RWLOCK_WRITER))
+            MVM_exception_throw_adhoc(tc,
+                "Attempt to unlock a reader-writer lock not held to read");
+    } while (!MVM_trycas(&body->state, state, state - 1));
+    tc->num_locks--;
+    if (state == 1 && MVM_load(&body->waiting_writers))
+        wake(tc, lock, body, &body->writers_cond, 0);
+}
+
+/* Takes the lock to write, waiting until no reader or writer holds it. */
+void MVM_rwlock_write_lock(MVMThreadContext *tc, MVMObject *lock) {
+    MVMReadWriteLockBody *body = get_body(tc, lock, "writelock");
+    if (MVM_load(&body->writer_id) == tc->thread_id)
+        MVM_exception_throw_adhoc(tc,
+            "Cannot take a reader-writer lock to write while already holding it");
+
+    /* Announcing we're waiting first keeps new readers out. */
+    MVM_incr(&body->waiting_writers);
+    if (!MVM_trycas(&body->state, 0, MVM_RWLOCK_WRITER)) {
+        MVMROOT(tc, lock, {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_mutex_lock(&body->park_lock);
+            while (!MVM_trycas(&body->state, 0, MVM_RWLOCK_WRITER))
+                uv_cond_wait(&body->writers_cond, &body->park_lock);
+            uv_mutex_unlock(&body->park_lock);
+            MVM_gc_mark_thread_unblocked(tc);
+        });
+    }
+    MVM_decr(&body->waiting_writers);
+    MVM_store(&body->writer_id, tc->thread_id);
+    tc->num_locks++;
+}
+
+/* Releases a write lock, handing the lock to any other waiting writer first,
+ * and otherwise letting in all the waiting readers. */
+void MVM_rwlock_write_unlock(MVMThreadContext *tc, MVMObject *lock) {
+    MVMReadWriteLockBody *body = get_body(tc, lock, "writeunlock");
+    if (MVM_load(&body->writer_id) != tc->thread_id)
+        MVM_exception_throw_adhoc(tc,
+            "Attempt to unlock a reader-writer lock by thread not holding it to write");
+    MVM_store(&body->writer_id, 0);
+    MVM_store(&body->state, 0);
+    tc->num_locks--;
+    if (MVM_load(&body->waiting_writers))
+        wake(tc, lock, body, &body->writers_cond, 0);
+    else if (MVM_load(&body->waiting_readers))
+        wake(tc, lock, body, &body->readers_cond, 1);
+}
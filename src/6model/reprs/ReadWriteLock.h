@@ -0,0 +1,40 @@
+/* The lock state word: the number of readers holding the lock, or this bit
+ * when a writer holds it. */
+#define MVM_RWLOCK_WRITER ((AO_t)1 << (sizeof(AO_t) * 8 - 1))
+
+/* Representation used for reader-writer locks, which any number of readers
+ * may hold at once, or a single writer. Writers are preferred: once one is
+ * waiting, new readers wait behind it. Readers and writers take the lock
+ * with a compare and swap on the state when they can; only when they must
+ * wait do they take the park lock, and mark the thread as blocked for the
+ * GC while they do. As with ConcBlockingQueue, the body is malloced so it
+ * never moves. The lock is not reentrant. */
+struct MVMReadWriteLockBody {
+    /* The number of readers holding the lock, or MVM_RWLOCK_WRITER. */
+    AO_t state;
+
+    /* The ID of the thread holding the lock to write, if any. */
+    AO_t writer_id;
+
+    /* Numbers of readers and writers waiting for the lock. */
+    AO_t waiting_readers;
+    AO_t waiting_writers;
+
+    /* Parking lock and condition variables. */
+    uv_mutex_t park_lock;
+    uv_cond_t  readers_cond;
+    uv_cond_t  writers_cond;
+};
+struct MVMReadWriteLock {
+    MVMObject common;
+    MVMReadWriteLockBody *body;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMReadWriteLock_initialize(MVMThreadContext *tc);
+
+/* Lock and unlock functions. */
+void MVM_rwlock_read_lock(MVMThreadContext *tc, MVMObject *lock);
+void MVM_rwlock_read_unlock(MVMThreadContext *tc, MVMObject *lock);
+void MVM_rwlock_write_lock(MVMThreadContext *tc, MVMObject *lock);
+void MVM_rwlock_write_unlock(MVMThreadContext *tc, MVMObject *lock);
@@ -137,17 +137,28 @@ void MVM_reentrantmutex_lock(MVMThreadContext *tc, MVMReentrantMutex *rm) {
         MVM_incr(&rm->body.lock_count);
     }
     else {
-        /* Not holding the lock; obtain it. */
+        /* Not holding the lock; obtain it. An uncontended lock is taken by
+         * the try, which never blocks, so there's no need to mark ourselves
+         * as blocked for the GC; only if that fails do we go the slow way. */
+        MVMuint64 wait_start = 0;
         /*interval_id = MVM_telemetry_interval_start(tc, "ReentrantMutex obtains lock");*/
         /*MVM_telemetry_interval_annotate(rm->body.mutex, interval_id, "lock in question");*/
-        MVMROOT(tc, rm, {
-            MVM_gc_mark_thread_blocked(tc);
-            uv_mutex_lock(rm->body.mutex);
-            MVM_gc_mark_thread_unblocked(tc);
-        });
+        if (uv_mutex_trylock(rm->body.mutex) != 0) {
+            if (tc->instance->lock_profiling)
+                wait_start = uv_hrtime();
+            MVMROOT(tc, rm, {
+                MVM_gc_mark_thread_blocked(tc);
+                uv_mutex_lock(rm->body.mutex);
+                MVM_gc_mark_thread_unblocked(tc);
+            });
+        }
         MVM_store(&rm->body.holder_id, tc->thread_id);
         MVM_store(&rm->body.lock_count, 1);
         tc->num_locks++;
+        if (tc->instance->lock_profiling)
+            MVM_lock_contention_log(tc, rm->body.mutex, "ReentrantMutex",
+                tc->cur_frame ? tc->cur_frame->static_info : NULL,
+                wait_start ? uv_hrtime() - wait_start : 0, wait_start != 0);
         /*MVM_telemetry_interval_stop(tc, interval_id, "ReentrantMutex obtained lock");*/
     }
 }
@@ -32,6 +32,8 @@ static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, voi
 
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&root);
 
+    uv_mutex_init(&sc->mutex_root_index);
+
     rep_indexes = REPR(BOOTIntArray)->allocate(tc, STABLE(BOOTIntArray));
     MVM_ASSIGN_REF(tc, &(root->header), sc->rep_indexes, rep_indexes);
 
@@ -127,11 +129,18 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     /* Free manually managed object and STable root list memory. */
     MVM_free(sc->body->root_objects);
     MVM_free(sc->body->root_stables);
+    MVM_ptr_hash_demolish(tc, &sc->body->rep_delta_attrs);
+    MVM_ptr_hash_demolish(tc, &sc->body->root_index[0]);
+    MVM_ptr_hash_demolish(tc, &sc->body->root_index[1]);
+    MVM_ptr_hash_demolish(tc, &sc->body->root_index[2]);
+    uv_mutex_destroy(&sc->body->mutex_root_index);
 
     /* If we have a serialization reader, clean that up too. */
     if (sc->body->sr) {
         if (sc->body->sr->data_needs_free)
             MVM_free(sc->body->sr->data);
+        MVM_free(sc->body->sr->objects_table_unpacked);
+        MVM_free(sc->body->sr->delta_objects);
         MVM_free(sc->body->sr->root.dependent_scs);
         MVM_free(sc->body->sr->contexts);
         MVM_free(sc->body->sr->wl_objects.indexes);
@@ -34,6 +34,23 @@ struct MVMSerializationContextBody {
      * mapping an object to its owner. */
     MVMObject *owned_objects;
 
+    /* Repossessed objects where only attribute containers they own were
+     * changed, mapped to a bitmask of the affected attribute indexes. Those
+     * are serialized as a delta rather than in full. The keys are always
+     * gen2 objects in our root set, so they neither move nor need marking. */
+    MVMPtrHashTable rep_delta_attrs;
+
+    /* Maps of the objects, STables and code refs in the root sets to their
+     * indexes, built lazily for lookups that can't use the index cached in
+     * the object header. They are keyed on addresses, so are only valid as
+     * long as no GC ran since root_index_gc_seq. The number of entries of
+     * each root set indexed so far lets those added since go in on demand.
+     * Protected by mutex_root_index. */
+    MVMPtrHashTable root_index[3];
+    MVMuint64 root_indexed[3];
+    MVMuint64 root_index_gc_seq;
+    uv_mutex_t mutex_root_index;
+
     /* Backlink to the (memory-managed) SC itself. If
      * this is null, it is unresolved. */
     MVMSerializationContext *sc;
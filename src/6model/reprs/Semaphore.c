@@ -26,19 +26,29 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 static void set_int(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 value) {
     MVMSemaphoreBody *body = (MVMSemaphoreBody *)data;
     int r;
-    body->sem = MVM_malloc(sizeof(uv_sem_t));
-    if ((r = uv_sem_init(body->sem, (MVMuint32) value)) < 0) {
+    if (value < 0)
+        MVM_exception_throw_adhoc(tc, "Cannot initialize Semaphore with %"PRId64" permits", value);
+    body->sem = MVM_calloc(1, sizeof(MVMSemaphoreState));
+    if ((r = uv_mutex_init(&body->sem->mutex)) < 0) {
         MVM_free_null(body->sem);
         MVM_exception_throw_adhoc(tc, "Failed to initialize Semaphore: %s",
             uv_strerror(r));
     }
+    if ((r = uv_cond_init(&body->sem->cond)) < 0) {
+        uv_mutex_destroy(&body->sem->mutex);
+        MVM_free_null(body->sem);
+        MVM_exception_throw_adhoc(tc, "Failed to initialize Semaphore: %s",
+            uv_strerror(r));
+    }
+    body->sem->permits = value;
 }
 
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMSemaphore *sem = (MVMSemaphore *)obj;
     if (sem->body.sem) {
-        uv_sem_destroy(sem->body.sem);
+        uv_cond_destroy(&sem->body.sem->cond);
+        uv_mutex_destroy(&sem->body.sem->mutex);
         MVM_free(sem->body.sem);
     }
 }
@@ -113,25 +123,107 @@ static const MVMREPROps Semaphore_this_repr = {
     NULL, /* describe_refs */
 };
 
+/* Takes n permits, waiting for them for at most timeout nanoseconds, or
+ * for as long as it takes if the timeout is negative. Returns 1 if it got
+ * them and 0 if not. All of the permits are taken at once, so threads that
+ * each want several can't deadlock holding some of them. The thread counts
+ * as blocked throughout, as it touches nothing but the state, which the GC
+ * leaves alone. */
+static MVMint64 acquire(MVMThreadContext *tc, MVMSemaphoreState *state, MVMint64 n,
+        MVMint64 timeout) {
+    MVMuint64 deadline = timeout > 0 ? uv_hrtime() + timeout : 0;
+    MVMint64  got      = 1;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&state->mutex);
+    if (state->permits < n) {
+        state->waiters++;
+        if (n > 1)
+            state->multi_waiters++;
+        /* Wakeups may be spurious, or come when another thread got in
+         * first, so we check again each time. */
+        while (state->permits < n) {
+            if (timeout < 0) {
+                uv_cond_wait(&state->cond, &state->mutex);
+            }
+            else {
+                MVMuint64 now = uv_hrtime();
+                if (timeout == 0 || now >= deadline) {
+                    got = 0;
+                    break;
+                }
+                uv_cond_timedwait(&state->cond, &state->mutex, deadline - now);
+            }
+        }
+        state->waiters--;
+        if (n > 1)
+            state->multi_waiters--;
+    }
+    if (got)
+        state->permits -= n;
+    uv_mutex_unlock(&state->mutex);
+    MVM_gc_mark_thread_unblocked(tc);
+    return got;
+}
+
+static void check_permits(MVMThreadContext *tc, const char *what, MVMint64 n) {
+    if (n < 0)
+        MVM_exception_throw_adhoc(tc, "Cannot %s a negative number of permits (%"PRId64")",
+            what, n);
+}
+
 MVMint64 MVM_semaphore_tryacquire(MVMThreadContext *tc, MVMSemaphore *sem) {
-    int r;
     MVM_telemetry_timestamp(tc, "Semaphore.tryAcquire");
-    r = uv_sem_trywait(sem->body.sem);
-    return !r;
+    return acquire(tc, sem->body.sem, 1, 0);
 }
 
 void MVM_semaphore_acquire(MVMThreadContext *tc, MVMSemaphore *sem) {
+    MVM_semaphore_acquire_n(tc, sem, 1);
+}
+
+void MVM_semaphore_release(MVMThreadContext *tc, MVMSemaphore *sem) {
+    MVM_semaphore_release_n(tc, sem, 1);
+}
+
+/* Takes n permits, waiting as long as it takes for them. */
+void MVM_semaphore_acquire_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n) {
     unsigned int interval_id;
+    check_permits(tc, "acquire", n);
     interval_id = MVM_telemetry_interval_start(tc, "Semaphore.acquire");
-    MVMROOT(tc, sem, {
-        MVM_gc_mark_thread_blocked(tc);
-        uv_sem_wait(sem->body.sem);
-        MVM_gc_mark_thread_unblocked(tc);
-    });
+    acquire(tc, sem->body.sem, n, -1);
     MVM_telemetry_interval_stop(tc, interval_id, "Semaphore.acquire");
 }
 
-void MVM_semaphore_release(MVMThreadContext *tc, MVMSemaphore *sem) {
+/* Tries to take n permits, waiting up to timeout seconds for them if they
+ * aren't there; a timeout of 0 or less doesn't wait. Returns 1 if it got the
+ * permits and 0 if not. */
+MVMint64 MVM_semaphore_tryacquire_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n,
+        MVMnum64 timeout) {
+    unsigned int interval_id;
+    MVMint64 got;
+    check_permits(tc, "acquire", n);
+    interval_id = MVM_telemetry_interval_start(tc, "Semaphore.tryAcquire");
+    got = acquire(tc, sem->body.sem, n,
+        timeout <= 0 ? 0 : timeout < 1e9 ? (MVMint64)(timeout * 1e9) : INT64_MAX / 2);
+    MVM_telemetry_interval_stop(tc, interval_id, "Semaphore.tryAcquire");
+    return got;
+}
+
+/* Gives back n permits, waking the waiters that might be able to use them:
+ * just one if they all want a single permit and only one came back, and all
+ * of them otherwise. */
+void MVM_semaphore_release_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n) {
+    MVMSemaphoreState *state = sem->body.sem;
+    check_permits(tc, "release", n);
     MVM_telemetry_timestamp(tc, "Semaphore.release");
-    uv_sem_post(sem->body.sem);
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&state->mutex);
+    state->permits += n;
+    if (state->waiters && n) {
+        if (n == 1 && !state->multi_waiters)
+            uv_cond_signal(&state->cond);
+        else
+            uv_cond_broadcast(&state->cond);
+    }
+    uv_mutex_unlock(&state->mutex);
+    MVM_gc_mark_thread_unblocked(tc);
 }
@@ -1,6 +1,20 @@
 /* Representation used for VM thread handles. */
 struct MVMSemaphoreBody {
-    uv_sem_t *sem;
+    MVMSemaphoreState *sem;
+};
+
+/* The permits of a semaphore, with the mutex protecting them and a condition
+ * variable to wait for them on. It's kept apart from the object, which the
+ * GC may move while threads are blocked on it. */
+struct MVMSemaphoreState {
+    uv_mutex_t mutex;
+    uv_cond_t  cond;
+    MVMint64   permits;
+
+    /* The threads waiting for permits, and how many of them want more than
+     * one, in which case a release has to wake all of them. */
+    MVMuint32  waiters;
+    MVMuint32  multi_waiters;
 };
 struct MVMSemaphore {
     MVMObject common;
@@ -14,3 +28,7 @@ const MVMREPROps * MVMSemaphore_initialize(MVMThreadContext *tc);
 MVMint64 MVM_semaphore_tryacquire(MVMThreadContext *tc, MVMSemaphore *sem);
 void MVM_semaphore_acquire(MVMThreadContext *tc, MVMSemaphore *sem);
 void MVM_semaphore_release(MVMThreadContext *tc, MVMSemaphore *sem);
+void MVM_semaphore_acquire_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n);
+MVMint64 MVM_semaphore_tryacquire_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n,
+    MVMnum64 timeout);
+void MVM_semaphore_release_n(MVMThreadContext *tc, MVMSemaphore *sem, MVMint64 n);
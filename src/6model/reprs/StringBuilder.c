@@ -0,0 +1,331 @@
+#include "moar.h"
+#include "math/ryu.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps StringBuilder_this_repr;
+
+/* The smallest buffer we'll allocate, in graphemes. */
+#define MVM_STRING_BUILDER_MIN_GRAPHS 16
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st  = MVM_gc_allocate_stable(tc, &StringBuilder_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMStringBuilder);
+    });
+
+    return st->WHAT;
+}
+
+/* Size in bytes of a grapheme in the builder's current storage. */
+static size_t grapheme_size(MVMStringBuilderBody *body) {
+    return body->storage_type == MVM_STRING_GRAPHEME_8
+        ? sizeof(MVMGrapheme8)
+        : sizeof(MVMGrapheme32);
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVMStringBuilderBody *src_body  = (MVMStringBuilderBody *)src;
+    MVMStringBuilderBody *dest_body = (MVMStringBuilderBody *)dest;
+    dest_body->storage_type      = src_body->storage_type;
+    dest_body->needs_renormalize = src_body->needs_renormalize;
+    dest_body->num_graphs        = src_body->num_graphs;
+    dest_body->alloc_graphs      = src_body->num_graphs;
+    dest_body->in_use            = 0;
+    if (src_body->num_graphs) {
+        size_t size = src_body->num_graphs * grapheme_size(src_body);
+        dest_body->buffer.any = MVM_malloc(size);
+        memcpy(dest_body->buffer.any, src_body->buffer.any, size);
+    }
+    else {
+        dest_body->buffer.any = NULL;
+    }
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMStringBuilder *sb = (MVMStringBuilder *)obj;
+    MVM_free(sb->body.buffer.any);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
+    /* Nothing to do for this REPR. */
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMStringBuilder);
+}
+
+/* Calculates the non-GC-managed memory we hold on to. */
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMStringBuilderBody *body = (MVMStringBuilderBody *)data;
+    return (MVMuint64)body->alloc_graphs * grapheme_size(body);
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMStringBuilder_initialize(MVMThreadContext *tc) {
+    return &StringBuilder_this_repr;
+}
+
+static const MVMREPROps StringBuilder_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    NULL, /* initialize */
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    MVM_REPR_DEFAULT_POS_FUNCS,
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    MVM_REPR_DEFAULT_ELEMS,
+    get_storage_spec,
+    NULL, /* change_type */
+    NULL, /* serialize */
+    NULL, /* deserialize */
+    NULL, /* serialize_repr_data */
+    NULL, /* deserialize_repr_data */
+    deserialize_stable_size,
+    NULL, /* gc_mark */
+    gc_free,
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    NULL, /* gc_free_repr_data */
+    compose,
+    NULL, /* spesh */
+    "StringBuilder", /* name */
+    MVM_REPR_ID_StringBuilder,
+    unmanaged_size,
+    NULL, /* describe_refs */
+};
+
+/* Assert that the passed object really is a string builder; throw if not. */
+void MVM_string_builder_ensure(MVMThreadContext *tc, MVMObject *sb, const char *op) {
+    if (MVM_UNLIKELY(REPR(sb)->ID != MVM_REPR_ID_StringBuilder || !IS_CONCRETE(sb)))
+        MVM_exception_throw_adhoc(tc,
+            "Operation '%s' can only work on an object with the StringBuilder representation",
+            op);
+}
+
+/* Checks and sets the builder single-user sanity check flag. */
+static void enter_single_user(MVMThreadContext *tc, MVMStringBuilder *sb) {
+    if (!MVM_trycas(&(sb->body.in_use), 0, 1))
+       MVM_exception_throw_adhoc(tc, "StringBuilder may not be used concurrently");
+    MVM_tc_set_ex_release_atomic(tc, &(sb->body.in_use));
+}
+
+/* Releases the builder single-user sanity check flag. */
+static void exit_single_user(MVMThreadContext *tc, MVMStringBuilder *sb) {
+    sb->body.in_use = 0;
+    MVM_tc_clear_ex_release_mutex(tc);
+}
+
+/* Makes sure there's space for another `graphs` graphemes, growing the
+ * buffer geometrically so appends are amortized O(1). A builder that has
+ * no buffer yet starts out with 8-bit storage. */
+static void ensure_space(MVMThreadContext *tc, MVMStringBuilder *sb, MVMStringIndex graphs) {
+    MVMuint64 needed = (MVMuint64)sb->body.num_graphs + graphs;
+    if (needed > 0xFFFFFFFFULL)
+        MVM_exception_throw_adhoc(tc,
+            "Can't append to StringBuilder, required number of graphemes %"PRIu64" > max allowed of %u",
+            needed, 0xFFFFFFFFU);
+    if (!sb->body.buffer.any)
+        sb->body.storage_type = MVM_STRING_GRAPHEME_8;
+    if (needed > sb->body.alloc_graphs) {
+        MVMuint64 new_alloc = (MVMuint64)sb->body.alloc_graphs * 2;
+        if (new_alloc < MVM_STRING_BUILDER_MIN_GRAPHS)
+            new_alloc = MVM_STRING_BUILDER_MIN_GRAPHS;
+        if (new_alloc < needed)
+            new_alloc = needed;
+        if (new_alloc > 0xFFFFFFFFULL)
+            new_alloc = 0xFFFFFFFFULL;
+        sb->body.buffer.any    = MVM_realloc(sb->body.buffer.any,
+            (size_t)new_alloc * grapheme_size(&(sb->body)));
+        sb->body.alloc_graphs  = (MVMuint32)new_alloc;
+    }
+}
+
+/* Switches the builder's buffer from 8-bit to 32-bit storage. */
+static void widen(MVMThreadContext *tc, MVMStringBuilder *sb) {
+    MVMGrapheme8  *old_buf = sb->body.buffer.blob_8;
+    MVMGrapheme32 *new_buf = MVM_malloc(sb->body.alloc_graphs * sizeof(MVMGrapheme32));
+    MVMuint32 num_graphs = sb->body.num_graphs;
+    MVMuint32 i;
+    MVM_VECTORIZE_LOOP
+    for (i = 0; i < num_graphs; i++)
+        new_buf[i] = old_buf[i];
+    MVM_free(old_buf);
+    sb->body.buffer.blob_32 = new_buf;
+    sb->body.storage_type   = MVM_STRING_GRAPHEME_32;
+}
+
+/* Notes whether appending something starting with the grapheme `first`
+ * will leave the result in NFG. */
+static void check_boundary(MVMThreadContext *tc, MVMStringBuilder *sb, MVMGrapheme32 first) {
+    if (sb->body.num_graphs && !sb->body.needs_renormalize) {
+        MVMGrapheme32 last = sb->body.storage_type == MVM_STRING_GRAPHEME_8
+            ? sb->body.buffer.blob_8[sb->body.num_graphs - 1]
+            : sb->body.buffer.blob_32[sb->body.num_graphs - 1];
+        if (MVM_nfg_are_graphemes_concat_stable(tc, last, first) != 1)
+            sb->body.needs_renormalize = 1;
+    }
+}
+
+/* Appends graphemes to the buffer, which must already have space for them. */
+static void append_8(MVMThreadContext *tc, MVMStringBuilder *sb, MVMGrapheme8 *from, MVMStringIndex graphs) {
+    if (sb->body.storage_type == MVM_STRING_GRAPHEME_8) {
+        memcpy(sb->body.buffer.blob_8 + sb->body.num_graphs, from, graphs * sizeof(MVMGrapheme8));
+    }
+    else {
+        MVMGrapheme32 *to = sb->body.buffer.blob_32 + sb->body.num_graphs;
+        MVMStringIndex i;
+        MVM_VECTORIZE_LOOP
+        for (i = 0; i < graphs; i++)
+            to[i] = from[i];
+    }
+    sb->body.num_graphs += graphs;
+}
+static void append_32(MVMThreadContext *tc, MVMStringBuilder *sb, MVMGrapheme32 *from, MVMStringIndex graphs) {
+    if (sb->body.storage_type == MVM_STRING_GRAPHEME_8) {
+        if (MVM_string_buf32_can_fit_into_8bit(from, graphs)) {
+            MVMGrapheme8 *to = sb->body.buffer.blob_8 + sb->body.num_graphs;
+            MVMStringIndex i;
+            MVM_VECTORIZE_LOOP
+            for (i = 0; i < graphs; i++)
+                to[i] = from[i];
+            sb->body.num_graphs += graphs;
+            return;
+        }
+        widen(tc, sb);
+    }
+    memcpy(sb->body.buffer.blob_32 + sb->body.num_graphs, from, graphs * sizeof(MVMGrapheme32));
+    sb->body.num_graphs += graphs;
+}
+
+/* Appends a string to the builder, copying straight out of the blobs that
+ * back it, a strand at a time. */
+void MVM_string_builder_append_s(MVMThreadContext *tc, MVMStringBuilder *sb, MVMString *s) {
+    MVMGraphemeIter gi;
+    MVMStringIndex  graphs;
+    MVM_string_check_arg(tc, s, "StringBuilder append");
+    graphs = MVM_string_graphs_nocheck(tc, s);
+    if (!graphs)
+        return;
+
+    enter_single_user(tc, sb);
+    check_boundary(tc, sb, MVM_string_get_grapheme_at_nocheck(tc, s, 0));
+    ensure_space(tc, sb, graphs);
+    MVM_string_gi_init(tc, &gi, s);
+    while (1) {
+        MVMStringIndex to_copy = MVM_string_gi_graphs_left_in_strand(tc, &gi);
+        switch (MVM_string_gi_blob_type(tc, &gi)) {
+            case MVM_STRING_GRAPHEME_32:
+                append_32(tc, sb, MVM_string_gi_active_blob_32_pos(tc, &gi), to_copy);
+                break;
+            case MVM_STRING_GRAPHEME_8:
+            case MVM_STRING_GRAPHEME_ASCII:
+                append_8(tc, sb, MVM_string_gi_active_blob_8_pos(tc, &gi), to_copy);
+                break;
+            default:
+                MVM_exception_throw_adhoc(tc, "String corruption detected: bad storage type");
+        }
+        if (!MVM_string_gi_has_more_strands_rep(tc, &gi))
+            break;
+        MVM_string_gi_next_strand_rep(tc, &gi);
+    }
+    exit_single_user(tc, sb);
+}
+
+/* Makes space for up to `max_len` digits and returns where to format them:
+ * straight into the buffer if it's 8-bit, or else into the scratch space. */
+static char * digits_target(MVMThreadContext *tc, MVMStringBuilder *sb, char *scratch, MVMStringIndex max_len) {
+    ensure_space(tc, sb, max_len);
+    return sb->body.storage_type == MVM_STRING_GRAPHEME_8
+        ? (char *)(sb->body.buffer.blob_8 + sb->body.num_graphs)
+        : scratch;
+}
+
+/* Takes the `len` digits formatted at the place digits_target gave. */
+static void digits_commit(MVMThreadContext *tc, MVMStringBuilder *sb, char *scratch, char *to, size_t len) {
+    check_boundary(tc, sb, to[0]);
+    if (to == scratch)
+        append_8(tc, sb, (MVMGrapheme8 *)scratch, len);
+    else
+        sb->body.num_graphs += len;
+}
+
+/* Appends the decimal representation of an integer, formatting it straight
+ * into the buffer rather than producing an intermediate string. */
+void MVM_string_builder_append_i(MVMThreadContext *tc, MVMStringBuilder *sb, MVMint64 i) {
+    char   scratch[MVM_INT_TO_STR_MAX_LEN];
+    char  *to;
+    size_t len;
+    enter_single_user(tc, sb);
+    to  = digits_target(tc, sb, scratch, MVM_INT_TO_STR_MAX_LEN);
+    len = MVM_i64_to_decimal(i, to);
+    digits_commit(tc, sb, scratch, to, len);
+    exit_single_user(tc, sb);
+}
+
+/* Appends a number, formatted the same way as a num to str coercion and
+ * likewise straight into the buffer. */
+void MVM_string_builder_append_n(MVMThreadContext *tc, MVMStringBuilder *sb, MVMnum64 n) {
+    char   scratch[MVM_NUM_TO_STR_MAX_LEN];
+    char  *to;
+    size_t len;
+    enter_single_user(tc, sb);
+    to  = digits_target(tc, sb, scratch, MVM_NUM_TO_STR_MAX_LEN);
+    len = MVM_num_to_shortest_str(n, to);
+    digits_commit(tc, sb, scratch, to, len);
+    exit_single_user(tc, sb);
+}
+
+/* Produces a string of everything appended so far and empties the builder.
+ * The buffer is handed over to the string as is, bar trimming off any unused
+ * space at the end. */
+MVMString * MVM_string_builder_finish(MVMThreadContext *tc, MVMStringBuilder *sb) {
+    MVMString *result;
+    MVMuint16  needs_renormalize;
+
+    if (!sb->body.num_graphs)
+        return tc->instance->str_consts.empty;
+
+    MVMROOT(tc, sb, {
+        result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
+    });
+    enter_single_user(tc, sb);
+    if (sb->body.alloc_graphs != sb->body.num_graphs && sb->body.num_graphs)
+        sb->body.buffer.any = MVM_realloc(sb->body.buffer.any,
+            sb->body.num_graphs * grapheme_size(&(sb->body)));
+    result->body.storage_type = sb->body.storage_type;
+    result->body.storage.any  = sb->body.buffer.any;
+    result->body.num_graphs   = sb->body.num_graphs;
+    needs_renormalize         = sb->body.needs_renormalize;
+    sb->body.buffer.any        = NULL;
+    sb->body.num_graphs        = 0;
+    sb->body.alloc_graphs      = 0;
+    sb->body.needs_renormalize = 0;
+    exit_single_user(tc, sb);
+
+    return needs_renormalize ? MVM_string_renormalize(tc, result) : result;
+}
@@ -0,0 +1,38 @@
+/* Representation used for a VM-provided string builder, which accumulates
+ * graphemes into a buffer that grows geometrically and is handed over to the
+ * resulting string when building is finished. */
+struct MVMStringBuilderBody {
+    /* The buffer of graphemes built up so far, in either 8-bit or 32-bit
+     * storage; we start out with 8 bits and widen if we have to. */
+    union {
+        MVMGrapheme32 *blob_32;
+        MVMGrapheme8  *blob_8;
+        void          *any;
+    } buffer;
+    MVMuint16 storage_type;
+
+    /* Set if something was appended that may not be stable under
+     * concatenation, so the result has to be renormalized. */
+    MVMuint16 needs_renormalize;
+
+    /* Graphemes used and allocated in the buffer. */
+    MVMuint32 num_graphs;
+    MVMuint32 alloc_graphs;
+
+    /* Single-user sanity check flag. */
+    AO_t in_use;
+};
+struct MVMStringBuilder {
+    MVMObject common;
+    MVMStringBuilderBody body;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMStringBuilder_initialize(MVMThreadContext *tc);
+
+/* Operations on a StringBuilder object. */
+void MVM_string_builder_ensure(MVMThreadContext *tc, MVMObject *sb, const char *op);
+void MVM_string_builder_append_s(MVMThreadContext *tc, MVMStringBuilder *sb, MVMString *s);
+void MVM_string_builder_append_i(MVMThreadContext *tc, MVMStringBuilder *sb, MVMint64 i);
+void MVM_string_builder_append_n(MVMThreadContext *tc, MVMStringBuilder *sb, MVMnum64 n);
+MVMString * MVM_string_builder_finish(MVMThreadContext *tc, MVMStringBuilder *sb);
@@ -0,0 +1,291 @@
+#include "moar.h"
+
+/* This representation's function pointer table. */
+static const MVMREPROps StringSearcher_this_repr;
+
+/* Creates a new type object of this representation, and associates it with
+ * the given HOW. */
+static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
+    MVMSTable *st  = MVM_gc_allocate_stable(tc, &StringSearcher_this_repr, HOW);
+
+    MVMROOT(tc, st, {
+        MVMObject *obj = MVM_gc_allocate_type_object(tc, st);
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, obj);
+        st->size = sizeof(MVMStringSearcher);
+    });
+
+    return st->WHAT;
+}
+
+/* Copies the body of one object to another. */
+static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
+    MVM_exception_throw_adhoc(tc, "Cannot copy object with representation StringSearcher");
+}
+
+/* Frees an automaton's nodes, along with their edges. */
+static void free_nodes(MVMStringSearcherNode *nodes, MVMuint32 num_nodes) {
+    MVMuint32 i;
+    for (i = 0; i < num_nodes; i++)
+        MVM_free(nodes[i].edges);
+    MVM_free(nodes);
+}
+
+/* Called by the VM in order to free memory associated with this object. */
+static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
+    MVMStringSearcher *searcher = (MVMStringSearcher *)obj;
+    if (searcher->body.nodes)
+        free_nodes(searcher->body.nodes, searcher->body.num_nodes);
+    MVM_free(searcher->body.needle_graphs);
+}
+
+static const MVMStorageSpec storage_spec = {
+    MVM_STORAGE_SPEC_REFERENCE, /* inlineable */
+    0,                          /* bits */
+    0,                          /* align */
+    MVM_STORAGE_SPEC_BP_NONE,   /* boxed_primitive */
+    0,                          /* can_box */
+    0,                          /* is_unsigned */
+};
+
+
+/* Gets the storage specification for this representation. */
+static const MVMStorageSpec * get_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
+    return &storage_spec;
+}
+
+/* Compose the representation. */
+static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
+    /* Nothing to do for this REPR. */
+}
+
+/* Set the size of the STable. */
+static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    st->size = sizeof(MVMStringSearcher);
+}
+
+/* Calculates the non-GC-managed memory we hold on to. */
+static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
+    MVMStringSearcherBody *body = (MVMStringSearcherBody *)data;
+    MVMuint64 size = body->num_needles * sizeof(MVMuint32);
+    if (body->nodes) {
+        MVMuint32 i;
+        size += body->num_nodes * sizeof(MVMStringSearcherNode);
+        for (i = 0; i < body->num_nodes; i++)
+            size += body->nodes[i].num_edges * sizeof(MVMStringSearcherEdge);
+    }
+    return size;
+}
+
+/* Initializes the representation. */
+const MVMREPROps * MVMStringSearcher_initialize(MVMThreadContext *tc) {
+    return &StringSearcher_this_repr;
+}
+
+static const MVMREPROps StringSearcher_this_repr = {
+    type_object_for,
+    MVM_gc_allocate_object,
+    NULL, /* initialize */
+    copy_to,
+    MVM_REPR_DEFAULT_ATTR_FUNCS,
+    MVM_REPR_DEFAULT_BOX_FUNCS,
+    MVM_REPR_DEFAULT_POS_FUNCS,
+    MVM_REPR_DEFAULT_ASS_FUNCS,
+    MVM_REPR_DEFAULT_ELEMS,
+    get_storage_spec,
+    NULL, /* change_type */
+    NULL, /* serialize */
+    NULL, /* deserialize */
+    NULL, /* serialize_repr_data */
+    NULL, /* deserialize_repr_data */
+    deserialize_stable_size,
+    NULL, /* gc_mark */
+    gc_free,
+    NULL, /* gc_cleanup */
+    NULL, /* gc_mark_repr_data */
+    NULL, /* gc_free_repr_data */
+    compose,
+    NULL, /* spesh */
+    "StringSearcher", /* name */
+    MVM_REPR_ID_StringSearcher,
+    unmanaged_size,
+    NULL, /* describe_refs */
+};
+
+/* Assert that the passed object really is a string searcher; throw if not. */
+void MVM_string_searcher_ensure(MVMThreadContext *tc, MVMObject *searcher, const char *op) {
+    if (MVM_UNLIKELY(REPR(searcher)->ID != MVM_REPR_ID_StringSearcher || !IS_CONCRETE(searcher)))
+        MVM_exception_throw_adhoc(tc,
+            "Operation '%s' can only work on an object with the StringSearcher representation",
+            op);
+}
+
+/* Finds the node a transition on g from the given node leads to, or 0 if
+ * there is no such transition (the root is never a transition target). */
+MVM_STATIC_INLINE MVMuint32 find_edge(MVMStringSearcherNode *node, MVMGrapheme32 g) {
+    MVMuint32 lo = 0, hi = node->num_edges;
+    while (lo < hi) {
+        MVMuint32 mid = lo + (hi - lo) / 2;
+        MVMGrapheme32 here = node->edges[mid].g;
+        if (here == g)
+            return node->edges[mid].node;
+        if (here < g)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return 0;
+}
+
+/* Adds a transition on g from the given node to the target node, keeping
+ * the edges sorted. */
+static void add_edge(MVMStringSearcherNode *node, MVMGrapheme32 g, MVMuint32 target) {
+    MVMuint32 pos = node->num_edges;
+    node->edges = MVM_realloc(node->edges, (node->num_edges + 1) * sizeof(MVMStringSearcherEdge));
+    while (pos > 0 && node->edges[pos - 1].g > g) {
+        node->edges[pos] = node->edges[pos - 1];
+        pos--;
+    }
+    node->edges[pos].g    = g;
+    node->edges[pos].node = target;
+    node->num_edges++;
+}
+
+/* Compiles the searcher from an array of needle strings. The trie of the
+ * needles is built first, then the fail and dictionary links are filled in
+ * with a breadth first walk, so every node's links point to shallower nodes
+ * that are already complete. */
+void MVM_string_searcher_compile(MVMThreadContext *tc, MVMStringSearcher *searcher, MVMObject *needles) {
+    MVM_VECTOR_DECL(MVMStringSearcherNode, nodes);
+    MVMStringSearcherNode  root;
+    MVMuint32             *needle_graphs;
+    MVMuint32             *queue;
+    MVMuint32              num_needles, i, head, tail;
+
+    if (REPR(needles)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(needles))
+        MVM_exception_throw_adhoc(tc, "StringSearcher needles must be a concrete array");
+    num_needles = (MVMuint32)MVM_repr_elems(tc, needles);
+    MVMROOT2(tc, searcher, needles, {
+        for (i = 0; i < num_needles; i++) {
+            MVMString *needle = MVM_repr_at_pos_s(tc, needles, i);
+            if (!needle || !IS_CONCRETE(needle) || MVM_string_graphs(tc, needle) == 0)
+                break;
+        }
+    });
+    if (i < num_needles)
+        MVM_exception_throw_adhoc(tc, "StringSearcher needle %"PRIu32" may not be empty", i);
+    if (!MVM_trycas(&(searcher->body.compiled), 0, 1))
+        MVM_exception_throw_adhoc(tc, "StringSearcher has already been compiled");
+
+    /* Build the trie. */
+    MVM_VECTOR_INIT(nodes, 16);
+    root.edges     = NULL;
+    root.num_edges = 0;
+    root.fail      = 0;
+    root.dict      = 0;
+    root.needle    = -1;
+    MVM_VECTOR_PUSH(nodes, root);
+    needle_graphs = MVM_malloc((num_needles ? num_needles : 1) * sizeof(MVMuint32));
+    MVMROOT2(tc, searcher, needles, {
+        for (i = 0; i < num_needles; i++) {
+            MVMString       *needle = MVM_repr_at_pos_s(tc, needles, i);
+            MVMStringIndex   graphs = MVM_string_graphs(tc, needle);
+            MVMStringIndex   j;
+            MVMuint32        cur    = 0;
+            MVMGraphemeIter  gi;
+            MVM_string_gi_init(tc, &gi, needle);
+            for (j = 0; j < graphs; j++) {
+                MVMGrapheme32 g    = MVM_string_gi_get_grapheme(tc, &gi);
+                MVMuint32     next = find_edge(&nodes[cur], g);
+                if (!next) {
+                    MVMStringSearcherNode fresh = root;
+                    next = MVM_VECTOR_ELEMS(nodes);
+                    MVM_VECTOR_PUSH(nodes, fresh);
+                    add_edge(&nodes[cur], g, next);
+                }
+                cur = next;
+            }
+            /* Of duplicate needles, only the first is reported. */
+            if (nodes[cur].needle < 0)
+                nodes[cur].needle = i;
+            needle_graphs[i] = graphs;
+        }
+    });
+
+    /* Fill in the links. */
+    queue = MVM_malloc(MVM_VECTOR_ELEMS(nodes) * sizeof(MVMuint32));
+    head  = tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        MVMuint32 u = queue[head++];
+        MVMuint32 e;
+        for (e = 0; e < nodes[u].num_edges; e++) {
+            MVMGrapheme32 g = nodes[u].edges[e].g;
+            MVMuint32     v = nodes[u].edges[e].node;
+            MVMuint32     f = 0;
+            if (u) {
+                f = nodes[u].fail;
+                while (f && !find_edge(&nodes[f], g))
+                    f = nodes[f].fail;
+                f = find_edge(&nodes[f], g);
+            }
+            nodes[v].fail = f;
+            nodes[v].dict = nodes[f].needle >= 0 ? f : nodes[f].dict;
+            queue[tail++] = v;
+        }
+    }
+    MVM_free(queue);
+
+    /* Publish the automaton; the nodes go last, since their presence is what
+     * says the searcher is ready. */
+    searcher->body.num_needles   = num_needles;
+    searcher->body.needle_graphs = needle_graphs;
+    searcher->body.num_nodes     = MVM_VECTOR_ELEMS(nodes);
+    MVM_barrier();
+    searcher->body.nodes         = nodes;
+}
+
+/* Finds all occurrences of all needles in the haystack from the start
+ * position on, in a single pass. Returns an integer array of position and
+ * needle index pairs, ordered by where each match ends, and longest first
+ * among matches ending at the same place. */
+MVMObject * MVM_string_searcher_find_all(MVMThreadContext *tc, MVMStringSearcher *searcher,
+                                         MVMString *haystack, MVMint64 start) {
+    MVMObject             *result;
+    MVMStringSearcherNode *nodes;
+    MVMuint32             *needle_graphs;
+    MVMGraphemeIter        gi;
+    MVMStringIndex         H_graphs, pos;
+    MVMuint32              state = 0;
+
+    MVM_string_check_arg(tc, haystack, "StringSearcher search");
+    if (!searcher->body.nodes)
+        MVM_exception_throw_adhoc(tc, "StringSearcher must be compiled before searching");
+    MVMROOT2(tc, searcher, haystack, {
+        result = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIntArray);
+    });
+
+    H_graphs = MVM_string_graphs_nocheck(tc, haystack);
+    if (start < 0 || H_graphs <= start)
+        return result;
+
+    nodes         = searcher->body.nodes;
+    needle_graphs = searcher->body.needle_graphs;
+    MVM_string_gi_init(tc, &gi, haystack);
+    if (start)
+        MVM_string_gi_move_to(tc, &gi, start);
+    for (pos = start; pos < H_graphs; pos++) {
+        MVMGrapheme32 g = MVM_string_gi_get_grapheme(tc, &gi);
+        MVMuint32     next, out;
+        while (!(next = find_edge(&nodes[state], g)) && state)
+            state = nodes[state].fail;
+        state = next;
+        out   = nodes[state].needle >= 0 ? state : nodes[state].dict;
+        while (out) {
+            MVMint32 needle = nodes[out].needle;
+            MVM_repr_push_i(tc, result, pos + 1 - needle_graphs[needle]);
+            MVM_repr_push_i(tc, result, needle);
+            out = nodes[out].dict;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+/* Representation used for a VM-provided multi-needle string searcher. It is
+ * compiled once from a list of needles into an Aho-Corasick automaton over
+ * graphemes, which then finds all occurrences of all needles in a haystack
+ * in a single pass. */
+struct MVMStringSearcherBody {
+    /* The automaton's nodes; node 0 is the root. NULL until compiled. */
+    MVMStringSearcherNode *nodes;
+    MVMuint32 num_nodes;
+
+    /* The number of needles, and the length in graphemes of each. */
+    MVMuint32  num_needles;
+    MVMuint32 *needle_graphs;
+
+    /* Set once compilation has started, so it only happens once. */
+    AO_t compiled;
+};
+struct MVMStringSearcher {
+    MVMObject common;
+    MVMStringSearcherBody body;
+};
+
+/* A node of the automaton, corresponding to some prefix of a needle. */
+struct MVMStringSearcherNode {
+    /* Transitions to longer prefixes, sorted ascending on grapheme so we
+     * can find one using binary search. */
+    MVMStringSearcherEdge *edges;
+    MVMuint32 num_edges;
+
+    /* The node for the longest proper suffix of this prefix that is itself
+     * a prefix of some needle. */
+    MVMuint32 fail;
+
+    /* The nearest node along the fail chain that completes a needle, or 0
+     * if there is none. */
+    MVMuint32 dict;
+
+    /* Index of the needle that this prefix completes, or -1 if none. */
+    MVMint32 needle;
+};
+struct MVMStringSearcherEdge {
+    MVMGrapheme32 g;
+    MVMuint32     node;
+};
+
+/* Function for REPR setup. */
+const MVMREPROps * MVMStringSearcher_initialize(MVMThreadContext *tc);
+
+/* Operations on a StringSearcher object. */
+void MVM_string_searcher_ensure(MVMThreadContext *tc, MVMObject *searcher, const char *op);
+void MVM_string_searcher_compile(MVMThreadContext *tc, MVMStringSearcher *searcher, MVMObject *needles);
+MVMObject * MVM_string_searcher_find_all(MVMThreadContext *tc, MVMStringSearcher *searcher,
+                                         MVMString *haystack, MVMint64 start);
@@ -1,5 +1,6 @@
 #include "moar.h"
 #include "limits.h"
+#include "platform/mmap.h"
 
 /* This representation's function pointer table. */
 static const MVMREPROps VMArray_this_repr;
@@ -68,6 +69,33 @@ static void VMArray_gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVM
     MVMuint64         elems     = body->elems;
     MVMuint64         start     = body->start;
     MVMuint64         i         = 0;
+
+    /* In a nursery collection, an array with a card table only needs the
+     * dirty cards scanning; cards turn clean once they no longer reference
+     * anything in the nursery. */
+    if (body->cards && !worklist->include_gen2) {
+        MVMCollectable **slots = (MVMCollectable **)body->slots.any;
+        MVMuint64        end   = start + elems;
+        MVMuint64        card;
+        for (card = start >> MVM_ARRAY_CARD_SHIFT; card << MVM_ARRAY_CARD_SHIFT < end; card++) {
+            if (body->cards[card]) {
+                MVMuint32 items_before_mark = worklist->items;
+                MVMuint64 to = (card + 1) << MVM_ARRAY_CARD_SHIFT;
+                i = card << MVM_ARRAY_CARD_SHIFT;
+                if (i < start)
+                    i = start;
+                if (to > end)
+                    to = end;
+                MVM_gc_worklist_presize_for(tc, worklist, to - i);
+                for (; i < to; i++)
+                    MVM_gc_worklist_add_no_include_gen2_nocheck(tc, worklist, &slots[i]);
+                if (worklist->items == items_before_mark)
+                    body->cards[card] = 0;
+            }
+        }
+        return;
+    }
+
     switch (repr_data->slot_type) {
         case MVM_ARRAY_OBJ: {
             MVMObject **slots = body->slots.o;
@@ -103,7 +131,14 @@ static void VMArray_gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVM
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMArray *arr = (MVMArray *)obj;
-    MVM_free(arr->body.slots.any);
+    if (arr->body.mapped)
+        MVM_platform_unmap_file(arr->body.slots.any, NULL, arr->body.ssize
+            * ((MVMArrayREPRData *)STABLE(obj)->REPR_data)->elem_size);
+    else if (arr->body.pooled)
+        MVM_io_read_buffer_release((char *)arr->body.slots.any);
+    else if (!arr->body.borrowed)
+        MVM_free(arr->body.slots.any);
+    MVM_free(arr->body.cards);
 }
 
 /* Marks the representation data in an STable.*/
@@ -300,6 +335,43 @@ static MVMuint64 zero_slots(MVMThreadContext *tc, MVMArrayBody *body,
     return elems;
 }
 
+/* A pinned array may have had its storage handed to C code, so it must not
+ * be moved. VMArray is never inlined, so the body is always in an MVMArray. */
+static void check_not_pinned(MVMThreadContext *tc, MVMArrayBody *body) {
+    MVMCollectable *header = (MVMCollectable *)((char *)body - offsetof(MVMArray, body));
+    if (header->flags1 & MVM_CF_PINNED)
+        MVM_exception_throw_adhoc(tc, "MVMArray: Cannot move the storage of a pinned array");
+}
+
+/* Called before a reference is stored into a slot of an object or string
+ * array. If that's a nursery reference going into a large gen2 array, and
+ * card marking is on, dirties the card for the slot, first making the card
+ * table if there isn't one. A new table starts out all dirty if the array
+ * is already an inter-generational root, since then we don't know which
+ * parts of it hold nursery references. */
+static void mark_card(MVMThreadContext *tc, MVMObject *root, MVMArrayBody *body, MVMuint64 slot, MVMCollectable *ref) {
+    if (ref && !(ref->flags2 & MVM_CF_SECOND_GEN) && root->header.flags2 & MVM_CF_SECOND_GEN
+            && tc->instance->gc_card_marking && body->ssize >= MVM_ARRAY_CARD_MIN_SLOTS) {
+        if (!body->cards) {
+            size_t num_cards = (body->ssize >> MVM_ARRAY_CARD_SHIFT) + 1;
+            body->cards = MVM_malloc(num_cards);
+            memset(body->cards, root->header.flags2 & MVM_CF_IN_GEN2_ROOT_LIST ? 1 : 0,
+                num_cards);
+        }
+        body->cards[slot >> MVM_ARRAY_CARD_SHIFT] = 1;
+    }
+}
+
+/* Cards cover fixed ranges of the storage, so the card table is thrown away
+ * if elements are moved around in it or it is reallocated. Until another is
+ * made, the array is scanned in full. */
+static void drop_cards(MVMArrayBody *body) {
+    if (body->cards) {
+        MVM_free(body->cards);
+        body->cards = NULL;
+    }
+}
+
 static void set_size_internal(MVMThreadContext *tc, MVMArrayBody *body, MVMuint64 n, MVMArrayREPRData *repr_data) {
     MVMuint64   elems = body->elems;
     MVMuint64   start = body->start;
@@ -309,9 +381,13 @@ static void set_size_internal(MVMThreadContext *tc, MVMArrayBody *body, MVMuint6
     if (n == elems)
         return;
 
+    if (n + start > ssize)
+        check_not_pinned(tc, body);
+
     if (start > 0 && n + start > ssize) {
         /* if there aren't enough slots at the end, shift off empty slots
          * from the beginning first */
+        drop_cards(body);
         if (elems > 0)
             memmove(slots,
                 (char *)slots + start * repr_data->elem_size,
@@ -360,9 +436,32 @@ static void set_size_internal(MVMThreadContext *tc, MVMArrayBody *body, MVMuint6
     }
 
     /* now allocate the new slot buffer */
-    slots = (slots)
-            ? MVM_realloc(slots, ssize * repr_data->elem_size)
-            : MVM_malloc(ssize * repr_data->elem_size);
+    drop_cards(body);
+    if (body->mapped) {
+        void *copy = MVM_malloc(ssize * repr_data->elem_size);
+        memcpy(copy, slots, body->ssize * repr_data->elem_size);
+        MVM_platform_unmap_file(slots, NULL, body->ssize * repr_data->elem_size);
+        slots = copy;
+        body->mapped = 0;
+    }
+    else if (body->pooled) {
+        void *copy = MVM_malloc(ssize * repr_data->elem_size);
+        memcpy(copy, slots, body->ssize * repr_data->elem_size);
+        MVM_io_read_buffer_release((char *)slots);
+        slots = copy;
+        body->pooled = 0;
+    }
+    else if (body->borrowed) {
+        void *copy = MVM_malloc(ssize * repr_data->elem_size);
+        memcpy(copy, slots, body->ssize * repr_data->elem_size);
+        slots = copy;
+        body->borrowed = 0;
+    }
+    else {
+        slots = (slots)
+                ? MVM_realloc(slots, ssize * repr_data->elem_size)
+                : MVM_malloc(ssize * repr_data->elem_size);
+    }
 
     /* fill out any unused slots with NULL pointers or zero values */
     body->slots.any = slots;
@@ -395,11 +494,13 @@ void MVM_VMArray_bind_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
         case MVM_ARRAY_OBJ:
             if (kind != MVM_reg_obj)
                 MVM_exception_throw_adhoc(tc, "MVMArray: bindpos expected object register");
+            mark_card(tc, root, body, body->start + real_index, (MVMCollectable *)value.o);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.o[body->start + real_index], value.o);
             break;
         case MVM_ARRAY_STR:
             if (kind != MVM_reg_str)
                 MVM_exception_throw_adhoc(tc, "MVMArray: bindpos expected string register");
+            mark_card(tc, root, body, body->start + real_index, (MVMCollectable *)value.s);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.s[body->start + real_index], value.s);
             break;
         case MVM_ARRAY_I64:
@@ -480,11 +581,13 @@ void MVM_VMArray_push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void
         case MVM_ARRAY_OBJ:
             if (kind != MVM_reg_obj)
                 MVM_exception_throw_adhoc(tc, "MVMArray: push expected object register");
+            mark_card(tc, root, body, body->start + body->elems - 1, (MVMCollectable *)value.o);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.o[body->start + body->elems - 1], value.o);
             break;
         case MVM_ARRAY_STR:
             if (kind != MVM_reg_str)
                 MVM_exception_throw_adhoc(tc, "MVMArray: push expected string register");
+            mark_card(tc, root, body, body->start + body->elems - 1, (MVMCollectable *)value.s);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.s[body->start + body->elems - 1], value.s);
             break;
         case MVM_ARRAY_I64:
@@ -637,6 +740,7 @@ static void unshift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
         set_size_internal(tc, body, elems + n, repr_data);
 
         /* move elements and set start */
+        drop_cards(body);
         memmove(
             (char *)body->slots.any + n * repr_data->elem_size,
             body->slots.any,
@@ -654,11 +758,13 @@ static void unshift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
         case MVM_ARRAY_OBJ:
             if (kind != MVM_reg_obj)
                 MVM_exception_throw_adhoc(tc, "MVMArray: unshift expected object register");
+            mark_card(tc, root, body, body->start, (MVMCollectable *)value.o);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.o[body->start], value.o);
             break;
         case MVM_ARRAY_STR:
             if (kind != MVM_reg_str)
                 MVM_exception_throw_adhoc(tc, "MVMArray: unshift expected string register");
+            mark_card(tc, root, body, body->start, (MVMCollectable *)value.s);
             MVM_ASSIGN_REF(tc, &(root->header), body->slots.s[body->start], value.s);
             break;
         case MVM_ARRAY_I64:
@@ -977,6 +1083,7 @@ static void asplice(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
     else if (tail > 0 && count > elems1) {
         /* We're shrinking the array, so first move the tail left */
         start = body->start;
+        drop_cards(body);
         memmove(
             (char *)body->slots.any + (start + offset + elems1) * repr_data->elem_size,
             (char *)body->slots.any + (start + offset + count) * repr_data->elem_size,
@@ -989,6 +1096,7 @@ static void asplice(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *
     start = body->start;
     if (tail > 0 && count < elems1) {
         /* The array grew, so move the tail to the right */
+        drop_cards(body);
         memmove(
             (char *)body->slots.any + (start + offset + elems1) * repr_data->elem_size,
             (char *)body->slots.any + (start + offset + count) * repr_data->elem_size,
@@ -1349,7 +1457,7 @@ static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerial
 static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
     switch (ins->info->opcode) {
     case MVM_OP_create: {
-        if (!(st->mode_flags & MVM_FINALIZE_TYPE)) {
+        if (!(st->mode_flags & MVM_FINALIZE_TYPE) && st->pretenure_state != MVM_PRETENURE_YES) {
             MVMSpeshOperand target   = ins->operands[0];
             MVMSpeshOperand type     = ins->operands[1];
             MVMSpeshFacts *tgt_facts = MVM_spesh_get_facts(tc, g, target);
@@ -1546,3 +1654,499 @@ static const MVMREPROps VMArray_this_repr = {
     unmanaged_size,
     describe_refs,
 };
+
+/* Bulk operations on native arrays. Each runs one tight loop over the
+ * contiguous slots of the array, written so the compiler can vectorize it,
+ * rather than going through at_pos and bind_pos per element. The kernels are
+ * instantiated for each native slot type by the dispatch macros below, which
+ * run a statement with p pointing at the first element and T as its type. */
+#define VMARRAY_BULK_CASE(slot, field, type, stmt) \
+    case slot: { \
+        typedef type T; \
+        T *p = body->slots.field + body->start; \
+        stmt; \
+        break; \
+    }
+#define VMARRAY_BULK_INT(stmt) \
+    switch (slot_type) { \
+        VMARRAY_BULK_CASE(MVM_ARRAY_I64, i64, MVMint64,  stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_I32, i32, MVMint32,  stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_I16, i16, MVMint16,  stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_I8,  i8,  MVMint8,   stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_U64, u64, MVMuint64, stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_U32, u32, MVMuint32, stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_U16, u16, MVMuint16, stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_U8,  u8,  MVMuint8,  stmt) \
+    }
+#define VMARRAY_BULK_NUM(stmt) \
+    switch (slot_type) { \
+        VMARRAY_BULK_CASE(MVM_ARRAY_N64, n64, MVMnum64, stmt) \
+        VMARRAY_BULK_CASE(MVM_ARRAY_N32, n32, MVMnum32, stmt) \
+    }
+
+/* Checks that an object is a concrete native int or num array, and gives
+ * back its body and slot type. */
+static MVMArrayBody * bulk_body(MVMThreadContext *tc, MVMObject *arr, MVMuint16 kind,
+        const char *op, MVMuint8 *slot_type) {
+    MVMuint8 type;
+    if (MVM_UNLIKELY(REPR(arr)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(arr)))
+        MVM_exception_throw_adhoc(tc, "%s requires a concrete VMArray", op);
+    type = ((MVMArrayREPRData *)STABLE(arr)->REPR_data)->slot_type;
+    switch (type) {
+        case MVM_ARRAY_I64: case MVM_ARRAY_I32: case MVM_ARRAY_I16: case MVM_ARRAY_I8:
+        case MVM_ARRAY_U64: case MVM_ARRAY_U32: case MVM_ARRAY_U16: case MVM_ARRAY_U8:
+            if (kind == MVM_reg_int64)
+                break;
+            MVM_FALLTHROUGH
+        case MVM_ARRAY_N64: case MVM_ARRAY_N32:
+            if (kind == MVM_reg_num64 && (type == MVM_ARRAY_N64 || type == MVM_ARRAY_N32))
+                break;
+            MVM_FALLTHROUGH
+        default:
+            MVM_exception_throw_adhoc(tc, "%s requires a native %s array", op,
+                kind == MVM_reg_int64 ? "int" : "num");
+    }
+    *slot_type = type;
+    return &((MVMArray *)arr)->body;
+}
+
+MVMint64 MVM_VMArray_sum_i(MVMThreadContext *tc, MVMObject *arr) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_int64, "arrsum_i", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    /* Unsigned, so that overflow wraps rather than being undefined. */
+    MVMuint64     sum  = 0;
+    VMARRAY_BULK_INT(
+        for (i = 0; i < n; i++)
+            sum += (MVMuint64)p[i]
+    )
+    return (MVMint64)sum;
+}
+
+MVMnum64 MVM_VMArray_sum_n(MVMThreadContext *tc, MVMObject *arr) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_num64, "arrsum_n", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    /* Four accumulators, since the compiler may not reorder a single float
+     * sum into vector lanes itself. */
+    MVMnum64      s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    VMARRAY_BULK_NUM(
+        for (i = 0; i + 4 <= n; i += 4) {
+            s0 += p[i];
+            s1 += p[i + 1];
+            s2 += p[i + 2];
+            s3 += p[i + 3];
+        }
+        for (; i < n; i++)
+            s0 += p[i]
+    )
+    return (s0 + s1) + (s2 + s3);
+}
+
+MVMint64 MVM_VMArray_minmax_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 want_max) {
+    const char   *op   = want_max ? "arrmax_i" : "arrmin_i";
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_int64, op, &slot_type);
+    MVMuint64     n    = body->elems, i;
+    MVMint64      result = 0;
+    if (n == 0)
+        MVM_exception_throw_adhoc(tc, "%s requires a non-empty array", op);
+    VMARRAY_BULK_INT(
+        T m = p[0];
+        if (want_max) {
+            for (i = 1; i < n; i++)
+                m = p[i] > m ? p[i] : m;
+        }
+        else {
+            for (i = 1; i < n; i++)
+                m = p[i] < m ? p[i] : m;
+        }
+        result = (MVMint64)m
+    )
+    return result;
+}
+
+MVMnum64 MVM_VMArray_minmax_n(MVMThreadContext *tc, MVMObject *arr, MVMint64 want_max) {
+    const char   *op   = want_max ? "arrmax_n" : "arrmin_n";
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_num64, op, &slot_type);
+    MVMuint64     n    = body->elems, i;
+    MVMnum64      result = 0.0;
+    if (n == 0)
+        MVM_exception_throw_adhoc(tc, "%s requires a non-empty array", op);
+    VMARRAY_BULK_NUM(
+        T m = p[0];
+        if (want_max) {
+            for (i = 1; i < n; i++)
+                m = p[i] > m ? p[i] : m;
+        }
+        else {
+            for (i = 1; i < n; i++)
+                m = p[i] < m ? p[i] : m;
+        }
+        result = (MVMnum64)m
+    )
+    return result;
+}
+
+/* Adds a scalar to, or multiplies by a scalar, every element in place. */
+void MVM_VMArray_scalar_op_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value, MVMint64 multiply) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_int64, multiply ? "arrmul_i" : "arradd_i", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    MVMuint64     v    = (MVMuint64)value;
+    enter_single_user(tc, body);
+    if (multiply) {
+        VMARRAY_BULK_INT(
+            for (i = 0; i < n; i++)
+                p[i] = (T)((MVMuint64)p[i] * v)
+        )
+    }
+    else {
+        VMARRAY_BULK_INT(
+            for (i = 0; i < n; i++)
+                p[i] = (T)((MVMuint64)p[i] + v)
+        )
+    }
+    exit_single_user(tc, body);
+}
+
+void MVM_VMArray_scalar_op_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value, MVMint64 multiply) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_num64, multiply ? "arrmul_n" : "arradd_n", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    enter_single_user(tc, body);
+    if (multiply) {
+        VMARRAY_BULK_NUM(
+            for (i = 0; i < n; i++)
+                p[i] = (T)(p[i] * value)
+        )
+    }
+    else {
+        VMARRAY_BULK_NUM(
+            for (i = 0; i < n; i++)
+                p[i] = (T)(p[i] + value)
+        )
+    }
+    exit_single_user(tc, body);
+}
+
+/* Adds or multiplies the elements of one array into another, element by
+ * element. The arrays must be of the same type and length. */
+void MVM_VMArray_elementwise_op(MVMThreadContext *tc, MVMObject *target, MVMObject *source, MVMint64 multiply) {
+    const char   *op = multiply ? "arrmularr" : "arraddarr";
+    MVMArrayBody *body, *other;
+    MVMuint8      slot_type;
+    MVMuint64     n, i;
+    MVMuint16     kind;
+
+    if (MVM_UNLIKELY(REPR(target)->ID != MVM_REPR_ID_VMArray || REPR(source)->ID != MVM_REPR_ID_VMArray
+            || STABLE(target) != STABLE(source)))
+        MVM_exception_throw_adhoc(tc, "%s requires two VMArrays of the same type", op);
+    switch (((MVMArrayREPRData *)STABLE(target)->REPR_data)->slot_type) {
+        case MVM_ARRAY_N64: case MVM_ARRAY_N32:
+            kind = MVM_reg_num64;
+            break;
+        default:
+            kind = MVM_reg_int64;
+            break;
+    }
+    body  = bulk_body(tc, target, kind, op, &slot_type);
+    other = bulk_body(tc, source, kind, op, &slot_type);
+    n = body->elems;
+    if (other->elems != n)
+        MVM_exception_throw_adhoc(tc, "%s requires arrays of the same length (got %"PRIu64" and %"PRIu64")",
+            op, n, other->elems);
+
+    enter_single_user(tc, body);
+    if (kind == MVM_reg_int64) {
+        if (multiply) {
+            VMARRAY_BULK_INT(
+                T *q = (T *)other->slots.any + other->start;
+                for (i = 0; i < n; i++)
+                    p[i] = (T)((MVMuint64)p[i] * (MVMuint64)q[i])
+            )
+        }
+        else {
+            VMARRAY_BULK_INT(
+                T *q = (T *)other->slots.any + other->start;
+                for (i = 0; i < n; i++)
+                    p[i] = (T)((MVMuint64)p[i] + (MVMuint64)q[i])
+            )
+        }
+    }
+    else {
+        if (multiply) {
+            VMARRAY_BULK_NUM(
+                T *q = (T *)other->slots.any + other->start;
+                for (i = 0; i < n; i++)
+                    p[i] = p[i] * q[i]
+            )
+        }
+        else {
+            VMARRAY_BULK_NUM(
+                T *q = (T *)other->slots.any + other->start;
+                for (i = 0; i < n; i++)
+                    p[i] = p[i] + q[i]
+            )
+        }
+    }
+    exit_single_user(tc, body);
+}
+
+/* Sets every element to a value. */
+void MVM_VMArray_fill_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_int64, "arrfill_i", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    enter_single_user(tc, body);
+    VMARRAY_BULK_INT(
+        T v = (T)value;
+        for (i = 0; i < n; i++)
+            p[i] = v
+    )
+    exit_single_user(tc, body);
+}
+
+void MVM_VMArray_fill_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_num64, "arrfill_n", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    enter_single_user(tc, body);
+    VMARRAY_BULK_NUM(
+        T v = (T)value;
+        for (i = 0; i < n; i++)
+            p[i] = v
+    )
+    exit_single_user(tc, body);
+}
+
+/* Finds the index of the first element equal to a value, as atpos would
+ * read it, or -1 if there is none. */
+MVMint64 MVM_VMArray_find_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_int64, "arrfind_i", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    MVMint64      result = -1;
+    VMARRAY_BULK_INT(
+        for (i = 0; i < n; i++) {
+            if ((MVMint64)p[i] == value) {
+                result = (MVMint64)i;
+                break;
+            }
+        }
+    )
+    return result;
+}
+
+MVMint64 MVM_VMArray_find_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value) {
+    MVMuint8      slot_type;
+    MVMArrayBody *body = bulk_body(tc, arr, MVM_reg_num64, "arrfind_n", &slot_type);
+    MVMuint64     n    = body->elems, i;
+    MVMint64      result = -1;
+    VMARRAY_BULK_NUM(
+        for (i = 0; i < n; i++) {
+            if ((MVMnum64)p[i] == value) {
+                result = (MVMint64)i;
+                break;
+            }
+        }
+    )
+    return result;
+}
+
+/* Atomic operations on single slots of native integer arrays with 32 or 64
+ * bit elements, taking one of the MVM_ATOMIC_ORDER_* memory orders. With a
+ * GNU C compatible compiler they map onto the __atomic builtins, which want
+ * the order as a constant, hence the switches. Elsewhere they are built on
+ * the libatomic_ops compare and swap, which always has a full barrier. As
+ * with pos_as_atomic, the array must not be resized while other threads are
+ * operating on it. */
+#if defined(__GNUC__) || defined(__clang__)
+#define VMARRAY_GNU_ATOMICS 1
+#define VMARRAY_LOAD_ORDERS(order, M) \
+    switch (order) { \
+        case MVM_ATOMIC_ORDER_RELAXED: M(__ATOMIC_RELAXED); break; \
+        case MVM_ATOMIC_ORDER_ACQUIRE: M(__ATOMIC_ACQUIRE); break; \
+        default:                       M(__ATOMIC_SEQ_CST); break; \
+    }
+#define VMARRAY_STORE_ORDERS(order, M) \
+    switch (order) { \
+        case MVM_ATOMIC_ORDER_RELAXED: M(__ATOMIC_RELAXED); break; \
+        case MVM_ATOMIC_ORDER_RELEASE: M(__ATOMIC_RELEASE); break; \
+        default:                       M(__ATOMIC_SEQ_CST); break; \
+    }
+/* Read-modify-write operations, with the order to use if a compare and swap
+ * fails as the second argument. */
+#define VMARRAY_RMW_ORDERS(order, M) \
+    switch (order) { \
+        case MVM_ATOMIC_ORDER_RELAXED: M(__ATOMIC_RELAXED, __ATOMIC_RELAXED); break; \
+        case MVM_ATOMIC_ORDER_ACQUIRE: M(__ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); break; \
+        case MVM_ATOMIC_ORDER_RELEASE: M(__ATOMIC_RELEASE, __ATOMIC_RELAXED); break; \
+        case MVM_ATOMIC_ORDER_ACQ_REL: M(__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); break; \
+        default:                       M(__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); break; \
+    }
+#else
+#define VMARRAY_GNU_ATOMICS 0
+#endif
+
+/* Runs the code in the third argument with T being the slot type and p
+ * pointing at the slot, leaving the value in v of type T, which is widened
+ * as atpos would read it into the result. */
+#define VMARRAY_ATOMIC_CASE(slot_type, slot, result, BODY) \
+    if (slot_type == MVM_ARRAY_I64 || slot_type == MVM_ARRAY_U64) { \
+        typedef MVMint64 T; \
+        T *p = (T *)(slot); \
+        T  v; \
+        BODY; \
+        result = (MVMint64)v; \
+    } \
+    else { \
+        typedef MVMint32 T; \
+        T *p = (T *)(slot); \
+        T  v; \
+        BODY; \
+        result = slot_type == MVM_ARRAY_U32 ? (MVMint64)(MVMuint32)v : (MVMint64)v; \
+    }
+
+static void * atomic_slot(MVMThreadContext *tc, MVMObject *arr, MVMint64 index,
+        MVMint64 order, const char *op, MVMuint8 *slot_type) {
+    MVMArrayBody *body;
+    if (MVM_UNLIKELY(REPR(arr)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(arr)))
+        MVM_exception_throw_adhoc(tc, "%s requires a concrete VMArray", op);
+    if (order < MVM_ATOMIC_ORDER_RELAXED || order > MVM_ATOMIC_ORDER_SEQ_CST)
+        MVM_exception_throw_adhoc(tc, "%s got unknown memory order %"PRId64, op, order);
+    body = &((MVMArray *)arr)->body;
+    if (index < 0)
+        index += body->elems;
+    if (index < 0 || (MVMuint64)index >= body->elems)
+        MVM_exception_throw_adhoc(tc, "Index out of bounds in %s", op);
+    *slot_type = ((MVMArrayREPRData *)STABLE(arr)->REPR_data)->slot_type;
+    switch (*slot_type) {
+        case MVM_ARRAY_I64: case MVM_ARRAY_U64:
+            return &(body->slots.i64[body->start + index]);
+        case MVM_ARRAY_I32: case MVM_ARRAY_U32:
+            return &(body->slots.i32[body->start + index]);
+        default:
+            MVM_exception_throw_adhoc(tc,
+                "%s requires a native integer array with 32 or 64 bit elements", op);
+    }
+}
+
+#if !VMARRAY_GNU_ATOMICS
+/* Compare and swap on a slot of either size, returning the value seen. */
+static MVMint64 fallback_cas(MVMThreadContext *tc, void *p, size_t size,
+        MVMint64 expected, MVMint64 value, const char *op) {
+    if (size == sizeof(AO_t))
+        return (MVMint64)AO_fetch_compare_and_swap_full((volatile AO_t *)p,
+            (AO_t)expected, (AO_t)value);
+#ifdef AO_HAVE_int_fetch_compare_and_swap_full
+    if (size == sizeof(unsigned int))
+        return (MVMint64)(MVMint32)AO_int_fetch_compare_and_swap_full(
+            (volatile unsigned int *)p, (unsigned int)expected, (unsigned int)value);
+#endif
+    MVM_exception_throw_adhoc(tc,
+        "%s is not supported on arrays with %d bit elements on this platform",
+        op, (int)(size * 8));
+}
+#endif
+
+MVMint64 MVM_VMArray_atomic_load_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 order) {
+    MVMuint8  slot_type;
+    void     *slot   = atomic_slot(tc, arr, index, order, "arratomicload_i", &slot_type);
+    MVMint64  result;
+    if (order == MVM_ATOMIC_ORDER_RELEASE || order == MVM_ATOMIC_ORDER_ACQ_REL)
+        MVM_exception_throw_adhoc(tc, "arratomicload_i cannot have release ordering");
+#if VMARRAY_GNU_ATOMICS
+#define LOAD(mo) v = __atomic_load_n(p, mo)
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result, VMARRAY_LOAD_ORDERS(order, LOAD))
+#undef LOAD
+#else
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        v = (T)fallback_cas(tc, p, sizeof(T), 0, 0, "arratomicload_i"))
+#endif
+    return result;
+}
+
+void MVM_VMArray_atomic_store_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index,
+        MVMint64 value, MVMint64 order) {
+    MVMuint8  slot_type;
+    void     *slot   = atomic_slot(tc, arr, index, order, "arratomicstore_i", &slot_type);
+    MVMint64  result;
+    if (order == MVM_ATOMIC_ORDER_ACQUIRE || order == MVM_ATOMIC_ORDER_ACQ_REL)
+        MVM_exception_throw_adhoc(tc, "arratomicstore_i cannot have acquire ordering");
+#if VMARRAY_GNU_ATOMICS
+#define STORE(mo) __atomic_store_n(p, v, mo)
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        v = (T)value; VMARRAY_STORE_ORDERS(order, STORE))
+#undef STORE
+#else
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        T seen = *(volatile T *)p;
+        T cur;
+        v = (T)value;
+        while ((cur = (T)fallback_cas(tc, p, sizeof(T), seen, v, "arratomicstore_i")) != seen)
+            seen = cur)
+#endif
+    (void)result;
+}
+
+/* Adds to a slot, returning the value it had before. */
+MVMint64 MVM_VMArray_atomic_add_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index,
+        MVMint64 value, MVMint64 order) {
+    MVMuint8  slot_type;
+    void     *slot   = atomic_slot(tc, arr, index, order, "arratomicadd_i", &slot_type);
+    MVMint64  result;
+#if VMARRAY_GNU_ATOMICS
+#define ADD(mo, fail_mo) v = __atomic_fetch_add(p, (T)value, mo)
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result, VMARRAY_RMW_ORDERS(order, ADD))
+#undef ADD
+#else
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        T cur;
+        v = *(volatile T *)p;
+        while ((cur = (T)fallback_cas(tc, p, sizeof(T), v,
+                (T)((MVMuint64)v + (MVMuint64)value), "arratomicadd_i")) != v)
+            v = cur)
+#endif
+    return result;
+}
+
+/* Sets a slot, returning the value it had before. */
+MVMint64 MVM_VMArray_atomic_xchg_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index,
+        MVMint64 value, MVMint64 order) {
+    MVMuint8  slot_type;
+    void     *slot   = atomic_slot(tc, arr, index, order, "arratomicxchg_i", &slot_type);
+    MVMint64  result;
+#if VMARRAY_GNU_ATOMICS
+#define XCHG(mo, fail_mo) v = __atomic_exchange_n(p, (T)value, mo)
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result, VMARRAY_RMW_ORDERS(order, XCHG))
+#undef XCHG
+#else
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        T cur;
+        v = *(volatile T *)p;
+        while ((cur = (T)fallback_cas(tc, p, sizeof(T), v, (T)value, "arratomicxchg_i")) != v)
+            v = cur)
+#endif
+    return result;
+}
+
+/* Sets a slot if it holds the expected value, returning the value it was
+ * seen to hold either way. */
+MVMint64 MVM_VMArray_atomic_cas_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index,
+        MVMint64 expected, MVMint64 value, MVMint64 order) {
+    MVMuint8  slot_type;
+    void     *slot   = atomic_slot(tc, arr, index, order, "arratomiccas_i", &slot_type);
+    MVMint64  result;
+#if VMARRAY_GNU_ATOMICS
+#define CAS(mo, fail_mo) __atomic_compare_exchange_n(p, &v, (T)value, 0, mo, fail_mo)
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        v = (T)expected; VMARRAY_RMW_ORDERS(order, CAS))
+#undef CAS
+#else
+    VMARRAY_ATOMIC_CASE(slot_type, slot, result,
+        v = (T)fallback_cas(tc, p, sizeof(T), (T)expected, (T)value, "arratomiccas_i"))
+#endif
+    return result;
+}
@@ -32,6 +32,27 @@ struct MVMArrayBody {
         void       *any;
     } slots;
 
+    /* Card table for large gen2 object and string arrays when card marking
+     * is enabled, one byte per MVM_ARRAY_CARD_SLOTS slots of storage, set if
+     * that part of the storage may reference a nursery object. NULL if the
+     * array doesn't have one, in which case it is scanned in full. */
+    MVMuint8   *cards;
+
+    /* Set if the slots are a private mapping of part of a file (see
+     * MVM_io_read_bytes), which is unmapped rather than freed, and copied
+     * out of if the array has to grow beyond it. */
+    MVMuint8    mapped;
+
+    /* Set if the slots are a pooled read buffer from an asynchronous socket
+     * read (see MVM_io_read_buffer_acquire), which goes back to its pool
+     * rather than being freed, and is copied out of if the array grows. */
+    MVMuint8    pooled;
+
+    /* Set if the slots are C memory shared with a CArray that doesn't own
+     * it (see MVM_nativecall_vmarray_view), which is never freed, and is
+     * copied out of if the array grows. */
+    MVMuint8    borrowed;
+
 #if MVM_ARRAY_CONC_DEBUG
     AO_t in_use;
 #endif 
@@ -41,6 +62,12 @@ struct MVMArray {
     MVMArrayBody body;
 };
 
+/* Card marking granularity, and the size of storage an array needs before it
+ * will be given a card table. */
+#define MVM_ARRAY_CARD_SHIFT        9
+#define MVM_ARRAY_CARD_SLOTS        (1 << MVM_ARRAY_CARD_SHIFT)
+#define MVM_ARRAY_CARD_MIN_SLOTS    16384
+
 /* Types of things we may be storing. */
 #define MVM_ARRAY_OBJ   0
 #define MVM_ARRAY_STR   1
@@ -80,3 +107,29 @@ void *MVM_VMArray_find_fast_impl_for_jit(MVMThreadContext *tc, MVMSTable *st, MV
 void MVM_VMArray_bind_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister value, MVMuint16 kind);
 
 void MVM_VMArray_push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind);
+
+/* Bulk operations on native arrays. */
+MVMint64 MVM_VMArray_sum_i(MVMThreadContext *tc, MVMObject *arr);
+MVMnum64 MVM_VMArray_sum_n(MVMThreadContext *tc, MVMObject *arr);
+MVMint64 MVM_VMArray_minmax_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 want_max);
+MVMnum64 MVM_VMArray_minmax_n(MVMThreadContext *tc, MVMObject *arr, MVMint64 want_max);
+void MVM_VMArray_scalar_op_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value, MVMint64 multiply);
+void MVM_VMArray_scalar_op_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value, MVMint64 multiply);
+void MVM_VMArray_elementwise_op(MVMThreadContext *tc, MVMObject *target, MVMObject *source, MVMint64 multiply);
+void MVM_VMArray_fill_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value);
+void MVM_VMArray_fill_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value);
+MVMint64 MVM_VMArray_find_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 value);
+MVMint64 MVM_VMArray_find_n(MVMThreadContext *tc, MVMObject *arr, MVMnum64 value);
+
+/* Atomic operations on slots of native integer arrays with 32 or 64 bit
+ * elements, and the memory orders they take. */
+#define MVM_ATOMIC_ORDER_RELAXED    0
+#define MVM_ATOMIC_ORDER_ACQUIRE    1
+#define MVM_ATOMIC_ORDER_RELEASE    2
+#define MVM_ATOMIC_ORDER_ACQ_REL    3
+#define MVM_ATOMIC_ORDER_SEQ_CST    4
+MVMint64 MVM_VMArray_atomic_load_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 order);
+void MVM_VMArray_atomic_store_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 value, MVMint64 order);
+MVMint64 MVM_VMArray_atomic_add_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 value, MVMint64 order);
+MVMint64 MVM_VMArray_atomic_xchg_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 value, MVMint64 order);
+MVMint64 MVM_VMArray_atomic_cas_i(MVMThreadContext *tc, MVMObject *arr, MVMint64 index, MVMint64 expected, MVMint64 value, MVMint64 order);
@@ -16,8 +16,10 @@ MVMObject * MVM_sc_create(MVMThreadContext *tc, MVMString *handle) {
     MVMROOT(tc, handle, {
         sc = (MVMSerializationContext *)REPR(tc->instance->SCRef)->allocate(tc, STABLE(tc->instance->SCRef));
         MVMROOT(tc, sc, {
-            /* Add to weak lookup hash. */
+            /* Add to weak lookup hash. Either way the handle or the SC end
+             * up where any thread can find them. */
             uv_mutex_lock(&tc->instance->mutex_sc_registry);
+            MVM_gc_note_escape(tc);
             struct MVMSerializationContextWeakHashEntry *entry
                 = MVM_str_hash_lvalue_fetch_nocheck(tc, &tc->instance->sc_weakhash, handle);
             if (!entry->hash_handle.key) {
@@ -106,18 +108,97 @@ void MVM_sc_set_description(MVMThreadContext *tc, MVMSerializationContext *sc, M
     MVM_ASSIGN_REF(tc, &(sc->common.header), sc->body->description, desc);
 }
 
+/* The root sets that can be looked up in the root index of an SC. */
+#define ROOT_OBJECTS 0
+#define ROOT_STABLES 1
+#define ROOT_CODES   2
+
+static MVMuint64 root_count(MVMThreadContext *tc, MVMSerializationContextBody *body, MVMuint32 kind) {
+    switch (kind) {
+        case ROOT_OBJECTS: return body->num_objects;
+        case ROOT_STABLES: return body->num_stables;
+        default:           return MVM_repr_elems(tc, body->root_codes);
+    }
+}
+
+static const void * root_at(MVMThreadContext *tc, MVMSerializationContextBody *body, MVMuint32 kind, MVMuint64 i) {
+    switch (kind) {
+        case ROOT_OBJECTS: return body->root_objects[i];
+        case ROOT_STABLES: return body->root_stables[i];
+        default:           return MVM_repr_at_pos_o(tc, body->root_codes, i);
+    }
+}
+
+/* Looks up the index of something in one of the root sets of an SC when the
+ * index cached in its header can't be used, such as when it's owned by some
+ * other SC. Rather than scanning the root set each time, which makes
+ * serializing a large SC quadratic, a map of the root set entries to their
+ * indexes is built on first use. It is thrown away when a GC moved things
+ * since it was built, and the entries added to the root set since are put in
+ * on demand. As entries may also be replaced behind its back, whatever it
+ * finds is checked, with a scan as the last resort. Returns -1 if it isn't
+ * in the root set. */
+static MVMint64 find_in_root_index(MVMThreadContext *tc, MVMSerializationContextBody *body,
+        MVMuint32 kind, const void *key) {
+    MVMPtrHashTable *index = &body->root_index[kind];
+    MVMuint64 gc_seq = MVM_load(&tc->instance->gc_seq_number);
+    MVMuint64 count, i;
+    struct MVMPtrHashEntry *entry;
+    MVMint64 result = -1;
+
+    uv_mutex_lock(&body->mutex_root_index);
+    if (body->root_index_gc_seq != gc_seq) {
+        MVMuint32 k;
+        for (k = 0; k < 3; k++) {
+            MVM_ptr_hash_demolish(tc, &body->root_index[k]);
+            MVM_ptr_hash_build(tc, &body->root_index[k]);
+            body->root_indexed[k] = 0;
+        }
+        body->root_index_gc_seq = gc_seq;
+    }
+
+    count = root_count(tc, body, kind);
+    for (i = body->root_indexed[kind]; i < count; i++) {
+        const void *root = root_at(tc, body, kind, i);
+        if (root) {
+            entry = MVM_ptr_hash_lvalue_fetch(tc, index, root);
+            if (!entry->key) {
+                entry->key   = root;
+                entry->value = i;
+            }
+        }
+    }
+    body->root_indexed[kind] = count;
+
+    entry = MVM_ptr_hash_fetch(tc, index, key);
+    if (entry && entry->value < count && root_at(tc, body, kind, entry->value) == key) {
+        result = entry->value;
+    }
+    else {
+        for (i = 0; i < count; i++) {
+            if (root_at(tc, body, kind, i) == key) {
+                entry = MVM_ptr_hash_lvalue_fetch(tc, index, key);
+                entry->key   = key;
+                entry->value = i;
+                result = i;
+                break;
+            }
+        }
+    }
+    uv_mutex_unlock(&body->mutex_root_index);
+
+    return result;
+}
+
 /* Given an SC, looks up the index of an object that is in its root set. */
 MVMint64 MVM_sc_find_object_idx(MVMThreadContext *tc, MVMSerializationContext *sc, MVMObject *obj) {
-    MVMObject **roots;
-    MVMint64    i, count;
-    MVMuint32   cached = MVM_sc_get_idx_in_sc(&obj->header);
+    MVMint64  idx;
+    MVMuint32 cached = MVM_sc_get_idx_in_sc(&obj->header);
     if (cached != ~(unsigned)0 && MVM_sc_get_collectable_sc(tc, &obj->header) == sc)
         return cached;
-    roots = sc->body->root_objects;
-    count = sc->body->num_objects;
-    for (i = 0; i < count; i++)
-        if (roots[i] == obj)
-            return i;
+    idx = find_in_root_index(tc, sc->body, ROOT_OBJECTS, obj);
+    if (idx >= 0)
+        return idx;
     MVM_exception_throw_adhoc(tc,
         "Object does not exist in serialization context");
 }
@@ -132,31 +213,26 @@ MVMint64 MVM_sc_find_object_idx_jit(MVMThreadContext *tc, MVMObject *sc, MVMObje
 
 /* Given an SC, looks up the index of an STable that is in its root set. */
 MVMint64 MVM_sc_find_stable_idx(MVMThreadContext *tc, MVMSerializationContext *sc, MVMSTable *st) {
-    MVMuint64 i;
+    MVMint64  idx;
     MVMuint32 cached = MVM_sc_get_idx_in_sc(&st->header);
     if (cached != ~(unsigned)0 && MVM_sc_get_collectable_sc(tc, &st->header) == sc)
         return cached;
-    for (i = 0; i < sc->body->num_stables; i++)
-        if (sc->body->root_stables[i] == st)
-            return i;
+    idx = find_in_root_index(tc, sc->body, ROOT_STABLES, st);
+    if (idx >= 0)
+        return idx;
     MVM_exception_throw_adhoc(tc,
         "STable %s does not exist in serialization context", MVM_6model_get_stable_debug_name(tc, st));
 }
 
 /* Given an SC, looks up the index of a code ref that is in its root set. */
 MVMint64 MVM_sc_find_code_idx(MVMThreadContext *tc, MVMSerializationContext *sc, MVMObject *obj) {
-    MVMObject *roots;
-    MVMint64   i, count;
+    MVMint64  idx;
     MVMuint32 cached = MVM_sc_get_idx_in_sc(&obj->header);
     if (cached != ~(unsigned)0 && MVM_sc_get_collectable_sc(tc, &obj->header) == sc)
         return cached;
-    roots = sc->body->root_codes;
-    count = MVM_repr_elems(tc, roots);
-    for (i = 0; i < count; i++) {
-        MVMObject *test = MVM_repr_at_pos_o(tc, roots, i);
-        if (test == obj)
-            return i;
-    }
+    idx = find_in_root_index(tc, sc->body, ROOT_CODES, obj);
+    if (idx >= 0)
+        return idx;
 
     if (REPR(obj)->ID == MVM_REPR_ID_MVMCode) {
         char *c_name = MVM_string_utf8_encode_C_string(tc, ((MVMCode *)obj)->body.name);
@@ -410,10 +486,33 @@ void MVM_sc_disclaim(MVMThreadContext *tc, MVMSerializationContext *sc) {
 void MVM_SC_WB_OBJ(MVMThreadContext *tc, MVMObject *obj) {
     assert(!(obj->header.flags2 & MVM_CF_FORWARDER_VALID));
     assert(MVM_sc_get_idx_of_sc(&obj->header) != (MVMuint32)~0);
-    if (MVM_sc_get_idx_of_sc(&obj->header) > 0 && !(obj->st->mode_flags & MVM_NEVER_REPOSSESS_TYPE))
+    if (MVM_sc_get_idx_of_sc(&obj->header) > 0 && !(STABLE(obj)->mode_flags & MVM_NEVER_REPOSSESS_TYPE))
         MVM_sc_wb_hit_obj(tc, obj);
 }
 
+/* When a container owned by an object is changed, we can often get away with
+ * serializing just the owner's attribute holding it, rather than the whole
+ * of the owner. This records that, returning zero if the owner has to be
+ * serialized in full instead. */
+static MVMint32 record_delta_attr(MVMThreadContext *tc, MVMSerializationContext *comp_sc,
+                                  MVMObject *owner, MVMObject *container) {
+    struct MVMPtrHashEntry *entry;
+    MVMint64 idx;
+    if (REPR(owner)->ID != MVM_REPR_ID_P6opaque || !IS_CONCRETE(owner)
+            || !(owner->header.flags2 & MVM_CF_SECOND_GEN))
+        return 0;
+    idx = MVM_p6opaque_attr_idx_holding(tc, owner, container);
+    if (idx < 0 || idx >= (MVMint64)(sizeof(uintptr_t) * 8))
+        return 0;
+    entry = MVM_ptr_hash_lvalue_fetch(tc, &comp_sc->body->rep_delta_attrs, owner);
+    if (!entry->key) {
+        entry->key   = owner;
+        entry->value = 0;
+    }
+    entry->value |= (uintptr_t)1 << idx;
+    return 1;
+}
+
 /* Called when an object triggers the SC repossession write barrier. */
 void MVM_sc_wb_hit_obj(MVMThreadContext *tc, MVMObject *obj) {
     MVMSerializationContext *comp_sc;
@@ -434,11 +533,12 @@ void MVM_sc_wb_hit_obj(MVMThreadContext *tc, MVMObject *obj) {
     if (MVM_sc_get_obj_sc(tc, obj) != comp_sc) {
         /* Get new slot ID. */
         MVMint64 new_slot = comp_sc->body->num_objects;
+        MVMObject *container = NULL;
 
         /* See if the object is actually owned by another, and it's the
          * owner we need to repossess. */
-        if (obj->st->WHAT == tc->instance->boot_types.BOOTArray ||
-            obj->st->WHAT == tc->instance->boot_types.BOOTHash) {
+        if (STABLE(obj)->WHAT == tc->instance->boot_types.BOOTArray ||
+            STABLE(obj)->WHAT == tc->instance->boot_types.BOOTHash) {
             MVMObject *owned_objects = MVM_sc_get_obj_sc(tc, obj)->body->owned_objects;
             MVMint64 n = MVM_repr_elems(tc, owned_objects);
             MVMint64 found = 0;
@@ -450,8 +550,16 @@ void MVM_sc_wb_hit_obj(MVMThreadContext *tc, MVMObject *obj) {
                     real_sc = MVM_sc_get_obj_sc(tc, obj);
                     if (!real_sc)
                         return; /* Probably disclaimed. */
-                    if (real_sc == comp_sc)
+                    if (real_sc == comp_sc) {
+                        /* Already repossessed; if only as a delta so far,
+                         * add this attribute to it or go for all of it. */
+                        if (comp_sc->body->rep_delta_attrs.entries
+                                && MVM_ptr_hash_fetch(tc, &comp_sc->body->rep_delta_attrs, obj)
+                                && !record_delta_attr(tc, comp_sc, obj, MVM_repr_at_pos_o(tc, owned_objects, i)))
+                            MVM_ptr_hash_fetch_and_delete(tc, &comp_sc->body->rep_delta_attrs, obj);
                         return;
+                    }
+                    container = MVM_repr_at_pos_o(tc, owned_objects, i);
                     found = 1;
                     break;
                 }
@@ -460,6 +568,11 @@ void MVM_sc_wb_hit_obj(MVMThreadContext *tc, MVMObject *obj) {
                 return;
         }
 
+        /* If it is only a container owned by the object that changed, try
+         * to just serialize that part of it. */
+        if (container)
+            record_delta_attr(tc, comp_sc, obj, container);
+
         /* Add to root set. */
         MVM_sc_set_object(tc, comp_sc, new_slot, obj);
 
@@ -476,6 +589,10 @@ void MVM_sc_wb_hit_obj(MVMThreadContext *tc, MVMObject *obj) {
         MVM_dump_backtrace(tc);
 #endif
     }
+    else if (comp_sc->body->rep_delta_attrs.entries) {
+        /* The object itself changed, so a delta will no longer do. */
+        MVM_ptr_hash_fetch_and_delete(tc, &comp_sc->body->rep_delta_attrs, obj);
+    }
 }
 
 /* Called when an STable triggers the SC repossession write barrier. */
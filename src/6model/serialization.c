@@ -10,7 +10,7 @@
 
 /* Version of the serialization format that we are currently at and lowest
  * version we support. */
-#define CURRENT_VERSION 23
+#define CURRENT_VERSION 26
 #define MIN_VERSION     16
 
 /* Various sizes (in bytes). */
@@ -808,20 +808,64 @@ void MVM_serialization_write_stable_ref(MVMThreadContext *tc, MVMSerializationWr
     write_locate_sc_and_index(tc, writer, sc_id, idx);
 }
 
+static MVMint32 read_int32(const char *buffer, size_t offset);
+
+/* Writes an unsigned LEB128 number, returning the number of bytes used. */
+static size_t write_uleb128(char *buffer, MVMuint32 value) {
+    size_t written = 0;
+    while (value >= 0x80) {
+        buffer[written++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[written++] = (char)value;
+    return written;
+}
+
+/* Packs the objects table, since it's mostly redundant: consecutive rows
+ * tend to have STables from the same SC, and the data offsets only grow.
+ * Each row becomes two LEB128 numbers: the packed STable reference (with
+ * the concreteness flag rotated down to the bottom bit) XOR that of the
+ * previous row, and the difference from the previous row's data offset.
+ * Returns the packed table, with its size in *size. */
+static char * pack_objects_table(MVMThreadContext *tc, MVMSerializationWriter *writer, MVMuint32 *size) {
+    char      *packed    = MVM_malloc(MAX(writer->root.num_objects, 1) * 10);
+    MVMuint32  prev_ref  = 0;
+    MVMuint32  prev_offs = 0;
+    size_t     pos       = 0;
+    MVMint32   i;
+    for (i = 0; i < writer->root.num_objects; i++) {
+        const char *row  = writer->root.objects_table + i * OBJECTS_TABLE_ENTRY_SIZE;
+        MVMuint32   ref  = (MVMuint32)read_int32(row, 0);
+        MVMuint32   offs = (MVMuint32)read_int32(row, 4);
+        ref = (ref << 1) | (ref >> 31);
+        pos += write_uleb128(packed + pos, ref ^ prev_ref);
+        pos += write_uleb128(packed + pos, offs - prev_offs);
+        prev_ref  = ref;
+        prev_offs = offs;
+    }
+    *size = (MVMuint32)pos;
+    return packed;
+}
+
 /* Concatenates the various output segments into a single binary MVMString. */
 static MVMObject * concatenate_outputs(MVMThreadContext *tc, MVMSerializationWriter *writer, MVMObject *type) {
     char      *output      = NULL;
     char      *output_b64  = NULL;
+    char      *objects_table;
+    MVMuint32  objects_table_size;
     MVMuint32  output_size = 0;
     MVMuint32  offset      = 0;
     MVMObject *result;
 
+    /* Pack the objects table. */
+    objects_table = pack_objects_table(tc, writer, &objects_table_size);
+
     /* Calculate total size. */
     output_size += MVM_ALIGN_SECTION(HEADER_SIZE);
     output_size += MVM_ALIGN_SECTION(writer->root.num_dependencies * DEP_TABLE_ENTRY_SIZE);
     output_size += MVM_ALIGN_SECTION(writer->root.num_stables * STABLES_TABLE_ENTRY_SIZE);
     output_size += MVM_ALIGN_SECTION(writer->stables_data_offset);
-    output_size += MVM_ALIGN_SECTION(writer->root.num_objects * OBJECTS_TABLE_ENTRY_SIZE);
+    output_size += MVM_ALIGN_SECTION(objects_table_size);
     output_size += MVM_ALIGN_SECTION(writer->objects_data_offset);
     output_size += MVM_ALIGN_SECTION(writer->root.num_closures * CLOSURES_TABLE_ENTRY_SIZE);
     output_size += MVM_ALIGN_SECTION(writer->root.num_contexts * CONTEXTS_TABLE_ENTRY_SIZE);
@@ -859,9 +903,9 @@ static MVMObject * concatenate_outputs(MVMThreadContext *tc, MVMSerializationWri
     /* Put objects table in place, and set location/rows in header. */
     write_int32(output, 24, offset);
     write_int32(output, 28, writer->root.num_objects);
-    memcpy(output + offset, writer->root.objects_table,
-        writer->root.num_objects * OBJECTS_TABLE_ENTRY_SIZE);
-    offset += MVM_ALIGN_SECTION(writer->root.num_objects * OBJECTS_TABLE_ENTRY_SIZE);
+    memcpy(output + offset, objects_table, objects_table_size);
+    offset += MVM_ALIGN_SECTION(objects_table_size);
+    MVM_free(objects_table);
 
     /* Put objects data in place. */
     write_int32(output, 32, offset);
@@ -1230,6 +1274,30 @@ static void serialize_object(MVMThreadContext *tc, MVMSerializationWriter *write
     write_int32(writer->root.objects_table, offset + 0, packed);
     write_int32(writer->root.objects_table, offset + 4, writer->objects_data_offset);
 
+    /* A repossessed object where only some attribute containers changed
+     * just gets those attributes written out, as a count followed by the
+     * attribute index and value of each. */
+    if (IS_CONCRETE(obj) && writer->root.sc->body->rep_delta_attrs.entries) {
+        struct MVMPtrHashEntry *delta = MVM_ptr_hash_fetch(tc,
+            &writer->root.sc->body->rep_delta_attrs, obj);
+        if (delta) {
+            uintptr_t mask = delta->value;
+            MVMint64  count = 0;
+            MVMuint32 idx;
+            for (idx = 0; (mask >> idx) != 0; idx++)
+                count += (mask >> idx) & 1;
+            MVM_serialization_write_int(tc, writer, count);
+            for (idx = 0; mask; idx++, mask >>= 1) {
+                if (mask & 1) {
+                    MVMObject *value = MVM_p6opaque_get_attr_idx(tc, obj, idx);
+                    MVM_serialization_write_int(tc, writer, idx);
+                    MVM_serialization_write_ref(tc, writer, value);
+                }
+            }
+            return;
+        }
+    }
+
     /* Delegate to its serialization REPR function. */
     if (IS_CONCRETE(obj)) {
         if (REPR(obj)->serialize)
@@ -1345,7 +1413,11 @@ static void serialize_repossessions(MVMThreadContext *tc, MVMSerializationWriter
             ? MVM_sc_find_stable_idx(tc, orig_sc, writer->root.sc->body->root_stables[obj_idx])
             : MVM_sc_find_object_idx(tc, orig_sc, writer->root.sc->body->root_objects[obj_idx]));
 
-        /* Write table row. */
+        /* Write table row; objects only repossessed for changes to their
+         * attribute containers get the delta type. */
+        if (!is_st && MVM_ptr_hash_fetch(tc, &writer->root.sc->body->rep_delta_attrs,
+                writer->root.sc->body->root_objects[obj_idx]))
+            is_st = 2;
         write_int32(writer->root.repos_table, offset, is_st);
         write_int32(writer->root.repos_table, offset + 4, obj_idx);
         write_int32(writer->root.repos_table, offset + 8, orig_sc_id);
@@ -1523,6 +1595,8 @@ MVM_NO_RETURN static void fail_deserialize(MVMThreadContext *tc, char **waste, M
         MVM_free(reader->data);
     if (reader->contexts)
         MVM_free(reader->contexts);
+    MVM_free(reader->objects_table_unpacked);
+    MVM_free(reader->delta_objects);
     if (reader->root.sc)
         reader->root.sc->body->sr = NULL;
     if (reader->root.dependent_scs)
@@ -1945,7 +2019,7 @@ MVMObject * MVM_serialization_read_ref(MVMThreadContext *tc, MVMSerializationRea
         case REFVAR_VM_INT: {
             MVMint64 value;
             value = MVM_serialization_read_int(tc, reader);
-            if (MVM_INTCACHE_RANGE_CHECK(value))
+            if (MVM_INTCACHE_RANGE_CHECK(tc, value))
                 result = MVM_intcache_get(tc, tc->instance->boot_types.BOOTInt, value);
             if (result == 0) {
                 result = MVM_gc_allocate_object(tc, STABLE(tc->instance->boot_types.BOOTInt));
@@ -2006,6 +2080,55 @@ MVMSTable * MVM_serialization_read_stable_ref(MVMThreadContext *tc, MVMSerializa
     return MVM_sc_get_stable(tc, sc, idx);
 }
 
+/* Reads an unsigned LEB128 number, not going past limit. Returns the number
+ * of bytes used, or 0 if it didn't fit. */
+static size_t read_uleb128(const char *buffer, const char *limit, MVMuint32 *value) {
+    size_t   read  = 0;
+    unsigned shift = 0;
+    *value = 0;
+    while (buffer + read < limit && shift < 32) {
+        MVMuint8 byte = (MVMuint8)buffer[read++];
+        *value |= (MVMuint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return read;
+        shift += 7;
+    }
+    return 0;
+}
+
+/* Unpacks an objects table packed by pack_objects_table into the fixed size
+ * rows that the rest of the reader works with. */
+static void unpack_objects_table(MVMThreadContext *tc, MVMSerializationReader *reader) {
+    const char *pos       = reader->root.objects_table;
+    const char *limit     = reader->root.objects_data;
+    MVMuint32   prev_ref  = 0;
+    MVMuint32   prev_offs = 0;
+    MVMint32    i;
+    if (reader->root.num_objects < 0)
+        fail_deserialize(tc, NULL, reader,
+            "Corruption detected (negative number of objects)");
+    reader->objects_table_unpacked = MVM_malloc(
+        MAX(reader->root.num_objects, 1) * OBJECTS_TABLE_ENTRY_SIZE);
+    for (i = 0; i < reader->root.num_objects; i++) {
+        char      *row = reader->objects_table_unpacked + i * OBJECTS_TABLE_ENTRY_SIZE;
+        MVMuint32  ref_delta, offs_delta;
+        size_t     used;
+        if (!(used = read_uleb128(pos, limit, &ref_delta)))
+            fail_deserialize(tc, NULL, reader,
+                "Corruption detected (objects table overruns objects data)");
+        pos += used;
+        if (!(used = read_uleb128(pos, limit, &offs_delta)))
+            fail_deserialize(tc, NULL, reader,
+                "Corruption detected (objects table overruns objects data)");
+        pos += used;
+        prev_ref  ^= ref_delta;
+        prev_offs += offs_delta;
+        write_int32(row, 0, (MVMint32)((prev_ref >> 1) | (prev_ref << 31)));
+        write_int32(row, 4, (MVMint32)prev_offs);
+    }
+    reader->root.objects_table = reader->objects_table_unpacked;
+}
+
 /* Checks the header looks sane and all of the places it points to make sense.
  * Also dissects the input string into the tables and data segments and populates
  * the reader data structure more fully. */
@@ -2098,10 +2221,16 @@ static void check_and_dissect_input(MVMThreadContext *tc,
     if (reader->root.objects_table < prov_pos)
         fail_deserialize(tc, NULL, reader,
             "Corruption detected (objects table starts before STables data ends)");
-    prov_pos = reader->root.objects_table + reader->root.num_objects * OBJECTS_TABLE_ENTRY_SIZE;
-    if (prov_pos > data_end)
-        fail_deserialize(tc, NULL, reader,
-            "Corruption detected (objects table overruns end of data)");
+    if (reader->root.version >= 25) {
+        /* The table is packed, so ends wherever the objects data starts. */
+        prov_pos = reader->root.objects_table;
+    }
+    else {
+        prov_pos = reader->root.objects_table + reader->root.num_objects * OBJECTS_TABLE_ENTRY_SIZE;
+        if (prov_pos > data_end)
+            fail_deserialize(tc, NULL, reader,
+                "Corruption detected (objects table overruns end of data)");
+    }
 
     /* Get location of objects data. */
     reader->root.objects_data = data + read_int32(data, 32);
@@ -2112,6 +2241,8 @@ static void check_and_dissect_input(MVMThreadContext *tc,
     if (prov_pos > data_end)
         fail_deserialize(tc, NULL, reader,
             "Corruption detected (objects data starts after end of data)");
+    if (reader->root.version >= 25)
+        unpack_objects_table(tc, reader);
 
     /* Get size and location of closures table. */
     reader->root.closures_table = data + read_int32(data, 36);
@@ -2169,7 +2300,7 @@ static void check_and_dissect_input(MVMThreadContext *tc,
             "Corruption detected (parameterization interns data overruns end of data)");
 
     /* Set reading limits for data chunks. */
-    reader->stables_data_end       = reader->root.objects_table;
+    reader->stables_data_end       = data + read_int32(data, 24);
     reader->objects_data_end       = reader->root.closures_table;
     reader->contexts_data_end      = reader->root.repos_table;
     reader->param_interns_data_end = data_end;
@@ -2802,10 +2933,21 @@ static void deserialize_object(MVMThreadContext *tc, MVMSerializationReader *rea
         reader->cur_read_offset = &(reader->objects_data_offset);
         reader->cur_read_end    = &(reader->objects_data_end);
 
-        /* Delegate to its deserialization REPR function. */
+        /* Delegate to its deserialization REPR function, unless it is a
+         * delta repossession, in which case we just rebind the changed
+         * attributes of the existing object. */
         reader->current_object = obj;
         reader->objects_data_offset = read_int32(obj_table_row, 4);
-        if (REPR(obj)->deserialize)
+        if (reader->delta_objects && (reader->delta_objects[i >> 3] & (1 << (i & 7)))) {
+            MVMint64 num_attrs = MVM_serialization_read_int(tc, reader);
+            MVMint64 j;
+            for (j = 0; j < num_attrs; j++) {
+                MVMint64   idx   = MVM_serialization_read_int(tc, reader);
+                MVMObject *value = MVM_serialization_read_ref(tc, reader);
+                MVM_p6opaque_bind_attr_idx(tc, obj, idx, value);
+            }
+        }
+        else if (REPR(obj)->deserialize)
             REPR(obj)->deserialize(tc, STABLE(obj), obj, OBJECT_BODY(obj), reader);
         else
             fail_deserialize(tc, NULL, reader, "Missing deserialize REPR function for %s (%s)",
@@ -3029,6 +3171,83 @@ void MVM_serialization_finish_deserialize_method_cache(MVMThreadContext *tc, MVM
     }
 }
 
+/* A deserialization thread takes serialization contexts that have been
+ * deserialized as far as loading them needed, and demands the rest of their
+ * STables and objects, so they needn't be done lazily one after the other
+ * on the threads that use them. Each demand takes the SC's mutex, and while
+ * it's working on an SC, other threads see that through sc_working and take
+ * the mutex too rather than using a stub; so they just wait for whatever is
+ * being deserialized at that moment, if they need it, and otherwise get on
+ * in parallel. Demands only ever go from an SC to those it depends on, so
+ * the mutexes are always taken in the same order. Work within an SC isn't
+ * shared, since its reader has just the one position in the data. */
+static void deserialize_worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    MVMInstance *i = tc->instance;
+
+#if MVM_HAS_PTHREAD_SETNAME_NP
+    pthread_setname_np(pthread_self(), "deserializer");
+#endif
+
+    while (1) {
+        MVMSerializationContext *sc = NULL;
+
+        /* Sleep as a blocked thread until there's work, or we're told to
+         * stop, then take it (if another thread didn't beat us to it);
+         * nothing between taking the mutex and rooting the SC can trigger a
+         * GC run. */
+        MVMuint32 stop;
+        MVM_gc_mark_thread_blocked(tc);
+        uv_mutex_lock(&i->mutex_deserialize_pending);
+        while (MVM_VECTOR_ELEMS(i->deserialize_pending) == 0 && !i->deserialize_pool->stop)
+            uv_cond_wait(&i->cond_deserialize_pending, &i->mutex_deserialize_pending);
+        stop = i->deserialize_pool->stop;
+        uv_mutex_unlock(&i->mutex_deserialize_pending);
+        MVM_gc_mark_thread_unblocked(tc);
+        if (stop)
+            break;
+        uv_mutex_lock(&i->mutex_deserialize_pending);
+        if (MVM_VECTOR_ELEMS(i->deserialize_pending) > 0)
+            sc = MVM_VECTOR_POP(i->deserialize_pending);
+        uv_mutex_unlock(&i->mutex_deserialize_pending);
+        if (!sc)
+            continue;
+
+        /* STables first, since the objects will need them. */
+        MVMROOT(tc, sc, {
+            MVMSerializationReader *sr = sc->body->sr;
+            MVMint64 num_stables = sr ? sr->root.num_stables : 0;
+            MVMint64 num_objects = sr ? sr->root.num_objects : 0;
+            MVMint64 idx;
+            for (idx = 0; idx < num_stables; idx++) {
+                MVM_serialization_demand_stable(tc, sc, idx);
+                GC_SYNC_POINT(tc);
+            }
+            for (idx = 0; idx < num_objects; idx++) {
+                MVM_serialization_demand_object(tc, sc, idx);
+                GC_SYNC_POINT(tc);
+            }
+        });
+    }
+}
+
+/* Starts the deserialization threads, if any were asked for. Contexts still
+ * queued when they were last stopped are picked up again. */
+void MVM_serialization_start_threads(MVMThreadContext *tc) {
+    MVMInstance *i = tc->instance;
+    if (!i->num_deserialize_threads)
+        return;
+    if (!i->deserialize_pool)
+        i->deserialize_pool = MVM_worker_pool_create(i->num_deserialize_threads,
+            &i->mutex_deserialize_pending, &i->cond_deserialize_pending, deserialize_worker);
+    MVM_worker_pool_start(tc, i->deserialize_pool);
+}
+
+/* Stops and joins the deserialization threads, if they are running. */
+void MVM_serialization_stop_threads(MVMThreadContext *tc) {
+    if (tc->instance->deserialize_pool)
+        MVM_worker_pool_stop(tc, tc->instance->deserialize_pool);
+}
+
 /* Repossess an object or STable. Ignores those not matching the specified
  * type (where 0 = object, 1 = STable). */
 static void repossess(MVMThreadContext *tc, MVMSerializationReader *reader, MVMint64 i,
@@ -3041,9 +3260,9 @@ static void repossess(MVMThreadContext *tc, MVMSerializationReader *reader, MVMi
     /* Do appropriate type of repossession, provided it matches the type of
      * thing we're current repossessing. */
     MVMint32 repo_type = read_int32(table_row, 0);
-    if (repo_type != type)
+    if (repo_type != type && !(repo_type == 2 && type == 0))
         return;
-    if (repo_type == 0) {
+    if (repo_type == 0 || repo_type == 2) {
         MVMSTable *updated_st;
 
         /* Get object to repossess. */
@@ -3077,19 +3296,35 @@ static void repossess(MVMThreadContext *tc, MVMSerializationReader *reader, MVMi
         MVM_sc_set_obj_sc(tc, orig_obj, reader->root.sc);
         MVM_sc_set_idx_in_sc(&(orig_obj->header), slot);
 
+        /* A delta repossession is applied on top of the object as it is;
+         * its type must not have changed since. */
+        if (repo_type == 2) {
+            if (reader->root.num_objects < 0 || slot >= (MVMuint32)reader->root.num_objects
+                    || REPR(orig_obj)->ID != MVM_REPR_ID_P6opaque || !IS_CONCRETE(orig_obj)
+                    || read_object_table_entry(tc, reader, slot, NULL) != STABLE(orig_obj))
+                fail_deserialize(tc, NULL, reader,
+                    "Delta repossession of %s does not match the existing object",
+                    MVM_6model_get_debug_name(tc, orig_obj));
+            if (!reader->delta_objects)
+                reader->delta_objects = MVM_calloc((reader->root.num_objects + 7) / 8, 1);
+            reader->delta_objects[slot >> 3] |= 1 << (slot & 7);
+            worklist_add_index(tc, &(reader->wl_objects), slot);
+            return;
+        }
+
         /* Clear it up, since we'll re-allocate all the bits inside
          * it on deserialization. */
         if (REPR(orig_obj)->gc_free) {
             REPR(orig_obj)->gc_free(tc, orig_obj);
             /* Ensure the object is clean in case the deserialization never happens */
-            memset(OBJECT_BODY(orig_obj), 0, orig_obj->header.size - sizeof(MVMObject));
+            memset(OBJECT_BODY(orig_obj), 0, MVM_gc_collectable_size(&orig_obj->header) - sizeof(MVMObject));
         }
 
         /* The object's STable may have changed as a result of the
          * repossession (perhaps due to mixing in to it), so put the
          * STable it should now have in place. */
         updated_st = read_object_table_entry(tc, reader, slot, NULL);
-        if (updated_st != orig_obj->st)
+        if (updated_st != STABLE(orig_obj))
             REPR(orig_obj)->change_type(tc, orig_obj, updated_st->WHAT);
 
         /* Put this on the list of things we should deserialize right away. */
@@ -3173,6 +3408,7 @@ void MVM_serialization_deserialize(MVMThreadContext *tc, MVMSerializationContext
         MVMObject *string_heap, MVMObject *codes_static,
         MVMObject *repo_conflicts, MVMString *data) {
     MVMint32 scodes, i;
+    MVMuint64 start = MVM_startup_profile_start(tc->instance);
 
     /* Allocate and set up reader. */
     MVMSerializationReader *reader = MVM_calloc(1, sizeof(MVMSerializationReader));
@@ -3266,10 +3502,26 @@ void MVM_serialization_deserialize(MVMThreadContext *tc, MVMSerializationContext
         MVM_serialization_demand_object(tc, sc, i);
     for (i = 0; i < sc->body->num_stables; i++)
         MVM_serialization_demand_stable(tc, sc, i);
+#else
+    /* Otherwise, let any deserialization threads get on with the rest. */
+    if (tc->instance->num_deserialize_threads
+            && (reader->root.num_objects || reader->root.num_stables)) {
+        uv_mutex_lock(&tc->instance->mutex_deserialize_pending);
+        MVM_VECTOR_PUSH(tc->instance->deserialize_pending, sc);
+        uv_cond_signal(&tc->instance->cond_deserialize_pending);
+        uv_mutex_unlock(&tc->instance->mutex_deserialize_pending);
+    }
 #endif
 
     /* Restore normal GC allocation. */
     MVM_gc_allocate_gen2_default_clear(tc);
+
+    if (tc->instance->startup_profiling) {
+        char *c_desc = MVM_string_utf8_encode_C_string(tc,
+            sc->body->description ? sc->body->description : sc->body->handle);
+        MVM_startup_profile_report(tc->instance, "deserialize SC", c_desc, start);
+        MVM_free(c_desc);
+    }
 }
 
 /*
@@ -118,6 +118,15 @@ struct MVMSerializationReader {
      * indicates when it should be. */
     char      *data;
     MVMuint32  data_needs_free;
+
+    /* Since version 25 the objects table is stored packed; this is the
+     * unpacked copy of it that root.objects_table then points to. */
+    char      *objects_table_unpacked;
+
+    /* Bitmap of the object slots that are repossessed as a delta onto the
+     * existing object, rather than deserialized in full; NULL when there
+     * are none. */
+    MVMuint8  *delta_objects;
 };
 
 /* Represents the serialization writer and the various functions available
@@ -184,6 +193,8 @@ MVMObject * MVM_serialization_demand_object(MVMThreadContext *tc, MVMSerializati
 MVMSTable * MVM_serialization_demand_stable(MVMThreadContext *tc, MVMSerializationContext *sc, MVMint64 idx);
 MVMObject * MVM_serialization_demand_code(MVMThreadContext *tc, MVMSerializationContext *sc, MVMint64 idx);
 void MVM_serialization_finish_deserialize_method_cache(MVMThreadContext *tc, MVMSTable *st);
+void MVM_serialization_start_threads(MVMThreadContext *tc);
+void MVM_serialization_stop_threads(MVMThreadContext *tc);
 
 /* Reader/writer functions. */
 MVMint64 MVM_serialization_read_int64(MVMThreadContext *tc, MVMSerializationReader *reader);
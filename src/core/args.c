@@ -36,13 +36,15 @@ void MVM_args_proc_init(MVMThreadContext *tc, MVMArgProcContext *ctx, MVMCallsit
     ctx->num_pos  = callsite->num_pos;
     ctx->arg_count = callsite->arg_count;
     ctx->arg_flags = NULL; /* will be populated by flattener if needed */
+    ctx->named_cursor = 0;
 }
 
 /* Clean up an arguments processing context. */
 void MVM_args_proc_cleanup(MVMThreadContext *tc, MVMArgProcContext *ctx) {
     if (ctx->arg_flags) {
-        MVM_free(ctx->arg_flags);
-        MVM_free(ctx->args);
+        /* The flags live in the same buffer as the flattened args. */
+        MVM_fixed_size_free(tc, tc->instance->fsa, ctx->flat_size, ctx->args);
+        ctx->arg_flags = NULL;
     }
     if (ctx->named_used_size > 64) {
         MVM_fixed_size_free(tc, tc->instance->fsa, ctx->named_used_size,
@@ -78,9 +80,20 @@ MVMCallsite * MVM_args_copy_callsite(MVMThreadContext *tc, MVMArgProcContext *ct
     return res;
 }
 
-/* Copy a callsite unless it is interned. */
+/* Copy a callsite unless it is interned. Flattened positional-only shapes
+ * are looked up in (or added to) the interned callsites, so we don't need
+ * to make a new one each time. */
 MVMCallsite * MVM_args_copy_uninterned_callsite(MVMThreadContext *tc, MVMArgProcContext *ctx) {
-    return ctx->callsite->is_interned && !ctx->arg_flags
+    if (ctx->arg_flags) {
+        if (ctx->num_pos == ctx->arg_count) {
+            MVMCallsite *cs = MVM_callsite_intern_positional(tc, ctx->arg_flags,
+                ctx->flag_count);
+            if (cs)
+                return cs;
+        }
+        return MVM_args_copy_callsite(tc, ctx);
+    }
+    return ctx->callsite->is_interned
         ? ctx->callsite
         : MVM_args_copy_callsite(tc, ctx);
 }
@@ -350,17 +363,25 @@ MVMArgInfo MVM_args_get_optional_pos_uint(MVMThreadContext *tc, MVMArgProcContex
 
 #define args_get_named(tc, ctx, name, required) do { \
      \
-    MVMuint32 flag_pos, arg_pos; \
+    MVMuint32 num_nameds = (ctx->arg_count - ctx->num_pos) / 2; \
+    MVMuint32 i, named_idx, arg_pos; \
     result.arg.s = NULL; \
     result.exists = 0; \
      \
-    for (flag_pos = arg_pos = ctx->num_pos; arg_pos < ctx->arg_count; flag_pos++, arg_pos += 2) { \
+    /* Nameds are mostly passed in the order they're bound, so start looking \
+     * just after the one we found last time. */ \
+    named_idx = ctx->named_cursor; \
+    for (i = 0; i < num_nameds; i++, named_idx++) { \
+        if (named_idx >= num_nameds) \
+            named_idx = 0; \
+        arg_pos = ctx->num_pos + 2 * named_idx; \
         if (MVM_string_equal(tc, ctx->args[arg_pos].s, name)) { \
             result.arg    = ctx->args[arg_pos + 1]; \
-            result.flags  = (ctx->arg_flags ? ctx->arg_flags : ctx->callsite->arg_flags)[flag_pos]; \
+            result.flags  = (ctx->arg_flags ? ctx->arg_flags : ctx->callsite->arg_flags)[ctx->num_pos + named_idx]; \
             result.exists = 1; \
             result.arg_idx = arg_pos + 1; \
-            mark_named_used(ctx, (arg_pos - ctx->num_pos)/2); \
+            mark_named_used(ctx, named_idx); \
+            ctx->named_cursor = named_idx + 1; \
             break; \
         } \
     } \
@@ -826,19 +847,49 @@ static MVMint32 seen_name(MVMThreadContext *tc, MVMString *name, MVMRegister *ne
 static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
     MVMArgInfo arg_info;
     MVMint32 flag_pos = 0, arg_pos = 0, new_arg_pos = 0,
-        new_arg_flags_size = ctx->arg_count > 0x7FFF ? ctx->arg_count : ctx->arg_count * 2,
-        new_args_size = new_arg_flags_size, i, new_flag_pos = 0, new_num_pos = 0;
+        i, new_flag_pos = 0, new_num_pos = 0;
+    MVMint64 max_pos = 0, max_nameds = 0;
+    MVMuint32 flat_size;
     MVMCallsiteEntry *new_arg_flags;
     MVMRegister *new_args;
 
     if (!ctx->callsite->has_flattening) return;
 
-    new_arg_flags = MVM_malloc(new_arg_flags_size * sizeof(MVMCallsiteEntry));
-    new_args = MVM_malloc(new_args_size * sizeof(MVMRegister));
+    /* Work out how many arguments we could end up with at most (duplicate
+     * nameds get dropped), so that we can flatten straight into a single
+     * buffer holding both the arguments and their flags. */
+    for (arg_pos = 0; arg_pos < ctx->num_pos; arg_pos++) {
+        MVMObject *list = ctx->args[arg_pos].o;
+        if ((ctx->callsite->arg_flags[arg_pos] & MVM_CALLSITE_ARG_FLAT) && list)
+            max_pos += REPR(list)->elems(tc, STABLE(list), list, OBJECT_BODY(list));
+        else
+            max_pos++;
+    }
+    if (max_pos > 0xFFFF)
+        MVM_exception_throw_adhoc(tc, "Too many arguments (%"PRId64") in flattening array, only %"PRId32" allowed.", max_pos, 0xFFFF);
+    for (flag_pos = ctx->num_pos; flag_pos < ctx->callsite->flag_count; flag_pos++, arg_pos++) {
+        if (ctx->callsite->arg_flags[flag_pos] & MVM_CALLSITE_ARG_FLAT_NAMED) {
+            MVMObject *hash = ctx->args[arg_pos].o;
+            if (hash && REPR(hash)->ID == MVM_REPR_ID_MVMHash)
+                max_nameds += MVM_hash_count(tc, &((MVMHash *)hash)->body);
+            else if (hash)
+                MVM_exception_throw_adhoc(tc, "flattening of other hash reprs NYI.");
+        }
+        else {
+            max_nameds++;
+            arg_pos++;
+        }
+    }
+    if (max_pos + 2 * max_nameds > 0xFFFF)
+        MVM_exception_throw_adhoc(tc, "Too many arguments (%"PRId64") in flattening, only %"PRId32" allowed.", max_pos + 2 * max_nameds, 0xFFFF);
+    flat_size = (max_pos + 2 * max_nameds) * sizeof(MVMRegister)
+        + (max_pos + max_nameds) * sizeof(MVMCallsiteEntry);
+    new_args = MVM_fixed_size_alloc(tc, tc->instance->fsa, flat_size ? flat_size : 1);
+    new_arg_flags = (MVMCallsiteEntry *)(new_args + max_pos + 2 * max_nameds);
 
     /* First flatten any positionals in amongst any non-flattening
      * positionals. */
-    for ( ; arg_pos < ctx->num_pos; arg_pos++) {
+    for (arg_pos = 0; arg_pos < ctx->num_pos; arg_pos++) {
 
         arg_info.arg    = ctx->args[arg_pos];
         arg_info.flags  = ctx->callsite->arg_flags[arg_pos];
@@ -851,20 +902,7 @@ static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
             MVMint64        count = REPR(list)->elems(tc, STABLE(list), list, OBJECT_BODY(list));
             MVMStorageSpec  lss   = REPR(list)->pos_funcs.get_elem_storage_spec(tc, STABLE(list));
 
-            if ((MVMint64)new_arg_pos + count > 0xFFFF) {
-                MVM_free(new_arg_flags);
-                MVM_free(new_args);
-                MVM_exception_throw_adhoc(tc, "Too many arguments (%"PRId64") in flattening array, only %"PRId32" allowed.", (MVMint64)new_arg_pos + count, 0xFFFF);
-            }
-
             for (i = 0; i < count; i++) {
-                if (new_arg_pos == new_args_size) {
-                    new_args = MVM_realloc(new_args, (new_args_size *= 2) * sizeof(MVMRegister));
-                }
-                if (new_flag_pos == new_arg_flags_size) {
-                    new_arg_flags = MVM_realloc(new_arg_flags, (new_arg_flags_size *= 2) * sizeof(MVMCallsiteEntry));
-                }
-
                 switch (lss.inlineable ? lss.boxed_primitive : 0) {
                     case MVM_STORAGE_SPEC_BP_INT:
                         (new_args + new_arg_pos++)->i64 = MVM_repr_at_pos_i(tc, list, i);
@@ -886,13 +924,6 @@ static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
             }
         }
         else {
-            if (new_arg_pos == new_args_size) {
-                new_args = MVM_realloc(new_args, (new_args_size *= 2) * sizeof(MVMRegister));
-            }
-            if (new_flag_pos == new_arg_flags_size) {
-                new_arg_flags = MVM_realloc(new_arg_flags, (new_arg_flags_size *= 2) * sizeof(MVMCallsiteEntry));
-            }
-
             *(new_args + new_arg_pos++) = arg_info.arg;
             new_arg_flags[new_flag_pos++] = arg_info.flags;
         }
@@ -910,45 +941,25 @@ static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
             arg_pos--;
             arg_info.arg = ctx->args[arg_pos];
 
-            if (arg_info.arg.o && REPR(arg_info.arg.o)->ID == MVM_REPR_ID_MVMHash) {
+            if (arg_info.arg.o) {
                 MVMHashBody *body = &((MVMHash *)arg_info.arg.o)->body;
-                MVMStrHashTable *hashtable = &(body->hashtable);
 
-                MVMStrHashIterator iterator = MVM_str_hash_first(tc, hashtable);
-                while (!MVM_str_hash_at_end(tc, hashtable, iterator)) {
-                    MVMHashEntry *current = MVM_str_hash_current_nocheck(tc, hashtable, iterator);
+                MVMStrHashIterator iterator = MVM_hash_first(tc, body);
+                while (!MVM_hash_at_end(tc, body, iterator)) {
+                    MVMHashEntry *current = MVM_hash_current_nocheck(tc, body, iterator);
                     MVMString *arg_name = current->hash_handle.key;
                     if (!seen_name(tc, arg_name, new_args, new_num_pos, new_arg_pos)) {
-                        if (new_arg_pos + 1 >= new_args_size) {
-                            new_args = MVM_realloc(new_args, (new_args_size *= 2) * sizeof(MVMRegister));
-                        }
-                        if (new_flag_pos == new_arg_flags_size) {
-                            new_arg_flags = MVM_realloc(new_arg_flags, (new_arg_flags_size *= 2) * sizeof(MVMCallsiteEntry));
-                        }
-
                         (new_args + new_arg_pos++)->s = arg_name;
                         (new_args + new_arg_pos++)->o = current->value;
                         new_arg_flags[new_flag_pos++] = MVM_CALLSITE_ARG_NAMED | MVM_CALLSITE_ARG_OBJ;
                     }
-                    iterator = MVM_str_hash_next_nocheck(tc, hashtable, iterator);
+                    iterator = MVM_hash_next_nocheck(tc, body, iterator);
                 }
             }
-            else if (arg_info.arg.o) {
-                MVM_free(new_arg_flags);
-                MVM_free(new_args);
-                MVM_exception_throw_adhoc(tc, "flattening of other hash reprs NYI.");
-            }
         }
         else {
             arg_pos -= 2;
             if (!seen_name(tc, (ctx->args + arg_pos)->s, new_args, new_num_pos, new_arg_pos)) {
-                if (new_arg_pos + 1 >= new_args_size) {
-                    new_args = MVM_realloc(new_args, (new_args_size *= 2) * sizeof(MVMRegister));
-                }
-                if (new_flag_pos == new_arg_flags_size) {
-                    new_arg_flags = MVM_realloc(new_arg_flags, (new_arg_flags_size *= 2) * sizeof(MVMCallsiteEntry));
-                }
-
                 (new_args + new_arg_pos++)->s = (ctx->args + arg_pos)->s;
                 *(new_args + new_arg_pos++) = *(ctx->args + arg_pos + 1);
                 new_arg_flags[new_flag_pos++] = ctx->callsite->arg_flags[flag_pos];
@@ -964,6 +975,8 @@ static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
     ctx->num_pos = new_num_pos;
     ctx->arg_flags = new_arg_flags;
     ctx->flag_count = new_flag_pos;
+    ctx->flat_size = flat_size ? flat_size : 1;
+    ctx->named_cursor = 0;
 }
 
 /* Does the common setup work when we jump the interpreter into a chosen
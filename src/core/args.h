@@ -19,6 +19,10 @@ struct MVMArgProcContext {
     } named_used;
     MVMuint16 named_used_size;
 
+    /* Index of the named after the one last looked up, where the next
+     * named lookup starts its search. */
+    MVMuint16 named_cursor;
+
     /* The total argument count (including 2 for each
      * named arg). */
     MVMuint16 arg_count;
@@ -28,6 +32,10 @@ struct MVMArgProcContext {
 
     /* The number of arg flags; only valid if arg_flags isn't NULL. */
     MVMuint16 flag_count;
+
+    /* The size of the buffer holding the flattened args and, after them,
+     * their flags; only valid if arg_flags isn't NULL. */
+    MVMuint32 flat_size;
 };
 
 /* Expected return type flags. */
@@ -64,9 +64,6 @@ typedef struct {
     /* The limit we can not read beyond. */
     MVMuint8 *read_limit;
 
-    /* Array of frames. */
-    MVMStaticFrame **frames;
-
     /* Special frame indexes */
     MVMuint32  mainline_frame;
     MVMuint32  main_frame;
@@ -108,7 +105,6 @@ static MVMuint8 read_int8(MVMuint8 *buffer, size_t offset) {
 
 /* Cleans up reader state. */
 static void cleanup_all(ReaderState *rs) {
-    MVM_free(rs->frames);
     MVM_free(rs->frame_outer_fixups);
     MVM_free(rs);
 }
@@ -310,6 +306,7 @@ static void deserialize_sc_deps(MVMThreadContext *tc, MVMCompUnit *cu, ReaderSta
         else {
             if (!entry->hash_handle.key) {
                 entry->hash_handle.key = handle;
+                MVM_gc_note_escape(tc);
 
                 MVMSerializationContextBody *scb = MVM_calloc(1, sizeof(MVMSerializationContextBody));
                 entry->scb = scb;
@@ -466,109 +463,88 @@ static MVMExtOpRecord * deserialize_extop_records(MVMThreadContext *tc, MVMCompU
 
 /* Loads the static frame information (what locals we have, bytecode offset,
  * lexicals, etc.) and returns a list of them. */
-static MVMStaticFrame ** deserialize_frames(MVMThreadContext *tc, MVMCompUnit *cu, ReaderState *rs) {
-    MVMStaticFrame **frames;
-    MVMuint8        *pos;
-    MVMuint32        bytecode_pos, bytecode_size, i, j;
-    MVMuint16        bytecode_version = rs->version;
+/* Checks the frames and builds an index of where they are; the static frames
+ * themselves are made when first needed, by MVM_bytecode_materialize_coderef.
+ * Everything that making them relies on is checked here, so that can't
+ * fail. */
+static void index_frames(MVMThreadContext *tc, MVMCompUnit *cu, ReaderState *rs) {
+    MVMuint32 *index;
+    MVMuint8  *pos;
+    MVMuint8  *outer_state;
+    MVMuint32  i, j;
+    MVMuint16  bytecode_version = rs->version;
 
-    /* Allocate frames array. */
+    /* Allocate the index. */
     if (rs->expected_frames == 0) {
         cleanup_all(rs);
         MVM_exception_throw_adhoc(tc, "Bytecode file must have at least one frame");
     }
-    frames = MVM_malloc(sizeof(MVMStaticFrame *) * rs->expected_frames);
+    index = MVM_malloc(sizeof(MVMuint32) * rs->expected_frames);
 
     /* Allocate outer fixup list for frames. */
     rs->frame_outer_fixups = MVM_malloc(sizeof(MVMuint16) * rs->expected_frames);
 
-    /* Load frames. */
+    /* Check frames. */
     pos = rs->frame_seg;
     for (i = 0; i < rs->expected_frames; i++) {
-        MVMStaticFrame *static_frame;
-        MVMStaticFrameBody *static_frame_body;
+        MVMuint32 bytecode_pos, bytecode_size, num_locals, num_lexicals, num_handlers;
 
         /* Ensure we can read a frame here. */
         ensure_can_read(tc, cu, rs, pos, FRAME_HEADER_SIZE);
+        index[i] = (MVMuint32)(pos - cu->body.data_start);
 
-        /* Allocate frame and get/check bytecode start/length. */
-        static_frame = (MVMStaticFrame *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTStaticFrame);
-        MVM_ASSIGN_REF(tc, &(cu->common.header), frames[i], static_frame);
-        static_frame_body = &static_frame->body;
+        /* Check bytecode start/length. */
         bytecode_pos = read_int32(pos, 0);
         bytecode_size = read_int32(pos, 4);
         if (bytecode_pos >= rs->bytecode_size) {
             MVMuint32 bytecode_size = rs->bytecode_size;
             cleanup_all(rs);
-            MVM_free(frames);
+            MVM_free(index);
             MVM_exception_throw_adhoc(tc, "Frame has invalid bytecode start point %d (size %d)", bytecode_pos, bytecode_size);
         }
         if (bytecode_pos + bytecode_size > rs->bytecode_size) {
             cleanup_all(rs);
-            MVM_free(frames);
+            MVM_free(index);
             MVM_exception_throw_adhoc(tc, "Frame bytecode overflows bytecode stream");
         }
-        static_frame_body->bytecode      = rs->bytecode_seg + bytecode_pos;
-        static_frame_body->bytecode_size = bytecode_size;
-        static_frame_body->orig_bytecode = static_frame_body->bytecode;
 
         /* Get number of locals and lexicals. */
-        static_frame_body->num_locals   = read_int32(pos, 8);
-        static_frame_body->num_lexicals = read_int32(pos, 12);
+        num_locals   = read_int32(pos, 8);
+        num_lexicals = read_int32(pos, 12);
 
-        /* Get compilation unit unique ID and name. */
-        MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->cuuid, get_heap_string(tc, cu, rs, pos, 16));
-        MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->name, get_heap_string(tc, cu, rs, pos, 20));
+        /* Check compilation unit unique ID and name. */
+        if (read_int32(pos, 16) >= cu->body.num_strings || read_int32(pos, 20) >= cu->body.num_strings) {
+            cleanup_all(rs);
+            MVM_free(index);
+            MVM_exception_throw_adhoc(tc, "String heap index beyond end of string heap");
+        }
 
         /* Add frame outer fixup to fixup list. */
         rs->frame_outer_fixups[i] = read_int16(pos, 24);
 
-        /* Get annotations details */
+        /* Check annotations details */
         {
             MVMuint32 annot_offset    = read_int32(pos, 26);
             MVMuint32 num_annotations = read_int32(pos, 30);
             if (annot_offset + num_annotations * 12 > rs->annotation_size) {
                 cleanup_all(rs);
-                MVM_free(frames);
+                MVM_free(index);
                 MVM_exception_throw_adhoc(tc, "Frame annotation segment overflows bytecode stream");
             }
-            static_frame_body->annotations_data = rs->annotation_seg + annot_offset;
-            static_frame_body->num_annotations  = num_annotations;
         }
 
         /* Read number of handlers. */
-        static_frame_body->num_handlers = read_int32(pos, 34);
-
-        /* Read exit handler flag (version 2 and higher). */
-        if (rs->version >= 2) {
-            MVMint16 flags = read_int16(pos, 38);
-            static_frame_body->has_exit_handler = flags & FRAME_FLAG_EXIT_HANDLER;
-            static_frame_body->is_thunk         = flags & FRAME_FLAG_IS_THUNK;
-            static_frame_body->no_inline        = flags & FRAME_FLAG_NO_INLINE;
-        }
-
-        /* Read code object SC indexes (version 4 and higher). */
-        if (rs->version >= 4) {
-            static_frame_body->code_obj_sc_dep_idx = read_int32(pos, 42);
-            static_frame_body->code_obj_sc_idx     = read_int32(pos, 46);
-        }
-
-        /* Associate frame with compilation unit. */
-        MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->cu, cu);
-
-        /* Stash position for lazy deserialization of the rest. */
-        static_frame_body->frame_data_pos = pos;
+        num_handlers = read_int32(pos, 34);
 
         /* Skip over the rest, making sure it's readable. */
         {
-            MVMuint32 skip = 2 * static_frame_body->num_locals +
-                             6 * static_frame_body->num_lexicals;
+            MVMuint32 skip = 2 * num_locals + 6 * num_lexicals;
             MVMuint16 slvs = read_int16(pos, 40);
             MVMuint32 num_local_debug_names = rs->version >= 6 ? read_int32(pos, 50) : 0;
             pos += FRAME_HEADER_SIZE;
             ensure_can_read(tc, cu, rs, pos, skip);
             pos += skip;
-            for (j = 0; j < static_frame_body->num_handlers; j++) {
+            for (j = 0; j < num_handlers; j++) {
                 ensure_can_read(tc, cu, rs, pos, FRAME_HANDLER_SIZE);
                 if (read_int32(pos, 8) & MVM_EX_CAT_LABELED) {
                     pos += FRAME_HANDLER_SIZE;
@@ -586,21 +562,135 @@ static MVMStaticFrame ** deserialize_frames(MVMThreadContext *tc, MVMCompUnit *c
         }
     }
 
-    /* Fixup outers. */
+    /* Check outers: they must be in range, and since frames are made along
+     * with their outers, there must be no cycles. Each frame has only the
+     * one outer, so following the chain from each frame in turn (marking
+     * frames as on the chain, then done) finds any. */
+    outer_state = MVM_calloc(rs->expected_frames, 1);
     for (i = 0; i < rs->expected_frames; i++) {
-        if (rs->frame_outer_fixups[i] != i) {
-            if (rs->frame_outer_fixups[i] < rs->expected_frames) {
-                MVM_ASSIGN_REF(tc, &(frames[i]->common.header), frames[i]->body.outer, frames[rs->frame_outer_fixups[i]]);
-            }
-            else {
+        MVMuint32 cur = i;
+        while (!outer_state[cur]) {
+            MVMuint16 outer = rs->frame_outer_fixups[cur];
+            outer_state[cur] = 1;
+            if (outer == cur)
+                break;
+            if (outer >= rs->expected_frames) {
                 cleanup_all(rs);
-                MVM_free(frames);
+                MVM_free(index);
+                MVM_free(outer_state);
                 MVM_exception_throw_adhoc(tc, "Invalid frame outer index; cannot fixup");
             }
+            cur = outer;
         }
+        if (outer_state[cur] == 1 && rs->frame_outer_fixups[cur] != cur) {
+            cleanup_all(rs);
+            MVM_free(index);
+            MVM_free(outer_state);
+            MVM_exception_throw_adhoc(tc, "Frame outers form a cycle; cannot fixup");
+        }
+        for (cur = i; outer_state[cur] == 1; cur = rs->frame_outer_fixups[cur])
+            outer_state[cur] = 2;
     }
+    MVM_free(outer_state);
 
-    return frames;
+    cu->body.frame_index    = index;
+    cu->body.bytecode_seg   = rs->bytecode_seg;
+    cu->body.annotation_seg = rs->annotation_seg;
+}
+
+/* Makes the static frame for a frame, and the code object for it, along with
+ * those for its outers if they weren't made yet. Allocates in gen2, so no
+ * rooting is needed. */
+static MVMObject * materialize_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
+    MVMuint8           *pos = cu->body.data_start + cu->body.frame_index[idx];
+    MVMuint16           outer_idx = read_int16(pos, 24);
+    MVMuint16           bytecode_version = cu->body.bytecode_version;
+    MVMStaticFrame     *static_frame;
+    MVMStaticFrameBody *static_frame_body;
+    MVMCode            *coderef;
+    MVMObject          *code_type;
+
+    /* Make sure the outer is there first. */
+    MVMStaticFrame *outer = NULL;
+    if (outer_idx != idx) {
+        MVMObject *outer_code = cu->body.coderefs[outer_idx];
+        if (!outer_code)
+            outer_code = materialize_coderef(tc, cu, outer_idx);
+        outer = ((MVMCode *)outer_code)->body.sf;
+    }
+
+    /* Allocate frame and set up bytecode start/length. */
+    static_frame = (MVMStaticFrame *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTStaticFrame);
+    static_frame_body = &static_frame->body;
+    static_frame_body->bytecode      = cu->body.bytecode_seg + read_int32(pos, 0);
+    static_frame_body->bytecode_size = read_int32(pos, 4);
+    static_frame_body->orig_bytecode = static_frame_body->bytecode;
+
+    /* Get number of locals and lexicals. */
+    static_frame_body->num_locals   = read_int32(pos, 8);
+    static_frame_body->num_lexicals = read_int32(pos, 12);
+
+    /* Get compilation unit unique ID and name. */
+    MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->cuuid, get_heap_string(tc, cu, NULL, pos, 16));
+    MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->name, get_heap_string(tc, cu, NULL, pos, 20));
+
+    /* Set outer. */
+    if (outer)
+        MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->outer, outer);
+
+    /* Get annotations details */
+    static_frame_body->annotations_data = cu->body.annotation_seg + read_int32(pos, 26);
+    static_frame_body->num_annotations  = read_int32(pos, 30);
+
+    /* Read number of handlers. */
+    static_frame_body->num_handlers = read_int32(pos, 34);
+
+    /* Read exit handler flag (version 2 and higher). */
+    if (bytecode_version >= 2) {
+        MVMint16 flags = read_int16(pos, 38);
+        static_frame_body->has_exit_handler = flags & FRAME_FLAG_EXIT_HANDLER;
+        static_frame_body->is_thunk         = flags & FRAME_FLAG_IS_THUNK;
+        static_frame_body->no_inline        = flags & FRAME_FLAG_NO_INLINE;
+    }
+
+    /* Read code object SC indexes (version 4 and higher). */
+    if (bytecode_version >= 4) {
+        static_frame_body->code_obj_sc_dep_idx = read_int32(pos, 42);
+        static_frame_body->code_obj_sc_idx     = read_int32(pos, 46);
+    }
+
+    /* Associate frame with compilation unit. */
+    MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->cu, cu);
+
+    /* Stash position for lazy deserialization of the rest. */
+    static_frame_body->frame_data_pos = pos;
+
+    /* Give it a code object. */
+    code_type = tc->instance->boot_types.BOOTCode;
+    coderef = (MVMCode *)REPR(code_type)->allocate(tc, STABLE(code_type));
+    MVM_ASSIGN_REF(tc, &(coderef->common.header), coderef->body.sf, static_frame);
+    MVM_ASSIGN_REF(tc, &(coderef->common.header), coderef->body.name, static_frame_body->name);
+    MVM_ASSIGN_REF(tc, &(static_frame->common.header), static_frame_body->static_code, coderef);
+
+    /* Only publish it once it's complete, since getcode reads it without
+     * taking the lock. */
+    MVM_barrier();
+    MVM_ASSIGN_REF(tc, &(cu->common.header), cu->body.coderefs[idx], coderef);
+    return (MVMObject *)coderef;
+}
+
+/* Makes the code object (and static frame) for a frame of a compilation unit
+ * that hasn't been used before. If the compilation unit is visible to other
+ * threads, this must be called with its deserialize_frame_mutex held. */
+MVMObject * MVM_bytecode_materialize_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
+    MVMObject *coderef;
+    if (idx >= cu->body.orig_frames)
+        MVM_exception_throw_adhoc(tc, "Frame index %u out of range (%u frames)",
+            idx, cu->body.orig_frames);
+    MVM_gc_allocate_gen2_default_set(tc);
+    coderef = materialize_coderef(tc, cu, idx);
+    MVM_gc_allocate_gen2_default_clear(tc);
+    return coderef;
 }
 
 /* Finishes up reading and exploding of a frame. */
@@ -972,21 +1062,16 @@ static MVMCallsite ** deserialize_callsites(MVMThreadContext *tc, MVMCompUnit *c
 }
 
 /* Creates code objects to go with each of the static frames. */
-static void create_code_objects(MVMThreadContext *tc, MVMCompUnit *cu, ReaderState *rs) {
-    MVMuint32  i;
-    MVMObject *code_type;
-    MVMCompUnitBody *cu_body = &cu->body;
-
-    cu_body->coderefs = MVM_malloc(cu_body->num_frames * sizeof(MVMObject *));
-
-    code_type = tc->instance->boot_types.BOOTCode;
-    for (i = 0; i < cu_body->num_frames; i++) {
-        MVMCode *coderef = (MVMCode *)REPR(code_type)->allocate(tc, STABLE(code_type));
-        MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->coderefs[i], coderef);
-        MVM_ASSIGN_REF(tc, &(coderef->common.header), coderef->body.sf, rs->frames[i]);
-        MVM_ASSIGN_REF(tc, &(coderef->common.header), coderef->body.name, rs->frames[i]->body.name);
-        MVM_ASSIGN_REF(tc, &(rs->frames[i]->common.header), rs->frames[i]->body.static_code, coderef);
+/* Gets the static frame for one of the special frames of a compilation unit
+ * as it is unpacked; nothing else can see it yet, so no lock is needed. */
+static MVMStaticFrame * special_frame(MVMThreadContext *tc, MVMCompUnit *cu, ReaderState *rs, MVMuint32 idx) {
+    if (idx >= rs->expected_frames) {
+        cleanup_all(rs);
+        MVM_exception_throw_adhoc(tc, "Special frame index %u out of range", idx);
     }
+    if (!cu->body.coderefs[idx])
+        materialize_coderef(tc, cu, idx);
+    return ((MVMCode *)cu->body.coderefs[idx])->body.sf;
 }
 
 /* Takes a compilation unit pointing at a bytecode stream (which actually
@@ -1019,11 +1104,12 @@ void MVM_bytecode_unpack(MVMThreadContext *tc, MVMCompUnit *cu) {
     cu_body->extops = deserialize_extop_records(tc, cu, rs);
     cu_body->num_extops = rs->expected_extops;
 
-    /* Load the static frame info and give each one a code reference. */
-    rs->frames = deserialize_frames(tc, cu, rs);
+    /* Index the static frames; they and their code objects are made on
+     * first use. */
+    index_frames(tc, cu, rs);
     cu_body->num_frames = rs->expected_frames;
     cu_body->orig_frames = rs->expected_frames;
-    create_code_objects(tc, cu, rs);
+    cu_body->coderefs = MVM_calloc(cu_body->num_frames, sizeof(MVMObject *));
 
     /* Load callsites. */
     cu_body->max_callsite_size = MVM_MIN_CALLSITE_SIZE;
@@ -1041,16 +1127,18 @@ void MVM_bytecode_unpack(MVMThreadContext *tc, MVMCompUnit *cu) {
     MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->hll_name,
         MVM_cu_string(tc, cu, rs->hll_str_idx));
 
-    /* Resolve special frames. */
+    /* Resolve special frames, which are needed right away. */
     if (rs->mainline_frame)
         MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->mainline_frame,
-            rs->mainline_frame ? rs->frames[rs->mainline_frame - 1] : rs->frames[0]);
+            special_frame(tc, cu, rs, rs->mainline_frame - 1));
     MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->main_frame,
-        rs->main_frame ? rs->frames[rs->main_frame - 1] : rs->frames[0]);
+        special_frame(tc, cu, rs, rs->main_frame ? rs->main_frame - 1 : 0));
     if (rs->load_frame)
-        MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->load_frame, rs->frames[rs->load_frame - 1]);
+        MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->load_frame,
+            special_frame(tc, cu, rs, rs->load_frame - 1));
     if (rs->deserialize_frame)
-        MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->deserialize_frame, rs->frames[rs->deserialize_frame - 1]);
+        MVM_ASSIGN_REF(tc, &(cu->common.header), cu_body->deserialize_frame,
+            special_frame(tc, cu, rs, rs->deserialize_frame - 1));
 
     /* Clean up reader state. */
     cleanup_all(rs);
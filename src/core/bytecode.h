@@ -10,5 +10,6 @@ struct MVMBytecodeAnnotation {
 void MVM_bytecode_unpack(MVMThreadContext *tc, MVMCompUnit *cu);
 MVMBytecodeAnnotation * MVM_bytecode_resolve_annotation(MVMThreadContext *tc, MVMStaticFrameBody *sfb, MVMuint32 offset);
 void MVM_bytecode_advance_annotation(MVMThreadContext *tc, MVMStaticFrameBody *sfb, MVMBytecodeAnnotation *ba);
+MVMObject * MVM_bytecode_materialize_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx);
 void MVM_bytecode_finish_frame(MVMThreadContext *tc, MVMCompUnit *cu, MVMStaticFrame *sf, MVMint32 dump_only);
 MVMuint8 MVM_bytecode_find_static_lexical_scref(MVMThreadContext *tc, MVMCompUnit *cu, MVMStaticFrame *sf, MVMuint16 index, MVMuint32 *sc, MVMuint32 *id);
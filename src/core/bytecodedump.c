@@ -59,7 +59,7 @@ enum {
 };
 
 static MVMStaticFrame * get_frame(MVMThreadContext *tc, MVMCompUnit *cu, int idx) {
-    return ((MVMCode *)cu->body.coderefs[idx])->body.sf;
+    return ((MVMCode *)MVM_cu_coderef(tc, cu, idx))->body.sf;
 }
 
 static void bytecode_dump_frame_internal(MVMThreadContext *tc, MVMStaticFrame *frame, MVMSpeshCandidate *maybe_candidate, MVMuint8 *frame_cur_op, char ***frame_lexicals, char **oo, MVMuint32 *os, MVMuint32 *ol) {
@@ -216,3 +216,41 @@ MVM_PUBLIC void MVM_callsite_try_intern(MVMThreadContext *tc, MVMCallsite **cs_p
     /* Finally, release mutex. */
     uv_mutex_unlock(&tc->instance->mutex_callsite_interns);
 }
+
+/* Finds the interned callsite for a positional-only shape given by the
+ * flags, interning a new one if there isn't one yet. Used to give flattened
+ * argument lists a callsite without copying one each time. Returns NULL if
+ * the shape is too big to intern. */
+MVMCallsite * MVM_callsite_intern_positional(MVMThreadContext *tc,
+        const MVMCallsiteEntry *flags, MVMuint16 num_flags) {
+    MVMCallsiteInterns *interns = tc->instance->callsite_interns;
+    MVMCallsite        *cs      = NULL;
+    MVMint32 i;
+
+    if (num_flags >= MVM_INTERN_ARITY_LIMIT)
+        return NULL;
+
+    uv_mutex_lock(&tc->instance->mutex_callsite_interns);
+    for (i = 0; i < interns->num_by_arity[num_flags]; i++) {
+        MVMCallsite *candidate = interns->by_arity[num_flags][i];
+        if (!num_flags || !memcmp(candidate->arg_flags, flags, num_flags)) {
+            cs = candidate;
+            break;
+        }
+    }
+    uv_mutex_unlock(&tc->instance->mutex_callsite_interns);
+
+    if (!cs) {
+        cs = MVM_calloc(1, sizeof(MVMCallsite));
+        if (num_flags) {
+            cs->arg_flags = MVM_malloc(num_flags * sizeof(MVMCallsiteEntry));
+            memcpy(cs->arg_flags, flags, num_flags * sizeof(MVMCallsiteEntry));
+        }
+        cs->flag_count = num_flags;
+        cs->arg_count  = num_flags;
+        cs->num_pos    = num_flags;
+        MVM_callsite_try_intern(tc, &cs);
+    }
+
+    return cs;
+}
@@ -129,6 +129,10 @@ MVMCallsite *MVM_callsite_copy(MVMThreadContext *tc, const MVMCallsite *cs);
 /* Callsite interning function. */
 MVM_PUBLIC void MVM_callsite_try_intern(MVMThreadContext *tc, MVMCallsite **cs);
 
+/* Find or intern a positional-only callsite with the given flags. */
+MVMCallsite * MVM_callsite_intern_positional(MVMThreadContext *tc,
+    const MVMCallsiteEntry *flags, MVMuint16 num_flags);
+
 /* Count the number of nameds (excluding flattening). */
 MVM_STATIC_INLINE MVMuint16 MVM_callsite_num_nameds(MVMThreadContext *tc, const MVMCallsite *cs) {
     MVMuint16 i = cs->num_pos;
@@ -1,25 +1,49 @@
 #include "moar.h"
+#include "platform/mmap.h"
 
 /* Allocates a new call stack region, not incorporated into the regions double
- * linked list yet. */
+ * linked list yet. Its address space is reserved, and only the first chunk
+ * committed. */
 static MVMCallStackRegion * create_region() {
-    MVMCallStackRegion *region = MVM_malloc(MVM_CALLSTACK_REGION_SIZE);
+    MVMCallStackRegion *region = MVM_platform_reserve_pages(MVM_CALLSTACK_REGION_SIZE);
+    if (!MVM_platform_commit_pages(region, MVM_CALLSTACK_COMMIT_SIZE,
+            MVM_PAGE_READ | MVM_PAGE_WRITE))
+        MVM_panic(1, "Failed to commit call stack memory");
     region->prev = region->next = NULL;
     region->alloc = (char *)region + sizeof(MVMCallStackRegion);
-    region->alloc_limit = (char *)region + MVM_CALLSTACK_REGION_SIZE;
+    region->alloc_limit = (char *)region + MVM_CALLSTACK_COMMIT_SIZE;
     return region;
 }
 
+/* Commits another chunk of a region, if there's any left short of the guard
+ * chunk at its end. Returns zero if it was already fully committed. */
+static MVMint32 commit_more(MVMCallStackRegion *region) {
+    char *guard = (char *)region + MVM_CALLSTACK_REGION_SIZE - MVM_CALLSTACK_COMMIT_SIZE;
+    if (region->alloc_limit >= guard)
+        return 0;
+    if (!MVM_platform_commit_pages(region->alloc_limit, MVM_CALLSTACK_COMMIT_SIZE,
+            MVM_PAGE_READ | MVM_PAGE_WRITE))
+        MVM_panic(1, "Failed to commit call stack memory");
+    region->alloc_limit += MVM_CALLSTACK_COMMIT_SIZE;
+    return 1;
+}
+
 /* Called upon thread creation to set up an initial callstack region for the
  * thread. */
 void MVM_callstack_region_init(MVMThreadContext *tc) {
     tc->stack_first = tc->stack_current = create_region();
 }
 
-/* Moves the current call stack region we're allocating/freeing in along to
- * the next one in the region chain, allocating that next one if needed. */
+/* Called when the current call stack region is out of committed space.
+ * Commits more of it if there's any; otherwise moves the current region we're
+ * allocating/freeing in along to the next one in the region chain, creating
+ * that next one if needed. Regions stay in the chain, committed, once they've
+ * been used, so deep recursion only pays for them the first time. */
 MVMCallStackRegion * MVM_callstack_region_next(MVMThreadContext *tc) {
-    MVMCallStackRegion *next_region = tc->stack_current->next;
+    MVMCallStackRegion *next_region;
+    if (commit_more(tc->stack_current))
+        return tc->stack_current;
+    next_region = tc->stack_current->next;
     if (!next_region) {
         next_region = create_region();
         tc->stack_current->next = next_region;
@@ -56,7 +80,7 @@ void MVM_callstack_region_destroy_all(MVMThreadContext *tc) {
     MVMCallStackRegion *cur = tc->stack_first;
     while (cur) {
         MVMCallStackRegion *next = cur->next;
-        MVM_free(cur);
+        MVM_platform_free_pages(cur, MVM_CALLSTACK_REGION_SIZE);
         cur = next;
     }
     tc->stack_first = NULL;
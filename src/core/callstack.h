@@ -11,12 +11,16 @@ struct MVMCallStackRegion {
     /* The place we'll allocate the next frame. */
     char *alloc;
 
-    /* The end of the allocatable region. */
+    /* The end of the allocatable region; that is, of the part of it that
+     * has been committed so far. */
     char *alloc_limit;
 };
 
-/* The default size of a call stack region. */
-#define MVM_CALLSTACK_REGION_SIZE 131072
+/* The size of the address space reserved for a call stack region. It is
+ * committed MVM_CALLSTACK_COMMIT_SIZE bytes at a time as frames need it, but
+ * for the last chunk, which is never committed and so serves as a guard. */
+#define MVM_CALLSTACK_REGION_SIZE 1048576
+#define MVM_CALLSTACK_COMMIT_SIZE 65536
 
 /* Functions for working with call stack regions. */
 void MVM_callstack_region_init(MVMThreadContext *tc);
@@ -1,5 +1,5 @@
 #include "moar.h"
-#include "math/grisu.h"
+#include "math/ryu.h"
 
 #if defined(_MSC_VER)
 #define strtoll _strtoi64
@@ -30,7 +30,7 @@ void MVM_coerce_istrue(MVMThreadContext *tc, MVMObject *obj, MVMRegister *res_re
         MVMuint8 *true_addr, MVMuint8 *false_addr, MVMuint8 flip) {
     MVMint64 result = 0;
     if (!MVM_is_null(tc, obj)) {
-        MVMBoolificationSpec *bs = obj->st->boolification_spec;
+        MVMBoolificationSpec *bs = STABLE(obj)->boolification_spec;
         switch (bs == NULL ? MVM_BOOL_MODE_NOT_TYPE_OBJECT : bs->mode) {
             case MVM_BOOL_MODE_CALL_METHOD: {
                 MVMObject *code = MVM_frame_find_invokee(tc, bs->method, NULL);
@@ -146,62 +146,9 @@ static void flip_return(MVMThreadContext *tc, void *sr_data) {
     MVMRegister *r = (MVMRegister *)sr_data;
     r->i64 = r->i64 ? 0 : 1;
 }
-/* ui64toa and i64toa
- * Copyright(c) 2014-2016 Milo Yip (miloyip@gmail.com)
- * https://github.com/miloyip/itoa-benchmark
- * With minor modifications.
-
- Copyright (C) 2014 Milo Yip
-
-MIT License:
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-    THE SOFTWARE. */
-static char * u64toa_naive_worker(uint64_t value, char* buffer) {
-    char temp[20];
-    char *p = temp;
-    do {
-        *p++ = (char)(value % 10) + '0';
-        value /= 10;
-    } while (value > 0);
-
-    do {
-        *buffer++ = *--p;
-    } while (p != temp);
-
-    return buffer;
-}
-static size_t i64toa_naive(int64_t value, char* buffer) {
-    uint64_t u = value;
-    char *buf = buffer;
-    if (value < 0) {
-        *buf++ = '-';
-        u = ~u + 1;
-    }
-    return u64toa_naive_worker(u, buf) - buffer;
-}
-/* End code */
-static size_t u64toa_naive(uint64_t value, char* buffer) {
-    return u64toa_naive_worker(value, buffer) - buffer;
-}
 MVMString * MVM_coerce_i_s(MVMThreadContext *tc, MVMint64 i) {
-    char buffer[20];
-    int len;
+    MVMGrapheme8 *blob;
+    size_t len;
     /* See if we can hit the cache. */
     int cache = 0 <= i && i < MVM_INT_TO_STR_CACHE_SIZE;
     if (cache) {
@@ -209,25 +156,26 @@ MVMString * MVM_coerce_i_s(MVMThreadContext *tc, MVMint64 i) {
         if (cached)
             return cached;
     }
-    /* Otherwise, need to do the work; cache it if in range. */
-    len = i64toa_naive(i, buffer);
-    if (0 <= len) {
-        MVMString *result = NULL;
-        MVMGrapheme8 *blob = MVM_malloc(len);
-        memcpy(blob, buffer, len);
+    /* Otherwise, need to do the work, writing the digits straight into the
+     * string's buffer; cache it if in range. */
+    blob = MVM_malloc(MVM_INT_TO_STR_MAX_LEN);
+    len  = MVM_i64_to_decimal(i, (char *)blob);
+    /* Strings that go in the cache are shared by all threads for the rest
+     * of the run, so there's no point them starting out in the nursery. */
+    if (cache) {
+        MVMString *result;
+        MVM_gc_allocate_gen2_default_set(tc);
         result = MVM_string_ascii_from_buf_nocheck(tc, blob, len);
-        if (cache)
-            tc->instance->int_to_str_cache[i] = result;
+        MVM_gc_allocate_gen2_default_clear(tc);
+        tc->instance->int_to_str_cache[i] = result;
         return result;
     }
-    else {
-        MVM_exception_throw_adhoc(tc, "Could not stringify integer (%"PRId64")", i);
-    }
+    return MVM_string_ascii_from_buf_nocheck(tc, blob, len);
 }
 
 MVMString * MVM_coerce_u_s(MVMThreadContext *tc, MVMuint64 i) {
-    char buffer[20];
-    int len;
+    MVMGrapheme8 *blob;
+    size_t len;
     /* See if we can hit the cache. */
     int cache = i < MVM_INT_TO_STR_CACHE_SIZE;
     if (cache) {
@@ -236,42 +184,25 @@ MVMString * MVM_coerce_u_s(MVMThreadContext *tc, MVMuint64 i) {
             return cached;
     }
     /* Otherwise, need to do the work; cache it if in range. */
-    len = u64toa_naive(i, buffer);
-    if (0 <= len) {
-        MVMString *result = NULL;
-        MVMGrapheme8 *blob = MVM_malloc(len);
-        memcpy(blob, buffer, len);
+    blob = MVM_malloc(MVM_INT_TO_STR_MAX_LEN);
+    len  = MVM_u64_to_decimal(i, (char *)blob);
+    if (cache) {
+        MVMString *result;
+        MVM_gc_allocate_gen2_default_set(tc);
         result = MVM_string_ascii_from_buf_nocheck(tc, blob, len);
-        if (cache)
-            tc->instance->int_to_str_cache[i] = result;
+        MVM_gc_allocate_gen2_default_clear(tc);
+        tc->instance->int_to_str_cache[i] = result;
         return result;
     }
-    else {
-        MVM_exception_throw_adhoc(tc, "Could not stringify integer (%"PRIu64")", i);
-    }
+    return MVM_string_ascii_from_buf_nocheck(tc, blob, len);
 }
 
 MVMString * MVM_coerce_n_s(MVMThreadContext *tc, MVMnum64 n) {
-    if (n == MVM_num_posinf(tc)) {
-        return MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "Inf");
-    }
-    else if (n == MVM_num_neginf(tc)) {
-        return MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "-Inf");
-    }
-    else if (n != n) {
-        return MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "NaN");
-    }
-    else {
-        char buf[64];
-        if (dtoa_grisu3(n, buf, 64) < 0)
-            MVM_exception_throw_adhoc(tc, "Could not stringify number (%f)", n);
-        else {
-            MVMStringIndex len = strlen(buf);
-            MVMGrapheme8 *blob = MVM_malloc(len);
-            memcpy(blob, buf, len);
-            return MVM_string_ascii_from_buf_nocheck(tc, blob, len);
-        }
-    }
+    /* The shortest digits that read back as the same number (or Inf, -Inf
+     * or NaN), written straight into the string's buffer. */
+    MVMGrapheme8 *blob = MVM_malloc(MVM_NUM_TO_STR_MAX_LEN);
+    size_t len = MVM_num_to_shortest_str(n, (char *)blob);
+    return MVM_string_ascii_from_buf_nocheck(tc, blob, len);
 }
 
 void MVM_coerce_smart_stringify(MVMThreadContext *tc, MVMObject *obj, MVMRegister *res_reg) {
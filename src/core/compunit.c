@@ -4,13 +4,29 @@
 #ifdef _WIN32
 #include <fcntl.h>
 #define O_RDONLY _O_RDONLY
+#else
+#include <fcntl.h>
+#endif
+
+static MVMuint32 read_uint32(MVMuint8 *src) {
+#ifdef MVM_BIGENDIAN
+    MVMuint32 value;
+    size_t i;
+    MVMuint8 *destbytes = (MVMuint8 *)&value;
+    for (i = 0; i < 4; i++)
+         destbytes[4 - i - 1] = src[i];
+    return value;
+#else
+    return *((MVMuint32 *)src);
 #endif
+}
 
 /* Creates a compilation unit from a byte array. */
 MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size) {
     /* Create compilation unit data structure. Allocate it in gen2 always, so
      * it will never move (the JIT relies on this). */
     MVMCompUnit *cu;
+    MVMuint64 start = MVM_startup_profile_start(tc->instance);
     MVM_gc_allocate_gen2_default_set(tc);
     cu = (MVMCompUnit *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTCompUnit);
     cu->body.data_start = bytes;
@@ -25,6 +41,9 @@ MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32
     cu->body.hll_config = MVM_hll_get_config_for(tc, cu->body.hll_name);
     MVM_gc_write_barrier_hit(tc, (MVMCollectable *)cu);
 
+    if (tc->instance->startup_profiling)
+        MVM_startup_profile_report(tc->instance, "unpack bytecode", NULL, start);
+
     return cu;
 }
 
@@ -35,6 +54,7 @@ MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename) {
     void        *handle      = NULL;
     uv_file      fd;
     MVMuint64    size;
+    MVMuint64    start = MVM_startup_profile_start(tc->instance);
     uv_fs_t req;
 
     /* Ensure the file exists, and get its size. */
@@ -62,6 +82,8 @@ MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename) {
     cu = MVM_cu_from_bytes(tc, (MVMuint8 *)block, (MVMuint32)size);
     cu->body.handle = handle;
     cu->body.deallocate = MVM_DEALLOCATE_UNMAP;
+    if (tc->instance->startup_profiling)
+        MVM_startup_profile_report(tc->instance, "map and unpack bytecode file", filename, start);
     return cu;
 }
 
@@ -88,12 +110,160 @@ MVMCompUnit * MVM_cu_map_from_file_handle(MVMThreadContext *tc, uv_file fd, MVMu
     block = ((char*)block) + pos;
 
     /* Turn it into a compilation unit. */
-    cu = MVM_cu_from_bytes(tc, (MVMuint8 *)block, (MVMuint32)size);
+    cu = MVM_cu_from_bytes(tc, (MVMuint8 *)block, (MVMuint32)(size - pos));
     cu->body.handle = handle;
     cu->body.deallocate = MVM_DEALLOCATE_UNMAP;
     return cu;
 }
 
+/* Compares the name of a bundle entry with a filename. */
+static int bundle_entry_cmp(MVMCUBundle *bundle, MVMuint32 entry, const char *name, size_t name_len) {
+    MVMuint8  *row       = bundle->entries + entry * MVM_CU_BUNDLE_ENTRY_SIZE;
+    MVMuint32  entry_len = read_uint32(row + 4);
+    int        result    = memcmp(bundle->block + read_uint32(row), name,
+        entry_len < name_len ? entry_len : name_len);
+    if (result)
+        return result;
+    return entry_len < name_len ? -1 : entry_len > name_len ? 1 : 0;
+}
+
+/* Maps a bundle of compilation units into memory, checks its index, and
+ * adds it to those that MVM_load_bytecode looks in. */
+void MVM_cu_bundle_load(MVMThreadContext *tc, MVMString *filename) {
+    MVMCUBundle *bundle;
+    char        *c_filename = MVM_string_utf8_c8_encode_C_string(tc, filename);
+    char        *waste[]    = { c_filename, NULL };
+    void        *handle     = NULL;
+    char        *block;
+    const char  *error      = NULL;
+    MVMuint32    num_entries, i;
+    MVMuint64    size;
+    uv_file      fd;
+    uv_fs_t      req;
+
+    if ((fd = uv_fs_open(NULL, &req, c_filename, O_RDONLY, 0, NULL)) < 0)
+        MVM_exception_throw_adhoc_free(tc, waste, "While trying to open bundle '%s': %s",
+            c_filename, uv_strerror(req.result));
+    if (uv_fs_fstat(NULL, &req, fd, NULL) < 0) {
+        uv_fs_close(NULL, &req, fd, NULL);
+        MVM_exception_throw_adhoc_free(tc, waste, "While trying to stat bundle '%s': %s",
+            c_filename, uv_strerror(req.result));
+    }
+    size = req.statbuf.st_size;
+#if defined(POSIX_FADV_WILLNEED) && !defined(_WIN32)
+    /* We'll want all of it, and reading it in sequentially beats faulting
+     * it in page by page as the compilation units are loaded. */
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    block = size ? MVM_platform_map_file(fd, &handle, (size_t)size, 0) : NULL;
+    uv_fs_close(NULL, &req, fd, NULL);
+    if (!block)
+        MVM_exception_throw_adhoc_free(tc, waste, "Could not map bundle '%s' into memory",
+            c_filename);
+
+    /* Check the header and the index. */
+    if (size < MVM_CU_BUNDLE_HEADER || memcmp(block, MVM_CU_BUNDLE_MAGIC, 8) != 0)
+        error = "it is not a bundle of compilation units";
+    else if (read_uint32((MVMuint8 *)block + 8) != MVM_CU_BUNDLE_VERSION)
+        error = "its version is not supported";
+    else if ((num_entries = read_uint32((MVMuint8 *)block + 12)) >
+            (size - MVM_CU_BUNDLE_HEADER) / MVM_CU_BUNDLE_ENTRY_SIZE)
+        error = "its index overruns the end of the file";
+    if (!error) {
+        for (i = 0; i < num_entries; i++) {
+            MVMuint8 *row = (MVMuint8 *)block + MVM_CU_BUNDLE_HEADER + i * MVM_CU_BUNDLE_ENTRY_SIZE;
+            if ((MVMuint64)read_uint32(row) + read_uint32(row + 4) > size
+                    || (MVMuint64)read_uint32(row + 8) + read_uint32(row + 12) > size) {
+                error = "an entry in its index overruns the end of the file";
+                break;
+            }
+        }
+    }
+    if (error) {
+        MVM_platform_unmap_file(block, handle, (size_t)size);
+        MVM_exception_throw_adhoc_free(tc, waste, "Could not load bundle '%s': %s",
+            c_filename, error);
+    }
+    MVM_free(c_filename);
+
+    bundle              = MVM_malloc(sizeof(MVMCUBundle));
+    bundle->block       = block;
+    bundle->handle      = handle;
+    bundle->size        = (size_t)size;
+    bundle->entries     = (MVMuint8 *)block + MVM_CU_BUNDLE_HEADER;
+    bundle->num_entries = num_entries;
+    for (i = 1; i < num_entries; i++) {
+        MVMuint8 *row = bundle->entries + i * MVM_CU_BUNDLE_ENTRY_SIZE;
+        if (bundle_entry_cmp(bundle, i - 1, bundle->block + read_uint32(row),
+                read_uint32(row + 4)) >= 0) {
+            MVM_platform_unmap_file(block, handle, bundle->size);
+            MVM_free(bundle);
+            MVM_exception_throw_adhoc(tc, "Could not load bundle: its index is not sorted");
+        }
+    }
+
+    uv_mutex_lock(&tc->instance->mutex_loaded_compunits);
+    MVM_VECTOR_PUSH(tc->instance->cu_bundles, bundle);
+    uv_mutex_unlock(&tc->instance->mutex_loaded_compunits);
+}
+
+/* Looks through the loaded bundles for a compilation unit with the given
+ * filename, and makes a compilation unit from it if there is one. The bundle
+ * stays mapped for the life of the VM, so the compilation unit doesn't need
+ * to release its bytes. Must be called with mutex_loaded_compunits held. */
+MVMCompUnit * MVM_cu_from_bundles(MVMThreadContext *tc, const char *filename) {
+    size_t    name_len = strlen(filename);
+    MVMuint32 i;
+    for (i = 0; i < tc->instance->cu_bundles_num; i++) {
+        MVMCUBundle *bundle = tc->instance->cu_bundles[i];
+        MVMuint32    lo     = 0;
+        MVMuint32    hi     = bundle->num_entries;
+        while (lo < hi) {
+            MVMuint32 mid = lo + (hi - lo) / 2;
+            int       cmp = bundle_entry_cmp(bundle, mid, filename, name_len);
+            if (cmp < 0) {
+                lo = mid + 1;
+            }
+            else if (cmp > 0) {
+                hi = mid;
+            }
+            else {
+                MVMuint8    *row = bundle->entries + mid * MVM_CU_BUNDLE_ENTRY_SIZE;
+                MVMCompUnit *cu  = MVM_cu_from_bytes(tc,
+                    (MVMuint8 *)bundle->block + read_uint32(row + 8),
+                    read_uint32(row + 12));
+                cu->body.trusted = tc->instance->trust_bundles;
+                return cu;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Unmaps all of the loaded bundles. */
+void MVM_cu_bundles_destroy(MVMInstance *instance) {
+    MVMuint32 i;
+    for (i = 0; i < instance->cu_bundles_num; i++) {
+        MVMCUBundle *bundle = instance->cu_bundles[i];
+        MVM_platform_unmap_file(bundle->block, bundle->handle, bundle->size);
+        MVM_free(bundle);
+    }
+    MVM_VECTOR_DESTROY(instance->cu_bundles);
+}
+
+/* Makes the code object and static frame for a frame that hasn't been used
+ * before, taking the lock that the frame's deserialization will later need
+ * anyway, so only one thread makes them. */
+MVMObject * MVM_cu_materialize_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
+    MVMObject *code;
+    MVM_reentrantmutex_lock(tc, (MVMReentrantMutex *)cu->body.deserialize_frame_mutex);
+    code = cu->body.coderefs[idx];
+    if (!code)
+        code = MVM_bytecode_materialize_coderef(tc, cu, idx);
+    MVM_reentrantmutex_unlock(tc, (MVMReentrantMutex *)cu->body.deserialize_frame_mutex);
+    return code;
+}
+
 /* Adds an extra callsite, needed due to an inlining, and returns its index. */
 MVMuint16 MVM_cu_callsite_add(MVMThreadContext *tc, MVMCompUnit *cu, MVMCallsite *cs) {
     MVMuint16 found = 0;
@@ -163,18 +333,6 @@ MVMuint32 MVM_cu_string_add(MVMThreadContext *tc, MVMCompUnit *cu, MVMString *st
 
 /* Used when we try to read a string from the string heap, but it's not there.
  * Decodes it "on-demand" and stores it in the string heap. */
-static MVMuint32 read_uint32(MVMuint8 *src) {
-#ifdef MVM_BIGENDIAN
-    MVMuint32 value;
-    size_t i;
-    MVMuint8 *destbytes = (MVMuint8 *)&value;
-    for (i = 0; i < 4; i++)
-         destbytes[4 - i - 1] = src[i];
-    return value;
-#else
-    return *((MVMuint32 *)src);
-#endif
-}
 static void compute_fast_table_upto(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 end_bin) {
     MVMuint32  cur_bin = cu->body.string_heap_fast_table_top;
     MVMuint8  *cur_pos = cu->body.string_heap_start + cu->body.string_heap_fast_table[cur_bin];
@@ -198,6 +356,124 @@ static void compute_fast_table_upto(MVMThreadContext *tc, MVMCompUnit *cu, MVMui
     MVM_barrier();
     cu->body.string_heap_fast_table_top = end_bin;
 }
+/* Looks up a string heap entry, given its length word and encoded bytes, in
+ * the instance-wide table of strings already decoded from some compilation
+ * unit. Must be called with the table's mutex held. */
+static MVMString * intern_lookup(MVMCUStringInterns *interns, MVMuint64 hash,
+        MVMuint32 ss, const MVMuint8 *bytes) {
+    MVMuint32 mask = interns->alloc_entries - 1;
+    MVMuint32 slot;
+    if (!interns->alloc_entries)
+        return NULL;
+    slot = (MVMuint32)hash & mask;
+    while (interns->entries[slot].string) {
+        MVMCUStringInternEntry *entry = &(interns->entries[slot]);
+        if (entry->hash == hash && entry->ss == ss
+                && memcmp(entry->bytes, bytes, ss >> 1) == 0)
+            return entry->string;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/* Places an entry into a free slot of the table. */
+static void intern_place(MVMCUStringInterns *interns, MVMCUStringInternEntry *entry) {
+    MVMuint32 mask = interns->alloc_entries - 1;
+    MVMuint32 slot = (MVMuint32)entry->hash & mask;
+    while (interns->entries[slot].string)
+        slot = (slot + 1) & mask;
+    interns->entries[slot] = *entry;
+}
+
+/* Adds a decoded string to the table, growing it when it is three quarters
+ * full. Must be called with the table's mutex held. */
+static void intern_add(MVMCUStringInterns *interns, MVMuint64 hash, MVMuint32 ss,
+        const MVMuint8 *bytes, MVMString *s) {
+    MVMCUStringInternEntry entry;
+    if (4 * (interns->num_entries + 1) > 3 * interns->alloc_entries) {
+        MVMCUStringInternEntry *old_entries = interns->entries;
+        MVMuint32               old_alloc   = interns->alloc_entries;
+        MVMuint32               i;
+        interns->alloc_entries = old_alloc ? 2 * old_alloc : 1024;
+        interns->entries       = MVM_calloc(interns->alloc_entries, sizeof(MVMCUStringInternEntry));
+        for (i = 0; i < old_alloc; i++)
+            if (old_entries[i].string)
+                intern_place(interns, &(old_entries[i]));
+        MVM_free(old_entries);
+    }
+    entry.hash   = hash;
+    entry.ss     = ss;
+    entry.bytes  = MVM_malloc((ss >> 1) ? (ss >> 1) : 1);
+    memcpy(entry.bytes, bytes, ss >> 1);
+    entry.string = s;
+    intern_place(interns, &entry);
+    interns->num_entries++;
+}
+
+/* Decodes a string from a string heap entry. */
+static MVMString * decode_heap_string(MVMThreadContext *tc, MVMuint32 ss, MVMuint8 *bytes) {
+    MVMString *s;
+    MVM_gc_allocate_gen2_default_set(tc);
+    s = ss & 1
+        ? MVM_string_utf8_decode(tc, tc->instance->VMString, (char *)bytes, ss >> 1)
+        : MVM_string_latin1_decode(tc, tc->instance->VMString, (char *)bytes, ss >> 1);
+    MVM_gc_allocate_gen2_default_clear(tc);
+    return s;
+}
+
+/* Obtains the string for a string heap entry, sharing one decoded string
+ * between all the compilation units that contain the same, short, entry.
+ * The decoding allocates, so it happens outside of the mutex; should two
+ * threads race to decode the same entry, the first to add theirs wins. */
+static MVMString * obtain_interned_string(MVMThreadContext *tc, MVMuint32 ss, MVMuint8 *bytes) {
+    MVMCUStringInterns *interns = tc->instance->cu_string_interns;
+    MVMuint64           hash;
+    MVMString          *s;
+    MVMuint32           i;
+    MVMuint8            high = 0;
+
+    /* ASCII decodes the same whichever way it is flagged, so it gets the one
+     * key; that way, equal ASCII strings always end up as the same string,
+     * and we can mark them as interned. */
+    for (i = 0; i < ss >> 1; i++)
+        high |= bytes[i];
+    if (!(high & 0x80))
+        ss &= ~1;
+    hash = siphash24(bytes, ss >> 1, tc->instance->hashSecrets) ^ ss;
+
+    uv_mutex_lock(&tc->instance->mutex_cu_string_interns);
+    s = intern_lookup(interns, hash, ss, bytes);
+    uv_mutex_unlock(&tc->instance->mutex_cu_string_interns);
+    if (s)
+        return s;
+
+    s = decode_heap_string(tc, ss, bytes);
+    uv_mutex_lock(&tc->instance->mutex_cu_string_interns);
+    {
+        MVMString *existing = intern_lookup(interns, hash, ss, bytes);
+        if (existing) {
+            s = existing;
+        }
+        else {
+            if (!(high & 0x80))
+                s->body.flags |= MVM_STRING_FLAG_INTERNED;
+            intern_add(interns, hash, ss, bytes, s);
+        }
+    }
+    uv_mutex_unlock(&tc->instance->mutex_cu_string_interns);
+    return s;
+}
+
+/* Frees the table of interned compilation unit strings. */
+void MVM_cu_string_interns_destroy(MVMInstance *instance) {
+    MVMCUStringInterns *interns = instance->cu_string_interns;
+    MVMuint32 i;
+    for (i = 0; i < interns->alloc_entries; i++)
+        MVM_free(interns->entries[i].bytes);
+    MVM_free(interns->entries);
+    MVM_free(interns);
+}
+
 MVMString * MVM_cu_obtain_string(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
     MVMuint32  cur_idx;
     MVMuint8  *cur_pos;
@@ -228,16 +504,15 @@ MVMString * MVM_cu_obtain_string(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint3
     if (cur_pos + 4 < limit) {
         MVMuint32 ss = read_uint32(cur_pos);
         MVMuint32 bytes = ss >> 1;
-        MVMuint32 decode_utf8 = ss & 1;
         cur_pos += 4;
         if (cur_pos + bytes < limit) {
             MVMString *s;
-            MVM_gc_allocate_gen2_default_set(tc);
-            s = decode_utf8
-                ? MVM_string_utf8_decode(tc, tc->instance->VMString, (char *)cur_pos, bytes)
-                : MVM_string_latin1_decode(tc, tc->instance->VMString, (char *)cur_pos, bytes);
+            MVMROOT(tc, cu, {
+                s = bytes <= MVM_CU_STRING_INTERN_MAX_BYTES
+                    ? obtain_interned_string(tc, ss, cur_pos)
+                    : decode_heap_string(tc, ss, cur_pos);
+            });
             MVM_ASSIGN_REF(tc, &(cu->common.header), cu->body.strings[idx], s);
-            MVM_gc_allocate_gen2_default_clear(tc);
             return s;
         }
         else {
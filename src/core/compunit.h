@@ -1,9 +1,64 @@
+/* An instance-wide table of the strings decoded from the string heaps of
+ * compilation units, keyed on their encoded form, so that a name appearing in
+ * many compilation units is only decoded once, and the one string, along with
+ * its cached hash code, is shared between them. Only short entries go in it. */
+#define MVM_CU_STRING_INTERN_MAX_BYTES 128
+struct MVMCUStringInternEntry {
+    /* Hash of the entry's length word and encoded bytes. */
+    MVMuint64 hash;
+
+    /* The length word (length in bytes shifted left by one, with the low bit
+     * set for UTF-8) and a copy of the encoded bytes. */
+    MVMuint32  ss;
+    MVMuint8  *bytes;
+
+    /* The decoded string; NULL if the slot is free. */
+    MVMString *string;
+};
+struct MVMCUStringInterns {
+    /* Open addressed table, with a power of two number of slots. */
+    MVMCUStringInternEntry *entries;
+    MVMuint32 num_entries;
+    MVMuint32 alloc_entries;
+};
+
+/* A bundle of many compilation units in one file, which is mapped into memory
+ * in one go, so a program made of many of them doesn't need to open and map
+ * each one. Compilation units are found in them by the filenames they would
+ * otherwise be loaded from. See docs/bytecode.markdown for the format. */
+#define MVM_CU_BUNDLE_MAGIC      "MOARBNDL"
+#define MVM_CU_BUNDLE_VERSION    1
+#define MVM_CU_BUNDLE_HEADER     16
+#define MVM_CU_BUNDLE_ENTRY_SIZE 16
+struct MVMCUBundle {
+    /* The mapped file. */
+    char      *block;
+    void      *handle;
+    size_t     size;
+
+    /* The index, which is sorted on the names. */
+    MVMuint8  *entries;
+    MVMuint32  num_entries;
+};
+
 MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size);
 MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename);
 MVMCompUnit * MVM_cu_map_from_file_handle(MVMThreadContext *tc, uv_file fd, MVMuint64 pos);
 MVMuint16 MVM_cu_callsite_add(MVMThreadContext *tc, MVMCompUnit *cu, MVMCallsite *cs);
 MVMuint32 MVM_cu_string_add(MVMThreadContext *tc, MVMCompUnit *cu, MVMString *str);
 MVMString * MVM_cu_obtain_string(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx);
+void MVM_cu_string_interns_destroy(MVMInstance *instance);
+void MVM_cu_bundle_load(MVMThreadContext *tc, MVMString *filename);
+MVMCompUnit * MVM_cu_from_bundles(MVMThreadContext *tc, const char *filename);
+void MVM_cu_bundles_destroy(MVMInstance *instance);
+
+MVMObject * MVM_cu_materialize_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx);
+
+/* Gets the code object for a frame, making it if this is its first use. */
+MVM_STATIC_INLINE MVMObject * MVM_cu_coderef(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
+    MVMObject *code = cu->body.coderefs[idx];
+    return code ? code : MVM_cu_materialize_coderef(tc, cu, idx);
+}
 
 MVM_STATIC_INLINE MVMString * MVM_cu_string(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 idx) {
     MVMString *s = cu->body.strings[idx];
@@ -51,13 +51,15 @@ void MVM_continuation_control(MVMThreadContext *tc, MVMint64 protect,
     MVMFrame           *root_frame  = NULL;
     MVMContinuationTag *tag_record  = NULL;
     MVMFrame            *jump_frame;
+    MVMFrame            *top_frame;
+    MVMFrame            *jump_heap;
+    MVMProfileContinuationData *prof_cont = NULL;
 
 
     MVM_jit_code_trampoline(tc);
 
-    MVMROOT2(tc, tag, code, {
-        jump_frame = MVM_frame_force_to_heap(tc, tc->cur_frame);
-    });
+    tc->num_dynvar_cache = 0;
+    jump_frame = tc->cur_frame;
     while (jump_frame) {
         MVMFrameExtra *e = jump_frame->extra;
         if (e) {
@@ -78,20 +80,42 @@ void MVM_continuation_control(MVMThreadContext *tc, MVMint64 protect,
         MVM_exception_throw_adhoc(tc, "No matching continuation reset found");
     if (!root_frame)
         MVM_exception_throw_adhoc(tc, "No continuation root frame found");
+    if (tc->instance->profiling)
+        prof_cont = MVM_profile_log_continuation_control(tc, root_frame);
+
+    /* Move the frames to capture to the heap. If the reset is in a frame
+     * on the call stack, only those are moved, and the frames from the reset
+     * on down stay where they are; otherwise, all the frames above it are on
+     * the stack, and they all move. */
+    if (MVM_FRAME_IS_ON_CALLSTACK(tc, jump_frame)) {
+        MVMROOT2(tc, tag, code, {
+            top_frame = MVM_frame_move_segment_to_heap(tc, root_frame, &root_frame);
+        });
+        jump_heap = NULL;
+    }
+    else {
+        MVMROOT3(tc, tag, code, jump_frame, {
+            top_frame = MVM_frame_force_to_heap(tc, tc->cur_frame);
+        });
+        root_frame = top_frame;
+        while (root_frame->caller != jump_frame)
+            root_frame = root_frame->caller;
+        jump_heap = jump_frame;
+    }
 
     /* Create continuation. */
-    MVMROOT3(tc, code, jump_frame, root_frame, {
+    MVMROOT4(tc, code, jump_heap, root_frame, top_frame, {
         cont = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTContinuation);
         MVM_ASSIGN_REF(tc, &(cont->header), ((MVMContinuation *)cont)->body.top,
-            tc->cur_frame);
+            top_frame);
         MVM_ASSIGN_REF(tc, &(cont->header), ((MVMContinuation *)cont)->body.root,
             root_frame);
-        ((MVMContinuation *)cont)->body.addr    = *tc->interp_cur_op;
-        ((MVMContinuation *)cont)->body.res_reg = res_reg;
-        if (tc->instance->profiling)
-            ((MVMContinuation *)cont)->body.prof_cont =
-                MVM_profile_log_continuation_control(tc, root_frame);
+        ((MVMContinuation *)cont)->body.addr      = *tc->interp_cur_op;
+        ((MVMContinuation *)cont)->body.res_reg   = res_reg;
+        ((MVMContinuation *)cont)->body.prof_cont = prof_cont;
     });
+    if (jump_heap)
+        jump_frame = jump_heap;
 
     /* Save and clear any active exception handler(s) added since reset. */
     if (tc->active_handlers != tag_record->active_handlers) {
@@ -177,7 +201,9 @@ void MVM_continuation_invoke(MVMThreadContext *tc, MVMContinuation *cont,
 
     MVM_jit_code_trampoline(tc);
 
-    /* Switch to the target frame. */
+    /* Switch to the target frame, whose callers are not those of any cached
+     * dynamic variables. */
+    tc->num_dynvar_cache = 0;
     tc->cur_frame = cont->body.top;
     tc->current_frame_nr = cont->body.top->sequence_nr;
 
@@ -186,6 +212,11 @@ void MVM_continuation_invoke(MVMThreadContext *tc, MVMContinuation *cont,
     *(tc->interp_reg_base) = tc->cur_frame->work;
     *(tc->interp_cu) = tc->cur_frame->static_info->body.cu;
 
+    /* Since the continuation is one-shot, it has no more use for its frames,
+     * and should not keep them alive once they have returned. */
+    cont->body.top  = NULL;
+    cont->body.root = NULL;
+
     /* Put saved active handlers list in place. */
     /* TODO: if we really need to support double-shot, this needs a re-visit.
      * As it is, Rakudo's gather/take only needs single-invoke continuations,
@@ -13,6 +13,16 @@ MVM_STATIC_INLINE MVMFrameHandler * MVM_frame_effective_handlers(MVMFrame *f) {
     return spesh_cand ? spesh_cand->handlers : f->static_info->body.handlers;
 }
 
+/* Gets the handler ranges for the effective frame handlers, if there are
+ * any and they are up to date. */
+MVM_STATIC_INLINE MVMFrameHandlerRanges * effective_handler_ranges(MVMFrame *f,
+        MVMFrameHandler *fhs) {
+    MVMFrameHandlerRanges *ranges = f->spesh_cand
+        ? f->spesh_cand->handler_ranges
+        : f->static_info->body.handler_ranges;
+    return ranges && ranges->handlers == fhs ? ranges : NULL;
+}
+
 /* Maps ID of exception category to its name. */
 static const char * cat_name(MVMThreadContext *tc, MVMint32 cat) {
     switch (cat) {
@@ -71,6 +81,90 @@ static MVMuint8 in_caller_chain(MVMThreadContext *tc, MVMFrame *f_maybe) {
 }
 
 
+static int cmp_offset(const void *a, const void *b) {
+    MVMuint32 x = *(const MVMuint32 *)a;
+    MVMuint32 y = *(const MVMuint32 *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/* Builds the ranges for a handler table (see MVMFrameHandlerRanges). The
+ * handlers nest, and tables are small, so the quadratic worst case of the
+ * lists is of no concern. Returns NULL if there are no handlers. */
+MVMFrameHandlerRanges * MVM_exception_handler_ranges_build(MVMThreadContext *tc,
+        MVMFrameHandler *handlers, MVMuint32 num_handlers) {
+    MVMFrameHandlerRanges *ranges;
+    MVMuint32 *bounds;
+    MVMuint32 num_bounds = 0, num_ranges = 0, num_indices = 0, i, j;
+    if (!num_handlers)
+        return NULL;
+
+    /* Every handler starts a range, and one starts just after it. */
+    bounds = MVM_malloc(2 * num_handlers * sizeof(MVMuint32));
+    for (i = 0; i < num_handlers; i++) {
+        bounds[num_bounds++] = handlers[i].start_offset;
+        bounds[num_bounds++] = handlers[i].end_offset + 1;
+    }
+    qsort(bounds, num_bounds, sizeof(MVMuint32), cmp_offset);
+    for (i = 0; i < num_bounds; i++)
+        if (i == 0 || bounds[i] != bounds[num_ranges - 1])
+            bounds[num_ranges++] = bounds[i];
+
+    /* A handler covers a range whole if it covers its start. */
+    for (i = 0; i < num_ranges; i++)
+        for (j = 0; j < num_handlers; j++)
+            if (handlers[j].start_offset <= bounds[i] && handlers[j].end_offset >= bounds[i])
+                num_indices++;
+
+    ranges = MVM_malloc(sizeof(MVMFrameHandlerRanges)
+        + (2 * num_ranges + 1 + num_indices) * sizeof(MVMuint32));
+    ranges->handlers       = handlers;
+    ranges->category_union = 0;
+    ranges->num_ranges     = num_ranges;
+    ranges->starts         = (MVMuint32 *)(ranges + 1);
+    ranges->firsts         = ranges->starts + num_ranges;
+    ranges->indices        = ranges->firsts + num_ranges + 1;
+    memcpy(ranges->starts, bounds, num_ranges * sizeof(MVMuint32));
+    MVM_free(bounds);
+    for (j = 0; j < num_handlers; j++)
+        ranges->category_union |= handlers[j].category_mask;
+    num_indices = 0;
+    for (i = 0; i < num_ranges; i++) {
+        ranges->firsts[i] = num_indices;
+        for (j = 0; j < num_handlers; j++)
+            if (handlers[j].start_offset <= ranges->starts[i] && handlers[j].end_offset >= ranges->starts[i])
+                ranges->indices[num_indices++] = j;
+    }
+    ranges->firsts[num_ranges] = num_indices;
+    return ranges;
+}
+
+/* Finds the handlers covering the given offset, in table order; returns a
+ * pointer to their indices and puts their number into num_out. */
+static MVMuint32 * covering_handlers(MVMFrameHandlerRanges *ranges, MVMuint32 pc,
+                                     MVMuint32 *num_out) {
+    MVMuint32 lo = 0, hi = ranges->num_ranges;
+    while (lo < hi) {
+        MVMuint32 mid = lo + (hi - lo) / 2;
+        if (ranges->starts[mid] <= pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0) {
+        *num_out = 0;
+        return ranges->indices;
+    }
+    *num_out = ranges->firsts[lo] - ranges->firsts[lo - 1];
+    return ranges->indices + ranges->firsts[lo - 1];
+}
+
+/* Whether any handler in the ranges may handle the category; this must hold
+ * of the union of the masks if handler_can_handle holds of any of them. */
+static MVMint32 ranges_may_handle(MVMFrameHandlerRanges *ranges, MVMuint32 cat) {
+    MVMuint32 mask = ranges->category_union;
+    return (cat & mask) == cat || ((mask & MVM_EX_CAT_CONTROL) && cat != MVM_EX_CAT_CATCH);
+}
+
 /* Information about a located handler. */
 typedef struct {
     MVMFrame        *frame;
@@ -100,11 +194,14 @@ static MVMint32 search_frame_handlers_dyn(MVMThreadContext *tc, MVMFrame *f,
                                           MVMuint32 cat, MVMObject *payload,
                                           LocatedHandler *lh) {
     MVMuint32  i;
+    MVMFrameHandler       *fhs    = MVM_frame_effective_handlers(f);
+    MVMFrameHandlerRanges *ranges = effective_handler_ranges(f, fhs);
+    if (ranges && !ranges_may_handle(ranges, cat))
+        return 0;
     if (f->spesh_cand && f->spesh_cand->jitcode && f->jit_entry_label) {
         MVMJitCode *jitcode = f->spesh_cand->jitcode;
         void *current_position = MVM_jit_code_get_current_position(tc, jitcode, f);
         MVMJitHandler    *jhs = f->spesh_cand->jitcode->handlers;
-        MVMFrameHandler  *fhs = MVM_frame_effective_handlers(f);
         for (i = MVM_jit_code_get_active_handlers(tc, jitcode, current_position, 0);
              i < jitcode->num_handlers;
              i = MVM_jit_code_get_active_handlers(tc, jitcode, current_position, i+1)) {
@@ -119,13 +216,17 @@ static MVMint32 search_frame_handlers_dyn(MVMThreadContext *tc, MVMFrame *f,
         MVMuint32 num_handlers = f->spesh_cand
             ? f->spesh_cand->num_handlers
             : f->static_info->body.num_handlers;
-        MVMuint32 pc;
+        MVMuint32 pc, j, *covering = NULL;
         if (f == tc->cur_frame)
             pc = (MVMuint32)(*tc->interp_cur_op - *tc->interp_bytecode_start);
         else
             pc = (MVMuint32)(f->return_address - MVM_frame_effective_bytecode(f));
-        for (i = 0; i < num_handlers; i++) {
-            MVMFrameHandler  *fh = &(MVM_frame_effective_handlers(f)[i]);
+        if (ranges)
+            covering = covering_handlers(ranges, pc, &num_handlers);
+        for (j = 0; j < num_handlers; j++) {
+            MVMFrameHandler  *fh;
+            i  = covering ? covering[j] : j;
+            fh = &(fhs[i]);
             if (!handler_can_handle(f, fh, cat, payload))
                 continue;
             if (pc >= fh->start_offset && pc <= fh->end_offset && !in_handler_stack(tc, fh, f)) {
@@ -217,13 +318,18 @@ static MVMint32 search_frame_handlers_lex(MVMThreadContext *tc, MVMFrame *f,
         MVMuint32 num_handlers = f->spesh_cand
             ? f->spesh_cand->num_handlers
             : f->static_info->body.num_handlers;
-        MVMuint32 pc;
+        MVMFrameHandlerRanges *ranges = effective_handler_ranges(f, fhs);
+        MVMuint32 pc, j, *covering = NULL;
         if (f == tc->cur_frame)
             pc = (MVMuint32)(*tc->interp_cur_op - *tc->interp_bytecode_start);
         else
             pc = (MVMuint32)(f->return_address - MVM_frame_effective_bytecode(f));
-        for (i = 0; i < num_handlers; i++) {
-            MVMFrameHandler *fh = &(fhs[i]);
+        if (ranges)
+            covering = covering_handlers(ranges, pc, &num_handlers);
+        for (j = 0; j < num_handlers; j++) {
+            MVMFrameHandler *fh;
+            i  = covering ? covering[j] : j;
+            fh = &(fhs[i]);
             if (skip_all_inlinees && fh->inlinee >= 0)
                 continue;
             if (fh->category_mask == MVM_EX_INLINE_BOUNDARY) {
@@ -333,6 +439,28 @@ static LocatedHandler search_for_handler_from(MVMThreadContext *tc, MVMFrame *f,
  * parameter; if ex_obj is passed, the category is not used). */
 static void unwind_after_handler(MVMThreadContext *tc, void *sr_data);
 static void cleanup_active_handler(MVMThreadContext *tc, void *sr_data);
+
+/* Takes a note of the frames from the origin of the exception on down, and
+ * the offsets they are at, for a backtrace to be made from should it be
+ * asked for. Just the pointers are copied; this doesn't allocate, so the origin
+ * chain can be walked twice. */
+static void capture_backtrace(MVMThreadContext *tc, MVMException *ex) {
+    MVMFrame *f;
+    MVMuint32 num_frames = 0, i = 0;
+    for (f = ex->body.origin; f; f = f->caller)
+        num_frames++;
+    if (!num_frames)
+        return;
+    ex->body.bt_frames  = MVM_malloc(num_frames * (sizeof(MVMFrame *) + sizeof(MVMuint32)));
+    ex->body.bt_offsets = (MVMuint32 *)(ex->body.bt_frames + num_frames);
+    for (f = ex->body.origin; f; f = f->caller, i++) {
+        MVMuint8 *cur_op = i ? f->return_address : ex->body.throw_address;
+        MVM_ASSIGN_REF(tc, &(ex->common.header), ex->body.bt_frames[i], f);
+        ex->body.bt_offsets[i] = cur_op - MVM_frame_effective_bytecode(f);
+    }
+    ex->body.bt_num_frames = num_frames;
+}
+
 static void run_handler(MVMThreadContext *tc, LocatedHandler lh, MVMObject *ex_obj,
                         MVMuint32 category, MVMObject *payload) {
     switch (lh.handler->action) {
@@ -361,7 +489,6 @@ static void run_handler(MVMThreadContext *tc, LocatedHandler lh, MVMObject *ex_o
         /* Create active handler record. */
         MVMActiveHandler *ah = MVM_malloc(sizeof(MVMActiveHandler));
         MVMFrame *cur_frame = tc->cur_frame;
-        MVMFrame *pres_frame;
         MVMObject *handler_code;
 
         /* Ensure we have an exception object. */
@@ -373,13 +500,9 @@ static void run_handler(MVMThreadContext *tc, LocatedHandler lh, MVMObject *ex_o
             MVM_ASSIGN_REF(tc, &(ex_obj->header), ((MVMException *)ex_obj)->body.payload, payload);
         }
 
-        /* Preserve the frame caller chain, so we can do backtraces. */
-        pres_frame = ((MVMException *)ex_obj)->body.origin;
-        while (pres_frame) {
-            MVMFrameExtra *extra = MVM_frame_extra(tc, pres_frame);
-            extra->caller_info_needed = 1;
-            pres_frame = pres_frame->caller;
-        }
+        /* Capture the frames to do backtraces of, if not done already. */
+        if (!((MVMException *)ex_obj)->body.bt_frames)
+            capture_backtrace(tc, (MVMException *)ex_obj);
 
         /* Find frame to invoke. */
         handler_code = MVM_frame_find_invokee(tc, lh.frame->work[lh.handler->block_reg].o, NULL);
@@ -465,15 +588,33 @@ static void cleanup_active_handler(MVMThreadContext *tc, void *sr_data) {
     MVM_free(ah);
 }
 
-char * MVM_exception_backtrace_line(MVMThreadContext *tc, MVMFrame *cur_frame,
-                                    MVMuint16 not_top, MVMuint8 *throw_address) {
+/* Gets the frame at the given position in the backtrace of an exception,
+ * and the bytecode offset it was at, or NULL past the end. Uses the captured
+ * frames if there are any, and otherwise follows the caller chain on from
+ * prev. */
+static MVMFrame * backtrace_frame(MVMException *ex, MVMFrame *prev, MVMuint32 i,
+                                  MVMuint32 *offset_out) {
+    MVMFrame *f;
+    if (ex->body.bt_frames) {
+        if (i >= ex->body.bt_num_frames)
+            return NULL;
+        *offset_out = ex->body.bt_offsets[i];
+        return ex->body.bt_frames[i];
+    }
+    f = i ? prev->caller : ex->body.origin;
+    if (f)
+        *offset_out = (i ? f->return_address : ex->body.throw_address)
+            - MVM_frame_effective_bytecode(f);
+    return f;
+}
+
+static char * backtrace_line_at(MVMThreadContext *tc, MVMFrame *cur_frame,
+                                MVMuint16 not_top, MVMuint32 offset) {
     MVMString *filename = cur_frame->static_info->body.cu->body.filename;
     MVMString *name = cur_frame->static_info->body.name;
     /* XXX TODO: make the caller pass in a char ** and a length pointer so
      * we can update it if necessary, and the caller can cache it. */
     char *o = MVM_malloc(1024);
-    MVMuint8 *cur_op = not_top ? cur_frame->return_address : throw_address;
-    MVMuint32 offset = cur_op - MVM_frame_effective_bytecode(cur_frame);
     MVMBytecodeAnnotation *annot = MVM_bytecode_resolve_annotation(tc, &cur_frame->static_info->body,
                                         offset > 0 ? offset - 1 : 0);
 
@@ -511,21 +652,24 @@ char * MVM_exception_backtrace_line(MVMThreadContext *tc, MVMFrame *cur_frame,
     return o;
 }
 
+char * MVM_exception_backtrace_line(MVMThreadContext *tc, MVMFrame *cur_frame,
+                                    MVMuint16 not_top, MVMuint8 *throw_address) {
+    MVMuint8 *cur_op = not_top ? cur_frame->return_address : throw_address;
+    return backtrace_line_at(tc, cur_frame, not_top,
+        cur_op - MVM_frame_effective_bytecode(cur_frame));
+}
+
 /* Returns a list of hashes containing file, line, sub and annotations. */
 MVMObject * MVM_exception_backtrace(MVMThreadContext *tc, MVMObject *ex_obj) {
     MVMFrame *cur_frame;
     MVMObject *arr = NULL, *annotations = NULL, *row = NULL, *value = NULL;
-    MVMuint32 count = 0;
+    MVMuint32 pos = 0, offset;
     MVMString *k_file = NULL, *k_line = NULL, *k_sub = NULL, *k_anno = NULL;
-    MVMuint8 *throw_address;
 
-    if (IS_CONCRETE(ex_obj) && REPR(ex_obj)->ID == MVM_REPR_ID_MVMException) {
-        cur_frame = ((MVMException *)ex_obj)->body.origin;
-        throw_address = ((MVMException *)ex_obj)->body.throw_address;
-    }
-    else {
+    if (IS_CONCRETE(ex_obj) && REPR(ex_obj)->ID == MVM_REPR_ID_MVMException)
+        cur_frame = backtrace_frame((MVMException *)ex_obj, NULL, pos, &offset);
+    else
         MVM_exception_throw_adhoc(tc, "Op 'backtrace' needs an exception object");
-    }
 
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&arr);
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&annotations);
@@ -536,6 +680,7 @@ MVMObject * MVM_exception_backtrace(MVMThreadContext *tc, MVMObject *ex_obj) {
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&k_sub);
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&k_anno);
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&cur_frame);
+    MVM_gc_root_temp_push(tc, (MVMCollectable **)&ex_obj);
 
     k_file = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "file");
     k_line = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "line");
@@ -545,8 +690,6 @@ MVMObject * MVM_exception_backtrace(MVMThreadContext *tc, MVMObject *ex_obj) {
     arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
 
     while (cur_frame != NULL) {
-        MVMuint8             *cur_op = count ? cur_frame->return_address : throw_address;
-        MVMuint32             offset = cur_op - MVM_frame_effective_bytecode(cur_frame);
         MVMBytecodeAnnotation *annot = MVM_bytecode_resolve_annotation(tc, &cur_frame->static_info->body,
                                             offset > 0 ? offset - 1 : 0);
         MVMuint32             fshi   = annot ? (MVMint32)annot->filename_string_heap_index : -1;
@@ -580,13 +723,12 @@ MVMObject * MVM_exception_backtrace(MVMThreadContext *tc, MVMObject *ex_obj) {
         MVM_repr_push_o(tc, arr, row);
         MVM_free(annot);
 
-        cur_frame = cur_frame->caller;
-        while (cur_frame && cur_frame->static_info->body.is_thunk)
-            cur_frame = cur_frame->caller;
-        count++;
+        do
+            cur_frame = backtrace_frame((MVMException *)ex_obj, cur_frame, ++pos, &offset);
+        while (cur_frame && cur_frame->static_info->body.is_thunk);
     }
 
-    MVM_gc_root_temp_pop_n(tc, 9);
+    MVM_gc_root_temp_pop_n(tc, 10);
 
     return arr;
 }
@@ -594,7 +736,7 @@ MVMObject * MVM_exception_backtrace(MVMThreadContext *tc, MVMObject *ex_obj) {
 /* Returns the lines (backtrace) of an exception-object as an array. */
 MVMObject * MVM_exception_backtrace_strings(MVMThreadContext *tc, MVMObject *ex_obj) {
     MVMException *ex;
-    MVMFrame *cur_frame;
+    MVMFrame *cur_frame = NULL;
     MVMObject *arr;
 
     if (IS_CONCRETE(ex_obj) && REPR(ex_obj)->ID == MVM_REPR_ID_MVMException)
@@ -605,17 +747,16 @@ MVMObject * MVM_exception_backtrace_strings(MVMThreadContext *tc, MVMObject *ex_
     MVMROOT(tc, ex, {
         arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
 
-        cur_frame = ex->body.origin;
-
         MVMROOT2(tc, arr, cur_frame, {
-            MVMuint32 count = 0;
+            MVMuint32 pos = 0;
+            MVMuint32 offset;
+            cur_frame = backtrace_frame(ex, NULL, pos, &offset);
             while (cur_frame != NULL) {
-                char *line = MVM_exception_backtrace_line(tc, cur_frame, count++,
-                    ex->body.throw_address);
+                char *line = backtrace_line_at(tc, cur_frame, pos != 0, offset);
                 MVMString *line_str = MVM_string_utf8_decode(tc, tc->instance->VMString, line, strlen(line));
                 MVMObject *line_obj = MVM_repr_box_str(tc, tc->instance->boot_types.BOOTStr, line_str);
                 MVM_repr_push_o(tc, arr, line_obj);
-                cur_frame = cur_frame->caller;
+                cur_frame = backtrace_frame(ex, cur_frame, ++pos, &offset);
                 MVM_free(line);
             }
         });
@@ -60,6 +60,31 @@ struct MVMFrameHandler {
     MVMint16 inlinee;
 };
 
+/* A frame's handlers grouped by the bytecode ranges they cover, so those
+ * covering an offset are found by a binary search rather than by scanning
+ * the whole table. The boundaries of all the handlers split the bytecode
+ * into ranges; each range lists the handlers covering it, in table order
+ * (and so innermost first). The handler table it was built for is kept, as
+ * instrumentation may swap the table of a static frame. */
+struct MVMFrameHandlerRanges {
+    /* The handler table these are ranges of. */
+    MVMFrameHandler *handlers;
+
+    /* The category masks of all the handlers or'd together, so frames with
+     * no handler of a thrown category can be passed over. */
+    MVMuint32 category_union;
+
+    /* The number of ranges, and the start offset of each (ascending). The
+     * last range starts after the end of every handler, so covers none. */
+    MVMuint32  num_ranges;
+    MVMuint32 *starts;
+
+    /* The indices of the handlers covering range i run from firsts[i] up to
+     * firsts[i + 1] in the indices array. */
+    MVMuint32 *firsts;
+    MVMuint32 *indices;
+};
+
 /* An active (currently executing) exception handler. */
 struct MVMActiveHandler {
     /* The frame the handler was found in. */
@@ -101,6 +126,8 @@ MVMObject * MVM_get_exception_payload(MVMThreadContext *tc, MVMObject *ex);
 void MVM_bind_exception_payload(MVMThreadContext *tc, MVMObject *ex, MVMObject *payload);
 void MVM_bind_exception_category(MVMThreadContext *tc, MVMObject *ex, MVMint32 category);
 void MVM_exception_returnafterunwind(MVMThreadContext *tc, MVMObject *ex);
+MVMFrameHandlerRanges * MVM_exception_handler_ranges_build(MVMThreadContext *tc,
+    MVMFrameHandler *handlers, MVMuint32 num_handlers);
 
 /* Exit codes for panic. */
 #define MVM_exitcode_NYI            12
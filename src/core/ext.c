@@ -164,6 +164,7 @@ int MVM_ext_register_extop(MVMThreadContext *tc, const char *cname,
     entry->discover   = discover;
     entry->no_jit     = flags & MVM_EXTOP_NO_JIT;
     entry->allocating = flags & MVM_EXTOP_ALLOCATING;
+    entry->jit_template = NULL;
 
     MVM_gc_root_add_permanent_desc(tc, (MVMCollectable **)&entry->hash_key,
         "Extension op name hash key");
@@ -173,6 +174,37 @@ int MVM_ext_register_extop(MVMThreadContext *tc, const char *cname,
     return 1;
 }
 
+/* Gives an extension op, which must have been registered already, a template
+ * for the expression JIT, so it can be compiled inline rather than as a call
+ * to its function. The template is usually made from an .expr file by
+ * tools/expr-template-compiler.pl --extops, and must live as long as the VM.
+ * It's only picked up by compilation units that resolve the op after this
+ * is called, so do it right after registering the op. */
+int MVM_ext_register_extop_jit_template(MVMThreadContext *tc, const char *cname,
+        const MVMJitExprTemplate *template) {
+    MVMString *name = MVM_string_ascii_decode_nt(
+            tc, tc->instance->VMString, cname);
+    MVMExtOpRegistry *entry;
+
+    uv_mutex_lock(&tc->instance->mutex_extop_registry);
+    entry = MVM_fixkey_hash_fetch_nocheck(tc, &tc->instance->extop_registry, name);
+    if (!entry) {
+        uv_mutex_unlock(&tc->instance->mutex_extop_registry);
+        MVM_exception_throw_adhoc(tc,
+                "cannot add a JIT template to unregistered extension op %s", cname);
+    }
+    if (!template->constants && memchr(template->info, 'c', template->len)) {
+        uv_mutex_unlock(&tc->instance->mutex_extop_registry);
+        MVM_exception_throw_adhoc(tc,
+                "JIT template of extension op %s uses constants but has no table of them",
+                cname);
+    }
+    entry->jit_template = template;
+    uv_mutex_unlock(&tc->instance->mutex_extop_registry);
+
+    return 1;
+}
+
 const MVMOpInfo * MVM_ext_resolve_extop_record(MVMThreadContext *tc,
         MVMExtOpRecord *record) {
 
@@ -200,6 +232,7 @@ const MVMOpInfo * MVM_ext_resolve_extop_record(MVMThreadContext *tc,
     record->discover   = entry->discover;
     record->no_jit     = entry->no_jit;
     record->allocating = entry->allocating;
+    record->jit_template = entry->jit_template;
 
     uv_mutex_unlock(&tc->instance->mutex_extop_registry);
 
@@ -22,11 +22,14 @@ struct MVMExtOpRegistry {
     MVMExtOpFactDiscover *discover;
     MVMuint32 no_jit;
     MVMuint32 allocating;
+    const MVMJitExprTemplate *jit_template;
 };
 
 int MVM_ext_load(MVMThreadContext *tc, MVMString *lib, MVMString *ext);
 MVM_PUBLIC int MVM_ext_register_extop(MVMThreadContext *tc, const char *cname,
         MVMExtOpFunc func, MVMuint8 num_operands, MVMuint8 operands[],
         MVMExtOpSpesh *spesh, MVMExtOpFactDiscover *discover, MVMuint32 flags);
+MVM_PUBLIC int MVM_ext_register_extop_jit_template(MVMThreadContext *tc, const char *cname,
+        const MVMJitExprTemplate *template);
 const MVMOpInfo * MVM_ext_resolve_extop_record(MVMThreadContext *tc,
         MVMExtOpRecord *record);
@@ -0,0 +1,135 @@
+#include "moar.h"
+
+/* Whether the running code can be suspended as a fiber. It must be a task
+ * run by a scheduler worker, not in a nested runloop (since the C frames of
+ * the outer one can't be captured), and not hold any locks, since those
+ * belong to the thread rather than the fiber. */
+static MVMint32 can_suspend(MVMThreadContext *tc) {
+    return tc->scheduler_worker && !tc->nested_interpreter && tc->thread_entry_frame
+        && !tc->num_locks && !tc->instance->profiling;
+}
+
+/* Captures the running fiber as a continuation, from the current frame down
+ * to the entry frame of the task, to be resumed at the current op. The
+ * active handlers go with it. Much as in continuationcontrol, dynamic
+ * variable caches are cleared, all the more so as the fiber may be resumed
+ * on another thread. */
+static MVMObject * capture(MVMThreadContext *tc, MVMRegister *res_reg) {
+    MVMObject *cont;
+    MVMFrame  *top, *f;
+
+    MVM_jit_code_trampoline(tc);
+    top = MVM_frame_force_to_heap(tc, tc->cur_frame);
+    for (f = top; f; f = f->caller)
+        if (f->extra)
+            f->extra->dynlex_cache_name = NULL;
+    tc->num_dynvar_cache = 0;
+
+    MVMROOT(tc, top, {
+        cont = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTContinuation);
+    });
+    MVM_ASSIGN_REF(tc, &(cont->header), ((MVMContinuation *)cont)->body.top, top);
+    MVM_ASSIGN_REF(tc, &(cont->header), ((MVMContinuation *)cont)->body.root,
+        tc->thread_entry_frame);
+    ((MVMContinuation *)cont)->body.addr            = *tc->interp_cur_op;
+    ((MVMContinuation *)cont)->body.res_reg         = res_reg;
+    ((MVMContinuation *)cont)->body.active_handlers = tc->active_handlers;
+    tc->active_handlers = NULL;
+    return cont;
+}
+
+/* Leaves the thread with no fiber running, after the continuation was handed
+ * elsewhere; the caller then drops out of the runloop. */
+static void detach(MVMThreadContext *tc) {
+    tc->cur_frame          = NULL;
+    tc->thread_entry_frame = NULL;
+}
+
+/* Takes a value from a concurrent blocking queue into the result register.
+ * Returns zero if that was done right away, or if the fiber is suspended
+ * until a value arrives, non-zero, in which case the caller must leave the
+ * runloop. When not running as a fiber, this blocks as shift would. */
+MVMint32 MVM_fiber_await(MVMThreadContext *tc, MVMObject *queue, MVMRegister *res_reg) {
+    MVMObject *cont, *value;
+    if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue || !IS_CONCRETE(queue))
+        MVM_exception_throw_adhoc(tc,
+            "fiberawait requires a concrete object with REPR ConcBlockingQueue");
+
+    if (!can_suspend(tc)) {
+        res_reg->o = MVM_repr_shift_o(tc, queue);
+        return 0;
+    }
+    MVMROOT(tc, queue, {
+        value = MVM_concblockingqueue_poll(tc, (MVMConcBlockingQueue *)queue);
+    });
+    if (!MVM_is_null(tc, value)) {
+        res_reg->o = value;
+        return 0;
+    }
+
+    MVMROOT(tc, queue, {
+        cont = capture(tc, res_reg);
+    });
+    if (MVM_concblockingqueue_fiber_wait(tc, queue, cont, res_reg)) {
+        detach(tc);
+        return 1;
+    }
+
+    /* A value arrived after all, so carry on, putting things back as they
+     * were; the continuation is never used. */
+    MVM_store(&((MVMContinuation *)cont)->body.invoked, 1);
+    tc->active_handlers = ((MVMContinuation *)cont)->body.active_handlers;
+    ((MVMContinuation *)cont)->body.active_handlers = NULL;
+    return 0;
+}
+
+/* Lets the other tasks waiting for the scheduler run, queueing the running
+ * fiber up behind them. Returns non-zero if the caller must leave the
+ * runloop, and zero if not running as a fiber, in which case nothing is
+ * done. */
+MVMint32 MVM_fiber_yield(MVMThreadContext *tc) {
+    MVMObject *cont;
+    if (!can_suspend(tc))
+        return 0;
+    cont = capture(tc, NULL);
+    MVM_scheduler_requeue(tc, cont, 1);
+    detach(tc);
+    return 1;
+}
+
+/* Hands a suspended fiber back to the scheduler, with the value it was
+ * waiting for. */
+void MVM_fiber_wake(MVMThreadContext *tc, MVMObject *cont, MVMObject *value) {
+    MVMContinuationBody *body = &((MVMContinuation *)cont)->body;
+    if (!MVM_trycas(&body->invoked, 0, 1))
+        MVM_panic(1, "Tried to wake a fiber more than once");
+    if (body->res_reg) {
+        body->res_reg->o = value;
+        MVM_gc_write_barrier(tc, &(body->top->header), &(value->header));
+    }
+    MVM_scheduler_requeue(tc, cont, 0);
+}
+
+/* Runs a fiber that was handed back to the scheduler, picking up where it
+ * left off, until it is suspended again or the task is done. */
+static void resume_invoke(MVMThreadContext *tc, void *data) {
+    MVMContinuationBody *body = &((MVMContinuation *)*(MVMObject **)data)->body;
+    tc->cur_frame        = body->top;
+    tc->current_frame_nr = body->top->sequence_nr;
+    *(tc->interp_cur_op)         = body->addr;
+    *(tc->interp_bytecode_start) = MVM_frame_effective_bytecode(tc->cur_frame);
+    *(tc->interp_reg_base)       = tc->cur_frame->work;
+    *(tc->interp_cu)             = tc->cur_frame->static_info->body.cu;
+    tc->active_handlers    = body->active_handlers;
+    body->active_handlers  = NULL;
+    tc->thread_entry_frame = body->root;
+    body->top  = NULL;
+    body->root = NULL;
+}
+void MVM_fiber_resume(MVMThreadContext *tc, MVMObject *cont) {
+    /* Fibers yielding don't go through wake, so claim those here. */
+    MVM_trycas(&((MVMContinuation *)cont)->body.invoked, 0, 1);
+    MVMROOT(tc, cont, {
+        MVM_interp_run(tc, resume_invoke, &cont, NULL);
+    });
+}
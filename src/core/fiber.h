@@ -0,0 +1,9 @@
+/* Fibers are the tasks run by the work-stealing scheduler. Rather than block
+ * the worker thread, a fiber waiting on an empty queue is suspended as a
+ * continuation reaching down to its entry frame, and the worker moves on to
+ * other tasks. The continuation is handed back to the scheduler, along with
+ * the value it waited for, when something is pushed to the queue. */
+MVMint32 MVM_fiber_await(MVMThreadContext *tc, MVMObject *queue, MVMRegister *res_reg);
+MVMint32 MVM_fiber_yield(MVMThreadContext *tc);
+void MVM_fiber_wake(MVMThreadContext *tc, MVMObject *cont, MVMObject *value);
+void MVM_fiber_resume(MVMThreadContext *tc, MVMObject *cont);
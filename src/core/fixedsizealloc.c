@@ -120,12 +120,42 @@ static void add_page(MVMFixedSizeAlloc *al, MVMuint32 bin) {
     al->size_classes[bin].cur_page = cur_page;
 }
 
+/* Tries to put a magazine into an empty slot of a size class's depot; returns
+ * non-zero if it managed. Threads start looking at different slots, so they
+ * don't all fight over the first few. */
+static MVMuint32 deposit_magazine(MVMThreadContext *tc, MVMFixedSizeAllocSizeClass *bin_ptr,
+                                  MVMFixedSizeAllocFreeListEntry *magazine) {
+    MVMuint32 start = tc->thread_id % MVM_FSA_DEPOT_SLOTS;
+    MVMuint32 i;
+    for (i = 0; i < MVM_FSA_DEPOT_SLOTS; i++) {
+        MVMuint32 slot = (start + i) % MVM_FSA_DEPOT_SLOTS;
+        if (!bin_ptr->depot[slot] && MVM_trycas(&(bin_ptr->depot[slot]), NULL, magazine))
+            return 1;
+    }
+    return 0;
+}
+
+/* Tries to take a magazine from a size class's depot, returning NULL if it is
+ * empty. */
+static MVMFixedSizeAllocFreeListEntry * withdraw_magazine(MVMThreadContext *tc,
+                                                          MVMFixedSizeAllocSizeClass *bin_ptr) {
+    MVMuint32 start = tc->thread_id % MVM_FSA_DEPOT_SLOTS;
+    MVMuint32 i;
+    for (i = 0; i < MVM_FSA_DEPOT_SLOTS; i++) {
+        MVMuint32 slot = (start + i) % MVM_FSA_DEPOT_SLOTS;
+        MVMFixedSizeAllocFreeListEntry *magazine = bin_ptr->depot[slot];
+        if (magazine && MVM_trycas(&(bin_ptr->depot[slot]), magazine, NULL))
+            return magazine;
+    }
+    return NULL;
+}
+
 /* Allocates a piece of memory of the specified size, using the FSA. */
 static void * alloc_slow_path(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMuint32 bin) {
     void *result;
 
     /* Lock. */
-    uv_mutex_lock(&(al->complex_alloc_mutex));
+    MVM_lock_contention_lock(tc, &(al->complex_alloc_mutex), "fixed size allocator");
 
     /* If we've no pages yet, never encountered this bin; set it up. */
     if (al->size_classes[bin].pages == NULL)
@@ -168,6 +198,7 @@ static void * alloc_from_global(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVM
     MVM_barrier();
     al->freelist_spin = 0;
     if (fle) {
+        MVM_decr(&(bin_ptr->free_list_items));
         VALGRIND_MEMPOOL_ALLOC(&al->size_classes[bin], ((void *)fle),
                 (bin + 1) << MVM_FSA_BIN_BITS);
         return (void *)fle;
@@ -198,6 +229,15 @@ void * MVM_fixed_size_alloc(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t
             bin_ptr->items--;
             return (void *)fle;
         }
+
+        /* Otherwise, see if there's a magazine we can take in its entirety
+         * to refill the per-thread free list. */
+        fle = withdraw_magazine(tc, &(al->size_classes[bin]));
+        if (fle) {
+            bin_ptr->free_list = fle->next;
+            bin_ptr->items = MVM_FSA_MAGAZINE_ITEMS - 1;
+            return (void *)fle;
+        }
         return alloc_from_global(tc, al, bin);
     }
     return MVM_malloc(bytes);
@@ -258,6 +298,35 @@ void * MVM_fixed_size_realloc_at_safepoint(MVMThreadContext *tc, MVMFixedSizeAll
 #endif
 }
 
+/* Keeps count of the items on a bin's global free list. */
+static void count_global_free(MVMFixedSizeAllocSizeClass *bin_ptr, MVMuint32 added) {
+    AO_t items = MVM_add(&(bin_ptr->free_list_items), added) + added;
+    if (items > bin_ptr->free_list_items_hwm)
+        bin_ptr->free_list_items_hwm = items;
+}
+
+/* Adds a chain of free list entries to the global free list for a bin in one
+ * go. Pushing is safe without the spin lock; only taking needs it. */
+static void add_chain_to_global_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
+        MVMint32 bin, MVMFixedSizeAllocFreeListEntry *first, MVMFixedSizeAllocFreeListEntry *last) {
+    MVMFixedSizeAllocSizeClass     *bin_ptr = &(al->size_classes[bin]);
+    MVMFixedSizeAllocFreeListEntry *orig;
+#ifdef MVM_VALGRIND_SUPPORT
+    MVMFixedSizeAllocFreeListEntry *cur = first;
+    while (cur) {
+        MVMFixedSizeAllocFreeListEntry *next = cur->next;
+        VALGRIND_MEMPOOL_FREE(bin_ptr, cur);
+        VALGRIND_MAKE_MEM_DEFINED(cur, sizeof(MVMFixedSizeAllocFreeListEntry));
+        cur = next;
+    }
+#endif
+    do {
+        orig = bin_ptr->free_list;
+        last->next = orig;
+    } while (!MVM_trycas(&(bin_ptr->free_list), orig, first));
+    count_global_free(bin_ptr, MVM_FSA_MAGAZINE_ITEMS);
+}
+
 /* Frees a piece of memory of the specified size, using the FSA. */
 static void add_to_global_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
                                        MVMint32 bin, void *to_free) {
@@ -273,19 +342,29 @@ static void add_to_global_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *
         orig = bin_ptr->free_list;
         to_add->next = orig;
     } while (!MVM_trycas(&(bin_ptr->free_list), orig, to_add));
+    count_global_free(bin_ptr, 1);
 }
 static void add_to_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
                                 MVMint32 bin, void *to_free) {
     MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(tc->thread_fsa->size_classes[bin]);
-    if (bin_ptr->items < MVM_FSA_THREAD_FREELIST_LIMIT) {
-        MVMFixedSizeAllocFreeListEntry *to_add  = (MVMFixedSizeAllocFreeListEntry *)to_free;
-        to_add->next = bin_ptr->free_list;
-        bin_ptr->free_list = to_add;
-        bin_ptr->items++;
-    }
-    else {
-        add_to_global_bin_freelist(tc, al, bin, to_free);
+    MVMFixedSizeAllocFreeListEntry   *to_add  = (MVMFixedSizeAllocFreeListEntry *)to_free;
+    if (bin_ptr->items >= MVM_FSA_THREAD_FREELIST_LIMIT) {
+        /* The thread's list is full, so split a magazine off the front of it
+         * and hand that to the global allocator, preferably to the depot. */
+        MVMFixedSizeAllocFreeListEntry *magazine = bin_ptr->free_list;
+        MVMFixedSizeAllocFreeListEntry *last     = magazine;
+        MVMuint32 i;
+        for (i = 1; i < MVM_FSA_MAGAZINE_ITEMS; i++)
+            last = last->next;
+        bin_ptr->free_list = last->next;
+        bin_ptr->items -= MVM_FSA_MAGAZINE_ITEMS;
+        last->next = NULL;
+        if (!deposit_magazine(tc, &(al->size_classes[bin]), magazine))
+            add_chain_to_global_bin_freelist(tc, al, bin, magazine, last);
     }
+    to_add->next = bin_ptr->free_list;
+    bin_ptr->free_list = to_add;
+    bin_ptr->items++;
 }
 void MVM_fixed_size_free(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t bytes, void *to_free) {
 #if FSA_SIZE_DEBUG
@@ -421,3 +500,82 @@ void MVM_fixed_size_destroy_thread(MVMThreadContext *tc) {
     MVM_free(al->size_classes);
     MVM_free(al);
 }
+
+/* Fills out the statistics for a bin (see MVM_FSA_STATS_FIELDS for what they
+ * are). The per-thread counts are read without synchronization, since they
+ * are only changed by their own threads; this is fine for the purpose. */
+void MVM_fixed_size_bin_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMuint32 bin, MVMint64 *stats) {
+    MVMFixedSizeAllocSizeClass *bin_ptr = &(al->size_classes[bin]);
+    MVMuint32 item_size = (bin + 1) << MVM_FSA_BIN_BITS;
+    MVMuint32 slot_size = item_size + 2 * MVM_FSA_REDZONE_BYTES;
+    MVMThread *cur_thread;
+    MVMuint32 i;
+
+    stats[MVM_FSA_STATS_ITEM_SIZE] = item_size;
+
+    uv_mutex_lock(&(al->complex_alloc_mutex));
+    stats[MVM_FSA_STATS_PAGES] = bin_ptr->num_pages;
+    stats[MVM_FSA_STATS_CARVED_ITEMS] = bin_ptr->num_pages
+        ? (MVMint64)bin_ptr->cur_page * MVM_FSA_PAGE_ITEMS
+            + (bin_ptr->alloc_pos - bin_ptr->pages[bin_ptr->cur_page]) / slot_size
+        : 0;
+    uv_mutex_unlock(&(al->complex_alloc_mutex));
+
+    stats[MVM_FSA_STATS_FREE_LIST_ITEMS] = MVM_load(&(bin_ptr->free_list_items));
+    stats[MVM_FSA_STATS_FREE_LIST_HWM] = MVM_load(&(bin_ptr->free_list_items_hwm));
+
+    stats[MVM_FSA_STATS_DEPOT_ITEMS] = 0;
+    for (i = 0; i < MVM_FSA_DEPOT_SLOTS; i++)
+        if (MVM_load(&(bin_ptr->depot[i])))
+            stats[MVM_FSA_STATS_DEPOT_ITEMS] += MVM_FSA_MAGAZINE_ITEMS;
+
+    stats[MVM_FSA_STATS_THREAD_ITEMS] = 0;
+    uv_mutex_lock(&(tc->instance->mutex_threads));
+    cur_thread = tc->instance->threads;
+    while (cur_thread) {
+        MVMThreadContext *thread_tc = cur_thread->body.tc;
+        if (thread_tc && thread_tc->thread_fsa)
+            stats[MVM_FSA_STATS_THREAD_ITEMS] += thread_tc->thread_fsa->size_classes[bin].items;
+        cur_thread = cur_thread->body.next;
+    }
+    uv_mutex_unlock(&(tc->instance->mutex_threads));
+}
+
+/* Puts the statistics for all bins into a native integer array, with
+ * MVM_FSA_STATS_FIELDS entries per bin. */
+void MVM_fixed_size_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMObject *result) {
+    MVMint64 stats[MVM_FSA_STATS_FIELDS];
+    MVMuint32 bin, i;
+    if (REPR(result)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(result) ||
+            ((MVMArrayREPRData *)STABLE(result)->REPR_data)->slot_type != MVM_ARRAY_I64) {
+        MVM_exception_throw_adhoc(tc, "fsastats needs a concrete 64bit int array.");
+    }
+    for (bin = 0; bin < MVM_FSA_BINS; bin++) {
+        MVM_fixed_size_bin_stats(tc, al, bin, stats);
+        for (i = 0; i < MVM_FSA_STATS_FIELDS; i++)
+            MVM_repr_bind_pos_i(tc, result, bin * MVM_FSA_STATS_FIELDS + i, stats[i]);
+    }
+}
+
+/* Writes the statistics of the bins in use into the telemetry log. This is
+ * called on every full GC run, so shows how things change over time. */
+void MVM_fixed_size_telemetry(MVMThreadContext *tc, MVMFixedSizeAlloc *al) {
+    MVMint64 stats[MVM_FSA_STATS_FIELDS];
+    MVMuint32 bin;
+    unsigned int interval_id = MVM_telemetry_interval_start(tc, "fixed size allocator stats");
+    if (!interval_id)
+        return;
+    for (bin = 0; bin < MVM_FSA_BINS; bin++) {
+        if (!al->size_classes[bin].pages)
+            continue;
+        MVM_fixed_size_bin_stats(tc, al, bin, stats);
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_ITEM_SIZE], interval_id, "bin item size");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_PAGES], interval_id, "pages");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_CARVED_ITEMS], interval_id, "carved items");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_FREE_LIST_ITEMS], interval_id, "global free list items");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_FREE_LIST_HWM], interval_id, "global free list high-water mark");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_DEPOT_ITEMS], interval_id, "depot items");
+        MVM_telemetry_interval_annotate(stats[MVM_FSA_STATS_THREAD_ITEMS], interval_id, "thread cached items");
+    }
+    MVM_telemetry_interval_stop(tc, interval_id, "fixed size allocator stats");
+}
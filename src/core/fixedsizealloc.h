@@ -1,3 +1,10 @@
+/* The number of items in a magazine, which is a chain of free list entries
+ * that is moved between a thread and the global pool as a unit. */
+#define MVM_FSA_MAGAZINE_ITEMS  256
+
+/* The number of magazines each size class's depot can hold. */
+#define MVM_FSA_DEPOT_SLOTS     32
+
 /* The global, top-level data structure for the fixed size allocator. */
 struct MVMFixedSizeAlloc {
     /* Size classes for the fixed size allocator. Each one represents a bunch
@@ -52,14 +59,29 @@ struct MVMFixedSizeAllocSizeClass {
 
     /* Head of the "free at next safepoint" list. */
     MVMFixedSizeAllocSafepointFreeListEntry *free_at_next_safepoint_list;
+
+    /* The depot of full magazines. Each slot is either NULL or the head of a
+     * chain of exactly MVM_FSA_MAGAZINE_ITEMS entries. Threads put in and
+     * take out whole magazines with a single CAS on a slot; since nothing is
+     * read through the slot before the CAS, there is no ABA problem and so
+     * no need for the spin lock. The free_list above is only used when the
+     * depot is full. */
+    MVMFixedSizeAllocFreeListEntry *depot[MVM_FSA_DEPOT_SLOTS];
+
+    /* How many items are on the free_list, and the most there have been.
+     * Only kept for statistics; the high-water mark is updated without any
+     * care for races, so is approximate. */
+    AO_t free_list_items;
+    AO_t free_list_items_hwm;
 };
 
 /* The per-thread data structure for the fixed size allocator, hung off the
  * thread context. Holds a free list per size bin. Allocations on the thread
  * will preferentially use the thread free list, and threads will free to
  * their own free lists, up to a length limit. On hitting the limit, they
- * will free back to the global allocator. This helps ensure patterns like
- * producer/consumer don't end up with a "leak". */
+ * will free a magazine's worth back to the global allocator, and when they
+ * run out they try to take a magazine from it. This helps ensure patterns
+ * like producer/consumer don't end up with a "leak". */
 struct MVMFixedSizeAllocThread {
     MVMFixedSizeAllocThreadSizeClass *size_classes;
 };
@@ -94,6 +116,18 @@ struct MVMFixedSizeAllocThreadSizeClass {
 /* The length limit for the per-thread free list. */
 #define MVM_FSA_THREAD_FREELIST_LIMIT   1024
 
+/* Statistics about each bin are reported as this many integers, in this
+ * order. The carved items are those that have ever been handed out from the
+ * pages, and so the high-water mark of items in use. */
+#define MVM_FSA_STATS_ITEM_SIZE         0
+#define MVM_FSA_STATS_PAGES             1
+#define MVM_FSA_STATS_CARVED_ITEMS      2
+#define MVM_FSA_STATS_FREE_LIST_ITEMS   3
+#define MVM_FSA_STATS_FREE_LIST_HWM     4
+#define MVM_FSA_STATS_DEPOT_ITEMS       5
+#define MVM_FSA_STATS_THREAD_ITEMS      6
+#define MVM_FSA_STATS_FIELDS            7
+
 /* Functions. */
 MVMFixedSizeAlloc * MVM_fixed_size_create(MVMThreadContext *tc);
 void MVM_fixed_size_create_thread(MVMThreadContext *tc);
@@ -106,3 +140,6 @@ void MVM_fixed_size_destroy_thread(MVMThreadContext *tc);
 void MVM_fixed_size_free(MVMThreadContext *tc, MVMFixedSizeAlloc *fsa, size_t bytes, void *free);
 void MVM_fixed_size_free_at_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *fsa, size_t bytes, void *free);
 void MVM_fixed_size_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *al);
+void MVM_fixed_size_bin_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMuint32 bin, MVMint64 *stats);
+void MVM_fixed_size_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMObject *result);
+void MVM_fixed_size_telemetry(MVMThreadContext *tc, MVMFixedSizeAlloc *al);
@@ -30,8 +30,7 @@ void MVM_fixkey_hash_demolish(MVMThreadContext *tc, MVMFixKeyHashTable *hashtabl
     }
 
     if (hashtable->metadata) {
-        MVM_free(hashtable->entries);
-        MVM_free(metadata - 1);
+        MVM_hash_free_storage(hashtable->entries, hashtable->metadata);
     }
 }
 /* and then free memory if you allocated it */
@@ -40,8 +39,8 @@ void MVM_fixkey_hash_demolish(MVMThreadContext *tc, MVMFixKeyHashTable *hashtabl
 MVM_STATIC_INLINE void hash_allocate_common(MVMFixKeyHashTable *hashtable) {
     hashtable->max_items = hashtable->official_size * FIXKEY_LOAD_FACTOR;
     size_t actual_items = hash_true_size(hashtable);
-    hashtable->entries = MVM_malloc(sizeof(MVMString ***) * actual_items);
-    hashtable->metadata = MVM_calloc(1 + actual_items + 1, 1);
+    hashtable->metadata = MVM_hash_allocate_storage(&hashtable->entries,
+        sizeof(MVMString ***) * actual_items, 1 + actual_items + 1);
     /* A sentinel. This marks an occupied slot, at its ideal position. */
     *hashtable->metadata = 1;
     ++hashtable->metadata;
@@ -205,8 +204,7 @@ void *MVM_fixkey_hash_lvalue_fetch_nocheck(MVMThreadContext *tc,
             ++metadata;
             entry_raw += sizeof(MVMString ***);
         }
-        MVM_free(entry_raw_orig);
-        MVM_free(metadata_orig - 1);
+        MVM_hash_free_storage(entry_raw_orig, metadata_orig);
     }
     MVMString ***indirection = hash_insert_internal(tc, hashtable, key);
     if (!*indirection) {
@@ -17,6 +17,14 @@ MVMRegister * MVM_frame_initial_work(MVMThreadContext *tc, MVMuint16 *local_type
     return work_initial;
 }
 
+/* Whether the name is that of a dynamic variable, with the * twigil. Only
+ * those go into the thread's dynamic variable cache, since only frames that
+ * declare them must be looked out for as shadowing cached ones. */
+static MVMint32 is_dynamic_name(MVMThreadContext *tc, MVMString *name) {
+    return MVM_string_graphs_nocheck(tc, name) > 1
+        && MVM_string_get_grapheme_at_nocheck(tc, name, 1) == '*';
+}
+
 /* Takes a static frame and does various one-off calculations about what
  * space it shall need. Also triggers bytecode verification of the frame's
  * bytecode. */
@@ -52,10 +60,21 @@ static void prepare_and_verify_static_frame(MVMThreadContext *tc, MVMStaticFrame
         static_frame_body->work_size = sizeof(MVMRegister) *
             (static_frame_body->num_locals + static_frame_body->cu->body.max_callsite_size);
 
-        /* Validate the bytecode. */
-        MVMROOT(tc, static_frame, {
-            MVM_validate_static_frame(tc, static_frame);
-        });
+        /* Validate the bytecode, unless it's trusted. Validation is also
+         * what finds out if the frame has anything worth specializing, so
+         * assume it does. (On big endian platforms validation also puts
+         * the bytecode into our byte order, so we can't skip it.) */
+#ifndef MVM_BIGENDIAN
+        if (cu->body.trusted) {
+            static_frame_body->specializable = 1;
+        }
+        else
+#endif
+        {
+            MVMROOT(tc, static_frame, {
+                MVM_validate_static_frame(tc, static_frame);
+            });
+        }
 
         /* Compute work area initial state that we can memcpy into place each
          * time. */
@@ -64,6 +83,10 @@ static void prepare_and_verify_static_frame(MVMThreadContext *tc, MVMStaticFrame
                 static_frame_body->local_types,
                 static_frame_body->num_locals);
 
+        /* Group the handlers by the bytecode ranges they cover. */
+        static_frame_body->handler_ranges = MVM_exception_handler_ranges_build(tc,
+            static_frame_body->handlers, static_frame_body->num_handlers);
+
         /* Check if we have any state var lexicals. */
         if (static_frame_body->static_env_flags) {
             MVMuint8 *flags  = static_frame_body->static_env_flags;
@@ -76,6 +99,18 @@ static void prepare_and_verify_static_frame(MVMThreadContext *tc, MVMStaticFrame
                 }
         }
 
+        /* Check if we declare any dynamic variables, which may shadow those
+         * in the thread's dynamic variable cache. */
+        {
+            MVMString **names = static_frame_body->lexical_names_list;
+            MVMuint32   i;
+            for (i = 0; i < static_frame_body->num_lexicals; i++)
+                if (is_dynamic_name(tc, names[i])) {
+                    static_frame_body->has_dynamic_lexicals = 1;
+                    break;
+                }
+        }
+
         /* Allocate the frame's spesh data structure; do it in gen2, both for
          * the sake of not triggering GC here to avoid a deadlock risk, but
          * also because then it can be ssigned into the gen2 static frame
@@ -99,13 +134,16 @@ static void prepare_and_verify_static_frame(MVMThreadContext *tc, MVMStaticFrame
  * profiling. */
 static void instrumentation_level_barrier(MVMThreadContext *tc, MVMStaticFrame *static_frame) {
     MVMCompUnit *cu = static_frame->body.cu;
+    MVMint32 prepared = 0;
     MVMROOT(tc, static_frame, {
         /* Obtain mutex, so we don't end up with instrumentation races. */
         MVM_reentrantmutex_lock(tc, (MVMReentrantMutex *)cu->body.deserialize_frame_mutex);
 
         /* Prepare and verify if needed. */
-        if (static_frame->body.instrumentation_level == 0)
+        if (static_frame->body.instrumentation_level == 0) {
             prepare_and_verify_static_frame(tc, static_frame);
+            prepared = 1;
+        }
 
         /* Re-check instrumentation level in case of races. */
         if (static_frame->body.instrumentation_level != tc->instance->instrumentation_level) {
@@ -124,12 +162,25 @@ static void instrumentation_level_barrier(MVMThreadContext *tc, MVMStaticFrame *
                  * again at some point, a solution for this problem must be found. */
                 MVM_profile_ensure_uninstrumented(tc, static_frame);
 
+            /* Instrumentation swaps in a handler table of its own. */
+            if (static_frame->body.handler_ranges
+                    && static_frame->body.handler_ranges->handlers != static_frame->body.handlers) {
+                MVM_free_at_safepoint(tc, static_frame->body.handler_ranges);
+                static_frame->body.handler_ranges = MVM_exception_handler_ranges_build(tc,
+                    static_frame->body.handlers, static_frame->body.num_handlers);
+            }
+
             /* Mark frame as being at the current instrumentation level. */
             static_frame->body.instrumentation_level = tc->instance->instrumentation_level;
         }
 
         /* Release the lock. */
         MVM_reentrantmutex_unlock(tc, (MVMReentrantMutex *)cu->body.deserialize_frame_mutex);
+
+        /* Have any specializations remembered from an earlier run produced
+         * now that the frame is ready. */
+        if (prepared && (tc->instance->spesh_cache || tc->instance->spesh_code_cache_dir))
+            MVM_spesh_cache_frame_prepared(tc, static_frame);
     });
 }
 
@@ -487,6 +538,15 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
         }
     }
 
+    /* Only a local closure has an outer on the call stack. A frame allocated
+     * on the heap must not point into the stack, so then its outer goes to
+     * the heap too (as will the rest of the stack anyway). */
+    if (outer && MVM_FRAME_IS_ON_CALLSTACK(tc, outer) && static_frame->body.allocate_on_heap) {
+        MVMROOT2(tc, static_frame, code_ref, {
+            outer = MVM_frame_move_to_heap(tc, outer);
+        });
+    }
+
     /* See if any specializations apply. */
     spesh = static_frame->body.spesh;
     if (spesh_cand < 0)
@@ -506,8 +566,23 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
         }
     }
 #endif
+
+    /* A baseline candidate produces no spesh logs, yet is only there until
+     * the frame has been logged enough to be specialized properly; so while
+     * recording, now and then run the unspecialized code instead. */
+    if (spesh_cand >= 0 && tc->spesh_log) {
+        MVMSpeshCandidate *cand = spesh->body.spesh_candidates[spesh_cand];
+        if (cand->is_baseline
+                && spesh->body.spesh_entries_recorded < MVM_SPESH_LOG_LOGGED_ENOUGH
+                && cand->uses % MVM_SPESH_BASELINE_LOG_INTERVAL == 0) {
+            cand->uses++;
+            spesh_cand = -1;
+        }
+    }
+
     if (spesh_cand >= 0) {
         MVMSpeshCandidate *chosen_cand = spesh->body.spesh_candidates[spesh_cand];
+        chosen_cand->uses++;
         if (static_frame->body.allocate_on_heap) {
             MVMROOT3(tc, static_frame, code_ref, outer, {
                 frame = allocate_frame(tc, static_frame, chosen_cand, 1);
@@ -544,8 +619,10 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
 
         /* If we should be spesh logging, set the correlation ID. */
         if (tc->instance->spesh_enabled && tc->spesh_log && static_frame->body.bytecode_size < MVM_SPESH_MAX_BYTECODE_SIZE) {
-            if (spesh->body.spesh_entries_recorded++ < MVM_SPESH_LOG_LOGGED_ENOUGH) {
+            if (spesh->body.spesh_entries_recorded < MVM_SPESH_LOG_LOGGED_ENOUGH
+                    && MVM_spesh_log_sample(tc)) {
                 MVMint32 id = ++tc->spesh_cid;
+                spesh->body.spesh_entries_recorded++;
                 frame->spesh_correlation_id = id;
                 MVMROOT3(tc, static_frame, code_ref, outer, {
                     if (on_heap) {
@@ -569,6 +646,12 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
     /* Outer. */
     frame->outer = outer;
 
+    /* A frame declaring dynamic variables, or with inlines that do, may
+     * shadow those found by earlier lookups. */
+    if (tc->num_dynvar_cache && (static_frame->body.has_dynamic_lexicals
+            || (frame->spesh_cand && frame->spesh_cand->inlines_dynamics)))
+        tc->num_dynvar_cache = 0;
+
     /* Initialize argument processing. */
     MVM_args_proc_init(tc, &frame->params, callsite, args);
 
@@ -583,6 +666,11 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
     *(tc->interp_reg_base) = frame->work;
     *(tc->interp_cu) = static_frame->body.cu;
 
+    /* Take a CPU sample if the sampling timer ticked since this thread last
+     * did; this is on every call, so must stay this cheap. */
+    if (MVM_UNLIKELY(tc->cpu_sample_epoch != MVM_load(&tc->instance->cpu_sample_epoch)))
+        MVM_profile_cpu_sample(tc);
+
     /* If we need to do so, make clones of things in the lexical environment
      * that need it. Note that we do this after tc->cur_frame became the
      * current frame, to make sure these new objects will certainly get
@@ -636,11 +724,44 @@ void MVM_frame_invoke(MVMThreadContext *tc, MVMStaticFrame *static_frame,
     }
 }
 
-/* Moves the specified frame from the stack and on to the heap. Must only
- * be called if the frame is not already there. Use MVM_frame_force_to_heap
- * when not sure. */
-MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
-    /* To keep things simple, we'll promote the entire stack. */
+/* Local closures (see MVM_frame_takeclosure_local) have a frame on the call
+ * stack as their outer, and so do any frames made by invoking them. When such
+ * an outer is promoted to the heap, this points the frames already promoted
+ * in the same pass, from above down to promoted, and the closures at its new
+ * home. When it leaves the call stack for good, promoted is NULL, and such
+ * closures are left without an outer; nothing can reach them any more, but
+ * the GC may still look at them. Either way, they stop being local. */
+static void update_local_outers(MVMThreadContext *tc, MVMThreadContext *owner,
+                                MVMFrame *above, MVMFrame *old, MVMFrame *promoted) {
+    MVMuint32 i, kept = 0;
+    while (above && above != promoted) {
+        if (above->outer == old) {
+            MVM_ASSIGN_REF(tc, &(above->header), above->outer, promoted);
+        }
+        above = above->caller;
+    }
+    for (i = 0; i < owner->num_local_closures; i++) {
+        MVMCode *closure = owner->local_closures[i];
+        if (closure->body.outer != old) {
+            owner->local_closures[kept++] = closure;
+        }
+        else if (promoted) {
+            MVM_ASSIGN_REF(tc, &(closure->common.header), closure->body.outer, promoted);
+        }
+        else {
+            closure->body.outer = NULL;
+        }
+    }
+    owner->num_local_closures = kept;
+}
+
+/* Promotes the frames on the stack from the current one down, until either
+ * a frame already on the heap or, if one is given, the stop frame has been
+ * promoted. The promoted stop frame is left with no caller, and put into
+ * stop_out. Returns the new current frame, and puts the promoted version of
+ * the frame asked for into result_out. */
+static MVMFrame * promote_chain(MVMThreadContext *tc, MVMFrame *frame, MVMFrame *stop,
+                                MVMFrame **result_out, MVMFrame **stop_out) {
     MVMFrame *cur_to_promote = tc->cur_frame;
     MVMFrame *new_cur_frame = NULL;
     MVMFrame *update_caller = NULL;
@@ -688,6 +809,13 @@ MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
                 new_cur_frame = promoted;
             }
 
+            /* If local closures may have it as their outer, update them. */
+            if (tc->num_local_closures)
+                update_local_outers(tc, tc, new_cur_frame, cur_to_promote, promoted);
+
+            /* The dynamic variable cache may point into it. */
+            tc->num_dynvar_cache = 0;
+
             /* If the frame we're promoting was in the active handlers list,
              * update the address there. */
             if (tc->active_handlers) {
@@ -704,9 +832,18 @@ MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
             if (cur_to_promote == frame)
                 result = promoted;
 
+            /* Stop at the stop frame, if we were given one. */
+            if (cur_to_promote == stop) {
+                promoted->caller = NULL;
+                *stop_out = promoted;
+                if (cur_to_promote == tc->thread_entry_frame)
+                    tc->thread_entry_frame = promoted;
+                cur_to_promote = NULL;
+            }
+
             /* Check if there's a caller, or if we reached the end of the
              * chain. */
-            if (cur_to_promote->caller) {
+            else if (cur_to_promote->caller) {
                 /* If the caller is on the stack then it needs promotion too.
                  * If not, we're done. */
                 if (MVM_FRAME_IS_ON_CALLSTACK(tc, cur_to_promote->caller)) {
@@ -733,6 +870,17 @@ MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
         }
     });
     MVM_CHECK_CALLER_CHAIN(tc, new_cur_frame);
+    *result_out = result;
+    return new_cur_frame;
+}
+
+/* Moves the specified frame from the stack and on to the heap. Must only
+ * be called if the frame is not already there. Use MVM_frame_force_to_heap
+ * when not sure. */
+MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
+    /* To keep things simple, we'll promote the entire stack. */
+    MVMFrame *result;
+    MVMFrame *new_cur_frame = promote_chain(tc, frame, NULL, &result, NULL);
 
     /* All is promoted. Update thread's current frame and reset the thread
      * local callstack. */
@@ -745,6 +893,42 @@ MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
     return result;
 }
 
+/* Moves the frames from the current one down to and including root, which
+ * must be on the stack, to the heap, leaving the frames below it on the
+ * stack as they are. This is for capturing continuations, which cut the
+ * promoted segment loose from the frames below anyway, so the promoted root
+ * is left without a caller and the root's caller becomes the current frame.
+ * The stack is rewound to where root was. Returns the promoted version of
+ * the frame that was current, and puts that of root into root_out. (Root is
+ * invoked by a continuation reset, which is not a call through a local
+ * closure, so no frame in the segment has an outer below it.) */
+MVMFrame * MVM_frame_move_segment_to_heap(MVMThreadContext *tc, MVMFrame *root, MVMFrame **root_out) {
+    MVMFrame           *below = root->caller;
+    MVMFrame           *top_result;
+    MVMCallStackRegion *region;
+
+    /* The frames below are still reachable through the old current frame
+     * while promotion allocates, so the GC sees them. */
+    promote_chain(tc, tc->cur_frame, root, &top_result, root_out);
+
+    /* The segment took up the stack from root on, possibly spilling into
+     * later regions, which are now empty. */
+    region = tc->stack_current;
+    while ((char *)root < (char *)region || (char *)root >= region->alloc_limit) {
+        region->alloc = (char *)region + sizeof(MVMCallStackRegion);
+        region = region->prev;
+        if (!region)
+            MVM_panic(1, "Failed to find continuation root frame on call stack");
+    }
+    region->alloc     = (char *)root;
+    tc->stack_current = region;
+    if ((char *)region->alloc - sizeof(MVMCallStackRegion) == (char *)region)
+        MVM_callstack_region_prev(tc);
+
+    tc->cur_frame = below;
+    return top_result;
+}
+
 /* This function is to be used by the debugserver if a thread is currently
  * blocked. */
 MVMFrame * MVM_frame_debugserver_move_to_heap(MVMThreadContext *tc, MVMThreadContext *owner, MVMFrame *frame) {
@@ -796,6 +980,11 @@ MVMFrame * MVM_frame_debugserver_move_to_heap(MVMThreadContext *tc, MVMThreadCon
                 new_cur_frame = promoted;
             }
 
+            /* If local closures may have it as their outer, update them. */
+            if (owner->num_local_closures)
+                update_local_outers(tc, owner, new_cur_frame, cur_to_promote, promoted);
+            owner->num_dynvar_cache = 0;
+
             /* If the frame we're promoting was in the active handlers list,
              * update the address there. */
             if (owner->active_handlers) {
@@ -865,6 +1054,16 @@ MVMFrame * MVM_frame_create_for_deopt(MVMThreadContext *tc, MVMStaticFrame *stat
     return frame;
 }
 
+/* Drops the dynamic variable cache entries that go with a frame leaving the
+ * caller chain. */
+static void forget_dynvars(MVMThreadContext *tc, MVMFrame *f) {
+    MVMuint32 i, kept = 0;
+    for (i = 0; i < tc->num_dynvar_cache; i++)
+        if (tc->dynvar_cache[i].frame != f)
+            tc->dynvar_cache[kept++] = tc->dynvar_cache[i];
+    tc->num_dynvar_cache = kept;
+}
+
 /* Removes a single frame, as part of a return or unwind. Done after any exit
  * handler has already been run. */
 static MVMuint64 remove_one_frame(MVMThreadContext *tc, MVMuint8 unwind) {
@@ -890,6 +1089,10 @@ static MVMuint64 remove_one_frame(MVMThreadContext *tc, MVMuint8 unwind) {
         need_caller = 0;
     }
 
+    /* Forget any dynamic variables cached as found in it. */
+    if (tc->num_dynvar_cache)
+        forget_dynvars(tc, returner);
+
     /* Clean up frame working space. */
     if (returner->work) {
         MVM_args_proc_cleanup(tc, &returner->params);
@@ -897,9 +1100,12 @@ static MVMuint64 remove_one_frame(MVMThreadContext *tc, MVMuint8 unwind) {
             returner->work);
     }
 
-    /* If it's a call stack frame, remove it from the stack. */
+    /* If it's a call stack frame, remove it from the stack, along with any
+     * local closures it took. */
     if (MVM_FRAME_IS_ON_CALLSTACK(tc, returner)) {
         MVMCallStackRegion *stack = tc->stack_current;
+        if (tc->num_local_closures)
+            update_local_outers(tc, tc, NULL, returner, NULL);
         stack->alloc = (char *)returner;
         if ((char *)stack->alloc - sizeof(MVMCallStackRegion) == (char *)stack)
             MVM_callstack_region_prev(tc);
@@ -1243,6 +1449,63 @@ MVMObject * MVM_frame_takeclosure(MVMThreadContext *tc, MVMObject *code) {
     return (MVMObject *)closure;
 }
 
+/* Like MVM_frame_takeclosure, but for a closure that spesh has found is only
+ * invoked by the current frame, and not otherwise used; so it can't outlive
+ * the frame, and there's no need to move the call stack to the heap for it to
+ * have the frame as its outer. The closure is recorded with the thread, so
+ * that its outer can be updated if the frame is promoted after all, and let
+ * go of when the frame is removed. */
+MVMObject * MVM_frame_takeclosure_local(MVMThreadContext *tc, MVMObject *code) {
+    MVMCode *closure;
+
+    if (!MVM_FRAME_IS_ON_CALLSTACK(tc, tc->cur_frame))
+        return MVM_frame_takeclosure(tc, code);
+    if (MVM_UNLIKELY(REPR(code)->ID != MVM_REPR_ID_MVMCode))
+        MVM_exception_throw_adhoc(tc,
+            "Can only perform takeclosure on object with representation MVMCode");
+
+    MVMROOT(tc, code, {
+        closure = (MVMCode *)REPR(code)->allocate(tc, STABLE(code));
+    });
+
+    MVM_ASSIGN_REF(tc, &(closure->common.header), closure->body.sf, ((MVMCode *)code)->body.sf);
+    MVM_ASSIGN_REF(tc, &(closure->common.header), closure->body.name, ((MVMCode *)code)->body.name);
+    MVM_ASSIGN_REF(tc, &(closure->common.header), closure->body.code_object,
+        ((MVMCode *)code)->body.code_object);
+
+    /* No write barrier, as the outer is not on the heap. */
+    closure->body.outer = tc->cur_frame;
+
+    if (tc->num_local_closures == tc->alloc_local_closures) {
+        tc->alloc_local_closures = tc->alloc_local_closures ? 2 * tc->alloc_local_closures : 8;
+        tc->local_closures = MVM_realloc(tc->local_closures,
+            tc->alloc_local_closures * sizeof(MVMCode *));
+    }
+    tc->local_closures[tc->num_local_closures++] = closure;
+
+    return (MVMObject *)closure;
+}
+
+/* Code read from a frame to be handed out as a value, such as by curcode, may
+ * be a local closure, which must then stop being one, since it can now be
+ * stored anywhere. This moves its outer, and thus the stack, to the heap. */
+MVMObject * MVM_frame_escaping_code(MVMThreadContext *tc, MVMObject *code) {
+    if (code && REPR(code)->ID == MVM_REPR_ID_MVMCode) {
+        MVMFrame *outer = ((MVMCode *)code)->body.outer;
+        if (outer && MVM_FRAME_IS_ON_CALLSTACK(tc, outer)) {
+            MVMROOT(tc, code, {
+                MVM_frame_move_to_heap(tc, outer);
+            });
+        }
+    }
+    return code;
+}
+
+/* Gets the code object of the current frame. */
+MVMObject * MVM_frame_cur_code(MVMThreadContext *tc) {
+    return MVM_frame_escaping_code(tc, tc->cur_frame->code_ref);
+}
+
 /* Vivifies a lexical in a frame. */
 MVMObject * MVM_frame_vivify_lexical(MVMThreadContext *tc, MVMFrame *f, MVMuint16 idx) {
     MVMuint8       *flags;
@@ -1318,32 +1581,86 @@ MVMObject * MVM_frame_vivify_lexical(MVMThreadContext *tc, MVMFrame *f, MVMuint1
     }
 }
 
-/* Looks up the address of the lexical with the specified name and the
- * specified type. Non-existing object lexicals produce NULL, expected
- * (for better or worse) by various things. Otherwise, an error is thrown
- * if it does not exist. Incorrect type always throws. */
-MVMRegister * MVM_frame_find_lexical_by_name(MVMThreadContext *tc, MVMString *name, MVMuint16 type) {
-    MVMFrame *cur_frame = tc->cur_frame;
+/* Finds the frame along the outer chain from the one passed that has a
+ * lexical with the given name, updating the frame pointer to it and returning
+ * the lexical's index, or MVM_INDEX_HASH_NOT_FOUND. Lookups found close by
+ * are cached per thread, keyed on the static frames walked, so repeating one
+ * needn't hash the name in each frame on the way. */
+static MVMuint32 find_lexical_index(MVMThreadContext *tc, MVMFrame **frame_ptr, MVMString *name) {
+    MVMFrame *cur_frame = *frame_ptr;
+    MVMStaticFrame *sfs[MVM_LEXNAME_CACHE_DEPTH + 1];
+    MVMuint32 i, depth = 0;
+
+    for (i = 0; i < tc->num_lexname_cache; i++) {
+        MVMLexnameCacheEntry *entry = &(tc->lexname_cache[i]);
+        if (entry->sfs[0] == cur_frame->static_info && MVM_string_equal(tc, name, entry->name)) {
+            MVMFrame *f = cur_frame;
+            MVMuint32 j;
+            for (j = 1; j <= entry->depth; j++) {
+                f = f->outer;
+                if (!f || f->static_info != entry->sfs[j])
+                    break;
+            }
+            if (j > entry->depth) {
+                *frame_ptr = f;
+                return entry->idx;
+            }
+        }
+    }
+
     while (cur_frame != NULL) {
+        if (depth <= MVM_LEXNAME_CACHE_DEPTH)
+            sfs[depth] = cur_frame->static_info;
         if (cur_frame->static_info->body.num_lexicals) {
             MVMuint32 idx = MVM_get_lexical_by_name(tc, cur_frame->static_info, name);
             if (idx != MVM_INDEX_HASH_NOT_FOUND) {
-                if (MVM_LIKELY(cur_frame->static_info->body.lexical_types[idx] == type)) {
-                    MVMRegister *result = &cur_frame->env[idx];
-                    if (type == MVM_reg_obj && !result->o)
-                        MVM_frame_vivify_lexical(tc, cur_frame, idx);
-                    return result;
-                }
-                else {
-                    char *c_name = MVM_string_utf8_encode_C_string(tc, name);
-                    char *waste[] = { c_name, NULL };
-                    MVM_exception_throw_adhoc_free(tc, waste,
-                        "Lexical with name '%s' has wrong type",
-                            c_name);
+                if (depth <= MVM_LEXNAME_CACHE_DEPTH) {
+                    MVMLexnameCacheEntry *entry;
+                    if (tc->num_lexname_cache < MVM_LEXNAME_CACHE_SIZE) {
+                        entry = &(tc->lexname_cache[tc->num_lexname_cache++]);
+                    }
+                    else {
+                        entry = &(tc->lexname_cache[tc->next_lexname_cache]);
+                        tc->next_lexname_cache = (tc->next_lexname_cache + 1) % MVM_LEXNAME_CACHE_SIZE;
+                    }
+                    entry->name  = name;
+                    memcpy(entry->sfs, sfs, (depth + 1) * sizeof(MVMStaticFrame *));
+                    entry->depth = depth;
+                    entry->idx   = idx;
                 }
+                *frame_ptr = cur_frame;
+                return idx;
             }
         }
         cur_frame = cur_frame->outer;
+        depth++;
+    }
+    return MVM_INDEX_HASH_NOT_FOUND;
+}
+
+/* Looks up the address of the lexical with the specified name and the
+ * specified type. Non-existing object lexicals produce NULL, expected
+ * (for better or worse) by various things. Otherwise, an error is thrown
+ * if it does not exist. Incorrect type always throws. */
+MVMRegister * MVM_frame_find_lexical_by_name(MVMThreadContext *tc, MVMString *name, MVMuint16 type) {
+    MVMFrame *cur_frame = tc->cur_frame;
+    MVMuint32 idx = cur_frame
+        ? find_lexical_index(tc, &cur_frame, name)
+        : MVM_INDEX_HASH_NOT_FOUND;
+    if (idx != MVM_INDEX_HASH_NOT_FOUND) {
+        if (MVM_LIKELY(cur_frame->static_info->body.lexical_types[idx] == type)) {
+            MVMRegister *result = &cur_frame->env[idx];
+            if (type == MVM_reg_obj && !result->o)
+                MVM_frame_vivify_lexical(tc, cur_frame, idx);
+            return result;
+        }
+        else {
+            char *c_name = MVM_string_utf8_encode_C_string(tc, name);
+            char *waste[] = { c_name, NULL };
+            MVM_exception_throw_adhoc_free(tc, waste,
+                "Lexical with name '%s' has wrong type",
+                    c_name);
+        }
     }
     if (MVM_UNLIKELY(type != MVM_reg_obj)) {
         char *c_name = MVM_string_utf8_encode_C_string(tc, name);
@@ -1358,30 +1675,27 @@ MVMRegister * MVM_frame_find_lexical_by_name(MVMThreadContext *tc, MVMString *na
  * chain. */
 MVM_PUBLIC void MVM_frame_bind_lexical_by_name(MVMThreadContext *tc, MVMString *name, MVMuint16 type, MVMRegister value) {
     MVMFrame *cur_frame = tc->cur_frame;
-    while (cur_frame != NULL) {
-        if (cur_frame->static_info->body.num_lexicals) {
-            MVMuint32 idx = MVM_get_lexical_by_name(tc, cur_frame->static_info, name);
-            if (idx != MVM_INDEX_HASH_NOT_FOUND) {
-                if (cur_frame->static_info->body.lexical_types[idx] == type) {
-                    if (type == MVM_reg_obj || type == MVM_reg_str) {
-                        MVM_ASSIGN_REF(tc, &(cur_frame->header),
-                            cur_frame->env[idx].o, value.o);
-                    }
-                    else {
-                        cur_frame->env[idx] = value;
-                    }
-                    return;
-                }
-                else {
-                    char *c_name = MVM_string_utf8_encode_C_string(tc, name);
-                    char *waste[] = { c_name, NULL };
-                    MVM_exception_throw_adhoc_free(tc, waste,
-                        "Lexical with name '%s' has wrong type",
-                            c_name);
-                }
+    MVMuint32 idx = cur_frame
+        ? find_lexical_index(tc, &cur_frame, name)
+        : MVM_INDEX_HASH_NOT_FOUND;
+    if (idx != MVM_INDEX_HASH_NOT_FOUND) {
+        if (cur_frame->static_info->body.lexical_types[idx] == type) {
+            if (type == MVM_reg_obj || type == MVM_reg_str) {
+                MVM_ASSIGN_REF(tc, &(cur_frame->header),
+                    cur_frame->env[idx].o, value.o);
+            }
+            else {
+                cur_frame->env[idx] = value;
             }
+            return;
+        }
+        else {
+            char *c_name = MVM_string_utf8_encode_C_string(tc, name);
+            char *waste[] = { c_name, NULL };
+            MVM_exception_throw_adhoc_free(tc, waste,
+                "Lexical with name '%s' has wrong type",
+                    c_name);
         }
-        cur_frame = cur_frame->outer;
     }
     {
         char *c_name = MVM_string_utf8_encode_C_string(tc, name);
@@ -1410,26 +1724,23 @@ MVMObject * MVM_frame_find_lexical_by_name_outer(MVMThreadContext *tc, MVMString
 /* Looks up the address of the lexical with the specified name, starting with
  * the specified frame. Only works if it's an object lexical.  */
 MVMRegister * MVM_frame_find_lexical_by_name_rel(MVMThreadContext *tc, MVMString *name, MVMFrame *cur_frame) {
-    while (cur_frame != NULL) {
-        if (cur_frame->static_info->body.num_lexicals) {
-            MVMuint32 idx = MVM_get_lexical_by_name(tc, cur_frame->static_info, name);
-            if (idx != MVM_INDEX_HASH_NOT_FOUND) {
-                if (cur_frame->static_info->body.lexical_types[idx] == MVM_reg_obj) {
-                    MVMRegister *result = &cur_frame->env[idx];
-                    if (!result->o)
-                        MVM_frame_vivify_lexical(tc, cur_frame, idx);
-                    return result;
-                }
-                else {
-                    char *c_name = MVM_string_utf8_encode_C_string(tc, name);
-                    char *waste[] = { c_name, NULL };
-                    MVM_exception_throw_adhoc_free(tc, waste,
-                        "Lexical with name '%s' has wrong type",
-                            c_name);
-                }
-            }
+    MVMuint32 idx = cur_frame
+        ? find_lexical_index(tc, &cur_frame, name)
+        : MVM_INDEX_HASH_NOT_FOUND;
+    if (idx != MVM_INDEX_HASH_NOT_FOUND) {
+        if (cur_frame->static_info->body.lexical_types[idx] == MVM_reg_obj) {
+            MVMRegister *result = &cur_frame->env[idx];
+            if (!result->o)
+                MVM_frame_vivify_lexical(tc, cur_frame, idx);
+            return result;
+        }
+        else {
+            char *c_name = MVM_string_utf8_encode_C_string(tc, name);
+            char *waste[] = { c_name, NULL };
+            MVM_exception_throw_adhoc_free(tc, waste,
+                "Lexical with name '%s' has wrong type",
+                    c_name);
         }
-        cur_frame = cur_frame->outer;
     }
     return NULL;
 }
@@ -1503,6 +1814,43 @@ static void try_cache_dynlex(MVMThreadContext *tc, MVMFrame *from, MVMFrame *to,
     }
 #endif
 }
+/* Looks in the thread's dynamic variable cache. An entry stays valid while
+ * the frame it names is on the caller chain, since any frame entered since
+ * that declares dynamic variables empties the cache (as does anything that
+ * moves frames about or switches stacks). Lookups made in an inline of a
+ * frame that inlines declarations of them are never cached, as they might
+ * be answered differently once that frame has moved on to another inline. */
+static MVMRegister * find_cached_dynvar(MVMThreadContext *tc, MVMString *name,
+        MVMuint16 *type, MVMint32 vivify, MVMFrame **found_frame) {
+    MVMuint32 i;
+    for (i = 0; i < tc->num_dynvar_cache; i++) {
+        MVMDynvarCacheEntry *entry = &(tc->dynvar_cache[i]);
+        if (MVM_string_equal(tc, name, entry->name)) {
+            /* Leave vivifying an unset lexical to the walk. */
+            if (vivify && entry->type == MVM_reg_obj && !entry->reg->o)
+                return NULL;
+            *type = entry->type;
+            *found_frame = entry->frame;
+            return entry->reg;
+        }
+    }
+    return NULL;
+}
+static void cache_dynvar(MVMThreadContext *tc, MVMString *name, MVMFrame *frame,
+        MVMRegister *reg, MVMuint16 type) {
+    MVMDynvarCacheEntry *entry;
+    if (tc->num_dynvar_cache < MVM_DYNVAR_CACHE_SIZE) {
+        entry = &(tc->dynvar_cache[tc->num_dynvar_cache++]);
+    }
+    else {
+        entry = &(tc->dynvar_cache[tc->next_dynvar_cache]);
+        tc->next_dynvar_cache = (tc->next_dynvar_cache + 1) % MVM_DYNVAR_CACHE_SIZE;
+    }
+    entry->name  = name;
+    entry->frame = frame;
+    entry->reg   = reg;
+    entry->type  = type;
+}
 MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
         MVMSpeshFrameWalker *fw, MVMString *name, MVMuint16 *type, MVMFrame *initial_frame,
         MVMint32 vivify, MVMFrame **found_frame) {
@@ -1512,6 +1860,7 @@ MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
     MVMuint32 ecost = 0;  /* frames traversed with empty cache */
     MVMuint32 xcost = 0;  /* frames traversed with wrong name */
     MVMFrame *last_real_frame = initial_frame;
+    MVMint32 use_cache;
     char *c_name;
     MVMuint64 start_time;
     MVMuint64 last_time;
@@ -1524,6 +1873,24 @@ MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
         last_time = tc->instance->dynvar_log_lasttime;
     }
 
+    /* A walk of the callers from the current frame may be answered by the
+     * thread's dynamic variable cache. */
+    use_cache = initial_frame == tc->cur_frame && !fw->started && !fw->traversed
+        && !fw->visit_outers && is_dynamic_name(tc, name);
+    if (use_cache) {
+        MVMRegister *result = find_cached_dynvar(tc, name, type, vivify, found_frame);
+        if (result) {
+            if (dlog) {
+                fprintf(dlog, "T %s 0 0 0 0 %"PRIu64" %"PRIu64" %"PRIu64"\n", c_name, last_time, start_time, uv_hrtime());
+                fflush(dlog);
+                MVM_free(c_name);
+                tc->instance->dynvar_log_lasttime = uv_hrtime();
+            }
+            MVM_spesh_frame_walker_cleanup(tc, fw);
+            return result;
+        }
+    }
+
     /* Traverse with the frame walker. */
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&initial_frame);
     MVM_gc_root_temp_push(tc, (MVMCollectable **)&last_real_frame);
@@ -1536,6 +1903,8 @@ MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
         if (!MVM_spesh_frame_walker_is_inline(tc, fw)) {
             MVMFrameExtra *e;
             last_real_frame = MVM_spesh_frame_walker_current_frame(tc, fw);
+            if (last_real_frame->spesh_cand && last_real_frame->spesh_cand->inlines_dynamics)
+                use_cache = 0;
             e = last_real_frame->extra;
             if (e && e->dynlex_cache_name) {
                 if (MVM_string_equal(tc, name, e->dynlex_cache_name)) {
@@ -1545,6 +1914,8 @@ MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
                     *type = e->dynlex_cache_type;
                     if (fcost+icost > 5)
                         try_cache_dynlex(tc, initial_frame, last_real_frame, name, result, *type, fcost, icost);
+                    if (use_cache)
+                        cache_dynvar(tc, name, last_real_frame, result, *type);
                     if (dlog) {
                         fprintf(dlog, "C %s %d %d %d %d %"PRIu64" %"PRIu64" %"PRIu64"\n", c_name, fcost, icost, ecost, xcost, last_time, start_time, uv_hrtime());
                         fflush(dlog);
@@ -1572,6 +1943,8 @@ MVMRegister * MVM_frame_find_dynamic_using_frame_walker(MVMThreadContext *tc,
             if (fcost+icost > 1)
                 try_cache_dynlex(tc, initial_frame, last_real_frame, name,
                     result, *type, fcost, icost);
+            if (use_cache)
+                cache_dynvar(tc, name, *found_frame, result, *type);
             if (dlog) {
                 fprintf(dlog, "%s %s %d %d %d %d %"PRIu64" %"PRIu64" %"PRIu64"\n",
                         MVM_spesh_frame_walker_is_inline(tc, fw) ? "I" : "F",
@@ -1792,8 +2165,8 @@ static MVMObject * find_invokee_internal(MVMThreadContext *tc, MVMObject *code,
         MVMRegister dest;
         if (!IS_CONCRETE(code))
             MVM_exception_throw_adhoc(tc, "Can not invoke a code type object");
-        if (code->st->REPR->ID == MVM_REPR_ID_P6opaque)
-            is->code_ref_offset = MVM_p6opaque_attr_offset(tc, code->st->WHAT,
+        if (STABLE(code)->REPR->ID == MVM_REPR_ID_P6opaque)
+            is->code_ref_offset = MVM_p6opaque_attr_offset(tc, STABLE(code)->WHAT,
                 is->class_handle, is->attr_name);
         REPR(code)->attr_funcs.get_attribute(tc,
             STABLE(code), code, OBJECT_BODY(code),
@@ -1886,10 +2259,10 @@ MVMObject * MVM_frame_find_invokee_multi_ok(MVMThreadContext *tc, MVMObject *cod
             MVMRegister dest;
             if (!IS_CONCRETE(code))
                 MVM_exception_throw_adhoc(tc, "Can not invoke a code type object");
-            if (code->st->REPR->ID == MVM_REPR_ID_P6opaque) {
-                is->md_valid_offset = MVM_p6opaque_attr_offset(tc, code->st->WHAT,
+            if (STABLE(code)->REPR->ID == MVM_REPR_ID_P6opaque) {
+                is->md_valid_offset = MVM_p6opaque_attr_offset(tc, STABLE(code)->WHAT,
                     is->md_class_handle, is->md_valid_attr_name);
-                is->md_cache_offset = MVM_p6opaque_attr_offset(tc, code->st->WHAT,
+                is->md_cache_offset = MVM_p6opaque_attr_offset(tc, STABLE(code)->WHAT,
                     is->md_class_handle, is->md_cache_attr_name);
             }
             REPR(code)->attr_funcs.get_attribute(tc,
@@ -1976,5 +2349,5 @@ MVMObject * MVM_frame_caller_code(MVMThreadContext *tc) {
     else {
         result = tc->instance->VMNull;
     }
-    return result;
+    return MVM_frame_escaping_code(tc, result);
 }
@@ -195,6 +195,7 @@ MVM_STATIC_INLINE MVMuint32 MVM_FRAME_IS_ON_CALLSTACK(MVMThreadContext *tc, MVMF
 /* Forces a frame to the callstack if needed. Done as a static inline to make
  * the quite common case where nothing is needed cheaper. */
 MVM_PUBLIC MVMFrame * MVM_frame_move_to_heap(MVMThreadContext *tc, MVMFrame *frame);
+MVMFrame * MVM_frame_move_segment_to_heap(MVMThreadContext *tc, MVMFrame *root, MVMFrame **root_out);
 MVM_STATIC_INLINE MVMFrame * MVM_frame_force_to_heap(MVMThreadContext *tc, MVMFrame *frame) {
     return MVM_FRAME_IS_ON_CALLSTACK(tc, frame)
         ? MVM_frame_move_to_heap(tc, frame)
@@ -223,6 +224,9 @@ MVM_PUBLIC MVMObject * MVM_frame_get_code_object(MVMThreadContext *tc, MVMCode *
 MVM_PUBLIC void MVM_frame_capturelex(MVMThreadContext *tc, MVMObject *code);
 MVM_PUBLIC void MVM_frame_capture_inner(MVMThreadContext *tc, MVMObject *code);
 MVM_PUBLIC MVMObject * MVM_frame_takeclosure(MVMThreadContext *tc, MVMObject *code);
+MVM_PUBLIC MVMObject * MVM_frame_takeclosure_local(MVMThreadContext *tc, MVMObject *code);
+MVM_PUBLIC MVMObject * MVM_frame_escaping_code(MVMThreadContext *tc, MVMObject *code);
+MVM_PUBLIC MVMObject * MVM_frame_cur_code(MVMThreadContext *tc);
 MVM_PUBLIC MVMObject * MVM_frame_vivify_lexical(MVMThreadContext *tc, MVMFrame *f, MVMuint16 idx);
 MVM_PUBLIC MVMRegister * MVM_frame_find_lexical_by_name(MVMThreadContext *tc, MVMString *name, MVMuint16 type);
 MVM_PUBLIC void MVM_frame_bind_lexical_by_name(MVMThreadContext *tc, MVMString *name, MVMuint16 type, MVMRegister value);
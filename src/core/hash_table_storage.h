@@ -0,0 +1,33 @@
+/* Storage for the entries and metadata of the hash tables.
+ *
+ * By default the entries and the metadata are two memory blocks, so that ASAN
+ * and valgrind can spot (some) overruns of either. Building with
+ * MVM_HASH_SINGLE_ALLOCATION puts both in one block instead, the metadata
+ * straight after the entries, saving an allocation and a free per table (and
+ * per resize), and keeping a probe's metadata and entries close in memory.
+ *
+ * The metadata block includes a sentinel byte at each end; the pointer that
+ * is returned is to the start of it, including the first sentinel. */
+
+MVM_STATIC_INLINE MVMuint8 * MVM_hash_allocate_storage(char **entries,
+                                                      size_t entries_size,
+                                                      size_t metadata_size) {
+#if MVM_HASH_SINGLE_ALLOCATION
+    char *block = MVM_malloc(entries_size + metadata_size);
+    memset(block + entries_size, 0, metadata_size);
+    *entries = block;
+    return (MVMuint8 *)(block + entries_size);
+#else
+    *entries = MVM_malloc(entries_size);
+    return MVM_calloc(metadata_size, 1);
+#endif
+}
+
+/* Frees storage allocated with MVM_hash_allocate_storage, given the entries
+ * and the metadata pointer just past the first sentinel. */
+MVM_STATIC_INLINE void MVM_hash_free_storage(char *entries, MVMuint8 *metadata) {
+    MVM_free(entries);
+#if !MVM_HASH_SINGLE_ALLOCATION
+    MVM_free(metadata - 1);
+#endif
+}
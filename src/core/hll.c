@@ -153,6 +153,9 @@ MVMObject * MVM_hll_set_config(MVMThreadContext *tc, MVMString *name, MVMObject
             MVM_intcache_for(tc, config->int_box_type);
         });
 
+    /* The HLL config is shared by all threads. */
+    MVM_gc_note_escape(tc);
+
     return config_hash;
 }
 
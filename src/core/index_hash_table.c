@@ -15,8 +15,7 @@ MVM_STATIC_INLINE MVMuint32 hash_true_size(MVMIndexHashTable *hashtable) {
    which you allocated (heap, stack, inside another struct, wherever) */
 void MVM_index_hash_demolish(MVMThreadContext *tc, MVMIndexHashTable *hashtable) {
     if (hashtable->metadata) {
-        MVM_free(hashtable->entries);
-        MVM_free(hashtable->metadata - 1);
+        MVM_hash_free_storage(hashtable->entries, hashtable->metadata);
     }
 }
 /* and then free memory if you allocated it */
@@ -25,8 +24,8 @@ void MVM_index_hash_demolish(MVMThreadContext *tc, MVMIndexHashTable *hashtable)
 MVM_STATIC_INLINE void hash_allocate_common(MVMIndexHashTable *hashtable) {
     hashtable->max_items = hashtable->official_size * INDEX_LOAD_FACTOR;
     size_t actual_items = hash_true_size(hashtable);
-    hashtable->entries = MVM_malloc(sizeof(struct MVMIndexHashEntry) * actual_items);
-    hashtable->metadata = MVM_calloc(1 + actual_items + 1, 1);
+    hashtable->metadata = MVM_hash_allocate_storage(&hashtable->entries,
+        sizeof(struct MVMIndexHashEntry) * actual_items, 1 + actual_items + 1);
     /* A sentinel. This marks an occupied slot, at its ideal position. */
     *hashtable->metadata = 1;
     ++hashtable->metadata;
@@ -176,8 +175,7 @@ void MVM_index_hash_insert_nocheck(MVMThreadContext *tc,
             ++metadata;
             entry_raw += sizeof(struct MVMIndexHashEntry);
         }
-        MVM_free(entry_raw_orig);
-        MVM_free(metadata_orig - 1);
+        MVM_hash_free_storage(entry_raw_orig, metadata_orig);
     }
     hash_insert_internal(tc, hashtable, list, idx);
     ++hashtable->cur_items;
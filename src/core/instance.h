@@ -57,6 +57,9 @@ struct MVMStringConsts {
     MVMString *anon;
     MVMString *P6opaque;
     MVMString *array;
+    MVMString *hash;
+    MVMString *queue;
+    MVMString *capacity;
     MVMString *box_target;
     MVMString *positional_delegate;
     MVMString *associative_delegate;
@@ -85,11 +88,13 @@ struct MVMStringConsts {
     MVMString *kind;
     MVMString *instrumented;
     MVMString *heap;
+    MVMString *census;
     MVMString *translate_newlines;
     MVMString *platform_newline;
     MVMString *path;
     MVMString *config;
     MVMString *replacement;
+    MVMString *env_delta;
 };
 
 struct MVMEventSubscriptions {
@@ -109,6 +114,20 @@ struct MVMSerializationContextWeakHashEntry {
     MVMSerializationContextBody *scb;
 };
 
+/* The persistent object ID hash is split into shards by object address, each
+ * with its own lock, so threads asking for object IDs rarely contend. */
+#define MVM_OBJECT_ID_SHARD_BITS 6
+#define MVM_OBJECT_ID_SHARDS     (1 << MVM_OBJECT_ID_SHARD_BITS)
+struct MVMObjectIdShard {
+    MVMPtrHashTable object_ids;
+    uv_mutex_t      mutex;
+};
+
+/* JIT code heap size classes go up to this many pages; each keeps at most
+ * MVM_JIT_CODE_HEAP_MAX_FREE freed blocks around for reuse. */
+#define MVM_JIT_CODE_HEAP_CLASSES  8
+#define MVM_JIT_CODE_HEAP_MAX_FREE 32
+
 /* Represents a MoarVM instance. */
 struct MVMInstance {
     /************************************************************************
@@ -126,6 +145,17 @@ struct MVMInstance {
     MVMThread *threads;
     uv_mutex_t mutex_threads;
 
+    /* The thread context of each native thread running one of our threads,
+     * so native callbacks can find it without walking the threads list. */
+    uv_key_t native_thread_tc;
+
+    /* The CPUs VM internal threads (such as the spesh worker and the event
+     * loops) are pinned to, as a mask of MVM_CPU_SET_WORDS words, or NULL to
+     * let them run anywhere; and the priority they run at, if one was set. */
+    MVMuint64 *internal_thread_affinity;
+    MVMint32   internal_thread_priority;
+    MVMuint8   has_internal_thread_priority;
+
     /************************************************************************
      * Garbage collection and memory management
      ************************************************************************/
@@ -193,14 +223,137 @@ struct MVMInstance {
      * since we last did a full collection? */
     AO_t gc_promoted_bytes_since_last_full;
 
+    /* Policy for deciding on a full collection: the percentage of the
+     * resident set that must have been promoted (adapted over time if a
+     * target percentage of time to spend in full collections is set), the
+     * minimum amount that must have been promoted, and when the last full
+     * collection finished (used for the adaptation). */
+    MVMuint32 gc_gen2_threshold_percent;
+    MVMuint32 gc_target_time_percent;
+    MVMuint64 gc_gen2_threshold_minimum;
+    MVMuint64 gc_last_full_end;
+
     /* The thread that is "to blame" for the current GC run (e.g. the one
      * that filled its nursery fastest). */
     MVMThreadContext *thread_to_blame_for_gc;
 
-    /* Persistent object ID hash, used to give nursery objects a lifetime
-     * unique ID. Plus a lock to protect it. */
-    MVMPtrHashTable     object_ids;
-    uv_mutex_t    mutex_object_ids;
+    /* The bounds that per-thread nursery sizes are kept within. */
+    MVMuint32 nursery_size_min;
+    MVMuint32 nursery_size_max;
+
+    /* Parallel marking of full collections: whether it is enabled, the
+     * number of threads taking part in the current run and how many of them
+     * are currently idle, and a pool (protected by the mutex) of chunks of
+     * work that busy threads have shared for idle ones to take. */
+    MVMuint8 gc_parallel_mark;
+    AO_t gc_mark_participants;
+    AO_t gc_mark_idle;
+    MVMGCPassedWork *gc_mark_pool;
+    AO_t gc_mark_pool_size;
+    uv_mutex_t mutex_gc_mark_pool;
+
+    /* Whether sweeping the second generation after a full collection is
+     * deferred, so it is done bit by bit as threads allocate. */
+    MVMuint8 gc_lazy_sweep;
+
+    /* Whether full collections leave out the parameterizations that only
+     * the lookups of parametric types refer to. */
+    MVMuint8 gc_weak_parameterizations;
+
+    /* Whether large gen2 arrays keep a card table, so that nursery
+     * collections only rescan the parts of them that were written to. */
+    MVMuint8 gc_card_marking;
+
+    /* Whether to free gen2 pages that a full collection finds empty. */
+    MVMuint8 gc_gen2_release_pages;
+
+    /* The least milliseconds between malloc trims after full collections
+     * (-1 if trimming is off), and when (in milliseconds) the last was. */
+    MVMint64 gc_trim_interval;
+    AO_t gc_trim_last;
+
+    /* Whether the nurseries of threads that are blocked when a collection
+     * happens get their unused pages handed back to the OS. */
+    MVMuint8 gc_release_idle_nursery;
+
+    /* Whether nurseries and gen2 pages should be backed by huge pages. */
+    MVMuint8 gc_huge_pages;
+
+    /* Whether nurseries and gen2 pages should prefer the NUMA node of the
+     * thread they belong to, and GC work be passed to threads on it. */
+    MVMuint8 gc_numa_local;
+
+    /* Whether types whose objects nearly always get promoted are allocated
+     * directly in gen2. */
+    MVMuint8 gc_pretenure;
+
+    /* Whether a thread whose nursery objects are not reachable by any other
+     * thread may collect its nursery without stopping the world. */
+    MVMuint8 gc_thread_local;
+
+    /* GC pause and phase timing statistics (see MVM_GC_STATS_FIELDS), along
+     * with a mutex to protect them. */
+    MVMuint64 gc_stats[MVM_GC_STATS_FIELDS];
+    uv_mutex_t mutex_gc_stats;
+
+    /* Counters handed out by the vmstats op, bumped atomically where the
+     * events happen. Promoted bytes only includes full collection periods
+     * that have ended; the current one is added in when the stats are read.
+     * The event loop task count is of the tasks currently active. */
+    AO_t stat_promoted_bytes;
+    AO_t stat_spesh_candidates;
+    AO_t stat_deopt_one;
+    AO_t stat_deopt_all;
+    AO_t stat_deopt_discards;
+    AO_t stat_osr;
+    AO_t stat_jit_code_bytes;
+    AO_t stat_event_loop_tasks;
+
+    /* Take a sample of one in this many object allocations (zero if off);
+     * the mutex protects the per-thread sample tables. */
+    MVMuint32 alloc_sample_interval;
+    uv_mutex_t mutex_alloc_samples;
+
+    /* CPU sampling: the interval in microseconds (zero if off), the epoch
+     * the timer thread bumps at each tick, and the flag telling it to stop.
+     * The mutex protects the per-thread sample trees. */
+    MVMuint32 cpu_sample_interval;
+    AO_t cpu_sample_epoch;
+    AO_t cpu_sample_stop;
+    uv_thread_t cpu_sample_thread;
+    uv_mutex_t mutex_cpu_samples;
+
+    /* Persistent object ID hash shards, used to give nursery objects a
+     * lifetime unique ID. */
+    MVMObjectIdShard object_id_shards[MVM_OBJECT_ID_SHARDS];
+
+    /* Objects that are pinned, and so kept alive and unmoving until they
+     * are unpinned, along with a mutex to protect the list. */
+    MVM_VECTOR_DECL(MVMCollectable *, pinned);
+    uv_mutex_t mutex_pinned;
+
+    /* The number of finalizer worker threads to run (0 unless enabled), and
+     * the objects queued up for them to finalize, with a mutex protecting
+     * the queue and a condition variable they wait on for more work. */
+    MVMuint32 num_finalizer_threads;
+    MVM_VECTOR_DECL(MVMFinalizeItem, finalize_pending);
+    uv_mutex_t mutex_finalize_pending;
+    uv_cond_t  cond_finalize_pending;
+    MVMWorkerPool *finalizer_pool;
+
+    /* The number of threads that finish deserializing serialization contexts
+     * in the background (0 unless enabled), and the contexts queued up for
+     * them, with a mutex protecting the queue and a condition variable they
+     * wait on for more work. */
+    MVMuint32 num_deserialize_threads;
+    MVM_VECTOR_DECL(MVMSerializationContext *, deserialize_pending);
+    uv_mutex_t mutex_deserialize_pending;
+    uv_cond_t  cond_deserialize_pending;
+    MVMWorkerPool *deserialize_pool;
+
+    /* The work-stealing scheduler that runs code objects submitted to it on
+     * a pool of worker threads. */
+    MVMScheduler *scheduler;
 
     /* Fixed size allocator. */
     MVMFixedSizeAlloc *fsa;
@@ -268,12 +421,20 @@ struct MVMInstance {
     MVMint8 spesh_inline_log;
     MVMint8 spesh_osr_enabled;
     MVMint8 spesh_pea_enabled;
+    MVMint8 spesh_licm_enabled;
+    MVMint8 spesh_baseline_enabled;
+    MVMint8 spesh_closures_enabled;
     MVMint8 spesh_nodelay;
     MVMint8 spesh_blocking;
+    MVMint8 spesh_server;
+
+    /* How many logs were waiting in the spesh queue when the spesh thread
+     * last took one; used to raise the thresholds while it's behind. */
+    MVMuint32 spesh_backlog;
 
     /* Number of specializations produced, and limit on number of
      * specializations (zero if no limit). */
-    MVMint32 spesh_produced;
+    AO_t spesh_produced;
     MVMint32 spesh_limit;
 
     /* Mutex taken when install specializations. */
@@ -282,10 +443,34 @@ struct MVMInstance {
     /* The thread object representing the spesh thread */
     MVMObject *spesh_thread;
 
+    /* Helper threads that produce specializations alongside the spesh
+     * thread, and how many there are. The spesh thread hands them each
+     * wave of its plan (the entries between the start and end index) in
+     * a new round, then waits for the busy count to fall to zero. */
+    MVMuint32   num_spesh_helpers;
+    MVMObject **spesh_helpers;
+    AO_t        spesh_helpers_started;
+    uv_mutex_t  mutex_spesh_helpers;
+    uv_cond_t   cond_spesh_helpers_work;
+    uv_cond_t   cond_spesh_helpers_done;
+    MVMuint64   spesh_helpers_round;
+    MVMuint32   spesh_wave_start;
+    MVMuint32   spesh_wave_end;
+    MVMuint32   spesh_helpers_busy;
+    MVMuint32   spesh_helpers_stop;
+
     /* The concurrent queue used to send logs to spesh_thread, provided it
      * is enabled. */
     MVMObject *spesh_queue;
 
+    /* Specializations remembered from earlier runs, if we're to keep them
+     * in a cache file. */
+    MVMSpeshCache *spesh_cache;
+
+    /* The directory to keep specialized code in for each compilation unit,
+     * if we're to do so. */
+    char *spesh_code_cache_dir;
+
     /* The current specialization plan; hung off here so we can mark it. */
     MVMSpeshPlan *spesh_plan;
 
@@ -318,6 +503,18 @@ struct MVMInstance {
     /* File for JIT perf map logging */
     FILE *jit_perf_map;
 
+    /* jitdump file for perf, the executable mapping of it that tells perf
+     * where to find it, and the index of the next code written to it */
+    FILE *jit_perf_dump;
+    void *jit_perf_dump_marker;
+    MVMuint64 jit_perf_dump_index;
+
+    /* Whether to register JIT-compiled code with GDB */
+    MVMuint8 jit_gdb_enabled;
+
+    /* Serializes writing the above and GDB registration */
+    uv_mutex_t mutex_jit_perf;
+
     /* Directory name for JIT bytecode dumps */
     char *jit_bytecode_dir;
 
@@ -330,23 +527,56 @@ struct MVMInstance {
         MVMint32 block_nr;
     }, jit_breakpoints);
 
+    /* Whether the JIT may have the interpreter run instructions it can't
+     * compile, rather than give up on the frame */
+    MVMuint8 jit_partial_enabled;
+
+    /* Per-opcode counts of frames the JIT gave up on, and of instructions
+     * it left to the interpreter, if reporting them at exit */
+    AO_t *jit_bail_counts;
+    AO_t *jit_interp_op_counts;
+
+    /* Blocks of pages for JIT code that are free to be reused, with one list
+     * (linked through the first word of each block) and count per number of
+     * pages, and the number of bytes of pages holding JIT code right now */
+    uv_mutex_t mutex_jit_code_heap;
+    void *jit_code_free_blocks[MVM_JIT_CODE_HEAP_CLASSES];
+    MVMuint32 jit_code_free_counts[MVM_JIT_CODE_HEAP_CLASSES];
+    AO_t jit_code_bytes;
+
+    /* Discarded candidates with JIT code that will be freed after a full
+     * collection finds no frame running it any more */
+    uv_mutex_t mutex_jit_code_discarded;
+    MVMSpeshCandidate *jit_code_discarded;
+
+    /* Candidates that have deopted, for reporting where deopts happen, and
+     * whether to report that at exit. */
+    uv_mutex_t mutex_deopting_candidates;
+    MVMSpeshCandidate *deopting_candidates;
+    MVMuint8 spesh_deopt_report;
+
     /************************************************************************
      * I/O and process state
      ************************************************************************/
 
-    /* The event loop thread, a mutex to avoid start-races, a concurrent
-     * queue of tasks that need to be processed by the event loop thread
-     * and an array of active tasks, for the purpose of keeping them GC
-     * marked. */
-    MVMObject        *event_loop_thread;
-    uv_loop_t        *event_loop;
+    /* The event loops, how many there are, the next one to hand a task that
+     * can go on any of them, and a mutex to avoid start-races. */
+    MVMEventLoop     *event_loops;
+    MVMuint32         num_event_loops;
+    AO_t              next_event_loop;
     uv_mutex_t        mutex_event_loop;
-    MVMObject        *event_loop_todo_queue;
-    MVMObject        *event_loop_permit_queue;
-    MVMObject        *event_loop_cancel_queue;
-    MVMObject        *event_loop_active;
-    MVMObject        *event_loop_free_indices;
-    uv_async_t       *event_loop_wakeup;
+
+    /* Cache of resolved host names (see MVM_DNS_CACHE_TTL), how long its
+     * entries live in nanoseconds (0 if it is disabled), the next entry to
+     * replace when it is full, and a mutex protecting it. */
+    MVMDNSCacheEntry *dns_cache;
+    MVMuint64         dns_cache_ttl;
+    MVMuint32         dns_cache_next;
+    uv_mutex_t        mutex_dns_cache;
+
+    /* Whether async processes must always be started by libuv, rather than
+     * with posix_spawn where we can (see MVM_SPAWN_USE_LIBUV). */
+    MVMuint8          spawn_use_libuv;
 
     /* Standard file handles. */
     MVMObject *stdin_handle;
@@ -382,11 +612,15 @@ struct MVMInstance {
     /* int -> str cache */
     MVMString **int_to_str_cache;
 
-    /* By far the most common integers are between 0 and 8, but we cache up to 15
-     * so that it lines up properly. */
+    /* Boxed small integers, for a range set by MVM_INTCACHE_MIN and
+     * MVM_INTCACHE_MAX. */
     MVMIntConstCache    *int_const_cache;
     uv_mutex_t mutex_int_const_cache;
 
+    /* Whether P6opaque packs attributes by alignment, rather than laying
+     * them out in declaration order. */
+    MVMuint8 p6opaque_pack;
+
     /* Multi-dispatch cache addition mutex (additions are relatively
      * rare, so little motivation to have it more fine-grained). */
     uv_mutex_t mutex_multi_cache_add;
@@ -394,6 +628,14 @@ struct MVMInstance {
     /* Next type cache ID, to go in STable. */
     AO_t cur_type_cache_id;
 
+#ifdef MVM_COMPACT_HEADERS
+    /* The next never used STable index, the indexes of freed STables that
+     * may be used again, and the mutex protecting them. */
+    MVMuint32 next_stable_index;
+    MVM_VECTOR_DECL(MVMuint32, free_stable_indexes);
+    uv_mutex_t mutex_stable_index;
+#endif
+
     /* Cached backend config hash. */
     MVMObject *cached_backend_config;
 
@@ -401,6 +643,10 @@ struct MVMInstance {
     MVMCallsiteInterns *callsite_interns;
     uv_mutex_t          mutex_callsite_interns;
 
+    /* Interned compilation unit string heap entries. */
+    MVMCUStringInterns *cu_string_interns;
+    uv_mutex_t          mutex_cu_string_interns;
+
     /* Normal Form Grapheme state (synthetics table, lookup, etc.). */
     MVMNFGState *nfg;
 
@@ -473,6 +719,14 @@ struct MVMInstance {
     MVMFixKeyHashTable     loaded_compunits;
     uv_mutex_t       mutex_loaded_compunits;
 
+    /* Bundles of compunits that loading looks in before going to disk;
+     * protected by mutex_loaded_compunits. */
+    MVM_VECTOR_DECL(MVMCUBundle *, cu_bundles);
+
+    /* Whether bytecode from bundles is trusted, and so not validated (see
+     * MVM_TRUST_BUNDLES). */
+    MVMuint8          trust_bundles;
+
     /* Hash of all loaded DLLs. */
     MVMFixKeyHashTable     dll_registry;
     uv_mutex_t       mutex_dll_registry;
@@ -499,8 +753,10 @@ struct MVMInstance {
     /* Whether instrumented profiling is turned on or not. */
     MVMuint32 profiling;
 
-    /* Heap snapshots, if we're doing heap snapshotting. */
+    /* Heap snapshots, if we're doing heap snapshotting, and whether to
+     * compress their references on a helper thread. */
     MVMHeapSnapshotCollection *heap_snapshots;
+    MVMuint32 heap_snapshot_threaded;
 
     /* Whether cross-thread write logging is turned on or not, and an output
      * mutex for it. */
@@ -513,6 +769,25 @@ struct MVMInstance {
     FILE *coverage_log_fh;
     MVMuint32  coverage_control;
 
+    /* If coverage is being recorded as counts rather than logged, the list
+     * of per-frame counters to write out at exit, and a mutex for it. */
+    MVMuint32  coverage_counting;
+    MVMLineCoverageCounters *coverage_counters;
+    uv_mutex_t mutex_coverage_counters;
+
+    /* Lock contention profiling: whether it's on (in which case there is a
+     * report at exit), the merged counts of threads that have gone, and a
+     * mutex for those. */
+    MVMuint32  lock_profiling;
+    MVMLockContention *lock_contention_exited;
+    uv_mutex_t mutex_lock_contention;
+
+    /* Startup profiling: whether it's on, when the instance started being
+     * created, and how many specializations were reported so far. */
+    MVMuint32  startup_profiling;
+    MVMuint64  startup_time;
+    AO_t       startup_spesh_reported;
+
     /* The time it takes to run the profiler instrumentation. */
     MVMuint64 profiling_overhead;
 
@@ -1,55 +1,65 @@
 #include "moar.h"
 
 void MVM_intcache_for(MVMThreadContext *tc, MVMObject *type) {
+    MVMIntConstCache *cache = tc->instance->int_const_cache;
     int type_index;
     int right_slot = -1;
     uv_mutex_lock(&tc->instance->mutex_int_const_cache);
-    for (type_index = 0; type_index < 4; type_index++) {
-        if (tc->instance->int_const_cache->types[type_index] == NULL) {
+    for (type_index = 0; type_index < MVM_INTCACHE_TYPES; type_index++) {
+        if (cache->types[type_index] == NULL) {
             right_slot = type_index;
             break;
         }
-        else if (tc->instance->int_const_cache->types[type_index] == type) {
+        else if (cache->types[type_index] == type) {
             uv_mutex_unlock(&tc->instance->mutex_int_const_cache);
             return;
         }
     }
     if (right_slot != -1) {
-        MVMROOT(tc, type, {
-            int val;
-            for (val = -1; val < 15; val++) {
-                MVMObject *obj;
-                obj = MVM_repr_alloc_init(tc, type);
-                MVM_repr_set_int(tc, obj, val);
-                tc->instance->int_const_cache->cache[type_index][val + 1] = obj;
-                MVM_gc_root_add_permanent_desc(tc,
-                    (MVMCollectable **)&tc->instance->int_const_cache->cache[type_index][val + 1],
-                    "Boxed integer cache entry");
-            }
-        });
-        tc->instance->int_const_cache->types[type_index] = type;
+        /* The entries are made lazily by MVM_intcache_fill, so all we need is
+         * somewhere to put them. It must be there before the type is, as the
+         * lookups don't take the lock. */
+        cache->cache[right_slot] = MVM_calloc(cache->max - cache->min + 1, sizeof(MVMObject *));
+        MVM_barrier();
+        cache->types[right_slot] = type;
         MVM_gc_root_add_permanent_desc(tc,
-            (MVMCollectable **)&tc->instance->int_const_cache->types[type_index],
+            (MVMCollectable **)&cache->types[right_slot],
             "Boxed integer cache type");
     }
     uv_mutex_unlock(&tc->instance->mutex_int_const_cache);
 }
 
+/* Creates the boxed integer for a value in the range of a cache slot that has
+ * not been wanted before. It is allocated straight into gen2, so this never
+ * triggers a GC; if another thread got there first, theirs is used. */
+MVMObject * MVM_intcache_fill(MVMThreadContext *tc, MVMint16 slot, MVMint64 value) {
+    MVMIntConstCache *cache = tc->instance->int_const_cache;
+    MVMObject **entry = &(cache->cache[slot][value - cache->min]);
+    MVMObject *obj;
+    MVM_gc_allocate_gen2_default_set(tc);
+    obj = MVM_repr_alloc_init(tc, cache->types[slot]);
+    MVM_repr_set_int(tc, obj, value);
+    MVM_gc_allocate_gen2_default_clear(tc);
+    if (!MVM_trycas(entry, NULL, obj))
+        obj = (MVMObject *)MVM_load(entry);
+    return obj;
+}
+
 MVMObject *MVM_intcache_get(MVMThreadContext *tc, MVMObject *type, MVMint64 value) {
     int type_index;
     int right_slot = -1;
 
-    if (value < -1 || value >= 15)
+    if (!MVM_INTCACHE_RANGE_CHECK(tc, value))
         return NULL;
 
-    for (type_index = 0; type_index < 4; type_index++) {
+    for (type_index = 0; type_index < MVM_INTCACHE_TYPES; type_index++) {
         if (tc->instance->int_const_cache->types[type_index] == type) {
             right_slot = type_index;
             break;
         }
     }
     if (right_slot != -1) {
-        return tc->instance->int_const_cache->cache[right_slot][value + 1];
+        return MVM_intcache_get_slot(tc, right_slot, value);
     }
     return NULL;
 }
@@ -58,7 +68,7 @@ MVMint32 MVM_intcache_type_index(MVMThreadContext *tc, MVMObject *type) {
     int type_index;
     int found = -1;
     uv_mutex_lock(&tc->instance->mutex_int_const_cache);
-    for (type_index = 0; type_index < 4; type_index++) {
+    for (type_index = 0; type_index < MVM_INTCACHE_TYPES; type_index++) {
         if (tc->instance->int_const_cache->types[type_index] == type) {
             found = type_index;
             break;
@@ -67,3 +77,40 @@ MVMint32 MVM_intcache_type_index(MVMThreadContext *tc, MVMObject *type) {
     uv_mutex_unlock(&tc->instance->mutex_int_const_cache);
     return found;
 }
+
+void MVM_intcache_destroy(MVMThreadContext *tc, MVMIntConstCache *cache) {
+    int type_index;
+    for (type_index = 0; type_index < MVM_INTCACHE_TYPES; type_index++)
+        MVM_free(cache->cache[type_index]);
+    MVM_free(cache);
+}
+
+/* Turns a box_i of a value that spesh knows, and that is in the range cached
+ * for the type, into a load of the cached object from a spesh slot. Returns
+ * non-zero if it did so. */
+MVMint32 MVM_intcache_spesh_box(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
+        MVMSTable *st) {
+    MVMSpeshFacts *value_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+    MVMSpeshFacts *tgt_facts;
+    MVMObject *obj;
+    if (!(value_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE))
+        return 0;
+    obj = MVM_intcache_get(tc, st->WHAT, value_facts->value.i);
+    if (!obj)
+        return 0;
+
+    MVM_spesh_use_facts(tc, g, value_facts);
+    MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[1], ins);
+    MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[2], ins);
+    MVM_spesh_graph_add_comment(tc, g, ins, "box_i of constant %"PRId64" into a %s",
+            value_facts->value.i, MVM_6model_get_stable_debug_name(tc, st));
+    ins->info = MVM_op_get_op(MVM_OP_sp_getspeshslot);
+    ins->operands[1].lit_i16 = MVM_spesh_add_spesh_slot_try_reuse(tc, g, (MVMCollectable *)obj);
+
+    tgt_facts = MVM_spesh_get_facts(tc, g, ins->operands[0]);
+    tgt_facts->flags |= MVM_SPESH_FACT_KNOWN_TYPE | MVM_SPESH_FACT_CONCRETE
+        | MVM_SPESH_FACT_KNOWN_VALUE;
+    tgt_facts->type    = st->WHAT;
+    tgt_facts->value.o = obj;
+    return 1;
+}
@@ -1,10 +1,41 @@
+/* The number of types that can have boxed integers cached. */
+#define MVM_INTCACHE_TYPES 4
+
+/* The range cached by default, and the limits on configuring it with
+ * MVM_INTCACHE_MIN and MVM_INTCACHE_MAX; the cached values must fit in a
+ * 32-bit integer for the JIT's range check. */
+#define MVM_INTCACHE_DEFAULT_MIN -1
+#define MVM_INTCACHE_DEFAULT_MAX 14
+#define MVM_INTCACHE_LIMIT 65536
+
+/* Boxed integers, per type, for values from min to max inclusive. Each array
+ * is allocated when its type is registered and never moved; the entries are
+ * created the first time they are asked for. */
 struct MVMIntConstCache {
-    MVMObject *types[4];
-    MVMObject *cache[4][16];
+    MVMObject  *types[MVM_INTCACHE_TYPES];
+    MVMObject **cache[MVM_INTCACHE_TYPES];
+    MVMint64    min;
+    MVMint64    max;
 };
 
-#define MVM_INTCACHE_RANGE_CHECK(value) ((value) >= -1 && (value) < 15)
+#define MVM_INTCACHE_RANGE_CHECK(tc, value) \
+    ((value) >= (tc)->instance->int_const_cache->min && \
+     (value) <= (tc)->instance->int_const_cache->max)
 
 void MVM_intcache_for(MVMThreadContext *tc, MVMObject *type);
 MVMObject *MVM_intcache_get(MVMThreadContext *tc, MVMObject *type, MVMint64 value);
 MVMint32 MVM_intcache_type_index(MVMThreadContext *tc, MVMObject *type);
+MVMObject * MVM_intcache_fill(MVMThreadContext *tc, MVMint16 slot, MVMint64 value);
+MVMint32 MVM_intcache_spesh_box(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
+    MVMSTable *st);
+void MVM_intcache_destroy(MVMThreadContext *tc, MVMIntConstCache *cache);
+
+/* Gets the boxed integer for an in-range value from a cache slot, creating
+ * it if this is the first time it is wanted. Entries are only published by a
+ * CAS once they are fully set up, so a plain read is enough. */
+MVM_STATIC_INLINE MVMObject * MVM_intcache_get_slot(MVMThreadContext *tc, MVMint16 slot,
+        MVMint64 value) {
+    MVMIntConstCache *cache = tc->instance->int_const_cache;
+    MVMObject *obj = cache->cache[slot][value - cache->min];
+    return obj ? obj : MVM_intcache_fill(tc, slot, value);
+}
@@ -95,9 +95,13 @@ static MVMObject * fastcreate(MVMThreadContext *tc, MVMuint8 *cur_op) {
     if (tc->allocate_in_gen2)
         MVM_panic(1, "Illegal use of a nursery-allocating spesh op when gen2 allocation flag set");
 #endif
-    obj->st              = (MVMSTable *)tc->cur_frame->effective_spesh_slots[GET_UI16(cur_op, 4)];
+    MVM_INIT_STABLE(obj, (MVMSTable *)tc->cur_frame->effective_spesh_slots[GET_UI16(cur_op, 4)]);
+#ifndef MVM_COMPACT_HEADERS
     obj->header.size     = size;
+#endif
     obj->header.owner    = tc->thread_id;
+    if (MVM_UNLIKELY(STABLE(obj)->pretenure_state == MVM_PRETENURE_SAMPLING))
+        MVM_gc_pretenure_sample(tc, obj);
     return obj;
 }
 
@@ -121,6 +125,19 @@ static MVMuint64 switch_endian(MVMuint64 val, unsigned char size) {
     MVM_panic(1, "Invalid size (%u) when attempting to switch endianness of %"PRIu64"\n", size, val);
 }
 
+/* Checks if the frame with the given sequence number is no longer running a
+ * frame it called (or itself), in which case an exception moved control out
+ * of the instruction MVM_interp_run_single_op was running. */
+static MVMint32 unwound_single_op_frame(MVMThreadContext *tc, MVMint32 frame_nr) {
+    MVMFrame *f = tc->cur_frame;
+    if (f == NULL || f->sequence_nr == frame_nr)
+        return 1;
+    while ((f = f->caller) != NULL)
+        if (f->sequence_nr == frame_nr)
+            return 0;
+    return 1;
+}
+
 /* This is the interpreter run loop. We have one of these per thread. */
 void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContext *, void *), void *invoke_data, MVMRunloopState *outer_runloop) {
 #if MVM_CGOTO
@@ -165,7 +182,16 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
 
     /* Set jump point, for if we arrive back in the interpreter from an
      * exception thrown from C code. */
-    setjmp(tc->interp_jump);
+    if (setjmp(tc->interp_jump)) {
+        /* When running a single instruction for the JIT, anything that
+         * unwound out of the frame we ran it in has to be handled by the
+         * outer runloop. */
+        if (outer_runloop && outer_runloop->single_op_frame_nr >= 0
+                && unwound_single_op_frame(tc, outer_runloop->single_op_frame_nr)) {
+            outer_runloop->single_op_unwound = 1;
+            goto return_label;
+        }
+    }
 
 #if !MVM_CGOTO
     /* Enter runloop. */
@@ -1224,7 +1250,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 cur_op += 2;
                 goto NEXT;
             OP(getcode):
-                GET_REG(cur_op, 0).o = cu->body.coderefs[GET_UI16(cur_op, 2)];
+                GET_REG(cur_op, 0).o = MVM_cu_coderef(tc, cu, GET_UI16(cur_op, 2));
                 cur_op += 4;
                 goto NEXT;
             OP(caller): {
@@ -1234,7 +1260,9 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 while (caller && depth-- > 0) /* keep the > 0. */
                     caller = caller->caller;
 
-                GET_REG(cur_op, 0).o = caller ? caller->code_ref : tc->instance->VMNull;
+                GET_REG(cur_op, 0).o = caller
+                    ? MVM_frame_escaping_code(tc, caller->code_ref)
+                    : tc->instance->VMNull;
 
                 cur_op += 4;
                 goto NEXT;
@@ -2631,7 +2659,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 goto NEXT;
             }
             OP(setboolspec): {
-                MVMSTable            *st = GET_REG(cur_op, 0).o->st;
+                MVMSTable            *st = STABLE(GET_REG(cur_op, 0).o);
                 MVMBoolificationSpec *bs = MVM_malloc(sizeof(MVMBoolificationSpec));
                 MVMBoolificationSpec *orig_bs = st->boolification_spec;
                 bs->mode = (MVMuint32)GET_REG(cur_op, 2).i64;
@@ -3317,17 +3345,10 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 if (REPR(maybe_cu)->ID == MVM_REPR_ID_MVMCompUnit) {
                     MVMCompUnit *cu = (MVMCompUnit *)maybe_cu;
                     if (cu->body.mainline_frame) {
-                        MVMObject *coderef;
-                        for (MVMuint32 i = 0; i < cu->body.num_frames; i++) {
-                            if (((MVMCode*)cu->body.coderefs[i])->body.sf == cu->body.mainline_frame) {
-                                coderef = cu->body.coderefs[i];
-                                break;
-                            }
-                        }
-                        GET_REG(cur_op, 0).o = coderef ? coderef : cu->body.coderefs[0];
+                        GET_REG(cur_op, 0).o = (MVMObject *)cu->body.mainline_frame->body.static_code;
                     }
                     else {
-                        GET_REG(cur_op, 0).o = cu->body.coderefs[0];
+                        GET_REG(cur_op, 0).o = MVM_cu_coderef(tc, cu, 0);
                     }
                 }
                 else {
@@ -3342,12 +3363,13 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 CHECK_CONC(maybe_cu);
                 if (REPR(maybe_cu)->ID == MVM_REPR_ID_MVMCompUnit) {
                     const MVMuint32 num_frames  = maybe_cu->body.num_frames;
-                    MVMObject ** const coderefs = maybe_cu->body.coderefs;
                     MVMuint32 i;
 
-                    for (i = 0; i < num_frames; i++) {
-                        MVM_repr_push_o(tc, result, coderefs[i]);
-                    }
+                    MVMROOT2(tc, result, maybe_cu, {
+                        for (i = 0; i < num_frames; i++) {
+                            MVM_repr_push_o(tc, result, MVM_cu_coderef(tc, maybe_cu, i));
+                        }
+                    });
 
                     GET_REG(cur_op, 0).o = result;
                 }
@@ -3390,7 +3412,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 goto NEXT;
             }
             OP(curcode):
-                GET_REG(cur_op, 0).o = tc->cur_frame->code_ref;
+                GET_REG(cur_op, 0).o = MVM_frame_cur_code(tc);
                 cur_op += 2;
                 goto NEXT;
             OP(callercode):
@@ -4209,9 +4231,12 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue))
                     GET_REG(cur_op, 0).o = MVM_concblockingqueue_poll(tc,
                         (MVMConcBlockingQueue *)queue);
+                else if (REPR(queue)->ID == MVM_REPR_ID_ConcRingQueue && IS_CONCRETE(queue))
+                    GET_REG(cur_op, 0).o = MVM_concringqueue_poll(tc,
+                        (MVMConcRingQueue *)queue);
                 else
                     MVM_exception_throw_adhoc(tc,
-                        "queuepoll requires a concrete object with REPR ConcBlockingQueue, got %s (%s)",
+                        "queuepoll requires a concrete object with REPR ConcBlockingQueue or ConcRingQueue, got %s (%s)",
                         REPR(queue)->name, MVM_6model_get_debug_name(tc, queue));
                 cur_op += 4;
                 goto NEXT;
@@ -4452,7 +4477,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             OP(osrpoint):
                 if (MVM_spesh_log_is_logging(tc))
                     MVM_spesh_log_osr(tc);
-                MVM_spesh_osr_poll_for_result(tc);
+                MVM_spesh_osr_poll(tc);
                 goto NEXT;
             OP(nativecallcast):
                 GET_REG(cur_op, 0).o = MVM_nativecall_cast(tc, GET_REG(cur_op, 2).o,
@@ -5728,6 +5753,383 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 cur_op += 2;
                 goto NEXT;
             }
+            OP(fsastats):
+                MVM_fixed_size_stats(tc, tc->instance->fsa, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(gcstats):
+                MVM_gc_stats(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(pinobj):
+                MVM_gc_root_pin(tc, (MVMCollectable *)GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(unpinobj):
+                MVM_gc_root_unpin(tc, (MVMCollectable *)GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(dumpallocsamples):
+                MVM_gc_alloc_samples_dump(tc);
+                goto NEXT;
+            OP(strbuilderappend_s): {
+                MVMObject *sb = GET_REG(cur_op, 0).o;
+                MVM_string_builder_ensure(tc, sb, "strbuilderappend_s");
+                MVM_string_builder_append_s(tc, (MVMStringBuilder *)sb, GET_REG(cur_op, 2).s);
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(strbuilderappend_i): {
+                MVMObject *sb = GET_REG(cur_op, 0).o;
+                MVM_string_builder_ensure(tc, sb, "strbuilderappend_i");
+                MVM_string_builder_append_i(tc, (MVMStringBuilder *)sb, GET_REG(cur_op, 2).i64);
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(strbuilderappend_n): {
+                MVMObject *sb = GET_REG(cur_op, 0).o;
+                MVM_string_builder_ensure(tc, sb, "strbuilderappend_n");
+                MVM_string_builder_append_n(tc, (MVMStringBuilder *)sb, GET_REG(cur_op, 2).n64);
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(strbuilderfinish): {
+                MVMObject *sb = GET_REG(cur_op, 2).o;
+                MVM_string_builder_ensure(tc, sb, "strbuilderfinish");
+                GET_REG(cur_op, 0).s = MVM_string_builder_finish(tc, (MVMStringBuilder *)sb);
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(strsearchcompile): {
+                MVMObject *searcher = GET_REG(cur_op, 0).o;
+                MVM_string_searcher_ensure(tc, searcher, "strsearchcompile");
+                MVM_string_searcher_compile(tc, (MVMStringSearcher *)searcher, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(strsearchall): {
+                MVMObject *searcher = GET_REG(cur_op, 2).o;
+                MVM_string_searcher_ensure(tc, searcher, "strsearchall");
+                GET_REG(cur_op, 0).o = MVM_string_searcher_find_all(tc, (MVMStringSearcher *)searcher,
+                    GET_REG(cur_op, 4).s, GET_REG(cur_op, 6).i64);
+                cur_op += 8;
+                goto NEXT;
+            }
+            OP(unicollkey):
+                GET_REG(cur_op, 0).o = MVM_unicode_string_collation_key(tc,
+                    GET_REG(cur_op, 2).s, GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).o);
+                cur_op += 8;
+                goto NEXT;
+            OP(unisort):
+                GET_REG(cur_op, 0).o = MVM_unicode_string_sort(tc,
+                    GET_REG(cur_op, 2).o, GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).i64);
+                cur_op += 8;
+                goto NEXT;
+            OP(encodeinto):
+                GET_REG(cur_op, 0).i64 = MVM_string_encode_into_buf_config(tc, GET_REG(cur_op, 2).s,
+                    GET_REG(cur_op, 4).s, GET_REG(cur_op, 8).o, GET_REG(cur_op, 10).i64,
+                    GET_REG(cur_op, 6).s, GET_REG(cur_op, 12).i64);
+                cur_op += 14;
+                goto NEXT;
+            OP(sethashordered):
+                MVM_hash_set_ordered(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(hashpresize):
+                MVM_hash_presize(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64);
+                cur_op += 4;
+                goto NEXT;
+            OP(hashbindall):
+                MVM_hash_bind_all(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o);
+                cur_op += 6;
+                goto NEXT;
+            OP(hashmerge):
+                MVM_hash_merge(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrsum_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_sum_i(tc, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrsum_n):
+                GET_REG(cur_op, 0).n64 = MVM_VMArray_sum_n(tc, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmin_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_minmax_i(tc, GET_REG(cur_op, 2).o, 0);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmax_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_minmax_i(tc, GET_REG(cur_op, 2).o, 1);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmin_n):
+                GET_REG(cur_op, 0).n64 = MVM_VMArray_minmax_n(tc, GET_REG(cur_op, 2).o, 0);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmax_n):
+                GET_REG(cur_op, 0).n64 = MVM_VMArray_minmax_n(tc, GET_REG(cur_op, 2).o, 1);
+                cur_op += 4;
+                goto NEXT;
+            OP(arradd_i):
+                MVM_VMArray_scalar_op_i(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64, 0);
+                cur_op += 4;
+                goto NEXT;
+            OP(arradd_n):
+                MVM_VMArray_scalar_op_n(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).n64, 0);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmul_i):
+                MVM_VMArray_scalar_op_i(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64, 1);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmul_n):
+                MVM_VMArray_scalar_op_n(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).n64, 1);
+                cur_op += 4;
+                goto NEXT;
+            OP(arraddarr):
+                MVM_VMArray_elementwise_op(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o, 0);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrmularr):
+                MVM_VMArray_elementwise_op(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o, 1);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrfill_i):
+                MVM_VMArray_fill_i(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrfill_n):
+                MVM_VMArray_fill_n(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).n64);
+                cur_op += 4;
+                goto NEXT;
+            OP(arrfind_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_find_i(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64);
+                cur_op += 6;
+                goto NEXT;
+            OP(arrfind_n):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_find_n(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).n64);
+                cur_op += 6;
+                goto NEXT;
+            OP(arrviewbind):
+                MVM_array_view_bind(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).i64, GET_REG(cur_op, 8).i64);
+                cur_op += 10;
+                goto NEXT;
+            OP(queuepushall):
+                MVM_concringqueue_push_all(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(queuepollmany):
+                GET_REG(cur_op, 0).i64 = MVM_concringqueue_poll_many(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).i64);
+                cur_op += 8;
+                goto NEXT;
+            OP(schedsubmit):
+                MVM_scheduler_submit(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(readlock):
+                MVM_rwlock_read_lock(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(readunlock):
+                MVM_rwlock_read_unlock(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(writelock):
+                MVM_rwlock_write_lock(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(writeunlock):
+                MVM_rwlock_write_unlock(tc, GET_REG(cur_op, 0).o);
+                cur_op += 2;
+                goto NEXT;
+            OP(arratomicload_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_atomic_load_i(tc,
+                    GET_REG(cur_op, 2).o, GET_REG(cur_op, 4).i64, GET_I16(cur_op, 6));
+                cur_op += 8;
+                goto NEXT;
+            OP(arratomicstore_i):
+                MVM_VMArray_atomic_store_i(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64,
+                    GET_REG(cur_op, 4).i64, GET_I16(cur_op, 6));
+                cur_op += 8;
+                goto NEXT;
+            OP(arratomicadd_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_atomic_add_i(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).i64, GET_I16(cur_op, 8));
+                cur_op += 10;
+                goto NEXT;
+            OP(arratomicxchg_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_atomic_xchg_i(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).i64, GET_I16(cur_op, 8));
+                cur_op += 10;
+                goto NEXT;
+            OP(arratomiccas_i):
+                GET_REG(cur_op, 0).i64 = MVM_VMArray_atomic_cas_i(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).i64, GET_REG(cur_op, 8).i64,
+                    GET_I16(cur_op, 10));
+                cur_op += 12;
+                goto NEXT;
+            OP(threadaffinity):
+                MVM_thread_set_affinity(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(threadpriority):
+                MVM_thread_set_priority(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64);
+                cur_op += 4;
+                goto NEXT;
+            OP(fiberawait): {
+                MVMRegister *res   = &GET_REG(cur_op, 0);
+                MVMObject   *queue = GET_REG(cur_op, 2).o;
+                cur_op += 4;
+                if (MVM_fiber_await(tc, queue, res))
+                    goto return_label;
+                goto NEXT;
+            }
+            OP(fiberyield):
+                if (MVM_fiber_yield(tc))
+                    goto return_label;
+                goto NEXT;
+            OP(asyncsendfile):
+                GET_REG(cur_op, 0).o = MVM_io_socket_send_file_async(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).o, GET_REG(cur_op, 8).o,
+                    GET_REG(cur_op, 10).o, GET_REG(cur_op, 12).i64, GET_REG(cur_op, 14).i64);
+                cur_op += 16;
+                goto NEXT;
+            OP(watchtree):
+                GET_REG(cur_op, 0).o = MVM_io_file_watch_tree(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).s, GET_REG(cur_op, 8).o,
+                    GET_REG(cur_op, 10).i64);
+                cur_op += 12;
+                goto NEXT;
+            OP(read_dir_all):
+                GET_REG(cur_op, 0).o = MVM_dir_read_all(tc, GET_REG(cur_op, 2).s,
+                    GET_REG(cur_op, 4).i64);
+                cur_op += 6;
+                goto NEXT;
+            OP(forkserver):
+                GET_REG(cur_op, 0).o = MVM_proc_fork_server(tc, GET_REG(cur_op, 2).s);
+                cur_op += 4;
+                goto NEXT;
+            OP(loadbundle):
+                MVM_cu_bundle_load(tc, GET_REG(cur_op, 0).s);
+                cur_op += 2;
+                goto NEXT;
+            OP(dumpcpusamples):
+                MVM_profile_cpu_samples_dump(tc, GET_REG(cur_op, 0).s);
+                cur_op += 2;
+                goto NEXT;
+            OP(vmstats):
+                GET_REG(cur_op, 0).o = MVM_vm_stats(tc);
+                cur_op += 2;
+                goto NEXT;
+            OP(parsenums):
+                GET_REG(cur_op, 0).i64 = MVM_parse_nums_str(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).s, GET_REG(cur_op, 6).s);
+                cur_op += 8;
+                goto NEXT;
+            OP(parsenumsbuf):
+                GET_REG(cur_op, 0).i64 = MVM_parse_nums_buf(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).s);
+                cur_op += 8;
+                goto NEXT;
+            OP(carrayview):
+                GET_REG(cur_op, 0).o = MVM_nativecall_carray_view(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o);
+                cur_op += 6;
+                goto NEXT;
+            OP(vmarrayview):
+                GET_REG(cur_op, 0).o = MVM_nativecall_vmarray_view(tc, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).i64);
+                cur_op += 8;
+                goto NEXT;
+            OP(mdfill_i):
+                MVM_MultiDimArray_fill_i(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(mdfill_n):
+                MVM_MultiDimArray_fill_n(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).n64);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(mdcopy):
+                MVM_MultiDimArray_copy(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(mdtranspose):
+                MVM_MultiDimArray_transpose(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(mdelemwise):
+                MVM_MultiDimArray_elemwise(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).i64);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 8;
+                goto NEXT;
+            OP(mdreadline):
+                MVM_MultiDimArray_read_line(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).o, GET_REG(cur_op, 6).i64);
+                cur_op += 8;
+                goto NEXT;
+            OP(mdwriteline):
+                MVM_MultiDimArray_write_line(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).o,
+                    GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).o);
+                MVM_SC_WB_OBJ(tc, GET_REG(cur_op, 0).o);
+                cur_op += 8;
+                goto NEXT;
+            OP(semacquiren): {
+                MVMObject *sem = GET_REG(cur_op, 0).o;
+                if (REPR(sem)->ID == MVM_REPR_ID_Semaphore && IS_CONCRETE(sem))
+                    MVM_semaphore_acquire_n(tc, (MVMSemaphore *)sem, GET_REG(cur_op, 2).i64);
+                else
+                    MVM_exception_throw_adhoc(tc,
+                        "semacquiren requires a concrete object with REPR Semaphore, got %s (%s)",
+                        REPR(sem)->name, MVM_6model_get_debug_name(tc, sem));
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(semtryacquiren): {
+                MVMObject *sem = GET_REG(cur_op, 2).o;
+                if (REPR(sem)->ID == MVM_REPR_ID_Semaphore && IS_CONCRETE(sem))
+                    GET_REG(cur_op, 0).i64 = MVM_semaphore_tryacquire_n(tc,
+                        (MVMSemaphore *)sem, GET_REG(cur_op, 4).i64, GET_REG(cur_op, 6).n64);
+                else
+                    MVM_exception_throw_adhoc(tc,
+                        "semtryacquiren requires a concrete object with REPR Semaphore, got %s (%s)",
+                        REPR(sem)->name, MVM_6model_get_debug_name(tc, sem));
+                cur_op += 8;
+                goto NEXT;
+            }
+            OP(semreleasen): {
+                MVMObject *sem = GET_REG(cur_op, 0).o;
+                if (REPR(sem)->ID == MVM_REPR_ID_Semaphore && IS_CONCRETE(sem))
+                    MVM_semaphore_release_n(tc, (MVMSemaphore *)sem, GET_REG(cur_op, 2).i64);
+                else
+                    MVM_exception_throw_adhoc(tc,
+                        "semreleasen requires a concrete object with REPR Semaphore, got %s (%s)",
+                        REPR(sem)->name, MVM_6model_get_debug_name(tc, sem));
+                cur_op += 4;
+                goto NEXT;
+            }
+            OP(condwaittimeout): {
+                MVMObject *cv = GET_REG(cur_op, 2).o;
+                if (REPR(cv)->ID == MVM_REPR_ID_ConditionVariable && IS_CONCRETE(cv))
+                    GET_REG(cur_op, 0).i64 = MVM_conditionvariable_wait_timeout(tc,
+                        (MVMConditionVariable *)cv, GET_REG(cur_op, 4).n64);
+                else
+                    MVM_exception_throw_adhoc(tc,
+                        "condwaittimeout requires a concrete object with REPR ConditionVariable, got %s (%s)",
+                        REPR(cv)->name, MVM_6model_get_debug_name(tc, cv));
+                cur_op += 6;
+                goto NEXT;
+            }
             OP(sp_guard): {
                 MVMRegister *target = &GET_REG(cur_op, 0);
                 MVMObject *check = GET_REG(cur_op, 2).o;
@@ -6281,9 +6683,9 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             }
             OP(sp_fastbox_i_ic): {
                 MVMint64 value = GET_REG(cur_op, 8).i64;
-                if (value >= -1 && value < 15) {
+                if (MVM_INTCACHE_RANGE_CHECK(tc, value)) {
                     MVMint16 slot = GET_UI16(cur_op, 10);
-                    GET_REG(cur_op, 0).o = tc->instance->int_const_cache->cache[slot][value + 1];
+                    GET_REG(cur_op, 0).o = MVM_intcache_get_slot(tc, slot, value);
                 }
                 else {
                     MVMObject *obj = fastcreate(tc, cur_op);
@@ -6295,9 +6697,9 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             }
             OP(sp_fastbox_bi_ic): {
                 MVMint64 value = GET_REG(cur_op, 8).i64;
-                if (value >= -1 && value < 15) {
+                if (MVM_INTCACHE_RANGE_CHECK(tc, value)) {
                     MVMint16 slot = GET_UI16(cur_op, 10);
-                    GET_REG(cur_op, 0).o = tc->instance->int_const_cache->cache[slot][value + 1];
+                    GET_REG(cur_op, 0).o = MVM_intcache_get_slot(tc, slot, value);
                 }
                 else {
                     MVMObject *obj = fastcreate(tc, cur_op);
@@ -6462,12 +6864,12 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 MVMObject *expected = GET_REG(cur_op, 4).o;
                 MVMObject *value = GET_REG(cur_op, 6).o;
                 cur_op += 8;
-                target->st->container_spec->cas(tc, target, expected, value, result);
+                STABLE(target)->container_spec->cas(tc, target, expected, value, result);
                 goto NEXT;
             }
             OP(sp_atomicload_o): {
                 MVMObject *target = GET_REG(cur_op, 2).o;
-                GET_REG(cur_op, 0).o = target->st->container_spec->atomic_load(tc, target);
+                GET_REG(cur_op, 0).o = STABLE(target)->container_spec->atomic_load(tc, target);
                 cur_op += 4;
                 goto NEXT;
             }
@@ -6475,7 +6877,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 MVMObject *target = GET_REG(cur_op, 0).o;
                 MVMObject *value = GET_REG(cur_op, 2).o;
                 cur_op += 4;
-                target->st->container_spec->atomic_store(tc, target, value);
+                STABLE(target)->container_spec->atomic_store(tc, target, value);
                 goto NEXT;
             }
             OP(sp_add_I): {
@@ -6487,14 +6889,14 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 if (ba->u.smallint.flag == MVM_BIGINT_32_FLAG && bb->u.smallint.flag == MVM_BIGINT_32_FLAG) {
                     MVMint64 result = (MVMint64)ba->u.smallint.value + (MVMint64)bb->u.smallint.value;
                     if (MVM_IS_32BIT_INT(result)) {
-                        if (result < -1 || result >= 15) {
+                        if (!MVM_INTCACHE_RANGE_CHECK(tc, result)) {
                             result_obj = fastcreate(tc, cur_op);
                             bc = (MVMP6bigintBody *)((char *)result_obj + offset);
                             bc->u.smallint.value = (MVMint32)result;
                             bc->u.smallint.flag = MVM_BIGINT_32_FLAG;
                         }
                         else {
-                            result_obj = tc->instance->int_const_cache->cache[GET_UI16(cur_op, 12)][result + 1];
+                            result_obj = MVM_intcache_get_slot(tc, GET_UI16(cur_op, 12), result);
                         }
                     }
                 }
@@ -6518,14 +6920,14 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 if (ba->u.smallint.flag == MVM_BIGINT_32_FLAG && bb->u.smallint.flag == MVM_BIGINT_32_FLAG) {
                     MVMint64 result = (MVMint64)ba->u.smallint.value - (MVMint64)bb->u.smallint.value;
                     if (MVM_IS_32BIT_INT(result)) {
-                        if (result < -1 || result >= 15) {
+                        if (!MVM_INTCACHE_RANGE_CHECK(tc, result)) {
                             result_obj = fastcreate(tc, cur_op);
                             bc = (MVMP6bigintBody *)((char *)result_obj + offset);
                             bc->u.smallint.value = (MVMint32)result;
                             bc->u.smallint.flag = MVM_BIGINT_32_FLAG;
                         }
                         else {
-                            result_obj = tc->instance->int_const_cache->cache[GET_UI16(cur_op, 12)][result + 1];
+                            result_obj = MVM_intcache_get_slot(tc, GET_UI16(cur_op, 12), result);
                         }
                     }
                 }
@@ -6549,14 +6951,14 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 if (ba->u.smallint.flag == MVM_BIGINT_32_FLAG && bb->u.smallint.flag == MVM_BIGINT_32_FLAG) {
                     MVMint64 result = (MVMint64)ba->u.smallint.value * (MVMint64)bb->u.smallint.value;
                     if (MVM_IS_32BIT_INT(result)) {
-                        if (result < -1 || result >= 15) {
+                        if (!MVM_INTCACHE_RANGE_CHECK(tc, result)) {
                             result_obj = fastcreate(tc, cur_op);
                             bc = (MVMP6bigintBody *)((char *)result_obj + offset);
                             bc->u.smallint.value = (MVMint32)result;
                             bc->u.smallint.flag = MVM_BIGINT_32_FLAG;
                         }
                         else {
-                            result_obj = tc->instance->int_const_cache->cache[GET_UI16(cur_op, 12)][result + 1];
+                            result_obj = MVM_intcache_get_slot(tc, GET_UI16(cur_op, 12), result);
                         }
                     }
                 }
@@ -6585,6 +6987,118 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 cur_op += 6;
                 goto NEXT;
             }
+            OP(sp_findmeth_poly): {
+                /* Check each of the cached types in turn, so the common case
+                 * of a match doesn't need a call. */
+                MVMObject       *obj   = GET_REG(cur_op, 2).o;
+                MVMuint16        idx   = GET_UI16(cur_op, 8);
+                MVMint16         n     = GET_I16(cur_op, 10);
+                MVMCollectable **slots = tc->cur_frame->effective_spesh_slots + idx;
+                MVMSTable       *st    = STABLE(obj);
+                MVMint16         i;
+                for (i = 0; i < n; i++) {
+                    if ((MVMSTable *)slots[2 * i] == st) {
+                        GET_REG(cur_op, 0).o = (MVMObject *)slots[2 * i + 1];
+                        break;
+                    }
+                }
+                if (i == n) {
+                    /* May invoke, so pre-increment op counter */
+                    MVMString *name = MVM_cu_string(tc, cu, GET_UI32(cur_op, 4));
+                    MVMRegister *res = &GET_REG(cur_op, 0);
+                    cur_op += 12;
+                    MVM_6model_find_method(tc, obj, name, res, 1);
+                }
+                else {
+                    cur_op += 12;
+                }
+                goto NEXT;
+            }
+            OP(sp_atpos_i64_nc): {
+                MVMArrayBody *body = &((MVMArray *)GET_REG(cur_op, 2).o)->body;
+                GET_REG(cur_op, 0).i64 = body->slots.i64[body->start + GET_REG(cur_op, 4).i64];
+                cur_op += 6;
+                goto NEXT;
+            }
+            OP(sp_bindpos_i64_nc): {
+                MVMObject    *obj  = GET_REG(cur_op, 0).o;
+                MVMArrayBody *body = &((MVMArray *)obj)->body;
+                body->slots.i64[body->start + GET_REG(cur_op, 2).i64] = GET_REG(cur_op, 4).i64;
+                MVM_SC_WB_OBJ(tc, obj);
+                cur_op += 6;
+                goto NEXT;
+            }
+            OP(sp_jit_opdone):
+                goto return_label;
+            OP(sp_takeclosure_local):
+                GET_REG(cur_op, 0).o = MVM_frame_takeclosure_local(tc, GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_getarg_o_decont): {
+                MVMObject *obj;
+                MVMRegister *r;
+                GET_REG(cur_op, 0).o = tc->cur_frame->params.args[GET_UI16(cur_op, 2)].o;
+                cur_op += 6;
+                obj = GET_REG(cur_op, 2).o;
+                r = &GET_REG(cur_op, 0);
+                cur_op += 4;
+                if (obj && IS_CONCRETE(obj) && STABLE(obj)->container_spec)
+                    STABLE(obj)->container_spec->fetch(tc, obj, r);
+                else
+                    r->o = obj;
+                goto NEXT;
+            }
+            OP(sp_p6oget_o_decont): {
+                MVMObject *o   = GET_REG(cur_op, 2).o;
+                MVMObject *val = MVM_p6opaque_read_object(tc, o, GET_UI16(cur_op, 4));
+                MVMObject *obj;
+                MVMRegister *r;
+                GET_REG(cur_op, 0).o = val ? val : tc->instance->VMNull;
+                cur_op += 8;
+                obj = GET_REG(cur_op, 2).o;
+                r = &GET_REG(cur_op, 0);
+                cur_op += 4;
+                if (obj && IS_CONCRETE(obj) && STABLE(obj)->container_spec)
+                    STABLE(obj)->container_spec->fetch(tc, obj, r);
+                else
+                    r->o = obj;
+                goto NEXT;
+            }
+            OP(sp_const_s_concat_s):
+                GET_REG(cur_op, 0).s = MVM_cu_string(tc, cu, GET_UI32(cur_op, 2));
+                cur_op += 8;
+                GET_REG(cur_op, 0).s = MVM_string_concatenate(tc,
+                    GET_REG(cur_op, 2).s, GET_REG(cur_op, 4).s);
+                cur_op += 6;
+                goto NEXT;
+            OP(sp_iter_shift_arr_o):
+                GET_REG(cur_op, 0).o = MVM_iter_shift_array_o(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iter_shift_arr_i):
+                GET_REG(cur_op, 0).i64 = MVM_iter_shift_array_i(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iter_shift_arr_n):
+                GET_REG(cur_op, 0).n64 = MVM_iter_shift_array_n(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iter_shift_arr_s):
+                GET_REG(cur_op, 0).s = MVM_iter_shift_array_s(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iter_shift_hash):
+                GET_REG(cur_op, 0).o = MVM_iter_shift_hash(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iterkey_hash):
+                GET_REG(cur_op, 0).s = MVM_iterkey_s_hash(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
+            OP(sp_iterval_hash):
+                GET_REG(cur_op, 0).o = MVM_iterval_hash(tc, (MVMIter *)GET_REG(cur_op, 2).o);
+                cur_op += 4;
+                goto NEXT;
             OP(prof_enter):
                 MVM_profile_log_enter(tc, tc->cur_frame->static_info,
                     MVM_PROFILE_ENTER_NORMAL);
@@ -6607,8 +7121,8 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 MVM_profile_log_exit(tc);
                 goto NEXT;
             OP(prof_allocated):
-                MVM_profile_log_allocated(tc, GET_REG(cur_op, 0).o);
-                cur_op += 2;
+                MVM_profile_log_allocated(tc, GET_REG(cur_op, 0).o, GET_I32(cur_op, 2));
+                cur_op += 6;
                 goto NEXT;
             OP(prof_replaced):
                 MVM_profile_log_scalar_replaced(tc,
@@ -6682,10 +7196,16 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             OP(breakpoint): {
                 MVMuint32 file_idx = GET_UI32(cur_op, 0);
                 MVMuint32 line_no  = GET_UI32(cur_op, 4);
-                MVM_debugserver_breakpoint_check(tc, file_idx, line_no);
+                MVM_debugserver_breakpoint_check_fast(tc, file_idx, line_no);
                 cur_op += 8;
                 goto NEXT;
             }
+            OP(coverage_count): {
+                MVMuint64 *counts = (MVMuint64 *)(uintptr_t)MVM_BC_get_I64(cur_op, 4);
+                counts[GET_UI32(cur_op, 0)]++;
+                cur_op += 12;
+                goto NEXT;
+            }
 #if MVM_CGOTO
             OP_CALL_EXTOP: {
                 /* Bounds checking? Never heard of that. */
@@ -6738,7 +7258,7 @@ void MVM_interp_run_nested(MVMThreadContext *tc, void (*initial_invoke)(MVMThrea
     MVMFrame *backup_thread_entry_frame     = tc->thread_entry_frame;
     void **backup_jit_return_address        = tc->jit_return_address;
     tc->jit_return_address                  = NULL;
-    MVMRunloopState outer_runloop = {tc->interp_cur_op, tc->interp_bytecode_start, tc->interp_reg_base, tc->interp_cu};
+    MVMRunloopState outer_runloop = {tc->interp_cur_op, tc->interp_bytecode_start, tc->interp_reg_base, tc->interp_cu, -1, 0};
     MVMROOT2(tc, backup_cur_frame, backup_thread_entry_frame, {
         MVMuint32 backup_mark                   = MVM_gc_root_temp_mark(tc);
         jmp_buf backup_interp_jump;
@@ -6767,6 +7287,55 @@ void MVM_interp_run_nested(MVMThreadContext *tc, void (*initial_invoke)(MVMThrea
     });
 }
 
+static void setup_single_op(MVMThreadContext *tc, void *op) {
+    MVMFrame *frame = tc->cur_frame;
+    *(tc->interp_cur_op)         = (MVMuint8 *)op;
+    *(tc->interp_bytecode_start) = (MVMuint8 *)op;
+    *(tc->interp_reg_base)       = frame->work;
+    *(tc->interp_cu)             = frame->static_info->body.cu;
+}
+
+/* Runs a single instruction in the current frame, for JIT-compiled code that
+ * can't compile it itself. The instruction is encoded as in bytecode and must
+ * be followed by sp_jit_opdone. It runs in a runloop of its own, so that the
+ * JIT-compiled code can continue after it; if it throws an exception that is
+ * handled outside of it, or it otherwise moves control out of the frame, we
+ * pass that on to the outer runloop, like any other C code called from the
+ * JIT would. */
+void MVM_interp_run_single_op(MVMThreadContext *tc, MVMuint8 *op) {
+    MVMRunloopState outer_runloop = {tc->interp_cur_op, tc->interp_bytecode_start,
+                                     tc->interp_reg_base, tc->interp_cu,
+                                     tc->cur_frame->sequence_nr, 0};
+    MVMuint8 *outer_cur_op           = *tc->interp_cur_op;
+    MVMuint8 *outer_bytecode_start   = *tc->interp_bytecode_start;
+    void **backup_jit_return_address = tc->jit_return_address;
+    jmp_buf backup_interp_jump;
+    memcpy(backup_interp_jump, tc->interp_jump, sizeof(jmp_buf));
+
+    tc->nested_interpreter++;
+    MVM_interp_run(tc, setup_single_op, op, &outer_runloop);
+    tc->nested_interpreter--;
+
+    tc->interp_cur_op         = outer_runloop.interp_cur_op;
+    tc->interp_bytecode_start = outer_runloop.interp_bytecode_start;
+    tc->interp_reg_base       = outer_runloop.interp_reg_base;
+    tc->interp_cu             = outer_runloop.interp_cu;
+    tc->jit_return_address    = backup_jit_return_address;
+    memcpy(tc->interp_jump, backup_interp_jump, sizeof(jmp_buf));
+
+    /* The runloop stored its state in the outer one when it finished. If it
+     * was unwound, that is where the outer runloop should continue. */
+    if (outer_runloop.single_op_unwound)
+        longjmp(tc->interp_jump, 1);
+
+    /* Otherwise, we're back in the same frame, and the outer runloop should
+     * continue where it was. */
+    *tc->interp_cur_op         = outer_cur_op;
+    *tc->interp_bytecode_start = outer_bytecode_start;
+    *tc->interp_reg_base       = tc->cur_frame->work;
+    *tc->interp_cu             = tc->cur_frame->static_info->body.cu;
+}
+
 void MVM_interp_enable_tracing() {
     tracing_enabled = 1;
 }
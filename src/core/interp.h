@@ -105,11 +105,16 @@ struct MVMRunloopState {
     MVMuint8 **interp_bytecode_start;
     MVMRegister **interp_reg_base;
     MVMCompUnit **interp_cu;
+    /* Sequence number of the frame MVM_interp_run_single_op runs an
+     * instruction in, or -1, and whether it was unwound */
+    MVMint32 single_op_frame_nr;
+    MVMuint8 single_op_unwound;
 };
 
 /* Functions. */
 void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContext *, void *), void *invoke_data, MVMRunloopState *outer_runloop);
 void MVM_interp_run_nested(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContext *, void *), void *invoke_data, MVMRegister *res);
+void MVM_interp_run_single_op(MVMThreadContext *tc, MVMuint8 *op);
 MVM_PUBLIC void MVM_interp_enable_tracing();
 
 MVM_STATIC_INLINE MVMint64 MVM_BC_get_I64(const MVMuint8 *cur_op, int offset) {
@@ -368,7 +368,7 @@ void * MVM_nativecall_unmarshal_carray(MVMThreadContext *tc, MVMObject *value, M
     if (!IS_CONCRETE(value))
         return NULL;
     else if (REPR(value)->ID == MVM_REPR_ID_MVMCArray)
-        return ((MVMCArray *)value)->body.storage;
+        return MVM_carray_storage(&((MVMCArray *)value)->body);
     else
         unmarshal_error(tc, "CArray", value, unmarshal_kind);
 }
@@ -446,12 +446,23 @@ void init_box_call_node(MVMThreadContext *tc, MVMSpeshGraph *sg, MVMJitNode *box
     }
 }
 
+/* Unlinks the (last) box_rv_node, keeping any nodes that free strings after the
+ * thread is unblocked. */
+static void drop_box_rv_node(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitNode *unblock_gc_node, MVMJitNode *box_rv_node) {
+    MVMJitNode *node = unblock_gc_node;
+    while (node->next != box_rv_node)
+        node = node->next;
+    node->next = NULL;
+    jg->last_node = node;
+}
+
 MVMJitGraph *MVM_nativecall_jit_graph_for_caller_code(
     MVMThreadContext   *tc,
     MVMSpeshGraph      *sg,
     MVMNativeCallBody  *body,
     MVMint16            restype,
     MVMint16            dst,
+    MVMint16            unboxed_dst,
     MVMSpeshIns       **arg_ins
 ) {
     MVMJitGraph *jg = MVM_spesh_alloc(tc, sg, sizeof(MVMJitGraph)); /* will actually calloc */
@@ -563,7 +574,33 @@ MVMJitGraph *MVM_nativecall_jit_graph_for_caller_code(
         }
     }
 
-    if (body->ret_type == MVM_NATIVECALL_ARG_CHAR
+    if (unboxed_dst >= 0) {
+        /* The caller unboxes the result straight away, so store the return
+         * value into the unboxed register and skip boxing it altogether. */
+        if (body->ret_type == MVM_NATIVECALL_ARG_CHAR
+            || body->ret_type == MVM_NATIVECALL_ARG_UCHAR
+            || body->ret_type == MVM_NATIVECALL_ARG_SHORT
+            || body->ret_type == MVM_NATIVECALL_ARG_USHORT
+            || body->ret_type == MVM_NATIVECALL_ARG_INT
+            || body->ret_type == MVM_NATIVECALL_ARG_UINT
+            || body->ret_type == MVM_NATIVECALL_ARG_LONG
+            || body->ret_type == MVM_NATIVECALL_ARG_ULONG
+            || body->ret_type == MVM_NATIVECALL_ARG_LONGLONG
+            || body->ret_type == MVM_NATIVECALL_ARG_ULONGLONG
+        ) {
+            call_node->u.call.rv_mode = MVM_JIT_RV_INT;
+        }
+        else if (body->ret_type == MVM_NATIVECALL_ARG_DOUBLE) {
+            call_node->u.call.rv_mode = MVM_JIT_RV_NUM;
+        }
+        else {
+            goto fail;
+        }
+        call_node->u.call.rv_type = body->ret_type;
+        call_node->u.call.rv_idx  = unboxed_dst;
+        drop_box_rv_node(tc, jg, unblock_gc_node, box_rv_node);
+    }
+    else if (body->ret_type == MVM_NATIVECALL_ARG_CHAR
         || body->ret_type == MVM_NATIVECALL_ARG_UCHAR
         || body->ret_type == MVM_NATIVECALL_ARG_SHORT
         || body->ret_type == MVM_NATIVECALL_ARG_USHORT
@@ -600,9 +637,7 @@ MVMJitGraph *MVM_nativecall_jit_graph_for_caller_code(
         }
     }
     else if (body->ret_type == MVM_NATIVECALL_ARG_VOID) {
-        call_node->next = unblock_gc_node;
-        unblock_gc_node->next = NULL;
-        jg->last_node = unblock_gc_node;
+        drop_box_rv_node(tc, jg, unblock_gc_node, box_rv_node);
     }
     else {
         goto fail;
@@ -615,7 +650,7 @@ fail:
 
 MVMJitCode *create_caller_code(MVMThreadContext *tc, MVMNativeCallBody *body) {
     MVMSpeshGraph *sg = MVM_calloc(1, sizeof(MVMSpeshGraph));
-    MVMJitGraph *jg = MVM_nativecall_jit_graph_for_caller_code(tc, sg, body, -1, -1, NULL);
+    MVMJitGraph *jg = MVM_nativecall_jit_graph_for_caller_code(tc, sg, body, -1, -1, -1, NULL);
     MVMJitCode *jitcode;
     if (jg != NULL) {
         MVMJitNode *entry_label = MVM_spesh_alloc(tc, sg, sizeof(MVMJitNode));
@@ -959,6 +994,98 @@ MVMObject * MVM_nativecall_cast(MVMThreadContext *tc, MVMObject *target_spec, MV
     return nativecall_cast(tc, target_spec, target_type, data_body);
 }
 
+/* Checks that a CArray type and a VMArray type have elements of the same
+ * size and kind, so that they can share storage. */
+static void check_shareable(MVMThreadContext *tc, MVMObject *carray_type,
+        MVMObject *array_type, const char *what) {
+    MVMCArrayREPRData *c_repr_data;
+    MVMArrayREPRData  *a_repr_data;
+    MVMuint8 slot_type;
+    if (REPR(carray_type)->ID != MVM_REPR_ID_MVMCArray || !STABLE(carray_type)->REPR_data)
+        MVM_exception_throw_adhoc(tc, "%s needs a composed CArray type, but got a %s (%s)",
+            what, REPR(carray_type)->name, MVM_6model_get_debug_name(tc, carray_type));
+    if (REPR(array_type)->ID != MVM_REPR_ID_VMArray || !STABLE(array_type)->REPR_data)
+        MVM_exception_throw_adhoc(tc, "%s needs a composed native array type, but got a %s (%s)",
+            what, REPR(array_type)->name, MVM_6model_get_debug_name(tc, array_type));
+    c_repr_data = (MVMCArrayREPRData *)STABLE(carray_type)->REPR_data;
+    a_repr_data = (MVMArrayREPRData *)STABLE(array_type)->REPR_data;
+    slot_type   = a_repr_data->slot_type;
+    if (c_repr_data->elem_kind != MVM_CARRAY_ELEM_KIND_NUMERIC
+            || slot_type < MVM_ARRAY_I64 || slot_type > MVM_ARRAY_U8)
+        MVM_exception_throw_adhoc(tc, "%s can only share storage of arrays of native numbers", what);
+    if ((size_t)c_repr_data->elem_size != a_repr_data->elem_size
+            || (REPR(c_repr_data->elem_type)->get_storage_spec(tc,
+                    STABLE(c_repr_data->elem_type))->boxed_primitive == MVM_STORAGE_SPEC_BP_NUM)
+                != (slot_type == MVM_ARRAY_N64 || slot_type == MVM_ARRAY_N32))
+        MVM_exception_throw_adhoc(tc, "%s needs a CArray (%s) and a native array (%s) of the same element type",
+            what, MVM_6model_get_debug_name(tc, carray_type), MVM_6model_get_debug_name(tc, array_type));
+}
+
+/* Makes a CArray of the given type that is a view of the storage of a native
+ * array, without copying it. The array keeps owning the storage, and the view
+ * keeps the array alive; the view follows the array if it is resized, and
+ * binding past its end grows the array. */
+MVMObject * MVM_nativecall_carray_view(MVMThreadContext *tc, MVMObject *type, MVMObject *array) {
+    MVMObject *result;
+    if (!IS_CONCRETE(array) || REPR(array)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "carrayview needs a concrete native array");
+    check_shareable(tc, type, array, "carrayview");
+    MVMROOT(tc, array, {
+        result = REPR(type)->allocate(tc, STABLE(type));
+    });
+    MVM_ASSIGN_REF(tc, &(result->header), ((MVMCArray *)result)->body.source, array);
+    MVM_carray_storage(&((MVMCArray *)result)->body);
+    return result;
+}
+
+/* Makes a native array of the given type sharing the storage of a CArray,
+ * without copying it. If we manage the CArray's storage, it is handed over
+ * to the array, and the CArray turns into a view of the array. If it came
+ * from C, so is owned there, the array borrows it, and as we don't know how
+ * long it is, elems must say; the array copies out of it if it has to grow.
+ * A CArray that is already a view gives back the array it is a view of. */
+MVMObject * MVM_nativecall_vmarray_view(MVMThreadContext *tc, MVMObject *type, MVMObject *carray, MVMint64 elems) {
+    MVMCArrayBody *c_body;
+    MVMArrayBody  *a_body;
+    MVMObject     *result;
+    if (!IS_CONCRETE(carray) || REPR(carray)->ID != MVM_REPR_ID_MVMCArray)
+        MVM_exception_throw_adhoc(tc, "vmarrayview needs a concrete CArray");
+    check_shareable(tc, carray, type, "vmarrayview");
+    c_body = &((MVMCArray *)carray)->body;
+
+    if (c_body->source) {
+        if (STABLE(c_body->source) != STABLE(type))
+            MVM_exception_throw_adhoc(tc, "vmarrayview cannot view a CArray that is a view of a %s as a %s",
+                MVM_6model_get_debug_name(tc, c_body->source), MVM_6model_get_debug_name(tc, type));
+        return c_body->source;
+    }
+    if (c_body->managed ? elems > c_body->allocated : elems < 0)
+        MVM_exception_throw_adhoc(tc, "vmarrayview cannot view %"PRId64" elements of a CArray %s",
+            elems, c_body->managed ? "with fewer allocated" : "from C");
+    if (elems < 0)
+        elems = c_body->elems;
+
+    MVMROOT(tc, carray, {
+        result = REPR(type)->allocate(tc, STABLE(type));
+    });
+    c_body = &((MVMCArray *)carray)->body;
+    a_body = &((MVMArray *)result)->body;
+    a_body->slots.any = c_body->storage;
+    a_body->start     = 0;
+    a_body->elems     = elems;
+    if (c_body->managed) {
+        a_body->ssize      = c_body->allocated;
+        c_body->managed    = 0;
+        c_body->allocated  = 0;
+        MVM_ASSIGN_REF(tc, &(carray->header), c_body->source, result);
+    }
+    else {
+        a_body->ssize    = elems;
+        a_body->borrowed = 1;
+    }
+    return result;
+}
+
 MVMint64 MVM_nativecall_sizeof(MVMThreadContext *tc, MVMObject *obj) {
     if (REPR(obj)->ID == MVM_REPR_ID_MVMCStruct)
         return ((MVMCStructREPRData *)STABLE(obj)->REPR_data)->struct_size;
@@ -981,6 +1108,40 @@ MVMint64 MVM_nativecall_sizeof(MVMThreadContext *tc, MVMObject *obj) {
             REPR(obj)->name, MVM_6model_get_debug_name(tc, obj));
 }
 
+/* Gets the C memory a child object of a CArray or struct wraps; NULL for
+ * type objects and strings, which we can't tell the pointer of. */
+static void * wrapped_cptr(MVMObject *obj) {
+    if (!IS_CONCRETE(obj))
+        return NULL;
+    switch (REPR(obj)->ID) {
+        case MVM_REPR_ID_MVMCArray:
+            return ((MVMCArray *)obj)->body.storage;
+        case MVM_REPR_ID_MVMCPointer:
+            return ((MVMCPointer *)obj)->body.ptr;
+        case MVM_REPR_ID_MVMCStruct:
+            return ((MVMCStruct *)obj)->body.cstruct;
+        case MVM_REPR_ID_MVMCPPStruct:
+            return ((MVMCPPStruct *)obj)->body.cppstruct;
+        case MVM_REPR_ID_MVMCUnion:
+            return ((MVMCUnion *)obj)->body.cunion;
+        default:
+            return NULL;
+    }
+}
+
+/* Checks the child object of a struct member is still for what the member
+ * holds, given the member's address, refreshing it if so and dropping it to
+ * be made again on the next access if not. The member is the child's memory
+ * itself if it is inlined, and otherwise a pointer to it. */
+static void refresh_child(MVMThreadContext *tc, MVMObject **child_objs, MVMint32 slot,
+        char *member, MVMint32 inlined) {
+    void *cptr = inlined ? (void *)member : *(void **)member;
+    if (wrapped_cptr(child_objs[slot]) != cptr)
+        child_objs[slot] = NULL;
+    else
+        MVM_nativecall_refresh(tc, child_objs[slot]);
+}
+
 /* Write-barriers a dyncall object so that delayed changes to the C-side of
  * objects are propagated to the HLL side. All CArray and CStruct arguments to
  * C functions are write-barriered automatically, so this should be necessary
@@ -1046,113 +1207,46 @@ void MVM_nativecall_refresh(MVMThreadContext *tc, MVMObject *cthingy) {
     else if (REPR(cthingy)->ID == MVM_REPR_ID_MVMCStruct) {
         MVMCStructBody     *body      = (MVMCStructBody *)OBJECT_BODY(cthingy);
         MVMCStructREPRData *repr_data = (MVMCStructREPRData *)STABLE(cthingy)->REPR_data;
-        char               *storage   = (char *) body->cstruct;
-        MVMint64            i;
-
-        for (i = 0; i < repr_data->num_attributes; i++) {
-            MVMint32  kind = repr_data->attribute_locations[i] & MVM_CSTRUCT_ATTR_MASK;
-            MVMint32  slot = repr_data->attribute_locations[i] >> MVM_CSTRUCT_ATTR_SHIFT;
-            void *cptr   = NULL; /* Address of the struct member holding the pointer in the C storage. */
-            void *objptr = NULL; /* The pointer in the object representing the C object. */
-
-            if (kind == MVM_CSTRUCT_ATTR_IN_STRUCT || !body->child_objs[slot])
-                continue;
-
-            cptr = (void *)(storage + (uintptr_t)repr_data->struct_offsets[i]);
-            if (IS_CONCRETE(body->child_objs[slot])) {
-                switch (kind) {
-                    case MVM_CSTRUCT_ATTR_CARRAY:
-                        objptr = ((MVMCArrayBody *)OBJECT_BODY(body->child_objs[slot]))->storage;
-                        break;
-                    case MVM_CSTRUCT_ATTR_CPTR:
-                        objptr = ((MVMCPointerBody *)OBJECT_BODY(body->child_objs[slot]))->ptr;
-                        break;
-                    case MVM_CSTRUCT_ATTR_CSTRUCT:
-                        objptr = (MVMCStructBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CSTRUCT_ATTR_CPPSTRUCT:
-                        objptr = (MVMCPPStructBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CSTRUCT_ATTR_CUNION:
-                        objptr = (MVMCUnionBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CSTRUCT_ATTR_STRING:
-                        objptr = NULL;
-                        break;
-                    default:
-                        MVM_exception_throw_adhoc(tc,
-                            "Fatal error: bad kind (%d) in CStruct write barrier",
-                            kind);
-                }
-            }
-            else {
-                objptr = NULL;
-            }
-
-            if (objptr != cptr)
-                body->child_objs[slot] = NULL;
-            else
-                MVM_nativecall_refresh(tc, body->child_objs[slot]);
+        MVMint32            i;
+
+        /* Only the members with child objects can be out of date. */
+        for (i = 0; repr_data->child_attrs[i] >= 0; i++) {
+            MVMint32 attr = repr_data->child_attrs[i];
+            MVMint32 slot = repr_data->attribute_locations[attr] >> MVM_CSTRUCT_ATTR_SHIFT;
+            if (body->child_objs[slot])
+                refresh_child(tc, body->child_objs, slot, (char *)body->cstruct
+                    + repr_data->struct_offsets[attr],
+                    repr_data->attribute_locations[attr] & MVM_CSTRUCT_ATTR_INLINED);
         }
     }
     else if (REPR(cthingy)->ID == MVM_REPR_ID_MVMCPPStruct) {
         MVMCPPStructBody     *body      = (MVMCPPStructBody *)OBJECT_BODY(cthingy);
         MVMCPPStructREPRData *repr_data = (MVMCPPStructREPRData *)STABLE(cthingy)->REPR_data;
-        char                 *storage   = (char *) body->cppstruct;
-        MVMint64              i;
+        MVMint32              i;
 
         for (i = 0; i < repr_data->num_attributes; i++) {
             MVMint32 kind = repr_data->attribute_locations[i] & MVM_CPPSTRUCT_ATTR_MASK;
             MVMint32 slot = repr_data->attribute_locations[i] >> MVM_CPPSTRUCT_ATTR_SHIFT;
-            void *cptr = NULL;   /* The pointer in the C storage. */
-            void *objptr = NULL; /* The pointer in the object representing the C object. */
-
-            if (kind == MVM_CPPSTRUCT_ATTR_IN_STRUCT || !body->child_objs[slot])
-                continue;
-
-            cptr = (void *)(storage + (uintptr_t)repr_data->struct_offsets[i]);
-            if (IS_CONCRETE(body->child_objs[slot])) {
-                switch (kind) {
-                    case MVM_CPPSTRUCT_ATTR_CARRAY:
-                        objptr = ((MVMCArrayBody *)OBJECT_BODY(body->child_objs[slot]))->storage;
-                        break;
-                    case MVM_CPPSTRUCT_ATTR_CPTR:
-                        objptr = ((MVMCPointerBody *)OBJECT_BODY(body->child_objs[slot]))->ptr;
-                        break;
-                    case MVM_CPPSTRUCT_ATTR_CSTRUCT:
-                        objptr = (MVMCStructBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CPPSTRUCT_ATTR_CPPSTRUCT:
-                        objptr = (MVMCPPStructBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CPPSTRUCT_ATTR_CUNION:
-                        objptr = (MVMCUnionBody *)OBJECT_BODY(body->child_objs[slot]);
-                        break;
-                    case MVM_CPPSTRUCT_ATTR_STRING:
-                        objptr = NULL;
-                        break;
-                    default:
-                        MVM_exception_throw_adhoc(tc,
-                            "Fatal error: bad kind (%d) in CPPStruct write barrier",
-                            kind);
-                }
-            }
-            else {
-                objptr = NULL;
-            }
-
-            if (objptr != cptr)
-                body->child_objs[slot] = NULL;
-            else
-                MVM_nativecall_refresh(tc, body->child_objs[slot]);
+            if (kind != MVM_CPPSTRUCT_ATTR_IN_STRUCT && body->child_objs[slot])
+                refresh_child(tc, body->child_objs, slot, (char *)body->cppstruct
+                    + repr_data->struct_offsets[i],
+                    repr_data->attribute_locations[i] & MVM_CPPSTRUCT_ATTR_INLINED);
         }
     }
 }
 
 /* Locate the thread that a callback should be run on. */
 MVMThreadContext * MVM_nativecall_find_thread_context(MVMInstance *instance) {
-    MVMint64 wanted_thread_id = MVM_platform_thread_id();
-    MVMThreadContext *tc = NULL;
+    MVMint64 wanted_thread_id;
+    MVMThreadContext *tc = (MVMThreadContext *)uv_key_get(&instance->native_thread_tc);
+
+    /* Usually the thread context was stashed when the thread started. This
+     * doesn't touch the threads list, so needn't wait for a GC to finish;
+     * the callback unblocks the thread before doing anything, which will. */
+    if (tc)
+        return tc;
+
+    wanted_thread_id = MVM_platform_thread_id();
     while (1) {
         uv_mutex_lock(&(instance->mutex_threads));
         if (instance->in_gc) {
@@ -1179,6 +1273,7 @@ MVMThreadContext * MVM_nativecall_find_thread_context(MVMInstance *instance) {
                 MVM_panic(1, "native callback ran on thread (%"PRId64") unknown to MoarVM",
                     wanted_thread_id);
             uv_mutex_unlock(&(instance->mutex_threads));
+            uv_key_set(&instance->native_thread_tc, tc);
             break;
         }
     }
@@ -102,6 +102,8 @@ MVMObject * MVM_nativecall_global(MVMThreadContext *tc, MVMString *lib, MVMStrin
 MVMObject * MVM_nativecall_cast(MVMThreadContext *tc, MVMObject *target_spec,
     MVMObject *res_type, MVMObject *obj);
 MVMint64 MVM_nativecall_sizeof(MVMThreadContext *tc, MVMObject *obj);
+MVMObject * MVM_nativecall_carray_view(MVMThreadContext *tc, MVMObject *type, MVMObject *array);
+MVMObject * MVM_nativecall_vmarray_view(MVMThreadContext *tc, MVMObject *type, MVMObject *carray, MVMint64 elems);
 void MVM_nativecall_refresh(MVMThreadContext *tc, MVMObject *cthingy);
 
 MVMObject * MVM_nativecall_make_cstruct(MVMThreadContext *tc, MVMObject *type, void *cstruct);
@@ -142,5 +144,6 @@ MVMJitGraph *MVM_nativecall_jit_graph_for_caller_code(
     MVMNativeCallBody  *body,
     MVMint16            restype,
     MVMint16            dst,
+    MVMint16            unboxed_dst,
     MVMSpeshIns       **arg_ins
 );
@@ -826,6 +826,79 @@ static const void * const LABELS[] = {
     &&OP_totalmem,
     &&OP_nextdispatcherfor,
     &&OP_takenextdispatcher,
+    &&OP_fsastats,
+    &&OP_gcstats,
+    &&OP_pinobj,
+    &&OP_unpinobj,
+    &&OP_dumpallocsamples,
+    &&OP_strbuilderappend_s,
+    &&OP_strbuilderappend_i,
+    &&OP_strbuilderappend_n,
+    &&OP_strbuilderfinish,
+    &&OP_strsearchcompile,
+    &&OP_strsearchall,
+    &&OP_unicollkey,
+    &&OP_unisort,
+    &&OP_encodeinto,
+    &&OP_sethashordered,
+    &&OP_hashpresize,
+    &&OP_hashbindall,
+    &&OP_hashmerge,
+    &&OP_arrsum_i,
+    &&OP_arrsum_n,
+    &&OP_arrmin_i,
+    &&OP_arrmax_i,
+    &&OP_arrmin_n,
+    &&OP_arrmax_n,
+    &&OP_arradd_i,
+    &&OP_arradd_n,
+    &&OP_arrmul_i,
+    &&OP_arrmul_n,
+    &&OP_arraddarr,
+    &&OP_arrmularr,
+    &&OP_arrfill_i,
+    &&OP_arrfill_n,
+    &&OP_arrfind_i,
+    &&OP_arrfind_n,
+    &&OP_arrviewbind,
+    &&OP_queuepushall,
+    &&OP_queuepollmany,
+    &&OP_schedsubmit,
+    &&OP_readlock,
+    &&OP_readunlock,
+    &&OP_writelock,
+    &&OP_writeunlock,
+    &&OP_arratomicload_i,
+    &&OP_arratomicstore_i,
+    &&OP_arratomicadd_i,
+    &&OP_arratomicxchg_i,
+    &&OP_arratomiccas_i,
+    &&OP_threadaffinity,
+    &&OP_threadpriority,
+    &&OP_fiberawait,
+    &&OP_fiberyield,
+    &&OP_asyncsendfile,
+    &&OP_watchtree,
+    &&OP_read_dir_all,
+    &&OP_forkserver,
+    &&OP_loadbundle,
+    &&OP_dumpcpusamples,
+    &&OP_vmstats,
+    &&OP_parsenums,
+    &&OP_parsenumsbuf,
+    &&OP_carrayview,
+    &&OP_vmarrayview,
+    &&OP_mdfill_i,
+    &&OP_mdfill_n,
+    &&OP_mdcopy,
+    &&OP_mdtranspose,
+    &&OP_mdelemwise,
+    &&OP_mdreadline,
+    &&OP_mdwriteline,
+    &&OP_semacquiren,
+    &&OP_semtryacquiren,
+    &&OP_semreleasen,
+    &&OP_condwaittimeout,
     &&OP_sp_guard,
     &&OP_sp_guardconc,
     &&OP_sp_guardtype,
@@ -913,6 +986,21 @@ static const void * const LABELS[] = {
     &&OP_sp_sub_I,
     &&OP_sp_mul_I,
     &&OP_sp_bool_I,
+    &&OP_sp_findmeth_poly,
+    &&OP_sp_atpos_i64_nc,
+    &&OP_sp_bindpos_i64_nc,
+    &&OP_sp_jit_opdone,
+    &&OP_sp_takeclosure_local,
+    &&OP_sp_getarg_o_decont,
+    &&OP_sp_p6oget_o_decont,
+    &&OP_sp_const_s_concat_s,
+    &&OP_sp_iter_shift_arr_o,
+    &&OP_sp_iter_shift_arr_i,
+    &&OP_sp_iter_shift_arr_n,
+    &&OP_sp_iter_shift_arr_s,
+    &&OP_sp_iter_shift_hash,
+    &&OP_sp_iterkey_hash,
+    &&OP_sp_iterval_hash,
     &&OP_prof_enter,
     &&OP_prof_enterspesh,
     &&OP_prof_enterinline,
@@ -923,95 +1011,7 @@ static const void * const LABELS[] = {
     &&OP_ctw_check,
     &&OP_coverage_log,
     &&OP_breakpoint,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
+    &&OP_coverage_count,
     NULL,
     NULL,
     NULL,
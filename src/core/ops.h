@@ -826,103 +826,192 @@
 #define MVM_OP_totalmem 822
 #define MVM_OP_nextdispatcherfor 823
 #define MVM_OP_takenextdispatcher 824
-#define MVM_OP_sp_guard 825
-#define MVM_OP_sp_guardconc 826
-#define MVM_OP_sp_guardtype 827
-#define MVM_OP_sp_guardsf 828
-#define MVM_OP_sp_guardsfouter 829
-#define MVM_OP_sp_guardobj 830
-#define MVM_OP_sp_guardnotobj 831
-#define MVM_OP_sp_guardjustconc 832
-#define MVM_OP_sp_guardjusttype 833
-#define MVM_OP_sp_rebless 834
-#define MVM_OP_sp_resolvecode 835
-#define MVM_OP_sp_decont 836
-#define MVM_OP_sp_getlex_o 837
-#define MVM_OP_sp_getlex_ins 838
-#define MVM_OP_sp_getlex_no 839
-#define MVM_OP_sp_bindlex_in 840
-#define MVM_OP_sp_bindlex_os 841
-#define MVM_OP_sp_getarg_o 842
-#define MVM_OP_sp_getarg_i 843
-#define MVM_OP_sp_getarg_n 844
-#define MVM_OP_sp_getarg_s 845
-#define MVM_OP_sp_fastinvoke_v 846
-#define MVM_OP_sp_fastinvoke_i 847
-#define MVM_OP_sp_fastinvoke_n 848
-#define MVM_OP_sp_fastinvoke_s 849
-#define MVM_OP_sp_fastinvoke_o 850
-#define MVM_OP_sp_speshresolve 851
-#define MVM_OP_sp_paramnamesused 852
-#define MVM_OP_sp_getspeshslot 853
-#define MVM_OP_sp_findmeth 854
-#define MVM_OP_sp_fastcreate 855
-#define MVM_OP_sp_get_o 856
-#define MVM_OP_sp_get_i64 857
-#define MVM_OP_sp_get_i32 858
-#define MVM_OP_sp_get_i16 859
-#define MVM_OP_sp_get_i8 860
-#define MVM_OP_sp_get_n 861
-#define MVM_OP_sp_get_s 862
-#define MVM_OP_sp_bind_o 863
-#define MVM_OP_sp_bind_i64 864
-#define MVM_OP_sp_bind_i32 865
-#define MVM_OP_sp_bind_i16 866
-#define MVM_OP_sp_bind_i8 867
-#define MVM_OP_sp_bind_n 868
-#define MVM_OP_sp_bind_s 869
-#define MVM_OP_sp_bind_s_nowb 870
-#define MVM_OP_sp_p6oget_o 871
-#define MVM_OP_sp_p6ogetvt_o 872
-#define MVM_OP_sp_p6ogetvc_o 873
-#define MVM_OP_sp_p6oget_i 874
-#define MVM_OP_sp_p6oget_n 875
-#define MVM_OP_sp_p6oget_s 876
-#define MVM_OP_sp_p6oget_bi 877
-#define MVM_OP_sp_p6obind_o 878
-#define MVM_OP_sp_p6obind_i 879
-#define MVM_OP_sp_p6obind_n 880
-#define MVM_OP_sp_p6obind_s 881
-#define MVM_OP_sp_p6oget_i32 882
-#define MVM_OP_sp_p6obind_i32 883
-#define MVM_OP_sp_getvt_o 884
-#define MVM_OP_sp_getvc_o 885
-#define MVM_OP_sp_fastbox_i 886
-#define MVM_OP_sp_fastbox_bi 887
-#define MVM_OP_sp_fastbox_i_ic 888
-#define MVM_OP_sp_fastbox_bi_ic 889
-#define MVM_OP_sp_deref_get_i64 890
-#define MVM_OP_sp_deref_get_n 891
-#define MVM_OP_sp_deref_bind_i64 892
-#define MVM_OP_sp_deref_bind_n 893
-#define MVM_OP_sp_getlexvia_o 894
-#define MVM_OP_sp_getlexvia_ins 895
-#define MVM_OP_sp_bindlexvia_os 896
-#define MVM_OP_sp_bindlexvia_in 897
-#define MVM_OP_sp_getstringfrom 898
-#define MVM_OP_sp_getwvalfrom 899
-#define MVM_OP_sp_jit_enter 900
-#define MVM_OP_sp_istrue_n 901
-#define MVM_OP_sp_boolify_iter 902
-#define MVM_OP_sp_boolify_iter_arr 903
-#define MVM_OP_sp_boolify_iter_hash 904
-#define MVM_OP_sp_cas_o 905
-#define MVM_OP_sp_atomicload_o 906
-#define MVM_OP_sp_atomicstore_o 907
-#define MVM_OP_sp_add_I 908
-#define MVM_OP_sp_sub_I 909
-#define MVM_OP_sp_mul_I 910
-#define MVM_OP_sp_bool_I 911
-#define MVM_OP_prof_enter 912
-#define MVM_OP_prof_enterspesh 913
-#define MVM_OP_prof_enterinline 914
-#define MVM_OP_prof_enternative 915
-#define MVM_OP_prof_exit 916
-#define MVM_OP_prof_allocated 917
-#define MVM_OP_prof_replaced 918
-#define MVM_OP_ctw_check 919
-#define MVM_OP_coverage_log 920
-#define MVM_OP_breakpoint 921
+#define MVM_OP_fsastats 825
+#define MVM_OP_gcstats 826
+#define MVM_OP_pinobj 827
+#define MVM_OP_unpinobj 828
+#define MVM_OP_dumpallocsamples 829
+#define MVM_OP_strbuilderappend_s 830
+#define MVM_OP_strbuilderappend_i 831
+#define MVM_OP_strbuilderappend_n 832
+#define MVM_OP_strbuilderfinish 833
+#define MVM_OP_strsearchcompile 834
+#define MVM_OP_strsearchall 835
+#define MVM_OP_unicollkey 836
+#define MVM_OP_unisort 837
+#define MVM_OP_encodeinto 838
+#define MVM_OP_sethashordered 839
+#define MVM_OP_hashpresize 840
+#define MVM_OP_hashbindall 841
+#define MVM_OP_hashmerge 842
+#define MVM_OP_arrsum_i 843
+#define MVM_OP_arrsum_n 844
+#define MVM_OP_arrmin_i 845
+#define MVM_OP_arrmax_i 846
+#define MVM_OP_arrmin_n 847
+#define MVM_OP_arrmax_n 848
+#define MVM_OP_arradd_i 849
+#define MVM_OP_arradd_n 850
+#define MVM_OP_arrmul_i 851
+#define MVM_OP_arrmul_n 852
+#define MVM_OP_arraddarr 853
+#define MVM_OP_arrmularr 854
+#define MVM_OP_arrfill_i 855
+#define MVM_OP_arrfill_n 856
+#define MVM_OP_arrfind_i 857
+#define MVM_OP_arrfind_n 858
+#define MVM_OP_arrviewbind 859
+#define MVM_OP_queuepushall 860
+#define MVM_OP_queuepollmany 861
+#define MVM_OP_schedsubmit 862
+#define MVM_OP_readlock 863
+#define MVM_OP_readunlock 864
+#define MVM_OP_writelock 865
+#define MVM_OP_writeunlock 866
+#define MVM_OP_arratomicload_i 867
+#define MVM_OP_arratomicstore_i 868
+#define MVM_OP_arratomicadd_i 869
+#define MVM_OP_arratomicxchg_i 870
+#define MVM_OP_arratomiccas_i 871
+#define MVM_OP_threadaffinity 872
+#define MVM_OP_threadpriority 873
+#define MVM_OP_fiberawait 874
+#define MVM_OP_fiberyield 875
+#define MVM_OP_asyncsendfile 876
+#define MVM_OP_watchtree 877
+#define MVM_OP_read_dir_all 878
+#define MVM_OP_forkserver 879
+#define MVM_OP_loadbundle 880
+#define MVM_OP_dumpcpusamples 881
+#define MVM_OP_vmstats 882
+#define MVM_OP_parsenums 883
+#define MVM_OP_parsenumsbuf 884
+#define MVM_OP_carrayview 885
+#define MVM_OP_vmarrayview 886
+#define MVM_OP_mdfill_i 887
+#define MVM_OP_mdfill_n 888
+#define MVM_OP_mdcopy 889
+#define MVM_OP_mdtranspose 890
+#define MVM_OP_mdelemwise 891
+#define MVM_OP_mdreadline 892
+#define MVM_OP_mdwriteline 893
+#define MVM_OP_semacquiren 894
+#define MVM_OP_semtryacquiren 895
+#define MVM_OP_semreleasen 896
+#define MVM_OP_condwaittimeout 897
+#define MVM_OP_sp_guard 898
+#define MVM_OP_sp_guardconc 899
+#define MVM_OP_sp_guardtype 900
+#define MVM_OP_sp_guardsf 901
+#define MVM_OP_sp_guardsfouter 902
+#define MVM_OP_sp_guardobj 903
+#define MVM_OP_sp_guardnotobj 904
+#define MVM_OP_sp_guardjustconc 905
+#define MVM_OP_sp_guardjusttype 906
+#define MVM_OP_sp_rebless 907
+#define MVM_OP_sp_resolvecode 908
+#define MVM_OP_sp_decont 909
+#define MVM_OP_sp_getlex_o 910
+#define MVM_OP_sp_getlex_ins 911
+#define MVM_OP_sp_getlex_no 912
+#define MVM_OP_sp_bindlex_in 913
+#define MVM_OP_sp_bindlex_os 914
+#define MVM_OP_sp_getarg_o 915
+#define MVM_OP_sp_getarg_i 916
+#define MVM_OP_sp_getarg_n 917
+#define MVM_OP_sp_getarg_s 918
+#define MVM_OP_sp_fastinvoke_v 919
+#define MVM_OP_sp_fastinvoke_i 920
+#define MVM_OP_sp_fastinvoke_n 921
+#define MVM_OP_sp_fastinvoke_s 922
+#define MVM_OP_sp_fastinvoke_o 923
+#define MVM_OP_sp_speshresolve 924
+#define MVM_OP_sp_paramnamesused 925
+#define MVM_OP_sp_getspeshslot 926
+#define MVM_OP_sp_findmeth 927
+#define MVM_OP_sp_fastcreate 928
+#define MVM_OP_sp_get_o 929
+#define MVM_OP_sp_get_i64 930
+#define MVM_OP_sp_get_i32 931
+#define MVM_OP_sp_get_i16 932
+#define MVM_OP_sp_get_i8 933
+#define MVM_OP_sp_get_n 934
+#define MVM_OP_sp_get_s 935
+#define MVM_OP_sp_bind_o 936
+#define MVM_OP_sp_bind_i64 937
+#define MVM_OP_sp_bind_i32 938
+#define MVM_OP_sp_bind_i16 939
+#define MVM_OP_sp_bind_i8 940
+#define MVM_OP_sp_bind_n 941
+#define MVM_OP_sp_bind_s 942
+#define MVM_OP_sp_bind_s_nowb 943
+#define MVM_OP_sp_p6oget_o 944
+#define MVM_OP_sp_p6ogetvt_o 945
+#define MVM_OP_sp_p6ogetvc_o 946
+#define MVM_OP_sp_p6oget_i 947
+#define MVM_OP_sp_p6oget_n 948
+#define MVM_OP_sp_p6oget_s 949
+#define MVM_OP_sp_p6oget_bi 950
+#define MVM_OP_sp_p6obind_o 951
+#define MVM_OP_sp_p6obind_i 952
+#define MVM_OP_sp_p6obind_n 953
+#define MVM_OP_sp_p6obind_s 954
+#define MVM_OP_sp_p6oget_i32 955
+#define MVM_OP_sp_p6obind_i32 956
+#define MVM_OP_sp_getvt_o 957
+#define MVM_OP_sp_getvc_o 958
+#define MVM_OP_sp_fastbox_i 959
+#define MVM_OP_sp_fastbox_bi 960
+#define MVM_OP_sp_fastbox_i_ic 961
+#define MVM_OP_sp_fastbox_bi_ic 962
+#define MVM_OP_sp_deref_get_i64 963
+#define MVM_OP_sp_deref_get_n 964
+#define MVM_OP_sp_deref_bind_i64 965
+#define MVM_OP_sp_deref_bind_n 966
+#define MVM_OP_sp_getlexvia_o 967
+#define MVM_OP_sp_getlexvia_ins 968
+#define MVM_OP_sp_bindlexvia_os 969
+#define MVM_OP_sp_bindlexvia_in 970
+#define MVM_OP_sp_getstringfrom 971
+#define MVM_OP_sp_getwvalfrom 972
+#define MVM_OP_sp_jit_enter 973
+#define MVM_OP_sp_istrue_n 974
+#define MVM_OP_sp_boolify_iter 975
+#define MVM_OP_sp_boolify_iter_arr 976
+#define MVM_OP_sp_boolify_iter_hash 977
+#define MVM_OP_sp_cas_o 978
+#define MVM_OP_sp_atomicload_o 979
+#define MVM_OP_sp_atomicstore_o 980
+#define MVM_OP_sp_add_I 981
+#define MVM_OP_sp_sub_I 982
+#define MVM_OP_sp_mul_I 983
+#define MVM_OP_sp_bool_I 984
+#define MVM_OP_sp_findmeth_poly 985
+#define MVM_OP_sp_atpos_i64_nc 986
+#define MVM_OP_sp_bindpos_i64_nc 987
+#define MVM_OP_sp_jit_opdone 988
+#define MVM_OP_sp_takeclosure_local 989
+#define MVM_OP_sp_getarg_o_decont 990
+#define MVM_OP_sp_p6oget_o_decont 991
+#define MVM_OP_sp_const_s_concat_s 992
+#define MVM_OP_sp_iter_shift_arr_o 993
+#define MVM_OP_sp_iter_shift_arr_i 994
+#define MVM_OP_sp_iter_shift_arr_n 995
+#define MVM_OP_sp_iter_shift_arr_s 996
+#define MVM_OP_sp_iter_shift_hash 997
+#define MVM_OP_sp_iterkey_hash 998
+#define MVM_OP_sp_iterval_hash 999
+#define MVM_OP_prof_enter 1000
+#define MVM_OP_prof_enterspesh 1001
+#define MVM_OP_prof_enterinline 1002
+#define MVM_OP_prof_enternative 1003
+#define MVM_OP_prof_exit 1004
+#define MVM_OP_prof_allocated 1005
+#define MVM_OP_prof_replaced 1006
+#define MVM_OP_ctw_check 1007
+#define MVM_OP_coverage_log 1008
+#define MVM_OP_breakpoint 1009
+#define MVM_OP_coverage_count 1010
 
 #define MVM_OP_EXT_BASE 1024
 #define MVM_OP_EXT_CU_LIMIT 1024
@@ -16,8 +16,7 @@ MVM_STATIC_INLINE MVMuint32 hash_true_size(MVMPtrHashTable *hashtable) {
    which you allocated (heap, stack, inside another struct, wherever) */
 void MVM_ptr_hash_demolish(MVMThreadContext *tc, MVMPtrHashTable *hashtable) {
     if (hashtable->metadata) {
-        MVM_free(hashtable->entries);
-        MVM_free(hashtable->metadata - 1);
+        MVM_hash_free_storage(hashtable->entries, hashtable->metadata);
     }
 }
 /* and then free memory if you allocated it */
@@ -26,8 +25,8 @@ void MVM_ptr_hash_demolish(MVMThreadContext *tc, MVMPtrHashTable *hashtable) {
 MVM_STATIC_INLINE void hash_allocate_common(MVMPtrHashTable *hashtable) {
     hashtable->max_items = hashtable->official_size * PTR_LOAD_FACTOR;
     size_t actual_items = hash_true_size(hashtable);
-    hashtable->entries = MVM_malloc(sizeof(struct MVMPtrHashEntry) * actual_items);
-    hashtable->metadata = MVM_calloc(1 + actual_items + 1, 1);
+    hashtable->metadata = MVM_hash_allocate_storage(&hashtable->entries,
+        sizeof(struct MVMPtrHashEntry) * actual_items, 1 + actual_items + 1);
     /* A sentinel. This marks an occupied slot, at its ideal position. */
     *hashtable->metadata = 1;
     ++hashtable->metadata;
@@ -167,8 +166,7 @@ struct MVMPtrHashEntry *MVM_ptr_hash_lvalue_fetch(MVMThreadContext *tc,
             ++metadata;
             entry_raw += sizeof(struct MVMPtrHashEntry);
         }
-        MVM_free(entry_raw_orig);
-        MVM_free(metadata_orig - 1);
+        MVM_hash_free_storage(entry_raw_orig, metadata_orig);
     }
     struct MVMPtrHashEntry *new_entry
         = hash_insert_internal(tc, hashtable, key);
@@ -1,5 +1,34 @@
 #include "moar.h"
 
+/* Which of the thread's lists of blocks for reuse a block of the given size
+ * goes in, or -1 if it's of a size that isn't kept. */
+static MVMint32 size_class(size_t size) {
+    return size == MVM_REGIONALLOC_FIRST_MEMBLOCK_SIZE ? 0
+         : size == MVM_REGIONALLOC_MEMBLOCK_SIZE       ? 1
+         : -1;
+}
+
+/* Gets a zeroed block with a buffer of the given size, reusing one the
+ * thread kept if there is one. */
+static MVMRegionBlock * get_block(MVMThreadContext *tc, MVMRegionAlloc *al, size_t size) {
+    MVMint32        cls = size_class(size);
+    MVMRegionBlock *block;
+    if (cls >= 0 && tc->region_block_cache[cls]) {
+        block = tc->region_block_cache[cls];
+        tc->region_block_cache[cls] = block->prev;
+        tc->region_block_cache_size[cls]--;
+        al->num_reused++;
+    }
+    else {
+        block = MVM_malloc(sizeof(MVMRegionBlock));
+        block->buffer = MVM_calloc(1, size);
+        block->limit  = block->buffer + size;
+    }
+    block->alloc = block->buffer;
+    al->num_blocks++;
+    return block;
+}
+
 void * MVM_region_alloc(MVMThreadContext *tc, MVMRegionAlloc *al, size_t bytes) {
     char *result = NULL;
 
@@ -13,15 +42,13 @@ void * MVM_region_alloc(MVMThreadContext *tc, MVMRegionAlloc *al, size_t bytes)
         al->block->alloc += bytes;
     } else {
         /* No block, or block was full. Add another. */
-        MVMRegionBlock *block = MVM_malloc(sizeof(MVMRegionBlock));
+        MVMRegionBlock *block;
         size_t buffer_size = al->block == NULL
             ? MVM_REGIONALLOC_FIRST_MEMBLOCK_SIZE
             : MVM_REGIONALLOC_MEMBLOCK_SIZE;
         if (buffer_size < bytes)
             buffer_size = bytes;
-        block->buffer = MVM_calloc(1, buffer_size);
-        block->alloc  = block->buffer;
-        block->limit  = block->buffer + buffer_size;
+        block         = get_block(tc, al, buffer_size);
         block->prev   = al->block;
         al->block     = block;
 
@@ -29,21 +56,48 @@ void * MVM_region_alloc(MVMThreadContext *tc, MVMRegionAlloc *al, size_t bytes)
         result = block->alloc;
         block->alloc += bytes;
     }
+    al->bytes_used += bytes;
     return result;
 }
 
 void MVM_region_destroy(MVMThreadContext *tc, MVMRegionAlloc *alloc) {
     MVMRegionBlock *block = alloc->block;
-    /* Free all of the allocated memory. */
+    /* Keep the blocks of the usual sizes for reuse, zeroing the part that
+     * was used, and free the rest. */
     while (block) {
         MVMRegionBlock *prev = block->prev;
-        MVM_free(block->buffer);
-        MVM_free(block);
+        MVMint32        cls  = size_class(block->limit - block->buffer);
+        if (cls >= 0 && tc->region_block_cache_size[cls] < MVM_REGIONALLOC_CACHE_BLOCKS) {
+            memset(block->buffer, 0, block->alloc - block->buffer);
+            block->prev = tc->region_block_cache[cls];
+            tc->region_block_cache[cls] = block;
+            tc->region_block_cache_size[cls]++;
+        }
+        else {
+            MVM_free(block->buffer);
+            MVM_free(block);
+        }
         block = prev;
     }
     alloc->block = NULL;
 }
 
+/* Frees the blocks a thread kept for reuse, when it is destroyed. */
+void MVM_region_cache_destroy(MVMThreadContext *tc) {
+    MVMuint32 i;
+    for (i = 0; i < 2; i++) {
+        MVMRegionBlock *block = tc->region_block_cache[i];
+        while (block) {
+            MVMRegionBlock *prev = block->prev;
+            MVM_free(block->buffer);
+            MVM_free(block);
+            block = prev;
+        }
+        tc->region_block_cache[i]      = NULL;
+        tc->region_block_cache_size[i] = 0;
+    }
+}
+
 /* Link source region into target region, so they can be cleaned up as one */
 void MVM_region_merge(MVMThreadContext *tc, MVMRegionAlloc *target, MVMRegionAlloc *source) {
     MVMRegionBlock *block = source->block;
@@ -54,4 +108,7 @@ void MVM_region_merge(MVMThreadContext *tc, MVMRegionAlloc *target, MVMRegionAll
         block = prev;
     }
     source->block = NULL;
+    target->bytes_used += source->bytes_used;
+    target->num_blocks += source->num_blocks;
+    target->num_reused += source->num_reused;
 }
@@ -15,6 +15,12 @@ struct MVMRegionBlock {
 
 struct MVMRegionAlloc {
     MVMRegionBlock *block;
+
+    /* Statistics: the bytes handed out, and the blocks taken, of which how
+     * many were reused from an earlier allocator. */
+    size_t    bytes_used;
+    MVMuint32 num_blocks;
+    MVMuint32 num_reused;
 };
 
 /* The default allocation chunk size for memory blocks used to store spesh
@@ -22,6 +28,12 @@ struct MVMRegionAlloc {
 #define MVM_REGIONALLOC_FIRST_MEMBLOCK_SIZE 32768
 #define MVM_REGIONALLOC_MEMBLOCK_SIZE       8192
 
+/* How many blocks of each of those sizes a thread keeps for reuse when a
+ * region is destroyed. Blocks made bigger for large allocations are always
+ * freed. */
+#define MVM_REGIONALLOC_CACHE_BLOCKS        32
+
 void * MVM_region_alloc(MVMThreadContext *tc, MVMRegionAlloc *alloc, size_t s);
 void MVM_region_destroy(MVMThreadContext *tc, MVMRegionAlloc *alloc);
 void MVM_region_merge(MVMThreadContext *tc,  MVMRegionAlloc *target, MVMRegionAlloc *source);
+void MVM_region_cache_destroy(MVMThreadContext *tc);
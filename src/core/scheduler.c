@@ -0,0 +1,327 @@
+#include "moar.h"
+#include "platform/sys.h"
+
+static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args);
+
+/* Creates the scheduler. A worker count of 0 means one per CPU core. No
+ * threads are started until the first task is submitted. */
+MVMScheduler * MVM_scheduler_create(MVMThreadContext *tc, MVMuint32 num_workers) {
+    MVMScheduler *s = MVM_calloc(1, sizeof(MVMScheduler));
+    MVMuint32 i;
+    int init_stat;
+    if (!num_workers) {
+        MVMint64 cores = MVM_platform_cpu_count();
+        num_workers = cores > 0 ? (MVMuint32)cores : 1;
+    }
+    s->num_workers = num_workers;
+    s->deques      = MVM_calloc(num_workers, sizeof(MVMWorkDeque));
+    for (i = 0; i < num_workers; i++) {
+        MVMWorkDequeBuffer *buf = MVM_malloc(sizeof(MVMWorkDequeBuffer) +
+            (MVM_WORK_DEQUE_INITIAL_SIZE - 1) * sizeof(MVMObject *));
+        buf->size = MVM_WORK_DEQUE_INITIAL_SIZE;
+        s->deques[i].buffer = buf;
+    }
+    MVM_VECTOR_INIT(s->injected, 16);
+    if ((init_stat = uv_mutex_init(&s->lock)) < 0)
+        MVM_panic(1, "Failed to initialize scheduler mutex: %s",
+            uv_strerror(init_stat));
+    if ((init_stat = uv_cond_init(&s->wakeup)) < 0)
+        MVM_panic(1, "Failed to initialize scheduler condition variable: %s",
+            uv_strerror(init_stat));
+    s->pool = MVM_worker_pool_create(num_workers, &s->lock, &s->wakeup, worker);
+    return s;
+}
+
+/* Stops and joins the workers, if they were started; a worker running a
+ * task finishes it first. Tasks still waiting stay where they are. This is
+ * done before a fork. */
+void MVM_scheduler_halt(MVMThreadContext *tc) {
+    MVM_worker_pool_stop(tc, tc->instance->scheduler->pool);
+}
+
+/* Starts the workers again after MVM_scheduler_halt, if they had been. */
+void MVM_scheduler_resume(MVMThreadContext *tc) {
+    MVMScheduler *s = tc->instance->scheduler;
+    if (MVM_load(&s->started)) {
+        MVM_store(&s->next_worker, 0);
+        MVM_worker_pool_start(tc, s->pool);
+    }
+}
+
+/* Stops the workers and frees the scheduler. */
+void MVM_scheduler_destroy(MVMThreadContext *tc) {
+    MVMScheduler *s = tc->instance->scheduler;
+    MVMuint32 i;
+    MVM_worker_pool_stop(tc, s->pool);
+    MVM_worker_pool_destroy(s->pool);
+    for (i = 0; i < s->num_workers; i++)
+        MVM_free(s->deques[i].buffer);
+    MVM_free(s->deques);
+    MVM_VECTOR_DESTROY(s->injected);
+    uv_mutex_destroy(&s->lock);
+    uv_cond_destroy(&s->wakeup);
+    MVM_free(s);
+    tc->instance->scheduler = NULL;
+}
+
+/* Pushes a task onto the bottom of a deque. Only called by its owner. If the
+ * buffer is full, it is replaced by one twice the size; thieves may still be
+ * reading from the old one, so it is only freed at the next safepoint. */
+static void deque_push(MVMThreadContext *tc, MVMWorkDeque *d, MVMObject *task) {
+    AO_t b = MVM_load(&d->bottom);
+    AO_t t = MVM_load(&d->top);
+    MVMWorkDequeBuffer *buf = d->buffer;
+    if ((intptr_t)(b - t) >= (intptr_t)buf->size) {
+        MVMuint64 new_size = buf->size * 2;
+        MVMWorkDequeBuffer *new_buf = MVM_malloc(sizeof(MVMWorkDequeBuffer) +
+            (new_size - 1) * sizeof(MVMObject *));
+        AO_t i;
+        new_buf->size = new_size;
+        for (i = t; i != b; i++)
+            new_buf->tasks[i & (new_size - 1)] = buf->tasks[i & (buf->size - 1)];
+        MVM_store(&d->buffer, new_buf);
+        uv_mutex_lock(&tc->instance->mutex_free_at_safepoint);
+        MVM_free_at_safepoint(tc, buf);
+        uv_mutex_unlock(&tc->instance->mutex_free_at_safepoint);
+        buf = new_buf;
+    }
+    buf->tasks[b & (buf->size - 1)] = task;
+    MVM_store(&d->bottom, b + 1);
+}
+
+/* Pops the most recently pushed task from the bottom of a deque, or returns
+ * NULL if it is empty. Only called by its owner. When a single task is left,
+ * a thief may be going for it too, so it is claimed by moving the top. */
+static MVMObject * deque_pop(MVMWorkDeque *d) {
+    AO_t b = MVM_load(&d->bottom) - 1;
+    MVMWorkDequeBuffer *buf = (MVMWorkDequeBuffer *)MVM_load(&d->buffer);
+    MVMObject *task;
+    AO_t t;
+    MVM_store(&d->bottom, b);
+    t = MVM_load(&d->top);
+    if ((intptr_t)(b - t) < 0) {
+        MVM_store(&d->bottom, b + 1);
+        return NULL;
+    }
+    task = buf->tasks[b & (buf->size - 1)];
+    if (b == t) {
+        if (!MVM_trycas(&d->top, t, t + 1))
+            task = NULL;
+        MVM_store(&d->bottom, b + 1);
+    }
+    return task;
+}
+
+/* Steals the oldest task from the top of another worker's deque. Returns
+ * NULL if it is empty or another thread took the task first. */
+static MVMObject * deque_steal(MVMWorkDeque *d) {
+    AO_t t = MVM_load(&d->top);
+    AO_t b = MVM_load(&d->bottom);
+    if ((intptr_t)(b - t) > 0) {
+        MVMWorkDequeBuffer *buf = (MVMWorkDequeBuffer *)MVM_load(&d->buffer);
+        MVMObject *task = buf->tasks[t & (buf->size - 1)];
+        if (MVM_trycas(&d->top, t, t + 1))
+            return task;
+    }
+    return NULL;
+}
+
+/* Whether there is a task anywhere for a worker to take. */
+static MVMint32 has_work(MVMScheduler *s) {
+    MVMuint32 i;
+    if (MVM_load(&s->num_injected))
+        return 1;
+    for (i = 0; i < s->num_workers; i++)
+        if ((intptr_t)(MVM_load(&s->deques[i].bottom) - MVM_load(&s->deques[i].top)) > 0)
+            return 1;
+    return 0;
+}
+
+/* Takes the oldest task from the injection queue, if there is one. */
+static MVMObject * take_injected(MVMThreadContext *tc, MVMScheduler *s) {
+    MVMObject *task = NULL;
+    if (!MVM_load(&s->num_injected))
+        return NULL;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&s->lock);
+    MVM_gc_mark_thread_unblocked(tc);
+    if (s->injected_head < MVM_VECTOR_ELEMS(s->injected)) {
+        task = s->injected[s->injected_head++];
+        MVM_decr(&s->num_injected);
+        if (s->injected_head == MVM_VECTOR_ELEMS(s->injected)) {
+            s->injected_head = 0;
+            MVM_VECTOR_CLEAR(s->injected);
+        }
+    }
+    uv_mutex_unlock(&s->lock);
+    return task;
+}
+
+/* Finds a worker its next task: its own newest one, else the oldest one
+ * injected from outside, else one stolen from another worker. */
+static MVMObject * find_task(MVMThreadContext *tc, MVMScheduler *s, MVMuint32 self) {
+    MVMObject *task = deque_pop(&s->deques[self]);
+    MVMuint32 i;
+    if (!task)
+        task = take_injected(tc, s);
+    for (i = 1; !task && i < s->num_workers; i++)
+        task = deque_steal(&s->deques[(self + i) % s->num_workers]);
+    return task;
+}
+
+/* Parks a worker, as a blocked thread, until there's work, returning non-zero
+ * if it was told to stop instead. The idle count is raised before looking for
+ * work one last time, and whoever makes work available checks it afterwards,
+ * so a wakeup can't be missed. */
+static MVMuint32 park(MVMThreadContext *tc, MVMScheduler *s) {
+    MVMuint32 stop;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&s->lock);
+    MVM_incr(&s->idle);
+    while (!has_work(s) && !s->pool->stop)
+        uv_cond_wait(&s->wakeup, &s->lock);
+    MVM_decr(&s->idle);
+    stop = s->pool->stop;
+    uv_mutex_unlock(&s->lock);
+    MVM_gc_mark_thread_unblocked(tc);
+    return stop;
+}
+
+/* Wakes up a parked worker, if there is one. */
+static void wake_worker(MVMThreadContext *tc, MVMScheduler *s) {
+    if (MVM_load(&s->idle)) {
+        MVM_gc_mark_thread_blocked(tc);
+        uv_mutex_lock(&s->lock);
+        MVM_gc_mark_thread_unblocked(tc);
+        uv_cond_signal(&s->wakeup);
+        uv_mutex_unlock(&s->lock);
+    }
+}
+
+/* Runs a task, or resumes a suspended fiber, in an interpreter of its own,
+ * leaving the interpreter state the worker was started with as it was. */
+static void task_invoke(MVMThreadContext *tc, void *data) {
+    MVMObject *code = MVM_frame_find_invokee(tc, *(MVMObject **)data, NULL);
+    STABLE(code)->invoke(tc, code,
+        MVM_callsite_get_common(tc, MVM_CALLSITE_ID_NULL_ARGS), NULL);
+    tc->thread_entry_frame = tc->cur_frame;
+}
+static void run_task(MVMThreadContext *tc, MVMObject *task) {
+    MVMROOT(tc, task, {
+        MVMuint8    **backup_cur_op         = tc->interp_cur_op;
+        MVMuint8    **backup_bytecode_start = tc->interp_bytecode_start;
+        MVMRegister **backup_reg_base       = tc->interp_reg_base;
+        MVMCompUnit **backup_cu             = tc->interp_cu;
+        if (REPR(task)->ID == MVM_REPR_ID_MVMContinuation)
+            MVM_fiber_resume(tc, task);
+        else
+            MVM_interp_run(tc, task_invoke, &task, NULL);
+        tc->interp_cur_op         = backup_cur_op;
+        tc->interp_bytecode_start = backup_bytecode_start;
+        tc->interp_reg_base       = backup_reg_base;
+        tc->interp_cu             = backup_cu;
+        tc->cur_frame             = NULL;
+        tc->thread_entry_frame    = NULL;
+    });
+}
+
+/* The loop each worker thread runs. */
+static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    MVMScheduler *s    = tc->instance->scheduler;
+    MVMuint32     self = (MVMuint32)MVM_incr(&s->next_worker);
+    tc->scheduler_worker = self + 1;
+
+#if MVM_HAS_PTHREAD_SETNAME_NP
+    pthread_setname_np(pthread_self(), "scheduler");
+#endif
+
+    /* Unlike other VM internal workers, these run HLL code. */
+    MVM_spesh_log_initialize_thread(tc, 0);
+
+    while (1) {
+        MVMObject *task = find_task(tc, s, self);
+        if (task)
+            run_task(tc, task);
+        else if (park(tc, s))
+            break;
+    }
+}
+
+/* Submits a code object to be run, with no arguments, on one of the worker
+ * threads. Exceptions must be handled by the code itself, just as with the
+ * code a thread is started with. */
+void MVM_scheduler_submit(MVMThreadContext *tc, MVMObject *code) {
+    MVMScheduler *s = tc->instance->scheduler;
+    MVMSTable    *st;
+    if (MVM_is_null(tc, code))
+        MVM_exception_throw_adhoc(tc, "schedsubmit requires a code object");
+    st = STABLE(code);
+    if (st->invoke == MVM_6model_invoke_default && !st->invocation_spec)
+        MVM_exception_throw_adhoc(tc, "schedsubmit requires an invokable object");
+
+    /* Start the workers the first time around. */
+    if (!MVM_load(&s->started) && MVM_trycas(&s->started, 0, 1)) {
+        MVMROOT(tc, code, {
+            MVM_worker_pool_start(tc, s->pool);
+        });
+    }
+
+    MVM_scheduler_requeue(tc, code, 0);
+}
+
+/* Queues up a task, or a fiber to resume, after the workers were started.
+ * Tasks from a worker go on its own deque, unless asked to go to the back,
+ * behind all the tasks waiting, by way of the injection queue. */
+void MVM_scheduler_requeue(MVMThreadContext *tc, MVMObject *task, MVMint32 to_back) {
+    MVMScheduler *s = tc->instance->scheduler;
+
+    /* The task will be seen by other threads. */
+    MVM_gc_note_escape(tc);
+
+    if (tc->scheduler_worker && !to_back) {
+        deque_push(tc, &s->deques[tc->scheduler_worker - 1], task);
+        wake_worker(tc, s);
+    }
+    else {
+        MVMROOT(tc, task, {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_mutex_lock(&s->lock);
+            MVM_gc_mark_thread_unblocked(tc);
+        });
+        MVM_VECTOR_PUSH(s->injected, task);
+        MVM_incr(&s->num_injected);
+        if (MVM_load(&s->idle))
+            uv_cond_signal(&s->wakeup);
+        uv_mutex_unlock(&s->lock);
+    }
+}
+
+/* Marks the tasks waiting in the deques and the injection queue. Called with
+ * the world stopped, so no worker is part way through pushing, popping or
+ * stealing. */
+#define add_collectable(tc, worklist, snapshot, col, desc) \
+    do { \
+        if (worklist) { \
+            MVM_gc_worklist_add(tc, worklist, &(col)); \
+        } \
+        else { \
+            MVM_profile_heap_add_collectable_rel_const_cstr(tc, snapshot, \
+                (MVMCollectable *)col, desc); \
+        } \
+    } while (0)
+void MVM_scheduler_gc_mark(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMHeapSnapshotState *snapshot) {
+    MVMScheduler *s = tc->instance->scheduler;
+    MVMuint64 i;
+    for (i = 0; i < s->num_workers; i++) {
+        MVMWorkDeque       *d   = &s->deques[i];
+        MVMWorkDequeBuffer *buf = d->buffer;
+        AO_t pos;
+        for (pos = d->top; (intptr_t)(d->bottom - pos) > 0; pos++)
+            add_collectable(tc, worklist, snapshot, buf->tasks[pos & (buf->size - 1)],
+                "Scheduler task");
+    }
+    for (i = s->injected_head; i < MVM_VECTOR_ELEMS(s->injected); i++)
+        add_collectable(tc, worklist, snapshot, s->injected[i],
+            "Injected scheduler task");
+    MVM_worker_pool_gc_mark(tc, s->pool, worklist, snapshot, "Scheduler worker thread");
+}
@@ -0,0 +1,63 @@
+/* The ring of tasks behind a work-stealing deque. The size is a power of 2;
+ * positions are used modulo the size. */
+struct MVMWorkDequeBuffer {
+    MVMuint64  size;
+    MVMObject *tasks[1];
+};
+
+/* The padding used to keep a deque's two ends on separate cache lines. */
+#define MVM_WORK_DEQUE_PAD 64
+
+/* A Chase-Lev work-stealing deque. Only the worker that owns it pushes and
+ * pops tasks, at the bottom; other workers steal from the top, claiming a
+ * task with a compare and swap. The owner replaces the buffer with one twice
+ * the size when it fills up, and the old one is freed at the next safepoint,
+ * since a thief may still be reading from it. */
+struct MVMWorkDeque {
+    AO_t top;
+    char pad0[MVM_WORK_DEQUE_PAD - sizeof(AO_t)];
+    AO_t bottom;
+    MVMWorkDequeBuffer *buffer;
+    char pad1[MVM_WORK_DEQUE_PAD - sizeof(AO_t) - sizeof(MVMWorkDequeBuffer *)];
+};
+
+/* The size of the buffer each deque starts out with. */
+#define MVM_WORK_DEQUE_INITIAL_SIZE 64
+
+/* A pool of worker threads that run submitted code objects, each with a
+ * deque of its own. Tasks submitted from a worker go on its own deque, and
+ * tasks submitted from any other thread are injected through a queue that
+ * all workers share. A worker with nothing to do steals from the others, and
+ * when nothing is to be had parks, as a blocked thread, on a condition
+ * variable. The workers are started when the first task is submitted. */
+struct MVMScheduler {
+    /* The number of workers, and their deques. */
+    MVMuint32     num_workers;
+    MVMWorkDeque *deques;
+
+    /* Whether the workers were started, how many took their index, and
+     * the pool of their threads. */
+    AO_t started;
+    AO_t next_worker;
+    MVMWorkerPool *pool;
+
+    /* Tasks submitted from threads that are not workers, oldest first from
+     * the head index on, and how many are waiting there. */
+    MVM_VECTOR_DECL(MVMObject *, injected);
+    MVMuint64 injected_head;
+    AO_t      num_injected;
+
+    /* The number of parked workers, and the lock and condition variable
+     * they park on. The lock also protects the injection queue. */
+    AO_t       idle;
+    uv_mutex_t lock;
+    uv_cond_t  wakeup;
+};
+
+MVMScheduler * MVM_scheduler_create(MVMThreadContext *tc, MVMuint32 num_workers);
+void MVM_scheduler_halt(MVMThreadContext *tc);
+void MVM_scheduler_resume(MVMThreadContext *tc);
+void MVM_scheduler_destroy(MVMThreadContext *tc);
+void MVM_scheduler_submit(MVMThreadContext *tc, MVMObject *code);
+void MVM_scheduler_requeue(MVMThreadContext *tc, MVMObject *task, MVMint32 to_back);
+void MVM_scheduler_gc_mark(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMHeapSnapshotState *snapshot);
@@ -35,8 +35,7 @@ MVM_STATIC_INLINE MVMuint32 hash_true_size(MVMStrHashTable *hashtable) {
    which you allocated (heap, stack, inside another struct, wherever) */
 void MVM_str_hash_demolish(MVMThreadContext *tc, MVMStrHashTable *hashtable) {
     if (hashtable->metadata) {
-        MVM_free(hashtable->entries);
-        MVM_free(hashtable->metadata - 1);
+        MVM_hash_free_storage(hashtable->entries, hashtable->metadata);
     }
     /* We shouldn't need these, but make something foolproof and they invent a
      * better fool: */
@@ -56,21 +55,21 @@ MVM_STATIC_INLINE void hash_allocate_common(MVMThreadContext *tc,
      * official allocation.
      * probe distance of 2 is the first extra bucket beyond the official
      * allocation
-     * probe distance of 255 is the 254th beyond the official allocation.
+     * probe distance of 63 is the 62nd beyond the official allocation.
      */
-    if (MVM_HASH_MAX_PROBE_DISTANCE < overflow_size) {
-        hashtable->probe_overflow_size = MVM_HASH_MAX_PROBE_DISTANCE - 1;
+    if (MVM_STR_HASH_MAX_PROBE_DISTANCE < overflow_size) {
+        hashtable->probe_overflow_size = MVM_STR_HASH_MAX_PROBE_DISTANCE - 1;
     } else {
         hashtable->probe_overflow_size = overflow_size;
     }
     size_t actual_items = hash_true_size(hashtable);
-    hashtable->entries = MVM_malloc(hashtable->entry_size * actual_items);
-    hashtable->metadata = MVM_calloc(1 + actual_items + 1, 1);
+    hashtable->metadata = MVM_hash_allocate_storage(&hashtable->entries,
+        hashtable->entry_size * actual_items, 1 + actual_items + 1);
     /* A sentinel. This marks an occupied slot, at its ideal position. */
-    *hashtable->metadata = 1;
+    *hashtable->metadata = MVM_STR_HASH_METADATA_INCREMENT;
     ++hashtable->metadata;
     /* A sentinel at the other end. Again, occupied, ideal position. */
-    hashtable->metadata[actual_items] = 1;
+    hashtable->metadata[actual_items] = MVM_STR_HASH_METADATA_INCREMENT;
 #if MVM_HASH_RANDOMIZE
     hashtable->salt = MVM_proc_rand_i(tc);
 #else
@@ -108,16 +107,6 @@ void MVM_str_hash_initial_allocate(MVMThreadContext *tc,
 #endif
 }
 
-/* make sure you still have your copies of entries and metadata before you
-   call this. */
-MVM_STATIC_INLINE void hash_grow(MVMThreadContext *tc,
-                                 MVMStrHashTable *hashtable) {
-    --hashtable->key_right_shift;
-    hashtable->official_size *= 2;
-
-    hash_allocate_common(tc, hashtable);
-}
-
 MVM_STATIC_INLINE struct MVMStrHashHandle *hash_insert_internal(MVMThreadContext *tc,
                                                                MVMStrHashTable *hashtable,
                                                                MVMString *key) {
@@ -126,8 +115,9 @@ MVM_STATIC_INLINE struct MVMStrHashHandle *hash_insert_internal(MVMThreadContext
                  key);
     }
 
-    unsigned int probe_distance = 1;
-    MVMHashNumItems bucket = MVM_str_hash_code(tc, hashtable->salt, key) >> hashtable->key_right_shift;
+    MVMuint64 hash_val = MVM_str_hash_code(tc, hashtable->salt, key);
+    MVMHashNumItems bucket = hash_val >> hashtable->key_right_shift;
+    unsigned int probe_distance = MVM_str_hash_initial_probe(hashtable, hash_val);
     char *entry_raw = hashtable->entries + bucket * hashtable->entry_size;
     MVMuint8 *metadata = hashtable->metadata + bucket;
     while (1) {
@@ -149,8 +139,8 @@ MVM_STATIC_INLINE struct MVMStrHashHandle *hash_insert_internal(MVMThreadContext
                 MVMuint8 *find_me_a_gap = metadata;
                 MVMuint8 old_probe_distance = *metadata;
                 do {
-                    MVMuint8 new_probe_distance = 1 + old_probe_distance;
-                    if (new_probe_distance == MVM_HASH_MAX_PROBE_DISTANCE) {
+                    MVMuint8 new_probe_distance = MVM_STR_HASH_METADATA_INCREMENT + old_probe_distance;
+                    if ((new_probe_distance >> MVM_STR_HASH_METADATA_HASH_BITS) == MVM_STR_HASH_MAX_PROBE_DISTANCE) {
                         /* Optimisation from Martin Ankerl's implementation:
                            setting this to zero forces a resize on any insert,
                            *before* the actual insert, so that we never end up
@@ -172,7 +162,7 @@ MVM_STATIC_INLINE struct MVMStrHashHandle *hash_insert_internal(MVMThreadContext
              * about to insert something at the (current) max_probe_distance, so
              * signal to the next insertion that it needs to take action first.
              */
-            if (probe_distance == MVM_HASH_MAX_PROBE_DISTANCE) {
+            if ((probe_distance >> MVM_STR_HASH_METADATA_HASH_BITS) == MVM_STR_HASH_MAX_PROBE_DISTANCE) {
                 hashtable->max_items = 0;
             }
 
@@ -189,23 +179,70 @@ MVM_STATIC_INLINE struct MVMStrHashHandle *hash_insert_internal(MVMThreadContext
 
         if (*metadata == probe_distance) {
             struct MVMStrHashHandle *entry = (struct MVMStrHashHandle *) entry_raw;
-            if (entry->key == key
-                || (MVM_string_graphs_nocheck(tc, key) == MVM_string_graphs_nocheck(tc, entry->key)
-                    && MVM_string_substrings_equal_nocheck(tc, key, 0,
-                                                           MVM_string_graphs_nocheck(tc, key),
-                                                           entry->key, 0))) {
+            if (MVM_str_hash_key_matches(tc, key, entry->key)) {
                 return entry;
             }
         }
-        ++probe_distance;
+        probe_distance += MVM_STR_HASH_METADATA_INCREMENT;
         ++metadata;
         entry_raw += hashtable->entry_size;
-        assert(probe_distance <= MVM_HASH_MAX_PROBE_DISTANCE);
+        assert((probe_distance >> MVM_STR_HASH_METADATA_HASH_BITS) <= MVM_STR_HASH_MAX_PROBE_DISTANCE);
         assert(metadata < hashtable->metadata + hashtable->official_size + hashtable->max_items);
         assert(metadata < hashtable->metadata + hashtable->official_size + 256);
     }
 }
 
+/* Grows the hash by the given number of doublings, moving all the entries
+ * over to the new storage. */
+static void hash_grow(MVMThreadContext *tc,
+                      MVMStrHashTable *hashtable,
+                      MVMuint32 doublings) {
+    MVMuint32 true_size =  hash_true_size(hashtable);
+    char *entry_raw_orig = hashtable->entries;
+    MVMuint8 *metadata_orig = hashtable->metadata;
+
+    hashtable->key_right_shift -= doublings;
+    hashtable->official_size <<= doublings;
+    hash_allocate_common(tc, hashtable);
+
+    char *entry_raw = entry_raw_orig;
+    MVMuint8 *metadata = metadata_orig;
+    MVMHashNumItems bucket = 0;
+    while (bucket < true_size) {
+        if (*metadata) {
+            struct MVMStrHashHandle *old_entry = (struct MVMStrHashHandle *) entry_raw;
+            void *new_entry_raw = hash_insert_internal(tc, hashtable, old_entry->key);
+            struct MVMStrHashHandle *new_entry = (struct MVMStrHashHandle *) new_entry_raw;
+            assert(new_entry->key == NULL);
+            memcpy(new_entry, old_entry, hashtable->entry_size);
+        }
+        ++bucket;
+        ++metadata;
+        entry_raw += hashtable->entry_size;
+    }
+    MVM_hash_free_storage(entry_raw_orig, metadata_orig);
+}
+
+/* Makes sure that the hash can take at least the given number of entries
+ * without growing, doing any growth needed now and in a single step. */
+void MVM_str_hash_reserve(MVMThreadContext *tc,
+                          MVMStrHashTable *hashtable,
+                          MVMuint32 entries) {
+    if (MVM_UNLIKELY(hashtable->entry_size == 0)) {
+        MVM_oops(tc, "Attempting reserve on MVM_str_hash without setting entry_size");
+    }
+    if (hashtable->entries == NULL) {
+        MVM_str_hash_initial_allocate(tc, hashtable, entries);
+    }
+    else if (entries > hashtable->max_items) {
+        MVMuint32 min_needed = entries * (1.0 / STR_LOAD_FACTOR);
+        MVMuint32 wanted_base2 = MVM_round_up_log_base2(min_needed);
+        MVMuint32 current_base2 = 8 * sizeof(MVMuint64) - hashtable->key_right_shift;
+        if (wanted_base2 > current_base2)
+            hash_grow(tc, hashtable, wanted_base2 - current_base2);
+    }
+}
+
 void *MVM_str_hash_lvalue_fetch_nocheck(MVMThreadContext *tc,
                                         MVMStrHashTable *hashtable,
                                         MVMString *key) {
@@ -228,29 +265,7 @@ void *MVM_str_hash_lvalue_fetch_nocheck(MVMThreadContext *tc,
             return entry;
         }
 
-        MVMuint32 true_size =  hash_true_size(hashtable);
-        char *entry_raw_orig = hashtable->entries;
-        MVMuint8 *metadata_orig = hashtable->metadata;
-
-        hash_grow(tc, hashtable);
-
-        char *entry_raw = entry_raw_orig;
-        MVMuint8 *metadata = metadata_orig;
-        MVMHashNumItems bucket = 0;
-        while (bucket < true_size) {
-            if (*metadata) {
-                struct MVMStrHashHandle *old_entry = (struct MVMStrHashHandle *) entry_raw;
-                void *new_entry_raw = hash_insert_internal(tc, hashtable, old_entry->key);
-                struct MVMStrHashHandle *new_entry = (struct MVMStrHashHandle *) new_entry_raw;
-                assert(new_entry->key == NULL);
-                memcpy(new_entry, old_entry, hashtable->entry_size);
-            }
-            ++bucket;
-            ++metadata;
-            entry_raw += hashtable->entry_size;
-        }
-        MVM_free(entry_raw_orig);
-        MVM_free(metadata_orig - 1);
+        hash_grow(tc, hashtable, 1);
     }
     struct MVMStrHashHandle *new_entry
         = hash_insert_internal(tc, hashtable, key);
@@ -288,26 +303,23 @@ void MVM_str_hash_delete_nocheck(MVMThreadContext *tc,
         /* Should this be an oops? */
         return;
     }
-    unsigned int probe_distance = 1;
-    MVMHashNumItems bucket = MVM_str_hash_code(tc, hashtable->salt, key) >> hashtable->key_right_shift;
+    MVMuint64 hash_val = MVM_str_hash_code(tc, hashtable->salt, key);
+    MVMHashNumItems bucket = hash_val >> hashtable->key_right_shift;
+    unsigned int probe_distance = MVM_str_hash_initial_probe(hashtable, hash_val);
     char *entry_raw = hashtable->entries + bucket * hashtable->entry_size;
     uint8_t *metadata = hashtable->metadata + bucket;
     while (1) {
         if (*metadata == probe_distance) {
             struct MVMStrHashHandle *entry = (struct MVMStrHashHandle *) entry_raw;
-            if (entry->key == key
-                || (MVM_string_graphs_nocheck(tc, key) == MVM_string_graphs_nocheck(tc, entry->key)
-                    && MVM_string_substrings_equal_nocheck(tc, key, 0,
-                                                           MVM_string_graphs_nocheck(tc, key),
-                                                           entry->key, 0))) {
+            if (MVM_str_hash_key_matches(tc, key, entry->key)) {
                 /* Target acquired. */
 
                 uint8_t *metadata_target = metadata;
                 /* Look at the next slot */
                 uint8_t old_probe_distance = metadata_target[1];
-                while (old_probe_distance > 1) {
+                while (old_probe_distance >= 2 * MVM_STR_HASH_METADATA_INCREMENT) {
                     /* OK, we can move this one. */
-                    *metadata_target = old_probe_distance - 1;
+                    *metadata_target = old_probe_distance - MVM_STR_HASH_METADATA_INCREMENT;
                     /* Try the next one, etc */
                     ++metadata_target;
                     old_probe_distance = metadata_target[1];
@@ -347,10 +359,10 @@ void MVM_str_hash_delete_nocheck(MVMThreadContext *tc,
             /* Strange. Not in the hash. Should this be an oops? */
             return;
         }
-        ++probe_distance;
+        probe_distance += MVM_STR_HASH_METADATA_INCREMENT;
         ++metadata;
         entry_raw += hashtable->entry_size;
-        assert(probe_distance <= MVM_HASH_MAX_PROBE_DISTANCE);
+        assert((probe_distance >> MVM_STR_HASH_METADATA_HASH_BITS) <= MVM_STR_HASH_MAX_PROBE_DISTANCE);
         assert(metadata < hashtable->metadata + hashtable->official_size + hashtable->max_items);
         assert(metadata < hashtable->metadata + hashtable->official_size + 256);
     }
@@ -444,7 +456,10 @@ MVMuint64 MVM_str_hash_fsck(MVMThreadContext *tc, MVMStrHashTable *hashtable, MV
                 MVMuint64 hash_val = MVM_str_hash_code(tc, hashtable->salt, key);
                 MVMuint32 ideal_bucket = hash_val >> hashtable->key_right_shift;
                 MVMint64 offset = 1 + bucket - ideal_bucket;
-                int wrong_bucket = offset != *metadata;
+                int wrong_bucket = offset != *metadata >> MVM_STR_HASH_METADATA_HASH_BITS
+                    || (MVM_str_hash_initial_probe(hashtable, hash_val)
+                        & (MVM_STR_HASH_METADATA_INCREMENT - 1))
+                       != (*metadata & (MVM_STR_HASH_METADATA_INCREMENT - 1));
                 int wrong_order = offset < 1 || offset > prev_offset + 1;
 
                 if (display == 2
@@ -504,7 +519,7 @@ MVMuint64 MVM_str_hash_fsck(MVMThreadContext *tc, MVMStrHashTable *hashtable, MV
         ++metadata;
         entry_raw += hashtable->entry_size;
     }
-    if (*metadata != 1) {
+    if (*metadata != MVM_STR_HASH_METADATA_INCREMENT) {
         ++errors;
         if (display) {
             fprintf(stderr, "%s    %02x!\n", prefix_hashes, *metadata);
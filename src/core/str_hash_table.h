@@ -40,6 +40,9 @@ hash value, or because we fake it and explicitly store the hash value.)
 
 Not all the optimisations described above are in place yet. Starting with
 "minimum viable product", with a design that should support adding them.
+We do now store a fixed number of extra hash bits in the metadata (see
+MVM_STR_HASH_METADATA_HASH_BITS), but don't yet trade them for probe distance
+dynamically.
 
 Also starting out by using two memory blocks, so that ASAN and valgrind can
 spot (some) problems.
@@ -158,6 +161,16 @@ spot (some) problems.
  * easier.
  */
 
+/* The metadata byte of an occupied slot holds the probe distance in its top
+ * bits, and the bits of the key's hash just below those that pick the ideal
+ * bucket in the rest. So a probe only has to look at a key when those bits
+ * match too, and most misses are rejected from the metadata alone. This
+ * limits the probe distance, and hitting the limit forces the hash to grow,
+ * just as with MVM_HASH_MAX_PROBE_DISTANCE for the other hashes. */
+#define MVM_STR_HASH_METADATA_HASH_BITS 2
+#define MVM_STR_HASH_METADATA_INCREMENT (1 << MVM_STR_HASH_METADATA_HASH_BITS)
+#define MVM_STR_HASH_MAX_PROBE_DISTANCE (0xFF >> MVM_STR_HASH_METADATA_HASH_BITS)
+
 struct MVMStrHashTable {
     /* strictly void *, but this makes the pointer arithmetic easier */
     char *entries;
@@ -7,6 +7,12 @@ void MVM_str_hash_initial_allocate(MVMThreadContext *tc,
                                    MVMStrHashTable *hashtable,
                                    MVMuint32 entries);
 
+/* Grows the hash, if needed, so that it can hold this many entries without
+ * growing again. Call MVM_str_hash_build first. */
+void MVM_str_hash_reserve(MVMThreadContext *tc,
+                          MVMStrHashTable *hashtable,
+                          MVMuint32 entries);
+
 /* Call this before you use the hashtable, to initialise it.
  * Doesn't allocate memory for the hashtable struct itself - you can embed the
  * struct within a larger struct if you wish.
@@ -43,6 +49,30 @@ MVM_STATIC_INLINE MVMuint64 MVM_str_hash_code(MVMThreadContext *tc,
     return (MVM_string_hash_code(tc, key) ^ salt) * UINT64_C(11400714819323198485);
 }
 
+/* Checks whether a key matches that of an entry. Two different strings that
+ * are both interned can't be equal, so only otherwise do we compare them. */
+MVM_STATIC_INLINE int MVM_str_hash_key_matches(MVMThreadContext *tc,
+                                               MVMString *key,
+                                               MVMString *entry_key) {
+    if (entry_key == key)
+        return 1;
+    if ((key->body.flags & entry_key->body.flags & MVM_STRING_FLAG_INTERNED))
+        return 0;
+    return MVM_string_graphs_nocheck(tc, key) == MVM_string_graphs_nocheck(tc, entry_key)
+        && MVM_string_substrings_equal_nocheck(tc, key, 0,
+                                               MVM_string_graphs_nocheck(tc, key),
+                                               entry_key, 0);
+}
+
+/* The metadata byte that a key with the given hash value would have if it
+ * were in its ideal bucket. */
+MVM_STATIC_INLINE unsigned int MVM_str_hash_initial_probe(MVMStrHashTable *hashtable,
+                                                           MVMuint64 hash_val) {
+    return MVM_STR_HASH_METADATA_INCREMENT
+        | ((hash_val >> (hashtable->key_right_shift - MVM_STR_HASH_METADATA_HASH_BITS))
+           & (MVM_STR_HASH_METADATA_INCREMENT - 1));
+}
+
 /* UNCONDITIONALLY creates a new hash entry with the given key and value.
  * Doesn't check if the key already exists. Use with care. */
 void *MVM_str_hash_insert_nocheck(MVMThreadContext *tc,
@@ -55,18 +85,15 @@ MVM_STATIC_INLINE void *MVM_str_hash_fetch_nocheck(MVMThreadContext *tc,
     if (MVM_UNLIKELY(hashtable->entries == NULL)) {
         return NULL;
     }
-    unsigned int probe_distance = 1;
-    MVMHashNumItems bucket = MVM_str_hash_code(tc, hashtable->salt, key) >> hashtable->key_right_shift;
+    MVMuint64 hash_val = MVM_str_hash_code(tc, hashtable->salt, key);
+    MVMHashNumItems bucket = hash_val >> hashtable->key_right_shift;
+    unsigned int probe_distance = MVM_str_hash_initial_probe(hashtable, hash_val);
     char *entry_raw = hashtable->entries + bucket * hashtable->entry_size;
     MVMuint8 *metadata = hashtable->metadata + bucket;
     while (1) {
         if (*metadata == probe_distance) {
             struct MVMStrHashHandle *entry = (struct MVMStrHashHandle *) entry_raw;
-            if (entry->key == key
-                || (MVM_string_graphs_nocheck(tc, key) == MVM_string_graphs_nocheck(tc, entry->key)
-                    && MVM_string_substrings_equal_nocheck(tc, key, 0,
-                                                           MVM_string_graphs_nocheck(tc, key),
-                                                           entry->key, 0))) {
+            if (MVM_str_hash_key_matches(tc, key, entry->key)) {
                 return entry;
             }
         }
@@ -80,10 +107,10 @@ MVM_STATIC_INLINE void *MVM_str_hash_fetch_nocheck(MVMThreadContext *tc,
                we seek can't be in the hash table. */
             return NULL;
         }
-        ++probe_distance;
+        probe_distance += MVM_STR_HASH_METADATA_INCREMENT;
         ++metadata;
         entry_raw += hashtable->entry_size;
-        assert(probe_distance <= MVM_HASH_MAX_PROBE_DISTANCE);
+        assert((probe_distance >> MVM_STR_HASH_METADATA_HASH_BITS) <= MVM_STR_HASH_MAX_PROBE_DISTANCE);
         assert(metadata < hashtable->metadata + hashtable->official_size + hashtable->max_items);
         assert(metadata < hashtable->metadata + hashtable->official_size + 256);
     }
@@ -1,5 +1,6 @@
 #include "moar.h"
 #include "platform/time.h"
+#include "platform/mmap.h"
 
 /* Initializes a new thread context. Note that this doesn't set up a
  * thread itself, it just creates the data structure that exists in
@@ -13,8 +14,9 @@ MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance
 
     /* Set up GC nursery. We only allocate tospace initially, and allocate
      * fromspace the first time this thread GCs, provided it ever does. */
+    tc->numa_node = tc->gc_numa_node = -1;
     tc->nursery_tospace_size = MVM_gc_new_thread_nursery_size(instance);
-    tc->nursery_tospace     = MVM_calloc(1, tc->nursery_tospace_size);
+    tc->nursery_tospace     = MVM_gc_nursery_alloc_space(instance, tc->nursery_tospace_size, -1);
     tc->nursery_alloc       = tc->nursery_tospace;
     tc->nursery_alloc_limit = (char *)tc->nursery_alloc + tc->nursery_tospace_size;
 
@@ -29,7 +31,10 @@ MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance
     tc->gen2roots       = MVM_malloc(sizeof(MVMCollectable *) * tc->alloc_gen2roots);
 
     /* Set up the second generation allocator. */
-    tc->gen2 = MVM_gc_gen2_create(instance);
+    tc->gen2 = MVM_gc_gen2_create(instance, tc);
+
+    /* Start counting down to the first allocation sample, if sampling. */
+    tc->alloc_sample_countdown = instance->alloc_sample_interval;
 
     /* The fixed size allocator also keeps pre-thread state. */
     MVM_fixed_size_create_thread(tc);
@@ -74,6 +79,17 @@ MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance
     return tc;
 }
 
+/* If NUMA-local memory is turned on, makes the thread's memory prefer the
+ * NUMA node of the CPU it is running on. This must be called on the thread
+ * itself, once it has started running. */
+void MVM_tc_bind_numa_node(MVMThreadContext *tc) {
+    if (!tc->instance->gc_numa_local)
+        return;
+    tc->numa_node = tc->gc_numa_node = MVM_platform_numa_node();
+    if (tc->numa_node >= 0)
+        MVM_gc_nursery_bind_numa_node(tc);
+}
+
 /* Destroys a given thread context. This will also free the nursery.
  * This means that it must no longer be in use, at all; this can be
  * ensured by a GC run at thread exit that forces evacuation of all
@@ -92,17 +108,19 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
 
     /* Free specialization state. */
     MVM_spesh_sim_stack_destroy(tc, tc->spesh_sim_stack);
+    MVM_region_cache_destroy(tc);
 
     /* Free the nursery and finalization queue. */
 #if MVM_GC_DEBUG >= 3
     memset(tc->nursery_fromspace, 0xfe, tc->nursery_fromspace_size);
 #endif
-    MVM_free(tc->nursery_fromspace);
+    MVM_gc_nursery_free_space(tc->instance, tc->nursery_fromspace, tc->nursery_fromspace_size);
 #if MVM_GC_DEBUG >= 3
     memset(tc->nursery_tospace, 0xfe, tc->nursery_tospace_size);
 #endif
-    MVM_free(tc->nursery_tospace);
+    MVM_gc_nursery_free_space(tc->instance, tc->nursery_tospace, tc->nursery_tospace_size);
     MVM_free(tc->finalizing);
+    MVM_free(tc->weak_lookups);
 
     /* Destroy the second generation allocator. */
     MVM_gc_gen2_destroy(tc->instance, tc->gen2);
@@ -118,6 +136,13 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
     MVM_free(tc->temproots);
     MVM_free(tc->gen2roots);
     MVM_free(tc->finalize);
+    MVM_free(tc->local_closures);
+    MVM_free(tc->alloc_samples);
+    uv_mutex_lock(&tc->instance->mutex_cpu_samples);
+    MVM_profile_cpu_samples_free(tc, tc->cpu_samples);
+    tc->cpu_samples = NULL;
+    uv_mutex_unlock(&tc->instance->mutex_cpu_samples);
+    MVM_lock_contention_thread_done(tc);
 
     /* Free any memory allocated for NFAs and multi-dim indices. */
     MVM_free(tc->nfa_done);
@@ -126,6 +151,7 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
     MVM_free(tc->nfa_fates);
     MVM_free(tc->nfa_longlit);
     MVM_free(tc->multi_dim_indices);
+    MVM_free(tc->unicode_property_cache);
 
     /* Free temporary working big integers. */
     for (i = 0; i < MVM_NUM_TEMP_BIGINTS; i++) {
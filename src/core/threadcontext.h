@@ -61,6 +61,57 @@ typedef enum {
     MVMDebugSteppingMode_STEP_OUT = 3,
 } MVMDebugSteppingMode;
 
+/* The number of entries in the per-thread lexical name cache, and the
+ * furthest out along the outer chain a cached lookup may have found its
+ * lexical. */
+#define MVM_LEXNAME_CACHE_SIZE  8
+#define MVM_LEXNAME_CACHE_DEPTH 4
+
+/* An entry in the per-thread lexical name cache: which frame out along the
+ * outer chain a lookup by name found a lexical in, and at what index. */
+struct MVMLexnameCacheEntry {
+    /* The name looked up. */
+    MVMString *name;
+
+    /* The static frames of the frames walked, starting with the one the
+     * lookup started from and ending with the one the lexical is in. A hit
+     * requires the frames walked to have the same ones. */
+    MVMStaticFrame *sfs[MVM_LEXNAME_CACHE_DEPTH + 1];
+
+    /* How many outers out the lexical was found, and its index there. */
+    MVMuint16 depth;
+    MVMuint16 idx;
+};
+
+/* The number of entries in the per-thread dynamic variable cache. */
+#define MVM_DYNVAR_CACHE_SIZE 8
+
+/* An entry in the per-thread dynamic variable cache: where a contextual was
+ * found when looked up from the current frame. */
+struct MVMDynvarCacheEntry {
+    /* The name of the contextual. */
+    MVMString *name;
+
+    /* The frame it was found in, or one of its callers that got to know it
+     * from its own dynlex cache; the entry goes when this frame returns. */
+    MVMFrame *frame;
+
+    /* The register holding it, and its type. */
+    MVMRegister *reg;
+    MVMuint16 type;
+};
+
+/* The number of entries in the per-thread synthetic grapheme cache; must be
+ * a power of two. */
+#define MVM_NFG_CACHE_SIZE 64
+
+/* An entry in the per-thread synthetic grapheme cache: a synthetic recently
+ * looked up or made, under the hash of its codepoints. Synthetics live as
+ * long as the instance, so entries never go stale. */
+struct MVMNFGCacheEntry {
+    MVMuint32 hash;
+    MVMint32  synthetic;
+};
 
 /* Information associated with an executing thread. */
 struct MVMThreadContext {
@@ -71,6 +122,13 @@ struct MVMThreadContext {
     /* Internal ID of the thread. */
     MVMuint32 thread_id;
 
+    /* One more than the index of the scheduler worker this thread is, or 0
+     * if it isn't one. */
+    MVMuint32 scheduler_worker;
+
+    /* The event loop this thread runs, if it is an event loop thread. */
+    MVMEventLoop *event_loop;
+
     /* Thread object representing the thread. */
     MVMThread *thread_obj;
 
@@ -111,13 +169,56 @@ struct MVMThreadContext {
     MVMuint32 nursery_fromspace_size;
     MVMuint32 nursery_tospace_size;
 
+    /* How many nursery collections this thread has taken part in, and how
+     * many of the most recent ones in a row found its nursery mostly
+     * unused (which is how we decide to shrink it). */
+    MVMuint32 nursery_collections;
+    MVMuint32 nursery_underused_runs;
+
+    /* The NUMA node this thread's nursery and gen2 pages prefer (-1 until
+     * the thread starts running, or if it is not known), and the node it
+     * was running on when it last joined in with a GC run. */
+    MVMint32 numa_node;
+    MVMint32 gc_numa_node;
+
+    /* Time spent by this thread in each phase of the current GC run, added
+     * to the instance-wide statistics at the end of it. */
+    MVMuint64 gc_phase_time[MVM_GC_PHASES];
+
     /* Non-zero is we should allocate in gen2; incremented/decremented as we
      * enter/leave a region wanting gen2 allocation. */
     MVMuint32 allocate_in_gen2;
 
+    /* Allocation sampling: the number of object allocations until the next
+     * sample is taken (zero if sampling is off), and an open addressing table
+     * of samples by type and allocating frame. It is rehashed after the
+     * thread's nursery is collected, since the keys may have moved. */
+    MVMuint32       alloc_sample_countdown;
+    MVMuint32       alloc_samples_size;
+    MVMuint32       alloc_samples_used;
+    MVMuint32       alloc_samples_collections;
+    MVMAllocSample *alloc_samples;
+
+    /* CPU sampling: the last sampling timer epoch this thread saw, and the
+     * tree of call stacks it took samples of. */
+    AO_t              cpu_sample_epoch;
+    MVMCPUSampleNode *cpu_samples;
+
+    /* Lock contention profiling counts of this thread, made on first use. */
+    MVMLockContention *lock_contention;
+
     /* Number of bytes promoted to gen2 in current GC run. */
     MVMuint32 gc_promoted_bytes;
 
+    /* With thread-local collection enabled: whether a nursery object of this
+     * thread may have become reachable by another thread since the last
+     * stop-the-world run (set by the write barrier); whether the current run
+     * must promote everything in the nursery so the flag can be cleared; and
+     * whether the current run is one the thread is doing on its own. */
+    MVMuint8 gc_nursery_escaped;
+    MVMuint8 gc_promote_nursery;
+    MVMuint8 gc_local;
+
     /* Temporarily rooted objects. This is generally used by code written in
      * C that wants to keep references to objects. Since those may change
      * if the code in question also allocates, there is a need to register
@@ -146,6 +247,12 @@ struct MVMThreadContext {
     MVMuint32             alloc_finalizing;
     MVMObject           **finalizing;
 
+    /* Parametric types reached in a full collection with weak
+     * parameterizations, whose lookups are yet to be pruned and marked. */
+    MVMuint32             num_weak_lookups;
+    MVMuint32             alloc_weak_lookups;
+    MVMSTable           **weak_lookups;
+
     /* The GC's cross-thread in-tray of processing work. */
     MVMGCPassedWork *gc_in_tray;
 
@@ -197,6 +304,32 @@ struct MVMThreadContext {
     /* Current call stack region, which the next frame will be allocated in. */
     MVMCallStackRegion *stack_current;
 
+    /* Closures taken by specialized code that found them to be only invoked
+     * by the frame taking them, which so is still on the call stack as their
+     * outer (see MVM_frame_takeclosure_local). */
+    MVMCode   **local_closures;
+    MVMuint32   num_local_closures;
+    MVMuint32   alloc_local_closures;
+
+    /* Cache of dynamic variable lookups from the current frame, so that the
+     * likes of $*OUT needn't be searched for down a deep stack each time (see
+     * MVM_frame_find_dynamic_using_frame_walker). The index of the entry to
+     * replace next when it is full. */
+    MVMDynvarCacheEntry dynvar_cache[MVM_DYNVAR_CACHE_SIZE];
+    MVMuint32           num_dynvar_cache;
+    MVMuint32           next_dynvar_cache;
+
+    /* Cache of lexical lookups by name along outer chains (see
+     * MVM_frame_find_lexical_by_name), with the index of the entry to
+     * replace next when it is full. */
+    MVMLexnameCacheEntry lexname_cache[MVM_LEXNAME_CACHE_SIZE];
+    MVMuint32            num_lexname_cache;
+    MVMuint32            next_lexname_cache;
+
+    /* Cache of synthetic grapheme lookups by codepoints, indexed by their
+     * hash, so repeated ones needn't walk the NFG trie (see nfg.c). */
+    MVMNFGCacheEntry nfg_cache[MVM_NFG_CACHE_SIZE];
+
     /* Linked list of exception handlers that we're currently executing, topmost
      * one first in the list. */
     MVMActiveHandler *active_handlers;
@@ -229,9 +362,21 @@ struct MVMThreadContext {
      * change to produce some specializations. */
     AO_t spesh_log_quota;
 
+    /* Log only one in this many frame entries, adapted to how backed up
+     * the spesh worker is, and how many more to skip before the next one
+     * (see MVM_spesh_log_sample). */
+    MVMuint32 spesh_log_sample_rate;
+    MVMuint32 spesh_log_sample_countdown;
+
     /* The spesh stack simulation, perserved between processing logs. */
     MVMSpeshSimStack *spesh_sim_stack;
 
+    /* Blocks left by region allocators (used for spesh graphs) that were
+     * destroyed, kept for the next ones to reuse, and how many there are;
+     * one list for each of the two sizes of block (see regionalloc.h). */
+    MVMRegionBlock *region_block_cache[2];
+    MVMuint32 region_block_cache_size[2];
+
     /* The current spesh graph that we are optimizing, retained here so we
      * can GC mark it and so be able to GC at certain points during the
      * optimization process, giving less GC latency. */
@@ -314,6 +459,10 @@ struct MVMThreadContext {
     MVMint64 *nfa_longlit;
     MVMint64  nfa_longlit_len;
 
+    /* Cache of codepoint property values, allocated on first use; see
+     * unicode_ops.c. */
+    MVMUnicodePropertyCacheEntry *unicode_property_cache;
+
     /* Memory for doing multi-dim indexing with late-bound dimension counts. */
     MVMint64 *multi_dim_indices;
     MVMint64  num_multi_dim_indices;
@@ -335,6 +484,7 @@ struct MVMThreadContext {
 };
 
 MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance);
+void MVM_tc_bind_numa_node(MVMThreadContext *tc);
 void MVM_tc_destroy(MVMThreadContext *tc);
 void MVM_tc_set_ex_release_mutex(MVMThreadContext *tc, uv_mutex_t *mutex);
 void MVM_tc_set_ex_release_atomic(MVMThreadContext *tc, AO_t *flag);
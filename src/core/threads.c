@@ -1,5 +1,6 @@
 #include "moar.h"
 #include <platform/threads.h>
+#include "platform/sys.h"
 
 /* Temporary structure for passing data to thread start. */
 typedef struct {
@@ -34,6 +35,12 @@ MVMObject * MVM_thread_new(MVMThreadContext *tc, MVMObject *invokee, MVMint64 ap
     child_tc->thread_obj = thread;
     child_tc->thread_id = 1 + MVM_incr(&tc->instance->next_user_thread_id);
         /* Add one, since MVM_incr returns original. */
+#ifdef MVM_COMPACT_HEADERS
+    /* Thread IDs are never reused, and the owner in a compact header only
+     * has 16 bits. */
+    if (child_tc->thread_id > 0xFFFF)
+        MVM_oops(tc, "Cannot create more than %d threads with compact object headers", 0xFFFF);
+#endif
     thread->body.tc = child_tc;
 
     MVM_telemetry_interval_stop(child_tc, interval_id, "i'm the newly spawned thread.");
@@ -42,6 +49,9 @@ MVMObject * MVM_thread_new(MVMThreadContext *tc, MVMObject *invokee, MVMint64 ap
      * is available once the thread dies and its ThreadContext is gone. */
     thread->body.thread_id = child_tc->thread_id;
 
+    /* The new thread will see the thread object and the code it runs. */
+    MVM_gc_note_escape(tc);
+
     return (MVMObject *)thread;
 }
 
@@ -64,6 +74,23 @@ static void thread_initial_invoke(MVMThreadContext *tc, void *data) {
     tc->thread_entry_frame = tc->cur_frame;
 }
 
+/* Pins a starting thread to its CPUs and sets its priority, if that was
+ * asked for either for the thread itself or, for VM internal threads, for
+ * all of them. Much as with NUMA binding, this is only a preference, so it
+ * is no problem if it can't be done. */
+static void apply_placement(MVMThreadContext *tc, MVMThread *thread, MVMint32 internal) {
+    MVMInstance *instance = tc->instance;
+    MVMuint64   *affinity = thread->body.affinity;
+    if (!affinity && internal)
+        affinity = instance->internal_thread_affinity;
+    if (affinity)
+        MVM_platform_thread_set_affinity(affinity, MVM_CPU_SET_WORDS);
+    if (thread->body.has_priority)
+        MVM_platform_thread_set_priority(thread->body.priority);
+    else if (internal && instance->has_internal_thread_priority)
+        MVM_platform_thread_set_priority(instance->internal_thread_priority);
+}
+
 /* This callback handles starting execution of a thread. */
 static void start_thread(void *data) {
     ThreadStart *ts = (ThreadStart *)data;
@@ -73,8 +100,17 @@ static void start_thread(void *data) {
     MVM_gc_mark_thread_unblocked(tc);
     tc->thread_obj->body.stage = MVM_thread_stage_started;
 
-    /* Stash thread ID. */
+    /* Stash thread ID, and the thread context for native callbacks. */
     tc->thread_obj->body.native_thread_id = MVM_platform_thread_id();
+    uv_key_set(&tc->instance->native_thread_tc, tc);
+
+    /* Move to the CPUs we were asked to run on before anything is put on
+     * the NUMA node we're running on. */
+    apply_placement(tc, tc->thread_obj,
+        REPR(tc->thread_obj->body.invokee)->ID == MVM_REPR_ID_MVMCFunction);
+
+    /* Now we know where we're running, put our memory there if wanted. */
+    MVM_tc_bind_numa_node(tc);
 
     /* Create a spesh log for this thread, unless it's just going to run C
      * code (and thus it's a VM internal worker). */
@@ -87,6 +123,7 @@ static void start_thread(void *data) {
     MVM_interp_run(tc, thread_initial_invoke, ts, NULL);
 
     MVM_debugserver_notify_thread_destruction(tc);
+    uv_key_set(&tc->instance->native_thread_tc, NULL);
 
     /* Pop the temp root stack's ts->thread_obj, if it's still there (if we
      * cleared the temp root stack on exception at some point, it'll already be
@@ -143,6 +180,7 @@ void MVM_thread_run(MVMThreadContext *tc, MVMObject *thread_obj) {
                 MVM_ASSIGN_REF(tc, &(child->common.header), child->body.next,
                     tc->instance->threads);
                 tc->instance->threads = child;
+                MVM_gc_note_escape(tc);
 
                 /* Store the thread object in the thread start information and
                  * keep it alive by putting it in the *child* tc's temp roots. */
@@ -366,3 +404,171 @@ void MVM_thread_set_self_name(MVMThreadContext *tc, MVMString *name) {
     });
     #endif
 }
+
+/* Parses a list of CPU indexes and ranges of them, such as "0,2-3", into a
+ * mask of MVM_CPU_SET_WORDS words. Returns NULL if it isn't a valid list or
+ * names no CPUs. */
+MVMuint64 * MVM_thread_parse_cpu_list(const char *spec) {
+    MVMuint64 *mask = MVM_calloc(MVM_CPU_SET_WORDS, sizeof(MVMuint64));
+    MVMint32   any  = 0;
+    const char *pos = spec;
+    while (*pos) {
+        char *end;
+        unsigned long first = strtoul(pos, &end, 10), last, cpu;
+        if (end == pos)
+            goto invalid;
+        last = first;
+        pos  = end;
+        if (*pos == '-') {
+            last = strtoul(pos + 1, &end, 10);
+            if (end == pos + 1 || last < first)
+                goto invalid;
+            pos = end;
+        }
+        if (last >= MVM_CPU_SET_WORDS * 64)
+            goto invalid;
+        for (cpu = first; cpu <= last; cpu++)
+            mask[cpu / 64] |= (MVMuint64)1 << (cpu % 64);
+        any = 1;
+        if (*pos == ',')
+            pos++;
+        else if (*pos)
+            goto invalid;
+    }
+    if (any)
+        return mask;
+  invalid:
+    MVM_free(mask);
+    return NULL;
+}
+
+static MVMThread * placement_target(MVMThreadContext *tc, MVMObject *thread_obj, const char *op) {
+    MVMThread *thread = (MVMThread *)thread_obj;
+    if (REPR(thread_obj)->ID != MVM_REPR_ID_MVMThread || !IS_CONCRETE(thread_obj))
+        MVM_exception_throw_adhoc(tc,
+            "Thread handle passed to %s must have representation MVMThread", op);
+    if (MVM_load(&thread->body.stage) != MVM_thread_stage_unstarted && thread != tc->thread_obj)
+        MVM_exception_throw_adhoc(tc,
+            "%s can only be used on a thread that was not yet started, or the current thread", op);
+    return thread;
+}
+
+/* Sets the CPUs a thread may run on, from a list of CPU indexes. This takes
+ * effect when the thread starts, or right away for the current thread. */
+void MVM_thread_set_affinity(MVMThreadContext *tc, MVMObject *thread_obj, MVMObject *cpus) {
+    MVMThread *thread = placement_target(tc, thread_obj, "threadaffinity");
+    MVMuint64 *mask   = MVM_calloc(MVM_CPU_SET_WORDS, sizeof(MVMuint64));
+    MVMint64   elems  = MVM_repr_elems(tc, cpus);
+    MVMint64   i;
+    for (i = 0; i < elems; i++) {
+        MVMint64 cpu = MVM_repr_at_pos_i(tc, cpus, i);
+        if (cpu < 0 || cpu >= MVM_CPU_SET_WORDS * 64) {
+            MVM_free(mask);
+            MVM_exception_throw_adhoc(tc, "CPU index %"PRId64" out of range in threadaffinity", cpu);
+        }
+        mask[cpu / 64] |= (MVMuint64)1 << (cpu % 64);
+    }
+    if (elems == 0) {
+        MVM_free(mask);
+        MVM_exception_throw_adhoc(tc, "threadaffinity needs at least one CPU");
+    }
+    if (thread == tc->thread_obj && MVM_load(&thread->body.stage) != MVM_thread_stage_unstarted) {
+        MVMint32 ok = MVM_platform_thread_set_affinity(mask, MVM_CPU_SET_WORDS);
+        MVM_free(mask);
+        if (!ok)
+            MVM_exception_throw_adhoc(tc, "Could not set the CPU affinity of the current thread");
+    }
+    else {
+        MVM_free(thread->body.affinity);
+        thread->body.affinity = mask;
+    }
+}
+
+/* Sets the priority of a thread, as a nice value from -20 (the highest) to
+ * 19 (the lowest). This takes effect when the thread starts, or right away
+ * for the current thread. */
+void MVM_thread_set_priority(MVMThreadContext *tc, MVMObject *thread_obj, MVMint64 priority) {
+    MVMThread *thread = placement_target(tc, thread_obj, "threadpriority");
+    if (priority < -20 || priority > 19)
+        MVM_exception_throw_adhoc(tc,
+            "Thread priority must be from -20 to 19, but got %"PRId64, priority);
+    if (thread == tc->thread_obj && MVM_load(&thread->body.stage) != MVM_thread_stage_unstarted) {
+        if (!MVM_platform_thread_set_priority((MVMint32)priority))
+            MVM_exception_throw_adhoc(tc, "Could not set the priority of the current thread");
+    }
+    else {
+        thread->body.priority     = (MVMint32)priority;
+        thread->body.has_priority = 1;
+    }
+}
+
+/* Creates a worker pool of the given number of threads, which wait on the
+ * passed condition variable, with its mutex, for work. None are started. */
+MVMWorkerPool * MVM_worker_pool_create(MVMuint32 num_threads, uv_mutex_t *mutex, uv_cond_t *cond,
+        void (*entry) (MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args)) {
+    MVMWorkerPool *pool = MVM_calloc(1, sizeof(MVMWorkerPool));
+    pool->num_threads   = num_threads;
+    pool->threads       = MVM_calloc(num_threads ? num_threads : 1, sizeof(MVMObject *));
+    pool->mutex         = mutex;
+    pool->cond          = cond;
+    pool->entry         = entry;
+    return pool;
+}
+
+/* Starts the threads of a worker pool, if they aren't running. The pool must
+ * be marked by the GC, since the thread objects are kept in it. */
+void MVM_worker_pool_start(MVMThreadContext *tc, MVMWorkerPool *pool) {
+    MVMuint32 n;
+    if (pool->running)
+        return;
+    pool->stop    = 0;
+    pool->running = 1;
+    for (n = 0; n < pool->num_threads; n++) {
+        MVMObject *entry = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTCCode);
+        ((MVMCFunction *)entry)->body.func = pool->entry;
+        pool->threads[n] = MVM_thread_new(tc, entry, 1);
+        MVM_thread_run(tc, pool->threads[n]);
+    }
+}
+
+/* Tells the threads of a worker pool to stop, wakes them all, and joins
+ * them. A thread busy with work finishes it first. */
+void MVM_worker_pool_stop(MVMThreadContext *tc, MVMWorkerPool *pool) {
+    MVMuint32 n;
+    if (!pool->running)
+        return;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(pool->mutex);
+    MVM_gc_mark_thread_unblocked(tc);
+    pool->stop = 1;
+    uv_cond_broadcast(pool->cond);
+    uv_mutex_unlock(pool->mutex);
+    for (n = 0; n < pool->num_threads; n++) {
+        if (pool->threads[n]) {
+            MVM_thread_join(tc, pool->threads[n]);
+            pool->threads[n] = NULL;
+        }
+    }
+    pool->running = 0;
+}
+
+/* Frees a worker pool, which must have been stopped. */
+void MVM_worker_pool_destroy(MVMWorkerPool *pool) {
+    MVM_free(pool->threads);
+    MVM_free(pool);
+}
+
+/* Marks the thread objects of a worker pool. */
+void MVM_worker_pool_gc_mark(MVMThreadContext *tc, MVMWorkerPool *pool, MVMGCWorklist *worklist,
+        MVMHeapSnapshotState *snapshot, char *description) {
+    MVMuint32 n;
+    if (!pool)
+        return;
+    for (n = 0; n < pool->num_threads; n++) {
+        if (worklist)
+            MVM_gc_worklist_add(tc, worklist, &(pool->threads[n]));
+        else
+            MVM_profile_heap_add_collectable_rel_const_cstr(tc, snapshot,
+                (MVMCollectable *)pool->threads[n], description);
+    }
+}
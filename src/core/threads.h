@@ -1,3 +1,29 @@
+/* CPU masks used for thread affinity are this many 64 bit words long. */
+#define MVM_CPU_SET_WORDS 16
+
+/* A pool of VM internal threads that sleep on a condition variable until
+ * there's work for them. It can be stopped, which wakes the threads and
+ * joins them once they see the stop flag (they must check it, with the mutex
+ * held, each time they wake), and started again; this is done around a fork
+ * and when the instance is destroyed. */
+struct MVMWorkerPool {
+    /* The number of threads, and their thread objects while running. */
+    MVMuint32   num_threads;
+    MVMObject **threads;
+
+    /* Whether the threads are running, and whether they've been told to
+     * stop; the latter is only changed with the mutex held. */
+    MVMuint32   running;
+    MVMuint32   stop;
+
+    /* The lock and condition variable the threads wait for work on. */
+    uv_mutex_t *mutex;
+    uv_cond_t  *cond;
+
+    /* What each thread runs. */
+    void (*entry) (MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args);
+};
+
 MVMObject * MVM_thread_new(MVMThreadContext *tc, MVMObject *invokee, MVMint64 app_lifetime);
 void MVM_thread_run(MVMThreadContext *tc, MVMObject *thread);
 void MVM_thread_join(MVMThreadContext *tc, MVMObject *thread);
@@ -10,3 +36,13 @@ MVMint64 MVM_thread_lock_count(MVMThreadContext *tc, MVMObject *thread);
 MVMint32 MVM_thread_cleanup_threads_list(MVMThreadContext *tc, MVMThread **head);
 void MVM_thread_join_foreground(MVMThreadContext *tc);
 void MVM_thread_set_self_name(MVMThreadContext *tc, MVMString *name);
+MVMuint64 * MVM_thread_parse_cpu_list(const char *spec);
+void MVM_thread_set_affinity(MVMThreadContext *tc, MVMObject *thread, MVMObject *cpus);
+void MVM_thread_set_priority(MVMThreadContext *tc, MVMObject *thread, MVMint64 priority);
+MVMWorkerPool * MVM_worker_pool_create(MVMuint32 num_threads, uv_mutex_t *mutex, uv_cond_t *cond,
+    void (*entry) (MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args));
+void MVM_worker_pool_start(MVMThreadContext *tc, MVMWorkerPool *pool);
+void MVM_worker_pool_stop(MVMThreadContext *tc, MVMWorkerPool *pool);
+void MVM_worker_pool_destroy(MVMWorkerPool *pool);
+void MVM_worker_pool_gc_mark(MVMThreadContext *tc, MVMWorkerPool *pool, MVMGCWorklist *worklist,
+    MVMHeapSnapshotState *snapshot, char *description);
@@ -15,8 +15,7 @@ MVM_STATIC_INLINE MVMuint32 hash_true_size(MVMUniHashTable *hashtable) {
    which you allocated (heap, stack, inside another struct, wherever) */
 void MVM_uni_hash_demolish(MVMThreadContext *tc, MVMUniHashTable *hashtable) {
     if (hashtable->metadata) {
-        MVM_free(hashtable->entries);
-        MVM_free(hashtable->metadata - 1);
+        MVM_hash_free_storage(hashtable->entries, hashtable->metadata);
     }
 }
 /* and then free memory if you allocated it */
@@ -25,8 +24,8 @@ void MVM_uni_hash_demolish(MVMThreadContext *tc, MVMUniHashTable *hashtable) {
 MVM_STATIC_INLINE void hash_allocate_common(MVMUniHashTable *hashtable) {
     hashtable->max_items = hashtable->official_size * UNI_LOAD_FACTOR;
     size_t actual_items = hash_true_size(hashtable);
-    hashtable->entries = MVM_malloc(sizeof(struct MVMUniHashEntry) * actual_items);
-    hashtable->metadata = MVM_calloc(1 + actual_items + 1, 1);
+    hashtable->metadata = MVM_hash_allocate_storage(&hashtable->entries,
+        sizeof(struct MVMUniHashEntry) * actual_items, 1 + actual_items + 1);
     /* A sentinel. This marks an occupied slot, at its ideal position. */
     *hashtable->metadata = 1;
     ++hashtable->metadata;
@@ -186,8 +185,7 @@ MVM_STATIC_INLINE void *MVM_uni_hash_lvalue_fetch(MVMThreadContext *tc,
             ++metadata;
             entry_raw += sizeof(struct MVMUniHashEntry);
         }
-        MVM_free(entry_raw_orig);
-        MVM_free(metadata_orig - 1);
+        MVM_hash_free_storage(entry_raw_orig, metadata_orig);
     }
     MVMuint32 hash_val = MVM_uni_hash_code(key, strlen(key));
     struct MVMUniHashEntry *new_entry
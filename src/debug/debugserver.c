@@ -106,6 +106,8 @@ typedef enum {
     FS_frame_number = 512,
     FS_arguments    = 1024,
     FS_name       = 2048,
+    FS_every      = 4096,
+    FS_rate       = 8192,
 } fields_set;
 
 typedef struct {
@@ -120,6 +122,9 @@ typedef struct {
     MVMuint8  suspend;
     MVMuint8  stacktrace;
 
+    MVMuint32 every;
+    MVMuint32 rate;
+
     MVMuint16 handle_count;
     MVMuint64 *handles;
 
@@ -246,6 +251,89 @@ static void stop_point_hit(MVMThreadContext *tc) {
     MVM_gc_enter_from_interrupt(tc);
 }
 
+/* Decides whether a breakpoint that was just hit fires, which it doesn't if
+ * it is only to fire every so many hits, or if it already fired as often as
+ * its rate limit allows in the current one second window. Called with the
+ * network send mutex held, which also protects the counters. */
+static MVMuint8 breakpoint_fires(MVMThreadContext *tc, MVMDebugServerBreakpointInfo *info) {
+    info->hits++;
+    if (info->every && info->hits % info->every != 0)
+        return 0;
+    if (info->rate) {
+        MVMuint64 now = uv_hrtime();
+        if (now - info->window_start >= 1000000000) {
+            info->window_start = now;
+            info->window_fired = 0;
+        }
+        if (info->window_fired >= info->rate) {
+            info->skipped++;
+            return 0;
+        }
+        info->window_fired++;
+    }
+    return 1;
+}
+
+/* Writes the value of the lexical a tracepoint asked for out of the current
+ * frame, or nil if it has none by that name. Objects are only described, as
+ * handles may only be made by the debugserver thread. */
+static void write_tracepoint_lexical(MVMThreadContext *tc, cmp_ctx_t *ctx, const char *lexical) {
+    MVMFrame *frame = tc->cur_frame;
+    MVMStaticFrame *sf = frame->static_info;
+    MVMString **names = sf->body.lexical_names_list;
+    MVMuint32 j;
+
+    cmp_write_str(ctx, "lexical", 7);
+    for (j = 0; j < sf->body.num_lexicals; j++) {
+        char *c_name = MVM_string_utf8_encode_C_string(tc, names[j]);
+        MVMint32 matches = strcmp(c_name, lexical) == 0;
+        MVM_free(c_name);
+        if (matches) {
+            MVMuint16 lextype = sf->body.lexical_types[j];
+            MVMRegister *value = &frame->env[j];
+            cmp_write_map(ctx, 2);
+            cmp_write_str(ctx, "kind", 4);
+            if (lextype == MVM_reg_obj) {
+                char *debugname = value->o
+                    ? MVM_6model_get_debug_name(tc, value->o)
+                    : "VMNull";
+                cmp_write_str(ctx, "obj", 3);
+                cmp_write_str(ctx, "type", 4);
+                cmp_write_str(ctx, debugname, strlen(debugname));
+            }
+            else if (lextype == MVM_reg_int64) {
+                cmp_write_str(ctx, "int", 3);
+                cmp_write_str(ctx, "value", 5);
+                cmp_write_integer(ctx, value->i64);
+            }
+            else if (lextype == MVM_reg_num64) {
+                cmp_write_str(ctx, "num", 3);
+                cmp_write_str(ctx, "value", 5);
+                cmp_write_double(ctx, value->n64);
+            }
+            else if (lextype == MVM_reg_str) {
+                cmp_write_str(ctx, "str", 3);
+                cmp_write_str(ctx, "value", 5);
+                if (value->s && IS_CONCRETE(value->s)) {
+                    char *c_value = MVM_string_utf8_encode_C_string(tc, value->s);
+                    cmp_write_str(ctx, c_value, strlen(c_value));
+                    MVM_free(c_value);
+                }
+                else {
+                    cmp_write_nil(ctx);
+                }
+            }
+            else {
+                cmp_write_str(ctx, "???", 3);
+                cmp_write_str(ctx, "value", 5);
+                cmp_write_nil(ctx);
+            }
+            return;
+        }
+    }
+    cmp_write_nil(ctx);
+}
+
 static MVMuint8 breakpoint_hit(MVMThreadContext *tc, MVMDebugServerBreakpointFileTable *file, MVMuint32 line_no) {
     cmp_ctx_t *ctx = NULL;
     MVMDebugServerBreakpointInfo *info;
@@ -260,11 +348,16 @@ static MVMuint8 breakpoint_hit(MVMThreadContext *tc, MVMDebugServerBreakpointFil
         info = &file->breakpoints[index];
 
         if (info->line_no == line_no) {
+            MVMuint8 is_tracepoint = info->every || info->rate;
             if (tc->instance->debugserver->debugspam_protocol)
                 fprintf(stderr, "hit a breakpoint\n");
             if (ctx) {
                 uv_mutex_lock(&tc->instance->debugserver->mutex_network_send);
-                cmp_write_map(ctx, 4);
+                if (!breakpoint_fires(tc, info)) {
+                    uv_mutex_unlock(&tc->instance->debugserver->mutex_network_send);
+                    continue;
+                }
+                cmp_write_map(ctx, 4 + (is_tracepoint ? 2 : 0) + (info->lexical ? 1 : 0));
                 cmp_write_str(ctx, "id", 2);
                 cmp_write_integer(ctx, info->breakpoint_id);
                 cmp_write_str(ctx, "type", 4);
@@ -277,6 +370,15 @@ static MVMuint8 breakpoint_hit(MVMThreadContext *tc, MVMDebugServerBreakpointFil
                 } else {
                     cmp_write_nil(ctx);
                 }
+                if (is_tracepoint) {
+                    cmp_write_str(ctx, "hits", 4);
+                    cmp_write_integer(ctx, info->hits);
+                    cmp_write_str(ctx, "skipped", 7);
+                    cmp_write_integer(ctx, info->skipped);
+                    info->skipped = 0;
+                }
+                if (info->lexical)
+                    write_tracepoint_lexical(tc, ctx, info->lexical);
                 uv_mutex_unlock(&tc->instance->debugserver->mutex_network_send);
             }
             if (info->shall_suspend) {
@@ -314,7 +416,7 @@ MVM_PUBLIC void MVM_debugserver_breakpoint_check(MVMThreadContext *tc, MVMuint32
         MVMDebugServerBreakpointTable *table = debugserver->breakpoints;
         MVMDebugServerBreakpointFileTable *found = &table->files[file_idx];
 
-        if (debugserver->any_breakpoints_at_all && found->breakpoints_used && found->lines_active[line_no]) {
+        if (found->breakpoints_used && found->lines_active[line_no]) {
             shall_suspend |= breakpoint_hit(tc, found, line_no);
         }
     }
@@ -384,6 +486,8 @@ MVMuint8 check_requirements(MVMThreadContext *tc, request_data *data) {
         case MT_SetBreakpointRequest:
             REQUIRE(FS_suspend, "A suspend field is required");
             REQUIRE(FS_stacktrace, "A stacktrace field is required");
+            /* The tracepoint settings are optional. */
+            accepted |= data->fields_set & (FS_every | FS_rate | FS_name);
             /* Fall-Through */
         case MT_ClearBreakpoint:
             REQUIRE(FS_file, "A file field is required");
@@ -1034,6 +1138,14 @@ void MVM_debugserver_add_breakpoint(MVMThreadContext *tc, cmp_ctx_t *ctx, reques
     bp_info->line_no = argument->line;
     bp_info->shall_suspend = argument->suspend;
     bp_info->send_backtrace = argument->stacktrace;
+    bp_info->every = argument->every;
+    bp_info->rate = argument->rate;
+    bp_info->lexical = argument->name;
+    argument->name = NULL;
+    bp_info->hits = 0;
+    bp_info->window_fired = 0;
+    bp_info->window_start = 0;
+    bp_info->skipped = 0;
 
     debugserver->any_breakpoints_at_all++;
 
@@ -1062,8 +1174,12 @@ void MVM_debugserver_clear_all_breakpoints(MVMThreadContext *tc, cmp_ctx_t *ctx,
     uv_mutex_lock(&debugserver->mutex_breakpoints);
 
     for (index = 0; index < table->files_used; index++) {
+        MVMuint32 bpidx;
         found = &table->files[index];
         memset(found->lines_active, 0, found->lines_active_alloc * sizeof(MVMuint8));
+        for (bpidx = 0; bpidx < found->breakpoints_used; bpidx++)
+            if (found->breakpoints[bpidx].lexical)
+                MVM_free_at_safepoint(tc, found->breakpoints[bpidx].lexical);
         found->breakpoints_used = 0;
     }
 
@@ -1112,6 +1228,8 @@ void MVM_debugserver_clear_breakpoint(MVMThreadContext *tc, cmp_ctx_t *ctx, requ
         if (bp_info->line_no == argument->line) {
             if (tc->instance->debugserver->debugspam_protocol)
                 fprintf(stderr, "breakpoint with id %"PRIu64" cleared\n", bp_info->breakpoint_id);
+            if (bp_info->lexical)
+                MVM_free_at_safepoint(tc, bp_info->lexical);
             found->breakpoints[bpidx] = found->breakpoints[--found->breakpoints_used];
             num_cleared++;
             bpidx--;
@@ -1945,12 +2063,12 @@ static MVMint32 request_object_metadata(MVMThreadContext *dtc, cmp_ctx_t *ctx, r
         cmp_write_map(ctx, slots);
 
         if (IS_CONCRETE(target)) {
-            MVMStrHashTable *hashtable = &(((MVMHashBody *)OBJECT_BODY(target))->hashtable);
+            MVMHashBody *body = (MVMHashBody *)OBJECT_BODY(target);
 
             /* FIXME. What stats should we generate? Some are O(1),
              * some are O(n) (like mean probe length, and its SD) */
             cmp_write_str(ctx, "mvmhash_num_items", 17);
-            cmp_write_int(ctx, hashtable->cur_items);
+            cmp_write_int(ctx, MVM_hash_count(dtc, body));
         }
 
         write_object_features(dtc, ctx, 0, 0, 1);
@@ -2126,7 +2244,7 @@ static MVMint32 request_object_metadata(MVMThreadContext *dtc, cmp_ctx_t *ctx, r
 
     if (IS_CONCRETE(target)) {
         cmp_write_str(ctx, "size", 4);
-        cmp_write_int(ctx, target->header.size);
+        cmp_write_int(ctx, MVM_gc_collectable_size(&target->header));
     }
 
     cmp_write_str(ctx, "repr_name", 9);
@@ -2234,8 +2352,8 @@ static MVMint32 request_object_associatives(MVMThreadContext *dtc, cmp_ctx_t *ct
     }
 
     if (REPR(target)->ID == MVM_REPR_ID_MVMHash) {
-        MVMStrHashTable *hashtable = &(((MVMHashBody *)OBJECT_BODY(target))->hashtable);
-        MVMuint64 count = MVM_str_hash_count(dtc, hashtable);
+        MVMHashBody *body = (MVMHashBody *)OBJECT_BODY(target);
+        MVMuint64 count = MVM_hash_count(dtc, body);
 
         cmp_write_map(ctx, 4);
         cmp_write_str(ctx, "id", 2);
@@ -2249,9 +2367,9 @@ static MVMint32 request_object_associatives(MVMThreadContext *dtc, cmp_ctx_t *ct
         cmp_write_str(ctx, "contents", 8);
         cmp_write_map(ctx, count);
 
-        MVMStrHashIterator iterator = MVM_str_hash_first(dtc, hashtable);
-        while (!MVM_str_hash_at_end(dtc, hashtable, iterator)) {
-            MVMHashEntry *entry = MVM_str_hash_current_nocheck(dtc, hashtable, iterator);
+        MVMStrHashIterator iterator = MVM_hash_first(dtc, body);
+        while (!MVM_hash_at_end(dtc, body, iterator)) {
+            MVMHashEntry *entry = MVM_hash_current_nocheck(dtc, body, iterator);
             char *key = MVM_string_utf8_encode_C_string(dtc, entry->hash_handle.key);
             MVMObject *value = entry->value;
             char *value_debug_name = value ? MVM_6model_get_debug_name(dtc, value) : "VMNull";
@@ -2277,7 +2395,7 @@ static MVMint32 request_object_associatives(MVMThreadContext *dtc, cmp_ctx_t *ct
 
             MVM_free(key);
 
-            iterator = MVM_str_hash_next_nocheck(dtc, hashtable, iterator);
+            iterator = MVM_hash_next_nocheck(dtc, body, iterator);
         }
     }
 
@@ -2539,6 +2657,14 @@ MVMint32 parse_message_map(MVMThreadContext *tc, cmp_ctx_t *ctx, request_data *d
             FIELD_FOUND(FS_stacktrace, "stacktrace field duplicated");
             type_to_parse = 1;
         }
+        else if (strncmp(key_str, "every", 15) == 0) {
+            FIELD_FOUND(FS_every, "every field duplicated");
+            type_to_parse = 1;
+        }
+        else if (strncmp(key_str, "rate", 15) == 0) {
+            FIELD_FOUND(FS_rate, "rate field duplicated");
+            type_to_parse = 1;
+        }
         else if (strncmp(key_str, "file", 15) == 0) {
             FIELD_FOUND(FS_file, "file field duplicated");
             type_to_parse = 2;
@@ -2587,6 +2713,12 @@ MVMint32 parse_message_map(MVMThreadContext *tc, cmp_ctx_t *ctx, request_data *d
                 case FS_stacktrace:
                     data->stacktrace = result;
                     break;
+                case FS_every:
+                    data->every = result;
+                    break;
+                case FS_rate:
+                    data->rate = result;
+                    break;
                 default:
                     data->parse_fail = 1;
                     data->parse_fail_message = "Int field to set NYI";
@@ -18,6 +18,21 @@ struct MVMDebugServerBreakpointInfo {
 
     MVMuint8 shall_suspend;
     MVMuint8 send_backtrace;
+
+    /* Tracepoint settings: only fire on every Nth hit, at most so many times
+     * a second, and the name of a lexical whose value to send along. Zero
+     * (or NULL) for each means no such restriction. */
+    MVMuint32 every;
+    MVMuint32 rate;
+    char *lexical;
+
+    /* How often the breakpoint was hit, how often it fired in the current
+     * one second window and when that started, and how many hits it didn't
+     * fire for since it last did because of the rate limit. */
+    MVMuint64 hits;
+    MVMuint32 window_fired;
+    MVMuint64 window_start;
+    MVMuint64 skipped;
 };
 
 struct MVMDebugServerBreakpointFileTable {
@@ -88,3 +103,18 @@ MVM_PUBLIC void MVM_debugserver_notify_unhandled_exception(MVMThreadContext *tc,
 
 MVM_PUBLIC void MVM_debugserver_register_line(MVMThreadContext *tc, char *filename, MVMuint32 filename_len, MVMuint32 line_no,  MVMuint32 *file_idx);
 MVM_PUBLIC void MVM_debugserver_breakpoint_check(MVMThreadContext *tc, MVMuint32 file_idx, MVMuint32 line_no);
+
+/* Breakpoint checks are put at the start of every basic block of a frame
+ * when debugging, so the common case of there being nothing to do at that
+ * location is kept down to a few loads before calling the full check. */
+MVM_STATIC_INLINE void MVM_debugserver_breakpoint_check_fast(MVMThreadContext *tc, MVMuint32 file_idx, MVMuint32 line_no) {
+    MVMDebugServerData *debugserver = tc->instance->debugserver;
+    if (tc->step_mode || (debugserver->any_breakpoints_at_all
+            && debugserver->breakpoints->files[file_idx].lines_active[line_no])) {
+        MVM_debugserver_breakpoint_check(tc, file_idx, line_no);
+    }
+    else {
+        tc->cur_line_no = line_no;
+        tc->cur_file_idx = file_idx;
+    }
+}
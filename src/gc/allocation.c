@@ -32,7 +32,7 @@ void * MVM_gc_allocate_nursery(MVMThreadContext *tc, size_t size) {
 #if MVM_GC_DEBUG < 3
         while (MVM_UNLIKELY((char *)tc->nursery_alloc + size >= (char *)tc->nursery_alloc_limit)) {
 #endif
-            if (size > MVM_NURSERY_SIZE)
+            if (size > tc->instance->nursery_size_max)
                 MVM_panic(MVM_exitcode_gcalloc, "Attempt to allocate more than the maximum nursery size");
             MVM_gc_enter_from_allocator(tc);
 #if MVM_GC_DEBUG < 3
@@ -61,14 +61,24 @@ void * MVM_gc_allocate_zeroed(MVMThreadContext *tc, size_t size) {
 MVMSTable * MVM_gc_allocate_stable(MVMThreadContext *tc, const MVMREPROps *repr, MVMObject *how) {
     MVMSTable *st;
     MVMROOT(tc, how, {
+#ifdef MVM_COMPACT_HEADERS
+        /* STables go straight to gen2, so the index table can hold them
+         * without being updated as they move. */
+        st                = MVM_gc_gen2_allocate_zeroed(tc->gen2, sizeof(MVMSTable));
+        MVM_6model_stable_index_add(tc, st);
+#else
         st                = MVM_gc_allocate_zeroed(tc, sizeof(MVMSTable));
-        st->header.flags1 = MVM_CF_STABLE;
         st->header.size   = sizeof(MVMSTable);
+#endif
+        st->header.flags1 = MVM_CF_STABLE;
         st->header.owner  = tc->thread_id;
         st->REPR          = repr;
         st->invoke        = MVM_6model_invoke_default;
         st->type_cache_id = MVM_6model_next_type_cache_id(tc);
         st->debug_name    = NULL;
+        st->pretenure_state = tc->instance->gc_pretenure
+            ? MVM_PRETENURE_SAMPLING
+            : MVM_PRETENURE_NO;
         MVM_ASSIGN_REF(tc, &(st->header), st->HOW, how);
     });
     return st;
@@ -80,23 +90,39 @@ MVMObject * MVM_gc_allocate_type_object(MVMThreadContext *tc, MVMSTable *st) {
     MVMROOT(tc, st, {
         obj                = MVM_gc_allocate_zeroed(tc, sizeof(MVMObject));
         obj->header.flags1 = MVM_CF_TYPE_OBJECT;
+#ifndef MVM_COMPACT_HEADERS
         obj->header.size   = sizeof(MVMObject);
+#endif
         obj->header.owner  = tc->thread_id;
-        MVM_ASSIGN_REF(tc, &(obj->header), obj->st, st);
+        MVM_SET_STABLE(tc, obj, st);
     });
     return obj;
 }
 
-/* Allocates a new object, and points it at the specified STable. */
+/* Allocates a new object, and points it at the specified STable. If objects
+ * of the type have been found to (almost) always end up in gen2, then it is
+ * allocated there right away. */
 MVMObject * MVM_gc_allocate_object(MVMThreadContext *tc, MVMSTable *st) {
     MVMObject *obj;
     MVMROOT(tc, st, {
-        obj               = MVM_gc_allocate_zeroed(tc, st->size);
+        if (MVM_UNLIKELY(st->pretenure_state == MVM_PRETENURE_YES) && !tc->allocate_in_gen2) {
+            obj = MVM_gc_gen2_allocate_zeroed(tc->gen2, st->size);
+            MVM_add(&tc->instance->gc_promoted_bytes_since_last_full, st->size);
+        }
+        else {
+            obj = MVM_gc_allocate_zeroed(tc, st->size);
+            if (MVM_UNLIKELY(st->pretenure_state == MVM_PRETENURE_SAMPLING) && !tc->allocate_in_gen2)
+                MVM_gc_pretenure_sample(tc, obj);
+        }
+#ifndef MVM_COMPACT_HEADERS
         obj->header.size  = (MVMuint16)st->size;
+#endif
         obj->header.owner = tc->thread_id;
-        MVM_ASSIGN_REF(tc, &(obj->header), obj->st, st);
+        MVM_SET_STABLE(tc, obj, st);
         if (st->mode_flags & MVM_FINALIZE_TYPE)
             MVM_gc_finalize_add_to_queue(tc, obj);
+        if (MVM_UNLIKELY(tc->alloc_sample_countdown) && --tc->alloc_sample_countdown == 0)
+            MVM_gc_alloc_sample(tc, obj);
     });
     return obj;
 }
@@ -105,7 +131,9 @@ MVMObject * MVM_gc_allocate_object(MVMThreadContext *tc, MVMSTable *st) {
 MVMFrame * MVM_gc_allocate_frame(MVMThreadContext *tc) {
     MVMFrame *f = MVM_gc_allocate_zeroed(tc, sizeof(MVMFrame));
     f->header.flags1 = MVM_CF_FRAME;
+#ifndef MVM_COMPACT_HEADERS
     f->header.size   = sizeof(MVMFrame);
+#endif
     f->header.owner  = tc->thread_id;
     return f;
 }
@@ -122,3 +150,188 @@ void MVM_gc_allocate_gen2_default_clear(MVMThreadContext *tc) {
         MVM_oops(tc, "Cannot leave gen2 allocation without entering it");
     tc->allocate_in_gen2--;
 }
+
+/* Marks a newly allocated nursery object as a sample for deciding whether
+ * to pretenure objects of its type. Once we've sampled enough, we stop and
+ * wait for the samples to be promoted (or not). */
+void MVM_gc_pretenure_sample(MVMThreadContext *tc, MVMObject *obj) {
+    MVMSTable *st = STABLE(obj);
+    obj->header.flags1 |= MVM_CF_PRETENURE_SAMPLE;
+    if (++st->pretenure_sampled >= MVM_PRETENURE_SAMPLES) {
+        st->pretenure_sample_end = (MVMuint32)MVM_load(&tc->instance->gc_seq_number);
+        st->pretenure_state = MVM_PRETENURE_WAITING;
+    }
+}
+
+/* Called by the GC when an object that was sampled, or whose type is waiting
+ * on a pretenuring decision, is promoted to gen2. Counts promoted samples,
+ * and once the samples have had time to be promoted, makes the decision. */
+void MVM_gc_pretenure_promoted(MVMThreadContext *tc, MVMObject *obj) {
+    MVMSTable *st = STABLE(obj);
+    if (obj->header.flags1 & MVM_CF_PRETENURE_SAMPLE) {
+        obj->header.flags1 &= ~MVM_CF_PRETENURE_SAMPLE;
+        st->pretenure_promoted++;
+    }
+    if (st->pretenure_state == MVM_PRETENURE_WAITING
+            && (MVMuint32)MVM_load(&tc->instance->gc_seq_number)
+                >= st->pretenure_sample_end + MVM_PRETENURE_WAIT_RUNS) {
+        MVMuint8 pretenure = (MVMuint64)st->pretenure_promoted * 100
+            >= (MVMuint64)st->pretenure_sampled * MVM_PRETENURE_PERCENT;
+        st->pretenure_state = pretenure ? MVM_PRETENURE_YES : MVM_PRETENURE_NO;
+        if (pretenure) {
+            unsigned int interval_id = MVM_telemetry_interval_start(tc, "pretenuring type");
+            MVM_telemetry_interval_annotate_dynamic((uintptr_t)st, interval_id,
+                st->debug_name ? st->debug_name : (char *)"<anon>");
+            MVM_telemetry_interval_stop(tc, interval_id, "pretenuring type");
+        }
+    }
+}
+
+/* Finds the slot in an allocation sample table for a type and frame; this is
+ * either the one holding them or the empty one where they should go. */
+static MVMuint32 alloc_sample_slot(MVMAllocSample *table, MVMuint32 size,
+        MVMSTable *st, MVMStaticFrame *sf) {
+    MVMuint32 i = (MVMuint32)((((uintptr_t)st >> 4) ^ ((uintptr_t)sf >> 4)) * 2654435769u)
+        & (size - 1);
+    while (table[i].st && (table[i].st != st || table[i].sf != sf))
+        i = (i + 1) & (size - 1);
+    return i;
+}
+static void alloc_samples_rehash(MVMThreadContext *tc, MVMuint32 new_size) {
+    MVMAllocSample *old_table = tc->alloc_samples;
+    MVMuint32       old_size  = tc->alloc_samples_size;
+    MVMuint32       i;
+    tc->alloc_samples      = MVM_calloc(new_size, sizeof(MVMAllocSample));
+    tc->alloc_samples_size = new_size;
+    for (i = 0; i < old_size; i++)
+        if (old_table[i].st)
+            tc->alloc_samples[alloc_sample_slot(tc->alloc_samples, new_size,
+                old_table[i].st, old_table[i].sf)] = old_table[i];
+    MVM_free(old_table);
+}
+
+/* Records a sampled allocation against its type and the frame doing it. */
+void MVM_gc_alloc_sample(MVMThreadContext *tc, MVMObject *obj) {
+    MVMStaticFrame *sf = tc->cur_frame ? tc->cur_frame->static_info : NULL;
+    MVMAllocSample *sample;
+    tc->alloc_sample_countdown = tc->instance->alloc_sample_interval;
+    uv_mutex_lock(&tc->instance->mutex_alloc_samples);
+    if (!tc->alloc_samples)
+        alloc_samples_rehash(tc, 64);
+    else if (tc->alloc_samples_used * 2 >= tc->alloc_samples_size)
+        alloc_samples_rehash(tc, tc->alloc_samples_size * 2);
+    else if (tc->alloc_samples_collections != tc->nursery_collections)
+        alloc_samples_rehash(tc, tc->alloc_samples_size);
+    tc->alloc_samples_collections = tc->nursery_collections;
+    sample = &tc->alloc_samples[alloc_sample_slot(tc->alloc_samples,
+        tc->alloc_samples_size, STABLE(obj), sf)];
+    if (!sample->st) {
+        sample->st = STABLE(obj);
+        sample->sf = sf;
+        tc->alloc_samples_used++;
+    }
+    sample->samples++;
+    sample->bytes += STABLE(obj)->size;
+    uv_mutex_unlock(&tc->instance->mutex_alloc_samples);
+}
+
+/* Orderings of allocation samples, for merging those of the threads and for
+ * sorting the report. */
+static int cmp_sample_site(const void *a, const void *b) {
+    const MVMAllocSample *x = a, *y = b;
+    if (x->st != y->st)
+        return (uintptr_t)x->st < (uintptr_t)y->st ? -1 : 1;
+    if (x->sf != y->sf)
+        return (uintptr_t)x->sf < (uintptr_t)y->sf ? -1 : 1;
+    return 0;
+}
+static int cmp_sample_count(const void *a, const void *b) {
+    const MVMAllocSample *x = a, *y = b;
+    return x->samples == y->samples ? 0 : x->samples > y->samples ? -1 : 1;
+}
+
+/* Merges adjacent samples that have the same type and, unless by_type is set,
+ * the same frame. Returns the new number of samples. */
+static MVMuint32 merge_samples(MVMAllocSample *samples, MVMuint32 num, MVMuint8 by_type) {
+    MVMuint32 i, out = 0;
+    for (i = 0; i < num; i++) {
+        if (out > 0 && samples[out - 1].st == samples[i].st
+                && (by_type || samples[out - 1].sf == samples[i].sf)) {
+            samples[out - 1].samples += samples[i].samples;
+            samples[out - 1].bytes   += samples[i].bytes;
+        }
+        else {
+            samples[out] = samples[i];
+            if (by_type)
+                samples[out].sf = NULL;
+            out++;
+        }
+    }
+    return out;
+}
+
+static void dump_samples(MVMThreadContext *tc, const char *title, MVMAllocSample *samples,
+        MVMuint32 num, MVMuint64 total) {
+    MVMuint32 i;
+    qsort(samples, num, sizeof(MVMAllocSample), cmp_sample_count);
+    fprintf(stderr, "%s:\n", title);
+    for (i = 0; i < num && i < MVM_ALLOC_SAMPLE_REPORT_TOP; i++) {
+        MVMAllocSample *s    = &samples[i];
+        const char     *type = s->st->debug_name ? s->st->debug_name : "<anon>";
+        fprintf(stderr, "  %10"PRIu64" %5.1f%% %12"PRIu64"  %s",
+            s->samples, 100.0 * s->samples / total, s->bytes, type);
+        if (s->sf) {
+            char *name = MVM_string_utf8_encode_C_string(tc, s->sf->body.name);
+            char *file = MVM_string_utf8_encode_C_string(tc, s->sf->body.cu->body.filename);
+            fprintf(stderr, " in %s (%s)", name[0] ? name : "<anon>", file);
+            MVM_free(name);
+            MVM_free(file);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+/* Writes the types and allocation sites with the most samples, summed over
+ * all threads that are still around, to stderr. The sample tables can't be
+ * collected from under us, since we don't reach a GC safepoint here and
+ * sampling turns off thread-local collection. */
+void MVM_gc_alloc_samples_dump(MVMThreadContext *tc) {
+    MVMInstance *i = tc->instance;
+    MVMThread   *thread;
+    MVMuint64    total = 0;
+    MVMuint32    num, j;
+    MVM_VECTOR_DECL(MVMAllocSample, samples);
+
+    if (!i->alloc_sample_interval)
+        MVM_exception_throw_adhoc(tc, "Allocation sampling is not enabled (set MVM_ALLOC_SAMPLE)");
+
+    MVM_VECTOR_INIT(samples, 256);
+    uv_mutex_lock(&i->mutex_threads);
+    uv_mutex_lock(&i->mutex_alloc_samples);
+    for (thread = i->threads; thread; thread = thread->body.next) {
+        MVMThreadContext *thread_tc = thread->body.tc;
+        if (!thread_tc)
+            continue;
+        for (j = 0; j < thread_tc->alloc_samples_size; j++) {
+            if (thread_tc->alloc_samples[j].st) {
+                MVM_VECTOR_PUSH(samples, thread_tc->alloc_samples[j]);
+                total += thread_tc->alloc_samples[j].samples;
+            }
+        }
+    }
+    uv_mutex_unlock(&i->mutex_alloc_samples);
+
+    fprintf(stderr, "Allocation samples (1 in %u object allocations, %"PRIu64" samples):\n",
+        i->alloc_sample_interval, total);
+    if (total) {
+        num = MVM_VECTOR_ELEMS(samples);
+        qsort(samples, num, sizeof(MVMAllocSample), cmp_sample_site);
+        num = merge_samples(samples, num, 0);
+        dump_samples(tc, "Top allocation sites", samples, num, total);
+        qsort(samples, num, sizeof(MVMAllocSample), cmp_sample_site);
+        num = merge_samples(samples, num, 1);
+        dump_samples(tc, "Top allocated types", samples, num, total);
+    }
+    uv_mutex_unlock(&i->mutex_threads);
+    MVM_VECTOR_DESTROY(samples);
+}
@@ -3,6 +3,31 @@
 #else
 #define MVM_ALIGN_SIZE(size) (size)
 #endif
+/* Pretenuring states of an STable. Unless pretenuring is turned on, types
+ * start out as not being pretenured. Otherwise, this many objects from the
+ * nursery are sampled; after waiting this many GC runs for the samples to
+ * be promoted or die, objects of the type are allocated in gen2 from then
+ * on if at least this percentage of the samples got promoted. */
+#define MVM_PRETENURE_NO            0
+#define MVM_PRETENURE_SAMPLING      1
+#define MVM_PRETENURE_WAITING       2
+#define MVM_PRETENURE_YES           3
+#define MVM_PRETENURE_SAMPLES       1024
+#define MVM_PRETENURE_WAIT_RUNS     3
+#define MVM_PRETENURE_PERCENT       90
+
+/* A count of the sampled allocations of a type by a static frame (which is
+ * NULL for allocations made outside of any frame). */
+struct MVMAllocSample {
+    MVMSTable      *st;
+    MVMStaticFrame *sf;
+    MVMuint64       samples;
+    MVMuint64       bytes;
+};
+
+/* How many of the top types and allocation sites are dumped. */
+#define MVM_ALLOC_SAMPLE_REPORT_TOP 25
+
 void * MVM_gc_allocate_nursery(MVMThreadContext *tc, size_t size);
 void * MVM_gc_allocate_zeroed(MVMThreadContext *tc, size_t size);
 MVMSTable * MVM_gc_allocate_stable(MVMThreadContext *tc, const MVMREPROps *repr, MVMObject *how);
@@ -11,6 +36,26 @@ MVMObject * MVM_gc_allocate_object(MVMThreadContext *tc, MVMSTable *st);
 MVMFrame * MVM_gc_allocate_frame(MVMThreadContext *tc);
 void MVM_gc_allocate_gen2_default_set(MVMThreadContext *tc);
 void MVM_gc_allocate_gen2_default_clear(MVMThreadContext *tc);
+void MVM_gc_pretenure_sample(MVMThreadContext *tc, MVMObject *obj);
+void MVM_gc_pretenure_promoted(MVMThreadContext *tc, MVMObject *obj);
+void MVM_gc_alloc_sample(MVMThreadContext *tc, MVMObject *obj);
+void MVM_gc_alloc_samples_dump(MVMThreadContext *tc);
+
+/* Gets the size of a collectable. With compact headers, it isn't stored, but
+ * comes from its kind or, for objects, their STable. */
+MVM_STATIC_INLINE MVMuint32 MVM_gc_collectable_size(MVMCollectable *c) {
+#ifdef MVM_COMPACT_HEADERS
+    if (c->flags1 & MVM_CF_STABLE)
+        return sizeof(MVMSTable);
+    if (c->flags1 & MVM_CF_FRAME)
+        return sizeof(MVMFrame);
+    if (c->flags1 & MVM_CF_TYPE_OBJECT)
+        return sizeof(MVMObject);
+    return STABLE(c)->size;
+#else
+    return c->size;
+#endif
+}
 
 MVM_STATIC_INLINE void * MVM_gc_allocate(MVMThreadContext *tc, size_t size) {
     return tc->allocate_in_gen2
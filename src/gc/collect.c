@@ -1,4 +1,5 @@
 #include "moar.h"
+#include "platform/mmap.h"
 
 /* Combines a piece of work that will be passed to another thread with the
  * ID of the target thread to pass it to. */
@@ -18,15 +19,112 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
 static void pass_work_item(MVMThreadContext *tc, WorkToPass *wtp, MVMCollectable **item_ptr);
 static void pass_leftover_work(MVMThreadContext *tc, WorkToPass *wtp);
 static void add_in_tray_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist);
+static void add_shared_work_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist);
+
+/* Sets up the bounds that nursery sizes are kept within, from the values of
+ * the environment variables or from the defaults where they are 0. */
+void MVM_gc_configure_nursery_sizes(MVMInstance *i, MVMuint32 min, MVMuint32 max) {
+    i->nursery_size_max = max;
+    if (i->nursery_size_max == 0)
+        i->nursery_size_max = MVM_NURSERY_SIZE;
+    i->nursery_size_min = min;
+    if (i->nursery_size_min == 0)
+        i->nursery_size_min = MVM_NURSERY_THREAD_START;
+    if (i->nursery_size_min > i->nursery_size_max)
+        i->nursery_size_min = i->nursery_size_max;
+}
 
 /* The size of the nursery that a new thread should get. The main thread will
  * get a full-size one right away. */
 MVMuint32 MVM_gc_new_thread_nursery_size(MVMInstance *i) {
-    return i->main_thread != NULL
-        ? (MVM_NURSERY_SIZE < MVM_NURSERY_THREAD_START
-            ? MVM_NURSERY_SIZE
-            : MVM_NURSERY_THREAD_START)
-        : MVM_NURSERY_SIZE;
+    return i->main_thread != NULL ? i->nursery_size_min : i->nursery_size_max;
+}
+
+/* Rounds a size up to a multiple of a power of two. */
+static size_t round_up(size_t size, size_t to) {
+    return (size + to - 1) & ~(to - 1);
+}
+
+/* When huge pages are wanted and a nursery semispace is big enough for it to
+ * be worth it, the space is mapped, rounded up to whole huge pages. It is
+ * also mapped when it is to be bound to a NUMA node. Returns the size of the
+ * mapping, or 0 if the space should just be malloc'd. */
+static size_t nursery_mapping_size(MVMInstance *i, MVMuint32 size) {
+    if (i->gc_huge_pages && size >= MVM_PLATFORM_HUGE_PAGE_SIZE)
+        return round_up(size, MVM_PLATFORM_HUGE_PAGE_SIZE);
+    if (i->gc_numa_local)
+        return round_up(size, MVM_PLATFORM_MIN_PAGE_SIZE);
+    return 0;
+}
+
+/* Allocates zeroed memory for a nursery semispace of the given size, which
+ * prefers the NUMA node given (if it's not -1 and that's turned on). */
+void * MVM_gc_nursery_alloc_space(MVMInstance *i, MVMuint32 size, MVMint32 numa_node) {
+    size_t mapping_size = nursery_mapping_size(i, size);
+    void *space;
+    if (!mapping_size)
+        return MVM_calloc(1, size);
+    space = MVM_platform_alloc_pages(mapping_size, MVM_PAGE_READ | MVM_PAGE_WRITE
+        | (i->gc_huge_pages && size >= MVM_PLATFORM_HUGE_PAGE_SIZE ? MVM_PAGE_HUGE : 0));
+    if (i->gc_numa_local)
+        MVM_platform_bind_pages_to_node(space, mapping_size, numa_node);
+    return space;
+}
+
+/* Makes a thread's nursery prefer the NUMA node it's now marked as being
+ * on. This is for the space allocated before the thread started running. */
+void MVM_gc_nursery_bind_numa_node(MVMThreadContext *tc) {
+    size_t mapping_size = nursery_mapping_size(tc->instance, tc->nursery_tospace_size);
+    if (mapping_size)
+        MVM_platform_bind_pages_to_node(tc->nursery_tospace, mapping_size, tc->numa_node);
+    mapping_size = nursery_mapping_size(tc->instance, tc->nursery_fromspace_size);
+    if (mapping_size && tc->nursery_fromspace)
+        MVM_platform_bind_pages_to_node(tc->nursery_fromspace, mapping_size, tc->numa_node);
+}
+
+/* Frees a nursery semispace allocated with MVM_gc_nursery_alloc_space. */
+void MVM_gc_nursery_free_space(MVMInstance *i, void *space, MVMuint32 size) {
+    size_t mapping_size = nursery_mapping_size(i, size);
+    if (!space)
+        return;
+    if (mapping_size)
+        MVM_platform_free_pages(space, mapping_size);
+    else
+        MVM_free(space);
+}
+
+/* Whether a thread's nursery pages should be handed back to the OS after a
+ * collection, because MVM_GC_RELEASE_IDLE_NURSERY is set and the thread was
+ * blocked, so its work was stolen. Huge pages would only get split up. */
+MVMint32 MVM_gc_nursery_is_idle(MVMThreadContext *tc) {
+    return tc->instance->gc_release_idle_nursery && !tc->instance->gc_huge_pages
+        && (MVM_load(&tc->gc_status) & MVMGCSTATUS_MASK) == MVMGCStatus_STOLEN;
+}
+
+/* Decides on the size of a thread's next tospace. If this thread caused the
+ * current GC run, then it is allocating quickly enough that it's worth
+ * granting it a bigger tospace, to cut down on how often it has to collect.
+ * If it was pulled into the run having used little of its nursery, and this
+ * keeps on happening, then it's allocating slowly and we give some memory
+ * back. */
+static MVMuint32 next_nursery_size(MVMThreadContext *tc, MVMuint32 used) {
+    MVMInstance *i    = tc->instance;
+    MVMuint32    size = tc->nursery_tospace_size;
+    if (i->thread_to_blame_for_gc == tc || tc->gc_local) {
+        tc->nursery_underused_runs = 0;
+        if (size < i->nursery_size_max)
+            size = size > i->nursery_size_max / 2 ? i->nursery_size_max : size * 2;
+    }
+    else if (used < size / 4 && size > i->nursery_size_min) {
+        if (++tc->nursery_underused_runs >= MVM_NURSERY_SHRINK_RUNS) {
+            tc->nursery_underused_runs = 0;
+            size = size / 2 < i->nursery_size_min ? i->nursery_size_min : size / 2;
+        }
+    }
+    else {
+        tc->nursery_underused_runs = 0;
+    }
+    return size;
 }
 
 /* Does a garbage collection run. Exactly what it does is configured by the
@@ -65,6 +163,12 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : processing %d items from in tray \n", worklist->items);
         process_worklist(tc, worklist, &wtp, gen);
     }
+    else if (what_to_do == MVMGCWhatToDo_SharedWork) {
+        /* We're helping out with marking; take a chunk of shared work. */
+        add_shared_work_to_worklist(tc, worklist);
+        GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : processing %d items from shared mark work\n", worklist->items);
+        process_worklist(tc, worklist, &wtp, gen);
+    }
     else if (what_to_do == MVMGCWhatToDo_Finalizing) {
         /* Need to process the finalizing queue. */
         MVMuint32 i;
@@ -73,23 +177,57 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : processing %d items from finalizing \n", worklist->items);
         process_worklist(tc, worklist, &wtp, gen);
     }
+    else if (what_to_do == MVMGCWhatToDo_WeakLookups) {
+        /* Mark the lookups that have been pruned. Parametric types reached
+         * while doing so go on a fresh list, for the next round. */
+        MVMSTable **lookups     = tc->weak_lookups;
+        MVMuint32   num_lookups = tc->num_weak_lookups;
+        MVMuint32   i;
+        tc->weak_lookups        = NULL;
+        tc->num_weak_lookups    = 0;
+        tc->alloc_weak_lookups  = 0;
+        for (i = 0; i < num_lookups; i++)
+            MVM_gc_worklist_add(tc, worklist, &(lookups[i]->paramet.ric.lookup));
+        GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : processing %d items from weak lookups \n", worklist->items);
+        process_worklist(tc, worklist, &wtp, gen);
+        MVM_free(lookups);
+    }
     else {
         /* Main collection run. The current tospace becomes fromspace, with
          * the size of the current tospace becoming stashed as the size of
          * that fromspace. */
         void *old_fromspace = tc->nursery_fromspace;
         MVMuint32 old_fromspace_size = tc->nursery_fromspace_size;
+        MVMuint32 used = (char *)tc->nursery_alloc - (char *)tc->nursery_tospace;
+
+        /* Whatever time isn't spent tracing is spent finding roots. */
+        MVMuint8  trace_phase = gen == MVMGCGenerations_Nursery
+            ? MVM_GC_PHASE_NURSERY_COPY
+            : MVM_GC_PHASE_GEN2_MARK;
+        MVMuint64 start_time  = uv_hrtime();
+        MVMuint64 start_trace = tc->gc_phase_time[trace_phase];
+
+        /* If the thread may collect alone, then in a stop-the-world run we
+         * promote everything in a nursery that became reachable by other
+         * threads; after that nobody else can be referencing it. */
+        if (tc->instance->gc_thread_local && !tc->gc_local) {
+            tc->gc_promote_nursery = tc->gc_nursery_escaped;
+            tc->gc_nursery_escaped = 0;
+        }
+
         tc->nursery_fromspace = tc->nursery_tospace;
         tc->nursery_fromspace_size = tc->nursery_tospace_size;
 
-        /* Decide on this threads's tospace size. If fromspace was already at
-         * the maximum nursery size, then that is the new tospace size. If
-         * not, then see if this thread caused the current GC run, and grant
-         * it a bigger tospace. Otherwise, new tospace size is left as the
-         * last tospace size. */
-        if (tc->nursery_tospace_size < MVM_NURSERY_SIZE) {
-            if (tc->instance->thread_to_blame_for_gc == tc)
-                tc->nursery_tospace_size *= 2;
+        /* Decide on this threads's tospace size. Anything that survives in
+         * the nursery fits in what was used, so even a shrunk tospace has
+         * room for it. */
+        tc->nursery_tospace_size = next_nursery_size(tc, used);
+        tc->nursery_collections++;
+        if (tc->nursery_tospace_size != tc->nursery_fromspace_size) {
+            unsigned int interval_id = MVM_telemetry_interval_start(tc, "nursery resize");
+            MVM_telemetry_interval_annotate(tc->nursery_collections, interval_id, "nursery collections");
+            MVM_telemetry_interval_annotate(tc->nursery_tospace_size, interval_id, "new nursery size");
+            MVM_telemetry_interval_stop(tc, interval_id, "nursery resized");
         }
 
         /* If the old fromspace matches the target size, just re-use it. If
@@ -98,8 +236,9 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
             tc->nursery_tospace = old_fromspace;
         }
         else {
-            MVM_free(old_fromspace);
-            tc->nursery_tospace = MVM_calloc(1, tc->nursery_tospace_size);
+            MVM_gc_nursery_free_space(tc->instance, old_fromspace, old_fromspace_size);
+            tc->nursery_tospace = MVM_gc_nursery_alloc_space(tc->instance,
+                tc->nursery_tospace_size, tc->numa_node);
         }
 
         /* Reset nursery allocation pointers to the new tospace. */
@@ -162,10 +301,19 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : processing %d items from in tray \n", worklist->items);
         process_worklist(tc, worklist, &wtp, gen);
 
+        tc->gc_phase_time[MVM_GC_PHASE_ROOTS] += (uv_hrtime() - start_time)
+            - (tc->gc_phase_time[trace_phase] - start_trace);
+
         /* At this point, we have probably done most of the work we will
          * need to (only get more if another thread passes us more); zero
-         * out the remaining tospace. */
-        memset(tc->nursery_alloc, 0, (char *)tc->nursery_alloc_limit - (char *)tc->nursery_alloc);
+         * out the remaining tospace. If the thread is blocked, it may be a
+         * while before it allocates again, so the pages go back to the OS
+         * rather than being written to. */
+        if (MVM_gc_nursery_is_idle(tc))
+            MVM_platform_zero_pages(tc->nursery_alloc,
+                (char *)tc->nursery_alloc_limit - (char *)tc->nursery_alloc);
+        else
+            memset(tc->nursery_alloc, 0, (char *)tc->nursery_alloc_limit - (char *)tc->nursery_alloc);
     }
 
     /* Destroy the worklist. */
@@ -179,12 +327,35 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
     }
 }
 
+/* Donates a chunk from the top of the worklist to the instance-wide shared
+ * mark work pool, so that an idle GC thread can pick it up. */
+static void share_work(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMInstance     *i    = tc->instance;
+    MVMGCPassedWork *work = MVM_malloc(sizeof(MVMGCPassedWork));
+    worklist->items -= MVM_GC_PASS_WORK_SIZE;
+    memcpy(work->items, worklist->list + worklist->items,
+        MVM_GC_PASS_WORK_SIZE * sizeof(MVMCollectable **));
+    work->num_items = MVM_GC_PASS_WORK_SIZE;
+    uv_mutex_lock(&i->mutex_gc_mark_pool);
+    work->next = i->gc_mark_pool;
+    i->gc_mark_pool = work;
+    MVM_incr(&i->gc_mark_pool_size);
+    uv_mutex_unlock(&i->mutex_gc_mark_pool);
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : shared %d items of mark work\n", MVM_GC_PASS_WORK_SIZE);
+}
+
 /* Processes the current worklist. */
 static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, WorkToPass *wtp, MVMuint8 gen) {
     MVMGen2Allocator  *gen2;
     MVMCollectable   **item_ptr;
     MVMCollectable    *new_addr;
     MVMuint32          gen2count;
+    MVMuint64          start_time = uv_hrtime();
+
+    /* In a parallel full collection, second generation objects never move,
+     * so any thread may mark them; they are not passed to their owner. We
+     * may also share our work with idle GC threads. */
+    MVMuint8 parallel_mark = gen == MVMGCGenerations_Both && tc->instance->gc_parallel_mark;
 
     /* Grab the second generation allocator; we may move items into the
      * old generation. */
@@ -234,8 +405,20 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
         }
 
         /* If it's owned by a different thread, we need to pass it over to
-         * the owning thread. */
-        if (item->owner != tc->thread_id) {
+         * the owning thread, unless it's a gen2 object that we can mark
+         * ourselves. Marking is idempotent, so should another thread race
+         * with us to mark the same object, we just both scan it. */
+        if (item->owner != tc->thread_id && !(parallel_mark && item_gen2)) {
+            /* Frames on the call stack are the only things with no owner;
+             * local closures and the frames invoking them point to them as
+             * their outer. The stack keeps them alive, and they never move. */
+            if (!item->owner)
+                continue;
+
+            /* When collecting on our own, the other threads are still
+             * running; their objects are none of our business. */
+            if (tc->gc_local)
+                continue;
             GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : sending a handle %p to object %p to thread %d\n", item_ptr, item, item->owner);
             pass_work_item(tc, wtp, item_ptr);
             continue;
@@ -258,6 +441,8 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
             item->flags2 |= MVM_CF_GEN2_LIVE;
             assert(*item_ptr == new_addr);
         } else {
+            MVMuint32 item_size = MVM_gc_collectable_size(item);
+
             /* Catch NULL stable (always sign of trouble) in debug mode. */
             if (MVM_GC_DEBUG_ENABLED(MVM_GC_DEBUG_COLLECT) && !STABLE(item)) {
                 GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : found a zeroed handle %p to object %p\n", item_ptr, item);
@@ -266,27 +451,30 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
             /* Did we see it in the nursery before, or should we move it to
              * gen2 anyway since either:
              *   * A persistent ID was requested?
+             *   * It is pinned?
              *   * It is referenced by a gen2 aggregate
+             *   * The nursery escaped to another thread (thread-local mode)
              */
-            if (item->flags1 & MVM_CF_HAS_OBJECT_ID
-                || item->flags2 & (MVM_CF_NURSERY_SEEN | MVM_CF_REF_FROM_GEN2)) {
+            if (item->flags1 & (MVM_CF_HAS_OBJECT_ID | MVM_CF_PINNED)
+                || item->flags2 & (MVM_CF_NURSERY_SEEN | MVM_CF_REF_FROM_GEN2)
+                || tc->gc_promote_nursery) {
                 /* Yes; we should move it to the second generation. Allocate
                  * space in the second generation. */
                 to_gen2 = 1;
                 new_addr = item->flags1 & MVM_CF_HAS_OBJECT_ID
                     ? MVM_gc_object_id_use_allocation(tc, item)
-                    : MVM_gc_gen2_allocate(gen2, item->size);
+                    : MVM_gc_gen2_allocate(gen2, item_size);
 
                 /* Add on to the promoted amount (used both to decide when to do
                  * the next full collection, as well as for profiling). Note we
                  * add unmanaged size on for objects below. */
-                tc->gc_promoted_bytes += item->size;
+                tc->gc_promoted_bytes += item_size;
 
                 /* Copy the object to the second generation and mark it as
                  * living there. */
                 GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : copying an object %p of size %d to gen2 %p\n",
-                    item, item->size, new_addr);
-                memcpy(new_addr, item, item->size);
+                    item, item_size, new_addr);
+                memcpy(new_addr, item, item_size);
                 if (new_addr->flags2 & MVM_CF_NURSERY_SEEN)
                     new_addr->flags2 ^= MVM_CF_NURSERY_SEEN;
                 new_addr->flags2 |= MVM_CF_SECOND_GEN;
@@ -299,6 +487,9 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
                 }
                 else if (!(new_addr->flags1 & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE))) {
                     MVMObject *new_obj_addr = (MVMObject *)new_addr;
+                    if (new_addr->flags1 & MVM_CF_PRETENURE_SAMPLE
+                            || STABLE(new_obj_addr)->pretenure_state == MVM_PRETENURE_WAITING)
+                        MVM_gc_pretenure_promoted(tc, new_obj_addr);
                     if (REPR(new_obj_addr)->unmanaged_size) {
                         MVMuint64 unmanaged_size =  REPR(new_obj_addr)->unmanaged_size(tc,
                             STABLE(new_obj_addr), OBJECT_BODY(new_obj_addr));
@@ -317,14 +508,14 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
                 /* No, so it will live in the nursery for another GC
                  * iteration. Allocate space in the nursery. */
                 new_addr = (MVMCollectable *)tc->nursery_alloc;
-                tc->nursery_alloc = (char *)tc->nursery_alloc + MVM_ALIGN_SIZE(item->size);
+                tc->nursery_alloc = (char *)tc->nursery_alloc + MVM_ALIGN_SIZE(item_size);
                 GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : copying an object %p (reprid %d) of size %d to tospace %p\n",
-                    item, (item->flags1 & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE | MVM_CF_FRAME)) ? -1 : (int)REPR(item)->ID, item->size, new_addr);
+                    item, (item->flags1 & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE | MVM_CF_FRAME)) ? -1 : (int)REPR(item)->ID, item_size, new_addr);
 
                 /* Copy the object to tospace and mark it as seen in the
                  * nursery (so the next time around it will move to the
                  * older generation, if it survives). */
-                memcpy(new_addr, item, item->size);
+                memcpy(new_addr, item, item_size);
                 new_addr->flags2 |= MVM_CF_NURSERY_SEEN;
             }
 
@@ -359,7 +550,28 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
                     MVM_gc_write_barrier_no_update_referenced(tc, new_addr, *j);
             }
         }
+
+        /* If we've built up a lot of work and other GC threads are sat idle,
+         * give them some of it. */
+        if (parallel_mark && worklist->items >= MVM_GC_SHARE_WORK_THRESHOLD
+                && MVM_load(&tc->instance->gc_mark_pool_size) < MVM_load(&tc->instance->gc_mark_idle))
+            share_work(tc, worklist);
+    }
+
+    tc->gc_phase_time[gen == MVMGCGenerations_Nursery
+        ? MVM_GC_PHASE_NURSERY_COPY
+        : MVM_GC_PHASE_GEN2_MARK] += uv_hrtime() - start_time;
+}
+
+/* Notes a parametric type whose lookup is to be marked once the rest of a
+ * full collection's marking is done. */
+static void add_weak_lookup(MVMThreadContext *tc, MVMSTable *st) {
+    if (tc->num_weak_lookups == tc->alloc_weak_lookups) {
+        tc->alloc_weak_lookups = tc->alloc_weak_lookups ? tc->alloc_weak_lookups * 2 : 16;
+        tc->weak_lookups = MVM_realloc(tc->weak_lookups,
+            sizeof(MVMSTable *) * tc->alloc_weak_lookups);
     }
+    tc->weak_lookups[tc->num_weak_lookups++] = st;
 }
 
 /* Marks a collectable item (object, type object, STable). */
@@ -380,7 +592,7 @@ void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMC
 
     if (new_addr->flags1 & MVM_CF_TYPE_OBJECT) {
         /* Add the STable to the worklist. */
-        MVM_gc_worklist_add(tc, worklist, &((MVMObject *)new_addr)->st);
+        MVM_gc_worklist_add(tc, worklist, MVM_STABLE_REF(new_addr));
     }
     else if (new_addr->flags1 & MVM_CF_STABLE) {
         /* Add all references in the STable to the work list. */
@@ -408,7 +620,12 @@ void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMC
         MVM_gc_worklist_add(tc, worklist, &new_addr_st->method_cache_sc);
         if (new_addr_st->mode_flags & MVM_PARAMETRIC_TYPE) {
             MVM_gc_worklist_add(tc, worklist, &new_addr_st->paramet.ric.parameterizer);
-            MVM_gc_worklist_add(tc, worklist, &new_addr_st->paramet.ric.lookup);
+            if (worklist->include_gen2 && tc->instance->gc_weak_parameterizations)
+                /* Leave the lookup until everything else is marked, so the
+                 * parameterizations nothing else uses can be dropped. */
+                add_weak_lookup(tc, new_addr_st);
+            else
+                MVM_gc_worklist_add(tc, worklist, &new_addr_st->paramet.ric.lookup);
         }
         else if (new_addr_st->mode_flags & MVM_PARAMETERIZED_TYPE) {
             MVM_gc_worklist_add(tc, worklist, &new_addr_st->paramet.erized.parametric_type);
@@ -427,7 +644,7 @@ void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMC
         MVMObject *new_addr_obj = (MVMObject *)new_addr;
 
         /* Add the STable to the worklist. */
-        MVM_gc_worklist_add(tc, worklist, &new_addr_obj->st);
+        MVM_gc_worklist_add(tc, worklist, MVM_STABLE_REF(new_addr_obj));
 
         /* If needed, mark it. This will add addresses to the worklist
          * that will need updating. Note that we are passing the address
@@ -553,6 +770,28 @@ static void add_in_tray_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklis
     }
 }
 
+/* Takes a chunk of work from the shared mark work pool, if any, and adds it
+ * to the worklist. */
+static void add_shared_work_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMInstance     *i = tc->instance;
+    MVMGCPassedWork *work;
+    MVMuint32        j;
+
+    uv_mutex_lock(&i->mutex_gc_mark_pool);
+    work = i->gc_mark_pool;
+    if (work) {
+        i->gc_mark_pool = work->next;
+        MVM_decr(&i->gc_mark_pool_size);
+    }
+    uv_mutex_unlock(&i->mutex_gc_mark_pool);
+
+    if (work) {
+        for (j = 0; j < work->num_items; j++)
+            MVM_gc_worklist_add(tc, worklist, work->items[j]);
+        MVM_free(work);
+    }
+}
+
 /* Save dead STable pointers to delete later.. */
 static void MVM_gc_collect_enqueue_stable_for_deletion(MVMThreadContext *tc, MVMSTable *st) {
     MVMSTable *old_head;
@@ -636,37 +875,147 @@ void MVM_gc_collect_free_nursery_uncopied(MVMThreadContext *executing_thread, MV
         }
 
         /* Go to the next item. */
-        scan = (char *)scan + MVM_ALIGN_SIZE(item->size);
+        scan = (char *)scan + MVM_ALIGN_SIZE(MVM_gc_collectable_size(item));
     }
 }
 
 /* Free STables (in any thread/generation!) queued to be freed. */
 void MVM_gc_collect_free_stables(MVMThreadContext *tc) {
-    MVMSTable *st = tc->instance->stables_to_free;
 #if MVM_GC_DEBUG < 3
-    while (st) {
-        MVMSTable *st_to_free = st;
-        st = st_to_free->header.sc_forward_u.st;
-        st_to_free->header.sc_forward_u.st = NULL;
-        MVM_6model_stable_gc_free(tc, st_to_free);
-    }
+    MVM_6model_stable_gc_free_list(tc, tc->instance->stables_to_free);
 #endif
     tc->instance->stables_to_free = NULL;
 }
 
+/* Does any cleanup needed for a dead object in the second generation. Returns
+ * non-zero if its slot may go on the free list, or zero if it must be left
+ * alone (which is the case for STables that are only marked as dead now, to
+ * be freed on the next sweep). */
+static MVMuint32 free_gen2_dead(MVMThreadContext *executing_thread, MVMThreadContext *tc,
+        MVMCollectable *col, MVMint32 global_destruction, MVMuint8 do_prof_log) {
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : collecting an object %p in the gen2\n", col);
+#if MVM_GC_DEBUG
+    col->flags2 |= MVM_CF_DEBUG_IN_GEN2_FREE_LIST;
+#endif
+    if (col->flags1 & MVM_CF_TYPE_OBJECT) {
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+        if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
+            MVM_free(col->sc_forward_u.sci);
+#endif
+    }
+    else if (col->flags1 & MVM_CF_STABLE) {
+        if (
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+            !(col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED) &&
+#endif
+            col->sc_forward_u.sc.sc_idx == 0
+            && col->sc_forward_u.sc.idx == (unsigned)MVM_DIRECT_SC_IDX_SENTINEL) {
+            /* We marked it dead last time, kill it. */
+            MVM_6model_stable_gc_free(tc, (MVMSTable *)col);
+        }
+        else {
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+            if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED) {
+                /* Whatever happens next, we can free this
+                   memory immediately, because no-one will be
+                   serializing a dead STable. */
+                assert(!(col->sc_forward_u.sci->sc_idx == 0
+                         && col->sc_forward_u.sci->idx
+                         == MVM_DIRECT_SC_IDX_SENTINEL));
+                MVM_free(col->sc_forward_u.sci);
+                col->flags1 &= ~MVM_CF_SERIALZATION_INDEX_ALLOCATED;
+            }
+#endif
+            if (global_destruction) {
+                /* We're in global destruction, so enqueue to the end
+                 * like we do in the nursery */
+                MVM_gc_collect_enqueue_stable_for_deletion(tc, (MVMSTable *)col);
+            } else {
+                /* There will definitely be another gc run, so mark it as "died last time". */
+                col->sc_forward_u.sc.sc_idx = 0;
+                col->sc_forward_u.sc.idx = MVM_DIRECT_SC_IDX_SENTINEL;
+            }
+            /* Skip the freelist updating. */
+            return 0;
+        }
+    }
+    else if (col->flags1 & MVM_CF_FRAME) {
+        MVM_frame_destroy(tc, (MVMFrame *)col);
+    }
+    else {
+        /* Object instance; call gc_free if needed. */
+        MVMObject *obj = (MVMObject *)col;
+        if (do_prof_log) {
+            MVM_profiler_log_gc_deallocate(executing_thread, obj);
+        }
+        if (STABLE(obj) && REPR(obj)->gc_free)
+            REPR(obj)->gc_free(tc, obj);
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+        if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
+            MVM_free(col->sc_forward_u.sci);
+#endif
+    }
+    return 1;
+}
+
+/* Goes through the over-sized objects of the second generation, freeing the
+ * unmarked ones and clearing the mark on the others. */
+static void free_gen2_overflows_unmarked(MVMThreadContext *tc) {
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 i;
+    for (i = 0; i < gen2->num_overflows; i++) {
+        if (gen2->overflows[i]) {
+            MVMCollectable *col = gen2->overflows[i];
+            if (col->flags2 & MVM_CF_GEN2_LIVE) {
+                /* A living over-sized object; just clear the mark. */
+                col->flags2 &= ~MVM_CF_GEN2_LIVE;
+            }
+            else {
+                /* Dead over-sized object. We know if it's this big it cannot
+                 * be a type object or STable, so only need handle the simple
+                 * object case. */
+                if (!(col->flags1 & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE | MVM_CF_FRAME))) {
+                    MVMObject *obj = (MVMObject *)col;
+                    if (REPR(obj)->gc_free)
+                        REPR(obj)->gc_free(tc, obj);
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+                    if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
+                        MVM_free(col->sc_forward_u.sci);
+#endif
+                }
+                else {
+                    MVM_panic(MVM_exitcode_gcnursery, "Internal error: gen2 overflow contains non-object");
+                }
+                MVM_free(col);
+                gen2->overflows[i] = NULL;
+            }
+        }
+    }
+    /* And finally compact the overflow list */
+    MVM_gc_gen2_compact_overflows(gen2);
+}
+
 /* Goes through the unmarked objects in the second generation heap and builds
  * free lists out of them. Also does any required finalization. */
 void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMThreadContext *tc, MVMint32 global_destruction) {
     /* Visit each of the size class bins. */
     MVMGen2Allocator *gen2 = tc->gen2;
-    MVMuint32 bin, obj_size, page, i;
+    MVMuint32 bin, obj_size, page, released;
     MVMuint8 do_prof_log = 0;
+    MVMuint8 release_pages = tc->instance->gc_gen2_release_pages
+        && !tc->instance->gc_huge_pages && !tc->instance->gc_numa_local
+        && !global_destruction;
 
     char ***freelist_insert_pos;
 
     if (executing_thread->prof_data)
         do_prof_log = 1;
 
+    /* If sweeping after the previous full collection was deferred and never
+     * got finished, do that first; the walk below relies on the free list
+     * being in page order. */
+    MVM_gc_collect_finish_gen2_sweep(tc);
+
     for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
         /* If we've nothing allocated in this size class, skip it. */
         if (gen2->size_classes[bin].pages == NULL)
@@ -681,6 +1030,7 @@ void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMTh
         freelist_insert_pos = &gen2->size_classes[bin].free_list;
 
         /* Visit each page. */
+        released = 0;
         for (page = 0; page < gen2->size_classes[bin].num_pages; page++) {
             /* Visit all the objects, looking for dead ones and reset the
              * mark for each of them. */
@@ -688,6 +1038,8 @@ void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMTh
             char *end_ptr = page + 1 == gen2->size_classes[bin].num_pages
                 ? gen2->size_classes[bin].alloc_pos
                 : cur_ptr + obj_size * MVM_GEN2_PAGE_ITEMS;
+            char ***page_start_pos = freelist_insert_pos;
+            MVMuint32 free_slots = 0;
             while (cur_ptr < end_ptr) {
                 MVMCollectable *col = (MVMCollectable *)cur_ptr;
 
@@ -695,6 +1047,7 @@ void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMTh
                  * new free list insert position. */
                 if (*freelist_insert_pos == (char **)cur_ptr) {
                     freelist_insert_pos = (char ***)cur_ptr;
+                    free_slots++;
                 }
 
                 /* Otherwise, it must be a collectable of some kind. Is it
@@ -703,115 +1056,141 @@ void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMTh
                     /* Yes; clear the mark. */
                     col->flags2 &= ~MVM_CF_GEN2_LIVE;
                 }
-                else {
-                    GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : collecting an object %p in the gen2\n", col);
-                    /* No, it's dead. Do any cleanup. */
-#if MVM_GC_DEBUG
-                    col->flags2 |= MVM_CF_DEBUG_IN_GEN2_FREE_LIST;
-#endif
-                    if (col->flags1 & MVM_CF_TYPE_OBJECT) {
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                        if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
-                            MVM_free(col->sc_forward_u.sci);
-#endif
-                    }
-                    else if (col->flags1 & MVM_CF_STABLE) {
-                        if (
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                            !(col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED) &&
-#endif
-                            col->sc_forward_u.sc.sc_idx == 0
-                            && col->sc_forward_u.sc.idx == (unsigned)MVM_DIRECT_SC_IDX_SENTINEL) {
-                            /* We marked it dead last time, kill it. */
-                            MVM_6model_stable_gc_free(tc, (MVMSTable *)col);
-                        }
-                        else {
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                            if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED) {
-                                /* Whatever happens next, we can free this
-                                   memory immediately, because no-one will be
-                                   serializing a dead STable. */
-                                assert(!(col->sc_forward_u.sci->sc_idx == 0
-                                         && col->sc_forward_u.sci->idx
-                                         == MVM_DIRECT_SC_IDX_SENTINEL));
-                                MVM_free(col->sc_forward_u.sci);
-                                col->flags1 &= ~MVM_CF_SERIALZATION_INDEX_ALLOCATED;
-                            }
-#endif
-                            if (global_destruction) {
-                                /* We're in global destruction, so enqueue to the end
-                                 * like we do in the nursery */
-                                MVM_gc_collect_enqueue_stable_for_deletion(tc, (MVMSTable *)col);
-                            } else {
-                                /* There will definitely be another gc run, so mark it as "died last time". */
-                                col->sc_forward_u.sc.sc_idx = 0;
-                                col->sc_forward_u.sc.idx = MVM_DIRECT_SC_IDX_SENTINEL;
-                            }
-                            /* Skip the freelist updating. */
-                            cur_ptr += obj_size;
-                            continue;
-                        }
-                    }
-                    else if (col->flags1 & MVM_CF_FRAME) {
-                        MVM_frame_destroy(tc, (MVMFrame *)col);
-                    }
-                    else {
-                        /* Object instance; call gc_free if needed. */
-                        MVMObject *obj = (MVMObject *)col;
-                        if (do_prof_log) {
-                            MVM_profiler_log_gc_deallocate(executing_thread, obj);
-                        }
-                        if (STABLE(obj) && REPR(obj)->gc_free)
-                            REPR(obj)->gc_free(tc, obj);
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                        if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
-                            MVM_free(col->sc_forward_u.sci);
-#endif
-                    }
 
-                    /* Chain in to the free list. */
+                /* No, it's dead. Do any cleanup, and then chain it in to the
+                 * free list. */
+                else if (free_gen2_dead(executing_thread, tc, col, global_destruction, do_prof_log)) {
                     *((char **)cur_ptr) = (char *)*freelist_insert_pos;
                     *freelist_insert_pos = (char **)cur_ptr;
 
                     /* Update the pointer to the insert position to point to us */
                     freelist_insert_pos = (char ***)cur_ptr;
+                    free_slots++;
                 }
 
                 /* Move to the next object. */
                 cur_ptr += obj_size;
             }
+
+            /* If we're releasing memory and the whole page is free, then
+             * unchain its slots (which are all together at the end of the
+             * free list so far) and free it. The last page is the one we
+             * bump-allocate in, so is always kept. */
+            if (release_pages && free_slots == MVM_GEN2_PAGE_ITEMS
+                    && page + 1 < gen2->size_classes[bin].num_pages) {
+                *page_start_pos = *freelist_insert_pos;
+                freelist_insert_pos = page_start_pos;
+                MVM_free(gen2->size_classes[bin].pages[page]);
+                gen2->size_classes[bin].pages[page] = NULL;
+                released++;
+            }
+        }
+
+        /* Close up the gaps left by any pages we released. */
+        if (released) {
+            MVMGen2SizeClass *szc = &(gen2->size_classes[bin]);
+            MVMuint32 kept = 0;
+            for (page = 0; page < szc->num_pages; page++)
+                if (szc->pages[page])
+                    szc->pages[kept++] = szc->pages[page];
+            szc->num_pages = kept;
+            szc->cur_page  = kept - 1;
         }
     }
-    
+
     /* Also need to consider overflows. */
-    for (i = 0; i < gen2->num_overflows; i++) {
-        if (gen2->overflows[i]) {
-            MVMCollectable *col = gen2->overflows[i];
-            if (col->flags2 & MVM_CF_GEN2_LIVE) {
-                /* A living over-sized object; just clear the mark. */
-                col->flags2 &= ~MVM_CF_GEN2_LIVE;
-            }
-            else {
-                /* Dead over-sized object. We know if it's this big it cannot
-                 * be a type object or STable, so only need handle the simple
-                 * object case. */
-                if (!(col->flags1 & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE | MVM_CF_FRAME))) {
-                    MVMObject *obj = (MVMObject *)col;
-                    if (REPR(obj)->gc_free)
-                        REPR(obj)->gc_free(tc, obj);
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                    if (col->flags1 & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
-                        MVM_free(col->sc_forward_u.sci);
-#endif
-                }
-                else {
-                    MVM_panic(MVM_exitcode_gcnursery, "Internal error: gen2 overflow contains non-object");
-                }
-                MVM_free(col);
-                gen2->overflows[i] = NULL;
-            }
+    free_gen2_overflows_unmarked(tc);
+}
+
+/* Instead of sweeping the second generation of a thread right away after a
+ * full collection, records how far each size class bin had got at the time
+ * of the collection. The pages are then swept one at a time as the thread
+ * allocates into the bin (see MVM_gc_gen2_allocate), or all at once when
+ * something needs the sweep to be finished. Over-sized objects are few and
+ * are still swept right away. */
+void MVM_gc_collect_defer_gen2_sweep(MVMThreadContext *tc) {
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 bin;
+
+    /* We may only have one sweep in flight at a time. */
+    MVM_gc_collect_finish_gen2_sweep(tc);
+
+    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
+        MVMGen2SizeClass *szc = &(gen2->size_classes[bin]);
+        if (szc->pages == NULL)
+            continue;
+
+        /* Take the current free list away; the slots on it are found and
+         * chained back in as their pages are swept. */
+        szc->sweep_page      = 0;
+        szc->sweep_num_pages = szc->num_pages;
+        szc->sweep_alloc_pos = szc->alloc_pos;
+        szc->sweep_free_list = szc->free_list;
+        szc->free_list       = NULL;
+        szc->free_list_tail  = &(szc->free_list);
+    }
+
+    free_gen2_overflows_unmarked(tc);
+}
+
+/* Sweeps the next unswept page of a size class bin, after the sweep of it was
+ * deferred. Anything allocated since the full collection is beyond the
+ * recorded bounds or in an already swept slot, so is never looked at. Freed
+ * slots are chained on to the end of the free list, which keeps it in page
+ * order once all the pages have been swept. This runs on the allocation path,
+ * outside of a GC run, so the gc_free of any dead object is called with the
+ * other threads still running. */
+void MVM_gc_collect_sweep_gen2_page(MVMThreadContext *tc, MVMuint32 bin) {
+    MVMGen2SizeClass *szc = &(tc->gen2->size_classes[bin]);
+    MVMuint32 obj_size = (bin + 1) << MVM_GEN2_BIN_BITS;
+    MVMuint32 page = szc->sweep_page++;
+    MVMuint8 do_prof_log = tc->prof_data ? 1 : 0;
+    char ***tail = szc->free_list ? szc->free_list_tail : &(szc->free_list);
+    char *cur_ptr = szc->pages[page];
+    char *end_ptr = page + 1 == szc->sweep_num_pages
+        ? szc->sweep_alloc_pos
+        : cur_ptr + obj_size * MVM_GEN2_PAGE_ITEMS;
+    while (cur_ptr < end_ptr) {
+        MVMCollectable *col = (MVMCollectable *)cur_ptr;
+
+        /* Was this slot free at the time of the collection? If so move on in
+         * the old free list, and then chain it in to the new one. */
+        if ((char *)szc->sweep_free_list == cur_ptr) {
+            szc->sweep_free_list = (char **)*(szc->sweep_free_list);
+        }
+
+        /* A live object; clear the mark and leave it alone. */
+        else if (col->flags2 & MVM_CF_GEN2_LIVE) {
+            col->flags2 &= ~MVM_CF_GEN2_LIVE;
+            cur_ptr += obj_size;
+            continue;
         }
+
+        /* A dead one; clean it up, unless it can't be freed yet. */
+        else if (!free_gen2_dead(tc, tc, col, 0, do_prof_log)) {
+            cur_ptr += obj_size;
+            continue;
+        }
+
+        *tail = (char **)cur_ptr;
+        tail = (char ***)cur_ptr;
+        cur_ptr += obj_size;
+    }
+    *tail = NULL;
+    szc->free_list_tail = tail;
+}
+
+/* Sweeps any pages of a thread's second generation that are still waiting to
+ * be swept after a full collection. This must happen before the marking of
+ * another full collection starts, and before the pages are handed over to
+ * another thread. */
+void MVM_gc_collect_finish_gen2_sweep(MVMThreadContext *tc) {
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 bin;
+    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
+        MVMGen2SizeClass *szc = &(gen2->size_classes[bin]);
+        while (szc->sweep_page < szc->sweep_num_pages)
+            MVM_gc_collect_sweep_gen2_page(tc, bin);
+        szc->sweep_free_list = NULL;
     }
-    /* And finally compact the overflow list */
-    MVM_gc_gen2_compact_overflows(gen2);
 }
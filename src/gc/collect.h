@@ -9,12 +9,69 @@
  * often done for GC stress testing) then this value will be ignored. */
 #define MVM_NURSERY_THREAD_START 131072
 
+/* The above are the defaults for the largest and smallest nursery sizes;
+ * they can be overridden with MVM_GC_NURSERY_MAX and MVM_GC_NURSERY_MIN.
+ * Between those bounds, a thread's nursery grows when the thread fills it
+ * and so triggers a GC run, and shrinks again if it was less than a
+ * quarter used for this many GC runs in a row. */
+#define MVM_NURSERY_SHRINK_RUNS 4
+
 /* How many bytes should have been promoted into gen2 before we decide to
  * do a full GC run? This defaults to a percentage of the resident set, with
  * a minimum to avoid small processes doing a load of gen2 collections. */
 #define MVM_GC_GEN2_THRESHOLD_PERCENT   20
 #define MVM_GC_GEN2_THRESHOLD_MINIMUM   (20 * 1024 * 1024)
 
+/* The least time, in milliseconds, between asking malloc to hand the free
+ * memory at the top of its heaps back to the OS after full collections. May
+ * be overridden by MVM_GC_TRIM_INTERVAL. */
+#define MVM_GC_TRIM_INTERVAL    1000
+
+/* Both of the above may be overridden by MVM_GC_GEN2_THRESHOLD_PERCENT and
+ * MVM_GC_GEN2_THRESHOLD_MINIMUM. If MVM_GC_TARGET_TIME_PERCENT is set, then
+ * the percentage is instead adapted after each full collection, so as to aim
+ * at that percentage of wall-clock time being spent in full collections. It
+ * is kept within these bounds. */
+#define MVM_GC_ADAPTIVE_THRESHOLD_MIN   5
+#define MVM_GC_ADAPTIVE_THRESHOLD_MAX   400
+
+/* Phases of a GC run that each thread keeps count of the time it spends in.
+ * Tracing is counted as nursery copying in nursery collections and as gen2
+ * marking in full ones. */
+#define MVM_GC_PHASE_ROOTS          0
+#define MVM_GC_PHASE_NURSERY_COPY   1
+#define MVM_GC_PHASE_GEN2_MARK      2
+#define MVM_GC_PHASE_GEN2_SWEEP     3
+#define MVM_GC_PHASE_FINALIZE       4
+#define MVM_GC_PHASES               5
+
+/* The always-on GC statistics, as handed out by the gcstats op; times are
+ * in nanoseconds. The phase times are summed over all the threads taking
+ * part. Bucket 0 of the pause histogram counts pauses of under 2us, and
+ * bucket n those of 2^n to 2^(n+1) microseconds, with the last one taking
+ * all longer pauses. Time to safepoint is from the co-ordinator signalling the
+ * other threads until they have all joined the run. Collections a thread did
+ * on its own (MVM_GC_THREAD_LOCAL) are counted and timed separately, and not
+ * included in the rest. Last come the number of times malloc was trimmed,
+ * the total bytes it took off the resident set, and the resident set size
+ * before and after the latest trim. */
+#define MVM_GC_STATS_RUNS           0
+#define MVM_GC_STATS_FULL_RUNS      1
+#define MVM_GC_STATS_PAUSE_TOTAL    2
+#define MVM_GC_STATS_PAUSE_MAX      3
+#define MVM_GC_STATS_PHASE_TIMES    4
+#define MVM_GC_STATS_HISTOGRAM      (MVM_GC_STATS_PHASE_TIMES + MVM_GC_PHASES)
+#define MVM_GC_PAUSE_BUCKETS        24
+#define MVM_GC_STATS_TTSP_TOTAL     (MVM_GC_STATS_HISTOGRAM + MVM_GC_PAUSE_BUCKETS)
+#define MVM_GC_STATS_TTSP_MAX       (MVM_GC_STATS_TTSP_TOTAL + 1)
+#define MVM_GC_STATS_LOCAL_RUNS     (MVM_GC_STATS_TTSP_MAX + 1)
+#define MVM_GC_STATS_LOCAL_TOTAL    (MVM_GC_STATS_LOCAL_RUNS + 1)
+#define MVM_GC_STATS_TRIMS          (MVM_GC_STATS_LOCAL_TOTAL + 1)
+#define MVM_GC_STATS_TRIM_RELEASED  (MVM_GC_STATS_TRIMS + 1)
+#define MVM_GC_STATS_TRIM_RSS_BEFORE (MVM_GC_STATS_TRIM_RELEASED + 1)
+#define MVM_GC_STATS_TRIM_RSS_AFTER (MVM_GC_STATS_TRIM_RSS_BEFORE + 1)
+#define MVM_GC_STATS_FIELDS         (MVM_GC_STATS_TRIM_RSS_AFTER + 1)
+
 /* What things should be processed in this GC run? */
 typedef enum {
     /* Everything, including the instance-wide roots. If we have many
@@ -28,7 +85,15 @@ typedef enum {
     MVMGCWhatToDo_InTray = 2,
 
     /* Only process the finalizing list. */
-    MVMGCWhatToDo_Finalizing = 4
+    MVMGCWhatToDo_Finalizing = 4,
+
+    /* Only process a chunk taken from the instance-wide shared mark work
+     * pool (used by parallel marking in full collections). */
+    MVMGCWhatToDo_SharedWork = 8,
+
+    /* Only mark the parameterization lookups of parametric types that were
+     * left unmarked, as weak parameterizations are enabled. */
+    MVMGCWhatToDo_WeakLookups = 16
 } MVMGCWhatToDo;
 
 /* What generation(s) to collect? */
@@ -44,6 +109,11 @@ typedef enum {
  * off to the next thread. (Power of 2, minus 2, is a decent choice.) */
 #define MVM_GC_PASS_WORK_SIZE   62
 
+/* When parallel marking is enabled, a thread doing a full collection whose
+ * worklist has grown beyond this many items will donate chunks of it to the
+ * shared mark work pool, provided there are idle GC threads to take them. */
+#define MVM_GC_SHARE_WORK_THRESHOLD (4 * MVM_GC_PASS_WORK_SIZE)
+
 /* Represents a piece of work (some addresses to visit) that have been passed
  * from one thread doing GC to another thread doing GC. */
 struct MVMGCPassedWork {
@@ -54,8 +124,16 @@ struct MVMGCPassedWork {
 
 /* Functions. */
 MVMuint32 MVM_gc_new_thread_nursery_size(MVMInstance *i);
+void * MVM_gc_nursery_alloc_space(MVMInstance *i, MVMuint32 size, MVMint32 numa_node);
+void MVM_gc_nursery_bind_numa_node(MVMThreadContext *tc);
+void MVM_gc_nursery_free_space(MVMInstance *i, void *space, MVMuint32 size);
+MVMint32 MVM_gc_nursery_is_idle(MVMThreadContext *tc);
+void MVM_gc_configure_nursery_sizes(MVMInstance *i, MVMuint32 min, MVMuint32 max);
 void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen);
 void MVM_gc_collect_free_nursery_uncopied(MVMThreadContext *executing_thread, MVMThreadContext *tc, void *limit);
 void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *executing_thread, MVMThreadContext *tc, MVMint32 global_destruction);
+void MVM_gc_collect_defer_gen2_sweep(MVMThreadContext *tc);
+void MVM_gc_collect_sweep_gen2_page(MVMThreadContext *tc, MVMuint32 bin);
+void MVM_gc_collect_finish_gen2_sweep(MVMThreadContext *tc);
 void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMCollectable *item);
 void MVM_gc_collect_free_stables(MVMThreadContext *tc);
@@ -106,11 +106,169 @@ void MVM_finalize_walk_queues(MVMThreadContext *tc, MVMuint8 gen) {
     while (cur_thread) {
         if (cur_thread->body.tc) {
             walk_thread_finalize_queue(cur_thread->body.tc, gen);
-            if (cur_thread->body.tc->num_finalizing > 0) {
+            if (cur_thread->body.tc->num_finalizing > 0)
                 MVM_gc_collect(cur_thread->body.tc, MVMGCWhatToDo_Finalizing, gen);
-                setup_finalize_handler_call(cur_thread->body.tc);
-            }
         }
         cur_thread = cur_thread->body.next;
     }
 }
+
+/* The same for a thread that collected its nursery on its own. The objects
+ * to finalize stay on the thread, since handing them to finalizer threads
+ * would need the world stopping. */
+void MVM_finalize_walk_local_queue(MVMThreadContext *tc) {
+    walk_thread_finalize_queue(tc, MVMGCGenerations_Nursery);
+    if (tc->num_finalizing > 0) {
+        MVM_gc_collect(tc, MVMGCWhatToDo_Finalizing, MVMGCGenerations_Nursery);
+        setup_finalize_handler_call(tc);
+    }
+}
+
+/* Finds the HLL whose finalize handler should be run for objects found on a
+ * thread, going by the innermost frame that has one. */
+static MVMHLLConfig * finalize_hll(MVMThreadContext *tc) {
+    MVMFrame *f = tc->cur_frame;
+    while (f) {
+        if (f->static_info->body.cu->body.hll_config)
+            return f->static_info->body.cu->body.hll_config;
+        f = f->caller;
+    }
+    return NULL;
+}
+
+/* Moves the objects a thread has waiting to be finalized over to the queue
+ * the finalizer threads take work from. Returns zero if we couldn't work out
+ * which HLL the objects belong to, in which case they're left alone. */
+static MVMuint32 queue_for_finalizer_threads(MVMThreadContext *tc, MVMThreadContext *owner) {
+    MVMInstance  *i   = tc->instance;
+    MVMHLLConfig *hll = finalize_hll(owner);
+    if (!hll)
+        return 0;
+    owner->gc_nursery_escaped = 1;
+    uv_mutex_lock(&i->mutex_finalize_pending);
+    while (owner->num_finalizing > 0) {
+        MVMFinalizeItem item;
+        item.obj = owner->finalizing[--owner->num_finalizing];
+        item.hll = hll;
+        MVM_VECTOR_PUSH(i->finalize_pending, item);
+    }
+    uv_cond_broadcast(&i->cond_finalize_pending);
+    uv_mutex_unlock(&i->mutex_finalize_pending);
+    return 1;
+}
+
+/* Arranges for the finalize handler to be run on the objects that the walk
+ * of the finalize queues found to be dead. These are either handed to the
+ * finalizer threads, if there are any, or run on the thread that allocated
+ * them the next time it returns to a frame. Must be called after the walk
+ * and once in-trays are cleared, so that the objects are at their final
+ * addresses. Assumes the world is stopped. */
+void MVM_finalize_hand_out(MVMThreadContext *tc) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+    while (cur_thread) {
+        MVMThreadContext *thread_tc = cur_thread->body.tc;
+        if (thread_tc && thread_tc->num_finalizing > 0) {
+            if (!tc->instance->num_finalizer_threads
+                    || !queue_for_finalizer_threads(tc, thread_tc))
+                setup_finalize_handler_call(thread_tc);
+        }
+        cur_thread = cur_thread->body.next;
+    }
+}
+
+/* A finalizer thread takes batches of objects queued for finalization,
+ * all belonging to the same HLL, and runs the finalize handler on them in
+ * an interpreter of its own. */
+typedef struct {
+    MVMObject   *handler;
+    MVMRegister  args[1];
+} FinalizerBatch;
+static void finalizer_batch_invoke(MVMThreadContext *tc, void *data) {
+    FinalizerBatch *fb      = (FinalizerBatch *)data;
+    MVMObject      *handler = MVM_frame_find_invokee(tc, fb->handler, NULL);
+    STABLE(handler)->invoke(tc, handler,
+        MVM_callsite_get_common(tc, MVM_CALLSITE_ID_INV_ARG), fb->args);
+    tc->thread_entry_frame = tc->cur_frame;
+}
+static void finalizer_worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    MVMInstance *i = tc->instance;
+
+#if MVM_HAS_PTHREAD_SETNAME_NP
+    pthread_setname_np(pthread_self(), "finalizer");
+#endif
+
+    while (1) {
+        MVMHLLConfig *hll   = NULL;
+        MVMObject    *drain = MVM_repr_alloc_init(tc, i->boot_types.BOOTArray);
+        MVMuint32     stop  = 0;
+        MVMROOT(tc, drain, {
+            while (!hll && !stop) {
+                /* Sleep as a blocked thread until there's work, or we're
+                 * told to stop. */
+                MVM_gc_mark_thread_blocked(tc);
+                uv_mutex_lock(&i->mutex_finalize_pending);
+                while (MVM_VECTOR_ELEMS(i->finalize_pending) == 0 && !i->finalizer_pool->stop)
+                    uv_cond_wait(&i->cond_finalize_pending, &i->mutex_finalize_pending);
+                stop = i->finalizer_pool->stop;
+                uv_mutex_unlock(&i->mutex_finalize_pending);
+                MVM_gc_mark_thread_unblocked(tc);
+                if (stop)
+                    break;
+
+                /* Now we're unblocked the GC can't move the objects under
+                 * us, so take a batch, if another thread didn't beat us to
+                 * it. Nothing in here can trigger a GC run, which matters
+                 * since the GC takes the mutex to queue objects. */
+                uv_mutex_lock(&i->mutex_finalize_pending);
+                if (MVM_VECTOR_ELEMS(i->finalize_pending) > 0) {
+                    hll = MVM_VECTOR_TOP(i->finalize_pending)[-1].hll;
+                    while (MVM_VECTOR_ELEMS(i->finalize_pending) > 0
+                            && MVM_VECTOR_TOP(i->finalize_pending)[-1].hll == hll
+                            && MVM_repr_elems(tc, drain) < MVM_FINALIZE_BATCH_SIZE)
+                        MVM_repr_push_o(tc, drain,
+                            MVM_VECTOR_POP(i->finalize_pending).obj);
+                }
+                uv_mutex_unlock(&i->mutex_finalize_pending);
+            }
+
+            /* Run the handler, if the HLL has one, leaving the interpreter
+             * state we were started with as it was. */
+            if (hll && hll->finalize_handler) {
+                MVMuint8        **backup_cur_op         = tc->interp_cur_op;
+                MVMuint8        **backup_bytecode_start = tc->interp_bytecode_start;
+                MVMRegister     **backup_reg_base       = tc->interp_reg_base;
+                MVMCompUnit     **backup_cu             = tc->interp_cu;
+                FinalizerBatch    fb;
+                fb.handler    = hll->finalize_handler;
+                fb.args[0].o  = drain;
+                MVM_interp_run(tc, finalizer_batch_invoke, &fb, NULL);
+                tc->interp_cur_op         = backup_cur_op;
+                tc->interp_bytecode_start = backup_bytecode_start;
+                tc->interp_reg_base       = backup_reg_base;
+                tc->interp_cu             = backup_cu;
+                tc->cur_frame             = NULL;
+                tc->thread_entry_frame    = NULL;
+            }
+        });
+        if (stop)
+            break;
+    }
+}
+
+/* Starts the finalizer threads, if any were asked for. Anything left in the
+ * queue when they were last stopped is picked up again. */
+void MVM_finalize_start_threads(MVMThreadContext *tc) {
+    MVMInstance *i = tc->instance;
+    if (!i->num_finalizer_threads)
+        return;
+    if (!i->finalizer_pool)
+        i->finalizer_pool = MVM_worker_pool_create(i->num_finalizer_threads,
+            &i->mutex_finalize_pending, &i->cond_finalize_pending, finalizer_worker);
+    MVM_worker_pool_start(tc, i->finalizer_pool);
+}
+
+/* Stops and joins the finalizer threads, if they are running. */
+void MVM_finalize_stop_threads(MVMThreadContext *tc) {
+    if (tc->instance->finalizer_pool)
+        MVM_worker_pool_stop(tc, tc->instance->finalizer_pool);
+}
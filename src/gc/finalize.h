@@ -1,3 +1,17 @@
+/* An object that is waiting for a finalizer thread, together with the HLL
+ * whose finalize handler should be run on it. */
+struct MVMFinalizeItem {
+    MVMObject    *obj;
+    MVMHLLConfig *hll;
+};
+
+/* The most objects a finalizer thread passes to a handler in one go. */
+#define MVM_FINALIZE_BATCH_SIZE 1024
+
 void MVM_gc_finalize_set(MVMThreadContext *tc, MVMObject *type, MVMint64 finalize);
 void MVM_gc_finalize_add_to_queue(MVMThreadContext *tc, MVMObject *obj);
 void MVM_finalize_walk_queues(MVMThreadContext *tc, MVMuint8 gen);
+void MVM_finalize_walk_local_queue(MVMThreadContext *tc);
+void MVM_finalize_hand_out(MVMThreadContext *tc);
+void MVM_finalize_start_threads(MVMThreadContext *tc);
+void MVM_finalize_stop_threads(MVMThreadContext *tc);
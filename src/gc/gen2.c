@@ -1,7 +1,8 @@
 #include "moar.h"
+#include "platform/mmap.h"
 
 /* Creates a new second generation allocator. */
-MVMGen2Allocator * MVM_gc_gen2_create(MVMInstance *i) {
+MVMGen2Allocator * MVM_gc_gen2_create(MVMInstance *i, MVMThreadContext *tc) {
     /* Create allocator data structure. */
     MVMGen2Allocator *al = MVM_malloc(sizeof(MVMGen2Allocator));
 
@@ -13,9 +14,40 @@ MVMGen2Allocator * MVM_gc_gen2_create(MVMInstance *i) {
     al->num_overflows = 0;
     al->overflows = MVM_malloc(al->alloc_overflows * sizeof(MVMCollectable *));
 
+    al->tc = tc;
+
+    al->chunks      = NULL;
+    al->num_chunks  = 0;
+    al->chunk_pos   = NULL;
+    al->chunk_limit = NULL;
+
     return al;
 }
 
+/* Allocates the memory for a page. With huge pages or NUMA-local memory
+ * turned on, this takes it from the current chunk, mapping a new one (which
+ * prefers the thread's NUMA node) if needed. */
+static char * alloc_page(MVMGen2Allocator *al, MVMuint32 page_size) {
+    MVMInstance *i = al->tc->instance;
+    char *page;
+    if (!i->gc_huge_pages && !i->gc_numa_local)
+        return MVM_malloc(page_size);
+    if (al->chunk_pos + page_size > al->chunk_limit) {
+        char *chunk = MVM_platform_alloc_pages(MVM_GEN2_CHUNK_SIZE,
+            MVM_PAGE_READ | MVM_PAGE_WRITE | (i->gc_huge_pages ? MVM_PAGE_HUGE : 0));
+        if (i->gc_numa_local)
+            MVM_platform_bind_pages_to_node(chunk, MVM_GEN2_CHUNK_SIZE, al->tc->numa_node);
+        al->chunks = MVM_realloc(al->chunks,
+            sizeof(char *) * (al->num_chunks + 1));
+        al->chunks[al->num_chunks++] = chunk;
+        al->chunk_pos   = chunk;
+        al->chunk_limit = chunk + MVM_GEN2_CHUNK_SIZE;
+    }
+    page = al->chunk_pos;
+    al->chunk_pos += page_size;
+    return page;
+}
+
 /* Sets up a size class bin in the second generation. */
 static void setup_bin(MVMGen2Allocator *al, MVMuint32 bin) {
     /* Work out page size we want. */
@@ -24,7 +56,7 @@ static void setup_bin(MVMGen2Allocator *al, MVMuint32 bin) {
     /* We'll just allocate a single page to start off with. */
     al->size_classes[bin].num_pages = 1;
     al->size_classes[bin].pages     = MVM_malloc(sizeof(void *) * al->size_classes[bin].num_pages);
-    al->size_classes[bin].pages[0]  = MVM_malloc(page_size);
+    al->size_classes[bin].pages[0]  = alloc_page(al, page_size);
 
     /* Set up allocation position and limit. */
     al->size_classes[bin].alloc_pos = al->size_classes[bin].pages[0];
@@ -44,7 +76,7 @@ static void add_page(MVMGen2Allocator *al, MVMuint32 bin) {
     al->size_classes[bin].num_pages++;
     al->size_classes[bin].pages = MVM_realloc(al->size_classes[bin].pages,
         sizeof(void *) * al->size_classes[bin].num_pages);
-    al->size_classes[bin].pages[cur_page] = MVM_malloc(page_size);
+    al->size_classes[bin].pages[cur_page] = alloc_page(al, page_size);
 
     /* Set up allocation position and limit. */
     al->size_classes[bin].alloc_pos = al->size_classes[bin].pages[cur_page];
@@ -73,6 +105,13 @@ void * MVM_gc_gen2_allocate(MVMGen2Allocator *al, MVMuint32 size) {
         if (al->size_classes[bin].pages == NULL)
             setup_bin(al, bin);
 
+        /* If the free list is empty but sweeping after the last full
+         * collection was deferred, sweep pages until we find some space
+         * or run out of pages to sweep. */
+        while (!al->size_classes[bin].free_list
+                && al->size_classes[bin].sweep_page < al->size_classes[bin].sweep_num_pages)
+            MVM_gc_collect_sweep_gen2_page(al->tc, bin);
+
         /* If there's a free list entry, use that. */
         if (al->size_classes[bin].free_list) {
             result = (void *)al->size_classes[bin].free_list;
@@ -118,12 +157,16 @@ void * MVM_gc_gen2_allocate_zeroed(MVMGen2Allocator *al, MVMuint32 size) {
 void MVM_gc_gen2_destroy(MVMInstance *i, MVMGen2Allocator *al) {
     MVMuint32 j, k;
 
-    /* Remove all pages. */
+    /* Remove all pages, or the chunks they were carved out of. */
     for (j = 0; j < MVM_GEN2_BINS; j++) {
-        for (k = 0; k < al->size_classes[j].num_pages; k++)
-            MVM_free(al->size_classes[j].pages[k]);
+        if (!i->gc_huge_pages && !i->gc_numa_local)
+            for (k = 0; k < al->size_classes[j].num_pages; k++)
+                MVM_free(al->size_classes[j].pages[k]);
         MVM_free(al->size_classes[j].pages);
     }
+    for (j = 0; j < al->num_chunks; j++)
+        MVM_platform_free_pages(al->chunks[j], MVM_GEN2_CHUNK_SIZE);
+    MVM_free(al->chunks);
 
     /* Free any allocated overflows. */
     for (j = 0; j < al->num_overflows; j++)
@@ -144,6 +187,10 @@ void MVM_gc_gen2_transfer(MVMThreadContext *src, MVMThreadContext *dest) {
     MVMuint32 bin, obj_size, page;
     char ***freelist_insert_pos;
 
+    /* Any deferred sweeping must be done before the pages change hands. */
+    MVM_gc_collect_finish_gen2_sweep(src);
+    MVM_gc_collect_finish_gen2_sweep(dest);
+
     for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
         MVMuint32 orig_dest_num_pages = dest_gen2->size_classes[bin].num_pages;
         char *cur_ptr, *end_ptr;
@@ -229,6 +276,18 @@ void MVM_gc_gen2_transfer(MVMThreadContext *src, MVMThreadContext *dest) {
         gen2->size_classes[bin].pages = NULL;
         gen2->size_classes[bin].num_pages = 0;
     }
+    if (gen2->num_chunks) { /* transfer the chunks the pages live in */
+        dest_gen2->chunks = MVM_realloc(dest_gen2->chunks,
+            sizeof(char *) * (dest_gen2->num_chunks + gen2->num_chunks));
+        memcpy(&dest_gen2->chunks[dest_gen2->num_chunks],
+            gen2->chunks, sizeof(char *) * gen2->num_chunks);
+        dest_gen2->num_chunks += gen2->num_chunks;
+        MVM_free(gen2->chunks);
+        gen2->chunks      = NULL;
+        gen2->num_chunks  = 0;
+        gen2->chunk_pos   = NULL;
+        gen2->chunk_limit = NULL;
+    }
     { /* transfer the overflows */
         MVMuint32 i;
         if (gen2->num_overflows + dest_gen2->num_overflows > dest_gen2->alloc_overflows) {
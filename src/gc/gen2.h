@@ -20,6 +20,22 @@ struct MVMGen2SizeClass {
 
     /* The number of pages allocated. */
     MVMuint32 num_pages;
+
+    /* If sweeping after a full collection was deferred, the next page to
+     * sweep, and the number of pages and the allocation position as they
+     * were at the time of the collection. Nothing needs sweeping once
+     * sweep_page reaches sweep_num_pages. */
+    MVMuint32 sweep_page;
+    MVMuint32 sweep_num_pages;
+    char *sweep_alloc_pos;
+
+    /* The free list as it was at the time of the collection, which is
+     * walked in step with the pages being swept. */
+    char **sweep_free_list;
+
+    /* The last node of the free list, which swept slots get chained on to;
+     * only valid while sweeping is deferred and the free list isn't empty. */
+    char ***free_list_tail;
 };
 
 /* An "instance" of the fixed size allocator. */
@@ -39,6 +55,18 @@ struct MVMGen2Allocator {
 
     /* The amount of space allocated in the overflow array. */
     MVMuint32        alloc_overflows;
+
+    /* The thread this allocator belongs to, which deferred sweeping is done
+     * on behalf of. */
+    MVMThreadContext *tc;
+
+    /* When using huge pages or NUMA-local memory, pages are carved out of
+     * mapped chunks, which are only freed along with the allocator. These are
+     * the chunks, and where the next page goes in the latest one. */
+    char      **chunks;
+    MVMuint32   num_chunks;
+    char       *chunk_pos;
+    char       *chunk_limit;
 };
 
 /* The number of bits we discard from the requested size when binning
@@ -58,6 +86,9 @@ struct MVMGen2Allocator {
 /* Number of bins in the FSA. Beyond this, we just degrade to malloc/free. */
 #define MVM_GEN2_BINS       40
 
+/* The size of the chunks that pages are carved out of when not malloc'd. */
+#define MVM_GEN2_CHUNK_SIZE MVM_PLATFORM_HUGE_PAGE_SIZE
+
 /* Default overflow list size. */
 #define MVM_GEN2_OVERFLOWS  32
 
@@ -65,7 +96,7 @@ struct MVMGen2Allocator {
 #define MVM_GEN2_PAGE_ITEMS 256
 
 /* Functions. */
-MVMGen2Allocator * MVM_gc_gen2_create(MVMInstance *i);
+MVMGen2Allocator * MVM_gc_gen2_create(MVMInstance *i, MVMThreadContext *tc);
 void * MVM_gc_gen2_allocate(MVMGen2Allocator *al, MVMuint32 size);
 void * MVM_gc_gen2_allocate_zeroed(MVMGen2Allocator *al, MVMuint32 size);
 void MVM_gc_gen2_destroy(MVMInstance *i, MVMGen2Allocator *allocator);
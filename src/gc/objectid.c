@@ -1,5 +1,13 @@
 #include "moar.h"
 
+/* Picks the object ID hash shard for an object by its address. Nursery
+ * objects are packed closely, so the address is scrambled first to spread
+ * neighbouring objects over the shards. */
+MVM_STATIC_INLINE MVMObjectIdShard * shard_for(MVMThreadContext *tc, void *obj) {
+    MVMuint64 h = ((MVMuint64)(uintptr_t)obj >> 3) * UINT64_C(0x9E3779B97F4A7C15);
+    return &tc->instance->object_id_shards[h >> (64 - MVM_OBJECT_ID_SHARD_BITS)];
+}
+
 /* Gets a stable identifier for an object, which will not change even if the
  * GC moves the object. */
 MVMuint64 MVM_gc_object_id(MVMThreadContext *tc, MVMObject *obj) {
@@ -13,22 +21,23 @@ MVMuint64 MVM_gc_object_id(MVMThreadContext *tc, MVMObject *obj) {
 
     /* Otherwise, see if we already have a persistent object ID. */
     else {
-        uv_mutex_lock(&tc->instance->mutex_object_ids);
+        MVMObjectIdShard *shard = shard_for(tc, obj);
+        MVM_lock_contention_lock(tc, &shard->mutex, "object ID hash");
         if (obj->header.flags1 & MVM_CF_HAS_OBJECT_ID) {
             /* Has one, so just look up by address in the hash ID hash. */
 
-            struct MVMPtrHashEntry *entry = MVM_ptr_hash_fetch(tc, &tc->instance->object_ids, obj);
+            struct MVMPtrHashEntry *entry = MVM_ptr_hash_fetch(tc, &shard->object_ids, obj);
             assert(entry);
             id = entry->value;
         }
         else {
             /* Hasn't got one; allocate it a place in gen2 and make an entry
              * in the persistent object ID hash. */
-            id = (uintptr_t)MVM_gc_gen2_allocate_zeroed(tc->gen2, obj->header.size);
-            MVM_ptr_hash_insert(tc, &tc->instance->object_ids, obj, id);
+            id = (uintptr_t)MVM_gc_gen2_allocate_zeroed(tc->gen2, MVM_gc_collectable_size(&obj->header));
+            MVM_ptr_hash_insert(tc, &shard->object_ids, obj, id);
             obj->header.flags1 |= MVM_CF_HAS_OBJECT_ID;
         }
-        uv_mutex_unlock(&tc->instance->mutex_object_ids);
+        uv_mutex_unlock(&shard->mutex);
     }
 
     return id;
@@ -38,17 +47,19 @@ MVMuint64 MVM_gc_object_id(MVMThreadContext *tc, MVMObject *obj) {
  * this removes the hash entry for it and returns the pre-allocated gen2
  * address. */
 void * MVM_gc_object_id_use_allocation(MVMThreadContext *tc, MVMCollectable *item) {
-    uv_mutex_lock(&tc->instance->mutex_object_ids);
-    void *addr = (void *) MVM_ptr_hash_fetch_and_delete(tc, &tc->instance->object_ids, item);
+    MVMObjectIdShard *shard = shard_for(tc, item);
+    uv_mutex_lock(&shard->mutex);
+    void *addr = (void *) MVM_ptr_hash_fetch_and_delete(tc, &shard->object_ids, item);
     item->flags1 ^= MVM_CF_HAS_OBJECT_ID;
-    uv_mutex_unlock(&tc->instance->mutex_object_ids);
+    uv_mutex_unlock(&shard->mutex);
     return addr;
 }
 
 /* Clears hash entry for a persistent object ID when an object dies in the
  * nursery. */
 void MVM_gc_object_id_clear(MVMThreadContext *tc, MVMCollectable *item) {
-    uv_mutex_lock(&tc->instance->mutex_object_ids);
-    (void) MVM_ptr_hash_fetch_and_delete(tc, &tc->instance->object_ids, item);
-    uv_mutex_unlock(&tc->instance->mutex_object_ids);
+    MVMObjectIdShard *shard = shard_for(tc, item);
+    uv_mutex_lock(&shard->mutex);
+    (void) MVM_ptr_hash_fetch_and_delete(tc, &shard->object_ids, item);
+    uv_mutex_unlock(&shard->mutex);
 }
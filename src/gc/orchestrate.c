@@ -1,6 +1,7 @@
 #include "moar.h"
 #include <platform/threads.h>
 #include "platform/malloc_trim.h"
+#include "platform/mmap.h"
 
 /* If we have the job of doing GC for a thread, we add it to our work
  * list. */
@@ -20,6 +21,54 @@ static void add_work(MVMThreadContext *tc, MVMThreadContext *stolen) {
     tc->gc_work[tc->gc_work_count++].tc = stolen;
 }
 
+/* Notes down the NUMA node that a thread joining in with a GC run is on, so
+ * work for threads whose memory is on that node can be given to it. */
+static void note_gc_numa_node(MVMThreadContext *tc) {
+    if (tc->instance->gc_numa_local)
+        tc->gc_numa_node = MVM_platform_numa_node();
+}
+
+/* Finds a thread other than the co-ordinator that is taking part in the
+ * GC run and is on the given NUMA node. */
+static MVMThreadContext * find_gc_thread_on_node(MVMThreadContext *tc, MVMint32 node) {
+    MVMThread *t = tc->instance->threads;
+    while (t) {
+        MVMThreadContext *other = t->body.tc;
+        if (other && other != tc && other->gc_numa_node == node
+                && (MVM_load(&other->gc_status) & MVMGCSTATUS_MASK) == MVMGCStatus_INTERRUPT)
+            return other;
+        t = t->body.next;
+    }
+    return NULL;
+}
+
+/* The co-ordinator steals the work of every thread that is blocked, so with
+ * NUMA-local memory it hands each of them on to a thread on the node that
+ * the stolen thread's memory is on, where there is one. This is done while
+ * the other threads wait for the signal to start, so their work lists can be
+ * safely changed. The first entry is always the co-ordinator itself. */
+static void pass_stolen_work_by_node(MVMThreadContext *tc) {
+    MVMuint32 i, kept = 1;
+    uv_mutex_lock(&tc->instance->mutex_threads);
+    for (i = 1; i < tc->gc_work_count; i++) {
+        MVMThreadContext *stolen = tc->gc_work[i].tc;
+        MVMThreadContext *target = stolen->numa_node >= 0 && stolen->numa_node != tc->gc_numa_node
+            ? find_gc_thread_on_node(tc, stolen->numa_node)
+            : NULL;
+        if (target) {
+            GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+                "Thread %d run %d : passing work of thread %d to thread %d on its NUMA node\n",
+                stolen->thread_id, target->thread_id);
+            add_work(target, stolen);
+        }
+        else {
+            tc->gc_work[kept++] = tc->gc_work[i];
+        }
+    }
+    tc->gc_work_count = kept;
+    uv_mutex_unlock(&tc->instance->mutex_threads);
+}
+
 /* Goes through all threads but the current one and notifies them that a
  * GC run is starting. Those that are blocked are considered excluded from
  * the run, and are not counted. Returns the count of threads that should be
@@ -115,6 +164,18 @@ static int process_in_tray(MVMThreadContext *tc, MVMuint8 gen) {
     return 0;
 }
 
+/* Takes and does a chunk of work from the shared mark work pool, if there is
+ * any. Returns a non-zero value if work was found and done. */
+static int process_shared_work(MVMThreadContext *tc, MVMuint8 gen) {
+    if (MVM_load(&tc->instance->gc_mark_pool)) {
+        GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+            "Thread %d run %d : Taking shared mark work\n");
+        MVM_gc_collect(tc, MVMGCWhatToDo_SharedWork, gen);
+        return 1;
+    }
+    return 0;
+}
+
 /* Called by a thread when it thinks it is done with GC. It may get some more
  * work yet, though. */
 static void clear_intrays(MVMThreadContext *tc, MVMuint8 gen) {
@@ -128,11 +189,121 @@ static void clear_intrays(MVMThreadContext *tc, MVMuint8 gen) {
                 did_work += process_in_tray(cur_thread->body.tc, gen);
             cur_thread = cur_thread->body.next;
         }
+        while (process_shared_work(tc, gen))
+            did_work++;
     }
 }
+
+/* With weak parameterizations, full collections leave the lookups of the
+ * parametric types they reach unmarked. Once all else is marked, including
+ * what finalizable objects keep alive, the
+ * co-ordinator drops the parameterizations that weren't marked from each
+ * lookup, then marks the rest; that may reach more parametric types, so it
+ * keeps going until there are none. */
+static void walk_weak_lookups(MVMThreadContext *tc, MVMuint8 gen) {
+    MVMuint32 found = 1;
+    while (found) {
+        MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+        found = 0;
+        while (cur_thread) {
+            MVMThreadContext *other = cur_thread->body.tc;
+            if (other && other->num_weak_lookups) {
+                MVMuint32 i;
+                for (i = 0; i < other->num_weak_lookups; i++)
+                    MVM_6model_parametric_prune_lookup(tc, other->weak_lookups[i]);
+                MVM_gc_collect(other, MVMGCWhatToDo_WeakLookups, gen);
+                found = 1;
+            }
+            cur_thread = cur_thread->body.next;
+        }
+        clear_intrays(tc, gen);
+    }
+}
+
+/* In a parallel full collection, a thread that has run out of its own work
+ * sits here, taking work from its in-trays and the shared mark work pool,
+ * until all of the threads taking part in the run are idle. This is only a
+ * load balancing effort: anything that arrives after we leave is picked up
+ * by the usual in-tray handling, or by the co-ordinator. */
+static void help_with_marking(MVMThreadContext *tc, MVMuint8 gen) {
+    MVMInstance *i = tc->instance;
+    MVMuint32 j;
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+        "Thread %d run %d : Idle; helping with marking\n");
+    MVM_incr(&i->gc_mark_idle);
+    while (1) {
+        MVMuint32 have_work = MVM_load(&i->gc_mark_pool) != 0;
+        for (j = 0; j < tc->gc_work_count && !have_work; j++)
+            if (MVM_load(&tc->gc_work[j].tc->gc_in_tray))
+                have_work = 1;
+        if (have_work) {
+            MVM_decr(&i->gc_mark_idle);
+            for (j = 0; j < tc->gc_work_count; j++)
+                process_in_tray(tc->gc_work[j].tc, gen);
+            process_shared_work(tc, gen);
+            MVM_incr(&i->gc_mark_idle);
+        }
+        else if (MVM_load(&i->gc_mark_idle) >= MVM_load(&i->gc_mark_participants)) {
+            break;
+        }
+        else {
+            MVM_platform_thread_yield();
+        }
+    }
+}
+/* Finishes any deferred gen2 sweeping in all threads. Only the co-ordinator
+ * does this, while all other threads are waiting for the run to start. */
+static void finish_gen2_sweeps(MVMThreadContext *tc) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+    MVMuint64 start_time = uv_hrtime();
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+        "Thread %d run %d : Co-ordinator finishing deferred gen2 sweeps\n");
+    while (cur_thread) {
+        if (cur_thread->body.tc)
+            MVM_gc_collect_finish_gen2_sweep(cur_thread->body.tc);
+        cur_thread = cur_thread->body.next;
+    }
+    tc->gc_phase_time[MVM_GC_PHASE_GEN2_SWEEP] += uv_hrtime() - start_time;
+}
+/* Asks malloc to hand the free memory at the top of its heaps back to the
+ * OS, which full collections may have left plenty of, unless that's turned
+ * off or was done less than the configured interval ago. Only one thread
+ * gets to do it at a time. Records the effect on the resident set. */
+static void maybe_trim(MVMThreadContext *tc) {
+    MVMInstance *i = tc->instance;
+    AO_t now, last;
+    size_t rss_before = 0, rss_after = 0;
+    if (i->gc_trim_interval < 0)
+        return;
+    now  = (AO_t)(uv_hrtime() / 1000000);
+    last = MVM_load(&i->gc_trim_last);
+    if (last && (MVMint64)(now - last) < i->gc_trim_interval)
+        return;
+    if (!MVM_trycas(&i->gc_trim_last, last, now))
+        return;
+
+    if (uv_resident_set_memory(&rss_before) < 0)
+        rss_before = 0;
+    MVM_malloc_trim();
+    if (uv_resident_set_memory(&rss_after) < 0)
+        rss_after = 0;
+
+    uv_mutex_lock(&i->mutex_gc_stats);
+    i->gc_stats[MVM_GC_STATS_TRIMS]++;
+    if (rss_before > rss_after)
+        i->gc_stats[MVM_GC_STATS_TRIM_RELEASED] += rss_before - rss_after;
+    i->gc_stats[MVM_GC_STATS_TRIM_RSS_BEFORE] = rss_before;
+    i->gc_stats[MVM_GC_STATS_TRIM_RSS_AFTER]  = rss_after;
+    uv_mutex_unlock(&i->mutex_gc_stats);
+}
+
 static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinator) {
     MVMuint32 i, did_work;
 
+    /* If we're marking in parallel, help out others until we're all done. */
+    if (gen == MVMGCGenerations_Both && tc->instance->gc_parallel_mark)
+        help_with_marking(tc, gen);
+
     /* Do any extra work that we have been passed. */
     GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
         "Thread %d run %d : doing any work in thread in-trays\n");
@@ -162,14 +333,33 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
      * cleaned from all inter-generational sets, and finally any objects to
      * be freed at the fixed size allocator's next safepoint are freed. */
     if (is_coordinator) {
+        /* Nobody is idle any more (or waiting for shared work). */
+        MVM_store(&tc->instance->gc_mark_idle, 0);
+
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
             "Thread %d run %d : Co-ordinator handling in-tray clearing completion\n");
         clear_intrays(tc, gen);
 
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
             "Thread %d run %d : Co-ordinator handling finalizers\n");
-        MVM_finalize_walk_queues(tc, gen);
-        clear_intrays(tc, gen);
+        {
+            MVMuint64 start_time = uv_hrtime();
+            MVM_finalize_walk_queues(tc, gen);
+            clear_intrays(tc, gen);
+            /* Weak parameterizations are only settled once finalizable
+             * objects have been kept alive, since they may bring back a
+             * parameterized type; dropping it from the lookup first would
+             * see a second type made for the same parameters. The keys of
+             * the entries kept are the parameters the types themselves
+             * hold, so were already marked before the finalizer walk. */
+            if (gen == MVMGCGenerations_Both && tc->instance->gc_weak_parameterizations) {
+                GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+                    "Thread %d run %d : Co-ordinator handling weak parameterizations\n");
+                walk_weak_lookups(tc, gen);
+            }
+            MVM_finalize_hand_out(tc);
+            tc->gc_phase_time[MVM_GC_PHASE_FINALIZE] += uv_hrtime() - start_time;
+        }
 
         if (gen == MVMGCGenerations_Both) {
             MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
@@ -190,6 +380,10 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
             "Thread %d run %d : Co-ordinator handling fixed-size allocator safepoint frees\n");
         MVM_fixed_size_safepoint(tc, tc->instance->fsa);
+        if (gen == MVMGCGenerations_Both) {
+            MVM_fixed_size_telemetry(tc, tc->instance->fsa);
+            MVM_spesh_candidate_free_unused_jit_code(tc);
+        }
         MVM_alloc_safepoint(tc);
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
             "Thread %d run %d : Co-ordinator signalling in-trays clear\n");
@@ -225,15 +419,24 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
             MVM_store(&thread_obj->body.stage, MVM_thread_stage_destroyed);
         }
         else {
-            /* Free gen2 unmarked if full collection. */
-            if (gen == MVMGCGenerations_Both) {
+            /* Free gen2 unmarked if full collection. With lazy sweeping,
+             * we leave it to the thread to do as it allocates, unless we
+             * are profiling (which wants to log the frees as part of the
+             * collection). */
+            if (gen == MVMGCGenerations_Both && tc->instance->gc_lazy_sweep
+                    && !tc->instance->profiling) {
+                GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+                    "Thread %d run %d : deferring gen2 sweep of thread %d\n",
+                    other->thread_id);
+                MVM_gc_collect_defer_gen2_sweep(other);
+            }
+            else if (gen == MVMGCGenerations_Both) {
+                MVMuint64 start_time = uv_hrtime();
                 GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
                     "Thread %d run %d : freeing gen2 of thread %d\n",
                     other->thread_id);
                 MVM_gc_collect_free_gen2_unmarked(tc, other, 0);
-                /* Tell malloc implementation to free empty pages to kernel.
-                 * Currently only activated for Linux. */
-                MVM_malloc_trim();
+                tc->gc_phase_time[MVM_GC_PHASE_GEN2_SWEEP] += uv_hrtime() - start_time;
             }
 
             /* Contribute this thread's promoted bytes. */
@@ -244,6 +447,13 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
                 "Thread %d run %d : collecting nursery uncopied of thread %d\n",
                 other->thread_id);
             MVM_gc_collect_free_nursery_uncopied(tc, other, tc->gc_work[i].limit);
+            other->gc_promote_nursery = 0;
+
+            /* The fromspace of a blocked thread holds nothing of use until
+             * it becomes the tospace of the next run, so needn't be kept in
+             * memory meanwhile. */
+            if (MVM_gc_nursery_is_idle(other))
+                MVM_platform_zero_pages(other->nursery_fromspace, other->nursery_fromspace_size);
 
             /* Handle exited threads. */
             if (MVM_load(&thread_obj->body.stage) == MVM_thread_stage_exited) {
@@ -290,6 +500,11 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
         tc->instance->in_gc = 0;
         uv_cond_broadcast(&tc->instance->cond_blocked_can_continue);
         uv_mutex_unlock(&tc->instance->mutex_gc_orchestrate);
+
+        /* The other threads are on their way again, so a malloc trim after
+         * a full collection doesn't add to the pause. */
+        if (gen == MVMGCGenerations_Both)
+            maybe_trim(tc);
     }
 }
 
@@ -385,7 +600,7 @@ static MVMint32 is_full_collection(MVMThreadContext *tc) {
 
     /* If it's below the absolute minimum, quickly return. */
     promoted = (MVMuint64)MVM_load(&tc->instance->gc_promoted_bytes_since_last_full);
-    if (promoted < MVM_GC_GEN2_THRESHOLD_MINIMUM)
+    if (promoted < tc->instance->gc_gen2_threshold_minimum)
         return 0;
 
     /* If we're heap profiling then don't consider the resident set size, as
@@ -398,7 +613,125 @@ static MVMint32 is_full_collection(MVMThreadContext *tc) {
         rss = 50 * 1024 * 1024;
     percent_growth = (100 * promoted) / (MVMuint64)rss;
 
-    return percent_growth >= MVM_GC_GEN2_THRESHOLD_PERCENT;
+    return percent_growth >= tc->instance->gc_gen2_threshold_percent;
+}
+
+/* If we have a target for the share of time spent in full collections, then
+ * after each one compare the time it took with the time since the previous
+ * one finished. If we're over the target then wait for more promotion next
+ * time; if we're well under it, then we can afford to collect sooner and so
+ * keep the heap smaller. */
+static void adapt_full_collection_threshold(MVMThreadContext *tc, MVMuint64 start_time,
+        MVMuint64 end_time) {
+    MVMInstance *i = tc->instance;
+    if (i->gc_target_time_percent && i->gc_last_full_end && start_time > i->gc_last_full_end) {
+        MVMuint64 gc_time       = end_time - start_time;
+        MVMuint64 total_time    = end_time - i->gc_last_full_end;
+        MVMuint64 time_percent  = (100 * gc_time) / total_time;
+        MVMuint32 threshold     = i->gc_gen2_threshold_percent;
+        if (time_percent > i->gc_target_time_percent)
+            threshold += threshold / 2 > 0 ? threshold / 2 : 1;
+        else if (time_percent < i->gc_target_time_percent / 2)
+            threshold -= threshold / 4;
+        if (threshold < MVM_GC_ADAPTIVE_THRESHOLD_MIN)
+            threshold = MVM_GC_ADAPTIVE_THRESHOLD_MIN;
+        if (threshold > MVM_GC_ADAPTIVE_THRESHOLD_MAX)
+            threshold = MVM_GC_ADAPTIVE_THRESHOLD_MAX;
+        if (threshold != i->gc_gen2_threshold_percent) {
+            GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+                "Thread %d run %d : full collection threshold now %d%%\n", threshold);
+            i->gc_gen2_threshold_percent = threshold;
+        }
+    }
+    i->gc_last_full_end = end_time;
+}
+
+/* Adds the time this thread spent in each phase of the GC run to the
+ * instance-wide statistics. */
+static void add_phase_times(MVMThreadContext *tc) {
+    MVMuint32 i;
+    uv_mutex_lock(&tc->instance->mutex_gc_stats);
+    for (i = 0; i < MVM_GC_PHASES; i++) {
+        tc->instance->gc_stats[MVM_GC_STATS_PHASE_TIMES + i] += tc->gc_phase_time[i];
+        tc->gc_phase_time[i] = 0;
+    }
+    uv_mutex_unlock(&tc->instance->mutex_gc_stats);
+}
+
+/* Records how long a GC run stopped the world for, as seen by the
+ * co-ordinator, and how much of that went on getting the other threads to
+ * stop. */
+static void record_pause(MVMThreadContext *tc, MVMuint64 pause, MVMuint64 ttsp, MVMuint8 full) {
+    MVMuint64 *stats = tc->instance->gc_stats;
+    MVMuint64 us = pause / 1000;
+    MVMuint32 bucket = 0;
+    while (us > 1 && bucket < MVM_GC_PAUSE_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    uv_mutex_lock(&tc->instance->mutex_gc_stats);
+    stats[MVM_GC_STATS_RUNS]++;
+    if (full)
+        stats[MVM_GC_STATS_FULL_RUNS]++;
+    stats[MVM_GC_STATS_PAUSE_TOTAL] += pause;
+    if (pause > stats[MVM_GC_STATS_PAUSE_MAX])
+        stats[MVM_GC_STATS_PAUSE_MAX] = pause;
+    stats[MVM_GC_STATS_HISTOGRAM + bucket]++;
+    stats[MVM_GC_STATS_TTSP_TOTAL] += ttsp;
+    if (ttsp > stats[MVM_GC_STATS_TTSP_MAX])
+        stats[MVM_GC_STATS_TTSP_MAX] = ttsp;
+    uv_mutex_unlock(&tc->instance->mutex_gc_stats);
+}
+
+/* Decides whether a thread that has filled its nursery can collect it on its
+ * own, while the other threads keep running. That needs none of its nursery
+ * objects to be reachable by another thread, and nothing else to want the
+ * world stopped. */
+static MVMuint32 can_collect_locally(MVMThreadContext *tc) {
+    MVMInstance *i = tc->instance;
+    return i->gc_thread_local
+        && !tc->gc_nursery_escaped
+        && MVM_load(&tc->gc_status) == MVMGCStatus_NONE
+        && !MVM_load(&i->gc_start)
+        && !i->profiling
+        && !i->alloc_sample_interval
+        && !i->cpu_sample_interval
+        && !i->debugserver
+        && !MVM_profile_heap_profiling(tc)
+        && !is_full_collection(tc);
+}
+
+/* Collects the nursery of the current thread without involving any of the
+ * others. Objects belonging to other threads are left untouched, and
+ * anything the collection would normally do for the whole instance (such
+ * as freeing STables and fixed size allocator safepoint frees) is left for
+ * the next stop-the-world run. */
+static void run_local_gc(MVMThreadContext *tc) {
+    MVMuint64    start_time  = uv_hrtime();
+    void        *limit       = tc->nursery_alloc;
+    unsigned int interval_id = MVM_telemetry_interval_start(tc, "start thread-local collection");
+    MVMuint64    duration;
+
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE, "Thread %d run %d : collecting nursery alone\n");
+    tc->gc_local = 1;
+    tc->gc_promoted_bytes = 0;
+    MVM_gc_collect(tc, MVMGCWhatToDo_NoInstance, MVMGCGenerations_Nursery);
+    {
+        MVMuint64 finalize_start = uv_hrtime();
+        MVM_finalize_walk_local_queue(tc);
+        tc->gc_phase_time[MVM_GC_PHASE_FINALIZE] += uv_hrtime() - finalize_start;
+    }
+    MVM_add(&tc->instance->gc_promoted_bytes_since_last_full, tc->gc_promoted_bytes);
+    MVM_gc_collect_free_nursery_uncopied(tc, tc, limit);
+    tc->gc_local = 0;
+    add_phase_times(tc);
+
+    duration = uv_hrtime() - start_time;
+    uv_mutex_lock(&tc->instance->mutex_gc_stats);
+    tc->instance->gc_stats[MVM_GC_STATS_LOCAL_RUNS]++;
+    tc->instance->gc_stats[MVM_GC_STATS_LOCAL_TOTAL] += duration;
+    uv_mutex_unlock(&tc->instance->mutex_gc_stats);
+    MVM_telemetry_interval_stop(tc, interval_id, "finished thread-local collection");
 }
 
 static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
@@ -428,6 +761,10 @@ static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
     } else {
         interval_id = MVM_telemetry_interval_start(tc, "start minor collection");
     }
+    if (is_coordinator)
+        MVM_telemetry_interval_annotate(
+            (uintptr_t)MVM_load(&tc->instance->gc_promoted_bytes_since_last_full),
+            interval_id, "gen2 bytes promoted since last full collection");
 
     if (is_coordinator)
         start_time = uv_hrtime();
@@ -446,6 +783,11 @@ static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
 
     /* Wait for everybody to agree we're done. */
     finish_gc(tc, gen, is_coordinator);
+    add_phase_times(tc);
+
+    /* The co-ordinator gets to tune when the next full collection happens. */
+    if (is_coordinator && gen == MVMGCGenerations_Both)
+        adapt_full_collection_threshold(tc, start_time, uv_hrtime());
 
     /* Finally, as the very last thing ever, the coordinator pushes a bit of
      * info into the subscription queue (if it is set) */
@@ -497,9 +839,18 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
 
     MVM_telemetry_timestamp(tc, "gc_enter_from_allocator");
 
+    /* If nobody else can see our nursery, there's no need to stop them. */
+    if (can_collect_locally(tc)) {
+        run_local_gc(tc);
+        return;
+    }
+
     /* Try to start the GC run. */
     if (MVM_trycas(&tc->instance->gc_start, 0, 1)) {
         MVMuint32 num_threads = 0;
+        MVMuint64 pause_start = uv_hrtime();
+        MVMuint64 signal_start, ttsp;
+        MVMuint8  full;
 
         /* Stash us as the thread to blame for this GC run (used to give it a
          * potential nursery size boost). */
@@ -521,7 +872,7 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
             (int)MVM_load(&tc->instance->gc_seq_number));
 
         /* Decide if it will be a full collection. */
-        tc->instance->gc_full_collect = is_full_collection(tc);
+        tc->instance->gc_full_collect = full = is_full_collection(tc);
 
         MVM_telemetry_timestamp(tc, "won the gc starting race");
 
@@ -538,9 +889,11 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
         MVM_store(&tc->instance->gc_completed, 0);
 
         /* We'll take care of our own work. */
+        note_gc_numa_node(tc);
         add_work(tc, tc);
 
         /* Find other threads, and signal or steal. Also set in GC flag. */
+        signal_start = uv_hrtime();
         uv_mutex_lock(&tc->instance->mutex_threads);
         tc->instance->in_gc = 1;
         num_threads = signal_all(tc, tc->instance->threads);
@@ -552,15 +905,25 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
         uv_cond_broadcast(&tc->instance->cond_gc_start);
         uv_mutex_unlock(&tc->instance->mutex_gc_orchestrate);
 
-        /* If there's an event loop thread, wake it up to participate. */
-        if (tc->instance->event_loop_wakeup)
-            uv_async_send(tc->instance->event_loop_wakeup);
+        /* If there are event loop threads, wake them up to participate. */
+        {
+            MVMuint32 i;
+            for (i = 0; i < tc->instance->num_event_loops; i++)
+                if (tc->instance->event_loops[i].wakeup)
+                    uv_async_send(tc->instance->event_loops[i].wakeup);
+        }
 
         /* Wait for other threads to be ready. */
         uv_mutex_lock(&tc->instance->mutex_gc_orchestrate);
         while (MVM_load(&tc->instance->gc_start) > 1)
             uv_cond_wait(&tc->instance->cond_gc_start, &tc->instance->mutex_gc_orchestrate);
         uv_mutex_unlock(&tc->instance->mutex_gc_orchestrate);
+        ttsp = uv_hrtime() - signal_start;
+
+        /* Now everyone has joined in, work we stole may be better done by
+         * another thread. */
+        if (tc->instance->gc_numa_local)
+            pass_stolen_work_by_node(tc);
 
         /* Sanity check finish votes. */
         if (MVM_load(&tc->instance->gc_finish) != 0)
@@ -571,13 +934,23 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
          * can also free the STables. */
         MVM_store(&tc->instance->gc_finish, num_threads + 1);
         MVM_store(&tc->instance->gc_ack, num_threads + 2);
+        MVM_store(&tc->instance->gc_mark_participants, num_threads + 1);
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE, "Thread %d run %d : finish votes is %d\n",
             (int)MVM_load(&tc->instance->gc_finish));
 
         /* Now we're ready to start, zero promoted since last full collection
          * counter if this is a full collect. */
-        if (tc->instance->gc_full_collect)
+        if (tc->instance->gc_full_collect) {
+            MVM_add(&tc->instance->stat_promoted_bytes,
+                MVM_load(&tc->instance->gc_promoted_bytes_since_last_full));
             MVM_store(&tc->instance->gc_promoted_bytes_since_last_full, 0);
+        }
+
+        /* Marking relies on the marks left by the last full collection having
+         * been cleared, so any gen2 sweeping that is still outstanding needs
+         * finishing before anyone starts. */
+        if (tc->instance->gc_full_collect && tc->instance->gc_lazy_sweep)
+            finish_gen2_sweeps(tc);
 
         /* This is a safe point for us to free any STables that have been marked
          * for deletion in the previous collection (since we let finalization -
@@ -597,6 +970,7 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
         /* Start collecting. */
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE, "Thread %d run %d : coordinator entering run_gc\n");
         run_gc(tc, MVMGCWhatToDo_All);
+        record_pause(tc, uv_hrtime() - pause_start, ttsp, full);
 
         /* If profiling, record that GC is over. */
         if (tc->instance->profiling)
@@ -656,6 +1030,7 @@ void MVM_gc_enter_from_interrupt(MVMThreadContext *tc) {
 
     /* We'll certainly take care of our own work. */
     tc->gc_work_count = 0;
+    note_gc_numa_node(tc);
     add_work(tc, tc);
 
     /* Indicate that we're ready to GC. Only want to decrement it if it's 2 or
@@ -665,8 +1040,12 @@ void MVM_gc_enter_from_interrupt(MVMThreadContext *tc) {
     uv_mutex_lock(&tc->instance->mutex_gc_orchestrate);
     while (MVM_load(&tc->instance->gc_start) < 2)
         uv_cond_wait(&tc->instance->cond_gc_start, &tc->instance->mutex_gc_orchestrate);
-    MVM_decr(&tc->instance->gc_start);
-    uv_cond_broadcast(&tc->instance->cond_gc_start);
+
+    /* Only the co-ordinator waits for the count to get down to 1, so only the
+     * last thread to join need wake anybody. Waking everyone waiting on each
+     * join made the wakeups go up with the square of the thread count. */
+    if (MVM_decr(&tc->instance->gc_start) == 2)
+        uv_cond_broadcast(&tc->instance->cond_gc_start);
     uv_mutex_unlock(&tc->instance->mutex_gc_orchestrate);
 
     /* If profiling, record that GC is starting.
@@ -748,3 +1127,19 @@ void MVM_gc_global_destruction(MVMThreadContext *tc) {
     MVM_gc_collect_free_gen2_unmarked(tc, tc, 1);
     MVM_gc_collect_free_stables(tc);
 }
+
+/* Puts the GC statistics (see MVM_GC_STATS_FIELDS for what they are) into a
+ * native integer array. */
+void MVM_gc_stats(MVMThreadContext *tc, MVMObject *result) {
+    MVMuint64 stats[MVM_GC_STATS_FIELDS];
+    MVMuint32 i;
+    if (REPR(result)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(result) ||
+            ((MVMArrayREPRData *)STABLE(result)->REPR_data)->slot_type != MVM_ARRAY_I64) {
+        MVM_exception_throw_adhoc(tc, "gcstats needs a concrete 64bit int array.");
+    }
+    uv_mutex_lock(&tc->instance->mutex_gc_stats);
+    memcpy(stats, tc->instance->gc_stats, sizeof(stats));
+    uv_mutex_unlock(&tc->instance->mutex_gc_stats);
+    for (i = 0; i < MVM_GC_STATS_FIELDS; i++)
+        MVM_repr_bind_pos_i(tc, result, i, (MVMint64)stats[i]);
+}
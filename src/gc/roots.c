@@ -25,12 +25,58 @@ void MVM_gc_root_add_permanent_desc(MVMThreadContext *tc, MVMCollectable **obj_r
     tc->instance->num_permroots++;
 
     uv_mutex_unlock(&tc->instance->mutex_permroots);
+
+    /* Whatever is stored there is reachable by all threads. */
+    MVM_gc_note_escape(tc);
 }
 
 void MVM_gc_root_add_permanent(MVMThreadContext *tc, MVMCollectable **obj_ref) {
     MVM_gc_root_add_permanent_desc(tc, obj_ref, "<\?\?>");
 }
 
+/* Pins a collectable, so that it stays alive and at the same address until
+ * it is unpinned; for example, so that it can safely be handed to C code.
+ * Since objects in the nursery move, if it's in one then a GC run is done
+ * so that it is promoted (pinned objects always are). Returns where the
+ * collectable is now. */
+MVMCollectable * MVM_gc_root_pin(MVMThreadContext *tc, MVMCollectable *col) {
+    MVMInstance *i = tc->instance;
+    if (col->flags1 & MVM_CF_PINNED)
+        return col;
+    uv_mutex_lock(&i->mutex_pinned);
+    col->flags1 |= MVM_CF_PINNED;
+    MVM_VECTOR_PUSH(i->pinned, col);
+    uv_mutex_unlock(&i->mutex_pinned);
+
+    /* The pinned list is instance-wide, so must be walked by whatever GC
+     * run comes next; a thread-local one wouldn't. */
+    MVM_gc_note_escape(tc);
+    if (!(col->flags2 & MVM_CF_SECOND_GEN)) {
+        MVMROOT(tc, col, {
+            MVM_gc_enter_from_allocator(tc);
+        });
+    }
+    return col;
+}
+
+/* Unpins a collectable, so it can die once it's no longer referenced. It
+ * stays in gen2, so still won't move. */
+void MVM_gc_root_unpin(MVMThreadContext *tc, MVMCollectable *col) {
+    MVMInstance *i = tc->instance;
+    size_t j;
+    if (!(col->flags1 & MVM_CF_PINNED))
+        return;
+    uv_mutex_lock(&i->mutex_pinned);
+    for (j = 0; j < MVM_VECTOR_ELEMS(i->pinned); j++) {
+        if (i->pinned[j] == col) {
+            i->pinned[j] = MVM_VECTOR_POP(i->pinned);
+            break;
+        }
+    }
+    col->flags1 &= ~MVM_CF_PINNED;
+    uv_mutex_unlock(&i->mutex_pinned);
+}
+
 /* Adds the set of permanently registered roots to a GC worklist. */
 void MVM_gc_root_add_permanents_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMHeapSnapshotState *snapshot) {
     MVMuint32         i, num_roots;
@@ -62,10 +108,31 @@ void MVM_gc_root_add_permanents_to_worklist(MVMThreadContext *tc, MVMGCWorklist
         } \
     } while (0)
 
+/* Adds the static frames of a tree of CPU samples. */
+static void add_cpu_sample_nodes(MVMThreadContext *tc, MVMGCWorklist *worklist,
+        MVMHeapSnapshotState *snapshot, MVMCPUSampleNode *node) {
+    MVMuint32 i;
+    if (node->sf)
+        add_collectable(tc, worklist, snapshot, node->sf, "CPU sample frame");
+    for (i = 0; i < node->num_children; i++)
+        add_cpu_sample_nodes(tc, worklist, snapshot, node->children[i]);
+}
+
+/* Adds the static frames in a table of lock contention counts. */
+static void add_lock_contention_frames(MVMThreadContext *tc, MVMGCWorklist *worklist,
+        MVMHeapSnapshotState *snapshot, MVMLockContention *lc) {
+    MVMuint32 i;
+    for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++)
+        if (lc->entries[i].sf)
+            add_collectable(tc, worklist, snapshot, lc->entries[i].sf, "Lock contention frame");
+}
+
 /* Adds anything that is a root thanks to being referenced by instance,
  * but that isn't permanent. */
 void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMHeapSnapshotState *snapshot) {
     MVMString                  **int_to_str_cache;
+    MVMIntConstCache            *int_const_cache;
+    MVMCUStringInterns          *cu_string_interns;
     MVMuint32                    i;
 
     add_collectable(tc, worklist, snapshot, tc->instance->threads, "Thread list");
@@ -73,23 +140,37 @@ void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorkl
     add_collectable(tc, worklist, snapshot, tc->instance->hll_syms, "HLL symbols");
     add_collectable(tc, worklist, snapshot, tc->instance->clargs, "Command line args");
 
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_thread,
-        "Event loop thread");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_todo_queue,
-        "Event loop todo queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_permit_queue,
-        "Event loop permit queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_cancel_queue,
-        "Event loop cancel queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_active,
-        "Event loop active task list");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_free_indices,
-        "Event loop active free indices list");
+    for (i = 0; i < tc->instance->num_event_loops; i++) {
+        MVMEventLoop *el = &tc->instance->event_loops[i];
+        add_collectable(tc, worklist, snapshot, el->thread,
+            "Event loop thread");
+        add_collectable(tc, worklist, snapshot, el->todo_queue,
+            "Event loop todo queue");
+        add_collectable(tc, worklist, snapshot, el->permit_queue,
+            "Event loop permit queue");
+        add_collectable(tc, worklist, snapshot, el->cancel_queue,
+            "Event loop cancel queue");
+        add_collectable(tc, worklist, snapshot, el->active,
+            "Event loop active task list");
+        add_collectable(tc, worklist, snapshot, el->free_indices,
+            "Event loop active free indices list");
+        add_collectable(tc, worklist, snapshot, el->batch,
+            "Event loop result batch");
+    }
 
     add_collectable(tc, worklist, snapshot, tc->instance->spesh_thread,
         "Specialization thread");
     add_collectable(tc, worklist, snapshot, tc->instance->spesh_queue,
         "Specialization log queue");
+    if (tc->instance->spesh_helpers)
+        for (i = 0; i < tc->instance->num_spesh_helpers; i++)
+            add_collectable(tc, worklist, snapshot, tc->instance->spesh_helpers[i],
+                "Specialization helper thread");
+
+    MVM_worker_pool_gc_mark(tc, tc->instance->finalizer_pool, worklist, snapshot,
+        "Finalizer thread");
+    MVM_worker_pool_gc_mark(tc, tc->instance->deserialize_pool, worklist, snapshot,
+        "Deserialization thread");
 
     if (worklist)
         MVM_spesh_plan_gc_mark(tc, tc->instance->spesh_plan, worklist);
@@ -99,6 +180,23 @@ void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorkl
         add_collectable(tc, worklist, snapshot, int_to_str_cache[i],
             "Integer to string cache entry");
 
+    int_const_cache = tc->instance->int_const_cache;
+    for (i = 0; i < MVM_INTCACHE_TYPES; i++) {
+        if (int_const_cache->cache[i]) {
+            MVMint64 j;
+            for (j = 0; j <= int_const_cache->max - int_const_cache->min; j++)
+                if (int_const_cache->cache[i][j])
+                    add_collectable(tc, worklist, snapshot, int_const_cache->cache[i][j],
+                        "Boxed integer cache entry");
+        }
+    }
+
+    cu_string_interns = tc->instance->cu_string_interns;
+    for (i = 0; i < cu_string_interns->alloc_entries; i++)
+        if (cu_string_interns->entries[i].string)
+            add_collectable(tc, worklist, snapshot, cu_string_interns->entries[i].string,
+                "Interned compilation unit string");
+
     /* okay, so this makes the weak hash slightly less weak.. for certain
      * keys of it anyway... */
     MVMStrHashTable *const weakhash = &tc->instance->sc_weakhash;
@@ -136,6 +234,20 @@ void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorkl
     add_collectable(tc, worklist, snapshot, tc->instance->sig_arr,
         "Cached signal mapping array");
 
+    for (i = 0; i < MVM_VECTOR_ELEMS(tc->instance->pinned); i++)
+        add_collectable(tc, worklist, snapshot, tc->instance->pinned[i],
+            "Pinned object");
+
+    for (i = 0; i < MVM_VECTOR_ELEMS(tc->instance->finalize_pending); i++)
+        add_collectable(tc, worklist, snapshot, tc->instance->finalize_pending[i].obj,
+            "Object awaiting a finalizer thread");
+
+    for (i = 0; i < MVM_VECTOR_ELEMS(tc->instance->deserialize_pending); i++)
+        add_collectable(tc, worklist, snapshot, tc->instance->deserialize_pending[i],
+            "SC awaiting a deserialization thread");
+
+    MVM_scheduler_gc_mark(tc, worklist, snapshot);
+
     if (tc->instance->confprog)
         MVM_confprog_mark(tc, worklist, snapshot);
 
@@ -147,12 +259,18 @@ void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorkl
     add_collectable(tc, worklist, snapshot, tc->instance->subscriptions.GCEvent,
         "VM Event SpeshOverviewEvent type");
 
+    /* Frames in the lock contention counts of threads that have gone. */
+    if (tc->instance->lock_contention_exited)
+        add_lock_contention_frames(tc, worklist, snapshot, tc->instance->lock_contention_exited);
+
     MVM_debugserver_mark_handles(tc, worklist, snapshot);
 }
 
 /* Adds anything that is a root thanks to being referenced by a thread,
  * context, but that isn't permanent. */
 void MVM_gc_root_add_tc_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMHeapSnapshotState *snapshot) {
+    MVMuint32 i;
+
     /* Any active exception handlers and payload. */
     MVMActiveHandler *cur_ah = tc->active_handlers;
     while (cur_ah != NULL) {
@@ -171,6 +289,17 @@ void MVM_gc_root_add_tc_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *w
     if (tc->thread_entry_frame && !MVM_FRAME_IS_ON_CALLSTACK(tc, tc->thread_entry_frame))
         add_collectable(tc, worklist, snapshot, tc->thread_entry_frame, "Thread entry frame");
 
+    /* The dynamic variable and lexical name caches point at things the GC
+     * may move, so rather than being marked they are emptied. */
+    if (worklist) {
+        tc->num_dynvar_cache = 0;
+        tc->num_lexname_cache = 0;
+    }
+
+    /* Closures whose outer is still on the call stack. */
+    for (i = 0; i < tc->num_local_closures; i++)
+        add_collectable(tc, worklist, snapshot, tc->local_closures[i], "Local closure");
+
     /* Any exception handler result. */
     add_collectable(tc, worklist, snapshot, tc->last_handler_result, "Last handler result");
 
@@ -213,6 +342,27 @@ void MVM_gc_root_add_tc_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *w
     if (worklist)
         MVM_profile_instrumented_mark_data(tc, worklist);
 
+    /* Types and frames that allocation samples were taken for. */
+    if (tc->alloc_samples) {
+        MVMuint32 i;
+        for (i = 0; i < tc->alloc_samples_size; i++) {
+            if (tc->alloc_samples[i].st) {
+                add_collectable(tc, worklist, snapshot, tc->alloc_samples[i].st,
+                    "Allocation sample type");
+                add_collectable(tc, worklist, snapshot, tc->alloc_samples[i].sf,
+                    "Allocation sample frame");
+            }
+        }
+    }
+
+    /* Frames in the CPU sample tree. */
+    if (tc->cpu_samples)
+        add_cpu_sample_nodes(tc, worklist, snapshot, tc->cpu_samples);
+
+    /* Frames that lock acquisitions were counted for. */
+    if (tc->lock_contention)
+        add_lock_contention_frames(tc, worklist, snapshot, tc->lock_contention);
+
     /* Specialization log, stack simulation, and plugin state. */
     add_collectable(tc, worklist, snapshot, tc->spesh_log, "Specialization log");
     if (worklist)
@@ -335,6 +485,20 @@ void MVM_gc_root_add_gen2s_to_worklist(MVMThreadContext *tc, MVMGCWorklist *work
      * slide all that stay towards the start of the array. */
     MVMuint32 insert_pos = 0;
 
+    /* When collecting on our own, the only entries that can reference our
+     * nursery are our frames with a work area, since their registers are
+     * written without a barrier; anything else being stored into gen2 would
+     * have stopped us collecting alone. The other entries may be in use by
+     * other threads, so we leave them, and the list, alone. */
+    if (tc->gc_local) {
+        for (i = 0; i < num_roots; i++) {
+            MVMCollectable *c = gen2roots[i];
+            if (c->flags1 & MVM_CF_FRAME && ((MVMFrame *)c)->work && c->owner == tc->thread_id)
+                MVM_gc_mark_collectable(tc, worklist, c);
+        }
+        return;
+    }
+
     /* Guess that we'll end up with around num_roots entries, to avoid some
      * worklist growth reallocations. */
     MVM_gc_worklist_presize_for(tc, worklist, num_roots);
@@ -451,6 +615,8 @@ void MVM_gc_root_add_frame_registers_to_worklist(MVMThreadContext *tc, MVMGCWork
 
         MVMSpeshCandidate *spesh_cand = frame->spesh_cand;
         MVMJitCode *jitcode = spesh_cand ? spesh_cand->jitcode : NULL;
+        if (jitcode)
+            jitcode->last_seen_gc = MVM_load(&tc->instance->gc_seq_number);
         if (jitcode && jitcode->local_types) {
             type_map = jitcode->local_types;
             count    = jitcode->num_locals;
@@ -10,10 +10,23 @@
 void MVM_gc_write_barrier_hit(MVMThreadContext *tc, MVMCollectable *update_root) {
     if (!(update_root->flags2 & MVM_CF_IN_GEN2_ROOT_LIST))
         MVM_gc_root_gen2_add(tc, update_root);
+    tc->gc_nursery_escaped = 1;
 }
 void MVM_gc_write_barrier_hit_by(MVMThreadContext *tc, MVMCollectable *update_root,
                                  MVMCollectable *referenced) {
     if (!(update_root->flags2 & MVM_CF_IN_GEN2_ROOT_LIST))
         MVM_gc_root_gen2_add(tc, update_root);
     referenced->flags2 |= MVM_CF_REF_FROM_GEN2;
+    tc->gc_nursery_escaped = 1;
+}
+
+/* Called when a nursery object is stored into a nursery object belonging to
+ * another thread. When the referenced object is ours, the other thread can now
+ * reach it; when it's theirs, this is harmless but rare enough not to be worth
+ * telling apart. Also, the barrier hits above set the same flag, since a gen2
+ * object may be seen by any thread. Once set, the thread doesn't collect its
+ * nursery on its own until a stop-the-world run has promoted all of it. */
+void MVM_gc_write_barrier_escape(MVMThreadContext *tc, MVMCollectable *update_root,
+                                 MVMCollectable *referenced) {
+    tc->gc_nursery_escaped = 1;
 }
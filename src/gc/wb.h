@@ -2,19 +2,36 @@
 MVM_PUBLIC void MVM_gc_write_barrier_hit(MVMThreadContext *tc, MVMCollectable *update_root);
 MVM_PUBLIC void MVM_gc_write_barrier_hit_by(MVMThreadContext *tc, MVMCollectable *update_root,
         MVMCollectable *referenced);
+MVM_PUBLIC void MVM_gc_write_barrier_escape(MVMThreadContext *tc, MVMCollectable *update_root,
+        MVMCollectable *referenced);
 
 /* Ensures that if a generation 2 object comes to hold a reference to a
  * nursery object, then the generation 2 object becomes an inter-generational
- * root. */
+ * root. A nursery object being stored into a nursery object of another thread
+ * is also noted, as it means the nursery can no longer be collected without
+ * stopping the other threads (see MVM_GC_THREAD_LOCAL). */
 MVM_STATIC_INLINE void MVM_gc_write_barrier(MVMThreadContext *tc, MVMCollectable *update_root, MVMCollectable *referenced) {
-    if (((update_root->flags2 & MVM_CF_SECOND_GEN) && referenced && !(referenced->flags2 & MVM_CF_SECOND_GEN)))
-        MVM_gc_write_barrier_hit_by(tc, update_root, referenced);
+    if (referenced && !(referenced->flags2 & MVM_CF_SECOND_GEN)) {
+        if (update_root->flags2 & MVM_CF_SECOND_GEN)
+            MVM_gc_write_barrier_hit_by(tc, update_root, referenced);
+        else if (MVM_UNLIKELY(update_root->owner != referenced->owner))
+            MVM_gc_write_barrier_escape(tc, update_root, referenced);
+    }
 }
 MVM_STATIC_INLINE void MVM_gc_write_barrier_no_update_referenced(MVMThreadContext *tc, MVMCollectable *update_root, MVMCollectable *referenced) {
-    if (((update_root->flags2 & MVM_CF_SECOND_GEN) && referenced && !(referenced->flags2 & MVM_CF_SECOND_GEN)))
-        MVM_gc_write_barrier_hit(tc, update_root);
+    if (referenced && !(referenced->flags2 & MVM_CF_SECOND_GEN)) {
+        if (update_root->flags2 & MVM_CF_SECOND_GEN)
+            MVM_gc_write_barrier_hit(tc, update_root);
+        else if (MVM_UNLIKELY(update_root->owner != referenced->owner))
+            MVM_gc_write_barrier_escape(tc, update_root, referenced);
+    }
 }
 
+/* Notes that the thread may have made a nursery object reachable from
+ * somewhere that the write barrier doesn't see, such as a field of the
+ * instance, so it may not collect its nursery on its own. */
+#define MVM_gc_note_escape(tc) ((tc)->gc_nursery_escaped = 1)
+
 /* Does an assignment, but makes sure the write barrier MVM_WB is applied
  * first. Takes the root object, the address within it we're writing to, and
  * the thing we're writing. Note that update_addr is not involved in the
@@ -149,17 +149,20 @@ static MVMint64 filtered_out(MVMThreadContext *tc, MVMObject *written) {
         return 1;
 
     /* Write on object from event loop thread is usually shift of invokable. */
-    if (tc->instance->event_loop_thread) {
-        MVMThread *thread = (MVMThread*)tc->instance->event_loop_thread;
-        if (thread != NULL && written->header.owner == thread->body.tc->thread_id)
-            return 1;
+    {
+        MVMuint32 i;
+        for (i = 0; i < tc->instance->num_event_loops; i++) {
+            MVMThread *thread = (MVMThread*)tc->instance->event_loops[i].thread;
+            if (thread != NULL && written->header.owner == thread->body.tc->thread_id)
+                return 1;
+        }
     }
 
     /* Filter out writes to Sub and Method, since these are almost always just
      * multi-dispatch caches. */
-    if (strncmp( MVM_6model_get_stable_debug_name(tc, written->st), "Method", 6) == 0)
+    if (strncmp( MVM_6model_get_stable_debug_name(tc, STABLE(written)), "Method", 6) == 0)
         return 1;
-    if (strncmp( MVM_6model_get_stable_debug_name(tc, written->st), "Sub", 3) == 0)
+    if (strncmp( MVM_6model_get_stable_debug_name(tc, STABLE(written)), "Sub", 3) == 0)
         return 1;
 
     /* Otherwise, may be relevant. */
@@ -117,15 +117,72 @@ static void instrument_graph_with_breakpoints(MVMThreadContext *tc, MVMSpeshGrap
         MVM_free(filename_buf);
 }
 
+/* Makes the instruction that records a line being hit; this is either a
+ * coverage_log, which writes it to the log, or a coverage_count, which just
+ * bumps a counter. The pointer operand is filled in later. */
+static MVMSpeshIns * make_coverage_ins(MVMThreadContext *tc, MVMSpeshGraph *g,
+        MVMint64 filename_string_index, MVMint64 line_number, MVMuint16 slot) {
+    MVMSpeshIns *ins = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
+    if (tc->instance->coverage_counting) {
+        ins->info        = MVM_op_get_op(MVM_OP_coverage_count);
+        ins->operands    = MVM_spesh_alloc(tc, g, 2 * sizeof(MVMSpeshOperand));
+        ins->operands[0].lit_i32 = slot;
+    }
+    else {
+        ins->info        = MVM_op_get_op(MVM_OP_coverage_log);
+        ins->operands    = MVM_spesh_alloc(tc, g, 4 * sizeof(MVMSpeshOperand));
+        ins->operands[0].lit_str_idx = filename_string_index;
+        ins->operands[1].lit_i32 = line_number;
+        ins->operands[2].lit_i32 = slot;
+    }
+    return ins;
+}
+
+/* Builds the counters for a frame instrumented with coverage_count ops, and
+ * adds them to the instance-wide list. */
+static MVMuint64 * register_counters(MVMThreadContext *tc, MVMSpeshGraph *g,
+        MVMuint16 num_slots, MVMint64 *slot_lines, MVMint64 *slot_files) {
+    MVMLineCoverageCounters *counters = MVM_calloc(1, sizeof(MVMLineCoverageCounters));
+    MVMint64 last_filename = -1;
+    MVMuint16 i;
+
+    counters->counts    = MVM_calloc(num_slots, sizeof(MVMuint64));
+    counters->lines     = MVM_malloc(num_slots * sizeof(MVMuint32));
+    counters->files     = MVM_malloc(num_slots * sizeof(MVMuint32));
+    counters->filenames = MVM_malloc(num_slots * sizeof(char *));
+    counters->num_slots = num_slots;
+    for (i = 0; i < num_slots; i++) {
+        if (slot_files[i] != last_filename) {
+            counters->filenames[counters->num_filenames++] = MVM_string_utf8_encode_C_string(tc,
+                MVM_cu_string(tc, g->sf->body.cu, slot_files[i]));
+            last_filename = slot_files[i];
+        }
+        counters->lines[i] = slot_lines[i];
+        counters->files[i] = counters->num_filenames - 1;
+    }
+
+    uv_mutex_lock(&tc->instance->mutex_coverage_counters);
+    counters->next = tc->instance->coverage_counters;
+    tc->instance->coverage_counters = counters;
+    uv_mutex_unlock(&tc->instance->mutex_coverage_counters);
+
+    return counters->counts;
+}
+
 static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
     MVMSpeshBB *bb = g->entry->linear_next;
     MVMuint16 array_slot = 0;
+    MVMuint8 counting = tc->instance->coverage_counting;
 
     MVMint32 last_line_number = -2;
     MVMint32 last_filename = -1;
 
     MVMuint16 allocd_slots  = g->num_bbs * 2;
-    char *line_report_store = MVM_calloc(allocd_slots, sizeof(char));
+    char *line_report_store = NULL;
+
+    /* When counting, we also need to remember which line each slot is for. */
+    MVMint64 *slot_lines = NULL;
+    MVMint64 *slot_files = NULL;
 
     /* Since we don't know the right size for the line report store
      * up front, we will have to realloc it along the way. After that
@@ -135,6 +192,14 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
     MVMuint32 fixup_idx; /* for iterating over the fixup array */
     MVMSpeshIns **to_fixup = MVM_malloc(fixup_alloc * sizeof(MVMSpeshIns*));
 
+    if (counting) {
+        slot_lines = MVM_malloc(allocd_slots * sizeof(MVMint64));
+        slot_files = MVM_malloc(allocd_slots * sizeof(MVMint64));
+    }
+    else {
+        line_report_store = MVM_calloc(allocd_slots, sizeof(char));
+    }
+
     while (bb) {
         MVMSpeshIns *ins = bb->first_ins;
         MVMSpeshIns *log_ins;
@@ -168,25 +233,29 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
             continue;
         }
 
-        log_ins = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
-        log_ins->info        = MVM_op_get_op(MVM_OP_coverage_log);
-        log_ins->operands    = MVM_spesh_alloc(tc, g, 4 * sizeof(MVMSpeshOperand));
-
-        log_ins->operands[0].lit_str_idx = filename_string_index;
-        log_ins->operands[1].lit_i32 = line_number;
-
         if (last_line_number == line_number && last_filename == filename_string_index) {
             /* Consecutive BBs with the same line number and filename should
              * share one "already reported" slot. */
-            log_ins->operands[2].lit_i32 = array_slot;
+            log_ins = make_coverage_ins(tc, g, filename_string_index, line_number, array_slot - 1);
         } else {
-            log_ins->operands[2].lit_i32 = array_slot++;
+            log_ins = make_coverage_ins(tc, g, filename_string_index, line_number, array_slot);
+            if (counting) {
+                slot_lines[array_slot] = line_number;
+                slot_files[array_slot] = filename_string_index;
+            }
+            array_slot++;
             last_line_number = line_number;
             last_filename = filename_string_index;
 
             if (array_slot == allocd_slots) {
                 allocd_slots *= 2;
-                line_report_store = MVM_realloc(line_report_store, sizeof(char) * allocd_slots);
+                if (counting) {
+                    slot_lines = MVM_realloc(slot_lines, sizeof(MVMint64) * allocd_slots);
+                    slot_files = MVM_realloc(slot_files, sizeof(MVMint64) * allocd_slots);
+                }
+                else {
+                    line_report_store = MVM_realloc(line_report_store, sizeof(char) * allocd_slots);
+                }
             }
         }
 
@@ -210,17 +279,28 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
                         break;
                     }
 
-                    log_ins = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
-                    log_ins->info        = MVM_op_get_op(MVM_OP_coverage_log);
-                    log_ins->operands    = MVM_spesh_alloc(tc, g, 4 * sizeof(MVMSpeshOperand));
-
-                    log_ins->operands[0].lit_str_idx = ann->data.lineno.filename_string_index;
-                    log_ins->operands[1].lit_i32 = ann->data.lineno.line_number;
-                    log_ins->operands[2].lit_i32 = array_slot++;
+                    log_ins = make_coverage_ins(tc, g, ann->data.lineno.filename_string_index,
+                        ann->data.lineno.line_number, array_slot);
+                    if (counting) {
+                        /* A counter that is never bumped would claim the
+                         * line was never hit, so put it in place. */
+                        slot_lines[array_slot] = ann->data.lineno.line_number;
+                        slot_files[array_slot] = ann->data.lineno.filename_string_index;
+                        MVM_spesh_manipulate_insert_ins(tc, bb, ins->prev, log_ins);
+                    }
+                    array_slot++;
+                    last_line_number = ann->data.lineno.line_number;
+                    last_filename = ann->data.lineno.filename_string_index;
 
                     if (array_slot == allocd_slots) {
                         allocd_slots *= 2;
-                        line_report_store = MVM_realloc(line_report_store, sizeof(char) * allocd_slots);
+                        if (counting) {
+                            slot_lines = MVM_realloc(slot_lines, sizeof(MVMint64) * allocd_slots);
+                            slot_files = MVM_realloc(slot_files, sizeof(MVMint64) * allocd_slots);
+                        }
+                        else {
+                            line_report_store = MVM_realloc(line_report_store, sizeof(char) * allocd_slots);
+                        }
                     }
 
                     to_fixup[fixup_elems++] = log_ins;
@@ -240,6 +320,18 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
         bb = bb->linear_next;
     }
 
+    if (counting) {
+        MVMuint64 *counts = array_slot
+            ? register_counters(tc, g, array_slot, slot_lines, slot_files)
+            : NULL;
+        for (fixup_idx = 0; fixup_idx < fixup_elems; fixup_idx++)
+            to_fixup[fixup_idx]->operands[1].lit_i64 = (uintptr_t)counts;
+        MVM_free(slot_lines);
+        MVM_free(slot_files);
+        MVM_free(to_fixup);
+        return;
+    }
+
     line_report_store = MVM_realloc(line_report_store, sizeof(char) * (array_slot + 1));
 
     for (fixup_idx = 0; fixup_idx < fixup_elems; fixup_idx++) {
@@ -319,3 +411,86 @@ void MVM_line_coverage_report(MVMThreadContext *tc, MVMString *filename, MVMuint
         MVM_free(encoded_filename);
     }
 }
+
+/* One line's worth of counts, for sorting and merging before output. */
+typedef struct {
+    const char *filename;
+    MVMuint32   line;
+    MVMuint64   count;
+} CoverageLine;
+
+static int compare_coverage_lines(const void *a, const void *b) {
+    const CoverageLine *la = (const CoverageLine *)a;
+    const CoverageLine *lb = (const CoverageLine *)b;
+    int cmp = strcmp(la->filename, lb->filename);
+    if (cmp)
+        return cmp;
+    return la->line < lb->line ? -1 : la->line > lb->line ? 1 : 0;
+}
+
+/* Writes the counters of all frames instrumented for counting out to the
+ * coverage log in LCOV tracefile format. A line that shows up in more than
+ * one frame (or more than once in a frame) gets the sum of its counts. */
+void MVM_line_coverage_dump_counts(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    FILE *fh = instance->coverage_log_fh;
+    MVMLineCoverageCounters *counters;
+    CoverageLine *lines;
+    size_t num_lines = 0;
+    size_t i = 0;
+
+    uv_mutex_lock(&instance->mutex_coverage_counters);
+    for (counters = instance->coverage_counters; counters; counters = counters->next)
+        num_lines += counters->num_slots;
+    lines = MVM_malloc((num_lines ? num_lines : 1) * sizeof(CoverageLine));
+    for (counters = instance->coverage_counters; counters; counters = counters->next) {
+        MVMuint32 slot;
+        for (slot = 0; slot < counters->num_slots; slot++) {
+            lines[i].filename = counters->filenames[counters->files[slot]];
+            lines[i].line     = counters->lines[slot];
+            lines[i].count    = counters->counts[slot];
+            i++;
+        }
+    }
+    qsort(lines, num_lines, sizeof(CoverageLine), compare_coverage_lines);
+
+    i = 0;
+    while (i < num_lines) {
+        const char *filename = lines[i].filename;
+        MVMuint32 found = 0;
+        MVMuint32 hit = 0;
+        fprintf(fh, "TN:\nSF:%s\n", filename);
+        while (i < num_lines && strcmp(lines[i].filename, filename) == 0) {
+            MVMuint32 line = lines[i].line;
+            MVMuint64 count = 0;
+            while (i < num_lines && lines[i].line == line && strcmp(lines[i].filename, filename) == 0)
+                count += lines[i++].count;
+            fprintf(fh, "DA:%"PRIu32",%"PRIu64"\n", line, count);
+            found++;
+            if (count)
+                hit++;
+        }
+        fprintf(fh, "LF:%"PRIu32"\nLH:%"PRIu32"\nend_of_record\n", found, hit);
+    }
+    fflush(fh);
+    MVM_free(lines);
+    uv_mutex_unlock(&instance->mutex_coverage_counters);
+}
+
+/* Frees the coverage counters. Only safe once no more code will run. */
+void MVM_line_coverage_destroy_counts(MVMThreadContext *tc) {
+    MVMLineCoverageCounters *counters = tc->instance->coverage_counters;
+    while (counters) {
+        MVMLineCoverageCounters *next = counters->next;
+        MVMuint32 i;
+        for (i = 0; i < counters->num_filenames; i++)
+            MVM_free(counters->filenames[i]);
+        MVM_free(counters->filenames);
+        MVM_free(counters->counts);
+        MVM_free(counters->lines);
+        MVM_free(counters->files);
+        MVM_free(counters);
+        counters = next;
+    }
+    tc->instance->coverage_counters = NULL;
+}
@@ -1,4 +1,24 @@
+/* When coverage is recorded as counts, each instrumented static frame gets
+ * one of these. The coverage_count instructions bump the counter for their
+ * slot, and the whole lot is written out once at exit. */
+struct MVMLineCoverageCounters {
+    /* Hit counter, line number and index into filenames of each slot. */
+    MVMuint64 *counts;
+    MVMuint32 *lines;
+    MVMuint32 *files;
+    MVMuint32  num_slots;
+
+    /* The (UTF-8 encoded) filenames the slots refer to. */
+    char     **filenames;
+    MVMuint32  num_filenames;
+
+    /* Next set of counters in the instance-wide list. */
+    MVMLineCoverageCounters *next;
+};
+
 void MVM_line_coverage_instrument(MVMThreadContext *tc, MVMStaticFrame *static_frame);
 void MVM_line_coverage_report(MVMThreadContext *tc, MVMString *filename, MVMuint32 line_number, MVMuint16 cache_slot, char *cache);
 
 void MVM_breakpoint_instrument(MVMThreadContext *tc, MVMStaticFrame *static_frame);
+void MVM_line_coverage_dump_counts(MVMThreadContext *tc);
+void MVM_line_coverage_destroy_counts(MVMThreadContext *tc);
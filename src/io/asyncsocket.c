@@ -1,9 +1,22 @@
 #include "moar.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
 /* Data that we keep for an asynchronous socket handle. */
 typedef struct {
     /* The libuv handle to the socket. */
     uv_stream_t *handle;
+
+    /* The event loop the handle belongs to, which all work on the socket
+     * must be done on. */
+    MVMuint32 loop;
 } MVMIOAsyncSocketData;
 
 /* Info we convey about a read task. */
@@ -15,11 +28,28 @@ typedef struct {
     int               work_idx;
 } ReadInfo;
 
-/* Allocates a buffer of the suggested size. */
+/* Allocates a buffer of the suggested size. Unless that is bigger than a
+ * pooled read buffer, we take one of those from the event loop's pool, and
+ * can tell it is pooled later by its size. */
 static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-    size_t size = suggested_size > 0 ? suggested_size : 4;
-    buf->base   = MVM_malloc(size);
-    buf->len    = size;
+    if (suggested_size <= MVM_IO_READ_BUFFER_SIZE) {
+        ReadInfo *ri = (ReadInfo *)handle->data;
+        buf->base    = MVM_io_read_buffer_acquire(ri->tc);
+        buf->len     = MVM_IO_READ_BUFFER_SIZE;
+    }
+    else {
+        buf->base    = MVM_malloc(suggested_size);
+        buf->len     = suggested_size;
+    }
+}
+
+/* Frees a buffer from on_alloc that didn't get handed over to a buffer
+ * object. */
+static void free_read_buffer(const uv_buf_t *buf) {
+    if (buf->len == MVM_IO_READ_BUFFER_SIZE)
+        MVM_io_read_buffer_release(buf->base);
+    else
+        MVM_free(buf->base);
 }
 
 /* Callback used to simply free memory on close. */
@@ -43,12 +73,19 @@ static void on_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
                 tc->instance->boot_types.BOOTInt, ri->seq_number++);
             MVM_repr_push_o(tc, arr, seq_boxed);
 
-            /* Produce a buffer and push it. */
+            /* Produce a buffer and push it, handing over the read buffer
+             * unless nothing was read into it. */
             res_buf      = (MVMArray *)MVM_repr_alloc_init(tc, ri->buf_type);
-            res_buf->body.slots.i8 = (MVMint8 *)buf->base;
-            res_buf->body.start    = 0;
-            res_buf->body.ssize    = buf->len;
-            res_buf->body.elems    = nread;
+            if (nread > 0) {
+                res_buf->body.slots.i8 = (MVMint8 *)buf->base;
+                res_buf->body.start    = 0;
+                res_buf->body.ssize    = buf->len;
+                res_buf->body.elems    = nread;
+                res_buf->body.pooled   = buf->len == MVM_IO_READ_BUFFER_SIZE;
+            }
+            else {
+                free_read_buffer(buf);
+            }
             MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
 
             /* Finally, no error. */
@@ -79,14 +116,14 @@ static void on_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
             });
         }
         if (buf->base)
-            MVM_free(buf->base);
+            free_read_buffer(buf);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
         if (conn_handle && !uv_is_closing(conn_handle)) {
             handle_data->handle = NULL;
             uv_close(conn_handle, free_on_close_cb);
         }
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
 }
 
 /* Does setup work for setting up asynchronous reads. */
@@ -111,7 +148,7 @@ static void read_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_t
             });
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
-            MVM_repr_push_o(tc, t->body.queue, arr);
+            MVM_io_eventloop_send(tc, t->body.queue, arr);
         });
         return;
     }
@@ -136,7 +173,7 @@ static void read_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_t
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -184,7 +221,7 @@ static MVMAsyncTask * read_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject
     if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
         MVM_exception_throw_adhoc(tc,
             "asyncreadbytes target queue must have ConcBlockingQueue REPR (got %s)",
-             MVM_6model_get_stable_debug_name(tc, queue->st));
+             MVM_6model_get_stable_debug_name(tc, STABLE(queue)));
     if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
         MVM_exception_throw_adhoc(tc,
             "asyncreadbytes result type must have REPR AsyncTask");
@@ -209,9 +246,10 @@ static MVMAsyncTask * read_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject
     MVM_ASSIGN_REF(tc, &(task->common.header), ri->handle, h);
     task->body.data = ri;
 
-    /* Hand the task off to the event loop. */
+    /* Hand the task off to the socket's event loop. */
     MVMROOT(tc, task, {
-        MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+            ((MVMIOAsyncSocketData *)h->body.data)->loop);
     });
 
     return task;
@@ -225,6 +263,12 @@ typedef struct {
     uv_buf_t          buf;
     MVMThreadContext *tc;
     int               work_idx;
+
+    /* When writing a list of buffers, the uv_buf_t for each of them, and
+     * how many bytes they come to in all. */
+    uv_buf_t         *bufs;
+    MVMuint32         num_bufs;
+    MVMuint64         total;
 } WriteInfo;
 
 /* Completion handler for an asynchronous write. */
@@ -238,7 +282,7 @@ static void on_write(uv_write_t *req, int status) {
         MVMROOT2(tc, arr, t, {
             MVMObject *bytes_box = MVM_repr_box_int(tc,
                 tc->instance->boot_types.BOOTInt,
-                wi->buf.len);
+                wi->bufs ? wi->total : wi->buf.len);
             MVM_repr_push_o(tc, arr, bytes_box);
         });
         MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
@@ -253,7 +297,7 @@ static void on_write(uv_write_t *req, int status) {
             MVM_repr_push_o(tc, arr, msg_box);
         });
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
     MVM_free(wi->req);
     MVM_io_eventloop_remove_active_work(tc, &(wi->work_idx));
 }
@@ -281,7 +325,7 @@ static void write_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
         return;
     }
@@ -290,17 +334,23 @@ static void write_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
     wi->tc = tc;
     wi->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
 
-    /* Extract buf data. */
-    buffer = (MVMArray *)wi->buf_data;
-    output = (char *)(buffer->body.slots.i8 + buffer->body.start);
-    output_size = (int)buffer->body.elems;
-
     /* Create and initialize write request. */
     wi->req           = MVM_malloc(sizeof(uv_write_t));
-    wi->buf           = uv_buf_init(output, output_size);
     wi->req->data     = data;
 
-    if ((r = uv_write(wi->req, handle_data->handle, &(wi->buf), 1, on_write)) < 0) {
+    /* Extract buf data; a list of buffers was gathered up front, and goes
+     * out in a single write. */
+    if (wi->bufs) {
+        r = uv_write(wi->req, handle_data->handle, wi->bufs, wi->num_bufs, on_write);
+    }
+    else {
+        buffer = (MVMArray *)wi->buf_data;
+        output = (char *)(buffer->body.slots.i8 + buffer->body.start);
+        output_size = (int)buffer->body.elems;
+        wi->buf = uv_buf_init(output, output_size);
+        r = uv_write(wi->req, handle_data->handle, &(wi->buf), 1, on_write);
+    }
+    if (r < 0) {
         /* Error; need to notify. */
         MVMROOT(tc, async_task, {
             MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
@@ -313,7 +363,7 @@ static void write_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
 
         /* Cleanup handle. */
@@ -331,8 +381,10 @@ static void write_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *workl
 
 /* Frees info for a write task. */
 static void write_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
-    if (data)
+    if (data) {
+        MVM_free(((WriteInfo *)data)->bufs);
         MVM_free(data);
+    }
 }
 
 /* Operations table for async write task. */
@@ -358,7 +410,8 @@ static MVMAsyncTask * write_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObjec
             "asyncwritebytes result type must have REPR AsyncTask");
     if (!IS_CONCRETE(buffer) || REPR(buffer)->ID != MVM_REPR_ID_VMArray)
         MVM_exception_throw_adhoc(tc, "asyncwritebytes requires a native array to read from");
-    if (((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type != MVM_ARRAY_U8
+    if (!MVM_io_is_buffer_list(tc, buffer)
+        && ((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type != MVM_ARRAY_U8
         && ((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type != MVM_ARRAY_I8)
         MVM_exception_throw_adhoc(tc, "asyncwritebytes requires a native array of uint8 or int8");
 
@@ -374,9 +427,22 @@ static MVMAsyncTask * write_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObjec
     MVM_ASSIGN_REF(tc, &(task->common.header), wi->buf_data, buffer);
     task->body.data = wi;
 
-    /* Hand the task off to the event loop. */
+    /* For a list of buffers, gather them now, so we can complain about any
+     * that are not byte buffers; the task frees them if we do. */
+    if (MVM_io_is_buffer_list(tc, buffer)) {
+        MVMuint64 elems = ((MVMArray *)buffer)->body.elems;
+        MVMuint32 i;
+        wi->bufs     = MVM_malloc((elems ? elems : 1) * sizeof(uv_buf_t));
+        wi->num_bufs = MVM_io_buffer_list_bufs(tc, buffer, 0, wi->bufs,
+            (MVMuint32)elems, "asyncwritebytes");
+        for (i = 0; i < wi->num_bufs; i++)
+            wi->total += wi->bufs[i].len;
+    }
+
+    /* Hand the task off to the socket's event loop. */
     MVMROOT(tc, task, {
-        MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+            ((MVMIOAsyncSocketData *)h->body.data)->loop);
     });
 
     return task;
@@ -431,7 +497,8 @@ static MVMint64 close_socket(MVMThreadContext *tc, MVMOSHandle *h) {
     ci = MVM_calloc(1, sizeof(CloseInfo));
     MVM_ASSIGN_REF(tc, &(task->common.header), ci->handle, h);
     task->body.data = ci;
-    MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+    MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+        ((MVMIOAsyncSocketData *)h->body.data)->loop);
 
     return 0;
 }
@@ -439,7 +506,7 @@ static MVMint64 close_socket(MVMThreadContext *tc, MVMOSHandle *h) {
 static MVMint64 socket_is_tty(MVMThreadContext *tc, MVMOSHandle *h) {
     MVMIOAsyncSocketData *data   = (MVMIOAsyncSocketData *)h->body.data;
     uv_handle_t          *handle = (uv_handle_t *)data->handle;
-    return (MVMint64)(handle->type == UV_TTY);
+    return handle ? (MVMint64)(handle->type == UV_TTY) : 0;
 }
 
 static MVMint64 socket_handle(MVMThreadContext *tc, MVMOSHandle *h) {
@@ -448,6 +515,8 @@ static MVMint64 socket_handle(MVMThreadContext *tc, MVMOSHandle *h) {
     int        fd;
     uv_os_fd_t fh;
 
+    if (!handle)
+        return -1;
     uv_fileno(handle, &fh);
     fd = uv_open_osfhandle(fh);
     return (MVMint64)fd;
@@ -519,8 +588,24 @@ typedef struct {
     uv_connect_t     *connect;
     MVMThreadContext *tc;
     int               work_idx;
+
+    /* The host name and port to connect to, if they are still to be
+     * resolved on the event loop, and the request doing it. */
+    char             *host;
+    MVMint64          port;
+    uv_getaddrinfo_t *resolve;
 } ConnectInfo;
 
+/* The hints we resolve host names to connect to with; these match the ones
+ * MVM_io_resolve_host_name uses for a stream socket of unspecified family. */
+static void connect_hints(struct addrinfo *hints) {
+    memset(hints, 0, sizeof(struct addrinfo));
+    hints->ai_flags    = AI_ADDRCONFIG | AI_NUMERICSERV | AI_PASSIVE;
+    hints->ai_family   = AF_UNSPEC;
+    hints->ai_socktype = SOCK_STREAM;
+    hints->ai_protocol = 0;
+}
+
 /* When a connection takes place, need to send result. */
 static void on_connect(uv_connect_t* req, int status) {
     ConnectInfo      *ci  = (ConnectInfo *)req->data;
@@ -534,6 +619,7 @@ static void on_connect(uv_connect_t* req, int status) {
             MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
             MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
             data->handle                 = (uv_stream_t *)ci->socket;
+            data->loop                   = MVM_io_eventloop_current(tc);
             result->body.ops             = &op_table;
             result->body.data            = data;
             MVM_repr_push_o(tc, arr, (MVMObject *)result);
@@ -564,50 +650,101 @@ static void on_connect(uv_connect_t* req, int status) {
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
         });
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
     MVM_free(req);
     MVM_io_eventloop_remove_active_work(tc, &(ci->work_idx));
 }
 
-/* Initilalize the connection on the event loop. */
-static void connect_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
-    int r;
+/* Reports that a connection could not be made, and gives up on it. */
+static void connect_failed(MVMThreadContext *tc, ConnectInfo *ci, const char *message) {
+    MVMAsyncTask *t = MVM_io_eventloop_get_active_work(tc, ci->work_idx);
+    MVMROOT(tc, t, {
+        MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVM_repr_push_o(tc, arr, t->body.schedulee);
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTIO);
+        MVMROOT(tc, arr, {
+            MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
+                tc->instance->VMString, message);
+            MVMObject *msg_box = MVM_repr_box_str(tc,
+                tc->instance->boot_types.BOOTStr, msg_str);
+            MVM_repr_push_o(tc, arr, msg_box);
+            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+        });
+        MVM_io_eventloop_send(tc, t->body.queue, arr);
+    });
+    MVM_io_eventloop_remove_active_work(tc, &(ci->work_idx));
+}
 
-    /* Add to work in progress. */
-    ConnectInfo *ci = (ConnectInfo *)data;
-    ci->tc        = tc;
-    ci->work_idx  = MVM_io_eventloop_add_active_work(tc, async_task);
+/* Starts connecting, once we have an address to connect to. */
+static void start_connect(MVMThreadContext *tc, uv_loop_t *loop, ConnectInfo *ci) {
+    int r;
 
     /* Create and initialize socket and connection. */
     ci->socket        = MVM_malloc(sizeof(uv_tcp_t));
     ci->connect       = MVM_malloc(sizeof(uv_connect_t));
-    ci->connect->data = data;
+    ci->connect->data = ci;
     if ((r = uv_tcp_init(loop, ci->socket)) < 0 ||
         (r = uv_tcp_connect(ci->connect, ci->socket, ci->dest, on_connect)) < 0) {
-        /* Error; need to notify. */
-        MVMROOT(tc, async_task, {
-            MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
-            MVM_repr_push_o(tc, arr, ((MVMAsyncTask *)async_task)->body.schedulee);
-            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTIO);
-            MVMROOT(tc, arr, {
-                MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
-                    tc->instance->VMString, uv_strerror(r));
-                MVMObject *msg_box = MVM_repr_box_str(tc,
-                    tc->instance->boot_types.BOOTStr, msg_str);
-                MVM_repr_push_o(tc, arr, msg_box);
-                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
-                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
-                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
-                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
-            });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
-        });
-
-        /* Cleanup handles. */
+        /* Cleanup handles; then we need to notify. */
         MVM_free_null(ci->connect);
         uv_close((uv_handle_t *)ci->socket, free_on_close_cb);
         ci->socket = NULL;
-        MVM_io_eventloop_remove_active_work(tc, &(ci->work_idx));
+        connect_failed(tc, ci, uv_strerror(r));
+    }
+}
+
+/* Called on the event loop when the host name we are to connect to has been
+ * resolved (or failed to). The address goes into the cache, if enabled. */
+static void on_resolved(uv_getaddrinfo_t *req, int status, struct addrinfo *res) {
+    ConnectInfo      *ci = (ConnectInfo *)req->data;
+    MVMThreadContext *tc = ci->tc;
+    MVM_free_null(ci->resolve);
+    if (status < 0 || !res) {
+        char message[256];
+        snprintf(message, sizeof(message), "Failed to resolve host name '%s'.\nError: %s",
+            ci->host, status < 0 ? uv_strerror(status) : "no addresses");
+        if (res)
+            uv_freeaddrinfo(res);
+        connect_failed(tc, ci, message);
+        return;
+    }
+    {
+        struct addrinfo hints;
+        connect_hints(&hints);
+        ci->dest = MVM_malloc(res->ai_addrlen);
+        memcpy(ci->dest, res->ai_addr, res->ai_addrlen);
+        MVM_io_dns_cache_add(tc, ci->host, ci->port, &hints, ci->dest, res->ai_addrlen);
+        uv_freeaddrinfo(res);
+    }
+    start_connect(tc, req->loop, ci);
+}
+
+/* Initilalize the connection on the event loop, resolving the host name
+ * first unless it was in the cache. */
+static void connect_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    /* Add to work in progress. */
+    ConnectInfo *ci = (ConnectInfo *)data;
+    ci->tc        = tc;
+    ci->work_idx  = MVM_io_eventloop_add_active_work(tc, async_task);
+
+    if (ci->dest) {
+        start_connect(tc, loop, ci);
+    }
+    else {
+        struct addrinfo hints;
+        char            port_cstr[8];
+        int             r;
+        connect_hints(&hints);
+        snprintf(port_cstr, 8, "%d", (int)ci->port);
+        ci->resolve       = MVM_malloc(sizeof(uv_getaddrinfo_t));
+        ci->resolve->data = ci;
+        if ((r = uv_getaddrinfo(loop, ci->resolve, on_resolved, ci->host, port_cstr, &hints)) < 0) {
+            MVM_free_null(ci->resolve);
+            connect_failed(tc, ci, uv_strerror(r));
+        }
     }
 }
 
@@ -617,6 +754,7 @@ static void connect_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
         ConnectInfo *ci = (ConnectInfo *)data;
         if (ci->dest)
             MVM_free(ci->dest);
+        MVM_free(ci->host);
         MVM_free(ci);
     }
 }
@@ -634,8 +772,10 @@ static const MVMAsyncTaskOps connect_op_table = {
 MVMObject * MVM_io_socket_connect_async(MVMThreadContext *tc, MVMObject *queue,
                                         MVMObject *schedulee, MVMString *host,
                                         MVMint64 port, MVMObject *async_type) {
-    MVMAsyncTask *task;
-    ConnectInfo  *ci;
+    MVMAsyncTask    *task;
+    ConnectInfo     *ci;
+    struct addrinfo  hints;
+    char            *host_cstr;
     struct sockaddr *dest;
 
     /* Validate REPRs. */
@@ -646,10 +786,11 @@ MVMObject * MVM_io_socket_connect_async(MVMThreadContext *tc, MVMObject *queue,
         MVM_exception_throw_adhoc(tc,
             "asyncconnect result type must have REPR AsyncTask");
 
-    /* Resolve hostname. (Could be done asynchronously too.) */
-    MVMROOT3(tc, queue, schedulee, async_type, {
-        dest = MVM_io_resolve_host_name(tc, host, port, MVM_SOCKET_FAMILY_UNSPEC, MVM_SOCKET_TYPE_STREAM, MVM_SOCKET_PROTOCOL_ANY, 0);
-    });
+    /* The host name is resolved on the event loop, unless we resolved it
+     * recently enough to have it in the cache. */
+    host_cstr = MVM_string_utf8_encode_C_string(tc, host);
+    connect_hints(&hints);
+    dest = MVM_io_dns_cache_lookup(tc, host_cstr, port, &hints);
 
     /* Create async task handle. */
     MVMROOT2(tc, queue, schedulee, {
@@ -660,11 +801,13 @@ MVMObject * MVM_io_socket_connect_async(MVMThreadContext *tc, MVMObject *queue,
     task->body.ops  = &connect_op_table;
     ci              = MVM_calloc(1, sizeof(ConnectInfo));
     ci->dest        = dest;
+    ci->host        = host_cstr;
+    ci->port        = port;
     task->body.data = ci;
 
-    /* Hand the task off to the event loop. */
+    /* Hand the task off to the next event loop in turn. */
     MVMROOT(tc, task, {
-        MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task, MVM_io_eventloop_pick(tc));
     });
 
     return (MVMObject *)task;
@@ -680,6 +823,100 @@ typedef struct {
 } ListenInfo;
 
 
+#ifndef _WIN32
+/* Info we convey about a task that opens an accepted connection on the event
+ * loop it was handed to. */
+typedef struct {
+    MVMOSHandle *handle;
+    int          fd;
+} AdoptInfo;
+
+/* Opens a handle for the connection on this loop. If that fails, the socket
+ * is left without one, so it acts as if it were closed. */
+static void adopt_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    AdoptInfo            *ai          = (AdoptInfo *)data;
+    MVMIOAsyncSocketData *handle_data = (MVMIOAsyncSocketData *)ai->handle->body.data;
+    uv_tcp_t             *socket      = MVM_malloc(sizeof(uv_tcp_t));
+    if (uv_tcp_init(loop, socket) < 0) {
+        close(ai->fd);
+        MVM_free(socket);
+    }
+    else if (uv_tcp_open(socket, ai->fd) < 0) {
+        close(ai->fd);
+        uv_close((uv_handle_t *)socket, free_on_close_cb);
+    }
+    else {
+        handle_data->handle = (uv_stream_t *)socket;
+    }
+    ai->fd = -1;
+}
+
+/* Marks objects for an adopt task. */
+static void adopt_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    AdoptInfo *ai = (AdoptInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &ai->handle);
+}
+
+/* Frees info for an adopt task, closing the descriptor if it never made it
+ * to the loop. */
+static void adopt_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    if (data) {
+        AdoptInfo *ai = (AdoptInfo *)data;
+        if (ai->fd >= 0)
+            close(ai->fd);
+        MVM_free(ai);
+    }
+}
+
+/* Operations table for async adopt task. */
+static const MVMAsyncTaskOps adopt_op_table = {
+    adopt_setup,
+    NULL,
+    NULL,
+    adopt_gc_mark,
+    adopt_gc_free
+};
+#endif
+
+/* With several event loops, hands an accepted connection over to the next
+ * one in turn, unless that is this one, by closing the handle here and
+ * having the other loop open a duplicate of the descriptor. The task that
+ * opens it is queued before the HLL sees the socket, so any work on the
+ * socket is queued after it on the same loop and finds it open. */
+static void hand_off(MVMThreadContext *tc, MVMOSHandle *result, uv_tcp_t *client) {
+#ifndef _WIN32
+    MVMIOAsyncSocketData *data = (MVMIOAsyncSocketData *)result->body.data;
+    MVMAsyncTask         *task;
+    AdoptInfo            *ai;
+    MVMuint32             target;
+    uv_os_fd_t            fd;
+    int                   dup_fd;
+
+    if (tc->instance->num_event_loops == 1)
+        return;
+    target = MVM_io_eventloop_pick(tc);
+    if (target == data->loop)
+        return;
+    if (uv_fileno((uv_handle_t *)client, &fd) != 0 || (dup_fd = dup(fd)) < 0)
+        return;
+
+    data->handle = NULL;
+    data->loop   = target;
+    uv_close((uv_handle_t *)client, free_on_close_cb);
+
+    MVMROOT(tc, result, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc,
+            tc->instance->boot_types.BOOTAsync);
+    });
+    task->body.ops  = &adopt_op_table;
+    ai              = MVM_calloc(1, sizeof(AdoptInfo));
+    MVM_ASSIGN_REF(tc, &(task->common.header), ai->handle, result);
+    ai->fd          = dup_fd;
+    task->body.data = ai;
+    MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task, target);
+#endif
+}
+
 /* Handles an incoming connection. */
 static void on_connection(uv_stream_t *server, int status) {
     ListenInfo       *li     = (ListenInfo *)server->data;
@@ -702,6 +939,7 @@ static void on_connection(uv_stream_t *server, int status) {
                 MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
                 MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
                 data->handle                 = (uv_stream_t *)client;
+                data->loop                   = MVM_io_eventloop_current(tc);
                 result->body.ops             = &op_table;
                 result->body.data            = data;
 
@@ -716,6 +954,7 @@ static void on_connection(uv_stream_t *server, int status) {
                 MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
                 MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
                 data->handle                 = (uv_stream_t *)li->socket;
+                data->loop                   = MVM_io_eventloop_current(tc);
                 result->body.ops             = &op_table;
                 result->body.data            = data;
 
@@ -724,6 +963,8 @@ static void on_connection(uv_stream_t *server, int status) {
                 uv_tcp_getsockname(client, (struct sockaddr *)&sockaddr, &name_len);
                 push_name_and_port(tc, &sockaddr, arr);
             }
+
+            hand_off(tc, (MVMOSHandle *)MVM_repr_at_pos_o(tc, arr, 1), client);
         });
     }
     else {
@@ -743,7 +984,7 @@ static void on_connection(uv_stream_t *server, int status) {
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
         });
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
 }
 
 /* Sets up a socket listener. */
@@ -779,7 +1020,7 @@ static void listen_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async
                 MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
                 MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
         uv_close((uv_handle_t *)li->socket, free_on_close_cb);
         li->socket = NULL;
@@ -805,6 +1046,7 @@ static void listen_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async
                 MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
                 MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
                 data->handle                 = (uv_stream_t *)li->socket;
+                data->loop                   = MVM_io_eventloop_current(tc);
                 result->body.ops             = &op_table;
                 result->body.data            = data;
 
@@ -813,7 +1055,7 @@ static void listen_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async
                 uv_tcp_getsockname(li->socket, (struct sockaddr *)&sockaddr, &name_len);
                 push_name_and_port(tc, &sockaddr, arr);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
     }
 }
@@ -886,10 +1128,255 @@ MVMObject * MVM_io_socket_listen_async(MVMThreadContext *tc, MVMObject *queue,
     li->backlog     = backlog;
     task->body.data = li;
 
-    /* Hand the task off to the event loop. */
+    /* Hand the task off to the next event loop in turn. */
+    MVMROOT(tc, task, {
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task, MVM_io_eventloop_pick(tc));
+    });
+
+    return (MVMObject *)task;
+}
+
+#ifndef _WIN32
+/* Size of each transfer a send file task asks the kernel for, so that we
+ * notice errors and a full socket buffer in good time. */
+#define SENDFILE_CHUNK_SIZE (1024 * 1024)
+
+/* Info we convey about a send file task. */
+typedef struct {
+    MVMOSHandle      *handle;
+    MVMObject        *file;
+    int               out_fd;
+    int               in_fd;
+    MVMint64          offset;
+    MVMint64          remaining;
+    MVMint64          sent;
+    int               error;
+    uv_work_t         req;
+    MVMThreadContext *tc;
+    int               work_idx;
+} SendFileInfo;
+
+/* The socket is non-blocking, since libuv owns it; when its buffer is full,
+ * the worker waits for room here rather than spinning. */
+static void wait_writable(int fd) {
+    struct pollfd pfd;
+    pfd.fd     = fd;
+    pfd.events = POLLOUT;
+    while (poll(&pfd, 1, -1) == -1 && errno == EINTR)
+        ;
+}
+
+#ifndef __linux__
+/* Writes all of a buffer read from the file to the socket. */
+static ssize_t write_all(int fd, char *buf, size_t bytes) {
+    size_t written = 0;
+    while (written < bytes) {
+        ssize_t r = write(fd, buf + written, bytes - written);
+        if (r == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                wait_writable(fd);
+            else if (errno != EINTR)
+                return -1;
+            continue;
+        }
+        written += r;
+    }
+    return written;
+}
+#endif
+
+/* Runs on a libuv thread pool thread, and so must not touch any objects.
+ * On Linux, sendfile moves the data from the file to the socket without it
+ * ever being copied into user space; elsewhere, we fall back to reading and
+ * writing it here, which at least keeps it off the event loop thread. */
+static void sendfile_work(uv_work_t *req) {
+    SendFileInfo *si  = (SendFileInfo *)req->data;
+#ifndef __linux__
+    char         *buf = MVM_malloc(SENDFILE_CHUNK_SIZE);
+#endif
+    while (si->remaining != 0) {
+        size_t  want = si->remaining < 0 || si->remaining > SENDFILE_CHUNK_SIZE
+            ? SENDFILE_CHUNK_SIZE
+            : (size_t)si->remaining;
+        ssize_t r;
+#ifdef __linux__
+        off_t offset = (off_t)si->offset;
+        r = sendfile(si->out_fd, si->in_fd, &offset, want);
+        if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            wait_writable(si->out_fd);
+            continue;
+        }
+#else
+        r = pread(si->in_fd, buf, want, (off_t)si->offset);
+        if (r > 0 && write_all(si->out_fd, buf, r) == -1)
+            r = -1;
+#endif
+        if (r == -1) {
+            if (errno == EINTR)
+                continue;
+            si->error = uv_translate_sys_error(errno);
+            break;
+        }
+        if (r == 0)
+            break;
+        si->offset += r;
+        si->sent   += r;
+        if (si->remaining > 0)
+            si->remaining -= r;
+    }
+#ifndef __linux__
+    MVM_free(buf);
+#endif
+}
+
+/* Completion handler for a send file task; runs on the event loop. */
+static void on_sendfile(uv_work_t *req, int status) {
+    SendFileInfo     *si  = (SendFileInfo *)req->data;
+    MVMThreadContext *tc  = si->tc;
+    MVMObject        *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    MVMAsyncTask     *t   = MVM_io_eventloop_get_active_work(tc, si->work_idx);
+    MVM_repr_push_o(tc, arr, t->body.schedulee);
+    if (status == 0 && si->error == 0) {
+        MVMROOT2(tc, arr, t, {
+            MVMObject *bytes_box = MVM_repr_box_int(tc,
+                tc->instance->boot_types.BOOTInt, si->sent);
+            MVM_repr_push_o(tc, arr, bytes_box);
+        });
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+    }
+    else {
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+        MVMROOT2(tc, arr, t, {
+            MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
+                tc->instance->VMString, uv_strerror(status ? status : si->error));
+            MVMObject *msg_box = MVM_repr_box_str(tc,
+                tc->instance->boot_types.BOOTStr, msg_str);
+            MVM_repr_push_o(tc, arr, msg_box);
+        });
+    }
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
+    MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
+}
+
+/* Does setup work for a send file task. */
+static void sendfile_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    SendFileInfo         *si          = (SendFileInfo *)data;
+    MVMIOAsyncSocketData *handle_data = (MVMIOAsyncSocketData *)si->handle->body.data;
+    const char           *error       = NULL;
+    int                   r;
+    uv_os_fd_t            fh;
+
+    /* Ensure not closed, and find the socket's descriptor. */
+    if (!handle_data->handle || uv_is_closing((uv_handle_t *)handle_data->handle))
+        error = "Cannot send a file to a closed socket";
+    else if ((r = uv_fileno((uv_handle_t *)handle_data->handle, &fh)) < 0)
+        error = uv_strerror(r);
+
+    if (!error) {
+        si->out_fd   = (int)fh;
+        si->tc       = tc;
+        si->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
+        si->req.data = data;
+        if ((r = uv_queue_work(loop, &(si->req), sendfile_work, on_sendfile)) < 0) {
+            MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
+            error = uv_strerror(r);
+        }
+    }
+
+    if (error) {
+        MVMROOT(tc, async_task, {
+            MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+            MVM_repr_push_o(tc, arr, ((MVMAsyncTask *)async_task)->body.schedulee);
+            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+            MVMROOT(tc, arr, {
+                MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
+                    tc->instance->VMString, error);
+                MVMObject *msg_box = MVM_repr_box_str(tc,
+                    tc->instance->boot_types.BOOTStr, msg_str);
+                MVM_repr_push_o(tc, arr, msg_box);
+            });
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+        });
+    }
+}
+
+/* Marks objects for a send file task. */
+static void sendfile_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    SendFileInfo *si = (SendFileInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &si->handle);
+    MVM_gc_worklist_add(tc, worklist, &si->file);
+}
+
+/* Frees info for a send file task. */
+static void sendfile_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    if (data)
+        MVM_free(data);
+}
+
+/* Operations table for a send file task. */
+static const MVMAsyncTaskOps sendfile_op_table = {
+    sendfile_setup,
+    NULL,
+    NULL,
+    sendfile_gc_mark,
+    sendfile_gc_free
+};
+#endif
+
+/* Sends length bytes (or, if length is negative, the rest) of a file from
+ * the given offset to a socket, without the data passing through a buffer
+ * of ours. Completion is reported like that of asyncwritebytes. Nothing else
+ * should be written to the socket until it completes, nor the file closed. */
+MVMObject * MVM_io_socket_send_file_async(MVMThreadContext *tc, MVMObject *oshandle,
+        MVMObject *queue, MVMObject *schedulee, MVMObject *file, MVMObject *async_type,
+        MVMint64 offset, MVMint64 length) {
+#ifdef _WIN32
+    MVM_exception_throw_adhoc(tc, "asyncsendfile is not yet supported on this platform");
+#else
+    MVMOSHandle  *h = (MVMOSHandle *)oshandle;
+    MVMAsyncTask *task;
+    SendFileInfo *si;
+    MVMint64      in_fd;
+
+    /* Validate REPRs and arguments. */
+    if (REPR(oshandle)->ID != MVM_REPR_ID_MVMOSHandle || !IS_CONCRETE(oshandle)
+            || h->body.ops != &op_table)
+        MVM_exception_throw_adhoc(tc, "asyncsendfile requires an asynchronous socket");
+    if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
+        MVM_exception_throw_adhoc(tc,
+            "asyncsendfile target queue must have ConcBlockingQueue REPR");
+    if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
+        MVM_exception_throw_adhoc(tc,
+            "asyncsendfile result type must have REPR AsyncTask");
+    if (offset < 0)
+        MVM_exception_throw_adhoc(tc, "asyncsendfile offset must not be negative");
+    MVMROOT4(tc, queue, schedulee, h, async_type, {
+        in_fd = MVM_io_fileno(tc, file);
+    });
+    if (in_fd < 0)
+        MVM_exception_throw_adhoc(tc, "asyncsendfile requires an open file handle to send from");
+
+    /* Create async task handle. */
+    MVMROOT4(tc, queue, schedulee, h, file, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc, async_type);
+    });
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.queue, queue);
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.schedulee, schedulee);
+    task->body.ops  = &sendfile_op_table;
+    si              = MVM_calloc(1, sizeof(SendFileInfo));
+    MVM_ASSIGN_REF(tc, &(task->common.header), si->handle, h);
+    MVM_ASSIGN_REF(tc, &(task->common.header), si->file, file);
+    si->in_fd       = (int)in_fd;
+    si->offset      = offset;
+    si->remaining   = length < 0 ? -1 : length;
+    task->body.data = si;
+
+    /* Hand the task off to the socket's event loop. */
     MVMROOT(tc, task, {
-        MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+            ((MVMIOAsyncSocketData *)h->body.data)->loop);
     });
 
     return (MVMObject *)task;
+#endif
 }
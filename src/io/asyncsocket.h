@@ -2,3 +2,6 @@ MVMObject * MVM_io_socket_connect_async(MVMThreadContext *tc, MVMObject *queue,
     MVMObject *schedulee, MVMString *host, MVMint64 port, MVMObject *async_type);
 MVMObject * MVM_io_socket_listen_async(MVMThreadContext *tc, MVMObject *queue,
     MVMObject *schedulee, MVMString *host, MVMint64 port, MVMint32 backlog, MVMObject *async_type);
+MVMObject * MVM_io_socket_send_file_async(MVMThreadContext *tc, MVMObject *oshandle,
+    MVMObject *queue, MVMObject *schedulee, MVMObject *file, MVMObject *async_type,
+    MVMint64 offset, MVMint64 length);
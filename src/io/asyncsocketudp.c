@@ -3,6 +3,14 @@
 /* Number of bytes we accept per read. */
 #define CHUNK_SIZE 65536
 
+/* When libuv can receive a batch of datagrams with a single recvmmsg call,
+ * we ask it to; it reads up to as many of them as there are CHUNK_SIZE
+ * chunks in the buffer, calling on_read for each. */
+#if UV_VERSION_HEX >= 0x012800
+#define MVM_UDP_RECVMMSG 1
+#define RECV_BATCH_SIZE 32
+#endif
+
 /* Data that we keep for an asynchronous UDP socket handle. */
 typedef struct {
     /* The libuv handle to the socket. */
@@ -16,14 +24,29 @@ typedef struct {
     int               seq_number;
     MVMThreadContext *tc;
     int               work_idx;
+#ifdef MVM_UDP_RECVMMSG
+    char             *recv_buf;
+#endif
 } ReadInfo;
 
+#ifdef MVM_UDP_RECVMMSG
+/* Hands out the read's batch buffer, which is used for every receive; each
+ * datagram is copied out of it into a buffer of its own size. */
+static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+    ReadInfo *ri = (ReadInfo *)handle->data;
+    if (!ri->recv_buf)
+        ri->recv_buf = MVM_malloc(RECV_BATCH_SIZE * CHUNK_SIZE);
+    buf->base = ri->recv_buf;
+    buf->len  = RECV_BATCH_SIZE * CHUNK_SIZE;
+}
+#else
 /* Allocates a buffer of the suggested size. */
 static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
     size_t size = suggested_size > 0 ? suggested_size : 4;
     buf->base   = MVM_malloc(size);
     buf->len    = size;
 }
+#endif
 
 /* Callback used to simply free memory on close. */
 static void free_on_close_cb(uv_handle_t *handle) {
@@ -82,7 +105,9 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
     /* libuv will call on_read once after all datagram read operations
      * to "give us back a buffer". in that case, nread and addr are NULL.
      * This is an artifact of the underlying implementation and we shouldn't
-     * pass it through to the user. */
+     * pass it through to the user. (With a batch buffer, that's also where
+     * libuv tells us it's done with it, which we can ignore, as we reuse
+     * it.) */
 
     if (nread == 0 && addr == NULL)
         return;
@@ -102,9 +127,17 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
 
             /* Produce a buffer and push it. */
             res_buf      = (MVMArray *)MVM_repr_alloc_init(tc, ri->buf_type);
+#ifdef MVM_UDP_RECVMMSG
+            if (nread > 0) {
+                res_buf->body.slots.i8 = MVM_malloc(nread);
+                memcpy(res_buf->body.slots.i8, buf->base, nread);
+            }
+            res_buf->body.ssize    = nread;
+#else
             res_buf->body.slots.i8 = (MVMint8 *)buf->base;
-            res_buf->body.start    = 0;
             res_buf->body.ssize    = buf->len;
+#endif
+            res_buf->body.start    = 0;
             res_buf->body.elems    = nread;
             MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
 
@@ -125,8 +158,10 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
         });
+#ifndef MVM_UDP_RECVMMSG
         if (buf->base)
             MVM_free(buf->base);
+#endif
         uv_udp_recv_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -142,12 +177,14 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
         });
+#ifndef MVM_UDP_RECVMMSG
         if (buf->base)
             MVM_free(buf->base);
+#endif
         uv_udp_recv_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
 }
 
 /* Does setup work for setting up asynchronous reads. */
@@ -177,7 +214,7 @@ static void read_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_t
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
     }
 }
@@ -191,8 +228,12 @@ static void read_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *workli
 
 /* Frees info for a read task. */
 static void read_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
-    if (data)
+    if (data) {
+#ifdef MVM_UDP_RECVMMSG
+        MVM_free(((ReadInfo *)data)->recv_buf);
+#endif
         MVM_free(data);
+    }
 }
 
 /* Operations table for async read task. */
@@ -213,7 +254,7 @@ static MVMAsyncTask * read_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject
     if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
         MVM_exception_throw_adhoc(tc,
             "asyncreadbytes target queue must have ConcBlockingQueue REPR (got %s)",
-             MVM_6model_get_stable_debug_name(tc, queue->st));
+             MVM_6model_get_stable_debug_name(tc, STABLE(queue)));
     if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
         MVM_exception_throw_adhoc(tc,
             "asyncreadbytes result type must have REPR AsyncTask");
@@ -283,7 +324,7 @@ static void on_write(uv_udp_send_t *req, int status) {
             MVM_repr_push_o(tc, arr, msg_box);
         });
     }
-    MVM_repr_push_o(tc, t->body.queue, arr);
+    MVM_io_eventloop_send(tc, t->body.queue, arr);
     MVM_free(wi->req);
     MVM_io_eventloop_remove_active_work(tc, &(wi->work_idx));
 }
@@ -329,7 +370,7 @@ static void write_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+            MVM_io_eventloop_send(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
         });
 
         /* Cleanup handle. */
@@ -494,7 +535,12 @@ static void setup_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
     SocketSetupInfo *ssi = (SocketSetupInfo *)data;
     uv_udp_t *udp_handle = MVM_malloc(sizeof(uv_udp_t));
     int r;
-    if ((r = uv_udp_init(loop, udp_handle)) >= 0) {
+#ifdef MVM_UDP_RECVMMSG
+    r = uv_udp_init_ex(loop, udp_handle, AF_UNSPEC | UV_UDP_RECVMMSG);
+#else
+    r = uv_udp_init(loop, udp_handle);
+#endif
+    if (r >= 0) {
         if (ssi->bind_addr)
             r = uv_udp_bind(udp_handle, ssi->bind_addr, 0);
         if (r >= 0 && (ssi->flags & 1))
@@ -518,7 +564,7 @@ static void setup_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
             });
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
         });
-        MVM_repr_push_o(tc, t->body.queue, arr);
+        MVM_io_eventloop_send(tc, t->body.queue, arr);
     }
     else {
         /* Something failed; need to notify. */
@@ -534,7 +580,7 @@ static void setup_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
                     tc->instance->boot_types.BOOTStr, msg_str);
                 MVM_repr_push_o(tc, arr, msg_box);
             });
-            MVM_repr_push_o(tc, t->body.queue, arr);
+            MVM_io_eventloop_send(tc, t->body.queue, arr);
             uv_close((uv_handle_t *)udp_handle, free_on_close_cb);
         });
     }
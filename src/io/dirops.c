@@ -1,6 +1,12 @@
 #include "moar.h"
 #ifndef _WIN32
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
 #endif
 
 #ifdef _WIN32
@@ -363,3 +369,230 @@ void MVM_dir_close(MVMThreadContext *tc, MVMObject *oshandle) {
     data->dir_handle = NULL;
 #endif
 }
+
+/* Reading a whole directory at once. Entry types use libuv's numbering of
+ * them, so that the libuv-based version (used on Windows) needs no mapping. */
+#ifndef _WIN32
+static MVMint64 type_from_mode(mode_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFREG:  return MVM_DIR_ENTRY_FILE;
+        case S_IFDIR:  return MVM_DIR_ENTRY_DIR;
+        case S_IFLNK:  return MVM_DIR_ENTRY_LINK;
+        case S_IFIFO:  return MVM_DIR_ENTRY_FIFO;
+        case S_IFSOCK: return MVM_DIR_ENTRY_SOCKET;
+        case S_IFCHR:  return MVM_DIR_ENTRY_CHAR;
+        case S_IFBLK:  return MVM_DIR_ENTRY_BLOCK;
+        default:       return MVM_DIR_ENTRY_UNKNOWN;
+    }
+}
+
+#ifdef DT_UNKNOWN
+static MVMint64 type_from_d_type(unsigned char d_type) {
+    switch (d_type) {
+        case DT_REG:  return MVM_DIR_ENTRY_FILE;
+        case DT_DIR:  return MVM_DIR_ENTRY_DIR;
+        case DT_LNK:  return MVM_DIR_ENTRY_LINK;
+        case DT_FIFO: return MVM_DIR_ENTRY_FIFO;
+        case DT_SOCK: return MVM_DIR_ENTRY_SOCKET;
+        case DT_CHR:  return MVM_DIR_ENTRY_CHAR;
+        case DT_BLK:  return MVM_DIR_ENTRY_BLOCK;
+        default:      return MVM_DIR_ENTRY_UNKNOWN;
+    }
+}
+#endif
+
+/* Adds an entry of the directory open as dir_fd to the result lists. Stats
+ * are made relative to the directory, so the kernel needn't walk the path to
+ * it again; we make one anyway if the directory didn't tell us the type. */
+static void add_entry(MVMThreadContext *tc, MVMObject *names, MVMObject *types,
+                      MVMObject *stats, int dir_fd, const char *name, MVMint64 type,
+                      MVMint64 flags) {
+    struct stat st;
+    int         have_stat = 0;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+        return;
+    if (flags & MVM_DIR_READ_STAT) {
+        int at_flags = flags & MVM_DIR_READ_FOLLOW ? 0 : AT_SYMLINK_NOFOLLOW;
+        have_stat = fstatat(dir_fd, name, &st, at_flags) == 0;
+        if (type == MVM_DIR_ENTRY_UNKNOWN && have_stat && !(flags & MVM_DIR_READ_FOLLOW))
+            type = type_from_mode(st.st_mode);
+    }
+    if (type == MVM_DIR_ENTRY_UNKNOWN) {
+        struct stat type_st;
+        if (fstatat(dir_fd, name, &type_st, AT_SYMLINK_NOFOLLOW) == 0)
+            type = type_from_mode(type_st.st_mode);
+    }
+    MVM_repr_push_s(tc, names, MVM_string_utf8_c8_decode(tc, tc->instance->VMString,
+        name, strlen(name)));
+    MVM_repr_push_i(tc, types, type);
+    if (flags & MVM_DIR_READ_STAT) {
+        MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)st.st_size : -1);
+        MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)st.st_mode : -1);
+#if defined(__APPLE__)
+        MVM_repr_push_i(tc, stats, have_stat
+            ? (MVMint64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec : -1);
+#else
+        MVM_repr_push_i(tc, stats, have_stat
+            ? (MVMint64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec : -1);
+#endif
+        MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)st.st_ino : -1);
+        MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)st.st_dev : -1);
+    }
+}
+
+#ifdef __linux__
+/* What getdents64 fills its buffer with. */
+struct getdents64_entry {
+    MVMuint64      d_ino;
+    MVMint64       d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+};
+#define GETDENTS_BUFFER_SIZE 65536
+#endif
+
+/* Reads all of the directory open as dir_fd, closing it. Returns 0 on
+ * success and an errno value otherwise. */
+static int read_all_entries(MVMThreadContext *tc, MVMObject *names, MVMObject *types,
+                            MVMObject *stats, int dir_fd, MVMint64 flags) {
+#ifdef __linux__
+    /* Fetch as many entries per syscall as fit in a big buffer, rather than
+     * the few that readdir asks for at a time. */
+    char *buf = MVM_malloc(GETDENTS_BUFFER_SIZE);
+    int   error = 0;
+    while (1) {
+        long got = syscall(SYS_getdents64, dir_fd, buf, GETDENTS_BUFFER_SIZE);
+        long pos = 0;
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            error = errno;
+            break;
+        }
+        if (got == 0)
+            break;
+        while (pos < got) {
+            struct getdents64_entry *entry = (struct getdents64_entry *)(buf + pos);
+            add_entry(tc, names, types, stats, dir_fd, entry->d_name,
+                type_from_d_type(entry->d_type), flags);
+            pos += entry->d_reclen;
+        }
+    }
+    MVM_free(buf);
+    close(dir_fd);
+    return error;
+#else
+    DIR           *dir = fdopendir(dir_fd);
+    struct dirent *entry;
+    int            error;
+    if (!dir) {
+        error = errno;
+        close(dir_fd);
+        return error;
+    }
+    while (1) {
+        errno = 0;
+        if (!(entry = readdir(dir)))
+            break;
+#ifdef DT_UNKNOWN
+        add_entry(tc, names, types, stats, dir_fd, entry->d_name,
+            type_from_d_type(entry->d_type), flags);
+#else
+        add_entry(tc, names, types, stats, dir_fd, entry->d_name,
+            MVM_DIR_ENTRY_UNKNOWN, flags);
+#endif
+    }
+    error = errno;
+    closedir(dir);
+    return error;
+#endif
+}
+#else
+/* On Windows, libuv gives us the entries and their types, and we stat each
+ * of them through it if asked to. */
+static int read_all_entries(MVMThreadContext *tc, MVMObject *names, MVMObject *types,
+                            MVMObject *stats, const char *dir_name, MVMint64 flags) {
+    uv_fs_t     req;
+    uv_dirent_t entry;
+    int         r = uv_fs_scandir(NULL, &req, dir_name, 0, NULL);
+    if (r < 0) {
+        uv_fs_req_cleanup(&req);
+        return r;
+    }
+    while (uv_fs_scandir_next(&req, &entry) != UV_EOF) {
+        MVM_repr_push_s(tc, names, MVM_string_utf8_c8_decode(tc, tc->instance->VMString,
+            entry.name, strlen(entry.name)));
+        MVM_repr_push_i(tc, types, (MVMint64)entry.type);
+        if (flags & MVM_DIR_READ_STAT) {
+            uv_fs_t  stat_req;
+            size_t   dir_len  = strlen(dir_name);
+            size_t   name_len = strlen(entry.name);
+            char    *path     = MVM_malloc(dir_len + name_len + 2);
+            int      have_stat;
+            memcpy(path, dir_name, dir_len);
+            path[dir_len] = '/';
+            memcpy(path + dir_len + 1, entry.name, name_len + 1);
+            have_stat = (flags & MVM_DIR_READ_FOLLOW
+                ? uv_fs_stat(NULL, &stat_req, path, NULL)
+                : uv_fs_lstat(NULL, &stat_req, path, NULL)) == 0;
+            MVM_free(path);
+            MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)stat_req.statbuf.st_size : -1);
+            MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)stat_req.statbuf.st_mode : -1);
+            MVM_repr_push_i(tc, stats, have_stat
+                ? (MVMint64)stat_req.statbuf.st_mtim.tv_sec * 1000000000
+                    + stat_req.statbuf.st_mtim.tv_nsec
+                : -1);
+            MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)stat_req.statbuf.st_ino : -1);
+            MVM_repr_push_i(tc, stats, have_stat ? (MVMint64)stat_req.statbuf.st_dev : -1);
+            uv_fs_req_cleanup(&stat_req);
+        }
+    }
+    uv_fs_req_cleanup(&req);
+    return 0;
+}
+#endif
+
+/* Reads all the entries of a directory in one go, except for . and ..,
+ * returning a list of three lists: their names, their types (as the
+ * MVM_DIR_ENTRY_* values), and, if MVM_DIR_READ_STAT is among the flags,
+ * MVM_DIR_STAT_FIELDS stats per entry (with -1s where an entry couldn't be
+ * stat'd); otherwise the last list is empty. */
+MVMObject * MVM_dir_read_all(MVMThreadContext *tc, MVMString *dirname, MVMint64 flags) {
+    MVMObject *result = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    MVMObject *names  = NULL;
+    MVMObject *types  = NULL;
+    MVMObject *stats  = NULL;
+    char      *dir_name;
+    int        error;
+    MVMROOT4(tc, dirname, result, names, types, {
+        names = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTStrArray);
+        MVM_repr_push_o(tc, result, names);
+        types = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIntArray);
+        MVM_repr_push_o(tc, result, types);
+        stats = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIntArray);
+        MVM_repr_push_o(tc, result, stats);
+    });
+    dir_name = MVM_string_utf8_c8_encode_C_string(tc, dirname);
+#ifdef _WIN32
+    MVMROOT4(tc, result, names, types, stats, {
+        error = read_all_entries(tc, names, types, stats, dir_name, flags);
+    });
+    MVM_free(dir_name);
+    if (error < 0)
+        MVM_exception_throw_adhoc(tc, "Failed to read dir: %s", uv_strerror(error));
+#else
+    {
+        int dir_fd = open(dir_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        MVM_free(dir_name);
+        if (dir_fd < 0)
+            MVM_exception_throw_adhoc(tc, "Failed to open dir: %s", strerror(errno));
+        MVMROOT4(tc, result, names, types, stats, {
+            error = read_all_entries(tc, names, types, stats, dir_fd, flags);
+        });
+        if (error)
+            MVM_exception_throw_adhoc(tc, "Failed to read dir: %s", strerror(error));
+    }
+#endif
+    return result;
+}
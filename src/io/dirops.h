@@ -1,3 +1,22 @@
+/* Entry types reported by MVM_dir_read_all; the same as libuv's. */
+#define MVM_DIR_ENTRY_UNKNOWN   0
+#define MVM_DIR_ENTRY_FILE      1
+#define MVM_DIR_ENTRY_DIR       2
+#define MVM_DIR_ENTRY_LINK      3
+#define MVM_DIR_ENTRY_FIFO      4
+#define MVM_DIR_ENTRY_SOCKET    5
+#define MVM_DIR_ENTRY_CHAR      6
+#define MVM_DIR_ENTRY_BLOCK     7
+
+/* Flags for MVM_dir_read_all: whether to stat the entries too, and whether
+ * those stats follow symbolic links. */
+#define MVM_DIR_READ_STAT       1
+#define MVM_DIR_READ_FOLLOW     2
+
+/* The stats we give per entry: size, mode, modification time in nanoseconds
+ * since the epoch, inode and device. */
+#define MVM_DIR_STAT_FIELDS     5
+
 void MVM_dir_mkdir(MVMThreadContext *tc, MVMString *path, MVMint64 mode);
 void MVM_dir_rmdir(MVMThreadContext *tc, MVMString *path);
 MVMObject * MVM_dir_open(MVMThreadContext *tc, MVMString *dirname);
@@ -6,3 +25,4 @@ void MVM_dir_close(MVMThreadContext *tc, MVMObject *oshandle);
 MVMString * MVM_dir_cwd(MVMThreadContext *tc);
 int MVM_dir_chdir_C_string(MVMThreadContext *tc, const char *dirstring);
 void MVM_dir_chdir(MVMThreadContext *tc, MVMString *dir);
+MVMObject * MVM_dir_read_all(MVMThreadContext *tc, MVMString *dirname, MVMint64 flags);
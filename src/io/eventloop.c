@@ -8,30 +8,59 @@
  * instead, it enters a libuv event loop "forever", until program exit.
  *
  * Work is sent to the event loop by
+ *
+ * There may be several event loops, each with a thread, work queues and
+ * active task list of its own (see MVM_EVENT_LOOPS). Work without a loop of
+ * its own to go on runs on the first; TCP connections and listeners are
+ * spread over all of them, and the work on a socket then runs on its loop.
  */
 
+/* Adds a value to one of the event loop's histograms. */
+void MVM_io_histogram_add(MVMIOHistogram *histogram, MVMuint64 value) {
+    MVMuint32 bucket = 0;
+    MVMuint64 rest = value >> 1;
+    while (rest && bucket < MVM_IO_HISTOGRAM_BUCKETS - 1) {
+        bucket++;
+        rest >>= 1;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total += value;
+    if (value > histogram->max)
+        histogram->max = value;
+}
+
 /* Sets up an async task to be done on the loop. */
 static void setup_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_todo_queue;
+    MVMEventLoop *el = tc->event_loop;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)el->todo_queue;
     MVMObject *task_obj;
+    MVMuint64 backlog = 0;
 
     MVMROOT(tc, queue, {
         while (!MVM_is_null(tc, task_obj = MVM_concblockingqueue_poll(tc, queue))) {
             MVMAsyncTask *task = (MVMAsyncTask *)task_obj;
             MVM_ASSERT_NOT_FROMSPACE(tc, task);
+            backlog++;
             if (task->body.state == MVM_ASYNC_TASK_STATE_NEW) {
+                task->body.setup_at = uv_hrtime();
+                if (task->body.queued_at)
+                    MVM_io_histogram_add(&el->setup_latency,
+                        task->body.setup_at - task->body.queued_at);
                 MVMROOT(tc, task, {
-                    task->body.ops->setup(tc, tc->instance->event_loop, task_obj, task->body.data);
+                    task->body.ops->setup(tc, el->loop, task_obj, task->body.data);
                     task->body.state = MVM_ASYNC_TASK_STATE_SETUP;
                 });
             }
         }
     });
+    MVM_io_histogram_add(&el->setup_backlog, backlog);
 }
 
 /* Performs an async emit permit grant on the loop. */
 static void permit_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_permit_queue;
+    MVMEventLoop *el = tc->event_loop;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)el->permit_queue;
     MVMObject *task_arr;
 
     MVMROOT(tc, queue, {
@@ -42,7 +71,7 @@ static void permit_work(MVMThreadContext *tc) {
             if (task->body.ops->permit) {
                 MVMint64 channel = MVM_repr_get_int(tc, MVM_repr_at_pos_o(tc, task_arr, 1));
                 MVMint64 permit = MVM_repr_get_int(tc, MVM_repr_at_pos_o(tc, task_arr, 2));
-                task->body.ops->permit(tc, tc->instance->event_loop, task_obj, task->body.data, channel, permit);
+                task->body.ops->permit(tc, el->loop, task_obj, task->body.data, channel, permit);
             }
         }
     });
@@ -50,7 +79,8 @@ static void permit_work(MVMThreadContext *tc) {
 
 /* Performs an async cancellation on the loop. */
 static void cancel_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_cancel_queue;
+    MVMEventLoop *el = tc->event_loop;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)el->cancel_queue;
     MVMObject *task_obj;
 
     MVMROOT(tc, queue, {
@@ -60,7 +90,7 @@ static void cancel_work(MVMThreadContext *tc) {
             if (task->body.state == MVM_ASYNC_TASK_STATE_SETUP) {
                 MVMROOT(tc, task, {
                     if (task->body.ops->cancel)
-                        task->body.ops->cancel(tc, tc->instance->event_loop, task_obj, task->body.data);
+                        task->body.ops->cancel(tc, el->loop, task_obj, task->body.data);
                 });
             }
             task->body.state = MVM_ASYNC_TASK_STATE_CANCELLED;
@@ -68,6 +98,85 @@ static void cancel_work(MVMThreadContext *tc) {
     });
 }
 
+/* Pushes a batch of results onto a queue, taking its locks once if it can. */
+static void push_batch(MVMThreadContext *tc, MVMObject *queue, MVMObject *values) {
+    if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue)) {
+        MVM_io_histogram_add(&tc->event_loop->results_backlog,
+            MVM_repr_elems(tc, queue));
+        MVM_concblockingqueue_push_batch(tc, queue, values);
+    }
+    else if (REPR(queue)->ID == MVM_REPR_ID_ConcRingQueue && IS_CONCRETE(queue)) {
+        MVM_concringqueue_push_all(tc, queue, values);
+    }
+    else {
+        MVMint64 count = MVM_repr_elems(tc, values);
+        MVMint64 i;
+        MVMROOT2(tc, queue, values, {
+            for (i = 0; i < count; i++)
+                MVM_repr_push_o(tc, queue, MVM_repr_at_pos_o(tc, values, i));
+        });
+    }
+}
+
+/* Delivers the results gathered since the last flush, as one batch for each
+ * target queue, with the results for a queue kept in the order they were
+ * sent. This runs just before the loop waits for I/O, and just after, so
+ * nothing sits in the batch while the loop is idle. */
+static void flush_batch(MVMThreadContext *tc) {
+    MVMObject *batch = tc->event_loop->batch;
+    MVMint64   elems = MVM_repr_elems(tc, batch);
+    MVMObject *values;
+    MVMint64   i, j;
+    if (elems == 0)
+        return;
+    MVMROOT(tc, batch, {
+        values = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVMROOT(tc, values, {
+            for (i = 0; i < elems; i += 2) {
+                MVMObject *queue = MVM_repr_at_pos_o(tc, batch, i);
+                if (MVM_is_null(tc, queue))
+                    continue;
+                MVM_repr_pos_set_elems(tc, values, 0);
+                for (j = i; j < elems; j += 2) {
+                    if (MVM_repr_at_pos_o(tc, batch, j) == queue) {
+                        MVM_repr_push_o(tc, values, MVM_repr_at_pos_o(tc, batch, j + 1));
+                        MVM_repr_bind_pos_o(tc, batch, j, tc->instance->VMNull);
+                    }
+                }
+                push_batch(tc, queue, values);
+            }
+        });
+        MVM_repr_pos_set_elems(tc, batch, 0);
+    });
+}
+static void flush_before_poll(uv_prepare_t *handle) {
+    MVMThreadContext *tc = (MVMThreadContext *)handle->data;
+    MVMEventLoop *el = tc->event_loop;
+    flush_batch(tc);
+    if (el->iteration_start) {
+        MVM_io_histogram_add(&el->iteration_time, uv_hrtime() - el->iteration_start);
+        el->iteration_start = 0;
+    }
+}
+static void flush_after_poll(uv_check_t *handle) {
+    MVMThreadContext *tc = (MVMThreadContext *)handle->data;
+    tc->event_loop->iteration_start = uv_hrtime();
+    flush_batch(tc);
+}
+
+/* Sends a result to the queue of the task it is for. On an event loop
+ * thread it is put in the batch for the current loop iteration; on any
+ * other thread it is pushed right away. */
+void MVM_io_eventloop_send(MVMThreadContext *tc, MVMObject *queue, MVMObject *result) {
+    if (tc->event_loop) {
+        MVM_repr_push_o(tc, tc->event_loop->batch, queue);
+        MVM_repr_push_o(tc, tc->event_loop->batch, result);
+    }
+    else {
+        MVM_repr_push_o(tc, queue, result);
+    }
+}
+
 /* Fired whenever we were signalled that there is a new task or a new
  * cancellation for the event loop to process. */
 static void async_handler(uv_async_t *handle) {
@@ -80,28 +189,68 @@ static void async_handler(uv_async_t *handle) {
 
 /* Enters the event loop. */
 static void enter_loop(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
-    uv_loop_t    *loop = tc->instance->event_loop;
-    uv_async_t   *async = tc->instance->event_loop_wakeup;
+    MVMEventLoop *el = tc->event_loop;
 
 #ifdef MVM_HAS_PTHREAD_SETNAME_NP
     pthread_setname_np(pthread_self(), "async io thread");
 #endif
 
-    /* Bind the thread context for the wakeup signal */
-    async->data = tc;
+    /* Bind the thread context for the wakeup signal and the batch flushes */
+    el->wakeup->data        = tc;
+    el->flush_prepare->data = tc;
+    el->flush_check->data   = tc;
 
     /* Enter event loop */
-    uv_run(loop, UV_RUN_DEFAULT);
+    uv_run(el->loop, UV_RUN_DEFAULT);
+}
+
+/* Sets up the state of an event loop, unless it is already there. */
+static void setup_loop(MVMThreadContext *tc, MVMEventLoop *el) {
+    MVMInstance *instance = tc->instance;
+    if (el->loop)
+        return;
+
+    /* The underlying loop structure that will handle all IO events. */
+    el->loop = MVM_malloc(sizeof(uv_loop_t));
+    if (uv_loop_init(el->loop) < 0)
+        MVM_panic(1, "Unable to initialize event loop");
+
+    /* The async signal handler for waking up the thread */
+    el->wakeup = MVM_malloc(sizeof(uv_async_t));
+    if (uv_async_init(el->loop, el->wakeup, async_handler) != 0)
+        MVM_panic(1, "Unable to initialize async wake-up handle for event loop");
+
+    /* The handles that flush the batch of results; they don't keep the
+     * loop alive by themselves. */
+    el->flush_prepare = MVM_malloc(sizeof(uv_prepare_t));
+    el->flush_check   = MVM_malloc(sizeof(uv_check_t));
+    if (uv_prepare_init(el->loop, el->flush_prepare) != 0
+            || uv_check_init(el->loop, el->flush_check) != 0)
+        MVM_panic(1, "Unable to initialize result batching handles for event loop");
+    uv_prepare_start(el->flush_prepare, flush_before_poll);
+    uv_check_start(el->flush_check, flush_after_poll);
+    uv_unref((uv_handle_t *)el->flush_prepare);
+    uv_unref((uv_handle_t *)el->flush_check);
+
+    /* Create various bits of state the async event loop thread needs. */
+    el->todo_queue   = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    el->permit_queue = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    el->cancel_queue = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    el->active       = MVM_repr_alloc_init(tc, instance->boot_types.BOOTArray);
+    el->free_indices = MVM_repr_alloc_init(tc, instance->boot_types.BOOTIntArray);
+    el->batch        = MVM_repr_alloc_init(tc, instance->boot_types.BOOTArray);
+    MVM_gc_note_escape(tc);
 }
 
-/* Sees if we have an event loop processing thread set up already, and
- * sets it up if not. */
+/* Sees if we have the event loop processing threads set up already, and
+ * sets them up if not. */
 void MVM_io_eventloop_start(MVMThreadContext *tc) {
     MVMInstance *instance = tc->instance;
     MVMObject *loop_runner;
     unsigned int interval_id;
+    MVMuint32 i;
 
-    if (instance->event_loop_thread)
+    if (instance->event_loops[instance->num_event_loops - 1].thread)
         return;
 
     /* Grab starting mutex and ensure we didn't lose the race. */
@@ -112,54 +261,124 @@ void MVM_io_eventloop_start(MVMThreadContext *tc) {
 
     interval_id = MVM_telemetry_interval_start(tc, "creating the event loop thread");
 
-    /* We may have lost the race, so we need to setup state carefully */
-    /* This may also be present if this is a thread restart */
-    if (!instance->event_loop) {
-        /* The underlying loop structure that will handle all IO events. */
-        instance->event_loop              = MVM_malloc(sizeof(uv_loop_t));
-        if (uv_loop_init(instance->event_loop) < 0)
-            MVM_panic(1, "Unable to initialize event loop");
-
-        /* The async signal handler for waking up the thread */
-        instance->event_loop_wakeup       = MVM_malloc(sizeof(uv_async_t));
-        if (uv_async_init(instance->event_loop, instance->event_loop_wakeup, async_handler) != 0)
-            MVM_panic(1, "Unable to initialize async wake-up handle for event loop");
-
-        /* Create various bits of state the async event loop thread needs. */
-        instance->event_loop_todo_queue   = MVM_repr_alloc_init(tc,
-            instance->boot_types.BOOTQueue);
-        instance->event_loop_permit_queue = MVM_repr_alloc_init(tc,
-            instance->boot_types.BOOTQueue);
-        instance->event_loop_cancel_queue = MVM_repr_alloc_init(tc,
-            instance->boot_types.BOOTQueue);
-        instance->event_loop_active       = MVM_repr_alloc_init(tc,
-            instance->boot_types.BOOTArray);
-        instance->event_loop_free_indices = MVM_repr_alloc_init(tc,
-            instance->boot_types.BOOTIntArray);
+    for (i = 0; i < instance->num_event_loops; i++) {
+        MVMEventLoop *el = &instance->event_loops[i];
+
+        /* We may have lost the race, so we need to setup state carefully */
+        /* This may also be present if this is a thread restart */
+        setup_loop(tc, el);
+
+        if (!el->thread) {
+            /* Start the event loop thread, which will call a C function that
+             * sits in the uv loop, never leaving until it is stopped from the
+             * outside */
+            MVMObject *thread;
+            loop_runner = MVM_repr_alloc_init(tc, instance->boot_types.BOOTCCode);
+            ((MVMCFunction *)loop_runner)->body.func = enter_loop;
+
+            thread = MVM_thread_new(tc, loop_runner, 1);
+            ((MVMThread *)thread)->body.tc->event_loop = el;
+            el->thread = thread;
+            MVM_thread_run(tc, el->thread);
+        }
     }
 
-    if (!instance->event_loop_thread) {
-        /* Start the event loop thread, which will call a C function that
-         * sits in the uv loop, never leaving until it is stopped from the
-         * outside */
-        loop_runner = MVM_repr_alloc_init(tc, instance->boot_types.BOOTCCode);
-        ((MVMCFunction *)loop_runner)->body.func = enter_loop;
+    MVM_telemetry_interval_stop(tc, interval_id, "created the event loop thread");
+    uv_mutex_unlock(&instance->mutex_event_loop);
+}
+
+/* Picks the event loop for a task that could go on any of them, taking them
+ * in turn. */
+MVMuint32 MVM_io_eventloop_pick(MVMThreadContext *tc) {
+    return (MVMuint32)(MVM_incr(&tc->instance->next_event_loop) % tc->instance->num_event_loops);
+}
 
-        instance->event_loop_thread = MVM_thread_new(tc, loop_runner, 1);
-        MVM_thread_run(tc, instance->event_loop_thread);
+/* Gets the index of the event loop the current thread runs. Must only be
+ * called on an event loop thread. */
+MVMuint32 MVM_io_eventloop_current(MVMThreadContext *tc) {
+    return (MVMuint32)(tc->event_loop - tc->instance->event_loops);
+}
+
+/* Each pooled read buffer has a header in front of it, saying which pool it
+ * belongs back in and, while it is there, chaining the free buffers. */
+typedef struct ReadBufferHeader {
+    MVMIOReadBufferPool     *pool;
+    struct ReadBufferHeader *next;
+} ReadBufferHeader;
+
+void MVM_io_read_buffer_pool_init(MVMIOReadBufferPool *pool) {
+    uv_mutex_init(&pool->mutex);
+    pool->free     = NULL;
+    pool->num_free = 0;
+}
+
+void MVM_io_read_buffer_pool_destroy(MVMIOReadBufferPool *pool) {
+    ReadBufferHeader *header = (ReadBufferHeader *)pool->free;
+    while (header) {
+        ReadBufferHeader *next = header->next;
+        MVM_free(header);
+        header = next;
     }
+    pool->free     = NULL;
+    pool->num_free = 0;
+    uv_mutex_destroy(&pool->mutex);
+}
 
-    MVM_telemetry_interval_stop(tc, interval_id, "created the event loop thread");
-    uv_mutex_unlock(&instance->mutex_event_loop);
+/* Takes a buffer of MVM_IO_READ_BUFFER_SIZE bytes from the pool of the event
+ * loop the current thread runs, allocating one if the pool is empty. Must
+ * only be called on an event loop thread. */
+char * MVM_io_read_buffer_acquire(MVMThreadContext *tc) {
+    MVMIOReadBufferPool *pool = &(tc->event_loop->read_buffers);
+    ReadBufferHeader    *header;
+    uv_mutex_lock(&pool->mutex);
+    header = (ReadBufferHeader *)pool->free;
+    if (header) {
+        pool->free = header->next;
+        pool->num_free--;
+    }
+    uv_mutex_unlock(&pool->mutex);
+    if (!header) {
+        header = MVM_malloc(sizeof(ReadBufferHeader) + MVM_IO_READ_BUFFER_SIZE);
+        header->pool = pool;
+    }
+    return (char *)(header + 1);
 }
 
+/* Gives a buffer from MVM_io_read_buffer_acquire back to its pool, or frees
+ * it if the pool already holds as many as it keeps. May be called from any
+ * thread. */
+void MVM_io_read_buffer_release(char *buf) {
+    ReadBufferHeader    *header = (ReadBufferHeader *)buf - 1;
+    MVMIOReadBufferPool *pool   = header->pool;
+    uv_mutex_lock(&pool->mutex);
+    if (pool->num_free < MVM_IO_READ_BUFFER_POOL_MAX) {
+        header->next = (ReadBufferHeader *)pool->free;
+        pool->free   = header;
+        pool->num_free++;
+        header       = NULL;
+    }
+    uv_mutex_unlock(&pool->mutex);
+    if (header)
+        MVM_free(header);
+}
 
-/* Adds a work item into the event loop work queue. */
+/* Adds a work item into the work queue of the first event loop, where any
+ * work without a particular loop to go on runs. */
 void MVM_io_eventloop_queue_work(MVMThreadContext *tc, MVMObject *work) {
+    MVM_io_eventloop_queue_work_on(tc, work, 0);
+}
+
+/* Adds a work item into the work queue of the specified event loop. Any
+ * permits and cancellation for it later go to the same loop. */
+void MVM_io_eventloop_queue_work_on(MVMThreadContext *tc, MVMObject *work, MVMuint32 loop) {
     MVMROOT(tc, work, {
+        MVMEventLoop *el;
         MVM_io_eventloop_start(tc);
-        MVM_repr_push_o(tc, tc->instance->event_loop_todo_queue, work);
-        uv_async_send(tc->instance->event_loop_wakeup);
+        el = &tc->instance->event_loops[loop];
+        ((MVMAsyncTask *)work)->body.loop = loop;
+        ((MVMAsyncTask *)work)->body.queued_at = uv_hrtime();
+        MVM_repr_push_o(tc, el->todo_queue, work);
+        uv_async_send(el->wakeup);
     });
 }
 
@@ -175,6 +394,7 @@ void MVM_io_eventloop_permit(MVMThreadContext *tc, MVMObject *task_obj,
             MVMObject *permits_box = NULL;
             MVMObject *arr = NULL;
             MVMROOT3(tc, channel_box, permits_box, arr, {
+                MVMEventLoop *el;
                 channel_box = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, channel);
                 permits_box = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, permits);
                 arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
@@ -182,8 +402,9 @@ void MVM_io_eventloop_permit(MVMThreadContext *tc, MVMObject *task_obj,
                 MVM_repr_push_o(tc, arr, channel_box);
                 MVM_repr_push_o(tc, arr, permits_box);
                 MVM_io_eventloop_start(tc);
-                MVM_repr_push_o(tc, tc->instance->event_loop_permit_queue, arr);
-                uv_async_send(tc->instance->event_loop_wakeup);
+                el = &tc->instance->event_loops[((MVMAsyncTask *)task_obj)->body.loop];
+                MVM_repr_push_o(tc, el->permit_queue, arr);
+                uv_async_send(el->wakeup);
             });
         });
     }
@@ -204,9 +425,11 @@ void MVM_io_eventloop_cancel_work(MVMThreadContext *tc, MVMObject *task_obj,
                 notify_schedulee);
         }
         MVMROOT(tc, task_obj, {
+            MVMEventLoop *el;
             MVM_io_eventloop_start(tc);
-            MVM_repr_push_o(tc, tc->instance->event_loop_cancel_queue, task_obj);
-            uv_async_send(tc->instance->event_loop_wakeup);
+            el = &tc->instance->event_loops[((MVMAsyncTask *)task_obj)->body.loop];
+            MVM_repr_push_o(tc, el->cancel_queue, task_obj);
+            uv_async_send(el->wakeup);
         });
     }
     else {
@@ -219,23 +442,27 @@ void MVM_io_eventloop_send_cancellation_notification(MVMThreadContext *tc, MVMAs
     MVMObject *notify_queue = task->body.cancel_notify_queue;
     MVMObject *notify_schedulee = task->body.cancel_notify_schedulee;
     if (notify_queue && notify_schedulee)
-        MVM_repr_push_o(tc, notify_queue, notify_schedulee);
+        MVM_io_eventloop_send(tc, notify_queue, notify_schedulee);
 }
 
-/* Adds a work item to the active async task set. */
+/* Adds a work item to the active async task set of the current thread's
+ * event loop. */
 int MVM_io_eventloop_add_active_work(MVMThreadContext *tc, MVMObject *async_task) {
-    MVMuint64 work_idx = MVM_repr_elems(tc, tc->instance->event_loop_free_indices) > 0
-        ? (MVMuint64)MVM_repr_pop_i(tc, tc->instance->event_loop_free_indices)
-        : MVM_repr_elems(tc, tc->instance->event_loop_active);
+    MVMEventLoop *el = tc->event_loop;
+    MVMuint64 work_idx = MVM_repr_elems(tc, el->free_indices) > 0
+        ? (MVMuint64)MVM_repr_pop_i(tc, el->free_indices)
+        : MVM_repr_elems(tc, el->active);
     MVM_ASSERT_NOT_FROMSPACE(tc, async_task);
-    MVM_repr_bind_pos_o(tc, tc->instance->event_loop_active, work_idx, async_task);
+    MVM_repr_bind_pos_o(tc, el->active, work_idx, async_task);
+    MVM_incr(&tc->instance->stat_event_loop_tasks);
     return work_idx;
 }
 
-/* Gets an active work item from the active work eventloop. */
+/* Gets an active work item from the current thread's event loop. */
 MVMAsyncTask * MVM_io_eventloop_get_active_work(MVMThreadContext *tc, int work_idx) {
-    if (work_idx >= 0 && work_idx < (int)MVM_repr_elems(tc, tc->instance->event_loop_active)) {
-        MVMObject *task_obj = MVM_repr_at_pos_o(tc, tc->instance->event_loop_active, work_idx);
+    MVMEventLoop *el = tc->event_loop;
+    if (work_idx >= 0 && work_idx < (int)MVM_repr_elems(tc, el->active)) {
+        MVMObject *task_obj = MVM_repr_at_pos_o(tc, el->active, work_idx);
         if (REPR(task_obj)->ID != MVM_REPR_ID_MVMAsyncTask)
             MVM_panic(1, "non-AsyncTask fetched from eventloop active work list");
         MVM_ASSERT_NOT_FROMSPACE(tc, task_obj);
@@ -250,11 +477,17 @@ MVMAsyncTask * MVM_io_eventloop_get_active_work(MVMThreadContext *tc, int work_i
  * memory associated with it to be collected. Replaces the work index with -1
  * so that any future use of the task will be a failed lookup. */
 void MVM_io_eventloop_remove_active_work(MVMThreadContext *tc, int *work_idx_to_clear) {
+    MVMEventLoop *el = tc->event_loop;
     int work_idx = *work_idx_to_clear;
-    if (work_idx >= 0 && work_idx < (int)MVM_repr_elems(tc, tc->instance->event_loop_active)) {
+    if (work_idx >= 0 && work_idx < (int)MVM_repr_elems(tc, el->active)) {
+        MVMObject *task_obj = MVM_repr_at_pos_o(tc, el->active, work_idx);
+        if (REPR(task_obj)->ID == MVM_REPR_ID_MVMAsyncTask && ((MVMAsyncTask *)task_obj)->body.setup_at)
+            MVM_io_histogram_add(&el->task_time,
+                uv_hrtime() - ((MVMAsyncTask *)task_obj)->body.setup_at);
         *work_idx_to_clear = -1;
-        MVM_repr_bind_pos_o(tc, tc->instance->event_loop_active, work_idx, tc->instance->VMNull);
-        MVM_repr_push_i(tc, tc->instance->event_loop_free_indices, work_idx);
+        MVM_repr_bind_pos_o(tc, el->active, work_idx, tc->instance->VMNull);
+        MVM_repr_push_i(tc, el->free_indices, work_idx);
+        MVM_decr(&tc->instance->stat_event_loop_tasks);
     }
     else {
         MVM_panic(1, "cannot remove invalid eventloop work item index %d", work_idx);
@@ -266,42 +499,62 @@ void MVM_io_eventloop_remove_active_work(MVMThreadContext *tc, int *work_idx_to_
 /* Send the stop signal - no synchronization required */
 void MVM_io_eventloop_stop(MVMThreadContext *tc) {
     MVMInstance *instance = tc->instance;
-    if (!instance->event_loop_thread)
-        return;
-    /* Stop the loop */
-    uv_stop(instance->event_loop);
-    uv_async_send(instance->event_loop_wakeup);
+    MVMuint32 i;
+    for (i = 0; i < instance->num_event_loops; i++) {
+        MVMEventLoop *el = &instance->event_loops[i];
+        if (!el->thread)
+            continue;
+        /* Stop the loop */
+        uv_stop(el->loop);
+        uv_async_send(el->wakeup);
+    }
 }
 
 /* Wait for exit (again, no synchronizaiton required) */
 void MVM_io_eventloop_join(MVMThreadContext *tc) {
     MVMInstance *instance = tc->instance;
-    if (!instance->event_loop_thread)
-        return;
-    MVM_thread_join(tc, instance->event_loop_thread);
+    MVMuint32 i;
+    for (i = 0; i < instance->num_event_loops; i++)
+        if (instance->event_loops[i].thread)
+            MVM_thread_join(tc, instance->event_loops[i].thread);
+}
+
+/* Forgets the stopped event loop threads, so that MVM_io_eventloop_start
+ * will start them again. Their loops are kept. */
+void MVM_io_eventloop_forget_threads(MVMThreadContext *tc) {
+    MVMuint32 i;
+    for (i = 0; i < tc->instance->num_event_loops; i++)
+        tc->instance->event_loops[i].thread = NULL;
 }
 
 /* Clean up used resources. Synchronization required - other threads might modify them as well */
 void MVM_io_eventloop_destroy(MVMThreadContext *tc) {
     MVMInstance *instance = tc->instance;
+    MVMuint32 i;
     MVM_gc_mark_thread_blocked(tc);
     uv_mutex_lock(&instance->mutex_event_loop);
     MVM_gc_mark_thread_unblocked(tc);
 
-    if (instance->event_loop_thread) {
-        MVM_io_eventloop_stop(tc);
-        MVM_io_eventloop_join(tc);
-        instance->event_loop_thread = NULL;
-    }
-
-    if (instance->event_loop) {
-        uv_close((uv_handle_t*)instance->event_loop_wakeup, NULL);
-
-        /* Not sure we can always do this */
-        uv_loop_close(instance->event_loop);
-       
-        MVM_free_null(instance->event_loop_wakeup);
-        MVM_free_null(instance->event_loop);
+    MVM_io_eventloop_stop(tc);
+    MVM_io_eventloop_join(tc);
+    MVM_io_eventloop_forget_threads(tc);
+
+    for (i = 0; i < instance->num_event_loops; i++) {
+        MVMEventLoop *el = &instance->event_loops[i];
+        if (el->loop) {
+            uv_close((uv_handle_t*)el->wakeup, NULL);
+            uv_close((uv_handle_t*)el->flush_prepare, NULL);
+            uv_close((uv_handle_t*)el->flush_check, NULL);
+            MVM_io_timer_wheel_destroy(el);
+
+            /* Not sure we can always do this */
+            uv_loop_close(el->loop);
+
+            MVM_free_null(el->wakeup);
+            MVM_free_null(el->flush_prepare);
+            MVM_free_null(el->flush_check);
+            MVM_free_null(el->loop);
+        }
     }
 
     uv_mutex_unlock(&instance->mutex_event_loop);
@@ -18,18 +18,97 @@ struct MVMAsyncTaskOps {
     void (*gc_free) (MVMThreadContext *tc, MVMObject *t, void *data);
 };
 
+/* A pool of read buffers for an event loop's sockets to read into, which
+ * are handed over to the buffer objects the data is delivered in, and come
+ * back to the pool when those are freed (from whichever thread that may be;
+ * thus the mutex). */
+struct MVMIOReadBufferPool {
+    uv_mutex_t  mutex;
+    void       *free;
+    MVMuint32   num_free;
+};
+
+/* The size of each pooled read buffer, which is what libuv suggests a read
+ * be done into, and how many buffers a pool keeps at most. */
+#define MVM_IO_READ_BUFFER_SIZE     65536
+#define MVM_IO_READ_BUFFER_POOL_MAX 64
+
+/* A histogram kept by an event loop. Bucket i counts the values v with
+ * 2^i <= v < 2^(i+1) (with 0 going in the first bucket, and the last one
+ * taking everything too big for the others). Only the loop's own thread
+ * updates it, so readers may see it mid-update. */
+#define MVM_IO_HISTOGRAM_BUCKETS 40
+struct MVMIOHistogram {
+    MVMuint64 buckets[MVM_IO_HISTOGRAM_BUCKETS];
+    MVMuint64 count;
+    MVMuint64 total;
+    MVMuint64 max;
+};
+
+/* The state of one event loop: its thread, the libuv loop, the queues that
+ * work, permits and cancellations are sent to it by, the active task list,
+ * for the purpose of keeping them GC marked, and the batch of results sent
+ * on it, as pairs of queue and result, which is flushed by the prepare and
+ * check handles each time around the loop. */
+struct MVMEventLoop {
+    MVMObject    *thread;
+    uv_loop_t    *loop;
+    MVMObject    *todo_queue;
+    MVMObject    *permit_queue;
+    MVMObject    *cancel_queue;
+    MVMObject    *active;
+    MVMObject    *free_indices;
+    MVMObject    *batch;
+    uv_async_t   *wakeup;
+    uv_prepare_t *flush_prepare;
+    uv_check_t   *flush_check;
+
+    MVMIOReadBufferPool read_buffers;
+
+    /* The wheel the timers on this loop are kept in, made on first use. */
+    MVMTimerWheel *timer_wheel;
+
+    /* Latency and backlog statistics: how long tasks waited between being
+     * queued and set up, how long they were active for, how long each loop
+     * iteration spent running callbacks, how many tasks were waiting each
+     * time the loop woke up to set work up, and how many results were
+     * already sitting unconsumed in a queue when more were delivered to it.
+     * Times are in nanoseconds. */
+    MVMIOHistogram setup_latency;
+    MVMIOHistogram task_time;
+    MVMIOHistogram iteration_time;
+    MVMIOHistogram setup_backlog;
+    MVMIOHistogram results_backlog;
+
+    /* When the current loop iteration started running callbacks, if it
+     * did. */
+    MVMuint64 iteration_start;
+};
+
 void MVM_io_eventloop_queue_work(MVMThreadContext *tc, MVMObject *work);
+void MVM_io_eventloop_queue_work_on(MVMThreadContext *tc, MVMObject *work, MVMuint32 loop);
+MVMuint32 MVM_io_eventloop_pick(MVMThreadContext *tc);
+MVMuint32 MVM_io_eventloop_current(MVMThreadContext *tc);
 void MVM_io_eventloop_permit(MVMThreadContext *tc, MVMObject *task_obj,
     MVMint64 channel, MVMint64 permits);
 void MVM_io_eventloop_cancel_work(MVMThreadContext *tc, MVMObject *task_obj,
     MVMObject *notify_queue, MVMObject *notify_schedulee);
+void MVM_io_eventloop_send(MVMThreadContext *tc, MVMObject *queue, MVMObject *result);
 void MVM_io_eventloop_send_cancellation_notification(MVMThreadContext *tc, MVMAsyncTask *task_obj);
 
 int MVM_io_eventloop_add_active_work(MVMThreadContext *tc, MVMObject *async_task);
 MVMAsyncTask * MVM_io_eventloop_get_active_work(MVMThreadContext *tc, int work_idx);
 void MVM_io_eventloop_remove_active_work(MVMThreadContext *tc, int *work_idx_to_clear);
 
+void MVM_io_read_buffer_pool_init(MVMIOReadBufferPool *pool);
+void MVM_io_read_buffer_pool_destroy(MVMIOReadBufferPool *pool);
+char * MVM_io_read_buffer_acquire(MVMThreadContext *tc);
+void MVM_io_read_buffer_release(char *buf);
+
+void MVM_io_histogram_add(MVMIOHistogram *histogram, MVMuint64 value);
+
 void MVM_io_eventloop_start(MVMThreadContext *tc);
 void MVM_io_eventloop_stop(MVMThreadContext *tc);
 void MVM_io_eventloop_join(MVMThreadContext *tc);
+void MVM_io_eventloop_forget_threads(MVMThreadContext *tc);
 void MVM_io_eventloop_destroy(MVMThreadContext *tc);
@@ -8,11 +8,12 @@ typedef struct {
     int               work_idx;
 } WatchInfo;
 
-static void on_changed(uv_fs_event_t *handle, const char *filename, int events, int status) {
-    WatchInfo        *wi  = (WatchInfo *)handle->data;
-    MVMThreadContext *tc  = wi->tc;
-    MVMObject        *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
-    MVMAsyncTask     *t   = MVM_io_eventloop_get_active_work(tc, wi->work_idx);
+/* Sends a single change to the task's queue. */
+static void send_change(MVMThreadContext *tc, MVMAsyncTask *t, const char *filename, int events) {
+    MVMObject *arr;
+    MVMROOT(tc, t, {
+        arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    });
     MVM_repr_push_o(tc, arr, t->body.schedulee);
     MVMROOT2(tc, t, arr, {
         MVMObject *filename_boxed;
@@ -37,6 +38,30 @@ static void on_changed(uv_fs_event_t *handle, const char *filename, int events,
     MVM_repr_push_o(tc, t->body.queue, arr);
 }
 
+static void on_changed(uv_fs_event_t *handle, const char *filename, int events, int status) {
+    WatchInfo        *wi  = (WatchInfo *)handle->data;
+    MVMThreadContext *tc  = wi->tc;
+    send_change(tc, MVM_io_eventloop_get_active_work(tc, wi->work_idx), filename, events);
+}
+
+/* Sends the error from starting to watch something to the task's queue. */
+static void send_error(MVMThreadContext *tc, MVMObject *async_task, int r) {
+    MVMROOT(tc, async_task, {
+        MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVM_repr_push_o(tc, arr, ((MVMAsyncTask *)async_task)->body.schedulee);
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+        MVMROOT(tc, arr, {
+            MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
+                tc->instance->VMString, uv_strerror(r));
+            MVMObject *msg_box = MVM_repr_box_str(tc,
+                tc->instance->boot_types.BOOTStr, msg_str);
+            MVM_repr_push_o(tc, arr, msg_box);
+        });
+        MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
+    });
+}
+
 /* Sets the signal handler up on the event loop. */
 static void setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
     WatchInfo *wi = (WatchInfo *)data;
@@ -51,20 +76,7 @@ static void setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task,
     uv_fs_event_init(loop, &wi->handle);
     if ((r = uv_fs_event_start(&wi->handle, on_changed, wi->path, 0)) != 0) {
         /* Error; need to notify. */
-        MVMROOT(tc, async_task, {
-            MVMObject    *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
-            MVM_repr_push_o(tc, arr, ((MVMAsyncTask *)async_task)->body.schedulee);
-            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
-            MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
-            MVMROOT(tc, arr, {
-                MVMString *msg_str = MVM_string_ascii_decode_nt(tc,
-                    tc->instance->VMString, uv_strerror(r));
-                MVMObject *msg_box = MVM_repr_box_str(tc,
-                    tc->instance->boot_types.BOOTStr, msg_str);
-                MVM_repr_push_o(tc, arr, msg_box);
-            });
-            MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
-        });
+        send_error(tc, async_task, r);
     }
 }
 
@@ -127,3 +139,339 @@ MVMObject * MVM_io_file_watch(MVMThreadContext *tc, MVMObject *queue,
 
     return (MVMObject *)task;
 }
+
+/* Watching a whole tree. Where the platform can do that itself, we use a
+ * single recursive watcher; otherwise (on Linux, for instance), we watch each
+ * directory of the tree, and start watching new ones when they appear. */
+#if defined(__APPLE__) || defined(_WIN32)
+#define NATIVE_RECURSIVE_WATCH 1
+#endif
+
+typedef struct TreeWatchInfo TreeWatchInfo;
+
+/* A watched directory of the tree, with its path relative to the root ("" for
+ * the root itself). The handle comes first, so that we can free the whole
+ * thing once the handle is closed. */
+typedef struct DirWatch {
+    uv_fs_event_t     handle;
+    TreeWatchInfo    *twi;
+    char             *rel;
+    struct DirWatch  *next;
+} DirWatch;
+
+/* Info we convey about a tree watcher. With a coalescing window, changes are
+ * gathered into a hash of the paths changed (mapped to whether any of the
+ * changes was a rename), sent along when the window closes. */
+struct TreeWatchInfo {
+    char             *path;
+    MVMint64          coalesce_ms;
+    MVMThreadContext *tc;
+    int               work_idx;
+    DirWatch         *dirs;
+    uv_timer_t       *timer;
+    MVMObject        *pending;
+    MVMint64          pending_events;
+};
+
+/* Joins a relative path onto a directory path, "" meaning the directory. */
+static char * join_path(const char *dir, const char *name) {
+    size_t  dir_len  = strlen(dir);
+    size_t  name_len = strlen(name);
+    char   *result   = MVM_malloc(dir_len + name_len + 2);
+    if (!dir_len) {
+        memcpy(result, name, name_len + 1);
+    }
+    else if (!name_len) {
+        memcpy(result, dir, dir_len + 1);
+    }
+    else {
+        memcpy(result, dir, dir_len);
+        result[dir_len] = '/';
+        memcpy(result + dir_len + 1, name, name_len + 1);
+    }
+    return result;
+}
+
+static void free_dir_watch(uv_handle_t *handle) {
+    DirWatch *dw = (DirWatch *)handle;
+    MVM_free(dw->rel);
+    MVM_free(dw);
+}
+
+static void free_on_close(uv_handle_t *handle) {
+    MVM_free(handle);
+}
+
+static void on_tree_changed(uv_fs_event_t *handle, const char *filename, int events, int status);
+
+/* Starts watching a directory of the tree, and (unless the platform does it
+ * for us) the directories under it, skipping symbolic links so that we can't
+ * loop. Only errors from the directory itself are reported. */
+static int watch_dir(TreeWatchInfo *twi, uv_loop_t *loop, const char *rel) {
+    DirWatch *dw   = MVM_malloc(sizeof(DirWatch));
+    char     *full = join_path(twi->path, rel);
+    int       r;
+#ifdef NATIVE_RECURSIVE_WATCH
+    unsigned int flags = UV_FS_EVENT_RECURSIVE;
+#else
+    unsigned int flags = 0;
+#endif
+    dw->twi         = twi;
+    dw->rel         = join_path("", rel);
+    dw->handle.data = dw;
+    uv_fs_event_init(loop, &dw->handle);
+    if ((r = uv_fs_event_start(&dw->handle, on_tree_changed, full, flags)) != 0) {
+        uv_close((uv_handle_t *)&dw->handle, free_dir_watch);
+        MVM_free(full);
+        return r;
+    }
+    dw->next  = twi->dirs;
+    twi->dirs = dw;
+
+#ifndef NATIVE_RECURSIVE_WATCH
+    {
+        uv_fs_t     req;
+        uv_dirent_t ent;
+        if (uv_fs_scandir(loop, &req, full, 0, NULL) >= 0) {
+            while (uv_fs_scandir_next(&req, &ent) != UV_EOF) {
+                int is_dir = ent.type == UV_DIRENT_DIR;
+                if (ent.type == UV_DIRENT_UNKNOWN) {
+                    uv_fs_t  stat_req;
+                    char    *child = join_path(full, ent.name);
+                    if (uv_fs_lstat(loop, &stat_req, child, NULL) == 0)
+                        is_dir = S_ISDIR(stat_req.statbuf.st_mode);
+                    uv_fs_req_cleanup(&stat_req);
+                    MVM_free(child);
+                }
+                if (is_dir) {
+                    char *child_rel = join_path(rel, ent.name);
+                    watch_dir(twi, loop, child_rel);
+                    MVM_free(child_rel);
+                }
+            }
+        }
+        uv_fs_req_cleanup(&req);
+    }
+#endif
+
+    MVM_free(full);
+    return 0;
+}
+
+#ifndef NATIVE_RECURSIVE_WATCH
+/* Renames are also how creations and deletions are reported, so on one we
+ * check whether a directory appeared (and start watching it) or went away
+ * (and stop watching it and everything that was under it). */
+static void track_rename(TreeWatchInfo *twi, uv_loop_t *loop, const char *rel) {
+    uv_fs_t  req;
+    char    *full   = join_path(twi->path, rel);
+    int      exists = uv_fs_lstat(loop, &req, full, NULL) == 0;
+    int      is_dir = exists && S_ISDIR(req.statbuf.st_mode);
+    size_t   len    = strlen(rel);
+    uv_fs_req_cleanup(&req);
+    MVM_free(full);
+    if (is_dir) {
+        DirWatch *dw;
+        for (dw = twi->dirs; dw; dw = dw->next)
+            if (strcmp(dw->rel, rel) == 0)
+                return;
+        watch_dir(twi, loop, rel);
+    }
+    else if (!exists) {
+        DirWatch **link = &(twi->dirs);
+        while (*link) {
+            DirWatch *dw = *link;
+            if (strncmp(dw->rel, rel, len) == 0 && (dw->rel[len] == '\0' || dw->rel[len] == '/')) {
+                *link = dw->next;
+                uv_fs_event_stop(&dw->handle);
+                uv_close((uv_handle_t *)&dw->handle, free_dir_watch);
+            }
+            else {
+                link = &(dw->next);
+            }
+        }
+    }
+}
+#endif
+
+/* Sends the changes gathered during a coalescing window. */
+static void flush_pending(uv_timer_t *timer) {
+    TreeWatchInfo    *twi = (TreeWatchInfo *)timer->data;
+    MVMThreadContext *tc  = twi->tc;
+    MVMAsyncTask     *t   = MVM_io_eventloop_get_active_work(tc, twi->work_idx);
+    MVMObject        *arr;
+    if (!twi->pending)
+        return;
+    MVMROOT(tc, t, {
+        arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVM_repr_push_o(tc, arr, t->body.schedulee);
+        MVM_repr_push_o(tc, arr, twi->pending);
+        MVMROOT(tc, arr, {
+            MVMObject *count_box = MVM_repr_box_int(tc,
+                tc->instance->boot_types.BOOTInt, twi->pending_events);
+            MVM_repr_push_o(tc, arr, count_box);
+        });
+        MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+    });
+    MVM_repr_push_o(tc, t->body.queue, arr);
+    twi->pending        = NULL;
+    twi->pending_events = 0;
+}
+
+/* Adds a change to those gathered in the current coalescing window, starting
+ * the window if there is none. */
+static void add_pending(TreeWatchInfo *twi, const char *rel, int events) {
+    MVMThreadContext *tc = twi->tc;
+    MVMAsyncTask     *t  = MVM_io_eventloop_get_active_work(tc, twi->work_idx);
+    MVMString        *key;
+    MVMROOT(tc, t, {
+        if (!twi->pending) {
+            MVMObject *hash = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTHash);
+            MVM_ASSIGN_REF(tc, &(t->common.header), twi->pending, hash);
+        }
+        key = MVM_string_utf8_c8_decode(tc, tc->instance->VMString, rel, strlen(rel));
+        if (events & UV_RENAME || !MVM_repr_exists_key(tc, twi->pending, key)) {
+            MVMROOT(tc, key, {
+                MVMObject *rename_boxed = MVM_repr_box_int(tc,
+                    tc->instance->boot_types.BOOTInt,
+                    events & UV_RENAME ? 1 : 0);
+                MVM_repr_bind_key_o(tc, twi->pending, key, rename_boxed);
+            });
+        }
+    });
+    twi->pending_events++;
+    if (!uv_is_active((uv_handle_t *)twi->timer))
+        uv_timer_start(twi->timer, flush_pending, (uint64_t)twi->coalesce_ms, 0);
+}
+
+static void on_tree_changed(uv_fs_event_t *handle, const char *filename, int events, int status) {
+    DirWatch         *dw  = (DirWatch *)handle;
+    TreeWatchInfo    *twi = dw->twi;
+    MVMThreadContext *tc  = twi->tc;
+    char             *rel;
+    if (status < 0)
+        return;
+    rel = join_path(dw->rel, filename ? filename : "");
+#ifndef NATIVE_RECURSIVE_WATCH
+    if (events & UV_RENAME && filename)
+        track_rename(twi, handle->loop, rel);
+#endif
+    if (twi->coalesce_ms > 0)
+        add_pending(twi, rel, events);
+    else
+        send_change(tc, MVM_io_eventloop_get_active_work(tc, twi->work_idx), rel, events);
+    MVM_free(rel);
+}
+
+/* Sets the tree watcher up on the event loop. */
+static void tree_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    TreeWatchInfo *twi = (TreeWatchInfo *)data;
+    int            r;
+
+    /* Add task to active list. */
+    twi->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
+    twi->tc       = tc;
+
+    /* Start watching, and get a timer ready for coalescing. */
+    if ((r = watch_dir(twi, loop, "")) != 0) {
+        send_error(tc, async_task, r);
+        MVM_io_eventloop_remove_active_work(tc, &(twi->work_idx));
+        return;
+    }
+    if (twi->coalesce_ms > 0) {
+        twi->timer       = MVM_malloc(sizeof(uv_timer_t));
+        twi->timer->data = twi;
+        uv_timer_init(loop, twi->timer);
+    }
+}
+
+/* Stops watching the tree, dropping any changes not yet sent. */
+static void tree_cancel(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *t, void *data) {
+    TreeWatchInfo *twi = (TreeWatchInfo *)data;
+    while (twi->dirs) {
+        DirWatch *dw = twi->dirs;
+        twi->dirs = dw->next;
+        uv_fs_event_stop(&dw->handle);
+        uv_close((uv_handle_t *)&dw->handle, free_dir_watch);
+    }
+    if (twi->timer) {
+        uv_timer_stop(twi->timer);
+        uv_close((uv_handle_t *)twi->timer, free_on_close);
+        twi->timer = NULL;
+    }
+    twi->pending = NULL;
+    if (twi->work_idx >= 0)
+        MVM_io_eventloop_remove_active_work(tc, &(twi->work_idx));
+}
+
+/* Marks the changes gathered in the current coalescing window. */
+static void tree_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    TreeWatchInfo *twi = (TreeWatchInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &twi->pending);
+}
+
+/* Frees data associated with a tree watcher task. */
+static void tree_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    if (data) {
+        TreeWatchInfo *twi = (TreeWatchInfo *)data;
+        MVM_free(twi->path);
+        MVM_free(twi);
+    }
+}
+
+/* Operations table for a tree watcher task. */
+static const MVMAsyncTaskOps tree_op_table = {
+    tree_setup,
+    NULL,
+    tree_cancel,
+    tree_gc_mark,
+    tree_gc_free
+};
+
+/* Watches a directory and everything under it. With a coalescing window of
+ * zero, each change is sent as with MVM_io_file_watch, but with its path
+ * relative to the directory; otherwise the changes seen over that many
+ * milliseconds after the first are sent together, as a hash of the paths
+ * changed to whether any of their changes was a rename, along with the
+ * number of changes seen. */
+MVMObject * MVM_io_file_watch_tree(MVMThreadContext *tc, MVMObject *queue,
+                                   MVMObject *schedulee, MVMString *path,
+                                   MVMObject *async_type, MVMint64 coalesce_ms) {
+    MVMAsyncTask  *task;
+    TreeWatchInfo *watch_info;
+    char          *c_path;
+
+    /* Validate REPRs. */
+    if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
+        MVM_exception_throw_adhoc(tc,
+            "tree watch target queue must have ConcBlockingQueue REPR");
+    if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
+        MVM_exception_throw_adhoc(tc,
+            "tree watch result type must have REPR AsyncTask");
+    if (coalesce_ms < 0)
+        MVM_exception_throw_adhoc(tc,
+            "tree watch coalescing window must not be negative");
+
+    /* Encode path. */
+    c_path = MVM_string_utf8_c8_encode_C_string(tc, path);
+
+    /* Create async task handle. */
+    MVMROOT2(tc, queue, schedulee, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc, async_type);
+    });
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.queue, queue);
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.schedulee, schedulee);
+    task->body.ops          = &tree_op_table;
+    watch_info              = MVM_calloc(1, sizeof(TreeWatchInfo));
+    watch_info->path        = c_path;
+    watch_info->coalesce_ms = coalesce_ms;
+    watch_info->work_idx    = -1;
+    task->body.data         = watch_info;
+
+    /* Hand the task off to the event loop. */
+    MVMROOT(tc, task, {
+        MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+    });
+
+    return (MVMObject *)task;
+}
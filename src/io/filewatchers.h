@@ -1,2 +1,5 @@
 MVMObject * MVM_io_file_watch(MVMThreadContext *tc, MVMObject *queue,
     MVMObject *schedulee, MVMString *path, MVMObject *async_type);
+MVMObject * MVM_io_file_watch_tree(MVMThreadContext *tc, MVMObject *queue,
+    MVMObject *schedulee, MVMString *path, MVMObject *async_type,
+    MVMint64 coalesce_ms);
@@ -103,7 +103,9 @@ MVMint64 MVM_io_tell(MVMThreadContext *tc, MVMObject *oshandle) {
 
 void MVM_io_read_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *result, MVMint64 length) {
     MVMOSHandle *handle = verify_is_handle(tc, oshandle, "read bytes");
-    MVMuint64 bytes_read;
+    MVMint64 bytes_read = -1;
+    size_t skip = 0;
+    MVMuint8 mapped = 0;
     char *buf;
 
     /* Ensure the target is in the correct form. */
@@ -119,18 +121,84 @@ void MVM_io_read_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *res
     if (handle->body.ops->sync_readable) {
         MVMROOT2(tc, handle, result, {
             uv_mutex_t *mutex = acquire_mutex(tc, handle);
-            bytes_read = handle->body.ops->sync_readable->read_bytes(tc, handle, &buf, length);
+            const MVMIOSyncReadable *readable = handle->body.ops->sync_readable;
+            if (readable->map_bytes && length >= MVM_IO_MAP_READ_MIN)
+                bytes_read = readable->map_bytes(tc, handle, &buf, &skip, length);
+            if (bytes_read < 0) {
+                skip = 0;
+                bytes_read = readable->read_bytes(tc, handle, &buf, length);
+            }
+            else {
+                mapped = 1;
+            }
             release_mutex(tc, mutex);
         });
     }
     else
         MVM_exception_throw_adhoc(tc, "Cannot read characters from this kind of handle");
 
-    /* Stash the data in the VMArray. */
+    /* Stash the data in the VMArray; if it was mapped, the storage starts
+     * at the start of the mapping. */
     ((MVMArray *)result)->body.slots.i8 = (MVMint8 *)buf;
-    ((MVMArray *)result)->body.start    = 0;
-    ((MVMArray *)result)->body.ssize    = bytes_read;
+    ((MVMArray *)result)->body.start    = skip;
+    ((MVMArray *)result)->body.ssize    = skip + bytes_read;
     ((MVMArray *)result)->body.elems    = bytes_read;
+    ((MVMArray *)result)->body.mapped   = mapped;
+}
+
+/* Checks if what we were asked to write is a list of buffers (that is, a
+ * native array of objects) rather than a single buffer. */
+MVMint64 MVM_io_is_buffer_list(MVMThreadContext *tc, MVMObject *buffer) {
+    return IS_CONCRETE(buffer) && REPR(buffer)->ID == MVM_REPR_ID_VMArray
+        && ((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type == MVM_ARRAY_OBJ;
+}
+
+/* Fills in a uv_buf_t for each of up to max buffers in a list of them,
+ * starting from the given index, and returns how many were filled in. The
+ * buffers must be native arrays of uint8 or int8. */
+MVMuint32 MVM_io_buffer_list_bufs(MVMThreadContext *tc, MVMObject *list, MVMuint64 from,
+        uv_buf_t *bufs, MVMuint32 max, const char *op) {
+    MVMArrayBody *body  = &((MVMArray *)list)->body;
+    MVMuint32     count = 0;
+    while (count < max && from + count < body->elems) {
+        MVMObject *buffer = body->slots.o[body->start + from + count];
+        MVMuint8   slot_type;
+        if (!buffer || !IS_CONCRETE(buffer) || REPR(buffer)->ID != MVM_REPR_ID_VMArray)
+            MVM_exception_throw_adhoc(tc, "%s requires a list of native arrays", op);
+        slot_type = ((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type;
+        if (slot_type != MVM_ARRAY_U8 && slot_type != MVM_ARRAY_I8)
+            MVM_exception_throw_adhoc(tc, "%s requires a list of native arrays of uint8 or int8", op);
+        bufs[count] = uv_buf_init(
+            (char *)(((MVMArray *)buffer)->body.slots.i8 + ((MVMArray *)buffer)->body.start),
+            (unsigned int)((MVMArray *)buffer)->body.elems);
+        count++;
+    }
+    return count;
+}
+
+/* Writes a list of buffers, a batch at a time, using the handle's vectored
+ * write if it has one. */
+static void write_buffer_list(MVMThreadContext *tc, MVMOSHandle *handle, MVMObject *list) {
+    MVMROOT2(tc, handle, list, {
+        uv_mutex_t *mutex = acquire_mutex(tc, handle);
+        const MVMIOSyncWritable *writable = handle->body.ops->sync_writable;
+        uv_buf_t bufs[MVM_IO_WRITEV_BATCH];
+        MVMuint64 from = 0;
+        MVMuint32 count;
+        while ((count = MVM_io_buffer_list_bufs(tc, list, from, bufs,
+                MVM_IO_WRITEV_BATCH, "write_fhb")) > 0) {
+            if (writable->write_bytes_vec) {
+                writable->write_bytes_vec(tc, handle, bufs, count);
+            }
+            else {
+                MVMuint32 i;
+                for (i = 0; i < count; i++)
+                    writable->write_bytes(tc, handle, bufs[i].base, bufs[i].len);
+            }
+            from += count;
+        }
+        release_mutex(tc, mutex);
+    });
 }
 
 void MVM_io_write_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *buffer) {
@@ -138,6 +206,14 @@ void MVM_io_write_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *bu
     char *output;
     MVMuint64 output_size;
 
+    /* A list of buffers is written in as few calls as we can manage. */
+    if (MVM_io_is_buffer_list(tc, buffer)) {
+        if (!handle->body.ops->sync_writable)
+            MVM_exception_throw_adhoc(tc, "Cannot write bytes to this kind of handle");
+        write_buffer_list(tc, handle, buffer);
+        return;
+    }
+
     /* Ensure the target is in the correct form. */
     if (!IS_CONCRETE(buffer) || REPR(buffer)->ID != MVM_REPR_ID_VMArray)
         MVM_exception_throw_adhoc(tc, "write_fhb requires a native array to read from");
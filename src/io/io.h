@@ -31,15 +31,32 @@ struct MVMIOClosable {
 struct MVMIOSyncReadable {
     MVMint64 (*read_bytes) (MVMThreadContext *tc, MVMOSHandle *h, char **buf, MVMuint64 bytes);
     MVMint64 (*eof) (MVMThreadContext *tc, MVMOSHandle *h);
+
+    /* Optionally, maps the bytes rather than reading them, for reads of at
+     * least MVM_IO_MAP_READ_MIN bytes. Hands back the start of the mapping
+     * in buf and how far into it the bytes start in skip. Returns -1 if
+     * they can't be mapped, in which case they are read instead. */
+    MVMint64 (*map_bytes) (MVMThreadContext *tc, MVMOSHandle *h, char **buf, size_t *skip, MVMuint64 bytes);
 };
 
+/* The smallest read that a handle will be asked to map rather than read. */
+#define MVM_IO_MAP_READ_MIN (1024 * 1024)
+
 /* I/O operations on handles that can do synchronous writing. */
 struct MVMIOSyncWritable {
     MVMint64 (*write_bytes) (MVMThreadContext *tc, MVMOSHandle *h, char *buf, MVMuint64 bytes);
     void (*flush) (MVMThreadContext *tc, MVMOSHandle *h, MVMint32 sync);
     void (*truncate) (MVMThreadContext *tc, MVMOSHandle *h, MVMint64 bytes);
+
+    /* Optionally, writes a number of buffers in one go, as when a list of
+     * buffers is written. May change the uv_buf_t entries it is given. If
+     * not implemented, each buffer is passed to write_bytes in turn. */
+    MVMint64 (*write_bytes_vec) (MVMThreadContext *tc, MVMOSHandle *h, uv_buf_t *bufs, MVMuint32 count);
 };
 
+/* How many buffers of a list of them are handed to write_bytes_vec at once. */
+#define MVM_IO_WRITEV_BATCH 64
+
 /* I/O operations on handles that can do asynchronous reading. */
 struct MVMIOAsyncReadable {
     MVMAsyncTask * (*read_bytes) (MVMThreadContext *tc, MVMOSHandle *h, MVMObject *queue,
@@ -92,6 +109,9 @@ void MVM_io_seek(MVMThreadContext *tc, MVMObject *oshandle, MVMint64 offset, MVM
 MVMint64 MVM_io_tell(MVMThreadContext *tc, MVMObject *oshandle);
 void MVM_io_read_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *result, MVMint64 length);
 void MVM_io_write_bytes(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *buffer);
+MVMint64 MVM_io_is_buffer_list(MVMThreadContext *tc, MVMObject *buffer);
+MVMuint32 MVM_io_buffer_list_bufs(MVMThreadContext *tc, MVMObject *list, MVMuint64 from,
+    uv_buf_t *bufs, MVMuint32 max, const char *op);
 void MVM_io_write_bytes_c(MVMThreadContext *tc, MVMObject *oshandle, char *output,
     MVMuint64 output_size);
 MVMObject * MVM_io_read_bytes_async(MVMThreadContext *tc, MVMObject *oshandle, MVMObject *queue,
@@ -21,6 +21,32 @@ extern char **environ;
 #include <stdlib.h>
 #endif
 
+/* Where posix_spawn can also change the working directory of the child, we
+ * can start async processes with it rather than libuv's fork, which has to
+ * copy the page tables of our (potentially very large) heap. glibc and macOS
+ * implement it with a vfork-style clone, which doesn't. */
+#if defined(__APPLE__)
+#  define MVM_SPAWN_FAST_PATH 1
+#elif defined(__GLIBC__)
+#  if __GLIBC_PREREQ(2, 29)
+#    define MVM_SPAWN_FAST_PATH 1
+#  endif
+#endif
+#ifndef _WIN32
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#endif
+#ifdef MVM_SPAWN_FAST_PATH
+#include <spawn.h>
+#endif
+
 #ifdef _WIN32
 static wchar_t * ANSIToUnicode(MVMuint16 acp, const char *str)
 {
@@ -120,6 +146,7 @@ MVMObject * MVM_proc_getenvhash(MVMThreadContext *tc) {
         MVM_gc_root_temp_pop_n(tc, 2);
 
         instance->env_hash = env_hash;
+        MVM_gc_note_escape(tc);
 
         return env_hash;
     }
@@ -153,8 +180,10 @@ MVMObject * MVM_proc_getenvhash(MVMThreadContext *tc) {
 
 /* Data that we keep for an asynchronous process handle. */
 typedef struct {
-    /* The libuv handle to the process. */
+    /* The libuv handle to the process, or, if it was started without libuv,
+     * its process ID (zero once it has exited). */
     uv_process_t *handle;
+    MVMint64      pid;
 
     /* The async task handle, provided we're running. */
     MVMObject *async_task;
@@ -196,6 +225,7 @@ typedef struct {
     int                using;
     int                merge;
     size_t             last_read;
+    int                pid;
 } SpawnInfo;
 
 /* Info we convey about a write task. */
@@ -464,9 +494,10 @@ static void spawn_async_close(uv_handle_t *handle) {
     MVM_free(handle);
 }
 
-static void async_spawn_on_exit(uv_process_t *req, MVMint64 exit_status, int term_signal) {
+/* Reports the exit of a spawned process and cleans up after it; watcher is
+ * the handle we were told about the exit through, and is closed. */
+static void spawn_exited(SpawnInfo *si, uv_handle_t *watcher, MVMint64 exit_status, int term_signal) {
     /* Check we've got a callback to fire. */
-    SpawnInfo        *si  = (SpawnInfo *)req->data;
     MVMThreadContext *tc  = si->tc;
     MVMObject *done_cb = MVM_repr_at_key_o(tc, si->callbacks,
         tc->instance->str_consts.done);
@@ -507,12 +538,17 @@ static void async_spawn_on_exit(uv_process_t *req, MVMint64 exit_status, int ter
     }
 
     /* Close handle. */
-    uv_close((uv_handle_t *)req, spawn_async_close);
+    uv_close(watcher, spawn_async_close);
     ((MVMIOAsyncProcessData *)((MVMOSHandle *)si->handle)->body.data)->handle = NULL;
+    ((MVMIOAsyncProcessData *)((MVMOSHandle *)si->handle)->body.data)->pid = 0;
     if (--si->using == 0)
         MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
 }
 
+static void async_spawn_on_exit(uv_process_t *req, MVMint64 exit_status, int term_signal) {
+    spawn_exited((SpawnInfo *)req->data, (uv_handle_t *)req, exit_status, term_signal);
+}
+
 #ifndef MIN
     #define MIN(x,y) ((x)<(y)?(x):(y))
 #endif
@@ -658,11 +694,194 @@ static MVMint64 get_pipe_fd(MVMThreadContext *tc, uv_pipe_t *pipe) {
     else
         return 0;
 }
+#ifdef MVM_SPAWN_FAST_PATH
+/* Reaps a process we started with posix_spawn once it has exited. libuv only
+ * ever waits for the processes it started itself, so we don't race it. */
+static void on_child_signal(uv_signal_t *handle, int signum) {
+    SpawnInfo *si = (SpawnInfo *)handle->data;
+    int        status;
+    pid_t      result;
+    do {
+        result = waitpid(si->pid, &status, WNOHANG);
+    } while (result < 0 && errno == EINTR);
+    if (result == si->pid) {
+        uv_signal_stop(handle);
+        spawn_exited(si, (uv_handle_t *)handle,
+            WIFEXITED(status) ? WEXITSTATUS(status) : 0,
+            WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+    }
+    else if (result < 0 && errno == ECHILD) {
+        /* Something else reaped it, so we'll never know how it went; but we
+         * still must not wait for it forever. */
+        uv_signal_stop(handle);
+        spawn_exited(si, (uv_handle_t *)handle, 0, 0);
+    }
+}
+
+/* Finds the program to run the way execvp would, but using the PATH of the
+ * environment the child gets, as libuv does. Returns NULL if it isn't found
+ * or the search depends on the directory the child runs in; we then leave it
+ * to libuv, which also reports the error. */
+static char * find_program(const char *prog, char **env) {
+    size_t      prog_len = strlen(prog);
+    const char *path     = "/usr/bin:/bin";
+    const char *start, *end;
+    MVMuint32   i;
+    if (strchr(prog, '/')) {
+        char *copy = MVM_malloc(prog_len + 1);
+        memcpy(copy, prog, prog_len + 1);
+        return copy;
+    }
+    for (i = 0; env[i]; i++) {
+        if (strncmp(env[i], "PATH=", 5) == 0) {
+            path = env[i] + 5;
+            break;
+        }
+    }
+    for (start = path; ; start = end + 1) {
+        struct stat  st;
+        size_t       dir_len;
+        char        *candidate;
+        end = strchr(start, ':');
+        if (!end)
+            end = start + strlen(start);
+        if (*start != '/')
+            return NULL;
+        dir_len   = end - start;
+        candidate = MVM_malloc(dir_len + prog_len + 2);
+        memcpy(candidate, start, dir_len);
+        candidate[dir_len] = '/';
+        memcpy(candidate + dir_len + 1, prog, prog_len + 1);
+        if (stat(candidate, &st) == 0 && S_ISREG(st.st_mode) && access(candidate, X_OK) == 0)
+            return candidate;
+        MVM_free(candidate);
+        if (!*end)
+            return NULL;
+    }
+}
+
+/* Makes a close-on-exec socket pair, which is what libuv uses for pipes to
+ * child processes too. */
+static int make_socketpair(int fds[2]) {
+#ifdef SOCK_CLOEXEC
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+        return -errno;
+#else
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+        return -errno;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+    return 0;
+}
+
+/* Starts the process with posix_spawn, setting up its standard handles as
+ * described by stdio. Returns 0 on success and a libuv error code on failure,
+ * UV_ENOSYS meaning that it has to be started by libuv instead. */
+static int spawn_fast(MVMThreadContext *tc, uv_loop_t *loop, SpawnInfo *si,
+                      uv_stdio_container_t *stdio, int *pid) {
+    posix_spawn_file_actions_t   actions;
+    posix_spawnattr_t            attr;
+    sigset_t                     signals;
+    uv_signal_t                 *watcher;
+    char                       **env         = si->env ? si->env : environ;
+    int                          parent_fd[3] = { -1, -1, -1 };
+    int                          child_fd[3]  = { -1, -1, -1 };
+    char                        *path;
+    pid_t                        child;
+    int                          i, r = 0;
+
+    /* The child's handles are put in place one after the other, so one may
+     * only come from a standard handle if it's going back to the same one. */
+    for (i = 0; i < 3; i++)
+        if (!(stdio[i].flags & UV_CREATE_PIPE) && stdio[i].data.fd < 3 && stdio[i].data.fd != i)
+            return UV_ENOSYS;
+    path = find_program(si->prog, env);
+    if (!path)
+        return UV_ENOSYS;
+
+    /* Create the pipes, and describe how to hand the child its ends. */
+    posix_spawn_file_actions_init(&actions);
+    for (i = 0; i < 3 && r == 0; i++) {
+        if (stdio[i].flags & UV_CREATE_PIPE) {
+            int fds[2];
+            r = make_socketpair(fds);
+            if (r == 0) {
+                parent_fd[i] = fds[0];
+                child_fd[i]  = fds[1];
+                if (fds[1] < 3)
+                    r = UV_ENOSYS;
+                else
+                    r = -posix_spawn_file_actions_adddup2(&actions, fds[1], i);
+            }
+        }
+#ifdef __APPLE__
+        else if (stdio[i].data.fd == i) {
+            r = -posix_spawn_file_actions_addinherit_np(&actions, i);
+        }
+#endif
+        else {
+            /* A dup2 onto itself clears close-on-exec, as of glibc 2.29. */
+            r = -posix_spawn_file_actions_adddup2(&actions, stdio[i].data.fd, i);
+        }
+    }
+    if (r == 0 && si->cwd && *si->cwd)
+        r = -posix_spawn_file_actions_addchdir_np(&actions, si->cwd);
+
+    /* The child starts out with default signal handling and nothing blocked,
+     * as it would from libuv. */
+    posix_spawnattr_init(&attr);
+    sigfillset(&signals);
+    sigdelset(&signals, SIGKILL);
+    sigdelset(&signals, SIGSTOP);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    /* Watch for the exit before starting it, so we can't miss it. */
+    watcher = MVM_malloc(sizeof(uv_signal_t));
+    uv_signal_init(loop, watcher);
+    watcher->data = si;
+    if (r == 0)
+        r = uv_signal_start(watcher, on_child_signal, SIGCHLD);
+    if (r == 0) {
+        r = -posix_spawn(&child, path, &actions, &attr, si->args, env);
+        if (r == 0)
+            si->pid = *pid = (int)child;
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    MVM_free(path);
+
+    /* Close the child's ends of the pipes, and open ours. */
+    for (i = 0; i < 3; i++) {
+        if (child_fd[i] >= 0)
+            close(child_fd[i]);
+        if (parent_fd[i] >= 0) {
+            if (r == 0)
+                uv_pipe_open((uv_pipe_t *)stdio[i].data.stream, parent_fd[i]);
+            else
+                close(parent_fd[i]);
+        }
+    }
+    if (r != 0) {
+        uv_close((uv_handle_t *)watcher, spawn_async_close);
+        /* posix_spawn won't run scripts without a #! line, but execvp will;
+         * leave those to libuv too. */
+        if (r == -ENOEXEC)
+            r = UV_ENOSYS;
+    }
+    return r;
+}
+#endif
+
 static void spawn_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
-    MVMint64 spawn_result;
+    MVMint64 spawn_result = UV_ENOSYS;
+    int      pid          = 0;
 
     /* Process info setup. */
-    uv_process_t *process = MVM_calloc(1, sizeof(uv_process_t));
+    uv_process_t *process = NULL;
     uv_process_options_t process_options = {0};
     uv_stdio_container_t process_stdio[3];
 
@@ -754,9 +973,18 @@ static void spawn_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
     process_options.stdio_count = 3;
     process_options.exit_cb     = async_spawn_on_exit;
 
-    /* Attach data, spawn, report any error. */
-    process->data = si;
-    spawn_result  = uv_spawn(loop, process, &process_options);
+    /* Spawn, preferring posix_spawn unless we were asked not to or it can't
+     * do what's needed, and report any error. */
+#ifdef MVM_SPAWN_FAST_PATH
+    if (!tc->instance->spawn_use_libuv)
+        spawn_result = spawn_fast(tc, loop, si, process_stdio, &pid);
+#endif
+    if (spawn_result == UV_ENOSYS) {
+        process       = MVM_calloc(1, sizeof(uv_process_t));
+        process->data = si;
+        spawn_result  = uv_spawn(loop, process, &process_options);
+        pid           = process->pid;
+    }
     if (spawn_result) {
         MVMObject *msg_box = NULL;
         si->state = STATE_DONE;
@@ -823,13 +1051,14 @@ static void spawn_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
         MVMObject *ready_cb = MVM_repr_at_key_o(tc, si->callbacks,
             tc->instance->str_consts.ready);
         apd->handle = process;
+        apd->pid    = pid;
         si->state = STATE_STARTED;
 
         if (!MVM_is_null(tc, ready_cb)) {
             MVMROOT2(tc, ready_cb, async_task, {
                 MVMObject *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
                 MVMROOT(tc, arr, {
-                    MVMObject *pid;
+                    MVMObject *pid_box;
                     MVMObject *handle_arr = MVM_repr_alloc_init(tc,
                         tc->instance->boot_types.BOOTIntArray);
                     MVM_repr_push_i(tc, handle_arr, si->pipe_stdout
@@ -840,8 +1069,8 @@ static void spawn_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
                         : -1);
                     MVM_repr_push_o(tc, arr, ready_cb);
                     MVM_repr_push_o(tc, arr, handle_arr);
-                    pid = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, process->pid);
-                    MVM_repr_push_o(tc, arr, pid);
+                    pid_box = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, pid);
+                    MVM_repr_push_o(tc, arr, pid_box);
                     MVM_repr_push_o(tc, ((MVMAsyncTask *)async_task)->body.queue, arr);
                 });
             });
@@ -922,7 +1151,8 @@ static void spawn_cancel(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async
     uv_process_t          *phandle = apd->handle;
 
     /* If it didn't already end, try to kill it. exit_cb will clean up phandle
-     * should the signal lead to process exit. */
+     * (or the pid, for processes we started without libuv) should the signal
+     * lead to process exit. */
     if (phandle) {
 #ifdef _WIN32
         /* On Windows, make sure we use a signal that will actually work. */
@@ -931,6 +1161,9 @@ static void spawn_cancel(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async
 #endif
         uv_process_kill(phandle, (int)apd->signal);
     }
+    else if (apd->pid) {
+        uv_kill((int)apd->pid, (int)apd->signal);
+    }
 }
 
 /* Marks objects for a spawn task. */
@@ -972,6 +1205,106 @@ static const MVMAsyncTaskOps spawn_op_table = {
     spawn_gc_free
 };
 
+/* Variable names are case insensitive on Windows. */
+#ifdef _WIN32
+#  define ENV_NAME_EQ(a, b, len) (_strnicmp((a), (b), (len)) == 0)
+#else
+#  define ENV_NAME_EQ(a, b, len) (strncmp((a), (b), (len)) == 0)
+#endif
+
+/* Makes the environment for a child from the one this process has, with
+ * the variables in the delta hash set to their values, or removed if the
+ * value is null or a type object. This saves building and encoding a hash
+ * of the whole environment for each process spawned, when all that changes
+ * are a few variables. */
+static char ** env_with_delta(MVMThreadContext *tc, MVMObject *delta) {
+    MVMuint64   delta_size = MVM_repr_elems(tc, delta);
+    char      **names      = MVM_malloc((delta_size + 1) * sizeof(char *));
+    char      **settings   = MVM_malloc((delta_size + 1) * sizeof(char *));
+    size_t     *name_lens  = MVM_malloc((delta_size + 1) * sizeof(size_t));
+    MVMIter    *iter       = (MVMIter *)MVM_iter(tc, delta);
+    MVMuint64   parent_size = 0, num = 0, i, j;
+    char      **env;
+
+    /* Encode the changes. */
+    MVMROOT(tc, iter, {
+        i = 0;
+        while (MVM_iter_istrue(tc, iter)) {
+            MVMObject *value;
+            MVM_repr_shift_o(tc, (MVMObject *)iter);
+            names[i]     = MVM_string_utf8_c8_encode_C_string(tc, MVM_iterkey_s(tc, iter));
+            name_lens[i] = strlen(names[i]);
+            value        = MVM_iterval(tc, iter);
+            if (MVM_is_null(tc, value) || !IS_CONCRETE(value)) {
+                settings[i] = NULL;
+            }
+            else {
+                char   *val     = MVM_string_utf8_c8_encode_C_string(tc, MVM_repr_get_str(tc, value));
+                size_t  val_len = strlen(val);
+                settings[i] = MVM_malloc(name_lens[i] + val_len + 2);
+                memcpy(settings[i], names[i], name_lens[i]);
+                settings[i][name_lens[i]] = '=';
+                memcpy(settings[i] + name_lens[i] + 1, val, val_len + 1);
+                MVM_free(val);
+            }
+            i++;
+        }
+        delta_size = i;
+    });
+
+    /* Copy the variables of this process that aren't changed. */
+#ifndef _WIN32
+    while (environ[parent_size])
+        parent_size++;
+#else
+    (void) _wgetenv(L"windows"); /* populate _wenviron */
+    while (_wenviron[parent_size])
+        parent_size++;
+#endif
+    env = MVM_malloc((parent_size + delta_size + 1) * sizeof(char *));
+    for (i = 0; i < parent_size; i++) {
+#ifndef _WIN32
+        const char *var = environ[i];
+#else
+        char       *var = UnicodeToUTF8(_wenviron[i]);
+#endif
+        const char *equal    = strchr(var, '=');
+        size_t      name_len = equal ? (size_t)(equal - var) : strlen(var);
+        MVMuint32   changed  = 0;
+        for (j = 0; j < delta_size; j++) {
+            if (name_lens[j] == name_len && ENV_NAME_EQ(names[j], var, name_len)) {
+                changed = 1;
+                break;
+            }
+        }
+#ifndef _WIN32
+        if (!changed) {
+            size_t len = strlen(var);
+            env[num] = MVM_malloc(len + 1);
+            memcpy(env[num++], var, len + 1);
+        }
+#else
+        if (changed)
+            MVM_free(var);
+        else
+            env[num++] = var;
+#endif
+    }
+
+    /* Add the ones that are set. */
+    for (i = 0; i < delta_size; i++) {
+        if (settings[i])
+            env[num++] = settings[i];
+        MVM_free(names[i]);
+    }
+    env[num] = NULL;
+
+    MVM_free(names);
+    MVM_free(settings);
+    MVM_free(name_lens);
+    return env;
+}
+
 /* Spawn a process asynchronously. */
 MVMObject * MVM_proc_spawn_async(MVMThreadContext *tc, MVMObject *queue, MVMObject *argv,
                                  MVMString *cwd, MVMObject *env, MVMObject *callbacks) {
@@ -1006,11 +1339,20 @@ MVMObject * MVM_proc_spawn_async(MVMThreadContext *tc, MVMObject *queue, MVMObje
     MVMROOT3(tc, queue, env, callbacks, {
         MVMIOAsyncProcessData *data;
 
-        /* Encode environment. */
-        size = MVM_repr_elems(tc, env);
-        iter = (MVMIter *)MVM_iter(tc, env);
-        _env = MVM_malloc((size + 1) * sizeof(char *));
-        INIT_ENV();
+        /* Encode environment. Without one, the child inherits ours; with
+         * env_delta set, it's ours with the changes in the hash made. */
+        if (MVM_is_null(tc, env) || !IS_CONCRETE(env)) {
+            _env = NULL;
+        }
+        else if (MVM_repr_exists_key(tc, callbacks, tc->instance->str_consts.env_delta)) {
+            _env = env_with_delta(tc, env);
+        }
+        else {
+            size = MVM_repr_elems(tc, env);
+            iter = (MVMIter *)MVM_iter(tc, env);
+            _env = MVM_malloc((size + 1) * sizeof(char *));
+            INIT_ENV();
+        }
 
         /* Create handle. */
         data              = MVM_calloc(1, sizeof(MVMIOAsyncProcessData));
@@ -1141,6 +1483,7 @@ MVMObject * MVM_proc_clargs(MVMThreadContext *tc) {
         });
 
         instance->clargs = clargs;
+        MVM_gc_note_escape(tc);
     }
     return clargs;
 }
@@ -1214,13 +1557,17 @@ The simplest way of doing this that I can see is:
 
 */
 
-MVMint64 MVM_proc_fork(MVMThreadContext *tc) {
+/* Does the work of MVM_proc_fork, but rather than throwing if it can't fork,
+ * returns -1 and sets the error. */
+static MVMint64 try_fork(MVMThreadContext *tc, const char **error) {
     MVMInstance *instance = tc->instance;
-    const char *error = NULL;
     MVMint64 pid = -1;
 
-    if (!MVM_platform_supports_fork(tc))
-        MVM_exception_throw_adhoc(tc, "This platform does not support fork()");
+    *error = NULL;
+    if (!MVM_platform_supports_fork(tc)) {
+        *error = "This platform does not support fork()";
+        return -1;
+    }
 
     /* Acquire the necessary locks. The event loop mutex will protect
      * modification of the event loop. Nothing yet protects against the
@@ -1235,8 +1582,11 @@ MVMint64 MVM_proc_fork(MVMThreadContext *tc) {
     MVM_io_eventloop_stop(tc);
     MVM_spesh_worker_join(tc);
     MVM_io_eventloop_join(tc);
-    /* Allow MVM_io_eventloop_start to restart the thread if necessary */
-    instance->event_loop_thread = NULL;
+    MVM_finalize_stop_threads(tc);
+    MVM_scheduler_halt(tc);
+    MVM_serialization_stop_threads(tc);
+    /* Allow MVM_io_eventloop_start to restart the threads if necessary */
+    MVM_io_eventloop_forget_threads(tc);
 
     MVM_gc_mark_thread_blocked(tc);
     uv_mutex_lock(&instance->mutex_threads);
@@ -1246,28 +1596,317 @@ MVMint64 MVM_proc_fork(MVMThreadContext *tc) {
     if (MVM_thread_cleanup_threads_list(tc, &instance->threads) == 1) {
         pid = MVM_platform_fork(tc);
     } else {
-        error = "Program has more than one active thread";
+        *error = "fork() failed: Program has more than one active thread";
     }
 
-    if (pid == 0 && instance->event_loop) {
+    if (pid == 0) {
         /* Reinitialize uv_loop_t after fork in child */
-        uv_loop_fork(instance->event_loop);
+        MVMuint32 i;
+        for (i = 0; i < instance->num_event_loops; i++)
+            if (instance->event_loops[i].loop)
+                uv_loop_fork(instance->event_loops[i].loop);
     }
 
     /* Release the thread lock, otherwise we can't start them */
     uv_mutex_unlock(&instance->mutex_threads);
     /* Without the mutex_event_loop being held, this might race */
     MVM_spesh_worker_start(tc);
+    MVM_finalize_start_threads(tc);
+    MVM_scheduler_resume(tc);
+    MVM_serialization_start_threads(tc);
 
     /* However, locks are nonrecursive, so unlocking is needed prior to
      * restarting the event loop */
     uv_mutex_unlock(&instance->mutex_event_loop);
-    if (instance->event_loop)
+    if (instance->event_loops[0].loop)
         MVM_io_eventloop_start(tc);
 
-    if (error != NULL)
-        MVM_exception_throw_adhoc(tc, "fork() failed: %s\n", error);
+    return pid;
+}
 
+MVMint64 MVM_proc_fork(MVMThreadContext *tc) {
+    const char *error;
+    MVMint64 pid = try_fork(tc, &error);
+    if (error != NULL)
+        MVM_exception_throw_adhoc(tc, "%s\n", error);
     return pid;
+}
+
+/*
+
+=item MVM_proc_fork_server
+
+Serves requests to start processes from a warmed-up VM, which spares them
+the work of getting it there, such as loading modules. Heap images can't be
+made, since the heap is full of pointers to C structures, libraries and
+code; but a fork shares the warmed-up heap with the child just as well.
+
+A Unix domain socket is made at the given path, and each connection to it
+carries one request. The client sends a 32-bit length (in native byte order)
+with the three file descriptors to use as the standard input, output and
+error of the new process attached (as SCM_RIGHTS), followed by that many
+bytes: the working directory to start in (or nothing, to stay put) and then
+each of the arguments, all NUL-terminated. The server forks; in the child,
+this function returns the arguments as a list of strings, with the standard
+handles and working directory changed over. The parent goes on serving,
+and once the child exits sends the client its status as a 32-bit integer
+(in the same form as that reported to spawnprocasync's done callback), or
+-1 if the fork failed, and closes the connection.
+
+The server only returns in the children, unless something goes wrong with
+the socket, and the same restrictions as for fork apply; if it can't fork at
+all, it closes everything it has open and throws. A client has a second for
+each read of its request before it is hung up on.
+
+=cut
+
+*/
+#ifndef _WIN32
+#define FORK_SERVER_MAX_REQUEST 65536
+#define FORK_SERVER_REAP_INTERVAL_MS 50
+#define FORK_SERVER_READ_TIMEOUT_MS 1000
+
+typedef struct {
+    pid_t pid;
+    int   conn;
+} ForkServerChild;
+
+/* Sends the client of a fork server its child's status and hangs up. */
+static void fork_server_reply(int conn, MVMint32 status) {
+    ssize_t r;
+    do {
+        r = send(conn, &status, sizeof(status), 0);
+    } while (r < 0 && errno == EINTR);
+    close(conn);
+}
+
+/* Reads a request from a connection to a fork server. Returns the payload,
+ * with the length in *len and the descriptors in fds, or NULL if the request
+ * is bad. */
+static char * fork_server_read_request(MVMThreadContext *tc, int conn, int fds[3], MVMuint32 *len) {
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    char            control[CMSG_SPACE(3 * sizeof(int))];
+    char           *payload;
+    MVMuint32       got = 0;
+    ssize_t         r;
+    int             have_fds = 0;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base       = len;
+    iov.iov_len        = sizeof(*len);
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    do {
+        r = recvmsg(conn, &msg, 0);
+    } while (r < 0 && errno == EINTR);
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t num_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            if (num_fds == 3 && !have_fds) {
+                memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+                have_fds = 1;
+            }
+            else {
+                /* Don't leak anything we weren't expecting. */
+                size_t i;
+                for (i = 0; i < num_fds; i++)
+                    close(((int *)CMSG_DATA(cmsg))[i]);
+            }
+        }
+    }
+    if (r != sizeof(*len) || !have_fds || *len > FORK_SERVER_MAX_REQUEST) {
+        if (have_fds) {
+            close(fds[0]);
+            close(fds[1]);
+            close(fds[2]);
+        }
+        return NULL;
+    }
 
+    payload = MVM_malloc(*len + 1);
+    while (got < *len) {
+        r = recv(conn, payload + got, *len - got, 0);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            MVM_free(payload);
+            close(fds[0]);
+            close(fds[1]);
+            close(fds[2]);
+            return NULL;
+        }
+        got += r;
+    }
+    payload[*len] = '\0';
+    return payload;
+}
+
+/* Reaps any children of a fork server that have exited, sending on their
+ * status. */
+static void fork_server_reap(ForkServerChild *children, MVMuint32 *num_children) {
+    MVMuint32 i = 0;
+    while (i < *num_children) {
+        int status;
+        if (waitpid(children[i].pid, &status, WNOHANG) == children[i].pid) {
+            MVMint32 result = WIFEXITED(status)
+                ? WEXITSTATUS(status) << 8
+                : (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+            fork_server_reply(children[i].conn, result);
+            children[i] = children[--*num_children];
+        }
+        else {
+            i++;
+        }
+    }
+}
+#endif
+
+MVMObject * MVM_proc_fork_server(MVMThreadContext *tc, MVMString *path) {
+#ifdef _WIN32
+    MVM_exception_throw_adhoc(tc, "forkserver is not supported on this platform");
+#else
+    struct sockaddr_un  addr;
+    char               *c_path = MVM_string_utf8_c8_encode_C_string(tc, path);
+    ForkServerChild    *children;
+    MVMuint32           num_children = 0, alloc_children = 8;
+    int                 listener;
+
+    /* Set up the socket. */
+    if (strlen(c_path) >= sizeof(addr.sun_path)) {
+        MVM_free(c_path);
+        MVM_exception_throw_adhoc(tc, "forkserver socket path is too long");
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, c_path);
+    MVM_free(c_path);
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        MVM_exception_throw_adhoc(tc, "forkserver failed to make a socket: %s", strerror(errno));
+    fcntl(listener, F_SETFD, FD_CLOEXEC);
+    unlink(addr.sun_path);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0) {
+        int error = errno;
+        close(listener);
+        MVM_exception_throw_adhoc(tc, "forkserver failed to listen: %s", strerror(error));
+    }
+
+    children = MVM_malloc(alloc_children * sizeof(ForkServerChild));
+    while (1) {
+        struct pollfd  pfd;
+        char          *payload = NULL;
+        const char    *error;
+        MVMuint32      len;
+        MVMint64       pid;
+        int            fds[3];
+        int            ready, conn = -1;
+
+        /* Wait for a request, passing on the status of any children that
+         * exit in the meantime. */
+        fork_server_reap(children, &num_children);
+        pfd.fd     = listener;
+        pfd.events = POLLIN;
+        MVM_gc_mark_thread_blocked(tc);
+        ready = poll(&pfd, 1, FORK_SERVER_REAP_INTERVAL_MS);
+        if (ready > 0) {
+            conn = accept(listener, NULL, NULL);
+            if (conn >= 0) {
+                /* A client that goes quiet mustn't hold up all the others. */
+                struct timeval timeout;
+                timeout.tv_sec  = FORK_SERVER_READ_TIMEOUT_MS / 1000;
+                timeout.tv_usec = (FORK_SERVER_READ_TIMEOUT_MS % 1000) * 1000;
+                setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                payload = fork_server_read_request(tc, conn, fds, &len);
+            }
+        }
+        MVM_gc_mark_thread_unblocked(tc);
+        if (ready < 0 && errno != EINTR) {
+            int error = errno;
+            close(listener);
+            MVM_free(children);
+            MVM_exception_throw_adhoc(tc, "forkserver failed to wait for requests: %s",
+                strerror(error));
+        }
+        if (ready <= 0 || conn < 0)
+            continue;
+        if (!payload) {
+            close(conn);
+            continue;
+        }
+        fcntl(conn, F_SETFD, FD_CLOEXEC);
+
+        /* Fork, not leaving anything buffered for both processes to write.
+         * If we can't fork at all, we never will, so give up serving. */
+        MVM_io_flush_standard_handles(tc);
+        pid = try_fork(tc, &error);
+        if (error) {
+            MVMuint32 i;
+            MVM_free(payload);
+            close(fds[0]);
+            close(fds[1]);
+            close(fds[2]);
+            fork_server_reply(conn, -1);
+            for (i = 0; i < num_children; i++)
+                close(children[i].conn);
+            MVM_free(children);
+            close(listener);
+            MVM_exception_throw_adhoc(tc, "forkserver could not fork: %s", error);
+        }
+        if (pid == 0) {
+            /* We're the child: drop what the server was using, make us look
+             * like the requesting process, and hand back the arguments. */
+            MVMObject *args;
+            MVMuint32  i, pos;
+            close(listener);
+            for (i = 0; i < num_children; i++)
+                close(children[i].conn);
+            MVM_free(children);
+            close(conn);
+            for (i = 0; i < 3; i++) {
+                if (fds[i] != (int)i) {
+                    dup2(fds[i], i);
+                    close(fds[i]);
+                }
+            }
+            if (payload[0] && chdir(payload) != 0) {
+                MVM_free(payload);
+                MVM_exception_throw_adhoc(tc, "forkserver could not change directory: %s",
+                    strerror(errno));
+            }
+            args = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTStrArray);
+            MVMROOT(tc, args, {
+                pos = strlen(payload) + 1;
+                while (pos < len) {
+                    size_t arg_len = strlen(payload + pos);
+                    MVM_repr_push_s(tc, args, MVM_string_utf8_c8_decode(tc,
+                        tc->instance->VMString, payload + pos, arg_len));
+                    pos += arg_len + 1;
+                }
+            });
+            MVM_free(payload);
+            return args;
+        }
+
+        /* We're still the server. */
+        MVM_free(payload);
+        close(fds[0]);
+        close(fds[1]);
+        close(fds[2]);
+        if (pid < 0) {
+            fork_server_reply(conn, -1);
+            continue;
+        }
+        if (num_children == alloc_children) {
+            alloc_children *= 2;
+            children = MVM_realloc(children, alloc_children * sizeof(ForkServerChild));
+        }
+        children[num_children].pid  = (pid_t)pid;
+        children[num_children].conn = conn;
+        num_children++;
+    }
+#endif
 }
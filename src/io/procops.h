@@ -28,6 +28,7 @@ MVMnum64 MVM_proc_time_n(MVMThreadContext *tc);
 MVMString * MVM_executable_name(MVMThreadContext *tc);
 void MVM_proc_getrusage(MVMThreadContext *tc, MVMObject *result);
 MVMint64 MVM_proc_fork(MVMThreadContext *tc);
+MVMObject * MVM_proc_fork_server(MVMThreadContext *tc, MVMString *path);
 
 #ifdef _WIN32
 #include <wchar.h>
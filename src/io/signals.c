@@ -288,6 +288,7 @@ MVMObject * MVM_io_get_signals(MVMThreadContext *tc) {
 
         populate_instance_valid_sigs(tc, sig_wanted_vals);
         instance->sig_arr = sig_arr;
+        MVM_gc_note_escape(tc);
     });
 
     return sig_arr;
@@ -1,9 +1,12 @@
 #include "moar.h"
 #include "platform/io.h"
+#include "platform/mmap.h"
 
 #ifndef _WIN32
 #include <sys/types.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <limits.h>
 #define DEFAULT_MODE 0x01B6
 typedef struct stat STAT_t;
 #else
@@ -91,6 +94,44 @@ static void perform_write(MVMThreadContext *tc, MVMIOFileData *data, char *buf,
     data->known_writable = 1;
 }
 
+#ifndef _WIN32
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+/* Writes a number of buffers with as few writev calls as we can, moving the
+ * buffers along past whatever was written when a write is partial. */
+static void perform_writev(MVMThreadContext *tc, MVMIOFileData *data, uv_buf_t *bufs, MVMuint32 count) {
+    MVMint64 bytes_written = 0;
+    MVM_gc_mark_thread_blocked(tc);
+    while (count > 0) {
+        ssize_t r;
+        do {
+            /* libuv's uv_buf_t is laid out like a struct iovec. */
+            r = writev(data->fd, (struct iovec *)bufs, count > IOV_MAX ? IOV_MAX : (int)count);
+        } while (r == -1 && errno == EINTR);
+        if (r == -1) {
+            int save_errno = errno;
+            MVM_gc_mark_thread_unblocked(tc);
+            MVM_exception_throw_adhoc(tc, "Failed to write bytes to filehandle: %s",
+                strerror(save_errno));
+        }
+        bytes_written += r;
+        while (count > 0 && (size_t)r >= bufs->len) {
+            r -= bufs->len;
+            bufs++;
+            count--;
+        }
+        if (count > 0) {
+            bufs->base += r;
+            bufs->len  -= r;
+        }
+    }
+    MVM_gc_mark_thread_unblocked(tc);
+    data->byte_position += bytes_written;
+    data->known_writable = 1;
+}
+#endif
+
 /* Flushes any existing output buffer and clears use back to 0. */
 static void flush_output_buffer(MVMThreadContext *tc, MVMIOFileData *data) {
     if (data->output_buffer_used) {
@@ -159,6 +200,41 @@ static MVMint64 read_bytes(MVMThreadContext *tc, MVMOSHandle *h, char **buf_out,
     return bytes_read;
 }
 
+/* Maps the next bytes of a regular file instead of reading them, so that big
+ * reads needn't be copied out of the page cache. */
+static MVMint64 map_bytes(MVMThreadContext *tc, MVMOSHandle *h, char **buf_out, size_t *skip, MVMuint64 bytes) {
+    MVMIOFileData *data = (MVMIOFileData *)h->body.data;
+    STAT_t statbuf;
+    MVMint64 pos;
+    char *block;
+    if (!data->seekable)
+        return -1;
+    flush_output_buffer(tc, data);
+    if (fstat(data->fd, &statbuf) == -1 || (statbuf.st_mode & S_IFMT) != S_IFREG)
+        return -1;
+    if ((pos = MVM_platform_lseek(data->fd, 0, SEEK_CUR)) == -1)
+        return -1;
+
+    /* Leave reads near or at the end of the file, including reporting EOF,
+     * to read_bytes. */
+    if (pos >= statbuf.st_size)
+        return -1;
+    if (bytes > (MVMuint64)(statbuf.st_size - pos))
+        bytes = statbuf.st_size - pos;
+    if (bytes < MVM_IO_MAP_READ_MIN)
+        return -1;
+
+    if (!(block = MVM_platform_map_file_private(data->fd, pos, bytes, skip)))
+        return -1;
+    if (MVM_platform_lseek(data->fd, pos + bytes, SEEK_SET) == -1) {
+        MVM_platform_unmap_file(block, NULL, *skip + bytes);
+        return -1;
+    }
+    *buf_out = block;
+    data->byte_position += bytes;
+    return bytes;
+}
+
 /* Checks if the end of file has been reached. */
 static MVMint64 mvm_eof(MVMThreadContext *tc, MVMOSHandle *h) {
     MVMIOFileData *data = (MVMIOFileData *)h->body.data;
@@ -220,6 +296,28 @@ static MVMint64 write_bytes(MVMThreadContext *tc, MVMOSHandle *h, char *buf, MVM
     return bytes;
 }
 
+/* Writes a number of buffers to the file handle. Small writes to a buffered
+ * handle go to the buffer, as they would one by one; otherwise, we flush it
+ * and write them all with a single writev where we can. */
+static MVMint64 write_bytes_vec(MVMThreadContext *tc, MVMOSHandle *h, uv_buf_t *bufs, MVMuint32 count) {
+    MVMIOFileData *data  = (MVMIOFileData *)h->body.data;
+    MVMuint64      total = 0;
+    MVMuint32      i;
+    for (i = 0; i < count; i++)
+        total += bufs[i].len;
+#ifndef _WIN32
+    if (!data->output_buffer_size || !data->known_writable
+            || data->output_buffer_used + total > data->output_buffer_size) {
+        flush_output_buffer(tc, data);
+        perform_writev(tc, data, bufs, count);
+        return total;
+    }
+#endif
+    for (i = 0; i < count; i++)
+        write_bytes(tc, h, bufs[i].base, bufs[i].len);
+    return total;
+}
+
 /* Flushes the file handle. */
 static void flush(MVMThreadContext *tc, MVMOSHandle *h, MVMint32 sync){
     MVMIOFileData *data = (MVMIOFileData *)h->body.data;
@@ -378,10 +476,356 @@ static void gc_free(MVMThreadContext *tc, MVMObject *h, void *d) {
     }
 }
 
+/* The size of the chunks an asynchronous read of a file is done in. */
+#define ASYNC_READ_CHUNK_SIZE 65536
+
+/* Info we convey about an asynchronous file read task. The file is read in
+ * chunks on the event loop, with libuv doing the blocking reads away from
+ * any of our threads, each chunk being sent to the task's queue. */
+typedef struct {
+    MVMOSHandle      *handle;
+    MVMObject        *buf_type;
+    int               seq_number;
+    MVMThreadContext *tc;
+    int               work_idx;
+    uv_fs_t           req;
+    char             *buf;
+    MVMint64          offset;
+    int               cancelled;
+} AsyncReadInfo;
+
+static void async_read_next(MVMThreadContext *tc, uv_loop_t *loop, AsyncReadInfo *ri);
+
+/* Sends the error or EOF notification for an asynchronous read, and stops
+ * it being active work. */
+static void async_read_done(MVMThreadContext *tc, AsyncReadInfo *ri, ssize_t error) {
+    MVMAsyncTask *t   = MVM_io_eventloop_get_active_work(tc, ri->work_idx);
+    MVMObject    *arr;
+    MVMROOT(tc, t, {
+        arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVM_repr_push_o(tc, arr, t->body.schedulee);
+        MVMROOT(tc, arr, {
+            if (error == 0) {
+                MVMObject *final = MVM_repr_box_int(tc,
+                    tc->instance->boot_types.BOOTInt, ri->seq_number);
+                MVM_repr_push_o(tc, arr, final);
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+            }
+            else {
+                MVMString *msg_str;
+                MVMObject *msg_box;
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+                msg_str = MVM_string_ascii_decode_nt(tc,
+                    tc->instance->VMString, uv_strerror((int)error));
+                msg_box = MVM_repr_box_str(tc,
+                    tc->instance->boot_types.BOOTStr, msg_str);
+                MVM_repr_push_o(tc, arr, msg_box);
+            }
+        });
+        MVM_io_eventloop_send(tc, t->body.queue, arr);
+    });
+    MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
+}
+
+/* Completion of the read of a chunk of a file. */
+static void on_async_read(uv_fs_t *req) {
+    AsyncReadInfo    *ri    = (AsyncReadInfo *)req->data;
+    MVMThreadContext *tc    = ri->tc;
+    ssize_t           nread = req->result;
+    uv_fs_req_cleanup(req);
+
+    if (ri->cancelled) {
+        MVM_free_null(ri->buf);
+        MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
+    }
+    else if (nread > 0) {
+        MVMAsyncTask *t = MVM_io_eventloop_get_active_work(tc, ri->work_idx);
+        MVMROOT(tc, t, {
+            MVMObject *arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+            MVM_repr_push_o(tc, arr, t->body.schedulee);
+            MVMROOT(tc, arr, {
+                MVMArray  *res_buf;
+                MVMObject *seq_boxed = MVM_repr_box_int(tc,
+                    tc->instance->boot_types.BOOTInt, ri->seq_number++);
+                MVM_repr_push_o(tc, arr, seq_boxed);
+                res_buf = (MVMArray *)MVM_repr_alloc_init(tc, ri->buf_type);
+                res_buf->body.slots.i8 = (MVMint8 *)ri->buf;
+                res_buf->body.start    = 0;
+                res_buf->body.ssize    = ASYNC_READ_CHUNK_SIZE;
+                res_buf->body.elems    = nread;
+                MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+            });
+            MVM_io_eventloop_send(tc, t->body.queue, arr);
+        });
+        ri->buf = NULL;
+        if (ri->offset >= 0)
+            ri->offset += nread;
+        async_read_next(tc, req->loop, ri);
+    }
+    else {
+        MVM_free_null(ri->buf);
+        async_read_done(tc, ri, nread);
+    }
+}
+
+/* Starts reading the next chunk of a file. */
+static void async_read_next(MVMThreadContext *tc, uv_loop_t *loop, AsyncReadInfo *ri) {
+    MVMIOFileData *data = (MVMIOFileData *)ri->handle->body.data;
+    uv_buf_t buf;
+    int r;
+    ri->buf      = MVM_malloc(ASYNC_READ_CHUNK_SIZE);
+    buf          = uv_buf_init(ri->buf, ASYNC_READ_CHUNK_SIZE);
+    ri->req.data = ri;
+    if ((r = uv_fs_read(loop, &(ri->req), data->fd, &buf, 1, ri->offset, on_async_read)) < 0) {
+        MVM_free_null(ri->buf);
+        async_read_done(tc, ri, r);
+    }
+}
+
+/* Does setup work for an asynchronous file read. */
+static void async_read_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    AsyncReadInfo *ri = (AsyncReadInfo *)data;
+    ri->tc       = tc;
+    ri->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
+    async_read_next(tc, loop, ri);
+}
+
+/* Stops reading. The chunk being read completes, but isn't sent. */
+static void async_read_cancel(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    AsyncReadInfo *ri = (AsyncReadInfo *)data;
+    if (ri->work_idx >= 0) {
+        ri->cancelled = 1;
+        uv_cancel((uv_req_t *)&(ri->req));
+    }
+}
+
+/* Marks objects for an asynchronous file read task. */
+static void async_read_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    AsyncReadInfo *ri = (AsyncReadInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &ri->buf_type);
+    MVM_gc_worklist_add(tc, worklist, &ri->handle);
+}
+
+/* Frees info for an asynchronous file read task. */
+static void async_read_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    if (data)
+        MVM_free(data);
+}
+
+/* Operations table for an asynchronous file read task. */
+static const MVMAsyncTaskOps async_read_op_table = {
+    async_read_setup,
+    NULL,
+    async_read_cancel,
+    async_read_gc_mark,
+    async_read_gc_free
+};
+
+static MVMAsyncTask * read_bytes_async(MVMThreadContext *tc, MVMOSHandle *h, MVMObject *queue,
+                                       MVMObject *schedulee, MVMObject *buf_type, MVMObject *async_type) {
+    MVMIOFileData *data = (MVMIOFileData *)h->body.data;
+    MVMAsyncTask  *task;
+    AsyncReadInfo *ri;
+
+    /* Validate REPRs. */
+    if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
+        MVM_exception_throw_adhoc(tc,
+            "asyncreadbytes target queue must have ConcBlockingQueue REPR (got %s)",
+             MVM_6model_get_stable_debug_name(tc, STABLE(queue)));
+    if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
+        MVM_exception_throw_adhoc(tc,
+            "asyncreadbytes result type must have REPR AsyncTask");
+    if (REPR(buf_type)->ID == MVM_REPR_ID_VMArray) {
+        MVMint32 slot_type = ((MVMArrayREPRData *)STABLE(buf_type)->REPR_data)->slot_type;
+        if (slot_type != MVM_ARRAY_U8 && slot_type != MVM_ARRAY_I8)
+            MVM_exception_throw_adhoc(tc, "asyncreadbytes buffer type must be an array of uint8 or int8");
+    }
+    else {
+        MVM_exception_throw_adhoc(tc, "asyncreadbytes buffer type must be an array");
+    }
+
+    /* Create async task handle. Seekable files are read from where the
+     * handle is now with explicit offsets, so that the reads don't move the
+     * handle's own position. */
+    MVMROOT4(tc, queue, schedulee, h, buf_type, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc, async_type);
+    });
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.queue, queue);
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.schedulee, schedulee);
+    task->body.ops  = &async_read_op_table;
+    ri              = MVM_calloc(1, sizeof(AsyncReadInfo));
+    MVM_ASSIGN_REF(tc, &(task->common.header), ri->buf_type, buf_type);
+    MVM_ASSIGN_REF(tc, &(task->common.header), ri->handle, h);
+    ri->work_idx    = -1;
+    ri->offset      = data->seekable ? MVM_platform_lseek(data->fd, 0, SEEK_CUR) : -1;
+    task->body.data = ri;
+
+    MVMROOT(tc, task, {
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+            MVM_io_eventloop_pick(tc));
+    });
+
+    return task;
+}
+
+/* Info we convey about an asynchronous file write task. */
+typedef struct {
+    MVMOSHandle      *handle;
+    MVMObject        *buf_data;
+    MVMThreadContext *tc;
+    int               work_idx;
+    uv_fs_t           req;
+    MVMuint64         written;
+} AsyncWriteInfo;
+
+static void async_write_next(MVMThreadContext *tc, uv_loop_t *loop, AsyncWriteInfo *wi);
+
+/* Sends the result of an asynchronous write, and stops it being active
+ * work. */
+static void async_write_done(MVMThreadContext *tc, AsyncWriteInfo *wi, ssize_t error) {
+    MVMAsyncTask *t   = MVM_io_eventloop_get_active_work(tc, wi->work_idx);
+    MVMObject    *arr;
+    MVMROOT(tc, t, {
+        arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        MVM_repr_push_o(tc, arr, t->body.schedulee);
+        MVMROOT(tc, arr, {
+            if (error == 0) {
+                MVMObject *bytes_box = MVM_repr_box_int(tc,
+                    tc->instance->boot_types.BOOTInt, wi->written);
+                MVM_repr_push_o(tc, arr, bytes_box);
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
+            }
+            else {
+                MVMString *msg_str;
+                MVMObject *msg_box;
+                MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTInt);
+                msg_str = MVM_string_ascii_decode_nt(tc,
+                    tc->instance->VMString, uv_strerror((int)error));
+                msg_box = MVM_repr_box_str(tc,
+                    tc->instance->boot_types.BOOTStr, msg_str);
+                MVM_repr_push_o(tc, arr, msg_box);
+            }
+        });
+        MVM_io_eventloop_send(tc, t->body.queue, arr);
+    });
+    MVM_io_eventloop_remove_active_work(tc, &(wi->work_idx));
+}
+
+/* Completion of (part of) an asynchronous write; writes any rest. */
+static void on_async_write(uv_fs_t *req) {
+    AsyncWriteInfo   *wi     = (AsyncWriteInfo *)req->data;
+    MVMThreadContext *tc     = wi->tc;
+    ssize_t           result = req->result;
+    uv_fs_req_cleanup(req);
+    if (result < 0) {
+        async_write_done(tc, wi, result);
+    }
+    else {
+        wi->written += result;
+        if (wi->written < ((MVMArray *)wi->buf_data)->body.elems)
+            async_write_next(tc, req->loop, wi);
+        else
+            async_write_done(tc, wi, 0);
+    }
+}
+
+/* Writes what is left of the buffer. */
+static void async_write_next(MVMThreadContext *tc, uv_loop_t *loop, AsyncWriteInfo *wi) {
+    MVMIOFileData *data   = (MVMIOFileData *)wi->handle->body.data;
+    MVMArray      *buffer = (MVMArray *)wi->buf_data;
+    uv_buf_t buf = uv_buf_init(
+        (char *)(buffer->body.slots.i8 + buffer->body.start + wi->written),
+        (unsigned int)(buffer->body.elems - wi->written));
+    int r;
+    wi->req.data = wi;
+    if ((r = uv_fs_write(loop, &(wi->req), data->fd, &buf, 1, -1, on_async_write)) < 0)
+        async_write_done(tc, wi, r);
+}
+
+/* Does setup work for an asynchronous file write. */
+static void async_write_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    AsyncWriteInfo *wi = (AsyncWriteInfo *)data;
+    wi->tc       = tc;
+    wi->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
+    if (((MVMArray *)wi->buf_data)->body.elems)
+        async_write_next(tc, loop, wi);
+    else
+        async_write_done(tc, wi, 0);
+}
+
+/* Marks objects for an asynchronous file write task. */
+static void async_write_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    AsyncWriteInfo *wi = (AsyncWriteInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &wi->handle);
+    MVM_gc_worklist_add(tc, worklist, &wi->buf_data);
+}
+
+/* Frees info for an asynchronous file write task. */
+static void async_write_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    if (data)
+        MVM_free(data);
+}
+
+/* Operations table for an asynchronous file write task. */
+static const MVMAsyncTaskOps async_write_op_table = {
+    async_write_setup,
+    NULL,
+    NULL,
+    async_write_gc_mark,
+    async_write_gc_free
+};
+
+static MVMAsyncTask * write_bytes_async(MVMThreadContext *tc, MVMOSHandle *h, MVMObject *queue,
+                                        MVMObject *schedulee, MVMObject *buffer, MVMObject *async_type) {
+    MVMAsyncTask   *task;
+    AsyncWriteInfo *wi;
+
+    /* Validate REPRs. */
+    if (REPR(queue)->ID != MVM_REPR_ID_ConcBlockingQueue)
+        MVM_exception_throw_adhoc(tc,
+            "asyncwritebytes target queue must have ConcBlockingQueue REPR");
+    if (REPR(async_type)->ID != MVM_REPR_ID_MVMAsyncTask)
+        MVM_exception_throw_adhoc(tc,
+            "asyncwritebytes result type must have REPR AsyncTask");
+    if (!IS_CONCRETE(buffer) || REPR(buffer)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "asyncwritebytes requires a native array to read from");
+    if (((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type != MVM_ARRAY_U8
+        && ((MVMArrayREPRData *)STABLE(buffer)->REPR_data)->slot_type != MVM_ARRAY_I8)
+        MVM_exception_throw_adhoc(tc, "asyncwritebytes requires a native array of uint8 or int8");
+
+    /* Anything written synchronously must reach the file first. */
+    flush_output_buffer(tc, (MVMIOFileData *)h->body.data);
+
+    /* Create async task handle. */
+    MVMROOT4(tc, queue, schedulee, h, buffer, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc, async_type);
+    });
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.queue, queue);
+    MVM_ASSIGN_REF(tc, &(task->common.header), task->body.schedulee, schedulee);
+    task->body.ops  = &async_write_op_table;
+    wi              = MVM_calloc(1, sizeof(AsyncWriteInfo));
+    MVM_ASSIGN_REF(tc, &(task->common.header), wi->handle, h);
+    MVM_ASSIGN_REF(tc, &(task->common.header), wi->buf_data, buffer);
+    wi->work_idx    = -1;
+    task->body.data = wi;
+
+    MVMROOT(tc, task, {
+        MVM_io_eventloop_queue_work_on(tc, (MVMObject *)task,
+            MVM_io_eventloop_pick(tc));
+    });
+
+    return task;
+}
+
 /* IO ops table, populated with functions. */
 static const MVMIOClosable      closable      = { closefh };
-static const MVMIOSyncReadable  sync_readable = { read_bytes, mvm_eof };
-static const MVMIOSyncWritable  sync_writable = { write_bytes, flush, truncatefh };
+static const MVMIOSyncReadable  sync_readable = { read_bytes, mvm_eof, map_bytes };
+static const MVMIOSyncWritable  sync_writable = { write_bytes, flush, truncatefh, write_bytes_vec };
+static const MVMIOAsyncReadable async_readable = { read_bytes_async };
+static const MVMIOAsyncWritable async_writable = { write_bytes_async };
 static const MVMIOSeekable      seekable      = { seek, mvm_tell };
 static const MVMIOLockable      lockable      = { lock, unlock };
 static const MVMIOIntrospection introspection = { is_tty, mvm_fileno };
@@ -390,8 +834,8 @@ static const MVMIOOps op_table = {
     &closable,
     &sync_readable,
     &sync_writable,
-    NULL,
-    NULL,
+    &async_readable,
+    &async_writable,
     NULL,
     &seekable,
     NULL,
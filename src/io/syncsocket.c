@@ -11,20 +11,29 @@
 #else
     #include "unistd.h"
     #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <limits.h>
     #include <sys/un.h>
 
     typedef int Socket;
     #define closesocket close
+    #ifndef IOV_MAX
+    #define IOV_MAX 16
+    #endif
 #endif
 
 #if defined(_MSC_VER)
 #define snprintf _snprintf
 #endif
 
-/* Assumed maximum packet size. If ever changing this to something beyond a
- * 16-bit number, then make sure to change the receive offsets in the data
- * structure below. */
-#define PACKET_SIZE 65535
+/* Bounds on the size of the read buffer each socket keeps. It starts out
+ * small, and doubles each time a receive fills it, up to the maximum. */
+#define READ_BUFFER_MIN 4096
+#define READ_BUFFER_MAX 65536
+
+/* The most we try to receive in one go into a result buffer; a single recv
+ * rarely brings in more than this anyway. */
+#define READ_DIRECT_MAX (1024 * 1024)
 
 /* Error handling varies between POSIX and WinSock. */
 MVM_NO_RETURN static void throw_error(MVMThreadContext *tc, int r, char *operation) MVM_NO_RETURN_ATTRIBUTE;
@@ -52,11 +61,12 @@ typedef struct {
     /* The socket handle (file descriptor on POSIX, SOCKET on Windows). */
     Socket handle;
 
-    /* Buffer of the last received packet of data, and start/end pointers
-     * into the data. */
-    char *last_packet;
-    MVMuint16 last_packet_start;
-    MVMuint16 last_packet_end;
+    /* Buffer of received data, kept for the life of the handle, its size,
+     * and the start and end of the data in it that is yet to be read. */
+    char *read_buf;
+    MVMuint32 read_buf_size;
+    MVMuint32 read_buf_start;
+    MVMuint32 read_buf_end;
 
     /* Did we reach EOF yet? */
     MVMint32 eof;
@@ -65,32 +75,31 @@ typedef struct {
     unsigned int interval_id;
 } MVMIOSyncSocketData;
 
-/* Read a packet worth of data into the last packet buffer. */
-static void read_one_packet(MVMThreadContext *tc, MVMIOSyncSocketData *data) {
-    unsigned int interval_id = MVM_telemetry_interval_start(tc, "syncsocket.read_one_packet");
+/* Receives up to size bytes into the given buffer, returning how many were
+ * received, with 0 meaning the other end closed the connection. */
+static MVMuint64 receive(MVMThreadContext *tc, MVMIOSyncSocketData *data, char *into, MVMuint64 size) {
+    unsigned int interval_id = MVM_telemetry_interval_start(tc, "syncsocket.receive");
     int r;
-    data->last_packet = MVM_malloc(PACKET_SIZE);
+    if (size > 0x7FFFFFFF)
+        size = 0x7FFFFFFF;
     do {
         MVM_gc_mark_thread_blocked(tc);
-        r = recv(data->handle, data->last_packet, PACKET_SIZE, 0);
+        r = recv(data->handle, into, (int)size, 0);
         MVM_gc_mark_thread_unblocked(tc);
     } while(r == -1 && errno == EINTR);
-    MVM_telemetry_interval_stop(tc, interval_id, "syncsocket.read_one_packet");
-    if (MVM_IS_SOCKET_ERROR(r) || r == 0) {
-        MVM_free_null(data->last_packet);
-        if (r != 0)
-            throw_error(tc, r, "receive data from socket");
-    }
-    else {
-        data->last_packet_start = 0;
-        data->last_packet_end = r;
-    }
+    MVM_telemetry_interval_stop(tc, interval_id, "syncsocket.receive");
+    if (MVM_IS_SOCKET_ERROR(r))
+        throw_error(tc, r, "receive data from socket");
+    return (MVMuint64)r;
 }
 
+/* Reads up to the requested number of bytes. Whatever is left in the read
+ * buffer is handed back without receiving anything more, so small reads are
+ * mostly served from it. When it is empty, requests at least as big as it
+ * receive straight into the result; otherwise we refill it. */
 MVMint64 socket_read_bytes(MVMThreadContext *tc, MVMOSHandle *h, char **buf, MVMuint64 bytes) {
     MVMIOSyncSocketData *data = (MVMIOSyncSocketData *)h->body.data;
-    char *use_last_packet = NULL;
-    MVMuint16 use_last_packet_start = 0, use_last_packet_end = 0;
+    MVMuint64 available;
 
     /* If at EOF, nothing more to do. */
     if (data->eof) {
@@ -98,86 +107,57 @@ MVMint64 socket_read_bytes(MVMThreadContext *tc, MVMOSHandle *h, char **buf, MVM
         return 0;
     }
 
-    /* See if there's anything in the packet buffer. */
-    if (data->last_packet) {
-        MVMuint16 last_remaining = data->last_packet_end - data->last_packet_start;
-        if (bytes <= last_remaining) {
-            /* There's enough, and it's sufficient for the request. Extract it
-             * and return, discarding the last packet buffer if we drain it. */
-            *buf = MVM_malloc(bytes);
-            memcpy(*buf, data->last_packet + data->last_packet_start, bytes);
-            if (bytes == last_remaining) {
-                MVM_free_null(data->last_packet);
+    available = data->read_buf_end - data->read_buf_start;
+    if (available == 0) {
+        MVMuint64 r;
+        data->read_buf_start = data->read_buf_end = 0;
+
+        if (bytes >= (data->read_buf_size ? data->read_buf_size : READ_BUFFER_MIN)) {
+            /* A big read; receive directly into the result, giving back
+             * the space if much less came in than we asked for. */
+            char *result;
+            if (bytes > READ_DIRECT_MAX)
+                bytes = READ_DIRECT_MAX;
+            result = MVM_malloc(bytes);
+            r = receive(tc, data, result, bytes);
+            if (r == 0) {
+                MVM_free(result);
+                *buf = NULL;
+                data->eof = 1;
+                return 0;
             }
-            else {
-                data->last_packet_start += bytes;
-            }
-            return bytes;
-        }
-        else {
-            /* Something, but not enough. Take the last packet for use, then
-             * we'll read another one. */
-            use_last_packet = data->last_packet;
-            use_last_packet_start = data->last_packet_start;
-            use_last_packet_end = data->last_packet_end;
-            data->last_packet = NULL;
+            if (r < bytes / 2)
+                result = MVM_realloc(result, r);
+            *buf = result;
+            return r;
         }
-    }
 
-    /* If we get here, we need to read another packet. */
-    read_one_packet(tc, data);
-
-    /* Now assemble the result. */
-    if (data->last_packet && use_last_packet) {
-        /* Need to assemble it from two places. */
-        MVMuint32 last_available = use_last_packet_end - use_last_packet_start;
-        MVMuint32 available = last_available + data->last_packet_end;
-        if (bytes > available)
-            bytes = available;
-        *buf = MVM_malloc(bytes);
-        memcpy(*buf, use_last_packet + use_last_packet_start, last_available);
-        memcpy(*buf + last_available, data->last_packet, bytes - last_available);
-        if (bytes == available) {
-            /* We used all of the just-read packet. */
-            MVM_free_null(data->last_packet);
+        /* Otherwise, refill the buffer, growing it if the last fill used
+         * all of it. */
+        if (!data->read_buf) {
+            data->read_buf_size = READ_BUFFER_MIN;
+            data->read_buf      = MVM_malloc(data->read_buf_size);
         }
-        else {
-            /* Still something left in the just-read packet for next time. */
-            data->last_packet_start += bytes - last_available;
+        r = receive(tc, data, data->read_buf, data->read_buf_size);
+        if (r == 0) {
+            *buf = NULL;
+            data->eof = 1;
+            return 0;
         }
-        MVM_free(use_last_packet);
-    }
-    else if (data->last_packet) {
-        /* Only data from the just-read packet. */
-        if (bytes >= data->last_packet_end) {
-            /* We need all of it, so no copying needed, just hand it back. */
-            *buf = data->last_packet;
-            bytes = data->last_packet_end;
-            data->last_packet = NULL;
-        }
-        else {
-            /* Only need some of it. */
-            *buf = MVM_malloc(bytes);
-            memcpy(*buf, data->last_packet, bytes);
-            data->last_packet_start += bytes;
+        data->read_buf_end = (MVMuint32)r;
+        available = r;
+        if (r == data->read_buf_size && data->read_buf_size < READ_BUFFER_MAX) {
+            data->read_buf_size *= 2;
+            data->read_buf = MVM_realloc(data->read_buf, data->read_buf_size);
         }
     }
-    else if (use_last_packet) {
-        /* Nothing read this time, so at the end. Drain previous packet data
-         * and mark EOF. */
-        bytes = use_last_packet_end - use_last_packet_start;
-        *buf = MVM_malloc(bytes);
-        memcpy(*buf, use_last_packet + use_last_packet_start, bytes);
-        data->eof = 1;
-        MVM_free(use_last_packet);
-    }
-    else {
-        /* Nothing to hand back; at EOF. */
-        *buf = NULL;
-        bytes = 0;
-        data->eof = 1;
-    }
 
+    /* Hand back as much of the buffered data as was asked for. */
+    if (bytes > available)
+        bytes = available;
+    *buf = MVM_malloc(bytes);
+    memcpy(*buf, data->read_buf + data->read_buf_start, bytes);
+    data->read_buf_start += (MVMuint32)bytes;
     return bytes;
 }
 
@@ -223,6 +203,53 @@ MVMint64 socket_write_bytes(MVMThreadContext *tc, MVMOSHandle *h, char *buf, MVM
     return bytes;
 }
 
+/* Writes a number of buffers to the stream, with a single writev (or on
+ * Windows, WSASend) for as long as it takes them all. Both take libuv's
+ * uv_buf_t as they are, since it is laid out like their own buffer type. */
+MVMint64 socket_write_bytes_vec(MVMThreadContext *tc, MVMOSHandle *h, uv_buf_t *bufs, MVMuint32 count) {
+    MVMIOSyncSocketData *data = (MVMIOSyncSocketData *)h->body.data;
+    MVMint64 sent = 0;
+    unsigned int interval_id;
+
+    interval_id = MVM_telemetry_interval_start(tc, "syncsocket.write_bytes_vec");
+    MVM_gc_mark_thread_blocked(tc);
+    while (count > 0) {
+        MVMint64 done;
+#ifdef _WIN32
+        DWORD wrote;
+        int r = WSASend(data->handle, (WSABUF *)bufs, count, &wrote, 0, NULL, NULL);
+        done = wrote;
+#else
+        ssize_t r;
+        do {
+            r = writev(data->handle, (struct iovec *)bufs, count > IOV_MAX ? IOV_MAX : (int)count);
+        } while(r == -1 && errno == EINTR);
+        done = r;
+#endif
+        if (MVM_IS_SOCKET_ERROR(r)) {
+            MVM_gc_mark_thread_unblocked(tc);
+            MVM_telemetry_interval_stop(tc, interval_id, "syncsocket.write_bytes_vec");
+            throw_error(tc, (int)r, "send data to socket");
+        }
+        sent += done;
+
+        /* Move past what was sent, which may end part way into a buffer. */
+        while (count > 0 && (MVMuint64)done >= bufs->len) {
+            done -= bufs->len;
+            bufs++;
+            count--;
+        }
+        if (count > 0) {
+            bufs->base += done;
+            bufs->len  -= done;
+        }
+    }
+    MVM_gc_mark_thread_unblocked(tc);
+    MVM_telemetry_interval_annotate(sent, interval_id, "written this many bytes");
+    MVM_telemetry_interval_stop(tc, interval_id, "syncsocket.write_bytes_vec");
+    return sent;
+}
+
 static MVMint64 do_close(MVMThreadContext *tc, MVMIOSyncSocketData *data) {
     if (data->handle) {
         closesocket(data->handle);
@@ -237,6 +264,7 @@ static MVMint64 close_socket(MVMThreadContext *tc, MVMOSHandle *h) {
 static void gc_free(MVMThreadContext *tc, MVMObject *h, void *d) {
     MVMIOSyncSocketData *data = (MVMIOSyncSocketData *)d;
     do_close(tc, data);
+    MVM_free(data->read_buf);
     MVM_free(data);
 }
 
@@ -280,6 +308,88 @@ static size_t get_struct_size_for_family(sa_family_t family) {
  * - SOCKET_PROTOCOL_ANY (any acceptable protocol)
  */
 
+/* Looks up a host name in the resolution cache, if it is enabled, handing
+ * back a copy of the address it resolved to if there is an entry for it
+ * that has not yet expired, and NULL otherwise. */
+struct sockaddr * MVM_io_dns_cache_lookup(MVMThreadContext *tc, const char *host,
+        MVMint64 port, const struct addrinfo *hints) {
+    MVMInstance     *instance = tc->instance;
+    struct sockaddr *result   = NULL;
+    MVMuint64        now;
+    MVMuint32        i;
+    if (!instance->dns_cache_ttl)
+        return NULL;
+    now = uv_hrtime();
+    uv_mutex_lock(&instance->mutex_dns_cache);
+    if (instance->dns_cache) {
+        for (i = 0; i < MVM_DNS_CACHE_SIZE; i++) {
+            MVMDNSCacheEntry *entry = &instance->dns_cache[i];
+            if (entry->host && entry->port == port && entry->family == hints->ai_family
+                    && entry->socktype == hints->ai_socktype
+                    && entry->protocol == hints->ai_protocol
+                    && strcmp(entry->host, host) == 0) {
+                if (entry->expires > now) {
+                    result = MVM_malloc(entry->addr_len);
+                    memcpy(result, &entry->addr, entry->addr_len);
+                }
+                break;
+            }
+        }
+    }
+    uv_mutex_unlock(&instance->mutex_dns_cache);
+    return result;
+}
+
+/* Adds (or refreshes) the address a host name resolved to in the cache, if
+ * it is enabled. When the cache is full, entries are replaced in turn. */
+void MVM_io_dns_cache_add(MVMThreadContext *tc, const char *host, MVMint64 port,
+        const struct addrinfo *hints, const struct sockaddr *addr, size_t addr_len) {
+    MVMInstance      *instance = tc->instance;
+    MVMDNSCacheEntry *entry    = NULL;
+    MVMuint32         i;
+    if (!instance->dns_cache_ttl || addr_len > sizeof(struct sockaddr_storage))
+        return;
+    uv_mutex_lock(&instance->mutex_dns_cache);
+    if (!instance->dns_cache)
+        instance->dns_cache = MVM_calloc(MVM_DNS_CACHE_SIZE, sizeof(MVMDNSCacheEntry));
+    for (i = 0; i < MVM_DNS_CACHE_SIZE; i++) {
+        MVMDNSCacheEntry *candidate = &instance->dns_cache[i];
+        if (candidate->host && candidate->port == port
+                && candidate->family == hints->ai_family
+                && candidate->socktype == hints->ai_socktype
+                && candidate->protocol == hints->ai_protocol
+                && strcmp(candidate->host, host) == 0) {
+            entry = candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        entry = &instance->dns_cache[instance->dns_cache_next];
+        instance->dns_cache_next = (instance->dns_cache_next + 1) % MVM_DNS_CACHE_SIZE;
+        MVM_free(entry->host);
+        entry->host     = strdup(host);
+        entry->port     = port;
+        entry->family   = hints->ai_family;
+        entry->socktype = hints->ai_socktype;
+        entry->protocol = hints->ai_protocol;
+    }
+    entry->expires  = uv_hrtime() + instance->dns_cache_ttl;
+    entry->addr_len = addr_len;
+    memcpy(&entry->addr, addr, addr_len);
+    uv_mutex_unlock(&instance->mutex_dns_cache);
+}
+
+/* Frees the host name resolution cache at instance destruction. */
+void MVM_io_dns_cache_destroy(MVMInstance *instance) {
+    if (instance->dns_cache) {
+        MVMuint32 i;
+        for (i = 0; i < MVM_DNS_CACHE_SIZE; i++)
+            MVM_free(instance->dns_cache[i].host);
+        MVM_free_null(instance->dns_cache);
+    }
+    uv_mutex_destroy(&instance->mutex_dns_cache);
+}
+
 struct sockaddr * MVM_io_resolve_host_name(MVMThreadContext *tc,
         MVMString *host, MVMint64 port,
         MVMuint16 family, MVMint64 type, MVMint64 protocol,
@@ -382,6 +492,12 @@ struct sockaddr * MVM_io_resolve_host_name(MVMThreadContext *tc,
 
     snprintf(port_cstr, 8, "%d", (int)port);
 
+    /* We may have resolved this recently. */
+    if ((address = MVM_io_dns_cache_lookup(tc, host_cstr, port, &hints))) {
+        MVM_free(host_cstr);
+        return address;
+    }
+
     MVM_gc_mark_thread_blocked(tc);
     error = getaddrinfo(host_cstr, port_cstr, &hints, &result);
     MVM_gc_mark_thread_unblocked(tc);
@@ -394,12 +510,12 @@ struct sockaddr * MVM_io_resolve_host_name(MVMThreadContext *tc,
         );
     }
 
-    MVM_free(host_cstr);
-
     address_len = get_struct_size_for_family(result->ai_family);
     address     = MVM_malloc(address_len);
     memcpy(address, result->ai_addr, address_len);
     freeaddrinfo(result);
+    MVM_io_dns_cache_add(tc, host_cstr, port, &hints, address, address_len);
+    MVM_free(host_cstr);
     return address;
 }
 
@@ -520,10 +636,12 @@ static MVMObject * socket_accept(MVMThreadContext *tc, MVMOSHandle *h);
 /* IO ops table, populated with functions. */
 static const MVMIOClosable      closable      = { close_socket };
 static const MVMIOSyncReadable  sync_readable = { socket_read_bytes,
-                                                  socket_eof };
+                                                  socket_eof,
+                                                  NULL };
 static const MVMIOSyncWritable  sync_writable = { socket_write_bytes,
                                                   socket_flush,
-                                                  socket_truncate };
+                                                  socket_truncate,
+                                                  socket_write_bytes_vec };
 static const MVMIOSockety             sockety = { socket_connect,
                                                   socket_bind,
                                                   socket_accept,
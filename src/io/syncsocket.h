@@ -14,6 +14,21 @@
 #define MVM_SOCKET_PROTOCOL_TCP 1
 #define MVM_SOCKET_PROTOCOL_UDP 2
 
+/* An entry in the host name resolution cache. */
+struct MVMDNSCacheEntry {
+    char                    *host;
+    MVMint64                 port;
+    int                      family;
+    int                      socktype;
+    int                      protocol;
+    MVMuint64                expires;
+    size_t                   addr_len;
+    struct sockaddr_storage  addr;
+};
+
+/* How many host names the cache holds. */
+#define MVM_DNS_CACHE_SIZE 64
+
 MVMObject * MVM_io_socket_create(MVMThreadContext *tc, MVMint64 listen);
 /* TODO: MVMuint16 can be too small for the machine's value for the
  *       given family, which this function doesn't use anymore in the
@@ -23,4 +38,9 @@ struct sockaddr * MVM_io_resolve_host_name(MVMThreadContext *tc,
         MVMString *host, MVMint64 port,
         MVMuint16 family, MVMint64 type, MVMint64 protocol,
         MVMint32 passive);
+struct sockaddr * MVM_io_dns_cache_lookup(MVMThreadContext *tc, const char *host,
+        MVMint64 port, const struct addrinfo *hints);
+void MVM_io_dns_cache_add(MVMThreadContext *tc, const char *host, MVMint64 port,
+        const struct addrinfo *hints, const struct sockaddr *addr, size_t addr_len);
+void MVM_io_dns_cache_destroy(MVMInstance *instance);
 MVMString * MVM_io_get_hostname(MVMThreadContext *tc);
@@ -1,52 +1,250 @@
 #include "moar.h"
 
+/* Timers are kept in a hierarchical timer wheel on the event loop they run
+ * on, driven by a single libuv timer, so that setting up and cancelling a
+ * timer is cheap even with very many of them around. The wheel ticks once a
+ * millisecond. Its first level has a slot for each of the next 64 ticks;
+ * each further level has 64 slots that each span all of the level below.
+ * A timer goes in the lowest level that reaches far enough, and is moved
+ * down (cascaded) when the wheel comes round to its slot, until it fires
+ * from the first level. Timers further away than the last level reaches sit
+ * in its furthest slot, and are cascaded back into it until in range. */
+#define WHEEL_LEVELS     4
+#define WHEEL_SLOT_BITS  6
+#define WHEEL_SLOTS      (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK  (WHEEL_SLOTS - 1)
+#define WHEEL_RANGE      ((MVMuint64)1 << (WHEEL_LEVELS * WHEEL_SLOT_BITS))
+
 /* Info we convey about a timer. */
-typedef struct {
+typedef struct TimerInfo {
     int timeout;
     int repeat;
-    uv_timer_t *handle;
     MVMThreadContext *tc;
     int work_idx;
+
+    /* The tick the timer is next due at, where in the wheel it is, and its
+     * links in the list for that slot. */
+    MVMuint64 expires;
+    MVMuint8 level;
+    MVMuint8 slot;
+    struct TimerInfo *prev;
+    struct TimerInfo *next;
 } TimerInfo;
 
-/* Frees the timer's handle memory. */
-static void free_timer(uv_handle_t *handle) {
-    MVM_free(handle);
+/* The timer wheel of an event loop: the libuv timer that drives it, the
+ * loop's thread, the last tick it has processed, its slots, and how many
+ * timers each level has, so that stretches in which nothing can happen are
+ * skipped. */
+struct MVMTimerWheel {
+    uv_timer_t        handle;
+    MVMThreadContext *tc;
+    MVMuint64  current;
+    TimerInfo *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    MVMuint32  level_count[WHEEL_LEVELS];
+    MVMuint32  count;
+};
+
+/* Puts a timer in the slot for when it is due. Anything due at or before
+ * the current tick goes in the current tick's slot. */
+static void wheel_insert(MVMTimerWheel *wheel, TimerInfo *ti) {
+    MVMuint64 due   = ti->expires > wheel->current ? ti->expires : wheel->current;
+    MVMuint64 delta = due - wheel->current;
+    MVMuint32 level = 0;
+    MVMuint32 slot;
+    if (delta >= WHEEL_RANGE) {
+        due   = wheel->current + WHEEL_RANGE - 1;
+        level = WHEEL_LEVELS - 1;
+    }
+    else {
+        while (delta >= ((MVMuint64)1 << ((level + 1) * WHEEL_SLOT_BITS)))
+            level++;
+    }
+    slot      = (MVMuint32)(due >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+    ti->level = (MVMuint8)level;
+    ti->slot  = (MVMuint8)slot;
+    ti->prev  = NULL;
+    ti->next  = wheel->slots[level][slot];
+    if (ti->next)
+        ti->next->prev = ti;
+    wheel->slots[level][slot] = ti;
+    wheel->level_count[level]++;
+    wheel->count++;
+}
+
+/* Takes a timer out of the wheel. */
+static void wheel_remove(MVMTimerWheel *wheel, TimerInfo *ti) {
+    if (ti->prev)
+        ti->prev->next = ti->next;
+    else
+        wheel->slots[ti->level][ti->slot] = ti->next;
+    if (ti->next)
+        ti->next->prev = ti->prev;
+    ti->prev = ti->next = NULL;
+    wheel->level_count[ti->level]--;
+    wheel->count--;
 }
 
-/* Timer callback; dispatches schedulee to the queue. */
-static void timer_cb(uv_timer_t *handle) {
-    TimerInfo        *ti = (TimerInfo *)handle->data;
-    MVMThreadContext *tc = ti->tc;
-    MVMAsyncTask     *t  = MVM_io_eventloop_get_active_work(tc, ti->work_idx);
-    MVM_repr_push_o(tc, t->body.queue, t->body.schedulee);
-    if (!ti->repeat && ti->work_idx >= 0) {
-        /* The timer will only fire once. Having now fired, stop the callback,
-         * clean up the handle, and remove the active work so that we will not
-         * hold on to the callback and its associated memory. */
-        uv_timer_stop(ti->handle);
-        uv_close((uv_handle_t *)ti->handle, free_timer);
+/* Moves all of the timers in a slot down to where they now belong. */
+static void wheel_cascade(MVMTimerWheel *wheel, MVMuint32 level, MVMuint32 slot) {
+    TimerInfo *ti = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NULL;
+    while (ti) {
+        TimerInfo *next = ti->next;
+        wheel->level_count[level]--;
+        wheel->count--;
+        wheel_insert(wheel, ti);
+        ti = next;
+    }
+}
+
+/* Fires a timer that is due, sending its schedulee to its queue (batched
+ * with whatever else the loop sends this time around), then either puts it
+ * back in the wheel for its next repeat or finishes with it. */
+static void fire(MVMThreadContext *tc, MVMTimerWheel *wheel, TimerInfo *ti) {
+    MVMAsyncTask *t = MVM_io_eventloop_get_active_work(tc, ti->work_idx);
+    MVM_io_eventloop_send(tc, t->body.queue, t->body.schedulee);
+    if (ti->repeat > 0) {
+        ti->expires = wheel->current + ti->repeat;
+        wheel_insert(wheel, ti);
+    }
+    else {
+        /* The timer will only fire once. Having now fired, remove the active
+         * work so that we will not hold on to the callback and its
+         * associated memory. */
         MVM_io_eventloop_remove_active_work(tc, &(ti->work_idx));
     }
 }
 
+/* Brings the wheel up to the given tick, cascading and firing timers along
+ * the way. When the lowest levels are empty, we jump straight to the next
+ * tick at which something could happen. */
+static void wheel_advance(MVMThreadContext *tc, MVMTimerWheel *wheel, MVMuint64 now) {
+    while (wheel->current < now) {
+        MVMuint64 span = 1;
+        MVMuint32 level;
+        TimerInfo *due;
+        if (wheel->count == 0) {
+            wheel->current = now;
+            break;
+        }
+        for (level = 0; level < WHEEL_LEVELS && wheel->level_count[level] == 0; level++)
+            span <<= WHEEL_SLOT_BITS;
+        if (span > 1) {
+            MVMuint64 next = (wheel->current | (span - 1)) + 1;
+            if (next > now) {
+                wheel->current = now;
+                break;
+            }
+            wheel->current = next - 1;
+        }
+
+        /* Move on a tick, cascading from each level whose slots we step
+         * into the start of a new round of. */
+        wheel->current++;
+        for (level = 1; level < WHEEL_LEVELS; level++) {
+            MVMuint32 below = (MVMuint32)(wheel->current >> ((level - 1) * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+            if (below != 0)
+                break;
+            wheel_cascade(wheel, level,
+                (MVMuint32)(wheel->current >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK);
+        }
+
+        /* Fire everything in this tick's slot. The slot is emptied first, as
+         * repeating timers may go back in it. */
+        due = wheel->slots[0][wheel->current & WHEEL_SLOT_MASK];
+        wheel->slots[0][wheel->current & WHEEL_SLOT_MASK] = NULL;
+        while (due) {
+            TimerInfo *next = due->next;
+            wheel->level_count[0]--;
+            wheel->count--;
+            due->prev = due->next = NULL;
+            if (due->expires > wheel->current)
+                wheel_insert(wheel, due);
+            else
+                fire(tc, wheel, due);
+            due = next;
+        }
+    }
+}
+
+/* Works out the next tick at which the wheel has something to do: either a
+ * timer due in the first level, or the next cascade from a higher one. */
+static MVMuint64 wheel_next_tick(MVMTimerWheel *wheel) {
+    MVMuint64 next = wheel->current + WHEEL_RANGE;
+    MVMuint32 level, i;
+    for (i = 1; i <= WHEEL_SLOTS; i++) {
+        if (wheel->slots[0][(wheel->current + i) & WHEEL_SLOT_MASK]) {
+            next = wheel->current + i;
+            break;
+        }
+    }
+    for (level = 1; level < WHEEL_LEVELS; level++) {
+        if (wheel->level_count[level]) {
+            MVMuint64 span     = (MVMuint64)1 << (level * WHEEL_SLOT_BITS);
+            MVMuint64 boundary = (wheel->current | (span - 1)) + 1;
+            if (boundary < next)
+                next = boundary;
+            break;
+        }
+    }
+    return next;
+}
+
+/* The libuv timer callback; processes the wheel, then sets itself for the
+ * next time there is something to do. */
+static void wheel_cb(uv_timer_t *handle);
+static void wheel_schedule(MVMTimerWheel *wheel) {
+    if (wheel->count) {
+        MVMuint64 now  = uv_now(wheel->handle.loop);
+        MVMuint64 next = wheel_next_tick(wheel);
+        uv_timer_start(&(wheel->handle), wheel_cb, next > now ? next - now : 0, 0);
+    }
+    else {
+        uv_timer_stop(&(wheel->handle));
+    }
+}
+static void wheel_cb(uv_timer_t *handle) {
+    MVMTimerWheel *wheel = (MVMTimerWheel *)handle->data;
+    wheel_advance(wheel->tc, wheel, uv_now(handle->loop));
+    wheel_schedule(wheel);
+}
+
+/* Gets the timer wheel of the current event loop, creating it if needed. */
+static MVMTimerWheel * get_wheel(MVMThreadContext *tc, uv_loop_t *loop) {
+    MVMEventLoop *el = tc->event_loop;
+    if (!el->timer_wheel) {
+        MVMTimerWheel *wheel = MVM_calloc(1, sizeof(MVMTimerWheel));
+        uv_timer_init(loop, &(wheel->handle));
+        wheel->handle.data = wheel;
+        wheel->tc          = tc;
+        wheel->current     = uv_now(loop);
+        el->timer_wheel    = wheel;
+    }
+    return el->timer_wheel;
+}
+
 /* Sets the timer up on the event loop. */
 static void setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
-    TimerInfo *ti = (TimerInfo *)data;
-    ti->handle = MVM_malloc(sizeof(uv_timer_t));
-    uv_timer_init(loop, ti->handle);
-    ti->work_idx     = MVM_io_eventloop_add_active_work(tc, async_task);
-    ti->tc           = tc;
-    ti->handle->data = ti;
-    uv_timer_start(ti->handle, timer_cb, ti->timeout, ti->repeat);
+    TimerInfo     *ti    = (TimerInfo *)data;
+    MVMTimerWheel *wheel = get_wheel(tc, loop);
+    ti->work_idx = MVM_io_eventloop_add_active_work(tc, async_task);
+    ti->tc       = tc;
+
+    /* Bring the wheel up to date first, so the timeout counts from now;
+     * the current tick is done with, so a zero timeout means the next. */
+    wheel_advance(tc, wheel, uv_now(loop));
+    ti->expires  = wheel->current + (ti->timeout > 0 ? ti->timeout : 1);
+    wheel_insert(wheel, ti);
+    wheel_schedule(wheel);
 }
 
 /* Stops the timer. */
 static void cancel(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
     TimerInfo *ti = (TimerInfo *)data;
     if (ti->work_idx >= 0) {
-        uv_timer_stop(ti->handle);
-        uv_close((uv_handle_t *)ti->handle, free_timer);
+        MVMTimerWheel *wheel = get_wheel(tc, loop);
+        wheel_remove(wheel, ti);
+        wheel_schedule(wheel);
         MVM_io_eventloop_send_cancellation_notification(ti->tc,
             MVM_io_eventloop_get_active_work(tc, ti->work_idx));
         MVM_io_eventloop_remove_active_work(tc, &(ti->work_idx));
@@ -90,7 +288,7 @@ MVMObject * MVM_io_timer_create(MVMThreadContext *tc, MVMObject *queue,
     MVM_ASSIGN_REF(tc, &(task->common.header), task->body.queue, queue);
     MVM_ASSIGN_REF(tc, &(task->common.header), task->body.schedulee, schedulee);
     task->body.ops      = &op_table;
-    timer_info          = MVM_malloc(sizeof(TimerInfo));
+    timer_info          = MVM_calloc(1, sizeof(TimerInfo));
     timer_info->timeout = timeout;
     timer_info->repeat  = repeat;
     task->body.data     = timer_info;
@@ -103,3 +301,15 @@ MVMObject * MVM_io_timer_create(MVMThreadContext *tc, MVMObject *queue,
 
     return (MVMObject *)task;
 }
+
+/* Closes the libuv timer of an event loop's timer wheel, as the loop is
+ * being destroyed, and frees the wheel itself once the timer is closed. */
+static void free_wheel(uv_handle_t *handle) {
+    MVM_free(handle->data);
+}
+void MVM_io_timer_wheel_destroy(MVMEventLoop *el) {
+    if (el->timer_wheel) {
+        uv_close((uv_handle_t *)&(el->timer_wheel->handle), free_wheel);
+        el->timer_wheel = NULL;
+    }
+}
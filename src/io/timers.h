@@ -1,2 +1,3 @@
 MVMObject * MVM_io_timer_create(MVMThreadContext *tc, MVMObject *queue,
     MVMObject *schedulee, MVMint64 timeout, MVMint64 repeat, MVMObject *async_type);
+void MVM_io_timer_wheel_destroy(MVMEventLoop *el);
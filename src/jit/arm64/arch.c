@@ -0,0 +1,88 @@
+#include "moar.h"
+#include "jit/internal.h"
+
+const MVMBitmap MVM_JIT_REGISTER_CLASS[] = {
+    /* none */ 0,
+    /* gpr  */ 0x00000000ffffffffULL,
+    /* fpr  */ 0xffffffff00000000ULL
+};
+
+#define X(n) ((MVMBitmap)1<<MVM_JIT_REG(X ## n))
+#define D(n) ((MVMBitmap)1<<MVM_JIT_REG(D ## n))
+
+/* x8 is the indirect result register, which we never need because we don't
+ * call functions that return structures; d31 is the last caller-saved vector
+ * register. Neither is ever used to pass an argument. */
+const MVMBitmap MVM_JIT_SPARE_REGISTERS = X(8)|D(31);
+
+/* x16 and x17 are the intra-procedure-call scratch registers, which the
+ * emitter uses freely; x18 is the platform register; x19-x21 hold TC, CU and
+ * WORK, x22 and x23 are temporaries that survive calls in emitted code, and
+ * x24-x28 are callee-saved and left alone. x29 is the frame pointer, x30 the
+ * link register. */
+const MVMBitmap MVM_JIT_RESERVED_REGISTERS =
+    X(16)|X(17)|X(18)|X(19)|X(20)|X(21)|X(22)|X(23)|X(24)|X(25)|X(26)|
+    X(27)|X(28)|X(29)|X(30)|((MVMBitmap)1<<MVM_JIT_REG(SP));
+
+/* x0-x7 and x9-x15 are caller-saved; so are d0-d7 and d16-d30, whereas the
+ * low halves of d8-d15 are callee-saved */
+const MVMBitmap MVM_JIT_AVAILABLE_REGISTERS =
+    X(0)|X(1)|X(2)|X(3)|X(4)|X(5)|X(6)|X(7)|
+    X(9)|X(10)|X(11)|X(12)|X(13)|X(14)|X(15)|
+    D(0)|D(1)|D(2)|D(3)|D(4)|D(5)|D(6)|D(7)|
+    D(16)|D(17)|D(18)|D(19)|D(20)|D(21)|D(22)|D(23)|
+    D(24)|D(25)|D(26)|D(27)|D(28)|D(29)|D(30);
+
+static const MVMint8 arg_gpr[] = {
+    MVM_JIT_REG(X0),
+    MVM_JIT_REG(X1),
+    MVM_JIT_REG(X2),
+    MVM_JIT_REG(X3),
+    MVM_JIT_REG(X4),
+    MVM_JIT_REG(X5),
+    MVM_JIT_REG(X6),
+    MVM_JIT_REG(X7),
+};
+
+static const MVMint8 arg_fpr[] = {
+    MVM_JIT_REG(D0),
+    MVM_JIT_REG(D1),
+    MVM_JIT_REG(D2),
+    MVM_JIT_REG(D3),
+    MVM_JIT_REG(D4),
+    MVM_JIT_REG(D5),
+    MVM_JIT_REG(D6),
+    MVM_JIT_REG(D7),
+};
+
+
+void MVM_jit_arch_storage_for_arglist(MVMThreadContext *tc, MVMJitCompiler *compiler,
+                                      MVMJitExprTree *tree, MVMint32 arglist_node,
+                                      MVMJitStorageRef *storage) {
+    MVMuint32 narg = MVM_JIT_EXPR_NCHILD(tree, arglist_node);
+    MVMint32 *args = MVM_JIT_EXPR_LINKS(tree, arglist_node);
+    MVMuint32 i, ngpr = 0, nfpr = 0, nstack = 0;
+    for (i = 0; i < narg; i++) {
+        MVMint32 carg_type = MVM_JIT_EXPR_ARGS(tree, args[i])[0];
+        /* AAPCS64 passes the first eight numeric arguments in vector
+         * registers and the first eight other arguments in general purpose
+         * registers, independently of each other; the rest go on the stack in
+         * 8 byte slots (we never pass anything smaller) */
+        if (carg_type == MVM_JIT_NUM && nfpr < sizeof(arg_fpr)) {
+            storage[i]._cls = MVM_JIT_STORAGE_FPR;
+            storage[i]._pos = arg_fpr[nfpr++];
+        } else if (carg_type != MVM_JIT_NUM && ngpr < sizeof(arg_gpr)) {
+            storage[i]._cls = MVM_JIT_STORAGE_GPR;
+            storage[i]._pos = arg_gpr[ngpr++];
+        } else {
+            storage[i]._cls = MVM_JIT_STORAGE_STACK;
+            storage[i]._pos = 8 * nstack++;
+        }
+    }
+}
+
+MVMJitStorageClass MVM_jit_arch_register_class(MVMuint8 reg_id) {
+    if (reg_id >= MVM_JIT_REG(D0))
+        return MVM_JIT_STORAGE_FPR;
+    return MVM_JIT_STORAGE_GPR;
+}
@@ -0,0 +1,76 @@
+/* Declaration of architecture specific register names */
+
+#define MVM_JIT_ARCH_GPR(_) \
+    _(X0), \
+    _(X1), \
+    _(X2), \
+    _(X3), \
+    _(X4), \
+    _(X5), \
+    _(X6), \
+    _(X7), \
+    _(X8), \
+    _(X9), \
+    _(X10), \
+    _(X11), \
+    _(X12), \
+    _(X13), \
+    _(X14), \
+    _(X15), \
+    _(X16), \
+    _(X17), \
+    _(X18), \
+    _(X19), \
+    _(X20), \
+    _(X21), \
+    _(X22), \
+    _(X23), \
+    _(X24), \
+    _(X25), \
+    _(X26), \
+    _(X27), \
+    _(X28), \
+    _(X29), \
+    _(X30), \
+    _(SP)
+
+#define MVM_JIT_ARCH_FPR(_) \
+    _(D0), \
+    _(D1), \
+    _(D2), \
+    _(D3), \
+    _(D4), \
+    _(D5), \
+    _(D6), \
+    _(D7), \
+    _(D8), \
+    _(D9), \
+    _(D10), \
+    _(D11), \
+    _(D12), \
+    _(D13), \
+    _(D14), \
+    _(D15), \
+    _(D16), \
+    _(D17), \
+    _(D18), \
+    _(D19), \
+    _(D20), \
+    _(D21), \
+    _(D22), \
+    _(D23), \
+    _(D24), \
+    _(D25), \
+    _(D26), \
+    _(D27), \
+    _(D28), \
+    _(D29), \
+    _(D30), \
+    _(D31)
+
+#define MVM_JIT_ARCH_NUM_REG 64
+
+/* Locals are addressed with a scaled 12 bit offset from the WORK register,
+ * and spills follow the locals, so frames with more locals than this (less
+ * some room for spills) can't be compiled. */
+#define MVM_JIT_ARCH_MAX_LOCALS 3840
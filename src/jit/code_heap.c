@@ -0,0 +1,70 @@
+#include "moar.h"
+#include "platform/mmap.h"
+
+/* JIT code lives in pages of its own, which are only writable while the code
+ * is being encoded, and are then made readable and executable instead (but
+ * never writable and executable at once). Freed blocks of up to
+ * MVM_JIT_CODE_HEAP_CLASSES pages are kept on a list per size class, so that
+ * churning through candidates doesn't map and unmap pages all the time. */
+
+#define CODE_PAGE_SIZE MVM_PLATFORM_MIN_PAGE_SIZE
+
+static size_t num_pages(size_t size) {
+    return (size + CODE_PAGE_SIZE - 1) / CODE_PAGE_SIZE;
+}
+
+/* Gets a block of writable memory to encode size bytes of code into. */
+void * MVM_jit_code_heap_alloc(MVMThreadContext *tc, size_t size) {
+    MVMInstance *instance = tc->instance;
+    size_t pages = num_pages(size);
+    void *block = NULL;
+    if (pages <= MVM_JIT_CODE_HEAP_CLASSES) {
+        uv_mutex_lock(&instance->mutex_jit_code_heap);
+        block = instance->jit_code_free_blocks[pages - 1];
+        if (block) {
+            instance->jit_code_free_blocks[pages - 1] = *(void **)block;
+            instance->jit_code_free_counts[pages - 1]--;
+        }
+        uv_mutex_unlock(&instance->mutex_jit_code_heap);
+    }
+    if (!block)
+        block = MVM_platform_alloc_pages(pages * CODE_PAGE_SIZE, MVM_PAGE_READ|MVM_PAGE_WRITE);
+    MVM_add(&instance->jit_code_bytes, pages * CODE_PAGE_SIZE);
+    return block;
+}
+
+/* Frees a block of code that nothing can be running any more. */
+void MVM_jit_code_heap_free(MVMThreadContext *tc, void *block, size_t size) {
+    MVMInstance *instance = tc->instance;
+    size_t pages = num_pages(size);
+    MVM_add(&instance->jit_code_bytes, -(AO_t)(pages * CODE_PAGE_SIZE));
+    if (pages <= MVM_JIT_CODE_HEAP_CLASSES
+            && MVM_platform_set_page_mode(block, pages * CODE_PAGE_SIZE, MVM_PAGE_READ|MVM_PAGE_WRITE)) {
+        uv_mutex_lock(&instance->mutex_jit_code_heap);
+        if (instance->jit_code_free_counts[pages - 1] < MVM_JIT_CODE_HEAP_MAX_FREE) {
+            *(void **)block = instance->jit_code_free_blocks[pages - 1];
+            instance->jit_code_free_blocks[pages - 1] = block;
+            instance->jit_code_free_counts[pages - 1]++;
+            block = NULL;
+        }
+        uv_mutex_unlock(&instance->mutex_jit_code_heap);
+        if (!block)
+            return;
+    }
+    MVM_platform_free_pages(block, pages * CODE_PAGE_SIZE);
+}
+
+/* Unmaps the blocks kept for reuse. */
+void MVM_jit_code_heap_destroy(MVMInstance *instance) {
+    MVMuint32 i;
+    for (i = 0; i < MVM_JIT_CODE_HEAP_CLASSES; i++) {
+        void *block = instance->jit_code_free_blocks[i];
+        while (block) {
+            void *next = *(void **)block;
+            MVM_platform_free_pages(block, (i + 1) * CODE_PAGE_SIZE);
+            block = next;
+        }
+        instance->jit_code_free_blocks[i] = NULL;
+        instance->jit_code_free_counts[i] = 0;
+    }
+}
@@ -0,0 +1,3 @@
+void * MVM_jit_code_heap_alloc(MVMThreadContext *tc, size_t size);
+void MVM_jit_code_heap_free(MVMThreadContext *tc, void *block, size_t size);
+void MVM_jit_code_heap_destroy(MVMInstance *instance);
@@ -73,6 +73,15 @@ MVMJitCode * MVM_jit_compile_graph(MVMThreadContext *tc, MVMJitGraph *jg) {
     MVMJitCode *code;
     MVMJitNode *node = jg->first_node;
 
+#ifdef MVM_JIT_ARCH_MAX_LOCALS
+    /* The backend can only address so many locals (and spills after them) */
+    if (jg->sg->num_locals > MVM_JIT_ARCH_MAX_LOCALS) {
+        MVM_spesh_debug_printf(tc, "JIT: too many locals (%d) to compile frame\n",
+                               jg->sg->num_locals);
+        return NULL;
+    }
+#endif
+
     /* initialation */
     MVM_jit_compiler_init(tc, &cl, jg);
     /* generate code */
@@ -124,23 +133,8 @@ MVMJitCode * MVM_jit_compile_graph(MVMThreadContext *tc, MVMJitGraph *jg) {
     /* Clear up the compiler */
     MVM_jit_compiler_deinit(tc, &cl);
 
-#if linux
-    /* Native Call compiles code that doesn't correspond
-     * to a staticframe, in which case we just skip this. */
-    if (tc->instance->jit_perf_map && jg->sg->sf) {
-        MVMStaticFrame *sf = jg->sg->sf;
-        char symbol_name[1024];
-        char *file_location = MVM_staticframe_file_location(tc, sf);
-        char *frame_name = MVM_string_utf8_encode_C_string(tc, sf->body.name);
-        snprintf(symbol_name, sizeof(symbol_name) - 1,
-                 "%s(%s)",  frame_name, file_location);
-        fprintf(tc->instance->jit_perf_map, "%lx %lx %s\n",
-                (unsigned long) code->func_ptr, code->size, symbol_name);
-        fflush(tc->instance->jit_perf_map);
-        MVM_free(file_location);
-        MVM_free(frame_name);
-    }
-#endif
+    if (code)
+        MVM_jit_perf_code_created(tc, jg, code);
 
     /* Logging for insight */
     if (MVM_jit_bytecode_dump_enabled(tc))
@@ -164,10 +158,11 @@ MVMJitCode * MVM_jit_compiler_assemble(MVMThreadContext *tc, MVMJitCompiler *cl,
         return NULL;
     }
 
-    memory = MVM_platform_alloc_pages(codesize, MVM_PAGE_READ|MVM_PAGE_WRITE);
+    memory = MVM_jit_code_heap_alloc(tc, codesize);
     if ((dasm_error = dasm_encode(cl, memory)) != 0) {
         if (tc->instance->jit_debug_enabled)
             fprintf(stderr, "DynASM could not encode, error: %d\n", dasm_error);
+        MVM_jit_code_heap_free(tc, memory, codesize);
         return NULL;
     }
 
@@ -175,6 +170,7 @@ MVMJitCode * MVM_jit_compiler_assemble(MVMThreadContext *tc, MVMJitCompiler *cl,
     if (!MVM_platform_set_page_mode(memory, codesize, MVM_PAGE_READ|MVM_PAGE_EXEC)) {
         if (tc->instance->jit_debug_enabled)
             fprintf(stderr, "JIT: Impossible to mark code read/executable");
+        MVM_jit_code_heap_free(tc, memory, codesize);
         /* our caller allocated the compiler and our caller must clean it up */
         tc->instance->jit_enabled = 0;
         return NULL;
@@ -185,6 +181,7 @@ MVMJitCode * MVM_jit_compiler_assemble(MVMThreadContext *tc, MVMJitCompiler *cl,
 
     code->func_ptr   = (void (*)(MVMThreadContext*,MVMCompUnit*,void*)) memory;
     code->size       = codesize;
+    MVM_add(&tc->instance->stat_jit_code_bytes, codesize);
     code->bytecode   = (MVMuint8*)MAGIC_BYTECODE;
 
     /* add sequence number */
@@ -252,7 +249,8 @@ void MVM_jit_code_destroy(MVMThreadContext *tc, MVMJitCode *code) {
     /* fetch_and_sub1 returns previous value, so check if there's only 1 reference */
     if (AO_fetch_and_sub1(&code->ref_cnt) > 1)
         return;
-    MVM_platform_free_pages(code->func_ptr, code->size);
+    MVM_jit_perf_code_destroyed(tc, code);
+    MVM_jit_code_heap_free(tc, code->func_ptr, code->size);
     MVM_free(code->labels);
     MVM_free(code->deopts);
     MVM_free(code->handlers);
@@ -284,7 +282,9 @@ void MVM_jit_compile_label(MVMThreadContext *tc, MVMJitCompiler *compiler,
 
 void MVM_jit_compile_store(MVMThreadContext *tc, MVMJitCompiler *compiler,
                            MVMJitTile *tile, MVMJitExprTree *tree) {
-    MVM_jit_emit_store(tc, compiler, tile->args[0], tile->args[1], tile->values[1], sizeof(MVMRegister));
+    /* spills of vectors set the tile size, everything else is a register */
+    MVM_jit_emit_store(tc, compiler, tile->args[0], tile->args[1], tile->values[1],
+                       tile->size > 0 ? (size_t)tile->size : sizeof(MVMRegister));
 }
 
 void MVM_jit_compile_memory_copy(MVMThreadContext *tc, MVMJitCompiler *compiler,
@@ -300,7 +300,8 @@ void MVM_jit_compile_move(MVMThreadContext *tc, MVMJitCompiler *compiler,
 
 void MVM_jit_compile_load(MVMThreadContext *tc, MVMJitCompiler *compiler,
                           MVMJitTile *tile, MVMJitExprTree *tree) {
-    MVM_jit_emit_load(tc, compiler, tile->values[0],  tile->args[0], tile->args[1], sizeof(MVMRegister));
+    MVM_jit_emit_load(tc, compiler, tile->values[0],  tile->args[0], tile->args[1],
+                      tile->size > 0 ? (size_t)tile->size : sizeof(MVMRegister));
 }
 
 void MVM_jit_compile_guard(MVMThreadContext *tc, MVMJitCompiler *compiler,
@@ -341,18 +342,18 @@ void MVM_jit_compile_expr_tree(MVMThreadContext *tc, MVMJitCompiler *compiler, M
     MVM_jit_tile_list_destroy(tc, list);
 }
 
+/* Spill slots are only typed for the sake of the GC, which needs to know
+ * whether they hold a collectable; so numbers and integers can share slots, as
+ * can strings and objects. Vectors need two slots at once. */
 MVM_STATIC_INLINE MVMint32 reg_type_bucket(MVMint8 reg_type) {
     switch (reg_type) {
-    case MVM_reg_num32:
-    case MVM_reg_num64:
+    case MVM_reg_str:
+    case MVM_reg_obj:
         return 1;
         break;
-    case MVM_reg_str:
+    case MVM_JIT_REG_VEC:
         return 2;
         break;
-    case MVM_reg_obj:
-        return 3;
-        break;
     default:
         break;
     }
@@ -367,6 +368,13 @@ MVMuint32 MVM_jit_spill_memory_select(MVMThreadContext *tc, MVMJitCompiler *comp
     if (compiler->spills_free[bucket] >= 0) {
         idx = compiler->spills_free[bucket];
         compiler->spills_free[bucket] = compiler->spills[idx].next;
+    } else if (reg_type == MVM_JIT_REG_VEC) {
+        /* a vector takes two consecutive slots, which we describe to the GC
+         * as plain numbers */
+        MVM_VECTOR_ENSURE_SPACE(compiler->spills, 2);
+        idx = compiler->spills_num;
+        compiler->spills_num += 2;
+        compiler->spills[idx].reg_type = compiler->spills[idx + 1].reg_type = MVM_reg_num64;
     } else {
         MVM_VECTOR_ENSURE_SPACE(compiler->spills, compiler->spills_num);
         idx = compiler->spills_num++;
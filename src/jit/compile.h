@@ -26,6 +26,12 @@ struct MVMJitCode {
     MVMuint32      spill_size;
     MVMuint32      seq_nr;
 
+    /* Sequence number of the last GC that saw a frame running this code */
+    MVMuint64      last_seen_gc;
+
+    /* Entry registering this code with GDB, if any */
+    void          *gdb_entry;
+
     AO_t ref_cnt;
 };
 
@@ -54,7 +54,7 @@ struct ValueDefinition {
 static MVMint32 noop_code[] = { MVM_JIT_NOOP, 0 };
 
 static struct MVMJitExprTemplate noop_template = {
-    noop_code, "ns", 2, 0, 0
+    noop_code, "ns", 2, 0, 0, NULL
 };
 
 /* Logical negation of comparison operators */
@@ -86,6 +86,8 @@ enum MVMJitExprOperator MVM_jit_expr_op_invert_comparison(enum MVMJitExprOperato
 MVMint32 MVM_jit_expr_op_is_unary(enum MVMJitExprOperator op) {
     switch (op) {
     case MVM_JIT_NOT:
+    case MVM_JIT_VSPLAT_NUM:
+    case MVM_JIT_VSUM_NUM:
         return 1;
     default:
         return 0;
@@ -101,6 +103,14 @@ MVMint32 MVM_jit_expr_op_is_binary(enum MVMJitExprOperator op) {
     case MVM_JIT_AND:
     case MVM_JIT_OR:
     case MVM_JIT_XOR:
+    case MVM_JIT_VADD:
+    case MVM_JIT_VSUB:
+    case MVM_JIT_VADD_NUM:
+    case MVM_JIT_VSUB_NUM:
+    case MVM_JIT_VMUL_NUM:
+    case MVM_JIT_VAND:
+    case MVM_JIT_VOR:
+    case MVM_JIT_VXOR:
         /* and DIV, SHIFT, etc */
         return 1;
     default:
@@ -116,6 +126,12 @@ MVMint32 MVM_jit_expr_op_is_commutative(enum MVMJitExprOperator op) {
     case MVM_JIT_MUL:
     case MVM_JIT_AND:
     case MVM_JIT_OR:
+    case MVM_JIT_VADD:
+    case MVM_JIT_VADD_NUM:
+    case MVM_JIT_VMUL_NUM:
+    case MVM_JIT_VAND:
+    case MVM_JIT_VOR:
+    case MVM_JIT_VXOR:
         return 1;
     default:
         return 0;
@@ -395,9 +411,21 @@ void MVM_jit_expr_load_operands(MVMThreadContext *tc, MVMJitExprTree *tree,
 }
 
 
+/* Finds the template an extension op registered, if any. */
+static const MVMJitExprTemplate * get_extop_template(MVMThreadContext *tc, MVMSpeshGraph *sg,
+                                                     MVMSpeshIns *ins) {
+    MVMExtOpRecord *extops     = sg->sf->body.cu->body.extops;
+    MVMuint16       num_extops = sg->sf->body.cu->body.num_extops;
+    MVMuint16       i;
+    for (i = 0; i < num_extops; i++)
+        if (extops[i].info == ins->info)
+            return extops[i].no_jit ? NULL : extops[i].jit_template;
+    return NULL;
+}
+
 /* Add template to nodes, filling in operands and linking tree nodes. Return template root */
 static MVMint32 apply_template(MVMThreadContext *tc, MVMJitExprTree *tree, MVMint32 len, char *info,
-                               MVMint32 *code, MVMint32 *operands) {
+                               MVMint32 *code, const void * const *constants, MVMint32 *operands) {
     MVMint32 i, j, root = 0, base = tree->nodes_num;
     MVM_VECTOR_ENSURE_SPACE(tree->nodes, len);
     /* Loop over string until the end */
@@ -414,7 +442,7 @@ static MVMint32 apply_template(MVMThreadContext *tc, MVMJitExprTree *tree, MVMin
             tree->nodes[j] = operands[code[i]];
             break;
         case 'c':
-            tree->nodes[j] = MVM_jit_expr_add_const_ptr(tc, tree, MVM_jit_expr_template_constants[code[i]]);
+            tree->nodes[j] = MVM_jit_expr_add_const_ptr(tc, tree, constants[code[i]]);
             break;
         case 'n':
             /* next node should contain size */
@@ -446,7 +474,9 @@ static MVMint32 apply_template(MVMThreadContext *tc, MVMJitExprTree *tree, MVMin
 
 MVMint32 MVM_jit_expr_apply_template(MVMThreadContext *tc, MVMJitExprTree *tree,
                                      const MVMJitExprTemplate *template, MVMint32 *operands) {
-    return apply_template(tc, tree, template->len, (char*)template->info, (MVMint32*)template->code, operands);
+    return apply_template(tc, tree, template->len, (char*)template->info, (MVMint32*)template->code,
+                          template->constants ? template->constants : MVM_jit_expr_template_constants,
+                          operands);
 }
 
 /* this will fail with more than 16 nodes, which is just as fine */
@@ -460,7 +490,7 @@ MVMint32 MVM_jit_expr_apply_template_adhoc(MVMThreadContext *tc, MVMJitExprTree
         code[i] = va_arg(args, MVMint32);
     }
     va_end(args);
-    return apply_template(tc, tree, i, info, code, NULL);
+    return apply_template(tc, tree, i, info, code, NULL, NULL);
 }
 
 
@@ -501,6 +531,32 @@ static void analyze_node(MVMThreadContext *tc, MVMJitTreeTraverser *traverser,
     case MVM_JIT_LOAD:
         node_size = args[0];
         break;
+    case MVM_JIT_LOAD_VEC:
+        node_size = args[0];
+        node_type = MVM_JIT_REG_VEC;
+        break;
+    case MVM_JIT_VSPLAT:
+    case MVM_JIT_VSPLAT_NUM:
+    case MVM_JIT_VADD:
+    case MVM_JIT_VSUB:
+    case MVM_JIT_VADD_NUM:
+    case MVM_JIT_VSUB_NUM:
+    case MVM_JIT_VMUL_NUM:
+    case MVM_JIT_VAND:
+    case MVM_JIT_VOR:
+    case MVM_JIT_VXOR:
+        /* vector operations never need casts; all vectors are as wide */
+        node_size = MVM_JIT_VEC_SZ;
+        node_type = MVM_JIT_REG_VEC;
+        break;
+    case MVM_JIT_VSUM:
+        node_size = args[0];
+        break;
+    case MVM_JIT_VSUM_NUM:
+        /* num32 lanes are summed in single precision, then widened */
+        node_size = MVM_JIT_NUM_SZ;
+        node_type = MVM_reg_num64;
+        break;
     case MVM_JIT_SCAST:
     case MVM_JIT_UCAST:
         node_size = args[0];
@@ -785,7 +841,9 @@ MVMJitExprTree * MVM_jit_expr_tree_build(MVMThreadContext *tc, MVMJitGraph *jg,
             goto emit;
         }
 
-        template = MVM_jit_get_template_for_opcode(opcode);
+        template = opcode == (MVMuint16)-1
+            ? get_extop_template(tc, sg, ins)
+            : MVM_jit_get_template_for_opcode(opcode);
         BAIL(template == NULL, "Cannot get template for: %s", ins->info->name);
         if (tree_is_empty(tc, tree)) {
             /* start with a no-op so every valid reference is nonzero */
@@ -2,6 +2,11 @@
 #define MVM_JIT_REG_SZ sizeof(MVMRegister)
 #define MVM_JIT_INT_SZ sizeof(MVMint64)
 #define MVM_JIT_NUM_SZ sizeof(MVMnum64)
+#define MVM_JIT_VEC_SZ 16
+
+/* Vector values have no VM register type, so they get a type of their own;
+ * its lower bits are zero so it never matches a real register type */
+#define MVM_JIT_REG_VEC 32
 
 /* C argument types */
 enum {
@@ -54,6 +59,9 @@ struct MVMJitExprTemplate {
     MVMint32 len;
     MVMint32 root;
     MVMint32 flags;
+    /* The constants the template refers to; NULL for the core templates,
+     * which share one table. Templates of extension ops have their own. */
+    const void * const *constants;
 };
 
 #define MVM_JIT_EXPR_TEMPLATE_VALUE       0
@@ -53,6 +53,21 @@
     _(OR, 2, 0),  \
     _(XOR, 2, 0), \
     _(NOT, 1, 0), \
+    /* vector (SIMD) operations; the argument is the lane size in bytes, \
+     * except for LOAD_VEC which takes the size of the vector */ \
+    _(LOAD_VEC, 1, 1), \
+    _(VSPLAT, 1, 1), \
+    _(VSPLAT_NUM, 1, 1), \
+    _(VADD, 2, 1), \
+    _(VSUB, 2, 1), \
+    _(VADD_NUM, 2, 1), \
+    _(VSUB_NUM, 2, 1), \
+    _(VMUL_NUM, 2, 1), \
+    _(VAND, 2, 0), \
+    _(VOR, 2, 0), \
+    _(VXOR, 2, 0), \
+    _(VSUM, 1, 1), \
+    _(VSUM_NUM, 1, 1), \
     /* boolean logic */ \
     _(ALL, -1, 0), \
     _(ANY, -1, 0), \
@@ -24,7 +24,13 @@ static void jg_append_deopt_check(MVMThreadContext *tc, MVMJitGraph *jg) {
 
 static void jg_append_primitive(MVMThreadContext *tc, MVMJitGraph *jg,
                                 MVMSpeshIns * ins) {
-    MVMJitNode * node = MVM_spesh_alloc(tc, jg->sg, sizeof(MVMJitNode));
+    MVMJitNode * node;
+    if (!MVM_jit_arch_supports_primitive(tc, ins)) {
+        /* checked by consume_bb after the instruction is consumed */
+        jg->unsupported_ins = ins;
+        return;
+    }
+    node = MVM_spesh_alloc(tc, jg->sg, sizeof(MVMJitNode));
     node->type = MVM_JIT_NODE_PRIMITIVE;
     node->u.prim.ins = ins;
     jg_append_node(jg, node);
@@ -112,6 +118,7 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
     case MVM_OP_capturelex: return MVM_frame_capturelex;
     case MVM_OP_captureinnerlex: return MVM_frame_capture_inner;
     case MVM_OP_takeclosure: return MVM_frame_takeclosure;
+    case MVM_OP_sp_takeclosure_local: return MVM_frame_takeclosure_local;
     case MVM_OP_usecapture: return MVM_args_use_capture;
     case MVM_OP_savecapture: return MVM_args_save_capture;
     case MVM_OP_captureposprimspec: return MVM_capture_pos_primspec;
@@ -375,8 +382,46 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
     case MVM_OP_atposref_i: return MVM_nativeref_pos_i;
     case MVM_OP_atposref_n: return MVM_nativeref_pos_n;
     case MVM_OP_atposref_s: return MVM_nativeref_pos_s;
+    case MVM_OP_atpos2d_i: return MVM_repr_at_pos_2d_i;
+    case MVM_OP_atpos2d_n: return MVM_repr_at_pos_2d_n;
+    case MVM_OP_atpos2d_s: return MVM_repr_at_pos_2d_s;
+    case MVM_OP_atpos2d_o: return MVM_repr_at_pos_2d_o;
+    case MVM_OP_atpos3d_i: return MVM_repr_at_pos_3d_i;
+    case MVM_OP_atpos3d_n: return MVM_repr_at_pos_3d_n;
+    case MVM_OP_atpos3d_s: return MVM_repr_at_pos_3d_s;
+    case MVM_OP_atpos3d_o: return MVM_repr_at_pos_3d_o;
+    case MVM_OP_atposnd_i: return MVM_repr_at_pos_multidim_i;
+    case MVM_OP_atposnd_n: return MVM_repr_at_pos_multidim_n;
+    case MVM_OP_atposnd_s: return MVM_repr_at_pos_multidim_s;
+    case MVM_OP_atposnd_o: return MVM_repr_at_pos_multidim_o;
+    case MVM_OP_bindpos2d_i: return MVM_repr_bind_pos_2d_i;
+    case MVM_OP_bindpos2d_n: return MVM_repr_bind_pos_2d_n;
+    case MVM_OP_bindpos2d_s: return MVM_repr_bind_pos_2d_s;
+    case MVM_OP_bindpos2d_o: return MVM_repr_bind_pos_2d_o;
+    case MVM_OP_bindpos3d_i: return MVM_repr_bind_pos_3d_i;
+    case MVM_OP_bindpos3d_n: return MVM_repr_bind_pos_3d_n;
+    case MVM_OP_bindpos3d_s: return MVM_repr_bind_pos_3d_s;
+    case MVM_OP_bindpos3d_o: return MVM_repr_bind_pos_3d_o;
+    case MVM_OP_bindposnd_i: return MVM_repr_bind_pos_multidim_i;
+    case MVM_OP_bindposnd_n: return MVM_repr_bind_pos_multidim_n;
+    case MVM_OP_bindposnd_s: return MVM_repr_bind_pos_multidim_s;
+    case MVM_OP_bindposnd_o: return MVM_repr_bind_pos_multidim_o;
+    case MVM_OP_mdfill_i: return MVM_MultiDimArray_fill_i;
+    case MVM_OP_mdfill_n: return MVM_MultiDimArray_fill_n;
+    case MVM_OP_mdcopy: return MVM_MultiDimArray_copy;
+    case MVM_OP_mdtranspose: return MVM_MultiDimArray_transpose;
+    case MVM_OP_mdelemwise: return MVM_MultiDimArray_elemwise;
+    case MVM_OP_mdreadline: return MVM_MultiDimArray_read_line;
+    case MVM_OP_mdwriteline: return MVM_MultiDimArray_write_line;
     case MVM_OP_indexingoptimized: return MVM_string_indexing_optimized;
     case MVM_OP_sp_boolify_iter: return MVM_iter_istrue;
+    case MVM_OP_sp_iter_shift_arr_o: return MVM_iter_shift_array_o;
+    case MVM_OP_sp_iter_shift_arr_i: return MVM_iter_shift_array_i;
+    case MVM_OP_sp_iter_shift_arr_n: return MVM_iter_shift_array_n;
+    case MVM_OP_sp_iter_shift_arr_s: return MVM_iter_shift_array_s;
+    case MVM_OP_sp_iter_shift_hash: return MVM_iter_shift_hash;
+    case MVM_OP_sp_iterkey_hash: return MVM_iterkey_s_hash;
+    case MVM_OP_sp_iterval_hash: return MVM_iterval_hash;
     case MVM_OP_prof_allocated: return MVM_profile_log_allocated;
     case MVM_OP_prof_exit: return MVM_profile_log_exit;
     case MVM_OP_sp_resolvecode: return MVM_frame_resolve_invokee_spesh;
@@ -390,6 +435,11 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
     case MVM_OP_atomicload_i: return MVM_6model_container_atomic_load_i;
     case MVM_OP_atomicstore_o: return MVM_6model_container_atomic_store;
     case MVM_OP_atomicstore_i: return MVM_6model_container_atomic_store_i;
+    case MVM_OP_arratomicload_i: return MVM_VMArray_atomic_load_i;
+    case MVM_OP_arratomicstore_i: return MVM_VMArray_atomic_store_i;
+    case MVM_OP_arratomicadd_i: return MVM_VMArray_atomic_add_i;
+    case MVM_OP_arratomicxchg_i: return MVM_VMArray_atomic_xchg_i;
+    case MVM_OP_arratomiccas_i: return MVM_VMArray_atomic_cas_i;
     case MVM_OP_lock: return MVM_reentrantmutex_lock_checked;
     case MVM_OP_unlock: return MVM_reentrantmutex_unlock_checked;
     case MVM_OP_getexcategory: return MVM_get_exception_category;
@@ -398,13 +448,14 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
 
     case MVM_OP_backtrace: return MVM_exception_backtrace;
     case MVM_OP_backtracestrings: return MVM_exception_backtrace_strings;
-    case MVM_OP_breakpoint: return MVM_debugserver_breakpoint_check;
+    case MVM_OP_breakpoint: return MVM_debugserver_breakpoint_check_fast;
     case MVM_OP_sp_getstringfrom: return MVM_cu_string;
     case MVM_OP_encoderepconf: return MVM_string_encode_to_buf_config;
     case MVM_OP_decodeconf: return MVM_string_decode_from_buf_config;
     case MVM_OP_decoderepconf: return MVM_string_decode_from_buf_config;
     case MVM_OP_strfromname: return MVM_unicode_string_from_name;
     case MVM_OP_strfromcodes: return MVM_unicode_codepoints_to_nfg_string;
+    case MVM_OP_curcode: return MVM_frame_cur_code;
     case MVM_OP_callercode: return MVM_frame_caller_code;
     case MVM_OP_stat: return MVM_file_stat;
     case MVM_OP_lstat: return MVM_file_stat;
@@ -463,6 +514,7 @@ static MVMint32 consume_invoke(MVMThreadContext *tc, MVMJitGraph *jg,
     MVMint16      is_fast;
     MVMint16      is_resolve = 0;
     MVMuint32     resolve_offset = 0;
+    void        (*cfunc)(MVMThreadContext *, MVMCallsite *, MVMRegister *) = NULL;
 
     while ((ins = ins->next)) {
         switch(ins->info->opcode) {
@@ -515,6 +567,7 @@ static MVMint32 consume_invoke(MVMThreadContext *tc, MVMJitGraph *jg,
             MVMint16 restype = ins->operands[2].reg.orig;
             MVMNativeCallBody *body;
             MVMJitGraph *nc_jg;
+            MVMSpeshIns *unbox;
 
             MVMSpeshFacts *object_facts = MVM_spesh_get_facts(tc, iter->graph, ins->operands[1]);
 
@@ -525,12 +578,32 @@ static MVMint32 consume_invoke(MVMThreadContext *tc, MVMJitGraph *jg,
             }
 
             body = MVM_nativecall_get_nc_body(tc, object_facts->value.o);
-            nc_jg = MVM_nativecall_jit_graph_for_caller_code(tc, iter->graph, body, restype, dst, arg_ins);
+
+            /* If the boxed result is only ever unboxed again right away, let
+             * the native call write the unboxed value directly */
+            unbox = ins->next;
+            nc_jg = NULL;
+            if (unbox
+                && ((unbox->info->opcode == MVM_OP_unbox_i && body->ret_type != MVM_NATIVECALL_ARG_DOUBLE)
+                    || (unbox->info->opcode == MVM_OP_unbox_n && body->ret_type == MVM_NATIVECALL_ARG_DOUBLE))
+                && unbox->operands[1].reg.orig == ins->operands[0].reg.orig
+                && unbox->operands[1].reg.i == ins->operands[0].reg.i
+                && MVM_spesh_usages_used_once(tc, iter->graph, ins->operands[0])
+                && !MVM_spesh_usages_is_used_by_deopt(tc, iter->graph, ins->operands[0])
+                && !MVM_spesh_usages_is_used_by_handler(tc, iter->graph, ins->operands[0])) {
+                nc_jg = MVM_nativecall_jit_graph_for_caller_code(tc, iter->graph, body, restype, dst,
+                                                                 unbox->operands[0].reg.orig, arg_ins);
+            }
+            if (nc_jg == NULL) {
+                unbox = NULL;
+                nc_jg = MVM_nativecall_jit_graph_for_caller_code(tc, iter->graph, body, restype, dst, -1, arg_ins);
+            }
             if (nc_jg == NULL)
                 return 0;
 
             jg->last_node->next = nc_jg->first_node;
             jg->last_node = nc_jg->last_node;
+            jg->fused_ins = unbox;
 
             goto success;
         }
@@ -592,6 +665,17 @@ static MVMint32 consume_invoke(MVMThreadContext *tc, MVMJitGraph *jg,
                                     ins? ins->info->name : "NULL", i, cs->arg_count);
         return 0;
     }
+    /* An invokee known to be a C function needn't be looked up nor go
+     * through its invocation handler; we can call its function directly. */
+    if (!is_fast && !is_resolve) {
+        MVMSpeshFacts *code_facts = MVM_spesh_get_facts(tc, iter->graph,
+            ins->operands[ins->info->opcode == MVM_OP_invoke_v ? 0 : 1]);
+        if (code_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE) {
+            MVMObject *code = code_facts->value.o;
+            if (code && REPR(code)->ID == MVM_REPR_ID_MVMCFunction && IS_CONCRETE(code))
+                cfunc = ((MVMCFunction *)code)->body.func;
+        }
+    }
     /* get label /after/ current (invoke) ins, where we'll need to reenter the JIT */
     reentry_label = MVM_jit_label_after_ins(tc, jg, iter->bb, ins);
     /* create invoke node */
@@ -608,6 +692,7 @@ static MVMint32 consume_invoke(MVMThreadContext *tc, MVMJitGraph *jg,
     node->u.invoke.reentry_label         = reentry_label;
     node->u.invoke.is_fast               = is_fast;
     node->u.invoke.is_resolve            = is_resolve;
+    node->u.invoke.cfunc                 = cfunc;
     jg_append_node(jg, node);
 
     /* append reentry label */
@@ -691,6 +776,133 @@ static MVMuint16 * try_fake_extop_regs(MVMThreadContext *tc, MVMSpeshGraph *sg,
     return regs;
 }
 
+/* Writes the instruction as bytecode, followed by sp_jit_opdone, so that we
+ * can have the interpreter run it; gives up on instructions that the
+ * interpreter couldn't run on its own, being branches, those that invoke,
+ * deoptimize or build call arguments. */
+static MVMuint8 * try_interp_op_bytecode(MVMThreadContext *tc, MVMJitGraph *jg, MVMSpeshIns *ins,
+                                         size_t *bufsize) {
+    const MVMOpInfo *info = ins->info;
+    MVMuint8 *buf, *pos;
+    size_t size = 2 * sizeof(MVMuint16);
+    MVMuint16 i, opcode;
+    if (!tc->instance->jit_partial_enabled || info->opcode >= MVM_OP_EXT_BASE ||
+        (info->jittivity & MVM_JIT_INFO_INVOKISH) || info->deopt_point ||
+        info->may_cause_deopt)
+        return NULL;
+    for (i = 0; i < info->num_operands; i++) {
+        switch (info->operands[i] & MVM_operand_rw_mask) {
+        case MVM_operand_read_reg:
+        case MVM_operand_write_reg:
+            size += 2;
+            break;
+        case MVM_operand_read_lex:
+        case MVM_operand_write_lex:
+            size += 4;
+            break;
+        case MVM_operand_literal:
+            switch (info->operands[i] & MVM_operand_type_mask) {
+            case MVM_operand_int8:
+                size += 1;
+                break;
+            case MVM_operand_int16:
+            case MVM_operand_coderef:
+            case MVM_operand_spesh_slot:
+                size += 2;
+                break;
+            case MVM_operand_int32:
+            case MVM_operand_uint32:
+            case MVM_operand_num32:
+            case MVM_operand_str:
+                size += 4;
+                break;
+            case MVM_operand_int64:
+            case MVM_operand_num64:
+                size += 8;
+                break;
+            default:
+                return NULL;
+            }
+            break;
+        default:
+            return NULL;
+        }
+    }
+
+    pos = buf = MVM_spesh_alloc(tc, jg->sg, size);
+    opcode = info->opcode;
+    memcpy(pos, &opcode, 2);
+    pos += 2;
+    for (i = 0; i < info->num_operands; i++) {
+        MVMSpeshOperand *o = &ins->operands[i];
+        switch (info->operands[i] & MVM_operand_rw_mask) {
+        case MVM_operand_read_reg:
+        case MVM_operand_write_reg:
+            memcpy(pos, &o->reg.orig, 2);
+            pos += 2;
+            break;
+        case MVM_operand_read_lex:
+        case MVM_operand_write_lex:
+            memcpy(pos, &o->lex.idx, 2);
+            memcpy(pos + 2, &o->lex.outers, 2);
+            pos += 4;
+            break;
+        default:
+            switch (info->operands[i] & MVM_operand_type_mask) {
+            case MVM_operand_int8:
+                memcpy(pos, &o->lit_i8, 1);
+                pos += 1;
+                break;
+            case MVM_operand_int16:
+            case MVM_operand_spesh_slot:
+                memcpy(pos, &o->lit_i16, 2);
+                pos += 2;
+                break;
+            case MVM_operand_coderef:
+                memcpy(pos, &o->coderef_idx, 2);
+                pos += 2;
+                break;
+            case MVM_operand_int32:
+                memcpy(pos, &o->lit_i32, 4);
+                pos += 4;
+                break;
+            case MVM_operand_uint32: {
+                /* kept in a 16 bit field; codegen widens it the same way */
+                MVMuint32 value = o->lit_ui32;
+                memcpy(pos, &value, 4);
+                pos += 4;
+                break;
+            }
+            case MVM_operand_num32:
+                memcpy(pos, &o->lit_n32, 4);
+                pos += 4;
+                break;
+            case MVM_operand_str:
+                memcpy(pos, &o->lit_str_idx, 4);
+                pos += 4;
+                break;
+            case MVM_operand_int64:
+                memcpy(pos, &o->lit_i64, 8);
+                pos += 8;
+                break;
+            case MVM_operand_num64:
+                memcpy(pos, &o->lit_n64, 8);
+                pos += 8;
+                break;
+            }
+        }
+    }
+    opcode = MVM_OP_sp_jit_opdone;
+    memcpy(pos, &opcode, 2);
+    *bufsize = size;
+    return buf;
+}
+
+static void count_op(MVMThreadContext *tc, AO_t *counts, MVMSpeshIns *ins) {
+    if (counts && ins->info->opcode < MVM_OP_EXT_BASE)
+        MVM_incr(&counts[ins->info->opcode]);
+}
+
 static void before_ins(MVMThreadContext *tc, MVMJitGraph *jg,
                        MVMSpeshIterator *iter, MVMSpeshIns  *ins) {
     MVMSpeshBB   *bb = iter->bb;
@@ -742,6 +954,14 @@ static void before_ins(MVMThreadContext *tc, MVMJitGraph *jg,
             has_label = 1;
             break;
         }
+        case MVM_SPESH_ANN_LINENO: {
+            /* Only needed to map code addresses to lines for perf */
+            if (tc->instance->jit_perf_dump) {
+                label = MVM_jit_label_before_ins(tc, jg, bb, ins);
+                has_label = 1;
+            }
+            break;
+        }
         } /* switch */
         ann = ann->next;
     }
@@ -914,6 +1134,11 @@ static MVMint32 consume_reprop(MVMThreadContext *tc, MVMJitGraph *jg,
                     if (function != NULL)
                         is_double_devirt++;
                 }
+                else if (alternative && ((MVMObject *)type_facts->type)->st->REPR->ID == MVM_REPR_ID_NativeHash) {
+                    function = MVM_NativeHash_find_fast_impl_for_jit(tc, ((MVMObject *)type_facts->type)->st, op, kind);
+                    if (function != NULL)
+                        is_double_devirt++;
+                }
                 if (function == NULL) {
                     function = alternative
                         ? (void *)((MVMObject*)type_facts->type)->st->REPR->ass_funcs.at_key
@@ -1719,6 +1944,9 @@ static void add_bail_comment(MVMThreadContext *tc, MVMJitGraph *jg, MVMSpeshIns
 static MVMint32 consume_ins(MVMThreadContext *tc, MVMJitGraph *jg,
                             MVMSpeshIterator *iter, MVMSpeshIns *ins) {
     MVMint16 op;
+    /* already compiled along with the instruction before it */
+    if (ins == jg->fused_ins)
+        return 1;
 start:
     op = ins->info->opcode;
     switch(op) {
@@ -1862,13 +2090,15 @@ start:
     case MVM_OP_ctx:
     case MVM_OP_ctxlexpad:
     case MVM_OP_ctxcallerskipthunks:
-    case MVM_OP_curcode:
     case MVM_OP_getcode:
     case MVM_OP_sp_fastcreate:
     case MVM_OP_iscont:
     case MVM_OP_decont:
     case MVM_OP_sp_decont:
     case MVM_OP_sp_findmeth:
+    case MVM_OP_sp_findmeth_poly:
+    case MVM_OP_sp_atpos_i64_nc:
+    case MVM_OP_sp_bindpos_i64_nc:
     case MVM_OP_hllboxtype_i:
     case MVM_OP_hllboxtype_n:
     case MVM_OP_hllboxtype_s:
@@ -2276,7 +2506,8 @@ start:
         jg_append_call_c(tc, jg, op_to_func(tc, op), 2, args, MVM_JIT_RV_VOID, -1);
         break;
     }
-    case MVM_OP_takeclosure: {
+    case MVM_OP_takeclosure:
+    case MVM_OP_sp_takeclosure_local: {
         MVMint16 dst = ins->operands[0].reg.orig;
         MVMint16 src = ins->operands[1].reg.orig;
         MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
@@ -2422,6 +2653,64 @@ start:
         jg_append_call_c(tc, jg, op_to_func(tc, op), 3, args, MVM_JIT_RV_INT, result);
         break;
     }
+    /* The memory order is passed as a literal; the C functions switch on it,
+     * as the expression JIT has no atomic nodes. */
+    case MVM_OP_arratomicload_i: {
+        MVMint16 result = ins->operands[0].reg.orig;
+        MVMint16 array  = ins->operands[1].reg.orig;
+        MVMint16 index  = ins->operands[2].reg.orig;
+        MVMint16 order  = ins->operands[3].lit_i16;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { array } },
+                                 { MVM_JIT_REG_VAL, { index } },
+                                 { MVM_JIT_LITERAL, { order } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 4, args, MVM_JIT_RV_INT, result);
+        break;
+    }
+    case MVM_OP_arratomicstore_i: {
+        MVMint16 array  = ins->operands[0].reg.orig;
+        MVMint16 index  = ins->operands[1].reg.orig;
+        MVMint16 value  = ins->operands[2].reg.orig;
+        MVMint16 order  = ins->operands[3].lit_i16;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { array } },
+                                 { MVM_JIT_REG_VAL, { index } },
+                                 { MVM_JIT_REG_VAL, { value } },
+                                 { MVM_JIT_LITERAL, { order } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 5, args, MVM_JIT_RV_VOID, -1);
+        break;
+    }
+    case MVM_OP_arratomicadd_i:
+    case MVM_OP_arratomicxchg_i: {
+        MVMint16 result = ins->operands[0].reg.orig;
+        MVMint16 array  = ins->operands[1].reg.orig;
+        MVMint16 index  = ins->operands[2].reg.orig;
+        MVMint16 value  = ins->operands[3].reg.orig;
+        MVMint16 order  = ins->operands[4].lit_i16;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { array } },
+                                 { MVM_JIT_REG_VAL, { index } },
+                                 { MVM_JIT_REG_VAL, { value } },
+                                 { MVM_JIT_LITERAL, { order } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 5, args, MVM_JIT_RV_INT, result);
+        break;
+    }
+    case MVM_OP_arratomiccas_i: {
+        MVMint16 result   = ins->operands[0].reg.orig;
+        MVMint16 array    = ins->operands[1].reg.orig;
+        MVMint16 index    = ins->operands[2].reg.orig;
+        MVMint16 expected = ins->operands[3].reg.orig;
+        MVMint16 value    = ins->operands[4].reg.orig;
+        MVMint16 order    = ins->operands[5].lit_i16;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { array } },
+                                 { MVM_JIT_REG_VAL, { index } },
+                                 { MVM_JIT_REG_VAL, { expected } },
+                                 { MVM_JIT_REG_VAL, { value } },
+                                 { MVM_JIT_LITERAL, { order } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 6, args, MVM_JIT_RV_INT, result);
+        break;
+    }
     case MVM_OP_atomicload_o: {
         MVMint16 dst = ins->operands[0].reg.orig;
         MVMint16 target = ins->operands[1].reg.orig;
@@ -2616,9 +2905,79 @@ start:
             return 0;
         }
         break;
+        /* multi-dim array ops */
+    case MVM_OP_atpos2d_i:
+    case MVM_OP_atpos2d_n:
+    case MVM_OP_atpos2d_s:
+    case MVM_OP_atpos2d_o:
+    case MVM_OP_atpos3d_i:
+    case MVM_OP_atpos3d_n:
+    case MVM_OP_atpos3d_s:
+    case MVM_OP_atpos3d_o:
+    case MVM_OP_atposnd_i:
+    case MVM_OP_atposnd_n:
+    case MVM_OP_atposnd_s:
+    case MVM_OP_atposnd_o: {
+        /* The result, the array, then the indices (or an array of them). */
+        MVMint16 dst = ins->operands[0].reg.orig;
+        MVMint32 num_args = ins->info->num_operands;
+        MVMuint16 rv = (ins->info->operands[0] & MVM_operand_type_mask) == MVM_operand_int64
+                       ? MVM_JIT_RV_INT
+                       : (ins->info->operands[0] & MVM_operand_type_mask) == MVM_operand_num64
+                       ? MVM_JIT_RV_NUM
+                       : MVM_JIT_RV_PTR;
+        MVMJitCallArg args[5] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } } };
+        MVMint32 i;
+        for (i = 1; i < num_args; i++) {
+            args[i].type = MVM_JIT_REG_VAL;
+            args[i].v.reg = ins->operands[i].reg.orig;
+        }
+        jg_append_call_c(tc, jg, op_to_func(tc, op), num_args, args, rv, dst);
+        break;
+    }
+    case MVM_OP_bindpos2d_i:
+    case MVM_OP_bindpos2d_n:
+    case MVM_OP_bindpos2d_s:
+    case MVM_OP_bindpos2d_o:
+    case MVM_OP_bindpos3d_i:
+    case MVM_OP_bindpos3d_n:
+    case MVM_OP_bindpos3d_s:
+    case MVM_OP_bindpos3d_o:
+    case MVM_OP_bindposnd_i:
+    case MVM_OP_bindposnd_n:
+    case MVM_OP_bindposnd_s:
+    case MVM_OP_bindposnd_o:
+    case MVM_OP_mdfill_i:
+    case MVM_OP_mdfill_n:
+    case MVM_OP_mdcopy:
+    case MVM_OP_mdtranspose:
+    case MVM_OP_mdelemwise:
+    case MVM_OP_mdreadline:
+    case MVM_OP_mdwriteline: {
+        /* All operands are passed on as they are, nums in float registers. */
+        MVMint32 num_args = ins->info->num_operands;
+        MVMJitCallArg args[6] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } } };
+        MVMint32 i;
+        for (i = 0; i < num_args; i++) {
+            args[i + 1].type = (ins->info->operands[i] & MVM_operand_type_mask) == MVM_operand_num64
+                               ? MVM_JIT_REG_VAL_F : MVM_JIT_REG_VAL;
+            args[i + 1].v.reg = ins->operands[i].reg.orig;
+        }
+        jg_append_call_c(tc, jg, op_to_func(tc, op), num_args + 1, args, MVM_JIT_RV_VOID, -1);
+        if (op == MVM_OP_mdfill_i || op == MVM_OP_mdfill_n || op == MVM_OP_mdcopy
+                || op == MVM_OP_mdtranspose || op == MVM_OP_mdelemwise
+                || op == MVM_OP_mdwriteline)
+            jg_sc_wb(tc, jg, ins->operands[0]);
+        break;
+    }
     case MVM_OP_iterkey_s:
     case MVM_OP_iterval:
-    case MVM_OP_iter: {
+    case MVM_OP_iter:
+    case MVM_OP_sp_iter_shift_arr_o:
+    case MVM_OP_sp_iter_shift_arr_s:
+    case MVM_OP_sp_iter_shift_hash:
+    case MVM_OP_sp_iterkey_hash:
+    case MVM_OP_sp_iterval_hash: {
         MVMint16 dst      = ins->operands[0].reg.orig;
         MVMint32 invocant = ins->operands[1].reg.orig;
         MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
@@ -2626,6 +2985,16 @@ start:
         jg_append_call_c(tc, jg, op_to_func(tc, op), 2, args, MVM_JIT_RV_PTR, dst);
         break;
     }
+    case MVM_OP_sp_iter_shift_arr_i:
+    case MVM_OP_sp_iter_shift_arr_n: {
+        MVMint16 dst  = ins->operands[0].reg.orig;
+        MVMint32 iter = ins->operands[1].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { iter } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 2, args,
+            op == MVM_OP_sp_iter_shift_arr_i ? MVM_JIT_RV_INT : MVM_JIT_RV_NUM, dst);
+        break;
+    }
     case MVM_OP_continuationreset: {
         MVMint16 reg  = ins->operands[0].reg.orig;
         MVMint16 tag  = ins->operands[1].reg.orig;
@@ -3717,10 +4086,12 @@ start:
     }
         /* profiling */
     case MVM_OP_prof_allocated: {
-        MVMint16 reg = ins->operands[0].reg.orig;
+        MVMint16 reg  = ins->operands[0].reg.orig;
+        MVMint32 line = ins->operands[1].lit_i32;
         MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
-                                 { MVM_JIT_REG_VAL, { reg } } };
-        jg_append_call_c(tc, jg, op_to_func(tc, op), 2, args, MVM_JIT_RV_VOID, -1);
+                                 { MVM_JIT_REG_VAL, { reg } },
+                                 { MVM_JIT_LITERAL, { line } } };
+        jg_append_call_c(tc, jg, op_to_func(tc, op), 3, args, MVM_JIT_RV_VOID, -1);
         break;
     }
     case MVM_OP_prof_exit: {
@@ -3896,6 +4267,7 @@ start:
         jg_append_call_c(tc, jg, op_to_func(tc, op), 2, args, MVM_JIT_RV_PTR, dst);
         break;
     }
+    case MVM_OP_curcode:
     case MVM_OP_callercode: {
         MVMint16 dst = ins->operands[0].reg.orig;
         MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } } };
@@ -3925,8 +4297,22 @@ start:
             }
         }
         if (!emitted_extop) {
-            add_bail_comment(tc, jg, ins);
-            return 0;
+            /* Let the interpreter run it, if it can */
+            size_t bytecode_size;
+            MVMuint8 *bytecode = try_interp_op_bytecode(tc, jg, ins, &bytecode_size);
+            if (bytecode == NULL) {
+                add_bail_comment(tc, jg, ins);
+                return 0;
+            }
+            else {
+                MVMint32 data_label = jg_add_data_node(tc, jg, bytecode, bytecode_size);
+                MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR,  { MVM_JIT_INTERP_TC } },
+                                         { MVM_JIT_DATA_LABEL,  { data_label } } };
+                jg_append_call_c(tc, jg, MVM_interp_run_single_op, 2, args, MVM_JIT_RV_VOID, -1);
+                count_op(tc, tc->instance->jit_interp_op_counts, ins);
+                if (MVM_spesh_debug_enabled(tc))
+                    MVM_spesh_graph_add_comment(tc, jg->sg, ins, "JIT: run by the interpreter");
+            }
         }
     }
     }
@@ -3938,11 +4324,12 @@ static MVMint32 consume_bb(MVMThreadContext *tc, MVMJitGraph *jg,
     MVMJitExprTree *tree = NULL;
     MVMuint32 i;
     MVMint32 label = MVM_jit_label_before_bb(tc, jg, bb);
+    MVMint32 produced = (MVMint32)MVM_load(&tc->instance->spesh_produced);
     jg_append_label(tc, jg, label);
 
     /* add a jit breakpoint if required */
     for (i = 0; i < tc->instance->jit_breakpoints_num; i++) {
-        if (tc->instance->jit_breakpoints[i].frame_nr == tc->instance->spesh_produced &&
+        if (tc->instance->jit_breakpoints[i].frame_nr == produced &&
             tc->instance->jit_breakpoints[i].block_nr == iter->bb->idx) {
             jg_append_control(tc, jg, bb->first_ins, MVM_JIT_CONTROL_BREAKPOINT);
             break; /* one is enough though */
@@ -3952,8 +4339,8 @@ static MVMint32 consume_bb(MVMThreadContext *tc, MVMJitGraph *jg,
     /* Try to create an expression tree */
     if (tc->instance->jit_expr_enabled &&
         (tc->instance->jit_expr_last_frame < 0 ||
-         tc->instance->spesh_produced < tc->instance->jit_expr_last_frame ||
-         (tc->instance->spesh_produced == tc->instance->jit_expr_last_frame &&
+         produced < tc->instance->jit_expr_last_frame ||
+         (produced == tc->instance->jit_expr_last_frame &&
           (tc->instance->jit_expr_last_bb < 0 ||
            iter->bb->idx <= tc->instance->jit_expr_last_bb)))) {
 
@@ -3977,8 +4364,15 @@ static MVMint32 consume_bb(MVMThreadContext *tc, MVMJitGraph *jg,
     /* Try to consume the (rest of the) basic block per instruction */
     while (iter->ins) {
         before_ins(tc, jg, iter, iter->ins);
-        if(!consume_ins(tc, jg, iter, iter->ins))
+        if(!consume_ins(tc, jg, iter, iter->ins)) {
+            count_op(tc, tc->instance->jit_bail_counts, iter->ins);
             return 0;
+        }
+        if (jg->unsupported_ins) {
+            add_bail_comment(tc, jg, jg->unsupported_ins);
+            count_op(tc, tc->instance->jit_bail_counts, jg->unsupported_ins);
+            return 0;
+        }
         after_ins(tc, jg, iter, iter->ins);
         MVM_spesh_iterator_next_ins(tc, iter);
     }
@@ -4017,6 +4411,8 @@ MVMJitGraph * MVM_jit_try_make_graph(MVMThreadContext *tc, MVMSpeshGraph *sg) {
     MVM_VECTOR_INIT(graph->label_nodes, 16 + sg->num_bbs);
 
     graph->expr_seq_nr = 0;
+    graph->unsupported_ins = NULL;
+    graph->fused_ins = NULL;
 
     /* JIT handlers are indexed by spesh graph handler index */
     if (sg->num_handlers > 0) {
@@ -16,6 +16,13 @@ struct MVMJitGraph {
     /* resultant JIT code is supports 'invokish' etc? */
     MVMuint8       no_trampoline;
 
+    /* Primitive instruction the architecture backend can't compile, if any */
+    MVMSpeshIns   *unsupported_ins;
+
+    /* Instruction compiled as part of the one before it, such as the unbox of
+     * a native call result */
+    MVMSpeshIns   *fused_ins;
+
     /* All labeled things */
     MVM_VECTOR_DECL(void*, obj_labels);
     MVM_VECTOR_DECL(MVMJitDeopt, deopts);
@@ -188,6 +195,8 @@ struct MVMJitInvoke {
     MVMint8       is_resolve;
     MVMuint32     resolve_offset;           /* Only for spesh resolve */
     MVMint32      reentry_label;
+    /* The function of a known MVMCFunction invokee, which we call directly */
+    void        (*cfunc)(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args);
 };
 
 struct MVMJitJumpList {
@@ -243,4 +252,5 @@ struct MVMJitNode {
 };
 
 MVMJitGraph* MVM_jit_try_make_graph(MVMThreadContext *tc, MVMSpeshGraph *sg);
+MVMint32 MVM_jit_arch_supports_primitive(MVMThreadContext *tc, MVMSpeshIns *ins);
 void MVM_jit_graph_destroy(MVMThreadContext *tc, MVMJitGraph *graph);
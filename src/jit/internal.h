@@ -18,7 +18,7 @@ struct MVMJitCompiler {
 
     /* For spilling values that don't fit into the register allocator */
     MVMint32    spills_base;
-    MVMint32    spills_free[4];
+    MVMint32    spills_free[3];
     MVM_VECTOR_DECL(struct { MVMint8 reg_type; MVMint32 next; }, spills);
 
     void *dasm_globals[MVM_JIT_MAX_GLOBALS];
@@ -68,11 +68,14 @@ void MVM_jit_spill_memory_release(MVMThreadContext *tc, MVMJitCompiler *compiler
 /* Although we use these only symbolically, we need to assign a temporary value
  * in order to to distinguish between them */
 #define MVM_JIT_ARCH_X64 1
+#define MVM_JIT_ARCH_ARM64 2
 #define MVM_JIT_PLATFORM_POSIX 1
 #define MVM_JIT_PLATFORM_WIN32 2
 
 #if MVM_JIT_ARCH == MVM_JIT_ARCH_X64
 #define MVM_JIT_ARCH_H "jit/x64/arch.h"
+#elif MVM_JIT_ARCH == MVM_JIT_ARCH_ARM64
+#define MVM_JIT_ARCH_H "jit/arm64/arch.h"
 #endif
 
 /* Depends on values of MVM_JIT_PLATFORM, so need to be defined, but uses the
@@ -82,6 +85,7 @@ void MVM_jit_spill_memory_release(MVMThreadContext *tc, MVMJitCompiler *compiler
 #endif
 
 #undef MVM_JIT_ARCH_X64
+#undef MVM_JIT_ARCH_ARM64
 #undef MVM_JIT_PLATFORM_POSIX
 #undef MVM_JIT_PLATFORM_WIN32
 
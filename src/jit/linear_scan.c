@@ -52,6 +52,13 @@ typedef struct {
 
     MVMuint32 spill_pos;
     MVMuint32 spill_idx;
+
+    /* Constant tile that can recompute this value instead of loading it from
+     * a spill slot */
+    MVMJitTile *remat;
+    /* Set when this live range is reloaded from the spill slot of another,
+     * in which case spilling it again simply reuses the slot */
+    MVMuint8 is_reload;
 } LiveRange;
 
 
@@ -85,6 +92,10 @@ typedef struct {
 
     /* Currently free registers */
     MVMBitmap reg_free;
+
+    /* Number of CALL tiles prior to each tile, to split spilled live ranges
+     * at call boundaries */
+    MVMuint32 *calls_before;
 } RegisterAllocator;
 
 
@@ -692,13 +703,101 @@ static void spill_set_release(MVMThreadContext *tc, RegisterAllocator *alc, MVMu
     }
 }
 
+/* Vectors are wider than a register, and so is their spill slot */
+MVM_STATIC_INLINE MVMint8 spill_size(MVMint8 reg_type) {
+    return reg_type == MVM_JIT_REG_VEC ? MVM_JIT_VEC_SZ : sizeof(MVMRegister);
+}
+
+/* A value defined only by a constant tile can be recomputed wherever it is
+ * needed, which is cheaper than a store and a load */
+static MVMJitTile * constant_definition(MVMJitTileList *list, LiveRange *range) {
+    MVMJitTile *def = NULL;
+    ValueRef *ref;
+    for (ref = range->first; ref != NULL; ref = ref->next) {
+        if (is_definition(ref)) {
+            if (def != NULL)
+                return NULL;
+            def = list->items[ref->tile_idx];
+        }
+    }
+    if (def == NULL || def->num_refs > 0)
+        return NULL;
+    switch (def->op) {
+    case MVM_JIT_CONST:
+    case MVM_JIT_CONST_LARGE:
+    case MVM_JIT_CONST_PTR:
+    case MVM_JIT_CONST_NUM:
+        return def;
+    default:
+        return NULL;
+    }
+}
+
+MVM_STATIC_INLINE MVMJitTile * clone_tile(MVMThreadContext *tc, RegisterAllocator *alc, MVMJitTile *tile) {
+    MVMJitTile *clone = MVM_spesh_alloc(tc, alc->compiler->graph->sg, sizeof(MVMJitTile));
+    memcpy(clone, tile, sizeof(MVMJitTile));
+    clone->debug_name = "#rematerialize";
+    return clone;
+}
+
+/* Choose where to spill a live range. Constants need no memory, and a live
+ * range that was itself reloaded from a spill slot can use that slot again,
+ * which is still valid and reserved for as long as the original value lives */
+static MVMuint32 select_spill_pos(MVMThreadContext *tc, RegisterAllocator *alc, MVMJitTileList *list, MVMuint32 v) {
+    LiveRange *range = alc->values + v;
+    if (range->remat == NULL && !range->is_reload)
+        range->remat = constant_definition(list, range);
+    if (range->remat != NULL)
+        return 0;
+    if (range->is_reload)
+        return range->spill_pos;
+    return MVM_jit_spill_memory_select(tc, alc->compiler, range->reg_type);
+}
+
+MVM_STATIC_INLINE MVMuint32 tile_block(MVMJitTileList *list, MVMuint32 tile_idx) {
+    MVMuint32 lo = 0, hi = list->blocks_num;
+    while (lo + 1 < hi) {
+        MVMuint32 mid = (lo + hi) / 2;
+        if (list->blocks[mid].start <= tile_idx)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Uses can share a single load if the first is always executed before the
+ * second (they're in the same basic block) and no CALL intervenes, counting a
+ * CALL that is the first use itself */
+MVM_STATIC_INLINE MVMint32 can_share_load(RegisterAllocator *alc, MVMJitTileList *list,
+                                          ValueRef *a, ValueRef *b) {
+    return tile_block(list, a->tile_idx) == tile_block(list, b->tile_idx) &&
+        alc->calls_before[b->tile_idx] == alc->calls_before[a->tile_idx];
+}
+
+static MVMint32 insert_remat_before_use(MVMThreadContext *tc, RegisterAllocator *alc, MVMJitTileList *list,
+                                        ValueRef *ref, MVMJitTile *def) {
+    MVMint32 n = live_range_init(alc);
+    MVMJitTile *tile = clone_tile(tc, alc, def);
+    LiveRange *range = alc->values + n;
+    MVM_jit_tile_list_insert(tc, list, tile, ref->tile_idx - 1, +1); /* insert just prior to use */
+    range->synthetic[0] = tile;
+    range->first = range->last = ref;
+    range->remat = def;
+
+    range->start = order_nr(ref->tile_idx) - 1;
+    range->end   = order_nr(ref->tile_idx);
+    return n;
+}
+
 static MVMint32 insert_load_before_use(MVMThreadContext *tc, RegisterAllocator *alc, MVMJitTileList *list,
-                                       ValueRef *ref, MVMint32 load_pos) {
+                                       ValueRef *ref, MVMint32 load_pos, MVMint8 reg_type) {
     MVMint32 n = live_range_init(alc);
     MVMJitTile *tile = MVM_jit_tile_make(tc, alc->compiler, MVM_jit_compile_load, 2, 1,
                                          MVM_JIT_STORAGE_LOCAL, load_pos, 0);
     LiveRange *range = alc->values + n;
     tile->debug_name = "#load-before-use";
+    tile->size       = spill_size(reg_type);
     MVM_jit_tile_list_insert(tc, list, tile, ref->tile_idx - 1, +1); /* insert just prior to use */
     range->synthetic[0] = tile;
     range->first = range->last = ref;
@@ -709,12 +808,13 @@ static MVMint32 insert_load_before_use(MVMThreadContext *tc, RegisterAllocator *
 }
 
 static MVMint32 insert_store_after_definition(MVMThreadContext *tc, RegisterAllocator *alc, MVMJitTileList *list,
-                                              ValueRef *ref, MVMint32 store_pos) {
+                                              ValueRef *ref, MVMint32 store_pos, MVMint8 reg_type) {
     MVMint32 n       = live_range_init(alc);
     MVMJitTile *tile = MVM_jit_tile_make(tc, alc->compiler, MVM_jit_compile_store, 2, 2,
                                          MVM_JIT_STORAGE_LOCAL, store_pos, 0, 0);
     LiveRange *range  = alc->values + n;
     tile->debug_name = "#store-after-definition";
+    tile->size       = spill_size(reg_type);
     MVM_jit_tile_list_insert(tc, list, tile, ref->tile_idx, -1); /* insert just after storage */
     range->synthetic[1] = tile;
     range->first = range->last = ref;
@@ -739,6 +839,10 @@ static void live_range_spill(MVMThreadContext *tc, RegisterAllocator *alc, MVMJi
                              MVMuint32 to_spill, MVMuint32 spill_pos, MVMuint32 code_pos) {
 
     MVMint8 reg_spilled = alc->values[to_spill].reg_num;
+    MVMJitTile *remat   = alc->values[to_spill].remat;
+    /* future uses that can share one load or rematerialization are split off
+     * into a single live range */
+    MVMint32 split = -1;
     /* loop over all value refs */
     _DEBUG("Spilling live range value %d to memory position %d at %d", to_spill, spill_pos, code_pos);
 
@@ -757,23 +861,43 @@ static void live_range_spill(MVMThreadContext *tc, RegisterAllocator *alc, MVMJi
              * already been handled, so we do need to insert a load a before
              * them (or modify in place, but, complex!). */
             continue;
+        } else if (order_nr(ref->tile_idx) < code_pos && (remat != NULL || !is_definition(ref))) {
+            /* past uses have been assigned the spilled register, which holds
+             * the value up to here, so they don't need a load; nor does the
+             * definition of a constant need a store */
+            continue;
+        } else if (split >= 0 && can_share_load(alc, list, alc->values[split].last, ref)) {
+            /* extend the previous split; it hasn't been allocated yet */
+            alc->values[split].last->next = ref;
+            alc->values[split].last       = ref;
+            alc->values[split].end        = order_nr(ref->tile_idx);
+            continue;
         } else if (is_definition(ref)) {
-            n = insert_store_after_definition(tc, alc, list, ref, spill_pos);
+            n = insert_store_after_definition(tc, alc, list, ref, spill_pos,
+                                              alc->values[to_spill].reg_type);
+        } else if (remat != NULL) {
+            n = insert_remat_before_use(tc, alc, list, ref, remat);
         } else {
-            n = insert_load_before_use(tc, alc, list, ref, spill_pos);
+            n = insert_load_before_use(tc, alc, list, ref, spill_pos,
+                                       alc->values[to_spill].reg_type);
+            alc->values[n].is_reload = 1;
+            alc->values[n].spill_pos = spill_pos;
         }
         alc->values[n].reg_perm = alc->values[to_spill].reg_perm;
+        alc->values[n].reg_type = alc->values[to_spill].reg_type;
 
         if (order_nr(ref->tile_idx) < code_pos) {
             /* in the past, which means we can safely use the spilled register
              * and immediately retire this live range */
             assign_register(tc, alc, list, n, reg_spilled);
             MVM_VECTOR_PUSH(alc->retired, n);
+            split = -1;
         } else {
             /* in the future, which means we need to add it to the worklist */
             MVM_VECTOR_ENSURE_SPACE(alc->worklist, 1);
             live_range_heap_push(alc->values, alc->worklist, &alc->worklist_num, n,
                                  values_cmp_first_ref);
+            split = is_definition(ref) ? -1 : n;
         }
     }
 
@@ -784,9 +908,12 @@ static void live_range_spill(MVMThreadContext *tc, RegisterAllocator *alc, MVMJi
     alc->values[to_spill].spill_pos = spill_pos;
     alc->values[to_spill].spill_idx = code_pos;
     free_register(tc, alc, reg_spilled);
-    MVM_VECTOR_ENSURE_SPACE(alc->spilled, 1);
-    live_range_heap_push(alc->values, alc->spilled, &alc->spilled_num,
-                         to_spill, values_cmp_last_ref);
+    if (remat == NULL && !alc->values[to_spill].is_reload) {
+        /* the slot is ours until the (original) last use */
+        MVM_VECTOR_ENSURE_SPACE(alc->spilled, 1);
+        live_range_heap_push(alc->values, alc->spilled, &alc->spilled_num,
+                             to_spill, values_cmp_last_ref);
+    }
 }
 
 
@@ -845,7 +972,7 @@ static void prepare_arglist_and_call(MVMThreadContext *tc, RegisterAllocator *al
         MVMuint32 code_pos = order_nr(call_idx);
         if (v->end > code_pos && live_range_has_hole(v, code_pos) == NULL) {
             /* surviving values need to be spilled */
-            MVMint32 spill_pos = MVM_jit_spill_memory_select(tc, alc->compiler, v->reg_type);
+            MVMint32 spill_pos = select_spill_pos(tc, alc, list, alc->active[i]);
             /* spilling at the CALL idx will mean that the spiller inserts a
              * LOAD at the current register before the ARGLIST, meaning it
              * remains 'live' for this ARGLIST */
@@ -1010,7 +1137,20 @@ static void prepare_arglist_and_call(MVMThreadContext *tc, RegisterAllocator *al
         LiveRange *v = alc->values + arg_values[arg];
         MVMJitStorageClass arg_cls = storage_refs[arg]._cls;
         MVMint32 arg_pos = storage_refs[arg]._pos;
-        if (arg_cls == MVM_JIT_STORAGE_GPR || arg_cls == MVM_JIT_STORAGE_FPR) {
+        if (v->remat != NULL) {
+            /* recompute the constant directly into place */
+            MVMJitTile *tile = clone_tile(tc, alc, v->remat);
+            if (arg_cls == MVM_JIT_STORAGE_STACK) {
+                MVMint8 reg_cls = v->remat->register_spec[0];
+                MVMint8 spare   = MVM_FFS(MVM_JIT_SPARE_REGISTERS & MVM_JIT_REGISTER_CLASS[reg_cls]) - 1;
+                tile->values[0] = spare;
+                INSERT_NEXT_TILE(tile);
+                INSERT_COPY_TO_STACK(arg_pos, spare);
+            } else {
+                tile->values[0] = arg_pos;
+                INSERT_NEXT_TILE(tile);
+            }
+        } else if (arg_cls == MVM_JIT_STORAGE_GPR || arg_cls == MVM_JIT_STORAGE_FPR) {
             _DEBUG("Loading spilled value to Rq(%d) from [rbx+%d]", storage_refs[arg]._pos, v->spill_pos);
             INSERT_LOAD_LOCAL(arg_pos, v->spill_pos);
         } else if (arg_cls == MVM_JIT_STORAGE_STACK) {
@@ -1077,7 +1217,7 @@ static void process_live_range(MVMThreadContext *tc, RegisterAllocator *alc, MVM
             /* choose a live range, a register to spill, and a spill location */
             /* also one that is valid for this register type */
             MVMuint32 to_spill   = select_live_range_for_spill(tc, alc, list, tile_order_nr, reg_perm);
-            MVMuint32 spill_pos  = MVM_jit_spill_memory_select(tc, alc->compiler, alc->values[to_spill].reg_type);
+            MVMuint32 spill_pos  = select_spill_pos(tc, alc, list, to_spill);
             active_set_splice(tc, alc, to_spill);
             _DEBUG("Spilling live range %d at %d to %d to free up a register",
 `                   to_spill, tile_order_nr, spill_pos);
@@ -1181,6 +1321,7 @@ static void enforce_operand_requirements(MVMThreadContext *tc, RegisterAllocator
 
 void MVM_jit_linear_scan_allocate(MVMThreadContext *tc, MVMJitCompiler *compiler, MVMJitTileList *list) {
     RegisterAllocator alc;
+    MVMuint32 i;
     /* initialize allocator */
     alc.compiler = compiler;
     /* restart spill stack */
@@ -1189,6 +1330,12 @@ void MVM_jit_linear_scan_allocate(MVMThreadContext *tc, MVMJitCompiler *compiler
     memset(alc.active, -1, sizeof(alc.active));
 
     alc.reg_free = MVM_JIT_AVAILABLE_REGISTERS;
+    alc.calls_before = MVM_malloc((list->items_num + 1) * sizeof(MVMuint32));
+    alc.calls_before[0] = 0;
+    for (i = 0; i < list->items_num; i++) {
+        alc.calls_before[i + 1] = alc.calls_before[i] +
+            (MVM_jit_expr_op_is_call(list->items[i]->op) ? 1 : 0);
+    }
     /* run algorithm */
     determine_live_ranges(tc, &alc, list);
     linear_scan(tc, &alc, list);
@@ -1199,6 +1346,7 @@ void MVM_jit_linear_scan_allocate(MVMThreadContext *tc, MVMJitCompiler *compiler
     MVM_free(alc.refs);
     MVM_free(alc.holes);
     MVM_free(alc.values);
+    MVM_free(alc.calls_before);
 
     MVM_free(alc.worklist);
     MVM_free(alc.retired);
@@ -0,0 +1,450 @@
+#include "moar.h"
+#include "platform/io.h"
+
+/* Makes JIT-compiled code known to profilers and debuggers: perf's simple
+ * map file of symbols (MVM_JIT_PERF_MAP), perf's jitdump format, which also
+ * carries the code itself and the HLL source lines it came from
+ * (MVM_JIT_PERF_DUMP), and the GDB JIT interface (MVM_JIT_GDB). All of these
+ * are Linux-only. */
+
+#if defined(__linux__)
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#define JIT_ELF_MACHINE EM_X86_64
+#elif defined(__aarch64__)
+#define JIT_ELF_MACHINE EM_AARCH64
+#else
+#define JIT_ELF_MACHINE EM_NONE
+#endif
+
+/* See tools/perf/Documentation/jitdump-specification.txt in the Linux source
+ * tree for the jitdump format. */
+#define JITDUMP_MAGIC         0x4A695444
+#define JITDUMP_VERSION       1
+#define JITDUMP_CODE_LOAD     0
+#define JITDUMP_DEBUG_INFO    2
+
+typedef struct {
+    MVMuint32 magic;
+    MVMuint32 version;
+    MVMuint32 total_size;
+    MVMuint32 elf_mach;
+    MVMuint32 pad1;
+    MVMuint32 pid;
+    MVMuint64 timestamp;
+    MVMuint64 flags;
+} JitDumpHeader;
+
+typedef struct {
+    MVMuint32 id;
+    MVMuint32 total_size;
+    MVMuint64 timestamp;
+} JitDumpRecord;
+
+typedef struct {
+    JitDumpRecord record;
+    MVMuint32 pid;
+    MVMuint32 tid;
+    MVMuint64 vma;
+    MVMuint64 code_addr;
+    MVMuint64 code_size;
+    MVMuint64 code_index;
+    /* followed by the null-terminated name and the code */
+} JitDumpCodeLoad;
+
+typedef struct {
+    JitDumpRecord record;
+    MVMuint64 code_addr;
+    MVMuint64 nr_entry;
+    /* followed by the entries */
+} JitDumpDebugInfo;
+
+typedef struct {
+    MVMuint64 code_addr;
+    MVMuint32 line;
+    MVMuint32 discrim;
+    /* followed by the null-terminated file name */
+} JitDumpDebugEntry;
+
+/* The GDB JIT interface; GDB puts a breakpoint in __jit_debug_register_code
+ * and reads the symbol files linked from __jit_debug_descriptor. */
+typedef enum {
+    JIT_NOACTION = 0,
+    JIT_REGISTER_FN,
+    JIT_UNREGISTER_FN
+} jit_actions_t;
+
+struct jit_code_entry {
+    struct jit_code_entry *next_entry;
+    struct jit_code_entry *prev_entry;
+    const char *symfile_addr;
+    MVMuint64 symfile_size;
+};
+
+struct jit_descriptor {
+    MVMuint32 version;
+    MVMuint32 action_flag;
+    struct jit_code_entry *relevant_entry;
+    struct jit_code_entry *first_entry;
+};
+
+void __attribute__((noinline)) __jit_debug_register_code(void);
+void __attribute__((noinline)) __jit_debug_register_code(void) {
+    __asm__ __volatile__("");
+}
+struct jit_descriptor __jit_debug_descriptor = { 1, JIT_NOACTION, NULL, NULL };
+
+/* Opens the jitdump file in the given directory. It must be mapped as
+ * executable, as that is how perf record finds out about it. */
+void MVM_jit_perf_dump_open(MVMInstance *instance, const char *dir) {
+    JitDumpHeader header;
+    char *filename = MVM_malloc(strlen(dir) + 32);
+    FILE *fh;
+    sprintf(filename, "%s/jit-%d.dump", dir, (int)getpid());
+    fh = MVM_platform_fopen(filename, "w+");
+    MVM_free(filename);
+    if (!fh)
+        return;
+
+    header.magic      = JITDUMP_MAGIC;
+    header.version    = JITDUMP_VERSION;
+    header.total_size = sizeof(JitDumpHeader);
+    header.elf_mach   = JIT_ELF_MACHINE;
+    header.pad1       = 0;
+    header.pid        = getpid();
+    header.timestamp  = uv_hrtime();
+    header.flags      = 0;
+    fwrite(&header, sizeof(JitDumpHeader), 1, fh);
+    fflush(fh);
+
+    instance->jit_perf_dump_marker = mmap(NULL, sysconf(_SC_PAGESIZE),
+        PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(fh), 0);
+    if (instance->jit_perf_dump_marker == MAP_FAILED) {
+        instance->jit_perf_dump_marker = NULL;
+        fclose(fh);
+        return;
+    }
+    instance->jit_perf_dump = fh;
+}
+
+void MVM_jit_perf_dump_close(MVMInstance *instance) {
+    if (instance->jit_perf_dump_marker)
+        munmap(instance->jit_perf_dump_marker, sysconf(_SC_PAGESIZE));
+    if (instance->jit_perf_dump)
+        fclose(instance->jit_perf_dump);
+    instance->jit_perf_dump_marker = NULL;
+    instance->jit_perf_dump = NULL;
+}
+
+typedef struct {
+    MVMuint64  addr;
+    MVMuint32  line;
+    char      *file;
+} LineEntry;
+
+typedef struct {
+    MVMCompUnit *cu;
+    MVMuint32    string_idx;
+    char        *name;
+} FileName;
+
+typedef struct {
+    MVM_VECTOR_DECL(LineEntry, lines);
+    MVM_VECTOR_DECL(FileName, files);
+} LineTable;
+
+static char * file_name(MVMThreadContext *tc, LineTable *table, MVMCompUnit *cu, MVMuint32 idx) {
+    FileName file;
+    MVMuint32 i;
+    for (i = 0; i < table->files_num; i++)
+        if (table->files[i].cu == cu && table->files[i].string_idx == idx)
+            return table->files[i].name;
+    file.cu         = cu;
+    file.string_idx = idx;
+    file.name       = idx < cu->body.num_strings
+        ? MVM_string_utf8_encode_C_string(tc, MVM_cu_string(tc, cu, idx))
+        : NULL;
+    MVM_VECTOR_PUSH(table->files, file);
+    return file.name;
+}
+
+/* Finds the label the JIT has put before an instruction, without adding one
+ * if it has none (unlike MVM_jit_label_before_ins). */
+static MVMint32 existing_label_before_ins(MVMThreadContext *tc, MVMJitGraph *jg,
+                                          MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMuint32 i;
+    while (ins->prev && ins->prev->info->opcode == MVM_SSA_PHI)
+        ins = ins->prev;
+    if (!ins->prev)
+        return MVM_jit_label_before_bb(tc, jg, bb);
+    for (i = 0; i < jg->obj_labels_num; i++)
+        if (jg->obj_labels[i] == ins)
+            return i + jg->obj_label_ofs;
+    return -1;
+}
+
+/* Maps the start of every basic block, and every line number annotation that
+ * has a label in the code, to the source line it belongs to. Lines in inlined
+ * code are those of the inlinee. */
+static void collect_lines(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitCode *code,
+                          LineTable *table) {
+    MVMSpeshGraph *sg = jg->sg;
+    MVMSpeshBB    *bb;
+    MVMint32 inline_idx[64];
+    MVMint32 depth = -1;
+    char *file = NULL;
+    MVMuint32 line = 0;
+    for (bb = sg->entry; bb; bb = bb->linear_next) {
+        MVMSpeshIns *ins;
+        MVMint32 at_bb_start = 1;
+        for (ins = bb->first_ins; ins; ins = ins->next) {
+            MVMSpeshAnn *ann;
+            MVMint32 pops = 0, new_line = 0;
+            for (ann = ins->annotations; ann; ann = ann->next) {
+                switch (ann->type) {
+                case MVM_SPESH_ANN_INLINE_START:
+                    if (++depth < 64)
+                        inline_idx[depth] = ann->data.inline_idx;
+                    break;
+                case MVM_SPESH_ANN_INLINE_END:
+                    pops++;
+                    break;
+                case MVM_SPESH_ANN_LINENO: {
+                    MVMCompUnit *cu = depth < 0
+                        ? sg->sf->body.cu
+                        : sg->inlines[inline_idx[depth < 64 ? depth : 63]].sf->body.cu;
+                    file     = file_name(tc, table, cu, ann->data.lineno.filename_string_index);
+                    line     = ann->data.lineno.line_number;
+                    new_line = 1;
+                    break;
+                }
+                }
+            }
+            if (file && (at_bb_start || new_line)) {
+                MVMint32 label = existing_label_before_ins(tc, jg, bb, ins);
+                if (label >= 0 && (MVMuint32)label < code->num_labels) {
+                    LineEntry entry;
+                    entry.addr = (MVMuint64)(uintptr_t)code->labels[label];
+                    entry.line = line;
+                    entry.file = file;
+                    /* a later line at the same address wins */
+                    if (table->lines_num && table->lines[table->lines_num - 1].addr == entry.addr)
+                        table->lines[table->lines_num - 1] = entry;
+                    else
+                        MVM_VECTOR_PUSH(table->lines, entry);
+                }
+            }
+            at_bb_start = 0;
+            while (pops--)
+                depth--;
+        }
+    }
+}
+
+static void write_perf_dump(MVMThreadContext *tc, MVMJitCode *code, char *symbol_name,
+                            LineTable *table) {
+    FILE *fh = tc->instance->jit_perf_dump;
+    MVMuint64 timestamp = uv_hrtime();
+    MVMuint32 i;
+    if (table->lines_num) {
+        JitDumpDebugInfo info;
+        MVMuint32 size = sizeof(JitDumpDebugInfo);
+        for (i = 0; i < table->lines_num; i++)
+            size += sizeof(JitDumpDebugEntry) + strlen(table->lines[i].file) + 1;
+        info.record.id         = JITDUMP_DEBUG_INFO;
+        info.record.total_size = size;
+        info.record.timestamp  = timestamp;
+        info.code_addr         = (MVMuint64)(uintptr_t)code->func_ptr;
+        info.nr_entry          = table->lines_num;
+        fwrite(&info, sizeof(JitDumpDebugInfo), 1, fh);
+        for (i = 0; i < table->lines_num; i++) {
+            JitDumpDebugEntry entry;
+            entry.code_addr = table->lines[i].addr;
+            entry.line      = table->lines[i].line;
+            entry.discrim   = 0;
+            fwrite(&entry, sizeof(JitDumpDebugEntry), 1, fh);
+            fwrite(table->lines[i].file, strlen(table->lines[i].file) + 1, 1, fh);
+        }
+    }
+    {
+        JitDumpCodeLoad load;
+        size_t name_size = strlen(symbol_name) + 1;
+        load.record.id         = JITDUMP_CODE_LOAD;
+        load.record.total_size = sizeof(JitDumpCodeLoad) + name_size + code->size;
+        load.record.timestamp  = timestamp;
+        load.pid               = getpid();
+        load.tid               = (MVMuint32)syscall(SYS_gettid);
+        load.vma               = (MVMuint64)(uintptr_t)code->func_ptr;
+        load.code_addr         = (MVMuint64)(uintptr_t)code->func_ptr;
+        load.code_size         = code->size;
+        load.code_index        = tc->instance->jit_perf_dump_index++;
+        fwrite(&load, sizeof(JitDumpCodeLoad), 1, fh);
+        fwrite(symbol_name, name_size, 1, fh);
+        fwrite((void *)code->func_ptr, code->size, 1, fh);
+    }
+    fflush(fh);
+}
+
+/* Builds a minimal ELF object holding just a symbol for the code, which is
+ * all GDB needs to show JIT-compiled frames by name in backtraces. */
+static void register_with_gdb(MVMThreadContext *tc, MVMJitCode *code, char *symbol_name) {
+    enum { SECT_NULL, SECT_TEXT, SECT_SYMTAB, SECT_STRTAB, SECT_SHSTRTAB, SECT_NUM };
+    static const char shstrtab[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+    size_t name_size    = strlen(symbol_name) + 1;
+    size_t strtab_ofs   = sizeof(Elf64_Ehdr);
+    size_t shstrtab_ofs = strtab_ofs + 1 + name_size;
+    size_t symtab_ofs   = (shstrtab_ofs + sizeof(shstrtab) + 7) & ~(size_t)7;
+    size_t shdr_ofs     = symtab_ofs + 2 * sizeof(Elf64_Sym);
+    size_t size         = shdr_ofs + SECT_NUM * sizeof(Elf64_Shdr);
+    char *elf = MVM_calloc(1, size);
+    Elf64_Ehdr *ehdr = (Elf64_Ehdr *)elf;
+    Elf64_Sym  *syms = (Elf64_Sym *)(elf + symtab_ofs);
+    Elf64_Shdr *shdr = (Elf64_Shdr *)(elf + shdr_ofs);
+    struct jit_code_entry *entry;
+
+    memcpy(ehdr->e_ident, ELFMAG, SELFMAG);
+    ehdr->e_ident[EI_CLASS]   = ELFCLASS64;
+#ifdef MVM_BIGENDIAN
+    ehdr->e_ident[EI_DATA]    = ELFDATA2MSB;
+#else
+    ehdr->e_ident[EI_DATA]    = ELFDATA2LSB;
+#endif
+    ehdr->e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr->e_type      = ET_REL;
+    ehdr->e_machine   = JIT_ELF_MACHINE;
+    ehdr->e_version   = EV_CURRENT;
+    ehdr->e_shoff     = shdr_ofs;
+    ehdr->e_ehsize    = sizeof(Elf64_Ehdr);
+    ehdr->e_shentsize = sizeof(Elf64_Shdr);
+    ehdr->e_shnum     = SECT_NUM;
+    ehdr->e_shstrndx  = SECT_SHSTRTAB;
+
+    memcpy(elf + strtab_ofs + 1, symbol_name, name_size);
+    memcpy(elf + shstrtab_ofs, shstrtab, sizeof(shstrtab));
+
+    syms[1].st_name  = 1;
+    syms[1].st_info  = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    syms[1].st_shndx = SECT_TEXT;
+    syms[1].st_value = 0;
+    syms[1].st_size  = code->size;
+
+    shdr[SECT_TEXT].sh_name      = 1;
+    shdr[SECT_TEXT].sh_type      = SHT_NOBITS;
+    shdr[SECT_TEXT].sh_flags     = SHF_ALLOC | SHF_EXECINSTR;
+    shdr[SECT_TEXT].sh_addr      = (Elf64_Addr)(uintptr_t)code->func_ptr;
+    shdr[SECT_TEXT].sh_size      = code->size;
+    shdr[SECT_TEXT].sh_addralign = 16;
+    shdr[SECT_SYMTAB].sh_name      = 7;
+    shdr[SECT_SYMTAB].sh_type      = SHT_SYMTAB;
+    shdr[SECT_SYMTAB].sh_offset    = symtab_ofs;
+    shdr[SECT_SYMTAB].sh_size      = 2 * sizeof(Elf64_Sym);
+    shdr[SECT_SYMTAB].sh_link      = SECT_STRTAB;
+    shdr[SECT_SYMTAB].sh_info      = 1;
+    shdr[SECT_SYMTAB].sh_entsize   = sizeof(Elf64_Sym);
+    shdr[SECT_SYMTAB].sh_addralign = 8;
+    shdr[SECT_STRTAB].sh_name      = 15;
+    shdr[SECT_STRTAB].sh_type      = SHT_STRTAB;
+    shdr[SECT_STRTAB].sh_offset    = strtab_ofs;
+    shdr[SECT_STRTAB].sh_size      = 1 + name_size;
+    shdr[SECT_STRTAB].sh_addralign = 1;
+    shdr[SECT_SHSTRTAB].sh_name      = 23;
+    shdr[SECT_SHSTRTAB].sh_type      = SHT_STRTAB;
+    shdr[SECT_SHSTRTAB].sh_offset    = shstrtab_ofs;
+    shdr[SECT_SHSTRTAB].sh_size      = sizeof(shstrtab);
+    shdr[SECT_SHSTRTAB].sh_addralign = 1;
+
+    entry = MVM_calloc(1, sizeof(struct jit_code_entry));
+    entry->symfile_addr = elf;
+    entry->symfile_size = size;
+    entry->next_entry   = __jit_debug_descriptor.first_entry;
+    if (entry->next_entry)
+        entry->next_entry->prev_entry = entry;
+    __jit_debug_descriptor.first_entry    = entry;
+    __jit_debug_descriptor.relevant_entry = entry;
+    __jit_debug_descriptor.action_flag    = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+    code->gdb_entry = entry;
+}
+
+/* Tells perf and GDB about newly compiled code. */
+void MVM_jit_perf_code_created(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitCode *code) {
+    MVMInstance *instance = tc->instance;
+    MVMStaticFrame *sf = jg->sg->sf;
+    char symbol_name[1024];
+    char *file_location, *frame_name;
+
+    /* Native Call compiles code that doesn't correspond to a staticframe, in
+     * which case we just skip this. */
+    if (!sf || !(instance->jit_perf_map || instance->jit_perf_dump || instance->jit_gdb_enabled))
+        return;
+
+    file_location = MVM_staticframe_file_location(tc, sf);
+    frame_name    = MVM_string_utf8_encode_C_string(tc, sf->body.name);
+    snprintf(symbol_name, sizeof(symbol_name) - 1, "%s(%s)", frame_name, file_location);
+    MVM_free(file_location);
+    MVM_free(frame_name);
+
+    uv_mutex_lock(&instance->mutex_jit_perf);
+    if (instance->jit_perf_map) {
+        fprintf(instance->jit_perf_map, "%lx %lx %s\n",
+                (unsigned long) code->func_ptr, code->size, symbol_name);
+        fflush(instance->jit_perf_map);
+    }
+    if (instance->jit_perf_dump) {
+        LineTable table;
+        MVMuint32 i;
+        MVM_VECTOR_INIT(table.lines, 16);
+        MVM_VECTOR_INIT(table.files, 4);
+        collect_lines(tc, jg, code, &table);
+        write_perf_dump(tc, code, symbol_name, &table);
+        for (i = 0; i < table.files_num; i++)
+            MVM_free(table.files[i].name);
+        MVM_VECTOR_DESTROY(table.lines);
+        MVM_VECTOR_DESTROY(table.files);
+    }
+    if (instance->jit_gdb_enabled)
+        register_with_gdb(tc, code, symbol_name);
+    uv_mutex_unlock(&instance->mutex_jit_perf);
+}
+
+/* Tells GDB that code is gone. (The jitdump format has no record for that;
+ * perf goes by the time later code is loaded at the same address.) */
+void MVM_jit_perf_code_destroyed(MVMThreadContext *tc, MVMJitCode *code) {
+    struct jit_code_entry *entry = code->gdb_entry;
+    if (!entry)
+        return;
+    uv_mutex_lock(&tc->instance->mutex_jit_perf);
+    if (entry->prev_entry)
+        entry->prev_entry->next_entry = entry->next_entry;
+    else
+        __jit_debug_descriptor.first_entry = entry->next_entry;
+    if (entry->next_entry)
+        entry->next_entry->prev_entry = entry->prev_entry;
+    __jit_debug_descriptor.relevant_entry = entry;
+    __jit_debug_descriptor.action_flag    = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+    uv_mutex_unlock(&tc->instance->mutex_jit_perf);
+    MVM_free((void *)entry->symfile_addr);
+    MVM_free(entry);
+    code->gdb_entry = NULL;
+}
+
+#else
+
+void MVM_jit_perf_dump_open(MVMInstance *instance, const char *dir) {
+}
+
+void MVM_jit_perf_dump_close(MVMInstance *instance) {
+}
+
+void MVM_jit_perf_code_created(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitCode *code) {
+}
+
+void MVM_jit_perf_code_destroyed(MVMThreadContext *tc, MVMJitCode *code) {
+}
+
+#endif
@@ -0,0 +1,4 @@
+void MVM_jit_perf_dump_open(MVMInstance *instance, const char *dir);
+void MVM_jit_perf_dump_close(MVMInstance *instance);
+void MVM_jit_perf_code_created(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitCode *code);
+void MVM_jit_perf_code_destroyed(MVMThreadContext *tc, MVMJitCode *code);
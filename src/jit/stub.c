@@ -25,6 +25,18 @@ void MVM_jit_code_destroy(MVMThreadContext *tc, MVMJitCode *code) {
     return;
 }
 
+void MVM_jit_code_heap_destroy(MVMInstance *instance) {
+    return;
+}
+
+void MVM_jit_perf_dump_open(MVMInstance *instance, const char *dir) {
+    return;
+}
+
+void MVM_jit_perf_dump_close(MVMInstance *instance) {
+    return;
+}
+
 void MVM_jit_code_enter(MVMThreadContext *tc, MVMJitCode *code, MVMCompUnit *cu) {
     return;
 }
@@ -2,9 +2,18 @@
 #include "internal.h"
 #include <math.h>
 
+/* internal.h undefines the architecture names again, so define them here;
+ * and undefine them before including the tables, which name registers */
+#define MVM_JIT_ARCH_X64 1
+#define MVM_JIT_ARCH_ARM64 2
 #if MVM_JIT_ARCH == MVM_JIT_ARCH_X64
-#include "jit/x64/tile_pattern.h"
+#define MVM_JIT_TILE_PATTERN_H "jit/x64/tile_pattern.h"
+#elif MVM_JIT_ARCH == MVM_JIT_ARCH_ARM64
+#define MVM_JIT_TILE_PATTERN_H "jit/arm64/tile_pattern.h"
 #endif
+#undef MVM_JIT_ARCH_X64
+#undef MVM_JIT_ARCH_ARM64
+#include MVM_JIT_TILE_PATTERN_H
 
 
 #if MVM_JIT_DEBUG
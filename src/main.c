@@ -13,7 +13,8 @@
 #endif
 
 #ifdef HAVE_TELEMEH
-#  define TELEMEH_USAGE "    MVM_TELEMETRY_LOG           Log internal events at high precision to this file\n"
+#  define TELEMEH_USAGE "    MVM_TELEMETRY_LOG           Log internal events at high precision to this file\n" \
+                        "    MVM_TELEMETRY_FORMAT        Set to \"binary\" for a binary telemetry log\n"
 #else
 #  define TELEMEH_USAGE ""
 #endif
@@ -87,20 +88,32 @@ The following environment variables are respected:\n\
     MVM_SPESH_INLINE_DISABLE    Disables inlining\n\
     MVM_SPESH_OSR_DISABLE       Disables on-stack replacement\n\
     MVM_SPESH_PEA_DISABLE       Disables partial escape analysis and related optimizations\n\
+    MVM_SPESH_LICM_DISABLE      Disables moving loop-invariant code out of loops\n\
+    MVM_SPESH_BASELINE_DISABLE  Disables JIT compiling frames before they are specialized\n\
+    MVM_SPESH_CLOSURES_DISABLE  Disables keeping the outers of local closures on the stack\n\
     MVM_SPESH_BLOCKING          Blocks log-sending thread while specializer runs\n\
     MVM_SPESH_LOG               Specifies a dynamic optimizer log file\n\
     MVM_SPESH_NODELAY           Run dynamic optimization even for cold frames\n\
     MVM_SPESH_LIMIT             Limit the maximum number of specializations\n\
+    MVM_SPESH_DEOPT_REPORT      Report where deopts happened at exit\n\
     MVM_JIT_DISABLE             Disables JITting to machine code\n\
     MVM_JIT_EXPR_DISABLE        Disable advanced 'expression' JIT\n\
+    MVM_JIT_PARTIAL_DISABLE     Don't JIT frames with ops the JIT can't compile\n\
+    MVM_JIT_BAIL_STATS          Report ops the JIT can't compile at exit\n\
     MVM_JIT_DEBUG               Add JIT debugging information to spesh log\n\
     MVM_JIT_PERF_MAP            Create a map file for the 'perf' profiler (linux only)\n\
+    MVM_JIT_PERF_DUMP           Write a jitdump file with code and source lines for 'perf'\n\
+                                  to this directory (linux only)\n\
+    MVM_JIT_GDB                 Register JIT-compiled code with GDB (linux only)\n\
     MVM_JIT_DUMP_BYTECODE       Dump bytecode in temporary directory\n\
     MVM_SPESH_INLINE_LOG        Dump details of inlining attempts to stderr\n\
     MVM_CROSS_THREAD_WRITE_LOG  Log unprotected cross-thread object writes to stderr\n\
     MVM_COVERAGE_LOG            Append (de-duped by default) line-by-line coverage messages to this file\n\
     MVM_COVERAGE_CONTROL        If set to 1, non-de-duping coverage started with nqp::coveragecontrol(1),\n\
-                                  if set to 2, non-de-duping coverage started right away\n"
+                                  if set to 2, non-de-duping coverage started right away\n\
+    MVM_COVERAGE_FORMAT         If set to 'lcov', count hits per line and write them to the\n\
+                                  coverage log at exit as an LCOV tracefile\n\
+    MVM_LOCK_PROFILE            Count lock acquisitions and waits; report the most contended at exit\n"
     TELEMEH_USAGE;
 
 static int cmp_flag(const void *key, const void *value)
@@ -263,7 +276,11 @@ int wmain(int argc, wchar_t *wargv[])
              );
         fp = MVM_platform_fopen(path, "w");
         if (fp) {
-            MVM_telemetry_init(fp);
+            char *format = getenv("MVM_TELEMETRY_FORMAT");
+            if (format && strcmp(format, "binary") == 0)
+                MVM_telemetry_init_binary(fp);
+            else
+                MVM_telemetry_init(fp);
             telemeh_inited = 1;
             interval_id = MVM_telemetry_interval_start(0, "moarvm startup");
         }
@@ -18,6 +18,15 @@
     #define MIN(x,y) ((x)<(y)?(x):(y))
 #endif
 
+/* Sizes, in digits, from which division uses Newton iteration, conversion to
+ * a string works by divide and conquer, and below which the parts it splits
+ * the number into are converted directly; and the size, in bits, below which
+ * a reciprocal is computed by plain division. */
+#define MVM_BIGINT_NEWTON_DIV_CUTOFF   200
+#define MVM_BIGINT_RADIX_DC_CUTOFF     200
+#define MVM_BIGINT_RADIX_DC_BASE       50
+#define MVM_BIGINT_NEWTON_BASE_BITS    (64 * MP_DIGIT_BIT)
+
 MVM_STATIC_INLINE void adjust_nursery(MVMThreadContext *tc, MVMP6bigintBody *body) {
     if (MVM_BIGINT_IS_BIG(body)) {
         int used = body->u.bigint->used;
@@ -142,6 +151,168 @@ static void store_bigint_result(MVMP6bigintBody *body, mp_int *i) {
     }
 }
 
+/* Makes the result of an operation on smallints, taking it from the integer
+ * cache if it's there. */
+static MVMObject * small_result(MVMThreadContext *tc, MVMObject *result_type, MVMint64 value) {
+    MVMObject *result = MVM_intcache_get(tc, result_type, value);
+    if (!result) {
+        result = MVM_repr_alloc_init(tc, result_type);
+        store_int64_result(tc, get_bigint_body(tc, result), value);
+    }
+    return result;
+}
+
+/* The GCD of two non-negative int64s. */
+static MVMint64 small_gcd(MVMint64 a, MVMint64 b) {
+    while (b != 0) {
+        MVMint64 t = b;
+        b = a % b;
+        a = t;
+    }
+    return a;
+}
+
+/* Multiplies two int64s, returning non-zero if the result doesn't fit. */
+static int mul_overflows(MVMint64 a, MVMint64 b, MVMint64 *result) {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+    return __builtin_mul_overflow(a, b, result);
+#else
+    MVMuint64 ua = a < 0 ? 0 - (MVMuint64)a : (MVMuint64)a;
+    MVMuint64 ub = b < 0 ? 0 - (MVMuint64)b : (MVMuint64)b;
+    MVMuint64 p;
+    int neg = (a < 0) != (b < 0);
+    if (ua == 0 || ub == 0) {
+        *result = 0;
+        return 0;
+    }
+    if (ua > UINT64_MAX / ub)
+        return 1;
+    p = ua * ub;
+    if (p > (neg ? (MVMuint64)INT64_MAX + 1 : (MVMuint64)INT64_MAX))
+        return 1;
+    *result = neg ? (MVMint64)(0 - p) : (MVMint64)p;
+    return 0;
+#endif
+}
+
+/* Computes an approximation to 2^(2p) / c, for a c of p bits, to within a
+ * few units. Uses Newton iteration, working out the reciprocal of the top
+ * half (and a few guard bits) of c and refining it, so the cost is a small
+ * multiple of that of a p bit multiplication. */
+static mp_err newton_reciprocal(mp_int *c, int p, mp_int *x) {
+    mp_err err;
+    mp_int ch, e, t;
+    int h;
+    if (p <= MVM_BIGINT_NEWTON_BASE_BITS) {
+        if ((err = mp_2expt(x, 2 * p)) != MP_OKAY)
+            return err;
+        return mp_div(x, c, x, NULL);
+    }
+    h = (p + 1) / 2 + 8;
+    if ((err = mp_init_multi(&ch, &e, &t, NULL)) != MP_OKAY)
+        return err;
+    if ((err = mp_div_2d(c, p - h, &ch, NULL)) != MP_OKAY)
+        goto done;
+    if ((err = newton_reciprocal(&ch, h, x)) != MP_OKAY)
+        goto done;
+    if ((err = mp_mul_2d(x, p - h, x)) != MP_OKAY)
+        goto done;
+    /* x += x * (2^(2p) - c * x) / 2^(2p) */
+    if ((err = mp_mul(c, x, &t)) != MP_OKAY)
+        goto done;
+    if ((err = mp_2expt(&e, 2 * p)) != MP_OKAY)
+        goto done;
+    if ((err = mp_sub(&e, &t, &e)) != MP_OKAY)
+        goto done;
+    if ((err = mp_mul(x, &e, &t)) != MP_OKAY)
+        goto done;
+    if ((err = mp_div_2d(&t, 2 * p, &t, NULL)) != MP_OKAY)
+        goto done;
+    err = mp_add(x, &t, x);
+  done:
+    mp_clear_multi(&ch, &e, &t, NULL);
+    return err;
+}
+
+/* Divides non-negative a by positive b by multiplying by a reciprocal of b
+ * that is precise enough for the quotient to be off by no more than one,
+ * then fixing it up. */
+static mp_err newton_divmod(mp_int *a, mp_int *b, mp_int *q, mp_int *r) {
+    mp_err err;
+    mp_int c, x;
+    int m = mp_count_bits(b);
+    int p = mp_count_bits(a) - m + 1 + 32;
+    if ((err = mp_init_multi(&c, &x, NULL)) != MP_OKAY)
+        return err;
+    if (p < m)
+        err = mp_div_2d(b, m - p, &c, NULL);
+    else
+        err = mp_mul_2d(b, p - m, &c);
+    if (err != MP_OKAY)
+        goto done;
+    if ((err = newton_reciprocal(&c, p, &x)) != MP_OKAY)
+        goto done;
+    if ((err = mp_mul(a, &x, q)) != MP_OKAY)
+        goto done;
+    if ((err = mp_div_2d(q, m + p, q, NULL)) != MP_OKAY)
+        goto done;
+    if ((err = mp_mul(q, b, &c)) != MP_OKAY)
+        goto done;
+    if ((err = mp_sub(a, &c, r)) != MP_OKAY)
+        goto done;
+    while (r->sign == MP_NEG && !mp_iszero(r)) {
+        if ((err = mp_sub_d(q, 1, q)) != MP_OKAY || (err = mp_add(r, b, r)) != MP_OKAY)
+            goto done;
+    }
+    while (mp_cmp(r, b) != MP_LT) {
+        if ((err = mp_add_d(q, 1, q)) != MP_OKAY || (err = mp_sub(r, b, r)) != MP_OKAY)
+            goto done;
+    }
+  done:
+    mp_clear_multi(&c, &x, NULL);
+    return err;
+}
+
+/* Does what mp_div does (a quotient truncated towards zero and a remainder
+ * with the sign of a, either of which may be NULL), switching to Newton
+ * division when both the divisor and the quotient are large, where the
+ * schoolbook division in mp_div is quadratic. */
+static mp_err bigint_divmod(mp_int *a, mp_int *b, mp_int *q, mp_int *r) {
+    mp_err err;
+    mp_int ta, tb, tq, tr;
+    mp_sign sign_a = a->sign;
+    mp_sign sign_b = b->sign;
+    if (b->used < MVM_BIGINT_NEWTON_DIV_CUTOFF || a->used - b->used < MVM_BIGINT_NEWTON_DIV_CUTOFF)
+        return mp_div(a, b, q, r);
+    if ((err = mp_init_multi(&ta, &tb, &tq, &tr, NULL)) != MP_OKAY)
+        return err;
+    if ((err = mp_abs(a, &ta)) != MP_OKAY || (err = mp_abs(b, &tb)) != MP_OKAY)
+        goto done;
+    if ((err = newton_divmod(&ta, &tb, &tq, &tr)) != MP_OKAY)
+        goto done;
+    if (sign_a != sign_b && (err = mp_neg(&tq, &tq)) != MP_OKAY)
+        goto done;
+    if (sign_a == MP_NEG && (err = mp_neg(&tr, &tr)) != MP_OKAY)
+        goto done;
+    if (q)
+        mp_exch(&tq, q);
+    if (r)
+        mp_exch(&tr, r);
+  done:
+    mp_clear_multi(&ta, &tb, &tq, &tr, NULL);
+    return err;
+}
+
+/* The same as mp_mod, but dividing with bigint_divmod. */
+static mp_err bigint_mod(mp_int *a, mp_int *b, mp_int *c) {
+    mp_err err;
+    if ((err = bigint_divmod(a, b, NULL, c)) != MP_OKAY)
+        return err;
+    if (!mp_iszero(c) && c->sign != b->sign)
+        return mp_add(b, c, c);
+    return MP_OKAY;
+}
+
 /* Bitops on libtomath (no two's complement API) are horrendously inefficient and
  * really should be hand-coded to work DIGIT-by-DIGIT with in-loop carry
  * handling.  For now we have these fixups.
@@ -300,12 +471,21 @@ MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MV
     return result; \
 }
 
-#define MVM_BIGINT_BINARY_OP(opname) \
+#define MVM_BIGINT_BINARY_OP(opname, SMALLINT_OP) \
 MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) { \
     MVMP6bigintBody *ba, *bb, *bc; \
     MVMObject *result; \
     mp_err err; \
     mp_int *ia, *ib, *ic; \
+    ba = get_bigint_body(tc, a); \
+    bb = get_bigint_body(tc, b); \
+    if (!MVM_BIGINT_IS_BIG(ba) && !MVM_BIGINT_IS_BIG(bb)) { \
+        MVMint64 sc; \
+        MVMint64 sa = ba->u.smallint.value; \
+        MVMint64 sb = bb->u.smallint.value; \
+        SMALLINT_OP; \
+        return small_result(tc, result_type, sc); \
+    } \
     MVMROOT2(tc, a, b, { \
         result = MVM_repr_alloc_init(tc, result_type);\
     }); \
@@ -436,11 +616,26 @@ MVM_BIGINT_UNARY_OP(neg, { sb = -sa; })
 MVM_BIGINT_BINARY_OP_SIMPLE(add, { sc = sa + sb; })
 MVM_BIGINT_BINARY_OP_SIMPLE(sub, { sc = sa - sb; })
 MVM_BIGINT_BINARY_OP_SIMPLE(mul, { sc = sa * sb; })
-MVM_BIGINT_BINARY_OP(lcm)
+MVM_BIGINT_BINARY_OP(lcm, {
+    MVMint64 ua = sa < 0 ? -sa : sa;
+    MVMint64 ub = sb < 0 ? -sb : sb;
+    sc = ua && ub ? ua / small_gcd(ua, ub) * ub : 0;
+})
 
 MVMObject *MVM_bigint_gcd(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) {
     MVMObject       *result;
 
+    {
+        MVMP6bigintBody *ba = get_bigint_body(tc, a);
+        MVMP6bigintBody *bb = get_bigint_body(tc, b);
+        if (!MVM_BIGINT_IS_BIG(ba) && !MVM_BIGINT_IS_BIG(bb)) {
+            MVMint64 sa = ba->u.smallint.value;
+            MVMint64 sb = bb->u.smallint.value;
+            return small_result(tc, result_type,
+                small_gcd(sa < 0 ? -sa : sa, sb < 0 ? -sb : sb));
+        }
+    }
+
     MVMROOT2(tc, a, b, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
@@ -450,35 +645,21 @@ MVMObject *MVM_bigint_gcd(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         MVMP6bigintBody *bb = get_bigint_body(tc, b);
         MVMP6bigintBody *bc = get_bigint_body(tc, result);
 
-        if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
-            mp_err err;
-            mp_int *ia = force_bigint(tc, ba, 0);
-            mp_int *ib = force_bigint(tc, bb, 1);
-            mp_int *ic = MVM_malloc(sizeof(mp_int));
-            if ((err = mp_init(ic)) != MP_OKAY) {
-                MVM_free(ic);
-                MVM_exception_throw_adhoc(tc, "Error creating a big integer: %s", mp_error_to_string(err));
-            }
-            if ((err = mp_gcd(ia, ib, ic)) != MP_OKAY) {
-                mp_clear(ic);
-                MVM_free(ic);
-                MVM_exception_throw_adhoc(tc, "Error getting the GCD of two big integer: %s", mp_error_to_string(err));
-            }
-            store_bigint_result(bc, ic);
-            adjust_nursery(tc, bc);
-        } else {
-            MVMint32 sa = ba->u.smallint.value;
-            MVMint32 sb = bb->u.smallint.value;
-            MVMint32 t;
-            sa = abs(sa);
-            sb = abs(sb);
-            while (sb != 0) {
-                t  = sb;
-                sb = sa % sb;
-                sa = t;
-            }
-            store_int64_result(tc, bc, sa);
+        mp_err err;
+        mp_int *ia = force_bigint(tc, ba, 0);
+        mp_int *ib = force_bigint(tc, bb, 1);
+        mp_int *ic = MVM_malloc(sizeof(mp_int));
+        if ((err = mp_init(ic)) != MP_OKAY) {
+            MVM_free(ic);
+            MVM_exception_throw_adhoc(tc, "Error creating a big integer: %s", mp_error_to_string(err));
+        }
+        if ((err = mp_gcd(ia, ib, ic)) != MP_OKAY) {
+            mp_clear(ic);
+            MVM_free(ic);
+            MVM_exception_throw_adhoc(tc, "Error getting the GCD of two big integer: %s", mp_error_to_string(err));
         }
+        store_bigint_result(bc, ic);
+        adjust_nursery(tc, bc);
     }
 
     return result;
@@ -508,6 +689,22 @@ MVMObject * MVM_bigint_mod(MVMThreadContext *tc, MVMObject *result_type, MVMObje
 
     MVMObject *result;
 
+    {
+        MVMP6bigintBody *ba = get_bigint_body(tc, a);
+        MVMP6bigintBody *bb = get_bigint_body(tc, b);
+        /* C's % truncates, but like mp_mod we want the result to have the sign
+         * of the divisor. Division by zero is left to mp_mod to complain
+         * about. */
+        if (!MVM_BIGINT_IS_BIG(ba) && !MVM_BIGINT_IS_BIG(bb) && bb->u.smallint.value != 0) {
+            MVMint64 sa = ba->u.smallint.value;
+            MVMint64 sb = bb->u.smallint.value;
+            MVMint64 sc = sa % sb;
+            if (sc != 0 && (sc < 0) != (sb < 0))
+                sc += sb;
+            return small_result(tc, result_type, sc);
+        }
+    }
+
     MVMROOT2(tc, a, b, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
@@ -518,31 +715,24 @@ MVMObject * MVM_bigint_mod(MVMThreadContext *tc, MVMObject *result_type, MVMObje
         MVMP6bigintBody *bc;
         bc = get_bigint_body(tc, result);
 
-        /* XXX the behavior of C's mod operator is not correct
-         * for our purposes. So we rely on mp_mod for all our modulus
-         * calculations for now. */
-        if (1 || MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
-            mp_int *ia = force_bigint(tc, ba, 0);
-            mp_int *ib = force_bigint(tc, bb, 1);
-            mp_int *ic = MVM_malloc(sizeof(mp_int));
-            mp_err err;
-
-            if ((err = mp_init(ic)) != MP_OKAY) {
-                MVM_free(ic);
-                MVM_exception_throw_adhoc(tc, "Error creating a big integer: %s", mp_error_to_string(err));
-            }
+        mp_int *ia = force_bigint(tc, ba, 0);
+        mp_int *ib = force_bigint(tc, bb, 1);
+        mp_int *ic = MVM_malloc(sizeof(mp_int));
+        mp_err err;
 
-            if ((err = mp_mod(ia, ib, ic)) != MP_OKAY) {
-                mp_clear(ic);
-                MVM_free(ic);
-                MVM_exception_throw_adhoc(tc, "Error getting the mod of two big integer: %s", mp_error_to_string(err));
-            }
+        if ((err = mp_init(ic)) != MP_OKAY) {
+            MVM_free(ic);
+            MVM_exception_throw_adhoc(tc, "Error creating a big integer: %s", mp_error_to_string(err));
+        }
 
-            store_bigint_result(bc, ic);
-            adjust_nursery(tc, bc);
-        } else {
-            store_int64_result(tc, bc, ba->u.smallint.value % bb->u.smallint.value);
+        if ((err = bigint_mod(ia, ib, ic)) != MP_OKAY) {
+            mp_clear(ic);
+            MVM_free(ic);
+            MVM_exception_throw_adhoc(tc, "Error getting the mod of two big integer: %s", mp_error_to_string(err));
         }
+
+        store_bigint_result(bc, ic);
+        adjust_nursery(tc, bc);
     }
 
     return result;
@@ -563,6 +753,20 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         return a;
     }
 
+    /* Both small; the result is floored rather than rounded towards zero. */
+    ba = get_bigint_body(tc, a);
+    if (!MVM_BIGINT_IS_BIG(ba) && !MVM_BIGINT_IS_BIG(bb)) {
+        MVMint64 num   = ba->u.smallint.value;
+        MVMint64 denom = bb->u.smallint.value;
+        MVMint64 value;
+        if (denom == 0)
+            MVM_exception_throw_adhoc(tc, "Division by zero");
+        value = num / denom;
+        if (num % denom != 0 && (num < 0) != (denom < 0))
+            value--;
+        return small_result(tc, result_type, value);
+    }
+
     MVMROOT2(tc, a, b, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
@@ -584,7 +788,7 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         cmp_b = bb->u.smallint.value < 0 ? MP_LT : MP_GT;
     }
 
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
+    {
         ia = force_bigint(tc, ba, 0);
         ib = force_bigint(tc, bb, 1);
 
@@ -604,7 +808,7 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
                 MVM_free(ic);
                 MVM_exception_throw_adhoc(tc, "Error creating big integers: %s", mp_error_to_string(err));
             }
-            if ((err = mp_div(ia, ib, &intermediate, &remainder)) != MP_OKAY) {
+            if ((err = bigint_divmod(ia, ib, &intermediate, &remainder)) != MP_OKAY) {
                 mp_clear_multi(ic, &remainder, &intermediate, NULL);
                 MVM_free(ic);
                 MVM_exception_throw_adhoc(tc, "Error dividing big integers: %s", mp_error_to_string(err));
@@ -624,7 +828,7 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
             }
             mp_clear_multi(&remainder, &intermediate, NULL);
         } else {
-            if ((err = mp_div(ia, ib, ic, NULL)) != MP_OKAY) {
+            if ((err = bigint_divmod(ia, ib, ic, NULL)) != MP_OKAY) {
                 mp_clear(ic);
                 MVM_free(ic);
                 MVM_exception_throw_adhoc(tc, "Error dividing big integers: %s", mp_error_to_string(err));
@@ -632,23 +836,6 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         }
         store_bigint_result(bc, ic);
         adjust_nursery(tc, bc);
-    } else {
-        MVMint32 num   = ba->u.smallint.value;
-        MVMint32 denom = bb->u.smallint.value;
-        MVMint64 value;
-        if ((cmp_a == MP_LT) ^ (cmp_b == MP_LT)) {
-            if (denom == 0) {
-                MVM_exception_throw_adhoc(tc, "Division by zero");
-            }
-            if ((num % denom) != 0) {
-                value = num / denom - 1;
-            } else {
-                value = num / denom;
-            }
-        } else {
-            value = (MVMint64)num / denom;
-        }
-        store_int64_result(tc, bc, value);
     }
 
     return result;
@@ -660,10 +847,31 @@ MVMObject * MVM_bigint_pow(MVMThreadContext *tc, MVMObject *a, MVMObject *b,
     MVMP6bigintBody *bb = get_bigint_body(tc, b);
     MVMObject       *r  = NULL;
 
-    mp_int *base        = force_bigint(tc, ba, 0);
-    mp_int *exponent    = force_bigint(tc, bb, 1);
+    mp_int *base;
+    mp_int *exponent;
     mp_digit exponent_d = 0;
 
+    /* Small base and non-negative exponent; try by squaring, falling back
+     * if it overflows. */
+    if (!MVM_BIGINT_IS_BIG(ba) && !MVM_BIGINT_IS_BIG(bb) && bb->u.smallint.value >= 0) {
+        MVMint64 sbase  = ba->u.smallint.value;
+        MVMint64 sexp   = bb->u.smallint.value;
+        MVMint64 result = 1;
+        int overflow    = 0;
+        while (sexp && !overflow) {
+            if (sexp & 1)
+                overflow = mul_overflows(result, sbase, &result);
+            sexp >>= 1;
+            if (sexp && !overflow)
+                overflow = mul_overflows(sbase, sbase, &sbase);
+        }
+        if (!overflow)
+            return MVM_repr_box_int(tc, int_type, result);
+    }
+
+    base     = force_bigint(tc, ba, 0);
+    exponent = force_bigint(tc, bb, 1);
+
     if (mp_iszero(exponent) || (MP_EQ == mp_cmp_d(base, 1))) {
         r = MVM_repr_box_int(tc, int_type, 1);
     }
@@ -721,6 +929,17 @@ MVMObject *MVM_bigint_shl(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
     MVMP6bigintBody *bb;
     MVMObject       *result;
 
+    /* A smallint shifted left by up to 32 bits still fits in 64 bits. */
+    ba = get_bigint_body(tc, a);
+    if (!MVM_BIGINT_IS_BIG(ba) && n <= 32) {
+        MVMint64 value = ba->u.smallint.value;
+        if (n < 0)
+            value = n <= -63 ? (value < 0 ? -1 : 0) : value >> -n;
+        else
+            value = value * ((MVMint64)1 << n);
+        return small_result(tc, result_type, value);
+    }
+
     MVMROOT(tc, a, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
@@ -728,7 +947,7 @@ MVMObject *MVM_bigint_shl(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
     ba = get_bigint_body(tc, a);
     bb = get_bigint_body(tc, result);
 
-    if (MVM_BIGINT_IS_BIG(ba) || n >= 31) {
+    {
         mp_err err;
         mp_int *ia = force_bigint(tc, ba, 0);
         mp_int *ib = MVM_malloc(sizeof(mp_int));
@@ -739,13 +958,6 @@ MVMObject *MVM_bigint_shl(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         two_complement_shl(tc, ib, ia, n);
         store_bigint_result(bb, ib);
         adjust_nursery(tc, bb);
-    } else {
-        MVMint64 value;
-        if (n < 0)
-            value = ((MVMint64)ba->u.smallint.value) >> -n;
-        else
-            value = ((MVMint64)ba->u.smallint.value) << n;
-        store_int64_result(tc, bb, value);
     }
 
     return result;
@@ -1047,9 +1259,112 @@ static int mp_faster_radix_size (mp_int *a, int radix, int *size)
     return MP_OKAY;
 }
 
+/* Writes the digits of a non-negative a, which is less than the square of
+ * powers[level], to buf at *pos, padded with zeros to width digits. It's
+ * split in two by dividing by powers[level], the base raised to 2^level,
+ * and each half is written the same way, so the work is mostly in a few
+ * big divisions instead of a small division per digit. */
+static mp_err radix_dc(mp_int *a, mp_int *powers, int level, size_t width, int base,
+        char *buf, size_t *pos) {
+    mp_err err;
+    if (level < 0 || a->used <= MVM_BIGINT_RADIX_DC_BASE) {
+        int len;
+        size_t num_digits;
+        char *digits;
+        if ((err = mp_radix_size(a, base, &len)) != MP_OKAY)
+            return err;
+        digits = MVM_malloc(len);
+        if ((err = mp_to_radix(a, digits, len, NULL, base)) != MP_OKAY) {
+            MVM_free(digits);
+            return err;
+        }
+        num_digits = strlen(digits);
+        if (width > num_digits) {
+            memset(buf + *pos, '0', width - num_digits);
+            *pos += width - num_digits;
+        }
+        memcpy(buf + *pos, digits, num_digits);
+        *pos += num_digits;
+        MVM_free(digits);
+        return MP_OKAY;
+    }
+    else {
+        mp_int q, r;
+        size_t half = (size_t)1 << level;
+        if ((err = mp_init_multi(&q, &r, NULL)) != MP_OKAY)
+            return err;
+        if ((err = bigint_divmod(a, &powers[level], &q, &r)) == MP_OKAY) {
+            if (width == 0 && mp_iszero(&q))
+                err = radix_dc(&r, powers, level - 1, 0, base, buf, pos);
+            else if ((err = radix_dc(&q, powers, level - 1, width ? width - half : 0,
+                    base, buf, pos)) == MP_OKAY)
+                err = radix_dc(&r, powers, level - 1, half, base, buf, pos);
+        }
+        mp_clear_multi(&q, &r, NULL);
+        return err;
+    }
+}
+
+/* Converts a large bigint to a string with radix_dc. */
+static MVMString * bigint_to_str_dc(MVMThreadContext *tc, mp_int *i, int base) {
+    mp_int     powers[32];
+    mp_int     abs_i;
+    int        num_powers = 0, k;
+    size_t     alloc, pos = 0;
+    char      *buf;
+    mp_err     err;
+    MVMString *result;
+
+    /* Work out the base raised to 1, 2, 4, 8... until it's bigger than i. */
+    if ((err = mp_init(&abs_i)) != MP_OKAY)
+        MVM_exception_throw_adhoc(tc, "Error creating a big integer: %s", mp_error_to_string(err));
+    if ((err = mp_abs(i, &abs_i)) != MP_OKAY)
+        goto error;
+    do {
+        if (num_powers == 32) {
+            err = MP_VAL;
+            goto error;
+        }
+        if ((err = mp_init(&powers[num_powers])) != MP_OKAY)
+            goto error;
+        num_powers++;
+        if (num_powers == 1)
+            mp_set_i32(&powers[0], base);
+        else if ((err = mp_sqr(&powers[num_powers - 2], &powers[num_powers - 1])) != MP_OKAY)
+            goto error;
+    } while (mp_cmp_mag(&powers[num_powers - 1], &abs_i) != MP_GT);
+
+    /* There are at most bits * log(2) / log(base) digits, and a sign. */
+    alloc = (size_t)(mp_count_bits(i) * (log(2.0) / log((double)base))) + 4;
+    buf = MVM_malloc(alloc);
+    if (i->sign == MP_NEG)
+        buf[pos++] = '-';
+    err = radix_dc(&abs_i, powers, num_powers - 2, 0, base, buf, &pos);
+    if (err != MP_OKAY) {
+        MVM_free(buf);
+        goto error;
+    }
+    result = MVM_string_ascii_decode(tc, tc->instance->VMString, buf, pos);
+    MVM_free(buf);
+    for (k = 0; k < num_powers; k++)
+        mp_clear(&powers[k]);
+    mp_clear(&abs_i);
+    return result;
+
+  error:
+    for (k = 0; k < num_powers; k++)
+        mp_clear(&powers[k]);
+    mp_clear(&abs_i);
+    MVM_exception_throw_adhoc(tc, "Error getting the string representation of a big integer: %s", mp_error_to_string(err));
+}
+
 MVMString * MVM_bigint_to_str(MVMThreadContext *tc, MVMObject *a, int base) {
     MVMP6bigintBody *body = get_bigint_body(tc, a);
-    if (MVM_BIGINT_IS_BIG(body)) {
+    if (MVM_BIGINT_IS_BIG(body) && body->u.bigint->used >= MVM_BIGINT_RADIX_DC_CUTOFF
+            && base >= 2 && base <= 36) {
+        return bigint_to_str_dc(tc, body->u.bigint, base);
+    }
+    else if (MVM_BIGINT_IS_BIG(body)) {
         mp_err err;
         mp_int *i = body->u.bigint;
         int len;
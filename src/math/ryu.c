@@ -0,0 +1,390 @@
+/* Shortest round-trip double to string conversion, after the Ryu algorithm
+ * described in "Ryū: fast float-to-string conversion" by Ulf Adams (PLDI
+ * 2018), whose reference implementation is available under the Apache 2.0
+ * or Boost licenses at https://github.com/ulfjack/ryu.
+ *
+ * Unlike Grisu, which this replaces, it finds the shortest decimal that reads
+ * back as the same double for every input, so never has to fall back to a
+ * slower path. The formatting of the result is as Perl 6 expects: plain
+ * decimals for numbers from 1e-4 up to 1e15, and otherwise scientific
+ * notation with an explicitly signed exponent of at least two digits if it is
+ * negative. */
+
+#include "moar.h"
+#include "ryu.h"
+#include "ryu_tables.h"
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_BIAS          1023
+
+/* Every pair of decimal digits, so numbers can be written two digits per
+ * division. */
+static const char DIGIT_PAIRS[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+/* The number of decimal digits in a value. */
+static MVMuint32 decimal_length(MVMuint64 v) {
+    MVMuint32 len = 1;
+    while (v >= 10000) {
+        v /= 10000;
+        len += 4;
+    }
+    if (v >= 1000) return len + 3;
+    if (v >= 100)  return len + 2;
+    if (v >= 10)   return len + 1;
+    return len;
+}
+
+/* Writes the digits of a value, which has the given number of them, to the
+ * buffer, two at a time from the end. */
+static void write_digits(MVMuint64 v, MVMuint32 len, char *buffer) {
+    char *p = buffer + len;
+    while (v >= 100) {
+        MVMuint32 pair = (MVMuint32)(v % 100) * 2;
+        v /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (v >= 10) {
+        MVMuint32 pair = (MVMuint32)v * 2;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    else {
+        *--p = (char)('0' + v);
+    }
+}
+
+size_t MVM_u64_to_decimal(MVMuint64 value, char *buffer) {
+    MVMuint32 len = decimal_length(value);
+    write_digits(value, len, buffer);
+    return len;
+}
+
+size_t MVM_i64_to_decimal(MVMint64 value, char *buffer) {
+    if (value < 0) {
+        *buffer = '-';
+        return MVM_u64_to_decimal(~(MVMuint64)value + 1, buffer + 1) + 1;
+    }
+    return MVM_u64_to_decimal((MVMuint64)value, buffer);
+}
+
+/* ceil(log2(5^e)), or 1 for e = 0; valid for 0 <= e <= 3528. */
+static MVMint32 pow5bits(MVMint32 e) {
+    return (MVMint32)(((MVMuint32)e * 1217359) >> 19) + 1;
+}
+
+/* floor(log10(2^e)) and floor(log10(5^e)); valid for 0 <= e <= 1650 and
+ * 0 <= e <= 2620 respectively. */
+static MVMuint32 log10_pow2(MVMint32 e) {
+    return ((MVMuint32)e * 78913) >> 18;
+}
+static MVMuint32 log10_pow5(MVMint32 e) {
+    return ((MVMuint32)e * 732923) >> 20;
+}
+
+static MVMuint32 pow5_factor(MVMuint64 value) {
+    MVMuint32 count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+static int multiple_of_pow5(MVMuint64 value, MVMuint32 p) {
+    return pow5_factor(value) >= p;
+}
+
+static int multiple_of_pow2(MVMuint64 value, MVMuint32 p) {
+    return (value & ((UINT64_C(1) << p) - 1)) == 0;
+}
+
+/* Multiplies a value of at most 55 bits by a 128-bit one from the tables,
+ * and gives bits j and up of the product; j is always at least 64 and less
+ * than 128. */
+static MVMuint64 mul_shift(MVMuint64 m, const MVMuint64 *mul, MVMint32 j) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 b0 = (unsigned __int128)m * mul[0];
+    unsigned __int128 b2 = (unsigned __int128)m * mul[1];
+    return (MVMuint64)(((b0 >> 64) + b2) >> (j - 64));
+#else
+    /* Portably, by 32-bit halves; only the high half of m * mul[0] and all
+     * of m * mul[1] are needed. */
+    MVMuint64 m_lo = (MVMuint32)m, m_hi = m >> 32;
+    MVMuint64 high0, low1, high1, sum;
+    MVMint32 dist = j - 64;
+    {
+        MVMuint64 b_lo = (MVMuint32)mul[0], b_hi = mul[0] >> 32;
+        MVMuint64 b00 = m_lo * b_lo, b01 = m_lo * b_hi;
+        MVMuint64 b10 = m_hi * b_lo, b11 = m_hi * b_hi;
+        MVMuint64 mid1 = b10 + (b00 >> 32);
+        MVMuint64 mid2 = b01 + (MVMuint32)mid1;
+        high0 = b11 + (mid1 >> 32) + (mid2 >> 32);
+    }
+    {
+        MVMuint64 b_lo = (MVMuint32)mul[1], b_hi = mul[1] >> 32;
+        MVMuint64 b00 = m_lo * b_lo, b01 = m_lo * b_hi;
+        MVMuint64 b10 = m_hi * b_lo, b11 = m_hi * b_hi;
+        MVMuint64 mid1 = b10 + (b00 >> 32);
+        MVMuint64 mid2 = b01 + (MVMuint32)mid1;
+        high1 = b11 + (mid1 >> 32) + (mid2 >> 32);
+        low1  = (mid2 << 32) | (MVMuint32)b00;
+    }
+    sum = high0 + low1;
+    if (sum < high0)
+        high1++;
+    return (high1 << (64 - dist)) | (sum >> dist);
+#endif
+}
+
+/* Finds the shortest decimal, as digits and a power of ten, that lies within
+ * the interval of reals that round to the double with the given mantissa and
+ * exponent fields, picking the one closest to its exact value. */
+static void shortest_decimal(MVMuint64 ieee_mantissa, MVMuint32 ieee_exponent,
+        MVMuint64 *digits, MVMint32 *exponent) {
+    MVMint32  e2, e10;
+    MVMuint64 m2, mv, vr, vp, vm, output;
+    MVMuint32 mm_shift;
+    MVMint32  removed = 0;
+    MVMuint32 last_removed_digit = 0;
+    int       accept_bounds;
+    int       vm_trailing_zeros = 0;
+    int       vr_trailing_zeros = 0;
+
+    if (ieee_exponent == 0) {
+        e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    }
+    else {
+        e2 = (MVMint32)ieee_exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = (UINT64_C(1) << DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+    }
+    accept_bounds = (m2 & 1) == 0;
+
+    /* The interval is [mm, mp] around mv, all scaled by 4 so as to be
+     * integers; the lower bound is closer when the mantissa is a power of
+     * two, as the exponent below has a finer spacing. */
+    mv = 4 * m2;
+    mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    /* Scale them all into decimal, by a power of ten that leaves at most 17
+     * significant digits, noting whether the parts divided away were all
+     * zeros. */
+    if (e2 >= 0) {
+        MVMuint32 q = log10_pow2(e2) - (e2 > 3);
+        MVMint32  k = MVM_RYU_POW5_INV_BITCOUNT + pow5bits((MVMint32)q) - 1;
+        MVMint32  i = -e2 + (MVMint32)q + k;
+        e10 = (MVMint32)q;
+        vr = mul_shift(4 * m2, MVM_RYU_POW5_INV_SPLIT[q], i);
+        vp = mul_shift(4 * m2 + 2, MVM_RYU_POW5_INV_SPLIT[q], i);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, MVM_RYU_POW5_INV_SPLIT[q], i);
+        if (q <= 21) {
+            /* At most one of mm, mv and mp is a multiple of 5; if it is one
+             * of 5^q, only zeros were divided away from it. */
+            if (mv % 5 == 0)
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else {
+        MVMuint32 q = log10_pow5(-e2) - (-e2 > 1);
+        MVMint32  i = -e2 - (MVMint32)q;
+        MVMint32  k = pow5bits(i) - MVM_RYU_POW5_BITCOUNT;
+        MVMint32  j = (MVMint32)q - k;
+        e10 = (MVMint32)q + e2;
+        vr = mul_shift(4 * m2, MVM_RYU_POW5_SPLIT[i], j);
+        vp = mul_shift(4 * m2 + 2, MVM_RYU_POW5_SPLIT[i], j);
+        vm = mul_shift(4 * m2 - 1 - mm_shift, MVM_RYU_POW5_SPLIT[i], j);
+        if (q <= 1) {
+            /* mv, mp and mm all have at least two trailing zero bits, so the
+             * division by 10^q removed nothing but zeros. */
+            vr_trailing_zeros = 1;
+            if (accept_bounds)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                vp--;
+        }
+        else if (q < 63) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    /* Drop digits while the bounds still differ, keeping track of how to
+     * round what is left. */
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        /* The rare general case, where the bounds or the value may be exact
+         * and ties need breaking. */
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (MVMuint32)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = (MVMuint32)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            /* Exactly half way; round to even. */
+            last_removed_digit = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros))
+            || last_removed_digit >= 5);
+    }
+    else {
+        /* The common case, where only the last digit removed matters. */
+        int round_up = 0;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+
+    *digits   = output;
+    *exponent = e10 + removed;
+}
+
+/* Integers from 1 up to 2^53 are exactly their mantissa shifted down, so can
+ * skip the search. Returns non-zero if it was one. */
+static int small_integer(MVMuint64 ieee_mantissa, MVMuint32 ieee_exponent,
+        MVMuint64 *digits, MVMint32 *exponent) {
+    MVMuint64 m2 = (UINT64_C(1) << DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+    MVMint32  e2 = (MVMint32)ieee_exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    if (e2 > 0 || e2 < -DOUBLE_MANTISSA_BITS)
+        return 0;
+    if ((m2 & ((UINT64_C(1) << -e2) - 1)) != 0)
+        return 0;
+    *digits   = m2 >> -e2;
+    *exponent = 0;
+    while (*digits % 10 == 0) {
+        *digits /= 10;
+        (*exponent)++;
+    }
+    return 1;
+}
+
+/* Writes an exponent as Perl 6 expects it, with an explicit sign and at
+ * least two digits if negative. */
+static size_t write_exponent(MVMint32 e, char *buffer) {
+    char *p = buffer;
+    *p++ = 'e';
+    if (e < 0) {
+        *p++ = '-';
+        if (e > -10)
+            *p++ = '0';
+        e = -e;
+    }
+    else {
+        *p++ = '+';
+    }
+    return (p - buffer) + MVM_u64_to_decimal((MVMuint64)e, p);
+}
+
+size_t MVM_num_to_shortest_str(MVMnum64 n, char *buffer) {
+    union { MVMuint64 u; MVMnum64 n; } bits;
+    MVMuint64 ieee_mantissa, digits;
+    MVMuint32 ieee_exponent, len;
+    MVMint32  exponent, decimal_pos;
+    char      digit_buf[20];
+    char     *p = buffer;
+
+    bits.n = n;
+    ieee_mantissa = bits.u & ((UINT64_C(1) << DOUBLE_MANTISSA_BITS) - 1);
+    ieee_exponent = (MVMuint32)((bits.u >> DOUBLE_MANTISSA_BITS)
+        & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+    if (ieee_exponent == (1u << DOUBLE_EXPONENT_BITS) - 1) {
+        if (ieee_mantissa) {
+            memcpy(p, "NaN", 3);
+            return 3;
+        }
+        if (bits.u >> 63)
+            *p++ = '-';
+        memcpy(p, "Inf", 3);
+        return (p - buffer) + 3;
+    }
+    if (bits.u >> 63)
+        *p++ = '-';
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        *p++ = '0';
+        return p - buffer;
+    }
+
+    if (!small_integer(ieee_mantissa, ieee_exponent, &digits, &exponent))
+        shortest_decimal(ieee_mantissa, ieee_exponent, &digits, &exponent);
+    len = decimal_length(digits);
+    write_digits(digits, len, digit_buf);
+
+    /* Lay out the digits; the value is digits * 10^exponent. */
+    decimal_pos = (MVMint32)len + exponent;
+    if (exponent == 0 || (exponent > 0 && decimal_pos <= 15)) {
+        /* An integer; trailing zeros are only written out up to 15 digits. */
+        memcpy(p, digit_buf, len);
+        p += len;
+        memset(p, '0', exponent);
+        p += exponent;
+    }
+    else if (decimal_pos > 0 && exponent < 0) {
+        /* A point somewhere among the digits. */
+        memcpy(p, digit_buf, decimal_pos);
+        p += decimal_pos;
+        *p++ = '.';
+        memcpy(p, digit_buf + decimal_pos, len - decimal_pos);
+        p += len - decimal_pos;
+    }
+    else if (decimal_pos <= 0 && decimal_pos > -4) {
+        /* A few zeros after the point. */
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -decimal_pos);
+        p += -decimal_pos;
+        memcpy(p, digit_buf, len);
+        p += len;
+    }
+    else {
+        /* Scientific notation. */
+        *p++ = digit_buf[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digit_buf + 1, len - 1);
+            p += len - 1;
+        }
+        p += write_exponent(decimal_pos - 1, p);
+    }
+    return p - buffer;
+}
@@ -0,0 +1,8 @@
+/* The most characters MVM_num_to_shortest_str writes, and the most that
+ * MVM_i64_to_decimal and MVM_u64_to_decimal do. */
+#define MVM_NUM_TO_STR_MAX_LEN 32
+#define MVM_INT_TO_STR_MAX_LEN 20
+
+size_t MVM_num_to_shortest_str(MVMnum64 n, char *buffer);
+size_t MVM_u64_to_decimal(MVMuint64 value, char *buffer);
+size_t MVM_i64_to_decimal(MVMint64 value, char *buffer);
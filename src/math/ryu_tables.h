@@ -0,0 +1,684 @@
+/* This file is generated by tools/ryu-tables.pl; do not edit it by hand.
+ *
+ * MVM_RYU_POW5_INV_SPLIT[i] is 2^(bits(5^i) - 1 + 125) / 5^i, rounded up,
+ * and MVM_RYU_POW5_SPLIT[i] is 5^i scaled to 125 bits, both as 128-bit
+ * values split into their low and high 64 bits. */
+
+#define MVM_RYU_POW5_INV_BITCOUNT 125
+#define MVM_RYU_POW5_BITCOUNT     125
+#define MVM_RYU_POW5_INV_TABLE_SIZE 342
+#define MVM_RYU_POW5_TABLE_SIZE     326
+
+static const MVMuint64 MVM_RYU_POW5_INV_SPLIT[MVM_RYU_POW5_INV_TABLE_SIZE][2] = {
+    { UINT64_C(0x0000000000000001), UINT64_C(0x2000000000000000) },
+    { UINT64_C(0x999999999999999A), UINT64_C(0x1999999999999999) },
+    { UINT64_C(0x47AE147AE147AE15), UINT64_C(0x147AE147AE147AE1) },
+    { UINT64_C(0x6C8B4395810624DE), UINT64_C(0x10624DD2F1A9FBE7) },
+    { UINT64_C(0x7A786C226809D496), UINT64_C(0x1A36E2EB1C432CA5) },
+    { UINT64_C(0x61F9F01B866E43AB), UINT64_C(0x14F8B588E368F084) },
+    { UINT64_C(0xB4C7F34938583622), UINT64_C(0x10C6F7A0B5ED8D36) },
+    { UINT64_C(0x87A6520EC08D236A), UINT64_C(0x1AD7F29ABCAF4857) },
+    { UINT64_C(0x9FB841A566D74F88), UINT64_C(0x15798EE2308C39DF) },
+    { UINT64_C(0xE62D01511F12A607), UINT64_C(0x112E0BE826D694B2) },
+    { UINT64_C(0xD6AE6881CB5109A4), UINT64_C(0x1B7CDFD9D7BDBAB7) },
+    { UINT64_C(0xDEF1ED34A2A73AEA), UINT64_C(0x15FD7FE17964955F) },
+    { UINT64_C(0x7F27F0F6E885C8BB), UINT64_C(0x119799812DEA1119) },
+    { UINT64_C(0x650CB4BE40D60DF8), UINT64_C(0x1C25C268497681C2) },
+    { UINT64_C(0xEA70909833DE7193), UINT64_C(0x16849B86A12B9B01) },
+    { UINT64_C(0x21F3A6E0297EC143), UINT64_C(0x1203AF9EE756159B) },
+    { UINT64_C(0x6985D7CD0F313537), UINT64_C(0x1CD2B297D889BC2B) },
+    { UINT64_C(0x2137DFD73F5A90F9), UINT64_C(0x170EF54646D49689) },
+    { UINT64_C(0xE75FE645CC4873FA), UINT64_C(0x12725DD1D243ABA0) },
+    { UINT64_C(0xA5663D3C7A0D865D), UINT64_C(0x1D83C94FB6D2AC34) },
+    { UINT64_C(0x511E976394D79EB1), UINT64_C(0x179CA10C9242235D) },
+    { UINT64_C(0xDA7EDF82DD794BC1), UINT64_C(0x12E3B40A0E9B4F7D) },
+    { UINT64_C(0x2A6498D1625BAC68), UINT64_C(0x1E392010175EE596) },
+    { UINT64_C(0xEEB6E0A781E2F053), UINT64_C(0x182DB34012B25144) },
+    { UINT64_C(0x58924D52CE4F26A9), UINT64_C(0x1357C299A88EA76A) },
+    { UINT64_C(0x27507BB7B07EA441), UINT64_C(0x1EF2D0F5DA7DD8AA) },
+    { UINT64_C(0x52A6C95FC0655034), UINT64_C(0x18C240C4AECB13BB) },
+    { UINT64_C(0x0EEBD44C99EAA690), UINT64_C(0x13CE9A36F23C0FC9) },
+    { UINT64_C(0xB17953ADC3110A80), UINT64_C(0x1FB0F6BE50601941) },
+    { UINT64_C(0xC12DDC8B02740867), UINT64_C(0x195A5EFEA6B34767) },
+    { UINT64_C(0x3424B06F3529A052), UINT64_C(0x14484BFEEBC29F86) },
+    { UINT64_C(0x901D59F290EE19DB), UINT64_C(0x1039D66589687F9E) },
+    { UINT64_C(0x4CFBC31DB4B0295F), UINT64_C(0x19F623D5A8A73297) },
+    { UINT64_C(0x3D9635B15D59BAB2), UINT64_C(0x14C4E977BA1F5BAC) },
+    { UINT64_C(0x97AB5E277DE16228), UINT64_C(0x109D8792FB4C4956) },
+    { UINT64_C(0xF2ABC9D8C9689D0D), UINT64_C(0x1A95A5B7F87A0EF0) },
+    { UINT64_C(0x5BBCA17A3ABA173E), UINT64_C(0x154484932D2E725A) },
+    { UINT64_C(0xAFCA1AC82EFB45CB), UINT64_C(0x11039D428A8B8EAE) },
+    { UINT64_C(0xB2DCF7A6B1920945), UINT64_C(0x1B38FB9DAA78E44A) },
+    { UINT64_C(0xF57D92EBC141A104), UINT64_C(0x15C72FB1552D836E) },
+    { UINT64_C(0xC46475896767B403), UINT64_C(0x116C262777579C58) },
+    { UINT64_C(0x6D6D88DBD8A5ECD2), UINT64_C(0x1BE03D0BF225C6F4) },
+    { UINT64_C(0x8ABE071646EB23DB), UINT64_C(0x164CFDA3281E38C3) },
+    { UINT64_C(0x6EFE6C11D255B649), UINT64_C(0x11D7314F534B609C) },
+    { UINT64_C(0xB197134FB6EF8A0E), UINT64_C(0x1C8B821885456760) },
+    { UINT64_C(0x27AC0F72F8BFA1A5), UINT64_C(0x16D601AD376AB91A) },
+    { UINT64_C(0xB95672C260994E1E), UINT64_C(0x1244CE242C5560E1) },
+    { UINT64_C(0xF5571E03CDC21695), UINT64_C(0x1D3AE36D13BBCE35) },
+    { UINT64_C(0x2AAC18030B01ABAB), UINT64_C(0x17624F8A762FD82B) },
+    { UINT64_C(0xBBBCE0026F348956), UINT64_C(0x12B50C6EC4F31355) },
+    { UINT64_C(0x92C7CCD0B1EDA889), UINT64_C(0x1DEE7A4AD4B81EEF) },
+    { UINT64_C(0xDBD30A408E57BA07), UINT64_C(0x17F1FB6F10934BF2) },
+    { UINT64_C(0x7CA8D50071DFC806), UINT64_C(0x1327FC58DA0F6FF5) },
+    { UINT64_C(0xFAA7BB33E9660CD6), UINT64_C(0x1EA6608E29B24CBB) },
+    { UINT64_C(0x9552FC298784D711), UINT64_C(0x18851A0B548EA3C9) },
+    { UINT64_C(0xAAA8C9BAD2D0AC0E), UINT64_C(0x139DAE6F76D88307) },
+    { UINT64_C(0xDDDADC5E1E1AACE3), UINT64_C(0x1F62B0B257C0D1A5) },
+    { UINT64_C(0x7E48B04B4B488A4F), UINT64_C(0x191BC08EAC9A4151) },
+    { UINT64_C(0xCB6D59D5D5D3A1D9), UINT64_C(0x141633A556E1CDDA) },
+    { UINT64_C(0x3C577B1177DC817B), UINT64_C(0x1011C2EAABE7D7E2) },
+    { UINT64_C(0xC6F25E825960CF2A), UINT64_C(0x19B604AAACA62636) },
+    { UINT64_C(0x6BF518684780A5BB), UINT64_C(0x14919D5556EB51C5) },
+    { UINT64_C(0x232A79ED06008496), UINT64_C(0x10747DDDDF22A7D1) },
+    { UINT64_C(0xD1DD8FE1A3340756), UINT64_C(0x1A53FC9631D10C81) },
+    { UINT64_C(0xA7E4731AE8F66C45), UINT64_C(0x150FFD44F4A73D34) },
+    { UINT64_C(0x531D28E253F8569E), UINT64_C(0x10D9976A5D52975D) },
+    { UINT64_C(0xEB61DB03B98D5762), UINT64_C(0x1AF5BF109550F22E) },
+    { UINT64_C(0xBC4E48CFC7A445E8), UINT64_C(0x159165A6DDDA5B58) },
+    { UINT64_C(0x6371D3D96C836B20), UINT64_C(0x11411E1F17E1E2AD) },
+    { UINT64_C(0x9F1C8628AD9F11CD), UINT64_C(0x1B9B6364F3030448) },
+    { UINT64_C(0xE5B06B53BE18DB0B), UINT64_C(0x1615E91D8F359D06) },
+    { UINT64_C(0xEAF3890FCB4715A2), UINT64_C(0x11AB20E472914A6B) },
+    { UINT64_C(0x44B8DB4C7871BC37), UINT64_C(0x1C45016D841BAA46) },
+    { UINT64_C(0x03C715D6C6C1635F), UINT64_C(0x169D9ABE03495505) },
+    { UINT64_C(0x3638DE456BCDE919), UINT64_C(0x1217AEFE69077737) },
+    { UINT64_C(0x56C163A2461641C1), UINT64_C(0x1CF2B1970E725858) },
+    { UINT64_C(0xDF011C81D1AB67CE), UINT64_C(0x17288E1271F51379) },
+    { UINT64_C(0x7F3416CE4155ECA5), UINT64_C(0x1286D80EC190DC61) },
+    { UINT64_C(0x6520247D3556476E), UINT64_C(0x1DA48CE468E7C702) },
+    { UINT64_C(0xEA801D30F7783925), UINT64_C(0x17B6D71D20B96C01) },
+    { UINT64_C(0xBB99B0F3F92CFA84), UINT64_C(0x12F8AC174D612334) },
+    { UINT64_C(0x5F5C4E532847F739), UINT64_C(0x1E5AACF215683854) },
+    { UINT64_C(0x7F7D0B75B9D32C2E), UINT64_C(0x18488A5B44536043) },
+    { UINT64_C(0x9930D5F7C7DC2358), UINT64_C(0x136D3B7C36A919CF) },
+    { UINT64_C(0x8EB4898C72F9D226), UINT64_C(0x1F152BF9F10E8FB2) },
+    { UINT64_C(0x722A07A38F2E41B8), UINT64_C(0x18DDBCC7F40BA628) },
+    { UINT64_C(0xC1BB394FA5BE9AFA), UINT64_C(0x13E497065CD61E86) },
+    { UINT64_C(0x9C5EC2190930F7F6), UINT64_C(0x1FD424D6FAF030D7) },
+    { UINT64_C(0x49E56814075A5FF8), UINT64_C(0x197683DF2F268D79) },
+    { UINT64_C(0x6E51201005E1E660), UINT64_C(0x145ECFE5BF520AC7) },
+    { UINT64_C(0xF1DA800CD181851A), UINT64_C(0x104BD984990E6F05) },
+    { UINT64_C(0x4FC400148268D4F5), UINT64_C(0x1A12F5A0F4E3E4D6) },
+    { UINT64_C(0xD96999AA01ED772B), UINT64_C(0x14DBF7B3F71CB711) },
+    { UINT64_C(0xADEE1488018AC5BC), UINT64_C(0x10AFF95CC5B09274) },
+    { UINT64_C(0x497CEDA668DE092C), UINT64_C(0x1AB328946F80EA54) },
+    { UINT64_C(0x3ACA57B853E4D424), UINT64_C(0x155C2076BF9A5510) },
+    { UINT64_C(0x623B7960431D7683), UINT64_C(0x1116805EFFAEAA73) },
+    { UINT64_C(0x9D2BF566D1C8BD9E), UINT64_C(0x1B5733CB32B110B8) },
+    { UINT64_C(0x7DBCC452416D647F), UINT64_C(0x15DF5CA28EF40D60) },
+    { UINT64_C(0xCAFD69DB678AB6CC), UINT64_C(0x117F7D4ED8C33DE6) },
+    { UINT64_C(0xAB2F0FC572778ADF), UINT64_C(0x1BFF2EE48E052FD7) },
+    { UINT64_C(0x88F273045B92D580), UINT64_C(0x1665BF1D3E6A8CAC) },
+    { UINT64_C(0xD3F528D049424466), UINT64_C(0x11EAFF4A98553D56) },
+    { UINT64_C(0xB988414D4203A0A3), UINT64_C(0x1CAB3210F3BB9557) },
+    { UINT64_C(0x6139CDD76802E6E9), UINT64_C(0x16EF5B40C2FC7779) },
+    { UINT64_C(0xE761717920025254), UINT64_C(0x125915CD68C9F92D) },
+    { UINT64_C(0xA568B58E999D5086), UINT64_C(0x1D5B561574765B7C) },
+    { UINT64_C(0x5120913EE14AA6D2), UINT64_C(0x177C44DDF6C515FD) },
+    { UINT64_C(0xA74D40FF1AA21F0E), UINT64_C(0x12C9D0B1923744CA) },
+    { UINT64_C(0x0BAECE64F769CB4A), UINT64_C(0x1E0FB44F50586E11) },
+    { UINT64_C(0x3C8BD850C5EE3C3B), UINT64_C(0x180C903F7379F1A7) },
+    { UINT64_C(0xCA0979DA37F1C9C9), UINT64_C(0x133D4032C2C7F485) },
+    { UINT64_C(0xA9A8C2F6BFE942DB), UINT64_C(0x1EC866B79E0CBA6F) },
+    { UINT64_C(0x2153CF2BCCBA9BE3), UINT64_C(0x18A0522C7E709526) },
+    { UINT64_C(0x1AA9728970954982), UINT64_C(0x13B374F06526DDB8) },
+    { UINT64_C(0xF775840F1A88759D), UINT64_C(0x1F8587E7083E2F8C) },
+    { UINT64_C(0x5F9136727BA05E17), UINT64_C(0x19379FEC0698260A) },
+    { UINT64_C(0x1940F85B9619E4DF), UINT64_C(0x142C7FF0054684D5) },
+    { UINT64_C(0xE100C6AFAB47EA4C), UINT64_C(0x1023998CD1053710) },
+    { UINT64_C(0xCE67A44C453FDD47), UINT64_C(0x19D28F47B4D524E7) },
+    { UINT64_C(0xD852E9D69DCCB106), UINT64_C(0x14A8729FC3DDB71F) },
+    { UINT64_C(0x79DBEE454B0A2738), UINT64_C(0x1086C219697E2C19) },
+    { UINT64_C(0x295FE3A211A9D859), UINT64_C(0x1A71368F0F30468F) },
+    { UINT64_C(0xBAB31C81A7BB137A), UINT64_C(0x15275ED8D8F36BA5) },
+    { UINT64_C(0x6228E39AEC95A92F), UINT64_C(0x10EC4BE0AD8F8951) },
+    { UINT64_C(0x9D0E38F7E0EF7517), UINT64_C(0x1B13AC9AAF4C0EE8) },
+    { UINT64_C(0xB0D82D931A592A79), UINT64_C(0x15A956E225D67253) },
+    { UINT64_C(0x8D79BE0F4847552E), UINT64_C(0x11544581B7DEC1DC) },
+    { UINT64_C(0x158F967EDA0BBB7C), UINT64_C(0x1BBA08CF8C979C94) },
+    { UINT64_C(0x77A611FF14D62F97), UINT64_C(0x162E6D72D6DFB076) },
+    { UINT64_C(0xF951A7FF43DE8C79), UINT64_C(0x11BEBDF578B2F391) },
+    { UINT64_C(0xC21C3FFED2FDAD8E), UINT64_C(0x1C6463225AB7EC1C) },
+    { UINT64_C(0x01B0333242648AD8), UINT64_C(0x16B6B5B5155FF017) },
+    { UINT64_C(0x0159C28E9B83A246), UINT64_C(0x122BC490DDE659AC) },
+    { UINT64_C(0xCEF604175F3903A3), UINT64_C(0x1D12D41AFCA3C2AC) },
+    { UINT64_C(0x725E69AC4C2D9C83), UINT64_C(0x17424348CA1C9BBD) },
+    { UINT64_C(0xF5185489D68AE39C), UINT64_C(0x129B69070816E2FD) },
+    { UINT64_C(0xEE8D540FBDAB05C6), UINT64_C(0x1DC574D80CF16B2F) },
+    { UINT64_C(0xBED77672FE226B05), UINT64_C(0x17D12A4670C1228C) },
+    { UINT64_C(0xFF12C528CB4EBC04), UINT64_C(0x130DBB6B8D674ED6) },
+    { UINT64_C(0xCB513B74787DF9A0), UINT64_C(0x1E7C5F127BD87E24) },
+    { UINT64_C(0x090DC929F9FE614D), UINT64_C(0x18637F41FCAD31B7) },
+    { UINT64_C(0xA0D7D42194CB810A), UINT64_C(0x1382CC34CA2427C5) },
+    { UINT64_C(0x67BFB9CF5478CE77), UINT64_C(0x1F37AD21436D0C6F) },
+    { UINT64_C(0x1FCC94A5DD2D71F9), UINT64_C(0x18F9574DCF8A7059) },
+    { UINT64_C(0x7FD6DD517DBDF4C7), UINT64_C(0x13FAAC3E3FA1F37A) },
+    { UINT64_C(0xFFBE2EE8C92FEE0B), UINT64_C(0x1FF779FD329CB8C3) },
+    { UINT64_C(0x6631BF20A0F324D6), UINT64_C(0x1992C7FDC216FA36) },
+    { UINT64_C(0xB827CC1A1A5C1D78), UINT64_C(0x14756CCB01ABFB5E) },
+    { UINT64_C(0x935309AE7B7CE460), UINT64_C(0x105DF0A267BCC918) },
+    { UINT64_C(0x1EEB42B0C594A099), UINT64_C(0x1A2FE76A3F9474F4) },
+    { UINT64_C(0xE58902270476E6E1), UINT64_C(0x14F31F8832DD2A5C) },
+    { UINT64_C(0xB7A0CE859D2BEBE7), UINT64_C(0x10C27FA028B0EEB0) },
+    { UINT64_C(0x59014A6F61DFDFD8), UINT64_C(0x1AD0CC33744E4AB4) },
+    { UINT64_C(0xE0CDD525E7E64CAD), UINT64_C(0x1573D68F903EA229) },
+    { UINT64_C(0x4D7177518651D6F1), UINT64_C(0x11297872D9CBB4EE) },
+    { UINT64_C(0x7BE8BEE8D6E957E8), UINT64_C(0x1B758D848FAC54B0) },
+    { UINT64_C(0xFCBA3253DF211320), UINT64_C(0x15F7A46A0C89DD59) },
+    { UINT64_C(0x63C8284318E74280), UINT64_C(0x1192E9EE706E4AAE) },
+    { UINT64_C(0x060D0D3827D86A66), UINT64_C(0x1C1E43171A4A1117) },
+    { UINT64_C(0x6B3DA42CECAD21EB), UINT64_C(0x167E9C127B6E7412) },
+    { UINT64_C(0x88FE1CF0BD574E56), UINT64_C(0x11FEE341FC585CDB) },
+    { UINT64_C(0x419694B462254A23), UINT64_C(0x1CCB0536608D615F) },
+    { UINT64_C(0x67ABAA29E81DD4E9), UINT64_C(0x1708D0F84D3DE77F) },
+    { UINT64_C(0xB95621BB2017DD87), UINT64_C(0x126D73F9D764B932) },
+    { UINT64_C(0xC223692B668C95A5), UINT64_C(0x1D7BECC2F23AC1EA) },
+    { UINT64_C(0xCE82BA891ED6DE1D), UINT64_C(0x179657025B6234BB) },
+    { UINT64_C(0xA53562074BDF1818), UINT64_C(0x12DEAC01E2B4F6FC) },
+    { UINT64_C(0x3B889CD87964F359), UINT64_C(0x1E3113363787F194) },
+    { UINT64_C(0xFC6D4A46C783F5E1), UINT64_C(0x18274291C6065ADC) },
+    { UINT64_C(0x30576E9F06032B1A), UINT64_C(0x13529BA7D19EAF17) },
+    { UINT64_C(0x1A257DCB3CD1DE90), UINT64_C(0x1EEA92A61C311825) },
+    { UINT64_C(0x481DFE3C30A7E540), UINT64_C(0x18BBA884E35A79B7) },
+    { UINT64_C(0xD34B31C9C0865100), UINT64_C(0x13C9539D82AEC7C5) },
+    { UINT64_C(0x5211E942CDA3B4CD), UINT64_C(0x1FA885C8D117A609) },
+    { UINT64_C(0x74DB21023E1C90A4), UINT64_C(0x19539E3A40DFB807) },
+    { UINT64_C(0xF715B401CB4A0D50), UINT64_C(0x1442E4FB67196005) },
+    { UINT64_C(0xF8DE299B09080AA7), UINT64_C(0x103583FC527AB337) },
+    { UINT64_C(0x8E304291A80CDDD7), UINT64_C(0x19EF3993B72AB859) },
+    { UINT64_C(0x3E8D020E200A4B13), UINT64_C(0x14BF6142F8EEF9E1) },
+    { UINT64_C(0x653D9B3E80083C0F), UINT64_C(0x10991A9BFA58C7E7) },
+    { UINT64_C(0x6EC8F864000D2CE4), UINT64_C(0x1A8E90F9908E0CA5) },
+    { UINT64_C(0x8BD3F9E999A423EA), UINT64_C(0x153EDA614071A3B7) },
+    { UINT64_C(0x3CA994BAE1501CBB), UINT64_C(0x10FF151A99F482F9) },
+    { UINT64_C(0xC775BAC49BB3612B), UINT64_C(0x1B31BB5DC320D18E) },
+    { UINT64_C(0xD2C4956A16291A89), UINT64_C(0x15C162B168E70E0B) },
+    { UINT64_C(0xDBD0778811BA7BA1), UINT64_C(0x11678227871F3E6F) },
+    { UINT64_C(0x2C80BF401C5D929B), UINT64_C(0x1BD8D03F3E9863E6) },
+    { UINT64_C(0xBD33CC3349E47549), UINT64_C(0x16470CFF6546B651) },
+    { UINT64_C(0xCA8FD68F6E505DD4), UINT64_C(0x11D270CC51055EA7) },
+    { UINT64_C(0x4419574BE3B3C953), UINT64_C(0x1C83E7AD4E6EFDD9) },
+    { UINT64_C(0x0347790982F63AA9), UINT64_C(0x16CFEC8AA52597E1) },
+    { UINT64_C(0xCF6C60D468C4FBBA), UINT64_C(0x123FF06EEA847980) },
+    { UINT64_C(0xE57A34870E07F92A), UINT64_C(0x1D331A4B10D3F59A) },
+    { UINT64_C(0x512E906C0B399422), UINT64_C(0x175C1508DA432AE2) },
+    { UINT64_C(0xDA8BA6BCD5C7A9B5), UINT64_C(0x12B010D3E1CF5581) },
+    { UINT64_C(0x90DF712E22D90F87), UINT64_C(0x1DE6815302E5559C) },
+    { UINT64_C(0xDA4C5A8B4F140C6C), UINT64_C(0x17EB9AA8CF1DDE16) },
+    { UINT64_C(0xAEA37BA2A5A9A38A), UINT64_C(0x1322E220A5B17E78) },
+    { UINT64_C(0x7DD25F6AA2A905A9), UINT64_C(0x1E9E369AA2B59727) },
+    { UINT64_C(0x97DB7F888220D154), UINT64_C(0x187E92154EF7AC1F) },
+    { UINT64_C(0x797C6606CE80A777), UINT64_C(0x139874DDD8C6234C) },
+    { UINT64_C(0x8F2D700AE4010BF1), UINT64_C(0x1F5A549627A36BAD) },
+    { UINT64_C(0x0C2459A25000D65A), UINT64_C(0x191510781FB5EFBE) },
+    { UINT64_C(0x701D1481D99A4515), UINT64_C(0x1410D9F9B2F7F2FE) },
+    { UINT64_C(0xC017439B147B6A77), UINT64_C(0x100D7B2E28C65BFE) },
+    { UINT64_C(0xCCF205C4ED9243F2), UINT64_C(0x19AF2B7D0E0A2CCA) },
+    { UINT64_C(0x0A5B37D0BE0E9CC2), UINT64_C(0x148C22CA71A1BD6F) },
+    { UINT64_C(0x0848F973CB3EE3CE), UINT64_C(0x10701BD527B4978C) },
+    { UINT64_C(0xDA0E5BEC78649FB0), UINT64_C(0x1A4CF9550C5425AC) },
+    { UINT64_C(0x7B3EAFF060507FC0), UINT64_C(0x150A6110D6A9B7BD) },
+    { UINT64_C(0x95CBBFF380406633), UINT64_C(0x10D51A73DEEE2C97) },
+    { UINT64_C(0xEFAC665266CD7052), UINT64_C(0x1AEE90B964B04758) },
+    { UINT64_C(0x2623850EB8A459DB), UINT64_C(0x158BA6FAB6F36C47) },
+    { UINT64_C(0x1E82D0D893B6AE49), UINT64_C(0x113C85955F29236C) },
+    { UINT64_C(0xFD9E1AF41F8AB075), UINT64_C(0x1B9408EEFEA838AC) },
+    { UINT64_C(0x97B1AF29B2D559F7), UINT64_C(0x16100725988693BD) },
+    { UINT64_C(0xAC8E25BAF5777B2C), UINT64_C(0x11A66C1E139EDC97) },
+    { UINT64_C(0x7A7D092B2258C513), UINT64_C(0x1C3D79C9B8FE2DBF) },
+    { UINT64_C(0x61FDA0EF4EAD6A76), UINT64_C(0x169794A160CB57CC) },
+    { UINT64_C(0xE7FE1A590BBDEEC5), UINT64_C(0x1212DD4DE7091309) },
+    { UINT64_C(0xA6635D5B45FCB13A), UINT64_C(0x1CEAFBAFD80E84DC) },
+    { UINT64_C(0x851C4AAF6B308DC8), UINT64_C(0x172262F3133ED0B0) },
+    { UINT64_C(0xD0E36EF2BC26D7D4), UINT64_C(0x1281E8C275CBDA26) },
+    { UINT64_C(0xB49F17EAC6A48C86), UINT64_C(0x1D9CA79D894629D7) },
+    { UINT64_C(0x2A18DFEF0550706B), UINT64_C(0x17B08617A104EE46) },
+    { UINT64_C(0x54E0B3259DD9F389), UINT64_C(0x12F39E794D9D8B6B) },
+    { UINT64_C(0x87CDEB6F62F65274), UINT64_C(0x1E5297287C2F4578) },
+    { UINT64_C(0xD30B22BF825EA85D), UINT64_C(0x18421286C9BF6AC6) },
+    { UINT64_C(0x0F3C1BCC684BB9E4), UINT64_C(0x13680ED23AFF889F) },
+    { UINT64_C(0x18602C7A4079296D), UINT64_C(0x1F0CE4839198DA98) },
+    { UINT64_C(0x46B356C833942124), UINT64_C(0x18D71D360E13E213) },
+    { UINT64_C(0x388F78A029434DB6), UINT64_C(0x13DF4A91A4DCB4DC) },
+    { UINT64_C(0x5A7F2766A86BAF8A), UINT64_C(0x1FCBAA82A1612160) },
+    { UINT64_C(0x153285EBB9EFBFA2), UINT64_C(0x196FBB9BB44DB44D) },
+    { UINT64_C(0xAA8ED189618C994E), UINT64_C(0x145962E2F6A4903D) },
+    { UINT64_C(0xEED8A7A11AD6E10C), UINT64_C(0x1047824F2BB6D9CA) },
+    { UINT64_C(0x7E27729B5E249B45), UINT64_C(0x1A0C03B1DF8AF611) },
+    { UINT64_C(0xFE85F549181D4904), UINT64_C(0x14D6695B193BF80D) },
+    { UINT64_C(0xCB9E5DD4134AA0D0), UINT64_C(0x10AB877C142FF9A4) },
+    { UINT64_C(0xDF63C9535211014D), UINT64_C(0x1AAC0BF9B9E65C3A) },
+    { UINT64_C(0x191CA10F74DA6771), UINT64_C(0x15566FFAFB1EB02F) },
+    { UINT64_C(0xADB080D92A4852C1), UINT64_C(0x1111F32F2F4BC025) },
+    { UINT64_C(0x15E7348EAA0D5134), UINT64_C(0x1B4FEB7EB212CD09) },
+    { UINT64_C(0xAB1F5D3EEE710DC4), UINT64_C(0x15D98932280F0A6D) },
+    { UINT64_C(0xBC1917658B8DA49D), UINT64_C(0x117AD428200C0857) },
+    { UINT64_C(0x2CF4F23C127C3A94), UINT64_C(0x1BF7B9D9CCE00D59) },
+    { UINT64_C(0xF0C3F4FCDB969543), UINT64_C(0x165FC7E170B33DE0) },
+    { UINT64_C(0x5A365D9716121103), UINT64_C(0x11E6398126F5CB1A) },
+    { UINT64_C(0x9056FC24F01CE804), UINT64_C(0x1CA38F350B22DE90) },
+    { UINT64_C(0xD9DF301D8CE3ECD0), UINT64_C(0x16E93F5DA2824BA6) },
+    { UINT64_C(0xE17F59B13D8323DA), UINT64_C(0x125432B14ECEA2EB) },
+    { UINT64_C(0x68CBC2B52F38395C), UINT64_C(0x1D53844EE47DD179) },
+    { UINT64_C(0x53D6355DBF602DE3), UINT64_C(0x177603725064A794) },
+    { UINT64_C(0xA9782AB165E68B1C), UINT64_C(0x12C4CF8EA6B6EC76) },
+    { UINT64_C(0x0F26AAB56FD744FA), UINT64_C(0x1E07B27DD78B13F1) },
+    { UINT64_C(0x3F52222ABFDF6A62), UINT64_C(0x18062864AC6F4327) },
+    { UINT64_C(0x65DB4E88997F884E), UINT64_C(0x1338205089F29C1F) },
+    { UINT64_C(0x6FC54A7428CC0D4A), UINT64_C(0x1EC033B40FEA9365) },
+    { UINT64_C(0x596AA1F68709A43B), UINT64_C(0x1899C2F673220F84) },
+    { UINT64_C(0xADEEE7F86C07B696), UINT64_C(0x13AE3591F5B4D936) },
+    { UINT64_C(0x497E3FF3E00C5756), UINT64_C(0x1F7D228322BAF524) },
+    { UINT64_C(0xD464FFF64CD6AC45), UINT64_C(0x1930E868E89590E9) },
+    { UINT64_C(0x4383FFF83D7889D1), UINT64_C(0x14272053ED4473EE) },
+    { UINT64_C(0xCF9CCCC69793A174), UINT64_C(0x101F4D0FF1038FF1) },
+    { UINT64_C(0x7F6147A425B90252), UINT64_C(0x19CBAE7FE805B31C) },
+    { UINT64_C(0xCC4DD2E9B7C7350F), UINT64_C(0x14A2F1FFECD15C16) },
+    { UINT64_C(0x3D0B0F215FD290D9), UINT64_C(0x10825B3323DAB012) },
+    { UINT64_C(0x61AB4B689950E7C1), UINT64_C(0x1A6A2B85062AB350) },
+    { UINT64_C(0x4E22A2BA1440B967), UINT64_C(0x1521BC6A6B555C40) },
+    { UINT64_C(0x0B4EE894DD009453), UINT64_C(0x10E7C9EEBC4449CD) },
+    { UINT64_C(0x1217DA87C800ED51), UINT64_C(0x1B0C764AC6D3A948) },
+    { UINT64_C(0xDB46486CA000BDDA), UINT64_C(0x15A391D56BDC876C) },
+    { UINT64_C(0x490506BD4CCD64AF), UINT64_C(0x114FA7DDEFE39F8A) },
+    { UINT64_C(0xA8080AC87AE23AB1), UINT64_C(0x1BB2A62FE638FF43) },
+    { UINT64_C(0x5339A239FBE82EF4), UINT64_C(0x162884F31E93FF69) },
+    { UINT64_C(0x75C7B4FB2FECF25D), UINT64_C(0x11BA03F5B20FFF87) },
+    { UINT64_C(0x22D92191E647EA2E), UINT64_C(0x1C5CD322B67FFF3F) },
+    { UINT64_C(0xB57A8141850654F2), UINT64_C(0x16B0A8E891FFFF65) },
+    { UINT64_C(0xC4620101373843F5), UINT64_C(0x1226ED86DB3332B7) },
+    { UINT64_C(0x3A366801F1F39FEE), UINT64_C(0x1D0B15A491EB8459) },
+    { UINT64_C(0xFB5EB99B27F6198B), UINT64_C(0x173C115074BC69E0) },
+    { UINT64_C(0x2F7EFAE2865E7AD6), UINT64_C(0x129674405D6387E7) },
+    { UINT64_C(0xE597F7D0D6FD9156), UINT64_C(0x1DBD86CD6238D971) },
+    { UINT64_C(0x8479930D78CADAAB), UINT64_C(0x17CAD23DE82D7AC1) },
+    { UINT64_C(0xD06142712D6F1556), UINT64_C(0x1308A831868AC89A) },
+    { UINT64_C(0x4D686A4EAF182222), UINT64_C(0x1E74404F3DAADA91) },
+    { UINT64_C(0xA453883EF279B4E8), UINT64_C(0x185D003F6488AEDA) },
+    { UINT64_C(0xE9DC6CFF28615D87), UINT64_C(0x137D99CC506D58AE) },
+    { UINT64_C(0xA960AE650D6895A4), UINT64_C(0x1F2F5C7A1A488DE4) },
+    { UINT64_C(0xBAB3BEB73DED4483), UINT64_C(0x18F2B061AEA07183) },
+    { UINT64_C(0x2EF6322C318A9D36), UINT64_C(0x13F559E7BEE6C136) },
+    { UINT64_C(0xE4BD1D13827761F0), UINT64_C(0x1FEEF63F97D79B89) },
+    { UINT64_C(0x83CA7DA9352C4E5A), UINT64_C(0x198BF832DFDFAFA1) },
+    { UINT64_C(0x9CA1FE20F756A515), UINT64_C(0x146FF9C24CB2F2E7) },
+    { UINT64_C(0x4A1B31B3F9121DAA), UINT64_C(0x1059949B708F28B9) },
+    { UINT64_C(0x435EB5ECC1B695DD), UINT64_C(0x1A28EDC580E50DF5) },
+    { UINT64_C(0x35E55E57015EDE4A), UINT64_C(0x14ED8B04671DA4C4) },
+    { UINT64_C(0xC4B77EAC0118B1D5), UINT64_C(0x10BE08D0527E1D69) },
+    { UINT64_C(0xA12597799B5AB622), UINT64_C(0x1AC9A7B3B7302F0F) },
+    { UINT64_C(0x4DB7AC6149155E81), UINT64_C(0x156E1FC2F8F358D9) },
+    { UINT64_C(0xD7C6238107444B9B), UINT64_C(0x1124E63593F5E0AD) },
+    { UINT64_C(0x593D059B3ED3AC2B), UINT64_C(0x1B6E3D2286563449) },
+    { UINT64_C(0xE0FD9E15CBDC89BC), UINT64_C(0x15F1CA820511C36D) },
+    { UINT64_C(0xB3FE18116FE3A163), UINT64_C(0x118E3B9B37416924) },
+    { UINT64_C(0x866359B57FD29BD1), UINT64_C(0x1C16C5C525357507) },
+    { UINT64_C(0xD1E91491330EE30E), UINT64_C(0x16789E3750F790D2) },
+    { UINT64_C(0x74BA76DA8F3F1C0B), UINT64_C(0x11FA182C40C60D75) },
+    { UINT64_C(0xEDF72490E531C678), UINT64_C(0x1CC359E067A348BB) },
+    { UINT64_C(0x8B2C1D40B75B052D), UINT64_C(0x1702AE4D1FB5D3C9) },
+    { UINT64_C(0x6F567DCD5F7C0424), UINT64_C(0x12688B70E62B0FD4) },
+    { UINT64_C(0x7EF0C94898C66D06), UINT64_C(0x1D74124E3D11B2ED) },
+    { UINT64_C(0x98C0A106E09EBD9F), UINT64_C(0x17900EA4FDA7C257) },
+    { UINT64_C(0x470080D24D4BCAE6), UINT64_C(0x12D9A550CAEC9B79) },
+    { UINT64_C(0xD800CE1D487944A2), UINT64_C(0x1E29088144ADC58E) },
+    { UINT64_C(0x1333D8176D2DD082), UINT64_C(0x1820D39A9D57D13F) },
+    { UINT64_C(0xA8F646792424A6CE), UINT64_C(0x134D76154AACA765) },
+    { UINT64_C(0x74BD3D8EA03AA47D), UINT64_C(0x1EE25688777AA56F) },
+    { UINT64_C(0x5D64313EE6955064), UINT64_C(0x18B51206C5FBB78C) },
+    { UINT64_C(0x4AB68DCBEBAAA6B7), UINT64_C(0x13C40E6BD1962C70) },
+    { UINT64_C(0x1124161312AAA457), UINT64_C(0x1FA01712E8F0471A) },
+    { UINT64_C(0xDA8344DC0EEEE9DF), UINT64_C(0x194CDF4253F36C14) },
+    { UINT64_C(0xE2029D7CD8BF2180), UINT64_C(0x143D7F6843292343) },
+    { UINT64_C(0x4E687DFD7A328133), UINT64_C(0x103132B9CF541C36) },
+    { UINT64_C(0x4A40C9959050CEB8), UINT64_C(0x19E851294BB9C6BD) },
+    { UINT64_C(0x0833D477A6A70BC6), UINT64_C(0x14B9DA876FC7D231) },
+    { UINT64_C(0xA02976C61EEC096B), UINT64_C(0x1094AED2BFD30E8D) },
+    { UINT64_C(0x004257A364ACDBDF), UINT64_C(0x1A877E1DFFB81749) },
+    { UINT64_C(0xCD01DFB5EA23E319), UINT64_C(0x153931B1996012A0) },
+    { UINT64_C(0x70CE4C91881CB5AE), UINT64_C(0x10FA8E27ADE6754D) },
+    { UINT64_C(0x1AE3ADB5A69455E2), UINT64_C(0x1B2A7D0C4970BBAF) },
+    { UINT64_C(0x7BE957C4854377E8), UINT64_C(0x15BB973D078D62F2) },
+    { UINT64_C(0xC987796A0435F987), UINT64_C(0x1162DF64060AB58E) },
+    { UINT64_C(0x75A58F1006BCC271), UINT64_C(0x1BD1656CD67788E4) },
+    { UINT64_C(0xF7B7A5A66BCA3527), UINT64_C(0x16411DF0AB92D3E9) },
+    { UINT64_C(0x5FC61E1EBCA1C41F), UINT64_C(0x11CDB18D560F0FEE) },
+    { UINT64_C(0xFFA363646102D365), UINT64_C(0x1C7C4F4889B1B316) },
+    { UINT64_C(0x32E91C504D9BDC51), UINT64_C(0x16C9D906D48E28DF) },
+    { UINT64_C(0x8F20E37371497D0E), UINT64_C(0x123B140576D820B2) },
+    { UINT64_C(0x7E9B0585820F2E7C), UINT64_C(0x1D2B533BF159CDEA) },
+    { UINT64_C(0xCBAF379E01A5BECA), UINT64_C(0x1755DC2FF447D7EE) },
+    { UINT64_C(0x0958F94B348498A1), UINT64_C(0x12AB168CC36CACBF) }
+};
+
+static const MVMuint64 MVM_RYU_POW5_SPLIT[MVM_RYU_POW5_TABLE_SIZE][2] = {
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1000000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1400000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1900000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1F40000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1388000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x186A000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1E84800000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1312D00000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x17D7840000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1DCD650000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x12A05F2000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x174876E800000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1D1A94A200000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x12309CE540000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x16BCC41E90000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1C6BF52634000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x11C37937E0800000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x16345785D8A00000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1BC16D674EC80000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1158E460913D0000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x15AF1D78B58C4000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1B1AE4D6E2EF5000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x10F0CF064DD59200) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x152D02C7E14AF680) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1A784379D99DB420) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x108B2A2C28029094) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x14ADF4B7320334B9) },
+    { UINT64_C(0x4000000000000000), UINT64_C(0x19D971E4FE8401E7) },
+    { UINT64_C(0x8800000000000000), UINT64_C(0x1027E72F1F128130) },
+    { UINT64_C(0xAA00000000000000), UINT64_C(0x1431E0FAE6D7217C) },
+    { UINT64_C(0xD480000000000000), UINT64_C(0x193E5939A08CE9DB) },
+    { UINT64_C(0xC9A0000000000000), UINT64_C(0x1F8DEF8808B02452) },
+    { UINT64_C(0xBE04000000000000), UINT64_C(0x13B8B5B5056E16B3) },
+    { UINT64_C(0xAD85000000000000), UINT64_C(0x18A6E32246C99C60) },
+    { UINT64_C(0xD8E6400000000000), UINT64_C(0x1ED09BEAD87C0378) },
+    { UINT64_C(0x878FE80000000000), UINT64_C(0x13426172C74D822B) },
+    { UINT64_C(0x6973E20000000000), UINT64_C(0x1812F9CF7920E2B6) },
+    { UINT64_C(0x03D0DA8000000000), UINT64_C(0x1E17B84357691B64) },
+    { UINT64_C(0x8262889000000000), UINT64_C(0x12CED32A16A1B11E) },
+    { UINT64_C(0x22FB2AB400000000), UINT64_C(0x178287F49C4A1D66) },
+    { UINT64_C(0xABB9F56100000000), UINT64_C(0x1D6329F1C35CA4BF) },
+    { UINT64_C(0xCB54395CA0000000), UINT64_C(0x125DFA371A19E6F7) },
+    { UINT64_C(0xBE2947B3C8000000), UINT64_C(0x16F578C4E0A060B5) },
+    { UINT64_C(0x2DB399A0BA000000), UINT64_C(0x1CB2D6F618C878E3) },
+    { UINT64_C(0xFC90400474400000), UINT64_C(0x11EFC659CF7D4B8D) },
+    { UINT64_C(0x7BB4500591500000), UINT64_C(0x166BB7F0435C9E71) },
+    { UINT64_C(0xDAA16406F5A40000), UINT64_C(0x1C06A5EC5433C60D) },
+    { UINT64_C(0xA8A4DE8459868000), UINT64_C(0x118427B3B4A05BC8) },
+    { UINT64_C(0xD2CE16256FE82000), UINT64_C(0x15E531A0A1C872BA) },
+    { UINT64_C(0x87819BAECBE22800), UINT64_C(0x1B5E7E08CA3A8F69) },
+    { UINT64_C(0xF4B1014D3F6D5900), UINT64_C(0x111B0EC57E6499A1) },
+    { UINT64_C(0x71DD41A08F48AF40), UINT64_C(0x1561D276DDFDC00A) },
+    { UINT64_C(0x0E549208B31ADB10), UINT64_C(0x1ABA4714957D300D) },
+    { UINT64_C(0x28F4DB456FF0C8EA), UINT64_C(0x10B46C6CDD6E3E08) },
+    { UINT64_C(0x33321216CBECFB24), UINT64_C(0x14E1878814C9CD8A) },
+    { UINT64_C(0xBFFE969C7EE839ED), UINT64_C(0x1A19E96A19FC40EC) },
+    { UINT64_C(0xF7FF1E21CF512434), UINT64_C(0x105031E2503DA893) },
+    { UINT64_C(0xF5FEE5AA43256D41), UINT64_C(0x14643E5AE44D12B8) },
+    { UINT64_C(0x337E9F14D3EEC892), UINT64_C(0x197D4DF19D605767) },
+    { UINT64_C(0x005E46DA08EA7AB6), UINT64_C(0x1FDCA16E04B86D41) },
+    { UINT64_C(0xA03AEC4845928CB2), UINT64_C(0x13E9E4E4C2F34448) },
+    { UINT64_C(0xC849A75A56F72FDE), UINT64_C(0x18E45E1DF3B0155A) },
+    { UINT64_C(0x7A5C1130ECB4FBD6), UINT64_C(0x1F1D75A5709C1AB1) },
+    { UINT64_C(0xEC798ABE93F11D65), UINT64_C(0x13726987666190AE) },
+    { UINT64_C(0xA797ED6E38ED64BF), UINT64_C(0x184F03E93FF9F4DA) },
+    { UINT64_C(0x517DE8C9C728BDEF), UINT64_C(0x1E62C4E38FF87211) },
+    { UINT64_C(0xD2EEB17E1C7976B5), UINT64_C(0x12FDBB0E39FB474A) },
+    { UINT64_C(0x87AA5DDDA397D462), UINT64_C(0x17BD29D1C87A191D) },
+    { UINT64_C(0xE994F5550C7DC97B), UINT64_C(0x1DAC74463A989F64) },
+    { UINT64_C(0x11FD195527CE9DED), UINT64_C(0x128BC8ABE49F639F) },
+    { UINT64_C(0xD67C5FAA71C24568), UINT64_C(0x172EBAD6DDC73C86) },
+    { UINT64_C(0x8C1B77950E32D6C2), UINT64_C(0x1CFA698C95390BA8) },
+    { UINT64_C(0x57912ABD28DFC639), UINT64_C(0x121C81F7DD43A749) },
+    { UINT64_C(0xAD75756C7317B7C8), UINT64_C(0x16A3A275D494911B) },
+    { UINT64_C(0x98D2D2C78FDDA5BA), UINT64_C(0x1C4C8B1349B9B562) },
+    { UINT64_C(0x9F83C3BCB9EA8794), UINT64_C(0x11AFD6EC0E14115D) },
+    { UINT64_C(0x0764B4ABE8652979), UINT64_C(0x161BCCA7119915B5) },
+    { UINT64_C(0x493DE1D6E27E73D7), UINT64_C(0x1BA2BFD0D5FF5B22) },
+    { UINT64_C(0x6DC6AD264D8F0866), UINT64_C(0x1145B7E285BF98F5) },
+    { UINT64_C(0xC938586FE0F2CA80), UINT64_C(0x159725DB272F7F32) },
+    { UINT64_C(0x7B866E8BD92F7D20), UINT64_C(0x1AFCEF51F0FB5EFF) },
+    { UINT64_C(0xAD34051767BDAE34), UINT64_C(0x10DE1593369D1B5F) },
+    { UINT64_C(0x9881065D41AD19C1), UINT64_C(0x15159AF804446237) },
+    { UINT64_C(0x7EA147F492186032), UINT64_C(0x1A5B01B605557AC5) },
+    { UINT64_C(0x6F24CCF8DB4F3C1F), UINT64_C(0x1078E111C3556CBB) },
+    { UINT64_C(0x4AEE003712230B27), UINT64_C(0x14971956342AC7EA) },
+    { UINT64_C(0xDDA98044D6ABCDF0), UINT64_C(0x19BCDFABC13579E4) },
+    { UINT64_C(0x0A89F02B062B60B6), UINT64_C(0x10160BCB58C16C2F) },
+    { UINT64_C(0xCD2C6C35C7B638E4), UINT64_C(0x141B8EBE2EF1C73A) },
+    { UINT64_C(0x8077874339A3C71D), UINT64_C(0x1922726DBAAE3909) },
+    { UINT64_C(0xE0956914080CB8E4), UINT64_C(0x1F6B0F092959C74B) },
+    { UINT64_C(0x6C5D61AC8507F38E), UINT64_C(0x13A2E965B9D81C8F) },
+    { UINT64_C(0x4774BA17A649F072), UINT64_C(0x188BA3BF284E23B3) },
+    { UINT64_C(0x1951E89D8FDC6C8F), UINT64_C(0x1EAE8CAEF261ACA0) },
+    { UINT64_C(0x0FD3316279E9C3D9), UINT64_C(0x132D17ED577D0BE4) },
+    { UINT64_C(0x13C7FDBB186434CF), UINT64_C(0x17F85DE8AD5C4EDD) },
+    { UINT64_C(0x58B9FD29DE7D4203), UINT64_C(0x1DF67562D8B36294) },
+    { UINT64_C(0xB7743E3A2B0E4942), UINT64_C(0x12BA095DC7701D9C) },
+    { UINT64_C(0xE5514DC8B5D1DB92), UINT64_C(0x17688BB5394C2503) },
+    { UINT64_C(0xDEA5A13AE3465277), UINT64_C(0x1D42AEA2879F2E44) },
+    { UINT64_C(0x0B2784C4CE0BF38A), UINT64_C(0x1249AD2594C37CEB) },
+    { UINT64_C(0xCDF165F6018EF06D), UINT64_C(0x16DC186EF9F45C25) },
+    { UINT64_C(0x416DBF7381F2AC88), UINT64_C(0x1C931E8AB871732F) },
+    { UINT64_C(0x88E497A83137ABD5), UINT64_C(0x11DBF316B346E7FD) },
+    { UINT64_C(0xEB1DBD923D8596CA), UINT64_C(0x1652EFDC6018A1FC) },
+    { UINT64_C(0x25E52CF6CCE6FC7D), UINT64_C(0x1BE7ABD3781ECA7C) },
+    { UINT64_C(0x97AF3C1A40105DCE), UINT64_C(0x1170CB642B133E8D) },
+    { UINT64_C(0xFD9B0B20D0147542), UINT64_C(0x15CCFE3D35D80E30) },
+    { UINT64_C(0x3D01CDE904199292), UINT64_C(0x1B403DCC834E11BD) },
+    { UINT64_C(0x462120B1A28FFB9B), UINT64_C(0x1108269FD210CB16) },
+    { UINT64_C(0xD7A968DE0B33FA82), UINT64_C(0x154A3047C694FDDB) },
+    { UINT64_C(0xCD93C3158E00F923), UINT64_C(0x1A9CBC59B83A3D52) },
+    { UINT64_C(0xC07C59ED78C09BB6), UINT64_C(0x10A1F5B813246653) },
+    { UINT64_C(0xB09B7068D6F0C2A3), UINT64_C(0x14CA732617ED7FE8) },
+    { UINT64_C(0xDCC24C830CACF34C), UINT64_C(0x19FD0FEF9DE8DFE2) },
+    { UINT64_C(0xC9F96FD1E7EC180F), UINT64_C(0x103E29F5C2B18BED) },
+    { UINT64_C(0x3C77CBC661E71E13), UINT64_C(0x144DB473335DEEE9) },
+    { UINT64_C(0x8B95BEB7FA60E598), UINT64_C(0x1961219000356AA3) },
+    { UINT64_C(0x6E7B2E65F8F91EFE), UINT64_C(0x1FB969F40042C54C) },
+    { UINT64_C(0xC50CFCFFBB9BB35F), UINT64_C(0x13D3E2388029BB4F) },
+    { UINT64_C(0xB6503C3FAA82A037), UINT64_C(0x18C8DAC6A0342A23) },
+    { UINT64_C(0xA3E44B4F95234844), UINT64_C(0x1EFB1178484134AC) },
+    { UINT64_C(0xE66EAF11BD360D2B), UINT64_C(0x135CEAEB2D28C0EB) },
+    { UINT64_C(0xE00A5AD62C839075), UINT64_C(0x183425A5F872F126) },
+    { UINT64_C(0x980CF18BB7A47493), UINT64_C(0x1E412F0F768FAD70) },
+    { UINT64_C(0x5F0816F752C6C8DC), UINT64_C(0x12E8BD69AA19CC66) },
+    { UINT64_C(0xF6CA1CB527787B13), UINT64_C(0x17A2ECC414A03F7F) },
+    { UINT64_C(0xF47CA3E2715699D7), UINT64_C(0x1D8BA7F519C84F5F) },
+    { UINT64_C(0xF8CDE66D86D62026), UINT64_C(0x127748F9301D319B) },
+    { UINT64_C(0xF7016008E88BA830), UINT64_C(0x17151B377C247E02) },
+    { UINT64_C(0xB4C1B80B22AE923C), UINT64_C(0x1CDA62055B2D9D83) },
+    { UINT64_C(0x50F91306F5AD1B65), UINT64_C(0x12087D4358FC8272) },
+    { UINT64_C(0xE53757C8B318623F), UINT64_C(0x168A9C942F3BA30E) },
+    { UINT64_C(0x9E852DBADFDE7ACF), UINT64_C(0x1C2D43B93B0A8BD2) },
+    { UINT64_C(0xA3133C94CBEB0CC1), UINT64_C(0x119C4A53C4E69763) },
+    { UINT64_C(0x8BD80BB9FEE5CFF1), UINT64_C(0x16035CE8B6203D3C) },
+    { UINT64_C(0xAECE0EA87E9F43EE), UINT64_C(0x1B843422E3A84C8B) },
+    { UINT64_C(0x4D40C9294F238A75), UINT64_C(0x1132A095CE492FD7) },
+    { UINT64_C(0x2090FB73A2EC6D12), UINT64_C(0x157F48BB41DB7BCD) },
+    { UINT64_C(0x68B53A508BA78856), UINT64_C(0x1ADF1AEA12525AC0) },
+    { UINT64_C(0x417144725748B536), UINT64_C(0x10CB70D24B7378B8) },
+    { UINT64_C(0x51CD958EED1AE283), UINT64_C(0x14FE4D06DE5056E6) },
+    { UINT64_C(0xE640FAF2A8619B24), UINT64_C(0x1A3DE04895E46C9F) },
+    { UINT64_C(0xEFE89CD7A93D00F7), UINT64_C(0x1066AC2D5DAEC3E3) },
+    { UINT64_C(0xEBE2C40D938C4134), UINT64_C(0x14805738B51A74DC) },
+    { UINT64_C(0x26DB7510F86F5181), UINT64_C(0x19A06D06E2611214) },
+    { UINT64_C(0x9849292A9B4592F1), UINT64_C(0x100444244D7CAB4C) },
+    { UINT64_C(0xBE5B73754216F7AD), UINT64_C(0x1405552D60DBD61F) },
+    { UINT64_C(0xADF25052929CB598), UINT64_C(0x1906AA78B912CBA7) },
+    { UINT64_C(0x996EE4673743E2FF), UINT64_C(0x1F485516E7577E91) },
+    { UINT64_C(0xFFE54EC0828A6DDF), UINT64_C(0x138D352E5096AF1A) },
+    { UINT64_C(0xBFDEA270A32D0957), UINT64_C(0x18708279E4BC5AE1) },
+    { UINT64_C(0x2FD64B0CCBF84BAD), UINT64_C(0x1E8CA3185DEB719A) },
+    { UINT64_C(0x5DE5EEE7FF7B2F4C), UINT64_C(0x1317E5EF3AB32700) },
+    { UINT64_C(0x755F6AA1FF59FB1F), UINT64_C(0x17DDDF6B095FF0C0) },
+    { UINT64_C(0x92B7454A7F3079E7), UINT64_C(0x1DD55745CBB7ECF0) },
+    { UINT64_C(0x5BB28B4E8F7E4C30), UINT64_C(0x12A5568B9F52F416) },
+    { UINT64_C(0xF29F2E22335DDF3C), UINT64_C(0x174EAC2E8727B11B) },
+    { UINT64_C(0xEF46F9AAC035570B), UINT64_C(0x1D22573A28F19D62) },
+    { UINT64_C(0xD58C5C0AB8215667), UINT64_C(0x123576845997025D) },
+    { UINT64_C(0x4AEF730D6629AC01), UINT64_C(0x16C2D4256FFCC2F5) },
+    { UINT64_C(0x9DAB4FD0BFB41701), UINT64_C(0x1C73892ECBFBF3B2) },
+    { UINT64_C(0xA28B11E277D08E60), UINT64_C(0x11C835BD3F7D784F) },
+    { UINT64_C(0x8B2DD65B15C4B1F9), UINT64_C(0x163A432C8F5CD663) },
+    { UINT64_C(0x6DF94BF1DB35DE77), UINT64_C(0x1BC8D3F7B3340BFC) },
+    { UINT64_C(0xC4BBCF772901AB0A), UINT64_C(0x115D847AD000877D) },
+    { UINT64_C(0x35EAC354F34215CD), UINT64_C(0x15B4E5998400A95D) },
+    { UINT64_C(0x8365742A30129B40), UINT64_C(0x1B221EFFE500D3B4) },
+    { UINT64_C(0xD21F689A5E0BA108), UINT64_C(0x10F5535FEF208450) },
+    { UINT64_C(0x06A742C0F58E894A), UINT64_C(0x1532A837EAE8A565) },
+    { UINT64_C(0x4851137132F22B9D), UINT64_C(0x1A7F5245E5A2CEBE) },
+    { UINT64_C(0xED32AC26BFD75B42), UINT64_C(0x108F936BAF85C136) },
+    { UINT64_C(0xA87F57306FCD3212), UINT64_C(0x14B378469B673184) },
+    { UINT64_C(0xD29F2CFC8BC07E97), UINT64_C(0x19E056584240FDE5) },
+    { UINT64_C(0xA3A37C1DD7584F1E), UINT64_C(0x102C35F729689EAF) },
+    { UINT64_C(0x8C8C5B254D2E62E6), UINT64_C(0x14374374F3C2C65B) },
+    { UINT64_C(0x6FAF71EEA079FB9F), UINT64_C(0x1945145230B377F2) },
+    { UINT64_C(0x0B9B4E6A48987A87), UINT64_C(0x1F965966BCE055EF) },
+    { UINT64_C(0x674111026D5F4C94), UINT64_C(0x13BDF7E0360C35B5) },
+    { UINT64_C(0xC111554308B71FBA), UINT64_C(0x18AD75D8438F4322) },
+    { UINT64_C(0x7155AA93CAE4E7A8), UINT64_C(0x1ED8D34E547313EB) },
+    { UINT64_C(0x26D58A9C5ECF10C9), UINT64_C(0x13478410F4C7EC73) },
+    { UINT64_C(0xF08AED437682D4FB), UINT64_C(0x1819651531F9E78F) },
+    { UINT64_C(0xECADA89454238A3A), UINT64_C(0x1E1FBE5A7E786173) },
+    { UINT64_C(0x73EC895CB4963664), UINT64_C(0x12D3D6F88F0B3CE8) },
+    { UINT64_C(0x90E7ABB3E1BBC3FD), UINT64_C(0x1788CCB6B2CE0C22) },
+    { UINT64_C(0x352196A0DA2AB4FD), UINT64_C(0x1D6AFFE45F818F2B) },
+    { UINT64_C(0x0134FE24885AB11E), UINT64_C(0x1262DFEEBBB0F97B) },
+    { UINT64_C(0xC1823DADAA715D65), UINT64_C(0x16FB97EA6A9D37D9) },
+    { UINT64_C(0x31E2CD19150DB4BF), UINT64_C(0x1CBA7DE5054485D0) },
+    { UINT64_C(0x1F2DC02FAD2890F7), UINT64_C(0x11F48EAF234AD3A2) },
+    { UINT64_C(0xA6F9303B9872B535), UINT64_C(0x1671B25AEC1D888A) },
+    { UINT64_C(0x50B77C4A7E8F6282), UINT64_C(0x1C0E1EF1A724EAAD) },
+    { UINT64_C(0x5272ADAE8F199D91), UINT64_C(0x1188D357087712AC) },
+    { UINT64_C(0x670F591A32E004F6), UINT64_C(0x15EB082CCA94D757) },
+    { UINT64_C(0x40D32F60BF980633), UINT64_C(0x1B65CA37FD3A0D2D) },
+    { UINT64_C(0x4883FD9C77BF03E0), UINT64_C(0x111F9E62FE44483C) },
+    { UINT64_C(0x5AA4FD0395AEC4D8), UINT64_C(0x156785FBBDD55A4B) },
+    { UINT64_C(0x314E3C447B1A760E), UINT64_C(0x1AC1677AAD4AB0DE) },
+    { UINT64_C(0xDED0E5AACCF089C9), UINT64_C(0x10B8E0ACAC4EAE8A) },
+    { UINT64_C(0x96851F15802CAC3B), UINT64_C(0x14E718D7D7625A2D) },
+    { UINT64_C(0xFC2666DAE037D74A), UINT64_C(0x1A20DF0DCD3AF0B8) },
+    { UINT64_C(0x9D980048CC22E68E), UINT64_C(0x10548B68A044D673) },
+    { UINT64_C(0x84FE005AFF2BA032), UINT64_C(0x1469AE42C8560C10) },
+    { UINT64_C(0xA63D8071BEF6883E), UINT64_C(0x198419D37A6B8F14) },
+    { UINT64_C(0xCFCCE08E2EB42A4E), UINT64_C(0x1FE52048590672D9) },
+    { UINT64_C(0x21E00C58DD309A70), UINT64_C(0x13EF342D37A407C8) },
+    { UINT64_C(0x2A580F6F147CC10D), UINT64_C(0x18EB0138858D09BA) },
+    { UINT64_C(0xB4EE134AD99BF150), UINT64_C(0x1F25C186A6F04C28) },
+    { UINT64_C(0x7114CC0EC80176D2), UINT64_C(0x137798F428562F99) },
+    { UINT64_C(0xCD59FF127A01D486), UINT64_C(0x18557F31326BBB7F) },
+    { UINT64_C(0xC0B07ED7188249A8), UINT64_C(0x1E6ADEFD7F06AA5F) },
+    { UINT64_C(0xD86E4F466F516E09), UINT64_C(0x1302CB5E6F642A7B) },
+    { UINT64_C(0xCE89E3180B25C98B), UINT64_C(0x17C37E360B3D351A) },
+    { UINT64_C(0x822C5BDE0DEF3BEE), UINT64_C(0x1DB45DC38E0C8261) },
+    { UINT64_C(0xF15BB96AC8B58575), UINT64_C(0x1290BA9A38C7D17C) },
+    { UINT64_C(0x2DB2A7C57AE2E6D2), UINT64_C(0x1734E940C6F9C5DC) },
+    { UINT64_C(0x391F51B6D99BA086), UINT64_C(0x1D022390F8B83753) },
+    { UINT64_C(0x03B3931248014454), UINT64_C(0x1221563A9B732294) },
+    { UINT64_C(0x04A077D6DA019569), UINT64_C(0x16A9ABC9424FEB39) },
+    { UINT64_C(0x45C895CC9081FAC3), UINT64_C(0x1C5416BB92E3E607) },
+    { UINT64_C(0x8B9D5D9FDA513CBA), UINT64_C(0x11B48E353BCE6FC4) },
+    { UINT64_C(0xAE84B507D0E58BE8), UINT64_C(0x1621B1C28AC20BB5) },
+    { UINT64_C(0x1A25E249C51EEEE3), UINT64_C(0x1BAA1E332D728EA3) },
+    { UINT64_C(0xF057AD6E1B33554D), UINT64_C(0x114A52DFFC679925) },
+    { UINT64_C(0x6C6D98C9A2002AA1), UINT64_C(0x159CE797FB817F6F) },
+    { UINT64_C(0x4788FEFC0A803549), UINT64_C(0x1B04217DFA61DF4B) },
+    { UINT64_C(0x0CB59F5D8690214E), UINT64_C(0x10E294EEBC7D2B8F) },
+    { UINT64_C(0xCFE30734E83429A1), UINT64_C(0x151B3A2A6B9C7672) },
+    { UINT64_C(0x83DBC9022241340A), UINT64_C(0x1A6208B50683940F) },
+    { UINT64_C(0xB2695DA15568C086), UINT64_C(0x107D457124123C89) },
+    { UINT64_C(0x1F03B509AAC2F0A7), UINT64_C(0x149C96CD6D16CBAC) },
+    { UINT64_C(0x26C4A24C1573ACD1), UINT64_C(0x19C3BC80C85C7E97) },
+    { UINT64_C(0x783AE56F8D684C03), UINT64_C(0x101A55D07D39CF1E) },
+    { UINT64_C(0x16499ECB70C25F03), UINT64_C(0x1420EB449C8842E6) },
+    { UINT64_C(0x9BDC067E4CF2F6C4), UINT64_C(0x19292615C3AA539F) },
+    { UINT64_C(0x82D3081DE02FB476), UINT64_C(0x1F736F9B3494E887) },
+    { UINT64_C(0xB1C3E512AC1DD0C9), UINT64_C(0x13A825C100DD1154) },
+    { UINT64_C(0xDE34DE57572544FC), UINT64_C(0x18922F31411455A9) },
+    { UINT64_C(0x55C215ED2CEE963B), UINT64_C(0x1EB6BAFD91596B14) },
+    { UINT64_C(0xB5994DB43C151DE5), UINT64_C(0x133234DE7AD7E2EC) },
+    { UINT64_C(0xE2FFA1214B1A655E), UINT64_C(0x17FEC216198DDBA7) },
+    { UINT64_C(0xDBBF89699DE0FEB6), UINT64_C(0x1DFE729B9FF15291) },
+    { UINT64_C(0x2957B5E202AC9F31), UINT64_C(0x12BF07A143F6D39B) },
+    { UINT64_C(0xF3ADA35A8357C6FE), UINT64_C(0x176EC98994F48881) },
+    { UINT64_C(0x70990C31242DB8BD), UINT64_C(0x1D4A7BEBFA31AAA2) },
+    { UINT64_C(0x865FA79EB69C9376), UINT64_C(0x124E8D737C5F0AA5) },
+    { UINT64_C(0xE7F791866443B854), UINT64_C(0x16E230D05B76CD4E) },
+    { UINT64_C(0xA1F575E7FD54A669), UINT64_C(0x1C9ABD04725480A2) },
+    { UINT64_C(0xA53969B0FE54E801), UINT64_C(0x11E0B622C774D065) },
+    { UINT64_C(0x0E87C41D3DEA2202), UINT64_C(0x1658E3AB7952047F) },
+    { UINT64_C(0xD229B5248D64AA82), UINT64_C(0x1BEF1C9657A6859E) },
+    { UINT64_C(0x435A1136D85EEA91), UINT64_C(0x117571DDF6C81383) },
+    { UINT64_C(0x143095848E76A536), UINT64_C(0x15D2CE55747A1864) },
+    { UINT64_C(0x193CBAE5B2144E83), UINT64_C(0x1B4781EAD1989E7D) },
+    { UINT64_C(0x2FC5F4CF8F4CB112), UINT64_C(0x110CB132C2FF630E) },
+    { UINT64_C(0xBBB77203731FDD56), UINT64_C(0x154FDD7F73BF3BD1) },
+    { UINT64_C(0x2AA54E844FE7D4AC), UINT64_C(0x1AA3D4DF50AF0AC6) },
+    { UINT64_C(0xDAA75112B1F0E4EB), UINT64_C(0x10A6650B926D66BB) },
+    { UINT64_C(0xD15125575E6D1E26), UINT64_C(0x14CFFE4E7708C06A) },
+    { UINT64_C(0x85A56EAD360865B0), UINT64_C(0x1A03FDE214CAF085) },
+    { UINT64_C(0x7387652C41C53F8E), UINT64_C(0x10427EAD4CFED653) },
+    { UINT64_C(0x50693E7752368F71), UINT64_C(0x14531E58A03E8BE8) },
+    { UINT64_C(0x64838E1526C4334E), UINT64_C(0x1967E5EEC84E2EE2) },
+    { UINT64_C(0xFDA4719A70754022), UINT64_C(0x1FC1DF6A7A61BA9A) },
+    { UINT64_C(0xDE86C70086494815), UINT64_C(0x13D92BA28C7D14A0) },
+    { UINT64_C(0x162878C0A7DB9A1A), UINT64_C(0x18CF768B2F9C59C9) },
+    { UINT64_C(0x5BB296F0D1D280A1), UINT64_C(0x1F03542DFB83703B) },
+    { UINT64_C(0x194F9E5683239064), UINT64_C(0x1362149CBD322625) },
+    { UINT64_C(0x5FA385EC23EC747E), UINT64_C(0x183A99C3EC7EAFAE) },
+    { UINT64_C(0xF78C67672CE7919D), UINT64_C(0x1E494034E79E5B99) },
+    { UINT64_C(0x3AB7C0A07C10BB02), UINT64_C(0x12EDC82110C2F940) },
+    { UINT64_C(0x4965B0C89B14E9C3), UINT64_C(0x17A93A2954F3B790) },
+    { UINT64_C(0x5BBF1CFAC1DA2433), UINT64_C(0x1D9388B3AA30A574) },
+    { UINT64_C(0xB957721CB92856A0), UINT64_C(0x127C35704A5E6768) },
+    { UINT64_C(0xE7AD4EA3E7726C48), UINT64_C(0x171B42CC5CF60142) },
+    { UINT64_C(0xA198A24CE14F075A), UINT64_C(0x1CE2137F74338193) },
+    { UINT64_C(0x44FF65700CD16498), UINT64_C(0x120D4C2FA8A030FC) },
+    { UINT64_C(0x563F3ECC1005BDBE), UINT64_C(0x16909F3B92C83D3B) },
+    { UINT64_C(0x2BCF0E7F14072D2E), UINT64_C(0x1C34C70A777A4C8A) },
+    { UINT64_C(0x5B61690F6C847C3D), UINT64_C(0x11A0FC668AAC6FD6) },
+    { UINT64_C(0xF239C35347A59B4C), UINT64_C(0x16093B802D578BCB) },
+    { UINT64_C(0xEEC83428198F021F), UINT64_C(0x1B8B8A6038AD6EBE) },
+    { UINT64_C(0x553D20990FF96153), UINT64_C(0x1137367C236C6537) },
+    { UINT64_C(0x2A8C68BF53F7B9A8), UINT64_C(0x1585041B2C477E85) },
+    { UINT64_C(0x752F82EF28F5A812), UINT64_C(0x1AE64521F7595E26) },
+    { UINT64_C(0x093DB1D57999890B), UINT64_C(0x10CFEB353A97DAD8) },
+    { UINT64_C(0x0B8D1E4AD7FFEB4E), UINT64_C(0x1503E602893DD18E) },
+    { UINT64_C(0x8E7065DD8DFFE622), UINT64_C(0x1A44DF832B8D45F1) },
+    { UINT64_C(0xF9063FAA78BFEFD5), UINT64_C(0x106B0BB1FB384BB6) },
+    { UINT64_C(0xB747CF9516EFEBCA), UINT64_C(0x1485CE9E7A065EA4) },
+    { UINT64_C(0xE519C37A5CABE6BD), UINT64_C(0x19A742461887F64D) },
+    { UINT64_C(0xAF301A2C79EB7036), UINT64_C(0x1008896BCF54F9F0) },
+    { UINT64_C(0xDAFC20B798664C43), UINT64_C(0x140AABC6C32A386C) },
+    { UINT64_C(0x11BB28E57E7FDF54), UINT64_C(0x190D56B873F4C688) },
+    { UINT64_C(0x1629F31EDE1FD72A), UINT64_C(0x1F50AC6690F1F82A) },
+    { UINT64_C(0x4DDA37F34AD3E67A), UINT64_C(0x13926BC01A973B1A) },
+    { UINT64_C(0xE150C5F01D88E019), UINT64_C(0x187706B0213D09E0) },
+    { UINT64_C(0x19A4F76C24EB181F), UINT64_C(0x1E94C85C298C4C59) },
+    { UINT64_C(0xB0071AA39712EF13), UINT64_C(0x131CFD3999F7AFB7) },
+    { UINT64_C(0x9C08E14C7CD7AAD8), UINT64_C(0x17E43C8800759BA5) },
+    { UINT64_C(0x030B199F9C0D958E), UINT64_C(0x1DDD4BAA0093028F) },
+    { UINT64_C(0x61E6F003C1887D79), UINT64_C(0x12AA4F4A405BE199) },
+    { UINT64_C(0xBA60AC04B1EA9CD7), UINT64_C(0x1754E31CD072D9FF) },
+    { UINT64_C(0xA8F8D705DE65440D), UINT64_C(0x1D2A1BE4048F907F) },
+    { UINT64_C(0xC99B8663AAFF4A88), UINT64_C(0x123A516E82D9BA4F) },
+    { UINT64_C(0xBC0267FC95BF1D2A), UINT64_C(0x16C8E5CA239028E3) },
+    { UINT64_C(0xAB0301FBBB2EE474), UINT64_C(0x1C7B1F3CAC74331C) },
+    { UINT64_C(0xEAE1E13D54FD4EC9), UINT64_C(0x11CCF385EBC89FF1) },
+    { UINT64_C(0x659A598CAA3CA27B), UINT64_C(0x1640306766BAC7EE) },
+    { UINT64_C(0xFF00EFEFD4CBCB1A), UINT64_C(0x1BD03C81406979E9) },
+    { UINT64_C(0x3F6095F5E4FF5EF0), UINT64_C(0x116225D0C841EC32) },
+    { UINT64_C(0xCF38BB735E3F36AC), UINT64_C(0x15BAAF44FA52673E) },
+    { UINT64_C(0x8306EA5035CF0457), UINT64_C(0x1B295B1638E7010E) },
+    { UINT64_C(0x11E4527221A162B6), UINT64_C(0x10F9D8EDE39060A9) },
+    { UINT64_C(0x565D670EAA09BB64), UINT64_C(0x15384F295C7478D3) },
+    { UINT64_C(0x2BF4C0D2548C2A3D), UINT64_C(0x1A8662F3B3919708) },
+    { UINT64_C(0x1B78F88374D79A66), UINT64_C(0x1093FDD8503AFE65) },
+    { UINT64_C(0x625736A4520D8100), UINT64_C(0x14B8FD4E6449BDFE) },
+    { UINT64_C(0xFAED044D6690E140), UINT64_C(0x19E73CA1FD5C2D7D) },
+    { UINT64_C(0xBCD422B0601A8CC8), UINT64_C(0x103085E53E599C6E) },
+    { UINT64_C(0x6C092B5C78212FFA), UINT64_C(0x143CA75E8DF0038A) },
+    { UINT64_C(0x070B763396297BF8), UINT64_C(0x194BD136316C046D) },
+    { UINT64_C(0x48CE53C07BB3DAF6), UINT64_C(0x1F9EC583BDC70588) },
+    { UINT64_C(0x2D80F4584D5068DA), UINT64_C(0x13C33B72569C6375) },
+    { UINT64_C(0x78E1316E60A48310), UINT64_C(0x18B40A4EEC437C52) }
+};
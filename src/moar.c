@@ -74,6 +74,24 @@ static FILE *fopen_perhaps_with_pid(char *env_var, char *path, const char *mode)
     exit(1);
 }
 
+/* Parses the value of a numeric environment variable, which must be a whole
+ * number from min to max. If it's not, we say so and use the default. */
+static MVMuint64 env_uint(const char *env_var, const char *value, MVMuint64 min,
+        MVMuint64 max, MVMuint64 dflt) {
+    char *end;
+    unsigned long long parsed;
+    if (!value || !value[0])
+        return dflt;
+    errno = 0;
+    parsed = strtoull(value, &end, 10);
+    if (value[0] == '-' || *end || errno || parsed < min || parsed > max) {
+        fprintf(stderr, "MoarVM: Ignoring `%s` given via `%s`: expected a whole number from %"PRIu64" to %"PRIu64"\n",
+            value, env_var, min, max);
+        return dflt;
+    }
+    return (MVMuint64)parsed;
+}
+
 MVM_STATIC_INLINE MVMuint64 ptr_hash_64_to_64(MVMuint64 u) {
     /* Thomas Wong's hash from
      * https://web.archive.org/web/20120211151329/http://www.concentric.net/~Ttwang/tech/inthash.htm */
@@ -93,16 +111,66 @@ MVMInstance * MVM_vm_create_instance(void) {
 
     char *spesh_log, *spesh_nodelay, *spesh_disable, *spesh_inline_disable,
          *spesh_osr_disable, *spesh_limit, *spesh_blocking, *spesh_inline_log,
-         *spesh_pea_disable;
+         *spesh_pea_disable, *spesh_licm_disable, *spesh_baseline_disable,
+         *spesh_closures_disable,
+         *spesh_workers,
+         *spesh_cache, *spesh_code_cache,
+         *spesh_server;
     char *jit_expr_disable, *jit_disable, *jit_last_frame, *jit_last_bb;
     char *dynvar_log;
     int init_stat;
+    MVMuint64 start_time = uv_hrtime(), phase_start;
 
     /* Set up instance data structure. */
     instance = MVM_calloc(1, sizeof(MVMInstance));
 
+    /* Should we report the time spent in the phases of starting up? */
+    {
+        char *startup_profile = getenv("MVM_STARTUP_PROFILE");
+        if (startup_profile && startup_profile[0])
+            instance->startup_profiling = 1;
+        instance->startup_time = start_time;
+    }
+
+    /* Work out the bounds on nursery sizes and where nurseries live, which
+     * the main thread's context needs right away. */
+    MVM_gc_configure_nursery_sizes(instance,
+        (MVMuint32)env_uint("MVM_GC_NURSERY_MIN", getenv("MVM_GC_NURSERY_MIN"), 0, 0xFFFFFFFF, 0),
+        (MVMuint32)env_uint("MVM_GC_NURSERY_MAX", getenv("MVM_GC_NURSERY_MAX"), 0, 0xFFFFFFFF, 0));
+    {
+        char *huge_pages = getenv("MVM_GC_HUGE_PAGES");
+        if (huge_pages && huge_pages[0])
+            instance->gc_huge_pages = 1;
+    }
+    {
+        char *numa_local = getenv("MVM_GC_NUMA_LOCAL");
+        if (numa_local && numa_local[0])
+            instance->gc_numa_local = 1;
+    }
+    {
+        char *pretenure = getenv("MVM_GC_PRETENURE");
+        if (pretenure && pretenure[0])
+            instance->gc_pretenure = 1;
+    }
+    {
+        char *alloc_sample = getenv("MVM_ALLOC_SAMPLE");
+        if (alloc_sample && alloc_sample[0])
+            instance->alloc_sample_interval = (MVMuint32)strtoul(alloc_sample, NULL, 10);
+    }
+    {
+        char *heap_snapshot_threaded = getenv("MVM_HEAPSNAPSHOT_THREADED");
+        if (heap_snapshot_threaded && heap_snapshot_threaded[0])
+            instance->heap_snapshot_threaded = 1;
+    }
+    {
+        char *cpu_sample = getenv("MVM_CPU_SAMPLE");
+        if (cpu_sample && cpu_sample[0])
+            instance->cpu_sample_interval = (MVMuint32)strtoul(cpu_sample, NULL, 10);
+    }
+
     /* Create the main thread's ThreadContext and stash it. */
     instance->main_thread = MVM_tc_create(NULL, instance);
+    MVM_tc_bind_numa_node(instance->main_thread);
 
     instance->subscriptions.vm_startup_hrtime = uv_hrtime();
     instance->subscriptions.vm_startup_now = MVM_proc_time_n(instance->main_thread);
@@ -136,10 +204,118 @@ MVMInstance * MVM_vm_create_instance(void) {
     init_cond(instance->cond_gc_completed, "GC completed");
     init_cond(instance->cond_gc_intrays_clearing, "GC intrays clearing");
     init_cond(instance->cond_blocked_can_continue, "GC thread unblock");
+    init_mutex(instance->mutex_gc_mark_pool, "GC shared mark work");
+    init_mutex(instance->mutex_gc_stats, "GC statistics");
+    init_mutex(instance->mutex_alloc_samples, "allocation samples");
+    init_mutex(instance->mutex_cpu_samples, "CPU samples");
+    {
+        char *parallel_mark = getenv("MVM_GC_PARALLEL_MARK");
+        if (parallel_mark && parallel_mark[0])
+            instance->gc_parallel_mark = 1;
+    }
+    {
+        char *threshold_percent = getenv("MVM_GC_GEN2_THRESHOLD_PERCENT");
+        char *threshold_minimum = getenv("MVM_GC_GEN2_THRESHOLD_MINIMUM");
+        char *target_time       = getenv("MVM_GC_TARGET_TIME_PERCENT");
+        instance->gc_gen2_threshold_percent = (MVMuint32)env_uint("MVM_GC_GEN2_THRESHOLD_PERCENT",
+            threshold_percent, 0, 0xFFFFFFFF, MVM_GC_GEN2_THRESHOLD_PERCENT);
+        instance->gc_gen2_threshold_minimum = env_uint("MVM_GC_GEN2_THRESHOLD_MINIMUM",
+            threshold_minimum, 0, UINT64_MAX, MVM_GC_GEN2_THRESHOLD_MINIMUM);
+        instance->gc_target_time_percent = (MVMuint32)env_uint("MVM_GC_TARGET_TIME_PERCENT",
+            target_time, 0, 100, 0);
+    }
+    {
+        char *release_pages = getenv("MVM_GC_GEN2_RELEASE_PAGES");
+        if (release_pages && release_pages[0])
+            instance->gc_gen2_release_pages = 1;
+    }
+    {
+        char *trim_interval = getenv("MVM_GC_TRIM_INTERVAL");
+        if (trim_interval && trim_interval[0])
+            instance->gc_trim_interval = strcmp(trim_interval, "off") == 0
+                ? -1
+                : (MVMint64)strtoll(trim_interval, NULL, 10);
+        else
+            instance->gc_trim_interval = MVM_GC_TRIM_INTERVAL;
+    }
+    {
+        char *release_idle = getenv("MVM_GC_RELEASE_IDLE_NURSERY");
+        if (release_idle && release_idle[0])
+            instance->gc_release_idle_nursery = 1;
+    }
+    {
+        char *lazy_sweep = getenv("MVM_GC_LAZY_SWEEP");
+        if (lazy_sweep && lazy_sweep[0])
+            instance->gc_lazy_sweep = 1;
+    }
+    {
+        char *weak_param = getenv("MVM_GC_WEAK_PARAMETERIZATIONS");
+        if (weak_param && weak_param[0])
+            instance->gc_weak_parameterizations = 1;
+    }
+    {
+        char *p6opaque_pack = getenv("MVM_P6OPAQUE_PACK");
+        if (p6opaque_pack && p6opaque_pack[0])
+            instance->p6opaque_pack = 1;
+    }
+    {
+        char *card_marking = getenv("MVM_GC_CARD_MARKING");
+        if (card_marking && card_marking[0])
+            instance->gc_card_marking = 1;
+    }
+    {
+        char *thread_local = getenv("MVM_GC_THREAD_LOCAL");
+        if (thread_local && thread_local[0])
+            instance->gc_thread_local = 1;
+    }
 
     /* Safe point free list. */
     init_mutex(instance->mutex_free_at_safepoint, "safepoint free list");
 
+    /* Pinned objects. */
+    init_mutex(instance->mutex_pinned, "pinned objects");
+
+    /* Objects waiting for the finalizer threads, if there are to be any. */
+    init_mutex(instance->mutex_finalize_pending, "finalizer queue");
+    init_cond(instance->cond_finalize_pending, "finalizer queue");
+    {
+        char *finalizer_threads = getenv("MVM_GC_FINALIZER_THREADS");
+        instance->num_finalizer_threads = (MVMuint32)env_uint("MVM_GC_FINALIZER_THREADS",
+            finalizer_threads, 0, 64, 0);
+    }
+
+    /* Serialization contexts waiting for the deserialization threads, if
+     * there are to be any. */
+    init_mutex(instance->mutex_deserialize_pending, "deserialization queue");
+    init_cond(instance->cond_deserialize_pending, "deserialization queue");
+    {
+        char *deserialize_threads = getenv("MVM_DESERIALIZE_THREADS");
+        instance->num_deserialize_threads = (MVMuint32)env_uint("MVM_DESERIALIZE_THREADS",
+            deserialize_threads, 0, 64, 0);
+    }
+
+    /* Where VM internal threads run, and at what priority. */
+    {
+        char *affinity = getenv("MVM_INTERNAL_THREAD_AFFINITY");
+        char *priority = getenv("MVM_INTERNAL_THREAD_PRIORITY");
+        if (affinity && affinity[0])
+            instance->internal_thread_affinity = MVM_thread_parse_cpu_list(affinity);
+        if (priority && priority[0]) {
+            int value = atoi(priority);
+            instance->internal_thread_priority = value < -20 ? -20 : value > 19 ? 19 : value;
+            instance->has_internal_thread_priority = 1;
+        }
+    }
+
+    /* The work-stealing scheduler; its workers start on first use. */
+    {
+        char *scheduler_workers = getenv("MVM_SCHEDULER_WORKERS");
+        instance->scheduler = MVM_scheduler_create(instance->main_thread,
+            scheduler_workers && scheduler_workers[0]
+                ? (MVMuint32)atoi(scheduler_workers)
+                : 0);
+    }
+
     /* Create fixed size allocator. */
     instance->fsa = MVM_fixed_size_create(instance->main_thread);
 
@@ -171,27 +347,65 @@ MVMInstance * MVM_vm_create_instance(void) {
     /* Set up loaded compunits hash mutex. */
     init_mutex(instance->mutex_loaded_compunits, "loaded compunits");
     MVM_fixkey_hash_build(instance->main_thread, &instance->loaded_compunits, sizeof(MVMString *));
+    MVM_VECTOR_INIT(instance->cu_bundles, 0);
+    {
+        char *trust_bundles = getenv("MVM_TRUST_BUNDLES");
+        if (trust_bundles && trust_bundles[0])
+            instance->trust_bundles = 1;
+    }
 
     /* Set up container registry mutex. */
     init_mutex(instance->mutex_container_registry, "container registry");
     MVM_str_hash_build(instance->main_thread, &instance->container_registry, sizeof(MVMContainerRegistry), 0);
 
-    /* Set up persistent object ID hash mutex. */
-    init_mutex(instance->mutex_object_ids, "object ID hash");
-    MVM_ptr_hash_build(instance->main_thread, &instance->object_ids);
+    /* Set up persistent object ID hash shards. */
+    {
+        MVMuint32 i;
+        for (i = 0; i < MVM_OBJECT_ID_SHARDS; i++) {
+            init_mutex(instance->object_id_shards[i].mutex, "object ID hash shard");
+            MVM_ptr_hash_build(instance->main_thread, &instance->object_id_shards[i].object_ids);
+        }
+    }
 
     /* Allocate all things during following setup steps directly in gen2, as
      * they will have program lifetime. */
     MVM_gc_allocate_gen2_default_set(instance->main_thread);
 
+#ifdef MVM_COMPACT_HEADERS
+    /* Set up the table objects find their STables in. */
+    init_mutex(instance->mutex_stable_index, "STable index");
+    instance->next_stable_index = 1;
+#endif
+
     /* Set up integer constant and string cache. */
     init_mutex(instance->mutex_int_const_cache, "int constant cache");
     instance->int_const_cache = MVM_calloc(1, sizeof(MVMIntConstCache));
+    {
+        char *intcache_min = getenv("MVM_INTCACHE_MIN");
+        char *intcache_max = getenv("MVM_INTCACHE_MAX");
+        MVMint64 min = MVM_INTCACHE_DEFAULT_MIN;
+        MVMint64 max = MVM_INTCACHE_DEFAULT_MAX;
+        if (intcache_min && intcache_min[0])
+            min = strtol(intcache_min, NULL, 10);
+        if (intcache_max && intcache_max[0])
+            max = strtol(intcache_max, NULL, 10);
+        if (min < -MVM_INTCACHE_LIMIT)
+            min = -MVM_INTCACHE_LIMIT;
+        if (max > MVM_INTCACHE_LIMIT)
+            max = MVM_INTCACHE_LIMIT;
+        if (max < min)
+            max = min;
+        instance->int_const_cache->min = min;
+        instance->int_const_cache->max = max;
+    }
     instance->int_to_str_cache = MVM_calloc(MVM_INT_TO_STR_CACHE_SIZE, sizeof(MVMString *));
 
     /* Initialize Unicode database and NFG. */
+    phase_start = MVM_startup_profile_start(instance);
     MVM_unicode_init(instance->main_thread);
     MVM_nfg_init(instance->main_thread);
+    if (instance->startup_profiling)
+        MVM_startup_profile_report(instance, "Unicode database and NFG init", NULL, phase_start);
 
     /* Bootstrap 6model. It is assumed the GC will not be called during this. */
     MVM_6model_bootstrap(instance->main_thread);
@@ -199,9 +413,32 @@ MVMInstance * MVM_vm_create_instance(void) {
     /* Set up main thread's last_payload. */
     instance->main_thread->last_payload = instance->VMNull;
 
-    /* Initialize event loop thread starting mutex. */
+    /* Initialize event loop thread starting mutex, and the event loops,
+     * which are only started when first needed. */
     init_mutex(instance->mutex_event_loop, "event loop thread start");
 
+    /* Host name resolution cache, off unless given a TTL in seconds. */
+    init_mutex(instance->mutex_dns_cache, "DNS cache");
+    {
+        char *dns_cache_ttl = getenv("MVM_DNS_CACHE_TTL");
+        if (dns_cache_ttl && atoi(dns_cache_ttl) > 0)
+            instance->dns_cache_ttl = (MVMuint64)atoi(dns_cache_ttl) * 1000000000ULL;
+    }
+    {
+        char *spawn_use_libuv = getenv("MVM_SPAWN_USE_LIBUV");
+        if (spawn_use_libuv && spawn_use_libuv[0])
+            instance->spawn_use_libuv = 1;
+    }
+    {
+        char *event_loops = getenv("MVM_EVENT_LOOPS");
+        MVMuint32 i;
+        instance->num_event_loops = (MVMuint32)env_uint("MVM_EVENT_LOOPS",
+            event_loops, 1, 64, 1);
+        instance->event_loops = MVM_calloc(instance->num_event_loops, sizeof(MVMEventLoop));
+        for (i = 0; i < instance->num_event_loops; i++)
+            MVM_io_read_buffer_pool_init(&instance->event_loops[i].read_buffers);
+    }
+
     /* Create main thread object, and also make it the start of the all threads
      * linked list. Set up the mutex to protect it. */
     instance->threads = instance->main_thread->thread_obj = (MVMThread *)
@@ -212,6 +449,12 @@ MVMInstance * MVM_vm_create_instance(void) {
     instance->threads->body.native_thread_id = MVM_platform_thread_id();
     instance->threads->body.thread_id = instance->main_thread->thread_id;
     init_mutex(instance->mutex_threads, "threads list");
+    if ((init_stat = uv_key_create(&instance->native_thread_tc)) < 0) {
+        fprintf(stderr, "MoarVM: Initialization of thread context key failed\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+    uv_key_set(&instance->native_thread_tc, instance->main_thread);
 
     /* Create compiler registry */
     instance->compiler_registry = MVM_repr_alloc_init(instance->main_thread, instance->boot_types.BOOTHash);
@@ -229,6 +472,10 @@ MVMInstance * MVM_vm_create_instance(void) {
     instance->callsite_interns = MVM_calloc(1, sizeof(MVMCallsiteInterns));
     init_mutex(instance->mutex_callsite_interns, "callsite interns");
 
+    /* Create compilation unit string intern table. */
+    instance->cu_string_interns = MVM_calloc(1, sizeof(MVMCUStringInterns));
+    init_mutex(instance->mutex_cu_string_interns, "compunit string interns");
+
     /* There's some callsites we statically use all over the place. Intern
      * them, so that spesh may end up optimizing more "internal" stuff. */
     MVM_callsite_initialize_common(instance->main_thread);
@@ -259,6 +506,15 @@ MVMInstance * MVM_vm_create_instance(void) {
         spesh_pea_disable = getenv("MVM_SPESH_PEA_DISABLE");
         if (!spesh_pea_disable || !spesh_pea_disable[0])
             instance->spesh_pea_enabled = 1;
+        spesh_licm_disable = getenv("MVM_SPESH_LICM_DISABLE");
+        if (!spesh_licm_disable || !spesh_licm_disable[0])
+            instance->spesh_licm_enabled = 1;
+        spesh_baseline_disable = getenv("MVM_SPESH_BASELINE_DISABLE");
+        if (!spesh_baseline_disable || !spesh_baseline_disable[0])
+            instance->spesh_baseline_enabled = 1;
+        spesh_closures_disable = getenv("MVM_SPESH_CLOSURES_DISABLE");
+        if (!spesh_closures_disable || !spesh_closures_disable[0])
+            instance->spesh_closures_enabled = 1;
     }
 
     init_mutex(instance->mutex_parameterization_add, "parameterization");
@@ -270,12 +526,40 @@ MVMInstance * MVM_vm_create_instance(void) {
         instance->spesh_nodelay = 1;
     }
 
+    /* Should we tune the specialization thresholds for a long-lived process,
+     * waiting longer on rarely called frames? */
+    spesh_server = getenv("MVM_SPESH_SERVER");
+    if (spesh_server && spesh_server[0])
+        instance->spesh_server = 1;
+
     /* Should we limit the number of specialized frames produced? (This is
      * mostly useful for building spesh bug bisect tools.) */
     spesh_limit = getenv("MVM_SPESH_LIMIT");
     if (spesh_limit && spesh_limit[0])
         instance->spesh_limit = atoi(spesh_limit);
 
+    /* Should we remember the specializations we produce in a file, and
+     * produce those remembered from earlier runs without waiting to see the
+     * frames get hot? */
+    spesh_cache = getenv("MVM_SPESH_CACHE");
+    if (instance->spesh_enabled && spesh_cache && spesh_cache[0])
+        instance->spesh_cache = MVM_spesh_cache_open(instance->main_thread, spesh_cache);
+
+    /* Should we also keep the specialized code itself, for each comp unit,
+     * in a directory, and install it rather than specializing again? */
+    spesh_code_cache = getenv("MVM_SPESH_CODE_CACHE");
+    if (instance->spesh_enabled && spesh_code_cache && spesh_code_cache[0])
+        instance->spesh_code_cache_dir = strdup(spesh_code_cache);
+
+    /* How many threads should produce specializations? The spesh thread is
+     * one of those; the rest are helpers it shares out its plans with. */
+    spesh_workers = getenv("MVM_SPESH_WORKERS");
+    if (spesh_workers && spesh_workers[0]) {
+        MVMint32 workers = atoi(spesh_workers);
+        if (workers > 1)
+            instance->num_spesh_helpers = workers > 64 ? 63 : workers - 1;
+    }
+
     /* Should we enforce that a thread, when sending work to the specialzation
      * worker, block until the specialization worker is done? This is useful
      * for getting more predictable behavior when debugging. */
@@ -288,6 +572,28 @@ MVMInstance * MVM_vm_create_instance(void) {
     if (spesh_inline_log && spesh_inline_log[0])
         instance->spesh_inline_log = 1;
 
+    /* Should we report where deopts happened at exit? */
+    {
+        char *deopt_report = getenv("MVM_SPESH_DEOPT_REPORT");
+        if (deopt_report && deopt_report[0])
+            instance->spesh_deopt_report = 1;
+    }
+
+    /* Should we profile lock contention? */
+    {
+        char *lock_profile = getenv("MVM_LOCK_PROFILE");
+        if (lock_profile && lock_profile[0])
+            instance->lock_profiling = 1;
+    }
+    init_mutex(instance->mutex_lock_contention, "lock contention");
+
+    /* JIT code heap and the queue of JIT code to free once unused. */
+    init_mutex(instance->mutex_jit_code_heap, "JIT code heap");
+    init_mutex(instance->mutex_jit_code_discarded, "discarded JIT code");
+    init_mutex(instance->mutex_deopting_candidates, "deopting candidates");
+    init_mutex(instance->mutex_coverage_counters, "coverage counters");
+    init_mutex(instance->mutex_jit_perf, "JIT perf and GDB output");
+
     /* JIT environment/logging setup. */
     jit_disable = getenv("MVM_JIT_DISABLE");
     if (!jit_disable || !jit_disable[0])
@@ -298,6 +604,20 @@ MVMInstance * MVM_vm_create_instance(void) {
         instance->jit_expr_enabled = 1;
 
 
+    {
+        char *jit_partial_disable = getenv("MVM_JIT_PARTIAL_DISABLE");
+        if (!jit_partial_disable || !jit_partial_disable[0])
+            instance->jit_partial_enabled = 1;
+    }
+
+    {
+        char *jit_bail_stats = getenv("MVM_JIT_BAIL_STATS");
+        if (jit_bail_stats && jit_bail_stats[0]) {
+            instance->jit_bail_counts      = MVM_calloc(MVM_OP_EXT_BASE, sizeof(AO_t));
+            instance->jit_interp_op_counts = MVM_calloc(MVM_OP_EXT_BASE, sizeof(AO_t));
+        }
+    }
+
     {
         char *jit_debug = getenv("MVM_JIT_DEBUG");
         if (jit_debug && jit_debug[0])
@@ -314,6 +634,16 @@ MVMInstance * MVM_vm_create_instance(void) {
             instance->jit_perf_map = MVM_platform_fopen(perf_map_filename, "w");
         }
     }
+    {
+        char *jit_perf_dump = getenv("MVM_JIT_PERF_DUMP");
+        if (jit_perf_dump && *jit_perf_dump)
+            MVM_jit_perf_dump_open(instance, jit_perf_dump);
+    }
+    {
+        char *jit_gdb = getenv("MVM_JIT_GDB");
+        if (jit_gdb && *jit_gdb)
+            instance->jit_gdb_enabled = 1;
+    }
 #endif
 
     {
@@ -374,6 +704,9 @@ MVMInstance * MVM_vm_create_instance(void) {
     /* Spesh thread syncing. */
     init_mutex(instance->mutex_spesh_sync, "spesh sync");
     init_cond(instance->cond_spesh_sync, "spesh sync");
+    init_mutex(instance->mutex_spesh_helpers, "spesh helpers");
+    init_cond(instance->cond_spesh_helpers_work, "spesh helpers work");
+    init_cond(instance->cond_spesh_helpers_done, "spesh helpers done");
 
     /* Various kinds of debugging that can be enabled. */
     dynvar_log = getenv("MVM_DYNVAR_LOG");
@@ -413,6 +746,18 @@ MVMInstance * MVM_vm_create_instance(void) {
             if (coverage_control && coverage_control[0])
                 instance->coverage_control = atoi(coverage_control);
         }
+
+        instance->coverage_counting = 0;
+        {
+            char *coverage_format = getenv("MVM_COVERAGE_FORMAT");
+            if (coverage_format && coverage_format[0]) {
+                if (strcmp(coverage_format, "lcov") == 0)
+                    instance->coverage_counting = 1;
+                else if (strcmp(coverage_format, "text") != 0)
+                    fprintf(stderr, "MoarVM: unknown MVM_COVERAGE_FORMAT '%s', using text\n",
+                        coverage_format);
+            }
+        }
     }
     else {
         instance->coverage_logging = 0;
@@ -425,11 +770,23 @@ MVMInstance * MVM_vm_create_instance(void) {
     MVM_spesh_worker_start(instance->main_thread);
     MVM_spesh_log_initialize_thread(instance->main_thread, 1);
 
+    /* Start any finalizer threads that were asked for. */
+    MVM_finalize_start_threads(instance->main_thread);
+
+    /* Start the CPU sampling timer, if it's enabled. */
+    MVM_profile_cpu_sampling_start(instance);
+
+    /* And any deserialization threads. */
+    MVM_serialization_start_threads(instance->main_thread);
+
     /* Back to nursery allocation, now we're set up. */
     MVM_gc_allocate_gen2_default_clear(instance->main_thread);
 
     init_mutex(instance->subscriptions.mutex_event_subscription, "vm event subscription mutex");
 
+    if (instance->startup_profiling)
+        MVM_startup_profile_report(instance, "create instance", NULL, start_time);
+
     return instance;
 }
 
@@ -461,9 +818,12 @@ static void toplevel_initial_invoke(MVMThreadContext *tc, void *data) {
 static void run_deserialization_frame(MVMThreadContext *tc, MVMCompUnit *cu) {
     if (cu->body.deserialize_frame) {
         MVMint8 spesh_enabled_orig = tc->instance->spesh_enabled;
+        MVMuint64 start = MVM_startup_profile_start(tc->instance);
         tc->instance->spesh_enabled = 0;
         MVM_interp_run(tc, toplevel_initial_invoke, cu->body.deserialize_frame, NULL);
         tc->instance->spesh_enabled = spesh_enabled_orig;
+        if (tc->instance->startup_profiling)
+            MVM_startup_profile_report(tc->instance, "run deserialization frame", NULL, start);
     }
 }
 
@@ -483,6 +843,8 @@ void MVM_vm_run_file(MVMInstance *instance, const char *filename) {
     run_deserialization_frame(tc, cu);
 
     /* Run the entry-point frame. */
+    if (instance->startup_profiling)
+        MVM_startup_profile_report(instance, "enter main frame", filename, instance->startup_time);
     MVM_interp_run(tc, toplevel_initial_invoke, cu->body.main_frame, NULL);
 }
 
@@ -562,6 +924,20 @@ void MVM_vm_dump_file(MVMInstance *instance, const char *filename) {
     MVM_free(dump);
 }
 
+/* Prints how often the JIT gave up on a frame, or left an instruction to the
+ * interpreter, for each op. */
+static void report_jit_bail_stats(MVMInstance *instance) {
+    MVMuint32 i;
+    fprintf(stderr, "JIT bails by op (frames not compiled, instructions interpreted):\n");
+    for (i = 0; i < MVM_OP_EXT_BASE; i++) {
+        MVMuint64 bails  = instance->jit_bail_counts[i];
+        MVMuint64 interp = instance->jit_interp_op_counts[i];
+        if (bails || interp)
+            fprintf(stderr, "  %-24s %10"PRIu64" %10"PRIu64"\n",
+                    MVM_op_get_op(i)->name, bails, interp);
+    }
+}
+
 /* Exits the process as quickly as is gracefully possible, respecting that
  * foreground threads should join first. Leaves all cleanup to the OS, as it
  * will be able to do it much more swiftly than we could. This is typically
@@ -574,6 +950,17 @@ void MVM_vm_exit(MVMInstance *instance) {
     /* Close any spesh or jit log. */
     if (instance->spesh_log_fh)
         fclose(instance->spesh_log_fh);
+    if (instance->jit_bail_counts)
+        report_jit_bail_stats(instance);
+    if (instance->spesh_deopt_report)
+        MVM_spesh_deopt_report(instance->main_thread, stderr);
+    if (instance->coverage_counting)
+        MVM_line_coverage_dump_counts(instance->main_thread);
+    if (instance->lock_profiling)
+        MVM_lock_contention_report(instance->main_thread, stderr);
+    if (instance->spesh_cache)
+        MVM_spesh_cache_destroy(instance->main_thread, instance->spesh_cache);
+    MVM_free(instance->spesh_code_cache_dir);
     if (instance->dynvar_log_fh) {
         fprintf(instance->dynvar_log_fh, "- x 0 0 0 0 %"PRId64" %"PRIu64" %"PRIu64"\n", instance->dynvar_log_lasttime, uv_hrtime(), uv_hrtime());
         fclose(instance->dynvar_log_fh);
@@ -621,7 +1008,17 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     /* Stop system threads */
     MVM_spesh_worker_stop(instance->main_thread);
     MVM_spesh_worker_join(instance->main_thread);
+    MVM_finalize_stop_threads(instance->main_thread);
+    MVM_scheduler_halt(instance->main_thread);
+    MVM_serialization_stop_threads(instance->main_thread);
     MVM_io_eventloop_destroy(instance->main_thread);
+    MVM_profile_cpu_sampling_stop(instance);
+    if (instance->spesh_deopt_report)
+        MVM_spesh_deopt_report(instance->main_thread, stderr);
+    if (instance->coverage_counting)
+        MVM_line_coverage_dump_counts(instance->main_thread);
+    if (instance->lock_profiling)
+        MVM_lock_contention_report(instance->main_thread, stderr);
 
     /* Run the normal GC one more time to actually collect the spesh thread */
     MVM_gc_enter_from_allocator(instance->main_thread);
@@ -644,12 +1041,29 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     uv_cond_destroy(&instance->cond_gc_finish);
     uv_cond_destroy(&instance->cond_gc_intrays_clearing);
     uv_cond_destroy(&instance->cond_blocked_can_continue);
+    uv_mutex_destroy(&instance->mutex_gc_mark_pool);
+    uv_mutex_destroy(&instance->mutex_gc_stats);
+    uv_mutex_destroy(&instance->mutex_alloc_samples);
     uv_mutex_destroy(&instance->mutex_gc_orchestrate);
 
     /* Clean up safepoint free vector. */
     MVM_VECTOR_DESTROY(instance->free_at_safepoint);
     uv_mutex_destroy(&instance->mutex_free_at_safepoint);
 
+    MVM_VECTOR_DESTROY(instance->pinned);
+    uv_mutex_destroy(&instance->mutex_pinned);
+    MVM_scheduler_destroy(instance->main_thread);
+    if (instance->finalizer_pool)
+        MVM_worker_pool_destroy(instance->finalizer_pool);
+    MVM_VECTOR_DESTROY(instance->finalize_pending);
+    uv_mutex_destroy(&instance->mutex_finalize_pending);
+    uv_cond_destroy(&instance->cond_finalize_pending);
+    if (instance->deserialize_pool)
+        MVM_worker_pool_destroy(instance->deserialize_pool);
+    MVM_VECTOR_DESTROY(instance->deserialize_pending);
+    uv_mutex_destroy(&instance->mutex_deserialize_pending);
+    uv_cond_destroy(&instance->cond_deserialize_pending);
+
     /* Clean up Hash of HLLConfig. */
     uv_mutex_destroy(&instance->mutex_hllconfigs);
     MVM_fixkey_hash_demolish(instance->main_thread, &instance->compiler_hll_configs);
@@ -688,6 +1102,12 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     /* Clean up multi cache addition mutex. */
     uv_mutex_destroy(&instance->mutex_multi_cache_add);
 
+#ifdef MVM_COMPACT_HEADERS
+    /* Clean up the STable index table. */
+    uv_mutex_destroy(&instance->mutex_stable_index);
+    MVM_6model_stable_index_destroy(instance);
+#endif
+
     /* Clean up parameterization addition mutex. */
     uv_mutex_destroy(&instance->mutex_parameterization_add);
 
@@ -695,6 +1115,13 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     uv_mutex_destroy(&instance->mutex_callsite_interns);
     cleanup_callsite_interns(instance);
 
+    /* Clean up interned compilation unit strings. */
+    uv_mutex_destroy(&instance->mutex_cu_string_interns);
+    MVM_cu_string_interns_destroy(instance);
+
+    /* Unmap bundles of compilation units. */
+    MVM_cu_bundles_destroy(instance);
+
     /* Release this interpreter's hold on Unicode database */
     MVM_unicode_release(instance->main_thread);
 
@@ -702,10 +1129,15 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     uv_mutex_destroy(&instance->mutex_spesh_install);
     uv_cond_destroy(&instance->cond_spesh_sync);
     uv_mutex_destroy(&instance->mutex_spesh_sync);
+    uv_cond_destroy(&instance->cond_spesh_helpers_done);
+    uv_cond_destroy(&instance->cond_spesh_helpers_work);
+    uv_mutex_destroy(&instance->mutex_spesh_helpers);
+    MVM_free(instance->spesh_helpers);
     if (instance->spesh_log_fh)
         fclose(instance->spesh_log_fh);
     if (instance->jit_perf_map)
         fclose(instance->jit_perf_map);
+    MVM_jit_perf_dump_close(instance);
     if (instance->dynvar_log_fh)
         fclose(instance->dynvar_log_fh);
     if (instance->jit_bytecode_dir)
@@ -713,11 +1145,29 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     if (instance->jit_breakpoints) {
         MVM_VECTOR_DESTROY(instance->jit_breakpoints);
     }
+    if (instance->jit_bail_counts) {
+        report_jit_bail_stats(instance);
+        MVM_free(instance->jit_bail_counts);
+        MVM_free(instance->jit_interp_op_counts);
+    }
+    MVM_jit_code_heap_destroy(instance);
+    uv_mutex_destroy(&instance->mutex_jit_code_heap);
+    uv_mutex_destroy(&instance->mutex_jit_code_discarded);
+    uv_mutex_destroy(&instance->mutex_deopting_candidates);
+    uv_mutex_destroy(&instance->mutex_jit_perf);
 
 
     /* Clean up cross-thread-write-logging mutex */
     uv_mutex_destroy(&instance->mutex_cross_thread_write_logging);
 
+    /* Clean up coverage counters. */
+    MVM_line_coverage_destroy_counts(instance->main_thread);
+    uv_mutex_destroy(&instance->mutex_coverage_counters);
+
+    /* Clean up lock contention counts. */
+    MVM_lock_contention_destroy(instance);
+    uv_mutex_destroy(&instance->mutex_lock_contention);
+
     /* Clean up NFG. */
     uv_mutex_destroy(&instance->nfg->update_mutex);
     MVM_nfg_destroy(instance->main_thread);
@@ -725,15 +1175,28 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
 
     /* Clean up integer constant and string cache. */
     uv_mutex_destroy(&instance->mutex_int_const_cache);
-    MVM_free(instance->int_const_cache);
+    MVM_intcache_destroy(instance->main_thread, instance->int_const_cache);
     MVM_free(instance->int_to_str_cache);
 
-    /* Clean up event loop mutex. */
+    /* Clean up the host name resolution cache. */
+    MVM_io_dns_cache_destroy(instance);
+
+    /* Clean up event loop mutex and state. */
     uv_mutex_destroy(&instance->mutex_event_loop);
+    {
+        MVMuint32 i;
+        for (i = 0; i < instance->num_event_loops; i++)
+            MVM_io_read_buffer_pool_destroy(&instance->event_loops[i].read_buffers);
+    }
+    MVM_free(instance->event_loops);
+
+    MVM_free(instance->internal_thread_affinity);
 
     /* Destroy main thread contexts and thread list mutex. */
     MVM_tc_destroy(instance->main_thread);
     uv_mutex_destroy(&instance->mutex_threads);
+    uv_key_delete(&instance->native_thread_tc);
+    uv_mutex_destroy(&instance->mutex_cpu_samples);
 
     /* Clean up fixed size allocator */
     MVM_fixed_size_destroy(instance->fsa);
@@ -775,6 +1238,7 @@ void MVM_vm_event_subscription_configure(MVMThreadContext *tc, MVMObject *queue,
 
         if (REPR(queue)->ID == MVM_REPR_ID_ConcBlockingQueue && IS_CONCRETE(queue)) {
             tc->instance->subscriptions.subscription_queue = queue;
+            MVM_gc_note_escape(tc);
         }
 
         gcevent = MVM_string_utf8_decode(tc, tc->instance->VMString, "gcevent", 7);
@@ -96,6 +96,9 @@ typedef double   MVMnum64;
 #define HASH_DEBUG_ITER 0
 #define MVM_HASH_RANDOMIZE 1
 #define MVM_HASH_MAX_PROBE_DISTANCE 255
+#ifndef MVM_HASH_SINGLE_ALLOCATION
+#define MVM_HASH_SINGLE_ALLOCATION 0
+#endif
 
 typedef MVMuint32 MVMHashNumItems;
 typedef MVMuint64 MVMHashv;
@@ -127,6 +130,8 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "core/bytecodedump.h"
 #include "core/ops.h"
 #include "core/threads.h"
+#include "core/scheduler.h"
+#include "core/fiber.h"
 #include "core/hll.h"
 #include "core/loadbytecode.h"
 #include "core/bitmap.h"
@@ -160,6 +165,8 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "spesh/dump.h"
 #include "spesh/debug.h"
 #include "spesh/pea.h"
+#include "spesh/licm.h"
+#include "spesh/range.h"
 #include "spesh/graph.h"
 #include "spesh/codegen.h"
 #include "spesh/candidate.h"
@@ -180,6 +187,7 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "spesh/worker.h"
 #include "spesh/stats.h"
 #include "spesh/plan.h"
+#include "spesh/cache.h"
 #include "spesh/arg_guard.h"
 #include "spesh/plugin.h"
 #include "spesh/frame_walker.h"
@@ -195,6 +203,7 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "strings/ops.h"
 #include "core/fixedsizealloc.h"
 #include "io/procops.h"
+#include "core/hash_table_storage.h"
 #include "core/str_hash_table_funcs.h"
 #include "core/fixkey_hash_table_funcs.h"
 #include "core/index_hash_table_funcs.h"
@@ -229,7 +238,9 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "jit/register.h"
 #include "jit/tile.h"
 #include "jit/compile.h"
+#include "jit/code_heap.h"
 #include "jit/dump.h"
+#include "jit/perf.h"
 #include "jit/interface.h"
 #include "profiler/instrument.h"
 #include "profiler/log.h"
@@ -237,6 +248,10 @@ MVM_PUBLIC MVMint32 MVM_jit_support(void);
 #include "profiler/heapsnapshot.h"
 #include "profiler/telemeh.h"
 #include "profiler/configuration.h"
+#include "profiler/sampling.h"
+#include "profiler/vmstats.h"
+#include "profiler/contention.h"
+#include "profiler/startup.h"
 #include "instrument/crossthreadwrite.h"
 #include "instrument/line_coverage.h"
 
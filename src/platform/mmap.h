@@ -2,8 +2,23 @@
 #define MVM_PAGE_WRITE   2
 #define MVM_PAGE_EXEC    4
 
+/* A hint that the pages should be backed by huge pages, if the platform can.
+ * Sizes given along with it should be a multiple of the huge page size. */
+#define MVM_PAGE_HUGE    8
+#define MVM_PLATFORM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* The smallest page size of any platform we run on, which sizes of memory to
+ * be bound to a NUMA node are rounded up to. */
+#define MVM_PLATFORM_MIN_PAGE_SIZE 4096
+
 void *MVM_platform_alloc_pages(size_t size, int mode);
 int MVM_platform_set_page_mode(void * block, size_t size, int mode);
 int MVM_platform_free_pages(void *block, size_t size);
+void *MVM_platform_reserve_pages(size_t size);
+int MVM_platform_commit_pages(void *block, size_t size, int mode);
 void *MVM_platform_map_file(int fd, void **handle, size_t size, int writable);
 int MVM_platform_unmap_file(void *block, void *handle, size_t size);
+void *MVM_platform_map_file_private(int fd, unsigned long long offset, size_t size, size_t *skip);
+int MVM_platform_numa_node(void);
+void MVM_platform_bind_pages_to_node(void *block, size_t size, int node);
+void MVM_platform_zero_pages(void *block, size_t size);
@@ -3,6 +3,10 @@
 #include "moar.h"
 #include "platform/mmap.h"
 #include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 /* MAP_ANONYMOUS is Linux, MAP_ANON is BSD */
 #ifndef MVM_MAP_ANON
@@ -41,11 +45,24 @@ static int page_mode_to_prot_mode(int page_mode) {
 
 void *MVM_platform_alloc_pages(size_t size, int page_mode)
 {
-    int prot_mode = page_mode_to_prot_mode(page_mode);
-    void *block = mmap(NULL, size, prot_mode, MVM_MAP_ANON | MAP_PRIVATE, -1, 0);
+    int prot_mode = page_mode_to_prot_mode(page_mode & ~MVM_PAGE_HUGE);
+    void *block = MAP_FAILED;
 
-    if (block == MAP_FAILED)
-        MVM_panic(1, "MVM_platform_alloc_pages failed: %d", errno);
+    /* Explicit huge pages need reserving by the administrator, so if there
+     * are none to be had, fall back to asking for transparent ones. */
+#ifdef MAP_HUGETLB
+    if (page_mode & MVM_PAGE_HUGE)
+        block = mmap(NULL, size, prot_mode, MVM_MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+#endif
+    if (block == MAP_FAILED) {
+        block = mmap(NULL, size, prot_mode, MVM_MAP_ANON | MAP_PRIVATE, -1, 0);
+        if (block == MAP_FAILED)
+            MVM_panic(1, "MVM_platform_alloc_pages failed: %d", errno);
+#ifdef MADV_HUGEPAGE
+        if (page_mode & MVM_PAGE_HUGE)
+            madvise(block, size, MADV_HUGEPAGE);
+#endif
+    }
 
     return block;
 }
@@ -60,6 +77,27 @@ int MVM_platform_free_pages(void *block, size_t size)
     return munmap(block, size) == 0;
 }
 
+/* Reserves address space without making any of it accessible; parts of it
+ * are then committed with MVM_platform_commit_pages. Memory is only backed
+ * once it is touched anyway, but inaccessible pages fault if something runs
+ * off the end of what was committed. */
+void *MVM_platform_reserve_pages(size_t size)
+{
+#ifdef MAP_NORESERVE
+    void *block = mmap(NULL, size, PROT_NONE, MVM_MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+#else
+    void *block = mmap(NULL, size, PROT_NONE, MVM_MAP_ANON | MAP_PRIVATE, -1, 0);
+#endif
+    if (block == MAP_FAILED)
+        MVM_panic(1, "MVM_platform_reserve_pages failed: %d", errno);
+    return block;
+}
+
+int MVM_platform_commit_pages(void *block, size_t size, int page_mode)
+{
+    return mprotect(block, size, page_mode_to_prot_mode(page_mode)) == 0;
+}
+
 void *MVM_platform_map_file(int fd, void **handle, size_t size, int writable)
 {
     void *block = mmap(NULL, size,
@@ -75,3 +113,77 @@ int MVM_platform_unmap_file(void *block, void *handle, size_t size)
     (void)handle;
     return munmap(block, size) == 0;
 }
+
+/* Maps size bytes of a file from offset as private memory, which may be
+ * written to without that reaching the file. Mappings start on a page
+ * boundary, so *skip is set to how far into the mapping the data at offset
+ * is; unmap it with a size of *skip + size. */
+void *MVM_platform_map_file_private(int fd, unsigned long long offset, size_t size, size_t *skip)
+{
+    unsigned long long page_size = (unsigned long long)sysconf(_SC_PAGESIZE);
+    unsigned long long aligned   = offset - offset % page_size;
+    void *block;
+
+    *skip = (size_t)(offset - aligned);
+    block = mmap(NULL, *skip + size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        fd, (off_t)aligned);
+    if (block == MAP_FAILED)
+        return NULL;
+#ifdef MADV_SEQUENTIAL
+    /* Big chunks read from a file are mostly worked through in order, so
+     * read ahead aggressively and drop pages behind. */
+    madvise(block, *skip + size, MADV_SEQUENTIAL);
+#endif
+    return block;
+}
+
+/* Returns the NUMA node of the CPU we're running on, or -1 if that can't be
+ * found out. */
+int MVM_platform_numa_node(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+        return (int)node;
+#endif
+    return -1;
+}
+
+/* Asks for the memory in a mapping to come from the given NUMA node when it
+ * is first touched, if possible. This is only a preference, so it's fine if
+ * the node runs out of memory, or if this isn't supported at all. */
+#define MVM_MPOL_PREFERRED 1
+void MVM_platform_bind_pages_to_node(void *block, size_t size, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long nodemask[16] = { 0 };
+    size_t bits_per_word = sizeof(unsigned long) * 8;
+    if (node < 0 || (size_t)node >= sizeof(nodemask) * 8)
+        return;
+    nodemask[node / bits_per_word] = 1UL << (node % bits_per_word);
+    /* The kernel takes one less than maxnode bits of the mask. */
+    syscall(SYS_mbind, block, size, MVM_MPOL_PREFERRED, nodemask,
+        sizeof(nodemask) * 8 + 1, 0);
+#else
+    (void)block; (void)size; (void)node;
+#endif
+}
+
+/* Zeroes memory, handing the whole pages in it back to the kernel rather than
+ * writing to them, so they stop counting towards the resident set until they
+ * are next touched. Only for anonymous private memory, which the kernel gives
+ * back zeroed. */
+void MVM_platform_zero_pages(void *block, size_t size)
+{
+#ifdef MADV_DONTNEED
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    char *start      = (char *)(((uintptr_t)block + page_size - 1) & ~(uintptr_t)(page_size - 1));
+    char *end        = (char *)(((uintptr_t)block + size) & ~(uintptr_t)(page_size - 1));
+    if (start < end && madvise(start, end - start, MADV_DONTNEED) == 0) {
+        memset(block, 0, start - (char *)block);
+        memset(end, 0, (char *)block + size - end);
+        return;
+    }
+#endif
+    memset(block, 0, size);
+}
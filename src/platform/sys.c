@@ -1,5 +1,10 @@
 #include "moar.h"
 #include "platform/sys.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#endif
 
 MVMint64 MVM_platform_cpu_count(void) {
     int            count;
@@ -58,3 +63,41 @@ MVMObject * MVM_platform_uname(MVMThreadContext *tc) {
 
     return result;
 }
+
+int MVM_platform_thread_set_affinity(const MVMuint64 *mask, size_t words) {
+#if defined(_WIN32)
+    /* Outside of processor groups only the first 64 CPUs are reachable. */
+    DWORD_PTR win_mask = (DWORD_PTR)mask[0];
+    return win_mask && SetThreadAffinityMask(GetCurrentThread(), win_mask) != 0;
+#elif defined(__linux__) && defined(SYS_sched_setaffinity)
+    /* The kernel wants a mask of longs; build one so the bits end up in the
+     * right places whatever their size and the byte order. */
+    unsigned long cpus[1024 / (sizeof(unsigned long) * 8)] = { 0 };
+    size_t bits_per_long = sizeof(unsigned long) * 8;
+    size_t i;
+    for (i = 0; i < words * 64 && i < sizeof(cpus) * 8; i++)
+        if (mask[i / 64] & ((MVMuint64)1 << (i % 64)))
+            cpus[i / bits_per_long] |= 1UL << (i % bits_per_long);
+    return syscall(SYS_sched_setaffinity, 0, sizeof(cpus), cpus) == 0;
+#else
+    (void)mask; (void)words;
+    return 0;
+#endif
+}
+
+int MVM_platform_thread_set_priority(MVMint32 priority) {
+#if defined(_WIN32)
+    int win_priority = priority <= -15 ? THREAD_PRIORITY_HIGHEST
+                     : priority <= -5  ? THREAD_PRIORITY_ABOVE_NORMAL
+                     : priority < 5    ? THREAD_PRIORITY_NORMAL
+                     : priority < 15   ? THREAD_PRIORITY_BELOW_NORMAL
+                     :                   THREAD_PRIORITY_LOWEST;
+    return SetThreadPriority(GetCurrentThread(), win_priority) != 0;
+#elif defined(__linux__) && defined(SYS_gettid)
+    /* On Linux, the nice value is per thread. */
+    return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), priority) == 0;
+#else
+    (void)priority;
+    return 0;
+#endif
+}
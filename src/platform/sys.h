@@ -5,3 +5,9 @@ MVMint64   MVM_platform_cpu_count(void);
 MVMint64   MVM_platform_free_memory(void);
 MVMint64   MVM_platform_total_memory(void);
 MVMObject* MVM_platform_uname(MVMThreadContext *tc);
+
+/* Pin the calling thread to the CPUs in a mask of the given number of 64 bit
+ * words, and set its priority (as a nice value, from -20 for the highest to
+ * 19 for the lowest). Both return zero if it could not be done. */
+int MVM_platform_thread_set_affinity(const MVMuint64 *mask, size_t words);
+int MVM_platform_thread_set_priority(MVMint32 priority);
@@ -22,7 +22,9 @@ static int page_mode_to_prot_mode(int page_mode) {
 }
 
 void *MVM_platform_alloc_pages(size_t size, int page_mode) {
-    int prot_mode = page_mode_to_prot_mode(page_mode);
+    /* Large pages need a privilege that we can't count on having, so the
+     * huge page hint is ignored. */
+    int prot_mode = page_mode_to_prot_mode(page_mode & ~MVM_PAGE_HUGE);
     void * allocd = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, prot_mode);
     if (!allocd)
         MVM_panic(1, "MVM_platform_alloc_pages failed: %d", GetLastError());
@@ -40,6 +42,17 @@ int MVM_platform_free_pages(void *pages, size_t size) {
     return VirtualFree(pages, 0, MEM_RELEASE);
 }
 
+void *MVM_platform_reserve_pages(size_t size) {
+    void * allocd = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+    if (!allocd)
+        MVM_panic(1, "MVM_platform_reserve_pages failed: %d", GetLastError());
+    return allocd;
+}
+
+int MVM_platform_commit_pages(void *pages, size_t size, int page_mode) {
+    return VirtualAlloc(pages, size, MEM_COMMIT, page_mode_to_prot_mode(page_mode)) != NULL;
+}
+
 void *MVM_platform_map_file(int fd, void **handle, size_t size, int writable) {
     HANDLE fh, mapping;
     LARGE_INTEGER li;
@@ -79,3 +92,50 @@ int MVM_platform_unmap_file(void *block, void *handle, size_t size) {
     (void)size;
     return unmapped && closed;
 }
+
+/* Maps size bytes of a file from offset as copy-on-write memory. Views
+ * start on an allocation granularity boundary, so *skip is set to how far
+ * into the view the data at offset is. */
+void *MVM_platform_map_file_private(int fd, unsigned long long offset, size_t size, size_t *skip) {
+    SYSTEM_INFO info;
+    HANDLE fh, mapping;
+    LARGE_INTEGER li;
+    unsigned long long aligned;
+    void *block;
+
+    GetSystemInfo(&info);
+    aligned = offset - offset % info.dwAllocationGranularity;
+    *skip = (size_t)(offset - aligned);
+
+    fh = (HANDLE)_get_osfhandle(fd);
+    if (fh == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    mapping = CreateFileMapping(fh, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping == NULL)
+        return NULL;
+
+    li.QuadPart = aligned;
+    block = MapViewOfFile(mapping, FILE_MAP_COPY, li.HighPart, li.LowPart,
+        *skip + size);
+
+    /* The view keeps the mapping alive, so it can be unmapped alone. */
+    CloseHandle(mapping);
+    return block;
+}
+
+/* Memory can only be put on a given NUMA node when it is allocated on this
+ * platform, so we don't claim to know what node we are on. */
+int MVM_platform_numa_node(void) {
+    return -1;
+}
+
+void MVM_platform_bind_pages_to_node(void *block, size_t size, int node) {
+    (void)block; (void)size; (void)node;
+}
+
+/* Pages can only be discarded here if they came from VirtualAlloc, which
+ * isn't known of the memory passed, so this just zeroes it. */
+void MVM_platform_zero_pages(void *block, size_t size) {
+    memset(block, 0, size);
+}
@@ -0,0 +1,173 @@
+#include "moar.h"
+
+/* The number of locks the report at exit lists. */
+#define REPORT_TOP 50
+
+/* Finds the entry for a lock, acquired from the given frame, in a table,
+ * making one if there is none yet. Returns NULL if the table is too full to
+ * take another. */
+static MVMLockContentionEntry * find_entry(MVMLockContention *lc, const void *lock,
+        const char *kind, MVMStaticFrame *sf) {
+    MVMuint64 hash = ((MVMuint64)(uintptr_t)lock >> 3) * UINT64_C(0x9E3779B97F4A7C15);
+    MVMuint32 idx  = (MVMuint32)(hash >> 32) % MVM_LOCK_CONTENTION_TABLE_SIZE;
+    while (1) {
+        MVMLockContentionEntry *entry = &lc->entries[idx];
+        if (!entry->lock) {
+            if (lc->used >= MVM_LOCK_CONTENTION_TABLE_SIZE / 4 * 3)
+                return NULL;
+            lc->used++;
+            entry->kind = kind;
+            entry->sf   = sf;
+            entry->lock = lock;
+            return entry;
+        }
+        if (entry->lock == lock && entry->sf == sf && entry->kind == kind)
+            return entry;
+        idx = (idx + 1) % MVM_LOCK_CONTENTION_TABLE_SIZE;
+    }
+}
+
+/* Adds the counts of one entry into the matching one of a table. */
+static void merge_entry(MVMLockContention *lc, const MVMLockContentionEntry *from) {
+    MVMLockContentionEntry *entry = find_entry(lc, from->lock, from->kind, from->sf);
+    if (!entry) {
+        lc->dropped += from->acquires;
+        return;
+    }
+    entry->acquires  += from->acquires;
+    entry->contended += from->contended;
+    entry->wait_time += from->wait_time;
+    if (from->max_wait > entry->max_wait)
+        entry->max_wait = from->max_wait;
+}
+
+/* Counts an acquisition of a lock by the current thread, which may have had
+ * to wait for it. Must not be called while the thread is marked blocked. */
+void MVM_lock_contention_log(MVMThreadContext *tc, const void *lock, const char *kind,
+        MVMStaticFrame *sf, MVMuint64 wait_time, MVMuint32 contended) {
+    MVMLockContentionEntry *entry;
+    if (!tc->lock_contention)
+        tc->lock_contention = MVM_calloc(1, sizeof(MVMLockContention));
+    entry = find_entry(tc->lock_contention, lock, kind, sf);
+    if (!entry) {
+        tc->lock_contention->dropped++;
+        return;
+    }
+    entry->acquires++;
+    if (contended) {
+        entry->contended++;
+        entry->wait_time += wait_time;
+        if (wait_time > entry->max_wait)
+            entry->max_wait = wait_time;
+    }
+}
+
+/* Takes an internal mutex, timing the wait if it's already held. */
+void MVM_lock_contention_lock_profiled(MVMThreadContext *tc, uv_mutex_t *mutex, const char *kind) {
+    MVMuint64 start;
+    if (uv_mutex_trylock(mutex) == 0) {
+        MVM_lock_contention_log(tc, mutex, kind, NULL, 0, 0);
+        return;
+    }
+    start = uv_hrtime();
+    uv_mutex_lock(mutex);
+    MVM_lock_contention_log(tc, mutex, kind, NULL, uv_hrtime() - start, 1);
+}
+
+/* Called when a thread is destroyed; keeps its counts in the table for the
+ * threads that have gone, so they still make it into the report. */
+void MVM_lock_contention_thread_done(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    MVMLockContention *lc = tc->lock_contention;
+    MVMuint32 i;
+    if (!lc)
+        return;
+    uv_mutex_lock(&instance->mutex_lock_contention);
+    if (!instance->lock_contention_exited)
+        instance->lock_contention_exited = MVM_calloc(1, sizeof(MVMLockContention));
+    for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++)
+        if (lc->entries[i].lock)
+            merge_entry(instance->lock_contention_exited, &lc->entries[i]);
+    instance->lock_contention_exited->dropped += lc->dropped;
+    tc->lock_contention = NULL;
+    uv_mutex_unlock(&instance->mutex_lock_contention);
+    MVM_free(lc);
+}
+
+static int compare_wait_time(const void *a, const void *b) {
+    const MVMLockContentionEntry *ea = (const MVMLockContentionEntry *)a;
+    const MVMLockContentionEntry *eb = (const MVMLockContentionEntry *)b;
+    return ea->wait_time < eb->wait_time ? 1 : ea->wait_time > eb->wait_time ? -1
+         : ea->acquires < eb->acquires ? 1 : ea->acquires > eb->acquires ? -1 : 0;
+}
+
+/* Writes the locks waited on the longest by all threads, living or gone, to
+ * the given file. Living threads' tables are read as they are being
+ * updated, so the figures may be a little off. */
+void MVM_lock_contention_report(MVMThreadContext *tc, FILE *out) {
+    MVMInstance *instance = tc->instance;
+    MVMLockContention *all = MVM_calloc(1, sizeof(MVMLockContention));
+    MVMLockContentionEntry *sorted;
+    MVMThread *thread;
+    MVMuint32 i, num = 0;
+
+    uv_mutex_lock(&instance->mutex_lock_contention);
+    if (instance->lock_contention_exited) {
+        for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++)
+            if (instance->lock_contention_exited->entries[i].lock)
+                merge_entry(all, &instance->lock_contention_exited->entries[i]);
+        all->dropped += instance->lock_contention_exited->dropped;
+    }
+    uv_mutex_lock(&instance->mutex_threads);
+    for (thread = instance->threads; thread; thread = thread->body.next) {
+        MVMThreadContext *thread_tc = thread->body.tc;
+        MVMLockContention *lc = thread_tc ? thread_tc->lock_contention : NULL;
+        if (!lc)
+            continue;
+        for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++)
+            if (lc->entries[i].lock)
+                merge_entry(all, &lc->entries[i]);
+        all->dropped += lc->dropped;
+    }
+    uv_mutex_unlock(&instance->mutex_threads);
+    uv_mutex_unlock(&instance->mutex_lock_contention);
+
+    sorted = MVM_malloc(MVM_LOCK_CONTENTION_TABLE_SIZE * sizeof(MVMLockContentionEntry));
+    for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++)
+        if (all->entries[i].lock)
+            sorted[num++] = all->entries[i];
+    qsort(sorted, num, sizeof(MVMLockContentionEntry), compare_wait_time);
+
+    fprintf(out, "Lock contention (%"PRIu32" locks, top %d by time waited):\n",
+        num, REPORT_TOP);
+    fprintf(out, "  %12s %12s %12s %12s  %s\n",
+        "wait (ms)", "max (ms)", "acquires", "contended", "lock");
+    for (i = 0; i < num && i < REPORT_TOP; i++) {
+        MVMLockContentionEntry *entry = &sorted[i];
+        fprintf(out, "  %12.3f %12.3f %12"PRIu64" %12"PRIu64"  %s %p",
+            entry->wait_time / 1e6, entry->max_wait / 1e6,
+            entry->acquires, entry->contended, entry->kind, entry->lock);
+        if (entry->sf) {
+            char *name = MVM_string_utf8_encode_C_string(tc, entry->sf->body.name);
+            char *file = entry->sf->body.cu->body.filename
+                ? MVM_string_utf8_encode_C_string(tc, entry->sf->body.cu->body.filename)
+                : NULL;
+            fprintf(out, " in %s (%s)", name[0] ? name : "<anon>", file ? file : "<unknown>");
+            MVM_free(name);
+            MVM_free(file);
+        }
+        fputc('\n', out);
+    }
+    if (all->dropped)
+        fprintf(out, "  (%"PRIu64" acquisitions not counted, as the tables were full)\n",
+            all->dropped);
+
+    MVM_free(sorted);
+    MVM_free(all);
+}
+
+/* Frees the table of the threads that have gone. */
+void MVM_lock_contention_destroy(MVMInstance *instance) {
+    MVM_free(instance->lock_contention_exited);
+    instance->lock_contention_exited = NULL;
+}
@@ -0,0 +1,49 @@
+/* Lock contention profiling, switched on by MVM_LOCK_PROFILE. Acquisitions
+ * of HLL locks (ReentrantMutex and the locks of ConcBlockingQueue) and of
+ * some hot internal mutexes are counted against the lock and, for the HLL
+ * ones, the static frame acquiring it, along with how many had to wait and
+ * how long for. */
+struct MVMLockContentionEntry {
+    /* The lock, which is only used for its identity, and what it is. A NULL
+     * lock means the entry is unused. */
+    const void *lock;
+    const char *kind;
+
+    /* The frame that acquired the lock, for HLL locks. */
+    MVMStaticFrame *sf;
+
+    /* Acquisitions, those that had to wait, and the total and longest wait
+     * (in nanoseconds). */
+    MVMuint64 acquires;
+    MVMuint64 contended;
+    MVMuint64 wait_time;
+    MVMuint64 max_wait;
+};
+
+/* The entries are kept in a fixed size open addressing table per thread,
+ * hashed on the lock alone, since the frames may be moved by the GC. Only
+ * the thread itself writes to it; it is never resized, so it's safe for the
+ * report to read it while the thread is running. Entries that don't fit are
+ * only counted. */
+#define MVM_LOCK_CONTENTION_TABLE_SIZE 1024
+struct MVMLockContention {
+    MVMLockContentionEntry entries[MVM_LOCK_CONTENTION_TABLE_SIZE];
+    MVMuint32 used;
+    MVMuint64 dropped;
+};
+
+void MVM_lock_contention_log(MVMThreadContext *tc, const void *lock, const char *kind,
+    MVMStaticFrame *sf, MVMuint64 wait_time, MVMuint32 contended);
+void MVM_lock_contention_lock_profiled(MVMThreadContext *tc, uv_mutex_t *mutex, const char *kind);
+void MVM_lock_contention_thread_done(MVMThreadContext *tc);
+void MVM_lock_contention_report(MVMThreadContext *tc, FILE *out);
+void MVM_lock_contention_destroy(MVMInstance *instance);
+
+/* Takes an internal mutex, counting it when profiling lock contention. */
+MVM_STATIC_INLINE void MVM_lock_contention_lock(MVMThreadContext *tc, uv_mutex_t *mutex,
+        const char *kind) {
+    if (tc->instance->lock_profiling)
+        MVM_lock_contention_lock_profiled(tc, mutex, kind);
+    else
+        uv_mutex_lock(mutex);
+}
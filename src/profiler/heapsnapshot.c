@@ -31,6 +31,9 @@ typedef int (gzFile);
 #ifndef MAX
     #define MAX(x, y) ((y) > (x) ? (y) : (x))
 #endif
+#ifndef MIN
+    #define MIN(x, y) ((y) < (x) ? (y) : (x))
+#endif
 /* Check if we're currently taking heap snapshots. */
 MVMint32 MVM_profile_heap_profiling(MVMThreadContext *tc) {
     return tc->instance->heap_snapshots != NULL;
@@ -39,13 +42,14 @@ MVMint32 MVM_profile_heap_profiling(MVMThreadContext *tc) {
 static void filemeta_to_filehandle_ver3(MVMThreadContext *tc, MVMHeapSnapshotCollection *col);
 static void snapmeta_to_filehandle_ver3(MVMThreadContext *tc, MVMHeapSnapshotCollection *col);
 
-/* Start heap profiling. */
-void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config) {
+/* Start heap profiling, either taking full snapshots or just a census. */
+static void heap_start(MVMThreadContext *tc, MVMObject *config, MVMuint8 census) {
     MVMHeapSnapshotCollection *col = MVM_calloc(1, sizeof(MVMHeapSnapshotCollection));
     char *path;
     MVMString *path_str;
 
     col->start_time = uv_hrtime();
+    col->census = census;
 
     path_str = MVM_repr_get_str(tc,
         MVM_repr_at_key_o(tc, config, tc->instance->str_consts.path));
@@ -66,6 +70,11 @@ void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config) {
     }
     MVM_free(path);
 
+    if (census) {
+        tc->instance->heap_snapshots = col;
+        return;
+    }
+
     fprintf(col->fh, "MoarHeapDumpv00%d", MVM_HEAPSNAPSHOT_FORMAT);
 
     {
@@ -86,6 +95,12 @@ void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config) {
 
     tc->instance->heap_snapshots = col;
 }
+void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config) {
+    heap_start(tc, config, 0);
+}
+void MVM_profile_heap_census_start(MVMThreadContext *tc, MVMObject *config) {
+    heap_start(tc, config, 1);
+}
 
 /* Grows storage if it's full, zeroing the extension. Assumes it's only being
  * grown for one more item. */
@@ -175,15 +190,197 @@ static void set_ref_from(MVMThreadContext *tc, MVMHeapSnapshotState *ss, MVMuint
     ss->hs->collectables[col_idx].refs_start = ss->hs->num_references;
 }
 
+#if MVM_HEAPSNAPSHOT_FORMAT == 3
+/* The references make up the bulk of a snapshot, so rather than holding all
+ * of them until the snapshot is written, they are compressed in chunks as
+ * they are added, into a temporary file per column. Writing the snapshot
+ * then copies those into place, giving the same output as compressing them
+ * all at once. Optionally the compression is done by a helper thread, while
+ * the next chunk is being filled. */
+#define REF_STREAM_CHUNK    65536
+#define REF_STREAM_COLUMNS  2
+
+struct MVMHeapSnapshotRefStream {
+    /* Compression stream and temporary file for each column. */
+    ZSTD_CStream *cstreams[REF_STREAM_COLUMNS];
+    FILE *files[REF_STREAM_COLUMNS];
+
+    /* Buffers for gathering a column of a chunk and compressing it. */
+    MVMuint64 *column;
+    char *out_buffer;
+    size_t out_size;
+
+    /* If using a helper thread, the chunk it is compressing (if any) and
+     * the one we'll fill next; the mutex and condition variable protect
+     * these and the done flag, which tells the helper to finish up. */
+    MVMuint8 threaded;
+    MVMuint8 done;
+    MVMHeapSnapshotReference *pending;
+    MVMuint64 num_pending;
+    MVMHeapSnapshotReference *spare;
+    uv_thread_t thread;
+    uv_mutex_t mutex;
+    uv_cond_t cond;
+};
+
+static void ref_stream_write(MVMHeapSnapshotRefStream *rs, MVMuint32 c, ZSTD_inBuffer *inbuf) {
+    size_t return_value;
+    do {
+        ZSTD_outBuffer outbuf;
+        outbuf.dst  = rs->out_buffer;
+        outbuf.pos  = 0;
+        outbuf.size = rs->out_size;
+        if (inbuf)
+            return_value = ZSTD_compressStream(rs->cstreams[c], &outbuf, inbuf);
+        else
+            return_value = ZSTD_endStream(rs->cstreams[c], &outbuf);
+        if (ZSTD_isError(return_value))
+            MVM_panic(1, "ZSTD compression error in heap snapshot: %s", ZSTD_getErrorName(return_value));
+        if (outbuf.pos && fwrite(outbuf.dst, 1, outbuf.pos, rs->files[c]) != outbuf.pos)
+            MVM_panic(1, "Could not write heap snapshot references: %s", strerror(errno));
+    } while (inbuf ? inbuf->pos < inbuf->size : return_value != 0);
+}
+
+static void ref_stream_compress(MVMHeapSnapshotRefStream *rs, MVMHeapSnapshotReference *refs, MVMuint64 num) {
+    MVMuint32 c;
+    for (c = 0; c < REF_STREAM_COLUMNS; c++) {
+        ZSTD_inBuffer inbuf;
+        MVMuint64 i;
+        for (i = 0; i < num; i++)
+            rs->column[i] = c == 0 ? refs[i].description : refs[i].collectable_index;
+        inbuf.src  = rs->column;
+        inbuf.pos  = 0;
+        inbuf.size = num * sizeof(MVMuint64);
+        ref_stream_write(rs, c, &inbuf);
+    }
+}
+
+static void ref_stream_helper(void *data) {
+    MVMHeapSnapshotRefStream *rs = (MVMHeapSnapshotRefStream *)data;
+    uv_mutex_lock(&rs->mutex);
+    while (1) {
+        MVMHeapSnapshotReference *refs;
+        while (!rs->pending && !rs->done)
+            uv_cond_wait(&rs->cond, &rs->mutex);
+        if (!rs->pending)
+            break;
+        refs = rs->pending;
+        uv_mutex_unlock(&rs->mutex);
+        ref_stream_compress(rs, refs, rs->num_pending);
+        uv_mutex_lock(&rs->mutex);
+        rs->spare   = refs;
+        rs->pending = NULL;
+        uv_cond_broadcast(&rs->cond);
+    }
+    uv_mutex_unlock(&rs->mutex);
+}
+
+static void ref_stream_destroy(MVMHeapSnapshotRefStream *rs) {
+    MVMuint32 c;
+    for (c = 0; c < REF_STREAM_COLUMNS; c++) {
+        if (rs->cstreams[c])
+            ZSTD_freeCStream(rs->cstreams[c]);
+        if (rs->files[c])
+            fclose(rs->files[c]);
+    }
+    MVM_free(rs->column);
+    MVM_free(rs->out_buffer);
+    MVM_free(rs->spare);
+    MVM_free(rs);
+}
+
+/* Sets up streaming of a snapshot's references. If we can't get temporary
+ * files, we just keep them all in memory instead. */
+static void ref_stream_start(MVMThreadContext *tc, MVMHeapSnapshot *hs) {
+    MVMHeapSnapshotRefStream *rs = MVM_calloc(1, sizeof(MVMHeapSnapshotRefStream));
+    MVMuint32 c;
+    for (c = 0; c < REF_STREAM_COLUMNS; c++) {
+        size_t return_value;
+        rs->files[c] = tmpfile();
+        if (!rs->files[c]) {
+            ref_stream_destroy(rs);
+            return;
+        }
+        rs->cstreams[c] = ZSTD_createCStream();
+        if (ZSTD_isError(return_value = ZSTD_initCStream(rs->cstreams[c], ZSTD_COMPRESSION_VALUE)))
+            MVM_panic(1, "ZSTD compression error in heap snapshot: %s", ZSTD_getErrorName(return_value));
+    }
+    rs->column     = MVM_malloc(REF_STREAM_CHUNK * sizeof(MVMuint64));
+    rs->out_size   = ZSTD_CStreamOutSize();
+    rs->out_buffer = MVM_malloc(rs->out_size);
+    if (tc->instance->heap_snapshot_threaded) {
+        rs->spare = MVM_malloc(REF_STREAM_CHUNK * sizeof(MVMHeapSnapshotReference));
+        uv_mutex_init(&rs->mutex);
+        uv_cond_init(&rs->cond);
+        if (uv_thread_create(&rs->thread, ref_stream_helper, rs) == 0) {
+            rs->threaded = 1;
+        }
+        else {
+            uv_mutex_destroy(&rs->mutex);
+            uv_cond_destroy(&rs->cond);
+        }
+    }
+    hs->references       = MVM_realloc(hs->references, REF_STREAM_CHUNK * sizeof(MVMHeapSnapshotReference));
+    hs->alloc_references = REF_STREAM_CHUNK;
+    hs->ref_stream       = rs;
+}
+
+/* Streams out the references currently buffered in the snapshot. */
+static void ref_stream_flush(MVMThreadContext *tc, MVMHeapSnapshot *hs) {
+    MVMHeapSnapshotRefStream *rs = hs->ref_stream;
+    MVMuint64 num = hs->num_references - hs->references_flushed;
+    if (rs->threaded) {
+        uv_mutex_lock(&rs->mutex);
+        while (rs->pending)
+            uv_cond_wait(&rs->cond, &rs->mutex);
+        rs->pending     = hs->references;
+        rs->num_pending = num;
+        hs->references  = rs->spare;
+        rs->spare       = NULL;
+        uv_cond_broadcast(&rs->cond);
+        uv_mutex_unlock(&rs->mutex);
+    }
+    else {
+        ref_stream_compress(rs, hs->references, num);
+    }
+    hs->references_flushed = hs->num_references;
+}
+
+/* Waits for the helper thread, if any, to be done with all the chunks, and
+ * shuts it down. */
+static void ref_stream_stop_helper(MVMHeapSnapshotRefStream *rs) {
+    if (rs->threaded) {
+        uv_mutex_lock(&rs->mutex);
+        rs->done = 1;
+        uv_cond_broadcast(&rs->cond);
+        uv_mutex_unlock(&rs->mutex);
+        uv_thread_join(&rs->thread);
+        uv_mutex_destroy(&rs->mutex);
+        uv_cond_destroy(&rs->cond);
+        rs->threaded = 0;
+    }
+}
+#endif
+
 /* Adds a reference. */
 static void add_reference(MVMThreadContext *tc, MVMHeapSnapshotState *ss, MVMuint16 ref_kind,
                           MVMuint64 index, MVMuint64 to) {
-    /* Add to the references collection. */
+    /* Add to the references collection, streaming out those we have so far
+     * if the buffer is full. */
     MVMHeapSnapshotReference *ref;
     MVMuint64 description = (index << MVM_SNAPSHOT_REF_KIND_BITS) | ref_kind;
-    grow_storage(&(ss->hs->references), &(ss->hs->num_references),
+    MVMuint64 buffered = ss->hs->num_references - ss->hs->references_flushed;
+    if (ss->col->census)
+        return;
+#if MVM_HEAPSNAPSHOT_FORMAT == 3
+    if (ss->hs->ref_stream && buffered == REF_STREAM_CHUNK) {
+        ref_stream_flush(tc, ss->hs);
+        buffered = 0;
+    }
+#endif
+    grow_storage(&(ss->hs->references), &buffered,
         &(ss->hs->alloc_references), sizeof(MVMHeapSnapshotReference));
-    ref = &(ss->hs->references[ss->hs->num_references]);
+    ref = &(ss->hs->references[buffered]);
     ref->description = description;
     ref->collectable_index = to;
     ss->hs->num_references++;
@@ -268,7 +465,9 @@ static MVMuint64 get_collectable_idx(MVMThreadContext *tc,
         idx = push_workitem(tc, ss, MVM_SNAPSHOT_COL_KIND_TYPE_OBJECT, collectable);
         ss->col->total_typeobjects++;
     }
-    else if (collectable->flags1 & MVM_CF_FRAME) {
+    else if (collectable->flags1 & MVM_CF_FRAME || !collectable->owner) {
+        /* No owner means a frame on the call stack, that a local closure
+         * refers to as its outer. */
         idx = push_workitem(tc, ss, MVM_SNAPSHOT_COL_KIND_FRAME, collectable);
         ss->col->total_frames++;
     }
@@ -408,7 +607,7 @@ static void process_collectable(MVMThreadContext *tc, MVMHeapSnapshotState *ss,
         add_reference_const_cstr_cached(tc, ss, "<SC>",
             get_collectable_idx(tc, ss,
                 (MVMCollectable *)tc->instance->all_scs[sc_idx]->sc), sc_cache);
-    col->collectable_size = c->size;
+    col->collectable_size = MVM_gc_collectable_size(c);
 }
 static void process_gc_worklist(MVMThreadContext *tc, MVMHeapSnapshotState *ss, char *desc) {
     MVMCollectable **c_ptr;
@@ -460,9 +659,9 @@ static void incorporate_sf_stats(MVMThreadContext *tc, MVMHeapSnapshotStats *sta
 static void process_object(MVMThreadContext *tc, MVMHeapSnapshotState *ss,
         MVMHeapSnapshotCollectable *col, MVMObject *obj, MVMuint64 *stable_cache, MVMuint64 *sc_cache) {
     process_collectable(tc, ss, col, (MVMCollectable *)obj, sc_cache);
-    set_type_index(tc, ss, col, obj->st);
+    set_type_index(tc, ss, col, STABLE(obj));
     add_reference_const_cstr_cached(tc, ss, "<STable>",
-        get_collectable_idx(tc, ss, (MVMCollectable *)obj->st), stable_cache);
+        get_collectable_idx(tc, ss, (MVMCollectable *)STABLE(obj)), stable_cache);
     if (IS_CONCRETE(obj)) {
         /* Use object's gc_mark function to find what it references. */
         /* XXX We'll also add an API for getting better information, e.g.
@@ -800,6 +999,12 @@ static void destroy_current_heap_snapshot(MVMThreadContext *tc) {
 
     MVM_free(col->snapshot->collectables);
     MVM_free(col->snapshot->references);
+#if MVM_HEAPSNAPSHOT_FORMAT == 3
+    if (col->snapshot->ref_stream) {
+        ref_stream_stop_helper(col->snapshot->ref_stream);
+        ref_stream_destroy(col->snapshot->ref_stream);
+    }
+#endif
     MVM_free_null(col->snapshot);
 }
 
@@ -1201,9 +1406,56 @@ void collectables_to_filehandle_ver3(MVMThreadContext *tc, MVMHeapSnapshotCollec
 #endif
 }
 
+/* Finishes the streams of references and copies them into the snapshot. */
+static void ref_stream_to_filehandle(MVMThreadContext *tc, MVMHeapSnapshotCollection *col) {
+    MVMHeapSnapshot *s = col->snapshot;
+    MVMHeapSnapshotRefStream *rs = s->ref_stream;
+    char *names[REF_STREAM_COLUMNS] = { "refdescr", "reftrget" };
+    MVMuint32 c;
+
+    if (s->num_references > s->references_flushed)
+        ref_stream_flush(tc, s);
+    ref_stream_stop_helper(rs);
+
+    for (c = 0; c < REF_STREAM_COLUMNS; c++) {
+        FILE *fh = col->fh;
+        MVMuint16 elem_size = sizeof(MVMuint64);
+        MVMuint64 size = 0;
+        size_t size_position, end_position, read;
+        char namebuf[8] = {0};
+
+        ref_stream_write(rs, c, NULL);
+
+        size_position = ftell(fh);
+        memcpy(namebuf, names[c], 8);
+        fwrite(namebuf, 8, 1, fh);
+        fwrite(&elem_size, sizeof(MVMuint16), 1, fh);
+        fwrite(&size, sizeof(MVMuint64), 1, fh);
+        rewind(rs->files[c]);
+        while ((read = fread(rs->out_buffer, 1, rs->out_size, rs->files[c])) > 0)
+            fwrite(rs->out_buffer, 1, read, fh);
+        end_position = ftell(fh);
+
+        if (col->second_level_toc) {
+            MVMuint32 toc_i = get_new_toc_entry(tc, col->second_level_toc);
+            col->second_level_toc->toc_words[toc_i] = names[c];
+            col->second_level_toc->toc_positions[toc_i * 2]     = size_position;
+            col->second_level_toc->toc_positions[toc_i * 2 + 1] = end_position;
+        }
+    }
+
+    ref_stream_destroy(rs);
+    s->ref_stream = NULL;
+}
+
 void references_to_filehandle_ver3(MVMThreadContext *tc, MVMHeapSnapshotCollection *col, MVMHeapDumpIndexSnapshotEntry *entry) {
     MVMHeapSnapshot *s = col->snapshot;
 
+    if (s->ref_stream) {
+        ref_stream_to_filehandle(tc, col);
+        return;
+    }
+
     char *first_ref = (char *)&s->references[0];
     char *second_ref = (char *)&s->references[1];
 
@@ -1855,6 +2107,68 @@ void finish_collection_to_filehandle(MVMThreadContext *tc, MVMHeapSnapshotCollec
 #endif
 }
 
+/* Writes out a census: a line of totals, then a line for each type and
+ * static frame with the count and total size of its objects or frames,
+ * biggest first. It's plain text, so that censuses are easy to diff. */
+typedef struct {
+    MVMuint64 count;
+    MVMuint64 size;
+    MVMuint64 index;
+} census_entry;
+static int census_comparator(const void *one_entry, const void *two_entry) {
+    const census_entry *one = (const census_entry *)one_entry;
+    const census_entry *two = (const census_entry *)two_entry;
+    if (one->size != two->size)
+        return one->size < two->size ? 1 : -1;
+    return one->index < two->index ? -1 : one->index > two->index;
+}
+static void census_to_filehandle(MVMThreadContext *tc, MVMHeapSnapshotCollection *col) {
+    MVMHeapSnapshotStats *stats = col->snapshot->stats;
+    FILE *fh = col->fh;
+    MVMuint64 num_types  = MIN(col->num_types, stats->type_stats_alloc);
+    MVMuint64 num_frames = MIN(col->num_static_frames, stats->sf_stats_alloc);
+    census_entry *entries = MVM_malloc(MAX(MAX(num_types, num_frames), 1) * sizeof(census_entry));
+    MVMuint64 i, num;
+
+    fprintf(fh, "census %"PRIu64" time %"PRIu64" bytes %"PRIu64" objects %"PRIu64
+        " typeobjects %"PRIu64" stables %"PRIu64" frames %"PRIu64"\n",
+        col->snapshot_idx, (col->snapshot->record_time - col->start_time) / 1000,
+        col->total_heap_size, col->total_objects, col->total_typeobjects,
+        col->total_stables, col->total_frames);
+
+    for (i = 0, num = 0; i < num_types; i++) {
+        if (stats->type_counts[i]) {
+            entries[num].count = stats->type_counts[i];
+            entries[num].size  = stats->type_size_sum[i];
+            entries[num].index = i;
+            num++;
+        }
+    }
+    qsort(entries, num, sizeof(census_entry), census_comparator);
+    for (i = 0; i < num; i++) {
+        MVMHeapSnapshotType *type = &col->types[entries[i].index];
+        fprintf(fh, "type %"PRIu64" %"PRIu64" %s (%s)\n", entries[i].count, entries[i].size,
+            col->strings[type->type_name], col->strings[type->repr_name]);
+    }
+
+    for (i = 0, num = 0; i < num_frames; i++) {
+        if (stats->sf_counts[i]) {
+            entries[num].count = stats->sf_counts[i];
+            entries[num].size  = stats->sf_size_sum[i];
+            entries[num].index = i;
+            num++;
+        }
+    }
+    qsort(entries, num, sizeof(census_entry), census_comparator);
+    for (i = 0; i < num; i++) {
+        MVMHeapSnapshotStaticFrame *sf = &col->static_frames[entries[i].index];
+        fprintf(fh, "frame %"PRIu64" %"PRIu64" %s (%s:%u)\n", entries[i].count, entries[i].size,
+            col->strings[sf->name], col->strings[sf->file], sf->line);
+    }
+
+    MVM_free(entries);
+}
+
 /* Takes a snapshot of the heap, outputting it to the filehandle */
 void MVM_profile_heap_take_snapshot(MVMThreadContext *tc) {
     if (MVM_profile_heap_profiling(tc)) {
@@ -1877,13 +2191,22 @@ void MVM_profile_heap_take_snapshot(MVMThreadContext *tc) {
 
             col->snapshot->record_time = uv_hrtime();
 
-            record_snapshot(tc, col, col->snapshot);
+            if (col->census) {
+                record_snapshot(tc, col, col->snapshot);
+                census_to_filehandle(tc, col);
+            }
+            else {
+#if MVM_HEAPSNAPSHOT_FORMAT == 3
+                ref_stream_start(tc, col->snapshot);
+#endif
+                record_snapshot(tc, col, col->snapshot);
 
 #if MVM_HEAPSNAPSHOT_FORMAT == 3
-            snapshot_to_filehandle_ver3(tc, col);
+                snapshot_to_filehandle_ver3(tc, col);
 #else
-            snapshot_to_filehandle_ver2(tc, col);
+                snapshot_to_filehandle_ver2(tc, col);
 #endif
+            }
 
             fflush(col->fh);
             destroy_current_heap_snapshot(tc);
@@ -1903,7 +2226,8 @@ MVMObject * MVM_profile_heap_end(MVMThreadContext *tc) {
 
     dataset = tc->instance->VMNull;
 
-    finish_collection_to_filehandle(tc, tc->instance->heap_snapshots);
+    if (!col->census)
+        finish_collection_to_filehandle(tc, tc->instance->heap_snapshots);
     fclose(col->fh);
     destroy_heap_snapshot_collection(tc);
     return dataset;
@@ -94,6 +94,10 @@ struct MVMHeapSnapshotCollection {
 
     /* The file handle we are outputting to */
     FILE *fh;
+
+    /* Whether we are only taking a census: counts and sizes of objects by
+     * type and of frames by static frame, without recording references. */
+    MVMuint8 census;
 };
 
 /* An individual heap snapshot. */
@@ -103,10 +107,13 @@ struct MVMHeapSnapshot {
     MVMuint64 num_collectables;
     MVMuint64 alloc_collectables;
 
-    /* References.  */
+    /* References. When they are being streamed out as the snapshot is
+     * taken, only those from references_flushed onwards are held here. */
     MVMHeapSnapshotReference *references;
     MVMuint64 num_references;
     MVMuint64 alloc_references;
+    MVMuint64 references_flushed;
+    MVMHeapSnapshotRefStream *ref_stream;
 
     MVMHeapSnapshotStats *stats;
 
@@ -248,6 +255,7 @@ struct MVMHeapSnapshotWorkItem {
 
 MVMint32 MVM_profile_heap_profiling(MVMThreadContext *tc);
 void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config);
+void MVM_profile_heap_census_start(MVMThreadContext *tc, MVMObject *config);
 void MVM_profile_heap_take_snapshot(MVMThreadContext *tc);
 MVMObject * MVM_profile_heap_end(MVMThreadContext *tc);
 
@@ -7,17 +7,19 @@ typedef struct {
     MVMProfileCallNode **list;
 } NodeWorklist;
 
-/* Adds an instruction to log an allocation. */
-static void add_allocation_logging_at_location(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins, MVMSpeshIns *location) {
+/* Adds an instruction to log an allocation, along with the line that the
+ * allocating instruction is on. */
+static void add_allocation_logging_at_location(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins, MVMSpeshIns *location, MVMint32 line) {
     MVMSpeshIns *alloc_ins = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
     alloc_ins->info        = MVM_op_get_op(MVM_OP_prof_allocated);
-    alloc_ins->operands    = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshOperand));
+    alloc_ins->operands    = MVM_spesh_alloc(tc, g, 2 * sizeof(MVMSpeshOperand));
     alloc_ins->operands[0] = ins->operands[0];
+    alloc_ins->operands[1].lit_i32 = line;
     MVM_spesh_manipulate_insert_ins(tc, bb, location, alloc_ins);
 }
 
-static void add_allocation_logging(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
-    add_allocation_logging_at_location(tc, g, bb, ins, ins);
+static void add_allocation_logging(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins, MVMint32 line) {
+    add_allocation_logging_at_location(tc, g, bb, ins, ins, line);
 }
 
 static void add_nativecall_logging(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb, MVMSpeshIns *ins) {
@@ -39,13 +41,25 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
     /* Insert entry instruction. */
     MVMSpeshBB *bb         = g->entry->linear_next;
     MVMSpeshIns *enter_ins = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
+    MVMint32 line          = -1;
     enter_ins->info        = MVM_op_get_op(MVM_OP_prof_enter);
     MVM_spesh_manipulate_insert_ins(tc, bb, NULL, enter_ins);
 
-    /* Walk the code and insert profile logging instructions as needed. */
+    /* Walk the code and insert profile logging instructions as needed. The
+     * graph was built straight from the bytecode, so walking it in linear
+     * order sees the line annotations in bytecode order, and the last one
+     * seen gives the line allocations are attributed to. */
     while (bb) {
         MVMSpeshIns *ins = bb->first_ins;
         while (ins) {
+            MVMSpeshAnn *line_ann = ins->annotations;
+            while (line_ann) {
+                if (line_ann->type == MVM_SPESH_ANN_LINENO) {
+                    line = line_ann->data.lineno.line_number;
+                    break;
+                }
+                line_ann = line_ann->next;
+            }
             switch (ins->info->opcode) {
             case MVM_OP_return_i:
             case MVM_OP_return_n:
@@ -152,6 +166,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
             case MVM_OP_asyncwritebytesto:
             case MVM_OP_asyncwritebytes:
             case MVM_OP_asyncreadbytes:
+            case MVM_OP_asyncsendfile:
             case MVM_OP_encoderep:
             case MVM_OP_lc:
             case MVM_OP_uc:
@@ -175,6 +190,10 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
             case MVM_OP_setdimensions:
             case MVM_OP_dimensions:
             case MVM_OP_watchfile:
+            case MVM_OP_watchtree:
+            case MVM_OP_read_dir_all:
+            case MVM_OP_forkserver:
+            case MVM_OP_vmstats:
             case MVM_OP_timer:
             case MVM_OP_ctx:
             case MVM_OP_ctxouter:
@@ -230,7 +249,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
             case MVM_OP_multicacheadd:
             case MVM_OP_radix:
             case MVM_OP_radix_I: {
-                add_allocation_logging(tc, g, bb, ins);
+                add_allocation_logging(tc, g, bb, ins, line);
                 break;
             }
             case MVM_OP_param_op_o:
@@ -243,7 +262,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
                     location = location->next;
                 }
                 location = location->prev;
-                add_allocation_logging_at_location(tc, g, target, ins, location);
+                add_allocation_logging_at_location(tc, g, target, ins, location, line);
                 break;
             }
             case MVM_OP_getlex:
@@ -260,7 +279,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
                  * an object register. */
                 if ((g->local_types && g->local_types[ins->operands[0].reg.orig] == MVM_reg_obj)
                     || (!g->local_types && g->sf->body.local_types[ins->operands[0].reg.orig] == MVM_reg_obj))
-                    add_allocation_logging(tc, g, bb, ins);
+                    add_allocation_logging(tc, g, bb, ins, line);
                 break;
             }
             case MVM_OP_getlexref_i:
@@ -288,7 +307,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
             case MVM_OP_getattrsref_s:
             case MVM_OP_nativecallcast:
             case MVM_OP_nativecallglobal:
-                add_allocation_logging(tc, g, bb, ins);
+                add_allocation_logging(tc, g, bb, ins, line);
                 break;
             case MVM_OP_nativecallinvoke:
                 add_nativecall_logging(tc, g, bb, ins);
@@ -302,7 +321,7 @@ static void instrument_graph(MVMThreadContext *tc, MVMSpeshGraph *g) {
                     for (i = 0; i < num_extops; i++) {
                         if (extops[i].info == ins->info) {
                             if (extops[i].allocating && extops[i].info->num_operands >= 1)
-                                add_allocation_logging(tc, g, bb, ins);
+                                add_allocation_logging(tc, g, bb, ins, line);
                             break;
                         }
                     }
@@ -405,6 +424,13 @@ typedef struct {
     MVMString *exclusive_time;
     MVMString *callees;
     MVMString *allocations;
+    MVMString *allocation_sites;
+    MVMString *lock_contention;
+    MVMString *kind;
+    MVMString *acquires;
+    MVMString *contended;
+    MVMString *wait_time;
+    MVMString *max_wait;
     MVMString *spesh;
     MVMString *jit;
     MVMString *replaced;
@@ -426,6 +452,8 @@ typedef struct {
     MVMString *osr;
     MVMString *deopt_one;
     MVMString *deopt_all;
+    MVMString *multi_cache_hits;
+    MVMString *multi_cache_misses;
     MVMString *spesh_time;
     MVMString *thread;
     MVMString *native_lib;
@@ -636,6 +664,14 @@ static MVMObject * dump_call_graph_node(MVMThreadContext *tc, ProfDumpStrs *pds,
         MVM_repr_bind_key_o(tc, node_hash, pds->deopt_all,
             box_i(tc, pcn->deopt_all_count));
 
+    /* Multi-dispatch cache hits and misses. */
+    if (pcn->multi_cache_hits)
+        MVM_repr_bind_key_o(tc, node_hash, pds->multi_cache_hits,
+            box_i(tc, pcn->multi_cache_hits));
+    if (pcn->multi_cache_misses)
+        MVM_repr_bind_key_o(tc, node_hash, pds->multi_cache_misses,
+            box_i(tc, pcn->multi_cache_misses));
+
     if (pcn->num_alloc) {
         /* Emit allocations. */
         MVMObject *alloc_list = new_array(tc);
@@ -666,9 +702,55 @@ static MVMObject * dump_call_graph_node(MVMThreadContext *tc, ProfDumpStrs *pds,
         }
     }
 
+    if (pcn->num_sites) {
+        /* Emit allocations by line; the file is that of the node. */
+        MVMObject *site_list = new_array(tc);
+        MVM_repr_bind_key_o(tc, node_hash, pds->allocation_sites, site_list);
+        for (i = 0; i < pcn->num_sites; i++) {
+            MVMObject *site_info = new_hash(tc);
+            MVMProfileAllocationSite *site = &pcn->sites[i];
+
+            MVMObject *type = tc->prof_data->type_array[site->type_idx];
+
+            MVM_repr_bind_key_o(tc, site_info, pds->line, box_i(tc, site->line));
+            MVM_repr_bind_key_o(tc, site_info, pds->id, box_i(tc, (MVMint64)(uintptr_t)type));
+            MVM_repr_bind_key_o(tc, site_info, pds->count, box_i(tc, site->count));
+            MVM_repr_push_o(tc, site_list, site_info);
+        }
+    }
+
     return node_hash;
 }
 
+/* Dumps the locks a thread acquired, with the time it waited for them. */
+static MVMObject * dump_lock_contention(MVMThreadContext *tc, ProfDumpStrs *pds,
+                                        const MVMLockContention *lc) {
+    MVMObject *lock_list = new_array(tc);
+    MVMuint32  i;
+    for (i = 0; i < MVM_LOCK_CONTENTION_TABLE_SIZE; i++) {
+        const MVMLockContentionEntry *entry = &(lc->entries[i]);
+        MVMObject *lock_info;
+        if (!entry->lock)
+            continue;
+        lock_info = new_hash(tc);
+        MVM_repr_bind_key_o(tc, lock_info, pds->kind, box_s(tc, str(tc, entry->kind)));
+        MVM_repr_bind_key_o(tc, lock_info, pds->id, box_i(tc, (MVMint64)(uintptr_t)entry->lock));
+        MVM_repr_bind_key_o(tc, lock_info, pds->acquires, box_i(tc, entry->acquires));
+        MVM_repr_bind_key_o(tc, lock_info, pds->contended, box_i(tc, entry->contended));
+        MVM_repr_bind_key_o(tc, lock_info, pds->wait_time, box_i(tc, entry->wait_time / 1000));
+        MVM_repr_bind_key_o(tc, lock_info, pds->max_wait, box_i(tc, entry->max_wait / 1000));
+        if (entry->sf) {
+            MVM_repr_bind_key_o(tc, lock_info, pds->name, box_s(tc, entry->sf->body.name));
+            MVM_repr_bind_key_o(tc, lock_info, pds->file,
+                box_s(tc, entry->sf->body.cu->body.filename
+                    ? entry->sf->body.cu->body.filename
+                    : tc->instance->str_consts.empty));
+        }
+        MVM_repr_push_o(tc, lock_list, lock_info);
+    }
+    return lock_list;
+}
+
 /* Dumps data from a single thread. */
 static MVMObject * dump_thread_data(MVMThreadContext *tc, ProfDumpStrs *pds,
                                     MVMThreadContext *othertc,
@@ -776,6 +858,11 @@ static MVMObject * dump_thread_data(MVMThreadContext *tc, ProfDumpStrs *pds,
     MVM_repr_bind_key_o(tc, thread_hash, pds->parent,
         box_i(tc, ptd->parent_thread_id));
 
+    /* Add lock contention, if it's being profiled. */
+    if (othertc->lock_contention)
+        MVM_repr_bind_key_o(tc, thread_hash, pds->lock_contention,
+            dump_lock_contention(tc, pds, othertc->lock_contention));
+
     return thread_hash;
 }
 
@@ -808,6 +895,13 @@ void MVM_profile_dump_instrumented_data(MVMThreadContext *tc) {
         pds.exclusive_time  = str(tc, "exclusive_time");
         pds.callees         = str(tc, "callees");
         pds.allocations     = str(tc, "allocations");
+        pds.allocation_sites = str(tc, "allocation_sites");
+        pds.lock_contention = str(tc, "lock_contention");
+        pds.kind            = str(tc, "kind");
+        pds.acquires        = str(tc, "acquires");
+        pds.contended       = str(tc, "contended");
+        pds.wait_time       = str(tc, "wait_time");
+        pds.max_wait        = str(tc, "max_wait");
         pds.type            = str(tc, "type");
         pds.count           = str(tc, "count");
         pds.spesh           = str(tc, "spesh");
@@ -827,6 +921,8 @@ void MVM_profile_dump_instrumented_data(MVMThreadContext *tc) {
         pds.osr             = str(tc, "osr");
         pds.deopt_one       = str(tc, "deopt_one");
         pds.deopt_all       = str(tc, "deopt_all");
+        pds.multi_cache_hits   = str(tc, "multi_cache_hits");
+        pds.multi_cache_misses = str(tc, "multi_cache_misses");
         pds.spesh_time      = str(tc, "spesh_time");
         pds.thread          = str(tc, "thread");
         pds.native_lib      = str(tc, "native library");
@@ -336,7 +336,7 @@ void MVM_profile_log_thread_created(MVMThreadContext *tc, MVMThreadContext *chil
 }
 
 /* Logs one allocation, potentially scalar replaced. */
-void log_one_allocation(MVMThreadContext *tc, MVMObject *obj, MVMProfileCallNode *pcn, MVMuint8 replaced) {
+MVMuint32 log_one_allocation(MVMThreadContext *tc, MVMObject *obj, MVMProfileCallNode *pcn, MVMuint8 replaced) {
     MVMObject *what = STABLE(obj)->WHAT;
     MVMuint32 i;
     MVMuint8 allocation_target;
@@ -362,7 +362,7 @@ void log_one_allocation(MVMThreadContext *tc, MVMObject *obj, MVMProfileCallNode
                 pcn->alloc[i].allocations_jit++;
             else if (allocation_target == 3)
                 pcn->alloc[i].scalar_replaced++;
-            return;
+            return pcn->alloc[i].type_idx;
         }
     }
 
@@ -399,11 +399,44 @@ void log_one_allocation(MVMThreadContext *tc, MVMObject *obj, MVMProfileCallNode
     pcn->alloc[pcn->num_alloc].allocations_spesh  = allocation_target == 1;
     pcn->alloc[pcn->num_alloc].allocations_jit    = allocation_target == 2;
     pcn->alloc[pcn->num_alloc].scalar_replaced    = allocation_target == 3;
-    pcn->num_alloc++;
+    return pcn->alloc[pcn->num_alloc++].type_idx;
 }
 
-/* Log that we've just allocated the passed object (just log the type). */
-void MVM_profile_log_allocated(MVMThreadContext *tc, MVMObject *obj) {
+/* Counts an allocation of the type with the given index against the line of
+ * the call node's code that it happened on. */
+static void log_allocation_site(MVMThreadContext *tc, MVMProfileCallNode *pcn, MVMuint32 type_idx, MVMint32 line) {
+    MVMuint32 i;
+
+    /* See if there's an existing site to update. */
+    for (i = 0; i < pcn->num_sites; i++) {
+        if (pcn->sites[i].line == line && pcn->sites[i].type_idx == type_idx) {
+            pcn->sites[i].count++;
+            return;
+        }
+    }
+
+    /* No entry; create one. */
+    if (pcn->num_sites == pcn->alloc_sites) {
+        size_t old_alloc = pcn->alloc_sites;
+        pcn->alloc_sites = old_alloc ? old_alloc * 2 : 4;
+        if (old_alloc == 0)
+            pcn->sites = MVM_fixed_size_alloc(tc, tc->instance->fsa,
+                    pcn->alloc_sites * sizeof(MVMProfileAllocationSite));
+        else
+            pcn->sites = MVM_fixed_size_realloc(tc, tc->instance->fsa,
+                    pcn->sites,
+                    old_alloc * sizeof(MVMProfileAllocationSite),
+                    pcn->alloc_sites * sizeof(MVMProfileAllocationSite));
+    }
+    pcn->sites[pcn->num_sites].line     = line;
+    pcn->sites[pcn->num_sites].type_idx = type_idx;
+    pcn->sites[pcn->num_sites].count    = 1;
+    pcn->num_sites++;
+}
+
+/* Log that we've just allocated the passed object (just log the type, and
+ * the line of code it was allocated on). */
+void MVM_profile_log_allocated(MVMThreadContext *tc, MVMObject *obj, MVMint32 line) {
     MVMProfileThreadData *ptd  = get_thread_data(tc);
     MVMProfileCallNode   *pcn  = ptd->current_call;
     if (pcn) {
@@ -419,8 +452,9 @@ void MVM_profile_log_allocated(MVMThreadContext *tc, MVMObject *obj) {
 
         /* Since some ops first allocate, then call something else that may
          * also allocate, we may have to allow for a bit of grace distance. */
-        if ((uintptr_t)obj > (uintptr_t)tc->nursery_tospace && distance <= obj->header.size && obj != ptd->last_counted_allocation) {
-            log_one_allocation(tc, obj, pcn, 0);
+        if ((uintptr_t)obj > (uintptr_t)tc->nursery_tospace && distance <= MVM_gc_collectable_size(&obj->header) && obj != ptd->last_counted_allocation) {
+            MVMuint32 type_idx = log_one_allocation(tc, obj, pcn, 0);
+            log_allocation_site(tc, pcn, type_idx, line);
             ptd->last_counted_allocation = obj;
         }
     }
@@ -621,3 +655,15 @@ void MVM_profiler_log_deopt_all(MVMThreadContext *tc) {
     if (pcn)
         pcn->deopt_all_count++;
 }
+
+/* Log a multi-dispatch cache lookup, and whether it found a candidate. */
+void MVM_profiler_log_multi_cache(MVMThreadContext *tc, MVMuint32 hit) {
+    MVMProfileThreadData *ptd = get_thread_data(tc);
+    MVMProfileCallNode   *pcn = ptd->current_call;
+    if (pcn) {
+        if (hit)
+            pcn->multi_cache_hits++;
+        else
+            pcn->multi_cache_misses++;
+    }
+}
@@ -136,6 +136,11 @@ struct MVMProfileCallNode {
     MVMuint32 num_alloc;
     MVMuint32 alloc_alloc;
 
+    /* Allocations by the line they happened on and their type. */
+    MVMProfileAllocationSite *sites;
+    MVMuint32 num_sites;
+    MVMuint32 alloc_sites;
+
     /* The total inclusive time so far spent in this node. */
     MVMuint64 total_time;
 
@@ -160,6 +165,11 @@ struct MVMProfileCallNode {
     /* Number of times deopt_all happened. */
     MVMuint64 deopt_all_count;
 
+    /* Number of multi-dispatch cache lookups that found a candidate, and
+     * that didn't. */
+    MVMuint64 multi_cache_hits;
+    MVMuint64 multi_cache_misses;
+
     /* If the static frame is NULL, we're collecting data on a native call */
     char *native_target_name;
 
@@ -187,6 +197,19 @@ struct MVMProfileAllocationCount {
     MVMuint64 scalar_replaced;
 };
 
+/* The number of allocations of a type that were made on a line of the code
+ * of a call node. */
+struct MVMProfileAllocationSite {
+    /* The line number, or -1 if it isn't known. */
+    MVMint32 line;
+
+    /* The type allocated. */
+    MVMuint32 type_idx;
+
+    /* The number of allocations we've counted. */
+    MVMuint64 count;
+};
+
 struct MVMProfileDeallocationCount {
     MVMObject *type;
 
@@ -230,7 +253,7 @@ void MVM_profile_log_unwind(MVMThreadContext *tc);
 MVMProfileContinuationData * MVM_profile_log_continuation_control(MVMThreadContext *tc, const MVMFrame *root_frame);
 void MVM_profile_log_continuation_invoke(MVMThreadContext *tc, const MVMProfileContinuationData *cd);
 void MVM_profile_log_thread_created(MVMThreadContext *tc, MVMThreadContext *child_tc);
-void MVM_profile_log_allocated(MVMThreadContext *tc, MVMObject *obj);
+void MVM_profile_log_allocated(MVMThreadContext *tc, MVMObject *obj, MVMint32 line);
 void MVM_profile_log_scalar_replaced(MVMThreadContext *tc, MVMSTable *st);
 void MVM_profiler_log_gc_start(MVMThreadContext *tc, MVMuint32 full, MVMuint32 this_thread_responsible);
 void MVM_profiler_log_gc_end(MVMThreadContext *tc);
@@ -242,3 +265,4 @@ void MVM_profiler_log_spesh_end(MVMThreadContext *tc);
 void MVM_profiler_log_osr(MVMThreadContext *tc, MVMuint64 jitted);
 void MVM_profiler_log_deopt_one(MVMThreadContext *tc);
 void MVM_profiler_log_deopt_all(MVMThreadContext *tc);
+void MVM_profiler_log_multi_cache(MVMThreadContext *tc, MVMuint32 hit);
@@ -36,6 +36,8 @@ void MVM_profile_start(MVMThreadContext *tc, MVMObject *config) {
         }
         else if (MVM_string_equal(tc, kind, tc->instance->str_consts.heap))
             MVM_profile_heap_start(tc, config);
+        else if (MVM_string_equal(tc, kind, tc->instance->str_consts.census))
+            MVM_profile_heap_census_start(tc, config);
         else
             MVM_exception_throw_adhoc(tc, "Unknown profiler specified");
     }
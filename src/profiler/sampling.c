@@ -0,0 +1,189 @@
+#include "moar.h"
+#include "platform/io.h"
+#include "platform/time.h"
+
+/* The sampling CPU profiler. A timer thread bumps an epoch counter in the
+ * instance at the sampling interval; each thread compares it with the last
+ * epoch it saw whenever it enters a frame, and if it has moved on, walks its
+ * call stack (including inlined frames) and counts a sample against it in a
+ * per-thread tree of call stacks. Since samples are taken on frame entry, a
+ * sample that falls during a long loop without calls is credited to the
+ * next call it makes, and threads that are blocked take no samples. */
+
+/* The timer thread. */
+static void sampling_timer(void *data) {
+    MVMInstance *instance = (MVMInstance *)data;
+    MVMuint64    interval = (MVMuint64)instance->cpu_sample_interval * 1000;
+#ifdef MVM_HAS_PTHREAD_SETNAME_NP
+    pthread_setname_np(pthread_self(), "cpu sampler");
+#endif
+    while (!MVM_load(&instance->cpu_sample_stop)) {
+        MVM_platform_nanosleep(interval);
+        MVM_incr(&instance->cpu_sample_epoch);
+    }
+}
+
+/* Starts the timer thread, if CPU sampling is enabled. */
+void MVM_profile_cpu_sampling_start(MVMInstance *instance) {
+    int error;
+    if (!instance->cpu_sample_interval)
+        return;
+    error = uv_thread_create(&instance->cpu_sample_thread, sampling_timer, instance);
+    if (error) {
+        fprintf(stderr, "MoarVM: Could not start CPU sampling: %s\n", uv_strerror(error));
+        instance->cpu_sample_interval = 0;
+    }
+}
+
+/* Stops the timer thread, if it was started. */
+void MVM_profile_cpu_sampling_stop(MVMInstance *instance) {
+    if (!instance->cpu_sample_interval)
+        return;
+    MVM_store(&instance->cpu_sample_stop, 1);
+    uv_thread_join(&instance->cpu_sample_thread);
+    instance->cpu_sample_interval = 0;
+}
+
+static MVMCPUSampleNode * new_node(MVMStaticFrame *sf) {
+    MVMCPUSampleNode *node = MVM_calloc(1, sizeof(MVMCPUSampleNode));
+    node->sf = sf;
+    return node;
+}
+
+/* Finds the child of a node for the specified static frame, adding it if
+ * there isn't one yet. */
+static MVMCPUSampleNode * get_child(MVMCPUSampleNode *node, MVMStaticFrame *sf) {
+    MVMCPUSampleNode *child;
+    MVMuint32 i;
+    for (i = 0; i < node->num_children; i++)
+        if (node->children[i]->sf == sf)
+            return node->children[i];
+    if (node->num_children == node->alloc_children) {
+        node->alloc_children = node->alloc_children ? node->alloc_children * 2 : 4;
+        node->children = MVM_realloc(node->children,
+            node->alloc_children * sizeof(MVMCPUSampleNode *));
+    }
+    child = new_node(sf);
+    node->children[node->num_children++] = child;
+    return child;
+}
+
+/* Takes a sample of the current call stack. The frame being entered has not
+ * started running yet, so we can't ask where it is to find its inlines; it is
+ * recorded as it is, and the walk starts at its caller. */
+void MVM_profile_cpu_sample(MVMThreadContext *tc) {
+    MVMStaticFrame    *stack[MVM_CPU_SAMPLE_MAX_DEPTH];
+    MVMuint32          depth = 0;
+    MVMCPUSampleNode  *node;
+
+    tc->cpu_sample_epoch = MVM_load(&tc->instance->cpu_sample_epoch);
+    if (!tc->instance->cpu_sample_interval || !tc->cur_frame)
+        return;
+
+    stack[depth++] = tc->cur_frame->static_info;
+    if (tc->cur_frame->caller) {
+        MVMSpeshFrameWalker fw;
+        MVM_spesh_frame_walker_init(tc, &fw, tc->cur_frame->caller, 0);
+        while (depth < MVM_CPU_SAMPLE_MAX_DEPTH && MVM_spesh_frame_walker_next(tc, &fw))
+            stack[depth++] = MVM_spesh_frame_walker_get_static_frame(tc, &fw);
+        MVM_spesh_frame_walker_cleanup(tc, &fw);
+    }
+
+    /* Count it in the tree, outermost frame first. */
+    uv_mutex_lock(&tc->instance->mutex_cpu_samples);
+    if (!tc->cpu_samples)
+        tc->cpu_samples = new_node(NULL);
+    node = tc->cpu_samples;
+    while (depth > 0)
+        node = get_child(node, stack[--depth]);
+    node->samples++;
+    uv_mutex_unlock(&tc->instance->mutex_cpu_samples);
+}
+
+/* Frees a tree of samples. */
+void MVM_profile_cpu_samples_free(MVMThreadContext *tc, MVMCPUSampleNode *node) {
+    MVMuint32 i;
+    if (!node)
+        return;
+    for (i = 0; i < node->num_children; i++)
+        MVM_profile_cpu_samples_free(tc, node->children[i]);
+    MVM_free(node->children);
+    MVM_free(node);
+}
+
+/* Writes a frame's name in the stack, avoiding the characters that have a
+ * meaning in the collapsed stack format. */
+static void write_frame_name(MVMThreadContext *tc, FILE *fh, MVMStaticFrame *sf) {
+    char *name = MVM_string_utf8_encode_C_string(tc, sf->body.name);
+    char *file = MVM_string_utf8_encode_C_string(tc, sf->body.cu->body.filename);
+    char *c;
+    for (c = name; *c; c++)
+        if (*c == ';' || *c == '\n')
+            *c = '_';
+    for (c = file; *c; c++)
+        if (*c == ';' || *c == '\n')
+            *c = '_';
+    fprintf(fh, "%s (%s)", name[0] ? name : "<anon>", file);
+    MVM_free(name);
+    MVM_free(file);
+}
+
+/* Writes a line for each node of the tree that has samples of its own,
+ * giving the path to it followed by the count. */
+static void dump_node(MVMThreadContext *tc, FILE *fh, MVMuint32 thread_id,
+        MVMCPUSampleNode **path, MVMuint32 depth) {
+    MVMCPUSampleNode *node = path[depth - 1];
+    MVMuint32 i;
+    if (node->samples) {
+        fprintf(fh, "thread %u", thread_id);
+        for (i = 1; i < depth; i++) {
+            fputc(';', fh);
+            write_frame_name(tc, fh, path[i]->sf);
+        }
+        fprintf(fh, " %"PRIu64"\n", node->samples);
+    }
+    if (depth <= MVM_CPU_SAMPLE_MAX_DEPTH) {
+        for (i = 0; i < node->num_children; i++) {
+            path[depth] = node->children[i];
+            dump_node(tc, fh, thread_id, path, depth + 1);
+        }
+    }
+}
+
+/* Writes the samples of all threads that are still around to a file, in
+ * the collapsed stack format that flame graph tools take, with each thread
+ * as the outermost frame of its stacks. Like the allocation samples, the
+ * trees can't be collected from under us, as we don't reach a GC safepoint
+ * here and sampling turns off thread-local collection. */
+void MVM_profile_cpu_samples_dump(MVMThreadContext *tc, MVMString *path) {
+    MVMInstance       *i = tc->instance;
+    MVMCPUSampleNode  *nodes[MVM_CPU_SAMPLE_MAX_DEPTH + 2];
+    MVMThread         *thread;
+    char              *c_path;
+    FILE              *fh;
+
+    if (!i->cpu_sample_interval)
+        MVM_exception_throw_adhoc(tc, "CPU sampling is not enabled (set MVM_CPU_SAMPLE)");
+
+    c_path = MVM_string_utf8_c8_encode_C_string(tc, path);
+    fh = MVM_platform_fopen(c_path, "w");
+    if (!fh) {
+        char *waste[] = { c_path, NULL };
+        MVM_exception_throw_adhoc_free(tc, waste, "Could not open CPU sample file '%s': %s",
+            c_path, strerror(errno));
+    }
+    MVM_free(c_path);
+
+    uv_mutex_lock(&i->mutex_threads);
+    uv_mutex_lock(&i->mutex_cpu_samples);
+    for (thread = i->threads; thread; thread = thread->body.next) {
+        MVMThreadContext *thread_tc = thread->body.tc;
+        if (!thread_tc || !thread_tc->cpu_samples)
+            continue;
+        nodes[0] = thread_tc->cpu_samples;
+        dump_node(tc, fh, thread_tc->thread_id, nodes, 1);
+    }
+    uv_mutex_unlock(&i->mutex_cpu_samples);
+    uv_mutex_unlock(&i->mutex_threads);
+    fclose(fh);
+}
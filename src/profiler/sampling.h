@@ -0,0 +1,19 @@
+/* A node in a thread's tree of sampled call stacks, keyed by static frame.
+ * It counts the samples taken while its frame was running and none of its
+ * children were. */
+struct MVMCPUSampleNode {
+    MVMStaticFrame    *sf;
+    MVMuint64          samples;
+    MVMuint32          num_children;
+    MVMuint32          alloc_children;
+    MVMCPUSampleNode **children;
+};
+
+/* How many of the innermost frames of a stack are recorded in a sample. */
+#define MVM_CPU_SAMPLE_MAX_DEPTH 256
+
+void MVM_profile_cpu_sampling_start(MVMInstance *instance);
+void MVM_profile_cpu_sampling_stop(MVMInstance *instance);
+void MVM_profile_cpu_sample(MVMThreadContext *tc);
+void MVM_profile_cpu_samples_free(MVMThreadContext *tc, MVMCPUSampleNode *node);
+void MVM_profile_cpu_samples_dump(MVMThreadContext *tc, MVMString *path);
@@ -0,0 +1,11 @@
+#include "moar.h"
+
+/* Writes out the line for a phase that started at the given time and is
+ * now done, optionally with some detail such as a file name. */
+void MVM_startup_profile_report(MVMInstance *instance, const char *phase,
+        const char *detail, MVMuint64 start) {
+    MVMuint64 now = uv_hrtime();
+    fprintf(stderr, "startup: at %10.3fms took %10.3fms  %s%s%s\n",
+        (now - instance->startup_time) / 1e6, (now - start) / 1e6,
+        phase, detail ? " " : "", detail ? detail : "");
+}
@@ -0,0 +1,17 @@
+/* Startup profiling, switched on by MVM_STARTUP_PROFILE. As each phase of
+ * getting a program going is done, a line is written to stderr with how
+ * long it took and how long it was since the instance started being
+ * created. The phases are creating the instance, loading the Unicode
+ * database, mapping and unpacking bytecode files, running deserialization
+ * frames, deserializing each SC and the first few specializations. */
+
+/* How many specializations (and JIT compilations) are reported. */
+#define MVM_STARTUP_PROFILE_SPESH 10
+
+void MVM_startup_profile_report(MVMInstance *instance, const char *phase,
+    const char *detail, MVMuint64 start);
+
+/* Gets the start time of a phase, or 0 if startup profiling is off. */
+MVM_STATIC_INLINE MVMuint64 MVM_startup_profile_start(MVMInstance *instance) {
+    return instance->startup_profiling ? uv_hrtime() : 0;
+}
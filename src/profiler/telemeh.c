@@ -58,7 +58,8 @@ enum RecordType {
     IntervalStart,
     IntervalEnd,
     IntervalAnnotation,
-    DynamicString
+    DynamicString,
+    Dropped
 };
 
 struct CalibrationRecord {
@@ -90,6 +91,10 @@ struct DynamicString {
     char *description;
 };
 
+struct DroppedRecord {
+    unsigned int count;
+};
+
 struct TelemetryRecord {
     enum RecordType recordType;
 
@@ -102,59 +107,114 @@ struct TelemetryRecord {
         struct IntervalRecord interval;
         struct IntervalAnnotation annotation;
         struct DynamicString annotation_dynamic;
+        struct DroppedRecord dropped;
     } u;
 };
 
-#define RECORD_BUFFER_SIZE 10000
+#define RECORD_BUFFER_SIZE 4096
+
+/* Every OS thread that emits telemetry gets its own ring buffer of events,
+ * so recording an event never touches a cache line shared with another
+ * thread. The producing thread is the only one to move head, and the
+ * background serializer is the only one to move tail. When the ring is
+ * full, the event is dropped and counted rather than overwriting records
+ * that may be in the middle of being serialized. Buffers are chained into
+ * a list (pushed with a CAS) so the serializer can find them, and live
+ * until the process exits, since a thread can go away at any time. */
+struct TelemetryBuffer {
+    struct TelemetryRecord records[RECORD_BUFFER_SIZE];
+    AO_t head;
+    AO_t tail;
+    AO_t dropped;
+    unsigned int droppedReported;
+    uintptr_t lastThreadID;
+    struct TelemetryBuffer *next;
+};
 
-// this is a ring buffer of telemetry events
-static struct TelemetryRecord recordBuffer[RECORD_BUFFER_SIZE];
-static AO_t recordBufferIndex = 0;
-static unsigned int lastSerializedIndex = 0;
+static uv_key_t bufferKey;
+static struct TelemetryBuffer * volatile allBuffers = NULL;
 static unsigned long long beginningEpoch = 0;
-static unsigned int telemetry_active = 0;
+static volatile unsigned int telemetry_active = 0;
+static unsigned int telemetry_inited = 0;
+static unsigned int telemetry_binary = 0;
 
-struct TelemetryRecord *newRecord()
+static struct TelemetryBuffer *threadBuffer()
 {
-    AO_t newBufferIndex, recordIndex;
-    struct TelemetryRecord *record;
+    struct TelemetryBuffer *buffer = uv_key_get(&bufferKey);
+    if (!buffer) {
+        struct TelemetryBuffer *head;
+        buffer = calloc(1, sizeof(struct TelemetryBuffer));
+        if (!buffer)
+            return NULL;
+        do {
+            head = (struct TelemetryBuffer *)MVM_load(&allBuffers);
+            buffer->next = head;
+        } while (!MVM_trycas(&allBuffers, head, buffer));
+        uv_key_set(&bufferKey, buffer);
+    }
+    return buffer;
+}
+
+/* Gets the next free record in this thread's buffer, or NULL if the buffer
+ * is full. The record only becomes visible to the serializer once it is
+ * passed to commitRecord. */
+static struct TelemetryRecord *newRecord(struct TelemetryBuffer **bufferOut)
+{
+    struct TelemetryBuffer *buffer = threadBuffer();
+    AO_t head;
 
-    do {
-        recordIndex = MVM_load(&recordBufferIndex);
-        newBufferIndex = (recordBufferIndex + 1) % RECORD_BUFFER_SIZE;
-    } while(!MVM_trycas(&recordBufferIndex, recordIndex, newBufferIndex));
+    if (!buffer)
+        return NULL;
 
-    record = &recordBuffer[recordIndex];
-    return record;
+    head = buffer->head;
+    if ((head + 1) % RECORD_BUFFER_SIZE == MVM_load(&buffer->tail)) {
+        MVM_incr(&buffer->dropped);
+        return NULL;
+    }
+
+    *bufferOut = buffer;
+    return &buffer->records[head];
 }
 
-static unsigned int intervalIDCounter = 0;
+static void commitRecord(struct TelemetryBuffer *buffer)
+{
+    MVM_store(&buffer->head, (buffer->head + 1) % RECORD_BUFFER_SIZE);
+}
+
+static AO_t intervalIDCounter = 0;
 
 MVM_PUBLIC void MVM_telemetry_timestamp(MVMThreadContext *threadID, const char *description)
 {
+    struct TelemetryBuffer *buffer;
     struct TelemetryRecord *record;
 
     if (!telemetry_active) { return; }
 
-    record = newRecord();
+    record = newRecord(&buffer);
+    if (!record) { return; }
 
     READ_TSC(record->u.timeStamp.time);
     record->recordType = TimeStamp;
     record->threadID = (uintptr_t)threadID;
     record->u.timeStamp.description = description;
+
+    commitRecord(buffer);
 }
 
 MVM_PUBLIC unsigned int MVM_telemetry_interval_start(MVMThreadContext *threadID, const char *description)
 {
+    struct TelemetryBuffer *buffer;
     struct TelemetryRecord *record;
 
     unsigned int intervalID;
 
     if (!telemetry_active) { return 0; }
 
-    record = newRecord();
-    MVM_incr(&intervalIDCounter);
-    intervalID = MVM_load(&intervalIDCounter);
+    intervalID = (unsigned int)MVM_incr(&intervalIDCounter) + 1;
+
+    record = newRecord(&buffer);
+    if (!record) { return intervalID; }
+
     READ_TSC(record->u.interval.time);
 
     record->recordType = IntervalStart;
@@ -162,48 +222,65 @@ MVM_PUBLIC unsigned int MVM_telemetry_interval_start(MVMThreadContext *threadID,
     record->u.interval.intervalID = intervalID;
     record->u.interval.description = description;
 
+    commitRecord(buffer);
+
     return intervalID;
 }
 
 MVM_PUBLIC void MVM_telemetry_interval_stop(MVMThreadContext *threadID, int intervalID, const char *description)
 {
+    struct TelemetryBuffer *buffer;
     struct TelemetryRecord *record;
 
     if (!telemetry_active) { return; }
 
-    record = newRecord();
+    record = newRecord(&buffer);
+    if (!record) { return; }
+
     READ_TSC(record->u.interval.time);
 
     record->recordType = IntervalEnd;
     record->threadID = (uintptr_t)threadID;
     record->u.interval.intervalID = intervalID;
     record->u.interval.description = description;
+
+    commitRecord(buffer);
 }
 
 MVM_PUBLIC void MVM_telemetry_interval_annotate(uintptr_t subject, int intervalID, const char *description) {
+    struct TelemetryBuffer *buffer;
     struct TelemetryRecord *record;
 
     if (!telemetry_active) { return; }
 
-    record = newRecord();
+    record = newRecord(&buffer);
+    if (!record) { return; }
+
     record->recordType = IntervalAnnotation;
     record->threadID = subject;
     record->u.annotation.intervalID = intervalID;
     record->u.annotation.description = description;
+
+    commitRecord(buffer);
 }
 
 MVM_PUBLIC void MVM_telemetry_interval_annotate_dynamic(uintptr_t subject, int intervalID, char *description) {
+    struct TelemetryBuffer *buffer;
     struct TelemetryRecord *record = NULL;
 
     if (!telemetry_active) { return; }
 
-    record = newRecord();
+    record = newRecord(&buffer);
+    if (!record) { return; }
+
     record->recordType = DynamicString;
     record->threadID = subject;
     record->u.annotation_dynamic.intervalID = intervalID;
 
     /* Dynamic description arbitrarily limited for performance reasons. */
     record->u.annotation_dynamic.description = strndup(description, 1024);
+
+    commitRecord(buffer);
 }
 
 void calibrateTSC(FILE *outfile)
@@ -232,98 +309,231 @@ void calibrateTSC(FILE *outfile)
 static uv_thread_t backgroundSerializationThread;
 static volatile int continueBackgroundSerialization = 1;
 
-void serializeTelemetryBufferRange(FILE *outfile, unsigned int serializationStart, unsigned int serializationEnd)
+static void serializeRecordText(FILE *outfile, struct TelemetryRecord *record)
 {
-    unsigned int i;
-    for(i = serializationStart; i < serializationEnd; i++) {
-        struct TelemetryRecord *record = &recordBuffer[i];
-
-        fprintf(outfile, "%10" PRIxPTR " ", record->threadID);
-
-        switch(record->recordType) {
-            case Calibration:
-                fprintf(outfile, "Calibration: %f ticks per second\n", record->u.calibration.ticksPerSecond);
-                break;
-            case Epoch:
-                fprintf(outfile, "Epoch counter: %lld\n", record->u.epoch.time);
-                break;
-            case TimeStamp:
-                fprintf(outfile, "%15lld -|-  \"%s\"\n", record->u.timeStamp.time - beginningEpoch, record->u.timeStamp.description);
-                break;
-            case IntervalStart:
-                fprintf(outfile, "%15lld (-   \"%s\" (%d)\n", record->u.interval.time - beginningEpoch, record->u.interval.description, record->u.interval.intervalID);
-                break;
-            case IntervalEnd:
-                fprintf(outfile, "%15lld  -)  \"%s\" (%d)\n", record->u.interval.time - beginningEpoch, record->u.interval.description, record->u.interval.intervalID);
-                break;
-            case IntervalAnnotation:
-                fprintf(outfile,  "%15s ???  \"%s\" (%d)\n", " ", record->u.annotation.description, record->u.annotation.intervalID);
-                break;
-            case DynamicString:
-                fprintf(outfile,  "%15s ???  \"%s\" (%d)\n", " ", record->u.annotation_dynamic.description, record->u.annotation_dynamic.intervalID);
-                free(record->u.annotation_dynamic.description);
-                break;
-        }
+    fprintf(outfile, "%10" PRIxPTR " ", record->threadID);
+
+    switch(record->recordType) {
+        case Calibration:
+            fprintf(outfile, "Calibration: %f ticks per second\n", record->u.calibration.ticksPerSecond);
+            break;
+        case Epoch:
+            fprintf(outfile, "Epoch counter: %lld\n", record->u.epoch.time);
+            break;
+        case TimeStamp:
+            fprintf(outfile, "%15lld -|-  \"%s\"\n", record->u.timeStamp.time - beginningEpoch, record->u.timeStamp.description);
+            break;
+        case IntervalStart:
+            fprintf(outfile, "%15lld (-   \"%s\" (%d)\n", record->u.interval.time - beginningEpoch, record->u.interval.description, record->u.interval.intervalID);
+            break;
+        case IntervalEnd:
+            fprintf(outfile, "%15lld  -)  \"%s\" (%d)\n", record->u.interval.time - beginningEpoch, record->u.interval.description, record->u.interval.intervalID);
+            break;
+        case IntervalAnnotation:
+            fprintf(outfile,  "%15s ???  \"%s\" (%d)\n", " ", record->u.annotation.description, record->u.annotation.intervalID);
+            break;
+        case DynamicString:
+            fprintf(outfile,  "%15s ???  \"%s\" (%d)\n", " ", record->u.annotation_dynamic.description, record->u.annotation_dynamic.intervalID);
+            break;
+        case Dropped:
+            fprintf(outfile,  "%15s !!!  dropped %u records\n", " ", record->u.dropped.count);
+            break;
     }
 }
 
-void serializeTelemetryBuffer(FILE *outfile)
+/* The binary format starts with the 8 byte magic "MVMTELE1". Every record
+ * follows as a 1 byte record type, the 8 byte thread ID (or annotation
+ * subject), an 8 byte value, a 4 byte interval ID and a description of 2
+ * byte length plus that many bytes (not NUL terminated). The value is the
+ * ticks per second as a double for Calibration, the raw TSC reading for
+ * Epoch and the rest, and the number of records lost for Dropped (in which
+ * case the thread ID is that of the last record the thread wrote). All
+ * numbers are written in the native byte order of the machine. */
+static void serializeRecordBinary(FILE *outfile, struct TelemetryRecord *record)
+{
+    unsigned char type = (unsigned char)record->recordType;
+    uint64_t threadID = (uint64_t)record->threadID;
+    uint64_t value = 0;
+    uint32_t intervalID = 0;
+    const char *description = NULL;
+    uint16_t length;
+
+    switch(record->recordType) {
+        case Calibration:
+            memcpy(&value, &record->u.calibration.ticksPerSecond, sizeof(uint64_t));
+            break;
+        case Epoch:
+            value = record->u.epoch.time;
+            break;
+        case TimeStamp:
+            value = record->u.timeStamp.time;
+            description = record->u.timeStamp.description;
+            break;
+        case IntervalStart:
+        case IntervalEnd:
+            value = record->u.interval.time;
+            intervalID = record->u.interval.intervalID;
+            description = record->u.interval.description;
+            break;
+        case IntervalAnnotation:
+            intervalID = record->u.annotation.intervalID;
+            description = record->u.annotation.description;
+            break;
+        case DynamicString:
+            intervalID = record->u.annotation_dynamic.intervalID;
+            description = record->u.annotation_dynamic.description;
+            break;
+        case Dropped:
+            value = record->u.dropped.count;
+            break;
+    }
+
+    length = description ? (uint16_t)strnlen(description, 0xFFFF) : 0;
+    fwrite(&type, 1, 1, outfile);
+    fwrite(&threadID, sizeof(uint64_t), 1, outfile);
+    fwrite(&value, sizeof(uint64_t), 1, outfile);
+    fwrite(&intervalID, sizeof(uint32_t), 1, outfile);
+    fwrite(&length, sizeof(uint16_t), 1, outfile);
+    if (length)
+        fwrite(description, 1, length, outfile);
+}
+
+static void serializeRecord(FILE *outfile, struct TelemetryRecord *record)
+{
+    if (telemetry_binary)
+        serializeRecordBinary(outfile, record);
+    else
+        serializeRecordText(outfile, record);
+    if (record->recordType == DynamicString)
+        free(record->u.annotation_dynamic.description);
+}
+
+static void serializeTelemetryBuffer(FILE *outfile, struct TelemetryBuffer *buffer)
 {
-    unsigned int serializationEnd = recordBufferIndex;
-    unsigned int serializationStart = lastSerializedIndex;
-
-    if(serializationEnd < serializationStart) {
-        serializeTelemetryBufferRange(outfile, serializationStart, RECORD_BUFFER_SIZE);
-        serializeTelemetryBufferRange(outfile, 0, serializationEnd);
-    } else {
-        serializeTelemetryBufferRange(outfile, serializationStart, serializationEnd);
+    AO_t head = MVM_load(&buffer->head);
+    AO_t tail = buffer->tail;
+    unsigned int dropped;
+
+    while (tail != head) {
+        struct TelemetryRecord *record = &buffer->records[tail];
+        buffer->lastThreadID = record->threadID;
+        serializeRecord(outfile, record);
+        tail = (tail + 1) % RECORD_BUFFER_SIZE;
     }
+    MVM_store(&buffer->tail, tail);
+
+    /* Report anything lost since the last pass, so the log can't silently
+     * have holes in it. */
+    dropped = (unsigned int)MVM_load(&buffer->dropped);
+    if (dropped != buffer->droppedReported) {
+        struct TelemetryRecord record;
+        record.recordType = Dropped;
+        record.threadID = buffer->lastThreadID;
+        record.u.dropped.count = dropped - buffer->droppedReported;
+        serializeRecord(outfile, &record);
+        buffer->droppedReported = dropped;
+    }
+}
 
-    lastSerializedIndex = serializationEnd;
+static void serializeTelemetryBuffers(FILE *outfile)
+{
+    struct TelemetryBuffer *buffer = (struct TelemetryBuffer *)MVM_load(&allBuffers);
+    while (buffer) {
+        serializeTelemetryBuffer(outfile, buffer);
+        buffer = buffer->next;
+    }
+    fflush(outfile);
 }
 
 void backgroundSerialization(void *outfile)
 {
     while(continueBackgroundSerialization) {
         MVM_sleep(500);
-        serializeTelemetryBuffer((FILE *)outfile);
+        serializeTelemetryBuffers((FILE *)outfile);
     }
 
+    /* Pick up whatever was written between the last pass and the stop. */
+    serializeTelemetryBuffers((FILE *)outfile);
+
     fclose((FILE *)outfile);
 }
 
-MVM_PUBLIC void MVM_telemetry_init(FILE *outfile)
+static void telemetryStart(FILE *outfile, unsigned int binary)
 {
-    struct TelemetryRecord *calibrationRecord;
-    struct TelemetryRecord *epochRecord;
+    struct TelemetryRecord calibrationRecord;
+    struct TelemetryRecord epochRecord;
     int threadCreateError;
 
-    telemetry_active = 1;
+    if (telemetry_inited)
+        return;
+
+    threadCreateError = uv_key_create(&bufferKey);
+    if (threadCreateError != 0)  {
+        fprintf(stderr, "MoarVM: Could not initialize telemetry: %s\n", uv_strerror(threadCreateError));
+        return;
+    }
+
+    telemetry_binary = binary;
+    if (binary)
+        fwrite("MVMTELE1", 1, 8, outfile);
 
     calibrateTSC(outfile);
 
-    calibrationRecord = newRecord();
-    calibrationRecord->u.calibration.ticksPerSecond = ticksPerSecond;
-    calibrationRecord->recordType = Calibration;
+    calibrationRecord.recordType = Calibration;
+    calibrationRecord.threadID = 0;
+    calibrationRecord.u.calibration.ticksPerSecond = ticksPerSecond;
+    serializeRecord(outfile, &calibrationRecord);
 
-    epochRecord = newRecord();
-    READ_TSC(epochRecord->u.epoch.time)
-    epochRecord->recordType = Epoch;
+    epochRecord.recordType = Epoch;
+    epochRecord.threadID = 0;
+    READ_TSC(epochRecord.u.epoch.time)
+    serializeRecord(outfile, &epochRecord);
 
-    beginningEpoch = epochRecord->u.epoch.time;
+    beginningEpoch = epochRecord.u.epoch.time;
+
+    telemetry_inited = 1;
+    telemetry_active = 1;
 
     threadCreateError = uv_thread_create((uv_thread_t *)&backgroundSerializationThread, backgroundSerialization, (void *)outfile);
     if (threadCreateError != 0)  {
         telemetry_active = 0;
+        telemetry_inited = 0;
 
         fprintf(stderr, "MoarVM: Could not initialize telemetry: %s\n", uv_strerror(threadCreateError));
     }
 }
 
+MVM_PUBLIC void MVM_telemetry_init(FILE *outfile)
+{
+    telemetryStart(outfile, 0);
+}
+
+MVM_PUBLIC void MVM_telemetry_init_binary(FILE *outfile)
+{
+    telemetryStart(outfile, 1);
+}
+
+/* Switches recording of events on or off without tearing down the log, so
+ * telemetry can be left initialized and only enabled when it's wanted. */
+MVM_PUBLIC void MVM_telemetry_set_active(int active)
+{
+    if (telemetry_inited)
+        telemetry_active = active ? 1 : 0;
+}
+
+MVM_PUBLIC int MVM_telemetry_is_active()
+{
+    return telemetry_active;
+}
+
 MVM_PUBLIC void MVM_telemetry_finish()
 {
+    if (!telemetry_inited)
+        return;
+    telemetry_active = 0;
     continueBackgroundSerialization = 0;
     uv_thread_join(&backgroundSerializationThread);
+    telemetry_inited = 0;
 }
 
 #else
@@ -336,6 +546,9 @@ MVM_PUBLIC void MVM_telemetry_interval_annotate(uintptr_t subject, int intervalI
 MVM_PUBLIC void MVM_telemetry_interval_annotate_dynamic(uintptr_t subject, int intervalID, char *description) { }
 
 MVM_PUBLIC void MVM_telemetry_init(FILE *outfile) { }
+MVM_PUBLIC void MVM_telemetry_init_binary(FILE *outfile) { }
+MVM_PUBLIC void MVM_telemetry_set_active(int active) { }
+MVM_PUBLIC int MVM_telemetry_is_active() { return 0; }
 MVM_PUBLIC void MVM_telemetry_finish() { }
 
 #endif
@@ -8,4 +8,7 @@ MVM_PUBLIC void MVM_telemetry_interval_annotate(uintptr_t subject, int intervalI
 MVM_PUBLIC void MVM_telemetry_interval_annotate_dynamic(uintptr_t subject, int intervalID, char *description);
 
 MVM_PUBLIC void MVM_telemetry_init(FILE *outfile);
+MVM_PUBLIC void MVM_telemetry_init_binary(FILE *outfile);
+MVM_PUBLIC void MVM_telemetry_set_active(int active);
+MVM_PUBLIC int MVM_telemetry_is_active();
 MVM_PUBLIC void MVM_telemetry_finish();
@@ -0,0 +1,178 @@
+#include "moar.h"
+
+/* The vmstats op hands back a hash of counters and gauges about the VM:
+ * the always-on GC statistics, along with the counters bumped by spesh, the
+ * JIT and the event loop, and a few figures worked out on the spot. It is
+ * cheap enough to be polled by something scraping metrics. Times are in
+ * nanoseconds and sizes in bytes. The entries that aren't numbers are
+ * deopt_sites, an array describing the deopt points hit most often, and
+ * event_loops, an array with the latency and backlog histograms of each
+ * event loop. */
+
+/* Adds a boxed integer entry to the stats hash. */
+static void add_stat(MVMThreadContext *tc, MVMObject *hash, const char *name, MVMint64 value) {
+    MVMString *key;
+    MVMObject *boxed;
+    MVMROOT(tc, hash, {
+        key = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, name);
+        MVMROOT(tc, key, {
+            boxed = MVM_repr_box_int(tc, MVM_hll_current(tc)->int_box_type, value);
+        });
+    });
+    MVM_repr_bind_key_o(tc, hash, key, boxed);
+}
+
+/* Adds a histogram entry to a hash, as a hash with its count, total and
+ * maximum, and an array of its bucket counts. */
+static void add_histogram(MVMThreadContext *tc, MVMObject *hash, const char *name, const MVMIOHistogram *source) {
+    MVMIOHistogram histogram;
+    MVMObject *entry, *buckets;
+    MVMString *key;
+    MVMuint32 i;
+    memcpy(&histogram, source, sizeof(MVMIOHistogram));
+    MVMROOT(tc, hash, {
+        entry = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_hash_type);
+        MVMROOT(tc, entry, {
+            add_stat(tc, entry, "count", histogram.count);
+            add_stat(tc, entry, "total", histogram.total);
+            add_stat(tc, entry, "max", histogram.max);
+            buckets = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_array_type);
+            MVMROOT(tc, buckets, {
+                for (i = 0; i < MVM_IO_HISTOGRAM_BUCKETS; i++)
+                    MVM_repr_push_o(tc, buckets, MVM_repr_box_int(tc,
+                        MVM_hll_current(tc)->int_box_type, histogram.buckets[i]));
+                key = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, "buckets");
+            });
+            MVM_repr_bind_key_o(tc, entry, key, buckets);
+            key = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, name);
+        });
+    });
+    MVM_repr_bind_key_o(tc, hash, key, entry);
+}
+
+/* Makes an array with the latency and backlog histograms of each of the
+ * event loops that has been started. */
+static MVMObject * event_loop_stats(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    MVMObject *loops = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_array_type);
+    MVMuint32 i;
+    MVMROOT(tc, loops, {
+        for (i = 0; i < instance->num_event_loops; i++) {
+            MVMEventLoop *el = &instance->event_loops[i];
+            MVMObject *loop;
+            if (!el->loop)
+                continue;
+            loop = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_hash_type);
+            MVMROOT(tc, loop, {
+                add_stat(tc, loop, "index", i);
+                add_histogram(tc, loop, "setup_latency", &el->setup_latency);
+                add_histogram(tc, loop, "task_time", &el->task_time);
+                add_histogram(tc, loop, "iteration_time", &el->iteration_time);
+                add_histogram(tc, loop, "setup_backlog", &el->setup_backlog);
+                add_histogram(tc, loop, "results_backlog", &el->results_backlog);
+                MVM_repr_push_o(tc, loops, loop);
+            });
+        }
+    });
+    return loops;
+}
+
+/* Works out how much memory the fixed size allocator has in its pages, and
+ * how much of that is handed out rather than sitting on a free list. */
+static void fsa_usage(MVMThreadContext *tc, MVMint64 *reserved, MVMint64 *used) {
+    MVMFixedSizeAlloc *al = tc->instance->fsa;
+    MVMint64 stats[MVM_FSA_STATS_FIELDS];
+    MVMuint32 bin;
+    *reserved = 0;
+    *used = 0;
+    for (bin = 0; bin < MVM_FSA_BINS; bin++) {
+        MVMint64 in_use;
+        if (!al->size_classes[bin].pages)
+            continue;
+        MVM_fixed_size_bin_stats(tc, al, bin, stats);
+        *reserved += stats[MVM_FSA_STATS_PAGES] * MVM_FSA_PAGE_ITEMS
+            * stats[MVM_FSA_STATS_ITEM_SIZE];
+        in_use = stats[MVM_FSA_STATS_CARVED_ITEMS] - stats[MVM_FSA_STATS_FREE_LIST_ITEMS]
+            - stats[MVM_FSA_STATS_DEPOT_ITEMS] - stats[MVM_FSA_STATS_THREAD_ITEMS];
+        if (in_use > 0)
+            *used += in_use * stats[MVM_FSA_STATS_ITEM_SIZE];
+    }
+}
+
+/* Counts the threads that have started and not yet exited. */
+static MVMint64 running_threads(MVMThreadContext *tc) {
+    MVMint64 count = 0;
+    MVMThread *cur_thread;
+    uv_mutex_lock(&(tc->instance->mutex_threads));
+    cur_thread = tc->instance->threads;
+    while (cur_thread) {
+        AO_t stage = MVM_load(&cur_thread->body.stage);
+        if (stage >= MVM_thread_stage_starting && stage < MVM_thread_stage_exited)
+            count++;
+        cur_thread = cur_thread->body.next;
+    }
+    uv_mutex_unlock(&(tc->instance->mutex_threads));
+    return count;
+}
+
+MVMObject * MVM_vm_stats(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    MVMuint64 gc[MVM_GC_STATS_FIELDS];
+    MVMint64 fsa_reserved, fsa_used, threads;
+    MVMint64 spesh_queue = 0;
+    MVMObject *result;
+
+    uv_mutex_lock(&instance->mutex_gc_stats);
+    memcpy(gc, instance->gc_stats, sizeof(gc));
+    uv_mutex_unlock(&instance->mutex_gc_stats);
+    fsa_usage(tc, &fsa_reserved, &fsa_used);
+    threads = running_threads(tc);
+    if (instance->spesh_queue)
+        spesh_queue = MVM_repr_elems(tc, instance->spesh_queue);
+
+    result = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_hash_type);
+    MVMROOT(tc, result, {
+        add_stat(tc, result, "gc_runs", gc[MVM_GC_STATS_RUNS]);
+        add_stat(tc, result, "gc_full_runs", gc[MVM_GC_STATS_FULL_RUNS]);
+        add_stat(tc, result, "gc_pause_total", gc[MVM_GC_STATS_PAUSE_TOTAL]);
+        add_stat(tc, result, "gc_pause_max", gc[MVM_GC_STATS_PAUSE_MAX]);
+        add_stat(tc, result, "gc_ttsp_total", gc[MVM_GC_STATS_TTSP_TOTAL]);
+        add_stat(tc, result, "gc_local_runs", gc[MVM_GC_STATS_LOCAL_RUNS]);
+        add_stat(tc, result, "gc_local_total", gc[MVM_GC_STATS_LOCAL_TOTAL]);
+        add_stat(tc, result, "gc_trims", gc[MVM_GC_STATS_TRIMS]);
+        add_stat(tc, result, "gc_trim_released", gc[MVM_GC_STATS_TRIM_RELEASED]);
+        add_stat(tc, result, "gc_trim_rss_before", gc[MVM_GC_STATS_TRIM_RSS_BEFORE]);
+        add_stat(tc, result, "gc_trim_rss_after", gc[MVM_GC_STATS_TRIM_RSS_AFTER]);
+        add_stat(tc, result, "gc_promoted_bytes",
+            MVM_load(&instance->stat_promoted_bytes)
+            + MVM_load(&instance->gc_promoted_bytes_since_last_full));
+        add_stat(tc, result, "spesh_queue_length", spesh_queue);
+        add_stat(tc, result, "spesh_candidates", MVM_load(&instance->stat_spesh_candidates));
+        add_stat(tc, result, "spesh_deopt_one", MVM_load(&instance->stat_deopt_one));
+        add_stat(tc, result, "spesh_deopt_all", MVM_load(&instance->stat_deopt_all));
+        add_stat(tc, result, "spesh_deopt_discards", MVM_load(&instance->stat_deopt_discards));
+        add_stat(tc, result, "spesh_osr", MVM_load(&instance->stat_osr));
+        add_stat(tc, result, "jit_code_bytes", MVM_load(&instance->stat_jit_code_bytes));
+        add_stat(tc, result, "event_loop_tasks", MVM_load(&instance->stat_event_loop_tasks));
+        add_stat(tc, result, "fsa_reserved_bytes", fsa_reserved);
+        add_stat(tc, result, "fsa_used_bytes", fsa_used);
+        add_stat(tc, result, "threads", threads);
+        {
+            MVMObject *sites = MVM_spesh_deopt_sites(tc);
+            MVMString *key;
+            MVMROOT(tc, sites, {
+                key = MVM_string_ascii_decode_nt(tc, instance->VMString, "deopt_sites");
+            });
+            MVM_repr_bind_key_o(tc, result, key, sites);
+        }
+        {
+            MVMObject *loops = event_loop_stats(tc);
+            MVMString *key;
+            MVMROOT(tc, loops, {
+                key = MVM_string_ascii_decode_nt(tc, instance->VMString, "event_loops");
+            });
+            MVM_repr_bind_key_o(tc, result, key, loops);
+        }
+    });
+    return result;
+}
@@ -0,0 +1 @@
+MVMObject * MVM_vm_stats(MVMThreadContext *tc);
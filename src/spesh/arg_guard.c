@@ -101,8 +101,8 @@ static MVMuint32 add_type_check_node(MVMThreadContext *tc, MVMSpeshArgGuard *tre
     tree->nodes[tree->used_nodes].op = concrete
         ? MVM_SPESH_GUARD_OP_STABLE_CONC
         : MVM_SPESH_GUARD_OP_STABLE_TYPE;
-    assert(type->st != NULL);
-    tree->nodes[tree->used_nodes].st = type->st;
+    assert(STABLE(type) != NULL);
+    tree->nodes[tree->used_nodes].st = STABLE(type);
     tree->nodes[tree->used_nodes].yes = 0;
     tree->nodes[tree->used_nodes].no = 0;
     return tree->used_nodes++;
@@ -430,24 +430,24 @@ MVMint32 MVM_spesh_arg_guard_run_types(MVMThreadContext *tc, MVMSpeshArgGuard *a
             case MVM_SPESH_GUARD_OP_STABLE_CONC:
                 if (use_decont_type)
                     current_node = test->decont_type_concrete && test->decont_type &&
-                            test->decont_type->st == agn->st
+                            STABLE(test->decont_type) == agn->st
                         ? agn->yes
                         : agn->no;
                 else
                     current_node = test->type_concrete && test->type &&
-                            test->type->st == agn->st
+                            STABLE(test->type) == agn->st
                         ? agn->yes
                         : agn->no;
                 break;
             case MVM_SPESH_GUARD_OP_STABLE_TYPE:
                 if (use_decont_type)
                     current_node = !test->decont_type_concrete && test->decont_type &&
-                            test->decont_type->st == agn->st
+                            STABLE(test->decont_type) == agn->st
                         ? agn->yes
                         : agn->no;
                 else
                     current_node = !test->type_concrete && test->type &&
-                            test->type->st == agn->st
+                            STABLE(test->type) == agn->st
                         ? agn->yes
                         : agn->no;
                 break;
@@ -493,19 +493,19 @@ MVMint32 MVM_spesh_arg_guard_run(MVMThreadContext *tc, MVMSpeshArgGuard *ag,
                 current_node = agn->yes;
                 break;
             case MVM_SPESH_GUARD_OP_STABLE_CONC:
-                current_node = IS_CONCRETE(test) && test->st == agn->st
+                current_node = IS_CONCRETE(test) && STABLE(test) == agn->st
                     ? agn->yes
                     : agn->no;
                 break;
             case MVM_SPESH_GUARD_OP_STABLE_TYPE:
-                current_node = !IS_CONCRETE(test) && test->st == agn->st
+                current_node = !IS_CONCRETE(test) && STABLE(test) == agn->st
                     ? agn->yes
                     : agn->no;
                 break;
             case MVM_SPESH_GUARD_OP_DEREF_VALUE: {
                 /* TODO Use offset approach later to avoid these calls. */
                 MVMRegister dc;
-                test->st->container_spec->fetch(tc, test, &dc);
+                STABLE(test)->container_spec->fetch(tc, test, &dc);
                 test = dc.o;
                 current_node = test ? agn->yes : agn->no;
                 break;
@@ -549,14 +549,14 @@ MVMint32 MVM_spesh_arg_guard_run_callinfo(MVMThreadContext *tc, MVMSpeshArgGuard
                 if (use_decont_facts) {
                     current_node = facts->flags & MVM_SPESH_FACT_DECONT_CONCRETE &&
                             facts->flags & MVM_SPESH_FACT_KNOWN_DECONT_TYPE &&
-                            facts->decont_type->st == agn->st
+                            STABLE(facts->decont_type) == agn->st
                         ? agn->yes
                         : agn->no;
                 }
                 else {
                     current_node = facts->flags & MVM_SPESH_FACT_CONCRETE &&
                             facts->flags & MVM_SPESH_FACT_KNOWN_TYPE &&
-                            facts->type->st == agn->st
+                            STABLE(facts->type) == agn->st
                         ? agn->yes
                         : agn->no;
                 }
@@ -565,14 +565,14 @@ MVMint32 MVM_spesh_arg_guard_run_callinfo(MVMThreadContext *tc, MVMSpeshArgGuard
                 if (use_decont_facts) {
                     current_node = facts->flags & MVM_SPESH_FACT_DECONT_TYPEOBJ &&
                             facts->flags & MVM_SPESH_FACT_KNOWN_DECONT_TYPE &&
-                            facts->decont_type->st == agn->st
+                            STABLE(facts->decont_type) == agn->st
                         ? agn->yes
                         : agn->no;
                 }
                 else {
                     current_node = facts->flags & MVM_SPESH_FACT_TYPEOBJ &&
                             facts->flags & MVM_SPESH_FACT_KNOWN_TYPE &&
-                            facts->type->st == agn->st
+                            STABLE(facts->type) == agn->st
                         ? agn->yes
                         : agn->no;
                 }
@@ -3,8 +3,11 @@
 /* Maximum number of positional args we'll consider for optimization purposes. */
 #define MAX_POS_ARGS 8
 
-/* Maximum number of named args we'll consider for optimization purposes. */
-#define MAX_NAMED_ARGS 8
+/* Maximum number of named params we'll consider for optimization purposes.
+ * This bounds the named parameter instructions, not the nameds passed (the
+ * callsite interning limit takes care of those), so methods with long lists
+ * of optional nameds still get each one bound to a fixed argument slot. */
+#define MAX_NAMED_ARGS 32
 
 /* Adds facts for an object arg. */
 static void add_facts(MVMThreadContext *tc, MVMSpeshGraph *g, MVMint32 slot,
@@ -0,0 +1,1232 @@
+#include "moar.h"
+#include <ctype.h>
+
+/* The cache file has a line per specialization, with tab-separated fields:
+ *
+ *   filename  cuid  flags  names  types
+ *
+ * The flags are the callsite flags as comma-separated numbers, or "-" when
+ * there is no callsite. The names are those of the named arguments, also
+ * comma-separated. The types are "-" for a certain specialization, and
+ * otherwise an entry per flag, comma-separated, each being the fields of an
+ * MVMSpeshCacheType separated by "|" (an empty handle meaning no type). Any
+ * of these separators, along with "%" and control characters, are written
+ * in strings as a "%" and two hex digits. */
+
+/* A growable string to build lines in. */
+typedef struct {
+    char   *data;
+    size_t  len;
+    size_t  alloc;
+} CacheBuf;
+
+static void buf_append(CacheBuf *buf, const char *str, size_t len) {
+    if (buf->len + len + 1 > buf->alloc) {
+        buf->alloc = (buf->len + len + 1) * 2;
+        buf->data = MVM_realloc(buf->data, buf->alloc);
+    }
+    memcpy(buf->data + buf->len, str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+static void buf_printf(CacheBuf *buf, const char *fmt, MVMint64 value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), fmt, value);
+    buf_append(buf, tmp, len);
+}
+
+static void buf_append_escaped(CacheBuf *buf, const char *str) {
+    while (*str) {
+        unsigned char c = (unsigned char)*str++;
+        if (c < 0x20 || c == 0x7F || c == '%' || c == ',' || c == '|') {
+            char tmp[4];
+            snprintf(tmp, sizeof(tmp), "%%%02X", c);
+            buf_append(buf, tmp, 3);
+        }
+        else {
+            char ch = (char)c;
+            buf_append(buf, &ch, 1);
+        }
+    }
+}
+
+/* Escapes a VM string into a buffer. */
+static void buf_append_string(MVMThreadContext *tc, CacheBuf *buf, MVMString *str) {
+    char *c_str = MVM_string_utf8_encode_C_string(tc, str);
+    buf_append_escaped(buf, c_str);
+    MVM_free(c_str);
+}
+
+/* Undoes the escaping in place. */
+static char * unescape(char *str) {
+    char *in = str, *out = str;
+    while (*in) {
+        if (in[0] == '%' && isxdigit((unsigned char)in[1]) && isxdigit((unsigned char)in[2])) {
+            char hex[3] = { in[1], in[2], '\0' };
+            *out++ = (char)strtol(hex, NULL, 16);
+            in += 3;
+        }
+        else {
+            *out++ = *in++;
+        }
+    }
+    *out = '\0';
+    return str;
+}
+
+/* Splits a string at a separator, writing up to max pointers to the parts
+ * and returning how many there were. The string is modified. */
+static MVMuint32 split(char *str, char sep, char **parts, MVMuint32 max) {
+    MVMuint32 n = 0;
+    while (n < max) {
+        char *end = strchr(str, sep);
+        parts[n++] = str;
+        if (!end)
+            break;
+        *end = '\0';
+        str = end + 1;
+    }
+    return n;
+}
+
+/* Counts the parts of a string split at a separator. */
+static MVMuint32 count_parts(const char *str, char sep) {
+    MVMuint32 n = 1;
+    while ((str = strchr(str, sep)))
+        n++, str++;
+    return n;
+}
+
+/* FNV-1a, which is quite enough for telling frames apart. */
+static MVMuint64 hash_key(const char *key) {
+    MVMuint64 hash = 0xcbf29ce484222325ULL;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static MVMSpeshCacheFrame * find_frame(MVMSpeshCache *cache, const char *key, MVMuint64 hash) {
+    MVMSpeshCacheFrame *frame = cache->buckets[hash & (cache->num_buckets - 1)];
+    while (frame) {
+        if (frame->hash == hash && strcmp(frame->key, key) == 0)
+            return frame;
+        frame = frame->next;
+    }
+    return NULL;
+}
+
+/* Forms the key for a static frame, or returns NULL if the frame's comp
+ * unit has no filename and so can't be found again in a later run. */
+static char * frame_key(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    CacheBuf buf = { NULL, 0, 0 };
+    MVMString *filename = sf->body.cu->body.filename;
+    if (!filename || !sf->body.cuuid)
+        return NULL;
+    buf_append_string(tc, &buf, filename);
+    buf_append(&buf, "\t", 1);
+    buf_append_string(tc, &buf, sf->body.cuuid);
+    return buf.data;
+}
+
+/* Parses a type from the fields of a type tuple entry. */
+static MVMint32 parse_type(char *str, MVMSpeshCacheType *type) {
+    char *fields[7];
+    if (str[0] == '\0')
+        return 1; /* Not an object argument. */
+    if (split(str, '|', fields, 7) != 7)
+        return 0;
+    type->sc_handle = fields[0][0] ? strdup(unescape(fields[0])) : NULL;
+    type->idx = strtoll(fields[1], NULL, 10);
+    type->type_concrete = (MVMuint8)atoi(fields[2]);
+    type->decont_sc_handle = fields[3][0] ? strdup(unescape(fields[3])) : NULL;
+    type->decont_idx = strtoll(fields[4], NULL, 10);
+    type->decont_type_concrete = (MVMuint8)atoi(fields[5]);
+    type->rw_cont = (MVMuint8)atoi(fields[6]);
+    return 1;
+}
+
+static void destroy_entry(MVMSpeshCacheEntry *entry) {
+    MVMuint32 i;
+    if (entry->types) {
+        for (i = 0; i < entry->flag_count; i++) {
+            MVM_free(entry->types[i].sc_handle);
+            MVM_free(entry->types[i].decont_sc_handle);
+        }
+        MVM_free(entry->types);
+    }
+    for (i = 0; i < entry->num_names; i++)
+        MVM_free(entry->names[i]);
+    MVM_free(entry->names);
+    MVM_free(entry->flags);
+    MVM_free(entry->line);
+}
+
+/* Parses a line of the cache file into an entry, returning the frame key or
+ * NULL if the line is not valid. The line is modified. */
+static char * parse_line(char *line, MVMSpeshCacheEntry *entry) {
+    char *fields[5];
+    MVMuint32 i;
+    memset(entry, 0, sizeof(MVMSpeshCacheEntry));
+    if (split(line, '\t', fields, 5) != 5)
+        return NULL;
+
+    /* The callsite flags. */
+    if (strcmp(fields[2], "-") != 0) {
+        MVMuint32 num_flags = fields[2][0] ? count_parts(fields[2], ',') : 0;
+        char **flags = MVM_malloc((num_flags ? num_flags : 1) * sizeof(char *));
+        entry->has_callsite = 1;
+        if (num_flags) {
+            split(fields[2], ',', flags, num_flags);
+            entry->flags = MVM_malloc(num_flags);
+            for (i = 0; i < num_flags; i++)
+                entry->flags[i] = (MVMCallsiteEntry)atoi(flags[i]);
+        }
+        entry->flag_count = num_flags;
+        MVM_free(flags);
+    }
+
+    /* The names of named arguments. */
+    if (fields[3][0]) {
+        MVMuint32 num_names = count_parts(fields[3], ',');
+        entry->names = MVM_malloc(num_names * sizeof(char *));
+        split(fields[3], ',', entry->names, num_names);
+        for (i = 0; i < num_names; i++)
+            entry->names[i] = strdup(unescape(entry->names[i]));
+        entry->num_names = num_names;
+    }
+
+    /* The type tuple. */
+    if (strcmp(fields[4], "-") != 0) {
+        char **types;
+        if (!entry->flag_count || count_parts(fields[4], ',') != entry->flag_count) {
+            destroy_entry(entry);
+            return NULL;
+        }
+        types = MVM_malloc(entry->flag_count * sizeof(char *));
+        split(fields[4], ',', types, entry->flag_count);
+        entry->types = MVM_calloc(entry->flag_count, sizeof(MVMSpeshCacheType));
+        for (i = 0; i < entry->flag_count; i++) {
+            if (!parse_type(types[i], &(entry->types[i]))) {
+                MVM_free(types);
+                destroy_entry(entry);
+                return NULL;
+            }
+        }
+        MVM_free(types);
+    }
+
+    /* Put the tab back between the filename and comp unit ID, so what's at
+     * the start of the line is the key. */
+    fields[0][strlen(fields[0])] = '\t';
+    return fields[0];
+}
+
+/* Opens the cache file, loading any specializations remembered in it, and
+ * then rewriting it without those remembered more than once. */
+MVMSpeshCache * MVM_spesh_cache_open(MVMThreadContext *tc, const char *path) {
+    MVMSpeshCache *cache = MVM_calloc(1, sizeof(MVMSpeshCache));
+    MVMuint32 num_frames = 0, i;
+    FILE *fh = fopen(path, "r");
+
+    cache->num_buckets = 1024;
+    cache->buckets = MVM_calloc(cache->num_buckets, sizeof(MVMSpeshCacheFrame *));
+
+    if (fh) {
+        CacheBuf raw = { NULL, 0, 0 };
+        while (1) {
+            MVMSpeshCacheEntry entry;
+            MVMSpeshCacheFrame *frame;
+            char *key, *copy;
+            MVMuint64 hash;
+            int c;
+
+            /* Read a line. */
+            raw.len = 0;
+            while ((c = fgetc(fh)) != EOF && c != '\n') {
+                char ch = (char)c;
+                buf_append(&raw, &ch, 1);
+            }
+            if (c == EOF && raw.len == 0)
+                break;
+            if (raw.len == 0)
+                continue;
+
+            /* Parse it, and skip it if it's broken or a duplicate. */
+            copy = strdup(raw.data);
+            if (!(key = parse_line(raw.data, &entry))) {
+                MVM_free(copy);
+                continue;
+            }
+            hash = hash_key(key);
+            frame = find_frame(cache, key, hash);
+            if (frame) {
+                MVMuint32 dup = 0;
+                for (i = 0; i < MVM_VECTOR_ELEMS(frame->entries); i++)
+                    if (strcmp(frame->entries[i].line, copy) == 0) {
+                        dup = 1;
+                        break;
+                    }
+                if (dup) {
+                    entry.line = copy;
+                    destroy_entry(&entry);
+                    continue;
+                }
+            }
+            else {
+                MVMuint32 bucket = hash & (cache->num_buckets - 1);
+                frame = MVM_calloc(1, sizeof(MVMSpeshCacheFrame));
+                frame->key = strdup(key);
+                frame->hash = hash;
+                MVM_VECTOR_INIT(frame->entries, 1);
+                frame->next = cache->buckets[bucket];
+                cache->buckets[bucket] = frame;
+                num_frames++;
+            }
+            entry.line = copy;
+            MVM_VECTOR_PUSH(frame->entries, entry);
+        }
+        MVM_free(raw.data);
+        fclose(fh);
+    }
+
+    /* Write back what we kept, and leave the file open to add to. */
+    cache->fh = fopen(path, "w");
+    if (!cache->fh) {
+        fprintf(stderr, "MoarVM: Could not open specialization cache file %s: %s\n",
+            path, strerror(errno));
+        MVM_spesh_cache_destroy(tc, cache);
+        return NULL;
+    }
+    for (i = 0; i < cache->num_buckets; i++) {
+        MVMSpeshCacheFrame *frame = cache->buckets[i];
+        while (frame) {
+            MVMuint32 j;
+            for (j = 0; j < MVM_VECTOR_ELEMS(frame->entries); j++)
+                fprintf(cache->fh, "%s\n", frame->entries[j].line);
+            frame = frame->next;
+        }
+    }
+    fflush(cache->fh);
+    return cache;
+}
+
+/* Closes the cache file and frees the cache. */
+void MVM_spesh_cache_destroy(MVMThreadContext *tc, MVMSpeshCache *cache) {
+    MVMuint32 i;
+    for (i = 0; i < cache->num_buckets; i++) {
+        MVMSpeshCacheFrame *frame = cache->buckets[i];
+        while (frame) {
+            MVMSpeshCacheFrame *next = frame->next;
+            MVMuint32 j;
+            for (j = 0; j < MVM_VECTOR_ELEMS(frame->entries); j++)
+                destroy_entry(&(frame->entries[j]));
+            MVM_VECTOR_DESTROY(frame->entries);
+            MVM_free(frame->key);
+            MVM_free(frame);
+            frame = next;
+        }
+    }
+    if (cache->fh)
+        fclose(cache->fh);
+    MVM_free(cache->buckets);
+    MVM_free(cache);
+}
+
+/* Appends the handle and index of a type to a buffer. Returns 0 if the type
+ * is not in a serialization context, and so can't be found again. */
+static MVMint32 append_type(MVMThreadContext *tc, CacheBuf *buf, MVMObject *type) {
+    MVMSerializationContext *sc;
+    MVMint64 idx;
+    if (!type)
+        return 1;
+    sc = MVM_sc_get_obj_sc(tc, type);
+    if (!sc || !sc->body->handle)
+        return 0;
+    idx = MVM_sc_get_idx_in_sc(&(type->header));
+    if (idx >= (MVMint64)sc->body->num_objects || sc->body->root_objects[idx] != type)
+        return 0;
+    buf_append_string(tc, buf, sc->body->handle);
+    buf_printf(buf, "|%"PRId64, idx);
+    return 1;
+}
+
+/* Remembers a specialization that was just produced in the cache file. This
+ * is called on a spesh worker, which will not GC while it's running. */
+void MVM_spesh_cache_record(MVMThreadContext *tc, MVMSpeshPlanned *p) {
+    MVMSpeshCache *cache = tc->instance->spesh_cache;
+    MVMCallsite *cs = p->cs_stats->cs;
+    CacheBuf buf = { NULL, 0, 0 };
+    char *key;
+    MVMuint32 i;
+    if (!cache || !(key = frame_key(tc, p->sf)))
+        return;
+    buf_append(&buf, key, strlen(key));
+    MVM_free(key);
+
+    /* The callsite. */
+    buf_append(&buf, "\t", 1);
+    if (cs) {
+        MVMuint16 num_nameds = MVM_callsite_num_nameds(tc, cs);
+        if (cs->has_flattening || (num_nameds && !cs->arg_names)) {
+            MVM_free(buf.data);
+            return;
+        }
+        for (i = 0; i < cs->flag_count; i++)
+            buf_printf(&buf, i ? ",%"PRId64 : "%"PRId64, cs->arg_flags[i]);
+        buf_append(&buf, "\t", 1);
+        for (i = 0; i < num_nameds; i++) {
+            if (i)
+                buf_append(&buf, ",", 1);
+            buf_append_string(tc, &buf, cs->arg_names[i]);
+        }
+    }
+    else {
+        buf_append(&buf, "-\t", 2);
+    }
+
+    /* The type tuple. */
+    buf_append(&buf, "\t", 1);
+    if (p->type_tuple) {
+        for (i = 0; i < cs->flag_count; i++) {
+            MVMSpeshStatsType *type = &(p->type_tuple[i]);
+            if (i)
+                buf_append(&buf, ",", 1);
+            if ((cs->arg_flags[i] & MVM_CALLSITE_ARG_OBJ) && type->type) {
+                if (!append_type(tc, &buf, type->type)) {
+                    MVM_free(buf.data);
+                    return;
+                }
+                buf_printf(&buf, "|%"PRId64"|", type->type_concrete);
+                if (type->decont_type) {
+                    if (!append_type(tc, &buf, type->decont_type)) {
+                        MVM_free(buf.data);
+                        return;
+                    }
+                }
+                else {
+                    buf_append(&buf, "|0", 2);
+                }
+                buf_printf(&buf, "|%"PRId64, type->decont_type_concrete);
+                buf_printf(&buf, "|%"PRId64, type->rw_cont);
+            }
+        }
+    }
+    else {
+        buf_append(&buf, "-", 1);
+    }
+
+    /* Write it as a single line, so lines from several workers don't get
+     * interleaved. */
+    buf_append(&buf, "\n", 1);
+    fputs(buf.data, cache->fh);
+    fflush(cache->fh);
+    MVM_free(buf.data);
+}
+
+/* Called when a static frame is first prepared for invocation. If there are
+ * specializations remembered for it in either cache, sends it to the spesh
+ * worker to produce or install them. */
+void MVM_spesh_cache_frame_prepared(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMSpeshCache *cache = tc->instance->spesh_cache;
+    MVMint32 wanted = 0;
+    char *key;
+    if (!tc->instance->spesh_queue)
+        return;
+    if (cache && (key = frame_key(tc, sf))) {
+        MVMSpeshCacheFrame *frame = find_frame(cache, key, hash_key(key));
+        MVM_free(key);
+        if (frame && MVM_trycas(&(frame->queued), 0, 1))
+            wanted = 1;
+    }
+    if (!wanted && tc->instance->spesh_code_cache_dir)
+        wanted = MVM_spesh_code_cache_has(tc, sf);
+    if (wanted)
+        MVM_repr_push_o(tc, tc->instance->spesh_queue, (MVMObject *)sf);
+}
+
+/* Finds an interned callsite that matches a remembered one. */
+static MVMCallsite * find_callsite(MVMThreadContext *tc, MVMSpeshCacheEntry *entry) {
+    MVMCallsiteInterns *interns = tc->instance->callsite_interns;
+    MVMCallsite *found = NULL;
+    MVMint32 i;
+    if (entry->flag_count >= MVM_INTERN_ARITY_LIMIT)
+        return NULL;
+    uv_mutex_lock(&tc->instance->mutex_callsite_interns);
+    for (i = 0; i < interns->num_by_arity[entry->flag_count] && !found; i++) {
+        MVMCallsite *cs = interns->by_arity[entry->flag_count][i];
+        MVMuint32 j;
+        if (entry->flag_count && memcmp(cs->arg_flags, entry->flags, entry->flag_count) != 0)
+            continue;
+        if (MVM_callsite_num_nameds(tc, cs) != entry->num_names)
+            continue;
+        for (j = 0; j < entry->num_names; j++) {
+            char *name = MVM_string_utf8_encode_C_string(tc, cs->arg_names[j]);
+            MVMint32 same = strcmp(name, entry->names[j]) == 0;
+            MVM_free(name);
+            if (!same)
+                break;
+        }
+        if (j == entry->num_names)
+            found = cs;
+    }
+    uv_mutex_unlock(&tc->instance->mutex_callsite_interns);
+    return found;
+}
+
+/* Finds the serialization context with a handle. May allocate. */
+static MVMSerializationContextBody * find_sc(MVMThreadContext *tc, const char *handle) {
+    MVMSerializationContext *sc = MVM_sc_find_by_handle(tc,
+        MVM_string_utf8_decode(tc, tc->instance->VMString, handle, strlen(handle)));
+    return sc ? sc->body : NULL;
+}
+
+/* Finds an object in a serialization context, provided it has already been
+ * deserialized; we don't want to cause deserialization from here. */
+static MVMObject * find_object(MVMThreadContext *tc, MVMSerializationContextBody *scb, MVMint64 idx) {
+    return scb && scb->sc ? MVM_sc_try_get_object(tc, scb->sc, idx) : NULL;
+}
+
+/* Adds a remembered specialization to a plan, provided its callsite and all
+ * of its types can be found in this run, and it wasn't produced already. */
+static void plan_entry(MVMThreadContext *tc, MVMSpeshPlan *plan, MVMStaticFrame *sf,
+        MVMSpeshCacheEntry *entry) {
+    MVMStaticFrameSpesh *spesh;
+    MVMSpeshStatsType *type_tuple = NULL;
+    MVMSpeshPlanned *p;
+    MVMCallsite *cs = NULL;
+    MVMuint32 i;
+
+    if (entry->has_callsite && !(cs = find_callsite(tc, entry)))
+        return;
+
+    /* Look up the serialization contexts first, since that may GC, and then
+     * the types, which won't. */
+    if (entry->types) {
+        MVMSerializationContextBody **scbs = MVM_calloc(2 * entry->flag_count,
+            sizeof(MVMSerializationContextBody *));
+        MVMint32 ok = 1;
+        for (i = 0; i < entry->flag_count && ok; i++) {
+            MVMSpeshCacheType *t = &(entry->types[i]);
+            if (t->sc_handle && !(scbs[2 * i] = find_sc(tc, t->sc_handle)))
+                ok = 0;
+            if (t->decont_sc_handle && !(scbs[2 * i + 1] = find_sc(tc, t->decont_sc_handle)))
+                ok = 0;
+        }
+        if (ok) {
+            type_tuple = MVM_calloc(entry->flag_count, sizeof(MVMSpeshStatsType));
+            for (i = 0; i < entry->flag_count && ok; i++) {
+                MVMSpeshCacheType *t = &(entry->types[i]);
+                if (t->sc_handle && !(type_tuple[i].type = find_object(tc, scbs[2 * i], t->idx)))
+                    ok = 0;
+                if (t->decont_sc_handle && !(type_tuple[i].decont_type =
+                        find_object(tc, scbs[2 * i + 1], t->decont_idx)))
+                    ok = 0;
+                type_tuple[i].type_concrete = t->type_concrete;
+                type_tuple[i].decont_type_concrete = t->decont_type_concrete;
+                type_tuple[i].rw_cont = t->rw_cont;
+            }
+        }
+        MVM_free(scbs);
+        if (!ok) {
+            MVM_free(type_tuple);
+            return;
+        }
+    }
+
+    /* Skip it if there's already a matching candidate. */
+    spesh = sf->body.spesh;
+    for (i = 0; i < spesh->body.num_spesh_candidates; i++) {
+        MVMSpeshCandidate *cand = spesh->body.spesh_candidates[i];
+        if (cand->cs != cs || cand->is_baseline)
+            continue;
+        if (type_tuple
+                ? cand->type_tuple && memcmp(cand->type_tuple, type_tuple,
+                    cs->flag_count * sizeof(MVMSpeshStatsType)) == 0
+                : !cand->type_tuple) {
+            MVM_free(type_tuple);
+            return;
+        }
+    }
+
+    /* Add it to the plan. */
+    if (plan->num_planned == plan->alloc_planned) {
+        plan->alloc_planned = plan->alloc_planned ? 2 * plan->alloc_planned : 4;
+        plan->planned = MVM_realloc(plan->planned,
+            plan->alloc_planned * sizeof(MVMSpeshPlanned));
+    }
+    entry->cs_stats.cs = cs;
+    p = &(plan->planned[plan->num_planned]);
+    memset(p, 0, sizeof(MVMSpeshPlanned));
+    p->kind = type_tuple ? MVM_SPESH_PLANNED_OBSERVED_TYPES : MVM_SPESH_PLANNED_CERTAIN;
+    p->sf = sf;
+    p->cs_stats = &(entry->cs_stats);
+    p->type_tuple = type_tuple;
+    plan->num_planned++;
+}
+
+/* Forms a plan with the remembered specializations of a static frame. The
+ * plan is installed as the current one while it is built, so the frame and
+ * types in it get marked should we GC while looking up the serialization
+ * contexts. */
+MVMSpeshPlan * MVM_spesh_cache_plan(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMSpeshCache *cache = tc->instance->spesh_cache;
+    MVMSpeshPlan *plan = MVM_calloc(1, sizeof(MVMSpeshPlan));
+    MVMSpeshCacheFrame *frame;
+    char *key;
+    MVMuint32 i;
+    tc->instance->spesh_plan = plan;
+    if (!cache || !(key = frame_key(tc, sf)))
+        return plan;
+    frame = find_frame(cache, key, hash_key(key));
+    MVM_free(key);
+    if (!frame)
+        return plan;
+    MVMROOT(tc, sf, {
+        for (i = 0; i < MVM_VECTOR_ELEMS(frame->entries); i++)
+            plan_entry(tc, plan, sf, &(frame->entries[i]));
+    });
+    return plan;
+}
+
+/* The spesh code cache files start with a header of the magic string, an
+ * integer to check we're on a machine of the same byte order, what build of
+ * the VM wrote them, and the hash and size of the comp unit's bytecode. The
+ * build is told by the version string, a hash of the op names in opcode order
+ * (since ops may be renumbered between builds of the same version) and the
+ * sizes of the structs that are written out as they are in memory. Then come the records, each a 32-bit
+ * size followed by the data, which is:
+ *
+ *   frame ID, callsite (as MVMSpeshCacheEntry), type tuple, bytecode,
+ *   handlers, deopts, deopt named used bit field, deopt usage info, locals
+ *   and lexicals counts and types, spesh slots
+ *
+ * Strings are a 32-bit length and the UTF-8 bytes. Types and spesh slots are
+ * a kind byte (0 for none, 1 for an object, 2 for an STable) and for the
+ * others the handle of its SC and the index in it. */
+#define CODE_CACHE_MAGIC        "MVMSPCC2"
+#define CODE_CACHE_BYTE_ORDER   0x01020304
+#define CODE_CACHE_REF_NONE     0
+#define CODE_CACHE_REF_OBJECT   1
+#define CODE_CACHE_REF_STABLE   2
+
+static void write_u8(CacheBuf *buf, MVMuint8 v)   { buf_append(buf, (char *)&v, 1); }
+static void write_u16(CacheBuf *buf, MVMuint16 v) { buf_append(buf, (char *)&v, 2); }
+static void write_u32(CacheBuf *buf, MVMuint32 v) { buf_append(buf, (char *)&v, 4); }
+static void write_u64(CacheBuf *buf, MVMuint64 v) { buf_append(buf, (char *)&v, 8); }
+static void write_cstr(CacheBuf *buf, const char *str) {
+    MVMuint32 len = strlen(str);
+    write_u32(buf, len);
+    buf_append(buf, str, len);
+}
+static void write_str(MVMThreadContext *tc, CacheBuf *buf, MVMString *str) {
+    char *c_str = MVM_string_utf8_encode_C_string(tc, str);
+    write_cstr(buf, c_str);
+    MVM_free(c_str);
+}
+
+/* Reads from a record, noting if we ran off the end of it. */
+typedef struct {
+    MVMuint8 *pos;
+    MVMuint8 *end;
+    MVMint32  ok;
+} CacheReader;
+
+static void read_bytes(CacheReader *r, void *out, size_t len) {
+    if (r->ok && (size_t)(r->end - r->pos) >= len) {
+        memcpy(out, r->pos, len);
+        r->pos += len;
+    }
+    else {
+        memset(out, 0, len);
+        r->ok = 0;
+    }
+}
+static MVMuint8  read_u8(CacheReader *r)  { MVMuint8 v;  read_bytes(r, &v, 1); return v; }
+static MVMuint16 read_u16(CacheReader *r) { MVMuint16 v; read_bytes(r, &v, 2); return v; }
+static MVMuint32 read_u32(CacheReader *r) { MVMuint32 v; read_bytes(r, &v, 4); return v; }
+static MVMuint64 read_u64(CacheReader *r) { MVMuint64 v; read_bytes(r, &v, 8); return v; }
+static char * read_cstr(CacheReader *r) {
+    MVMuint32 len = read_u32(r);
+    char *str;
+    if (!r->ok || (size_t)(r->end - r->pos) < len) {
+        r->ok = 0;
+        return NULL;
+    }
+    str = MVM_malloc(len + 1);
+    read_bytes(r, str, len);
+    str[len] = '\0';
+    return str;
+}
+static void * read_array(CacheReader *r, size_t size) {
+    void *arr;
+    if (!r->ok || (size_t)(r->end - r->pos) < size) {
+        r->ok = 0;
+        return NULL;
+    }
+    if (size == 0)
+        return NULL;
+    arr = MVM_malloc(size);
+    read_bytes(r, arr, size);
+    return arr;
+}
+
+/* Writes a reference to an object or STable, returning 0 if it isn't in the
+ * root set of a serialization context, and so can't be found again. Code
+ * objects live in a separate list of an SC, and are not kept. */
+static MVMint32 write_ref(MVMThreadContext *tc, CacheBuf *buf, MVMCollectable *col) {
+    MVMSerializationContext *sc;
+    MVMuint32 idx;
+    if (!col) {
+        write_u8(buf, CODE_CACHE_REF_NONE);
+        return 1;
+    }
+    sc = MVM_sc_get_collectable_sc(tc, col);
+    idx = MVM_sc_get_idx_in_sc(col);
+    if (!sc || !sc->body->handle || idx == ~(MVMuint32)0)
+        return 0;
+    if (col->flags1 & MVM_CF_STABLE) {
+        if (idx >= sc->body->num_stables || sc->body->root_stables[idx] != (MVMSTable *)col)
+            return 0;
+        write_u8(buf, CODE_CACHE_REF_STABLE);
+    }
+    else {
+        if (REPR((MVMObject *)col)->ID == MVM_REPR_ID_MVMCode
+                || idx >= sc->body->num_objects
+                || sc->body->root_objects[idx] != (MVMObject *)col)
+            return 0;
+        write_u8(buf, CODE_CACHE_REF_OBJECT);
+    }
+    write_str(tc, buf, sc->body->handle);
+    write_u64(buf, idx);
+    return 1;
+}
+
+/* A reference read back in, resolved in two passes: first the SC, which may
+ * GC, and then the object or STable itself, which will not. */
+typedef struct {
+    MVMuint8                     kind;
+    char                        *handle;
+    MVMint64                     idx;
+    MVMSerializationContextBody *scb;
+} CacheRef;
+
+static void read_ref(CacheReader *r, CacheRef *ref) {
+    ref->kind = read_u8(r);
+    ref->handle = NULL;
+    ref->scb = NULL;
+    if (ref->kind != CODE_CACHE_REF_NONE) {
+        ref->handle = read_cstr(r);
+        ref->idx = (MVMint64)read_u64(r);
+    }
+}
+static MVMCollectable * resolve_ref(MVMThreadContext *tc, CacheRef *ref, MVMint32 *ok) {
+    MVMCollectable *col = NULL;
+    switch (ref->kind) {
+        case CODE_CACHE_REF_NONE:
+            return NULL;
+        case CODE_CACHE_REF_OBJECT:
+            col = (MVMCollectable *)find_object(tc, ref->scb, ref->idx);
+            break;
+        case CODE_CACHE_REF_STABLE:
+            if (ref->scb && ref->scb->sc)
+                col = (MVMCollectable *)MVM_sc_try_get_stable(tc, ref->scb->sc, ref->idx);
+            break;
+    }
+    if (!col)
+        *ok = 0;
+    return col;
+}
+
+/* Hashes the bytecode of a comp unit. */
+static MVMuint64 hash_cu(MVMCompUnit *cu) {
+    MVMuint64 hash = 0xcbf29ce484222325ULL;
+    MVMuint8 *data = cu->body.data_start;
+    MVMuint32 i;
+    for (i = 0; i < cu->body.data_size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static int compare_records(const void *a, const void *b) {
+    return strcmp(((const MVMSpeshCodeCacheRecord *)a)->cuuid,
+        ((const MVMSpeshCodeCacheRecord *)b)->cuuid);
+}
+
+/* Loads the records kept for a comp unit. A file that's for some other
+ * version of the comp unit is removed. */
+/* Hashes the names and operands of all ops in opcode order, so a cache
+ * written by a build with the ops numbered differently is not used. */
+static MVMuint64 hash_ops(void) {
+    MVMuint64 hash = 0xcbf29ce484222325ULL;
+    const MVMOpInfo *info;
+    unsigned short op = 0;
+    while ((info = MVM_op_get_op(op++))) {
+        const char *name = info->name;
+        MVMuint16 i;
+        while (*name) {
+            hash ^= (MVMuint8)*name++;
+            hash *= 0x100000001b3ULL;
+        }
+        for (i = 0; i < info->num_operands; i++) {
+            hash ^= info->operands[i];
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= 0xFF;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* Writes the header of a new code cache file. */
+static void write_header(FILE *fh, MVMSpeshCodeCacheUnit *unit, MVMuint32 data_size) {
+    MVMuint32 byte_order  = CODE_CACHE_BYTE_ORDER;
+    MVMuint32 version_len = (MVMuint32)strlen(MVM_VERSION);
+    MVMuint64 ops_hash    = hash_ops();
+    MVMuint32 sizes[3];
+    sizes[0] = sizeof(MVMFrameHandler);
+    sizes[1] = sizeof(MVMint32);
+    sizes[2] = sizeof(MVMuint16);
+    fwrite(CODE_CACHE_MAGIC, 8, 1, fh);
+    fwrite(&byte_order, 4, 1, fh);
+    fwrite(&version_len, 4, 1, fh);
+    fwrite(MVM_VERSION, 1, version_len, fh);
+    fwrite(&ops_hash, 8, 1, fh);
+    fwrite(sizes, 4, 3, fh);
+    fwrite(&(unit->hash), 8, 1, fh);
+    fwrite(&data_size, 4, 1, fh);
+}
+
+/* Reads the header of a code cache file, returning non-zero if it was
+ * written by the same build of the VM for the same bytecode. */
+static MVMint32 check_header(FILE *fh, MVMSpeshCodeCacheUnit *unit, MVMuint32 data_size) {
+    char magic[8];
+    char version[64];
+    MVMuint32 byte_order = 0, version_len = 0, size = 0;
+    MVMuint32 sizes[3];
+    MVMuint64 ops_hash = 0, hash = 0;
+    if (fread(magic, 8, 1, fh) != 1 || memcmp(magic, CODE_CACHE_MAGIC, 8) != 0)
+        return 0;
+    if (fread(&byte_order, 4, 1, fh) != 1 || byte_order != CODE_CACHE_BYTE_ORDER)
+        return 0;
+    if (fread(&version_len, 4, 1, fh) != 1 || version_len != strlen(MVM_VERSION)
+            || version_len > sizeof(version)
+            || fread(version, 1, version_len, fh) != version_len
+            || memcmp(version, MVM_VERSION, version_len) != 0)
+        return 0;
+    if (fread(&ops_hash, 8, 1, fh) != 1 || ops_hash != hash_ops())
+        return 0;
+    if (fread(sizes, 4, 3, fh) != 3 || sizes[0] != sizeof(MVMFrameHandler)
+            || sizes[1] != sizeof(MVMint32) || sizes[2] != sizeof(MVMuint16))
+        return 0;
+    return fread(&hash, 8, 1, fh) == 1 && hash == unit->hash
+        && fread(&size, 4, 1, fh) == 1 && size == data_size;
+}
+
+static MVMSpeshCodeCacheUnit * load_unit(MVMThreadContext *tc, MVMCompUnit *cu) {
+    MVMSpeshCodeCacheUnit *unit = MVM_calloc(1, sizeof(MVMSpeshCodeCacheUnit));
+    const char *dir = tc->instance->spesh_code_cache_dir;
+    size_t path_len = strlen(dir) + 1 + 16 + 6 + 1;
+    MVMuint32 alloc_records = 0;
+    FILE *fh;
+    int init_stat;
+
+    if ((init_stat = uv_mutex_init(&unit->lock)) < 0) {
+        MVM_free(unit);
+        return NULL;
+    }
+    unit->hash = hash_cu(cu);
+    unit->path = MVM_malloc(path_len);
+    snprintf(unit->path, path_len, "%s/%016"PRIx64".spesh", dir, unit->hash);
+
+    if ((fh = fopen(unit->path, "rb"))) {
+        if (check_header(fh, unit, cu->body.data_size)) {
+            MVMuint32 rec_size;
+            while (fread(&rec_size, 4, 1, fh) == 1) {
+                MVMSpeshCodeCacheRecord rec;
+                CacheReader r;
+                memset(&rec, 0, sizeof(rec));
+                rec.data = MVM_malloc(rec_size ? rec_size : 1);
+                rec.size = rec_size;
+                if (fread(rec.data, 1, rec_size, fh) != rec_size) {
+                    MVM_free(rec.data);
+                    break;
+                }
+                r.pos = rec.data;
+                r.end = rec.data + rec_size;
+                r.ok = 1;
+                if (!(rec.cuuid = read_cstr(&r))) {
+                    MVM_free(rec.data);
+                    continue;
+                }
+                if (unit->num_records == alloc_records) {
+                    alloc_records = alloc_records ? 2 * alloc_records : 16;
+                    unit->records = MVM_realloc(unit->records,
+                        alloc_records * sizeof(MVMSpeshCodeCacheRecord));
+                }
+                unit->records[unit->num_records++] = rec;
+            }
+            fclose(fh);
+        }
+        else {
+            fclose(fh);
+            remove(unit->path);
+        }
+    }
+
+    if (unit->num_records)
+        qsort(unit->records, unit->num_records, sizeof(MVMSpeshCodeCacheRecord),
+            compare_records);
+    return unit;
+}
+
+/* Gets the code cache of a comp unit, loading it the first time. Returns
+ * NULL if there's no code cache, or another thread is loading it just now. */
+static MVMSpeshCodeCacheUnit * get_unit(MVMThreadContext *tc, MVMCompUnit *cu) {
+    if (!tc->instance->spesh_code_cache_dir)
+        return NULL;
+    if (MVM_load(&(cu->body.spesh_code_cache_state)) != 2) {
+        if (!MVM_trycas(&(cu->body.spesh_code_cache_state), 0, 1))
+            return NULL;
+        cu->body.spesh_code_cache = load_unit(tc, cu);
+        MVM_store(&(cu->body.spesh_code_cache_state), 2);
+    }
+    return cu->body.spesh_code_cache;
+}
+
+void MVM_spesh_code_cache_unit_destroy(MVMThreadContext *tc, MVMSpeshCodeCacheUnit *unit) {
+    MVMuint32 i;
+    for (i = 0; i < unit->num_records; i++) {
+        MVM_free(unit->records[i].cuuid);
+        MVM_free(unit->records[i].data);
+    }
+    MVM_free(unit->records);
+    MVM_free(unit->path);
+    uv_mutex_destroy(&unit->lock);
+    MVM_free(unit);
+}
+
+/* Finds the index of the first record for a frame ID, or -1 if none. */
+static MVMint64 find_records(MVMSpeshCodeCacheUnit *unit, const char *cuuid) {
+    MVMint64 lo = 0, hi = (MVMint64)unit->num_records - 1, found = -1;
+    while (lo <= hi) {
+        MVMint64 mid = (lo + hi) / 2;
+        int cmp = strcmp(unit->records[mid].cuuid, cuuid);
+        if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else {
+            if (cmp == 0)
+                found = mid;
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+/* Checks if there is code kept for a static frame that wasn't installed. */
+MVMint32 MVM_spesh_code_cache_has(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMSpeshCodeCacheUnit *unit = get_unit(tc, sf->body.cu);
+    MVMint32 result = 0;
+    char *cuuid;
+    MVMint64 i;
+    if (!unit || !unit->num_records || !sf->body.cuuid)
+        return 0;
+    cuuid = MVM_string_utf8_encode_C_string(tc, sf->body.cuuid);
+    for (i = find_records(unit, cuuid); i >= 0 && (MVMuint32)i < unit->num_records
+            && strcmp(unit->records[i].cuuid, cuuid) == 0; i++) {
+        if (!MVM_load(&(unit->records[i].used))) {
+            result = 1;
+            break;
+        }
+    }
+    MVM_free(cuuid);
+    return result;
+}
+
+/* Keeps a candidate that was just installed in the code cache, provided it
+ * doesn't have inlines or replaced allocations, and everything it refers to
+ * can be found again. This is called on a spesh worker, which will not GC
+ * while it's running. */
+void MVM_spesh_code_cache_record(MVMThreadContext *tc, MVMStaticFrame *sf, MVMSpeshCandidate *cand) {
+    MVMSpeshCodeCacheUnit *unit = get_unit(tc, sf->body.cu);
+    MVMCallsite *cs = cand->cs;
+    CacheBuf buf = { NULL, 0, 0 };
+    MVMuint32 i, n;
+    FILE *fh;
+
+    if (!unit || !sf->body.cuuid || cand->num_inlines
+            || MVM_VECTOR_ELEMS(cand->deopt_pea.materialize_info)
+            || MVM_VECTOR_ELEMS(cand->deopt_pea.deopt_point))
+        return;
+    if (cs && (cs->has_flattening || (MVM_callsite_num_nameds(tc, cs) && !cs->arg_names)))
+        return;
+
+    /* Frame ID and callsite. */
+    write_str(tc, &buf, sf->body.cuuid);
+    write_u8(&buf, cs ? 1 : 0);
+    if (cs) {
+        MVMuint16 num_nameds = MVM_callsite_num_nameds(tc, cs);
+        write_u16(&buf, cs->flag_count);
+        buf_append(&buf, (char *)cs->arg_flags, cs->flag_count);
+        write_u16(&buf, num_nameds);
+        for (i = 0; i < num_nameds; i++)
+            write_str(tc, &buf, cs->arg_names[i]);
+    }
+
+    /* Type tuple. */
+    write_u8(&buf, cand->type_tuple ? 1 : 0);
+    if (cand->type_tuple) {
+        for (i = 0; i < cs->flag_count; i++) {
+            MVMSpeshStatsType *t = &(cand->type_tuple[i]);
+            MVMint32 is_obj = cs->arg_flags[i] & MVM_CALLSITE_ARG_OBJ;
+            if (!write_ref(tc, &buf, is_obj ? (MVMCollectable *)t->type : NULL)
+                    || !write_ref(tc, &buf, is_obj ? (MVMCollectable *)t->decont_type : NULL))
+                goto cannot_keep;
+            write_u8(&buf, t->type_concrete);
+            write_u8(&buf, t->decont_type_concrete);
+            write_u8(&buf, t->rw_cont);
+        }
+    }
+
+    /* The code, handlers and deopt information. */
+    write_u32(&buf, cand->bytecode_size);
+    buf_append(&buf, (char *)cand->bytecode, cand->bytecode_size);
+    write_u32(&buf, cand->num_handlers);
+    buf_append(&buf, (char *)cand->handlers, cand->num_handlers * sizeof(MVMFrameHandler));
+    write_u32(&buf, cand->num_deopts);
+    buf_append(&buf, (char *)cand->deopts, 2 * cand->num_deopts * sizeof(MVMint32));
+    write_u64(&buf, cand->deopt_named_used_bit_field);
+    n = 0;
+    if (cand->deopt_usage_info) {
+        MVMint32 *info = cand->deopt_usage_info;
+        while (info[n] != -1) {
+            n += 2 + info[n + 1];
+        }
+        n++;
+    }
+    write_u32(&buf, n);
+    buf_append(&buf, (char *)cand->deopt_usage_info, n * sizeof(MVMint32));
+
+    /* Locals and lexicals. */
+    write_u16(&buf, cand->num_locals);
+    write_u16(&buf, cand->num_lexicals);
+    write_u8(&buf, cand->local_types ? 1 : 0);
+    if (cand->local_types)
+        buf_append(&buf, (char *)cand->local_types, cand->num_locals * sizeof(MVMuint16));
+    write_u8(&buf, cand->lexical_types ? 1 : 0);
+    if (cand->lexical_types)
+        buf_append(&buf, (char *)cand->lexical_types, cand->num_lexicals * sizeof(MVMuint16));
+
+    /* Spesh slots. */
+    write_u32(&buf, cand->num_spesh_slots);
+    for (i = 0; i < cand->num_spesh_slots; i++)
+        if (!write_ref(tc, &buf, cand->spesh_slots[i]))
+            goto cannot_keep;
+
+    /* Append it to the file, writing the header first if it's new. */
+    uv_mutex_lock(&unit->lock);
+    if ((fh = fopen(unit->path, "ab"))) {
+        MVMuint32 size = (MVMuint32)buf.len;
+        fseek(fh, 0, SEEK_END);
+        if (ftell(fh) == 0)
+            write_header(fh, unit, sf->body.cu->body.data_size);
+        fwrite(&size, 4, 1, fh);
+        fwrite(buf.data, 1, buf.len, fh);
+        fclose(fh);
+    }
+    uv_mutex_unlock(&unit->lock);
+
+  cannot_keep:
+    MVM_free(buf.data);
+}
+
+/* Reads a record back into a candidate, resolving everything it refers to.
+ * Returns NULL if the record is broken, or something it refers to can't be
+ * found, or there's already a candidate for the same callsite and types. */
+static MVMSpeshCandidate * read_candidate(MVMThreadContext *tc, MVMStaticFrame *sf,
+        MVMSpeshCodeCacheRecord *rec) {
+    MVMSpeshCandidate *cand = NULL;
+    MVMSpeshCacheEntry entry;
+    CacheRef *refs = NULL;
+    MVMuint8 *concs = NULL;
+    MVMuint32 num_refs = 0, num_slots = 0, i;
+    MVMint32 has_types, ok = 1;
+    MVMCallsite *cs = NULL;
+    CacheReader r;
+    char *cuuid;
+
+    r.pos = rec->data;
+    r.end = rec->data + rec->size;
+    r.ok = 1;
+    memset(&entry, 0, sizeof(entry));
+    cuuid = read_cstr(&r);
+    MVM_free(cuuid);
+
+    /* The callsite. */
+    entry.has_callsite = read_u8(&r);
+    if (entry.has_callsite) {
+        entry.flag_count = read_u16(&r);
+        entry.flags = read_array(&r, entry.flag_count);
+        entry.num_names = read_u16(&r);
+        if (r.ok && entry.num_names) {
+            entry.names = MVM_calloc(entry.num_names, sizeof(char *));
+            for (i = 0; i < entry.num_names; i++)
+                entry.names[i] = read_cstr(&r);
+        }
+        if (r.ok && !(cs = find_callsite(tc, &entry)))
+            ok = 0;
+    }
+    entry.line = NULL;
+    destroy_entry(&entry);
+    if (!r.ok || !ok)
+        return NULL;
+
+    cand = MVM_calloc(1, sizeof(MVMSpeshCandidate));
+    cand->cs = cs;
+
+    /* The type tuple; we note the references for now, with the three flags
+     * for each argument. */
+    has_types = read_u8(&r);
+    if (has_types) {
+        if (!cs)
+            goto broken;
+        refs = MVM_calloc(2 * cs->flag_count, sizeof(CacheRef));
+        concs = MVM_calloc(3 * cs->flag_count, 1);
+        for (i = 0; i < cs->flag_count; i++) {
+            read_ref(&r, &refs[num_refs++]);
+            read_ref(&r, &refs[num_refs++]);
+            concs[3 * i] = read_u8(&r);
+            concs[3 * i + 1] = read_u8(&r);
+            concs[3 * i + 2] = read_u8(&r);
+        }
+    }
+
+    /* The code and deopt information. */
+    cand->bytecode_size = read_u32(&r);
+    cand->bytecode = read_array(&r, cand->bytecode_size);
+    cand->num_handlers = read_u32(&r);
+    cand->handlers = read_array(&r, cand->num_handlers * sizeof(MVMFrameHandler));
+    cand->num_deopts = read_u32(&r);
+    cand->deopts = read_array(&r, 2 * cand->num_deopts * sizeof(MVMint32));
+    cand->deopt_named_used_bit_field = read_u64(&r);
+    i = read_u32(&r);
+    cand->deopt_usage_info = read_array(&r, i * sizeof(MVMint32));
+    cand->num_locals = read_u16(&r);
+    cand->num_lexicals = read_u16(&r);
+    if (read_u8(&r))
+        cand->local_types = read_array(&r, cand->num_locals * sizeof(MVMuint16));
+    if (read_u8(&r))
+        cand->lexical_types = read_array(&r, cand->num_lexicals * sizeof(MVMuint16));
+    if (!r.ok || !cand->bytecode)
+        goto broken;
+
+    /* The spesh slots. */
+    num_slots = read_u32(&r);
+    if (!r.ok || num_slots > (MVMuint32)(r.end - r.pos))
+        goto broken;
+    refs = MVM_realloc(refs, (num_refs + num_slots) * sizeof(CacheRef));
+    for (i = 0; i < num_slots; i++)
+        read_ref(&r, &refs[num_refs + i]);
+    if (!r.ok) {
+        num_refs += num_slots;
+        goto broken;
+    }
+
+    /* Find the serialization contexts, which may GC, and only then the
+     * types and spesh slot contents. */
+    for (i = 0; i < num_refs + num_slots && ok; i++)
+        if (refs[i].handle && !(refs[i].scb = find_sc(tc, refs[i].handle)))
+            ok = 0;
+    num_refs += num_slots;
+    if (!ok)
+        goto broken;
+    if (has_types) {
+        cand->type_tuple = MVM_calloc(cs->flag_count, sizeof(MVMSpeshStatsType));
+        for (i = 0; i < cs->flag_count; i++) {
+            cand->type_tuple[i].type = (MVMObject *)resolve_ref(tc, &refs[2 * i], &ok);
+            cand->type_tuple[i].decont_type = (MVMObject *)resolve_ref(tc, &refs[2 * i + 1], &ok);
+            cand->type_tuple[i].type_concrete = concs[3 * i];
+            cand->type_tuple[i].decont_type_concrete = concs[3 * i + 1];
+            cand->type_tuple[i].rw_cont = concs[3 * i + 2];
+        }
+    }
+    cand->num_spesh_slots = num_slots;
+    if (num_slots) {
+        MVMuint32 first = num_refs - num_slots;
+        cand->spesh_slots = MVM_calloc(num_slots, sizeof(MVMCollectable *));
+        for (i = 0; i < num_slots; i++)
+            cand->spesh_slots[i] = resolve_ref(tc, &refs[first + i], &ok);
+    }
+    if (!ok)
+        goto broken;
+
+    /* Make sure it's not already there. */
+    {
+        MVMStaticFrameSpesh *spesh = sf->body.spesh;
+        for (i = 0; i < spesh->body.num_spesh_candidates; i++) {
+            MVMSpeshCandidate *other = spesh->body.spesh_candidates[i];
+            if (other->cs != cs || other->is_baseline)
+                continue;
+            if (cand->type_tuple
+                    ? other->type_tuple && memcmp(other->type_tuple, cand->type_tuple,
+                        cs->flag_count * sizeof(MVMSpeshStatsType)) == 0
+                    : !other->type_tuple)
+                goto broken;
+        }
+    }
+
+    for (i = 0; i < num_refs; i++)
+        MVM_free(refs[i].handle);
+    MVM_free(refs);
+    MVM_free(concs);
+    cand->handler_ranges = MVM_exception_handler_ranges_build(tc, cand->handlers,
+        cand->num_handlers);
+    return cand;
+
+  broken:
+    for (i = 0; i < num_refs; i++)
+        MVM_free(refs[i].handle);
+    MVM_free(refs);
+    MVM_free(concs);
+    MVM_spesh_candidate_destroy(tc, cand);
+    return NULL;
+}
+
+/* Installs the code kept for a static frame. Called on the spesh worker.
+ * The JIT compiles the candidates afresh, from graphs built from their
+ * bytecode, since the machine code is not position independent. */
+void MVM_spesh_code_cache_install(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMSpeshCodeCacheUnit *unit = get_unit(tc, sf->body.cu);
+    char *cuuid;
+    MVMint64 i;
+    if (!unit || !unit->num_records || !sf->body.cuuid)
+        return;
+    cuuid = MVM_string_utf8_encode_C_string(tc, sf->body.cuuid);
+    MVMROOT(tc, sf, {
+        for (i = find_records(unit, cuuid); i >= 0 && (MVMuint32)i < unit->num_records
+                && strcmp(unit->records[i].cuuid, cuuid) == 0; i++) {
+            MVMSpeshCandidate *cand;
+            if (!MVM_trycas(&(unit->records[i].used), 0, 1))
+                continue;
+            cand = read_candidate(tc, sf, &(unit->records[i]));
+            if (!cand)
+                continue;
+            if (tc->instance->jit_enabled) {
+                MVMSpeshGraph *sg = MVM_spesh_graph_create_from_cand(tc, sf, cand, 0, NULL);
+                MVMJitGraph *jg = MVM_jit_try_make_graph(tc, sg);
+                if (jg != NULL) {
+                    cand->jitcode = MVM_jit_compile_graph(tc, jg);
+                    MVM_jit_graph_destroy(tc, jg);
+                }
+                MVM_spesh_graph_destroy(tc, sg);
+            }
+            MVM_spesh_candidate_install(tc, sf, cand);
+        }
+    });
+    MVM_free(cuuid);
+}
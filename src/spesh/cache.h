@@ -0,0 +1,103 @@
+/* The specialization cache remembers which specializations were produced,
+ * in a file that outlives the process, so a later run can produce them as
+ * soon as each frame is first invoked rather than waiting for statistics.
+ * Frames are identified by the filename of their compilation unit and their
+ * compilation unit ID, and types by the handle of the serialization context
+ * they belong to and their index in it. */
+
+/* A type remembered for an argument. The handles are NULL if there was no
+ * type (that is, the argument is not an object or had no decont type). */
+struct MVMSpeshCacheType {
+    char      *sc_handle;
+    MVMint64   idx;
+    char      *decont_sc_handle;
+    MVMint64   decont_idx;
+    MVMuint8   type_concrete;
+    MVMuint8   decont_type_concrete;
+    MVMuint8   rw_cont;
+};
+
+/* A remembered specialization. If there's no callsite, flag_count is zero
+ * and has_callsite is not set; if it's a certain specialization, there are
+ * no types. */
+struct MVMSpeshCacheEntry {
+    /* The line of the cache file it came from, used to spot duplicates. */
+    char *line;
+
+    /* The callsite flags and the names of the named arguments. */
+    MVMuint8          has_callsite;
+    MVMuint16         flag_count;
+    MVMCallsiteEntry *flags;
+    MVMuint16         num_names;
+    char            **names;
+
+    /* The type tuple, with an entry per callsite flag. */
+    MVMSpeshCacheType *types;
+
+    /* Set up when the specialization is planned, so the plan can point at
+     * something with the callsite. */
+    MVMSpeshStatsByCallsite cs_stats;
+};
+
+/* The remembered specializations of one static frame. */
+struct MVMSpeshCacheFrame {
+    /* The escaped filename and compilation unit ID, separated by a tab. */
+    char      *key;
+    MVMuint64  hash;
+
+    /* The specializations. */
+    MVM_VECTOR_DECL(MVMSpeshCacheEntry, entries);
+
+    /* Whether the frame was sent to the spesh worker already. */
+    AO_t queued;
+
+    /* The next frame in the same bucket. */
+    MVMSpeshCacheFrame *next;
+};
+
+/* The cache itself, hashing frames into buckets. It's filled when the VM
+ * starts and not changed afterwards, other than the queued flags. */
+struct MVMSpeshCache {
+    /* The cache file, rewritten without duplicates when loaded, to which
+     * each specialization produced is appended. */
+    FILE *fh;
+
+    /* The buckets; there's a power of 2 of them. */
+    MVMSpeshCacheFrame **buckets;
+    MVMuint32            num_buckets;
+};
+
+MVMSpeshCache * MVM_spesh_cache_open(MVMThreadContext *tc, const char *path);
+void MVM_spesh_cache_destroy(MVMThreadContext *tc, MVMSpeshCache *cache);
+void MVM_spesh_cache_record(MVMThreadContext *tc, MVMSpeshPlanned *p);
+void MVM_spesh_cache_frame_prepared(MVMThreadContext *tc, MVMStaticFrame *sf);
+MVMSpeshPlan * MVM_spesh_cache_plan(MVMThreadContext *tc, MVMStaticFrame *sf);
+
+/* Specialized code kept for a compilation unit, in a file in the spesh code
+ * cache directory named after a hash of its bytecode. Each record holds one
+ * candidate, serialized, along with the ID of the frame it belongs to. */
+struct MVMSpeshCodeCacheRecord {
+    char      *cuuid;
+    MVMuint8  *data;
+    MVMuint32  size;
+
+    /* Whether it was installed (or found to be unusable) already. */
+    AO_t used;
+};
+struct MVMSpeshCodeCacheUnit {
+    /* The hash of the comp unit's bytecode, and the path of its file. */
+    MVMuint64  hash;
+    char      *path;
+
+    /* The records loaded from the file, sorted by frame ID. */
+    MVMSpeshCodeCacheRecord *records;
+    MVMuint32                num_records;
+
+    /* Taken while appending to the file. */
+    uv_mutex_t lock;
+};
+
+MVMint32 MVM_spesh_code_cache_has(MVMThreadContext *tc, MVMStaticFrame *sf);
+void MVM_spesh_code_cache_record(MVMThreadContext *tc, MVMStaticFrame *sf, MVMSpeshCandidate *cand);
+void MVM_spesh_code_cache_install(MVMThreadContext *tc, MVMStaticFrame *sf);
+void MVM_spesh_code_cache_unit_destroy(MVMThreadContext *tc, MVMSpeshCodeCacheUnit *unit);
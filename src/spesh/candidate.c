@@ -30,18 +30,130 @@ static void spesh_gc_point(MVMThreadContext *tc) {
 #endif
 }
 
+/* Marks the least used candidate other than the newest (last) one discarded
+ * if there are more than MVM_SPESH_MAX_LIVE_CANDIDATES not discarded. The
+ * remaining candidates' use counts are halved, so that a candidate that was
+ * hot long ago won't hold on to its place forever. */
+static void evict_if_over_budget(MVMThreadContext *tc, MVMSpeshCandidate **cands,
+        MVMuint32 num_cands) {
+    MVMSpeshCandidate *victim = NULL;
+    MVMuint32 live = 0, i;
+    for (i = 0; i < num_cands; i++)
+        if (!cands[i]->discarded)
+            live++;
+    if (live <= MVM_SPESH_MAX_LIVE_CANDIDATES)
+        return;
+    for (i = 0; i + 1 < num_cands; i++)
+        if (!cands[i]->discarded && (!victim || cands[i]->uses < victim->uses))
+            victim = cands[i];
+    if (!victim)
+        return;
+    MVM_spesh_candidate_discard(tc, victim);
+    for (i = 0; i < num_cands; i++)
+        cands[i]->uses /= 2;
+}
+
+/* Discards the baseline candidate for the callsite of a newly installed
+ * certain specialization of a frame, if there is one, as that replaces it. */
+static void discard_replaced_baseline(MVMThreadContext *tc, MVMSpeshCandidate **cands,
+        MVMuint32 num_cands, MVMSpeshCandidate *replacement) {
+    MVMuint32 i;
+    if (replacement->is_baseline || replacement->type_tuple)
+        return;
+    for (i = 0; i < num_cands; i++)
+        if (cands[i]->is_baseline && !cands[i]->discarded && cands[i]->cs == replacement->cs)
+            MVM_spesh_candidate_discard(tc, cands[i]);
+}
+
+/* Baseline candidates are JIT compiled straight from the bytecode, the
+ * optimizer being skipped; it is what would remove the OSR points, which the
+ * JIT doesn't compile, so we do that here. */
+static void remove_osr_points(MVMThreadContext *tc, MVMSpeshGraph *sg) {
+    MVMSpeshBB *bb = sg->entry;
+    while (bb) {
+        MVMSpeshIns *ins = bb->first_ins;
+        while (ins) {
+            MVMSpeshIns *next = ins->next;
+            if (ins->info->opcode == MVM_OP_osrpoint)
+                MVM_spesh_manipulate_delete_ins(tc, sg, bb, ins);
+            ins = next;
+        }
+        bb = bb->linear_next;
+    }
+}
+
+/* Installs a candidate for a static frame, working out the sizes of its work
+ * and environment areas (taking the JIT spill area into account), adding it
+ * to the candidate list and regenerating the argument guards. Only one thread
+ * may install candidates for a given frame at a time. */
+void MVM_spesh_candidate_install(MVMThreadContext *tc, MVMStaticFrame *sf,
+        MVMSpeshCandidate *candidate) {
+    MVMSpeshCandidate **new_candidate_list;
+    MVMStaticFrameSpesh *spesh;
+
+    calculate_work_env_sizes(tc, sf, candidate);
+    candidate->sf = sf;
+
+    /* Create a new candidate list and copy any existing ones. Free memory
+     * using the FSA safepoint mechanism. */
+    spesh = sf->body.spesh;
+    new_candidate_list = MVM_fixed_size_alloc(tc, tc->instance->fsa,
+        (spesh->body.num_spesh_candidates + 1) * sizeof(MVMSpeshCandidate *));
+    if (spesh->body.num_spesh_candidates) {
+        size_t orig_size = spesh->body.num_spesh_candidates * sizeof(MVMSpeshCandidate *);
+        memcpy(new_candidate_list, spesh->body.spesh_candidates, orig_size);
+        MVM_fixed_size_free_at_safepoint(tc, tc->instance->fsa, orig_size,
+            spesh->body.spesh_candidates);
+    }
+    new_candidate_list[spesh->body.num_spesh_candidates] = candidate;
+    spesh->body.spesh_candidates = new_candidate_list;
+
+    /* May now be referencing nursery objects, so barrier just in case. */
+    if (spesh->common.header.flags2 & MVM_CF_SECOND_GEN)
+        MVM_gc_write_barrier_hit(tc, (MVMCollectable *)spesh);
+
+    /* A certain specialization replaces the baseline candidate for its
+     * callsite; then, if that's too many candidates in use, evict the least
+     * used. */
+    discard_replaced_baseline(tc, new_candidate_list, spesh->body.num_spesh_candidates, candidate);
+    evict_if_over_budget(tc, new_candidate_list, spesh->body.num_spesh_candidates + 1);
+
+    /* Regenerate the guards, and bump the candidate count only after they
+     * are installed. This means there is a period when we can read, in
+     * another thread, a candidate ahead of the count being updated. Since
+     * we set it up above, that's fine enough. The updating of the count
+     * *after* this, plus the barrier, is to make sure the guards are in
+     * place before the count is bumped, since OSR will watch the number
+     * of candidates to see if there's one for it to try and jump in to,
+     * and if the guards aren't in place first will see there is not, and
+     * not bother checking again. */
+    MVM_spesh_arg_guard_regenerate(tc, &(spesh->body.spesh_arg_guard),
+        spesh->body.spesh_candidates, spesh->body.num_spesh_candidates + 1);
+    MVM_barrier();
+    spesh->body.num_spesh_candidates++;
+}
+
 /* Produces and installs a specialized version of the code, according to the
- * specified plan. */
+ * specified plan. For a baseline plan, the optimizer is skipped, so all we
+ * really spend time on is the JIT. */
 void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     MVMSpeshGraph *sg;
     MVMSpeshCode *sc;
     MVMSpeshCandidate *candidate;
-    MVMSpeshCandidate **new_candidate_list;
-    MVMStaticFrameSpesh *spesh;
     MVMuint64 start_time = 0, spesh_time = 0, jit_time = 0, end_time;
+    MVMuint64 profile_start = MVM_startup_profile_start(tc->instance);
+    MVMuint32 i;
+
+    MVMint32 spesh_produced;
+    MVMint32 baseline = p->kind == MVM_SPESH_PLANNED_BASELINE;
+
+    /* If the frame has used up its budget of candidates, don't produce any
+     * more for it. */
+    if (p->sf->body.spesh->body.num_spesh_candidates >= MVM_SPESH_MAX_CANDIDATES)
+        return;
 
     /* If we've reached our specialization limit, don't continue. */
-    MVMint32 spesh_produced = ++tc->instance->spesh_produced;
+    spesh_produced = (MVMint32)MVM_incr(&tc->instance->spesh_produced) + 1;
     if (tc->instance->spesh_limit)
         if (spesh_produced > tc->instance->spesh_limit)
             return;
@@ -82,7 +194,10 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     spesh_gc_point(tc);
     MVM_spesh_facts_discover(tc, sg, p, 0);
     spesh_gc_point(tc);
-    MVM_spesh_optimize(tc, sg, p);
+    if (baseline)
+        remove_osr_points(tc, sg);
+    else
+        MVM_spesh_optimize(tc, sg, p);
     spesh_gc_point(tc);
 
     /* Clear active graph; beyond this point, no more GC syncs. */
@@ -102,7 +217,10 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     candidate->bytecode_size = sc->bytecode_size;
     candidate->handlers      = sc->handlers;
     candidate->deopt_usage_info = sc->deopt_usage_info;
+    candidate->deopt_ops     = sc->deopt_ops;
     candidate->num_handlers  = sg->num_handlers;
+    candidate->handler_ranges = MVM_exception_handler_ranges_build(tc,
+        candidate->handlers, candidate->num_handlers);
     candidate->num_deopts    = sg->num_deopt_addrs;
     candidate->deopts        = sg->deopt_addrs;
     candidate->deopt_named_used_bit_field = sg->deopt_named_used_bit_field;
@@ -113,6 +231,13 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     candidate->inlines       = sg->inlines;
     candidate->local_types   = sg->local_types;
     candidate->lexical_types = sg->lexical_types;
+    candidate->is_baseline   = baseline;
+    for (i = 0; i < candidate->num_inlines; i++) {
+        if (candidate->inlines[i].sf->body.has_dynamic_lexicals) {
+            candidate->inlines_dynamics = 1;
+            break;
+        }
+    }
 
     MVM_free(sc);
 
@@ -138,6 +263,10 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
             "Specialization took %" PRIu64 "us (total %" PRIu64"us)\n",
             (spesh_time - start_time) / 1000,
             (end_time - start_time) / 1000);
+        MVM_spesh_debug_printf(tc,
+            "Graph used %" PRIu64 " bytes in %u region blocks (%u reused)\n",
+            (MVMuint64)sg->region_alloc.bytes_used,
+            sg->region_alloc.num_blocks, sg->region_alloc.num_reused);
 
         if (tc->instance->jit_enabled) {
             MVM_spesh_debug_printf(tc,
@@ -153,8 +282,15 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
         fflush(tc->instance->spesh_log_fh);
     }
 
-    /* calculate work environment taking JIT spill area into account */
-    calculate_work_env_sizes(tc, sg->sf, candidate);
+    /* Report the first few specializations if profiling startup. */
+    if (tc->instance->startup_profiling && MVM_incr(&tc->instance->startup_spesh_reported)
+            < MVM_STARTUP_PROFILE_SPESH) {
+        char *c_name = MVM_string_utf8_encode_C_string(tc, p->sf->body.name);
+        MVM_startup_profile_report(tc->instance,
+            candidate->jitcode ? "specialize and JIT compile" : "specialize",
+            c_name[0] ? c_name : "<anon>", profile_start);
+        MVM_free(c_name);
+    }
 
     /* Update spesh slots. */
     candidate->num_spesh_slots = sg->num_spesh_slots;
@@ -164,37 +300,26 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     sg->cand = candidate;
     MVM_spesh_graph_destroy(tc, sg);
 
-    /* Create a new candidate list and copy any existing ones. Free memory
-     * using the FSA safepoint mechanism. */
-    spesh = p->sf->body.spesh;
-    new_candidate_list = MVM_fixed_size_alloc(tc, tc->instance->fsa,
-        (spesh->body.num_spesh_candidates + 1) * sizeof(MVMSpeshCandidate *));
-    if (spesh->body.num_spesh_candidates) {
-        size_t orig_size = spesh->body.num_spesh_candidates * sizeof(MVMSpeshCandidate *);
-        memcpy(new_candidate_list, spesh->body.spesh_candidates, orig_size);
-        MVM_fixed_size_free_at_safepoint(tc, tc->instance->fsa, orig_size,
-            spesh->body.spesh_candidates);
+    /* A baseline candidate is only worth having if the JIT compiled it. */
+    if (baseline && !candidate->jitcode) {
+        p->sf->body.spesh->body.baseline_failed = 1;
+        MVM_spesh_candidate_destroy(tc, candidate);
+#if MVM_GC_DEBUG
+        tc->in_spesh = 0;
+#endif
+        return;
     }
-    new_candidate_list[spesh->body.num_spesh_candidates] = candidate;
-    spesh->body.spesh_candidates = new_candidate_list;
 
-    /* May now be referencing nursery objects, so barrier just in case. */
-    if (spesh->common.header.flags2 & MVM_CF_SECOND_GEN)
-        MVM_gc_write_barrier_hit(tc, (MVMCollectable *)spesh);
+    /* Install it. */
+    MVM_spesh_candidate_install(tc, p->sf, candidate);
+    MVM_incr(&tc->instance->stat_spesh_candidates);
 
-    /* Regenerate the guards, and bump the candidate count only after they
-     * are installed. This means there is a period when we can read, in
-     * another thread, a candidate ahead of the count being updated. Since
-     * we set it up above, that's fine enough. The updating of the count
-     * *after* this, plus the barrier, is to make sure the guards are in
-     * place before the count is bumped, since OSR will watch the number
-     * of candidates to see if there's one for it to try and jump in to,
-     * and if the guards aren't in place first will see there is not, and
-     * not bother checking again. */
-    MVM_spesh_arg_guard_regenerate(tc, &(spesh->body.spesh_arg_guard),
-        spesh->body.spesh_candidates, spesh->body.num_spesh_candidates + 1);
-    MVM_barrier();
-    spesh->body.num_spesh_candidates++;
+    /* Remember it for future runs, if we're keeping caches. Baseline
+     * candidates are cheap to make again and not worth keeping. */
+    if (tc->instance->spesh_cache && !baseline)
+        MVM_spesh_cache_record(tc, p);
+    if (tc->instance->spesh_code_cache_dir && !baseline)
+        MVM_spesh_code_cache_record(tc, p->sf, candidate);
 
     /* If we're logging, dump the upadated arg guards also. */
     if (MVM_spesh_debug_enabled(tc)) {
@@ -215,18 +340,106 @@ void MVM_spesh_candidate_destroy(MVMThreadContext *tc, MVMSpeshCandidate *candid
     MVM_free(candidate->type_tuple);
     MVM_free(candidate->bytecode);
     MVM_free(candidate->handlers);
+    MVM_free(candidate->handler_ranges);
     MVM_free(candidate->spesh_slots);
     MVM_free(candidate->deopts);
     MVM_spesh_pea_destroy_deopt_info(tc, &(candidate->deopt_pea));
     MVM_free(candidate->inlines);
     MVM_free(candidate->local_types);
     MVM_free(candidate->lexical_types);
-    if (candidate->jitcode)
+    if (candidate->jitcode) {
+        /* Take it off the queue of JIT code to free, if it's on there. */
+        if (candidate->discarded) {
+            MVMSpeshCandidate **link;
+            uv_mutex_lock(&tc->instance->mutex_jit_code_discarded);
+            link = &tc->instance->jit_code_discarded;
+            while (*link && *link != candidate)
+                link = &(*link)->next_discarded;
+            if (*link)
+                *link = candidate->next_discarded;
+            uv_mutex_unlock(&tc->instance->mutex_jit_code_discarded);
+        }
         MVM_jit_code_destroy(tc, candidate->jitcode);
+    }
+    if (candidate->deopt_counts) {
+        MVMSpeshCandidate **link;
+        uv_mutex_lock(&tc->instance->mutex_deopting_candidates);
+        link = &tc->instance->deopting_candidates;
+        while (*link && *link != candidate)
+            link = &(*link)->next_deopting;
+        if (*link)
+            *link = candidate->next_deopting;
+        uv_mutex_unlock(&tc->instance->mutex_deopting_candidates);
+        MVM_free(candidate->deopt_counts);
+    }
+    MVM_free(candidate->deopt_ops);
     MVM_free(candidate->deopt_usage_info);
     MVM_free(candidate);
 }
 
+/* Marks a candidate discarded, so it won't be chosen any more. Frames may
+ * still be running its JIT code though, so that is only queued to be freed
+ * once a full collection finds no frame doing so. */
+void MVM_spesh_candidate_discard(MVMThreadContext *tc, MVMSpeshCandidate *candidate) {
+    if (candidate->discarded)
+        return;
+    candidate->discarded = 1;
+    if (candidate->jitcode) {
+        uv_mutex_lock(&tc->instance->mutex_jit_code_discarded);
+        candidate->next_discarded = tc->instance->jit_code_discarded;
+        tc->instance->jit_code_discarded = candidate;
+        uv_mutex_unlock(&tc->instance->mutex_jit_code_discarded);
+    }
+}
+
+/* Discards the candidates of a frame that keep deoptimizing, and so cost more
+ * than they save. Since discarded candidates still count as existing when
+ * planning, the same specializations won't be produced again. Run by the
+ * specialization worker before planning for the frame, so nothing else is
+ * changing its candidates or guards. */
+void MVM_spesh_candidate_discard_deopting(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMStaticFrameSpesh *spesh = sf->body.spesh;
+    MVMuint32 num_cands = spesh->body.num_spesh_candidates;
+    MVMuint32 discarded = 0, i;
+    for (i = 0; i < num_cands; i++) {
+        MVMSpeshCandidate *cand = spesh->body.spesh_candidates[i];
+        MVMuint64 deopts = MVM_load(&cand->deopt_total);
+        if (!cand->discarded && deopts >= MVM_SPESH_DEOPT_DISCARD_MIN
+                && deopts * MVM_SPESH_DEOPT_DISCARD_RATE >= cand->uses) {
+            MVM_spesh_candidate_discard(tc, cand);
+            MVM_incr(&tc->instance->stat_deopt_discards);
+            discarded++;
+        }
+    }
+    if (discarded)
+        MVM_spesh_arg_guard_regenerate(tc, &(spesh->body.spesh_arg_guard),
+            spesh->body.spesh_candidates, num_cands);
+}
+
+/* Frees the JIT code of discarded candidates that no frame was found running
+ * during the full collection that is just finishing. Called by the GC
+ * co-ordinator while all other threads are still stopped, so no new frame can
+ * have started running it since, and the candidate's bytecode is used from
+ * now on. */
+void MVM_spesh_candidate_free_unused_jit_code(MVMThreadContext *tc) {
+    MVMuint64 gc_seq_number = MVM_load(&tc->instance->gc_seq_number);
+    MVMSpeshCandidate **link;
+    uv_mutex_lock(&tc->instance->mutex_jit_code_discarded);
+    link = &tc->instance->jit_code_discarded;
+    while (*link) {
+        MVMSpeshCandidate *candidate = *link;
+        if (candidate->jitcode->last_seen_gc != gc_seq_number) {
+            *link = candidate->next_discarded;
+            MVM_jit_code_destroy(tc, candidate->jitcode);
+            candidate->jitcode = NULL;
+        }
+        else {
+            link = &candidate->next_discarded;
+        }
+    }
+    uv_mutex_unlock(&tc->instance->mutex_jit_code_discarded);
+}
+
 /* Discards existing candidates. Used when we instrument bytecode, and so
  * need to ignore these ones from here on. */
 void MVM_spesh_candidate_discard_existing(MVMThreadContext *tc, MVMStaticFrame *sf) {
@@ -235,7 +448,7 @@ void MVM_spesh_candidate_discard_existing(MVMThreadContext *tc, MVMStaticFrame *
         MVMuint32 num_candidates = spesh->body.num_spesh_candidates;
         MVMuint32 i;
         for (i = 0; i < num_candidates; i++)
-            spesh->body.spesh_candidates[i]->discarded = 1;
+            MVM_spesh_candidate_discard(tc, spesh->body.spesh_candidates[i]);
         MVM_spesh_arg_guard_discard(tc, sf);
     }
 }
@@ -10,6 +10,19 @@ struct MVMSpeshCandidate {
     /* Has the candidated been discarded? */
     MVMuint8 discarded;
 
+    /* Is this a baseline candidate, the unoptimized bytecode compiled by the
+     * JIT, which is to be discarded once a certain specialization for the
+     * same callsite is installed? */
+    MVMuint8 is_baseline;
+
+    /* The next discarded candidate whose JIT code is waiting to be freed. */
+    MVMSpeshCandidate *next_discarded;
+
+    /* Roughly how many times it has been chosen when invoking the frame
+     * (updated without synchronization, so it may miss some), halved each
+     * time a candidate of the frame is evicted so as to favor recent use. */
+    MVMuint32 uses;
+
     /* Length of the specialized bytecode in bytes. */
     MVMuint32 bytecode_size;
 
@@ -19,6 +32,9 @@ struct MVMSpeshCandidate {
     /* Frame handlers for this specialization. */
     MVMFrameHandler *handlers;
 
+    /* The handlers grouped by the ranges of bytecode they cover. */
+    MVMFrameHandlerRanges *handler_ranges;
+
     /* Spesh slots, used to hold information for fast access. */
     MVMCollectable **spesh_slots;
 
@@ -31,6 +47,21 @@ struct MVMSpeshCandidate {
     /* Deoptimization mappings. */
     MVMint32 *deopts;
 
+    /* The op at each deopt point, usually the guard that deopts there (NULL
+     * if the candidate didn't come from codegen). */
+    MVMuint16 *deopt_ops;
+
+    /* How many times each deopt point was hit, made on the first deopt and
+     * updated without synchronization, and the total over all of them. A
+     * candidate that has deopted is on the instance's list of them, for the
+     * deopt report. */
+    MVMuint32 *deopt_counts;
+    AO_t deopt_total;
+    MVMSpeshCandidate *next_deopting;
+
+    /* The static frame this is a specialization of, set on install. */
+    MVMStaticFrame *sf;
+
     /* Bit field of named args used to put in place during deopt, since we
      * typically don't update the array in specialized code. */
     MVMuint64 deopt_named_used_bit_field;
@@ -43,6 +74,9 @@ struct MVMSpeshCandidate {
     MVMuint32 num_inlines;
     MVMSpeshInline *inlines;
 
+    /* Whether any of the inlines declares dynamic variables. */
+    MVMuint8 inlines_dynamics;
+
     /* The list of local types (only set up if we do inlines). */
     MVMuint16 *local_types;
 
@@ -77,7 +111,29 @@ struct MVMSpeshCandidate {
     MVMint32 *deopt_usage_info;
 };
 
+/* While a frame is still being logged, one in this many of the calls that
+ * would pick its baseline candidate run the unspecialized code instead, so
+ * that the logs to specialize it properly keep coming. */
+#define MVM_SPESH_BASELINE_LOG_INTERVAL 4
+
+/* The most candidates a frame may have in use at once; beyond this, the least
+ * used one is evicted from the argument guards. Evicted candidates stay in
+ * the list, since callers may have preselected them by index, and so there
+ * is also a limit on how many a frame may have in total. */
+#define MVM_SPESH_MAX_LIVE_CANDIDATES   12
+#define MVM_SPESH_MAX_CANDIDATES        48
+
+/* A candidate that has deopted at least this many times, and at least once
+ * in this many uses, costs more than it saves and is discarded. */
+#define MVM_SPESH_DEOPT_DISCARD_MIN     64
+#define MVM_SPESH_DEOPT_DISCARD_RATE    4
+
 /* Functions for creating and clearing up specializations. */
 void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p);
+void MVM_spesh_candidate_install(MVMThreadContext *tc, MVMStaticFrame *sf,
+    MVMSpeshCandidate *candidate);
 void MVM_spesh_candidate_destroy(MVMThreadContext *tc, MVMSpeshCandidate *candidate);
+void MVM_spesh_candidate_discard(MVMThreadContext *tc, MVMSpeshCandidate *candidate);
+void MVM_spesh_candidate_discard_deopting(MVMThreadContext *tc, MVMStaticFrame *sf);
 void MVM_spesh_candidate_discard_existing(MVMThreadContext *tc, MVMStaticFrame *sf);
+void MVM_spesh_candidate_free_unused_jit_code(MVMThreadContext *tc);
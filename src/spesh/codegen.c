@@ -8,6 +8,35 @@ typedef struct {
     MVM_VECTOR_DECL(MVMSpeshIns *, seen_phis);
 } AllDeoptUsers;
 
+/* Pairs of ops that are fused into a superinstruction, written over the
+ * opcode of the first when the second directly follows it. */
+static const struct {
+    MVMuint16 first;
+    MVMuint16 second;
+    MVMuint16 fused;
+} superops[] = {
+    { MVM_OP_sp_getarg_o, MVM_OP_sp_decont,  MVM_OP_sp_getarg_o_decont },
+    { MVM_OP_sp_p6oget_o, MVM_OP_sp_decont,  MVM_OP_sp_p6oget_o_decont },
+    { MVM_OP_const_s,     MVM_OP_concat_s,   MVM_OP_sp_const_s_concat_s },
+};
+#define NUM_SUPEROPS (sizeof(superops) / sizeof(superops[0]))
+
+static MVMuint16 superop_for(MVMuint16 first, MVMuint16 second) {
+    MVMuint32 i;
+    for (i = 0; i < NUM_SUPEROPS; i++)
+        if (superops[i].first == first && superops[i].second == second)
+            return superops[i].fused;
+    return 0;
+}
+
+MVMuint16 MVM_spesh_codegen_superop_base(MVMThreadContext *tc, MVMuint16 opcode) {
+    MVMuint32 i;
+    for (i = 0; i < NUM_SUPEROPS; i++)
+        if (superops[i].fused == opcode)
+            return superops[i].first;
+    MVM_oops(tc, "Spesh: %d is not a superinstruction", opcode);
+}
+
 /* Writer state. */
 typedef struct {
     /* Bytecode output buffer. */
@@ -31,6 +60,9 @@ typedef struct {
      * inline from this bytecode in the future. */
     MVM_VECTOR_DECL(MVMint32, deopt_usage_info);
 
+    /* The op at each deopt point, for reporting deopts. */
+    MVMuint16 *deopt_ops;
+
     /* Working deopt users state (so we can allocate it once and re-use it). */
     AllDeoptUsers all_deopt_users;
 } SpeshWriterState;
@@ -106,6 +138,8 @@ static void collect_deopt_users(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpesh
 /* Writes instructions within a basic block boundary. */
 static void write_instructions(MVMThreadContext *tc, MVMSpeshGraph *g, SpeshWriterState *ws, MVMSpeshBB *bb) {
     MVMSpeshIns *ins = bb->first_ins;
+    MVMint32 prev_pos = -1;
+    MVMuint16 prev_opcode = 0;
     while (ins) {
         MVMint32 i;
 
@@ -180,9 +214,22 @@ static void write_instructions(MVMThreadContext *tc, MVMSpeshGraph *g, SpeshWrit
                 }
                 if (!found)
                     MVM_oops(tc, "Spesh: failed to resolve extop in code-gen");
+                prev_pos = -1;
             }
             else {
-                /* Core op. */
+                /* Core op. If it completes a pair we have a superinstruction
+                 * for, write that over the previous op. */
+                MVMuint16 fused = prev_pos >= 0
+                    ? superop_for(prev_opcode, ins->info->opcode)
+                    : 0;
+                if (fused) {
+                    memcpy(ws->bytecode + prev_pos, &fused, sizeof(MVMuint16));
+                    prev_pos = -1;
+                }
+                else {
+                    prev_pos = ws->bytecode_pos;
+                    prev_opcode = ins->info->opcode;
+                }
                 write_int16(ws, ins->info->opcode);
             }
 
@@ -307,6 +354,8 @@ static void write_instructions(MVMThreadContext *tc, MVMSpeshGraph *g, SpeshWrit
                 case MVM_SPESH_ANN_DEOPT_ALL_INS:
                 case MVM_SPESH_ANN_DEOPT_INLINE:
                     g->deopt_addrs[2 * ann->data.deopt_idx + 1] = ws->bytecode_pos;
+                    if (ws->deopt_ops && (MVMuint32)ann->data.deopt_idx < g->num_deopt_addrs)
+                        ws->deopt_ops[ann->data.deopt_idx] = ins->info->opcode;
 #ifndef NDEBUG
                     if (deopt_idx == ann->data.deopt_idx)
                         seen_deopt_idx = 1;
@@ -341,6 +390,9 @@ MVMSpeshCode * MVM_spesh_codegen(MVMThreadContext *tc, MVMSpeshGraph *g) {
     for (i = 0; i < g->num_bbs; i++)
         ws->bb_offsets[i] = -1;
     MVM_VECTOR_INIT(ws->deopt_usage_info, 0);
+    ws->deopt_ops       = g->num_deopt_addrs
+        ? MVM_calloc(g->num_deopt_addrs, sizeof(MVMuint16))
+        : NULL;
     MVM_VECTOR_INIT(ws->all_deopt_users.idxs, 0);
     MVM_VECTOR_INIT(ws->all_deopt_users.seen_phis, 0);
 
@@ -429,6 +481,7 @@ MVMSpeshCode * MVM_spesh_codegen(MVMThreadContext *tc, MVMSpeshGraph *g) {
     res->bytecode_size    = ws->bytecode_pos;
     res->handlers         = ws->handlers;
     res->deopt_usage_info = ws->deopt_usage_info;
+    res->deopt_ops        = ws->deopt_ops;
 
     /* Cleanup. */
     MVM_free(ws->bb_offsets);
@@ -11,6 +11,16 @@ struct MVMSpeshCode {
 
     /* Deopt usage info, which will be stored on the candidate. */
     MVMint32 *deopt_usage_info;
+
+    /* The op at each deopt point, also for the candidate. */
+    MVMuint16 *deopt_ops;
 };
 
 MVMSpeshCode * MVM_spesh_codegen(MVMThreadContext *tc, MVMSpeshGraph *g);
+
+/* Superinstructions that codegen writes over the first of a pair of ops; see
+ * the oplist. Anything that builds a graph from the bytecode wants the op
+ * back that it was written over. */
+#define MVM_SPESH_SUPEROP_FIRST MVM_OP_sp_getarg_o_decont
+#define MVM_SPESH_SUPEROP_LAST  MVM_OP_sp_const_s_concat_s
+MVMuint16 MVM_spesh_codegen_superop_base(MVMThreadContext *tc, MVMuint16 opcode);
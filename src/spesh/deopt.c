@@ -7,15 +7,41 @@
 #define MVM_LOG_DEOPTS 0
 
 /* Uninlining can invalidate what the dynlex cache points to, so we'll
- * clear it in various caches. */
+ * clear it in various caches, as well as the thread's one. */
 MVM_STATIC_INLINE void clear_dynlex_cache(MVMThreadContext *tc, MVMFrame *f) {
     MVMFrameExtra *e = f->extra;
+    tc->num_dynvar_cache = 0;
     if (e) {
         e->dynlex_cache_name = NULL;
         e->dynlex_cache_reg = NULL;
     }
 }
 
+/* Counts a deopt at a deopt point of a candidate, for the deopt report and
+ * for spesh to notice candidates that keep deopting. The table of counts is
+ * made on the first deopt, at which point the candidate also goes on the
+ * instance's list of deopting candidates. */
+static void count_deopt(MVMThreadContext *tc, MVMSpeshCandidate *cand, MVMuint32 deopt_idx) {
+    MVMuint32 *counts = (MVMuint32 *)MVM_load(&cand->deopt_counts);
+    if (!counts) {
+        MVMuint32 *fresh = MVM_calloc(cand->num_deopts ? cand->num_deopts : 1, sizeof(MVMuint32));
+        if (MVM_trycas(&cand->deopt_counts, NULL, fresh)) {
+            uv_mutex_lock(&tc->instance->mutex_deopting_candidates);
+            cand->next_deopting = tc->instance->deopting_candidates;
+            tc->instance->deopting_candidates = cand;
+            uv_mutex_unlock(&tc->instance->mutex_deopting_candidates);
+            counts = fresh;
+        }
+        else {
+            MVM_free(fresh);
+            counts = (MVMuint32 *)MVM_load(&cand->deopt_counts);
+        }
+    }
+    if (deopt_idx < cand->num_deopts)
+        counts[deopt_idx]++;
+    MVM_incr(&cand->deopt_total);
+}
+
 /* If we have to deopt inside of a frame containing inlines, and we're in
  * an inlined frame at the point we hit deopt, we need to undo the inlining
  * by switching all levels of inlined frame out for a bunch of frames that
@@ -176,40 +202,60 @@ static void materialize_object(MVMThreadContext *tc, MVMFrame *f, MVMObject ***m
         MVMSpeshPEAMaterializeInfo *mi = &(cand->deopt_pea.materialize_info[info_idx]);
         MVMSTable *st = (MVMSTable *)cand->spesh_slots[mi->stable_sslot];
         MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)st->REPR_data;
-        MVMROOT(tc, f, {
-            MVMObject *obj = MVM_gc_allocate_object(tc, st);
-            char *data = (char *)OBJECT_BODY(obj);
-            MVMuint32 num_attrs = repr_data->num_attributes;
-            MVMuint32 i;
-            for (i = 0; i < num_attrs; i++) {
-                MVMRegister value = f->work[mi->attr_regs[i]];
-                MVMuint16 offset = repr_data->attribute_offsets[i];
-                MVMSTable *flattened = repr_data->flattened_stables[i];
-                if (flattened) {
-                    const MVMStorageSpec *ss = flattened->REPR->get_storage_spec(tc, flattened);
-                    switch (ss->boxed_primitive) {
-                        case MVM_STORAGE_SPEC_BP_INT:
-                            flattened->REPR->box_funcs.set_int(tc, flattened, obj,
-                                (char *)data + offset, value.i64);
-                            break;
-                        case MVM_STORAGE_SPEC_BP_NUM:
-                            flattened->REPR->box_funcs.set_num(tc, flattened, obj,
-                                (char *)data + offset, value.n64);
-                            break;
-                        case MVM_STORAGE_SPEC_BP_STR:
-                            flattened->REPR->box_funcs.set_str(tc, flattened, obj,
-                                (char *)data + offset, value.s);
-                            break;
-                        default:
-                            MVM_panic(1, "Unimplemented case of native attribute deopt materialization");
+        if (st->REPR->ID == MVM_REPR_ID_VMArray || st->REPR->ID == MVM_REPR_ID_MVMHash) {
+            /* An array or hash; put the elements into a new, empty one. */
+            MVMROOT(tc, f, {
+                MVMObject *obj = MVM_gc_allocate_object(tc, st);
+                MVMuint32 i;
+                MVMROOT(tc, obj, {
+                    for (i = 0; i < mi->num_attr_regs; i++) {
+                        MVMObject *value = f->work[mi->attr_regs[i]].o;
+                        if (mi->key_sslots)
+                            MVM_repr_bind_key_o(tc, obj,
+                                (MVMString *)cand->spesh_slots[mi->key_sslots[i]], value);
+                        else
+                            MVM_repr_push_o(tc, obj, value);
+                    }
+                });
+                (*materialized)[info_idx] = obj;
+            });
+        }
+        else {
+            MVMROOT(tc, f, {
+                MVMObject *obj = MVM_gc_allocate_object(tc, st);
+                char *data = (char *)OBJECT_BODY(obj);
+                MVMuint32 num_attrs = repr_data->num_attributes;
+                MVMuint32 i;
+                for (i = 0; i < num_attrs; i++) {
+                    MVMRegister value = f->work[mi->attr_regs[i]];
+                    MVMuint16 offset = repr_data->attribute_offsets[i];
+                    MVMSTable *flattened = repr_data->flattened_stables[i];
+                    if (flattened) {
+                        const MVMStorageSpec *ss = flattened->REPR->get_storage_spec(tc, flattened);
+                        switch (ss->boxed_primitive) {
+                            case MVM_STORAGE_SPEC_BP_INT:
+                                flattened->REPR->box_funcs.set_int(tc, flattened, obj,
+                                    (char *)data + offset, value.i64);
+                                break;
+                            case MVM_STORAGE_SPEC_BP_NUM:
+                                flattened->REPR->box_funcs.set_num(tc, flattened, obj,
+                                    (char *)data + offset, value.n64);
+                                break;
+                            case MVM_STORAGE_SPEC_BP_STR:
+                                flattened->REPR->box_funcs.set_str(tc, flattened, obj,
+                                    (char *)data + offset, value.s);
+                                break;
+                            default:
+                                MVM_panic(1, "Unimplemented case of native attribute deopt materialization");
+                        }
+                    }
+                    else {
+                        *((MVMObject **)(data + offset)) = value.o;
                     }
                 }
-                else {
-                    *((MVMObject **)(data + offset)) = value.o;
-                }
-            }
-            (*materialized)[info_idx] = obj;
-        });
+                (*materialized)[info_idx] = obj;
+            });
+        }
 #if MVM_LOG_DEOPTS
         fprintf(stderr, "    Materialized a %s\n", st->debug_name);
 #endif
@@ -235,6 +281,12 @@ static void materialize_replaced_objects(MVMThreadContext *tc, MVMFrame *f, MVMi
 
 
 static void deopt_frame(MVMThreadContext *tc, MVMFrame *f, MVMuint32 deopt_idx, MVMuint32 deopt_offset, MVMuint32 deopt_target) {
+    /* Specialized code may have taken local closures, relying on what it
+     * knew to be sure they don't escape; the unspecialized code might not
+     * keep to that, so their outers must be on the heap. */
+    if (tc->num_local_closures)
+        f = MVM_frame_force_to_heap(tc, f);
+
     /* Found it. We materialize any replaced objects first, then if
      * we have stuff replaced in inlines then uninlining will take
      * care of moving it out into the frames where it belongs. */
@@ -281,6 +333,7 @@ static void deopt_frame(MVMThreadContext *tc, MVMFrame *f, MVMuint32 deopt_idx,
  * at a valid de-optimization point. Typically used when a guard fails. */
 void MVM_spesh_deopt_one(MVMThreadContext *tc, MVMuint32 deopt_idx) {
     MVMFrame *f = tc->cur_frame;
+    MVM_incr(&tc->instance->stat_deopt_one);
     if (tc->instance->profiling)
         MVM_profiler_log_deopt_one(tc);
 #if MVM_LOG_DEOPTS
@@ -297,6 +350,7 @@ void MVM_spesh_deopt_one(MVMThreadContext *tc, MVMuint32 deopt_idx) {
 #if MVM_LOG_DEOPTS
         fprintf(stderr, "    Will deopt %u -> %u\n", deopt_offset, deopt_target);
 #endif
+        count_deopt(tc, f->spesh_cand, deopt_idx);
         deopt_frame(tc, tc->cur_frame, deopt_idx, deopt_offset, deopt_target);
     }
     else {
@@ -358,6 +412,7 @@ void MVM_spesh_deopt_all(MVMThreadContext *tc) {
         MVM_string_utf8_encode_C_string(tc, l->static_info->body.name),
         MVM_string_utf8_encode_C_string(tc, l->static_info->body.cuuid));
 #endif
+    MVM_incr(&tc->instance->stat_deopt_all);
     if (tc->instance->profiling)
         MVM_profiler_log_deopt_all(tc);
 
@@ -370,6 +425,7 @@ void MVM_spesh_deopt_all(MVMThreadContext *tc) {
                  * just update return address. */
                 MVMint32 deopt_offset = f->spesh_cand->deopts[2 * deopt_idx + 1];
                 MVMint32 deopt_target = f->spesh_cand->deopts[2 * deopt_idx];
+                count_deopt(tc, f->spesh_cand, deopt_idx);
                 MVMROOT2(tc, f, l, {
                     materialize_replaced_objects(tc, f, deopt_idx);
                 });
@@ -415,3 +471,147 @@ void MVM_spesh_deopt_all(MVMThreadContext *tc) {
     fprintf(stderr, "Deopt all completed\n");
 #endif
 }
+
+/* A deopt point that has been hit, as gathered for the report: the frame it
+ * is in (the innermost inline covering it, if any), the line it resumes at,
+ * and the op that deopted there. */
+typedef struct {
+    MVMSpeshCandidate *cand;
+    MVMuint32          deopt_idx;
+    MVMuint32          count;
+    MVMStaticFrame    *sf;
+    MVMuint32          line;
+    const char        *op_name;
+    MVMuint8           discarded;
+} DeoptSite;
+
+static int cmp_deopt_site(const void *a, const void *b) {
+    const DeoptSite *x = a, *y = b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+static void describe_deopt_site(MVMThreadContext *tc, DeoptSite *site) {
+    MVMSpeshCandidate *cand = site->cand;
+    MVMuint32 target = cand->deopts[2 * site->deopt_idx];
+    MVMuint32 offset = cand->deopts[2 * site->deopt_idx + 1];
+    MVMBytecodeAnnotation *annot;
+    MVMuint32 i;
+    site->sf = cand->sf;
+    for (i = 0; i < cand->num_inlines; i++) {
+        if (offset > cand->inlines[i].start && offset <= cand->inlines[i].end) {
+            site->sf = cand->inlines[i].sf;
+            break;
+        }
+    }
+    annot = MVM_bytecode_resolve_annotation(tc, &site->sf->body, target);
+    site->line = annot ? annot->line_number : 0;
+    MVM_free(annot);
+    site->op_name = cand->deopt_ops && cand->deopt_ops[site->deopt_idx]
+        ? MVM_op_get_op(cand->deopt_ops[site->deopt_idx])->name
+        : "?";
+    site->discarded = cand->discarded;
+}
+
+/* Gathers the deopt points that have been hit, most hit first, keeping at
+ * most MVM_SPESH_DEOPT_REPORT_TOP of them. They are described while the
+ * lock is held, since the candidates may go away once it is released. */
+static MVMuint32 gather_deopt_sites(MVMThreadContext *tc, DeoptSite **sites_out) {
+    MVM_VECTOR_DECL(DeoptSite, sites);
+    MVMSpeshCandidate *cand;
+    MVMuint32 num, i;
+    MVM_VECTOR_INIT(sites, 32);
+    uv_mutex_lock(&tc->instance->mutex_deopting_candidates);
+    for (cand = tc->instance->deopting_candidates; cand; cand = cand->next_deopting) {
+        for (i = 0; i < cand->num_deopts; i++) {
+            if (cand->deopt_counts[i]) {
+                DeoptSite site;
+                site.cand = cand;
+                site.deopt_idx = i;
+                site.count = cand->deopt_counts[i];
+                MVM_VECTOR_PUSH(sites, site);
+            }
+        }
+    }
+    num = MVM_VECTOR_ELEMS(sites);
+    qsort(sites, num, sizeof(DeoptSite), cmp_deopt_site);
+    if (num > MVM_SPESH_DEOPT_REPORT_TOP)
+        num = MVM_SPESH_DEOPT_REPORT_TOP;
+    for (i = 0; i < num; i++)
+        describe_deopt_site(tc, &sites[i]);
+    uv_mutex_unlock(&tc->instance->mutex_deopting_candidates);
+    *sites_out = sites;
+    return num;
+}
+
+/* Writes the most hit deopt points to the given file. */
+void MVM_spesh_deopt_report(MVMThreadContext *tc, FILE *out) {
+    DeoptSite *sites;
+    MVMuint32 num = gather_deopt_sites(tc, &sites), i;
+    fprintf(out, "Deopts: %"PRIu64" one, %"PRIu64" all, %"PRIu64" candidates discarded\n",
+        (MVMuint64)MVM_load(&tc->instance->stat_deopt_one),
+        (MVMuint64)MVM_load(&tc->instance->stat_deopt_all),
+        (MVMuint64)MVM_load(&tc->instance->stat_deopt_discards));
+    for (i = 0; i < num; i++) {
+        char *name = MVM_string_utf8_encode_C_string(tc, sites[i].sf->body.name);
+        char *file = MVM_string_utf8_encode_C_string(tc, sites[i].sf->body.cu->body.filename);
+        fprintf(out, "  %10u  %-20s %s (%s:%u)%s\n", sites[i].count, sites[i].op_name,
+            name[0] ? name : "<anon>", file, sites[i].line,
+            sites[i].discarded ? " [discarded]" : "");
+        MVM_free(name);
+        MVM_free(file);
+    }
+    MVM_free(sites);
+}
+
+/* Add entries to a hash describing a deopt point. */
+static void bind_site_str(MVMThreadContext *tc, MVMObject *site, const char *key, MVMString *value) {
+    MVMString *key_str;
+    MVMObject *boxed;
+    MVMROOT2(tc, site, value, {
+        key_str = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, key);
+        MVMROOT(tc, key_str, {
+            boxed = MVM_repr_box_str(tc, MVM_hll_current(tc)->str_box_type, value);
+        });
+    });
+    MVM_repr_bind_key_o(tc, site, key_str, boxed);
+}
+static void bind_site_int(MVMThreadContext *tc, MVMObject *site, const char *key, MVMint64 value) {
+    MVMString *key_str;
+    MVMObject *boxed;
+    MVMROOT(tc, site, {
+        key_str = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, key);
+        MVMROOT(tc, key_str, {
+            boxed = MVM_repr_box_int(tc, MVM_hll_current(tc)->int_box_type, value);
+        });
+    });
+    MVM_repr_bind_key_o(tc, site, key_str, boxed);
+}
+
+/* Makes an array of hashes describing the most hit deopt points, for the
+ * vmstats op. */
+MVMObject * MVM_spesh_deopt_sites(MVMThreadContext *tc) {
+    DeoptSite *sites;
+    MVMuint32 num = gather_deopt_sites(tc, &sites), i;
+    MVMObject *result;
+    for (i = 0; i < num; i++)
+        MVM_gc_root_temp_push(tc, (MVMCollectable **)&sites[i].sf);
+    result = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_array_type);
+    MVMROOT(tc, result, {
+        for (i = 0; i < num; i++) {
+            MVMObject *site = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_hash_type);
+            MVM_repr_push_o(tc, result, site);
+            MVMROOT(tc, site, {
+                MVMString *op_str;
+                bind_site_str(tc, site, "name", sites[i].sf->body.name);
+                bind_site_str(tc, site, "file", sites[i].sf->body.cu->body.filename);
+                bind_site_int(tc, site, "line", sites[i].line);
+                op_str = MVM_string_ascii_decode_nt(tc, tc->instance->VMString, sites[i].op_name);
+                bind_site_str(tc, site, "op", op_str);
+                bind_site_int(tc, site, "count", sites[i].count);
+            });
+        }
+    });
+    MVM_gc_root_temp_pop_n(tc, num);
+    MVM_free(sites);
+    return result;
+}
@@ -1,3 +1,8 @@
 void MVM_spesh_deopt_all(MVMThreadContext *tc);
 void MVM_spesh_deopt_one(MVMThreadContext *tc, MVMuint32 deopt_idx);
 MVMint32 MVM_spesh_deopt_find_inactive_frame_deopt_idx(MVMThreadContext *tc, MVMFrame *f);
+void MVM_spesh_deopt_report(MVMThreadContext *tc, FILE *out);
+MVMObject * MVM_spesh_deopt_sites(MVMThreadContext *tc);
+
+/* How many of the most hit deopt points are reported. */
+#define MVM_SPESH_DEOPT_REPORT_TOP 25
@@ -335,8 +335,18 @@ static void dump_bb(MVMThreadContext *tc, DumpStr *ds, MVMSpeshGraph *g, MVMSpes
                             size += 2;
                             break;
                         case MVM_operand_coderef: {
-                            MVMCodeBody *body = &((MVMCode*)g->sf->body.cu->body.coderefs[cur_ins->operands[i].coderef_idx])->body;
-                            MVMBytecodeAnnotation *anno = MVM_bytecode_resolve_annotation(tc, &body->sf->body, 0);
+                            MVMCode *code = (MVMCode *)g->sf->body.cu->body.coderefs[cur_ins->operands[i].coderef_idx];
+                            MVMCodeBody *body;
+                            MVMBytecodeAnnotation *anno;
+
+                            /* Don't make code objects from the spesh thread. */
+                            if (!code) {
+                                appendf(ds, "coderef(%"PRIu16", not yet made)", cur_ins->operands[i].coderef_idx);
+                                size += 2;
+                                break;
+                            }
+                            body = &code->body;
+                            anno = MVM_bytecode_resolve_annotation(tc, &body->sf->body, 0);
 
                             append(ds, "coderef(");
 
@@ -712,11 +722,11 @@ void dump_stats_type_tuple(MVMThreadContext *tc, DumpStr *ds, MVMCallsite *cs,
             appendf(ds, "%sType %d: %s%s (%s)",
                 prefix, j,
                 (type_tuple[j].rw_cont ? "RW " : ""),
-                MVM_6model_get_stable_debug_name(tc, type->st),
+                MVM_6model_get_stable_debug_name(tc, STABLE(type)),
                 (type_tuple[j].type_concrete ? "Conc" : "TypeObj"));
             if (decont_type)
                 appendf(ds, " of %s (%s)",
-                    MVM_6model_get_stable_debug_name(tc, decont_type->st),
+                    MVM_6model_get_stable_debug_name(tc, STABLE(decont_type)),
                     (type_tuple[j].decont_type_concrete ? "Conc" : "TypeObj"));
             append(ds, "\n");
         }
@@ -752,7 +762,7 @@ void dump_stats_by_callsite(MVMThreadContext *tc, DumpStr *ds, MVMSpeshStatsByCa
                 for (k = 0; k < oss->num_types; k++)
                     appendf(ds, "                %d x type %s (%s)\n",
                         oss->types[k].count,
-                        MVM_6model_get_stable_debug_name(tc, oss->types[k].type->st),
+                        MVM_6model_get_stable_debug_name(tc, STABLE(oss->types[k].type)),
                         (oss->types[k].type_concrete ? "Conc" : "TypeObj"));
                 for (k = 0; k < oss->num_invokes; k++) {
                     char *body_name = MVM_string_utf8_encode_C_string(tc, oss->invokes[k].sf->body.name);
@@ -818,7 +828,7 @@ char * MVM_spesh_dump_stats(MVMThreadContext *tc, MVMStaticFrame *sf) {
             append(&ds, "Static values:\n");
             for (i = 0; i < ss->num_static_values; i++)
                 appendf(&ds, "    - %s (%p) @ %d\n",
-                    MVM_6model_get_stable_debug_name(tc, ss->static_values[i].value->st),
+                    MVM_6model_get_stable_debug_name(tc, STABLE(ss->static_values[i].value)),
                     ss->static_values[i].value,
                     ss->static_values[i].bytecode_offset);
         }
@@ -850,6 +860,9 @@ char * MVM_spesh_dump_planned(MVMThreadContext *tc, MVMSpeshPlanned *p) {
         case MVM_SPESH_PLANNED_DERIVED_TYPES:
             append(&ds, "Derived type");
             break;
+        case MVM_SPESH_PLANNED_BASELINE:
+            append(&ds, "Baseline");
+            break;
     }
     append(&ds, " specialization of '");
     append_str(tc, &ds, p->sf->body.name);
@@ -910,6 +923,12 @@ char * MVM_spesh_dump_planned(MVMThreadContext *tc, MVMSpeshPlanned *p) {
             dump_stats_type_tuple(tc, &ds, cs, p->type_tuple, "    ");
             break;
         }
+        case MVM_SPESH_PLANNED_BASELINE:
+            appendf(&ds,
+                "It was planned due to the callsite receiving %u hits and %u OSR hits,\n"
+                "not yet enough to specialize it.\n",
+                p->cs_stats->hits, p->cs_stats->osr_hits);
+            break;
     }
 
     appendf(&ds, "\nThe maximum stack depth is %d.\n\n", p->max_depth);
@@ -93,7 +93,7 @@ static void decont_facts(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *in
     MVMint32 in_flags = in_facts->flags;
     if ((in_flags & MVM_SPESH_FACT_TYPEOBJ) ||
             ((in_flags & MVM_SPESH_FACT_KNOWN_TYPE) &&
-            !in_facts->type->st->container_spec)) {
+            !STABLE(in_facts->type)->container_spec)) {
         copy_facts(tc, g, out_orig, out_i, in_orig, in_i);
         return;
     }
@@ -376,7 +376,7 @@ static void log_facts(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
         guard->operands[0] = guard_reg;
         guard->operands[1] = preguard_reg;
         guard->operands[2].lit_i16 = MVM_spesh_add_spesh_slot_try_reuse(tc, g,
-            (MVMCollectable *)agg_type->st);
+            (MVMCollectable *)STABLE(agg_type));
         guard->operands[3].lit_ui32 = deopt_one_ann->data.deopt_idx;
         if (ins->next)
             MVM_spesh_manipulate_insert_ins(tc, bb, ins, guard);
@@ -323,6 +323,18 @@ MVMFrame * MVM_spesh_frame_walker_get_frame(MVMThreadContext *tc, MVMSpeshFrameW
     return NULL;
 }
 
+/* Gets the static frame at the current location, be it a real frame or an
+ * inline. */
+MVMStaticFrame * MVM_spesh_frame_walker_get_static_frame(MVMThreadContext *tc, MVMSpeshFrameWalker *fw) {
+    MVMSpeshCandidate *spesh_cand;
+    if (fw->visiting_outers)
+        return fw->cur_outer_frame->static_info;
+    spesh_cand = fw->cur_caller_frame->spesh_cand;
+    return fw->inline_idx == NO_INLINE || !spesh_cand
+        ? fw->cur_caller_frame->static_info
+        : spesh_cand->inlines[fw->inline_idx].sf;
+}
+
 /* Gets a hash of the lexicals at the current location. */
 MVMObject * MVM_spesh_frame_walker_get_lexicals_hash(MVMThreadContext *tc, MVMSpeshFrameWalker *fw) {
     MVMFrame *frame;
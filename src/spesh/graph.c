@@ -39,6 +39,8 @@ void * MVM_spesh_alloc(MVMThreadContext *tc, MVMSpeshGraph *g, size_t bytes) {
  * that already pass validation. */
 static const MVMOpInfo * get_op_info(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint16 opcode) {
     if (opcode < MVM_OP_EXT_BASE) {
+        if (opcode >= MVM_SPESH_SUPEROP_FIRST && opcode <= MVM_SPESH_SUPEROP_LAST)
+            opcode = MVM_spesh_codegen_superop_base(tc, opcode);
         return MVM_op_get_op(opcode);
     }
     else {
@@ -245,12 +245,14 @@ MVMuint32 MVM_spesh_inline_get_max_size(MVMThreadContext *tc, MVMStaticFrame *sf
 }
 
 /* Sees if it will be possible to inline the target code ref, given we could
- * already identify a spesh candidate. Returns NULL if no inlining is possible
- * or a graph ready to be merged if it will be possible. */
+ * already identify a spesh candidate, whose size must be within the given
+ * limit for the call site. Returns NULL if no inlining is possible or a graph
+ * ready to be merged if it will be possible. */
 MVMSpeshGraph * MVM_spesh_inline_try_get_graph(MVMThreadContext *tc, MVMSpeshGraph *inliner,
                                                MVMStaticFrame *target_sf,
                                                MVMSpeshCandidate *cand,
                                                MVMSpeshIns *invoke_ins,
+                                               MVMuint32 max_size,
                                                char **no_inline_reason,
                                                MVMuint32 *effective_size,
                                                MVMOpInfo const **no_inline_info) {
@@ -259,7 +261,7 @@ MVMSpeshGraph * MVM_spesh_inline_try_get_graph(MVMThreadContext *tc, MVMSpeshGra
 
     /* Check bytecode size is within the inline limit. */
     *effective_size = get_effective_size(tc, cand);
-    if (*effective_size > MVM_spesh_inline_get_max_size(tc, target_sf)) {
+    if (*effective_size > max_size) {
         *no_inline_reason = "bytecode is too large to inline";
         return NULL;
     }
@@ -747,6 +749,14 @@ static MVMSpeshBB * merge_graph(MVMThreadContext *tc, MVMSpeshGraph *inliner,
         else {
             mi_new.attr_regs = NULL;
         }
+        if (mi_orig.key_sslots) {
+            mi_new.key_sslots = MVM_malloc(mi_new.num_attr_regs * sizeof(MVMuint16));
+            for (j = 0; j < mi_new.num_attr_regs; j++)
+                mi_new.key_sslots[j] = mi_orig.key_sslots[j] + inliner->num_spesh_slots;
+        }
+        else {
+            mi_new.key_sslots = NULL;
+        }
         MVM_VECTOR_PUSH(inliner->deopt_pea.materialize_info, mi_new);
     }
     for (i = 0; i < MVM_VECTOR_ELEMS(inlinee->deopt_pea.deopt_point); i++) {
@@ -1,6 +1,16 @@
 /* Default maximum size of bytecode we'll inline. */
 #define MVM_SPESH_DEFAULT_MAX_INLINE_SIZE 192
 
+/* Weighing of call sites for inlining. The maximum inline size is doubled
+ * for call sites logged making at least MVM_SPESH_INLINE_HOT_CALLS calls per
+ * entry to the frame they're in, and halved for those making fewer than one
+ * call per MVM_SPESH_INLINE_COLD_ENTRIES entries. Each argument whose type
+ * is already known at the call site, so that the guard on it in the callee
+ * will go away, allows MVM_SPESH_INLINE_GUARD_BONUS bytes more. */
+#define MVM_SPESH_INLINE_HOT_CALLS      4
+#define MVM_SPESH_INLINE_COLD_ENTRIES   8
+#define MVM_SPESH_INLINE_GUARD_BONUS    8
+
 /* The maximum number of locals an inliner can reach, and maximum number of
  * inlines we can reach, before we stop inlining; this is to prevent us
  * reaching sizes where the analysis becomes hugely costly. */
@@ -57,7 +67,8 @@ struct MVMSpeshInline {
 
 MVMSpeshGraph * MVM_spesh_inline_try_get_graph(MVMThreadContext *tc,
     MVMSpeshGraph *inliner, MVMStaticFrame *target_sf, MVMSpeshCandidate *cand,
-    MVMSpeshIns *invoke_ins, char **no_inline_reason, MVMuint32 *effective_size, MVMOpInfo const **no_inline_info);
+    MVMSpeshIns *invoke_ins, MVMuint32 max_size, char **no_inline_reason,
+    MVMuint32 *effective_size, MVMOpInfo const **no_inline_info);
 MVMSpeshGraph * MVM_spesh_inline_try_get_graph_from_unspecialized(MVMThreadContext *tc,
     MVMSpeshGraph *inliner, MVMStaticFrame *target_sf, MVMSpeshIns *invoke_ins,
     MVMSpeshCallInfo *call_info, MVMSpeshStatsType *type_tuple, char **no_inline_reason, MVMOpInfo const **no_inline_info);
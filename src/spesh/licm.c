@@ -0,0 +1,452 @@
+#include "moar.h"
+
+/* Loop-invariant code motion. Natural loops are found in the graph, being a
+ * header block together with the blocks that can reach a back edge to it
+ * without passing through it, where the header dominates the source of the
+ * back edge. When a loop is entered from a single block outside of it, which
+ * goes nowhere but the header, that block serves as the preheader: any
+ * instruction in the loop computing a value only from values defined outside
+ * of it is moved to the end of the preheader, so it runs once rather than on
+ * every iteration.
+ *
+ * Since the moved instructions run even when the loop body would not have
+ * reached them, only those that can't throw, deoptimize, or have any side
+ * effect are candidates. Guards are left alone, since their deopt points are
+ * at their place in the loop. Object memory reads are moved only out of
+ * loops with no instructions that might write memory, and only when the
+ * object is known to be concrete.
+ *
+ * All versions of a register share its storage, so a moved instruction is
+ * made to write into a fresh register. Its users are rewritten to read that;
+ * if the original register has to hold the value, because it's needed for
+ * deoptimization or by a phi or handler, a set into it is left in the loop
+ * instead. */
+
+/* Debug logging of LICM. */
+#define LICM_LOG 0
+static void licm_log(char *fmt, ...) {
+#if LICM_LOG
+    va_list args;
+    fprintf(stderr, "LICM: ");
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+#endif
+}
+
+/* State for the loop currently being processed. */
+typedef struct {
+    /* The immediate dominator of each basic block, and whether each basic
+     * block is in the loop, indexed by basic block index. */
+    MVMSpeshBB **idom;
+    MVMuint8 *in_loop;
+
+    /* The instructions in the loop, sorted by address, and whether each was
+     * moved out of it. */
+    MVMSpeshIns **ins;
+    MVMuint8 *hoisted;
+    MVMuint32 num_ins;
+
+    /* Whether nothing in the loop might write to memory. */
+    MVMuint8 read_only;
+
+    /* The preheader, and the instruction after which to put what's moved. */
+    MVMSpeshBB *preheader;
+    MVMSpeshIns *insert_after;
+
+    /* The first instruction moved into the preheader, if any. */
+    MVMSpeshIns *first_hoisted;
+
+    /* Registers from this index on were made by this pass. */
+    MVMuint16 first_reg;
+} LoopState;
+
+/* Instructions that compute a value from their operands alone, and never
+ * throw. */
+static MVMint32 is_invariant_op(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_OP_add_i: case MVM_OP_sub_i: case MVM_OP_mul_i:
+        case MVM_OP_neg_i: case MVM_OP_abs_i: case MVM_OP_cmp_i:
+        case MVM_OP_band_i: case MVM_OP_bor_i: case MVM_OP_bxor_i:
+        case MVM_OP_bnot_i: case MVM_OP_blshift_i: case MVM_OP_brshift_i:
+        case MVM_OP_not_i: case MVM_OP_eq_i: case MVM_OP_ne_i:
+        case MVM_OP_lt_i: case MVM_OP_le_i: case MVM_OP_gt_i: case MVM_OP_ge_i:
+        case MVM_OP_add_n: case MVM_OP_sub_n: case MVM_OP_mul_n:
+        case MVM_OP_div_n: case MVM_OP_neg_n:
+        case MVM_OP_eq_n: case MVM_OP_ne_n: case MVM_OP_lt_n:
+        case MVM_OP_le_n: case MVM_OP_gt_n: case MVM_OP_ge_n:
+        case MVM_OP_coerce_in: case MVM_OP_coerce_ni:
+        case MVM_OP_isnull: case MVM_OP_isconcrete: case MVM_OP_eqaddr:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Instructions that read object memory at an offset, and do nothing else. */
+static MVMint32 is_load_op(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_OP_sp_get_o: case MVM_OP_sp_get_i64: case MVM_OP_sp_get_i32:
+        case MVM_OP_sp_get_i16: case MVM_OP_sp_get_i8: case MVM_OP_sp_get_n:
+        case MVM_OP_sp_get_s:
+        case MVM_OP_sp_p6oget_o: case MVM_OP_sp_p6oget_i: case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6oget_s: case MVM_OP_sp_p6oget_i32:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Instructions that don't write to memory, besides the above. */
+static MVMint32 is_non_writing_op(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_SSA_PHI:
+        case MVM_OP_set: case MVM_OP_goto: case MVM_OP_if_i: case MVM_OP_unless_i:
+        case MVM_OP_const_i64: case MVM_OP_const_i64_16: case MVM_OP_const_i64_32:
+        case MVM_OP_const_n64: case MVM_OP_const_s: case MVM_OP_null:
+        case MVM_OP_sp_getspeshslot:
+        case MVM_OP_sp_guard: case MVM_OP_sp_guardconc: case MVM_OP_sp_guardtype:
+        case MVM_OP_sp_guardobj: case MVM_OP_sp_guardnotobj:
+        case MVM_OP_sp_guardjustconc: case MVM_OP_sp_guardjusttype:
+            return 1;
+        default:
+            return is_invariant_op(opcode) || is_load_op(opcode);
+    }
+}
+
+static int cmp_ins(const void *a, const void *b) {
+    MVMSpeshIns *ia = *(MVMSpeshIns **)a;
+    MVMSpeshIns *ib = *(MVMSpeshIns **)b;
+    return ia < ib ? -1 : ia > ib ? 1 : 0;
+}
+
+/* Finds the index of an instruction in the loop, or -1 if it's not in it. */
+static MVMint32 find_loop_ins(LoopState *ls, MVMSpeshIns *ins) {
+    MVMint32 lo = 0, hi = (MVMint32)ls->num_ins - 1;
+    while (lo <= hi) {
+        MVMint32 mid = (lo + hi) / 2;
+        if (ls->ins[mid] == ins)
+            return mid;
+        if (ls->ins[mid] < ins)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return -1;
+}
+
+/* Checks if one basic block dominates another. */
+static MVMint32 dominates(LoopState *ls, MVMSpeshBB *a, MVMSpeshBB *b) {
+    while (b && b != a)
+        b = ls->idom[b->idx];
+    return b == a;
+}
+
+/* Checks if the value read by an operand is defined outside of the loop (or
+ * by an instruction already moved out of it). A set left behind by an earlier
+ * move is looked through, to the fresh register it copies. */
+static MVMint32 is_invariant(MVMThreadContext *tc, MVMSpeshGraph *g, LoopState *ls,
+                             MVMSpeshOperand o) {
+    MVMSpeshIns *writer = MVM_spesh_get_facts(tc, g, o)->writer;
+    MVMint32 idx;
+    if (!writer)
+        return 1;
+    if (writer->info->opcode == MVM_OP_set && writer->operands[1].reg.orig >= ls->first_reg)
+        return is_invariant(tc, g, ls, writer->operands[1]);
+    idx = find_loop_ins(ls, writer);
+    return idx < 0 || ls->hoisted[idx];
+}
+
+static MVMint32 can_hoist(MVMThreadContext *tc, MVMSpeshGraph *g, LoopState *ls,
+                          MVMSpeshIns *ins) {
+    MVMuint16 opcode = ins->info->opcode;
+    MVMuint16 i;
+    if (ins->annotations || (ins->info->operands[0] & MVM_operand_rw_mask) != MVM_operand_write_reg)
+        return 0;
+    if (is_load_op(opcode)) {
+        MVMSpeshFacts *obj_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+        if (!ls->read_only || !(obj_facts->flags & MVM_SPESH_FACT_CONCRETE)
+                || !(obj_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE))
+            return 0;
+    }
+    else if (!is_invariant_op(opcode)) {
+        return 0;
+    }
+    for (i = 1; i < ins->info->num_operands; i++)
+        if ((ins->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_read_reg
+                && !is_invariant(tc, g, ls, ins->operands[i]))
+            return 0;
+    return 1;
+}
+
+/* Checks if the value written by an instruction has to stay in the register
+ * it was written to. */
+static MVMint32 needs_original_reg(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand o) {
+    MVMSpeshUseChainEntry *use;
+    if (MVM_spesh_usages_is_used_by_deopt(tc, g, o) || MVM_spesh_usages_is_used_by_handler(tc, g, o))
+        return 1;
+    for (use = MVM_spesh_get_facts(tc, g, o)->usage.users; use; use = use->next)
+        if (use->user->info->opcode == MVM_SSA_PHI)
+            return 1;
+    return 0;
+}
+
+/* Moves an instruction in the loop to the end of the preheader. */
+static void hoist(MVMThreadContext *tc, MVMSpeshGraph *g, LoopState *ls, MVMSpeshBB *bb,
+                  MVMSpeshIns *ins) {
+    MVMSpeshOperand result = ins->operands[0];
+    MVMSpeshIns *prev = ins->prev;
+    MVMSpeshFacts *res_facts, *new_facts;
+    MVMSpeshOperand fresh;
+    MVMuint16 i;
+
+    /* Read past any sets left behind by earlier moves. */
+    for (i = 1; i < ins->info->num_operands; i++) {
+        if ((ins->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_read_reg) {
+            MVMSpeshIns *writer = MVM_spesh_get_facts(tc, g, ins->operands[i])->writer;
+            while (writer && writer->info->opcode == MVM_OP_set
+                    && writer->operands[1].reg.orig >= ls->first_reg) {
+                MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[i], ins);
+                ins->operands[i] = writer->operands[1];
+                MVM_spesh_usages_add_by_reg(tc, g, ins->operands[i], ins);
+                writer = MVM_spesh_get_facts(tc, g, ins->operands[i])->writer;
+            }
+        }
+    }
+
+    /* Take it out of its basic block. */
+    if (ins->prev)
+        ins->prev->next = ins->next;
+    else
+        bb->first_ins = ins->next;
+    if (ins->next)
+        ins->next->prev = ins->prev;
+    else
+        bb->last_ins = ins->prev;
+    ins->prev = ins->next = NULL;
+
+    /* Make a fresh register for it to write, with the same facts. */
+    fresh.reg.orig = MVM_spesh_manipulate_get_unique_reg(tc, g, g->local_types
+        ? g->local_types[result.reg.orig]
+        : g->sf->body.local_types[result.reg.orig]);
+    fresh.reg.i = 0;
+    res_facts = MVM_spesh_get_facts(tc, g, result);
+    new_facts = MVM_spesh_get_facts(tc, g, fresh);
+    *new_facts = *res_facts;
+    new_facts->writer = ins;
+    ins->operands[0] = fresh;
+
+    if (needs_original_reg(tc, g, result)) {
+        /* Leave a set into the original register behind. */
+        MVMSpeshIns *set = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshIns));
+        set->info = MVM_op_get_op(MVM_OP_set);
+        set->operands = MVM_spesh_alloc(tc, g, 2 * sizeof(MVMSpeshOperand));
+        set->operands[0] = result;
+        set->operands[1] = fresh;
+        memset(&(new_facts->usage), 0, sizeof(MVMSpeshUsages));
+        MVM_spesh_usages_add_by_reg(tc, g, fresh, set);
+        res_facts->writer = set;
+        MVM_spesh_manipulate_insert_ins(tc, bb, prev, set);
+    }
+    else {
+        /* Point all of the users at the fresh register. */
+        MVMSpeshUseChainEntry *use;
+        for (use = new_facts->usage.users; use; use = use->next) {
+            MVMSpeshIns *user = use->user;
+            for (i = 0; i < user->info->num_operands; i++)
+                if ((user->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_read_reg
+                        && user->operands[i].reg.orig == result.reg.orig
+                        && user->operands[i].reg.i == result.reg.i)
+                    user->operands[i] = fresh;
+        }
+        memset(&(res_facts->usage), 0, sizeof(MVMSpeshUsages));
+        res_facts->writer = NULL;
+        res_facts->dead_writer = 1;
+    }
+
+    /* Put it in the preheader. */
+    MVM_spesh_manipulate_insert_ins(tc, ls->preheader, ls->insert_after, ins);
+    ls->insert_after = ins;
+    if (!ls->first_hoisted)
+        ls->first_hoisted = ins;
+    ls->hoisted[find_loop_ins(ls, ins)] = 1;
+    licm_log("moved %s out of the loop headed by BB %d", ins->info->name,
+        ls->preheader->succ[0]->idx);
+}
+
+/* Finds the OSR deopt annotation on an instruction, if any. */
+static MVMSpeshAnn * find_osr_ann(MVMSpeshIns *ins) {
+    MVMSpeshAnn *ann = ins->annotations;
+    while (ann && ann->type != MVM_SPESH_ANN_DEOPT_OSR)
+        ann = ann->next;
+    return ann;
+}
+
+/* Processes the loop with the given header, if it is one. */
+static void process_loop(MVMThreadContext *tc, MVMSpeshGraph *g, LoopState *ls,
+                         MVMSpeshBB **rpo, MVMuint32 num_idx, MVMSpeshBB *header) {
+    MVMSpeshBB **worklist;
+    MVMSpeshBB *preheader = NULL;
+    MVMSpeshIns *osr_ins = NULL;
+    MVMuint32 num_work = 0, i, changed;
+
+    /* Find the back edges and, from them, the blocks in the loop. */
+    memset(ls->in_loop, 0, num_idx);
+    ls->in_loop[header->idx] = 1;
+    worklist = MVM_malloc(num_idx * sizeof(MVMSpeshBB *));
+    for (i = 0; i < header->num_pred; i++) {
+        MVMSpeshBB *pred = header->pred[i];
+        if (dominates(ls, header, pred) && !ls->in_loop[pred->idx]) {
+            ls->in_loop[pred->idx] = 1;
+            worklist[num_work++] = pred;
+        }
+    }
+    if (!num_work) {
+        MVM_free(worklist);
+        return;
+    }
+    while (num_work) {
+        MVMSpeshBB *bb = worklist[--num_work];
+        for (i = 0; i < bb->num_pred; i++) {
+            if (!ls->in_loop[bb->pred[i]->idx]) {
+                ls->in_loop[bb->pred[i]->idx] = 1;
+                worklist[num_work++] = bb->pred[i];
+            }
+        }
+    }
+    MVM_free(worklist);
+
+    /* There must be a single way in, from a block that goes nowhere else and
+     * ends in nothing we can't put instructions before or after. */
+    for (i = 0; i < header->num_pred; i++) {
+        if (!ls->in_loop[header->pred[i]->idx]) {
+            if (preheader)
+                return;
+            preheader = header->pred[i];
+        }
+    }
+    if (!preheader || preheader->num_succ != 1 || preheader->jumplist || header->jumplist)
+        return;
+    if (preheader->last_ins && preheader->last_ins->info->opcode != MVM_OP_goto) {
+        MVMuint16 j;
+        for (j = 0; j < preheader->last_ins->info->num_operands; j++)
+            if ((preheader->last_ins->info->operands[j] & MVM_operand_rw_mask) == MVM_operand_literal
+                    && (preheader->last_ins->info->operands[j] & MVM_operand_type_mask) == MVM_operand_ins)
+                return;
+    }
+
+    /* Collect the instructions in the loop. An OSR entry into the loop is
+     * only allowed right at the start of the header, in which case it can be
+     * moved to the start of what we put in the preheader. */
+    ls->num_ins = 0;
+    ls->read_only = 1;
+    for (i = 0; i < g->num_bbs; i++) {
+        MVMSpeshBB *bb = rpo[i];
+        MVMSpeshIns *ins;
+        if (!ls->in_loop[bb->idx])
+            continue;
+        for (ins = bb->first_ins; ins; ins = ins->next) {
+            if (find_osr_ann(ins)) {
+                MVMSpeshIns *first = header->first_ins;
+                while (first && first->info->opcode == MVM_SSA_PHI)
+                    first = first->next;
+                if (ins != first)
+                    return;
+                osr_ins = ins;
+            }
+            if (!is_non_writing_op(ins->info->opcode))
+                ls->read_only = 0;
+            ls->num_ins++;
+        }
+    }
+    ls->ins = MVM_malloc(ls->num_ins * sizeof(MVMSpeshIns *));
+    ls->hoisted = MVM_calloc(ls->num_ins, 1);
+    ls->num_ins = 0;
+    for (i = 0; i < g->num_bbs; i++) {
+        MVMSpeshIns *ins;
+        if (ls->in_loop[rpo[i]->idx])
+            for (ins = rpo[i]->first_ins; ins; ins = ins->next)
+                ls->ins[ls->num_ins++] = ins;
+    }
+    qsort(ls->ins, ls->num_ins, sizeof(MVMSpeshIns *), cmp_ins);
+
+    /* Keep moving instructions out until nothing more can be. */
+    ls->preheader = preheader;
+    ls->insert_after = preheader->last_ins && preheader->last_ins->info->opcode == MVM_OP_goto
+        ? preheader->last_ins->prev
+        : preheader->last_ins;
+    ls->first_hoisted = NULL;
+    do {
+        changed = 0;
+        for (i = 0; i < g->num_bbs; i++) {
+            MVMSpeshBB *bb = rpo[i];
+            MVMSpeshIns *ins;
+            if (!ls->in_loop[bb->idx])
+                continue;
+            ins = bb->first_ins;
+            while (ins) {
+                MVMSpeshIns *next = ins->next;
+                if (ins->info->opcode != MVM_SSA_PHI && can_hoist(tc, g, ls, ins)) {
+                    hoist(tc, g, ls, bb, ins);
+                    changed = 1;
+                }
+                ins = next;
+            }
+        }
+    } while (changed);
+
+    /* Move an OSR entry so the moved instructions run after it. It may now
+     * be on a set left behind at the start of the header. */
+    if (osr_ins && ls->first_hoisted) {
+        MVMSpeshIns *first = header->first_ins;
+        MVMSpeshAnn *ann;
+        MVMSpeshAnn **link;
+        while (first->info->opcode == MVM_SSA_PHI)
+            first = first->next;
+        ann = find_osr_ann(first);
+        link = &(first->annotations);
+        while (*link != ann)
+            link = &((*link)->next);
+        *link = ann->next;
+        ann->next = ls->first_hoisted->annotations;
+        ls->first_hoisted->annotations = ann;
+    }
+
+    MVM_free(ls->ins);
+    MVM_free(ls->hoisted);
+}
+
+void MVM_spesh_licm(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    LoopState ls;
+    MVMSpeshBB **rpo;
+    MVMSpeshBB *bb;
+    MVMuint32 num_idx = 0;
+    MVMint32 i;
+
+    /* Make sure the dominator tree and predecessors are up to date, then
+     * work out the immediate dominator of each block. */
+    MVM_spesh_graph_recompute_dominance(tc, g);
+    for (bb = g->entry; bb; bb = bb->linear_next)
+        if ((MVMuint32)bb->idx >= num_idx)
+            num_idx = bb->idx + 1;
+    ls.idom = MVM_calloc(num_idx, sizeof(MVMSpeshBB *));
+    ls.in_loop = MVM_malloc(num_idx);
+    for (bb = g->entry; bb; bb = bb->linear_next) {
+        MVMuint16 j;
+        for (j = 0; j < bb->num_children; j++)
+            ls.idom[bb->children[j]->idx] = bb;
+    }
+    ls.first_reg = g->num_locals;
+
+    /* Visit the headers in reverse of reverse postorder, so inner loops are
+     * processed before the loops they are nested in, which gives the things
+     * moved out of an inner loop a chance to move out of the outer one. */
+    rpo = MVM_spesh_graph_reverse_postorder(tc, g);
+    for (i = g->num_bbs - 1; i >= 0; i--)
+        process_loop(tc, g, &ls, rpo, num_idx, rpo[i]);
+
+    MVM_free(rpo);
+    MVM_free(ls.idom);
+    MVM_free(ls.in_loop);
+}
@@ -0,0 +1 @@
+void MVM_spesh_licm(MVMThreadContext *tc, MVMSpeshGraph *g);
@@ -21,6 +21,23 @@ MVMSpeshLog * MVM_spesh_log_create(MVMThreadContext *tc, MVMThread *target_threa
     return result;
 }
 
+/* Adapts how many frame entries we sample for logging to the backlog of logs
+ * the spesh worker has yet to get to, logging fewer while it lags behind
+ * and going back to logging them all once it has caught up. */
+static void adapt_sample_rate(MVMThreadContext *tc) {
+    MVMuint64 backlog = MVM_repr_elems(tc, tc->instance->spesh_queue);
+    MVMuint32 rate = tc->spesh_log_sample_rate;
+    if (backlog > MVM_SPESH_LOG_SAMPLE_BACKLOG) {
+        if (rate < MVM_SPESH_LOG_SAMPLE_MAX) {
+            tc->spesh_log_sample_rate = rate < 2 ? 2 : rate * 2;
+            MVM_telemetry_timestamp(tc, "spesh worker backed up; sampling fewer frames to log");
+        }
+    }
+    else if (rate > 1) {
+        tc->spesh_log_sample_rate = rate / 2;
+    }
+}
+
 /* Increments the used count and - if it hits the limit - sends the log off
  * to the worker thread and NULLs it out. */
 void send_log(MVMThreadContext *tc, MVMSpeshLog *sl) {
@@ -43,6 +60,7 @@ void send_log(MVMThreadContext *tc, MVMSpeshLog *sl) {
     }
     else {
         MVM_repr_push_o(tc, tc->instance->spesh_queue, (MVMObject *)sl);
+        adapt_sample_rate(tc);
     }
     if (MVM_decr(&(tc->spesh_log_quota)) > 1) {
         tc->spesh_log = MVM_spesh_log_create(tc, tc->thread_obj);
@@ -84,7 +102,7 @@ static void log_param_type(MVMThreadContext *tc, MVMint32 cid, MVMuint16 arg_idx
     MVMSpeshLogEntry *entry = &(sl->body.entries[sl->body.used]);
     entry->kind = kind;
     entry->id = cid;
-    MVM_ASSIGN_REF(tc, &(sl->common.header), entry->param.type, value->st->WHAT);
+    MVM_ASSIGN_REF(tc, &(sl->common.header), entry->param.type, STABLE(value)->WHAT);
     entry->param.flags = IS_CONCRETE(value) ? MVM_SPESH_LOG_TYPE_FLAG_CONCRETE : 0;
     if (rw_cont)
         entry->param.flags |= MVM_SPESH_LOG_TYPE_FLAG_RW_CONT;
@@ -154,7 +172,7 @@ void MVM_spesh_log_type(MVMThreadContext *tc, MVMObject *value) {
     MVMSpeshLogEntry *entry = &(sl->body.entries[sl->body.used]);
     entry->kind = MVM_SPESH_LOG_TYPE;
     entry->id = cid;
-    MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, value->st->WHAT);
+    MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, STABLE(value)->WHAT);
     entry->type.flags = IS_CONCRETE(value) ? MVM_SPESH_LOG_TYPE_FLAG_CONCRETE : 0;
     entry->type.bytecode_offset = (*(tc->interp_cur_op) - *(tc->interp_bytecode_start)) - 2;
     commit_entry(tc, sl);
@@ -180,7 +198,7 @@ void MVM_spesh_log_decont(MVMThreadContext *tc, MVMuint8 *prev_op, MVMObject *va
         MVMSpeshLogEntry *entry = &(sl->body.entries[sl->body.used]);
         entry->kind = MVM_SPESH_LOG_TYPE;
         entry->id = cid;
-        MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, value->st->WHAT);
+        MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, STABLE(value)->WHAT);
         entry->type.flags = IS_CONCRETE(value) ? MVM_SPESH_LOG_TYPE_FLAG_CONCRETE : 0;
         entry->type.bytecode_offset = (prev_op - *(tc->interp_bytecode_start)) - 2;
         commit_entry(tc, sl);
@@ -215,7 +233,7 @@ void MVM_spesh_log_return_type(MVMThreadContext *tc, MVMObject *value) {
     entry->kind = MVM_SPESH_LOG_RETURN;
     entry->id = cid;
     if (value) {
-        MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, value->st->WHAT);
+        MVM_ASSIGN_REF(tc, &(sl->common.header), entry->type.type, STABLE(value)->WHAT);
         entry->type.flags = IS_CONCRETE(value) ? MVM_SPESH_LOG_TYPE_FLAG_CONCRETE : 0;
     }
     else {
@@ -24,6 +24,25 @@ struct MVMSpeshLogGuard {
  * thresholds.c, but we set it higher to allow more data collection. */
 #define MVM_SPESH_LOG_LOGGED_ENOUGH 1000
 
+/* Sampling of frame entries for logging. When a thread sends a log while the
+ * spesh worker has more than MVM_SPESH_LOG_SAMPLE_BACKLOG others queued, it
+ * goes on to log only one in so many frame entries, starting at 2 and
+ * doubling with each such send up to MVM_SPESH_LOG_SAMPLE_MAX; sends with
+ * the backlog below that halve it again, until every entry is logged. */
+#define MVM_SPESH_LOG_SAMPLE_BACKLOG 2
+#define MVM_SPESH_LOG_SAMPLE_MAX 16
+
+/* Decides whether to log the entry to a frame we could log, going by the
+ * current sampling rate (where 0 and 1 both mean all of them). */
+MVM_STATIC_INLINE MVMint32 MVM_spesh_log_sample(MVMThreadContext *tc) {
+    if (tc->spesh_log_sample_countdown > 1) {
+        tc->spesh_log_sample_countdown--;
+        return 0;
+    }
+    tc->spesh_log_sample_countdown = tc->spesh_log_sample_rate;
+    return 1;
+}
+
 /* Quick inline checks if we are logging, to save function call overhead. */
 MVM_STATIC_INLINE MVMint32 MVM_spesh_log_is_logging(MVMThreadContext *tc) {
     MVMFrame *cur_frame = tc->cur_frame;
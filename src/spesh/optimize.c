@@ -7,17 +7,29 @@ static void optimize_bb(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
 /* This is where the main optimization work on a spesh graph takes place,
  * using facts discovered during analysis. */
 
+/* How a call site was weighed for inlining: how many calls it was logged
+ * making over how many entries to the frame it's in, how many of its
+ * arguments are of known type, and the size limit that came out of that. */
+typedef struct {
+    MVMuint32   site_calls;
+    MVMuint32   frame_hits;
+    MVMuint32   known_args;
+    MVMuint32   size_limit;
+    const char *weight;
+} InlineCost;
+
 /* Logging of whether we can or can't inline. */
 static void log_inline(MVMThreadContext *tc, MVMSpeshGraph *g, MVMStaticFrame *target_sf,
                        MVMSpeshGraph *inline_graph, MVMuint32 bytecode_size,
-                       char *no_inline_reason, MVMint32 unspecialized, const MVMOpInfo *no_inline_info) {
+                       char *no_inline_reason, MVMint32 unspecialized, const MVMOpInfo *no_inline_info,
+                       InlineCost *cost) {
     if (tc->instance->spesh_inline_log) {
         char *c_name_i = MVM_string_utf8_encode_C_string(tc, target_sf->body.name);
         char *c_cuid_i = MVM_string_utf8_encode_C_string(tc, target_sf->body.cuuid);
         char *c_name_t = MVM_string_utf8_encode_C_string(tc, g->sf->body.name);
         char *c_cuid_t = MVM_string_utf8_encode_C_string(tc, g->sf->body.cuuid);
         if (inline_graph) {
-            fprintf(stderr, "Can inline %s%s (%s) with bytecode size %u into %s (%s)\n",
+            fprintf(stderr, "Can inline %s%s (%s) with bytecode size %u into %s (%s)",
                 unspecialized ? "unspecialized " : "",
                 c_name_i, c_cuid_i,
                 bytecode_size, c_name_t, c_cuid_t);
@@ -28,8 +40,10 @@ static void log_inline(MVMThreadContext *tc, MVMSpeshGraph *g, MVMStaticFrame *t
             if (no_inline_info) {
                 fprintf(stderr, " - ins: %s", no_inline_info->name);
             }
-            fprintf(stderr, "\n");
         }
+        fprintf(stderr, " [%s call site, %u calls in %u entries, %u known args, size limit %u]\n",
+            cost->weight, cost->site_calls, cost->frame_hits, cost->known_args,
+            cost->size_limit);
         MVM_free(c_name_i);
         MVM_free(c_cuid_i);
         MVM_free(c_name_t);
@@ -168,9 +182,102 @@ static void optimize_findmeth_s_perhaps_constant(MVMThreadContext *tc, MVMSpeshG
     }
 }
 
+/* Looks at the types logged for the instruction that wrote the invocant of a
+ * method lookup, and if between 2 and MVM_SPESH_POLY_MAX_TYPES of them make up
+ * nearly all of what was seen and every one of them resolves the method,
+ * rewrites the lookup to check for each of them in turn, with the methods
+ * they resolve to in spesh slots. Returns non-zero if it did that. */
+#define MVM_SPESH_POLY_MAX_TYPES 4
+static MVMint32 try_polymorphic_method_lookup(MVMThreadContext *tc, MVMSpeshGraph *g,
+        MVMSpeshIns *ins, MVMSpeshFacts *obj_facts, MVMSpeshPlanned *p) {
+    MVMObject *types[MVM_SPESH_POLY_MAX_TYPES];
+    MVMObject *meths[MVM_SPESH_POLY_MAX_TYPES];
+    MVMuint32 counts[MVM_SPESH_POLY_MAX_TYPES];
+    MVMuint32 num_types = 0, total = 0, covered = 0, i, j, k;
+    MVMSpeshAnn *ann;
+    MVMSpeshOperand *orig_o;
+    MVMString *name;
+
+    /* Find the logged offset of the invocant's writer. */
+    if (!p || !obj_facts->writer)
+        return 0;
+    ann = obj_facts->writer->annotations;
+    while (ann && ann->type != MVM_SPESH_ANN_LOGGED)
+        ann = ann->next;
+    if (!ann)
+        return 0;
+
+    /* Count up the types seen there, by STable, as that's what will be
+     * checked. Give up if there are too many distinct ones. */
+    for (i = 0; i < p->num_type_stats; i++) {
+        MVMSpeshStatsByType *ts = p->type_stats[i];
+        for (j = 0; j < ts->num_by_offset; j++) {
+            MVMSpeshStatsByOffset *oss = &(ts->by_offset[j]);
+            if (oss->bytecode_offset != ann->data.bytecode_offset)
+                continue;
+            for (k = 0; k < oss->num_types; k++) {
+                MVMObject *type = oss->types[k].type;
+                MVMuint32 t;
+                total += oss->types[k].count;
+                if (!type)
+                    continue;
+                for (t = 0; t < num_types; t++)
+                    if (STABLE(types[t]) == STABLE(type))
+                        break;
+                if (t == num_types) {
+                    if (num_types == MVM_SPESH_POLY_MAX_TYPES)
+                        return 0;
+                    types[num_types] = type;
+                    counts[num_types++] = 0;
+                }
+                counts[t] += oss->types[k].count;
+            }
+            break;
+        }
+    }
+    for (i = 0; i < num_types; i++)
+        covered += counts[i];
+    if (num_types < 2 || covered < total - total / 10)
+        return 0;
+
+    /* Resolve the method for each of the types. */
+    for (i = 0; i < num_types; i++) {
+        name = MVM_spesh_get_string(tc, g, ins->operands[2]);
+        meths[i] = MVM_spesh_try_find_method(tc, types[i], name);
+        if (MVM_is_null(tc, meths[i]))
+            return 0;
+    }
+
+    /* Rewrite the instruction, putting the pairs in consecutive slots. */
+    orig_o = ins->operands;
+    ins->info = MVM_op_get_op(MVM_OP_sp_findmeth_poly);
+    ins->operands = MVM_spesh_alloc(tc, g, 5 * sizeof(MVMSpeshOperand));
+    memcpy(ins->operands, orig_o, 3 * sizeof(MVMSpeshOperand));
+    for (i = 0; i < num_types; i++) {
+        MVMint16 ss = MVM_spesh_add_spesh_slot(tc, g, (MVMCollectable *)STABLE(types[i]));
+        if (i == 0)
+            ins->operands[3].lit_i16 = ss;
+        MVM_spesh_add_spesh_slot(tc, g, (MVMCollectable *)meths[i]);
+    }
+    ins->operands[4].lit_i16 = num_types;
+
+    if (MVM_spesh_debug_enabled(tc)) {
+        char *name_cstr;
+        name = MVM_spesh_get_string(tc, g, orig_o[2]);
+        name_cstr = MVM_string_utf8_encode_C_string(tc, name);
+        MVM_spesh_graph_add_comment(tc, g, ins,
+                "polymorphic method lookup of '%s' over %u types",
+                name_cstr, num_types);
+        MVM_free(name_cstr);
+    }
+    return 1;
+}
+
 /* Performs optimization on a method lookup. If we know the type that we'll
- * be dispatching on, resolve it right off. If not, add a cache. */
-static void optimize_method_lookup(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins) {
+ * be dispatching on, resolve it right off. If not, but a few types were seen,
+ * check for each of them. Otherwise, add a cache. */
+static void optimize_method_lookup(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
+                                   MVMSpeshPlanned *p) {
     /* See if we can resolve the method right off due to knowing the type. */
     MVMSpeshFacts *obj_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
     MVMint32 resolved = 0;
@@ -185,7 +292,7 @@ static void optimize_method_lookup(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSp
             /* Tweak facts for the target, given we know the method. */
             MVMSpeshFacts *meth_facts = MVM_spesh_get_and_use_facts(tc, g, ins->operands[0]);
             meth_facts->flags |= MVM_SPESH_FACT_KNOWN_TYPE;
-            meth_facts->type = meth->st->WHAT;
+            meth_facts->type = STABLE(meth)->WHAT;
             meth_facts->flags |= MVM_SPESH_FACT_KNOWN_VALUE;
             meth_facts->value.o = meth;
 
@@ -212,7 +319,8 @@ static void optimize_method_lookup(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSp
     /* If not, add space to cache a single type/method pair, to save hash
      * lookups in the (common) monomorphic case, and rewrite to caching
      * version of the instruction. */
-    if (!resolved && ins->info->opcode == MVM_OP_findmeth) {
+    if (!resolved && ins->info->opcode == MVM_OP_findmeth
+            && !try_polymorphic_method_lookup(tc, g, ins, obj_facts, p)) {
         MVMSpeshOperand *orig_o = ins->operands;
         ins->info = MVM_op_get_op(MVM_OP_sp_findmeth);
         ins->operands = MVM_spesh_alloc(tc, g, 4 * sizeof(MVMSpeshOperand));
@@ -633,7 +741,7 @@ static void optimize_decont(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *
     MVMSpeshFacts *obj_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
     if ((obj_facts->flags & MVM_SPESH_FACT_TYPEOBJ) ||
             ((obj_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) &&
-            !obj_facts->type->st->container_spec)) {
+            !STABLE(obj_facts->type)->container_spec)) {
         /* Know that we don't need to decont. */
         ins->info = MVM_op_get_op(MVM_OP_set);
         MVM_spesh_use_facts(tc, g, obj_facts);
@@ -803,7 +911,7 @@ static void optimize_container_check(MVMThreadContext *tc, MVMSpeshGraph *g,
         else if ((facts->flags & MVM_SPESH_FACT_CONCRETE) &&
                 (facts->flags & MVM_SPESH_FACT_KNOWN_TYPE)) {
             /* Know the type and know it's concrete. */
-            MVMContainerSpec const *cs = facts->type->st->container_spec;
+            MVMContainerSpec const *cs = STABLE(facts->type)->container_spec;
             if (!cs) {
                 /* No container spec, so can be sure it's not a container. */
                 known_result = 0;
@@ -1204,7 +1312,7 @@ static void optimize_istrue_isfalse(MVMThreadContext *tc, MVMSpeshGraph *g, MVMS
     /* Known value, maybe possible to coerce to a constant */
     if (input_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE) {
         MVMObject *objval = input_facts->value.o;
-        MVMBoolificationSpec *bs = objval->st->boolification_spec;
+        MVMBoolificationSpec *bs = STABLE(objval)->boolification_spec;
         MVMRegister resultreg;
         MVMint64 truthvalue;
         switch (bs == NULL ? MVM_BOOL_MODE_NOT_TYPE_OBJECT : bs->mode) {
@@ -1241,7 +1349,7 @@ static void optimize_istrue_isfalse(MVMThreadContext *tc, MVMSpeshGraph *g, MVMS
     if (input_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) {
         /* Go by boolification mode to pick a new instruction, if any. */
         MVMObject *type            = input_facts->type;
-        MVMBoolificationSpec *bs   = type->st->boolification_spec;
+        MVMBoolificationSpec *bs   = STABLE(type)->boolification_spec;
         MVMuint8 guaranteed_concrete = input_facts->flags & MVM_SPESH_FACT_CONCRETE;
         MVMuint8 mode = bs == NULL ? MVM_BOOL_MODE_NOT_TYPE_OBJECT : bs->mode;
 
@@ -1679,7 +1787,7 @@ static void insert_arg_type_guard(MVMThreadContext *tc, MVMSpeshGraph *g,
     guard->operands[0] = guard_reg;
     guard->operands[1] = preguard_reg;
     guard->operands[2].lit_i16 = MVM_spesh_add_spesh_slot_try_reuse(tc, g,
-        (MVMCollectable *)type_info->type->st);
+        (MVMCollectable *)STABLE(type_info->type));
     find_deopt_target_and_index(tc, g, arg_info->prepargs_ins, &deopt_target, &deopt_index);
 
     MVM_spesh_manipulate_insert_ins(tc, arg_info->prepargs_bb,
@@ -1733,7 +1841,7 @@ static void insert_arg_decont_type_guard(MVMThreadContext *tc, MVMSpeshGraph *g,
     guard->operands[0] = MVM_spesh_manipulate_new_version(tc, g, temp.reg.orig);
     guard->operands[1] = temp;
     guard->operands[2].lit_i16 = MVM_spesh_add_spesh_slot_try_reuse(tc, g,
-        (MVMCollectable *)type_info->decont_type->st);
+        (MVMCollectable *)STABLE(type_info->decont_type));
     MVM_spesh_manipulate_insert_ins(tc, arg_info->prepargs_bb,
         arg_info->prepargs_ins->prev, guard);
     MVM_spesh_usages_add_by_reg(tc, g, temp, guard);
@@ -1902,6 +2010,62 @@ static MVMuint32 get_prepargs_deopt_idx(MVMThreadContext *tc, MVMSpeshGraph *g,
     find_deopt_target_and_index(tc, g, info->prepargs_ins, &deopt_target, &deopt_index);
     return deopt_index;
 }
+/* Weighs a call site for inlining, scaling the maximum inline size by how
+ * often the call site was logged invoking per entry to the frame, and giving
+ * a bonus for arguments of known type. Call sites with no statistics (such
+ * as those in code that was itself inlined) get the plain maximum. */
+static void weigh_inline(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
+                         MVMSpeshPlanned *p, MVMSpeshCallInfo *arg_info,
+                         MVMuint32 num_arg_slots, MVMStaticFrame *target_sf,
+                         InlineCost *cost) {
+    MVMuint32 max_size = MVM_spesh_inline_get_max_size(tc, target_sf);
+    MVMuint32 invoke_offset = find_invoke_offset(tc, ins);
+    MVMuint32 i;
+
+    cost->site_calls = 0;
+    cost->frame_hits = 0;
+    cost->known_args = 0;
+    if (p && invoke_offset) {
+        for (i = 0; i < p->num_type_stats; i++) {
+            MVMSpeshStatsByType *ts = p->type_stats[i];
+            MVMuint32 j;
+            cost->frame_hits += ts->hits;
+            for (j = 0; j < ts->num_by_offset; j++) {
+                if (ts->by_offset[j].bytecode_offset == invoke_offset) {
+                    MVMSpeshStatsByOffset *by_offset = &(ts->by_offset[j]);
+                    MVMuint32 k;
+                    for (k = 0; k < by_offset->num_invokes; k++)
+                        cost->site_calls += by_offset->invokes[k].count;
+                }
+            }
+        }
+    }
+    if (num_arg_slots <= MAX_ARGS_FOR_OPT) {
+        for (i = 0; i < num_arg_slots; i++)
+            if (arg_info->arg_facts[i]
+                    && arg_info->arg_facts[i]->flags & MVM_SPESH_FACT_KNOWN_TYPE)
+                cost->known_args++;
+    }
+
+    if (!cost->frame_hits) {
+        cost->weight = "unweighed";
+        cost->size_limit = max_size;
+    }
+    else if (cost->site_calls >= (MVMuint64)cost->frame_hits * MVM_SPESH_INLINE_HOT_CALLS) {
+        cost->weight = "hot";
+        cost->size_limit = max_size * 2;
+    }
+    else if ((MVMuint64)cost->site_calls * MVM_SPESH_INLINE_COLD_ENTRIES < cost->frame_hits) {
+        cost->weight = "cold";
+        cost->size_limit = max_size / 2;
+    }
+    else {
+        cost->weight = "warm";
+        cost->size_limit = max_size;
+    }
+    cost->size_limit += cost->known_args * MVM_SPESH_INLINE_GUARD_BONUS;
+}
+
 static void optimize_call(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
                           MVMSpeshIns *ins, MVMSpeshPlanned *p, MVMint32 callee_idx,
                           MVMSpeshCallInfo *arg_info) {
@@ -2068,6 +2232,8 @@ static void optimize_call(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb
     if (target_sf->body.instrumentation_level == tc->instance->instrumentation_level) {
         MVMint32 spesh_cand = try_find_spesh_candidate(tc, target_sf, arg_info,
             stable_type_tuple);
+        InlineCost cost;
+        weigh_inline(tc, g, ins, p, arg_info, num_arg_slots, target_sf, &cost);
         if (spesh_cand >= 0) {
             /* Yes. Will we be able to inline? */
             char *no_inline_reason = NULL;
@@ -2075,8 +2241,9 @@ static void optimize_call(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb
             MVMuint32 effective_size;
             MVMSpeshGraph *inline_graph = MVM_spesh_inline_try_get_graph(tc, g,
                 target_sf, target_sf->body.spesh->body.spesh_candidates[spesh_cand],
-                ins, &no_inline_reason, &effective_size, &no_inline_info);
-            log_inline(tc, g, target_sf, inline_graph, effective_size, no_inline_reason, 0, no_inline_info);
+                ins, cost.size_limit, &no_inline_reason, &effective_size, &no_inline_info);
+            log_inline(tc, g, target_sf, inline_graph, effective_size, no_inline_reason, 0,
+                no_inline_info, &cost);
             if (inline_graph) {
                 /* Yes, have inline graph, so go ahead and do it. Make sure we
                  * keep the code ref reg alive by giving it a usage count as
@@ -2156,13 +2323,13 @@ static void optimize_call(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb
 
         /* We know what we're calling, but there's no specialization available
          * to us. If it's small, then we could produce one and inline it. */
-        else if (target_sf->body.bytecode_size < MVM_spesh_inline_get_max_size(tc, target_sf)) {
+        else if (target_sf->body.bytecode_size < cost.size_limit) {
             char *no_inline_reason = NULL;
             const MVMOpInfo *no_inline_info = NULL;
             MVMSpeshGraph *inline_graph = MVM_spesh_inline_try_get_graph_from_unspecialized(
                     tc, g, target_sf, ins, arg_info, stable_type_tuple, &no_inline_reason, &no_inline_info);
             log_inline(tc, g, target_sf, inline_graph, target_sf->body.bytecode_size,
-                    no_inline_reason, 1, no_inline_info);
+                    no_inline_reason, 1, no_inline_info, &cost);
             if (inline_graph) {
                 MVMSpeshOperand code_ref_reg = ins->info->opcode == MVM_OP_invoke_v
                         ? ins->operands[0]
@@ -2179,7 +2346,7 @@ static void optimize_call(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb
         else {
             log_inline(tc, g, target_sf, NULL, target_sf->body.bytecode_size,
                 "no spesh candidate available and bytecode too large to produce an inline",
-                0, NULL);
+                0, NULL, &cost);
         }
     }
 
@@ -2470,7 +2637,7 @@ static void optimize_container_atomic(MVMThreadContext *tc, MVMSpeshGraph *g,
                                       MVMSpeshIns *ins, MVMuint16 target_reg) {
     MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, ins->operands[target_reg]);
     if ((facts->flags & MVM_SPESH_FACT_CONCRETE) && (facts->flags & MVM_SPESH_FACT_KNOWN_TYPE)) {
-        MVMContainerSpec const *cs = facts->type->st->container_spec;
+        MVMContainerSpec const *cs = STABLE(facts->type)->container_spec;
         if (!cs)
             return;
         switch (ins->info->opcode) {
@@ -2517,8 +2684,8 @@ static void optimize_bigint_binary_op(MVMThreadContext *tc, MVMSpeshGraph *g, MV
         }
     }
     if (common_type && REPR(common_type)->ID == MVM_REPR_ID_P6opaque) {
-        MVMuint16 offset = MVM_p6opaque_get_bigint_offset(tc, common_type->st);
-        MVMint16 cache_type_index = MVM_intcache_type_index(tc, common_type->st->WHAT);
+        MVMuint16 offset = MVM_p6opaque_get_bigint_offset(tc, STABLE(common_type));
+        MVMint16 cache_type_index = MVM_intcache_type_index(tc, STABLE(common_type)->WHAT);
         if (offset && cache_type_index >= 0) {
             /* Lower the op. */
             MVMSpeshOperand *orig_operands = ins->operands;
@@ -2530,9 +2697,9 @@ static void optimize_bigint_binary_op(MVMThreadContext *tc, MVMSpeshGraph *g, MV
             }
             ins->operands = MVM_spesh_alloc(tc, g, 7 * sizeof(MVMSpeshOperand));
             ins->operands[0] = orig_operands[0];
-            ins->operands[1].lit_i16 = common_type->st->size;
+            ins->operands[1].lit_i16 = STABLE(common_type)->size;
             ins->operands[2].lit_i16 = MVM_spesh_add_spesh_slot_try_reuse(tc, g,
-                    (MVMCollectable *)common_type->st);
+                    (MVMCollectable *)STABLE(common_type));
             ins->operands[3] = orig_operands[1];
             ins->operands[4] = orig_operands[2];
             ins->operands[5].lit_i16 = offset;
@@ -2559,7 +2726,7 @@ static void optimize_bigint_bool_op(MVMThreadContext *tc, MVMSpeshGraph *g, MVMS
     }
 
     if (type && REPR(type)->ID == MVM_REPR_ID_P6opaque) {
-        MVMuint16 offset = MVM_p6opaque_get_bigint_offset(tc, type->st);
+        MVMuint16 offset = MVM_p6opaque_get_bigint_offset(tc, STABLE(type));
         if (offset) {
             MVMSpeshOperand input = ins->operands[1];
             MVMSpeshOperand output = ins->operands[0];
@@ -2820,7 +2987,7 @@ static void optimize_bb_switch(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshB
                 break;
             MVM_FALLTHROUGH
         case MVM_OP_findmeth:
-            optimize_method_lookup(tc, g, ins);
+            optimize_method_lookup(tc, g, ins, p);
             break;
         case MVM_OP_tryfindmeth_s:
             optimize_findmeth_s_perhaps_constant(tc, g, ins);
@@ -2828,7 +2995,7 @@ static void optimize_bb_switch(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshB
                 break;
             MVM_FALLTHROUGH
         case MVM_OP_tryfindmeth:
-            optimize_method_lookup(tc, g, ins);
+            optimize_method_lookup(tc, g, ins, p);
             break;
         case MVM_OP_can:
         case MVM_OP_can_s:
@@ -2912,6 +3079,8 @@ static void optimize_bb_switch(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshB
         case MVM_OP_getattrs_s:
         case MVM_OP_getattrs_o:
         case MVM_OP_create:
+        case MVM_OP_iterkey_s:
+        case MVM_OP_iterval:
             optimize_repr_op(tc, g, bb, ins, 1);
             break;
         case MVM_OP_box_i:
@@ -2933,10 +3102,19 @@ static void optimize_bb_switch(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshB
         case MVM_OP_decont_s:
         case MVM_OP_decont_u: {
             /* We'll lower these in a later pass, but we should preemptively
-             * use the facts on the box type. */
+             * use the facts on the box type. A concrete container of a known
+             * type that never invokes on fetch may get turned into a load of
+             * the value and an unbox of it right away, though. */
             MVMSpeshFacts *type_facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
-            if (type_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE)
+            if (type_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) {
+                MVMContainerSpec const *contspec = STABLE(type_facts->type)->container_spec;
                 MVM_spesh_use_facts(tc, g, type_facts);
+                if (ins->info->opcode != MVM_OP_unbox_i && ins->info->opcode != MVM_OP_unbox_n
+                        && ins->info->opcode != MVM_OP_unbox_s && ins->info->opcode != MVM_OP_unbox_u
+                        && (type_facts->flags & MVM_SPESH_FACT_CONCRETE)
+                        && contspec && contspec->fetch_never_invokes && contspec->spesh)
+                    contspec->spesh(tc, STABLE(type_facts->type), g, bb, ins);
+            }
             break;
         }
         case MVM_OP_ne_s:
@@ -3067,6 +3245,202 @@ static void optimize_bb(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
  * the pass. If they are unused, we can delete them. If they are used, then
  * we can try to lower them.
  */
+/* Common subexpression elimination. Instructions that compute a value from
+ * their operands alone, or that check the same thing about the same value
+ * again, are replaced by a set from the result of an identical instruction
+ * that dominates them. Since all versions of a register share its storage,
+ * the earlier result must not have been overwritten by the time of the later
+ * instruction; to check that cheaply, we only look back along a chain of
+ * basic blocks that each have a single predecessor, as the set elimination
+ * below also does. Reads of object memory are only deduplicated if nothing
+ * on the way might write memory. Guards whose facts already prove them are
+ * handled by optimize_guard in the main pass. */
+typedef struct {
+    MVM_VECTOR_DECL(MVMSpeshIns *, available);
+} CSEState;
+
+/* Kinds of instruction we will deduplicate. */
+#define CSE_NONE  0
+#define CSE_VALUE 1
+#define CSE_LOAD  2
+#define CSE_GUARD 3
+static MVMint32 cse_kind(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_OP_add_i: case MVM_OP_sub_i: case MVM_OP_mul_i:
+        case MVM_OP_neg_i: case MVM_OP_abs_i: case MVM_OP_cmp_i:
+        case MVM_OP_band_i: case MVM_OP_bor_i: case MVM_OP_bxor_i:
+        case MVM_OP_bnot_i: case MVM_OP_blshift_i: case MVM_OP_brshift_i:
+        case MVM_OP_not_i: case MVM_OP_eq_i: case MVM_OP_ne_i:
+        case MVM_OP_lt_i: case MVM_OP_le_i: case MVM_OP_gt_i: case MVM_OP_ge_i:
+        case MVM_OP_add_n: case MVM_OP_sub_n: case MVM_OP_mul_n:
+        case MVM_OP_div_n: case MVM_OP_neg_n:
+        case MVM_OP_eq_n: case MVM_OP_ne_n: case MVM_OP_lt_n:
+        case MVM_OP_le_n: case MVM_OP_gt_n: case MVM_OP_ge_n:
+        case MVM_OP_coerce_in: case MVM_OP_coerce_ni:
+        case MVM_OP_isnull: case MVM_OP_isconcrete: case MVM_OP_eqaddr:
+        case MVM_OP_hllboxtype_i: case MVM_OP_hllboxtype_n: case MVM_OP_hllboxtype_s:
+        case MVM_OP_box_i: case MVM_OP_box_n: case MVM_OP_box_s: case MVM_OP_box_u:
+            return CSE_VALUE;
+        case MVM_OP_unbox_i: case MVM_OP_unbox_n: case MVM_OP_unbox_s: case MVM_OP_unbox_u:
+        case MVM_OP_sp_get_o: case MVM_OP_sp_get_i64: case MVM_OP_sp_get_i32:
+        case MVM_OP_sp_get_i16: case MVM_OP_sp_get_i8: case MVM_OP_sp_get_n:
+        case MVM_OP_sp_get_s:
+        case MVM_OP_sp_p6oget_o: case MVM_OP_sp_p6oget_i: case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6oget_s: case MVM_OP_sp_p6oget_i32:
+            return CSE_LOAD;
+        case MVM_OP_sp_guard: case MVM_OP_sp_guardconc: case MVM_OP_sp_guardtype:
+        case MVM_OP_sp_guardobj: case MVM_OP_sp_guardnotobj:
+        case MVM_OP_sp_guardjustconc: case MVM_OP_sp_guardjusttype:
+            return CSE_GUARD;
+        default:
+            return CSE_NONE;
+    }
+}
+
+/* Checks if two instructions of the same op read the same values and have
+ * the same literal operands. Spesh slots are compared by what they hold. */
+static MVMint32 cse_same_operands(MVMSpeshGraph *g, MVMSpeshIns *a, MVMSpeshIns *b) {
+    MVMuint16 i;
+    for (i = 0; i < a->info->num_operands; i++) {
+        MVMuint8 flags = a->info->operands[i];
+        MVMSpeshOperand oa = a->operands[i];
+        MVMSpeshOperand ob = b->operands[i];
+        switch (flags & MVM_operand_rw_mask) {
+            case MVM_operand_write_reg:
+                break;
+            case MVM_operand_read_reg:
+                if (oa.reg.orig != ob.reg.orig || oa.reg.i != ob.reg.i)
+                    return 0;
+                break;
+            case MVM_operand_literal:
+                switch (flags & MVM_operand_type_mask) {
+                    case MVM_operand_int8:
+                        if (oa.lit_i8 != ob.lit_i8)
+                            return 0;
+                        break;
+                    case MVM_operand_int16:
+                    case MVM_operand_uint16:
+                        if (oa.lit_i16 != ob.lit_i16)
+                            return 0;
+                        break;
+                    case MVM_operand_int32:
+                    case MVM_operand_uint32:
+                        if (oa.lit_i32 != ob.lit_i32)
+                            return 0;
+                        break;
+                    case MVM_operand_int64:
+                    case MVM_operand_uint64:
+                    case MVM_operand_num64:
+                        if (oa.lit_i64 != ob.lit_i64)
+                            return 0;
+                        break;
+                    case MVM_operand_str:
+                        if (oa.lit_str_idx != ob.lit_str_idx)
+                            return 0;
+                        break;
+                    case MVM_operand_spesh_slot:
+                        if (g->spesh_slots[oa.lit_i16] != g->spesh_slots[ob.lit_i16])
+                            return 0;
+                        break;
+                    default:
+                        return 0;
+                }
+                break;
+            default:
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* Checks that, going back from one instruction to another along a chain of
+ * single-predecessor basic blocks, no other version of reg is written, and
+ * optionally that nothing might write memory. */
+static MVMint32 cse_path_clear(MVMSpeshBB *bb, MVMSpeshIns *from, MVMSpeshIns *to,
+                               MVMuint16 reg, MVMint32 check_memory) {
+    MVMSpeshBB *cur_bb = bb;
+    MVMSpeshIns *check = to->prev;
+    while (1) {
+        while (check) {
+            MVMuint16 i;
+            if (check == from)
+                return 1;
+            for (i = 0; i < check->info->num_operands; i++)
+                if ((check->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_write_reg
+                        && check->operands[i].reg.orig == reg)
+                    return 0;
+            if (check_memory && check->info->opcode != MVM_SSA_PHI
+                    && cse_kind(check->info->opcode) == CSE_NONE
+                    && (!check->info->pure || (check->info->jittivity & MVM_JIT_INFO_INVOKISH)
+                        || check->info->opcode == MVM_OP_sp_p6obind_i32)
+                    && check->info->opcode != MVM_OP_goto)
+                return 0;
+            check = check->prev;
+        }
+        if (cur_bb->num_pred != 1)
+            return 0;
+        cur_bb = cur_bb->pred[0];
+        check = cur_bb->last_ins;
+    }
+}
+
+static void cse_visit_bb(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
+                         CSEState *cs) {
+    size_t available_at_entry = MVM_VECTOR_ELEMS(cs->available);
+    MVMSpeshIns *ins;
+    MVMuint16 i;
+
+    /* Nothing before a join point can be seen past it. */
+    if (bb->num_pred != 1)
+        MVM_VECTOR_ELEMS(cs->available) = 0;
+
+    for (ins = bb->first_ins; ins; ins = ins->next) {
+        MVMint32 kind = cse_kind(ins->info->opcode);
+        MVMint64 j;
+        if (kind == CSE_NONE)
+            continue;
+        for (j = (MVMint64)MVM_VECTOR_ELEMS(cs->available) - 1; j >= 0; j--) {
+            MVMSpeshIns *prev = cs->available[j];
+            if (prev->info != ins->info || !cse_same_operands(g, prev, ins))
+                continue;
+            if (kind == CSE_GUARD) {
+                /* The earlier guard would have deoptimized already. */
+                ins->info = MVM_op_get_op(MVM_OP_set);
+                MVM_spesh_graph_add_comment(tc, g, ins, "duplicate guard");
+                break;
+            }
+            if (cse_path_clear(bb, prev, ins, prev->operands[0].reg.orig, kind == CSE_LOAD)) {
+                MVMSpeshOperand *new_operands = MVM_spesh_alloc(tc, g, 2 * sizeof(MVMSpeshOperand));
+                for (i = 1; i < ins->info->num_operands; i++)
+                    if ((ins->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_read_reg)
+                        MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[i], ins);
+                new_operands[0] = ins->operands[0];
+                new_operands[1] = prev->operands[0];
+                MVM_spesh_usages_add_by_reg(tc, g, new_operands[1], ins);
+                MVM_spesh_graph_add_comment(tc, g, ins, "common subexpression of %s",
+                    ins->info->name);
+                ins->info = MVM_op_get_op(MVM_OP_set);
+                ins->operands = new_operands;
+                break;
+            }
+        }
+        if (ins->info->opcode != MVM_OP_set)
+            MVM_VECTOR_PUSH(cs->available, ins);
+    }
+
+    /* Visit children, then forget what was made available here. */
+    for (i = 0; i < bb->num_children; i++) {
+        cse_visit_bb(tc, g, bb->children[i], cs);
+        MVM_VECTOR_ELEMS(cs->available) = available_at_entry;
+    }
+}
+static void eliminate_common_subexpressions(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    CSEState cs;
+    MVM_VECTOR_INIT(cs.available, 64);
+    cse_visit_bb(tc, g, g->entry, &cs);
+    MVM_VECTOR_DESTROY(cs.available);
+}
+
 typedef struct {
     MVMSpeshBB *bb;
     MVMSpeshIns *ins;
@@ -3422,6 +3796,74 @@ static void merge_bbs(MVMThreadContext *tc, MVMSpeshGraph *g) {
 }
 
 /* Drives the overall optimization work taking place on a spesh graph. */
+/* Checks that the closure in the given register is only used as the code
+ * invoked by a call this frame makes, or by a guard or an outer lexical access
+ * for such a call that was inlined, looking through copies of it. Then it is
+ * never stored anywhere, so it can't outlive the frame. */
+static MVMint32 closure_only_invoked(MVMThreadContext *tc, MVMSpeshGraph *g,
+                                     MVMSpeshOperand reg) {
+    MVMSpeshUseChainEntry *use = MVM_spesh_get_facts(tc, g, reg)->usage.users;
+    while (use) {
+        MVMSpeshIns *user = use->user;
+        MVMuint32 code_idx;
+        switch (user->info->opcode) {
+            case MVM_OP_invoke_v:
+            case MVM_OP_sp_fastinvoke_v:
+            case MVM_OP_sp_guardsf:
+            case MVM_OP_sp_guardsfouter:
+                code_idx = 0;
+                break;
+            case MVM_OP_invoke_i:
+            case MVM_OP_invoke_n:
+            case MVM_OP_invoke_s:
+            case MVM_OP_invoke_o:
+            case MVM_OP_sp_fastinvoke_i:
+            case MVM_OP_sp_fastinvoke_n:
+            case MVM_OP_sp_fastinvoke_s:
+            case MVM_OP_sp_fastinvoke_o:
+                code_idx = 1;
+                break;
+            case MVM_OP_sp_bindlexvia_os:
+            case MVM_OP_sp_bindlexvia_in:
+                code_idx = 2;
+                break;
+            case MVM_OP_sp_getlexvia_o:
+            case MVM_OP_sp_getlexvia_ins:
+                code_idx = 3;
+                break;
+            case MVM_OP_set:
+                if (!closure_only_invoked(tc, g, user->operands[0]))
+                    return 0;
+                use = use->next;
+                continue;
+            default:
+                return 0;
+        }
+        if (user->operands[code_idx].reg.orig != reg.reg.orig
+                || user->operands[code_idx].reg.i != reg.reg.i)
+            return 0;
+        use = use->next;
+    }
+    return 1;
+}
+
+/* Turns takeclosure into sp_takeclosure_local where the closure is only ever
+ * invoked by this frame, so that taking it doesn't force the call stack on to
+ * the heap. */
+static void take_local_closures(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    MVMSpeshBB *bb = g->entry;
+    while (bb) {
+        MVMSpeshIns *ins = bb->first_ins;
+        while (ins) {
+            if (ins->info->opcode == MVM_OP_takeclosure
+                    && closure_only_invoked(tc, g, ins->operands[0]))
+                ins->info = MVM_op_get_op(MVM_OP_sp_takeclosure_local);
+            ins = ins->next;
+        }
+        bb = bb->linear_next;
+    }
+}
+
 void MVM_spesh_optimize(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshPlanned *p) {
     /* Before starting, we eliminate dead basic blocks that were tossed by
      * arg spesh, to simplify the graph. */
@@ -3456,10 +3898,24 @@ void MVM_spesh_optimize(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshPlanned
      * add new fact dependencies. Do a final dead instruction elimination pass
      * to clean up after it, and also delete dead BBs thanks to any control
      * flow opts. */
+    eliminate_common_subexpressions(tc, g);
     post_inline_pass(tc, g, g->entry);
     MVM_spesh_eliminate_dead_ins(tc, g);
     MVM_spesh_eliminate_dead_bbs(tc, g, 1);
 
+    /* Now that copies are gone and inlining is done, find closures that are
+     * only called by this frame. */
+    if (tc->instance->spesh_closures_enabled)
+        take_local_closures(tc, g);
+
+    /* Drop bounds checks on native array accesses in counted loops. */
+    MVM_spesh_range_analysis(tc, g);
+
+    /* Move computations that don't change over the iterations of a loop out
+     * of it. */
+    if (tc->instance->spesh_licm_enabled)
+        MVM_spesh_licm(tc, g);
+
 #if MVM_SPESH_CHECK_DU
     MVM_spesh_usages_check(tc, g);
 #endif
@@ -30,6 +30,7 @@ void perform_osr(MVMThreadContext *tc, MVMSpeshCandidate *specialized) {
         MVM_string_utf8_encode_C_string(tc, tc->cur_frame->static_info->body.cuuid),
         osr_index);
 #endif
+    MVM_incr(&tc->instance->stat_osr);
 
     jit_code = specialized->jitcode;
     num_locals = jit_code && jit_code->local_types ?
@@ -91,6 +92,10 @@ void perform_osr(MVMThreadContext *tc, MVMSpeshCandidate *specialized) {
     tc->cur_frame->effective_spesh_slots = specialized->spesh_slots;
     tc->cur_frame->spesh_cand            = specialized;
 
+    /* The specialization may inline frames declaring dynamic variables, and
+     * has its own lexical layout, so forget those cached. */
+    tc->num_dynvar_cache = 0;
+
     /* Move into the optimized (and maybe JIT-compiled) code. */
 
     if (jit_code && jit_code->num_deopts) {
@@ -1 +1,12 @@
 void MVM_spesh_osr_poll_for_result(MVMThreadContext *tc);
+
+/* Called at every OSR point, which is at the head of every loop, so kept
+ * cheap: we only go looking for a candidate to jump into if we're in another
+ * frame than the last time we looked or candidates got installed since. */
+MVM_STATIC_INLINE void MVM_spesh_osr_poll(MVMThreadContext *tc) {
+    MVMFrame *f = tc->cur_frame;
+    if (f->sequence_nr != tc->osr_hunt_frame_nr
+            || f->static_info->body.spesh->body.num_spesh_candidates
+                != (MVMuint32)tc->osr_hunt_num_spesh_candidates)
+        MVM_spesh_osr_poll_for_result(tc);
+}
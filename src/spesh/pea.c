@@ -22,6 +22,9 @@ static void pea_log(char *fmt, ...) {
 #define TRANSFORM_ADD_DEOPT_POINT   5
 #define TRANSFORM_ADD_DEOPT_USAGE   6
 #define TRANSFORM_PROF_ALLOCATED    7
+#define TRANSFORM_GETELEM_TO_SET    8
+#define TRANSFORM_BINDELEM_TO_SET   9
+#define TRANSFORM_ELEMS_TO_CONST    10
 typedef struct {
     /* The allocation that this transform relates to eliminating. */
     MVMSpeshPEAAllocation *allocation;
@@ -48,6 +51,7 @@ typedef struct {
         struct {
             MVMint32 deopt_point_idx;
             MVMuint16 target_reg;
+            MVMuint16 num_elems;
         } dp;
         struct {
             MVMint32 deopt_point_idx;
@@ -56,6 +60,10 @@ typedef struct {
         struct {
             MVMSpeshIns *ins;
         } prof;
+        struct {
+            MVMSpeshIns *ins;
+            MVMuint16 value;
+        } elems;
     };
 } Transformation;
 
@@ -133,35 +141,62 @@ MVMint32 flattened_type_to_register_kind(MVMThreadContext *tc, MVMSTable *st) {
     }
 }
 
+/* Checks if an allocation is of an array or hash, which has elements rather
+ * than attributes. */
+static MVMuint32 allocation_has_elems(MVMSpeshPEAAllocation *alloc) {
+    return alloc->hypothetical_elem_reg_idxs != NULL;
+}
+
 /* Gets, allocating if needed, the deopt materialization info index of a
- * particular tracked object. */
+ * particular tracked object. For arrays and hashes, it's made for the number
+ * of elements they have at the deopt point. */
 static MVMuint16 get_deopt_materialization_info(MVMThreadContext *tc, MVMSpeshGraph *g,
-                                                GraphState *gs, MVMSpeshPEAAllocation *alloc) {
-    if (alloc->has_deopt_materialization_idx) {
+                                                GraphState *gs, MVMSpeshPEAAllocation *alloc,
+                                                MVMuint16 num_elems) {
+    if (alloc->has_deopt_materialization_idx && (!allocation_has_elems(alloc) ||
+            alloc->deopt_materialization_elems == num_elems)) {
         return alloc->deopt_materialization_idx;
     }
     else {
         MVMSpeshPEAMaterializeInfo mi;
-
-        /* Build up information about registers containing attribute data. */
-        MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)alloc->type->st->REPR_data;
-        MVMuint32 num_attrs = repr_data->num_attributes;
-        MVMuint16 *attr_regs;
-        if (num_attrs > 0) {
-            MVMuint32 i;
-            attr_regs = MVM_malloc(num_attrs * sizeof(MVMuint16));
-            for (i = 0; i < num_attrs; i++)
-                attr_regs[i] = gs->attr_regs[alloc->hypothetical_attr_reg_idxs[i]];
+        MVMuint16 *attr_regs = NULL;
+        MVMuint16 *key_sslots = NULL;
+        MVMuint32 num_regs, i;
+
+        if (allocation_has_elems(alloc)) {
+            /* Build up information about registers containing elements,
+             * and the keys for a hash. */
+            num_regs = num_elems;
+            if (num_regs > 0) {
+                attr_regs = MVM_malloc(num_regs * sizeof(MVMuint16));
+                for (i = 0; i < num_regs; i++)
+                    attr_regs[i] = gs->attr_regs[alloc->hypothetical_elem_reg_idxs[i]];
+                if (alloc->elem_keys) {
+                    key_sslots = MVM_malloc(num_regs * sizeof(MVMuint16));
+                    for (i = 0; i < num_regs; i++)
+                        key_sslots[i] = MVM_spesh_add_spesh_slot_try_reuse(tc, g,
+                            (MVMCollectable *)alloc->elem_keys[i]);
+                }
+            }
         }
         else {
-            attr_regs = NULL;
+            /* Build up information about registers containing attribute data. */
+            MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)STABLE(alloc->type)->REPR_data;
+            num_regs = repr_data->num_attributes;
+            if (num_regs > 0) {
+                attr_regs = MVM_malloc(num_regs * sizeof(MVMuint16));
+                for (i = 0; i < num_regs; i++)
+                    attr_regs[i] = gs->attr_regs[alloc->hypothetical_attr_reg_idxs[i]];
+            }
         }
 
         /* Set up and add materialization info. */
-        mi.stable_sslot = MVM_spesh_add_spesh_slot_try_reuse(tc, g, (MVMCollectable *)alloc->type->st);
-        mi.num_attr_regs = num_attrs;
+        mi.stable_sslot = MVM_spesh_add_spesh_slot_try_reuse(tc, g, (MVMCollectable *)STABLE(alloc->type));
+        mi.num_attr_regs = num_regs;
         mi.attr_regs = attr_regs;
+        mi.key_sslots = key_sslots;
         alloc->deopt_materialization_idx = MVM_VECTOR_ELEMS(g->deopt_pea.materialize_info);
+        alloc->deopt_materialization_elems = num_elems;
         alloc->has_deopt_materialization_idx = 1;
         MVM_VECTOR_PUSH(g->deopt_pea.materialize_info, mi);
 
@@ -181,13 +216,21 @@ static void apply_transform(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *
     switch (t->transform) {
         case TRANSFORM_DELETE_FASTCREATE: {
             MVMSTable *st = t->fastcreate.st;
-            MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)st->REPR_data;
             MVMSpeshPEAAllocation *alloc = t->allocation;
             MVMuint32 i;
-            for (i = 0; i < repr_data->num_attributes; i++) {
-                MVMuint32 idx = alloc->hypothetical_attr_reg_idxs[i];
-                gs->attr_regs[idx] = MVM_spesh_manipulate_get_unique_reg(tc, g,
-                    flattened_type_to_register_kind(tc, repr_data->flattened_stables[i]));
+            if (allocation_has_elems(alloc)) {
+                for (i = 0; i < alloc->num_elems; i++) {
+                    MVMuint32 idx = alloc->hypothetical_elem_reg_idxs[i];
+                    gs->attr_regs[idx] = MVM_spesh_manipulate_get_unique_reg(tc, g, MVM_reg_obj);
+                }
+            }
+            else {
+                MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)st->REPR_data;
+                for (i = 0; i < repr_data->num_attributes; i++) {
+                    MVMuint32 idx = alloc->hypothetical_attr_reg_idxs[i];
+                    gs->attr_regs[idx] = MVM_spesh_manipulate_get_unique_reg(tc, g,
+                        flattened_type_to_register_kind(tc, repr_data->flattened_stables[i]));
+                }
             }
             pea_log("OPT: eliminated an allocation of %s into r%d(%d)",
                     st->debug_name, t->fastcreate.ins->operands[0].reg.orig,
@@ -223,6 +266,50 @@ static void apply_transform(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *
             MVM_spesh_graph_add_comment(tc, g, ins, "write of scalar-replaced attribute");
             break;
         }
+        case TRANSFORM_GETELEM_TO_SET: {
+            MVMSpeshIns *ins = t->attr.ins;
+            MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[1], ins);
+            MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[2], ins);
+            ins->info = MVM_op_get_op(MVM_OP_set);
+            ins->operands[1].reg.orig = gs->attr_regs[t->attr.hypothetical_reg_idx];
+            ins->operands[1].reg.i = MVM_spesh_manipulate_get_current_version(tc, g,
+                ins->operands[1].reg.orig);
+            MVM_spesh_usages_add_by_reg(tc, g, ins->operands[1], ins);
+            MVM_spesh_graph_add_comment(tc, g, ins, "read of scalar-replaced element");
+            break;
+        }
+        case TRANSFORM_BINDELEM_TO_SET: {
+            /* The same caveat about versions as for attributes applies. */
+            MVMSpeshIns *ins = t->attr.ins;
+            MVMSpeshOperand value;
+            MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[0], ins);
+            if (ins->info->opcode == MVM_OP_push_o) {
+                value = ins->operands[1];
+            }
+            else {
+                MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[1], ins);
+                value = ins->operands[2];
+            }
+            ins->info = MVM_op_get_op(MVM_OP_set);
+            ins->operands[0] = MVM_spesh_manipulate_new_version(tc, g,
+                gs->attr_regs[t->attr.hypothetical_reg_idx]);
+            ins->operands[1] = value;
+            MVM_spesh_get_facts(tc, g, ins->operands[0])->writer = ins;
+            MVM_spesh_graph_add_comment(tc, g, ins, "write of scalar-replaced element");
+            break;
+        }
+        case TRANSFORM_ELEMS_TO_CONST: {
+            MVMSpeshIns *ins = t->elems.ins;
+            MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, ins->operands[0]);
+            MVM_spesh_usages_delete_by_reg(tc, g, ins->operands[1], ins);
+            ins->info = MVM_op_get_op(MVM_OP_const_i64_16);
+            ins->operands[1].lit_i16 = t->elems.value;
+            facts->flags |= MVM_SPESH_FACT_KNOWN_VALUE;
+            facts->value.i = t->elems.value;
+            MVM_spesh_graph_add_comment(tc, g, ins, "elems of scalar-replaced %s",
+                t->allocation->elem_keys ? "hash" : "array");
+            break;
+        }
         case TRANSFORM_DELETE_SET:
             MVM_spesh_manipulate_delete_ins(tc, g, bb, t->set.ins);
             break;
@@ -236,7 +323,8 @@ static void apply_transform(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *
         case TRANSFORM_ADD_DEOPT_POINT: {
             MVMSpeshPEADeoptPoint dp;
             dp.deopt_point_idx = t->dp.deopt_point_idx;
-            dp.materialize_info_idx = get_deopt_materialization_info(tc, g, gs, t->allocation);
+            dp.materialize_info_idx = get_deopt_materialization_info(tc, g, gs, t->allocation,
+                t->dp.num_elems);
             dp.target_reg = t->dp.target_reg;
             MVM_VECTOR_PUSH(g->deopt_pea.deopt_point, dp);
             break;
@@ -273,7 +361,7 @@ static void add_tracked_register(MVMThreadContext *tc, GraphState *gs, MVMSpeshO
 /* Sees if this is something we can potentially avoid really allocating. If
  * it is, sets up the allocation tracking state that we need. */
 static MVMSpeshPEAAllocation * try_track_allocation(MVMThreadContext *tc, MVMSpeshGraph *g,
-        GraphState *gs, MVMSpeshIns *alloc_ins, MVMSTable *st) {
+        GraphState *gs, MVMSpeshBB *bb, MVMSpeshIns *alloc_ins, MVMSTable *st) {
     if (st->REPR->ID == MVM_REPR_ID_P6opaque) {
         MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)st->REPR_data;
         MVMSpeshPEAAllocation *alloc = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshPEAAllocation));
@@ -294,6 +382,23 @@ static MVMSpeshPEAAllocation * try_track_allocation(MVMThreadContext *tc, MVMSpe
         add_tracked_register(tc, gs, alloc_ins->operands[0], alloc);
         return alloc;
     }
+    else if ((st->REPR->ID == MVM_REPR_ID_VMArray && st->REPR_data &&
+                ((MVMArrayREPRData *)st->REPR_data)->slot_type == MVM_ARRAY_OBJ) ||
+            st->REPR->ID == MVM_REPR_ID_MVMHash) {
+        /* Arrays and hashes start out empty; we find out about the elements
+         * as they are added. */
+        MVMSpeshPEAAllocation *alloc = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshPEAAllocation));
+        alloc->allocator = alloc_ins;
+        alloc->allocator_bb = bb;
+        alloc->type = st->WHAT;
+        alloc->hypothetical_elem_reg_idxs = MVM_spesh_alloc(tc, g,
+                MVM_SPESH_PEA_MAX_ELEMS * sizeof(MVMuint16));
+        if (st->REPR->ID == MVM_REPR_ID_MVMHash)
+            alloc->elem_keys = MVM_spesh_alloc(tc, g,
+                    MVM_SPESH_PEA_MAX_ELEMS * sizeof(MVMString *));
+        add_tracked_register(tc, gs, alloc_ins->operands[0], alloc);
+        return alloc;
+    }
     return NULL;
 }
 
@@ -370,6 +475,65 @@ static MVMuint32 allocation_tracked(MVMSpeshPEAAllocation *alloc) {
     return alloc && !alloc->irreplaceable;
 }
 
+/* Check if an allocation with attributes, or one with elements, is being
+ * tracked. */
+static MVMuint32 attributes_tracked(MVMSpeshPEAAllocation *alloc) {
+    return allocation_tracked(alloc) && !allocation_has_elems(alloc);
+}
+static MVMuint32 elements_tracked(MVMSpeshPEAAllocation *alloc) {
+    return allocation_tracked(alloc) && allocation_has_elems(alloc);
+}
+
+/* Finds which element of a tracked array or hash an instruction accesses,
+ * returning -1 if that's not known. Arrays must be accessed by a constant
+ * index and hashes by a constant key. If adding is set, then a new element
+ * can be added at the end, though only in the block that allocated it (so
+ * the number of elements is the same at any later point in the graph). */
+static MVMint32 element_index(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs,
+        MVMSpeshPEAAllocation *alloc, MVMSpeshBB *bb, MVMSpeshIns *ins, MVMuint32 adding) {
+    MVMuint16 opcode = ins->info->opcode;
+    MVMString *key = NULL;
+    MVMint64 idx;
+    if (alloc->elem_keys) {
+        MVMSpeshFacts *key_facts;
+        MVMuint32 i;
+        if (opcode != MVM_OP_atkey_o && opcode != MVM_OP_bindkey_o)
+            return -1;
+        key_facts = MVM_spesh_get_facts(tc, g,
+                ins->operands[opcode == MVM_OP_atkey_o ? 2 : 1]);
+        if (!(key_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE) || !key_facts->value.s)
+            return -1;
+        key = key_facts->value.s;
+        for (i = 0; i < alloc->num_elems; i++)
+            if (MVM_string_equal(tc, alloc->elem_keys[i], key))
+                return i;
+        idx = alloc->num_elems;
+    }
+    else if (opcode == MVM_OP_push_o) {
+        idx = alloc->num_elems;
+    }
+    else {
+        MVMSpeshFacts *idx_facts;
+        if (opcode != MVM_OP_atpos_o && opcode != MVM_OP_bindpos_o)
+            return -1;
+        idx_facts = MVM_spesh_get_facts(tc, g,
+                ins->operands[opcode == MVM_OP_atpos_o ? 2 : 1]);
+        if (!(idx_facts->flags & MVM_SPESH_FACT_KNOWN_VALUE))
+            return -1;
+        idx = idx_facts->value.i;
+        if (idx < 0 || idx > alloc->num_elems)
+            return -1;
+    }
+    if (idx < alloc->num_elems)
+        return (MVMint32)idx;
+    if (!adding || bb != alloc->allocator_bb || alloc->num_elems == MVM_SPESH_PEA_MAX_ELEMS)
+        return -1;
+    alloc->hypothetical_elem_reg_idxs[alloc->num_elems] = gs->latest_hypothetical_reg_idx++;
+    if (key)
+        alloc->elem_keys[alloc->num_elems] = key;
+    return alloc->num_elems++;
+}
+
 /* Indicates that a real object is required; will eventually mark a point at
  * which we materialize. */
 static void real_object_required(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
@@ -392,14 +556,19 @@ static void real_object_required(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpes
 static void add_scalar_replacement_deopt_usages(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
                                                 GraphState *gs, MVMSpeshPEAAllocation *alloc,
                                                 MVMint32 deopt_idx) {
-    MVMP6opaqueREPRData *repr_data = (MVMP6opaqueREPRData *)alloc->type->st->REPR_data;
+    MVMuint32 has_elems = allocation_has_elems(alloc);
+    MVMuint32 num_regs = has_elems
+        ? alloc->num_elems
+        : ((MVMP6opaqueREPRData *)STABLE(alloc->type)->REPR_data)->num_attributes;
     MVMuint32 i;
-    for (i = 0; i < repr_data->num_attributes; i++) {
+    for (i = 0; i < num_regs; i++) {
         Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
         tran->allocation = alloc;
         tran->transform = TRANSFORM_ADD_DEOPT_USAGE;
         tran->du.deopt_point_idx = deopt_idx;
-        tran->du.hypothetical_reg_idx = alloc->hypothetical_attr_reg_idxs[i];
+        tran->du.hypothetical_reg_idx = has_elems
+            ? alloc->hypothetical_elem_reg_idxs[i]
+            : alloc->hypothetical_attr_reg_idxs[i];
         add_transform_for_bb(tc, gs, bb, tran);
     }
 }
@@ -418,6 +587,7 @@ static void add_deopt_materializations_idx(MVMThreadContext *tc, MVMSpeshGraph *
                 tran->transform = TRANSFORM_ADD_DEOPT_POINT;
                 tran->dp.deopt_point_idx = deopt_idx;
                 tran->dp.target_reg = gs->tracked_registers[i].reg.reg.orig;
+                tran->dp.num_elems = alloc->num_elems;
                 add_transform_for_bb(tc, gs, bb, tran);
                 add_scalar_replacement_deopt_usages(tc, g, bb, gs, alloc, deopt_user_idx);
             }
@@ -502,7 +672,7 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
                                 (hyp_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) &&
                                 hyp_facts->pea.depend_allocation) {
                             MVMSTable *wanted = (MVMSTable *)g->spesh_slots[ins->operands[2].lit_ui16];
-                            settify = wanted == hyp_facts->type->st;
+                            settify = wanted == STABLE(hyp_facts->type);
                             settify_dep = hyp_facts->pea.depend_allocation;
                         }
                         break;
@@ -522,7 +692,7 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
             switch (opcode) {
                 case MVM_OP_sp_fastcreate: {
                     MVMSTable *st = (MVMSTable *)g->spesh_slots[ins->operands[2].lit_i16];
-                    MVMSpeshPEAAllocation *alloc = try_track_allocation(tc, g, gs, ins, st);
+                    MVMSpeshPEAAllocation *alloc = try_track_allocation(tc, g, gs, bb, ins, st);
                     if (alloc) {
                         MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[0]);
                         Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
@@ -565,7 +735,7 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
                      * tracked object into a set. */
                     MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[0]);
                     MVMSpeshPEAAllocation *alloc = target->pea.allocation;
-                    if (allocation_tracked(alloc)) {
+                    if (attributes_tracked(alloc)) {
                         MVMint32 is_p6o_op = opcode == MVM_OP_sp_p6obind_i ||
                             opcode == MVM_OP_sp_p6obind_n ||
                             opcode == MVM_OP_sp_p6obind_s ||
@@ -588,6 +758,9 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
                             MVM_spesh_copy_facts_resolved(tc, g, tgt_facts, src_facts);
                         }
                     }
+                    else {
+                        real_object_required(tc, g, ins, ins->operands[0]);
+                    }
 
                     /* For now, no transitive EA, so for the object case,
                      * mark the object being stored as requiring the real
@@ -604,7 +777,7 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
                 case MVM_OP_sp_p6ogetvt_o: {
                     MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[1]);
                     MVMSpeshPEAAllocation *alloc = target->pea.allocation;
-                    if (allocation_tracked(alloc)) {
+                    if (attributes_tracked(alloc)) {
                         MVMuint16 hypothetical_reg = attribute_offset_to_reg(tc, alloc,
                                 ins->operands[2].lit_i16);
                         Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
@@ -625,6 +798,89 @@ static MVMuint32 analyze(MVMThreadContext *tc, MVMSpeshGraph *g, GraphState *gs)
                             }
                         }
                     }
+                    else {
+                        real_object_required(tc, g, ins, ins->operands[1]);
+                    }
+                    break;
+                }
+                case MVM_OP_push_o:
+                case MVM_OP_bindpos_o:
+                case MVM_OP_bindkey_o: {
+                    /* Schedule transform of a store of an element into a
+                     * tracked array or hash into a set. */
+                    MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[0]);
+                    MVMSpeshPEAAllocation *alloc = target->pea.allocation;
+                    MVMSpeshOperand value = ins->operands[opcode == MVM_OP_push_o ? 1 : 2];
+                    MVMint32 elem = elements_tracked(alloc)
+                        ? element_index(tc, g, gs, alloc, bb, ins, 1)
+                        : -1;
+                    if (elem >= 0) {
+                        MVMuint16 hypothetical_reg = alloc->hypothetical_elem_reg_idxs[elem];
+                        MVMSpeshFacts *tgt_facts = create_shadow_facts_h(tc, gs, hypothetical_reg);
+                        Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
+                        tran->allocation = alloc;
+                        tran->transform = TRANSFORM_BINDELEM_TO_SET;
+                        tran->attr.ins = ins;
+                        tran->attr.hypothetical_reg_idx = hypothetical_reg;
+                        add_transform_for_bb(tc, gs, bb, tran);
+                        MVM_spesh_copy_facts_resolved(tc, g, tgt_facts,
+                                MVM_spesh_get_facts(tc, g, value));
+                    }
+                    else {
+                        real_object_required(tc, g, ins, ins->operands[0]);
+                    }
+
+                    /* As with attributes, the stored object needs to be real. */
+                    real_object_required(tc, g, ins, value);
+                    break;
+                }
+                case MVM_OP_atpos_o:
+                case MVM_OP_atkey_o: {
+                    MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+                    MVMSpeshPEAAllocation *alloc = target->pea.allocation;
+                    MVMint32 elem = elements_tracked(alloc)
+                        ? element_index(tc, g, gs, alloc, bb, ins, 0)
+                        : -1;
+                    if (elem >= 0) {
+                        MVMuint16 hypothetical_reg = alloc->hypothetical_elem_reg_idxs[elem];
+                        MVMSpeshFacts *tgt_facts = create_shadow_facts_c(tc, gs, ins->operands[0]);
+                        MVMSpeshFacts *src_facts = get_shadow_facts_h(tc, gs, hypothetical_reg);
+                        Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
+                        tran->allocation = alloc;
+                        tran->transform = TRANSFORM_GETELEM_TO_SET;
+                        tran->attr.ins = ins;
+                        tran->attr.hypothetical_reg_idx = hypothetical_reg;
+                        add_transform_for_bb(tc, gs, bb, tran);
+                        if (src_facts) {
+                            MVM_spesh_copy_facts_resolved(tc, g, tgt_facts, src_facts);
+                            tgt_facts->pea.depend_allocation = alloc;
+                        }
+                    }
+                    else {
+                        real_object_required(tc, g, ins, ins->operands[1]);
+                    }
+                    break;
+                }
+                case MVM_OP_elems:
+                case MVM_OP_sp_get_i64: {
+                    /* The number of elements of a tracked array or hash is
+                     * known, and elems on a VMArray is specialized into a
+                     * read of it. */
+                    MVMSpeshFacts *target = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+                    MVMSpeshPEAAllocation *alloc = target->pea.allocation;
+                    if (elements_tracked(alloc) && (opcode == MVM_OP_elems ||
+                            (!alloc->elem_keys &&
+                             ins->operands[2].lit_i16 == offsetof(MVMArray, body.elems)))) {
+                        Transformation *tran = MVM_spesh_alloc(tc, g, sizeof(Transformation));
+                        tran->allocation = alloc;
+                        tran->transform = TRANSFORM_ELEMS_TO_CONST;
+                        tran->elems.ins = ins;
+                        tran->elems.value = alloc->num_elems;
+                        add_transform_for_bb(tc, gs, bb, tran);
+                    }
+                    else {
+                        real_object_required(tc, g, ins, ins->operands[1]);
+                    }
                     break;
                 }
                 case MVM_OP_prof_allocated: {
@@ -717,8 +973,10 @@ void MVM_spesh_pea(MVMThreadContext *tc, MVMSpeshGraph *g) {
 /* Clean up any deopt info. */
 void MVM_spesh_pea_destroy_deopt_info(MVMThreadContext *tc, MVMSpeshPEADeopt *deopt_pea) {
     MVMuint32 i;
-    for (i = 0; i < MVM_VECTOR_ELEMS(deopt_pea->materialize_info); i++)
+    for (i = 0; i < MVM_VECTOR_ELEMS(deopt_pea->materialize_info); i++) {
         MVM_free(deopt_pea->materialize_info[i].attr_regs);
+        MVM_free(deopt_pea->materialize_info[i].key_sslots);
+    }
     MVM_VECTOR_DESTROY(deopt_pea->materialize_info);
     MVM_VECTOR_DESTROY(deopt_pea->deopt_point);
 }
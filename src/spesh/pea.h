@@ -10,6 +10,15 @@ struct MVMSpeshPEAAllocation {
      * the attributes of this type. */
     MVMuint16 *hypothetical_attr_reg_idxs;
 
+    /* For arrays and hashes, the basic block of the allocation (the only one
+     * where we let elements be added), the number of elements so far, the
+     * indexes of the hypothetical registers holding them, and for hashes
+     * their keys. */
+    MVMSpeshBB *allocator_bb;
+    MVMuint16 num_elems;
+    MVMuint16 *hypothetical_elem_reg_idxs;
+    MVMString **elem_keys;
+
     /* Have we seen something that invalidates our ability to scalar replace
      * this? */
     MVMuint8 irreplaceable;
@@ -17,8 +26,15 @@ struct MVMSpeshPEAAllocation {
     /* The deopt materialization index, and whether we have allocated one yet. */
     MVMuint8 has_deopt_materialization_idx;
     MVMuint16 deopt_materialization_idx;
+
+    /* For arrays and hashes, the number of elements the materialization
+     * info was made for. */
+    MVMuint16 deopt_materialization_elems;
 };
 
+/* The most elements an array or hash may have for us to scalar replace it. */
+#define MVM_SPESH_PEA_MAX_ELEMS 8
+
 /* Information held per SSA value. */
 struct MVMSpeshPEAInfo {
     /* If this value is an allocation that is potentially being scalar
@@ -53,8 +69,12 @@ struct MVMSpeshPEAMaterializeInfo {
     MVMuint16 num_attr_regs;
 
     /* A list of the registers holding the attributes to put into the
-     * materialized object. */
+     * materialized object. For arrays and hashes, the elements. */
     MVMuint16 *attr_regs;
+
+    /* For hashes, the spesh slots holding the key of each element; NULL
+     * otherwise. */
+    MVMuint16 *key_sslots;
 };
 
 /* Information about that needs to be materialized at a particular deopt
@@ -1,18 +1,25 @@
 #include "moar.h"
 
-/* Checks if we have any existing specialization of this. */
+/* Checks if we have any existing specialization of this. Baseline candidates
+ * don't count when planning a certain specialization, since it is what is to
+ * replace them; when planning a baseline candidate, any candidate for the
+ * callsite at all does. */
 MVMint32 have_existing_specialization(MVMThreadContext *tc, MVMStaticFrame *sf,
-        MVMCallsite *cs, MVMSpeshStatsType *type_tuple) {
+        MVMSpeshPlannedKind kind, MVMCallsite *cs, MVMSpeshStatsType *type_tuple) {
     MVMStaticFrameSpesh *sfs = sf->body.spesh;
     MVMuint32 i;
     for (i = 0; i < sfs->body.num_spesh_candidates; i++) {
         if (sfs->body.spesh_candidates[i]->cs == cs) {
             /* Callsite matches. Is it a matching certain specialization? */
             MVMSpeshStatsType *cand_type_tuple = sfs->body.spesh_candidates[i]->type_tuple;
-            if (type_tuple == NULL && cand_type_tuple == NULL) {
-                /* Yes, so we're done. */
+            if (kind == MVM_SPESH_PLANNED_BASELINE) {
                 return 1;
             }
+            else if (type_tuple == NULL && cand_type_tuple == NULL) {
+                /* Yes, so we're done, unless it's only the baseline. */
+                if (!sfs->body.spesh_candidates[i]->is_baseline)
+                    return 1;
+            }
             else if (type_tuple != NULL && cand_type_tuple != NULL) {
                 /* Typed specialization, so compare the tuples. */
                 size_t tt_size = cs->flag_count * sizeof(MVMSpeshStatsType);
@@ -33,7 +40,7 @@ void add_planned(MVMThreadContext *tc, MVMSpeshPlan *plan, MVMSpeshPlannedKind k
                  MVMuint32 num_type_stats) {
     MVMSpeshPlanned *p;
     if (sf->body.bytecode_size > MVM_SPESH_MAX_BYTECODE_SIZE ||
-        have_existing_specialization(tc, sf, cs_stats->cs, type_tuple)) {
+        have_existing_specialization(tc, sf, kind, cs_stats->cs, type_tuple)) {
         /* Clean up allocated memory.
          * NB - the only caller is plan_for_cs, which means that we could do the
          * allocations in here, except that we need the type tuple for the
@@ -232,19 +239,31 @@ static void plan_for_cs(MVMThreadContext *tc, MVMSpeshPlan *plan, MVMStaticFrame
 }
 
 /* Considers the statistics of a given static frame and plans specializtions
- * to produce for it. */
+ * to produce for it. Callsites that are not yet hot enough to specialize but
+ * have been hit a few times get a baseline candidate, provided the JIT is
+ * there to compile it. */
 void plan_for_sf(MVMThreadContext *tc, MVMSpeshPlan *plan, MVMStaticFrame *sf,
         MVMuint64 *in_certain_specialization, MVMuint64 *in_observed_specialization, MVMuint64 *in_osr_specialization) {
     MVMSpeshStats *ss = sf->body.spesh->body.spesh_stats;
     MVMuint32 threshold = MVM_spesh_threshold(tc, sf);
-    if (ss->hits >= threshold || ss->osr_hits >= MVM_SPESH_PLAN_SF_MIN_OSR) {
-        /* The frame is hot enough; look through its callsites to see if any
-         * of those are. */
+    MVMint32 hot, baseline;
+
+    /* Before planning anything new, drop candidates that keep deopting. */
+    MVM_spesh_candidate_discard_deopting(tc, sf);
+
+    hot = ss->hits >= threshold || ss->osr_hits >= MVM_SPESH_PLAN_SF_MIN_OSR;
+    baseline = tc->instance->spesh_baseline_enabled && tc->instance->jit_enabled
+        && !sf->body.spesh->body.baseline_failed;
+    if (hot || baseline) {
+        /* The frame is hot enough, or we may want a baseline; look through
+         * its callsites to see if any of those are. */
         MVMuint32 i;
         for (i = 0; i < ss->num_by_callsite; i++) {
             MVMSpeshStatsByCallsite *by_cs = &(ss->by_callsite[i]);
-            if (by_cs->hits >= threshold || by_cs->osr_hits >= MVM_SPESH_PLAN_CS_MIN_OSR)
+            if (hot && (by_cs->hits >= threshold || by_cs->osr_hits >= MVM_SPESH_PLAN_CS_MIN_OSR))
                 plan_for_cs(tc, plan, sf, by_cs, in_certain_specialization, in_observed_specialization, in_osr_specialization);
+            else if (baseline && by_cs->hits + by_cs->osr_hits >= MVM_SPESH_PLAN_BASELINE_HITS)
+                add_planned(tc, plan, MVM_SPESH_PLANNED_BASELINE, sf, by_cs, NULL, NULL, 0);
         }
     }
 }
@@ -281,16 +300,22 @@ void twiddle_stack_depths(MVMThreadContext *tc, MVMSpeshPlanned *planned, MVMuin
     }
 }
 
-/* Sorts the plan in descending order of maximum call depth. */
+/* Sorts the plan in descending order of maximum call depth. Plans of the same
+ * depth are grouped by static frame, so the spesh workers can share them out
+ * with each frame going to just one of them. */
+static MVMint32 planned_before(MVMSpeshPlanned *a, MVMSpeshPlanned *b) {
+    return a->max_depth > b->max_depth ||
+        (a->max_depth == b->max_depth && (uintptr_t)a->sf < (uintptr_t)b->sf);
+}
 void sort_plan(MVMThreadContext *tc, MVMSpeshPlanned *planned, MVMuint32 n) {
     if (n >= 2) {
         MVMSpeshPlanned pivot = planned[n / 2];
         MVMuint32 i, j;
         for (i = 0, j = n - 1; ; i++, j--) {
             MVMSpeshPlanned temp;
-            while (planned[i].max_depth > pivot.max_depth)
+            while (planned_before(&planned[i], &pivot))
                 i++;
-            while (planned[j].max_depth < pivot.max_depth)
+            while (planned_before(&pivot, &planned[j]))
                 j--;
             if (i >= j)
                 break;
@@ -8,6 +8,12 @@
  * consider. */
 #define MVM_SPESH_PLAN_CS_MIN_OSR   100
 
+/* The minimum number of hits plus OSR hits a static frame and interned
+ * callsite combination that has no candidate yet needs before we produce a
+ * baseline candidate for it, which is just the unoptimized bytecode compiled
+ * by the JIT, to run until it is hot enough to be specialized properly. */
+#define MVM_SPESH_PLAN_BASELINE_HITS    10
+
 /* The percentage of hits or OSR hits that a type tuple should receive, out of
  * the total callsite hits, to receive an "observed types" specialization. */
 #define MVM_SPESH_PLAN_TT_OBS_PERCENT       25
@@ -36,7 +42,11 @@ typedef enum {
     /* A specialization based on analysis of various argument types that
      * showed up. This may happen when one argument type is predcitable, but
      * others are not. */
-    MVM_SPESH_PLANNED_DERIVED_TYPES
+    MVM_SPESH_PLANNED_DERIVED_TYPES,
+
+    /* A baseline candidate: the callsite's unoptimized bytecode, JIT
+     * compiled, to use until a certain specialization replaces it. */
+    MVM_SPESH_PLANNED_BASELINE
 } MVMSpeshPlannedKind;
 
 /* An planned specialization that should be produced. */
@@ -52,12 +62,16 @@ struct MVMSpeshPlanned {
     /* The static frame with the code to specialize. */
     MVMStaticFrame *sf;
 
+    /* Which of the spesh workers is to produce it (0 being the spesh thread
+     * itself). */
+    MVMuint32 worker;
+
     /* The callsite statistics entry that this specialization was planned as
      * a result of (by extension, we find the callsite, if any). */
     MVMSpeshStatsByCallsite *cs_stats;
 
     /* The type tuple to produce the specialization for, if this is a type
-     * based specialization. NULL for certain specializations. The memory
+     * based specialization. NULL for certain and baseline specializations. The memory
      * associated with this tuple will always have been allocated by the
      * planner, not shared with the statistics structure, even if this is a
      * specialization for an exactly observed type. */
@@ -0,0 +1,368 @@
+#include "moar.h"
+
+/* Range analysis for native array accesses in counted loops. We look for
+ * loops of the shape:
+ *
+ *     i = phi(start, next)     # in the loop header, where start >= 0
+ *     ...
+ *     c = lt_i i, n            # or an equivalent comparison
+ *     unless_i c, exit         # or the matching if_i
+ *     ...                      # i < n from here on
+ *     atpos_i v, a, i
+ *     ...
+ *     next = add_i i, step     # where step > 0
+ *
+ * where n was read from the elems of the VMArray a. Since i never goes
+ * below start and is less than the number of elements wherever the
+ * comparison dominates, the access is in range, and can be done without the
+ * bounds check and the growing logic. That needs the number of elements to
+ * not shrink between reading n and the access; we require that there are no
+ * operations that might shrink an array in the frame at all, and nothing
+ * that might invoke in the loop (nor, when n is read before the loop, on the
+ * way from there to the loop). */
+
+/* Debug logging of range analysis. */
+#define RANGE_LOG 0
+static void range_log(char *fmt, ...) {
+#if RANGE_LOG
+    va_list args;
+    fprintf(stderr, "Range: ");
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+#endif
+}
+
+/* The basic block an instruction is in. */
+typedef struct {
+    MVMSpeshIns *ins;
+    MVMSpeshBB  *bb;
+} InsLocation;
+
+typedef struct {
+    /* The immediate dominator of each basic block, indexed by its index. */
+    MVMSpeshBB **idom;
+
+    /* Scratch space for finding the blocks of a loop, indexed the same. */
+    MVMuint8 *in_loop;
+    MVMSpeshBB **worklist;
+    MVMuint32 num_idx;
+
+    /* Where each instruction is, sorted by instruction address. */
+    InsLocation *locations;
+    MVMuint32 num_locations;
+} RangeState;
+
+static int cmp_location(const void *a, const void *b) {
+    MVMSpeshIns *ia = ((InsLocation *)a)->ins;
+    MVMSpeshIns *ib = ((InsLocation *)b)->ins;
+    return ia < ib ? -1 : ia > ib ? 1 : 0;
+}
+
+static MVMSpeshBB * bb_of(RangeState *rs, MVMSpeshIns *ins) {
+    MVMint32 lo = 0, hi = (MVMint32)rs->num_locations - 1;
+    while (lo <= hi) {
+        MVMint32 mid = (lo + hi) / 2;
+        if (rs->locations[mid].ins == ins)
+            return rs->locations[mid].bb;
+        if (rs->locations[mid].ins < ins)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return NULL;
+}
+
+static MVMint32 dominates(RangeState *rs, MVMSpeshBB *a, MVMSpeshBB *b) {
+    while (b && b != a)
+        b = rs->idom[b->idx];
+    return b == a;
+}
+
+static MVMint32 is_invokish(MVMSpeshIns *ins) {
+    return ins->info->opcode != MVM_SSA_PHI
+        && (ins->info->jittivity & MVM_JIT_INFO_INVOKISH);
+}
+
+/* Operations that may make an array smaller. */
+static MVMint32 may_shrink_array(MVMSpeshIns *ins) {
+    const char *name = ins->info->name;
+    return ins->info->opcode == MVM_OP_splice || ins->info->opcode == MVM_OP_setelemspos
+        || strncmp(name, "pop_", 4) == 0 || strncmp(name, "shift_", 6) == 0;
+}
+
+/* Gets the writer of a value, if it is an integer constant. */
+static MVMint32 known_int(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand o,
+                          MVMint64 *value) {
+    MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, o);
+    if (facts->flags & MVM_SPESH_FACT_KNOWN_VALUE) {
+        *value = facts->value.i;
+        return 1;
+    }
+    return 0;
+}
+
+static MVMint32 same_value(MVMSpeshOperand a, MVMSpeshOperand b) {
+    return a.reg.orig == b.reg.orig && a.reg.i == b.reg.i;
+}
+
+/* Checks if an operand was read from the number of elements of an array. */
+static MVMint32 is_elems_of(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand n,
+                            MVMSpeshOperand arr) {
+    MVMSpeshIns *writer = MVM_spesh_get_facts(tc, g, n)->writer;
+    if (!writer)
+        return 0;
+    if (writer->info->opcode == MVM_OP_elems)
+        return same_value(writer->operands[1], arr);
+    if (writer->info->opcode == MVM_OP_sp_get_i64)
+        return same_value(writer->operands[1], arr)
+            && writer->operands[2].lit_i16 == offsetof(MVMArray, body.elems);
+    return 0;
+}
+
+/* Finds the blocks of the loop with the given header, returning 0 if it
+ * isn't the header of a loop, or the loop has something that might invoke
+ * in it. */
+static MVMint32 find_loop(RangeState *rs, MVMSpeshBB *header) {
+    MVMuint32 num_work = 0, i;
+    memset(rs->in_loop, 0, rs->num_idx);
+    rs->in_loop[header->idx] = 1;
+    for (i = 0; i < header->num_pred; i++) {
+        MVMSpeshBB *pred = header->pred[i];
+        if (dominates(rs, header, pred) && !rs->in_loop[pred->idx]) {
+            rs->in_loop[pred->idx] = 1;
+            rs->worklist[num_work++] = pred;
+        }
+    }
+    if (!num_work)
+        return 0;
+    while (num_work) {
+        MVMSpeshBB *bb = rs->worklist[--num_work];
+        for (i = 0; i < bb->num_pred; i++) {
+            if (!rs->in_loop[bb->pred[i]->idx]) {
+                rs->in_loop[bb->pred[i]->idx] = 1;
+                rs->worklist[num_work++] = bb->pred[i];
+            }
+        }
+    }
+    for (i = 0; i < rs->num_locations; i++)
+        if (rs->in_loop[rs->locations[i].bb->idx] && is_invokish(rs->locations[i].ins))
+            return 0;
+    return 1;
+}
+
+/* Checks that nothing might invoke between an instruction before a loop and
+ * the loop header, going back along a chain of single-predecessor blocks. */
+static MVMint32 clear_since(RangeState *rs, MVMSpeshBB *header, MVMSpeshIns *from) {
+    MVMSpeshBB *cur_bb = NULL;
+    MVMSpeshIns *check;
+    MVMuint16 i;
+    for (i = 0; i < header->num_pred; i++) {
+        if (!rs->in_loop[header->pred[i]->idx]) {
+            if (cur_bb)
+                return 0;
+            cur_bb = header->pred[i];
+        }
+    }
+    if (!cur_bb)
+        return 0;
+    check = cur_bb->last_ins;
+    while (1) {
+        while (check) {
+            if (check == from)
+                return 1;
+            if (is_invokish(check))
+                return 0;
+            check = check->prev;
+        }
+        if (cur_bb->num_pred != 1)
+            return 0;
+        cur_bb = cur_bb->pred[0];
+        check = cur_bb->last_ins;
+    }
+}
+
+/* Looks for a comparison showing i < n that dominates the given block,
+ * returning n if there is one. */
+static MVMint32 find_bound(MVMThreadContext *tc, MVMSpeshGraph *g, RangeState *rs,
+                           MVMSpeshBB *header, MVMSpeshBB *bb, MVMSpeshOperand i,
+                           MVMSpeshOperand *n) {
+    for (; bb && bb != header; bb = rs->idom[bb->idx]) {
+        MVMSpeshBB *pred;
+        MVMSpeshIns *branch, *cmp;
+        MVMint32 taken_when_true, safe_is_target, i_first;
+        if (bb->num_pred != 1)
+            continue;
+        pred = bb->pred[0];
+        branch = pred->last_ins;
+        if (!branch || (branch->info->opcode != MVM_OP_if_i && branch->info->opcode != MVM_OP_unless_i))
+            continue;
+        cmp = MVM_spesh_get_facts(tc, g, branch->operands[0])->writer;
+        if (!cmp)
+            continue;
+
+        /* Work out whether the comparison being true means i < n. */
+        switch (cmp->info->opcode) {
+            case MVM_OP_lt_i: i_first = 1; taken_when_true = 1; break;
+            case MVM_OP_gt_i: i_first = 0; taken_when_true = 1; break;
+            case MVM_OP_ge_i: i_first = 1; taken_when_true = 0; break;
+            case MVM_OP_le_i: i_first = 0; taken_when_true = 0; break;
+            default: continue;
+        }
+        if (!same_value(cmp->operands[i_first ? 1 : 2], i))
+            continue;
+
+        /* The block is safe if it's reached when i < n holds. */
+        safe_is_target = branch->info->opcode == MVM_OP_if_i ? taken_when_true : !taken_when_true;
+        if ((branch->operands[1].ins_bb == bb) != safe_is_target)
+            continue;
+        if (pred->num_succ == 2 && pred->succ[0] == pred->succ[1])
+            continue;
+        *n = cmp->operands[i_first ? 2 : 1];
+        return 1;
+    }
+    return 0;
+}
+
+/* Tries to prove the index of an array access is in range. */
+static MVMint32 in_range(MVMThreadContext *tc, MVMSpeshGraph *g, RangeState *rs,
+                         MVMSpeshBB *bb, MVMSpeshOperand arr, MVMSpeshOperand idx) {
+    MVMSpeshIns *phi = MVM_spesh_get_facts(tc, g, idx)->writer;
+    MVMSpeshBB *header;
+    MVMSpeshIns *n_writer;
+    MVMSpeshOperand n;
+    MVMint32 have_start = 0, have_step = 0;
+    MVMuint16 k;
+
+    /* The index must be an induction variable of a loop. */
+    if (!phi || phi->info->opcode != MVM_SSA_PHI || phi->info->num_operands != 3)
+        return 0;
+    header = bb_of(rs, phi);
+    if (!header || !dominates(rs, header, bb) || !find_loop(rs, header) || !rs->in_loop[bb->idx])
+        return 0;
+
+    /* Find the bound, which must be the number of elements of the array. */
+    if (!find_bound(tc, g, rs, header, bb, idx, &n) || !is_elems_of(tc, g, n, arr))
+        return 0;
+    n_writer = MVM_spesh_get_facts(tc, g, n)->writer;
+    if (!rs->in_loop[bb_of(rs, n_writer)->idx] && !clear_since(rs, header, n_writer))
+        return 0;
+
+    /* One input to the phi must be a non-negative start, and the other an
+     * increment of the phi by a positive step, done where it's in range so
+     * it can't overflow. */
+    for (k = 1; k < 3; k++) {
+        MVMSpeshIns *writer = MVM_spesh_get_facts(tc, g, phi->operands[k])->writer;
+        MVMint64 value;
+        if (writer && writer->info->opcode == MVM_OP_add_i
+                && rs->in_loop[bb_of(rs, writer)->idx]) {
+            MVMSpeshOperand other;
+            MVMSpeshOperand bound;
+            if (same_value(writer->operands[1], idx))
+                other = writer->operands[2];
+            else if (same_value(writer->operands[2], idx))
+                other = writer->operands[1];
+            else
+                return 0;
+            if (!known_int(tc, g, other, &value) || value <= 0 || value > 0x7FFFFFFF)
+                return 0;
+            if (!find_bound(tc, g, rs, header, bb_of(rs, writer), idx, &bound)
+                    || !same_value(bound, n))
+                return 0;
+            have_step = 1;
+        }
+        else if (known_int(tc, g, phi->operands[k], &value) && value >= 0) {
+            have_start = 1;
+        }
+        else {
+            return 0;
+        }
+    }
+    return have_start && have_step;
+}
+
+/* Checks if an array operand is known to be a concrete VMArray with 64-bit
+ * integer slots. */
+static MVMint32 is_i64_array(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand o) {
+    MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, o);
+    MVMSTable *st;
+    if (!(facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) || !(facts->flags & MVM_SPESH_FACT_CONCRETE))
+        return 0;
+    st = STABLE(facts->type);
+    return st->REPR->ID == MVM_REPR_ID_VMArray && st->REPR_data
+        && ((MVMArrayREPRData *)st->REPR_data)->slot_type == MVM_ARRAY_I64;
+}
+
+void MVM_spesh_range_analysis(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    RangeState rs;
+    MVMSpeshBB *bb;
+    MVMuint32 i, have_access = 0;
+
+    /* Find where every instruction is, and see if there's anything to do. */
+    rs.num_idx = 0;
+    rs.num_locations = 0;
+    for (bb = g->entry; bb; bb = bb->linear_next) {
+        MVMSpeshIns *ins;
+        if ((MVMuint32)bb->idx >= rs.num_idx)
+            rs.num_idx = bb->idx + 1;
+        for (ins = bb->first_ins; ins; ins = ins->next) {
+            if (may_shrink_array(ins))
+                return;
+            if (ins->info->opcode == MVM_OP_atpos_i || ins->info->opcode == MVM_OP_bindpos_i)
+                have_access = 1;
+            rs.num_locations++;
+        }
+    }
+    if (!have_access)
+        return;
+    rs.locations = MVM_malloc(rs.num_locations * sizeof(InsLocation));
+    rs.num_locations = 0;
+    for (bb = g->entry; bb; bb = bb->linear_next) {
+        MVMSpeshIns *ins;
+        for (ins = bb->first_ins; ins; ins = ins->next) {
+            rs.locations[rs.num_locations].ins = ins;
+            rs.locations[rs.num_locations].bb = bb;
+            rs.num_locations++;
+        }
+    }
+    qsort(rs.locations, rs.num_locations, sizeof(InsLocation), cmp_location);
+
+    /* Work out the immediate dominators. */
+    MVM_spesh_graph_recompute_dominance(tc, g);
+    rs.idom = MVM_calloc(rs.num_idx, sizeof(MVMSpeshBB *));
+    rs.in_loop = MVM_malloc(rs.num_idx);
+    rs.worklist = MVM_malloc(rs.num_idx * sizeof(MVMSpeshBB *));
+    for (bb = g->entry; bb; bb = bb->linear_next) {
+        MVMuint16 j;
+        for (j = 0; j < bb->num_children; j++)
+            rs.idom[bb->children[j]->idx] = bb;
+    }
+
+    /* Look at each access. */
+    for (i = 0; i < rs.num_locations; i++) {
+        MVMSpeshIns *ins = rs.locations[i].ins;
+        MVMSpeshBB *ins_bb = rs.locations[i].bb;
+        if (ins->info->opcode == MVM_OP_atpos_i) {
+            if (is_i64_array(tc, g, ins->operands[1])
+                    && in_range(tc, g, &rs, ins_bb, ins->operands[1], ins->operands[2])) {
+                ins->info = MVM_op_get_op(MVM_OP_sp_atpos_i64_nc);
+                MVM_spesh_graph_add_comment(tc, g, ins, "index proven in range");
+                range_log("unchecked atpos_i in BB %d", ins_bb->idx);
+            }
+        }
+        else if (ins->info->opcode == MVM_OP_bindpos_i) {
+            if (is_i64_array(tc, g, ins->operands[0])
+                    && in_range(tc, g, &rs, ins_bb, ins->operands[0], ins->operands[1])) {
+                ins->info = MVM_op_get_op(MVM_OP_sp_bindpos_i64_nc);
+                MVM_spesh_graph_add_comment(tc, g, ins, "index proven in range");
+                range_log("unchecked bindpos_i in BB %d", ins_bb->idx);
+            }
+        }
+    }
+
+    MVM_free(rs.locations);
+    MVM_free(rs.idom);
+    MVM_free(rs.in_loop);
+    MVM_free(rs.worklist);
+}
@@ -0,0 +1 @@
+void MVM_spesh_range_analysis(MVMThreadContext *tc, MVMSpeshGraph *g);
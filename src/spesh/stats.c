@@ -3,8 +3,10 @@
 /* Gets the statistics for a static frame, creating them if needed. */
 MVMSpeshStats * stats_for(MVMThreadContext *tc, MVMStaticFrame *sf) {
     MVMStaticFrameSpesh *spesh = sf->body.spesh;
-    if (!spesh->body.spesh_stats)
+    if (!spesh->body.spesh_stats) {
         spesh->body.spesh_stats = MVM_calloc(1, sizeof(MVMSpeshStats));
+        spesh->body.spesh_stats->first_update = tc->instance->spesh_stats_version;
+    }
     return spesh->body.spesh_stats;
 }
 
@@ -37,7 +39,7 @@ MVMint32 incomplete_type_tuple(MVMThreadContext *tc, MVMCallsite *cs,
             MVMObject *type = arg_types[i].type;
             if (!type)
                 return 1;
-            if (arg_types[i].type_concrete && type->st->container_spec)
+            if (arg_types[i].type_concrete && STABLE(type)->container_spec)
                 if (!arg_types[i].decont_type && REPR(type)->ID != MVM_REPR_ID_NativeRef)
                     return 1;
         }
@@ -25,6 +25,10 @@ struct MVMSpeshStats {
      * help decide when to throw out data that is no longer evolving, to
      * reduce memory use. */
     MVMuint32 last_update;
+
+    /* The version of the statistics when these were created; together with
+     * the hits, this tells us how frequently the frame is called. */
+    MVMuint32 first_update;
 };
 
 /* Statistics by callsite. */
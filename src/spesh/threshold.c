@@ -1,15 +1,49 @@
 #include "moar.h"
 
 /* Choose the threshold for a given static frame before we start applying
- * specialization to it. */
+ * specialization to it. The starting point depends on the bytecode size,
+ * since bigger frames cost more to specialize, and is then adjusted for how
+ * frequently the frame is being called: the calls per version of the spesh
+ * statistics since we started gathering them for it. Calls that run long
+ * enough to rack up OSR hits count towards that too. Frames called often are
+ * specialized sooner, large ones most of all, as they have most to gain;
+ * those only called now and then have to wait longer, so they don't take up
+ * the specializer's time. While logs back up in the spesh queue, all of the
+ * thresholds go up. */
 MVMuint32 MVM_spesh_threshold(MVMThreadContext *tc, MVMStaticFrame *sf) {
     MVMuint32 bs = sf->body.bytecode_size;
+    MVMuint32 threshold;
+    MVMuint32 backlog;
+    MVMSpeshStats *ss;
     if (tc->instance->spesh_nodelay)
         return 1;
     if (bs <= 2048)
-        return 150;
+        threshold = 150;
     else if (bs <= 8192)
-        return 200;
+        threshold = 200;
     else
-        return 300;
+        threshold = 300;
+
+    ss = sf->body.spesh ? sf->body.spesh->body.spesh_stats : NULL;
+    if (ss) {
+        MVMuint32 age = tc->instance->spesh_stats_version - ss->first_update + 1;
+        MVMuint32 calls = ss->hits + ss->osr_hits;
+        if (calls / age >= MVM_SPESH_THRESHOLD_HOT_RATE) {
+            /* Hot; large frames come down to the small frame threshold, and
+             * in server mode everything comes down further. */
+            if (threshold > 150)
+                threshold = 150;
+            if (tc->instance->spesh_server)
+                threshold = threshold * 2 / 3;
+        }
+        else if (age >= MVM_SPESH_THRESHOLD_MIN_AGE && calls < age) {
+            /* Cold; fewer than one call per version. */
+            threshold *= tc->instance->spesh_server ? 4 : 2;
+        }
+    }
+
+    backlog = tc->instance->spesh_backlog;
+    if (backlog > MVM_SPESH_THRESHOLD_MAX_BACKLOG)
+        backlog = MVM_SPESH_THRESHOLD_MAX_BACKLOG;
+    return threshold + threshold * backlog / 4;
 }
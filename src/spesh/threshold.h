@@ -1,4 +1,14 @@
 /* The maximum size of bytecode we'll ever attempt to optimize. */
 #define MVM_SPESH_MAX_BYTECODE_SIZE 65536
 
+/* The calls per statistics version at which a frame counts as hot, and the
+ * number of versions for which we must have seen a frame before deciding it
+ * is cold. */
+#define MVM_SPESH_THRESHOLD_HOT_RATE 32
+#define MVM_SPESH_THRESHOLD_MIN_AGE  4
+
+/* The most waiting logs that push the thresholds up; each one adds a quarter
+ * of the threshold. */
+#define MVM_SPESH_THRESHOLD_MAX_BACKLOG 8
+
 MVMuint32 MVM_spesh_threshold(MVMThreadContext *tc, MVMStaticFrame *sf);
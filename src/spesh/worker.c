@@ -4,6 +4,134 @@
  * calls and types that showed up at runtime. It uses this to produce
  * specialized versions of code. */
 
+/* Decides which spesh worker will produce each specialization in a plan. The
+ * plan is sorted deepest first, and each run of entries of the same depth is
+ * a wave that the workers share, handing out the static frames in turn. Each
+ * static frame has a single worker per wave, so no two of them are ever
+ * installing candidates for it at once. This must be done before anything
+ * can trigger GC, since the entries are grouped by static frame address. */
+static void assign_workers(MVMThreadContext *tc, MVMSpeshPlan *plan) {
+    MVMuint32 num_workers = tc->instance->num_spesh_helpers + 1;
+    MVMuint32 worker = 0;
+    MVMuint32 i;
+    for (i = 0; i < plan->num_planned; i++) {
+        MVMSpeshPlanned *p = &(plan->planned[i]);
+        if (i == 0 || p->max_depth != p[-1].max_depth)
+            worker = 0;
+        else if (p->sf != p[-1].sf)
+            worker = (worker + 1) % num_workers;
+        p->worker = worker;
+    }
+}
+
+/* Produces the specializations in part of a plan that are for a particular
+ * worker. */
+static void produce(MVMThreadContext *tc, MVMSpeshPlan *plan, MVMuint32 start,
+        MVMuint32 end, MVMuint32 worker) {
+    MVMuint32 i;
+    for (i = start; i < end; i++) {
+        if (plan->planned[i].worker == worker) {
+            MVM_spesh_candidate_add(tc, &(plan->planned[i]));
+            GC_SYNC_POINT(tc);
+        }
+    }
+}
+
+/* Enters the work loop of a helper, which waits for the spesh thread to hand
+ * it a wave of the current plan, and produces its share of it. */
+static void helper(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    MVMInstance *instance = tc->instance;
+    MVMuint32 worker = (MVMuint32)MVM_incr(&(instance->spesh_helpers_started)) + 1;
+    MVMuint64 seen_round = 0;
+
+#ifdef MVM_HAS_PTHREAD_SETNAME_NP
+    pthread_setname_np(pthread_self(), "spesh helper");
+#endif
+
+    while (1) {
+        MVMuint32 start, end;
+        MVM_gc_mark_thread_blocked(tc);
+        uv_mutex_lock(&(instance->mutex_spesh_helpers));
+        while (instance->spesh_helpers_round == seen_round && !instance->spesh_helpers_stop)
+            uv_cond_wait(&(instance->cond_spesh_helpers_work), &(instance->mutex_spesh_helpers));
+        seen_round = instance->spesh_helpers_round;
+        start = instance->spesh_wave_start;
+        end = instance->spesh_wave_end;
+        uv_mutex_unlock(&(instance->mutex_spesh_helpers));
+        MVM_gc_mark_thread_unblocked(tc);
+        if (instance->spesh_helpers_stop)
+            break;
+
+        produce(tc, instance->spesh_plan, start, end, worker);
+
+        uv_mutex_lock(&(instance->mutex_spesh_helpers));
+        if (--instance->spesh_helpers_busy == 0)
+            uv_cond_signal(&(instance->cond_spesh_helpers_done));
+        uv_mutex_unlock(&(instance->mutex_spesh_helpers));
+    }
+}
+
+/* Implements a plan. With helpers, each wave is shared out between them and
+ * the spesh thread, and must be finished before the next, shallower, wave is
+ * started, so callees are in place ahead of callers that might inline them.
+ * Waves with just the one static frame aren't worth handing out. While
+ * specializations are logged or limited, they are all produced in order by
+ * the spesh thread, so the results are easy to follow. */
+static void implement_plan(MVMThreadContext *tc, MVMSpeshPlan *plan) {
+    MVMInstance *instance = tc->instance;
+    MVMuint32 n = plan->num_planned;
+    MVMuint32 i = 0;
+    if (!instance->num_spesh_helpers || MVM_spesh_debug_enabled(tc) || instance->spesh_limit) {
+        for (i = 0; i < n; i++) {
+            MVM_spesh_candidate_add(tc, &(plan->planned[i]));
+            GC_SYNC_POINT(tc);
+        }
+        return;
+    }
+    while (i < n) {
+        MVMuint32 end = i + 1;
+        MVMuint32 shared = 0;
+        while (end < n && plan->planned[end].max_depth == plan->planned[i].max_depth) {
+            if (plan->planned[end].worker)
+                shared = 1;
+            end++;
+        }
+        if (shared) {
+            uv_mutex_lock(&(instance->mutex_spesh_helpers));
+            instance->spesh_wave_start = i;
+            instance->spesh_wave_end = end;
+            instance->spesh_helpers_busy = instance->num_spesh_helpers;
+            instance->spesh_helpers_round++;
+            uv_cond_broadcast(&(instance->cond_spesh_helpers_work));
+            uv_mutex_unlock(&(instance->mutex_spesh_helpers));
+
+            produce(tc, plan, i, end, 0);
+
+            MVM_gc_mark_thread_blocked(tc);
+            uv_mutex_lock(&(instance->mutex_spesh_helpers));
+            while (instance->spesh_helpers_busy)
+                uv_cond_wait(&(instance->cond_spesh_helpers_done), &(instance->mutex_spesh_helpers));
+            uv_mutex_unlock(&(instance->mutex_spesh_helpers));
+            MVM_gc_mark_thread_unblocked(tc);
+        }
+        else {
+            produce(tc, plan, i, end, 0);
+        }
+        i = end;
+    }
+}
+
+/* Tells the helpers to finish up. */
+static void stop_helpers(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    if (instance->spesh_helpers) {
+        uv_mutex_lock(&(instance->mutex_spesh_helpers));
+        instance->spesh_helpers_stop = 1;
+        uv_cond_broadcast(&(instance->cond_spesh_helpers_work));
+        uv_mutex_unlock(&(instance->mutex_spesh_helpers));
+    }
+}
+
 /* Enters the work loop. */
 static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
     MVMuint64 work_sequence_number = 0;
@@ -34,6 +162,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
 
             start_time = uv_hrtime();
             log_obj = MVM_repr_shift_o(tc, tc->instance->spesh_queue);
+            tc->instance->spesh_backlog = (MVMuint32)MVM_repr_elems(tc, tc->instance->spesh_queue);
             if (MVM_spesh_debug_enabled(tc)) {
                 MVM_spesh_debug_printf(tc,
                     "Received Logs\n"
@@ -52,7 +181,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                     });
                     MVM_gc_root_temp_push(tc, (MVMCollectable **)&overview_subscription_packet);
 
-                    MVM_repr_pos_set_elems(tc, overview_subscription_packet, 15);
+                    MVM_repr_pos_set_elems(tc, overview_subscription_packet, 16);
 
                     overview_data = ((MVMArray *)overview_subscription_packet)->body.slots.i64;
 
@@ -73,7 +202,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
             uv_mutex_unlock(&(tc->instance->mutex_spesh_sync));
 
             tc->instance->spesh_stats_version++;
-            if (log_obj->st->REPR->ID == MVM_REPR_ID_MVMSpeshLog) {
+            if (STABLE(log_obj)->REPR->ID == MVM_REPR_ID_MVMSpeshLog) {
                 MVMSpeshLog *sl = (MVMSpeshLog *)log_obj;
                 MVM_telemetry_interval_annotate((uintptr_t)sl->body.thread->body.tc, interval_id, "from this thread");
                 if (overview_data) {
@@ -119,6 +248,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                     /* Form a specialization plan. */
                     start_time = uv_hrtime();
                     tc->instance->spesh_plan = MVM_spesh_plan(tc, updated_static_frames, &certain_spesh, &observed_spesh, &osr_spesh);
+                    assign_workers(tc, tc->instance->spesh_plan);
                     if (MVM_spesh_debug_enabled(tc)) {
                         n = tc->instance->spesh_plan->num_planned;
                         MVM_spesh_debug_printf(tc,
@@ -148,11 +278,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                     start_time = uv_hrtime();
 
                     /* Implement the plan and then discard it. */
-                    n = tc->instance->spesh_plan->num_planned;
-                    for (i = 0; i < n; i++) {
-                        MVM_spesh_candidate_add(tc, &(tc->instance->spesh_plan->planned[i]));
-                        GC_SYNC_POINT(tc);
-                    }
+                    implement_plan(tc, tc->instance->spesh_plan);
                     MVM_spesh_plan_destroy(tc, tc->instance->spesh_plan);
                     tc->instance->spesh_plan = NULL;
 
@@ -206,8 +332,24 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                 });
 
             }
+            else if (STABLE(log_obj)->REPR->ID == MVM_REPR_ID_MVMStaticFrame) {
+                /* A frame with specializations remembered in the caches was
+                 * just invoked for the first time; install any code kept for
+                 * it, then produce any others now. */
+                MVMROOT(tc, log_obj, {
+                    MVMSpeshPlan *plan;
+                    MVM_spesh_code_cache_install(tc, (MVMStaticFrame *)log_obj);
+                    plan = MVM_spesh_cache_plan(tc, (MVMStaticFrame *)log_obj);
+                    assign_workers(tc, plan);
+                    implement_plan(tc, plan);
+                    MVM_spesh_plan_destroy(tc, plan);
+                    tc->instance->spesh_plan = NULL;
+                });
+            }
             else if (MVM_is_null(tc, log_obj)) {
-                /* This is a stop signal, so quit processing */
+                /* This is a stop signal, so quit processing, and have any
+                 * helpers do likewise */
+                stop_helpers(tc);
                 break;
             } else {
                 MVM_panic(1, "Unexpected object sent to specialization worker");
@@ -219,6 +361,7 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                 MVMObject *queue = tc->instance->subscriptions.subscription_queue;
 
                 overview_data[14] = (uv_hrtime() - start_time) / 1000;
+                overview_data[15] = MVM_load(&tc->instance->jit_code_bytes);
 
                 overview_data = NULL;
 
@@ -259,6 +402,27 @@ void MVM_spesh_worker_start(MVMThreadContext *tc) {
 
         tc->instance->spesh_thread = MVM_thread_new(tc, worker_entry_point, 1);
         MVM_thread_run(tc, tc->instance->spesh_thread);
+
+        /* Start any helpers too. */
+        if (tc->instance->num_spesh_helpers) {
+            MVMuint32 i;
+            if (!tc->instance->spesh_helpers)
+                tc->instance->spesh_helpers = MVM_calloc(tc->instance->num_spesh_helpers,
+                    sizeof(MVMObject *));
+            /* A restart after a fork must not leave the helpers thinking a
+             * round from before it is waiting for them. */
+            tc->instance->spesh_helpers_started = 0;
+            tc->instance->spesh_helpers_stop = 0;
+            tc->instance->spesh_helpers_round = 0;
+            tc->instance->spesh_helpers_busy = 0;
+            for (i = 0; i < tc->instance->num_spesh_helpers; i++) {
+                MVMObject *helper_entry_point = MVM_repr_alloc_init(tc,
+                    tc->instance->boot_types.BOOTCCode);
+                ((MVMCFunction *)helper_entry_point)->body.func = helper;
+                tc->instance->spesh_helpers[i] = MVM_thread_new(tc, helper_entry_point, 1);
+                MVM_thread_run(tc, tc->instance->spesh_helpers[i]);
+            }
+        }
     }
 }
 
@@ -275,5 +439,12 @@ void MVM_spesh_worker_join(MVMThreadContext *tc) {
         assert(tc->instance->spesh_thread != NULL);
         MVM_thread_join(tc, tc->instance->spesh_thread);
         tc->instance->spesh_thread = NULL;
+        if (tc->instance->spesh_helpers) {
+            MVMuint32 i;
+            for (i = 0; i < tc->instance->num_spesh_helpers; i++) {
+                MVM_thread_join(tc, tc->instance->spesh_helpers[i]);
+                tc->instance->spesh_helpers[i] = NULL;
+            }
+        }
     }
 }
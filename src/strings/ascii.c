@@ -26,6 +26,7 @@ MVMString * MVM_string_ascii_decode(MVMThreadContext *tc, const MVMObject *resul
     result->body.storage.blob_32 = buffer;
     result->body.storage_type = MVM_STRING_GRAPHEME_32;
     result->body.num_graphs = result_graphs;
+    MVM_string_narrow_to_8bit(tc, result);
 
     return result;
 }
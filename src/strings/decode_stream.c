@@ -273,6 +273,7 @@ static MVMString * take_chars(MVMThreadContext *tc, MVMDecodeStream *ds, MVMint3
             }
         }
     }
+    MVM_string_narrow_to_8bit(tc, result);
     return result;
 }
 MVMString * MVM_string_decodestream_get_chars(MVMThreadContext *tc, MVMDecodeStream *ds,
@@ -336,6 +337,12 @@ static MVMint32 find_separator(MVMThreadContext *tc, const MVMDecodeStream *ds,
     MVMint32 sep_loc = 0;
     MVMDecodeStreamChars *cur_chars = ds->chars_head;
 
+    /* No char above the greatest first grapheme of any separator can start
+     * one, and of the ASCII chars only those in the mask can, which lets us
+     * pass over most chars with a comparison or two. */
+    MVMGrapheme32 max_first_grapheme = sep_spec->max_first_grapheme;
+    const MVMuint64 *ascii_first_mask = sep_spec->ascii_first_mask;
+
     /* First, skip over any buffers we need not consider. */
     MVMint32 max_sep_length = sep_spec->max_sep_length;
     while (cur_chars && cur_chars->next) {
@@ -371,6 +378,11 @@ static MVMint32 find_separator(MVMThreadContext *tc, const MVMDecodeStream *ds,
             MVMint32 sep_graph_pos = 0;
             MVMGrapheme32 cur_char = cur_chars->chars[i];
             sep_loc++;
+            if (cur_char > max_first_grapheme)
+                continue;
+            if (cur_char >= 0 && cur_char < 128
+                    && !(ascii_first_mask[cur_char >> 6] & ((MVMuint64)1 << (cur_char & 63))))
+                continue;
             for (j = 0; j < sep_spec->num_seps; j++) {
                 if (sep_spec->sep_graphemes[sep_graph_pos] == cur_char) {
                     if (sep_spec->sep_lengths[j] == 1) {
@@ -390,9 +402,92 @@ static MVMint32 find_separator(MVMThreadContext *tc, const MVMDecodeStream *ds,
     }
     return 0;
 }
+
+/* For encodings that decode ASCII bytes to the same codepoints, a line made
+ * of ASCII besides \r decodes to exactly its bytes, ending with a separator
+ * that is a lone control char: such a char never combines with what follows,
+ * and nothing before it can combine with it. The same goes for a line ending
+ * in \r\n, which decodes to a single grapheme, provided that is chomped.
+ * When there is nothing yet decoded or waiting in the normalizer, and such a
+ * line is in the head byte buffer, we can carve it out of there directly,
+ * skipping the decoder and the 32-bit char buffers. Returns NULL if we
+ * can't. */
+#define LINE_SCAN_BLOCK 64
+static MVMString * take_ascii_line(MVMThreadContext *tc, MVMDecodeStream *ds,
+                                   MVMDecodeStreamSeparators *sep_spec, MVMint32 chomp) {
+    MVMDecodeStreamBytes *cur_bytes = ds->bytes_head;
+    MVMuint8             *bytes;
+    MVMint32              start, pos, end, sep_bytes, i;
+    MVMString            *result;
+
+    if (!cur_bytes || ds->chars_head || !sep_spec->only_control_seps
+            || !MVM_unicode_normalizer_empty(tc, &(ds->norm)))
+        return NULL;
+    if (ds->encoding != MVM_encoding_type_utf8 && ds->encoding != MVM_encoding_type_ascii
+            && ds->encoding != MVM_encoding_type_latin1)
+        return NULL;
+
+    /* Scan for the first byte that isn't printable ASCII, a block at a time,
+     * then see if it's a separator, a control char we can take as it is, or
+     * something we need the decoder for. */
+    bytes = cur_bytes->bytes;
+    start = pos = ds->bytes_head_pos;
+    end   = cur_bytes->length;
+    while (1) {
+        MVMint32 special = 0;
+        MVMuint8 b;
+        if (pos + LINE_SCAN_BLOCK <= end) {
+            MVM_VECTORIZE_LOOP
+            for (i = pos; i < pos + LINE_SCAN_BLOCK; i++)
+                special |= (MVMuint8)(bytes[i] - 0x20) >= 0x60;
+            if (!special) {
+                pos += LINE_SCAN_BLOCK;
+                continue;
+            }
+        }
+        while (pos < end && (MVMuint8)(bytes[pos] - 0x20) < 0x60)
+            pos++;
+        if (pos == end)
+            return NULL;
+        b = bytes[pos];
+        if (b < 0x20 && (sep_spec->control_sep_mask & ((MVMuint32)1 << b))) {
+            sep_bytes = 1;
+            break;
+        }
+        if (b == '\r') {
+            if (!sep_spec->crlf_is_sep || !chomp || pos + 1 == end || bytes[pos + 1] != '\n')
+                return NULL;
+            sep_bytes = 2;
+            break;
+        }
+        if (b >= 0x80)
+            return NULL;
+        pos++;
+    }
+    pos += sep_bytes;
+
+    /* Got a line; make a string of it and move past it. */
+    result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
+    result->body.num_graphs     = pos - start - (chomp ? sep_bytes : 0);
+    result->body.storage_type   = MVM_STRING_GRAPHEME_8;
+    result->body.storage.blob_8 = MVM_malloc(result->body.num_graphs ? result->body.num_graphs : 1);
+    memcpy(result->body.storage.blob_8, bytes + start, result->body.num_graphs);
+    result->body.flags          = MVM_STRING_FLAGS_COMPUTED | MVM_STRING_FLAG_ALL_ASCII
+                                | MVM_STRING_FLAG_NO_SYNTHETICS;
+    if (pos - start > 32)
+        ds->result_size_guess = ((pos - start) << 1) & ~0xF;
+    MVM_string_decodestream_discard_to(tc, ds, cur_bytes, pos);
+    return result;
+}
+
 MVMString * MVM_string_decodestream_get_until_sep(MVMThreadContext *tc, MVMDecodeStream *ds,
                                                   MVMDecodeStreamSeparators *sep_spec, MVMint32 chomp) {
     MVMint32 sep_loc, sep_length;
+    MVMString *line;
+
+    /* Try to take the line straight out of the byte buffer. */
+    if ((line = take_ascii_line(tc, ds, sep_spec, chomp)))
+        return line;
 
     /* Look for separator, trying more decoding if it fails. We get the place
      * just beyond the separator, so can use take_chars to get what's need.
@@ -503,6 +598,7 @@ static MVMString * get_all_in_buffer(MVMThreadContext *tc, MVMDecodeStream *ds)
         ds->chars_head = ds->chars_tail = NULL;
     }
 
+    MVM_string_narrow_to_8bit(tc, result);
     return result;
 }
 
@@ -630,6 +726,7 @@ static void cache_sep_info(MVMThreadContext *tc, MVMDecodeStreamSeparators *sep_
     MVMint32 max_final_grapheme = -1;
     MVMint32 max_sep_length = 1;
     MVMint32 cur_sep_pos = 0;
+    MVMGrapheme32 crlf;
     MVMint32 i;
     for (i = 0; i < sep_spec->num_seps; i++) {
         MVMint32 length = sep_spec->sep_lengths[i];
@@ -643,6 +740,34 @@ static void cache_sep_info(MVMThreadContext *tc, MVMDecodeStreamSeparators *sep_
     sep_spec->max_sep_length = max_sep_length;
     sep_spec->final_graphemes = final_graphemes;
     sep_spec->max_final_grapheme = max_final_grapheme;
+
+    /* Work out what can start a separator, and whether they're all control
+     * chars or \r\n. */
+    sep_spec->max_first_grapheme = -1;
+    sep_spec->ascii_first_mask[0] = sep_spec->ascii_first_mask[1] = 0;
+    sep_spec->control_sep_mask = 0;
+    sep_spec->crlf_is_sep = 0;
+    sep_spec->only_control_seps = sep_spec->num_seps > 0;
+    crlf = MVM_nfg_crlf_grapheme(tc);
+    cur_sep_pos = 0;
+    for (i = 0; i < sep_spec->num_seps; i++) {
+        MVMGrapheme32 first = sep_spec->sep_graphemes[cur_sep_pos];
+        if (first > sep_spec->max_first_grapheme)
+            sep_spec->max_first_grapheme = first;
+        if (first >= 0 && first < 128)
+            sep_spec->ascii_first_mask[first >> 6] |= (MVMuint64)1 << (first & 63);
+        if (sep_spec->sep_lengths[i] == 1 && first >= 0 && first < 0x20) {
+            /* A \r may yet be the start of a \r\n, so we leave it to the
+             * decoder. */
+            if (first != '\r')
+                sep_spec->control_sep_mask |= (MVMuint32)1 << first;
+        }
+        else if (sep_spec->sep_lengths[i] == 1 && first == crlf)
+            sep_spec->crlf_is_sep = 1;
+        else
+            sep_spec->only_control_seps = 0;
+        cur_sep_pos += sep_spec->sep_lengths[i];
+    }
 }
 
 /* Sets a decode stream separator to its default value. */
@@ -86,6 +86,19 @@ struct MVMDecodeStreamSeparators {
      * maximum codepoint/synthetic index of any final grapheme and doing a
      * quick comparison. */
     MVMGrapheme32 max_final_grapheme;
+
+    /* Likewise, the maximum first grapheme of any separator, and which of
+     * the ASCII chars start one, so most chars can be passed over without
+     * checking them against each separator. */
+    MVMGrapheme32 max_first_grapheme;
+    MVMuint64     ascii_first_mask[2];
+
+    /* Which lone control chars are separators, whether \r\n is one, and if
+     * they are all the separators there are, which lets lines be taken
+     * straight from the bytes for ASCII-compatible encodings. */
+    MVMuint32     control_sep_mask;
+    MVMuint8      crlf_is_sep;
+    MVMuint8      only_control_seps;
 };
 
 /* Checks if we may have encountered one of the separators. This just looks to
@@ -8,11 +8,19 @@
  * there is one, or negative if there is not (note 0 is a valid index). */
 static MVMint32 find_child_node_idx(MVMThreadContext *tc, const MVMNFGTrieNode *node, MVMCodepoint cp) {
     if (node) {
-        /* TODO: update this to do a binary search later on. */
-        MVMint32 i;
-        for (i = 0; i < node->num_entries; i++)
-            if (node->next_codes[i].code == cp)
-                return i;
+        /* The entries are sorted on codepoint, so binary search them. */
+        MVMint32 lo = 0;
+        MVMint32 hi = node->num_entries - 1;
+        while (lo <= hi) {
+            MVMint32 mid = lo + (hi - lo) / 2;
+            MVMCodepoint mid_cp = node->next_codes[mid].code;
+            if (mid_cp == cp)
+                return mid;
+            if (mid_cp < cp)
+                lo = mid + 1;
+            else
+                hi = mid - 1;
+        }
     }
     return -1;
 }
@@ -221,11 +229,37 @@ static MVMGrapheme32 add_synthetic(MVMThreadContext *tc, MVMCodepoint *codes, MV
     return result;
 }
 
-/* Does a lookup of a synthetic in the trie. If we find one, returns it. If
- * not, acquires the update lock, re-checks that we really are missing the
- * synthetic, and then adds it. */
+/* Hashes a codepoint sequence (FNV-1a), to index the per-thread cache of
+ * synthetic lookups. */
+static MVMuint32 hash_codes(MVMCodepoint *codes, MVMint32 num_codes) {
+    MVMuint32 hash = 0x811C9DC5;
+    MVMint32  i;
+    for (i = 0; i < num_codes; i++)
+        hash = (hash ^ (MVMuint32)codes[i]) * 0x01000193;
+    return hash;
+}
+
+/* Checks a synthetic is the one for the given codepoints. Synthetics are
+ * never changed once they are visible to other threads, so this needs no
+ * lock. */
+static MVMint32 synthetic_has_codes(MVMThreadContext *tc, MVMGrapheme32 synth, MVMCodepoint *codes, MVMint32 num_codes) {
+    MVMNFGSynthetic *info = &(tc->instance->nfg->synthetics[-synth - 1]);
+    return info->num_codes == num_codes
+        && memcmp(info->codes, codes, num_codes * sizeof(MVMCodepoint)) == 0;
+}
+
+/* Does a lookup of a synthetic, first in the per-thread cache, then in the
+ * trie. If we find one, returns it. If not, acquires the update lock,
+ * re-checks that we really are missing the synthetic, and then adds it. */
 static MVMGrapheme32 lookup_or_add_synthetic(MVMThreadContext *tc, MVMCodepoint *codes, MVMint32 num_codes, MVMint32 utf8_c8) {
-    MVMGrapheme32 result = lookup_synthetic(tc, codes, num_codes);
+    MVMuint32         hash   = hash_codes(codes, num_codes);
+    MVMNFGCacheEntry *cached = &(tc->nfg_cache[hash & (MVM_NFG_CACHE_SIZE - 1)]);
+    MVMGrapheme32     result;
+    if (cached->synthetic && cached->hash == hash
+            && synthetic_has_codes(tc, cached->synthetic, codes, num_codes))
+        return cached->synthetic;
+
+    result = lookup_synthetic(tc, codes, num_codes);
     if (!result) {
         uv_mutex_lock(&tc->instance->nfg->update_mutex);
         result = lookup_synthetic(tc, codes, num_codes);
@@ -233,6 +267,8 @@ static MVMGrapheme32 lookup_or_add_synthetic(MVMThreadContext *tc, MVMCodepoint
             result = add_synthetic(tc, codes, num_codes, utf8_c8);
         uv_mutex_unlock(&tc->instance->nfg->update_mutex);
     }
+    cached->hash      = hash;
+    cached->synthetic = result;
     return result;
 }
 
@@ -398,17 +434,22 @@ MVM_STATIC_INLINE MVMint32 codepoint_GCB_Control (MVMThreadContext *tc, MVMCodep
 /* Returns non-zero if the result of concatenating the two strings will freely
  * leave us in NFG without any further effort. */
 MVMint32 MVM_nfg_is_concat_stable(MVMThreadContext *tc, MVMString *a, MVMString *b) {
-    MVMGrapheme32 last_a;
-    MVMGrapheme32 first_b;
-    MVMGrapheme32 crlf;
-
     /* If either string is empty, we're good. */
     if (a->body.num_graphs == 0 || b->body.num_graphs == 0)
         return 1;
 
-    /* Get first and last graphemes of the strings. */
-    last_a  = MVM_string_get_grapheme_at_nocheck(tc, a, a->body.num_graphs - 1);
-    first_b = MVM_string_get_grapheme_at_nocheck(tc, b, 0);
+    /* Otherwise, it comes down to the last and first graphemes. */
+    return MVM_nfg_are_graphemes_concat_stable(tc,
+        MVM_string_get_grapheme_at_nocheck(tc, a, a->body.num_graphs - 1),
+        MVM_string_get_grapheme_at_nocheck(tc, b, 0));
+}
+
+/* Checks if the grapheme last_a followed by first_b is stable under
+ * concatenation, in the same sense as MVM_nfg_is_concat_stable. */
+MVMint32 MVM_nfg_are_graphemes_concat_stable(MVMThreadContext *tc, MVMGrapheme32 last_a,
+        MVMGrapheme32 first_b) {
+    MVMGrapheme32 crlf;
+
     /* Put the case where we are adding a lf or crlf line ending */
     if (first_b == '\n')
         /* If we see \r + \n we need to renormalize. Otherwise we're good */
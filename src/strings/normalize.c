@@ -28,6 +28,11 @@ static void assert_codepoint_array(MVMThreadContext *tc, const MVMObject *arr, c
     }
     MVM_exception_throw_adhoc(tc, "%s", error);
 }
+/* The most codepoints we offer the normalizer as a stable run at once, so we
+ * don't grow the result for all of the input up front. When a run can't be
+ * taken, we pass the next codepoint the usual way before trying again. */
+#define STABLE_RUN_MAX 4096
+
 MVM_STATIC_INLINE void maybe_grow_result(MVMCodepoint **result, MVMint64 *result_alloc, MVMint64 needed) {
     if (needed >= *result_alloc) {
         while (needed >= *result_alloc)
@@ -40,7 +45,7 @@ void MVM_unicode_normalize_codepoints(MVMThreadContext *tc, const MVMObject *in,
     MVMCodepoint  *input;
     MVMCodepoint  *result;
     MVMint64       input_pos, input_codes, result_pos, result_alloc;
-    MVMint32       ready;
+    MVMint32       ready, retry;
 
     /* Validate input/output array. */
     assert_codepoint_array(tc, in, "Normalization input must be native array of 32-bit integers");
@@ -60,8 +65,22 @@ void MVM_unicode_normalize_codepoints(MVMThreadContext *tc, const MVMObject *in,
     MVM_unicode_normalizer_init(tc, &norm, form);
     input_pos  = 0;
     result_pos = 0;
+    retry      = 0;
     while (input_pos < input_codes) {
         MVMCodepoint cp;
+        if (!retry) {
+            MVMint32 run = input_codes - input_pos < STABLE_RUN_MAX
+                ? (MVMint32)(input_codes - input_pos) : STABLE_RUN_MAX;
+            maybe_grow_result(&result, &result_alloc, result_pos + run);
+            run = MVM_unicode_normalizer_process_stable_run(tc, &norm,
+                input + input_pos, run, result + result_pos);
+            if (run) {
+                result_pos += run;
+                input_pos  += run;
+                continue;
+            }
+        }
+        retry = !retry;
         ready = MVM_unicode_normalizer_process_codepoint(tc, &norm, input[input_pos], &cp);
         if (ready) {
             maybe_grow_result(&result, &result_alloc, result_pos + ready);
@@ -87,7 +106,7 @@ MVMString * MVM_unicode_codepoints_c_array_to_nfg_string(MVMThreadContext *tc, M
     MVMNormalizer  norm;
     MVMint64       input_pos, result_pos, result_alloc;
     MVMGrapheme32 *result;
-    MVMint32       ready;
+    MVMint32       ready, retry;
     MVMString     *str;
 
     if (cp_count == 0)
@@ -101,8 +120,22 @@ MVMString * MVM_unicode_codepoints_c_array_to_nfg_string(MVMThreadContext *tc, M
     MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFG);
     input_pos  = 0;
     result_pos = 0;
+    retry      = 0;
     while (input_pos < cp_count) {
         MVMGrapheme32 g;
+        if (!retry) {
+            MVMint32 run = cp_count - input_pos < STABLE_RUN_MAX
+                ? (MVMint32)(cp_count - input_pos) : STABLE_RUN_MAX;
+            maybe_grow_result(&result, &result_alloc, result_pos + run);
+            run = MVM_unicode_normalizer_process_stable_run(tc, &norm,
+                cp_v + input_pos, run, result + result_pos);
+            if (run) {
+                result_pos += run;
+                input_pos  += run;
+                continue;
+            }
+        }
+        retry = !retry;
         ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, cp_v[input_pos], &g);
         if (ready) {
             maybe_grow_result(&result, &result_alloc, result_pos + ready);
@@ -124,6 +157,7 @@ MVMString * MVM_unicode_codepoints_c_array_to_nfg_string(MVMThreadContext *tc, M
     str->body.storage.blob_32 = result;
     str->body.storage_type    = MVM_STRING_GRAPHEME_32;
     str->body.num_graphs      = result_pos;
+    MVM_string_narrow_to_8bit(tc, str);
     return str;
 }
 
@@ -747,6 +781,76 @@ MVMint32 MVM_unicode_normalizer_process_codepoint_full(MVMThreadContext *tc, MVM
     return norm->buffer_norm_end - norm->buffer_start++;
 }
 
+/* Checks whether a codepoint would take the fast case in the above, so comes
+ * straight out again when it follows another that would: it is no
+ * normalization terminator or prepend, and is a starter passing quick check. */
+static MVMint32 is_stable_starter(MVMThreadContext *tc, const MVMNormalizer *n, MVMCodepoint cp) {
+    if (cp < 0x20 || (0x7F <= cp && cp <= 0x9F) || cp == 0xAD)
+        return 0;
+    if (cp < n->first_significant)
+        return 1;
+    if (is_grapheme_prepend(tc, cp) || (cp > 0xFF && MVM_string_is_control_full(tc, cp)))
+        return 0;
+    return passes_quickcheck(tc, n, cp) && MVM_unicode_relative_ccc(tc, cp) == 0;
+}
+
+/* Takes a run of codepoints and passes through as many from the start of it
+ * as are stable starters, without buffering them one at a time. Codepoints
+ * below the first significant one for the form are checked a block at a
+ * time; above it, each gets the quick check. The normalizer has to be in the
+ * state its fast cases leave it in: for composition, holding one stable
+ * starter, and otherwise empty. The codepoints that come out are put into out
+ * and their number returned, which is the number of input codepoints taken;
+ * 0 means the caller should pass the next codepoint in the usual way. */
+#define STABLE_RUN_BLOCK 64
+MVMint32 MVM_unicode_normalizer_process_stable_run(MVMThreadContext *tc, MVMNormalizer *n, const MVMCodepoint *in, MVMint32 len, MVMCodepoint *out) {
+    MVMCodepoint first_significant = n->first_significant;
+    MVMint32     composing         = MVM_NORMALIZE_COMPOSE(n->form);
+    MVMint32     taken             = 0;
+    if (len <= 0 || n->prepend_buffer || n->buffer_norm_end != n->buffer_start)
+        return 0;
+    if (composing) {
+        if (n->buffer_end - n->buffer_start != 1
+                || !is_stable_starter(tc, n, n->buffer[n->buffer_start]))
+            return 0;
+    }
+    else if (n->buffer_start != n->buffer_end) {
+        return 0;
+    }
+
+    while (taken < len) {
+        MVMint32 block_end = len - taken > STABLE_RUN_BLOCK ? taken + STABLE_RUN_BLOCK : len;
+        MVMint32 unstable  = 0;
+        MVMint32 i;
+        MVM_VECTORIZE_LOOP
+        for (i = taken; i < block_end; i++) {
+            MVMCodepoint cp = in[i];
+            unstable |= !((0x20 <= cp && cp < 0x7F)
+                || (0xA0 <= cp && cp < first_significant && cp != 0xAD));
+        }
+        if (!unstable) {
+            taken = block_end;
+            continue;
+        }
+        while (taken < block_end && is_stable_starter(tc, n, in[taken]))
+            taken++;
+        if (taken < block_end)
+            break;
+    }
+    if (!taken)
+        return 0;
+
+    if (composing) {
+        out[0] = n->buffer[n->buffer_start];
+        memcpy(out + 1, in, (taken - 1) * sizeof(MVMCodepoint));
+        n->buffer[n->buffer_start] = in[taken - 1];
+    }
+    else {
+        memcpy(out, in, taken * sizeof(MVMCodepoint));
+    }
+    return taken;
+}
+
 /* Push a number of codepoints into the "to normalize" buffer. */
 void MVM_unicode_normalizer_push_codepoints(MVMThreadContext *tc, MVMNormalizer *n, const MVMCodepoint *in, MVMint32 num_codepoints) {
     MVMint32 i;
@@ -133,6 +133,30 @@ MVM_STATIC_INLINE MVMint32 MVM_unicode_normalizer_process_codepoint_to_grapheme(
     return MVM_unicode_normalizer_process_codepoint(tc, n, in, (MVMGrapheme32 *)out);
 }
 
+/* Takes a run of printable ASCII characters (0x20 to 0x7E), none of which
+ * can interact with their neighbours in any normalization form. When the
+ * normalizer is in the state its composition fast-path leaves it in, holding
+ * one earlier codepoint that can't either, this does what passing each of the
+ * characters to MVM_unicode_normalizer_process_codepoint would do, putting the
+ * len codepoints that come out into out and returning len. Otherwise, does
+ * nothing and returns 0, and the caller should go one codepoint at a time. */
+MVM_STATIC_INLINE MVMint32 MVM_unicode_normalizer_process_ascii_run(MVMThreadContext *tc, MVMNormalizer *n, const MVMuint8 *in, MVMint32 len, MVMCodepoint *out) {
+    MVMint32 i;
+    if (!MVM_NORMALIZE_COMPOSE(n->form) || n->prepend_buffer || n->first_significant <= 0x7E
+            || n->buffer_end - n->buffer_start != 1 || n->buffer_norm_end != n->buffer_start
+            || n->buffer[n->buffer_start] >= n->first_significant
+            || n->buffer[n->buffer_start] == 0x0D || len <= 0)
+        return 0;
+    out[0] = n->buffer[n->buffer_start];
+    for (i = 1; i < len; i++)
+        out[i] = in[i - 1];
+    n->buffer[n->buffer_start] = in[len - 1];
+    return len;
+}
+
+/* Block-level counterpart of the above for any codepoints; see normalize.c. */
+MVMint32 MVM_unicode_normalizer_process_stable_run(MVMThreadContext *tc, MVMNormalizer *n, const MVMCodepoint *in, MVMint32 len, MVMCodepoint *out);
+
 /* Push a number of codepoints into the "to normalize" buffer. */
 void MVM_unicode_normalizer_push_codepoints(MVMThreadContext *tc, MVMNormalizer *n, const MVMCodepoint *in, MVMint32 num_codepoints);
 
@@ -208,6 +208,14 @@ static void turn_32bit_into_8bit_unchecked(MVMThreadContext *tc, MVMString *str)
 
     MVM_free(old_buf);
 }
+/* Switches a flat 32-bit string over to 8-bit storage if all of its graphemes
+ * fit, quartering its size. Only to be used on strings that are still being
+ * built, since the blob is replaced. */
+void MVM_string_narrow_to_8bit(MVMThreadContext *tc, MVMString *str) {
+    if (str->body.storage_type == MVM_STRING_GRAPHEME_32 && str->body.num_graphs
+            && MVM_string_buf32_can_fit_into_8bit(str->body.storage.blob_32, str->body.num_graphs))
+        turn_32bit_into_8bit_unchecked(tc, str);
+}
 /* Checks if the next num_graphs graphemes in the iterator can fit into 8 bits.
  * This was written to take advantage of SIMD vectorization, so we use a multiple
  * bitwise operations to check, and biwise OR it with val. Care must be taken
@@ -416,6 +424,60 @@ static MVMString * collapse_strands(MVMThreadContext *tc, MVMString *orig) {
     return result;
 }
 
+/* Frees up at least `needed` strand slots in a strand string by collapsing a
+ * run of its trailing strands into a single flat one. Fully collapsing the
+ * string instead would make building a string by repeated concatenation
+ * quadratic, since everything built so far would be copied again every
+ * few dozen concatenations. Here, the run to collapse is also extended
+ * over any earlier strand no bigger than the run itself, which keeps strand
+ * sizes decreasing towards the end of the string; much like the carries of
+ * a binary counter, each grapheme then only gets copied a logarithmic
+ * number of times over the life of the builder. */
+static MVMString * collapse_trailing_strands(MVMThreadContext *tc, MVMString *orig, MVMuint16 needed) {
+    MVMStringStrand *strands     = orig->body.storage.strands;
+    MVMuint16        num_strands = orig->body.num_strands;
+    MVMuint16        first;
+    MVMuint64        tail_graphs = 0;
+    MVMuint16        i;
+    MVMString       *tail        = NULL;
+    MVMString       *result      = NULL;
+
+    if (num_strands <= needed + 1)
+        return collapse_strands(tc, orig);
+    first = num_strands - needed - 1;
+    for (i = first; i < num_strands; i++)
+        tail_graphs += (MVMuint64)(strands[i].end - strands[i].start) * (strands[i].repetitions + 1);
+    while (first > 0) {
+        MVMStringStrand *prev = &strands[first - 1];
+        MVMuint64 prev_graphs = (MVMuint64)(prev->end - prev->start) * (prev->repetitions + 1);
+        if (prev_graphs > tail_graphs)
+            break;
+        tail_graphs += prev_graphs;
+        first--;
+    }
+    if (first == 0)
+        return collapse_strands(tc, orig);
+
+    MVMROOT(tc, orig, {
+        tail = MVM_string_substring(tc, orig, orig->body.num_graphs - tail_graphs, tail_graphs);
+        MVMROOT(tc, tail, {
+            result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
+        });
+    });
+    result->body.storage_type    = MVM_STRING_STRAND;
+    result->body.num_graphs      = orig->body.num_graphs;
+    result->body.num_strands     = first + 1;
+    result->body.storage.strands = allocate_strands(tc, first + 1);
+    copy_strands(tc, orig, 0, result, 0, first);
+    result->body.storage.strands[first].blob_string = tail;
+    MVM_gc_write_barrier(tc, (MVMCollectable *)result, (MVMCollectable *)tail);
+    result->body.storage.strands[first].start       = 0;
+    result->body.storage.strands[first].end         = tail_graphs;
+    result->body.storage.strands[first].repetitions = 0;
+    STRAND_CHECK(tc, result);
+    return result;
+}
+
 /* Takes a string that is no longer in NFG form after some concatenation-style
  * operation, and returns a new string that is in NFG. Note that we could do a
  * much, much, smarter thing in the future that doesn't involve all of this
@@ -468,9 +530,16 @@ static MVMString * re_nfg(MVMThreadContext *tc, MVMString *in) {
     out->body.storage.blob_32 = out_buffer;
     out->body.storage_type    = MVM_STRING_GRAPHEME_32;
     out->body.num_graphs      = out_pos;
+    MVM_string_narrow_to_8bit(tc, out);
     return out;
 }
 
+/* Renormalizes a string that was put together from pieces which may not have
+ * been stable under concatenation. */
+MVMString * MVM_string_renormalize(MVMThreadContext *tc, MVMString *s) {
+    return re_nfg(tc, s);
+}
+
 /* Returns nonzero if two substrings are equal, doesn't check bounds */
 MVMint64 MVM_string_substrings_equal_nocheck(MVMThreadContext *tc, MVMString *a,
         MVMint64 starta, MVMint64 length, MVMString *b, MVMint64 startb) {
@@ -557,6 +626,140 @@ static MVMint64 MVM_string_memmem_grapheme32str (MVMThreadContext *tc, MVMString
     if (needle_buf) MVM_free(needle_buf);
     return rtrn;
 }
+/* Finds the first position in H_start..H_end of haystack blob H at which all
+ * of needle n occurs, or -1 if there's none. Candidates are filtered a block
+ * at a time by comparing only the needle's first and last graphemes, in a
+ * loop simple enough for the compiler to vectorize; just those that pass are
+ * compared in full. Instantiated for each combination of 8-bit and 32-bit
+ * haystack and needle, so neither side needs converting. */
+#define BLOB_INDEX_BLOCK 64
+#define DEFINE_BLOB_INDEX(name, H_type, n_type) \
+static MVMint64 name(const H_type *H, MVMStringIndex H_start, MVMStringIndex H_end, \
+        const n_type *n, MVMStringIndex n_graphs) { \
+    const MVMGrapheme32 first  = n[0]; \
+    const MVMGrapheme32 last   = n[n_graphs - 1]; \
+    const H_type       *H_last = H + n_graphs - 1; \
+    MVMStringIndex pos, limit; \
+    if (H_end < H_start || H_end - H_start < n_graphs) \
+        return -1; \
+    limit = H_end - n_graphs + 1; \
+    for (pos = H_start; pos < limit; pos += BLOB_INDEX_BLOCK) { \
+        MVMuint8       hits[BLOB_INDEX_BLOCK]; \
+        MVMuint8       any_hits = 0; \
+        MVMStringIndex block = limit - pos < BLOB_INDEX_BLOCK ? limit - pos : BLOB_INDEX_BLOCK; \
+        MVMStringIndex i; \
+        MVM_VECTORIZE_LOOP \
+        for (i = 0; i < block; i++) { \
+            hits[i] = (H[pos + i] == first) & (H_last[pos + i] == last); \
+            any_hits |= hits[i]; \
+        } \
+        if (!any_hits) \
+            continue; \
+        for (i = 0; i < block; i++) { \
+            if (hits[i]) { \
+                MVMStringIndex k = 1; \
+                while (k + 1 < n_graphs && H[pos + i + k] == n[k]) \
+                    k++; \
+                if (n_graphs <= k + 1) \
+                    return pos + i; \
+            } \
+        } \
+    } \
+    return -1; \
+}
+DEFINE_BLOB_INDEX(blob_index_8_8,   MVMGrapheme8,  MVMGrapheme8)
+DEFINE_BLOB_INDEX(blob_index_8_32,  MVMGrapheme8,  MVMGrapheme32)
+DEFINE_BLOB_INDEX(blob_index_32_8,  MVMGrapheme32, MVMGrapheme8)
+DEFINE_BLOB_INDEX(blob_index_32_32, MVMGrapheme32, MVMGrapheme32)
+
+/* A needle resolved to the blob its graphemes live in. */
+typedef struct {
+    void      *graphs;
+    MVMuint8   is_8bit;
+} IndexNeedle;
+
+/* Resolves a needle that's flat, or a single unrepeated strand (as produced
+ * by substr), to its graphemes. Returns 0 for any other needle. */
+static int resolve_index_needle(MVMThreadContext *tc, MVMString *needle, IndexNeedle *out) {
+    MVMString      *blob   = needle;
+    MVMStringIndex  offset = 0;
+    if (needle->body.storage_type == MVM_STRING_STRAND) {
+        if (needle->body.num_strands != 1 || needle->body.storage.strands[0].repetitions)
+            return 0;
+        blob   = needle->body.storage.strands[0].blob_string;
+        offset = needle->body.storage.strands[0].start;
+    }
+    if (blob->body.storage_type == MVM_STRING_GRAPHEME_32) {
+        out->graphs  = blob->body.storage.blob_32 + offset;
+        out->is_8bit = 0;
+    }
+    else {
+        out->graphs  = blob->body.storage.blob_8 + offset;
+        out->is_8bit = 1;
+    }
+    return 1;
+}
+
+/* Searches H_start..H_end of the flat string blob for the needle. */
+static MVMint64 blob_index(MVMString *blob, MVMStringIndex H_start, MVMStringIndex H_end,
+        IndexNeedle *n, MVMStringIndex n_graphs) {
+    if (blob->body.storage_type == MVM_STRING_GRAPHEME_32)
+        return n->is_8bit
+            ? blob_index_32_8(blob->body.storage.blob_32, H_start, H_end, n->graphs, n_graphs)
+            : blob_index_32_32(blob->body.storage.blob_32, H_start, H_end, n->graphs, n_graphs);
+    else
+        return n->is_8bit
+            ? blob_index_8_8(blob->body.storage.blob_8, H_start, H_end, n->graphs, n_graphs)
+            : blob_index_8_32(blob->body.storage.blob_8, H_start, H_end, n->graphs, n_graphs);
+}
+
+/* Searches a strand haystack blob by blob, without collapsing it. Matches
+ * lying within a single strand are found by the blob kernels, leaving only
+ * candidates that run over the end of a strand for the general comparison.
+ * Returns 0 without searching if any strand is repeated. */
+static int strand_index(MVMThreadContext *tc, MVMString *Haystack, MVMString *needle,
+        IndexNeedle *n, MVMStringIndex start, MVMStringIndex n_graphs, MVMint64 *found) {
+    MVMStringStrand *strands   = Haystack->body.storage.strands;
+    MVMuint16        num       = Haystack->body.num_strands;
+    MVMStringIndex   H_graphs  = Haystack->body.num_graphs;
+    MVMStringIndex   seg_start = 0;
+    MVMGrapheme32    first     = n->is_8bit
+        ? ((MVMGrapheme8 *)n->graphs)[0]
+        : ((MVMGrapheme32 *)n->graphs)[0];
+    MVMuint16        i;
+
+    for (i = 0; i < num; i++)
+        if (strands[i].repetitions)
+            return 0;
+
+    *found = -1;
+    for (i = 0; i < num && seg_start + n_graphs <= H_graphs; i++) {
+        MVMStringStrand *strand  = &strands[i];
+        MVMStringIndex   seg_end = seg_start + (strand->end - strand->start);
+        if (start < seg_end) {
+            MVMStringIndex from = start > seg_start ? start : seg_start;
+            MVMStringIndex cand;
+            MVMint64       pos  = blob_index(strand->blob_string,
+                strand->start + (from - seg_start), strand->end, n, n_graphs);
+            if (pos >= 0) {
+                *found = pos - strand->start + seg_start;
+                return 1;
+            }
+            cand = seg_end - from > n_graphs - 1 ? seg_end - (n_graphs - 1) : from;
+            for (; cand < seg_end && cand + n_graphs <= H_graphs; cand++) {
+                if (MVM_string_get_grapheme_at_nocheck(tc, strand->blob_string,
+                            strand->start + (cand - seg_start)) == first
+                        && MVM_string_substrings_equal_nocheck(tc, Haystack, cand, n_graphs, needle, 0)) {
+                    *found = cand;
+                    return 1;
+                }
+            }
+        }
+        seg_start = seg_end;
+    }
+    return 1;
+}
+
 /* Returns the location of one string in another or -1  */
 MVMint64 MVM_string_index(MVMThreadContext *tc, MVMString *Haystack, MVMString *needle, MVMint64 start) {
     size_t index           = (size_t)start;
@@ -587,6 +790,7 @@ MVMint64 MVM_string_index(MVMThreadContext *tc, MVMString *Haystack, MVMString *
                 return MVM_string_memmem_grapheme32str(tc, Haystack, needle, start, H_graphs, n_graphs);
             }
             break;
+        case MVM_STRING_GRAPHEME_ASCII:
         case MVM_STRING_GRAPHEME_8:
             if (needle->body.storage_type == MVM_STRING_GRAPHEME_8 || needle->body.num_graphs < 100) {
                 void         *mm_return_8 = NULL;
@@ -623,6 +827,18 @@ MVMint64 MVM_string_index(MVMThreadContext *tc, MVMString *Haystack, MVMString *
             }
             break;
     }
+    /* Otherwise, if the needle lives in a single blob, search the haystack
+     * (blob by blob, if it's a strand one) with the kernels above. */
+    {
+        IndexNeedle n;
+        if (resolve_index_needle(tc, needle, &n)) {
+            MVMint64 found;
+            if (Haystack->body.storage_type != MVM_STRING_STRAND)
+                return blob_index(Haystack, start, H_graphs, &n, n_graphs);
+            if (strand_index(tc, Haystack, needle, &n, start, n_graphs, &found))
+                return found;
+        }
+    }
     /* Minimal code version for needles of size 1 */
     if (n_graphs == 1) {
         MVMGraphemeIter H_gi;
@@ -706,6 +922,62 @@ MVMint64 MVM_string_index_from_end(MVMThreadContext *tc, MVMString *Haystack, MV
 }
 
 /* Returns a substring of the given string */
+/* Substrings of flat strings are normally views into them, which is cheap
+ * for large slices, but costs an extra indirection on every access and keeps
+ * the whole of the original string alive. So short slices, and slices that
+ * are only a sliver of a large string (such as a token taken from a whole
+ * input file) are copied out instead. */
+#define MVM_SUBSTRING_COPY_MAX      32
+#define MVM_SUBSTRING_LARGE_PARENT  65536
+#define MVM_SUBSTRING_SLIVER_RATIO  16
+MVM_STATIC_INLINE int substring_should_copy(MVMString *blob, MVMint64 graphs) {
+    MVMStringIndex blob_graphs = blob->body.num_graphs;
+    return graphs <= MVM_SUBSTRING_COPY_MAX
+        || (MVM_SUBSTRING_LARGE_PARENT <= blob_graphs
+            && graphs * MVM_SUBSTRING_SLIVER_RATIO <= blob_graphs);
+}
+
+/* Makes result a flat copy of a range of the graphemes of a flat string. The
+ * result's number of graphemes must already be set. */
+static void copy_flat_range(MVMThreadContext *tc, MVMString *result, MVMString *blob, MVMint64 start) {
+    MVMStringIndex graphs = result->body.num_graphs;
+    switch (blob->body.storage_type) {
+        case MVM_STRING_GRAPHEME_ASCII:
+        case MVM_STRING_GRAPHEME_8:
+            result->body.storage_type   = blob->body.storage_type;
+            result->body.storage.blob_8 = MVM_malloc(graphs * sizeof(MVMGrapheme8));
+            memcpy(result->body.storage.blob_8, blob->body.storage.blob_8 + start,
+                graphs * sizeof(MVMGrapheme8));
+            break;
+        case MVM_STRING_GRAPHEME_32:
+            result->body.storage_type    = MVM_STRING_GRAPHEME_32;
+            result->body.storage.blob_32 = MVM_malloc(graphs * sizeof(MVMGrapheme32));
+            memcpy(result->body.storage.blob_32, blob->body.storage.blob_32 + start,
+                graphs * sizeof(MVMGrapheme32));
+            break;
+        default:
+            MVM_exception_throw_adhoc(tc, "Unknown string storage type %d in substring",
+                blob->body.storage_type);
+    }
+}
+
+/* Makes result either a copy of, or a single strand view into, a range of the
+ * graphemes of a flat string, as substring_should_copy decides. */
+static void substring_of_flat(MVMThreadContext *tc, MVMString *result, MVMString *blob, MVMint64 start) {
+    if (substring_should_copy(blob, result->body.num_graphs)) {
+        copy_flat_range(tc, result, blob, start);
+        return;
+    }
+    result->body.storage_type    = MVM_STRING_STRAND;
+    result->body.storage.strands = allocate_strands(tc, 1);
+    result->body.num_strands     = 1;
+    result->body.storage.strands[0].blob_string = blob;
+    MVM_gc_write_barrier(tc, (MVMCollectable *)result, (MVMCollectable *)blob);
+    result->body.storage.strands[0].start       = start;
+    result->body.storage.strands[0].end         = start + result->body.num_graphs;
+    result->body.storage.strands[0].repetitions = 0;
+}
+
 MVMString * MVM_string_substring(MVMThreadContext *tc, MVMString *a, MVMint64 offset, MVMint64 length) {
     MVMString *result;
     MVMint64   start_pos, end_pos;
@@ -751,35 +1023,48 @@ MVMString * MVM_string_substring(MVMThreadContext *tc, MVMString *a, MVMint64 of
         result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
         result->body.num_graphs = end_pos - start_pos;
         if (a->body.storage_type != MVM_STRING_STRAND) {
-            /* It's some kind of buffer. Construct a strand view into it. */
-            result->body.storage_type    = MVM_STRING_STRAND;
-            result->body.storage.strands = allocate_strands(tc, 1);
-            result->body.num_strands     = 1;
-            result->body.storage.strands[0].blob_string = a;
-            MVM_gc_write_barrier(tc, (MVMCollectable *)result, (MVMCollectable *)a);
-            result->body.storage.strands[0].start       = start_pos;
-            result->body.storage.strands[0].end         = end_pos;
-            result->body.storage.strands[0].repetitions = 0;
+            /* It's some kind of buffer. Construct a strand view into it, or
+             * copy the slice out of it. */
+            substring_of_flat(tc, result, a, start_pos);
         }
         else if (a->body.num_strands == 1 && a->body.storage.strands[0].repetitions == 0) {
             /* Single strand string; quite possibly already a substring. We'll
              * just produce an updated view. */
             MVMStringStrand *orig_strand = &(a->body.storage.strands[0]);
-            result->body.storage_type    = MVM_STRING_STRAND;
-            result->body.storage.strands = allocate_strands(tc, 1);
-            result->body.num_strands     = 1;
-            result->body.storage.strands[0].blob_string = orig_strand->blob_string;
-            MVM_gc_write_barrier(tc, (MVMCollectable *)result, (MVMCollectable *)orig_strand->blob_string);
-            result->body.storage.strands[0].start       = orig_strand->start + start_pos;
-            result->body.storage.strands[0].end         = orig_strand->start + end_pos;
-            result->body.storage.strands[0].repetitions = 0;
+            substring_of_flat(tc, result, orig_strand->blob_string,
+                orig_strand->start + start_pos);
         }
         else {
-            /* Produce a new blob string, collapsing the strands. */
-            MVMGraphemeIter gi;
-            MVM_string_gi_init(tc, &gi, a);
-            MVM_string_gi_move_to(tc, &gi, start_pos);
-            iterate_gi_into_string(tc, &gi, result, a, start_pos);
+            /* See if the substring lies within a single repetition of a
+             * single strand; if so, it can just be a view of that strand's
+             * blob. */
+            MVMStringStrand *strands   = a->body.storage.strands;
+            MVMint64         seg_start = 0;
+            MVMuint16        i;
+            for (i = 0; i < a->body.num_strands; i++) {
+                MVMint64 rep_graphs = strands[i].end - strands[i].start;
+                MVMint64 seg_end    = seg_start + rep_graphs * (strands[i].repetitions + 1);
+                if (start_pos < seg_end) {
+                    MVMint64 offset = (start_pos - seg_start) % rep_graphs;
+                    if (offset + (end_pos - start_pos) > rep_graphs)
+                        i = a->body.num_strands;
+                    break;
+                }
+                seg_start = seg_end;
+            }
+            if (i < a->body.num_strands) {
+                MVMStringStrand *orig_strand = &strands[i];
+                MVMint64 offset = (start_pos - seg_start) % (orig_strand->end - orig_strand->start);
+                substring_of_flat(tc, result, orig_strand->blob_string,
+                    orig_strand->start + offset);
+            }
+            else {
+                /* Produce a new blob string, collapsing the strands. */
+                MVMGraphemeIter gi;
+                MVM_string_gi_init(tc, &gi, a);
+                MVM_string_gi_move_to(tc, &gi, start_pos);
+                iterate_gi_into_string(tc, &gi, result, a, start_pos);
+            }
         }
     });
 
@@ -938,7 +1223,8 @@ MVMString * MVM_string_concatenate(MVMThreadContext *tc, MVMString *a, MVMString
         /* Otherwise, construct a new strand string. */
         else {
             /* See if we have too many strands between the two. If so, we will
-             * collapse the biggest side. */
+             * collapse the biggest side (or, for the left side, just enough of
+             * its tail). */
             MVMuint16 strands_a = a->body.storage_type == MVM_STRING_STRAND
                 ? a->body.num_strands
                 : 1;
@@ -951,9 +1237,13 @@ MVMString * MVM_string_concatenate(MVMThreadContext *tc, MVMString *a, MVMString
                 MVMROOT(tc, result, {
                     if (strands_b <= strands_a) {
                         MVMROOT(tc, effective_b, {
-                            effective_a = collapse_strands(tc, effective_a);
+                            effective_a = collapse_trailing_strands(tc, effective_a,
+                                strands_a + strands_b + (renormalized_section_graphs ? 1 : 0)
+                                    - MVM_STRING_MAX_STRANDS);
                         });
-                        strands_a   = 1;
+                        strands_a   = effective_a->body.storage_type == MVM_STRING_STRAND
+                            ? effective_a->body.num_strands
+                            : 1;
                     }
                     else {
                         MVMROOT(tc, effective_a, {
@@ -1377,6 +1667,21 @@ static MVMint64 string_index_ignore_case(MVMThreadContext *tc, MVMString *Haysta
     if (n_graphs < 1)
         return -1;
 
+    /* Folding the case of ASCII maps each grapheme to exactly one other, so
+     * when both sides are ASCII we can fold them and do a plain search. */
+    if (ignorecase && !ignoremark
+            && (MVM_string_flags(tc, Haystack) & MVM_STRING_FLAG_ALL_ASCII)
+            && (MVM_string_flags(tc, needle) & MVM_STRING_FLAG_ALL_ASCII)) {
+        MVMString *Haystack_fc;
+        MVMROOT(tc, needle, {
+            Haystack_fc = MVM_string_fc(tc, Haystack);
+        });
+        MVMROOT(tc, Haystack_fc, {
+            needle_fc = MVM_string_fc(tc, needle);
+        });
+        return MVM_string_index(tc, Haystack_fc, needle_fc, start);
+    }
+
     MVMROOT(tc, Haystack, {
         needle_fc = ignorecase ? MVM_string_fc(tc, needle) : needle;
     });
@@ -1517,12 +1822,136 @@ MVMint64 MVM_string_index_of_grapheme(MVMThreadContext *tc, MVMString *a, MVMGra
     return -1;
 }
 
+/* Scans a range of a flat string's graphemes for anything outside of ASCII
+ * and for synthetics, and returns the flags that hold for the range. */
+static MVMuint8 scan_blob_flags(MVMThreadContext *tc, MVMString *blob, MVMStringIndex start, MVMStringIndex end) {
+    MVMuint8 flags = MVM_STRING_FLAG_ALL_ASCII | MVM_STRING_FLAG_NO_SYNTHETICS;
+    MVMStringIndex i;
+    switch (blob->body.storage_type) {
+        case MVM_STRING_GRAPHEME_ASCII:
+            break;
+        case MVM_STRING_GRAPHEME_8: {
+            const MVMGrapheme8 *g8 = blob->body.storage.blob_8;
+            MVMuint8 high = 0;
+            MVM_VECTORIZE_LOOP
+            for (i = start; i < end; i++)
+                high |= (MVMuint8)g8[i];
+            /* An 8-bit grapheme is signed, so the top bit being set means
+             * it's negative, and so a synthetic; the rest are ASCII. */
+            if (high & 0x80)
+                flags = 0;
+            break;
+        }
+        case MVM_STRING_GRAPHEME_32: {
+            const MVMGrapheme32 *g32 = blob->body.storage.blob_32;
+            MVMuint32 bits = 0;
+            MVM_VECTORIZE_LOOP
+            for (i = start; i < end; i++)
+                bits |= (MVMuint32)g32[i];
+            if (bits & 0x80000000)
+                flags = 0;
+            else if (bits & ~0x7F)
+                flags = MVM_STRING_FLAG_NO_SYNTHETICS;
+            break;
+        }
+        default:
+            MVM_exception_throw_adhoc(tc, "Unknown string storage type %d", blob->body.storage_type);
+    }
+    return flags;
+}
+
+/* Works out the flags describing a string's graphemes and caches them on the
+ * string. Two threads may race to do this, but both will store the same. */
+MVMuint8 MVM_string_compute_flags(MVMThreadContext *tc, MVMString *s) {
+    MVMuint8 flags;
+    if (s->body.storage_type == MVM_STRING_STRAND) {
+        MVMuint16 i;
+        flags = MVM_STRING_FLAG_ALL_ASCII | MVM_STRING_FLAG_NO_SYNTHETICS;
+        for (i = 0; flags && i < s->body.num_strands; i++) {
+            MVMStringStrand *strand = &(s->body.storage.strands[i]);
+            MVMString       *blob   = strand->blob_string;
+            /* Whatever holds for all of the underlying string holds for the
+             * part of it we use, so only scan when that doesn't say enough. */
+            MVMuint8 blob_flags = blob->body.flags & MVM_STRING_FLAGS_COMPUTED
+                ? blob->body.flags
+                : scan_blob_flags(tc, blob, strand->start, strand->end);
+            flags &= blob_flags;
+        }
+    }
+    else {
+        flags = scan_blob_flags(tc, s, 0, s->body.num_graphs);
+    }
+    flags |= MVM_STRING_FLAGS_COMPUTED | (s->body.flags & ~(MVM_STRING_FLAG_ALL_ASCII | MVM_STRING_FLAG_NO_SYNTHETICS));
+    s->body.flags = flags;
+    return flags;
+}
+
 /* Case change functions. */
 MVMint64 MVM_string_grapheme_is_cclass(MVMThreadContext *tc, MVMint64 cclass, MVMGrapheme32 g);
+
+/* Changes the case of a string known to be all ASCII; every grapheme maps to
+ * exactly one other, so the result is ASCII too and the same length. */
+static MVMString * do_ascii_case_change(MVMThreadContext *tc, MVMString *s, MVMint32 type, MVMStringIndex sgraphs) {
+    MVMString      *result;
+    MVMGrapheme8   *result_buf = MVM_malloc(sgraphs * sizeof(MVMGrapheme8));
+    MVMuint8        changed    = 0;
+    MVMStringIndex  i;
+    if (s->body.storage_type == MVM_STRING_STRAND) {
+        MVMGraphemeIter gi;
+        MVM_string_gi_init(tc, &gi, s);
+        for (i = 0; i < sgraphs; i++)
+            result_buf[i] = (MVMGrapheme8)MVM_string_gi_get_grapheme(tc, &gi);
+    }
+    else if (s->body.storage_type == MVM_STRING_GRAPHEME_32) {
+        const MVMGrapheme32 *g32 = s->body.storage.blob_32;
+        MVM_VECTORIZE_LOOP
+        for (i = 0; i < sgraphs; i++)
+            result_buf[i] = (MVMGrapheme8)g32[i];
+    }
+    else {
+        memcpy(result_buf, s->body.storage.blob_8, sgraphs * sizeof(MVMGrapheme8));
+    }
+    if (type == MVM_unicode_case_change_type_lower || type == MVM_unicode_case_change_type_fold) {
+        MVM_VECTORIZE_LOOP
+        for (i = 0; i < sgraphs; i++) {
+            MVMuint8 is_upper = (MVMuint8)(result_buf[i] - 'A') < 26;
+            changed |= is_upper;
+            result_buf[i] |= is_upper << 5;
+        }
+    }
+    else {
+        MVM_VECTORIZE_LOOP
+        for (i = 0; i < sgraphs; i++) {
+            MVMuint8 is_lower = (MVMuint8)(result_buf[i] - 'a') < 26;
+            changed |= is_lower;
+            result_buf[i] &= ~(is_lower << 5);
+        }
+    }
+    if (!changed) {
+        MVM_free(result_buf);
+        s->body.flags |= MVM_STRING_FLAG_CASE_STABLE(type);
+        return s;
+    }
+    result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
+    result->body.num_graphs      = sgraphs;
+    result->body.storage_type    = MVM_STRING_GRAPHEME_8;
+    result->body.storage.blob_8  = result_buf;
+    result->body.flags           = MVM_STRING_FLAGS_COMPUTED | MVM_STRING_FLAG_ALL_ASCII
+                                 | MVM_STRING_FLAG_NO_SYNTHETICS
+                                 | MVM_STRING_FLAG_CASE_STABLE(type);
+    return result;
+}
+
 static MVMString * do_case_change(MVMThreadContext *tc, MVMString *s, MVMint32 type, char *error) {
     MVMint64 sgraphs;
+    MVMuint8 flags;
     MVM_string_check_arg(tc, s, error);
     sgraphs = MVM_string_graphs_nocheck(tc, s);
+    if (s->body.flags & MVM_STRING_FLAG_CASE_STABLE(type))
+        return s;
+    flags = MVM_string_flags(tc, s);
+    if (sgraphs && (flags & MVM_STRING_FLAG_ALL_ASCII))
+        return do_ascii_case_change(tc, s, type, sgraphs);
     if (sgraphs) {
         MVMString *result;
         MVMGraphemeIter gi;
@@ -1644,6 +2073,7 @@ static MVMString * do_case_change(MVMThreadContext *tc, MVMString *s, MVMint32 t
             result->body.num_graphs      = result_graphs;
             result->body.storage_type    = MVM_STRING_GRAPHEME_32;
             result->body.storage.blob_32 = result_buf;
+            MVM_string_narrow_to_8bit(tc, result);
             return result;
         }
         else {
@@ -1651,6 +2081,7 @@ static MVMString * do_case_change(MVMThreadContext *tc, MVMString *s, MVMint32 t
         }
     }
     STRAND_CHECK(tc, s);
+    s->body.flags |= MVM_STRING_FLAG_CASE_STABLE(type);
     return s;
 }
 MVMString * MVM_string_uc(MVMThreadContext *tc, MVMString *s) {
@@ -1818,6 +2249,129 @@ MVMObject * MVM_string_encode_to_buf(MVMThreadContext *tc, MVMString *s, MVMStri
         MVMObject *buf, MVMString *replacement) {
     return MVM_string_encode_to_buf_config(tc, s, enc_name, buf, replacement, MVM_ENCODING_PERMISSIVE);
 }
+/* Writes the ASCII graphemes of part of a flat string out as code units of
+ * the given width, with the character in the byte at low and any other byte
+ * of the unit zeroed. */
+static MVMuint8 * write_ascii_units(MVMString *blob, MVMStringIndex start, MVMStringIndex end,
+        MVMuint8 *out, MVMuint32 unit, MVMuint32 low) {
+    MVMStringIndex i, n = end - start;
+    if (unit == 1) {
+        if (blob->body.storage_type == MVM_STRING_GRAPHEME_32) {
+            const MVMGrapheme32 *g32 = blob->body.storage.blob_32 + start;
+            MVM_VECTORIZE_LOOP
+            for (i = 0; i < n; i++)
+                out[i] = (MVMuint8)g32[i];
+        }
+        else {
+            memcpy(out, blob->body.storage.blob_8 + start, n);
+        }
+    }
+    else {
+        for (i = 0; i < n; i++) {
+            MVMGrapheme32 g = blob->body.storage_type == MVM_STRING_GRAPHEME_32
+                ? blob->body.storage.blob_32[start + i]
+                : blob->body.storage.blob_8[start + i];
+            out[unit * i + low]     = (MVMuint8)g;
+            out[unit * i + 1 - low] = 0;
+        }
+    }
+    return out + unit * n;
+}
+
+/* Encodes a string into the supplied Buf instance, which should be an 8-bit
+ * integer array with MVMArray REPR, starting at the given offset into it. The
+ * Buf is left holding what came before the offset followed by the encoded
+ * string, and keeps its storage, so one Buf can be reused for one encode after
+ * another without allocating. A string made up purely of ASCII is written
+ * straight into the Buf; anything else is encoded and then copied in. Returns
+ * the number of bytes written. */
+MVMint64 MVM_string_encode_into_buf_config(MVMThreadContext *tc, MVMString *s, MVMString *enc_name,
+        MVMObject *buf, MVMint64 offset, MVMString *replacement, MVMint64 config) {
+    MVMArrayREPRData *buf_rd;
+    MVMArrayBody     *body;
+    MVMuint8          encoding_flag;
+    MVMStringIndex    graphs;
+    MVMuint64         output_size;
+    MVMuint32         unit = 0, low = 0;
+    char             *encoded;
+
+    /* Ensure the target is in the correct form. */
+    MVM_string_check_arg(tc, s, "encode");
+    if (!IS_CONCRETE(buf) || REPR(buf)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "encode requires a native array to write into");
+    buf_rd = (MVMArrayREPRData *)STABLE(buf)->REPR_data;
+    if (!buf_rd || (buf_rd->slot_type != MVM_ARRAY_U8 && buf_rd->slot_type != MVM_ARRAY_I8))
+        MVM_exception_throw_adhoc(tc, "encode into a buffer requires an 8-bit native int array");
+    body = &((MVMArray *)buf)->body;
+    if (offset < 0 || body->elems < (MVMuint64)offset)
+        MVM_exception_throw_adhoc(tc, "encode offset (%"PRId64") out of range (0..%"PRIu64")",
+            offset, body->elems);
+
+    MVMROOT2(tc, buf, s, {
+        encoding_flag = MVM_string_find_encoding(tc, enc_name);
+    });
+    graphs = MVM_string_graphs_nocheck(tc, s);
+
+    /* All of the encodings agree on what ASCII looks like, bar the width of
+     * the code units, so we can write it out ourselves. */
+    if (MVM_string_flags(tc, s) & MVM_STRING_FLAG_ALL_ASCII) {
+        switch (encoding_flag) {
+            case MVM_encoding_type_utf8:
+            case MVM_encoding_type_utf8_c8:
+            case MVM_encoding_type_ascii:
+            case MVM_encoding_type_latin1:
+            case MVM_encoding_type_windows1252:
+            case MVM_encoding_type_windows1251:
+            case MVM_encoding_type_shiftjis:
+            case MVM_encoding_type_gb2312:
+            case MVM_encoding_type_gb18030:
+                unit = 1;
+                break;
+            case MVM_encoding_type_utf16le:
+                unit = 2;
+                break;
+            case MVM_encoding_type_utf16be:
+                unit = 2;
+                low  = 1;
+                break;
+            case MVM_encoding_type_utf16:
+                unit = 2;
+#ifdef MVM_BIGENDIAN
+                low  = 1;
+#endif
+                break;
+        }
+    }
+    if (unit) {
+        MVMuint8 *out;
+        output_size = (MVMuint64)graphs * unit;
+        MVM_repr_pos_set_elems(tc, buf, offset + output_size);
+        out = body->slots.u8 + body->start + offset;
+        if (s->body.storage_type == MVM_STRING_STRAND) {
+            MVMuint16 i;
+            for (i = 0; i < s->body.num_strands; i++) {
+                MVMStringStrand *strand = &(s->body.storage.strands[i]);
+                MVMuint32        rep;
+                for (rep = 0; rep <= strand->repetitions; rep++)
+                    out = write_ascii_units(strand->blob_string, strand->start, strand->end,
+                        out, unit, low);
+            }
+        }
+        else {
+            write_ascii_units(s, 0, graphs, out, unit, low);
+        }
+        return output_size;
+    }
+
+    MVMROOT2(tc, buf, s, {
+        encoded = MVM_string_encode_config(tc, s, 0, graphs, &output_size,
+            encoding_flag, replacement, 0, config);
+    });
+    MVM_repr_pos_set_elems(tc, buf, offset + output_size);
+    memcpy(body->slots.u8 + body->start + offset, encoded, output_size);
+    MVM_free(encoded);
+    return output_size;
+}
 /* Decodes a string using the data from the specified Buf. Decodes "strict" by
  * default, but optionally can be "permissive". */
 MVMString * MVM_string_decode_from_buf_config(MVMThreadContext *tc, MVMObject *buf,
@@ -1862,10 +2416,19 @@ MVMObject * MVM_string_split(MVMThreadContext *tc, MVMString *separator, MVMStri
     MVMObject *result = NULL;
     MVMStringIndex start, end, sep_length;
     MVMHLLConfig *hll = MVM_hll_current(tc);
+    IndexNeedle sep_needle;
+    int direct;
 
     MVM_string_check_arg(tc, separator, "split separator");
     MVM_string_check_arg(tc, input, "split input");
 
+    /* When the input is flat and the separator lives in a single blob, we
+     * can go straight to the search kernels rather than through all of the
+     * dispatching in MVM_string_index for each field. */
+    direct = input->body.storage_type != MVM_STRING_STRAND
+        && MVM_string_graphs_nocheck(tc, separator)
+        && resolve_index_needle(tc, separator, &sep_needle);
+
     MVMROOT3(tc, input, separator, result, {
         result = MVM_repr_alloc_init(tc, hll->slurpy_array_type);
         start = 0;
@@ -1879,7 +2442,9 @@ MVMObject * MVM_string_split(MVMThreadContext *tc, MVMString *separator, MVMStri
 
             /* XXX make this use the dual-traverse iterator, but such that it
                 can reset the index of what it's comparing... <!> */
-            index = MVM_string_index(tc, input, separator, start);
+            index = direct
+                ? (MVMStringIndex)blob_index(input, start, end, &sep_needle, sep_length)
+                : (MVMStringIndex)MVM_string_index(tc, input, separator, start);
             length = sep_length ? (index == (MVMStringIndex)-1 ? end : index) - start : 1;
             if (0 < length || (sep_length && length == 0)) {
                 portion = MVM_string_substring(tc, input, start, length);
@@ -1916,10 +2481,14 @@ void copy_to_32bit (MVMThreadContext *tc, MVMString *source,
         }
         case MVM_STRING_GRAPHEME_ASCII:
         case MVM_STRING_GRAPHEME_8: {
-            MVMStringIndex sindex = 0;
-            while (sindex < source->body.num_graphs)
-                dest->body.storage.blob_32[(*position)++] =
-                    source->body.storage.blob_8[sindex++];
+            MVMGrapheme32  *to     = dest->body.storage.blob_32 + *position;
+            MVMGrapheme8   *from   = source->body.storage.blob_8;
+            MVMStringIndex  graphs = source->body.num_graphs;
+            MVMStringIndex  sindex;
+            MVM_VECTORIZE_LOOP
+            for (sindex = 0; sindex < graphs; sindex++)
+                to[sindex] = from[sindex];
+            *position += graphs;
             break;
         }
         default:
@@ -1982,12 +2551,44 @@ MVMString * MVM_string_ascii_from_buf_nocheck(MVMThreadContext *tc, MVMGrapheme8
     result->body.storage.blob_8 = buf;
     return result;
 }
+/* A join refers to its pieces as strands, rather than copying them, when
+ * there are few enough of them and they average at least this many
+ * graphemes. */
+#define MVM_JOIN_STRAND_MIN_GRAPHS 150
+
+/* Appends a piece of a join to a strand result, referring to the strands of
+ * the piece or, if it's flat, to the piece itself. */
+static void join_add_strands(MVMThreadContext *tc, MVMString *piece, MVMString *result, MVMuint16 *offset) {
+    if (piece->body.storage_type == MVM_STRING_STRAND) {
+        copy_strands(tc, piece, 0, result, *offset, piece->body.num_strands);
+        *offset += piece->body.num_strands;
+    }
+    else if (piece->body.num_graphs) {
+        MVMStringStrand *strand = &(result->body.storage.strands[(*offset)++]);
+        strand->blob_string = piece;
+        strand->start       = 0;
+        strand->end         = piece->body.num_graphs;
+        strand->repetitions = 0;
+    }
+}
+/* If the array to join is a native str VMArray, returns its slots, so the
+ * pieces can be read without a REPR call for each. Only valid until the
+ * next allocation, as the array may move. */
+static MVMString ** join_str_slots(MVMThreadContext *tc, MVMObject *array, MVMint64 is_str_array) {
+    if (is_str_array && REPR(array)->ID == MVM_REPR_ID_VMArray
+            && ((MVMArrayREPRData *)STABLE(array)->REPR_data)->slot_type == MVM_ARRAY_STR) {
+        MVMArrayBody *body = &((MVMArray *)array)->body;
+        return body->slots.s + body->start;
+    }
+    return NULL;
+}
 MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObject *input) {
     MVMString  *result = NULL;
     MVMString **pieces = NULL;
-    MVMint64    elems, num_pieces, sgraphs, i, is_str_array, total_graphs;
-    MVMuint16   sstrands, total_strands;
-    MVMint32    concats_stable = 1, all_strands;
+    MVMString **str_slots;
+    MVMint64    elems, num_pieces, sgraphs, i, is_str_array, total_graphs, total_strands;
+    MVMuint16   sstrands;
+    MVMint32    concats_stable = 1, all_strands, all_8bit;
     size_t      bytes;
 
     MVM_string_check_arg(tc, separator, "join separator");
@@ -2005,9 +2606,14 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
 
     /* If there's only one element to join, just return it. */
     if (elems == 1) {
-        MVMString *piece = join_get_str_from_pos(tc, input, 0, is_str_array);
-        if (piece)
-            return piece;
+        str_slots = join_str_slots(tc, input, is_str_array);
+        {
+            MVMString *piece = str_slots
+                ? str_slots[0]
+                : join_get_str_from_pos(tc, input, 0, is_str_array);
+            if (piece)
+                return piece;
+        }
     }
 
     /* Allocate result. */
@@ -2029,11 +2635,18 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
     num_pieces    = 0;
     total_graphs  = 0;
     total_strands = 0;
-    /* Is the separator a strand? */
+    /* Is the separator a strand? Is it in 8-bit storage? */
     all_strands = separator->body.storage_type == MVM_STRING_STRAND;
+    all_8bit    = !sgraphs || separator->body.storage_type == MVM_STRING_GRAPHEME_8
+        || separator->body.storage_type == MVM_STRING_GRAPHEME_ASCII;
+    /* Nothing in this pass allocates, so a native str array's slots can be
+     * read directly. */
+    str_slots = join_str_slots(tc, input, is_str_array);
     for (i = 0; i < elems; i++) {
         /* Get piece of the string. */
-        MVMString *piece = join_get_str_from_pos(tc, input, i, is_str_array);
+        MVMString *piece = str_slots
+            ? str_slots[i]
+            : join_get_str_from_pos(tc, input, i, is_str_array);
         MVMint64   piece_graphs;
         if (!piece)
             continue;
@@ -2051,6 +2664,9 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
         /* Add on the piece's strands and graphs. */
         piece_graphs = MVM_string_graphs(tc, piece);
         if (piece_graphs) {
+            if (all_8bit)
+                all_8bit = piece->body.storage_type == MVM_STRING_GRAPHEME_8
+                    || piece->body.storage_type == MVM_STRING_GRAPHEME_ASCII;
             total_strands += piece->body.storage_type == MVM_STRING_STRAND
                 ? piece->body.num_strands
                 : 1;
@@ -2062,8 +2678,11 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
     }
     /* This guards the joining by method of multiple concats, and will be faster
      * if we only end up with one piece after going through each element of the array */
-    if (num_pieces == 1)
-        return pieces[0];
+    if (num_pieces == 1) {
+        MVMString *piece = pieces[0];
+        MVM_fixed_size_free(tc, tc->instance->fsa, bytes, pieces);
+        return piece;
+    }
     /* We now know the total eventual number of graphemes. */
     if (total_graphs == 0) {
         MVM_fixed_size_free(tc, tc->instance->fsa, bytes, pieces);
@@ -2072,14 +2691,14 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
     result->body.num_graphs = total_graphs;
 
     MVMROOT2(tc, result, separator, {
-    /* If the separator and pieces are all strands, and there are
-     * on average at least 16 graphemes in each of the strands. */
-    if (all_strands && total_strands <  MVM_STRING_MAX_STRANDS
-              &&  total_strands * 16 <= total_graphs) {
+    /* If the separator and pieces are all strands, and there are on average
+     * at least 16 graphemes in each of the strands, or if the pieces are big
+     * enough that copying them costs more than referring to them. */
+    if (total_strands < MVM_STRING_MAX_STRANDS
+            && total_strands * (all_strands ? 16 : MVM_JOIN_STRAND_MIN_GRAPHS) <= total_graphs) {
         MVMuint16 offset = 0;
         result->body.storage_type    = MVM_STRING_STRAND;
         result->body.storage.strands = allocate_strands(tc, total_strands);
-        result->body.num_strands     = total_strands;
         for (i = 0; i < num_pieces; i++) {
             MVMString *piece = pieces[i];
             if (0 < i) {
@@ -2087,37 +2706,37 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
                 if (concats_stable)
                     join_check_stability(tc, piece, separator, pieces,
                         &concats_stable, num_pieces, sgraphs, i);
-                copy_strands(tc, separator, 0, result, offset, separator->body.num_strands);
-                offset += separator->body.num_strands;
+                if (sgraphs)
+                    join_add_strands(tc, separator, result, &offset);
             }
-            copy_strands(tc, piece, 0, result, offset, piece->body.num_strands);
-            offset += piece->body.num_strands;
-        }
-    }
-    /* Doing multiple concats is only faster if we have about 300 graphemes per
-       piece or if we have less than for pieces and more than 150 graphemes per piece */
-    else if (total_strands <  MVM_STRING_MAX_STRANDS && (300 < num_pieces/total_graphs || (num_pieces < 4 && 150 < num_pieces/total_graphs))) {
-        MVMString *result = NULL;
-        MVMROOT(tc, result, {
-            if (sgraphs) {
-                i = 0;
-                result = MVM_string_concatenate(tc, pieces[i++], separator);
-                result = MVM_string_concatenate(tc, result, pieces[i++]);
-                for (; i < num_pieces;) {
-                    result = MVM_string_concatenate(tc, result, separator);
-                    result = MVM_string_concatenate(tc, result, pieces[i++]);
+            join_add_strands(tc, piece, result, &offset);
+        }
+        /* An empty separator was counted as a strand, but didn't get one. */
+        result->body.num_strands = offset;
+    }
+    else if (all_8bit) {
+        /* Everything is in 8-bit storage, so we can produce an 8-bit flat
+         * string by just copying the blobs. */
+        MVMGrapheme8 *out      = MVM_malloc(total_graphs * sizeof(MVMGrapheme8));
+        MVMint64      position = 0;
+        result->body.storage_type    = MVM_STRING_GRAPHEME_8;
+        result->body.storage.blob_8  = out;
+        for (i = 0; i < num_pieces; i++) {
+            MVMString *piece = pieces[i];
+            if (0 < i) {
+                if (concats_stable)
+                    join_check_stability(tc, piece, separator, pieces,
+                        &concats_stable, num_pieces, sgraphs, i);
+                if (sgraphs) {
+                    memcpy(out + position, separator->body.storage.blob_8, sgraphs * sizeof(MVMGrapheme8));
+                    position += sgraphs;
                 }
-
             }
-            else {
-                result = MVM_string_concatenate(tc, pieces[0], pieces[1]);
-                i = 2;
-                for (; i < num_pieces;) {
-                    result = MVM_string_concatenate(tc, result, pieces[i++]);
-                }
+            if (piece->body.num_graphs) {
+                memcpy(out + position, piece->body.storage.blob_8, piece->body.num_graphs * sizeof(MVMGrapheme8));
+                position += piece->body.num_graphs;
             }
-        });
-        return result;
+        }
     }
     else {
         /* We'll produce a single, flat string. */
@@ -2142,6 +2761,7 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
             /* Add piece */
             copy_to_32bit(tc, piece, result, &position, &gi);
         }
+        MVM_string_narrow_to_8bit(tc, result);
     }
 
     MVM_fixed_size_free(tc, tc->instance->fsa, bytes, pieces);
@@ -2369,6 +2989,54 @@ MVMString * MVM_string_flip(MVMThreadContext *tc, MVMString *s) {
 
 /* Compares two strings, returning -1, 0 or 1 to indicate less than,
  * equal or greater than. */
+/* Find the first index below len at which two flat blobs differ, or len if
+ * they don't. Graphemes are compared a block at a time, in a way compilers
+ * can turn into wide compares, and only a differing block is searched one
+ * grapheme at a time. */
+#define MVM_COMPARE_BLOCK 16
+static MVMStringIndex first_mismatch_8_8(const MVMGrapheme8 *a, const MVMGrapheme8 *b, MVMStringIndex len) {
+    MVMStringIndex i = 0, j;
+    for (; i + MVM_COMPARE_BLOCK <= len; i += MVM_COMPARE_BLOCK) {
+        MVMuint8 diff = 0;
+        MVM_VECTORIZE_LOOP
+        for (j = 0; j < MVM_COMPARE_BLOCK; j++)
+            diff |= (MVMuint8)(a[i + j] ^ b[i + j]);
+        if (diff)
+            break;
+    }
+    while (i < len && a[i] == b[i])
+        i++;
+    return i;
+}
+static MVMStringIndex first_mismatch_32_32(const MVMGrapheme32 *a, const MVMGrapheme32 *b, MVMStringIndex len) {
+    MVMStringIndex i = 0, j;
+    for (; i + MVM_COMPARE_BLOCK <= len; i += MVM_COMPARE_BLOCK) {
+        MVMuint32 diff = 0;
+        MVM_VECTORIZE_LOOP
+        for (j = 0; j < MVM_COMPARE_BLOCK; j++)
+            diff |= (MVMuint32)(a[i + j] ^ b[i + j]);
+        if (diff)
+            break;
+    }
+    while (i < len && a[i] == b[i])
+        i++;
+    return i;
+}
+static MVMStringIndex first_mismatch_32_8(const MVMGrapheme32 *a, const MVMGrapheme8 *b, MVMStringIndex len) {
+    MVMStringIndex i = 0, j;
+    for (; i + MVM_COMPARE_BLOCK <= len; i += MVM_COMPARE_BLOCK) {
+        MVMuint32 diff = 0;
+        MVM_VECTORIZE_LOOP
+        for (j = 0; j < MVM_COMPARE_BLOCK; j++)
+            diff |= (MVMuint32)(a[i + j] ^ (MVMGrapheme32)b[i + j]);
+        if (diff)
+            break;
+    }
+    while (i < len && a[i] == b[i])
+        i++;
+    return i;
+}
+
 MVMint64 MVM_string_compare(MVMThreadContext *tc, MVMString *a, MVMString *b) {
     MVMStringIndex alen, blen, i = 0, scanlen;
     MVMGraphemeIter gi_a, gi_b;
@@ -2393,18 +3061,10 @@ MVMint64 MVM_string_compare(MVMThreadContext *tc, MVMString *a, MVMString *b) {
     }
     else if ((a->body.storage_type == MVM_STRING_GRAPHEME_8 || a->body.storage_type == MVM_STRING_GRAPHEME_ASCII)
           && (b->body.storage_type == MVM_STRING_GRAPHEME_8 || b->body.storage_type == MVM_STRING_GRAPHEME_ASCII)) {
-        MVMGrapheme8  *a_blob8 = a->body.storage.blob_8;
-        MVMGrapheme8  *b_blob8 = b->body.storage.blob_8;
-        while (i < scanlen && a_blob8[i] == b_blob8[i]) {
-            i++;
-        }
+        i = first_mismatch_8_8(a->body.storage.blob_8, b->body.storage.blob_8, scanlen);
     }
     else if (a->body.storage_type == MVM_STRING_GRAPHEME_32 && b->body.storage_type == MVM_STRING_GRAPHEME_32) {
-        MVMGrapheme32  *a_blob32 = a->body.storage.blob_32;
-        MVMGrapheme32  *b_blob32 = b->body.storage.blob_32;
-        while (i < scanlen && a_blob32[i] == b_blob32[i]) {
-            i++;
-        }
+        i = first_mismatch_32_32(a->body.storage.blob_32, b->body.storage.blob_32, scanlen);
     }
     else {
         MVMGrapheme32 *blob32 = NULL;
@@ -2433,9 +3093,7 @@ MVMint64 MVM_string_compare(MVMThreadContext *tc, MVMString *a, MVMString *b) {
                 MVM_exception_throw_adhoc(tc,
                     "String corruption in string compare. Unknown string type.");
         }
-        while (i < scanlen && blob32[i] == blob8[i]) {
-            i++;
-        }
+        i = first_mismatch_32_8(blob32, blob8, scanlen);
     }
     /* If one of the strings was a strand or we encountered a differing character
      * while scanning in the loops above. */
@@ -2890,11 +3548,81 @@ typedef union {
     MVMuint64 u64;
 } MVMJenHashGraphemeView;
 
+/* State for feeding graphemes to SipHash two at a time, as one 64 bit block,
+ * when they come in runs of any length; an odd grapheme at the end of a run
+ * is held back to pair with the first of the next. */
+typedef struct {
+    siphash   sh;
+    MVMuint32 pending;
+    MVMuint32 has_pending;
+} MVMGraphemeHasher;
+
+/* Feeds the graphemes in the given range of a flat string to the hasher. */
+static void hash_blob_range(MVMThreadContext *tc, MVMGraphemeHasher *gh, MVMString *blob,
+                            MVMStringIndex start, MVMStringIndex end) {
+    MVMJenHashGraphemeView gv;
+    MVMStringIndex i = start;
+    if (start == end)
+        return;
+    switch (blob->body.storage_type) {
+        case MVM_STRING_GRAPHEME_8:
+        case MVM_STRING_GRAPHEME_ASCII: {
+            const MVMGrapheme8 *g8 = blob->body.storage.blob_8;
+            if (gh->has_pending) {
+                gv.graphs[0] = gh->pending;
+                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g8[i++]);
+                siphashadd64bits(&gh->sh, gv.u64);
+                gh->has_pending = 0;
+            }
+            for (; i + 1 < end; i += 2) {
+                gv.graphs[0] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g8[i]);
+                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g8[i + 1]);
+                siphashadd64bits(&gh->sh, gv.u64);
+            }
+            if (i < end) {
+                gh->pending     = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g8[i]);
+                gh->has_pending = 1;
+            }
+            break;
+        }
+        case MVM_STRING_GRAPHEME_32: {
+            const MVMGrapheme32 *g32 = blob->body.storage.blob_32;
+            if (gh->has_pending) {
+                gv.graphs[0] = gh->pending;
+                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g32[i++]);
+                siphashadd64bits(&gh->sh, gv.u64);
+                gh->has_pending = 0;
+            }
+            for (; i + 1 < end; i += 2) {
+#if defined(MVM_HASH_FORCE_LITTLE_ENDIAN)
+                gv.graphs[0] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g32[i]);
+                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g32[i + 1]);
+#else
+                memcpy(gv.graphs, g32 + i, sizeof(gv.graphs));
+#endif
+                siphashadd64bits(&gh->sh, gv.u64);
+            }
+            if (i < end) {
+                gh->pending     = MVM_MAYBE_TO_LITTLE_ENDIAN_32(g32[i]);
+                gh->has_pending = 1;
+            }
+            break;
+        }
+        default:
+            MVM_exception_throw_adhoc(tc, "Unknown string storage type %d", blob->body.storage_type);
+    }
+}
+
 /* To force little endian representation on big endian machines, set
  * MVM_HASH_FORCE_LITTLE_ENDIAN in strings/siphash/csiphash.h
  * If this isn't set, MVM_MAYBE_TO_LITTLE_ENDIAN_32 does nothing (the default).
  * This would mainly be useful for debugging or if there were some other reason
- * someone cared that hashes were identical on different endian platforms */
+ * someone cared that hashes were identical on different endian platforms.
+ *
+ * Whatever the storage, the hash is that of the graphemes as a sequence of
+ * 32 bit integers, so equal strings always hash the same. Rather than going
+ * through the grapheme iterator, we feed each blob (or strand of one) to the
+ * hash in bulk. */
 MVMuint64 MVM_string_compute_hash_code(MVMThreadContext *tc, MVMString *s) {
 #if defined(MVM_HASH_FORCE_LITTLE_ENDIAN)
     const MVMuint64 key[2] = {
@@ -2906,52 +3634,35 @@ MVMuint64 MVM_string_compute_hash_code(MVMThreadContext *tc, MVMString *s) {
 #endif
     MVMuint64 hash = 0;
     MVMStringIndex s_len = MVM_string_graphs_nocheck(tc, s);
-    switch (s->body.storage_type) {
-        case MVM_STRING_GRAPHEME_8:
-        case MVM_STRING_GRAPHEME_ASCII: {
-            size_t i;
-            MVMJenHashGraphemeView gv;
-            siphash sh;
-            siphashinit(&sh, s_len * sizeof(MVMGrapheme32), key);
-            for (i = 0; i + 1 < s_len;) {
-                gv.graphs[0] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(s->body.storage.blob_8[i++]);
-                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(s->body.storage.blob_8[i++]);
-                siphashadd64bits(&sh, gv.u64);
-            }
-            /* If there is a final 32 bit grapheme pass it through, otherwise
-             * pass through 0. */
-            hash = siphashfinish_32bits(&sh,
-                i < s_len
-                    ? MVM_MAYBE_TO_LITTLE_ENDIAN_32(s->body.storage.blob_8[i]) : 0);
-            break;
-        }
 #if !defined(MVM_HASH_FORCE_LITTLE_ENDIAN)
-        case MVM_STRING_GRAPHEME_32: {
-            hash = siphash24(
-                (MVMuint8*)s->body.storage.blob_32,
-                s_len * sizeof(MVMGrapheme32),
-                key);
-            break;
-        }
+    if (s->body.storage_type == MVM_STRING_GRAPHEME_32) {
+        hash = siphash24(
+            (MVMuint8*)s->body.storage.blob_32,
+            s_len * sizeof(MVMGrapheme32),
+            key);
+    }
+    else
 #endif
-        default: {
-            siphash sh;
-            MVMGraphemeIter gi;
-            MVMJenHashGraphemeView gv;
-            size_t i;
-            siphashinit(&sh, s_len * sizeof(MVMGrapheme32), key);
-            MVM_string_gi_init(tc, &gi, s);
-            for (i = 0; i + 1 < s_len; i += 2) {
-                gv.graphs[0] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(MVM_string_gi_get_grapheme(tc, &gi));
-                gv.graphs[1] = MVM_MAYBE_TO_LITTLE_ENDIAN_32(MVM_string_gi_get_grapheme(tc, &gi));
-                siphashadd64bits(&sh, gv.u64);
+    {
+        MVMGraphemeHasher gh;
+        siphashinit(&gh.sh, s_len * sizeof(MVMGrapheme32), key);
+        gh.pending     = 0;
+        gh.has_pending = 0;
+        if (s->body.storage_type == MVM_STRING_STRAND) {
+            MVMuint16 i;
+            for (i = 0; i < s->body.num_strands; i++) {
+                MVMStringStrand *strand = &(s->body.storage.strands[i]);
+                MVMuint32 rep;
+                for (rep = 0; rep <= strand->repetitions; rep++)
+                    hash_blob_range(tc, &gh, strand->blob_string, strand->start, strand->end);
             }
-            hash = siphashfinish_32bits(&sh,
-                i < s_len
-                    ? MVM_MAYBE_TO_LITTLE_ENDIAN_32(MVM_string_gi_get_grapheme(tc, &gi))
-                    : 0);
-            break;
         }
+        else {
+            hash_blob_range(tc, &gh, s, 0, s_len);
+        }
+        /* If there is a final 32 bit grapheme pass it through, otherwise
+         * pass through 0. */
+        hash = siphashfinish_32bits(&gh.sh, gh.has_pending ? gh.pending : 0);
     }
     return s->body.cached_hash_code = hash;
 }
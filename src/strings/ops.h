@@ -76,6 +76,15 @@ MVM_STATIC_INLINE int MVM_string_buf32_can_fit_into_8bit(MVMGrapheme32 *active_b
     return val ? 0 : 1;
 }
 
+void MVM_string_narrow_to_8bit(MVMThreadContext *tc, MVMString *str);
+MVMString * MVM_string_renormalize(MVMThreadContext *tc, MVMString *s);
+MVMuint8 MVM_string_compute_flags(MVMThreadContext *tc, MVMString *s);
+MVM_STATIC_INLINE MVMuint8 MVM_string_flags(MVMThreadContext *tc, MVMString *s) {
+    return s->body.flags & MVM_STRING_FLAGS_COMPUTED
+        ? s->body.flags
+        : MVM_string_compute_flags(tc, s);
+}
+
 MVMuint64 MVM_string_compute_hash_code(MVMThreadContext *tc, MVMString *s);
 MVM_STATIC_INLINE MVMuint64 MVM_string_hash_code(MVMThreadContext *tc, MVMString *s) {
     return s->body.cached_hash_code ? s->body.cached_hash_code
@@ -114,6 +123,7 @@ MVMString * MVM_string_decode(MVMThreadContext *tc, const MVMObject *type_object
 char * MVM_string_encode(MVMThreadContext *tc, MVMString *s, MVMint64 start, MVMint64 length, MVMuint64 *output_size, MVMint64 encoding_flag, MVMString *replacement, MVMint32 translate_newlines);
 MVMObject * MVM_string_encode_to_buf(MVMThreadContext *tc, MVMString *s, MVMString *enc_name, MVMObject *buf, MVMString *replacement);
 MVMObject * MVM_string_encode_to_buf_config(MVMThreadContext *tc, MVMString *s, MVMString *enc_name, MVMObject *buf, MVMString *replacement, MVMint64 bitmap);
+MVMint64 MVM_string_encode_into_buf_config(MVMThreadContext *tc, MVMString *s, MVMString *enc_name, MVMObject *buf, MVMint64 offset, MVMString *replacement, MVMint64 config);
 MVMString * MVM_string_decode_from_buf(MVMThreadContext *tc, MVMObject *buf, MVMString *enc_name);
 MVMString * MVM_string_decode_from_buf_config(MVMThreadContext *tc, MVMObject *buf,
         MVMString *enc_name, MVMString *replacement, MVMint64 bitmap);
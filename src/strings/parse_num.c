@@ -312,3 +312,400 @@ MVMnum64 MVM_coerce_s_n(MVMThreadContext *tc, MVMString *s) {
 
     return n;
 }
+
+/* Bulk parsing of delimited numbers, as from a line of a CSV file, straight
+ * into a native array. The fields are scanned in place, eight digits at a
+ * time where they are 8-bit, and only fields that aren't plain decimals go
+ * through MVM_coerce_s_n on a string made for them. */
+
+#define FIELD_BUF_LEN 128
+
+/* Reads eight bytes as a little endian word, whatever the platform. */
+static MVMuint64 load8(const MVMuint8 *p) {
+    return  (MVMuint64)p[0]        | ((MVMuint64)p[1] << 8)
+         | ((MVMuint64)p[2] << 16) | ((MVMuint64)p[3] << 24)
+         | ((MVMuint64)p[4] << 32) | ((MVMuint64)p[5] << 40)
+         | ((MVMuint64)p[6] << 48) | ((MVMuint64)p[7] << 56);
+}
+
+/* Whether all eight bytes of a word are ASCII digits: adding 0x46 sets the
+ * high bit of any byte above '9', and subtracting 0x30 that of any below
+ * '0'. */
+static int all_digits8(MVMuint64 v) {
+    return (((v + UINT64_C(0x4646464646464646)) | (v - UINT64_C(0x3030303030303030)))
+        & UINT64_C(0x8080808080808080)) == 0;
+}
+
+/* The value of eight ASCII digits in a word, the first in the lowest byte,
+ * combining pairs, then quads, then the two halves by multiplication. */
+static MVMuint64 digits8_value(MVMuint64 v) {
+    v = ((v & UINT64_C(0x0F0F0F0F0F0F0F0F)) * 2561) >> 8;
+    v = ((v & UINT64_C(0x00FF00FF00FF00FF)) * 6553601) >> 16;
+    return ((v & UINT64_C(0x0000FFFF0000FFFF)) * UINT64_C(42949672960001)) >> 32;
+}
+
+static int is_ascii_space(MVMuint8 c) {
+    return c == ' ' || (c >= 9 && c <= 13);
+}
+
+static int is_digit(MVMuint8 c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Adds a run of digits to an accumulated value, up to a limit on how many
+ * digits it may hold in all. Returns how many were taken. */
+static MVMuint32 take_digits(const MVMuint8 **pp, const MVMuint8 *end, MVMuint64 *value,
+        MVMuint32 room) {
+    const MVMuint8 *p = *pp;
+    MVMuint32 taken = 0;
+    while (end - p >= 8 && room - taken >= 8) {
+        MVMuint64 v = load8(p);
+        if (!all_digits8(v))
+            break;
+        *value = *value * 100000000 + digits8_value(v);
+        p += 8;
+        taken += 8;
+    }
+    while (p < end && taken < room && is_digit(*p)) {
+        *value = *value * 10 + (*p - '0');
+        p++;
+        taken++;
+    }
+    *pp = p;
+    return taken;
+}
+
+/* Parses a plain decimal integer, with an optional sign. Returns zero if
+ * the field is anything else, or is out of range. */
+static int parse_field_i(const MVMuint8 *p, const MVMuint8 *end, MVMint64 *result) {
+    MVMuint64 value = 0;
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if (p == end)
+        return 0;
+    while (end - p > 1 && *p == '0')
+        p++;
+    /* Up to 19 digits always fit; a 20th may not. */
+    take_digits(&p, end, &value, 19);
+    if (p != end)
+        return 0;
+    if (negative) {
+        if (value > (MVMuint64)INT64_MAX + 1)
+            return 0;
+        *result = (MVMint64)(~value + 1);
+    }
+    else {
+        if (value > (MVMuint64)INT64_MAX)
+            return 0;
+        *result = (MVMint64)value;
+    }
+    return 1;
+}
+
+/* Parses a plain decimal number, with an optional sign, fraction and
+ * exponent. Those whose digits fit in a double's mantissa and whose exponent
+ * is small are exact as a single multiplication or division; others go to
+ * strtod. Returns zero if the field is anything else. */
+static int parse_field_n(const MVMuint8 *start, const MVMuint8 *end, MVMnum64 *result) {
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const MVMuint8 *p = start;
+    MVMuint64 mantissa = 0;
+    MVMint64  exponent = 0;
+    MVMuint32 digits = 0;
+    int negative = 0, has_digits = 0, exact = 1;
+
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    /* The integer part; leading zeros don't count towards the digits. */
+    while (p < end && *p == '0') {
+        p++;
+        has_digits = 1;
+    }
+    digits = take_digits(&p, end, &mantissa, 19);
+    if (digits) {
+        has_digits = 1;
+        while (p < end && is_digit(*p)) {
+            /* Too many to hold; only their count matters, unless they are
+             * not all zeros, in which case strtod does it. */
+            exact &= *p == '0';
+            exponent++;
+            p++;
+        }
+    }
+
+    /* The fraction. */
+    if (p < end && *p == '.') {
+        MVMuint32 frac;
+        p++;
+        if (p == end || !is_digit(*p))
+            return 0;
+        has_digits = 1;
+        if (!mantissa) {
+            while (p < end && *p == '0') {
+                exponent--;
+                p++;
+            }
+        }
+        frac = take_digits(&p, end, &mantissa, 19 - digits);
+        digits += frac;
+        exponent -= frac;
+        while (p < end && is_digit(*p)) {
+            exact &= *p == '0';
+            p++;
+        }
+    }
+    if (!has_digits)
+        return 0;
+
+    /* The exponent. */
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        MVMint64 e = 0;
+        int e_negative = 0;
+        p++;
+        if (p < end && (*p == '-' || *p == '+'))
+            e_negative = *p++ == '-';
+        if (p == end || !is_digit(*p))
+            return 0;
+        while (p < end && is_digit(*p)) {
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+            p++;
+        }
+        exponent += e_negative ? -e : e;
+    }
+    if (p != end)
+        return 0;
+
+    if (mantissa == 0) {
+        *result = negative ? -0.0 : 0.0;
+    }
+    else if (exact && mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22) {
+        MVMnum64 n = (MVMnum64)mantissa;
+        n = exponent < 0 ? n / pow10[-exponent] : n * pow10[exponent];
+        *result = negative ? -n : n;
+    }
+    else {
+        /* The syntax is a subset of strtod's, so it can take the field as it
+         * is, once terminated. */
+        char buf[FIELD_BUF_LEN + 1];
+        size_t len = end - start;
+        if (len <= FIELD_BUF_LEN) {
+            memcpy(buf, start, len);
+            buf[len] = '\0';
+            *result = strtod(buf, NULL);
+        }
+        else {
+            char *heap_buf = MVM_malloc(len + 1);
+            memcpy(heap_buf, start, len);
+            heap_buf[len] = '\0';
+            *result = strtod(heap_buf, NULL);
+            MVM_free(heap_buf);
+        }
+    }
+    return 1;
+}
+
+/* The source of the fields: either a flat string, whose graphemes are 8 or 32
+ * bits, or the bytes of a buffer. */
+typedef struct {
+    MVMString           *str;
+    const MVMuint8      *bytes;
+    const MVMGrapheme32 *g32;
+    MVMuint64            length;
+} NumSource;
+
+static MVMint64 find_delimiter(NumSource *src, MVMint64 from, MVMuint8 delimiter) {
+    if (src->bytes) {
+        const MVMuint8 *found = memchr(src->bytes + from, delimiter, src->length - from);
+        return found ? found - src->bytes : (MVMint64)src->length;
+    }
+    while ((MVMuint64)from < src->length && src->g32[from] != delimiter)
+        from++;
+    return from;
+}
+
+/* Gets a field as 8-bit characters, with any space around it trimmed. Those
+ * of 32-bit strings are narrowed into the buffer, with anything that isn't
+ * ASCII made 0x80, which no plain number contains; a field too long for the
+ * buffer is all 0x80. */
+static void field_bytes(NumSource *src, MVMint64 from, MVMint64 to, MVMuint8 *buf,
+        const MVMuint8 **start, const MVMuint8 **end) {
+    const MVMuint8 *s, *e;
+    if (src->bytes) {
+        s = src->bytes + from;
+        e = src->bytes + to;
+    }
+    else {
+        MVMint64 i;
+        while (from < to && src->g32[from] >= 0 && src->g32[from] < 128
+                && is_ascii_space((MVMuint8)src->g32[from]))
+            from++;
+        while (to > from && src->g32[to - 1] >= 0 && src->g32[to - 1] < 128
+                && is_ascii_space((MVMuint8)src->g32[to - 1]))
+            to--;
+        if (to - from > FIELD_BUF_LEN) {
+            buf[0] = 0x80;
+            *start = buf;
+            *end   = buf + 1;
+            return;
+        }
+        for (i = from; i < to; i++) {
+            MVMGrapheme32 g = src->g32[i];
+            buf[i - from] = g >= 0 && g < 128 ? (MVMuint8)g : 0x80;
+        }
+        s = buf;
+        e = buf + (to - from);
+    }
+    while (s < e && is_ascii_space(*s))
+        s++;
+    while (e > s && is_ascii_space(e[-1]))
+        e--;
+    *start = s;
+    *end   = e;
+}
+
+/* Makes a string of a field, for the error message or the full parser. */
+static MVMString * field_string(MVMThreadContext *tc, NumSource *src, MVMint64 from, MVMint64 to) {
+    if (src->str)
+        return MVM_string_substring(tc, src->str, from, to - from);
+    return MVM_string_utf8_c8_decode(tc, tc->instance->VMString,
+        (const char *)src->bytes + from, to - from);
+}
+
+static MVMint64 parse_nums(MVMThreadContext *tc, MVMObject *target, NumSource *src,
+        MVMString *delimiter_str) {
+    MVMArrayREPRData *repr_data;
+    MVMArrayBody     *body;
+    MVMuint8          delimiter;
+    MVMuint8          slot_type;
+    int               want_num;
+    MVMint64          num_fields, field, pos, old_elems;
+
+    if (REPR(target)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(target))
+        MVM_exception_throw_adhoc(tc, "parsenums target must be a concrete array (got %s)",
+            MVM_6model_get_debug_name(tc, target));
+    repr_data = (MVMArrayREPRData *)STABLE(target)->REPR_data;
+    slot_type = repr_data->slot_type;
+    switch (slot_type) {
+        case MVM_ARRAY_N64: case MVM_ARRAY_N32:
+            want_num = 1;
+            break;
+        case MVM_ARRAY_I64: case MVM_ARRAY_I32: case MVM_ARRAY_I16: case MVM_ARRAY_I8:
+        case MVM_ARRAY_U64: case MVM_ARRAY_U32: case MVM_ARRAY_U16: case MVM_ARRAY_U8:
+        case MVM_ARRAY_I4: case MVM_ARRAY_I2: case MVM_ARRAY_I1:
+        case MVM_ARRAY_U4: case MVM_ARRAY_U2: case MVM_ARRAY_U1:
+            want_num = 0;
+            break;
+        default:
+            MVM_exception_throw_adhoc(tc, "parsenums target must be a native int or num array");
+    }
+    MVM_string_check_arg(tc, delimiter_str, "parsenums");
+    if (MVM_string_graphs_nocheck(tc, delimiter_str) != 1
+            || MVM_string_get_grapheme_at_nocheck(tc, delimiter_str, 0) < 0
+            || MVM_string_get_grapheme_at_nocheck(tc, delimiter_str, 0) >= 128)
+        MVM_exception_throw_adhoc(tc, "parsenums delimiter must be a single ASCII character");
+    delimiter = (MVMuint8)MVM_string_get_grapheme_at_nocheck(tc, delimiter_str, 0);
+    if (src->length == 0)
+        return 0;
+
+    /* Count the fields, so the array is only grown once. */
+    num_fields = 1;
+    pos = 0;
+    while ((pos = find_delimiter(src, pos, delimiter)) < (MVMint64)src->length) {
+        num_fields++;
+        pos++;
+    }
+    old_elems = MVM_repr_elems(tc, target);
+    REPR(target)->pos_funcs.set_elems(tc, STABLE(target), target, OBJECT_BODY(target),
+        old_elems + num_fields);
+
+    /* Parse them. Only making a string for a field may GC, after which the
+     * array must be looked up again. */
+    pos = 0;
+    for (field = 0; field < num_fields; field++) {
+        MVMint64 to = find_delimiter(src, pos, delimiter);
+        MVMuint8 buf[FIELD_BUF_LEN];
+        const MVMuint8 *start, *end;
+        MVMRegister value;
+        MVMint64 index = old_elems + field;
+        field_bytes(src, pos, to, buf, &start, &end);
+        if (want_num) {
+            if (start == end)
+                value.n64 = 0.0;
+            else if (!parse_field_n(start, end, &value.n64)) {
+                MVMString *s;
+                MVMROOT(tc, target, {
+                    s = field_string(tc, src, pos, to);
+                    value.n64 = MVM_coerce_s_n(tc, s);
+                });
+            }
+        }
+        else {
+            if (start == end)
+                value.i64 = 0;
+            else if (!parse_field_i(start, end, &value.i64)) {
+                char *got = MVM_string_utf8_encode_C_string(tc, field_string(tc, src, pos, to));
+                char *waste[] = { got, NULL };
+                MVM_exception_throw_adhoc_free(tc, waste,
+                    "Can't convert '%s' to int: not a decimal integer in range", got);
+            }
+        }
+        body = &((MVMArray *)target)->body;
+        if (slot_type == MVM_ARRAY_I64)
+            body->slots.i64[body->start + index] = value.i64;
+        else if (slot_type == MVM_ARRAY_N64)
+            body->slots.n64[body->start + index] = value.n64;
+        else
+            REPR(target)->pos_funcs.bind_pos(tc, STABLE(target), target, body, index,
+                value, want_num ? MVM_reg_num64 : MVM_reg_int64);
+        pos = to + 1;
+    }
+    return num_fields;
+}
+
+MVMint64 MVM_parse_nums_str(MVMThreadContext *tc, MVMObject *target, MVMString *source,
+        MVMString *delimiter) {
+    NumSource src;
+    MVM_string_check_arg(tc, source, "parsenums");
+    MVMROOT2(tc, target, delimiter, {
+        source = MVM_string_indexing_optimized(tc, source);
+    });
+    src.str    = source;
+    src.length = MVM_string_graphs_nocheck(tc, source);
+    if (source->body.storage_type == MVM_STRING_GRAPHEME_32) {
+        src.bytes = NULL;
+        src.g32   = source->body.storage.blob_32;
+    }
+    else {
+        src.bytes = (const MVMuint8 *)source->body.storage.blob_8;
+        src.g32   = NULL;
+    }
+    {
+        MVMint64 result;
+        MVMROOT(tc, src.str, {
+            result = parse_nums(tc, target, &src, delimiter);
+        });
+        return result;
+    }
+}
+
+MVMint64 MVM_parse_nums_buf(MVMThreadContext *tc, MVMObject *target, MVMObject *buf,
+        MVMString *delimiter) {
+    NumSource src;
+    MVMArrayREPRData *repr_data;
+    if (REPR(buf)->ID != MVM_REPR_ID_VMArray || !IS_CONCRETE(buf))
+        MVM_exception_throw_adhoc(tc, "parsenumsbuf requires a concrete buffer");
+    repr_data = (MVMArrayREPRData *)STABLE(buf)->REPR_data;
+    if (repr_data->slot_type != MVM_ARRAY_U8 && repr_data->slot_type != MVM_ARRAY_I8)
+        MVM_exception_throw_adhoc(tc, "parsenumsbuf requires a buffer of 8-bit elements");
+    src.str    = NULL;
+    src.bytes  = ((MVMArray *)buf)->body.slots.u8 + ((MVMArray *)buf)->body.start;
+    src.g32    = NULL;
+    src.length = ((MVMArray *)buf)->body.elems;
+    return parse_nums(tc, target, &src, delimiter);
+}
@@ -1 +1,5 @@
 MVMnum64 MVM_coerce_s_n(MVMThreadContext *tc, MVMString *s);
+MVMint64 MVM_parse_nums_str(MVMThreadContext *tc, MVMObject *target, MVMString *source,
+    MVMString *delimiter);
+MVMint64 MVM_parse_nums_buf(MVMThreadContext *tc, MVMObject *target, MVMObject *buf,
+    MVMString *delimiter);
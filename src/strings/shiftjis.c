@@ -12,9 +12,39 @@ static MVMint16 shift_jis_index_to_cp_array_offset (MVMThreadContext *tc, MVMint
     }
     return index - offset;
 }
+
+/* Direct lookup tables, built from the generated ones the first time they are
+ * needed, so that neither direction has to search: the codepoint for each
+ * pointer, and one more than the pointer for each codepoint in the BMP, with
+ * 0 meaning there is none in both. They are never changed once built, so are
+ * read without locking. */
+static MVMuint16 index_to_cp_table[SHIFTJIS_MAX_INDEX + 1];
+static MVMuint16 cp_to_index_table[0x10000];
+static uv_once_t tables_built = UV_ONCE_INIT;
+static void build_tables(void) {
+    MVMint32 i;
+    for (i = 0; i <= SHIFTJIS_MAX_INDEX; i++) {
+        MVMint16 offset = shift_jis_index_to_cp_array_offset(NULL, i);
+        if (offset != SHIFTJIS_NULL)
+            index_to_cp_table[i] = shiftjis_index_to_cp_codepoints[offset];
+    }
+    for (i = 0; i < 0x10000; i++) {
+        MVMint16 index = shift_jis_cp_to_index(NULL, i);
+        if (index != SHIFTJIS_NULL)
+            cp_to_index_table[i] = index + 1;
+    }
+}
+static void ensure_tables(void) {
+    uv_once(&tables_built, build_tables);
+}
 static MVMGrapheme32 shift_jis_index_to_cp (MVMThreadContext *tc, MVMint16 index) {
-    MVMint16 offset = shift_jis_index_to_cp_array_offset(tc, index);
-    return offset == SHIFTJIS_NULL ? SHIFTJIS_NULL : shiftjis_index_to_cp_codepoints[offset];
+    MVMuint16 codepoint = 0 <= index && index <= SHIFTJIS_MAX_INDEX ? index_to_cp_table[index] : 0;
+    return codepoint ? codepoint : SHIFTJIS_NULL;
+}
+static MVMint16 shift_jis_cp_to_index_fast (MVMThreadContext *tc, MVMGrapheme32 codepoint) {
+    return 0 <= codepoint && codepoint < 0x10000
+        ? (MVMint16)cp_to_index_table[codepoint] - 1
+        : SHIFTJIS_NULL;
 }
 /* Encodes the specified substring to ShiftJIS as specified here:
  * https://encoding.spec.whatwg.org/#shift_jis-decoder
@@ -30,6 +60,8 @@ char * MVM_string_shiftjis_encode_substr(MVMThreadContext *tc, MVMString *str,
     MVMuint8 *repl_bytes = NULL;
     MVMuint64 repl_length;
 
+    ensure_tables();
+
     /* must check start first since it's used in the length check */
     if (start < 0 || start > strgraphs)
         MVM_exception_throw_adhoc(tc, "start (%"PRId64") out of range (0..%"PRIu32")", start, strgraphs);
@@ -85,7 +117,7 @@ char * MVM_string_shiftjis_encode_substr(MVMThreadContext *tc, MVMString *str,
                     codepoint = 0xFF0D;
                 }
                 /* Let pointer be the index Shift_JIS pointer for code point. */
-                pointer = shift_jis_cp_to_index(tc, codepoint);
+                pointer = shift_jis_cp_to_index_fast(tc, codepoint);
                 /* If pointer is null, return error with code point. */
                 if (pointer == SHIFTJIS_NULL) {
                     if (replacement) {
@@ -220,6 +252,7 @@ MVMString * MVM_string_shiftjis_decode(MVMThreadContext *tc,
     /* TODO allocate less? */
     MVMGrapheme32 *buffer = MVM_malloc(sizeof(MVMGrapheme32) * result_size);
 
+    ensure_tables();
     result_graphs = 0;
     while (pos < num_bytes || repl_pos) {
         MVMGrapheme32 graph;
@@ -337,6 +370,7 @@ MVMuint32 MVM_string_shiftjis_decodestream(MVMThreadContext *tc, MVMDecodeStream
     if (stopper_chars && *stopper_chars == 0)
         return 1;
 
+    ensure_tables();
     bufsize = ds->result_size_guess;
     buffer  = MVM_malloc(bufsize * sizeof(MVMGrapheme32));
 
@@ -98,12 +98,31 @@ typedef struct siphash siphash;
     d = ROTATE(d, t) ^ c;       \
     a = ROTATE(a, 32);
 
-#define DOUBLE_ROUND(v0,v1,v2,v3)  \
-    HALF_ROUND(v0,v1,v2,v3,13,16); \
-    HALF_ROUND(v2,v1,v0,v3,17,21); \
+#define SIP_ROUND(v0,v1,v2,v3)     \
     HALF_ROUND(v0,v1,v2,v3,13,16); \
     HALF_ROUND(v2,v1,v0,v3,17,21);
 
+#define DOUBLE_ROUND(v0,v1,v2,v3)  \
+    SIP_ROUND(v0,v1,v2,v3);        \
+    SIP_ROUND(v0,v1,v2,v3);
+
+/* By default we use SipHash-2-4. Defining MVM_HASH_SIPHASH_1_3 (Configure.pl
+ * --fast-hash) selects SipHash-1-3 instead, which does half the work per
+ * block; it is still keyed, but has a smaller security margin against
+ * collision attacks, so it is for deployments that can accept that. */
+#if defined(MVM_HASH_SIPHASH_1_3)
+#  define COMPRESS_ROUNDS(v0,v1,v2,v3) SIP_ROUND(v0,v1,v2,v3)
+#  define FINALIZE_ROUNDS(v0,v1,v2,v3) \
+    SIP_ROUND(v0,v1,v2,v3);            \
+    SIP_ROUND(v0,v1,v2,v3);            \
+    SIP_ROUND(v0,v1,v2,v3);
+#else
+#  define COMPRESS_ROUNDS(v0,v1,v2,v3) DOUBLE_ROUND(v0,v1,v2,v3)
+#  define FINALIZE_ROUNDS(v0,v1,v2,v3) \
+    DOUBLE_ROUND(v0,v1,v2,v3);         \
+    DOUBLE_ROUND(v0,v1,v2,v3);
+#endif
+
 MVM_STATIC_INLINE void siphashinit (siphash *sh, size_t src_sz, const uint64_t key[2]) {
     const uint64_t k0 = MVM_MAYBE_TO_LITTLE_ENDIAN_64(key[0]);
     const uint64_t k1 = MVM_MAYBE_TO_LITTLE_ENDIAN_64(key[1]);
@@ -116,17 +135,16 @@ MVM_STATIC_INLINE void siphashinit (siphash *sh, size_t src_sz, const uint64_t k
 MVM_STATIC_INLINE void siphashadd64bits (siphash *sh, const uint64_t in) {
     const uint64_t mi = MVM_MAYBE_TO_LITTLE_ENDIAN_64(in);
     sh->v3 ^= mi;
-    DOUBLE_ROUND(sh->v0,sh->v1,sh->v2,sh->v3);
+    COMPRESS_ROUNDS(sh->v0,sh->v1,sh->v2,sh->v3);
     sh->v0 ^= mi;
 }
 MVM_STATIC_INLINE uint64_t siphashfinish_last_part (siphash *sh, uint64_t t) {
     sh->b |= MVM_MAYBE_TO_LITTLE_ENDIAN_64(t);
     sh->v3 ^= sh->b;
-    DOUBLE_ROUND(sh->v0,sh->v1,sh->v2,sh->v3);
+    COMPRESS_ROUNDS(sh->v0,sh->v1,sh->v2,sh->v3);
     sh->v0 ^= sh->b;
     sh->v2 ^= 0xff;
-    DOUBLE_ROUND(sh->v0,sh->v1,sh->v2,sh->v3);
-    DOUBLE_ROUND(sh->v0,sh->v1,sh->v2,sh->v3);
+    FINALIZE_ROUNDS(sh->v0,sh->v1,sh->v2,sh->v3);
     return (sh->v0 ^ sh->v1) ^ (sh->v2 ^ sh->v3);
 }
 /* This union helps us avoid doing weird things with pointers that can cause old
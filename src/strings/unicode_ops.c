@@ -1,3 +1,4 @@
+#include "platform/sys.h"
 /* Compares two strings, using the Unicode Collation Algorithm
  * Return values:
  *    0   The strings are identical for the collation levels requested
@@ -671,12 +672,319 @@ MVMint64 MVM_unicode_string_compare(MVMThreadContext *tc, MVMString *a, MVMStrin
     return collation_return_by_quaternary(tc, &level_eval_settings, alen, blen, compare_by_cp_rtrn);
 }
 
+/* Sort keys. MVM_unicode_string_compare walks the collation elements of two
+ * strings side by side, anew for every comparison. For sorting many strings
+ * it is much cheaper to turn each into a binary sort key once, such that
+ * comparing two keys with memcmp orders them as the comparison would. Each
+ * string's comparison sequence is its non-ignorable primary values, then a
+ * level separator, then the same for the secondary and tertiary levels. An
+ * element is written as a class byte (3, 2 and 1 for the three levels),
+ * which orders elements of different levels as their values do, followed by
+ * the value, complemented if the level is reversed. A separator sorts below
+ * the values of its level, or above them if the level is reversed, and on
+ * a disabled level only the number of elements is kept, as only that can
+ * have an effect. After this come the codepoints and grapheme count that the
+ * quaternary level breaks ties with. That only differs from the comparison
+ * for a string and a longer one that starts with all of its codepoints but
+ * has no more graphemes (such as "\r" and "\r\n"), which the comparison
+ * calls equal and the keys order shorter first; and for the empty string,
+ * which sorts first if the quaternary level is disabled, rather than comparing
+ * equal to everything. */
+struct collation_key_buf {
+    MVMuint8 *bytes;
+    size_t    used;
+    size_t    alloc;
+};
+typedef struct collation_key_buf collation_key_buf;
+static void key_bytes(collation_key_buf *kb, MVMuint32 value, int num_bytes) {
+    if (kb->alloc < kb->used + num_bytes) {
+        kb->alloc = (kb->alloc + num_bytes) * 2;
+        kb->bytes = MVM_realloc(kb->bytes, kb->alloc);
+    }
+    while (num_bytes--)
+        kb->bytes[kb->used++] = (MVMuint8)(value >> (8 * num_bytes));
+}
+/* Gets the direction of a level from the collation mode: 1 for normal, -1 for
+ * reversed, 0 if disabled (which setting both bits also amounts to). */
+static int collation_level_direction(MVMint64 collation_mode, int level) {
+    MVMint64 positive = collation_mode & (1 << (2 * level));
+    MVMint64 negative = collation_mode & (2 << (2 * level));
+    return positive && !negative ? 1 : negative && !positive ? -1 : 0;
+}
+static void collation_key_level(collation_key_buf *kb, collation_stack *stack, int level, int direction) {
+    static const int widths[3] = { 3, 2, 1 };
+    MVMuint32 cls   = 3 - level;
+    int       width = widths[level];
+    MVMuint32 mask  = (1 << (8 * width)) - 1;
+    MVMint64  i;
+    /* Once both strings are on the tertiary level and it is disabled, they
+     * tie, so we only mark getting there. */
+    if (direction == 0 && level == 2) {
+        key_bytes(kb, cls, 1);
+        return;
+    }
+    for (i = 0; i <= stack->stack_top; i++) {
+        MVMuint32 value = stack->keys[i].a[level];
+        if (value == collation_zero)
+            continue;
+        key_bytes(kb, cls, 1);
+        if (direction)
+            key_bytes(kb, direction > 0 ? value : mask & ~value, width);
+    }
+    if (direction > 0) {
+        key_bytes(kb, 0, 1);
+    }
+    else {
+        key_bytes(kb, cls, 1);
+        if (direction < 0)
+            key_bytes(kb, mask, width);
+    }
+}
+static void collation_key_to_buf(MVMThreadContext *tc, collation_key_buf *kb, MVMString *s,
+        MVMStringIndex graphs, MVMint64 collation_mode) {
+    int             direction = collation_level_direction(collation_mode, 3);
+    MVMCodepointIter ci;
+    kb->bytes = NULL;
+    kb->used  = kb->alloc = 0;
+    if (graphs == 0) {
+        if (direction < 0)
+            key_bytes(kb, 0xFF, 1);
+        return;
+    }
+    {
+        collation_stack stack;
+        int level;
+        init_stack(tc, &stack);
+        MVM_string_ci_init(tc, &ci, s, 0, 0);
+        while (grab_from_stack(tc, &ci, &stack, "s"))
+            ;
+        for (level = 0; level < 3; level++)
+            collation_key_level(kb, &stack, level, collation_level_direction(collation_mode, level));
+        cleanup_stack(tc, &stack);
+    }
+    if (direction) {
+        MVMuint32 flip = direction < 0 ? 0xFFFFFFFF : 0;
+        MVM_string_ci_init(tc, &ci, s, 0, 0);
+        while (MVM_string_ci_has_more(tc, &ci))
+            key_bytes(kb, (MVM_string_ci_get_codepoint(tc, &ci) + 1) ^ flip, 3);
+        key_bytes(kb, flip, 3);
+        key_bytes(kb, graphs ^ flip, 4);
+    }
+}
+
+/* Appends the sort key of the string under the given collation mode to the
+ * buffer, which must be a native array of 8-bit integers. */
+MVMObject * MVM_unicode_string_collation_key(MVMThreadContext *tc, MVMString *s, MVMint64 collation_mode, MVMObject *buf) {
+    MVMArrayREPRData *buf_rd;
+    collation_key_buf kb;
+    MVM_string_check_arg(tc, s, "unicollkey");
+    if (!IS_CONCRETE(buf) || REPR(buf)->ID != MVM_REPR_ID_VMArray)
+        MVM_exception_throw_adhoc(tc, "unicollkey requires a native array to write into");
+    buf_rd = (MVMArrayREPRData *)STABLE(buf)->REPR_data;
+    if (!buf_rd || (buf_rd->slot_type != MVM_ARRAY_U8 && buf_rd->slot_type != MVM_ARRAY_I8))
+        MVM_exception_throw_adhoc(tc, "unicollkey requires a native array of 8-bit integers");
+    collation_key_to_buf(tc, &kb, s, MVM_string_graphs_nocheck(tc, s), collation_mode);
+    if (kb.used) {
+        MVMuint64 prev_elems = ((MVMArray *)buf)->body.elems;
+        MVM_repr_pos_set_elems(tc, buf, prev_elems + kb.used);
+        memcpy(((MVMArray *)buf)->body.slots.u8 + ((MVMArray *)buf)->body.start + prev_elems,
+            kb.bytes, kb.used);
+    }
+    MVM_free(kb.bytes);
+    return buf;
+}
+
+/* Sorts an array of strings by collation, returning an integer array of
+ * their indexes in sorted order; strings that compare equal keep their
+ * relative order. Sort keys are computed up front, split over the number of
+ * threads asked for (or one per CPU core if that's 0). The workers must not
+ * touch anything the GC manages, allocate from it or throw, so we first copy
+ * the codepoints of each string out to malloc'd memory, and they make their
+ * keys from those. That lets us be marked blocked while they run. A worker
+ * that finds something it can't make a key of notes it in its status, which
+ * is checked once they are all done. */
+struct collation_sort_item {
+    MVMuint8      *key;
+    size_t         key_length;
+    MVMint64       index;
+    MVMCodepoint  *cps;
+    MVMStringIndex num_cps;
+    MVMStringIndex graphs;
+};
+typedef struct collation_sort_item collation_sort_item;
+struct collation_sort_job {
+    MVMThreadContext    *tc;
+    collation_sort_item *items;
+    MVMint64             from, to, collation_mode;
+    /* 0 if all went well, or one more than the index of the string that
+     * has an invalid codepoint. */
+    MVMint64             status;
+};
+typedef struct collation_sort_job collation_sort_job;
+static void collation_sort_keys(void *arg) {
+    collation_sort_job *job = (collation_sort_job *)arg;
+    MVMint64 i;
+    job->status = 0;
+    for (i = job->from; i < job->to; i++) {
+        collation_sort_item *item = &(job->items[i]);
+        collation_key_buf    kb;
+        MVMString            flat;
+        MVMStringIndex       j;
+        for (j = 0; j < item->num_cps; j++) {
+            if (item->cps[j] < 0 || item->cps[j] > 0x10FFFF) {
+                job->status = i + 1;
+                return;
+            }
+        }
+        /* A string that lives only here, made of the codepoints, so the
+         * iterators read nothing but them. */
+        memset(&flat, 0, sizeof(MVMString));
+        flat.body.storage_type    = MVM_STRING_GRAPHEME_32;
+        flat.body.storage.blob_32 = item->cps;
+        flat.body.num_graphs      = item->num_cps;
+        collation_key_to_buf(job->tc, &kb, &flat, item->graphs, job->collation_mode);
+        item->key        = kb.bytes;
+        item->key_length = kb.used;
+    }
+}
+static int collation_sort_cmp(const void *a_v, const void *b_v) {
+    const collation_sort_item *a = (const collation_sort_item *)a_v;
+    const collation_sort_item *b = (const collation_sort_item *)b_v;
+    size_t common = a->key_length < b->key_length ? a->key_length : b->key_length;
+    int    rtrn   = common ? memcmp(a->key, b->key, common) : 0;
+    if (rtrn)
+        return rtrn;
+    if (a->key_length != b->key_length)
+        return a->key_length < b->key_length ? -1 : 1;
+    return a->index < b->index ? -1 : a->index > b->index ? 1 : 0;
+}
+#define collation_sort_min_per_thread 1024
+MVMObject * MVM_unicode_string_sort(MVMThreadContext *tc, MVMObject *strings, MVMint64 collation_mode, MVMint64 num_threads) {
+    collation_sort_item *items;
+    collation_sort_job  *jobs;
+    MVMObject           *result;
+    MVMint64             elems, i, status = 0;
+    if (!IS_CONCRETE(strings) || REPR(strings)->ID != MVM_REPR_ID_VMArray
+            || !STABLE(strings)->REPR_data
+            || ((MVMArrayREPRData *)STABLE(strings)->REPR_data)->slot_type != MVM_ARRAY_STR)
+        MVM_exception_throw_adhoc(tc, "unisort requires a native array of strings");
+    elems = MVM_repr_elems(tc, strings);
+    for (i = 0; i < elems; i++)
+        MVM_string_check_arg(tc, ((MVMArray *)strings)->body.slots.s[((MVMArray *)strings)->body.start + i], "unisort");
+
+    MVMROOT(tc, strings, {
+        result = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIntArray);
+    });
+    if (elems == 0)
+        return result;
+
+    /* Compute the sort keys. */
+    if (num_threads <= 0)
+        num_threads = MVM_platform_cpu_count();
+    if (num_threads > elems / collation_sort_min_per_thread)
+        num_threads = elems / collation_sort_min_per_thread;
+    if (num_threads < 1)
+        num_threads = 1;
+    items = MVM_calloc(elems, sizeof(collation_sort_item));
+    for (i = 0; i < elems; i++) {
+        MVMString       *s     = ((MVMArray *)strings)->body.slots.s[((MVMArray *)strings)->body.start + i];
+        MVMStringIndex   alloc = MVM_string_graphs_nocheck(tc, s);
+        MVMCodepointIter ci;
+        items[i].index  = i;
+        items[i].graphs = alloc;
+        items[i].cps    = MVM_malloc((alloc ? alloc : 1) * sizeof(MVMCodepoint));
+        MVM_string_ci_init(tc, &ci, s, 0, 0);
+        while (MVM_string_ci_has_more(tc, &ci)) {
+            if (items[i].num_cps == alloc) {
+                alloc *= 2;
+                items[i].cps = MVM_realloc(items[i].cps, alloc * sizeof(MVMCodepoint));
+            }
+            items[i].cps[items[i].num_cps++] = MVM_string_ci_get_codepoint(tc, &ci);
+        }
+    }
+    jobs  = MVM_malloc(num_threads * sizeof(collation_sort_job));
+    for (i = 0; i < num_threads; i++) {
+        jobs[i].tc             = tc;
+        jobs[i].items          = items;
+        jobs[i].from           = elems * i / num_threads;
+        jobs[i].to             = elems * (i + 1) / num_threads;
+        jobs[i].collation_mode = collation_mode;
+    }
+    if (num_threads == 1) {
+        collation_sort_keys(&jobs[0]);
+    }
+    else {
+        uv_thread_t *threads = MVM_malloc((num_threads - 1) * sizeof(uv_thread_t));
+        MVMint64     started = 0;
+        MVM_gc_mark_thread_blocked(tc);
+        while (started < num_threads - 1 && uv_thread_create(&threads[started],
+                collation_sort_keys, &jobs[started + 1]) == 0)
+            started++;
+        collation_sort_keys(&jobs[0]);
+        /* Do any jobs we failed to start a thread for ourselves. */
+        for (i = started + 1; i < num_threads; i++)
+            collation_sort_keys(&jobs[i]);
+        for (i = 0; i < started; i++)
+            uv_thread_join(&threads[i]);
+        MVM_gc_mark_thread_unblocked(tc);
+        MVM_free(threads);
+    }
+    for (i = 0; i < num_threads; i++)
+        if (jobs[i].status && (!status || jobs[i].status < status))
+            status = jobs[i].status;
+    MVM_free(jobs);
+    for (i = 0; i < elems; i++)
+        MVM_free(items[i].cps);
+    if (status) {
+        for (i = 0; i < elems; i++)
+            MVM_free(items[i].key);
+        MVM_free(items);
+        MVM_exception_throw_adhoc(tc, "unisort found an invalid codepoint in the string at index %"PRId64, status - 1);
+    }
+
+    /* Sort on them, and produce the result. */
+    qsort(items, elems, sizeof(collation_sort_item), collation_sort_cmp);
+    MVM_repr_pos_set_elems(tc, result, elems);
+    for (i = 0; i < elems; i++) {
+        ((MVMArray *)result)->body.slots.i64[i] = items[i].index;
+        MVM_free(items[i].key);
+    }
+    MVM_free(items);
+    return result;
+}
+
+/* The hashes for looking things up by name are only built when first needed,
+ * so that creating an instance does no work on them. Several threads may
+ * want one at once, so building is done under a mutex, and a hash is only
+ * flagged ready once it's complete. */
+static uv_mutex_t property_hash_count_mutex;
+static int property_hash_count = 0;
+static uv_once_t property_hash_count_guard = UV_ONCE_INIT;
+
+static void setup_property_mutex(void)
+{
+    uv_mutex_init(&property_hash_count_mutex);
+}
+
+static void ensure_lookup_hash(MVMThreadContext *tc, AO_t *ready, void (*generate)(MVMThreadContext *tc)) {
+    if (MVM_UNLIKELY(!MVM_load(ready))) {
+        uv_mutex_lock(&property_hash_count_mutex);
+        if (!MVM_load(ready)) {
+            generate(tc);
+            MVM_store(ready, 1);
+        }
+        uv_mutex_unlock(&property_hash_count_mutex);
+    }
+}
+static AO_t codepoints_by_name_ready;
+static AO_t property_codes_by_names_aliases_ready;
+static AO_t property_codes_by_seq_names_ready;
+static AO_t unicode_property_values_hashes_ready;
+
 /* Looks up a codepoint by name. Lazily constructs a hash. */
 MVMGrapheme32 MVM_unicode_lookup_by_name(MVMThreadContext *tc, MVMString *name) {
     char *cname = MVM_string_utf8_encode_C_string(tc, name);
-    if (!MVM_uni_hash_count(tc, &codepoints_by_name)) {
-        generate_codepoints_by_name(tc);
-    }
+    ensure_lookup_hash(tc, &codepoints_by_name_ready, generate_codepoints_by_name);
     struct MVMUniHashEntry *result = MVM_uni_hash_fetch(tc, &codepoints_by_name, cname);
     if (!result) {
         #define prefixes_len 7
@@ -817,9 +1125,34 @@ MVMint64 MVM_unicode_codepoint_get_property_bool(MVMThreadContext *tc, MVMint64
     return 0;
 }
 
+/* Character class and property checks in regexes tend to ask about the
+ * same few properties of the same codepoints over and over, so we keep a
+ * small direct-mapped cache of property values per thread, sparing a hit the
+ * walk through the property tables. */
+static MVMint32 cached_property_int(MVMThreadContext *tc, MVMint64 codepoint, MVMint64 property_code) {
+    MVMUnicodePropertyCacheEntry *cache = tc->unicode_property_cache;
+    MVMUnicodePropertyCacheEntry *entry;
+    if (MVM_UNLIKELY(codepoint < 0 || 0x10FFFF < codepoint))
+        return MVM_unicode_get_property_int(tc, codepoint, property_code);
+    if (MVM_UNLIKELY(!cache)) {
+        MVMuint32 i;
+        cache = MVM_malloc(MVM_UNICODE_PROPERTY_CACHE_SIZE * sizeof(MVMUnicodePropertyCacheEntry));
+        for (i = 0; i < MVM_UNICODE_PROPERTY_CACHE_SIZE; i++)
+            cache[i].codepoint = -1;
+        tc->unicode_property_cache = cache;
+    }
+    entry = &cache[((MVMuint32)(codepoint ^ (property_code << 21)) * 0x9E3779B1U)
+        >> (32 - MVM_UNICODE_PROPERTY_CACHE_BITS)];
+    if (entry->codepoint != codepoint || entry->property_code != property_code) {
+        entry->codepoint     = (MVMint32)codepoint;
+        entry->property_code = (MVMint32)property_code;
+        entry->value         = MVM_unicode_get_property_int(tc, codepoint, property_code);
+    }
+    return entry->value;
+}
 MVMint64 MVM_unicode_codepoint_has_property_value(MVMThreadContext *tc, MVMint64 codepoint, MVMint64 property_code, MVMint64 property_value_code) {
     if (MVM_LIKELY(property_code != 0)) {
-        return (MVMint64)MVM_unicode_get_property_int(tc,
+        return (MVMint64)cached_property_int(tc,
             codepoint, property_code) == property_value_code;
     }
     return 0;
@@ -908,9 +1241,7 @@ static void generate_property_codes_by_seq_names(MVMThreadContext *tc) {
 MVMint64 MVM_unicode_name_to_property_code(MVMThreadContext *tc, MVMString *name) {
     MVMuint64 size;
     char *cname = MVM_string_ascii_encode(tc, name, &size, 0);
-    if (!MVM_uni_hash_count(tc, &property_codes_by_names_aliases)) {
-        generate_property_codes_by_names_aliases(tc);
-    }
+    ensure_lookup_hash(tc, &property_codes_by_names_aliases_ready, generate_property_codes_by_names_aliases);
     struct MVMUniHashEntry *result = MVM_uni_hash_fetch(tc, &property_codes_by_names_aliases, cname);
     return result ? result->value : 0;
 }
@@ -951,6 +1282,7 @@ MVMint32 unicode_cname_to_property_value_code(MVMThreadContext *tc, MVMint64 pro
         MVM_exception_throw_adhoc(tc, "Property value or name queried (%"PRIu64") is larger than allowed (1024).", out_str_length);
 
     out_str = alloca(sizeof(char) * out_str_length);
+    ensure_lookup_hash(tc, &unicode_property_values_hashes_ready, generate_unicode_property_values_hashes);
     snprintf(out_str, out_str_length, "%"PRIi64"-%s", property_code, cname);
 
     struct MVMUniHashEntry *result = MVM_uni_hash_fetch(tc,
@@ -993,23 +1325,11 @@ MVMCodepoint MVM_unicode_find_primary_composite(MVMThreadContext *tc, MVMCodepoi
     return 0;
 }
 
-static uv_mutex_t property_hash_count_mutex;
-static int property_hash_count = 0;
-static uv_once_t property_hash_count_guard = UV_ONCE_INIT;
-
-static void setup_property_mutex(void)
-{
-    uv_mutex_init(&property_hash_count_mutex);
-}
-
 void MVM_unicode_init(MVMThreadContext *tc)
 {
     uv_once(&property_hash_count_guard, setup_property_mutex);
 
     uv_mutex_lock(&property_hash_count_mutex);
-    if (property_hash_count == 0) {
-        generate_unicode_property_values_hashes(tc);
-    }
     property_hash_count++;
     uv_mutex_unlock(&property_hash_count_mutex);
 }
@@ -1018,7 +1338,7 @@ void MVM_unicode_release(MVMThreadContext *tc)
 {
     uv_mutex_lock(&property_hash_count_mutex);
     property_hash_count--;
-    if (property_hash_count == 0) {
+    if (property_hash_count == 0 && MVM_load(&unicode_property_values_hashes_ready)) {
         int i;
 
         for (i = 0; i < MVM_NUM_PROPERTY_CODES; i++) {
@@ -1028,6 +1348,7 @@ void MVM_unicode_release(MVMThreadContext *tc)
         MVM_free(unicode_property_values_hashes);
 
         unicode_property_values_hashes = NULL;
+        MVM_store(&unicode_property_values_hashes_ready, 0);
     }
     uv_mutex_unlock(&property_hash_count_mutex);
 }
@@ -1047,9 +1368,7 @@ MVMString * MVM_unicode_string_from_name(MVMThreadContext *tc, MVMString *name)
     else {
         const MVMint32 *uni_seq = NULL;
         char *cname = MVM_string_utf8_encode_C_string(tc, name_uc);
-        if (!MVM_uni_hash_count(tc, &property_codes_by_seq_names)) {
-            generate_property_codes_by_seq_names(tc);
-        }
+        ensure_lookup_hash(tc, &property_codes_by_seq_names_ready, generate_property_codes_by_seq_names);
         struct MVMUniHashEntry *result = MVM_uni_hash_fetch(tc,
                                                             &property_codes_by_seq_names,
                                                             cname);
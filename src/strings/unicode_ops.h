@@ -1,4 +1,15 @@
+/* An entry in the per-thread cache of codepoint property values. */
+#define MVM_UNICODE_PROPERTY_CACHE_BITS 8
+#define MVM_UNICODE_PROPERTY_CACHE_SIZE (1 << MVM_UNICODE_PROPERTY_CACHE_BITS)
+struct MVMUnicodePropertyCacheEntry {
+    MVMint32 codepoint;
+    MVMint32 property_code;
+    MVMint32 value;
+};
+
 MVMint64 MVM_unicode_string_compare(MVMThreadContext *tc, MVMString *a, MVMString *b,
     MVMint64 collation_mode, MVMint64 lang_mode, MVMint64 country_mode);
+MVMObject * MVM_unicode_string_collation_key(MVMThreadContext *tc, MVMString *s, MVMint64 collation_mode, MVMObject *buf);
+MVMObject * MVM_unicode_string_sort(MVMThreadContext *tc, MVMObject *strings, MVMint64 collation_mode, MVMint64 num_threads);
 
 MVMString * MVM_unicode_string_from_name(MVMThreadContext *tc, MVMString *name);
@@ -168,6 +168,54 @@ static MVMint32 utf8_encode(MVMuint8 *bp, MVMCodepoint cp) {
 
 #define UTF8_MAXINC (32 * 1024 * 1024)
 
+/* Runs of printable ASCII shorter than this aren't worth the cost of trying
+ * to skip the DFA for. */
+#define UTF8_ASCII_RUN_MIN 16
+
+/* Word-at-a-time tests on 8 bytes of input. Each leaves the high bit set in
+ * any byte that fails the test (any_high only tests the high bits, and the
+ * others expect them to have been found clear). A word that fails is looked
+ * at again byte by byte, so false positives only cost us speed. */
+#define UTF8_WORD_ONES  0x0101010101010101ULL
+#define UTF8_WORD_HIGHS 0x8080808080808080ULL
+#define any_high(w)         ((w) & UTF8_WORD_HIGHS)
+#define any_cr(w)           ((((w) ^ (0x0D * UTF8_WORD_ONES)) - UTF8_WORD_ONES) \
+                                & ~((w) ^ (0x0D * UTF8_WORD_ONES)) & UTF8_WORD_HIGHS)
+#define any_unprintable(w)  ((~((w) + 0x60 * UTF8_WORD_ONES) | ((w) + UTF8_WORD_ONES)) \
+                                & UTF8_WORD_HIGHS)
+
+/* Counts the bytes at the start of the input that decode to themselves in
+ * NFG, which is all of ASCII except for \r (since \r\n is one grapheme). */
+static size_t self_decoding_prefix(const MVMuint8 *in, size_t bytes) {
+    size_t i = 0;
+    while (i + 8 <= bytes) {
+        MVMuint64 w;
+        memcpy(&w, in + i, 8);
+        if (any_high(w) || any_cr(w))
+            break;
+        i += 8;
+    }
+    while (i < bytes && in[i] < 0x80 && in[i] != 0x0D)
+        i++;
+    return i;
+}
+
+/* Counts the printable ASCII bytes (0x20 to 0x7E) at the start of the input,
+ * looking at no more than max of them. */
+static MVMint32 printable_ascii_prefix(const MVMuint8 *in, MVMint32 max) {
+    MVMint32 i = 0;
+    while (i + 8 <= max) {
+        MVMuint64 w;
+        memcpy(&w, in + i, 8);
+        if (any_high(w) || any_unprintable(w))
+            break;
+        i += 8;
+    }
+    while (i < max && in[i] >= 0x20 && in[i] < 0x7F)
+        i++;
+    return i;
+}
+
 /* Decodes the specified number of bytes of utf8 into an NFG string, creating
  * a result of the specified type. The type must have the MVMString REPR. */
 MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result_type, const char *utf8, size_t bytes) {
@@ -177,21 +225,56 @@ MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result
     MVMint32 line_ending = 0;
     MVMint32 state = 0;
     MVMint32 bufsize = bytes;
-    MVMGrapheme32 *buffer = MVM_malloc(sizeof(MVMGrapheme32) * bufsize);
+    MVMGrapheme32 *buffer;
     size_t orig_bytes;
     const char *orig_utf8;
+    const char *ascii_checked_to;
+    MVMint32 ascii_retry = 0;
     MVMint32 line;
     MVMint32 col;
     MVMint32 ready;
+    MVMNormalizer norm;
+
+    /* Input that is all ASCII (the most common case by far) besides \r comes
+     * out exactly as it went in, so we need neither the DFA nor normalizing. */
+    if (self_decoding_prefix((const MVMuint8 *)utf8, bytes) == bytes) {
+        MVMGrapheme8 *blob = MVM_malloc(bytes);
+        memcpy(blob, utf8, bytes);
+        result->body.storage.blob_8 = blob;
+        result->body.storage_type   = MVM_STRING_GRAPHEME_8;
+        result->body.num_graphs     = bytes;
+        return result;
+    }
+    buffer = MVM_malloc(sizeof(MVMGrapheme32) * bufsize);
 
     /* Need to normalize to NFG as we decode. */
-    MVMNormalizer norm;
     MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFG);
 
     orig_bytes = bytes;
     orig_utf8 = utf8;
+    ascii_checked_to = utf8;
 
     for (; bytes; ++utf8, --bytes) {
+        /* Between codepoints, long enough runs of printable ASCII can go in
+         * to the buffer directly, provided the normalizer is happy for them
+         * to. It may first want to see a codepoint the usual way, so if it
+         * isn't we try again from the next byte, but only the once. We note
+         * how far we looked, so short runs aren't looked at again. */
+        if (state == UTF8_ACCEPT && utf8 >= ascii_checked_to) {
+            MVMint32 run = printable_ascii_prefix((const MVMuint8 *)utf8,
+                bytes < (size_t)(bufsize - count) ? (MVMint32)bytes : bufsize - count);
+            if (run >= UTF8_ASCII_RUN_MIN && MVM_unicode_normalizer_process_ascii_run(tc,
+                    &norm, (const MVMuint8 *)utf8, run, (MVMCodepoint *)buffer + count)) {
+                count += run;
+                utf8  += run - 1;
+                bytes -= run - 1;
+                ascii_retry = 0;
+                continue;
+            }
+            ascii_retry      = run >= UTF8_ASCII_RUN_MIN && !ascii_retry;
+            ascii_checked_to = ascii_retry ? utf8 + 1 : utf8 + run;
+        }
+
         switch(MVM_EXPECT(decode_utf8_byte(&state, &codepoint, (MVMuint8)*utf8), UTF8_ACCEPT)) {
         case UTF8_ACCEPT: { /* got a codepoint */
             MVMGrapheme32 g;
@@ -549,65 +632,220 @@ MVMuint32 MVM_string_utf8_decodestream(MVMThreadContext *tc, MVMDecodeStream *ds
     return reached_stopper;
 }
 
+/* Output state threaded through the pieces of the UTF-8 encoder below. The
+ * buffer is always allocated with 4 bytes of slack beyond limit, so a single
+ * codepoint can be encoded once pos < limit has been checked. */
+typedef struct {
+    MVMuint8  *result;
+    size_t     pos;
+    size_t     limit;
+    MVMuint8  *repl_bytes;
+    MVMuint64  repl_length;
+    MVMint32   translate_newlines;
+} UTF8EncodeState;
+
+/* Graphemes are checked and copied in chunks of this size, which is small
+ * enough for the check to stay cheap when a chunk turns out to need the
+ * slow path, and big enough for the compiler to vectorize the loops. */
+#define UTF8_ENCODE_CHUNK 64
+
+/* Newline translation only ever does anything on Windows, so elsewhere the
+ * bulk paths need not consider it. */
+#ifdef _WIN32
+#define translating_newlines(es) ((es)->translate_newlines)
+#else
+#define translating_newlines(es) 0
+#endif
+
+static void encode_reserve(UTF8EncodeState *es, size_t needed) {
+    if (es->pos + needed > es->limit) {
+        size_t new_limit = es->limit * 2;
+        if (new_limit < es->pos + needed)
+            new_limit = es->pos + needed;
+        es->limit  = new_limit;
+        es->result = MVM_realloc(es->result, new_limit + 4);
+    }
+}
+
+static void encode_codepoint(MVMThreadContext *tc, UTF8EncodeState *es, MVMCodepoint cp) {
+    MVMint32 bytes;
+    if (es->pos >= es->limit)
+        encode_reserve(es, 4);
+    bytes = utf8_encode(es->result + es->pos, cp);
+    if (bytes) {
+        es->pos += bytes;
+    }
+    else if (es->repl_bytes) {
+        encode_reserve(es, es->repl_length);
+        memcpy(es->result + es->pos, es->repl_bytes, es->repl_length);
+        es->pos += es->repl_length;
+    }
+    else {
+        MVM_free(es->result);
+        MVM_free(es->repl_bytes);
+        MVM_string_utf8_throw_encoding_exception(tc, cp);
+    }
+}
+
+static void encode_grapheme(MVMThreadContext *tc, UTF8EncodeState *es, MVMGrapheme32 g) {
+#ifdef _WIN32
+    if (es->translate_newlines && g == '\n')
+        g = MVM_nfg_crlf_grapheme(tc);
+#endif
+    if (g >= 0) {
+        encode_codepoint(tc, es, g);
+    }
+    else {
+        MVMNFGSynthetic *synth = MVM_nfg_get_synthetic_info(tc, g);
+        MVMint32 i;
+        for (i = 0; i < synth->num_codes; i++)
+            encode_codepoint(tc, es, synth->codes[i]);
+    }
+}
+
+/* Encodes graphemes from..to of a flat (non-strand) string. ASCII blobs are
+ * copied straight through; 8-bit and 32-bit blobs are checked a chunk at a
+ * time and copied (narrowing, in the 32-bit case) when the whole chunk is
+ * ASCII, which covers the bulk of most output. */
+static void encode_blob_range(MVMThreadContext *tc, UTF8EncodeState *es, MVMString *blob,
+        MVMStringIndex from, MVMStringIndex to) {
+    MVMStringIndex i;
+    switch (blob->body.storage_type) {
+        case MVM_STRING_GRAPHEME_ASCII: {
+            MVMGraphemeASCII *graphs = blob->body.storage.blob_ascii;
+            if (translating_newlines(es)) {
+                for (i = from; i < to; i++)
+                    encode_grapheme(tc, es, graphs[i]);
+            }
+            else {
+                encode_reserve(es, to - from);
+                memcpy(es->result + es->pos, graphs + from, to - from);
+                es->pos += to - from;
+            }
+            break;
+        }
+        case MVM_STRING_GRAPHEME_8: {
+            MVMGrapheme8 *graphs = blob->body.storage.blob_8;
+            while (from < to) {
+                MVMStringIndex n = to - from < UTF8_ENCODE_CHUNK ? to - from : UTF8_ENCODE_CHUNK;
+                MVMuint8 seen = 0;
+                MVM_VECTORIZE_LOOP
+                for (i = 0; i < n; i++)
+                    seen |= (MVMuint8)graphs[from + i];
+                if (!(seen & 0x80) && !translating_newlines(es)) {
+                    encode_reserve(es, n);
+                    memcpy(es->result + es->pos, graphs + from, n);
+                    es->pos += n;
+                }
+                else {
+                    for (i = 0; i < n; i++)
+                        encode_grapheme(tc, es, graphs[from + i]);
+                }
+                from += n;
+            }
+            break;
+        }
+        case MVM_STRING_GRAPHEME_32: {
+            MVMGrapheme32 *graphs = blob->body.storage.blob_32;
+            while (from < to) {
+                MVMStringIndex n = to - from < UTF8_ENCODE_CHUNK ? to - from : UTF8_ENCODE_CHUNK;
+                MVMuint32 seen = 0;
+                MVM_VECTORIZE_LOOP
+                for (i = 0; i < n; i++)
+                    seen |= (MVMuint32)graphs[from + i];
+                if (!(seen & 0xFFFFFF80) && !translating_newlines(es)) {
+                    MVMuint8 *out;
+                    encode_reserve(es, n);
+                    out = es->result + es->pos;
+                    MVM_VECTORIZE_LOOP
+                    for (i = 0; i < n; i++)
+                        out[i] = (MVMuint8)graphs[from + i];
+                    es->pos += n;
+                }
+                else {
+                    for (i = 0; i < n; i++)
+                        encode_grapheme(tc, es, graphs[from + i]);
+                }
+                from += n;
+            }
+            break;
+        }
+        default:
+            MVM_free(es->result);
+            MVM_free(es->repl_bytes);
+            MVM_exception_throw_adhoc(tc, "String corruption detected: bad storage type");
+    }
+}
+
 /* Encodes the specified string to UTF-8. */
 char * MVM_string_utf8_encode_substr(MVMThreadContext *tc,
         MVMString *str, MVMuint64 *output_size, MVMint64 start, MVMint64 length,
         MVMString *replacement, MVMint32 translate_newlines) {
-    MVMuint8        *result = NULL;
-    size_t           result_pos, result_limit;
-    MVMCodepointIter ci;
-    MVMStringIndex   strgraphs  = MVM_string_graphs(tc, str);
-    MVMuint8        *repl_bytes = NULL;
-    MVMuint64        repl_length;
+    UTF8EncodeState es;
+    MVMStringIndex  strgraphs = MVM_string_graphs(tc, str);
 
     if (start < 0 || start > strgraphs)
         MVM_exception_throw_adhoc(tc, "start (%"PRId64") out of range (0..%"PRIu32")", start, strgraphs);
     if (length == -1)
-        length = strgraphs;
+        length = strgraphs - start;
     if (length < 0 || start + length > strgraphs)
         MVM_exception_throw_adhoc(tc, "length (%"PRId64") out of range (0..%"PRIu32")", length, strgraphs);
 
+    es.repl_bytes         = NULL;
+    es.repl_length        = 0;
+    es.translate_newlines = translate_newlines;
     if (replacement)
-        repl_bytes = (MVMuint8 *) MVM_string_utf8_encode_substr(tc,
-            replacement, &repl_length, 0, -1, NULL, translate_newlines);
-
-    /* Guesstimate that we'll be within 2 bytes for most chars most of the
-     * time, and give ourselves 4 bytes breathing space. */
-    result_limit = 2 * length;
-    result       = MVM_malloc(result_limit + 4);
-    result_pos   = 0;
-
-    /* Iterate the codepoints and encode them. */
-    MVM_string_ci_init(tc, &ci, str, translate_newlines, 0);
-    while (MVM_string_ci_has_more(tc, &ci)) {
-        MVMint32 bytes;
-        MVMCodepoint cp = MVM_string_ci_get_codepoint(tc, &ci);
-        if (result_pos >= result_limit) {
-            result_limit *= 2;
-            result = MVM_realloc(result, result_limit + 4);
-        }
-        bytes = utf8_encode(result + result_pos, cp);
-        if (bytes)
-            result_pos += bytes;
-        else if (replacement) {
-            if (repl_length >= result_limit || result_pos >= result_limit - repl_length) {
-                result_limit += repl_length;
-                result = MVM_realloc(result, result_limit + 4);
+        es.repl_bytes = (MVMuint8 *) MVM_string_utf8_encode_substr(tc,
+            replacement, &es.repl_length, 0, -1, NULL, translate_newlines);
+
+    /* 8-bit storage only ever holds one-byte codepoints bar the odd
+     * synthetic, so we can size for that exactly. Otherwise, guesstimate
+     * that we'll be within 2 bytes for most chars most of the time. Either
+     * way, give ourselves 4 bytes breathing space. */
+    es.limit = str->body.storage_type == MVM_STRING_GRAPHEME_ASCII
+            || str->body.storage_type == MVM_STRING_GRAPHEME_8
+        ? (size_t)length
+        : 2 * (size_t)length;
+    es.result = MVM_malloc(es.limit + 4);
+    es.pos    = 0;
+
+    if (str->body.storage_type == MVM_STRING_STRAND) {
+        /* Walk the strands, encoding the part of each repetition of each
+         * one that falls within the requested range straight from its
+         * blob. */
+        MVMStringStrand *strands   = str->body.storage.strands;
+        MVMuint64        skip      = (MVMuint64)start;
+        MVMuint64        remaining = (MVMuint64)length;
+        MVMuint16        i;
+        for (i = 0; i < str->body.num_strands && remaining; i++) {
+            MVMStringStrand *strand = &strands[i];
+            MVMuint64 strand_graphs = strand->end - strand->start;
+            MVMuint64 total         = strand_graphs * (strand->repetitions + 1);
+            if (skip >= total) {
+                skip -= total;
+                continue;
             }
-            memcpy(result + result_pos, repl_bytes, repl_length);
-            result_pos += repl_length;
-        }
-        else {
-            MVM_free(result);
-            MVM_free(repl_bytes);
-            MVM_string_utf8_throw_encoding_exception(tc, cp);
+            while (skip < total && remaining) {
+                MVMuint64 offset = skip % strand_graphs;
+                MVMuint64 take   = strand_graphs - offset;
+                if (take > remaining)
+                    take = remaining;
+                encode_blob_range(tc, &es, strand->blob_string,
+                    strand->start + offset, strand->start + offset + take);
+                skip      += take;
+                remaining -= take;
+            }
+            skip = 0;
         }
     }
+    else {
+        encode_blob_range(tc, &es, str, start, start + length);
+    }
 
     if (output_size)
-        *output_size = (MVMuint64)result_pos;
-    MVM_free(repl_bytes);
-    return (char *)result;
+        *output_size = (MVMuint64)es.pos;
+    MVM_free(es.repl_bytes);
+    return (char *)es.result;
 }
 
 /* Encodes the specified string to UTF-8. */
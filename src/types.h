@@ -13,11 +13,15 @@ typedef struct MVMAttributeIdentifier MVMAttributeIdentifier;
 typedef struct MVMBoolificationSpec MVMBoolificationSpec;
 typedef struct MVMBootTypes MVMBootTypes;
 typedef struct MVMEventSubscriptions MVMEventSubscriptions;
+typedef struct MVMObjectIdShard MVMObjectIdShard;
 typedef struct MVMBytecodeAnnotation MVMBytecodeAnnotation;
 typedef struct MVMCallCapture MVMCallCapture;
 typedef struct MVMCallCaptureBody MVMCallCaptureBody;
 typedef struct MVMCallsite MVMCallsite;
 typedef struct MVMCallsiteInterns MVMCallsiteInterns;
+typedef struct MVMCUStringInternEntry MVMCUStringInternEntry;
+typedef struct MVMCUStringInterns MVMCUStringInterns;
+typedef struct MVMCUBundle MVMCUBundle;
 typedef struct MVMCallStackRegion MVMCallStackRegion;
 typedef struct MVMCFunction MVMCFunction;
 typedef struct MVMCFunctionBody MVMCFunctionBody;
@@ -40,6 +44,8 @@ typedef struct MVMDLLSym MVMDLLSym;
 typedef struct MVMDLLSymBody MVMDLLSymBody;
 typedef struct MVMException MVMException;
 typedef struct MVMExceptionBody MVMExceptionBody;
+typedef struct MVMDNSCacheEntry MVMDNSCacheEntry;
+typedef struct MVMEventLoop MVMEventLoop;
 typedef struct MVMExtOpRecord MVMExtOpRecord;
 typedef struct MVMExtOpRegistry MVMExtOpRegistry;
 typedef struct MVMExtRegistry MVMExtRegistry;
@@ -53,7 +59,14 @@ typedef struct MVMFixedSizeAllocThread MVMFixedSizeAllocThread;
 typedef struct MVMFixedSizeAllocThreadSizeClass MVMFixedSizeAllocThreadSizeClass;
 typedef struct MVMFrame MVMFrame;
 typedef struct MVMFrameExtra MVMFrameExtra;
+typedef struct MVMDynvarCacheEntry MVMDynvarCacheEntry;
+typedef struct MVMLexnameCacheEntry MVMLexnameCacheEntry;
+typedef struct MVMNFGCacheEntry MVMNFGCacheEntry;
+typedef struct MVMFinalizeItem MVMFinalizeItem;
+typedef struct MVMAllocSample MVMAllocSample;
+typedef struct MVMCPUSampleNode MVMCPUSampleNode;
 typedef struct MVMFrameHandler MVMFrameHandler;
+typedef struct MVMFrameHandlerRanges MVMFrameHandlerRanges;
 typedef struct MVMGen2Allocator MVMGen2Allocator;
 typedef struct MVMGen2SizeClass MVMGen2SizeClass;
 typedef struct MVMGCPassedWork MVMGCPassedWork;
@@ -63,9 +76,12 @@ typedef struct MVMHashAttrStore MVMHashAttrStore;
 typedef struct MVMHashAttrStoreBody MVMHashAttrStoreBody;
 typedef struct MVMHashBody MVMHashBody;
 typedef struct MVMHashEntry MVMHashEntry;
+typedef struct MVMHashOrdered MVMHashOrdered;
 typedef struct MVMHLLConfig MVMHLLConfig;
 typedef struct MVMIntConstCache MVMIntConstCache;
 typedef struct MVMInstance MVMInstance;
+typedef struct MVMIOHistogram MVMIOHistogram;
+typedef struct MVMIOReadBufferPool MVMIOReadBufferPool;
 typedef struct MVMInvocationSpec MVMInvocationSpec;
 typedef struct MVMIter MVMIter;
 typedef struct MVMIterBody MVMIterBody;
@@ -75,6 +91,10 @@ typedef struct MVMKnowHOWREPR MVMKnowHOWREPR;
 typedef struct MVMKnowHOWREPRBody MVMKnowHOWREPRBody;
 typedef struct MVMNFA MVMNFA;
 typedef struct MVMNFABody MVMNFABody;
+typedef struct MVMNFADFA MVMNFADFA;
+typedef struct MVMNFADFAEvent MVMNFADFAEvent;
+typedef struct MVMNFADFAState MVMNFADFAState;
+typedef struct MVMNFADFATransition MVMNFADFATransition;
 typedef struct MVMNFAStateInfo MVMNFAStateInfo;
 typedef struct MVMNFGState MVMNFGState;
 typedef struct MVMNFGSynthetic MVMNFGSynthetic;
@@ -110,6 +130,8 @@ typedef struct MVMCUnionREPRData MVMCUnionREPRData;
 typedef struct MVMMultiCache MVMMultiCache;
 typedef struct MVMMultiCacheBody MVMMultiCacheBody;
 typedef struct MVMMultiCacheNode MVMMultiCacheNode;
+typedef struct MVMMultiCacheHash MVMMultiCacheHash;
+typedef struct MVMMultiCacheHashEntry MVMMultiCacheHashEntry;
 typedef struct MVMMultiDimArray MVMMultiDimArray;
 typedef struct MVMMultiDimArrayBody MVMMultiDimArrayBody;
 typedef struct MVMMultiDimArrayREPRData MVMMultiDimArrayREPRData;
@@ -121,9 +143,29 @@ typedef struct MVMConditionVariable MVMConditionVariable;
 typedef struct MVMConditionVariableBody MVMConditionVariableBody;
 typedef struct MVMSemaphore MVMSemaphore;
 typedef struct MVMSemaphoreBody MVMSemaphoreBody;
+typedef struct MVMSemaphoreState MVMSemaphoreState;
 typedef struct MVMConcBlockingQueue MVMConcBlockingQueue;
 typedef struct MVMConcBlockingQueueBody MVMConcBlockingQueueBody;
 typedef struct MVMConcBlockingQueueNode MVMConcBlockingQueueNode;
+typedef struct MVMConcHash MVMConcHash;
+typedef struct MVMConcHashBody MVMConcHashBody;
+typedef struct MVMConcHashSlot MVMConcHashSlot;
+typedef struct MVMConcHashTable MVMConcHashTable;
+typedef struct MVMNativeHash MVMNativeHash;
+typedef struct MVMNativeHashBody MVMNativeHashBody;
+typedef struct MVMNativeHashEntry MVMNativeHashEntry;
+typedef struct MVMNativeHashREPRData MVMNativeHashREPRData;
+typedef struct MVMChunkedArray MVMChunkedArray;
+typedef struct MVMChunkedArrayBody MVMChunkedArrayBody;
+typedef struct MVMChunkedArrayREPRData MVMChunkedArrayREPRData;
+typedef struct MVMArrayView MVMArrayView;
+typedef struct MVMArrayViewBody MVMArrayViewBody;
+typedef struct MVMConcRingQueue MVMConcRingQueue;
+typedef struct MVMConcRingQueueBody MVMConcRingQueueBody;
+typedef struct MVMConcRingQueueCell MVMConcRingQueueCell;
+typedef struct MVMConcRingQueueREPRData MVMConcRingQueueREPRData;
+typedef struct MVMReadWriteLock MVMReadWriteLock;
+typedef struct MVMReadWriteLockBody MVMReadWriteLockBody;
 typedef struct MVMObject MVMObject;
 typedef struct MVMObjectStooge MVMObjectStooge;
 typedef struct MVMOpInfo MVMOpInfo;
@@ -192,6 +234,12 @@ typedef struct MVMSpeshSimStack MVMSpeshSimStack;
 typedef struct MVMSpeshSimStackFrame MVMSpeshSimStackFrame;
 typedef struct MVMSpeshSimCallType MVMSpeshSimCallType;
 typedef struct MVMSpeshPlan MVMSpeshPlan;
+typedef struct MVMSpeshCache MVMSpeshCache;
+typedef struct MVMSpeshCacheFrame MVMSpeshCacheFrame;
+typedef struct MVMSpeshCacheEntry MVMSpeshCacheEntry;
+typedef struct MVMSpeshCacheType MVMSpeshCacheType;
+typedef struct MVMSpeshCodeCacheUnit MVMSpeshCodeCacheUnit;
+typedef struct MVMSpeshCodeCacheRecord MVMSpeshCodeCacheRecord;
 typedef struct MVMSpeshPlanned MVMSpeshPlanned;
 typedef struct MVMSpeshArgGuard MVMSpeshArgGuard;
 typedef struct MVMSpeshArgGuardNode MVMSpeshArgGuardNode;
@@ -209,22 +257,36 @@ typedef struct MVMSTable MVMSTable;
 typedef struct MVMStaticFrame MVMStaticFrame;
 typedef struct MVMStaticFrameBody MVMStaticFrameBody;
 typedef struct MVMStaticFrameInstrumentation MVMStaticFrameInstrumentation;
+typedef struct MVMLineCoverageCounters MVMLineCoverageCounters;
+typedef struct MVMLockContention MVMLockContention;
+typedef struct MVMLockContentionEntry MVMLockContentionEntry;
 typedef struct MVMStaticFrameDebugLocal MVMStaticFrameDebugLocal;
 typedef struct MVMStaticFrameSpesh MVMStaticFrameSpesh;
 typedef struct MVMStaticFrameSpeshBody MVMStaticFrameSpeshBody;
 typedef struct MVMStorageSpec MVMStorageSpec;
 typedef struct MVMString MVMString;
 typedef struct MVMStringBody MVMStringBody;
+typedef struct MVMStringBuilder MVMStringBuilder;
+typedef struct MVMStringBuilderBody MVMStringBuilderBody;
+typedef struct MVMStringSearcher MVMStringSearcher;
+typedef struct MVMStringSearcherBody MVMStringSearcherBody;
+typedef struct MVMStringSearcherNode MVMStringSearcherNode;
+typedef struct MVMStringSearcherEdge MVMStringSearcherEdge;
 typedef struct MVMStringConsts MVMStringConsts;
 typedef struct MVMStringStrand MVMStringStrand;
 typedef struct MVMGraphemeIter MVMGraphemeIter;
 typedef struct MVMCodepointIter MVMCodepointIter;
+typedef struct MVMScheduler MVMScheduler;
+typedef struct MVMWorkDeque MVMWorkDeque;
+typedef struct MVMWorkDequeBuffer MVMWorkDequeBuffer;
 typedef struct MVMThread MVMThread;
 typedef struct MVMThreadBody MVMThreadBody;
 typedef struct MVMThreadContext MVMThreadContext;
+typedef struct MVMTimerWheel MVMTimerWheel;
 typedef struct MVMUnicodeNamedValue MVMUnicodeNamedValue;
 typedef struct MVMUninstantiable MVMUninstantiable;
 typedef struct MVMWorkThread MVMWorkThread;
+typedef struct MVMWorkerPool MVMWorkerPool;
 typedef struct MVMIOOps MVMIOOps;
 typedef struct MVMIOClosable MVMIOClosable;
 typedef struct MVMIOSyncReadable MVMIOSyncReadable;
@@ -237,6 +299,7 @@ typedef struct MVMIOSockety MVMIOSockety;
 typedef struct MVMIOIntrospection MVMIOIntrospection;
 typedef struct MVMIOLockable MVMIOLockable;
 typedef struct MVMDecodeStream MVMDecodeStream;
+typedef struct MVMUnicodePropertyCacheEntry MVMUnicodePropertyCacheEntry;
 typedef struct MVMDecodeStreamBytes MVMDecodeStreamBytes;
 typedef struct MVMDecodeStreamChars MVMDecodeStreamChars;
 typedef struct MVMDecodeStreamSeparators MVMDecodeStreamSeparators;
@@ -271,6 +334,7 @@ typedef struct MVMProfileThreadData MVMProfileThreadData;
 typedef struct MVMProfileGC MVMProfileGC;
 typedef struct MVMProfileCallNode MVMProfileCallNode;
 typedef struct MVMProfileAllocationCount MVMProfileAllocationCount;
+typedef struct MVMProfileAllocationSite MVMProfileAllocationSite;
 typedef struct MVMProfileDeallocationCount MVMProfileDeallocationCount;
 typedef struct MVMProfileContinuationData MVMProfileContinuationData;
 typedef struct MVMHeapSnapshotCollection MVMHeapSnapshotCollection;
@@ -284,6 +348,7 @@ typedef struct MVMHeapSnapshotStaticFrame MVMHeapSnapshotStaticFrame;
 typedef struct MVMHeapSnapshotCollectable MVMHeapSnapshotCollectable;
 typedef struct MVMHeapSnapshotReference MVMHeapSnapshotReference;
 typedef struct MVMHeapSnapshotState MVMHeapSnapshotState;
+typedef struct MVMHeapSnapshotRefStream MVMHeapSnapshotRefStream;
 typedef struct MVMHeapSnapshotWorkItem MVMHeapSnapshotWorkItem;
 typedef struct MVMDebugServerBreakpointInfo MVMDebugServerBreakpointInfo;
 typedef struct MVMDebugServerBreakpointFileTable MVMDebugServerBreakpointFileTable;
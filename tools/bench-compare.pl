@@ -0,0 +1,51 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Getopt::Long;
+
+# Compares two outputs of tools/bench, such as of runs before and after a
+# change, by the best time per operation of each benchmark. Changes bigger
+# than the threshold (in percent) are marked; with --fail, the exit code is
+# non-zero if anything got slower by more than that.
+#
+#   tools/bench-compare.pl [--threshold 5] [--fail] before.tsv after.tsv
+
+my %OPTIONS = (threshold => 5);
+GetOptions(\%OPTIONS, qw(threshold=f fail)) && @ARGV == 2
+    or die "Usage: $0 [--threshold percent] [--fail] before after\n";
+
+sub read_results {
+    my ($file) = @_;
+    my (%results, @order);
+    open my $fh, '<', $file or die "Can't open $file: $!\n";
+    while (<$fh>) {
+        chomp;
+        next if /^#/ || !/\S/;
+        my ($name, $ops, $best, $median) = split /\t/;
+        push @order, $name unless exists $results{$name};
+        $results{$name} = $best;
+    }
+    close $fh;
+    return (\%results, \@order);
+}
+
+my ($before) = read_results($ARGV[0]);
+my ($after, $order) = read_results($ARGV[1]);
+
+my $regressed = 0;
+printf "%-24s %14s %14s %9s\n", 'benchmark', 'before ns/op', 'after ns/op', 'change';
+for my $name (@$order) {
+    unless (exists $before->{$name} && $before->{$name} > 0) {
+        printf "%-24s %14s %14.2f %9s\n", $name, '-', $after->{$name}, 'new';
+        next;
+    }
+    my $change = 100 * ($after->{$name} - $before->{$name}) / $before->{$name};
+    my $mark = $change > $OPTIONS{threshold}  ? ' slower'
+             : $change < -$OPTIONS{threshold} ? ' faster'
+             : '';
+    $regressed++ if $change > $OPTIONS{threshold};
+    printf "%-24s %14.2f %14.2f %+8.1f%%%s\n", $name, $before->{$name},
+        $after->{$name}, $change, $mark;
+}
+
+exit($OPTIONS{fail} && $regressed ? 1 : 0);
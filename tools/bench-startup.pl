@@ -0,0 +1,35 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+# Measures the cold start latency of commands, such as a "hello world" and a
+# program that loads a large module graph, by running each a number of
+# times. The output has the same format as that of tools/bench, so runs can
+# be compared across commits with tools/bench-compare.pl.
+#
+#   tools/bench-startup.pl [--runs 11] name='command' ...
+#
+# for example
+#
+#   tools/bench-startup.pl hello='nqp -e "say(1)"' modules='raku -MTest -e ""'
+
+my %OPTIONS = (runs => 11);
+GetOptions(\%OPTIONS, qw(runs=i)) && @ARGV && $OPTIONS{runs} > 0
+    or die "Usage: $0 [--runs n] name='command' ...\n";
+
+print "# name\tops\tbest_ns_per_op\tmedian_ns_per_op\n";
+for my $bench (@ARGV) {
+    my ($name, $command) = $bench =~ /^([^=]+)=(.+)$/s
+        or die "Expected name='command', got '$bench'\n";
+    my @times;
+    for (1 .. $OPTIONS{runs}) {
+        my $start = time;
+        system("$command >/dev/null 2>&1") == 0
+            or die "'$command' failed\n";
+        push @times, (time - $start) * 1e9;
+    }
+    @times = sort { $a <=> $b } @times;
+    printf "%s\t1\t%.2f\t%.2f\n", $name, $times[0], $times[int(@times / 2)];
+}
@@ -0,0 +1,210 @@
+#include "moar.h"
+
+/* Measures how allocation and GC, queues, locks and plain computation scale
+ * with the number of threads. For each workload and thread count, that many
+ * VM threads are started, each doing a fixed amount of work, and a tab
+ * separated line is written with the throughput, the number of GC runs,
+ * percentiles of the GC pauses, and the average and longest time it took to
+ * get all threads to the GC safepoint. The pause percentiles come from the
+ * power of two histogram the GC keeps, so they are bucket upper bounds.
+ *
+ * Usage: tools/bench-threads [-t max-threads] [-s scale] [workload ...]
+ */
+
+#define DEFAULT_MAX_THREADS 64
+
+typedef struct {
+    const char *name;
+    void (*func)(MVMThreadContext *tc, MVMuint64 ops);
+    MVMuint64 ops;
+} Workload;
+
+/* Shared between the threads; rooted by the main thread. */
+static MVMObject *queue;
+static MVMObject *lock;
+static MVMuint64  locked_counter;
+
+/* What the threads of the current run are to do. */
+static const Workload *current;
+static MVMuint64 current_ops;
+
+/* Allocates boxed integers, keeping every tenth in a list that is dropped
+ * every so often, so there is a mix of garbage and survivors. */
+static void work_alloc(MVMThreadContext *tc, MVMuint64 ops) {
+    MVMObject *keep = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    MVMuint64 i;
+    MVMROOT(tc, keep, {
+        for (i = 0; i < ops; i++) {
+            MVMObject *boxed = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, i);
+            if (i % 10 == 0)
+                MVM_repr_push_o(tc, keep, boxed);
+            if (i % 100000 == 0)
+                keep = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        }
+    });
+}
+
+/* Pushes onto and shifts from a ConcBlockingQueue shared by all threads.
+ * Each thread pushes before it shifts, so there's always something to get
+ * and nobody ends up waiting forever. */
+static void work_queue(MVMThreadContext *tc, MVMuint64 ops) {
+    MVMuint64 i;
+    for (i = 0; i < ops; i++) {
+        MVM_repr_push_o(tc, queue, tc->instance->VMNull);
+        MVM_repr_shift_o(tc, queue);
+    }
+}
+
+/* Takes a ReentrantMutex shared by all threads for a short critical
+ * section. */
+static void work_lock(MVMThreadContext *tc, MVMuint64 ops) {
+    MVMuint64 i;
+    for (i = 0; i < ops; i++) {
+        MVM_reentrantmutex_lock(tc, (MVMReentrantMutex *)lock);
+        locked_counter++;
+        MVM_reentrantmutex_unlock(tc, (MVMReentrantMutex *)lock);
+    }
+}
+
+/* Computes without touching shared state or allocating, which should scale
+ * with the number of cores; checking GC safepoints on the way, like the
+ * interpreter does on backward branches. */
+static volatile MVMuint64 compute_sink;
+static void work_compute(MVMThreadContext *tc, MVMuint64 ops) {
+    MVMuint64 i, x = 88172645463325252ULL;
+    for (i = 0; i < ops; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        if ((i & 0xFFFF) == 0)
+            GC_SYNC_POINT(tc);
+    }
+    compute_sink = x;
+}
+
+static const Workload workloads[] = {
+    { "alloc",   work_alloc,   2000000 },
+    { "queue",   work_queue,   200000 },
+    { "lock",    work_lock,    500000 },
+    { "compute", work_compute, 100000000 },
+};
+
+static void thread_entry(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    current->func(tc, current_ops);
+}
+
+static void copy_gc_stats(MVMInstance *instance, MVMuint64 *to) {
+    uv_mutex_lock(&instance->mutex_gc_stats);
+    memcpy(to, instance->gc_stats, MVM_GC_STATS_FIELDS * sizeof(MVMuint64));
+    uv_mutex_unlock(&instance->mutex_gc_stats);
+}
+
+/* Finds the pause (in microseconds) below which the given share of the
+ * collections in the histogram fall. */
+static MVMuint64 pause_percentile(MVMuint64 *histogram, MVMuint64 runs, MVMuint32 percent) {
+    MVMuint64 seen = 0, wanted = (runs * percent + 99) / 100;
+    MVMuint32 i;
+    if (!runs)
+        return 0;
+    for (i = 0; i < MVM_GC_PAUSE_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= wanted)
+            return (MVMuint64)2 << i;
+    }
+    return (MVMuint64)2 << (MVM_GC_PAUSE_BUCKETS - 1);
+}
+
+static void run(MVMThreadContext *tc, const Workload *workload, MVMuint32 num_threads, MVMuint64 scale) {
+    MVMuint64 before[MVM_GC_STATS_FIELDS], after[MVM_GC_STATS_FIELDS], histogram[MVM_GC_PAUSE_BUCKETS];
+    MVMObject *threads = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    MVMuint64 start, elapsed, runs, total_ops;
+    MVMuint32 i;
+
+    current     = workload;
+    current_ops = workload->ops * scale / num_threads;
+    total_ops   = current_ops * num_threads;
+
+    MVMROOT(tc, threads, {
+        copy_gc_stats(tc->instance, before);
+        start = uv_hrtime();
+        for (i = 0; i < num_threads; i++) {
+            MVMObject *entry = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTCCode);
+            MVMObject *thread;
+            ((MVMCFunction *)entry)->body.func = thread_entry;
+            thread = MVM_thread_new(tc, entry, 0);
+            MVM_repr_push_o(tc, threads, thread);
+            MVM_thread_run(tc, thread);
+        }
+        for (i = 0; i < num_threads; i++)
+            MVM_thread_join(tc, MVM_repr_at_pos_o(tc, threads, i));
+        elapsed = uv_hrtime() - start;
+        copy_gc_stats(tc->instance, after);
+    });
+
+    runs = after[MVM_GC_STATS_RUNS] - before[MVM_GC_STATS_RUNS];
+    for (i = 0; i < MVM_GC_PAUSE_BUCKETS; i++)
+        histogram[i] = after[MVM_GC_STATS_HISTOGRAM + i] - before[MVM_GC_STATS_HISTOGRAM + i];
+
+    printf("%s\t%"PRIu32"\t%"PRIu64"\t%.0f\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%.1f\t%.1f\n",
+        workload->name, num_threads, total_ops, total_ops / (elapsed / 1e9), runs,
+        pause_percentile(histogram, runs, 50),
+        pause_percentile(histogram, runs, 90),
+        pause_percentile(histogram, runs, 99),
+        runs ? (after[MVM_GC_STATS_TTSP_TOTAL] - before[MVM_GC_STATS_TTSP_TOTAL]) / 1e3 / runs : 0.0,
+        /* The longest wait is only known over the whole run of the VM. */
+        after[MVM_GC_STATS_TTSP_MAX] / 1e3);
+    fflush(stdout);
+}
+
+static int wanted(const char *name, int argc, char **argv, int first) {
+    int i;
+    if (first >= argc)
+        return 1;
+    for (i = first; i < argc; i++)
+        if (strcmp(name, argv[i]) == 0)
+            return 1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    MVMInstance *instance = MVM_vm_create_instance();
+    MVMThreadContext *tc = instance->main_thread;
+    MVMuint32 max_threads = DEFAULT_MAX_THREADS, threads;
+    MVMuint64 scale = 1;
+    MVMuint32 i;
+    int first = 1;
+
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-t") == 0 && first + 1 < argc) {
+            max_threads = atoi(argv[first + 1]);
+            if (max_threads < 1)
+                max_threads = 1;
+        }
+        else if (strcmp(argv[first], "-s") == 0 && first + 1 < argc) {
+            scale = strtoull(argv[first + 1], NULL, 10);
+            if (scale < 1)
+                scale = 1;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-t max-threads] [-s scale] [workload ...]\n", argv[0]);
+            return 1;
+        }
+        first += 2;
+    }
+
+    queue = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    MVM_gc_root_add_permanent_desc(tc, (MVMCollectable **)&queue, "Benchmark queue");
+    lock = MVM_repr_alloc_init(tc, instance->boot_types.BOOTReentrantMutex);
+    MVM_gc_root_add_permanent_desc(tc, (MVMCollectable **)&lock, "Benchmark lock");
+
+    printf("# workload\tthreads\tops\tops_per_sec\tgc_runs\tpause_p50_us\tpause_p90_us\tpause_p99_us\tttsp_avg_us\tttsp_max_us\n");
+    for (i = 0; i < sizeof(workloads) / sizeof(Workload); i++) {
+        if (!wanted(workloads[i].name, argc, argv, first))
+            continue;
+        for (threads = 1; threads <= max_threads; threads *= 2)
+            run(tc, &workloads[i], threads, scale);
+    }
+
+    /* MVM_vm_destroy_instance(instance); */
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include "moar.h"
+
+/* Micro-benchmarks of some of the VM's hot paths, run against the library
+ * directly. Each benchmark is run a number of times, and a line with its
+ * name, the number of operations per run, and the best and the median time
+ * per operation in nanoseconds is written, tab separated, to standard
+ * output. tools/bench-compare.pl compares two such outputs, for example of
+ * runs before and after a change.
+ *
+ * Usage: tools/bench [-r runs] [-s scale] [name-substring ...]
+ */
+
+#define DEFAULT_RUNS 7
+#define MAX_RUNS     101
+
+/* Things set up once and shared by the benchmarks. Everything is made in
+ * gen2 so that it stays where it is; the GC benchmarks run last. */
+typedef struct {
+    MVMString  *short_a;
+    MVMString  *short_b;
+    MVMString  *haystack;
+    MVMString  *needle;
+    MVMString  *csv;
+    MVMString  *comma;
+    MVMString  *text;
+    char       *utf8;
+    MVMuint64   utf8_bytes;
+
+    MVMuint32   num_keys;
+    MVMString **keys;
+    char      **c_keys;
+} BenchData;
+
+typedef MVMuint64 (*BenchFunc)(MVMThreadContext *tc, BenchData *d, MVMuint64 ops);
+
+typedef struct {
+    const char *name;
+    BenchFunc   func;
+    MVMuint64   ops;
+} Bench;
+
+static MVMString * make_string(MVMThreadContext *tc, const char *c_string) {
+    return MVM_string_utf8_decode(tc, tc->instance->VMString, c_string, strlen(c_string));
+}
+
+/* Strings. */
+static MVMuint64 bench_str_concat(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMuint64 i, start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_string_concatenate(tc, d->short_a, d->short_b);
+    return uv_hrtime() - start;
+}
+
+static MVMuint64 bench_str_index(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMuint64 i, start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_string_index(tc, d->haystack, d->needle, 0);
+    return uv_hrtime() - start;
+}
+
+static MVMuint64 bench_str_split(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMuint64 i, start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_string_split(tc, d->comma, d->csv);
+    return uv_hrtime() - start;
+}
+
+static MVMuint64 bench_utf8_decode(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMuint64 i, start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_string_utf8_decode(tc, tc->instance->VMString, d->utf8, d->utf8_bytes);
+    return uv_hrtime() - start;
+}
+
+static MVMuint64 bench_utf8_encode(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMuint64 i, size, start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_free(MVM_string_utf8_encode(tc, d->text, &size, 0));
+    return uv_hrtime() - start;
+}
+
+/* Hashes; each operation is an insert or a lookup of one of the keys. */
+typedef struct {
+    struct MVMStrHashHandle hash_handle;
+    MVMuint64 value;
+} StrEntry;
+
+typedef struct {
+    MVMString *hash_key;
+    MVMuint64  value;
+} FixKeyEntry;
+
+static MVMuint64 bench_str_hash_insert(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMStrHashTable hash;
+    MVMuint64 i, elapsed = 0;
+    for (i = 0; i < ops; i += d->num_keys) {
+        MVMuint64 j, start = uv_hrtime();
+        MVM_str_hash_build(tc, &hash, sizeof(StrEntry), 0);
+        for (j = 0; j < d->num_keys; j++)
+            ((StrEntry *)MVM_str_hash_insert_nocheck(tc, &hash, d->keys[j]))->value = j;
+        elapsed += uv_hrtime() - start;
+        MVM_str_hash_demolish(tc, &hash);
+    }
+    return elapsed;
+}
+
+static MVMuint64 bench_str_hash_fetch(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMStrHashTable hash;
+    MVMuint64 i, start;
+    MVM_str_hash_build(tc, &hash, sizeof(StrEntry), d->num_keys);
+    for (i = 0; i < d->num_keys; i++)
+        ((StrEntry *)MVM_str_hash_insert_nocheck(tc, &hash, d->keys[i]))->value = i;
+    start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_str_hash_fetch_nocheck(tc, &hash, d->keys[i % d->num_keys]);
+    start = uv_hrtime() - start;
+    MVM_str_hash_demolish(tc, &hash);
+    return start;
+}
+
+static MVMuint64 bench_fixkey_hash_insert(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMFixKeyHashTable hash;
+    MVMuint64 i, elapsed = 0;
+    for (i = 0; i < ops; i += d->num_keys) {
+        MVMuint64 j, start = uv_hrtime();
+        MVM_fixkey_hash_build(tc, &hash, sizeof(FixKeyEntry));
+        for (j = 0; j < d->num_keys; j++)
+            ((FixKeyEntry *)MVM_fixkey_hash_insert_nocheck(tc, &hash, d->keys[j]))->value = j;
+        elapsed += uv_hrtime() - start;
+        MVM_fixkey_hash_demolish(tc, &hash);
+    }
+    return elapsed;
+}
+
+static MVMuint64 bench_fixkey_hash_fetch(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMFixKeyHashTable hash;
+    MVMuint64 i, start;
+    MVM_fixkey_hash_build(tc, &hash, sizeof(FixKeyEntry));
+    for (i = 0; i < d->num_keys; i++)
+        ((FixKeyEntry *)MVM_fixkey_hash_insert_nocheck(tc, &hash, d->keys[i]))->value = i;
+    start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_fixkey_hash_fetch_nocheck(tc, &hash, d->keys[i % d->num_keys]);
+    start = uv_hrtime() - start;
+    MVM_fixkey_hash_demolish(tc, &hash);
+    return start;
+}
+
+static MVMuint64 bench_index_hash_insert(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMIndexHashTable hash;
+    MVMuint64 i, elapsed = 0;
+    for (i = 0; i < ops; i += d->num_keys) {
+        MVMuint64 j, start = uv_hrtime();
+        MVM_index_hash_build(tc, &hash, 0);
+        for (j = 0; j < d->num_keys; j++)
+            MVM_index_hash_insert_nocheck(tc, &hash, d->keys, j);
+        elapsed += uv_hrtime() - start;
+        MVM_index_hash_demolish(tc, &hash);
+    }
+    return elapsed;
+}
+
+static MVMuint64 bench_index_hash_fetch(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMIndexHashTable hash;
+    MVMuint64 i, start;
+    MVM_index_hash_build(tc, &hash, d->num_keys);
+    for (i = 0; i < d->num_keys; i++)
+        MVM_index_hash_insert_nocheck(tc, &hash, d->keys, i);
+    start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_index_hash_fetch_nocheck(tc, &hash, d->keys, d->keys[i % d->num_keys]);
+    start = uv_hrtime() - start;
+    MVM_index_hash_demolish(tc, &hash);
+    return start;
+}
+
+static MVMuint64 bench_uni_hash_insert(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMUniHashTable hash;
+    MVMuint64 i, elapsed = 0;
+    for (i = 0; i < ops; i += d->num_keys) {
+        MVMuint64 j, start = uv_hrtime();
+        MVM_uni_hash_build(tc, &hash, 0);
+        for (j = 0; j < d->num_keys; j++)
+            MVM_uni_hash_insert(tc, &hash, d->c_keys[j], j);
+        elapsed += uv_hrtime() - start;
+        MVM_uni_hash_demolish(tc, &hash);
+    }
+    return elapsed;
+}
+
+static MVMuint64 bench_uni_hash_fetch(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMUniHashTable hash;
+    MVMuint64 i, start;
+    MVM_uni_hash_build(tc, &hash, d->num_keys);
+    for (i = 0; i < d->num_keys; i++)
+        MVM_uni_hash_insert(tc, &hash, d->c_keys[i], i);
+    start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_uni_hash_fetch(tc, &hash, d->c_keys[i % d->num_keys]);
+    start = uv_hrtime() - start;
+    MVM_uni_hash_demolish(tc, &hash);
+    return start;
+}
+
+static MVMuint64 bench_ptr_hash_insert(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMPtrHashTable hash;
+    MVMuint64 i, elapsed = 0;
+    for (i = 0; i < ops; i += d->num_keys) {
+        MVMuint64 j, start = uv_hrtime();
+        MVM_ptr_hash_build(tc, &hash);
+        for (j = 0; j < d->num_keys; j++)
+            MVM_ptr_hash_insert(tc, &hash, d->keys[j], j);
+        elapsed += uv_hrtime() - start;
+        MVM_ptr_hash_demolish(tc, &hash);
+    }
+    return elapsed;
+}
+
+static MVMuint64 bench_ptr_hash_fetch(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMPtrHashTable hash;
+    MVMuint64 i, start;
+    MVM_ptr_hash_build(tc, &hash);
+    for (i = 0; i < d->num_keys; i++)
+        MVM_ptr_hash_insert(tc, &hash, d->keys[i], i);
+    start = uv_hrtime();
+    for (i = 0; i < ops; i++)
+        MVM_ptr_hash_fetch(tc, &hash, d->keys[i % d->num_keys]);
+    start = uv_hrtime() - start;
+    MVM_ptr_hash_demolish(tc, &hash);
+    return start;
+}
+
+/* Arrays; each operation is a push and a shift. */
+static MVMuint64 bench_vmarray_push_shift_o(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMObject *array = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+    MVMuint64 i, start;
+    MVMROOT(tc, array, {
+        start = uv_hrtime();
+        for (i = 0; i < ops; i++)
+            MVM_repr_push_o(tc, array, (MVMObject *)d->short_a);
+        for (i = 0; i < ops; i++)
+            MVM_repr_shift_o(tc, array);
+        start = uv_hrtime() - start;
+    });
+    return start;
+}
+
+static MVMuint64 bench_vmarray_push_shift_i(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    MVMObject *array = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIntArray);
+    MVMuint64 i, start;
+    MVMROOT(tc, array, {
+        start = uv_hrtime();
+        for (i = 0; i < ops; i++)
+            MVM_repr_push_i(tc, array, i);
+        for (i = 0; i < ops; i++)
+            MVM_repr_shift_i(tc, array);
+        start = uv_hrtime() - start;
+    });
+    return start;
+}
+
+/* GC. A nursery worth of boxed integers is allocated, with every so many
+ * of them kept alive, and then only the collection is timed; an operation
+ * is one collection. */
+static MVMuint64 collect_with_survivors(MVMThreadContext *tc, MVMuint64 ops, MVMuint32 percent, MVMint32 full) {
+    MVMObject *keep = NULL;
+    MVMuint64 i, elapsed = 0;
+    MVM_gc_root_temp_push(tc, (MVMCollectable **)&keep);
+    for (i = 0; i < ops; i++) {
+        MVMuint64 j, start;
+        keep = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
+        for (j = 0; j < 100000; j++) {
+            MVMObject *boxed = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, j);
+            if (j % 100 < percent)
+                MVM_repr_push_o(tc, keep, boxed);
+        }
+        /* Make the collection a full one by looking like a lot was
+         * promoted since the last. */
+        if (full)
+            MVM_store(&tc->instance->gc_promoted_bytes_since_last_full, (AO_t)1 << 40);
+        start = uv_hrtime();
+        MVM_gc_enter_from_allocator(tc);
+        elapsed += uv_hrtime() - start;
+    }
+    MVM_gc_root_temp_pop(tc);
+    return elapsed;
+}
+
+static MVMuint64 bench_gc_nursery_0(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 0, 0);
+}
+static MVMuint64 bench_gc_nursery_10(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 10, 0);
+}
+static MVMuint64 bench_gc_nursery_50(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 50, 0);
+}
+static MVMuint64 bench_gc_nursery_90(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 90, 0);
+}
+static MVMuint64 bench_gc_full_10(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 10, 1);
+}
+static MVMuint64 bench_gc_full_90(MVMThreadContext *tc, BenchData *d, MVMuint64 ops) {
+    return collect_with_survivors(tc, ops, 90, 1);
+}
+
+static const Bench benches[] = {
+    { "str_concat",            bench_str_concat,            1000000 },
+    { "str_index",             bench_str_index,             100000 },
+    { "str_split",             bench_str_split,             10000 },
+    { "utf8_decode",           bench_utf8_decode,           10000 },
+    { "utf8_encode",           bench_utf8_encode,           10000 },
+    { "str_hash_insert",       bench_str_hash_insert,       1000000 },
+    { "str_hash_fetch",        bench_str_hash_fetch,        1000000 },
+    { "fixkey_hash_insert",    bench_fixkey_hash_insert,    1000000 },
+    { "fixkey_hash_fetch",     bench_fixkey_hash_fetch,     1000000 },
+    { "index_hash_insert",     bench_index_hash_insert,     1000000 },
+    { "index_hash_fetch",      bench_index_hash_fetch,      1000000 },
+    { "uni_hash_insert",       bench_uni_hash_insert,       1000000 },
+    { "uni_hash_fetch",        bench_uni_hash_fetch,        1000000 },
+    { "ptr_hash_insert",       bench_ptr_hash_insert,       1000000 },
+    { "ptr_hash_fetch",        bench_ptr_hash_fetch,        1000000 },
+    { "vmarray_push_shift_o",  bench_vmarray_push_shift_o,  1000000 },
+    { "vmarray_push_shift_i",  bench_vmarray_push_shift_i,  1000000 },
+    { "gc_nursery_survive_0",  bench_gc_nursery_0,          20 },
+    { "gc_nursery_survive_10", bench_gc_nursery_10,         20 },
+    { "gc_nursery_survive_50", bench_gc_nursery_50,         20 },
+    { "gc_nursery_survive_90", bench_gc_nursery_90,         20 },
+    { "gc_full_survive_10",    bench_gc_full_10,            5 },
+    { "gc_full_survive_90",    bench_gc_full_90,            5 },
+};
+
+static void setup(MVMThreadContext *tc, BenchData *d) {
+    char buf[64];
+    MVMuint32 i;
+    MVMString *piece;
+
+    MVM_gc_allocate_gen2_default_set(tc);
+
+    d->short_a  = make_string(tc, "The quick brown ");
+    d->short_b  = make_string(tc, "fox jumps over t");
+    d->needle   = make_string(tc, "needle");
+    d->comma    = make_string(tc, ",");
+
+    d->haystack = make_string(tc, "");
+    piece = make_string(tc, "hay stack ");
+    for (i = 0; i < 100; i++)
+        d->haystack = MVM_string_concatenate(tc, d->haystack, piece);
+    d->haystack = MVM_string_concatenate(tc, d->haystack, d->needle);
+    d->haystack = MVM_string_indexing_optimized(tc, d->haystack);
+
+    d->csv = make_string(tc, "");
+    for (i = 0; i < 100; i++) {
+        snprintf(buf, sizeof(buf), i ? ",field%u" : "field%u", i);
+        d->csv = MVM_string_concatenate(tc, d->csv, make_string(tc, buf));
+    }
+    d->csv = MVM_string_indexing_optimized(tc, d->csv);
+
+    /* About 4KB of UTF-8, mostly ASCII with some accented and CJK text. */
+    d->text = make_string(tc, "");
+    piece = make_string(tc, "Plain ASCII text, caf\xc3\xa9 na\xc3\xafve, \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e. ");
+    for (i = 0; i < 100; i++)
+        d->text = MVM_string_concatenate(tc, d->text, piece);
+    d->text = MVM_string_indexing_optimized(tc, d->text);
+    d->utf8 = MVM_string_utf8_encode(tc, d->text, &d->utf8_bytes, 0);
+
+    d->num_keys = 10000;
+    d->keys     = MVM_malloc(d->num_keys * sizeof(MVMString *));
+    d->c_keys   = MVM_malloc(d->num_keys * sizeof(char *));
+    for (i = 0; i < d->num_keys; i++) {
+        snprintf(buf, sizeof(buf), "key-%u", i * 7919);
+        d->keys[i]   = make_string(tc, buf);
+        d->c_keys[i] = MVM_string_utf8_encode_C_string(tc, d->keys[i]);
+    }
+
+    MVM_gc_allocate_gen2_default_clear(tc);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    MVMuint64 x = *(const MVMuint64 *)a, y = *(const MVMuint64 *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static int wanted(const char *name, int argc, char **argv, int first) {
+    int i;
+    if (first >= argc)
+        return 1;
+    for (i = first; i < argc; i++)
+        if (strstr(name, argv[i]))
+            return 1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    MVMInstance *instance = MVM_vm_create_instance();
+    MVMThreadContext *tc = instance->main_thread;
+    MVMCompUnit *cu = MVM_calloc(1, sizeof(MVMCompUnit));
+    BenchData data;
+    MVMuint64 times[MAX_RUNS];
+    MVMuint32 runs = DEFAULT_RUNS;
+    MVMuint64 scale = 1;
+    MVMuint32 i, r;
+    int first = 1;
+
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-r") == 0 && first + 1 < argc) {
+            runs = atoi(argv[first + 1]);
+            if (runs < 1 || runs > MAX_RUNS)
+                runs = DEFAULT_RUNS;
+        }
+        else if (strcmp(argv[first], "-s") == 0 && first + 1 < argc) {
+            scale = strtoull(argv[first + 1], NULL, 10);
+            if (scale < 1)
+                scale = 1;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-r runs] [-s scale] [name-substring ...]\n", argv[0]);
+            return 1;
+        }
+        first += 2;
+    }
+
+    /* Some of the string ops find the current HLL through the compilation
+     * unit being interpreted; there is none here, so give them one. */
+    cu->body.hll_config = MVM_hll_get_config_for(tc, make_string(tc, "bench"));
+    tc->interp_cu = &cu;
+
+    memset(&data, 0, sizeof(BenchData));
+    setup(tc, &data);
+
+    printf("# name\tops\tbest_ns_per_op\tmedian_ns_per_op\n");
+    for (i = 0; i < sizeof(benches) / sizeof(Bench); i++) {
+        const Bench *bench = &benches[i];
+        MVMuint64 ops = bench->ops * scale;
+        if (!wanted(bench->name, argc, argv, first))
+            continue;
+        for (r = 0; r < runs; r++)
+            times[r] = bench->func(tc, &data, ops);
+        qsort(times, runs, sizeof(MVMuint64), compare_u64);
+        printf("%s\t%"PRIu64"\t%.2f\t%.2f\n", bench->name, ops,
+            (double)times[0] / ops, (double)times[runs / 2] / ops);
+        fflush(stdout);
+    }
+
+    /* MVM_vm_destroy_instance(instance); */
+    return 0;
+}
@@ -13,6 +13,7 @@ sixmodel_types = [
 
 # Generated with: MoarVM> ack -h -B1 MVMObject\ common src/6model/reprs/*.h | grep struct | cut -d' ' -f1,2 | sort -u | sed "s/^/'/" | sed "s/\$/ *',/"
 'struct MVMArray *',
+'struct MVMArrayView *',
 'struct MVMAsyncTask *',
 'struct MVMCArray *',
 'struct MVMCFunction *',
@@ -22,9 +23,12 @@ sixmodel_types = [
 'struct MVMCStruct *',
 'struct MVMCUnion *',
 'struct MVMCallCapture *',
+'struct MVMChunkedArray *',
 'struct MVMCode *',
 #'struct MVMCompUnit *', # CompUnits are always allocated in gen2 directly
 'struct MVMConcBlockingQueue *',
+'struct MVMConcHash *',
+'struct MVMConcRingQueue *',
 'struct MVMConditionVariable *',
 'struct MVMContext *',
 'struct MVMContinuation *',
@@ -40,6 +44,7 @@ sixmodel_types = [
 'struct MVMMultiDimArray *',
 'struct MVMNFA *',
 'struct MVMNativeCall *',
+'struct MVMNativeHash *',
 'struct MVMNativeRef *',
 'struct MVMNull *',
 'struct MVMOSHandle *',
@@ -48,6 +53,7 @@ sixmodel_types = [
 'struct MVMP6num *',
 'struct MVMP6opaque *',
 'struct MVMP6str *',
+'struct MVMReadWriteLock *',
 'struct MVMReentrantMutex *',
 'struct MVMSemaphore *',
 'struct MVMSpeshLog *',
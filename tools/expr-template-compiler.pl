@@ -31,7 +31,7 @@ my %OPTIONS = (
     prefix => 'MVM_JIT_',
     include => 1,
 );
-GetOptions(\%OPTIONS, qw(prefix=s list=s input=s output=s include! test));
+GetOptions(\%OPTIONS, qw(prefix=s list=s input=s output=s include! test extops=s name=s));
 
 my ($PREFIX, $OPLIST) = @OPTIONS{'prefix', 'oplist'};
 if ($OPTIONS{output}) {
@@ -44,6 +44,21 @@ if ($OPTIONS{input} //= shift @ARGV) {
     open( STDIN, '<', $OPTIONS{input} ) or die $!;
 }
 
+# Templates for extension ops: the ops are declared in a file in the format
+# of src/core/oplist, and a named template is written for each of them
+# rather than the table indexed by opcode.
+my @EXTOPS;
+if ($OPTIONS{extops}) {
+    open( my $fh, '<', $OPTIONS{extops} ) or die $!;
+    @EXTOPS = oplist::parse_oplist($fh);
+    close( $fh ) or die $!;
+    for (@EXTOPS) {
+        my ($name, $attr, $operands, $adverbs) = @$_;
+        die "Extension op '$name' has the name of a core op" if exists $OPLIST{$name};
+        $OPLIST{$name} = { attr => $attr, operands => $operands, adverbs => $adverbs };
+    }
+}
+
 END {
     close STDOUT;
     if ($? && $OPTIONS{output}) {
@@ -57,7 +72,9 @@ END {
 my %OPERATOR_TYPES = (
     (map { $_ => 'void' } qw(store store_num discard dov when ifv branch mark callv guard)),
     (map { $_ => 'flag' } qw(lt le eq ne ge gt nz zr all any)),
-    (map { $_ => 'num' }  qw(const_num load_num calln)),
+    (map { $_ => 'num' }  qw(const_num load_num calln vsum_num)),
+    (map { $_ => 'vec' }  qw(load_vec vsplat vsplat_num vadd vsub vadd_num vsub_num
+                             vmul_num vand vor vxor)),
     (map { $_ => '?' }    qw(if copy do add sub mul)),
     qw(arglist) x 2,
     qw(carg) x 2,
@@ -81,6 +98,11 @@ my %OPERAND_TYPES = (
     arglist => 'carg',
     carg => '?',
     store => 'reg,?',
+    vsplat => 'reg',
+    vsplat_num => 'num',
+    vsum => 'vec',
+    vsum_num => 'vec',
+    map(($_ => 'vec,vec'), qw(vadd vsub vadd_num vsub_num vmul_num vand vor vxor)),
     guard => 'void',
     # anything on numbers is polymorphic,
     # because the output type is the input type
@@ -91,6 +113,7 @@ my %OPERAND_TYPES = (
 my %OP_SIZE_PARAM = (
     load => 2,
     load_num => 2,
+    load_vec => 2,
     store => 3,
     store_num => 3,
     call => 3,
@@ -296,7 +319,7 @@ sub expr_type {
 sub check_type {
     my ($got, $want, $why) = @_;
     return $got if $want eq $got;
-    return $got if $want eq '?' and $got =~ m/reg|num/;
+    return $got if $want eq '?' and $got =~ m/reg|num|vec/;
     confess "$why: Got $got wanted $want";
 }
 
@@ -570,34 +593,61 @@ print <<"HEADER";
 /* FILE AUTOGENERATED BY $0. DO NOT EDIT.
  * Defines tables for expression templates. */
 HEADER
-my $i = 0;
-print "static const MVMint32 MVM_jit_expr_templates[] = {\n    ";
-for (@$templates) {
-    $i += length($_) + 2;
-    if ($i > 75) {
-        print "\n    ";
-        $i = length($_) + 2;
+sub print_templates {
+    my ($array) = @_;
+    my $i = 0;
+    print "static const MVMint32 $array\[] = {\n    ";
+    for (@$templates) {
+        $i += length($_) + 2;
+        if ($i > 75) {
+            print "\n    ";
+            $i = length($_) + 2;
+        }
+        print "$_,";
     }
-    print "$_,";
+    print "\n};\n";
+}
+
+sub print_constants {
+    my ($array) = @_;
+    my @constants; @constants[values %CONSTANTS] = keys %CONSTANTS;
+    print "static const void* $array\[] = {\n";
+    print "    $_,\n" for @constants;
+    print "    NULL,\n" unless @constants;
+    print "};\n";
 }
-print "\n};\n";
+
+if (@EXTOPS) {
+    my $name = $OPTIONS{name} // 'extop';
+    print_templates("${name}_expr_templates");
+    print_constants("${name}_expr_template_constants");
+    for my $opcode (@EXTOPS) {
+        my ($op) = @$opcode;
+        next unless defined(my $td = $info->{$op});
+        printf 'static const MVMJitExprTemplate %s_expr_template_%s = {%s',
+            $name, $op, "\n";
+        printf '    %s_expr_templates + %d, "%s", %d, %d, %d, %s_expr_template_constants%s',
+            $name, $td->{idx}, $td->{info}, $td->{len}, $td->{root}, $td->{flags}, $name, "\n";
+        print "};\n";
+    }
+    exit;
+}
+
+print_templates('MVM_jit_expr_templates');
 print "static const MVMJitExprTemplate MVM_jit_expr_template_info[] = {\n";
 for my $opcode (@OPLIST) {
     my ($name) = @$opcode;
     if (defined($info->{$name})) {
         my $td = $info->{$name};
-        printf '    { MVM_jit_expr_templates + %d, "%s", %d, %d, %d },%s',
+        printf '    { MVM_jit_expr_templates + %d, "%s", %d, %d, %d, NULL },%s',
           $td->{idx}, $td->{info}, $td->{len}, $td->{root}, $td->{flags}, "\n";
     } else {
-        print "    { NULL, NULL, -1, 0, 0 },\n";
+        print "    { NULL, NULL, -1, 0, 0, NULL },\n";
     }
 }
 print "};\n";
 
-my @constants; @constants[values %CONSTANTS] = keys %CONSTANTS;
-print "static const void* MVM_jit_expr_template_constants[] = {\n";
-print "    $_,\n" for @constants;
-print "};\n";
+print_constants('MVM_jit_expr_template_constants');
 
 printf <<'FOOTER', scalar @OPLIST;
 static const MVMJitExprTemplate * MVM_jit_get_template_for_opcode(MVMuint16 opcode) {
@@ -0,0 +1,66 @@
+#!/usr/bin/env perl
+# Generates src/math/ryu_tables.h, the tables of powers of five that the Ryu
+# shortest double to string conversion in src/math/ryu.c multiplies by.
+use strict;
+use warnings;
+use Math::BigInt;
+
+my $POW5_INV_BITCOUNT = 125;
+my $POW5_BITCOUNT     = 125;
+my $NUM_INV           = 342;
+my $NUM               = 326;
+
+my $mask = Math::BigInt->new(2)->bpow(64)->bsub(1);
+
+sub split64 {
+    my ($n) = @_;
+    my $lo = $n->copy->band($mask);
+    my $hi = $n->copy->brsft(64);
+    return sprintf("{ UINT64_C(%s), UINT64_C(%s) }",
+        to_hex($lo), to_hex($hi));
+}
+
+sub to_hex {
+    my $hex = $_[0]->as_hex;
+    $hex =~ s/^0x//;
+    return '0x' . ('0' x (16 - length $hex)) . uc $hex;
+}
+
+sub bitlength {
+    my $len = length $_[0]->as_bin;
+    return $len - 2;
+}
+
+my @inv;
+for my $i (0 .. $NUM_INV - 1) {
+    my $pow = Math::BigInt->new(5)->bpow($i);
+    my $j   = bitlength($pow) - 1 + $POW5_INV_BITCOUNT;
+    my $inv = Math::BigInt->new(2)->bpow($j)->bdiv($pow)->badd(1);
+    push @inv, split64($inv);
+}
+
+my @pow;
+for my $i (0 .. $NUM - 1) {
+    my $pow   = Math::BigInt->new(5)->bpow($i);
+    my $shift = bitlength($pow) - $POW5_BITCOUNT;
+    $pow = $shift < 0 ? $pow->blsft(-$shift) : $pow->brsft($shift);
+    push @pow, split64($pow);
+}
+
+print <<"HEADER";
+/* This file is generated by tools/ryu-tables.pl; do not edit it by hand.
+ *
+ * MVM_RYU_POW5_INV_SPLIT[i] is 2^(bits(5^i) - 1 + $POW5_INV_BITCOUNT) / 5^i, rounded up,
+ * and MVM_RYU_POW5_SPLIT[i] is 5^i scaled to $POW5_BITCOUNT bits, both as 128-bit
+ * values split into their low and high 64 bits. */
+
+#define MVM_RYU_POW5_INV_BITCOUNT $POW5_INV_BITCOUNT
+#define MVM_RYU_POW5_BITCOUNT     $POW5_BITCOUNT
+#define MVM_RYU_POW5_INV_TABLE_SIZE $NUM_INV
+#define MVM_RYU_POW5_TABLE_SIZE     $NUM
+
+static const MVMuint64 MVM_RYU_POW5_INV_SPLIT[MVM_RYU_POW5_INV_TABLE_SIZE][2] = {
+HEADER
+print "    ", join(",\n    ", @inv), "\n};\n\n";
+print "static const MVMuint64 MVM_RYU_POW5_SPLIT[MVM_RYU_POW5_TABLE_SIZE][2] = {\n";
+print "    ", join(",\n    ", @pow), "\n};\n";
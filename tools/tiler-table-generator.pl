@@ -25,9 +25,10 @@ sub sortn {
 sub register_spec {
     my ($symbol) = @_;
     my ($type, $name) = split /:/, $symbol;
-    if ($type eq 'reg' or $type eq 'num') {
+    if ($type eq 'reg' or $type eq 'num' or $type eq 'vec') {
         return sprintf('register_require(%s)', uc $name) if defined $name;
-        return $type eq 'num' ? 'storage_fpr' : 'storage_gpr';
+        # vectors live in the (full width of the) floating point registers
+        return $type eq 'reg' ? 'storage_gpr' : 'storage_fpr';
     }
     return 'storage_none';
 }
@@ -490,7 +491,7 @@ for my $expr_op (@EXPR_OPS) {
     for my $rs1 (sortn keys %{$table{$head}}) {
         for my $rs2 (sortn keys %{$table{$head}{$rs1}}) {
             my $state = $table{$head}{$rs1}{$rs2};
-            my $best; $best ||= $min_cost{$state,$_} for qw(reg num void);
+            my $best; $best ||= $min_cost{$state,$_} for qw(reg num vec void);
             print sprintf('  { %s%s, %s, %s, %d, %d },',
                           $PREFIX, $expr_op->[0], $rs1, $rs2, $state, $best || -1);
         }